@@ -117,6 +117,7 @@ namespace alivesmt {
     bool isQVar() const;
     bool isBV() const;
     bool isBool() const;
+    bool isArray() const;
     bool isFloat() const;
     bool isTrue() const;
     bool isFalse() const;
@@ -351,6 +352,14 @@ namespace alivesmt {
 
     static expr mkArray(const char *name, const expr &domain, const expr &range);
     static expr mkConstArray(const expr &domain, const expr &value);
+    // constant array of the same sort as this array expr
+    expr mkConstArrayLike(const expr &value) const;
+
+    // Raw Z3 access, for clients that build terms with the Z3 API directly
+    // and so skip the folds of the operators here. fromZ3 takes a reference.
+    static expr fromZ3(Z3_ast ast) { return expr(ast); }
+    Z3_ast toZ3() const { return ast(); }
+    Z3_sort z3Sort() const { return sort(); }
 
     expr store(const expr &idx, const expr &val) const;
     expr load(const expr &idx, uint64_t max_idx = UINT64_MAX) const;
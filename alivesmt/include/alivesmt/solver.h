@@ -7,6 +7,7 @@
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 #include "alivesmt/expr.h"
 
 typedef struct _Z3_func_interp *Z3_func_interp;
@@ -172,6 +173,13 @@ namespace alivesmt {
     Z3_solver s;
     bool valid = true;
     bool is_unsat = false;
+    // (valid, is_unsat) saved by each open push() scope
+    std::vector<std::pair<bool, bool>> scopes;
+    // UNSAT core of the last check with assumptions; computed on demand
+    // from the refuted assumptions
+    mutable std::vector<expr> core, refuted;
+
+    Result make_result(int z3_answer) const;
 
   public:
     Solver(bool simple = false);
@@ -181,10 +189,22 @@ namespace alivesmt {
     // use a negated solver for minimization
     void block(const Model &m, Solver *sneg = nullptr);
     void reset();
+    // limit each check to `ms` milliseconds (overrides the global timeout)
+    void set_timeout(unsigned ms);
+    void set_seed(unsigned seed);
 
     expr assertions() const;
 
     Result check(const char *query_name, bool dont_skip = false) const;
+    // check the current assertions together with the given assumptions,
+    // which are not added to the assertion stack
+    Result check(const std::vector<expr> &assumptions, const char *query_name) const;
+    // right after an UNSAT check with assumptions: the assumptions needed
+    // to refute them (empty if the assertions alone are unsat)
+    const std::vector<expr> &unsatCore() const;
+
+    void push();
+    void pop(unsigned levels = 1);
 
     friend class SolverPush;
   };
@@ -10,7 +10,7 @@
 #include "util/config.h"
 
 using namespace std;
-using util::config::dbg;
+using alivesmt::util::config::dbg;
 
 static void z3_error_handler(Z3_context ctx, Z3_error_code err) {
   string_view str = Z3_get_error_msg(ctx, err);
@@ -310,6 +310,8 @@ namespace alivesmt {
   expr expr::IntSMin(unsigned bits) {
     if (bits == 0)
       return {};
+    if (bits <= 64)
+      return mkUInt(uint64_t(1) << (bits - 1), bits);
     expr v = mkUInt(1, 1);
     if (bits > 1)
       v = v.concat(mkUInt(0, bits - 1));
@@ -319,6 +321,8 @@ namespace alivesmt {
   expr expr::IntSMax(unsigned bits) {
     if (bits == 0)
       return {};
+    if (bits <= 64)
+      return mkUInt((uint64_t(1) << (bits - 1)) - 1, bits);
     expr v = mkUInt(0, 1);
     if (bits > 1)
       v = v.concat(mkInt(-1, bits - 1));
@@ -359,6 +363,11 @@ namespace alivesmt {
     return Z3_get_sort_kind(ctx(), sort()) == Z3_BOOL_SORT;
   }
 
+  bool expr::isArray() const {
+    C();
+    return Z3_get_sort_kind(ctx(), sort()) == Z3_ARRAY_SORT;
+  }
+
   bool expr::isFloat() const {
     C();
     return Z3_get_sort_kind(ctx(), sort()) == Z3_FLOATING_POINT_SORT;
@@ -1858,6 +1867,11 @@ namespace alivesmt {
     return Z3_mk_const_array(ctx(), domain.sort(), value());
   }
 
+  expr expr::mkConstArrayLike(const expr &value) const {
+    C(value);
+    return Z3_mk_const_array(ctx(), Z3_get_array_sort_domain(ctx(), sort()), value());
+  }
+
   expr expr::store(const expr &idx, const expr &val) const {
     C(idx, val);
     expr array, str_idx, str_val;
@@ -416,9 +416,26 @@ namespace alivesmt {
 
   void Solver::reset() {
     Z3_solver_reset(ctx(), s);
+    scopes.clear();
     tactic->reset_solver();
   }
 
+  void Solver::set_timeout(unsigned ms) {
+    Z3_params p = Z3_mk_params(ctx());
+    Z3_params_inc_ref(ctx(), p);
+    Z3_params_set_uint(ctx(), p, Z3_mk_string_symbol(ctx(), "timeout"), ms);
+    Z3_solver_set_params(ctx(), s, p);
+    Z3_params_dec_ref(ctx(), p);
+  }
+
+  void Solver::set_seed(unsigned seed) {
+    Z3_params p = Z3_mk_params(ctx());
+    Z3_params_inc_ref(ctx(), p);
+    Z3_params_set_uint(ctx(), p, Z3_mk_string_symbol(ctx(), "random_seed"), seed);
+    Z3_solver_set_params(ctx(), s, p);
+    Z3_params_dec_ref(ctx(), p);
+  }
+
   expr Solver::assertions() const {
     auto vect = Z3_solver_get_assertions(ctx(), s);
     Z3_ast_vector_inc_ref(ctx(), vect);
@@ -473,7 +490,88 @@ namespace alivesmt {
 
     tactic->check();
 
-    switch (Z3_solver_check(ctx(), s)) {
+    return make_result(Z3_solver_check(ctx(), s));
+  }
+
+  Result Solver::check(const vector<expr> &assumptions, const char *query_name) const {
+    core.clear();
+    refuted.clear();
+    if (!valid) {
+      ++num_invalid;
+      return Result::INVALID;
+    }
+
+    vector<Z3_ast> asts;
+    asts.reserve(assumptions.size());
+    for (auto &e: assumptions) {
+      if (!e.isValid()) {
+        ++num_invalid;
+        return Result::INVALID;
+      }
+      if (e.isFalse()) {
+        core.push_back(e);
+        return Result::UNSAT;
+      }
+      asts.push_back(e());
+    }
+
+    if (is_unsat) {
+      ++num_trivial;
+      return Result::UNSAT;
+    }
+
+    ++num_queries;
+    if (print_queries) {
+      dbg() << "\nSMT query (" << query_name << ", " << asts.size() << " assumptions):\n"
+            << Z3_solver_to_string(ctx(), s) << endl;
+    }
+
+    auto answer = Z3_solver_check_assumptions(ctx(), s, asts.size(), asts.data());
+    if (answer == Z3_L_FALSE)
+      refuted = assumptions;
+    return make_result(answer);
+  }
+
+  const vector<expr> &Solver::unsatCore() const {
+    if (refuted.empty())
+      return core;
+    // Most of the tactic pipeline cannot track assumptions, so redo the
+    // refutation on a plain solver that produces cores.
+    Z3_solver cs = Z3_mk_simple_solver(ctx());
+    Z3_solver_inc_ref(ctx(), cs);
+    Z3_params p = Z3_mk_params(ctx());
+    Z3_params_inc_ref(ctx(), p);
+    Z3_params_set_bool(ctx(), p, Z3_mk_string_symbol(ctx(), "unsat_core"), true);
+    Z3_solver_set_params(ctx(), cs, p);
+    Z3_params_dec_ref(ctx(), p);
+
+    Z3_ast_vector as = Z3_solver_get_assertions(ctx(), s);
+    Z3_ast_vector_inc_ref(ctx(), as);
+    for (unsigned i = 0, n = Z3_ast_vector_size(ctx(), as); i < n; ++i)
+      Z3_solver_assert(ctx(), cs, Z3_ast_vector_get(ctx(), as, i));
+    Z3_ast_vector_dec_ref(ctx(), as);
+
+    vector<Z3_ast> asts;
+    asts.reserve(refuted.size());
+    for (auto &e: refuted)
+      asts.push_back(e());
+    if (Z3_solver_check_assumptions(ctx(), cs, asts.size(), asts.data()) == Z3_L_FALSE) {
+      Z3_ast_vector v = Z3_solver_get_unsat_core(ctx(), cs);
+      Z3_ast_vector_inc_ref(ctx(), v);
+      for (unsigned i = 0, n = Z3_ast_vector_size(ctx(), v); i < n; ++i)
+        core.push_back(expr(Z3_ast_vector_get(ctx(), v, i)));
+      Z3_ast_vector_dec_ref(ctx(), v);
+    } else {
+      // no answer this time: all of them together are a core
+      core = refuted;
+    }
+    Z3_solver_dec_ref(ctx(), cs);
+    refuted.clear();
+    return core;
+  }
+
+  Result Solver::make_result(int z3_answer) const {
+    switch (z3_answer) {
       case Z3_L_FALSE:
         ++num_unsats;
         return Result::UNSAT;
@@ -494,6 +592,21 @@ namespace alivesmt {
     }
   }
 
+  void Solver::push() {
+    scopes.emplace_back(valid, is_unsat);
+    Z3_solver_push(ctx(), s);
+  }
+
+  void Solver::pop(unsigned levels) {
+    assert(levels <= scopes.size());
+    if (levels == 0)
+      return;
+    valid = scopes[scopes.size() - levels].first;
+    is_unsat = scopes[scopes.size() - levels].second;
+    scopes.resize(scopes.size() - levels);
+    Z3_solver_pop(ctx(), s, levels);
+  }
+
   Result check_expr(const expr &e, const char *query_name, bool dont_skip) {
     Solver s;
     s.add(e);
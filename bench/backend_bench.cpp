@@ -0,0 +1,68 @@
+// Code emission of the C and WebAssembly backends over straight-line
+// programs of growing size.
+
+#include "bench.hpp"
+#include "inputs.hpp"
+
+#include <sstream>
+#include "backend/c_backend.hpp"
+#include "backend/vec_lowering.hpp"
+#include "backend/wasm_backend.hpp"
+#include "backend/wasm_binary.hpp"
+
+using namespace symir;
+using namespace symir::bench;
+
+static std::unique_ptr<CheckedProgram> checkedStraightLine(State &state) {
+  try {
+    return parseAndCheck(straightLineSource((int) state.range(0), false));
+  } catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return nullptr;
+  }
+}
+
+static void BM_CBackend(State &state) {
+  auto checked = checkedStraightLine(state);
+  if (!checked)
+    return;
+  int64_t bytes = 0;
+  for (auto _: state) {
+    std::ostringstream os;
+    CBackend cb(os);
+    cb.setVecLowering(makeVecLowering("vecext"));
+    cb.emit(checked->prog);
+    bytes += (int64_t) os.tellp();
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_CBackend)->Range(64, 16384);
+
+static void BM_WasmBackend(State &state) {
+  auto checked = checkedStraightLine(state);
+  if (!checked)
+    return;
+  int64_t bytes = 0;
+  for (auto _: state) {
+    std::ostringstream os;
+    WasmBackend wb(os);
+    wb.emit(checked->prog);
+    bytes += (int64_t) os.tellp();
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_WasmBackend)->Range(64, 16384);
+
+static void BM_WasmBinaryEncode(State &state) {
+  auto checked = checkedStraightLine(state);
+  if (!checked)
+    return;
+  std::ostringstream wat;
+  WasmBackend wb(wat);
+  wb.emit(checked->prog);
+  std::string text = wat.str();
+  for (auto _: state)
+    DoNotOptimize(WasmBinaryEncoder().encode(text).size());
+  state.SetBytesProcessed(state.iterations() * (int64_t) text.size());
+}
+BENCHMARK(BM_WasmBinaryEncode)->Range(64, 16384);
@@ -0,0 +1,263 @@
+/**
+ * symir-bench — microbenchmarks of the SymIR toolchain (`make bench`).
+ *
+ * Runs every registered benchmark whose name matches --filter, prints a
+ * table, and with --json writes the results in Google Benchmark's JSON
+ * format for regression tracking.
+ */
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <thread>
+#include "cxxopts.hpp"
+#include "json.hpp"
+
+namespace symir::bench {
+
+  namespace {
+
+    std::vector<std::unique_ptr<Benchmark>> &registry() {
+      static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+      return benchmarks;
+    }
+
+    double cpuNow() {
+      timespec ts{};
+      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+      return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+    }
+
+  } // namespace
+
+  void State::PauseTiming() {
+    if (!running_)
+      return;
+    realSeconds_ += std::chrono::duration<double>(Clock::now() - realStart_).count();
+    cpuSeconds_ += cpuNow() - cpuStart_;
+    running_ = false;
+  }
+
+  void State::ResumeTiming() {
+    if (running_)
+      return;
+    running_ = true;
+    cpuStart_ = cpuNow();
+    realStart_ = Clock::now();
+  }
+
+  State::Iterator State::begin() {
+    ResumeTiming();
+    return {this, iterations_};
+  }
+
+  void State::finish() { PauseTiming(); }
+
+  Benchmark *Benchmark::Range(int64_t lo, int64_t hi, int64_t mult) {
+    int64_t x = lo;
+    for (; x < hi; x *= mult)
+      Arg(x);
+    return Arg(hi);
+  }
+
+  Benchmark *registerBenchmark(const char *name, Function fn) {
+    registry().push_back(std::make_unique<Benchmark>(name, fn));
+    return registry().back().get();
+  }
+
+  struct Result {
+    std::string name;
+    int64_t iterations = 0;
+    double realNs = 0, cpuNs = 0; // per iteration
+    double itemsPerSecond = 0, bytesPerSecond = 0;
+    std::map<std::string, double> counters;
+    std::string label, error;
+  };
+
+  struct Runner {
+    double minTime;
+
+    Result run(const Benchmark &b, const std::vector<int64_t> &args, const std::string &name) {
+      Result r;
+      r.name = name;
+      for (int64_t iters = 1;;) {
+        State state(args, iters);
+        b.fn_(state);
+        if (!state.error_.empty()) {
+          r.error = state.error_;
+          return r;
+        }
+        double t = state.realSeconds_;
+        // As Google Benchmark: grow by at most 10x, aiming 40% past the goal.
+        if (t >= minTime || iters >= (int64_t(1) << 30)) {
+          r.iterations = iters;
+          r.realNs = t * 1e9 / (double) iters;
+          r.cpuNs = state.cpuSeconds_ * 1e9 / (double) iters;
+          if (state.items_ && t > 0)
+            r.itemsPerSecond = (double) state.items_ / t;
+          if (state.bytes_ && t > 0)
+            r.bytesPerSecond = (double) state.bytes_ / t;
+          r.counters = std::move(state.counters);
+          r.label = std::move(state.label_);
+          return r;
+        }
+        double scale = t > 0 ? std::min(10.0, 1.4 * minTime / t) : 10.0;
+        iters = std::max(iters + 1, (int64_t) ((double) iters * scale));
+      }
+    }
+  };
+
+  static std::string instanceName(const std::string &name, const std::vector<int64_t> &args) {
+    std::string out = name;
+    for (int64_t a: args)
+      out += "/" + std::to_string(a);
+    return out;
+  }
+
+  static std::string formatTime(double ns) {
+    char buf[32];
+    if (ns >= 1e6)
+      std::snprintf(buf, sizeof buf, "%.2f ms", ns / 1e6);
+    else if (ns >= 1e3)
+      std::snprintf(buf, sizeof buf, "%.2f us", ns / 1e3);
+    else
+      std::snprintf(buf, sizeof buf, "%.1f ns", ns);
+    return buf;
+  }
+
+  static void writeJson(std::ostream &os, const std::vector<Result> &results, const char *argv0) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+#if defined(USE_BITWUZLA)
+    const char *solverName = "bitwuzla";
+#elif defined(USE_ALIVESMT)
+    const char *solverName = "alivesmt";
+#else
+    const char *solverName = "none";
+#endif
+    os << "{\n  \"context\": {\n    \"date\": " << json::quote(date)
+       << ",\n    \"executable\": " << json::quote(argv0)
+       << ",\n    \"num_cpus\": " << std::thread::hardware_concurrency()
+       << ",\n    \"library_build_type\": \"release\",\n    \"solver\": "
+       << json::quote(solverName) << "\n  },\n  \"benchmarks\": [";
+    for (std::size_t k = 0; k < results.size(); k++) {
+      const Result &r = results[k];
+      os << (k ? "," : "") << "\n    {\n      \"name\": " << json::quote(r.name)
+         << ",\n      \"run_name\": " << json::quote(r.name)
+         << ",\n      \"run_type\": \"iteration\",\n      \"repetitions\": 1"
+         << ",\n      \"repetition_index\": 0,\n      \"threads\": 1";
+      if (!r.error.empty()) {
+        os << ",\n      \"error_occurred\": true,\n      \"error_message\": "
+           << json::quote(r.error) << "\n    }";
+        continue;
+      }
+      os << ",\n      \"iterations\": " << r.iterations << ",\n      \"real_time\": " << r.realNs
+         << ",\n      \"cpu_time\": " << r.cpuNs << ",\n      \"time_unit\": \"ns\"";
+      if (r.itemsPerSecond)
+        os << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+      if (r.bytesPerSecond)
+        os << ",\n      \"bytes_per_second\": " << r.bytesPerSecond;
+      for (const auto &[name, value]: r.counters)
+        os << ",\n      " << json::quote(name) << ": " << value;
+      if (!r.label.empty())
+        os << ",\n      \"label\": " << json::quote(r.label);
+      os << "\n    }";
+    }
+    os << "\n  ]\n}\n";
+  }
+
+} // namespace symir::bench
+
+using namespace symir::bench;
+
+int main(int argc, char **argv) {
+  cxxopts::Options options("symir-bench", "Microbenchmarks of the SymIR toolchain");
+  // clang-format off
+  options.add_options()
+    ("filter",            "Run only the benchmarks whose name matches this regex",
+                          cxxopts::value<std::string>()->default_value("."))
+    ("min-time",          "Seconds each benchmark runs at least",
+                          cxxopts::value<double>()->default_value("0.2"))
+    ("json",              "Write the results as Google Benchmark JSON to this file",
+                          cxxopts::value<std::string>())
+    ("list",              "List the benchmarks and exit")
+    ("h,help",            "Print usage");
+  // clang-format on
+
+  cxxopts::ParseResult result;
+  try {
+    result = options.parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return 1;
+  }
+  if (result.count("help")) {
+    std::cout << options.help() << "\n";
+    return 0;
+  }
+
+  std::regex filter;
+  try {
+    filter = std::regex(result["filter"].as<std::string>());
+  } catch (const std::regex_error &e) {
+    std::cerr << "error: bad --filter: " << e.what() << "\n";
+    return 1;
+  }
+
+  Runner runner{result["min-time"].as<double>()};
+  std::vector<Result> results;
+  bool anyError = false;
+  bool list = result.count("list") > 0;
+  if (!list)
+    std::printf("%-44s %14s %14s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+  for (const auto &b: registry()) {
+    std::vector<std::vector<int64_t>> instances = b->args();
+    if (instances.empty())
+      instances.push_back({});
+    for (const auto &args: instances) {
+      std::string name = instanceName(b->name(), args);
+      if (!std::regex_search(name, filter))
+        continue;
+      if (list) {
+        std::printf("%s\n", name.c_str());
+        continue;
+      }
+      Result r = runner.run(*b, args, name);
+      if (!r.error.empty()) {
+        anyError = true;
+        std::printf("%-44s ERROR: %s\n", name.c_str(), r.error.c_str());
+      } else {
+        std::printf(
+            "%-44s %14s %14s %12lld", name.c_str(), formatTime(r.realNs).c_str(),
+            formatTime(r.cpuNs).c_str(), (long long) r.iterations
+        );
+        if (r.itemsPerSecond)
+          std::printf(" items/s=%.4g", r.itemsPerSecond);
+        for (const auto &[k, v]: r.counters)
+          std::printf(" %s=%.4g", k.c_str(), v);
+        if (!r.label.empty())
+          std::printf(" %s", r.label.c_str());
+        std::printf("\n");
+      }
+      std::fflush(stdout);
+      results.push_back(std::move(r));
+    }
+  }
+
+  if (result.count("json")) {
+    std::ofstream os(result["json"].as<std::string>());
+    if (!os) {
+      std::cerr << "error: cannot open " << result["json"].as<std::string>() << "\n";
+      return 1;
+    }
+    writeJson(os, results, argv[0]);
+  }
+  return anyError ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * A minimal microbenchmark harness with the interface of Google Benchmark
+ * (the subset the suite uses: BENCHMARK()->Arg(), range-for over State,
+ * PauseTiming/ResumeTiming, SetItemsProcessed/SetBytesProcessed, counters,
+ * DoNotOptimize), so that the suite carries no dependency and still reads,
+ * and reports, as a Google Benchmark one. Its JSON output (--json) has
+ * Google Benchmark's schema, for the usual comparison tools.
+ *
+ * Each benchmark runs with 1, then ever more iterations until one run
+ * takes at least --min-time; that run is the one reported.
+ */
+namespace symir::bench {
+
+  class State {
+  public:
+    State(std::vector<int64_t> args, int64_t iterations) :
+        args_(std::move(args)), iterations_(iterations) {}
+
+    // The i-th argument of this instance (Arg(), Args()).
+    int64_t range(std::size_t i = 0) const { return args_.at(i); }
+    int64_t iterations() const { return iterations_; }
+
+    void PauseTiming();
+    void ResumeTiming();
+    void SetItemsProcessed(int64_t n) { items_ = n; }
+    void SetBytesProcessed(int64_t n) { bytes_ = n; }
+    void SetLabel(std::string label) { label_ = std::move(label); }
+    void SkipWithError(std::string message) { error_ = std::move(message); }
+
+    // Reported as is, next to the times.
+    std::map<std::string, double> counters;
+
+    struct Iterator {
+      State *state;
+      int64_t left;
+
+      // Non-trivial, so `for (auto _: state)` does not warn.
+      struct Value {
+        ~Value() {}
+      };
+      Value operator*() const { return {}; }
+      void operator++() { --left; }
+      bool operator!=(const Iterator &) {
+        if (left > 0)
+          return true;
+        state->finish();
+        return false;
+      }
+    };
+    Iterator begin();
+    Iterator end() { return {this, 0}; }
+
+  private:
+    friend struct Runner;
+    void finish();
+
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<int64_t> args_;
+    int64_t iterations_;
+    int64_t items_ = 0, bytes_ = 0;
+    std::string label_, error_;
+
+    bool running_ = false;
+    Clock::time_point realStart_;
+    double cpuStart_ = 0;
+    double realSeconds_ = 0, cpuSeconds_ = 0;
+  };
+
+  using Function = void (*)(State &);
+
+  // A registered benchmark and its argument lists, one instance each.
+  class Benchmark {
+  public:
+    Benchmark(std::string name, Function fn) : name_(std::move(name)), fn_(fn) {}
+
+    Benchmark *Arg(int64_t x) {
+      args_.push_back({x});
+      return this;
+    }
+    Benchmark *Args(std::initializer_list<int64_t> xs) {
+      args_.emplace_back(xs);
+      return this;
+    }
+    // Arg() of lo, lo * mult, ... up to hi (and hi itself).
+    Benchmark *Range(int64_t lo, int64_t hi, int64_t mult = 8);
+
+    const std::string &name() const { return name_; }
+    const std::vector<std::vector<int64_t>> &args() const { return args_; }
+
+  private:
+    friend struct Runner;
+    std::string name_;
+    Function fn_;
+    std::vector<std::vector<int64_t>> args_;
+  };
+
+  Benchmark *registerBenchmark(const char *name, Function fn);
+
+  // Keeps `value` from being optimised away.
+  template<typename T>
+  inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+} // namespace symir::bench
+
+#define SYMIR_BENCH_CONCAT2(a, b) a##b
+#define SYMIR_BENCH_CONCAT(a, b) SYMIR_BENCH_CONCAT2(a, b)
+#define BENCHMARK(fn)                                                                            \
+  [[maybe_unused]] static ::symir::bench::Benchmark *SYMIR_BENCH_CONCAT(                         \
+      benchmark_, __LINE__                                                                       \
+  ) = ::symir::bench::registerBenchmark(#fn, fn)
@@ -0,0 +1,68 @@
+// The frontend over straight-line programs of growing size: lexing,
+// parsing, and each checker on its own.
+
+#include "bench.hpp"
+#include "inputs.hpp"
+
+#include "analysis/pass_manager.hpp"
+#include "frontend/diagnostics.hpp"
+#include "frontend/lexer.hpp"
+#include "frontend/parser.hpp"
+#include "frontend/semchecker.hpp"
+#include "frontend/typechecker.hpp"
+
+using namespace symir;
+using namespace symir::bench;
+
+static void BM_Lex(State &state) {
+  std::string src = straightLineSource((int) state.range(0), false);
+  for (auto _: state) {
+    Lexer lexer(src);
+    int tokens = 0;
+    while (lexer.next().kind != TokenKind::End)
+      tokens++;
+    DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t) src.size());
+}
+BENCHMARK(BM_Lex)->Range(64, 16384);
+
+static void BM_Parse(State &state) {
+  std::string src = straightLineSource((int) state.range(0), false);
+  for (auto _: state) {
+    Lexer lexer(src);
+    Parser parser(lexer);
+    Program prog = parser.parseProgram();
+    DoNotOptimize(prog.funs.size());
+  }
+  state.SetBytesProcessed(state.iterations() * (int64_t) src.size());
+}
+BENCHMARK(BM_Parse)->Range(64, 16384);
+
+// One checker, on a fresh parse each iteration (untimed): the checkers
+// annotate the tree.
+template<typename Checker>
+static void runChecker(State &state) {
+  std::string src = straightLineSource((int) state.range(0), false);
+  for (auto _: state) {
+    state.PauseTiming();
+    Lexer lexer(src);
+    Parser parser(lexer);
+    Program prog = parser.parseProgram();
+    DiagBag diags;
+    PassManager pm(diags);
+    pm.addModulePass(std::make_unique<Checker>());
+    state.ResumeTiming();
+    if (pm.run(prog) == PassResult::Error) {
+      state.SkipWithError("input does not check");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SemChecker(State &state) { runChecker<SemChecker>(state); }
+BENCHMARK(BM_SemChecker)->Range(64, 16384);
+
+static void BM_TypeChecker(State &state) { runChecker<TypeChecker>(state); }
+BENCHMARK(BM_TypeChecker)->Range(64, 16384);
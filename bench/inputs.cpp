@@ -0,0 +1,133 @@
+#include "inputs.hpp"
+
+#include <stdexcept>
+#include "analysis/pass_manager.hpp"
+#include "frontend/diagnostics.hpp"
+#include "frontend/lexer.hpp"
+#include "frontend/parser.hpp"
+#include "frontend/semchecker.hpp"
+#include "frontend/typechecker.hpp"
+
+namespace symir::bench {
+
+  namespace {
+
+    constexpr int kStmtsPerBlock = 16;
+    constexpr int kLocals = 8;
+
+    int numBlocks(int n) { return (n + kStmtsPerBlock - 1) / kStmtsPerBlock; }
+
+    std::string x(int i) { return "%x" + std::to_string(i % kLocals); }
+
+  } // namespace
+
+  std::string straightLineSource(int n, bool symbolic) {
+    std::string s = "fun @main() : i32 {\n";
+    if (symbolic)
+      for (int k = 0; k < 4; k++)
+        s += "  sym %?c" + std::to_string(k) + " : coef i32 in [-8, 8];\n";
+    for (int k = 0; k < kLocals; k++)
+      s += "  let mut " + x(k) + ": i32 = " + std::to_string(k + 1) + ";\n";
+    int blocks = numBlocks(n);
+    for (int b = 0, i = 0; b < blocks; b++) {
+      s += "^b" + std::to_string(b) + ":\n";
+      for (int k = 0; k < kStmtsPerBlock && i < n; k++, i++) {
+        std::string c0 = symbolic ? "%?c" + std::to_string(i % 4) : "1023";
+        std::string c1 = symbolic ? "%?c" + std::to_string((i + 1) % 4) : "7";
+        s += "  " + x(i) + " = " + c0 + " & " + x(i + 1) + " + " + c1 + " ^ " + x(i + 3) + ";\n";
+      }
+      if (b + 1 < blocks)
+        s += "  br ^b" + std::to_string(b + 1) + ";\n";
+      else
+        s += "  ret %x0;\n";
+    }
+    if (blocks == 0)
+      s += "^b0:\n  ret %x0;\n";
+    return s + "}\n";
+  }
+
+  std::vector<std::string> straightLinePath(int n) {
+    std::vector<std::string> path;
+    for (int b = 0; b < std::max(1, numBlocks(n)); b++)
+      path.push_back("^b" + std::to_string(b));
+    return path;
+  }
+
+  static std::string loopKernel(int n, bool pointer) {
+    std::string s = "fun @main() : i32 {\n"
+                    "  let mut %a: [64] i32 = 0;\n";
+    if (pointer)
+      s += "  let mut %p: ptr i32 = null;\n";
+    s += "  let mut %i: i32 = 0;\n"
+         "  let mut %j: i32 = 0;\n"
+         "  let mut %sum: i32 = 0;\n"
+         "  let %n: i32 = " +
+         std::to_string(n) +
+         ";\n"
+         "^entry:\n"
+         "  br ^loop;\n"
+         "^loop:\n"
+         "  br %i < %n, ^body, ^done;\n"
+         "^body:\n"
+         "  %j = 63 & %i;\n";
+    if (pointer)
+      s += "  %p = addr %a[%j];\n"
+           "  store %p, 255 & %i + 3 ^ %j;\n"
+           "  %sum = 65535 & %sum + load %p;\n";
+    else
+      s += "  %a[%j] = 255 & %i + 3 ^ %j;\n"
+           "  %sum = 65535 & %sum + %a[%j];\n";
+    s += "  %i = %i + 1;\n"
+         "  br ^loop;\n"
+         "^done:\n"
+         "  ret %sum;\n"
+         "}\n";
+    return s;
+  }
+
+  std::string loopKernelSource(int n) { return loopKernel(n, false); }
+
+  std::string pointerKernelSource(int n) { return loopKernel(n, true); }
+
+  std::string symbolicIndexSource(int n) {
+    std::string s = "fun @main() : i32 {\n"
+                    "  sym %?i : index i32 in [0, " +
+                    std::to_string(n - 1) +
+                    "];\n"
+                    "  sym %?j : index i32 in [0, " +
+                    std::to_string(n - 1) + "];\n  let mut %a: [" + std::to_string(n) +
+                    "] i32 = {";
+    for (int k = 0; k < n; k++)
+      s += (k ? ", " : "") + std::to_string(3 * k);
+    s += "};\n"
+         "  let mut %r: i32 = 0;\n"
+         "^entry:\n"
+         "  %r = %a[%?i] + %a[%?j];\n"
+         "  require %r == " +
+         std::to_string(3 * (n - 1)) +
+         ", \"the two ends\";\n"
+         "  ret %r;\n"
+         "}\n";
+    return s;
+  }
+
+  std::unique_ptr<CheckedProgram> parseAndCheck(std::string src) {
+    auto checked = std::make_unique<CheckedProgram>();
+    checked->src = std::move(src);
+    Lexer lexer(checked->src);
+    Parser parser(lexer);
+    checked->prog = parser.parseProgram();
+    DiagBag diags;
+    PassManager pm(diags, &checked->analyses);
+    pm.addModulePass(std::make_unique<SemChecker>());
+    pm.addModulePass(std::make_unique<TypeChecker>());
+    if (pm.run(checked->prog) == PassResult::Error) {
+      for (const auto &d: diags.diags)
+        if (d.level == DiagLevel::Error)
+          throw std::runtime_error("benchmark input does not check: " + d.message);
+      throw std::runtime_error("benchmark input does not check");
+    }
+    return checked;
+  }
+
+} // namespace symir::bench
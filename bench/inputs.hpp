@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "analysis/analysis_manager.hpp"
+#include "ast/ast.hpp"
+
+/**
+ * The programs the benchmarks run on, generated as SymIR text at a given
+ * size so that each stage can be timed as its input grows.
+ */
+namespace symir::bench {
+
+  /**
+   * `fun @main() : i32` of `n` assignments over eight i32 locals, 16 to a
+   * block, the blocks chained by `br`. Each is `%xa = 1023 & %xb + 7 ^ %xc`,
+   * so values stay well within i32 whatever `n`. With `symbolic`, the
+   * coefficients are four coef syms in [-8, 8] instead.
+   */
+  std::string straightLineSource(int n, bool symbolic);
+  // Its blocks, in the order they run: the path to solve.
+  std::vector<std::string> straightLinePath(int n);
+
+  // A loop of `n` iterations that updates and sums a [64] i32 array
+  // (within the bytecode engine's subset).
+  std::string loopKernelSource(int n);
+
+  // The same loop, through a pointer: addr, store and load each iteration.
+  std::string pointerKernelSource(int n);
+
+  // Two reads of a dense [n] i32 array at symbolic indices, one `^entry`
+  // block: the solver merges all `n` cells for each.
+  std::string symbolicIndexSource(int n);
+
+  // A parsed and checked program, with the analyses the checkers built.
+  struct CheckedProgram {
+    std::string src;
+    Program prog;
+    AnalysisManager analyses;
+  };
+
+  // Throws std::runtime_error with the first error if `src` does not check.
+  std::unique_ptr<CheckedProgram> parseAndCheck(std::string src);
+
+} // namespace symir::bench
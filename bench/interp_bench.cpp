@@ -0,0 +1,46 @@
+// Interpreter::run on loop kernels: over an array, on either engine, and
+// through a pointer (which the bytecode engine leaves to the AST walker).
+
+#include "bench.hpp"
+#include "inputs.hpp"
+
+#include <sstream>
+#include "interp/interpreter.hpp"
+
+using namespace symir;
+using namespace symir::bench;
+
+static void runKernel(State &state, const std::string &src, Interpreter::Engine engine) {
+  std::unique_ptr<CheckedProgram> checked;
+  try {
+    checked = parseAndCheck(src);
+  } catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  Interpreter interp(checked->prog);
+  interp.setEngine(engine);
+  interp.setAnalysisManager(checked->analyses);
+  std::ostringstream out;
+  interp.setOutput(out);
+  for (auto _: state) {
+    interp.run("@main", {});
+    out.str("");
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0)); // loop iterations
+}
+
+static void BM_InterpLoopBytecode(State &state) {
+  runKernel(state, loopKernelSource((int) state.range(0)), Interpreter::Engine::Bytecode);
+}
+BENCHMARK(BM_InterpLoopBytecode)->Range(64, 32768);
+
+static void BM_InterpLoopAst(State &state) {
+  runKernel(state, loopKernelSource((int) state.range(0)), Interpreter::Engine::Ast);
+}
+BENCHMARK(BM_InterpLoopAst)->Range(64, 32768);
+
+static void BM_InterpPointer(State &state) {
+  runKernel(state, pointerKernelSource((int) state.range(0)), Interpreter::Engine::Bytecode);
+}
+BENCHMARK(BM_InterpPointer)->Range(64, 32768);
@@ -0,0 +1,132 @@
+// SymbolicExecutor::solve, encoding only or solving too. Encoding runs on
+// a null solver: an Smt2Solver whose transport answers `unknown` at once,
+// so every term is built and the query written, but nothing solved.
+
+#include "bench.hpp"
+#include "inputs.hpp"
+
+#include "solver/smt2.hpp"
+#include "solver/solver.hpp"
+#if defined(USE_BITWUZLA)
+#include "solver/bitwuzla_impl.hpp"
+#elif defined(USE_ALIVESMT)
+#include "solver/alive_impl.hpp"
+#endif
+
+using namespace symir;
+using namespace symir::bench;
+
+static SymbolicExecutor::SolverFactory nullSolverFactory() {
+  return [](const SymbolicExecutor::Config &) -> std::unique_ptr<smt::ISolver> {
+    return std::make_unique<solver::Smt2Solver>(
+        [](const std::string &, const std::atomic<bool> &) { return solver::Smt2Answer{}; }
+    );
+  };
+}
+
+static SymbolicExecutor::SolverFactory backendSolverFactory() {
+  return [](const SymbolicExecutor::Config &cfg) -> std::unique_ptr<smt::ISolver> {
+#if defined(USE_BITWUZLA)
+    return std::make_unique<solver::BitwuzlaSolver>(solver::BitwuzlaSolver::Options{
+        cfg.timeout_ms, cfg.seed, cfg.num_smt_threads, cfg.bitwuzla_preprocess,
+        cfg.bitwuzla_rewrite_level
+    });
+#elif defined(USE_ALIVESMT)
+    return std::make_unique<solver::AliveSolver>(cfg.timeout_ms, cfg.seed, cfg.num_smt_threads);
+#else
+    (void) cfg;
+    throw std::runtime_error("No solver backend compiled in");
+#endif
+  };
+}
+
+static void runSolve(
+    State &state, const std::string &src, const std::vector<std::string> &path,
+    SymbolicExecutor::Config cfg, SymbolicExecutor::SolverFactory factory, bool expectSat
+) {
+  std::unique_ptr<CheckedProgram> checked;
+  try {
+    checked = parseAndCheck(src);
+  } catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  cfg.timeout_ms = 60000;
+  cfg.analyses = &checked->analyses;
+  SymbolicExecutor executor(checked->prog, cfg, factory);
+  for (auto _: state) {
+    auto res = executor.solve("@main", path);
+    if (expectSat && !res.sat) {
+      state.SkipWithError("not sat: " + res.message);
+      break;
+    }
+  }
+}
+
+static void BM_SolveEncodeOnly(State &state) {
+  int n = (int) state.range(0);
+  runSolve(
+      state, straightLineSource(n, true), straightLinePath(n), {}, nullSolverFactory(), false
+  );
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SolveEncodeOnly)->Range(16, 1024, 4);
+
+static void BM_SolveFull(State &state) {
+  int n = (int) state.range(0);
+  runSolve(
+      state, straightLineSource(n, true), straightLinePath(n), {}, backendSolverFactory(), true
+  );
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SolveFull)->Range(16, 256, 4);
+
+// Reads at a symbolic index of a dense array merge its cells into one
+// ITE chain (SymbolicExecutor::mergeAggregate); the ITE encoding is forced
+// so that large arrays do not switch to SMT arrays.
+static SymbolicExecutor::Config iteArrays() {
+  SymbolicExecutor::Config cfg;
+  cfg.array_encoding = SymbolicExecutor::Config::ArrayEncoding::Ite;
+  return cfg;
+}
+
+static void BM_MergeAggregateEncode(State &state) {
+  int n = (int) state.range(0);
+  runSolve(state, symbolicIndexSource(n), {"^entry"}, iteArrays(), nullSolverFactory(), false);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_MergeAggregateEncode)->Range(8, 4096);
+
+static void BM_MergeAggregateSolve(State &state) {
+  int n = (int) state.range(0);
+  runSolve(state, symbolicIndexSource(n), {"^entry"}, iteArrays(), backendSolverFactory(), true);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_MergeAggregateSolve)->Range(8, 256);
+
+// Term construction straight on the backend, as with --no-term-builder:
+// per round a literal, an add, a compare and an ITE over the running
+// term, with sorts asked for each time and one request repeated.
+static void BM_BackendBuild(State &state) {
+  int n = (int) state.range(0);
+  auto factory = backendSolverFactory();
+  for (auto _: state) {
+    auto solver = factory({});
+    smt::Term acc = solver->make_const(solver->make_bv_sort(32), "x");
+    for (int i = 0; i < n; i++) {
+      auto s = solver->make_bv_sort(32);
+      auto sum = solver->make_term(
+          smt::Kind::BV_ADD, acc, solver->make_bv_value(s, std::to_string(i), 10)
+      );
+      auto lt = solver->make_term(
+          smt::Kind::BV_SLT, sum, solver->make_bv_value_uint64(s, 7 * (uint64_t) i)
+      );
+      acc = solver->make_term(smt::Kind::ITE, {lt, sum, acc});
+      auto one = solver->make_bv_one(solver->get_sort(acc));
+      DoNotOptimize(solver->make_term(smt::Kind::BV_SUB, acc, one));
+      DoNotOptimize(solver->make_term(smt::Kind::BV_SUB, acc, one));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_BackendBuild)->Range(64, 4096);
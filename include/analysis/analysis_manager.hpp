@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "analysis/cfg.hpp"
+#include "analysis/liveness.hpp"
+#include "analysis/loops.hpp"
+#include "analysis/ssa.hpp"
+#include "analysis/sym_prefix.hpp"
+#include "ast/ast.hpp"
+#include "frontend/diagnostics.hpp"
+
+namespace symir {
+
+  /**
+   * Per-function analysis cache shared by the passes, the interpreter and
+   * the symbolic executor: each result below is computed from the
+   * function's CFG the first time it is asked for and kept until the
+   * function is invalidated, so a tool builds each CFG once however many
+   * consumers it has.
+   *
+   * Entries are keyed by the FunDecl's address, so a manager serves one
+   * Program at a time; invalidate() a function that a pass rewrites, and
+   * clear() before the functions seen are freed or moved. Lookups are
+   * thread-safe. A returned reference stays valid until its function is
+   * invalidated.
+   */
+  class AnalysisManager {
+  public:
+    /// The CFG of `f`. The diagnostics of building it (unknown or duplicate
+    /// labels) are appended to `diags` on every call, as CFG::build does.
+    const CFG &cfg(const FunDecl &f, DiagBag &diags);
+    /// The CFG of `f`, or nullptr if building it reported errors.
+    const CFG *validCfg(const FunDecl &f);
+
+    /// CFG::rpo().
+    const std::vector<std::size_t> &rpo(const FunDecl &f);
+    /// CFG::dominators().
+    const std::vector<std::size_t> &dominators(const FunDecl &f);
+    /// CFG::postDominators().
+    const std::vector<std::size_t> &postDominators(const FunDecl &f);
+    /// The dominator tree of dominators().
+    const DomTree &domTree(const FunDecl &f);
+    /// The post-dominator tree of postDominators(), rooted at the virtual
+    /// exit.
+    const DomTree &postDomTree(const FunDecl &f);
+    /// LoopNest::build() over domTree().
+    const LoopNest &loops(const FunDecl &f);
+    /// CFG::reachSets().
+    const std::vector<BitVector> &reachSets(const FunDecl &f);
+    /// CFG::canReachRet().
+    const BitVector &canReachRet(const FunDecl &f);
+    /// CFG::shortestPathToRet().
+    const std::unordered_map<std::size_t, std::size_t> &shortestPathToRet(const FunDecl &f);
+    /// Per block: 1 if it is reachable from the entry block.
+    const std::vector<char> &reachable(const FunDecl &f);
+    /// Live locals per block; only meaningful when validCfg(f) is non-null.
+    const Liveness &liveness(const FunDecl &f);
+    /// Pruned SSA form of the scalar locals; only meaningful when
+    /// validCfg(f) is non-null.
+    const SSAForm &ssa(const FunDecl &f);
+    /// Where the symbol-independent prefix of runs of `f` ends.
+    const SymPrefix &symPrefix(const FunDecl &f);
+
+    /// Takes `cfg` as the CFG of `f`, built without diagnostics (e.g. one
+    /// loaded along with `f`), unless `f` already has one.
+    void adopt(const FunDecl &f, CFG cfg);
+
+    /// The CFG of a function with what is derived from its edges and ret
+    /// blocks alone: the orders and dominator trees, the loop nest with its
+    /// back edges, and the paths to ret. Functions with the same blocks and
+    /// edges, such as the inits rysmith generates for one path, may share
+    /// one. Nothing here depends on the instructions.
+    struct Shape {
+      CFG cfg;
+      std::vector<std::size_t> rpo, dominators, postDominators;
+      DomTree domTree, postDomTree;
+      LoopNest loops;
+      std::unordered_map<std::size_t, std::size_t> toRet;
+      BitVector canReachRet;
+      std::vector<char> reachable;
+    };
+    /// The shape of `f`, or nullopt if building its CFG reported errors.
+    std::optional<Shape> shape(const FunDecl &f);
+    /// Takes `shape` as the CFG of `f` and the analyses of it, as adopt()
+    /// does, unless `f` already has a CFG.
+    void adoptShape(const FunDecl &f, const Shape &shape);
+
+    /// Drops everything cached for `f`.
+    void invalidate(const FunDecl &f);
+    /// Drops everything.
+    void clear();
+
+  private:
+    struct Entry {
+      std::mutex mu; // guards the fields below
+      bool built = false;
+      CFG cfg;
+      std::vector<Diagnostic> diags; // of CFG::build
+      std::optional<std::vector<std::size_t>> rpo, dominators, postDominators;
+      std::optional<std::unordered_map<std::size_t, std::size_t>> toRet;
+      std::optional<std::vector<char>> reachable;
+      std::optional<DomTree> domTree, postDomTree;
+      std::optional<LoopNest> loops;
+      std::optional<std::vector<BitVector>> reachSets;
+      std::optional<BitVector> canReachRet;
+      std::optional<Liveness> liveness;
+      std::optional<SSAForm> ssa;
+      std::optional<SymPrefix> symPrefix;
+    };
+
+    // The entry for `f` with its CFG built, locked by `lock`.
+    Entry &entry(const FunDecl &f, std::unique_lock<std::mutex> &lock);
+
+    std::mutex mu_; // guards entries_
+    std::unordered_map<const FunDecl *, std::unique_ptr<Entry>> entries_;
+  };
+
+} // namespace symir
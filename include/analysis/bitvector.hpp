@@ -0,0 +1,105 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace symir {
+
+  /**
+   * A fixed-size dense bit set, the state of bit-vector dataflow problems
+   * (one bit per local). The set operations work a word at a time and in
+   * place; those that a solver iterates on report whether they changed
+   * anything.
+   */
+  class BitVector {
+  public:
+    BitVector() = default;
+    explicit BitVector(std::size_t size, bool value = false)
+        : size_(size), words_((size + 63) / 64, value ? ~std::uint64_t(0) : 0) {
+      clearTail();
+    }
+
+    std::size_t size() const { return size_; }
+
+    bool test(std::size_t i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+    void set(std::size_t i) { words_[i / 64] |= std::uint64_t(1) << (i % 64); }
+    void reset(std::size_t i) { words_[i / 64] &= ~(std::uint64_t(1) << (i % 64)); }
+    void set(std::size_t i, bool value) { value ? set(i) : reset(i); }
+
+    void setAll() {
+      for (auto &w: words_)
+        w = ~std::uint64_t(0);
+      clearTail();
+    }
+    void resetAll() {
+      for (auto &w: words_)
+        w = 0;
+    }
+
+    /// this |= other; true if a bit was added.
+    bool unionWith(const BitVector &other) {
+      std::uint64_t changed = 0;
+      for (std::size_t k = 0; k < words_.size(); ++k) {
+        std::uint64_t w = words_[k] | other.words_[k];
+        changed |= w ^ words_[k];
+        words_[k] = w;
+      }
+      return changed != 0;
+    }
+
+    /// this &= other; true if a bit was removed.
+    bool intersectWith(const BitVector &other) {
+      std::uint64_t changed = 0;
+      for (std::size_t k = 0; k < words_.size(); ++k) {
+        std::uint64_t w = words_[k] & other.words_[k];
+        changed |= w ^ words_[k];
+        words_[k] = w;
+      }
+      return changed != 0;
+    }
+
+    /// this &= ~other.
+    void subtract(const BitVector &other) {
+      for (std::size_t k = 0; k < words_.size(); ++k)
+        words_[k] &= ~other.words_[k];
+    }
+
+    bool any() const {
+      for (auto w: words_)
+        if (w)
+          return true;
+      return false;
+    }
+
+    std::size_t count() const {
+      std::size_t n = 0;
+      for (auto w: words_)
+        n += std::popcount(w);
+      return n;
+    }
+
+    /// Calls `fn(i)` for every set bit, in increasing order.
+    template<typename Fn>
+    void forEach(Fn &&fn) const {
+      for (std::size_t k = 0; k < words_.size(); ++k)
+        for (std::uint64_t w = words_[k]; w; w &= w - 1)
+          fn(k * 64 + std::countr_zero(w));
+    }
+
+    bool operator==(const BitVector &other) const = default;
+
+  private:
+    // Keeps the bits past size_ clear, so equality and count can compare
+    // whole words.
+    void clearTail() {
+      if (size_ % 64)
+        words_.back() &= (std::uint64_t(1) << (size_ % 64)) - 1;
+    }
+
+    std::size_t size_ = 0;
+    std::vector<std::uint64_t> words_;
+  };
+
+} // namespace symir
@@ -3,6 +3,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "analysis/bitvector.hpp"
 #include "ast/ast.hpp"
 #include "frontend/diagnostics.hpp"
 
@@ -18,7 +19,7 @@ namespace symir {
     // List of block labels in the order they appear in the function.
     std::vector<std::string> blocks;
     // Mapping from block label to its index in the 'blocks' vector.
-    std::unordered_map<std::string, std::size_t> indexOf;
+    std::unordered_map<Symbol, std::size_t> indexOf;
 
     // Adjacency lists representing the edges between blocks (using indices).
     std::vector<std::vector<std::size_t>> succ;
@@ -30,7 +31,7 @@ namespace symir {
     /**
      * Helper to get a string key for a block label.
      */
-    static std::string labelKey(const BlockLabel &b) { return b.name; }
+    static Symbol labelKey(const BlockLabel &b) { return b.name; }
 
     /**
      * Builds the CFG for a given function declaration.
@@ -49,6 +50,33 @@ namespace symir {
      * Returns a map from block index to the index of the next block in the shortest path.
      */
     std::unordered_map<std::size_t, std::size_t> shortestPathToRet(const FunDecl &f) const;
+
+    /**
+     * Computes the immediate dominator of every block. The entry block maps
+     * to itself; blocks not reachable from the entry map to SIZE_MAX.
+     */
+    std::vector<std::size_t> dominators() const;
+
+    /**
+     * Computes the immediate post-dominator of every block. Blocks without
+     * successors (ret/unreachable) flow into a virtual exit, written as
+     * `blocks.size()`; blocks from which no exit is reachable map to
+     * SIZE_MAX.
+     */
+    std::vector<std::size_t> postDominators() const;
+
+    /**
+     * Computes, per block, the blocks reachable from it along one or more
+     * edges: a block is in its own set exactly when it lies on a cycle.
+     */
+    std::vector<BitVector> reachSets() const;
+
+    /**
+     * Computes the blocks from which a block ending with 'ret' is reachable
+     * (the 'ret' blocks included): the keys of shortestPathToRet() and the
+     * 'ret' blocks, as a bit set.
+     */
+    BitVector canReachRet(const FunDecl &f) const;
   };
 
 } // namespace symir
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
 #include <vector>
 #include "analysis/cfg.hpp"
 
 namespace symir {
 
   /**
-   * Generic interface for a Forward Dataflow Problem.
+   * Generic interface for a dataflow problem, solved by DataflowSolver.
+   * Problems are forward unless they declare a backward `direction`.
    * @tparam State The type representing the dataflow information (e.g., bitset, map).
    */
   template<typename State>
@@ -20,7 +27,8 @@ namespace symir {
     virtual State bottom() = 0;
 
     /**
-     * The state at the start of the entry block.
+     * The state at the start of the entry block (for backward problems:
+     * at the end of every block without successors).
      */
     virtual State entryState() = 0;
 
@@ -38,14 +46,82 @@ namespace symir {
      * Checks if two dataflow states are equal.
      */
     virtual bool equal(const State &lhs, const State &rhs) = 0;
+
+    /**
+     * The state flowing along the edge from `block` to its successor `to`,
+     * given the block's 'out' state. Defaults to `out`; edge-sensitive
+     * problems refine it by the branch condition.
+     */
+    virtual State edge(const Block &block, const std::string &to, const State &out) {
+      (void) block;
+      (void) to;
+      return out;
+    }
+
+    /**
+     * Combines the previous and the new 'in' state of a loop header (a
+     * block entered by a retreating edge). Problems whose lattice has
+     * infinite ascending chains override it to force termination.
+     */
+    virtual State widen(const State &prev, const State &next) {
+      (void) prev;
+      return next;
+    }
   };
 
   /**
-   * Worklist-based iterative solver for forward dataflow problems.
+   * The direction a dataflow problem propagates in. A problem picks backward
+   * by declaring `static constexpr DataflowDirection direction =
+   * DataflowDirection::Backward;`; forward is the default.
+   */
+  enum class DataflowDirection { Forward, Backward };
+
+  /**
+   * What DataflowSolver needs from a problem. Problems deriving from
+   * DataflowProblem satisfy it through the virtual interface; a problem can
+   * instead provide the members directly, without virtual dispatch, and
+   * replace `meet` and `transfer` by in-place forms that the solver then
+   * prefers:
+   *   - `void meetInto(State &acc, const State &in)` for acc = meet(acc, in);
+   *   - `void transferInto(const Block &block, State &state)` for
+   *     state = transfer(block, state).
+   * `equal`, `edge` and `widen` are optional; without them states are
+   * compared with `==` and edges and loop headers pass states unchanged.
+   */
+  template<typename P, typename State>
+  concept DataflowProblemFor =
+      requires(P &p) {
+        { p.bottom() } -> std::convertible_to<State>;
+        { p.entryState() } -> std::convertible_to<State>;
+      } &&
+      (requires(P &p, State &acc, const State &in) { p.meetInto(acc, in); } ||
+       requires(P &p, const State &a, const State &b) {
+         { p.meet(a, b) } -> std::convertible_to<State>;
+       }) &&
+      (requires(P &p, const Block &b, State &s) { p.transferInto(b, s); } ||
+       requires(P &p, const Block &b, const State &in) {
+         { p.transfer(b, in) } -> std::convertible_to<State>;
+       });
+
+  /**
+   * Worklist-based iterative solver for forward and backward dataflow
+   * problems.
+   *
+   * Blocks reachable from the entry are visited in reverse postorder
+   * (postorder for backward problems), and after the first sweep only the
+   * dependents of blocks whose result changed are revisited. The problem
+   * type is a template parameter, so a `final` or non-virtual problem is
+   * called directly.
    */
   template<typename State>
   class DataflowSolver {
   public:
+    /**
+     * Per block, `in` is the state at its first instruction and `out` the
+     * state after its terminator, whatever the direction: a forward problem
+     * meets into `in` and transfers to `out`, a backward one meets into
+     * `out` and transfers to `in`.
+     */
     struct Result {
       std::vector<State> in;
       std::vector<State> out;
@@ -53,37 +129,123 @@ namespace symir {
 
     /**
      * Solves the dataflow problem on a given function.
+     *
+     * `entryState()` seeds the entry block of a forward problem and every
+     * block without successors (`ret`, `unreachable`) of a backward one.
+     * `edge(block, to, state)` is called per CFG edge `block -> to` with
+     * the state of the block the information comes from.
      */
-    static Result solve(const FunDecl &f, const CFG &cfg, DataflowProblem<State> &problem) {
+    template<typename Problem>
+      requires DataflowProblemFor<Problem, State>
+    static Result solve(const FunDecl &f, const CFG &cfg, Problem &problem) {
+      constexpr bool forward = direction<Problem>() == DataflowDirection::Forward;
       size_t numBlocks = cfg.blocks.size();
       Result res;
       res.in.assign(numBlocks, problem.bottom());
       res.out.assign(numBlocks, problem.bottom());
+      if (numBlocks == 0)
+        return res;
 
-      res.in[cfg.entry] = problem.entryState();
-
-      std::vector<size_t> rpo = cfg.rpo();
-      bool changed = true;
-      while (changed) {
-        changed = false;
-        for (size_t idx: rpo) {
-          if (idx != cfg.entry && !cfg.pred[idx].empty()) {
-            State meetState = res.out[cfg.pred[idx][0]];
-            for (size_t i = 1; i < cfg.pred[idx].size(); ++i) {
-              meetState = problem.meet(meetState, res.out[cfg.pred[idx][i]]);
-            }
-            res.in[idx] = meetState;
-          }
+      // joined: the meet over the sources; computed: the transfer of it.
+      std::vector<State> &joined = forward ? res.in : res.out;
+      std::vector<State> &computed = forward ? res.out : res.in;
+      const auto &sources = forward ? cfg.pred : cfg.succ;
+      const auto &dependents = forward ? cfg.succ : cfg.pred;
+
+      if constexpr (forward)
+        res.in[cfg.entry] = problem.entryState();
+
+      std::vector<size_t> order = cfg.rpo();
+      if constexpr (!forward)
+        std::reverse(order.begin(), order.end());
+      std::vector<size_t> pos(numBlocks, numBlocks);
+      for (size_t k = 0; k < order.size(); ++k)
+        pos[order[k]] = k;
+      // Blocks entered by a retreating edge of the visiting order.
+      std::vector<bool> header(numBlocks, false);
+      for (size_t idx: order)
+        for (size_t s: sources[idx])
+          if (pos[s] >= pos[idx] && pos[s] < numBlocks)
+            header[idx] = true;
+
+      auto incoming = [&](size_t s, size_t idx) -> State {
+        if constexpr (requires(const std::string &to) { problem.edge(f.blocks[s], to, computed[s]); }) {
+          if constexpr (forward)
+            return problem.edge(f.blocks[s], cfg.blocks[idx], computed[s]);
+          else
+            return problem.edge(f.blocks[idx], cfg.blocks[s], computed[s]);
+        } else {
+          return computed[s];
+        }
+      };
+      auto meetInto = [&](State &acc, const State &in) {
+        if constexpr (requires { problem.meetInto(acc, in); })
+          problem.meetInto(acc, in);
+        else
+          acc = problem.meet(acc, in);
+      };
+      auto equal = [&](const State &lhs, const State &rhs) -> bool {
+        if constexpr (requires { problem.equal(lhs, rhs); })
+          return problem.equal(lhs, rhs);
+        else
+          return lhs == rhs;
+      };
+
+      // Min-heap of positions in `order`, so the worklist drains in order.
+      std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> work;
+      std::vector<bool> queued(numBlocks, false);
+      for (size_t k = 0; k < order.size(); ++k) {
+        work.push(k);
+        queued[order[k]] = true;
+      }
+
+      State next = problem.bottom();
+      while (!work.empty()) {
+        size_t idx = order[work.top()];
+        work.pop();
+        queued[idx] = false;
 
-          State newOut = problem.transfer(f.blocks[idx], res.in[idx]);
-          if (!problem.equal(res.out[idx], newOut)) {
-            res.out[idx] = newOut;
-            changed = true;
+        // The entry of a forward problem joins loops back to it with the
+        // entry state; so do the exits of a backward one, which have no
+        // sources at all.
+        bool boundary = forward ? idx == cfg.entry : sources[idx].empty();
+        if (boundary || !sources[idx].empty()) {
+          State meetState = boundary ? State(problem.entryState()) : incoming(sources[idx][0], idx);
+          for (size_t i = boundary ? 0 : 1; i < sources[idx].size(); ++i)
+            meetInto(meetState, incoming(sources[idx][i], idx));
+          if constexpr (requires { problem.widen(joined[idx], meetState); }) {
+            if (header[idx])
+              meetState = problem.widen(joined[idx], meetState);
           }
+          joined[idx] = std::move(meetState);
+        }
+
+        if constexpr (requires { problem.transferInto(f.blocks[idx], next); }) {
+          next = joined[idx];
+          problem.transferInto(f.blocks[idx], next);
+        } else {
+          next = problem.transfer(f.blocks[idx], joined[idx]);
         }
+        if (equal(computed[idx], next))
+          continue;
+        std::swap(computed[idx], next);
+        for (size_t d: dependents[idx])
+          if (pos[d] < numBlocks && !queued[d]) {
+            work.push(pos[d]);
+            queued[d] = true;
+          }
       }
       return res;
     }
+
+  private:
+    template<typename Problem>
+    static constexpr DataflowDirection direction() {
+      if constexpr (requires { Problem::direction; })
+        return Problem::direction;
+      else
+        return DataflowDirection::Forward;
+    }
   };
 
 } // namespace symir
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include "analysis/bitvector.hpp"
 #include "analysis/dataflow.hpp"
 #include "analysis/pass_manager.hpp"
 
@@ -18,28 +19,34 @@ namespace symir {
     /**
      * Executes the analysis on the function.
      */
-    symir::PassResult run(FunDecl &f, DiagBag &diags) override;
+    symir::PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
 
   private:
-    using InitSet = std::unordered_map<std::string, bool>;
+    // One bit per let (indices into FunDecl::lets): set if initialized.
+    using InitSet = BitVector;
 
     /**
-     * Dataflow problem definition for definite initialization.
-     * The state is a map from variable name to a boolean (is initialized).
+     * Dataflow problem definition for definite initialization. Lets start
+     * out initialized everywhere but at the entry, and a block's state is
+     * the intersection over its predecessors.
      */
-    class Problem : public symir::DataflowProblem<InitSet> {
+    class Problem final {
     public:
-      Problem(const FunDecl &f, DiagBag &diags);
+      explicit Problem(const FunDecl &f);
 
-      InitSet bottom() override;
-      InitSet entryState() override;
-      InitSet meet(const InitSet &lhs, const InitSet &rhs) override;
-      InitSet transfer(const Block &block, const InitSet &in) override;
-      bool equal(const InitSet &lhs, const InitSet &rhs) override;
+      InitSet bottom();
+      InitSet entryState();
+      void meetInto(InitSet &acc, const InitSet &in);
+      void transferInto(const Block &block, InitSet &state);
+
+      // Runs `block` from `in` and reports its reads of uninitialized lets.
+      void check(const Block &block, const InitSet &in, DiagBag &diags);
 
     private:
+      void run(const Block &block, InitSet &state, DiagBag *diags);
+
       const FunDecl &f_;
-      DiagBag &diags_;
+      std::unordered_map<Symbol, std::size_t> index_; // let -> bit
     };
   };
 
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "analysis/dataflow.hpp"
+
+namespace symir {
+
+  /**
+   * Interval abstract interpretation of the integer scalars of a function.
+   *
+   * Every integer sym, param and let whose address is never taken is given
+   * a signed interval. Syms start from their domain (and a fixed value, if
+   * any), params and `undef` from their type's range. Assignments are
+   * evaluated through the flat `Expr` forms; `assume`, `require` and the
+   * branch condition of each edge taken narrow the variables they compare,
+   * and a condition that cannot hold makes the state unreachable.
+   *
+   * Signed overflow, division by zero and overshifts are UB and the solver
+   * rejects every path that has them, so results may be computed in exact
+   * arithmetic and cut back to the type's range. Floats, pointers, vectors,
+   * aggregates, loads and casts are not tracked.
+   *
+   * The analysis runs over one path (onPath(), cheap enough for every
+   * solve) or over the whole CFG to find edges no path can take and the
+   * range of each variable used as an index where it is used.
+   */
+  class IntervalAnalysis {
+  public:
+    struct Interval {
+      int64_t lo = INT64_MIN;
+      int64_t hi = INT64_MAX;
+
+      bool empty() const { return lo > hi; }
+      bool operator==(const Interval &other) const = default;
+    };
+
+    using FixedSyms = std::unordered_map<std::string, int64_t>;
+
+    struct PathResult {
+      // Some condition on the path can never hold: the path is UNSAT.
+      bool infeasible = false;
+      // Syms whose range the path narrowed, with the narrowed range; valid
+      // for every model of the path and only meaningful if feasible.
+      std::unordered_map<std::string, Interval> syms;
+    };
+
+    /**
+     * Runs along `path` (block labels from the entry). Following a label
+     * that is not a successor is left to the solver to reject; unknown
+     * labels throw.
+     */
+    static PathResult
+    onPath(const FunDecl &f, const CFG &cfg, const std::vector<std::string> &path,
+           const FixedSyms &fixedSyms = {});
+
+    /**
+     * Runs over the whole CFG, widening at loop headers.
+     */
+    IntervalAnalysis(const FunDecl &f, const CFG &cfg, const FixedSyms &fixedSyms = {});
+
+    // False when no execution can go from block `from` to block `to`
+    // (indices into the CFG).
+    bool feasible(std::size_t from, std::size_t to) const;
+
+    /**
+     * The range of the variable `index` reads (an array, vector lane or
+     * `ptrindex` index in the function body) wherever it is read; null for
+     * literal and untracked indices and for sites in unreachable blocks.
+     */
+    const Interval *range(const Index &index) const {
+      auto it = sites_.find(&index);
+      return it == sites_.end() ? nullptr : &it->second;
+    }
+
+  private:
+    struct State {
+      bool reachable = false;
+      std::vector<Interval> vals; // per slot: syms, then params, then lets
+    };
+
+    class Problem final : public symir::DataflowProblem<State> {
+    public:
+      Problem(const FunDecl &f, const FixedSyms &fixedSyms);
+
+      State bottom() override;
+      State entryState() override;
+      State meet(const State &lhs, const State &rhs) override;
+      State transfer(const Block &block, const State &in) override;
+      bool equal(const State &lhs, const State &rhs) override;
+      State edge(const Block &block, const std::string &to, const State &out) override;
+      State widen(const State &prev, const State &next) override;
+
+      // Runs `block` from `in` and records the range of each index it reads.
+      void record(const Block &block, const State &in,
+                  std::unordered_map<const Index *, Interval> &sites);
+
+    private:
+      State run(const Block &block, const State &in,
+                std::unordered_map<const Index *, Interval> *sites);
+
+      const FunDecl &f_;
+      const FixedSyms &fixed_;
+      std::unordered_map<std::string, std::size_t> index_; // sym, param or let -> slot
+      std::vector<int> bits_;     // per slot: integer width, 0 for other types
+      std::vector<bool> tracked_; // per slot: integer scalar, never addressed
+    };
+
+    std::vector<std::vector<std::size_t>> dead_; // per block: successors never taken
+    std::unordered_map<const Index *, Interval> sites_;
+  };
+
+} // namespace symir
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "analysis/bitvector.hpp"
+#include "analysis/dataflow.hpp"
+
+namespace symir {
+
+  /**
+   * Live-variable analysis over the `let` locals and params of a function,
+   * solved backward over bit vectors.
+   *
+   * A local is live at a point if some path from it reads the local before
+   * assigning it as a whole; element and field assignments write only part
+   * of it and do not end its liveness. A let whose address is taken may be
+   * read through a pointer anywhere, so it is live throughout.
+   */
+  class Liveness {
+  public:
+    Liveness(const FunDecl &f, const CFG &cfg);
+
+    /// The bit of a local: lets first (as in FunDecl::lets), then params;
+    /// SIZE_MAX for any other name.
+    std::size_t slot(Symbol name) const {
+      auto it = index_.find(name);
+      return it == index_.end() ? SIZE_MAX : it->second;
+    }
+    std::size_t numSlots() const { return numSlots_; }
+
+    /// Locals live at the start and at the end of a block. Blocks not
+    /// reachable from the entry have nothing live.
+    const BitVector &liveIn(std::size_t block) const { return in_[block]; }
+    const BitVector &liveOut(std::size_t block) const { return out_[block]; }
+
+    bool isLiveIn(std::size_t block, Symbol name) const {
+      std::size_t k = slot(name);
+      return k != SIZE_MAX && in_[block].test(k);
+    }
+    bool isLiveOut(std::size_t block, Symbol name) const {
+      std::size_t k = slot(name);
+      return k != SIZE_MAX && out_[block].test(k);
+    }
+
+    /// Whether the address of the local in `slot` is taken somewhere.
+    bool isAddressed(std::size_t slot) const { return addressed_.test(slot); }
+
+  private:
+    class Problem final {
+    public:
+      static constexpr DataflowDirection direction = DataflowDirection::Backward;
+
+      Problem(
+          const FunDecl &f, const std::vector<BitVector> &gen, const std::vector<BitVector> &kill,
+          std::size_t numSlots
+      )
+          : f_(f), gen_(gen), kill_(kill), numSlots_(numSlots) {}
+
+      BitVector bottom() { return BitVector(numSlots_); }
+      BitVector entryState() { return BitVector(numSlots_); }
+      void meetInto(BitVector &acc, const BitVector &in) { acc.unionWith(in); }
+      void transferInto(const Block &block, BitVector &state);
+
+    private:
+      const FunDecl &f_;
+      const std::vector<BitVector> &gen_;  // per block: read before assigned
+      const std::vector<BitVector> &kill_; // per block: assigned as a whole
+      std::size_t numSlots_;
+    };
+
+    std::unordered_map<Symbol, std::size_t> index_;
+    std::size_t numSlots_ = 0;
+    std::vector<BitVector> in_, out_;
+    BitVector addressed_;
+  };
+
+} // namespace symir
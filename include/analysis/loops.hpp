@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "analysis/bitvector.hpp"
+#include "analysis/cfg.hpp"
+
+namespace symir {
+
+  /**
+   * A dominator (or post-dominator) tree, from the immediate dominators
+   * CFG::dominators() or CFG::postDominators() computes. Dominance queries
+   * are O(1): a node dominates exactly the nodes numbered between its
+   * entry and exit in a depth-first walk of the tree.
+   */
+  struct DomTree {
+    static constexpr std::size_t npos = SIZE_MAX;
+
+    std::size_t root = npos; // the entry, or the virtual exit of postDominators()
+    std::vector<std::size_t> idom;
+    std::vector<std::vector<std::size_t>> children;
+    // Per node: entry and exit number of the walk, depth below the root;
+    // npos for nodes not in the tree (unreachable from the root).
+    std::vector<std::size_t> pre, post, depth;
+
+    DomTree() = default;
+    /// Takes `idom` indexed by node, with `idom[root] == root` (or, for
+    /// post-dominators, `root == idom.size()` for the virtual exit).
+    DomTree(std::vector<std::size_t> idom, std::size_t root);
+
+    bool contains(std::size_t b) const { return b < pre.size() && pre[b] != npos; }
+    /// True if `a` dominates `b`; every node in the tree dominates itself.
+    bool dominates(std::size_t a, std::size_t b) const {
+      return contains(a) && contains(b) && pre[a] <= pre[b] && post[b] <= post[a];
+    }
+  };
+
+  /**
+   * The loop-nest forest of a CFG, with every edge classified by a
+   * depth-first walk from the entry.
+   *
+   * A back edge whose target dominates its source closes a natural loop:
+   * the target is the header, and the loop is the header with every block
+   * that reaches the edge's source without passing through it. Back edges
+   * to the same header form one loop. A back edge whose target does not
+   * dominate its source makes the CFG irreducible; it forms no loop.
+   */
+  struct LoopNest {
+    static constexpr std::size_t npos = SIZE_MAX;
+
+    // Tree: first visit of the target. Forward: to a descendant already
+    // visited. Back: to an ancestor, or the block itself. Cross: anything
+    // else, including every edge out of a block the walk does not reach.
+    enum class EdgeKind : std::uint8_t { Tree, Forward, Back, Cross };
+
+    struct Loop {
+      std::size_t header;
+      std::size_t parent = npos; // innermost enclosing loop
+      std::uint32_t depth = 1;   // 1 for an outermost loop
+      BitVector blocks;          // the header and the blocks of nested loops included
+      std::vector<std::size_t> latches; // sources of the back edges to the header
+    };
+
+    std::vector<Loop> loops; // every loop before the loops nested in it
+    std::vector<std::size_t> innermost;          // per block; npos outside of every loop
+    std::vector<std::vector<EdgeKind>> edgeKind; // parallel to CFG::succ
+    bool reducible = true;
+
+    static LoopNest build(const CFG &cfg, const DomTree &dom);
+
+    /// Number of loops around `b`, 0 outside of every loop.
+    std::uint32_t depth(std::size_t b) const {
+      return innermost[b] == npos ? 0 : loops[innermost[b]].depth;
+    }
+    bool isHeader(std::size_t b) const {
+      return innermost[b] != npos && loops[innermost[b]].header == b;
+    }
+    /// The `k`-th edge out of `from` (CFG::succ[from][k]) is a back edge.
+    bool isBackEdge(std::size_t from, std::size_t k) const {
+      return edgeKind[from][k] == EdgeKind::Back;
+    }
+  };
+
+} // namespace symir
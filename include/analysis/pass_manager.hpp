@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
+#include "analysis/analysis_manager.hpp"
 #include "ast/ast.hpp"
 #include "frontend/diagnostics.hpp"
 
@@ -24,6 +26,12 @@ namespace symir {
   public:
     virtual ~Pass() = default;
     virtual std::string name() const = 0;
+
+    /**
+     * False for a pass that rewrites the IR: the manager then drops the
+     * cached analyses of what it ran on.
+     */
+    virtual bool preservesAnalyses() const { return true; }
   };
 
   /**
@@ -31,7 +39,16 @@ namespace symir {
    */
   class ModulePass : public Pass {
   public:
-    virtual PassResult run(Program &prog, DiagBag &diags) = 0;
+    virtual PassResult run(Program &prog, DiagBag &diags, AnalysisManager &am) = 0;
+
+  protected:
+    /// Threads the pass may spread its per-function work over (see
+    /// forEachFunction()); set by the PassManager running it.
+    unsigned numThreads() const { return numThreads_; }
+
+  private:
+    friend class PassManager;
+    unsigned numThreads_ = 1;
   };
 
   /**
@@ -39,15 +56,39 @@ namespace symir {
    */
   class FunctionPass : public Pass {
   public:
-    virtual PassResult run(FunDecl &fun, DiagBag &diags) = 0;
+    virtual PassResult run(FunDecl &fun, DiagBag &diags, AnalysisManager &am) = 0;
   };
 
+  /**
+   * Runs fn(i, diags) for every function index i in [0, n) on up to
+   * `threads` threads. Each call reports into a DiagBag of its own, and
+   * the bags are appended to `diags` in index order once all calls have
+   * returned, so the diagnostics read as in a serial run whatever the
+   * scheduling. If calls throw, the bags before the lowest throwing index
+   * are merged and its exception is rethrown. With one thread (or one
+   * function) fn runs on the caller and reports into `diags` directly.
+   *
+   * The emitters (CBackend, WasmBackend, SIRPrinter) render with it the
+   * same way: each call writes one function into a buffer of its own
+   * through a worker copy of the emitter that shares only read-only
+   * settings, and the caller joins the buffers in index order, so the
+   * output is byte for byte that of one thread.
+   */
+  void forEachFunction(
+      std::size_t n, unsigned threads, DiagBag &diags,
+      const std::function<void(std::size_t, DiagBag &)> &fn
+  );
+
   /**
    * Orchestrates the execution of a series of compiler passes.
+   *
+   * The passes share one AnalysisManager: the manager's own, or the one
+   * given, which the tool can then hand on to the interpreter or solver.
    */
   class PassManager {
   public:
-    explicit PassManager(DiagBag &diags) : diags_(diags) {}
+    explicit PassManager(DiagBag &diags, AnalysisManager *am = nullptr) :
+        diags_(diags), am_(am ? am : &ownAm_) {}
 
     /**
      * Registers a module-level pass.
@@ -62,13 +103,32 @@ namespace symir {
      */
     void addFunctionPass(std::unique_ptr<FunctionPass> pass);
 
+    /**
+     * Lets the passes check up to `n` functions at a time (0 means one per
+     * hardware thread). Diagnostics keep the serial order.
+     */
+    void setNumThreads(unsigned n);
+
     /**
      * Executes all registered passes on the program in the order they were added.
      */
     PassResult run(Program &prog);
 
+    /// The analysis cache the passes use.
+    AnalysisManager &analyses() { return *am_; }
+
+    /// The bag the passes report into.
+    DiagBag &diags() { return diags_; }
+
+    /// The names of the registered passes, in order: what a module checked
+    /// by this manager has been checked for.
+    std::string pipeline() const;
+
   private:
     DiagBag &diags_;
+    AnalysisManager ownAm_;
+    AnalysisManager *am_;
+    unsigned numThreads_ = 1;
     std::vector<std::unique_ptr<ModulePass>> modulePasses_;
   };
 
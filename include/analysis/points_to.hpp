@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "analysis/dataflow.hpp"
+
+namespace symir {
+
+  /**
+   * Flow-sensitive may-points-to analysis over the `let` locals of a function.
+   *
+   * SymIR pointers are only created by `addr`, and pointer arithmetic,
+   * `ptrindex` and `ptrfield` never leave the object they start in (doing
+   * so is UB), so every pointer is traced back to the lets it may address.
+   * The state records, per let and param, the targets of any pointer held
+   * anywhere inside it; aggregates are summarised as a whole. Pointer params
+   * and `undef` initializers address unknown storage.
+   *
+   * The targets of the pointer operand of every reachable `store` and
+   * `load` are kept, so the symbolic executor only dispatches over them.
+   */
+  class PointsToAnalysis {
+  public:
+    /**
+     * The lets (indices into FunDecl::lets, sorted) a pointer may address,
+     * or `any` when it may address storage the analysis does not know.
+     */
+    struct Targets {
+      bool any = false;
+      std::vector<std::size_t> lets;
+
+      void add(const Targets &other);
+      bool operator==(const Targets &other) const {
+        return any == other.any && lets == other.lets;
+      }
+    };
+
+    PointsToAnalysis(const FunDecl &f, const CFG &cfg);
+
+    /**
+     * Targets of the pointer a store writes through or a load reads through;
+     * null for sites in unreachable blocks or outside the function body.
+     */
+    const Targets *targets(const StoreInstr &s) const { return find(&s); }
+    const Targets *targets(const LoadAtom &l) const { return find(&l); }
+
+  private:
+    // Targets held per local: lets first, then params.
+    using State = std::vector<Targets>;
+    using Sites = std::unordered_map<const void *, Targets>;
+
+    class Problem final : public symir::DataflowProblem<State> {
+    public:
+      explicit Problem(const FunDecl &f);
+
+      State bottom() override;
+      State entryState() override;
+      State meet(const State &lhs, const State &rhs) override;
+      State transfer(const Block &block, const State &in) override;
+      bool equal(const State &lhs, const State &rhs) override;
+
+      // Runs `block` from `in` and records its store and load targets.
+      void record(const Block &block, const State &in, Sites &sites);
+
+    private:
+      State run(const Block &block, const State &in, Sites *sites);
+
+      const FunDecl &f_;
+      std::unordered_map<std::string, std::size_t> index_; // let or param -> slot
+    };
+
+    const Targets *find(const void *site) const {
+      auto it = sites_.find(site);
+      return it == sites_.end() ? nullptr : &it->second;
+    }
+
+    Sites sites_;
+  };
+
+} // namespace symir
@@ -16,7 +16,7 @@ namespace symir {
     /**
      * Executes the analysis on the function.
      */
-    symir::PassResult run(FunDecl &f, DiagBag &diags) override;
+    symir::PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
   };
 
 } // namespace symir
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "analysis/cfg.hpp"
+#include "analysis/liveness.hpp"
+#include "ast/ast.hpp"
+
+namespace symir {
+
+  /**
+   * Pruned SSA form of the scalar locals of a function, kept beside the
+   * AST rather than rewriting it (SymIR itself stays non-SSA).
+   *
+   * The variables are the params and lets of integer, float or pointer
+   * type whose address is never taken, so that a whole-local assignment
+   * is their only definition. Each variable has one value on entry (the
+   * param, or the let's initializer or `undef`), one per assignment to
+   * it, and one per phi. Phis are placed on the iterated dominance
+   * frontier of the definitions, and only where the variable is live
+   * (pruned SSA); values are then numbered by a walk of the dominator
+   * tree. Blocks not reachable from the entry get no values.
+   *
+   * Variables are numbered as Liveness slots (lets, then params); a slot
+   * that is not a variable has no values.
+   */
+  class SSAForm {
+  public:
+    static constexpr std::size_t npos = SIZE_MAX;
+
+    struct Value {
+      std::size_t var;       // Liveness slot
+      std::size_t block;     // defining block; npos for the value on entry
+      std::size_t instr;     // defining AssignInstr in `block`; npos for a phi
+      std::uint32_t version; // per variable, 0 for the value on entry
+    };
+
+    struct Phi {
+      std::size_t value;
+      // Per predecessor (parallel to CFG::pred of the block): the value
+      // that flows in, npos from a block not reachable from the entry.
+      std::vector<std::size_t> incoming;
+      // The entry block only: the value on entry, which flows in from
+      // the function's start.
+      std::size_t onEntry = npos;
+    };
+
+    SSAForm(
+        const FunDecl &f, const CFG &cfg, const std::vector<std::size_t> &idom,
+        const Liveness &live
+    );
+
+    std::size_t numVars() const { return isVar_.size(); }
+    bool isVar(std::size_t slot) const { return slot < isVar_.size() && isVar_[slot]; }
+    /// The local a variable is.
+    Symbol local(std::size_t var) const { return names_[var]; }
+
+    const std::vector<Value> &values() const { return values_; }
+    /// The value of `var` on entry to the function.
+    std::size_t entryValue(std::size_t var) const { return entry_[var]; }
+    /// The phis at the start of `block`, by variable.
+    const std::vector<Phi> &phis(std::size_t block) const { return phis_[block]; }
+    /// The value that instruction `instr` of `block` defines, or npos.
+    std::size_t def(std::size_t block, std::size_t instr) const {
+      const auto &d = defs_[block];
+      return instr < d.size() ? d[instr] : npos;
+    }
+    /// The value of `var` at the start of `block`, phis included; npos in
+    /// unreachable blocks.
+    std::size_t valueIn(std::size_t block, std::size_t var) const {
+      const auto &in = in_[block];
+      return in.empty() ? npos : in[var];
+    }
+
+    /// `%x.3`: the local's name and the value's version.
+    std::string name(std::size_t value) const;
+
+  private:
+    std::vector<Symbol> names_; // by slot
+    std::vector<char> isVar_;
+    std::vector<Value> values_;
+    std::vector<std::size_t> entry_;               // by var
+    std::vector<std::vector<Phi>> phis_;           // by block
+    std::vector<std::vector<std::size_t>> defs_;   // by block, by instruction
+    std::vector<std::vector<std::size_t>> in_;     // by block, by var
+  };
+
+} // namespace symir
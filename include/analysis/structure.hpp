@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include "analysis/cfg.hpp"
+#include "analysis/loops.hpp"
+
+namespace symir {
+
+  /**
+   * The nesting in which a backend emits a reducible CFG as structured
+   * control flow (Ramsey, "Beyond Relooper"): a block with several forward
+   * in-edges (a merge) gets a construct of its own closed right before its
+   * code, inside the code of its immediate dominator; a loop header gets a
+   * loop around the blocks it dominates; any other block is emitted in
+   * place of the one branch into it. Branches then leave a merge construct
+   * or restart a loop. Used by the WASM backend (`block`/`loop`/`if`) and
+   * by `symirc --cfg-lowering structured`.
+   */
+  struct StructuredCfg {
+    const FunDecl *f = nullptr;
+    const CFG *cfg = nullptr;
+    std::vector<std::size_t> number; // position in reverse postorder
+    std::vector<bool> isLoopHeader, isMerge;
+    // Per block: the merges it immediately dominates, the latest in reverse
+    // postorder first (its construct is outermost, since every other child
+    // may branch to it).
+    std::vector<std::vector<std::size_t>> mergeChildren;
+
+    /**
+     * The nesting of `f` whose CFG is `cfg` with immediate dominators
+     * `idom`; nullopt if the CFG is irreducible.
+     */
+    static std::optional<StructuredCfg>
+    build(const FunDecl &f, const CFG &cfg, const std::vector<std::size_t> &idom);
+
+    /// True if every edge going backward in reverse postorder targets a
+    /// block that dominates its source (LoopNest::reducible).
+    static bool isReducible(const CFG &cfg, const std::vector<std::size_t> &idom);
+
+    /// True if the edge `from` -> `to` goes back to a loop header.
+    bool isBackEdge(std::size_t from, std::size_t to) const { return number[to] <= number[from]; }
+  };
+
+} // namespace symir
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "ast/ast.hpp"
+
+namespace symir {
+
+  /**
+   * Where the symbol-independent prefix of a function's runs ends: up to
+   * the first use of a sym, a run does the same under every binding.
+   *
+   * A let is sym-dependent if its initializer names a sym, a param (bound
+   * by the caller) or a sym-dependent let. One whose initializer names no
+   * local at all is deferred: it is bound after the prefix, which cannot
+   * tell. The prefix binds the other lets up to the first sym-dependent
+   * one that is not deferred. Only when it binds them all does it go on
+   * into the blocks, from the entry block until it enters one that names
+   * a sym or a sym-dependent let anywhere (an index, an `addr` or a store
+   * included) or that returns. Values only derive from syms through such
+   * names, and a pointer into a sym-dependent let is made by naming it, so
+   * every value the prefix computes is the same in all runs.
+   */
+  class SymPrefix {
+  public:
+    explicit SymPrefix(const FunDecl &f);
+
+    /// The prefix binds the lets before this one, in FunDecl::lets order,
+    /// except the deferred ones.
+    std::size_t numLets() const { return numLets_; }
+
+    /// Whether let `k` (before numLets()) is bound after the prefix.
+    bool deferred(std::size_t k) const { return deferred_[k] != 0; }
+
+    /// Whether the prefix ends on entering `block`.
+    bool endsAt(std::size_t block) const { return ends_[block] != 0; }
+
+  private:
+    std::size_t numLets_ = 0;
+    std::vector<char> deferred_;
+    std::vector<char> ends_;
+  };
+
+} // namespace symir
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "analysis/pass_manager.hpp"
+
+namespace symir {
+
+  /**
+   * Transformation passes that rewrite a checked function without changing
+   * what any execution of it does, UB included: an operation that may trap
+   * (overflow, division by zero, an overshift, reading `undef`, a load) is
+   * never folded away, only operations whose outcome is known not to trap.
+   * They run after the checkers, on a well-typed Program.
+   */
+
+  /**
+   * Sparse conditional constant propagation over the integer scalars
+   * whose address is never taken. Constants flow only along the branches
+   * that can be taken, so a constant branch condition also hides what the
+   * untaken side assigns. Reads of constants become literals, assignments
+   * and `ret` values that fold become one literal, conditional branches on
+   * a constant condition become unconditional, and `assume`/`require`
+   * whose condition is constant and true are dropped.
+   *
+   * A literal is an i64 to the interpreter, which checks overflow at the
+   * width of an expression's first atom and of an op's coefficient; those
+   * two positions take a literal only in i64 expressions.
+   */
+  class ConstantPropagation : public FunctionPass {
+  public:
+    std::string name() const override { return "ConstantPropagation"; }
+    bool preservesAnalyses() const override { return false; }
+    PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
+  };
+
+  /**
+   * Replaces the reads of a scalar local that was last assigned a copy of
+   * another (`%x = %y;`, or `let %x: T = %y;`) by reads of the original,
+   * as long as neither has been assigned since on any path. The copy is
+   * then often dead, for DeadStoreElimination to remove.
+   */
+  class CopyPropagation : public FunctionPass {
+  public:
+    std::string name() const override { return "CopyPropagation"; }
+    bool preservesAnalyses() const override { return false; }
+    PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
+  };
+
+  /**
+   * Removes assignments to locals that are not live afterwards, when the
+   * right-hand side cannot trap (a literal, a sym, or a read of a local
+   * that is never `undef`), and then the lets nothing refers to any more
+   * whose initializer cannot trap.
+   */
+  class DeadStoreElimination : public FunctionPass {
+  public:
+    std::string name() const override { return "DeadStoreElimination"; }
+    bool preservesAnalyses() const override { return false; }
+    PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
+  };
+
+  /**
+   * Removes the blocks no path from the entry reaches, such as those
+   * ConstantPropagation cut off.
+   */
+  class DeadBlockElimination : public FunctionPass {
+  public:
+    std::string name() const override { return "DeadBlockElimination"; }
+    bool preservesAnalyses() const override { return false; }
+    PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
+  };
+
+  /**
+   * Retargets branches to empty blocks that only jump on (goto chains) at
+   * the final target, then merges every block that is the only successor
+   * of its only predecessor into that predecessor.
+   */
+  class BlockMerging : public FunctionPass {
+  public:
+    std::string name() const override { return "BlockMerging"; }
+    bool preservesAnalyses() const override { return false; }
+    PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
+  };
+
+  /**
+   * Rewrites counted loops that work element by element over local arrays
+   * into `<K> T` vector operations followed by the original loop, which
+   * runs the remaining iterations. A loop qualifies when
+   *
+   *   - its header only branches on `%i < B` or `%i <= B`, to a body block
+   *     whose sole predecessor it is, and is entered from one other block;
+   *   - the body ends in `%i = %i + 1; br` back to the header, and `%i`
+   *     starts from a constant and `B` is constant, so that the trip count
+   *     is known and at least K;
+   *   - every other body instruction assigns an element `%a[..][%i]` of a
+   *     local array of integers or floats, or a scalar that no iteration
+   *     reads before assigning it, from `+`, `-`, an op or `~` over such
+   *     elements and scalars, literals, loop-invariant scalars and `%i`.
+   *
+   * Iteration j then touches element j of the arrays only, so K iterations
+   * may run as one, and the elements they touch are contiguous: the iv
+   * indexes the innermost dimension with stride 1. Any other access, or a
+   * loop that reads an element of another iteration, leaves the loop
+   * scalar. Vectors are not in memory, so an element is copied to and
+   * from its vector lane by lane, in the order findLaneRuns recognizes:
+   * the backends emit each such copy as one vector load or store, and
+   * the operations between them as vector operations. Every operation of
+   * the loop still runs, lane-wise, so a trap in the scalar loop is a trap
+   * here too.
+   */
+  class LoopVectorization : public FunctionPass {
+  public:
+    explicit LoopVectorization(unsigned lanes = 4) : lanes_(lanes < 2 ? 2 : lanes) {}
+
+    std::string name() const override { return "LoopVectorization"; }
+    bool preservesAnalyses() const override { return false; }
+    PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
+
+  private:
+    unsigned lanes_;
+  };
+
+  /**
+   * A copy between a vector and consecutive array elements, one lane per
+   * instruction: from instruction `first` of a block on, the `lanes`
+   * assignments
+   *
+   *   %v[0] = %a[..][%j];  %v[1] = %a[..][%j1];  ...    (a load), or
+   *   %a[..][%j] = %v[0];  %a[..][%j1] = %v[1];  ...    (a store),
+   *
+   * where `%jk` was assigned `%j + k` earlier in the block and neither has
+   * changed since. This is how LoopVectorization moves vectors in and out
+   * of arrays. Only the shape is matched: a backend still checks that
+   * `vec` is a vector of `lanes` lanes and `element` an array element of
+   * its lane type before it emits the run as one vector load or store.
+   */
+  struct LaneRun {
+    std::size_t first = 0;
+    std::size_t lanes = 0;
+    bool store = false;
+    const LValue *element = nullptr; // `%a[..][%j]`, in instruction `first`
+    Symbol vec;
+  };
+
+  /// The lane runs of two or more lanes in `b`, in order.
+  std::vector<LaneRun> findLaneRuns(const Block &b);
+
+  /**
+   * Adds the passes above but LoopVectorization to `pm`, each placed
+   * where the earlier ones have exposed the most to it: what `-O` runs.
+   */
+  void addOptimizationPasses(PassManager &pm);
+
+} // namespace symir
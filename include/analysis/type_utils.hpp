@@ -14,7 +14,8 @@ namespace symir {
     static std::optional<std::uint32_t> getBitWidth(const TypePtr &t);
 
     /**
-     * Checks if two types are structurally equal.
+     * Checks if two types are structurally equal. For two interned types
+     * (TypeTable) this is a pointer compare.
      */
     static bool areTypesEqual(const TypePtr &a, const TypePtr &b);
 
@@ -9,7 +9,7 @@ namespace symir {
   public:
     std::string name() const override { return "UnusedNameAnalysis"; }
 
-    symir::PassResult run(FunDecl &f, DiagBag &diags) override;
+    symir::PassResult run(FunDecl &f, DiagBag &diags, AnalysisManager &am) override;
   };
 
 } // namespace symir
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace symir {
+
+  /**
+   * Bump storage for the AST nodes a Program holds by pointer (InitValPtr,
+   * AtomPtr). Allocation is a pointer bump, frees are no-ops, and all of it
+   * goes back in one piece when the arena dies.
+   *
+   * Nodes allocated here keep the arena alive through their allocator (see
+   * ArenaAllocator), so a node that outlives its Program stays valid.
+   */
+  class AstArena {
+  public:
+    AstArena() = default;
+    AstArena(const AstArena &) = delete;
+    AstArena &operator=(const AstArena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t align) { return res_.allocate(bytes, align); }
+
+  private:
+    std::pmr::monotonic_buffer_resource res_{64 * 1024};
+  };
+
+  /**
+   * Standard allocator over an AstArena, for `std::allocate_shared`. It
+   * holds a reference on the arena, so a node's control block keeps the
+   * storage it lives in alive.
+   */
+  template<typename T>
+  struct ArenaAllocator {
+    using value_type = T;
+
+    std::shared_ptr<AstArena> arena;
+
+    explicit ArenaAllocator(std::shared_ptr<AstArena> a) : arena(std::move(a)) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &o) : arena(o.arena) {}
+
+    T *allocate(std::size_t n) {
+      return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *, std::size_t) noexcept {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &o) const {
+      return arena == o.arena;
+    }
+  };
+
+  /// A shared node in `arena`, or on the heap when there is none.
+  template<typename T, typename... Args>
+  std::shared_ptr<T> makeNode(const std::shared_ptr<AstArena> &arena, Args &&...args) {
+    if (!arena)
+      return std::make_shared<T>(std::forward<Args>(args)...);
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+  }
+
+} // namespace symir
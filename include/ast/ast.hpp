@@ -6,6 +6,8 @@
 #include <string>
 #include <variant>
 #include <vector>
+#include "ast/arena.hpp"
+#include "ast/symbol.hpp"
 
 namespace symir {
 
@@ -48,6 +50,10 @@ namespace symir {
   // Node Base
   // ---------------------------
 
+  /// Identifies a parsed node for side tables such as TypeAnnotations.
+  /// The parser numbers LValues and Atoms of a Program from 1; 0 marks a
+  /// node built in code, which has no entry. A copy keeps the id of the
+  /// node it was copied from.
   using NodeId = std::uint32_t;
 
   /**
@@ -66,7 +72,7 @@ namespace symir {
    * Global identifier starting with '@', e.g., '@main'.
    */
   struct GlobalId {
-    std::string name;
+    Symbol name;
     SourceSpan span;
   };
 
@@ -74,7 +80,7 @@ namespace symir {
    * Local identifier starting with '%', e.g., '%x'.
    */
   struct LocalId {
-    std::string name;
+    Symbol name;
     SourceSpan span;
   };
 
@@ -82,7 +88,7 @@ namespace symir {
    * Symbolic identifier starting with '@?' or '%?', e.g., '%?v'.
    */
   struct SymId {
-    std::string name;
+    Symbol name;
     SourceSpan span;
   };
 
@@ -90,7 +96,7 @@ namespace symir {
    * Block label identifier starting with '^', e.g., '^entry'.
    */
   struct BlockLabel {
-    std::string name;
+    Symbol name;
     SourceSpan span;
   };
 
@@ -162,13 +168,30 @@ namespace symir {
     SourceSpan span;
   };
 
+  /**
+   * Set on the nodes TypeTable hands out. A copy of a node is a new,
+   * uninterned node, so copying does not carry the mark over.
+   */
+  struct CanonicalMark {
+    bool on = false;
+
+    CanonicalMark() = default;
+    CanonicalMark(const CanonicalMark &) {}
+    CanonicalMark &operator=(const CanonicalMark &) { return *this; }
+  };
+
   /**
    * Wrapper for all possible types in SymIR.
+   *
+   * The parser and typechecker build types through TypeTable, which gives
+   * one shared node per structurally distinct type (see ast/type_table.hpp).
+   * Such nodes have no source span and must not be modified.
    */
   struct Type {
     using Variant = std::variant<IntType, FloatType, StructType, ArrayType, PtrType, VecType>;
     Variant v;
     SourceSpan span;
+    CanonicalMark canonical{};
   };
 
   // ---------------------------
@@ -220,7 +243,7 @@ namespace symir {
    * Represents a struct field access segment.
    */
   struct AccessField {
-    std::string field;
+    Symbol field;
     SourceSpan span;
   };
 
@@ -233,6 +256,7 @@ namespace symir {
     LocalId base;
     std::vector<Access> accesses;
     SourceSpan span;
+    NodeId id = 0;
   };
 
   using RValue = LValue;
@@ -265,6 +289,13 @@ namespace symir {
     SelectVal vtrue;
     SelectVal vfalse;
     SourceSpan span;
+
+    SelectAtom() = default;
+    SelectAtom(SelectAtom &&) = default;
+    SelectAtom &operator=(SelectAtom &&) = default;
+    // Deep copies, so that a copied Program is independent of the original.
+    SelectAtom(const SelectAtom &other);
+    SelectAtom &operator=(const SelectAtom &other);
   };
 
   /**
@@ -317,6 +348,7 @@ namespace symir {
     Variant src;
     TypePtr dstType;
     SourceSpan span;
+    SourceSpan dstSpan{}; // where dstType is written; interned types have no span
   };
 
   /**
@@ -368,7 +400,7 @@ namespace symir {
 
   struct PtrFieldAtom {
     RValue rval;
-    std::string field;
+    Symbol field;
     SourceSpan span;
   };
 
@@ -381,6 +413,7 @@ namespace symir {
         PtrIndexAtom, PtrFieldAtom>;
     Variant v;
     SourceSpan span;
+    NodeId id = 0;
   };
 
   enum class AddOp { Plus, Minus };
@@ -411,6 +444,17 @@ namespace symir {
     SourceSpan span;
   };
 
+  inline SelectAtom::SelectAtom(const SelectAtom &other)
+      : cond(other.cond ? std::make_unique<Cond>(*other.cond) : nullptr),
+        maskExpr(other.maskExpr ? std::make_unique<Expr>(*other.maskExpr) : nullptr),
+        vtrue(other.vtrue), vfalse(other.vfalse), span(other.span) {}
+
+  inline SelectAtom &SelectAtom::operator=(const SelectAtom &other) {
+    if (this != &other)
+      *this = SelectAtom(other);
+    return *this;
+  }
+
   // ---------------------------
   // AST: instructions / terminators
   // ---------------------------
@@ -497,9 +541,10 @@ namespace symir {
   // ---------------------------
 
   struct FieldDecl {
-    std::string name;
+    Symbol name;
     TypePtr type;
     SourceSpan span;
+    SourceSpan typeSpan{}; // where `type` is written; interned types have no span
   };
 
   /**
@@ -535,6 +580,7 @@ namespace symir {
     TypePtr type;
     std::optional<Domain> domain;
     SourceSpan span;
+    SourceSpan typeSpan{};
   };
 
   struct InitVal;
@@ -578,6 +624,7 @@ namespace symir {
     TypePtr type;
     std::optional<InitVal> init;
     SourceSpan span;
+    SourceSpan typeSpan{};
   };
 
   /**
@@ -587,6 +634,7 @@ namespace symir {
     LocalId name;
     TypePtr type;
     SourceSpan span;
+    SourceSpan typeSpan{};
   };
 
   /**
@@ -600,8 +648,11 @@ namespace symir {
     std::vector<LetDecl> lets;
     std::vector<Block> blocks;
     SourceSpan span;
+    SourceSpan retTypeSpan{};
   };
 
+  class TypeAnnotations;
+
   /**
    * Represents a complete SymIR program.
    */
@@ -609,6 +660,13 @@ namespace symir {
     std::vector<StructDecl> structs;
     std::vector<FunDecl> funs;
     SourceSpan span;
+    /// Storage for the parsed InitVal/Atom nodes (null for trees built in
+    /// code, whose nodes are on the heap). See makeNode().
+    std::shared_ptr<AstArena> arena;
+    /// One past the largest NodeId the parser handed out.
+    NodeId numNodeIds = 1;
+    /// The node types the TypeChecker resolved; null until it has run.
+    std::shared_ptr<const TypeAnnotations> types;
   };
 
   // ---------------------------
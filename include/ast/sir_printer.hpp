@@ -24,15 +24,40 @@ namespace symir {
             &vecModel
     ) : out_(out), model_(model), vecModel_(vecModel) {}
 
+    // Substitutes the syms of each function from its own model (keyed by
+    // function name); functions without one keep their syms.
+    struct FunctionModel {
+      std::unordered_map<std::string, SymbolicExecutor::Result::ModelVal> model;
+      std::unordered_map<std::string, std::vector<SymbolicExecutor::Result::ModelVal>> vecModel;
+    };
+
+    explicit SIRPrinter(
+        std::ostream &out, std::unordered_map<std::string, FunctionModel> functionModels
+    ) : out_(out), functionModels_(std::move(functionModels)), perFunction_(true) {}
+
     void print(const Program &p);
 
+    /// Threads to print the functions on (0 = one per hardware thread; see
+    /// forEachFunction()), each with the model this printer holds for it.
+    /// The structs are printed on the caller.
+    void setNumThreads(unsigned n);
+
   private:
+    /// A worker printing function `f` of `parent`'s program into `out`,
+    /// with the model `parent` has for it.
+    SIRPrinter(const SIRPrinter &parent, std::ostream &out, const FunDecl &f);
+
     std::ostream &out_;
+    unsigned numThreads_ = 1;
     std::unordered_map<std::string, SymbolicExecutor::Result::ModelVal> model_;
     // [v0.2.1] Per-lane concrete values for vector syms produced by the
     // solver. References to a vec sym `%?v` are rewritten to a synthetic
     // local `%v__solved` whose init list carries these lane values.
     std::unordered_map<std::string, std::vector<SymbolicExecutor::Result::ModelVal>> vecModel_;
+    // With perFunction_, model_ and vecModel_ are taken from here for each
+    // function being printed.
+    std::unordered_map<std::string, FunctionModel> functionModels_;
+    bool perFunction_ = false;
     int indent_level_ = 0;
 
     // Translate `%?v` / `@?v` to a corresponding local identifier suitable
@@ -41,6 +66,9 @@ namespace symir {
     // live in for now).
     std::string vecSymLocalName(const std::string &symName) const;
 
+    void printStructs(const Program &p);
+    void printFunction(const FunDecl &f);
+
     void indent();
     void printType(const TypePtr &t);
     void printExpr(const Expr &e);
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace symir {
+
+  /**
+   * An interned identifier (`@f`, `%x`, `%?k`, `^bb`, a field name).
+   *
+   * A Symbol is a dense 32-bit index into the current SymbolTable, so
+   * equal names are equal handles: comparison is one integer compare and
+   * the hash is precomputed at interning. Id 0 is the empty name. The
+   * text is one table lookup away and stays valid as long as the table.
+   *
+   * Symbols convert to `const std::string &` and offer the read-only
+   * string operations the tree uses on names, so code that only reads a
+   * name does not need to know it is interned. Ordering is by text, as for
+   * the strings they replace.
+   */
+  class Symbol {
+  public:
+    Symbol() = default;
+    Symbol(std::string_view text);
+    Symbol(const std::string &text) : Symbol(std::string_view(text)) {}
+    Symbol(const char *text) : Symbol(std::string_view(text)) {}
+
+    std::uint32_t id() const { return id_; }
+    const std::string &str() const;
+    std::size_t hash() const;
+
+    operator const std::string &() const { return str(); }
+    operator std::string_view() const { return str(); }
+
+    bool empty() const { return id_ == 0; }
+    std::size_t size() const { return str().size(); }
+    std::size_t length() const { return str().size(); }
+    const char *c_str() const { return str().c_str(); }
+    const char *data() const { return str().data(); }
+    char operator[](std::size_t i) const { return str()[i]; }
+    char front() const { return str().front(); }
+    char back() const { return str().back(); }
+    std::string::const_iterator begin() const { return str().begin(); }
+    std::string::const_iterator end() const { return str().end(); }
+    std::string substr(std::size_t pos = 0, std::size_t n = std::string::npos) const {
+      return str().substr(pos, n);
+    }
+    template<typename T>
+    std::size_t find(const T &what, std::size_t pos = 0) const {
+      return str().find(what, pos);
+    }
+    template<typename T>
+    std::size_t rfind(const T &what, std::size_t pos = std::string::npos) const {
+      return str().rfind(what, pos);
+    }
+    bool starts_with(std::string_view p) const { return str().starts_with(p); }
+    bool ends_with(std::string_view p) const { return str().ends_with(p); }
+    int compare(std::string_view other) const { return str().compare(other); }
+
+    friend bool operator==(Symbol a, Symbol b) { return a.id_ == b.id_; }
+    friend bool operator==(Symbol a, std::string_view b) { return a.str() == b; }
+    friend bool operator==(Symbol a, const std::string &b) { return a.str() == b; }
+    friend bool operator==(Symbol a, const char *b) { return a.str() == b; }
+    friend std::strong_ordering operator<=>(Symbol a, Symbol b) {
+      if (a.id_ == b.id_)
+        return std::strong_ordering::equal;
+      return a.str().compare(b.str()) <=> 0;
+    }
+
+  private:
+    std::uint32_t id_ = 0;
+    friend class SymbolTable;
+  };
+
+  inline std::string operator+(const Symbol &a, const std::string &b) { return a.str() + b; }
+  inline std::string operator+(const std::string &a, const Symbol &b) { return a + b.str(); }
+  inline std::string operator+(const Symbol &a, const char *b) { return a.str() + b; }
+  inline std::string operator+(const char *a, const Symbol &b) { return a + b.str(); }
+  inline std::string operator+(const Symbol &a, char b) { return a.str() + b; }
+  inline std::string operator+(char a, const Symbol &b) { return a + b.str(); }
+  inline std::string operator+(const Symbol &a, const Symbol &b) { return a.str() + b.str(); }
+  inline std::string operator+(std::string &&a, const Symbol &b) { return std::move(a) + b.str(); }
+  inline std::ostream &operator<<(std::ostream &os, const Symbol &s) { return os << s.str(); }
+
+  /**
+   * The interning table behind Symbol, filled by the parser and by code
+   * that builds identifiers. Interning takes a lock; looking a symbol's
+   * text or hash up does not. Entries are never removed, so a table lives
+   * as long as the names it holds are used.
+   *
+   * Symbols are made and read against the current table of their thread:
+   * that of the innermost Scope, or global() outside of any. A one-shot
+   * tool uses global() for everything. A long-running one gives each
+   * session (a module a server keeps, a document an editor has open) a
+   * table of its own and enters its Scope for all work on it, so the names
+   * of a session go when it does. Symbols of different tables must not
+   * meet; threads started inside a Scope enter it as well (see Scope).
+   */
+  class SymbolTable {
+  public:
+    SymbolTable();
+    ~SymbolTable();
+    SymbolTable(const SymbolTable &) = delete;
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    /// The table of the whole process.
+    static SymbolTable &global();
+    /// The table Symbols of this thread refer to.
+    static SymbolTable &current() { return current_ ? *current_ : global(); }
+
+    /**
+     * Makes `table` the current one of this thread until destroyed. Code
+     * that hands work to other threads takes current() along and enters
+     * it there, as it does with timing::Inherit.
+     */
+    class Scope {
+    public:
+      explicit Scope(SymbolTable &table) : prev_(current_) { current_ = &table; }
+      ~Scope() { current_ = prev_; }
+      Scope(const Scope &) = delete;
+      Scope &operator=(const Scope &) = delete;
+
+    private:
+      SymbolTable *prev_;
+    };
+
+    Symbol intern(std::string_view text);
+    const std::string &text(std::uint32_t id) const { return entry(id).text; }
+    std::size_t hash(std::uint32_t id) const { return entry(id).hash; }
+    /// One past the largest id handed out: vectors indexed by
+    /// Symbol::id() need this many entries.
+    std::uint32_t size() const { return size_.load(std::memory_order_acquire); }
+
+  private:
+    struct Entry {
+      std::string text;
+      std::size_t hash = 0;
+    };
+    // Chunk c holds 2^(kFirstBits + c) entries, so a small table stays
+    // small and 32-bit ids need few chunks.
+    static constexpr unsigned kFirstBits = 6;
+    static constexpr unsigned kMaxChunks = 32 - kFirstBits;
+
+    // The chunk of `id` and its index there.
+    static std::pair<unsigned, std::uint32_t> locate(std::uint32_t id) {
+      std::uint64_t v = std::uint64_t(id) + (std::uint64_t(1) << kFirstBits);
+      unsigned chunk = static_cast<unsigned>(std::bit_width(v)) - 1 - kFirstBits;
+      return {chunk, static_cast<std::uint32_t>(v - (std::uint64_t(1) << (kFirstBits + chunk)))};
+    }
+    const Entry &entry(std::uint32_t id) const {
+      auto [chunk, i] = locate(id);
+      return chunks_[chunk].load(std::memory_order_acquire)[i];
+    }
+
+    static inline thread_local SymbolTable *current_ = nullptr;
+
+    std::mutex mu_;
+    // Entries live in fixed chunks, so a published entry never moves.
+    std::atomic<Entry *> chunks_[kMaxChunks] = {};
+    std::atomic<std::uint32_t> size_{0};
+    std::unordered_map<std::string_view, std::uint32_t> index_; // guarded by mu_
+  };
+
+  inline Symbol::Symbol(std::string_view text) : id_(SymbolTable::current().intern(text).id_) {}
+  inline const std::string &Symbol::str() const { return SymbolTable::current().text(id_); }
+  inline std::size_t Symbol::hash() const { return SymbolTable::current().hash(id_); }
+
+} // namespace symir
+
+template<>
+struct std::hash<symir::Symbol> {
+  std::size_t operator()(symir::Symbol s) const noexcept { return s.hash(); }
+};
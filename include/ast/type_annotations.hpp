@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "ast/ast.hpp"
+
+namespace symir {
+
+  /**
+   * The types the TypeChecker resolved, indexed by NodeId, so consumers
+   * look a node's type up instead of walking lets, params and struct
+   * fields again. It holds the type of every checked LValue (after its
+   * accesses) and of every Atom whose type is a pointer, vector, array or
+   * struct; scalar atoms and nodes without an id have no entry.
+   *
+   * Slots are preallocated for a Program's ids, so functions checked on
+   * different threads fill it without locking.
+   */
+  class TypeAnnotations {
+  public:
+    explicit TypeAnnotations(NodeId numIds = 0) : types_(numIds) {}
+
+    /// The recorded type of the node, or null.
+    TypePtr of(const LValue &lv) const { return at(lv.id); }
+    TypePtr of(const Atom &a) const { return at(a.id); }
+    TypePtr of(NodeId id) const { return at(id); }
+
+    /// One past the largest id with a slot.
+    NodeId size() const { return static_cast<NodeId>(types_.size()); }
+
+    void set(NodeId id, TypePtr t) {
+      if (id != 0 && id < types_.size())
+        types_[id] = std::move(t);
+    }
+
+  private:
+    TypePtr at(NodeId id) const { return id < types_.size() ? types_[id] : nullptr; }
+
+    std::vector<TypePtr> types_;
+  };
+
+} // namespace symir
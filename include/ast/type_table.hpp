@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include "ast/ast.hpp"
+
+namespace symir {
+
+  /**
+   * Hash-consing table for AST types: intern() returns the one shared node
+   * for each structurally distinct type, so two interned types are equal
+   * exactly when they are the same pointer. Interned nodes carry no source
+   * span and live for the whole process. Interning takes a lock.
+   */
+  class TypeTable {
+  public:
+    static TypeTable &global();
+
+    /// The canonical node for `t`; its element and pointee types are
+    /// interned along with it.
+    TypePtr intern(const Type &t);
+    TypePtr intern(const TypePtr &t) { return !t || t->canonical.on ? t : intern(*t); }
+
+  private:
+    struct Key {
+      std::uint8_t tag = 0;  // Type::Variant index
+      std::uint8_t kind = 0; // IntType/FloatType kind
+      std::uint64_t n = 0;   // custom bitwidth, or array/vector size
+      std::uint32_t name = 0;
+      const Type *child = nullptr;
+
+      bool operator==(const Key &) const = default;
+    };
+    struct KeyHash {
+      std::size_t operator()(const Key &k) const noexcept;
+    };
+
+    TypeTable() = default;
+
+    std::mutex mu_;
+    std::unordered_map<Key, TypePtr, KeyHash> index_; // guarded by mu_
+  };
+
+} // namespace symir
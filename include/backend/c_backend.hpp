@@ -2,9 +2,16 @@
 
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <variant>
+#include <vector>
+#include "analysis/intervals.hpp"
+#include "analysis/structure.hpp"
+#include "analysis/transforms.hpp"
 #include "ast/ast.hpp"
+#include "ast/type_annotations.hpp"
 #include "backend/vec_lowering.hpp"
 
 namespace symir {
@@ -30,17 +37,101 @@ namespace symir {
 
     void setNoRequire(bool val) { noRequire_ = val; }
 
+    /// Lower failed checks to calls of `void fn(int kind, const char *msg)`
+    /// instead of `assert`: kind 1 is a `require` (msg is its message, or
+    /// NULL), kind 2 an `assume` (msg is NULL). Used by `symiri --native`,
+    /// which must tell the two apart and report them without aborting.
+    void setCheckHook(std::string fn) { checkHook_ = std::move(fn); }
+
+    /// How much UB the emitted code checks itself (`symirc --ub-checks`,
+    /// see UbChecks). `require`s are governed by setNoRequire alone.
+    void setUbChecks(UbChecks checks) { ubChecks_ = checks; }
+
     /// [v0.2.1] Set the vector-lowering strategy. Takes ownership. If
     /// never called, the backend defaults to "vecext" on first emit.
     void setVecLowering(std::unique_ptr<VecLowering> vl) { vecLowering_ = std::move(vl); }
 
+    /// Append a benchmark driver for function `entry` (`symirc
+    /// --emit-bench`): a `main` that times calls of it over argument and
+    /// symbol tuples read from a file or generated from a seed, and prints
+    /// ns/call statistics. Before timing starts, the driver rejects the
+    /// tuples that fail a check, trap or have UB `UbChecks::Explicit`
+    /// catches, whatever setUbChecks and setNoRequire say. Throws
+    /// if `entry` is missing or takes or returns a non-scalar, non-vector.
+    void setBenchEntry(std::string entry) { benchEntry_ = std::move(entry); }
+
+    /// The value of a sym in a model: an integer or a float.
+    using SymValue = std::variant<int64_t, double>;
+    /// Sym values per function, then per sym (`"@main"` -> `"%?k"` -> 4),
+    /// as `symirsolve --emit-model` writes them.
+    using SymModel =
+        std::unordered_map<std::string, std::unordered_map<std::string, SymValue>>;
+
+    /// Specialize the output (`symirc --specialize`). Scalar syms that
+    /// `model` gives a value are emitted as literals instead of externs.
+    /// While `require`s are emitted, each function's interval analysis (run
+    /// with those values) also removes the branch arms no execution takes
+    /// and the blocks only they reach, and drops the bounds checks of
+    /// vector-lane and `ptrindex` indices it proves in range. `assume`s
+    /// without a check hook become `__builtin_unreachable()` hints. emit()
+    /// throws if the model names a function or sym the program lacks, or
+    /// gives an integer sym a float.
+    void specialize(SymModel model = {});
+
+    /// How branches are lowered (`symirc --cfg-lowering`).
+    enum class CfgLowering {
+      /// A label per block and `goto` (the default).
+      Goto,
+      /// The StructuredCfg nesting: loops become `for (;;)` and merge blocks
+      /// follow a `do { ... } while (0)`, so branches become `if`/`else`,
+      /// `continue` and `break`. A branch to a construct other than the
+      /// innermost, which C cannot name, stays a `goto`, and so does every
+      /// branch of an irreducible CFG.
+      Structured,
+      /// One `switch` over a block number inside `for (;;)`; a branch sets
+      /// the number and continues. Keeps compile time about linear in the
+      /// number of blocks, at the cost of an indirect jump per branch.
+      Switch,
+    };
+    void setCfgLowering(CfgLowering l) { cfgLowering_ = l; }
+
+    /// Threads to emit the functions on (0 = one per hardware thread; see
+    /// forEachFunction()). The preamble, structs, bench driver and vector
+    /// epilogue are emitted on the caller.
+    void setNumThreads(unsigned n);
+
+    // --- Mangling and naming helpers ---
+    /// The C name of symbol `symName` of function `funcName` (`<func>__<sym>`).
+    static std::string
+    getMangledSymbolName(const std::string &funcName, const std::string &symName);
+    /// The C name of a function or local (`symir_<name>`).
+    static std::string mangleName(const std::string &name);
+    static std::string stripSigil(const std::string &name);
+
   private:
+    /// A worker emitting functions of the program `parent` is emitting
+    /// into `out`; it shares the parent's settings and struct layouts.
+    CBackend(const CBackend &parent, std::ostream &out);
+
     std::ostream &out_;
+    unsigned numThreads_ = 1;
     int indent_level_ = 0;
     bool noRequire_ = false;
+    std::string checkHook_;
+    std::string benchEntry_;
+    CfgLowering cfgLowering_ = CfgLowering::Goto;
+    UbChecks ubChecks_ = UbChecks::Sanitizer;
+    // Set by specialize(); shared with the workers.
+    std::shared_ptr<const SymModel> model_;
     std::string curFuncName_;
-    std::unique_ptr<VecLowering> vecLowering_; // [v0.2.1] strategy, see vec_lowering.hpp
-    std::unordered_map<std::string, std::uint32_t> varWidths_;
+    // Appended to the C names of the functions emitted (emitBenchProbe).
+    std::string nameSuffix_;
+    // [v0.2.1] strategy, see vec_lowering.hpp; shared with the workers
+    std::shared_ptr<VecLowering> vecLowering_;
+    // The vecext strategy, whose types the hooks of vector syms return
+    // whatever vecLowering_ is; vecLowering_ itself when that is vecext.
+    std::shared_ptr<VecLowering> symHooks_;
+    std::unordered_map<Symbol, std::uint32_t> varWidths_;
     TypePtr curFuncRetType_;
     // ``isDoubleCtx_`` is the lowering-time evaluation context for float
     // literals: when false, literals emit with the ``f`` suffix so an
@@ -48,14 +139,96 @@ namespace symir {
     // FLT_EVAL_METHOD == 0. Mutated transiently around assign/store/ret/
     // cond/init/cast emission via ``CtxGuard``.
     bool isDoubleCtx_ = false;
-    std::unordered_map<std::string, TypePtr> varTypes_;
+    std::unordered_map<Symbol, TypePtr> varTypes_;
     // Struct field name+type in declaration order. Linear lookup by name
     // for AccessField, indexed lookup for InitVal aggregates. Structs are
     // tiny (handful of fields), so linear scan is fine.
-    std::unordered_map<std::string, std::vector<std::pair<std::string, TypePtr>>> structFields_;
+    std::unordered_map<Symbol, std::vector<std::pair<std::string, TypePtr>>> structFields_;
+    // The checker's node types (Program::types), consulted before walking
+    // varTypes_/structFields_; null when the program was not type checked.
+    const TypeAnnotations *nodeTypes_ = nullptr;
+
+    // --- Specialization (c_specialize.cpp) ---
+    // The facts about the function being emitted, while requires are.
+    std::optional<CFG> curCfg_;
+    std::optional<IntervalAnalysis> curRanges_;
+    std::vector<char> curLive_; // per block: reached along feasible edges
+
+    /// Throws if model_ does not fit `prog`.
+    void checkModel(const Program &prog) const;
+    /// The value specialize() compiles in for sym `sym` of `func`, if any.
+    const SymValue *symValue(const std::string &func, const std::string &sym) const;
+    /// Computes the facts above for `f` (clears them when not specializing).
+    void prepareSpecialization(const FunDecl &f);
+    /// A read of sym `sym` of the current function: its literal or a call.
+    void emitSymRef(const std::string &sym);
+    /// The local a vector sym is copied into under a strategy that
+    /// unrolls lanes (see emitFunction).
+    static std::string symLaneLocal(const std::string &sym);
+    /// The C operand naming local or sym `name` in a lane-wise
+    /// expression: the local, the sym's read, or its lane local.
+    std::string laneOperand(const std::string &name);
+    /// True if `idx` is known to lie in [0, hi] where it is read.
+    bool indexWithin(const Index &idx, uint64_t hi) const;
+    /// False if no execution goes from block `from` (an index into the
+    /// CFG) to `to`, which specialization leaves out.
+    bool feasible(std::size_t from, const BlockLabel &to) const;
+
+    // --- Control-flow lowering (c_cfg_lowering.cpp) ---
+    // The lowering of the function being emitted (Goto for an irreducible
+    // CFG under Structured), its nesting, and the constructs enclosing the
+    // code being emitted (true for a loop), innermost last.
+    CfgLowering curLowering_ = CfgLowering::Goto;
+    std::optional<StructuredCfg> curStructure_;
+    std::vector<std::pair<bool, std::size_t>> constructs_;
+
+    /// The blocks of `f`, lowered as cfgLowering_ says.
+    void emitBlocks(const FunDecl &f);
+    /// A `br` ending block `b`, without the arms no execution takes.
+    void emitBranch(std::size_t b, const BrTerm &br);
+    /// Control going from block `from` to `to`, on a line of its own.
+    void emitJump(std::size_t from, const BlockLabel &to);
+    void emitStructuredTree(std::size_t b);
+    void emitStructuredWithin(std::size_t b, std::size_t firstChild);
+
+    // --- Benchmark driver (c_bench.cpp) ---
+    /// The function named by setBenchEntry; throws if it cannot be driven.
+    const FunDecl &benchFunction(const Program &prog) const;
+    void emitBenchIncludes();
+    /// Whether the driver screens the tuples with a copy of the entry of
+    /// its own: when the entry itself leaves out checks or requires.
+    bool needsBenchProbe() const { return ubChecks_ != UbChecks::Explicit || noRequire_; }
+    void emitBenchProbe(const FunDecl &entry);
+    void emitBenchDriver(const Program &prog, const FunDecl &entry);
+
+    /// One function: its sym externs, then its definition.
+    void emitFunction(const FunDecl &f);
+    void emitInstr(const Instr &ins);
+    /// The instructions of `b`, a lane run (findLaneRuns) as one vector
+    /// load or store where it copies a whole vector.
+    void emitInstrs(const Block &b);
+    /// `run` as one load or store; false (emitting nothing) unless `vec`
+    /// is a vector of `lanes` lanes of the elements' type.
+    bool emitLaneRun(const LaneRun &run);
+    /// The terminator of block `b` (an index into the CFG).
+    void emitTerm(std::size_t b, const Terminator &term);
 
     // --- Emission helpers ---
     void indent();
+    /// The statement a failed check of UB rule `rule` runs; "" when the
+    /// check is left out.
+    std::string trap(int rule) const { return ubTrap(ubChecks_, rule); }
+    /// The SymIR width of an integer type (`i12` -> 12); 0 for other types.
+    static int intWidth(const TypePtr &type);
+    /// The integer type of the operands of `expr`, from its first atom that
+    /// is not an integer literal; null if it has none or they are not integers.
+    TypePtr exprIntType(const Expr &expr);
+    /// `SYMIR_*` macros of the checks of UbChecks::Explicit.
+    void emitUbCheckMacros();
+    /// `op` with its UB checked by the `SYMIR_*` macros; false (emitting
+    /// nothing) if it has no UB to check or is not on integers.
+    bool emitCheckedOp(const OpAtom &op);
+    std::string cTypeName(const TypePtr &type);
     void emitType(const TypePtr &type);
     void emitExpr(const Expr &expr);
     void emitAtom(const Atom &atom);
@@ -103,17 +276,24 @@ namespace symir {
     /// otherwise.
     void emitVecAssign(const LValue &lhs, const Expr &rhs, const VecType &vt);
 
+    /// Vector assignment through the strategy's native chunk hooks
+    /// (VecLowering::nativeChunks): arithmetic, `cmp` and mask-form
+    /// `select`. Emits nothing and returns false when any part of the RHS
+    /// has no native form, leaving it to the lane-unroll path.
+    bool emitVecNativeAssign(const LValue &lhs, const Expr &rhs, const VecType &vt);
+    /// Chunk `c` of a vector Atom / Coef / SelectVal; "" if not native.
+    std::string vecNativeAtomChunk(const Atom &a, const VecType &vt, std::size_t c);
+    std::string vecNativeCoefChunk(const Coef &cf, const VecType &vt, std::size_t c);
+    std::string vecNativeSelectValChunk(const SelectVal &sv, const VecType &vt, std::size_t c);
+    /// `__builtin_trap()` on any non-finite lane of the FP vector `name`.
+    void emitVecFiniteChecks(const std::string &name, const VecType &vt);
+
     // Look up a struct field by name; returns nullptr if either the
     // struct or the field is unknown.
     TypePtr findStructFieldType(const std::string &structName, const std::string &fieldName) const;
     // Look up a struct field by declaration-order index; returns nullptr
     // if the struct is unknown or the index is out of range.
     TypePtr getStructFieldTypeAt(const std::string &structName, size_t idx) const;
-
-    // --- Mangling and naming helpers ---
-    std::string getMangledSymbolName(const std::string &funcName, const std::string &symName);
-    std::string mangleName(const std::string &name);
-    std::string stripSigil(const std::string &name);
   };
 
 } // namespace symir
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -8,6 +9,39 @@
 
 namespace symir {
 
+  /// Lane-wise binary operators of the native vector hooks below.
+  enum class VecOp { Add, Sub, Mul, Div, And, Or, Xor, Shl, Shr, LShr };
+
+  /// How much of SymIR's undefined behavior the emitted C checks itself
+  /// (`symirc --ub-checks`).
+  enum class UbChecks {
+    /// No checks: the fastest code, with SymIR UB left to whatever C
+    /// makes of it.
+    None,
+    /// Inline checks of the scalar UB rules UBSan would otherwise catch
+    /// too, so no sanitizer build is needed. A failed check calls
+    /// `SYMIR_UB_TRAP(rule)`, a macro the C file defines to
+    /// `__builtin_trap()` unless the includer did.
+    Explicit,
+    /// The checks no sanitizer makes (FP results, pointer navigation,
+    /// vector lanes); the rest is left to UBSan (the default).
+    Sanitizer,
+  };
+
+  /// The statement a failed check of UB rule `rule` (docs/UB.md) runs
+  /// under `checks`; "" under None, where the check is left out.
+  inline std::string ubTrap(UbChecks checks, int rule) {
+    switch (checks) {
+      case UbChecks::None:
+        return "";
+      case UbChecks::Explicit:
+        return "SYMIR_UB_TRAP(" + std::to_string(rule) + ")";
+      case UbChecks::Sanitizer:
+        break;
+    }
+    return "__builtin_trap()";
+  }
+
   /**
    * VecLowering — abstract strategy that controls how the C backend lowers
    * `<N> T` vector locals and operations. Four built-in strategies are
@@ -63,6 +97,34 @@ namespace symir {
         std::ostream &out, const std::string &lhs, const std::string &rhs, const VecType &vt
     ) = 0;
 
+    /// Whole-vector load of `name` from the N consecutive lanes the C
+    /// pointer `elems` points to (`&a[i]`), as one copy where the lanes lie
+    /// in memory like the elements of an array; lane by lane otherwise.
+    /// Emits statement(s) without a trailing semicolon.
+    virtual void emitLoadContiguous(
+        std::ostream &out, const std::string &name, const VecType &vt, const std::string &elems
+    ) {
+      for (std::size_t k = 0; k < vt.size; ++k) {
+        if (k)
+          out << "; ";
+        std::string lane = std::to_string(k);
+        emitLaneWrite(out, name, vt, lane, "(" + elems + ")[" + lane + "]");
+      }
+    }
+
+    /// Whole-vector store of `name` to the N consecutive lanes at `elems`,
+    /// the counterpart of emitLoadContiguous.
+    virtual void emitStoreContiguous(
+        std::ostream &out, const std::string &elems, const std::string &name, const VecType &vt
+    ) {
+      for (std::size_t k = 0; k < vt.size; ++k) {
+        if (k)
+          out << "; ";
+        std::string lane = std::to_string(k);
+        out << "(" << elems << ")[" << lane << "] = " << emitLaneRead(name, vt, lane);
+      }
+    }
+
     /// May a vector cross a C function boundary? `false` for `scalars`
     /// (multiple identifiers can't be one return value) and `array` (C
     /// decays arrays to pointers); the C backend refuses to emit a vector
@@ -75,6 +137,90 @@ namespace symir {
     /// `scalars`, `array`, `structscalars`, `structarray` all return true
     /// so the C backend emits per-lane statements at AssignInstr.
     virtual bool needsLaneUnroll() const = 0;
+
+    /// Text closing what `emitPreamble` opened, emitted at the end of the
+    /// file when the preamble was.
+    virtual void emitEpilogue(std::ostream &out) { (void) out; }
+
+    // --- Native vector operations (optional) ---
+    //
+    // A strategy that lowers vector arithmetic to SIMD instructions works on
+    // chunks: the native registers a vector is split into, chunk `c` holding
+    // lanes [c*W, (c+1)*W) for the strategy's W. The C backend builds one C
+    // expression per chunk from these hooks and stores it back, so the lanes
+    // of a chunk may only depend on the same lanes of the operands. Any hook
+    // returning "" means "no native form": the backend then unrolls lanes
+    // instead, for the whole instruction.
+
+    /// Number of chunks of `vt`; 0 when its lanes have no native form (the
+    /// default), which also keeps the backend from calling the hooks below.
+    virtual std::size_t nativeChunks(const VecType &vt) const {
+      (void) vt;
+      return 0;
+    }
+
+    /// Chunk `c` of the vector variable `name`.
+    virtual std::string loadChunk(const std::string &name, const VecType &vt, std::size_t c) {
+      (void) name, (void) vt, (void) c;
+      return "";
+    }
+
+    /// A chunk with every lane set to the scalar C expression `scalar`.
+    virtual std::string broadcastChunk(const std::string &scalar, const VecType &vt) {
+      (void) scalar, (void) vt;
+      return "";
+    }
+
+    /// Lane-wise `a op b` of two chunks, both chunk `c` of a `vt` value.
+    virtual std::string binaryChunk(
+        VecOp op, const VecType &vt, std::size_t c, const std::string &a, const std::string &b
+    ) {
+      (void) op, (void) vt, (void) c, (void) a, (void) b;
+      return "";
+    }
+
+    /// Lane-wise `~a` of a chunk.
+    virtual std::string notChunk(const VecType &vt, const std::string &a) {
+      (void) vt, (void) a;
+      return "";
+    }
+
+    /// Statement (no trailing semicolon) storing `value` as chunk `c` of
+    /// the vector variable `name`.
+    virtual std::string storeChunk(
+        const std::string &name, const VecType &vt, std::size_t c, const std::string &value
+    ) {
+      (void) name, (void) vt, (void) c, (void) value;
+      return "";
+    }
+
+    /// Statement (no trailing semicolon) setting the lanes of chunk `c` of
+    /// the `<N> i1` variable `mask` to `a op b`, where `a` and `b` are
+    /// chunks of operands of type `vt`.
+    virtual std::string compareChunk(
+        const std::string &mask, RelOp op, const VecType &vt, std::size_t c, const std::string &a,
+        const std::string &b
+    ) {
+      (void) mask, (void) op, (void) vt, (void) c, (void) a, (void) b;
+      return "";
+    }
+
+    /// Chunk `c` of the lane-wise `mask ? t : f`, where `mask` is an
+    /// `<N> i1` variable and `t` and `f` are chunks of type `vt`.
+    virtual std::string selectChunk(
+        const std::string &mask, const VecType &vt, std::size_t c, const std::string &t,
+        const std::string &f
+    ) {
+      (void) mask, (void) vt, (void) c, (void) t, (void) f;
+      return "";
+    }
+
+    /// The checks of the UB the strategy's own code can hit; set by the C
+    /// backend.
+    void setUbChecks(UbChecks checks) { ubChecks_ = checks; }
+
+  protected:
+    UbChecks ubChecks_ = UbChecks::Sanitizer;
   };
 
   /**
@@ -82,11 +228,27 @@ namespace symir {
    * `symirc` is "vecext".
    *
    * Built-in names:
-   *   "vecext"  — GCC/Clang vector_size attribute (Phase 1)
-   *   "struct"  — packed struct { T lanes[N]; }   (Phase 2)
-   *   "scalars" — N separate scalars               (Phase 2)
-   *   "array"   — T[N]                              (Phase 2)
+   *   "vecext"     — GCC/Clang vector_size attribute (Phase 1)
+   *   "struct"     — packed struct { T lanes[N]; }   (Phase 2)
+   *   "scalars"    — N separate scalars               (Phase 2)
+   *   "array"      — T[N]                              (Phase 2)
+   *   "intrinsics" — SSE4/AVX2/AVX-512/NEON intrinsics, for the "sse4"
+   *                  target (see makeIntrinsicsLowering)
    */
   std::unique_ptr<VecLowering> makeVecLowering(const std::string &name);
 
+  /**
+   * The "intrinsics" strategy for `target`: "sse4" (SSE4.2), "avx2",
+   * "avx512" (F, BW, DQ and VL) or "neon" (AArch64). Returns nullptr for
+   * unknown targets.
+   *
+   * Vectors are structs of lanes padded to whole registers. Arithmetic,
+   * `cmp` and mask-form `select` on 8/16/32/64-bit integer and f32/f64
+   * lanes map to the target's intrinsics, one register at a time, integer
+   * `+`/`-` trapping on signed overflow; integer `*`, `/`, `%`, shifts,
+   * casts and odd lane widths are unrolled lane by lane. The emitted file
+   * enables the target with `#pragma` itself.
+   */
+  std::unique_ptr<VecLowering> makeIntrinsicsLowering(const std::string &target);
+
 } // namespace symir
@@ -5,7 +5,11 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include "analysis/cfg.hpp"
+#include "analysis/structure.hpp"
+#include "analysis/transforms.hpp"
 #include "ast/ast.hpp"
+#include "ast/type_annotations.hpp"
 
 namespace symir {
 
@@ -31,12 +35,31 @@ namespace symir {
 
     void setNoRequire(bool val) { noRequire_ = val; }
 
+    /**
+     * Lowers vector arithmetic, `cmp` and mask-form `select` to SIMD128
+     * (`v128`) instructions, 16 bytes at a time, for vectors of 8/16/32/
+     * 64-bit integer or f32/f64 lanes whose size is a multiple of 16
+     * bytes. Anything else is still unrolled lane by lane.
+     */
+    void setSimd(bool val) { simd_ = val; }
+
+    /// Threads to emit the functions on (0 = one per hardware thread; see
+    /// forEachFunction()). The module header, memory and stack pointer are
+    /// emitted on the caller.
+    void setNumThreads(unsigned n);
+
   private:
+    /// A worker emitting functions of the program `parent` is emitting
+    /// into `out`; it shares the parent's settings and struct layouts.
+    WasmBackend(const WasmBackend &parent, std::ostream &out);
+
     std::ostream &out_;
+    unsigned numThreads_ = 1;
     int indent_level_ = 0;
     std::string curFuncName_;
     bool noModuleTags_ = false;
     bool noRequire_ = false;
+    bool simd_ = false;
 
     // Maps local/param names to their WASM local index or info
     struct LocalInfo {
@@ -65,6 +88,8 @@ namespace symir {
     };
 
     std::unordered_map<std::string, StructInfo> structLayouts_;
+    // The checker's node types (Program::types); null if not type checked.
+    const TypeAnnotations *nodeTypes_ = nullptr;
 
     // --- Emission helpers ---
     void indent();
@@ -92,11 +117,28 @@ namespace symir {
         std::uint32_t srcOffset
     );
     void emitAddress(const LValue &lv);
+    /// One function (locals, body and export).
+    void emitFunction(const FunDecl &f);
+    void emitInstr(const Instr &ins);
+    /// The instructions of `b`, a lane run (findLaneRuns) as v128 loads
+    /// and stores where SIMD128 moves the whole vector.
+    void emitInstrs(const Block &b);
+    bool emitLaneRun(const LaneRun &run);
+    void emitRet(const RetTerm &rt, const FunDecl &f);
+
+    // --- Control flow ---
+    // A reducible CFG becomes nested `block`/`loop`/`if` with direct `br`s
+    // (see StructuredCfg): a merge block gets a `block`, a loop header a
+    // `loop`. An irreducible CFG keeps the `br_table` dispatch loop over
+    // all blocks.
+    void emitStructuredTree(const StructuredCfg &sc, std::size_t b);
+    void emitStructuredWithin(const StructuredCfg &sc, std::size_t b, std::size_t firstChild);
+    void emitStructuredBranch(const StructuredCfg &sc, std::size_t from, const BlockLabel &to);
+    void emitDispatchLoop(const FunDecl &f);
 
     TypePtr getLValueType(const LValue &lv);
     TypePtr getSelectValType(const SelectVal &sv);
-    // TODO: Support native WebAssembly SIMD-128 (v128) lowering for vectors as planned
-    // in SPEC v0.2.1 §10.16. Currently vectors are lowered by unrolling operations lane-by-lane.
+    // Vectors are unrolled lane by lane, unless setSimd() applies (below).
     void emitVecExprLane(
         const Expr &expr, const VecType &vt, std::uint64_t lane, std::uint32_t targetWidth,
         bool isFloat
@@ -118,6 +160,25 @@ namespace symir {
         bool isFloat
     );
 
+    // --- SIMD128 (setSimd) ---
+    // A vector local lives on the shadow stack with its lanes in order, so
+    // chunk `c` is the 16 bytes at lane c*16/sizeof(T). These helpers push
+    // one chunk as a v128.
+
+    /// `i32x4` etc. for `vt`; nullptr when `vt` has no SIMD128 form.
+    const char *simdShape(const VecType &vt);
+    /// Whether emitVecSimdAssign can lower `lhs = rhs` (nothing emitted).
+    bool canSimdAssign(const LValue &lhs, const Expr &rhs, const VecType &vt);
+    bool canSimdAtom(const Atom &atom);
+    bool canSimdCoef(const Coef &coef);
+    bool isSimdVecLocal(const std::string &name);
+    /// Emits `lhs = rhs` as v128 operations if canSimdAssign; else false.
+    bool emitVecSimdAssign(const LValue &lhs, const Expr &rhs, const VecType &vt);
+    void emitSimdAddress(const std::string &name, std::uint32_t byteOffset);
+    void emitSimdAtom(const Atom &atom, const VecType &vt, std::uint64_t chunk);
+    void emitSimdCoef(const Coef &coef, const VecType &vt, std::uint64_t chunk);
+    void emitSimdSelectVal(const SelectVal &sv, const VecType &vt, std::uint64_t chunk);
+
     // --- Naming and structure ---
     std::string mangleName(const std::string &name);
     std::string stripSigil(const std::string &name);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+namespace symir {
+
+  /**
+   * Assembles the WAT emitted by WasmBackend into a binary `.wasm` module
+   * (`symirc --target wasm-bin`), in memory, so that running the output
+   * needs no external assembler.
+   *
+   * Only the subset of the text format that WasmBackend produces is
+   * accepted: one `(module ...)` holding function imports, a memory,
+   * globals with a constant initializer, functions whose bodies are flat
+   * instructions (with folded `block`/`loop` and `if (result T)`), and
+   * function exports. Anything else throws std::runtime_error.
+   */
+  class WasmBinaryEncoder {
+  public:
+    /// With `names`, appends a "name" section naming functions and locals.
+    explicit WasmBinaryEncoder(bool names = false) : names_(names) {}
+
+    /// The bytes of the module in `wat`.
+    std::string encode(const std::string &wat) const;
+
+  private:
+    bool names_;
+  };
+
+} // namespace symir
@@ -18,6 +18,7 @@ namespace symir {
     constexpr int StaticError = 4;       // type / semantic / CFG analysis error
     constexpr int UndefinedBehavior = 5; // runtime undefined behavior
     constexpr int RequireViolation = 6;  // require assertion failed
+    constexpr int BudgetExhausted = 7;   // step or time budget of a run used up
   } // namespace ExitCode
 
   /**
@@ -36,4 +37,12 @@ namespace symir {
     explicit RequireViolationError(const std::string &msg) : std::runtime_error(msg) {}
   };
 
+  /**
+   * Thrown by the interpreter when a run exceeds the step or time budget
+   * it was given (symiri --max-steps / --max-ms).
+   */
+  struct BudgetExhaustedError : std::runtime_error {
+    explicit BudgetExhaustedError(const std::string &msg) : std::runtime_error(msg) {}
+  };
+
 } // namespace symir
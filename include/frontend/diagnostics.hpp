@@ -1,6 +1,8 @@
 #pragma once
 
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "ast/ast.hpp"
 
@@ -29,6 +31,18 @@ namespace symir {
       diags.push_back(Diagnostic{DiagLevel::Note, msg, sp});
     }
 
+    /// Appends the diagnostics of `other`, keeping their order.
+    void merge(DiagBag &&other) {
+      if (diags.empty()) {
+        diags = std::move(other.diags);
+        return;
+      }
+      diags.insert(
+          diags.end(), std::make_move_iterator(other.diags.begin()),
+          std::make_move_iterator(other.diags.end())
+      );
+    }
+
     bool hasErrors() const {
       for (const auto &d: diags)
         if (d.level == DiagLevel::Error)
@@ -45,7 +59,7 @@ namespace symir {
   };
 
   void printMessage(
-      std::ostream &os, const std::string &src, const SourceSpan &span, const std::string &msg,
+      std::ostream &os, std::string_view src, const SourceSpan &span, const std::string &msg,
       DiagLevel level = DiagLevel::Error
   );
 
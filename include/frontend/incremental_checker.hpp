@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ast/ast.hpp"
+#include "frontend/diagnostics.hpp"
+
+namespace symir {
+
+  /**
+   * Checks successive versions of one module, redoing only the top-level
+   * declarations that changed: the engine behind symir-lsp.
+   *
+   * The text is cut into pieces at every line that starts (in column 1,
+   * outside comments) with `fun` or `struct`. A piece is lexed, parsed and
+   * checked on its own and its results are kept, keyed by its text, so an
+   * edit costs one declaration however large the module is. A function is
+   * checked against the module's structs and is checked again only when a
+   * struct piece changes; the structs are checked once per version of
+   * them. A piece that fails to parse does not hide the diagnostics of the
+   * others.
+   *
+   * Each piece is lexed at a position of its own (its serial number times
+   * 2^40), so results stay valid when an edit above moves the piece, and a
+   * diagnostic names the piece it belongs to; update() maps them back to
+   * positions in the current text.
+   */
+  class IncrementalChecker {
+  public:
+    /// What the last update() did.
+    struct Stats {
+      std::size_t pieces = 0;  // top-level pieces of the text
+      std::size_t parsed = 0;  // of those, lexed and parsed anew
+      std::size_t checked = 0; // pieces with functions checked anew
+    };
+
+    IncrementalChecker();
+    ~IncrementalChecker();
+
+    /// Takes `text` as the new version of the module and returns all its
+    /// diagnostics, with spans in `text`.
+    std::vector<Diagnostic> update(std::string_view text);
+
+    const Stats &stats() const { return stats_; }
+
+  private:
+    struct Piece;
+    struct TextHash {
+      using is_transparent = void;
+      std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    static void parse(Piece &piece);
+    // Checks the functions of `piece` against structs_.
+    void checkFunctions(Piece &piece);
+
+    // Pieces of the last version by text; identical pieces are listed in turn.
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Piece>>, TextHash, std::equal_to<>>
+        pieces_;
+    std::uint64_t nextSerial_ = 1;
+    // The structs of the module, the serials of the pieces declaring them,
+    // and the diagnostics of checking them.
+    std::vector<StructDecl> structs_;
+    std::vector<std::uint64_t> structSerials_;
+    std::vector<Diagnostic> structDiags_;
+    Stats stats_;
+  };
+
+} // namespace symir
@@ -1,8 +1,8 @@
 #pragma once
 
+#include <deque>
 #include <string>
 #include <string_view>
-#include <vector>
 #include "ast/ast.hpp"
 
 namespace symir {
@@ -84,30 +84,41 @@ namespace symir {
 
   /**
    * Represents a single lexical token.
+   *
+   * `lexeme` is a slice of the source text, except for string literals
+   * with escapes, whose decoded text the Lexer owns. Either way it lives
+   * as long as the Lexer and its source.
    */
   struct Token {
     TokenKind kind;
-    std::string lexeme;
+    std::string_view lexeme;
     SourceSpan span;
   };
 
   /**
    * Lexical analyzer for the SymIR language.
-   * Converts a source string into a sequence of tokens.
+   * Converts a source string into a sequence of tokens, one at a time.
    */
   class Lexer {
   public:
+    /// `src` must outlive the Lexer and the tokens it returns.
     explicit Lexer(std::string_view src);
+    /// Lexes `src` as text found at `start`: token positions count from
+    /// there, so a piece of a larger file gets positions in that file.
+    Lexer(std::string_view src, SourcePos start);
     /**
-     * Lexes the entire source and returns a vector of tokens.
+     * Lexes and returns the next token; End once the source is exhausted,
+     * and again on every later call.
      */
-    std::vector<Token> lexAll();
+    Token next();
 
   private:
     std::string_view src_;
+    std::size_t base_ = 0; // offset of src_[0]
     std::size_t i_ = 0;
     int line_ = 1;
     int col_ = 1;
+    std::deque<std::string> decoded_; // string literals with escapes
 
     char peek(std::size_t k = 0) const;
     char get();
@@ -117,8 +128,10 @@ namespace symir {
     static bool isIdentStart(char c);
     static bool isIdentCont(char c);
 
-    Token make(TokenKind k, std::string lex, SourcePos b, SourcePos e);
-    Token next();
+    // A token of the source text from `b` to `e`.
+    Token make(TokenKind k, SourcePos b, SourcePos e) const;
+    // The identifier characters at the cursor.
+    std::string_view scanIdent();
   };
 
 } // namespace symir
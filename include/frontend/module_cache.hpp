@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "analysis/analysis_manager.hpp"
+#include "analysis/pass_manager.hpp"
+#include "ast/ast.hpp"
+#include "frontend/diagnostics.hpp"
+
+namespace symir {
+
+  /**
+   * A directory of type-checked modules, so a tool that is handed a file
+   * it (or another tool) has checked before skips lexing, parsing and
+   * checking it.
+   *
+   * An entry is keyed by the source text and the names of the passes that
+   * checked it, and holds the Program (strings, node ids, spans), its
+   * TypeAnnotations, the CFG of every function and the diagnostics the
+   * passes reported. Entries are written in a compact versioned binary
+   * format, one file each, and memory-mapped to load them. Only modules the
+   * passes accepted are stored. Unreadable, stale or foreign entries count
+   * as misses; any process may share the directory.
+   */
+  class ModuleCache {
+  public:
+    /// Uses (and creates) the directory `dir`.
+    explicit ModuleCache(const std::string &dir);
+
+    /**
+     * Loads the module checked from `source` by `pipeline` into `prog`,
+     * appends its diagnostics to `diags` and hands its CFGs to `am`.
+     * False (with nothing changed) on a miss.
+     */
+    bool load(
+        std::string_view source, const std::string &pipeline, Program &prog, DiagBag &diags,
+        AnalysisManager &am
+    ) const;
+
+    /// Stores `prog`, checked from `source` by `pipeline` with the
+    /// diagnostics `diags`. Failures to write are ignored.
+    void store(
+        std::string_view source, const std::string &pipeline, const Program &prog,
+        const DiagBag &diags, AnalysisManager &am
+    ) const;
+
+  private:
+    std::string pathOf(std::string_view source, const std::string &pipeline) const;
+
+    std::string dir_;
+  };
+
+  /**
+   * Lexes, parses and checks `source` with `pm` into `prog`, or loads the
+   * result from `cache` when it has it (a null cache is always a miss). A
+   * module the passes accept is stored back. Lex and parse errors throw as
+   * from Parser::parseProgram().
+   */
+  PassResult
+  parseAndCheck(std::string_view source, PassManager &pm, const ModuleCache *cache, Program &prog);
+
+} // namespace symir
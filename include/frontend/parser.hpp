@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
 #include <vector>
 #include "ast/ast.hpp"
 #include "frontend/lexer.hpp"
@@ -9,23 +11,45 @@ namespace symir {
   /**
    * Recursive-descent parser for the SymIR language.
    * Transforms a sequence of tokens into a structured AST (Program).
+   *
+   * Tokens are pulled from the Lexer as the parser looks ahead and are
+   * dropped once consumed, so memory stays bounded by the longest
+   * alternative the parser may backtrack over (one atom).
    */
   class Parser {
   public:
-    explicit Parser(std::vector<Token> toks);
+    /// Parses the tokens of `lexer`, which must outlive the Parser.
+    explicit Parser(Lexer &lexer);
     /**
      * Entry point for parsing a complete SymIR program.
      */
     Program parseProgram();
 
   private:
-    std::vector<Token> toks_;
+    struct Backtrack;
+
+    Lexer &lexer_;
+    std::shared_ptr<AstArena> arena_; // holds the InitVal/Atom nodes parsed
+    std::vector<Instr> instrScratch_;
+    std::vector<Block> blockScratch_;
+    // Lookahead window, filled by peek(): the tokens from the one before
+    // idx_ (for prevEnd()), or from the oldest Backtrack point, on.
+    // window_[0] is token number base_.
+    mutable std::deque<Token> window_;
+    mutable std::size_t base_ = 0;
     std::size_t idx_ = 0;
+    int pins_ = 0; // live Backtrack points
+    NodeId nextNodeId_ = 1; // for the LValues and Atoms parsed
+    // Time spent in the Lexer and tokens lexed, under --time-passes.
+    mutable std::uint64_t lexNs_ = 0;
+    mutable std::uint64_t lexTokens_ = 0;
 
+    Token lex() const;
     const Token &peek(std::size_t k = 0) const;
     bool is(TokenKind k) const;
-    const Token &consume(TokenKind k, const char *what);
+    Token consume(TokenKind k, const char *what);
     bool tryConsume(TokenKind k);
+    void advance();
     [[noreturn]] void errorHere(const std::string &msg) const;
 
     // --- Sub-parsers for different AST components ---
@@ -35,6 +59,7 @@ namespace symir {
     BlockLabel parseBlockLabel();
 
     TypePtr parseType();
+    TypePtr parseType(SourceSpan &span); // also reports where the type is written
     SourcePos prevEnd() const;
 
     StructDecl parseStructDecl();
@@ -69,6 +94,7 @@ namespace symir {
     RelOp parseRelOp();
     Expr parseExpr();
     Atom parseAtom();
+    Atom parseAtomForm(); // parseAtom() without numbering the result
     AtomOpKind parseAtomOp();
     SelectVal parseSelectVal();
   };
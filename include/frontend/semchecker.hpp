@@ -18,7 +18,7 @@ namespace symir {
     /**
      * Executes the semantic checker on the program.
      */
-    symir::PassResult run(Program &prog, DiagBag &diags) override;
+    symir::PassResult run(Program &prog, DiagBag &diags, AnalysisManager &am) override;
 
   private:
     void checkStruct(const StructDecl &s, DiagBag &diags);
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "analysis/analysis_manager.hpp"
+#include "analysis/pass_manager.hpp"
+#include "ast/ast.hpp"
+#include "frontend/diagnostics.hpp"
+#include "frontend/module_cache.hpp"
+#include "json.hpp"
+#include "solver/work_pool.hpp"
+
+namespace symir {
+
+  /**
+   * A module a long-running tool has read and checked, with its CFGs.
+   *
+   * Its names are interned in a SymbolTable of its own, which goes with
+   * the module: enter `symbols` (SymbolTable::Scope) before touching the
+   * module, as requestModule()'s callers do.
+   */
+  struct LoadedModule {
+    mutable SymbolTable symbols;
+    std::string input;  // file name, or empty for a module sent as text
+    std::string source; // the text it was checked from
+    Program prog;
+    DiagBag diags;
+    std::string error; // rendered lex, parse and check errors; empty if usable
+    // CFGs built by the checker, reused by every request on the module
+    mutable AnalysisManager analyses;
+
+    /// The warnings, rendered as the tools print them.
+    std::string warnings() const;
+  };
+
+  /**
+   * Checked modules by file name (or by text), shared by the requests of a
+   * batch or a server.
+   *
+   * The first request for a module loads it; concurrent requests for the
+   * same module wait for that load instead of repeating it. A file is
+   * loaded again when its modification time or size has changed since.
+   * Every module is checked by the same pipeline, the passes the tool
+   * otherwise runs on its input.
+   */
+  class ModuleStore {
+  public:
+    using Pipeline = std::function<void(PassManager &)>;
+
+    /// `moduleCache` (may be null) must outlive the store.
+    ModuleStore(Pipeline pipeline, const ModuleCache *moduleCache);
+
+    std::shared_ptr<const LoadedModule> get(const std::string &path);
+    std::shared_ptr<const LoadedModule> getSource(const std::string &source);
+
+    /// Forgets the module of `path`; false if there was none.
+    bool drop(const std::string &path);
+
+    struct Stats {
+      std::size_t modules = 0;
+      uint64_t loads = 0, hits = 0;
+    };
+    Stats stats() const;
+
+  private:
+    using Entry = std::shared_future<std::shared_ptr<const LoadedModule>>;
+    struct Stamp {
+      int64_t mtime = -1;
+      int64_t size = -1;
+      bool operator==(const Stamp &) const = default;
+    };
+
+    std::shared_ptr<const LoadedModule>
+    lookup(const std::string &key, const Stamp &stamp, std::string input, std::string source);
+    void check(LoadedModule &m) const;
+
+    Pipeline pipeline_;
+    const ModuleCache *moduleCache_;
+    mutable std::mutex mu_;
+    std::map<std::string, std::pair<Stamp, Entry>> modules_; // by "file:" or "text:" key
+    uint64_t loads_ = 0, hits_ = 0;
+  };
+
+  /**
+   * JSON-RPC 2.0 server for the `--serve` mode of the tools: one message
+   * per line, on stdin/stdout or on the connections of a Unix socket.
+   *
+   * Requests run concurrently on a WorkPool and are answered as they
+   * finish, so answers may come out of order and are matched by `id`;
+   * notifications (no `id`) get none. `ping` and `shutdown` are built in:
+   * `shutdown` waits for the requests of its connection, answers, and
+   * stops the server. A handler gets the request's `params` (null if
+   * absent) and returns the JSON text of its result, or throws: an Error
+   * with its code, any other exception as a server error (-32000).
+   */
+  class RpcServer {
+  public:
+    struct Error : std::runtime_error {
+      Error(int code, const std::string &message) : std::runtime_error(message), code(code) {}
+      int code;
+    };
+    static constexpr int kParseError = -32700;
+    static constexpr int kInvalidRequest = -32600;
+    static constexpr int kMethodNotFound = -32601;
+    static constexpr int kInvalidParams = -32602;
+    static constexpr int kServerError = -32000;
+
+    using Handler = std::function<std::string(const json::Value &params)>;
+
+    /// 0 workers means std::thread::hardware_concurrency().
+    RpcServer(std::string name, unsigned numWorkers);
+
+    void on(const std::string &method, Handler handler);
+
+    /// Serves stdin until `shutdown` or its end. Replies go to the process'
+    /// stdout; anything else written to stdout meanwhile goes to stderr.
+    int serveStdio();
+
+    /// Serves the clients of a Unix socket created at `path` until one of
+    /// them sends `shutdown`. The socket file is removed at the end.
+    int serveUnix(const std::string &path);
+
+  private:
+    void serveConnection(int in, int out);
+    std::string dispatch(const json::Value &msg, const std::string &id);
+
+    std::string name_;
+    std::map<std::string, Handler> handlers_;
+    solver::WorkPool pool_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> requests_{0}, errors_{0};
+  };
+
+  /**
+   * The module methods of a server on `store`:
+   *
+   *   load  {input | source}  checks a module ahead of the requests on it,
+   *                           returns {"functions": [...], "warnings": ...}
+   *   drop  {input}           forgets a module, returns {"dropped": bool}
+   *   stats                   {"modules", "loads", "hits"}
+   */
+  void addModuleMethods(RpcServer &server, ModuleStore &store);
+
+  /// The usable module a request names by `input` (a file) or `source` (its
+  /// text). Throws an RpcServer::Error if there is none or it has errors.
+  std::shared_ptr<const LoadedModule> requestModule(ModuleStore &store, const json::Value &params);
+
+} // namespace symir
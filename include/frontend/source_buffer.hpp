@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace symir {
+
+  /**
+   * The text of a source file, mapped read-only into memory so the lexer
+   * can slice its tokens straight out of it. Inputs that cannot be mapped
+   * (pipes, empty files) are read into an owned buffer instead. The text
+   * stays at the same address for the lifetime of the buffer, also across
+   * moves.
+   */
+  class SourceBuffer {
+  public:
+    /// Maps (or reads) the file at `path`; nullopt if it cannot be opened
+    /// or read.
+    static std::optional<SourceBuffer> open(const std::string &path);
+
+    SourceBuffer(SourceBuffer &&other) noexcept;
+    SourceBuffer &operator=(SourceBuffer &&other) noexcept;
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+    ~SourceBuffer();
+
+    std::string_view text() const { return {data_, size_}; }
+
+  private:
+    SourceBuffer() = default;
+    void release();
+
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool mapped_ = false;   // data_ is an mmap() of size_ bytes
+    std::vector<char> own_; // else the text, if any
+  };
+
+} // namespace symir
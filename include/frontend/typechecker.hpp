@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 #include "analysis/pass_manager.hpp"
+#include "ast/type_annotations.hpp"
 
 namespace symir {
 
@@ -68,16 +69,10 @@ namespace symir {
     TypePtr structType() const { return std::get<StructTy>(v).type; }
   };
 
-  /**
-   * Stores type information for AST nodes after type checking.
-   */
-  struct TypeAnnotations {
-    std::unordered_map<NodeId, Ty> nodeTy;
-  };
-
   /**
    * Performs bitwidth-aware type checking on the SymIR AST.
    * Ensures that bitwidths match across assignments and operations.
+   * The node types it resolves are left in `Program::types`.
    */
   class TypeChecker : public symir::ModulePass {
   public:
@@ -86,7 +81,7 @@ namespace symir {
     /**
      * Executes the type checker on the program.
      */
-    symir::PassResult run(Program &prog, DiagBag &diags) override;
+    symir::PassResult run(Program &prog, DiagBag &diags, AnalysisManager &am) override;
 
   private:
     struct StructInfo {
@@ -95,7 +90,7 @@ namespace symir {
       SourceSpan declSpan;
     };
 
-    std::unordered_map<std::string, StructInfo> structs_;
+    std::unordered_map<Symbol, StructInfo> structs_;
 
     struct VarInfo {
       TypePtr type;
@@ -112,52 +107,54 @@ namespace symir {
 
     // --- Internal type checking helpers ---
     void collectStructs(const Program &prog, DiagBag &diags);
-    void checkFunction(const FunDecl &f, TypeAnnotations &ann, DiagBag &diags);
+    void checkFunction(
+        const FunDecl &f, TypeAnnotations &ann, DiagBag &diags, AnalysisManager &am
+    );
 
     void checkInitVal(
         const InitVal &iv, const TypePtr &targetType,
-        const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags
+        const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, DiagBag &diags
     );
 
     Ty typeOfExpr(
-        const Expr &e, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
+        const Expr &e, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
         std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx = nullptr
     );
 
     Ty typeOfAtom(
-        const Atom &a, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
+        const Atom &a, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
         std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx = nullptr
     );
 
     TypePtr typeOfLValue(
-        const LValue &lv, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags
+        const LValue &lv, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags
     );
 
     void checkIndex(
-        const Index &idx, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags
+        const Index &idx, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, DiagBag &diags
     );
 
     TypePtr typeOfCoef(
-        const Coef &c, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags,
+        const Coef &c, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, DiagBag &diags,
         std::optional<std::uint32_t> expectedBits,
         TypePtr ptrCtx = nullptr // non-null only when null literal needs ptr type resolution
     );
 
     Ty typeOfSelectVal(
-        const SelectVal &sv, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
+        const SelectVal &sv, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
         std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx = nullptr
     );
 
     void checkCond(
-        const Cond &c, const std::unordered_map<std::string, VarInfo> &vars,
-        const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags
+        const Cond &c, const std::unordered_map<Symbol, VarInfo> &vars,
+        const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags
     );
 
     void checkLiteralRange(int64_t val, std::uint32_t bits, SourceSpan sp, DiagBag &diags);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "interp/interpreter.hpp"
+
+namespace symir {
+
+  /**
+   * A function lowered for the bytecode engine of the Interpreter.
+   *
+   * Every sym and let owns a frame slot, and the temporaries of each
+   * instruction take the slots after them, so nothing is looked up by name
+   * while running. Operands are decoded once into slot, constant or lvalue
+   * path reads, and jump targets are instruction indices. Each block starts
+   * with an Enter naming it, which runPath() checks against the path.
+   *
+   * The instructions evaluate in the AST walker's order and share its
+   * scalar semantics (Interpreter::applyScalar() and friends), so both
+   * engines print the same results and report the same UB.
+   */
+  struct Interpreter::Bytecode {
+    enum class Op : std::uint8_t {
+      Enter,       // dst = block
+      Move,        // dst = a
+      Apply,       // dst = a <sub: AtomOpKind> b
+      Not,         // dst = ~a
+      Cmp,         // dst = cmp <sub: RelOp> a, b
+      Cast,        // dst = a as types[target]
+      AddSub,      // dst = dst <sub: AddOp> b
+      Set,         // slot dst = a
+      SetPath,     // paths[dst] = a
+      Jump,        // goto target
+      CondJump,    // goto (a <sub: RelOp> b) ? target : alt
+      MaskJump,    // goto a != 0 ? target : alt
+      Br,          // block terminator: goto target
+      CondBr,      // block terminator: goto (a <sub: RelOp> b) ? target : alt
+      Assume,      // a <sub: RelOp> b
+      Require,     // a <sub: RelOp> b, else messages[target]
+      Ret,         // return a
+      RetVoid,     // return
+      Unreachable, // trap
+    };
+
+    struct Operand {
+      enum class Kind : std::uint8_t { Slot, Const, Path };
+      Kind kind = Kind::Slot;
+      bool checked = false;    // an rvalue: reading undef is UB
+      std::uint32_t index = 0; // slot, constant or path
+    };
+
+    // One access of an lvalue: `[const]`, `[slot]` or `.field`.
+    struct Step {
+      enum class Kind : std::uint8_t { Const, Slot, Field };
+      Kind kind = Kind::Const;
+      std::uint32_t index = 0; // constant or slot of the index, or field index
+    };
+
+    struct Path {
+      std::uint32_t base = 0; // slot
+      std::vector<Step> steps;
+    };
+
+    struct Instr {
+      Op op = Op::Unreachable;
+      std::uint8_t sub = 0;
+      std::uint32_t dst = 0;
+      Operand a, b;
+      std::uint32_t target = 0;
+      std::uint32_t alt = 0;
+    };
+
+    // Slot i < slotNames.size() holds that sym or let; the rest are
+    // temporaries.
+    std::vector<std::string> slotNames;
+    std::uint32_t frameSize = 0;
+    std::uint32_t entry = 0;
+    std::vector<Instr> code;
+    std::vector<RuntimeValue> consts;
+    std::vector<Path> paths;
+    std::vector<TypePtr> types;
+    std::vector<std::string> messages;
+    std::vector<std::string> labels; // block index -> label
+    std::vector<std::uint32_t> starts; // block index -> its Enter
+
+    struct Builder;
+  };
+
+} // namespace symir
@@ -1,11 +1,21 @@
 #pragma once
 
-#include <list>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <variant>
 #include <vector>
+#include "analysis/analysis_manager.hpp"
+#include "analysis/cfg.hpp"
 #include "ast/ast.hpp"
+#include "interp/profile.hpp"
+#include "interp/trace.hpp"
 
 namespace symir {
 
@@ -16,7 +26,21 @@ namespace symir {
    */
   class Interpreter {
   public:
+    /**
+     * How function bodies are executed. Bytecode lowers each function once
+     * into a slot-indexed register program (see interp/bytecode.hpp) and
+     * runs it in a dispatch loop; Ast walks the AST against a name-keyed
+     * store and is the reference. Functions outside the bytecode subset
+     * (pointers, vectors, parameters) and traced runs always use Ast.
+     */
+    enum class Engine { Ast, Bytecode };
+
     explicit Interpreter(const Program &prog);
+    ~Interpreter();
+
+    void setEngine(Engine engine) { engine_ = engine; }
+    // Where run() prints the `Result:` line (std::cout by default).
+    void setOutput(std::ostream &out) { out_ = &out; }
     /**
      * Executes the specified entry function with given symbolic bindings.
      * @param entryFuncName The name of the function to start execution from.
@@ -28,30 +52,269 @@ namespace symir {
     void
     run(const std::string &entryFuncName, const SymBindings &symBindings, bool dumpExec = false);
 
+    /**
+     * Makes run() also record its trace into `writer` (null: no binary
+     * trace). `filter` selects the events of both this and the text dump.
+     * Traced runs use the AST walker; runPath() and call() never trace.
+     */
+    void setTrace(TraceWriter *writer, TraceFilter filter = {}) {
+      trace_ = writer;
+      traceFilter_ = std::move(filter);
+      traceIds_.clear();
+    }
+
+    /**
+     * Makes run() fill `profile` (null: no profiling), which it resets
+     * first; it is complete even when the run ends in UB. Profiled runs use
+     * the AST walker; runPath() and call() never profile.
+     */
+    void setProfile(Profile *profile) { profile_ = profile; }
+
+    /**
+     * Makes call() also append the CFG index of every block it enters to
+     * `log` (null: no log), which each call() clears first. Logged calls
+     * use the AST walker.
+     */
+    void setBlockLog(std::vector<std::size_t> *log) { blockLog_ = log; }
+
+    /// Limits of one run: blocks entered and wall time (0 = unlimited).
+    struct Budget {
+      std::uint64_t maxSteps = 0;
+      std::uint64_t maxMs = 0;
+    };
+
+    /**
+     * Bounds every later run(), runPath() and call(), and each row of
+     * callBatch(), by `budget`. A run that would enter one block more than
+     * `maxSteps`, or is still running after `maxMs`, throws
+     * BudgetExhaustedError (call() reports Status::BudgetExhausted). Each
+     * block entry costs one decrement; the clock is read every
+     * kClockBlocks blocks.
+     */
+    void setBudget(Budget budget) { budget_ = budget; }
+
+    /**
+     * Takes CFGs from `am` (which must outlive the interpreter and serve
+     * its Program) instead of a private cache, so the ones the checking
+     * passes built are reused.
+     */
+    void setAnalysisManager(AnalysisManager &am) { analyses_ = &am; }
+
+    /**
+     * Executes the entry function along `path` only, printing nothing.
+     * Returns false as soon as control leaves the path and true once the
+     * terminator of its last block has been evaluated. UB and failed
+     * assumptions or requirements throw as in run().
+     */
+    bool runPath(
+        const std::string &entryFuncName, const SymBindings &symBindings,
+        const std::vector<std::string> &path
+    );
+
+    struct Bytecode;
+
+    /**
+     * An entry function made ready for repeated call()s: its CFG, and its
+     * bytecode if the engine at prepare() time was Bytecode and the
+     * function is in the bytecode subset. Valid while the Interpreter that
+     * prepared it lives.
+     */
+    struct PreparedFunction {
+      const FunDecl *fun = nullptr;
+      const CFG *cfg = nullptr;
+      const Bytecode *bytecode = nullptr;
+    };
+
+    /// The outcome of one call(); nothing is printed.
+    struct CallResult {
+      enum class Status { Returned, UndefinedBehavior, RequireViolation, BudgetExhausted, Error };
+      Status status = Status::Returned;
+      // The returned scalar; empty for `ret;`.
+      std::optional<std::variant<std::int64_t, double>> value;
+      bool pointer = false; // value is the address of a returned pointer
+      // The UB, require or error message
+      std::string message;
+      // Blocks executed
+      std::uint64_t steps = 0;
+    };
+
+    PreparedFunction prepare(const std::string &entryFuncName);
+
+    /**
+     * Runs `fn` on `args` (one per parameter) and `symBindings`. Failures
+     * are reported in the result rather than thrown. The memory model is
+     * reset by clearing what the previous call allocated, and the
+     * name-to-type map is only rebuilt when the entry function changes.
+     */
+    CallResult call(
+        const PreparedFunction &fn, const std::vector<std::variant<std::int64_t, double>> &args,
+        const SymBindings &symBindings
+    );
+
+    /**
+     * As a call() of `fn` with no arguments per entry of `rows`, in order.
+     * Bytecode functions over scalar locals run the rows in lock-step
+     * (src/interp/batch.cpp): each slot is a column with one lane per row,
+     * and rows that branch apart run as separate groups that merge again
+     * where their paths meet. Other functions, and rows whose locals
+     * cannot share columns, run one call() at a time. Those rows share the
+     * symbol-independent prefix of the run (SymPrefix): it runs once, and
+     * each row forks from its end state.
+     */
+    std::vector<CallResult>
+    callBatch(const PreparedFunction &fn, const std::vector<const SymBindings *> &rows);
+
   private:
+
     const Program &prog_;
     bool dumpExec_ = false;
-    std::unordered_map<std::string, const StructDecl *> structs_;
+    bool tracing_ = false; // dumpExec_ or trace_, in run() only
+    TraceWriter *trace_ = nullptr;
+    TraceFilter traceFilter_;
+    // Trace string ids of block labels and of lvalues without a dynamic
+    // index, by AST node
+    std::unordered_map<const void *, std::uint32_t> traceIds_;
+    Profile *profile_ = nullptr;
+    bool profiling_ = false; // profile_, in run() only
+    std::vector<std::size_t> *blockLog_ = nullptr;
+    bool logging_ = false; // blockLog_, in call() only
+    std::size_t profBlock_ = 0;  // block running, or SIZE_MAX before the first
+    std::chrono::steady_clock::time_point profSince_; // when profBlock_ began
+    Engine engine_ = Engine::Bytecode;
+    AnalysisManager ownAnalyses_;
+    AnalysisManager *analyses_ = &ownAnalyses_;
+    std::ostream *out_ = &std::cout;
+    std::unordered_map<Symbol, const StructDecl *> structs_;
+
+    struct Aggregate;
+    class AggregateArena;
 
     /**
      * Represents a value during runtime.
+     *
+     * Scalars (Int, Float, Ptr, Undef) are held inline in 24 bytes. Arrays,
+     * vectors and structs hold a counted handle to an Aggregate node from
+     * the interpreter's arena, so copying one is a reference bump; the
+     * first write through a shared handle clones the node (copy-on-write).
+     * Struct fields are stored in StructDecl order.
      */
     struct RuntimeValue {
-      enum class Kind { Int, Float, Array, Struct, Undef, Ptr, Vec } kind = Kind::Undef;
-      std::int64_t intVal = 0;
-      double floatVal = 0.0;
-      std::uint32_t bits = 64;    // bitwidth for Int or Float (32/64)
-      std::uint64_t ptrVal = 0;   // for Ptr kind: raw address
-      std::uint64_t ptrBase = 0;  // for Ptr kind: base address of provenance object
-      std::uint64_t elemSize = 1; // for Ptr kind: static element size of the pointee type
-      std::vector<RuntimeValue> arrayVal;
-      std::unordered_map<std::string, RuntimeValue> structVal;
-      // [v0.2.1] Vec: same shape as Array (per-lane RuntimeValue tuple),
-      // but represents a vector value (no address; not in heap_; lane-wise
-      // arithmetic). Element kind matches the lane scalar type.
+      enum class Kind : std::uint8_t { Int, Float, Array, Struct, Undef, Ptr, Vec };
+      Kind kind = Kind::Undef;
+      std::uint16_t bits = 64;    // bitwidth for Int or Float (32/64)
+      std::uint32_t elemSize = 1; // for Ptr kind: static element size of the pointee type
+      union {
+        std::int64_t intVal = 0;
+        std::uint64_t ptrVal; // for Ptr kind: raw address
+      };
+      union {
+        double floatVal = 0.0;
+        std::uint64_t ptrBase; // for Ptr kind: base address of provenance object
+        Aggregate *agg;        // for Array, Struct and Vec kinds; owned
+      };
+      // [v0.2.1] Vec: a vector value (no address; not in memory; lane-wise
+      // arithmetic). Its lanes are packed in the Aggregate rather than
+      // held as elements, and `bits` is the lane width.
+
+      RuntimeValue() = default;
+      RuntimeValue(const RuntimeValue &o) { copyFrom(o); }
+      RuntimeValue(RuntimeValue &&o) noexcept { takeFrom(o); }
+      ~RuntimeValue() {
+        if (isAggregate())
+          release();
+      }
+      RuntimeValue &operator=(const RuntimeValue &o) {
+        RuntimeValue copy(o); // `o` may live inside the node released here
+        return *this = std::move(copy);
+      }
+      RuntimeValue &operator=(RuntimeValue &&o) noexcept {
+        if (this != &o) {
+          if (isAggregate())
+            release();
+          takeFrom(o);
+        }
+        return *this;
+      }
+
+      bool isAggregate() const {
+        return kind == Kind::Array || kind == Kind::Struct || kind == Kind::Vec;
+      }
+      // Elements of an Array or Vec, or fields of a Struct.
+      const std::vector<RuntimeValue> &elements() const { return agg->elems; }
+      // As elements(), first unsharing the node.
+      std::vector<RuntimeValue> &mutableElements() { return mutableNode().elems; }
+      // The node of an aggregate, first unsharing it.
+      Aggregate &mutableNode() {
+        if (agg->refs > 1)
+          unshare();
+        return *agg;
+      }
+      const RuntimeValue *field(const std::string &name) const;
+      RuntimeValue *mutableField(const std::string &name);
+
+    private:
+      void copyFrom(const RuntimeValue &o) {
+        kind = o.kind;
+        bits = o.bits;
+        elemSize = o.elemSize;
+        ptrVal = o.ptrVal;
+        ptrBase = o.ptrBase;
+        if (isAggregate())
+          ++agg->refs;
+      }
+      // A moved-from aggregate is left Undef; scalars are copied.
+      void takeFrom(RuntimeValue &o) {
+        kind = o.kind;
+        bits = o.bits;
+        elemSize = o.elemSize;
+        ptrVal = o.ptrVal;
+        ptrBase = o.ptrBase;
+        if (o.isAggregate())
+          o.kind = Kind::Undef;
+      }
+      void release();
+      void unshare();
     };
 
-    using Store = std::unordered_map<std::string, RuntimeValue>;
+    struct Aggregate {
+      std::uint32_t refs = 1;
+      const StructDecl *decl = nullptr; // for Struct kind: field order
+      AggregateArena *arena = nullptr;
+      std::vector<RuntimeValue> elems;
+      // Vec kind: one packed lane array, `floats` if floatLanes (f32 lanes
+      // hold their f32 image) else `ints` (two's complement at the lane
+      // width; cmp masks hold 0/1). `undef` is either empty, no lane being
+      // undef, or holds one flag per lane.
+      bool floatLanes = false;
+      std::vector<std::int64_t> ints;
+      std::vector<double> floats;
+      std::vector<std::uint8_t> undef;
+    };
+
+    /**
+     * Owns the Aggregate nodes of one interpreter. Released nodes keep
+     * their element storage and are handed out again, so steady-state
+     * execution does not allocate for aggregate temporaries.
+     */
+    class AggregateArena {
+    public:
+      Aggregate *make(const StructDecl *decl = nullptr);
+      void recycle(Aggregate *node);
+
+    private:
+      std::vector<Aggregate *> free_; // outlives nodes_, which release into it
+      std::deque<Aggregate> nodes_;
+    };
+
+    // Declared before every member holding values, which release into it.
+    AggregateArena arena_;
+
+    // A fresh Array, Struct or Vec value with no elements.
+    RuntimeValue makeAggregate(RuntimeValue::Kind kind, const StructDecl *decl = nullptr);
+    // Index of `field` in `s`, or -1.
+    static int fieldIndex(const StructDecl &s, const std::string &field);
+
+    using Store = std::unordered_map<Symbol, RuntimeValue>;
 
     // ---- Memory model for pointer operations ----
 
@@ -65,8 +328,7 @@ namespace symir {
       std::uint64_t count;    // number of elements
       // [v0.2.1] For array-of-struct field cells: the element index of
       // the containing struct (i.e. `%arr[k].fld`'s k). -1 / SIZE_MAX
-      // when not array-nested. Used by StoreInstr to mirror the heap
-      // write back into the right `store["%arr"].arrayVal[k]` cell.
+      // when not array-nested.
       std::uint64_t arrayIdx = static_cast<std::uint64_t>(-1);
       std::uint64_t provId = 0; // unique provenance object ID
       TypePtr type = nullptr;   // [v0.2.1] The static type of the object/field
@@ -81,16 +343,52 @@ namespace symir {
           provId(pi), type(t) {}
     };
 
-    // heap_: flat address → RuntimeValue (one slot per element)
-    std::unordered_map<std::uint64_t, RuntimeValue> heap_;
-    // objects_: per-function allocation tracking
-    std::list<ObjectInfo> objects_;
+    // Memory holds every local whose address was taken, from its first
+    // `addr` on: [kMemoryBase, nextAddr_) in the sizeofType() layout, so
+    // loads, stores and by-name accesses all read and write the same bytes.
+    static constexpr std::uint64_t kMemoryBase = 4096; // null = 0 stays below
+    std::vector<std::uint8_t> mem_;
+    // defined_[i]: mem_[i] holds a value (false = undef)
+    std::vector<bool> defined_;
+    // ptrCells_: provenance of the pointers stored in memory, by address
+    struct PtrCell {
+      std::uint64_t provId;
+      std::uint32_t elemSize;
+    };
+    std::unordered_map<std::uint64_t, PtrCell> ptrCells_;
+    // objects_: per-function allocation tracking; objects_[i].provId == i + 1
+    std::vector<ObjectInfo> objects_;
+    // byBase_: base address → indices into objects_ starting there, in
+    // allocation order
+    std::map<std::uint64_t, std::vector<std::uint32_t>> byBase_;
+    // parent_[i]: innermost earlier object enclosing objects_[i], or kNoObject
+    std::vector<std::uint32_t> parent_;
+    // nested_: every object so far is nested in or disjoint from the others
+    // and was allocated after the objects enclosing it, so parent_ chains
+    // answer the containment queries; once false, those scan objects_.
+    bool nested_ = true;
+    static constexpr std::uint32_t kNoObject = static_cast<std::uint32_t>(-1);
     // addrMap_: varName → base address (assigned lazily on first addr)
     std::unordered_map<std::string, std::uint64_t> addrMap_;
-    // typeMap_: varName → TypePtr, rebuilt at start of each execFunction call
+    // typeMap_: varName → TypePtr of the function typeMapOf_, rebuilt by
+    // enterFunction() when another function is entered
     std::unordered_map<std::string, TypePtr> typeMap_;
-    // nextAddr_: allocator counter (starts at 4096 to leave null = 0 at bottom)
-    std::uint64_t nextAddr_ = 4096;
+    const FunDecl *typeMapOf_ = nullptr;
+    // steps_: blocks executed by the current run
+    std::uint64_t steps_ = 0;
+    Budget budget_;
+    static constexpr std::uint64_t kClockBlocks = 4096;
+    // Block entries left before budgetCheck() runs, and when the time
+    // budget of the current run ends
+    std::uint64_t fuel_ = UINT64_MAX;
+    std::chrono::steady_clock::time_point deadline_;
+    // Arms the budget for a run that starts now.
+    void startBudget();
+    // At a block entry once fuel_ ran out: throws if the budget is used
+    // up, else refuels.
+    void budgetCheck();
+    // nextAddr_: allocator counter
+    std::uint64_t nextAddr_ = kMemoryBase;
     // nextProvId_: unique provenance ID counter
     std::uint64_t nextProvId_ = 1;
 
@@ -102,21 +400,86 @@ namespace symir {
     std::uint64_t
     materializeStruct(const std::string &varName, const StructDecl &s, const Store &store);
     ObjectInfo &addObject(ObjectInfo obj);
+    // Innermost object containing `addr` while nested_, or kNoObject.
+    std::uint32_t innermostObject(std::uint64_t addr) const;
     const ObjectInfo *findObject(std::uint64_t addr) const;
     const ObjectInfo *findObjectByProvId(std::uint64_t provId) const;
     const ObjectInfo *findObjectByBaseAddress(std::uint64_t base) const;
     const ObjectInfo *findFieldOrStructObject(std::uint64_t addr, const TypePtr &type) const;
     const ObjectInfo *findObjectForArith(std::uint64_t addr) const;
 
+    // Bump-allocates `size` bytes of undef memory and returns their base.
+    std::uint64_t allocBytes(std::uint64_t size);
+    // Decode / encode the value of type `t` at `addr`.
+    RuntimeValue loadCell(std::uint64_t addr, const TypePtr &t);
+    void storeCell(std::uint64_t addr, const TypePtr &t, const RuntimeValue &v);
+    // Scalar or pointer type of the cell at `addr`, or null.
+    TypePtr cellTypeAt(std::uint64_t addr) const;
+    // The value of local `name`, from memory once its address was taken.
+    RuntimeValue readVar(const std::string &name, const Store &store);
+    // Address and type (into `type`) of `lv`, whose base lives at `base`;
+    // `read` adds the undef-index check of reads.
+    std::uint64_t lvalueAddress(
+        const LValue &lv, std::uint64_t base, TypePtr &type, const Store &store, bool read
+    );
+
     // --- Runtime evaluation helpers ---
     RuntimeValue makeUndef(const TypePtr &t);
     RuntimeValue broadcast(const TypePtr &t, const RuntimeValue &v);
     RuntimeValue evalInit(const InitVal &iv, const TypePtr &t, const Store &store);
     std::string rvToString(const RuntimeValue &rv) const;
 
-    void execFunction(
+    // With a `path`, stops at its end and returns whether control
+    // followed it; see runPath(). Otherwise the returned value goes to
+    // `*ret` (left Undef by `ret;`).
+    bool execFunction(
+        const FunDecl &f, const std::vector<RuntimeValue> &args, const SymBindings &symBindings,
+        const std::vector<std::string> *path, RuntimeValue *ret
+    );
+    // The AST walker over `cfg`, on the frame bound by enterFunction();
+    // same contract as execFunction(). Starts at block `from` (SIZE_MAX:
+    // the entry block).
+    bool execAst(
+        const FunDecl &f, const CFG &cfg, Store &store, const std::vector<std::string> *path,
+        RuntimeValue *ret, std::size_t from = SIZE_MAX
+    );
+    // Resets the memory model and binds params, syms and lets in
+    // declaration order.
+    Store enterFunction(
         const FunDecl &f, const std::vector<RuntimeValue> &args, const SymBindings &symBindings
     );
+    // The steps of enterFunction(): resetting the memory model and binding
+    // the params, binding the syms, and binding lets [from, to).
+    Store enterFrame(const FunDecl &f, const std::vector<RuntimeValue> &args);
+    void bindSyms(const FunDecl &f, const SymBindings &symBindings, Store &store);
+    void bindLets(const FunDecl &f, std::size_t from, std::size_t to, Store &store);
+    // Runs `body` on the flags, counters and budget of a fresh call(),
+    // reporting what it throws; `body` stores the returned value.
+    CallResult guardedCall(const std::function<void(RuntimeValue &)> &body);
+    // Trace events of execAst(), to the text dump and/or trace_.
+    void traceBlock(const Block &block);
+    void traceAssign(const LValue &lv, const RuntimeValue &v, const Store &store);
+    // Profile events of execAst(): entering block `pc`, and the end of
+    // the run.
+    void profileBlock(std::size_t pc);
+    void profileEnd();
+    // `lv` as the text trace prints it, dynamic indices resolved.
+    std::string lvalueText(const LValue &lv, const Store &store);
+    // Prints the `Result:` line of a returning entry function.
+    void printResult(const RuntimeValue &res) const;
+
+    // --- Bytecode engine (src/interp/bytecode.cpp) ---
+    // The lowered form of `f`, built on first use; null if `f` is
+    // outside the bytecode subset.
+    const Bytecode *bytecodeFor(const FunDecl &f);
+    // Runs `bc` on the frame bound by enterFunction(); same contract as
+    // execFunction().
+    bool execBytecode(
+        const Bytecode &bc, Store &store, const std::vector<std::string> *path, RuntimeValue *ret,
+        std::size_t from = SIZE_MAX
+    );
+
+    std::unordered_map<const FunDecl *, std::unique_ptr<Bytecode>> bytecode_;
 
     RuntimeValue evalExpr(const Expr &e, const Store &store);
     RuntimeValue evalAtom(const Atom &a, const Store &store);
@@ -126,6 +489,85 @@ namespace symir {
     void setLValue(const LValue &lv, RuntimeValue val, Store &store);
 
     bool evalCond(const Cond &c, const Store &store);
+
+    // --- Scalar semantics shared by both engines ---
+    // Each takes evaluated operands and raises the UB of its construct.
+    static void addScalar(RuntimeValue &v, const RuntimeValue &right, AddOp op);
+    static RuntimeValue applyScalar(AtomOpKind op, const RuntimeValue &c, const RuntimeValue &r);
+    static RuntimeValue notScalar(const RuntimeValue &r);
+    static bool compareValues(RelOp op, const RuntimeValue &a, const RuntimeValue &b);
+    static bool condValues(RelOp op, const RuntimeValue &l, const RuntimeValue &r);
+    static RuntimeValue castScalar(const RuntimeValue &v, const TypePtr &dstType);
+    static const RuntimeValue &readElement(const RuntimeValue &cur, const RuntimeValue &idx);
+    static const RuntimeValue &readField(const RuntimeValue &cur, const std::string &field);
+    static RuntimeValue &writeElement(RuntimeValue &cur, std::int64_t idx);
+    static const RuntimeValue &readField(const RuntimeValue &cur, std::uint32_t index);
+    static RuntimeValue &writeField(RuntimeValue &cur, const std::string &field);
+    static RuntimeValue &writeField(RuntimeValue &cur, std::uint32_t index);
+    static void assignValue(RuntimeValue &cur, const RuntimeValue &val);
+
+    // --- Vector semantics (src/interp/vector.cpp) ---
+    // Each op runs one kernel over the packed lanes, then tests its UB
+    // predicates on the whole vector and reports the first offending lane,
+    // with the message a lane-by-lane evaluation would give.
+    RuntimeValue makeVec(std::size_t lanes, std::uint32_t bits, bool floatLanes);
+    // `<N> T` with every lane `v` (a scalar of any kind, or Undef).
+    RuntimeValue splatVec(const VecType &t, const RuntimeValue &v);
+    static std::size_t laneCount(const RuntimeValue &v);
+    // Lane `k`, as a scalar (Undef if the lane is).
+    static RuntimeValue laneAt(const RuntimeValue &v, std::size_t k);
+    static RuntimeValue readLane(const RuntimeValue &v, const RuntimeValue &idx);
+    static void writeLane(RuntimeValue &v, std::int64_t idx, const RuntimeValue &val);
+    // `l <op> r`, `r` a vector or a broadcast scalar literal.
+    RuntimeValue addVec(const RuntimeValue &l, const RuntimeValue &r, AddOp op);
+    // `c <op> r`, `c` a vector or a broadcast scalar coefficient.
+    RuntimeValue applyVec(AtomOpKind op, const RuntimeValue &c, const RuntimeValue &r);
+    RuntimeValue notVec(const RuntimeValue &r);
+    RuntimeValue cmpVec(RelOp op, const RuntimeValue &l, const RuntimeValue &r);
+    RuntimeValue selectVec(const RuntimeValue &mask, const RuntimeValue &t, const RuntimeValue &f);
+    RuntimeValue castVec(const RuntimeValue &v, const TypePtr &dstType);
+
+    std::vector<std::uint8_t> laneFlags_; // per-lane UB codes of the kernel running
+
+    // Lock-step engine of callBatch() (src/interp/batch.cpp)
+    struct Lockstep;
+
+    /**
+     * A run of an entry function stopped at the end of its
+     * symbol-independent prefix, with no sym bound: the frame, the memory
+     * model and the block to resume at. Its aggregates are shared
+     * copy-on-write with the runs forked from it.
+     */
+    struct Checkpoint {
+      const SymPrefix *prefix = nullptr;
+      std::size_t lets = 0;    // prefix->numLets()
+      std::size_t pc = 0;      // block to resume at
+      std::uint64_t steps = 0; // blocks the prefix ran
+      Store store;
+      std::vector<std::uint8_t> mem;
+      std::vector<bool> defined;
+      std::unordered_map<std::uint64_t, PtrCell> ptrCells;
+      std::vector<ObjectInfo> objects;
+      std::map<std::uint64_t, std::vector<std::uint32_t>> byBase;
+      std::vector<std::uint32_t> parent;
+      bool nested = true;
+      std::unordered_map<std::string, std::uint64_t> addrMap;
+      std::uint64_t nextAddr = kMemoryBase;
+      std::uint64_t nextProvId = 1;
+    };
+
+    // While set, execAst() stops on entering a block where this prefix
+    // ends, leaving it in prefixEnd_.
+    const SymPrefix *prefix_ = nullptr;
+    std::size_t prefixEnd_ = 0;
+
+    // Runs the prefix of `fn` into `cp`. False if it shares nothing, or
+    // cannot run it without bindings (a failure in the prefix fails every
+    // row, so call() reports it for each).
+    bool checkpoint(const PreparedFunction &fn, Checkpoint &cp);
+    // As call(fn, {}, symBindings), resuming from `cp`.
+    CallResult
+    fork(const PreparedFunction &fn, const Checkpoint &cp, const SymBindings &symBindings);
   };
 
 } // namespace symir
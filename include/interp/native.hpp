@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "ast/ast.hpp"
+#include "interp/interpreter.hpp"
+
+namespace symir {
+
+  /**
+   * An entry function compiled to native code (`symiri --native`).
+   *
+   * The program is lowered to C by CBackend, with UBSan checks turned into
+   * traps, and built by the system C compiler (`$CC`, default `cc`) into a
+   * shared object named by the hash of its source and flags, so a cache
+   * directory holds one build per distinct program. Generated shim code
+   * serves the entry's symbols from the bindings of each call. A trap in
+   * the native code is reported as UB, and a failed `require` or `assume`
+   * as the interpreter reports it.
+   *
+   * Only entry functions whose UB the native code traps in the same places
+   * as the interpreter qualify; see unsupportedReason(). Callers fall back
+   * to the Interpreter for the rest.
+   */
+  class NativeFunction {
+  public:
+    /**
+     * Why `entry` cannot run natively, or "" if it can: pointers, vectors,
+     * integers other than i32 and i64, parameters, and locals that may
+     * hold undef are left to the interpreter. Throws std::runtime_error if
+     * there is no function named `entry`.
+     */
+    static std::string unsupportedReason(const Program &prog, const std::string &entry);
+
+    /// `$XDG_CACHE_HOME/symir/native`, `~/.cache/symir/native`, or a
+    /// directory under /tmp.
+    static std::string defaultCacheDir();
+
+    /**
+     * Builds (or reuses from `cacheDir`) and loads the native code of
+     * `entry`. Throws std::runtime_error if the compiler fails; its output
+     * is kept in the cache directory.
+     */
+    NativeFunction(const Program &prog, const std::string &entry, const std::string &cacheDir);
+    ~NativeFunction();
+
+    struct Entry {
+      const Program *prog;
+      std::string entry;
+    };
+
+    /**
+     * Builds the entries of several programs into one shared object, with
+     * one compiler run, and loads them: one NativeFunction per entry, in
+     * order. Each program is a translation unit of its own, but their
+     * functions share the object, so the names of all their functions
+     * must differ. Throws like the constructor.
+     */
+    static std::vector<std::unique_ptr<NativeFunction>>
+    buildAll(const std::vector<Entry> &entries, const std::string &cacheDir);
+
+    NativeFunction(const NativeFunction &) = delete;
+    NativeFunction &operator=(const NativeFunction &) = delete;
+
+    /**
+     * Runs the entry function once. Like Interpreter::call(), failures are
+     * reported in the result; `steps` is always 0. Calls on different
+     * threads may run concurrently.
+     */
+    Interpreter::CallResult call(const Interpreter::SymBindings &symBindings) const;
+
+    /// The loaded shared object.
+    const std::string &libraryPath() const { return libPath_; }
+
+  private:
+    struct Sym {
+      std::string name;
+      bool isFloat = false;
+    };
+
+    NativeFunction() = default;
+    // Takes in `entry` of `prog` and returns the C of `prog` and the shim,
+    // whose external names end in `tag`.
+    std::string source(const Program &prog, const std::string &entry, const std::string &tag);
+    // Builds `sources` into one shared object, or reuses it, and loads it.
+    static std::shared_ptr<void>
+    load(const std::vector<std::string> &sources, const std::string &cacheDir, std::string &path);
+    void bind(std::shared_ptr<void> handle, const std::string &path, const std::string &tag);
+
+    const FunDecl *fun_ = nullptr;
+    std::vector<Sym> syms_;
+    bool hasRet_ = false, retFloat_ = false;
+    std::string libPath_;
+    std::shared_ptr<void> handle_; // shared by the entries of one buildAll()
+    void *run_ = nullptr;          // symiri_native_run<tag>
+  };
+
+} // namespace symir
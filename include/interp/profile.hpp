@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "ast/ast.hpp"
+
+namespace symir {
+
+  /**
+   * Execution counts of one Interpreter::run() (`symiri --profile`), for
+   * the blocks of its entry function. Profiled runs use the AST walker.
+   */
+  struct Profile {
+    // Names of the Instr and Atom alternatives, in variant order.
+    static constexpr const char *kInstrNames[] = {"assign", "assume", "require", "store"};
+    static constexpr const char *kAtomNames[] = {"op",   "select", "coef",  "rvalue",
+                                                 "cast", "unary",  "addr",  "load",
+                                                 "cmp",  "ptrindex", "ptrfield"};
+
+    bool timed = false; // set before run(): also sample wall time per block
+
+    const FunDecl *fun = nullptr;
+    std::uint64_t steps = 0;                  // blocks executed
+    std::vector<std::uint64_t> blockCounts;   // by block index
+    std::vector<double> blockSeconds;         // by block index, if timed
+    std::unordered_map<std::uint64_t, std::uint64_t> edgeCounts; // (from << 32 | to)
+    std::array<std::uint64_t, std::variant_size_v<Instr>> instrCounts{};
+    std::array<std::uint64_t, std::variant_size_v<Atom::Variant>> atomCounts{};
+
+    static std::uint64_t edgeKey(std::size_t from, std::size_t to) {
+      return static_cast<std::uint64_t>(from) << 32 | to;
+    }
+  };
+
+  /**
+   * The profile as JSON: per-block counts (and seconds), every CFG edge
+   * with its count, retreating edges (loop iterations) marked "back", and
+   * the instruction and atom counts.
+   */
+  void writeProfileJson(const Profile &p, std::ostream &os);
+
+  /// The CFG as Graphviz DOT, blocks shaded by execution count.
+  void writeProfileDot(const Profile &p, std::ostream &os);
+
+} // namespace symir
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace symir {
+
+  /// Which events of an execution the Interpreter traces.
+  struct TraceFilter {
+    bool blocksOnly = false;             // no assignments
+    std::unordered_set<std::string> vars; // assignments to these locals only; empty = all
+
+    bool wantsAssign(const std::string &base) const {
+      return !blocksOnly && (vars.empty() || vars.count(base));
+    }
+  };
+
+  /**
+   * Writes the binary execution trace of `symiri --trace-file`.
+   *
+   * The file starts with the magic "SYTR" and a version byte, followed by
+   * records that each begin with a tag byte; integers are LEB128 varints
+   * (signed ones zigzag-encoded). Block labels and assigned lvalues are
+   * strings, each sent once as a String record the first time it is used
+   * and referred to by id after that:
+   *
+   *   String  id len bytes
+   *   Block   label-id
+   *   Assign  lvalue-id value     value = tag byte and payload, see Value
+   *   End
+   *
+   * Records go through a fixed buffer, and with `compress` the file is
+   * gzip-compressed (builds with zlib only; see traceCompressionAvailable()).
+   */
+  class TraceWriter {
+  public:
+    enum class Record : std::uint8_t { End, String, Block, Assign };
+    // Int: zigzag value, bits; Float: bits, 8 raw bytes; Ptr: address;
+    // Text: string id of the printed aggregate.
+    enum class Value : std::uint8_t { Undef, Int, Float, Ptr, Text };
+
+    TraceWriter(const std::string &path, bool compress);
+    ~TraceWriter(); // writes End and closes
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    // The id of `s`, emitting its String record on first use.
+    std::uint32_t intern(const std::string &s);
+
+    void block(std::uint32_t label);
+    void assignUndef(std::uint32_t lv);
+    void assignInt(std::uint32_t lv, std::int64_t value, std::uint32_t bits);
+    void assignFloat(std::uint32_t lv, double value, std::uint32_t bits);
+    void assignPtr(std::uint32_t lv, std::uint64_t addr);
+    void assignText(std::uint32_t lv, const std::string &text);
+
+  private:
+    void put(std::uint8_t b) {
+      if (len_ == sizeof(buf_))
+        flush();
+      buf_[len_++] = b;
+    }
+    void putVarint(std::uint64_t v);
+    void flush();
+
+    void *file_ = nullptr; // FILE* or gzFile
+    bool gz_ = false;
+    std::unordered_map<std::string, std::uint32_t> ids_;
+    std::size_t len_ = 0;
+    std::uint8_t buf_[1 << 16];
+  };
+
+  // Whether this build can write and read compressed traces.
+  bool traceCompressionAvailable();
+
+  /**
+   * Prints the binary trace at `path` as the text of `--dump-trace`.
+   * Throws std::runtime_error on an unreadable or malformed file.
+   */
+  void decodeTrace(const std::string &path, std::ostream &os);
+
+} // namespace symir
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace symir::json {
+
+  /**
+   * Minimal JSON document model for the tools' line-oriented interfaces
+   * (job files, reports). Numbers keep their source text so 64-bit
+   * integers survive unchanged; objects keep their key order.
+   */
+  struct Value {
+    enum class Kind { Null, Bool, Number, String, Array, Object };
+
+    Kind kind = Kind::Null;
+    bool boolean = false;
+    std::string text; // String contents or Number source text
+    std::vector<Value> items;
+    std::vector<std::pair<std::string, Value>> members;
+
+    bool isNull() const { return kind == Kind::Null; }
+    bool isBool() const { return kind == Kind::Bool; }
+    bool isNumber() const { return kind == Kind::Number; }
+    bool isString() const { return kind == Kind::String; }
+    bool isArray() const { return kind == Kind::Array; }
+    bool isObject() const { return kind == Kind::Object; }
+
+    // Member `key` of an object, or null if absent (or not an object).
+    const Value *find(std::string_view key) const {
+      for (const auto &[k, v]: members)
+        if (k == key)
+          return &v;
+      return nullptr;
+    }
+
+    int64_t asInt64() const {
+      int64_t v = 0;
+      auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), v);
+      if (kind != Kind::Number || ec != std::errc() || end != text.data() + text.size())
+        throw std::runtime_error("JSON: expected an integer, got '" + text + "'");
+      return v;
+    }
+
+    const std::string &asString() const {
+      if (kind != Kind::String)
+        throw std::runtime_error("JSON: expected a string");
+      return text;
+    }
+
+    bool asBool() const {
+      if (kind != Kind::Bool)
+        throw std::runtime_error("JSON: expected true or false");
+      return boolean;
+    }
+  };
+
+  namespace detail {
+
+    class Reader {
+    public:
+      explicit Reader(std::string_view s) : s_(s) {}
+
+      Value document() {
+        Value v = value();
+        ws();
+        if (i_ != s_.size())
+          fail("trailing characters");
+        return v;
+      }
+
+    private:
+      [[noreturn]] void fail(const std::string &what) const {
+        throw std::runtime_error("JSON: " + what + " at offset " + std::to_string(i_));
+      }
+
+      void ws() {
+        while (i_ < s_.size() &&
+               (s_[i_] == ' ' || s_[i_] == '\t' || s_[i_] == '\n' || s_[i_] == '\r'))
+          ++i_;
+      }
+
+      bool eat(char c) {
+        ws();
+        if (i_ < s_.size() && s_[i_] == c) {
+          ++i_;
+          return true;
+        }
+        return false;
+      }
+
+      void expect(char c) {
+        if (!eat(c))
+          fail(std::string("expected '") + c + "'");
+      }
+
+      bool keyword(std::string_view kw) {
+        if (s_.substr(i_, kw.size()) != kw)
+          return false;
+        i_ += kw.size();
+        return true;
+      }
+
+      Value value() {
+        ws();
+        if (i_ == s_.size())
+          fail("unexpected end of input");
+        Value v;
+        char c = s_[i_];
+        if (c == '{') {
+          ++i_;
+          v.kind = Value::Kind::Object;
+          if (eat('}'))
+            return v;
+          do {
+            ws();
+            std::string key = string();
+            expect(':');
+            v.members.emplace_back(std::move(key), value());
+          } while (eat(','));
+          expect('}');
+        } else if (c == '[') {
+          ++i_;
+          v.kind = Value::Kind::Array;
+          if (eat(']'))
+            return v;
+          do
+            v.items.push_back(value());
+          while (eat(','));
+          expect(']');
+        } else if (c == '"') {
+          v.kind = Value::Kind::String;
+          v.text = string();
+        } else if (keyword("true") || keyword("false")) {
+          v.kind = Value::Kind::Bool;
+          v.boolean = c == 't';
+        } else if (keyword("null")) {
+          v.kind = Value::Kind::Null;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+          std::size_t b = i_++;
+          while (i_ < s_.size() && (std::isdigit(static_cast<unsigned char>(s_[i_])) ||
+                                    s_[i_] == '.' || s_[i_] == 'e' || s_[i_] == 'E' ||
+                                    s_[i_] == '+' || s_[i_] == '-'))
+            ++i_;
+          v.kind = Value::Kind::Number;
+          v.text = std::string(s_.substr(b, i_ - b));
+        } else {
+          fail(std::string("unexpected '") + c + "'");
+        }
+        return v;
+      }
+
+      std::string string() {
+        if (i_ >= s_.size() || s_[i_] != '"')
+          fail("expected a string");
+        ++i_;
+        std::string out;
+        while (i_ < s_.size() && s_[i_] != '"') {
+          char c = s_[i_++];
+          if (c != '\\') {
+            out += c;
+            continue;
+          }
+          if (i_ == s_.size())
+            break;
+          switch (char e = s_[i_++]) {
+            case 'n':
+              out += '\n';
+              break;
+            case 't':
+              out += '\t';
+              break;
+            case 'r':
+              out += '\r';
+              break;
+            case 'b':
+              out += '\b';
+              break;
+            case 'f':
+              out += '\f';
+              break;
+            case 'u': {
+              unsigned cp = 0;
+              if (i_ + 4 > s_.size())
+                fail("bad \\u escape");
+              auto [end, ec] = std::from_chars(s_.data() + i_, s_.data() + i_ + 4, cp, 16);
+              if (ec != std::errc() || end != s_.data() + i_ + 4)
+                fail("bad \\u escape");
+              i_ += 4;
+              // UTF-8 encode; surrogate pairs are not combined.
+              if (cp < 0x80) {
+                out += static_cast<char>(cp);
+              } else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+              } else {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+              }
+              break;
+            }
+            default:
+              out += e; // \" \\ \/
+          }
+        }
+        if (i_ == s_.size())
+          fail("unterminated string");
+        ++i_;
+        return out;
+      }
+
+      std::string_view s_;
+      std::size_t i_ = 0;
+    };
+
+  } // namespace detail
+
+  // Parses one JSON document. Throws std::runtime_error on malformed input.
+  inline Value parse(std::string_view text) { return detail::Reader(text).document(); }
+
+  // `s` as a quoted JSON string literal.
+  inline std::string quote(std::string_view s) {
+    std::string out = "\"";
+    for (char c: s) {
+      switch (c) {
+        case '"':
+          out += "\\\"";
+          break;
+        case '\\':
+          out += "\\\\";
+          break;
+        case '\n':
+          out += "\\n";
+          break;
+        case '\t':
+          out += "\\t";
+          break;
+        case '\r':
+          out += "\\r";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            static const char *hex = "0123456789abcdef";
+            out += "\\u00";
+            out += hex[(c >> 4) & 0xF];
+            out += hex[c & 0xF];
+          } else {
+            out += c;
+          }
+      }
+    }
+    out += '"';
+    return out;
+  }
+
+} // namespace symir::json
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <string>
+#include "reify/hyperparameters.hpp"
+
+namespace symir::reify {
+
+  /**
+   * Reweights genIntAtomOnPath's atom kinds while rysmith runs (--adaptive),
+   * towards the kinds whose programs come out valid fastest.
+   *
+   * Each init's cost (the seconds spent generating and solving it) and
+   * outcome (a concrete program or not) are shared out among the kinds by
+   * how many of its atoms are of each. A kind's yield is its valid programs
+   * per second, pulled towards the run's by a prior of a few inits' worth.
+   * Every kUpdateEvery inits, each kind's slot is resized to its base size
+   * times its yield over the run's, renormalised to the base total.
+   *
+   * `coverage` in (0, 1] is the feature-coverage target: a kind keeps at
+   * least `coverage` times its base share and gets at most 1/coverage
+   * times it, so nothing the base generates drops out of the mix. At 1 the
+   * base is kept as is.
+   */
+  class AdaptiveMix {
+  public:
+    static constexpr int kUpdateEvery = 16;
+
+    AdaptiveMix(const hp::Params &base, double coverage);
+
+    // The Params for the next init: the base with the current slot ends.
+    hp::Params next() const;
+
+    // Records an init whose function has `atoms` and took `seconds`.
+    void record(const std::array<int, hp::kNumIntAtoms> &atoms, double seconds, bool valid);
+
+    // One line per kind: its base and current share, and its yield.
+    std::string report() const;
+
+  private:
+    void update();
+
+    hp::Params base_;
+    double coverage_;
+
+    mutable std::mutex mu_;
+    hp::Params current_;
+    std::array<double, hp::kNumIntAtoms> valid_{}, seconds_{};
+    double totalValid_ = 0, totalSeconds_ = 0;
+    int inits_ = 0;
+  };
+
+} // namespace symir::reify
@@ -11,6 +11,10 @@ namespace symir::reify {
     std::string label;
     std::vector<std::string> succs;
     std::vector<std::string> preds;
+    // The same edges by block id (index into RyCFG::blocks), in the same
+    // order
+    std::vector<std::size_t> succIds;
+    std::vector<std::size_t> predIds;
 
     bool isBranch() const { return succs.size() == 2; }
 
@@ -22,6 +26,7 @@ namespace symir::reify {
   struct RyCFG {
     std::string entry;
     std::string exitLabel;
+    std::size_t entryId = 0, exitId = 0;
     std::vector<RyCFGBlock> blocks;
     std::unordered_map<std::string, std::size_t> blockIndex;
 
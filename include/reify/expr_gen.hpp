@@ -1,10 +1,12 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <random>
 #include <string>
 #include <vector>
 #include "ast/ast.hpp"
+#include "reify/hyperparameters.hpp"
 #include "reify/type_gen.hpp"
 #include "reify/var_catalogue.hpp"
 
@@ -30,6 +32,9 @@ namespace symir::reify {
     int64_t valueLo = -128, valueHi = 127;
     int64_t indexLo = 1, indexHi = 30;
 
+    // On-path int atoms generated, by kind (what rysmith --adaptive weighs)
+    std::array<int, hp::kNumIntAtoms> intAtoms{};
+
     // Generate next sym of given kind and type
     std::string next(SymKind kind, TypePtr type);
 
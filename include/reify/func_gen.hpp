@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -10,6 +11,28 @@
 
 namespace symir::reify {
 
+  /**
+   * Checks the execution path while genFunction writes it (rysmith
+   * --incremental). genFunction first writes every block off the path and
+   * the skeleton of those on it, then start()s the oracle and feeds it the
+   * path in order, block by block as each is generated. A step the oracle
+   * refutes is generated anew.
+   */
+  class PathOracle {
+  public:
+    virtual ~PathOracle() = default;
+
+    // `prog` has all of its blocks and lets and stays in place until
+    // genFunction returns; the path's blocks and the syms still grow.
+    virtual void start(const Program &prog, const std::string &funcName) = 0;
+    // Whether the path stays feasible when the instructions of `block`
+    // from `firstInstr` on run next. Only a feasible step is committed.
+    virtual bool run(const Block &block, std::size_t firstInstr) = 0;
+    // Likewise, when they run and `block` then leaves by its terminator
+    // for `next` (null at the end of the path).
+    virtual bool take(const Block &block, std::size_t firstInstr, const std::string *next) = 0;
+  };
+
   struct FuncGenConfig {
     std::string funcName = "func";
     uint32_t seed = 0;
@@ -22,11 +45,19 @@ namespace symir::reify {
     int64_t coefLo = -8, coefHi = 8;
     int64_t valueLo = -128, valueHi = 127;
     int64_t indexLo = 1, indexHi = 30;
+    // Checks the path as it is generated (not owned); null: no checks
+    PathOracle *oracle = nullptr;
   };
 
   struct FuncGenResult {
     symir::Program prog;
     std::vector<std::string> pathLabels; // ["^entry", "^b0", ...]
+    // The oracle refuted a step that could not be generated anew (a
+    // branch condition, or a block the path runs again): the path is
+    // infeasible.
+    bool refuted = false;
+    // On-path int atoms the function uses, by kind (SymCounter::intAtoms)
+    std::array<int, hp::kNumIntAtoms> intAtoms{};
   };
 
   FuncGenResult genFunction(
@@ -3,6 +3,7 @@
 #include <climits>
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 // Central place to manage reify's *code-level* tunable hyperparameters.
 //
@@ -19,7 +20,10 @@
 //   - max-ptr-depth, max-agg-nest, max-agg-elems
 //
 // Editing a value here changes behaviour for all rysmith runs without
-// touching any CLI default.
+// touching any CLI default. The slot tables, expression structure, type
+// probabilities and var fractions are also runtime Params (bottom of this
+// file), which rysmith --hyperparams loads from a file: the constants are
+// their defaults.
 namespace symir::reify::hp {
 
   // ===========================================================================
@@ -150,6 +154,14 @@ namespace symir::reify::hp {
   inline constexpr std::int64_t kOffPathDivisor_Lo = 1;
   inline constexpr std::int64_t kOffPathDivisor_Hi = 8;
 
+  // ===========================================================================
+  // Incremental generation (FuncGenConfig::oracle): how often the statements
+  // of a block, or its branch condition, are generated anew while the oracle
+  // refutes them. Statements still refuted are left out; a condition is
+  // kept, refuting the path.
+  // ===========================================================================
+  inline constexpr int kIncrementalRegens = 4;
+
   // ===========================================================================
   // Float literal pools.
   //
@@ -181,4 +193,106 @@ namespace symir::reify::hp {
   inline constexpr std::size_t kFloatMulCoefPoolSize =
       sizeof(kFloatMulCoefPool) / sizeof(kFloatMulCoefPool[0]);
 
+  // ===========================================================================
+  // Runtime values.
+  //
+  // The generators read the slot tables, expression structure, type-kind
+  // probabilities and var fractions above through params(), so that rysmith
+  // can load them from a file (--hyperparams) or reweight them as it goes
+  // (--adaptive). Each field is named after its constant without the `k`,
+  // which is also its key in a file. The literal pools and ranges are not
+  // runtime values.
+  // ===========================================================================
+  struct Params {
+    int intOnPath_CoefBareEnd = kIntOnPath_CoefBareEnd;
+    int intOnPath_MulEnd = kIntOnPath_MulEnd;
+    int intOnPath_BitwiseEnd = kIntOnPath_BitwiseEnd;
+    int intOnPath_ShiftEnd = kIntOnPath_ShiftEnd;
+    int intOnPath_UnaryNotEnd = kIntOnPath_UnaryNotEnd;
+    int intOnPath_CastEnd = kIntOnPath_CastEnd;
+    int intOnPath_DivModEnd = kIntOnPath_DivModEnd;
+    int intOnPath_LoadEnd = kIntOnPath_LoadEnd;
+    int intOnPath_SelectEnd = kIntOnPath_SelectEnd;
+
+    int intOffPath_ConcreteEnd = kIntOffPath_ConcreteEnd;
+    int intOffPath_MulEnd = kIntOffPath_MulEnd;
+    int intOffPath_BitwiseEnd = kIntOffPath_BitwiseEnd;
+    int intOffPath_CastEnd = kIntOffPath_CastEnd;
+    int intOffPath_DivModEnd = kIntOffPath_DivModEnd;
+    int intOffPath_PlainRvalEnd = kIntOffPath_PlainRvalEnd;
+    int intOffPath_LoadEnd = kIntOffPath_LoadEnd;
+    int intOffPath_SelectEnd = kIntOffPath_SelectEnd;
+
+    int floatOnPath_CastFromI32SymEnd = kFloatOnPath_CastFromI32SymEnd;
+    int floatOnPath_MulLitEnd = kFloatOnPath_MulLitEnd;
+    int floatOnPath_CastFromVarEnd = kFloatOnPath_CastFromVarEnd;
+    int floatOnPath_SelectEnd = kFloatOnPath_SelectEnd;
+
+    int minAtomsPerExpr = kMinAtomsPerExpr;
+    int maxAtomsPerExpr = kMaxAtomsPerExpr;
+
+    double pTypeScalar = kPTypeScalar;
+    double pTypeArray = kPTypeArray;
+    double pTypeStruct = kPTypeStruct;
+    double pTypePtr = kPTypePtr;
+    double pTypeVec = kPTypeVec;
+
+    double fracNonPtrVars = kFracNonPtrVars;
+    double fracPtr1Vars = kFracPtr1Vars;
+    double fracAggPtrVars = kFracAggPtrVars;
+
+    int vecCopyEnd = kVecCopyEnd;
+    int vecSymMulEnd = kVecSymMulEnd;
+    int vecConcMulEnd = kVecConcMulEnd;
+    int vecLaneWriteProb = kVecLaneWriteProb;
+
+    double pStructFieldIsArray = kPStructFieldIsArray;
+  };
+
+  // genIntAtomOnPath's atom kinds, in slot order: the features rysmith
+  // --adaptive weighs.
+  enum class IntAtom { CoefBare, Mul, Bitwise, Shift, UnaryNot, Cast, DivMod, Load, Select };
+  inline constexpr int kNumIntAtoms = 9;
+
+  const char *intAtomName(IntAtom k);
+
+  // The end of kind k's slot in Params: p.*intOnPathEnd(k).
+  int Params::*intOnPathEnd(IntAtom k);
+
+  // The Params the generators on this thread read: those of the innermost
+  // live Scope on this thread, else the process-wide ones (configure()),
+  // else the defaults.
+  const Params &params();
+
+  // Sets the process-wide Params. Call before any generator thread starts.
+  void configure(const Params &p);
+
+  // Makes `p` what params() returns on this thread while it lives; `p`
+  // must outlive it.
+  class Scope {
+  public:
+    explicit Scope(const Params &p);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    const Params *prev_;
+  };
+
+  // Reads Params from a file of `Name = value` lines, where Name is a
+  // constant above without the `k` (e.g. `IntOnPath_DivModEnd = 86`); `#`
+  // starts a comment. Unset fields keep their defaults. Throws
+  // std::runtime_error naming the line on an unknown name or a malformed
+  // value, and on a result validate() rejects.
+  Params loadParams(const std::string &path);
+
+  // Writes every field of `p` in the format loadParams() reads.
+  std::string formatParams(const Params &p);
+
+  // Empty if `p` is usable, else what is wrong: slot ends that decrease or
+  // leave [0, 100], negative probabilities, fractions outside [0, 1], or
+  // an empty atom-count range.
+  std::string validate(const Params &p);
+
 } // namespace symir::reify::hp
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "ast/ast.hpp"
+#include "reify/expr_gen.hpp"
+
+namespace symir::reify {
+
+  /**
+   * A program of a mutation corpus (rysmith --mutate): a leaf function as
+   * rysmith writes it, whose `// path:` header names its execution path.
+   */
+  struct CorpusEntry {
+    std::string name;              // file name, for reports
+    Program prog;                  // parsed, not checked
+    std::vector<std::string> path; // block labels, with their `^`
+  };
+
+  // Parses the .sir files of `dir` once. Those without a path header or a
+  // function, or that do not parse, are left out and named in `skipped`.
+  std::vector<CorpusEntry> loadCorpus(const std::string &dir, std::vector<std::string> &skipped);
+
+  struct MutateConfig {
+    int nStmts = 3; // statements of an inserted block
+    bool enableInterestCoefs = true;
+    ExprGenConfig exprCfg;
+    // Domains of the syms an inserted block declares
+    int64_t coefLo = -8, coefHi = 8;
+    int64_t valueLo = -128, valueHi = 127;
+    int64_t indexLo = 1, indexHi = 30;
+  };
+
+  /**
+   * Applies one AST-level mutation, of a kind drawn at random, to the first
+   * function of `prog`, on the blocks of its execution path `path`:
+   *
+   *   - narrow the domain of a sym to a random part of it, so that the
+   *     model must change;
+   *   - replace the operator of an on-path op atom by another of its family
+   *     (`*` `&` `|` `^`, the shifts, `/` `%`);
+   *   - insert a block of newly generated on-path statements on an edge of
+   *     the path, which `path` then runs wherever it took that edge.
+   *
+   * Returns what it did (e.g. "insert ^m0 on ^b2 -> ^b3"), or an empty
+   * string if the kind drawn found nothing to mutate. The result still has
+   * to be checked.
+   */
+  std::string mutate(
+      std::mt19937 &rng, Program &prog, std::vector<std::string> &path, const MutateConfig &cfg
+  );
+
+} // namespace symir::reify
@@ -4,6 +4,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "analysis/bitvector.hpp"
 #include "reify/cfg_gen.hpp"
 
 namespace symir::reify {
@@ -18,7 +19,45 @@ namespace symir::reify {
     int maxPathLen = 50;
   };
 
+  /**
+   * Samples execution paths (entry to exit) of one CFG. What does not
+   * depend on the seed is worked out once, over block ids: the edges, each
+   * block's distance to the exit, the static back edges and, for each, the
+   * blocks that can reach its source. A sample is then a walk over ids.
+   * The CFG must outlive the sampler.
+   */
+  class PathSampler {
+  public:
+    explicit PathSampler(const RyCFG &cfg);
+
+    std::optional<std::vector<std::string>> sample(const SamplePathParams &params) const;
+
+    // Up to k distinct paths, walked from the seeds params.seed,
+    // params.seed + 1, ... (at most 4k of them); the first is sample(params)
+    // if that succeeds.
+    std::vector<std::vector<std::string>> sample(const SamplePathParams &params, int k) const;
+
+  private:
+    struct BackEdge {
+      std::size_t src, slot, dst; // dst = blocks[src].succIds[slot]
+      BitVector reachesSrc;       // blocks with a path to src
+    };
+
+    std::optional<std::vector<std::size_t>> walk(const SamplePathParams &params) const;
+    bool appendShortestToExit(std::vector<std::size_t> &path) const;
+    std::vector<std::string> labelsOf(const std::vector<std::size_t> &path) const;
+
+    const RyCFG &cfg_;
+    std::vector<std::size_t> edgeBase_; // id of each block's first out-edge
+    std::vector<int> distToExit_;       // -1 if the exit is unreachable
+    std::vector<BackEdge> backEdges_;
+  };
+
   std::optional<std::vector<std::string>>
   samplePath(const RyCFG &cfg, const SamplePathParams &params);
 
+  // PathSampler(cfg).sample(params, k)
+  std::vector<std::vector<std::string>>
+  samplePaths(const RyCFG &cfg, const SamplePathParams &params, int k);
+
 } // namespace symir::reify
@@ -4,21 +4,31 @@
 #include "alivesmt/smt.h"
 #include "alivesmt/solver.h"
 #include "solver/smt.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace symir::solver {
 
   class AliveSolver : public smt::ISolver {
   public:
-    AliveSolver(uint32_t timeout_ms = 0, uint32_t seed = 0, uint32_t num_smt_threads = 1);
+    // `max_memory_mb` (0 = none) caps what Z3 may allocate during each
+    // check: past it, the check answers UNKNOWN.
+    AliveSolver(
+        uint32_t timeout_ms = 0, uint32_t seed = 0, uint32_t num_smt_threads = 1,
+        uint32_t max_memory_mb = 0
+    );
     ~AliveSolver() override;
 
     smt::Sort make_bv_sort(uint32_t size) override;
     smt::Sort make_fp_sort(uint32_t exp, uint32_t sig) override;
     smt::Sort make_bool_sort() override;
+    smt::Sort make_array_sort(smt::Sort index, smt::Sort elem) override;
 
     bool is_bv_sort(smt::Sort s) override;
     bool is_fp_sort(smt::Sort s) override;
     bool is_bool_sort(smt::Sort s) override;
+    bool is_array_sort(smt::Sort s) override;
     bool is_rm_sort(smt::Sort s);
     uint32_t get_bv_width(smt::Sort s) override;
     std::pair<uint32_t, uint32_t> get_fp_dims(smt::Sort s) override;
@@ -36,11 +46,13 @@ namespace symir::solver {
     smt::Term make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) override;
     smt::Term make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) override;
     smt::Term make_rm_value(smt::RoundingMode rm) override;
+    smt::Term make_const_array(smt::Sort s, smt::Term val) override;
 
     smt::Term make_const(smt::Sort s, const std::string &name) override;
 
+    using smt::ISolver::make_term;
     smt::Term make_term(
-        smt::Kind k, const std::vector<smt::Term> &args, const std::vector<uint32_t> &indices
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
     ) override;
 
     smt::Sort get_sort(smt::Term t) override;
@@ -50,20 +62,66 @@ namespace symir::solver {
     void assert_formula(smt::Term t) override;
     smt::Result check_sat() override;
 
+    void push(uint32_t levels) override;
+    void pop(uint32_t levels) override;
+    smt::Result check_sat_assuming(const std::vector<smt::Term> &assumptions) override;
+    std::vector<smt::Term> get_unsat_assumptions() override;
+    void interrupt() override;
+
     smt::Term get_value(smt::Term t) override;
     std::string get_bv_value_string(smt::Term t, uint8_t base) override;
     std::string get_fp_value_string(smt::Term t) override;
 
   private:
-    ::alivesmt::smt_initializer initializer;
     std::unique_ptr<::alivesmt::Solver> solver;
     std::unique_ptr<::alivesmt::Result> last_result;
-
-    ::alivesmt::expr unwrap(smt::Term t) const;
-    ::alivesmt::expr unwrap(smt::Sort s) const;
-
-    smt::Term wrap(const ::alivesmt::expr &t) const;
-    smt::Sort wrap_sort(const ::alivesmt::expr &s) const;
+    std::vector<smt::Term> last_assumptions; // of the last check_sat_assuming
+    uint32_t maxMemoryMb_ = 0;               // per check; 0 = none
+
+    // Handle tables; slot 0 is the empty handle. Sorts are represented by
+    // an expression of that sort and deduplicated, terms are appended.
+    std::vector<::alivesmt::expr> terms_;
+    std::vector<::alivesmt::expr> sorts_;
+
+    // What the sort queries need to know of a sort, worked out once per
+    // sort handle (parallel to sorts_), so that they need no Z3 calls.
+    struct SortInfo {
+      enum class Kind { Other, Bool, BV, FP, Array, RM };
+      Z3_sort z3 = nullptr;
+      Kind kind = Kind::Other;
+      uint32_t width = 0;        // BV
+      uint32_t exp = 0, sig = 0; // FP
+    };
+    std::vector<SortInfo> sortInfo_;
+    std::unordered_map<Z3_sort, uint32_t> sortIds_; // Z3 sorts are hash-consed
+    std::vector<smt::Sort> bvSorts_;                // by width
+    smt::Sort boolSort_, floatSort_, doubleSort_;
+    std::vector<smt::Term> bvZero_, bvOne_; // by sort handle
+
+    // make_term() results by request, {kind, #args, args..., indices...}:
+    // without a TermBuilder in front, the executor asks for the same terms
+    // again and again.
+    struct KeyHash {
+      std::size_t operator()(const std::vector<uint32_t> &key) const;
+    };
+    std::unordered_map<std::vector<uint32_t>, smt::Term, KeyHash> memo_;
+
+    const ::alivesmt::expr &unwrap(smt::Term t) const;
+    const ::alivesmt::expr &unwrap(smt::Sort s) const;
+    const SortInfo &info(smt::Sort s) const;
+
+    smt::Term wrap(::alivesmt::expr t);
+    smt::Sort wrap_sort(const ::alivesmt::expr &s);
+
+    smt::Term make_bv_literal(smt::Sort s, uint64_t val);
+    // BV and Boolean operators straight through the Z3 API; nullptr for the
+    // kinds left to the AliveSMT operators (FP, overflow checks).
+    Z3_ast make_z3_term(
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+    );
+    ::alivesmt::expr make_alive_term(
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+    );
 
     ::alivesmt::expr map_rm(smt::RoundingMode rm) const;
   };
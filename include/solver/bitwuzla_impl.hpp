@@ -1,22 +1,84 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <bitwuzla/cpp/bitwuzla.h>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "solver/smt.hpp"
 
 namespace symir::solver {
 
+  /**
+   * A Bitwuzla TermManager shared by the solvers of one thread, with the
+   * sorts and constants every query needs made once.
+   *
+   * SymbolicExecutor asks for a new solver per path (per session with
+   * incremental sampling); each one is a fresh bitwuzla::Bitwuzla over
+   * this context instead of a TermManager of its own, so sorts, rounding
+   * modes and common values are not rebuilt from nothing every query.
+   *
+   * Not thread-safe: a TermManager and the terms made by it must stay on
+   * one thread. forThisThread() hands out one context per thread, and a
+   * solver must be used on the thread that made it.
+   */
+  class BitwuzlaContext {
+  public:
+    BitwuzlaContext() = default;
+    BitwuzlaContext(const BitwuzlaContext &) = delete;
+    BitwuzlaContext &operator=(const BitwuzlaContext &) = delete;
+
+    static std::shared_ptr<BitwuzlaContext> forThisThread();
+
+    bitwuzla::TermManager &tm() { return tm_; }
+
+    const bitwuzla::Sort &boolSort();
+    const bitwuzla::Sort &bvSort(uint32_t width);
+    const bitwuzla::Sort &fpSort(uint32_t exp, uint32_t sig);
+    const bitwuzla::Term &rm(bitwuzla::RoundingMode mode);
+    const bitwuzla::Term &bvZero(uint32_t width);
+    const bitwuzla::Term &bvOne(uint32_t width);
+
+  private:
+    bitwuzla::TermManager tm_;
+    bitwuzla::Sort bool_;
+    std::vector<bitwuzla::Sort> bv_; // by width; null until first asked for
+    std::map<std::pair<uint32_t, uint32_t>, bitwuzla::Sort> fp_;
+    std::array<bitwuzla::Term, 5> rm_;
+    std::vector<bitwuzla::Term> zero_, one_; // by width
+  };
+
   class BitwuzlaSolver : public smt::ISolver {
   public:
+    // Bitwuzla options; the defaults are Bitwuzla's own.
+    struct Options {
+      uint32_t timeout_ms = 0;
+      uint32_t seed = 0;
+      uint32_t num_smt_threads = 1;
+      bool preprocess = true;     // run the preprocessing passes before solving
+      uint32_t rewrite_level = 2; // 0 (off) to 2 (full)
+      uint32_t memory_limit_mb = 0; // 0 = none
+    };
+
+    // On the calling thread's context (BitwuzlaContext::forThisThread()).
     BitwuzlaSolver(uint32_t timeout_ms = 0, uint32_t seed = 0, uint32_t num_smt_threads = 1);
+    explicit BitwuzlaSolver(
+        const Options &options,
+        std::shared_ptr<BitwuzlaContext> ctx = BitwuzlaContext::forThisThread()
+    );
     ~BitwuzlaSolver() override = default;
 
     smt::Sort make_bv_sort(uint32_t size) override;
     smt::Sort make_fp_sort(uint32_t exp, uint32_t sig) override;
     smt::Sort make_bool_sort() override;
+    smt::Sort make_array_sort(smt::Sort index, smt::Sort elem) override;
 
     bool is_bv_sort(smt::Sort s) override;
     bool is_fp_sort(smt::Sort s) override;
     bool is_bool_sort(smt::Sort s) override;
+    bool is_array_sort(smt::Sort s) override;
     bool is_rm_sort(smt::Sort s);
     uint32_t get_bv_width(smt::Sort s) override;
     std::pair<uint32_t, uint32_t> get_fp_dims(smt::Sort s) override;
@@ -34,11 +96,13 @@ namespace symir::solver {
     smt::Term make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) override;
     smt::Term make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) override;
     smt::Term make_rm_value(smt::RoundingMode rm) override;
+    smt::Term make_const_array(smt::Sort s, smt::Term val) override;
 
     smt::Term make_const(smt::Sort s, const std::string &name) override;
 
+    using smt::ISolver::make_term;
     smt::Term make_term(
-        smt::Kind k, const std::vector<smt::Term> &args, const std::vector<uint32_t> &indices
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
     ) override;
 
     smt::Sort get_sort(smt::Term t) override;
@@ -48,21 +112,45 @@ namespace symir::solver {
     void assert_formula(smt::Term t) override;
     smt::Result check_sat() override;
 
+    void push(uint32_t levels) override;
+    void pop(uint32_t levels) override;
+    smt::Result check_sat_assuming(const std::vector<smt::Term> &assumptions) override;
+    std::vector<smt::Term> get_unsat_assumptions() override;
+    void interrupt() override;
+
     smt::Term get_value(smt::Term t) override;
     std::string get_bv_value_string(smt::Term t, uint8_t base) override;
     std::string get_fp_value_string(smt::Term t) override;
 
   private:
-    bitwuzla::TermManager tm;
-    bitwuzla::Bitwuzla solver;
+    // Polled by Bitwuzla during a check; set by interrupt().
+    class Terminator : public bitwuzla::Terminator {
+    public:
+      explicit Terminator(const std::atomic<bool> &flag) : flag(flag) {}
 
-    // Using a map to cache or manage lifetime if necessary,
-    // but for shared_ptr<void> we just allocate new wrappers.
+      bool terminate() override { return flag.load(std::memory_order_relaxed); }
+
+    private:
+      const std::atomic<bool> &flag;
+    };
+
+    std::atomic<bool> interrupted{false};
+    Terminator terminator{interrupted}; // outlives `solver`, which polls it
+    std::shared_ptr<BitwuzlaContext> ctx; // outlives `solver` and every term
+    bitwuzla::TermManager &tm;
+    bitwuzla::Bitwuzla solver;
 
-    bitwuzla::Sort unwrap(smt::Sort s) const;
-    bitwuzla::Term unwrap(smt::Term t) const;
-    smt::Sort wrap(bitwuzla::Sort s) const;
-    smt::Term wrap(bitwuzla::Term t) const;
+    // Handle tables; slot 0 is the empty handle. Bitwuzla hash-conses its
+    // terms, so the reverse maps keep one slot per distinct term/sort.
+    std::vector<bitwuzla::Sort> sorts_;
+    std::vector<bitwuzla::Term> terms_;
+    std::unordered_map<bitwuzla::Sort, uint32_t> sortIds_;
+    std::unordered_map<bitwuzla::Term, uint32_t> termIds_;
+
+    const bitwuzla::Sort &unwrap(smt::Sort s) const;
+    const bitwuzla::Term &unwrap(smt::Term t) const;
+    smt::Sort wrap(const bitwuzla::Sort &s);
+    smt::Term wrap(const bitwuzla::Term &t);
 
     bitwuzla::Kind map_kind(smt::Kind k) const;
     bitwuzla::RoundingMode map_rm(smt::RoundingMode rm) const;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "solver/smt.hpp"
+
+namespace symir::solver {
+
+  /**
+   * Cooperative cancellation of solver checks that run on several threads.
+   *
+   * A check runs through run(), which registers its solver for as long as
+   * the check runs. cancel() interrupts every registered solver and makes
+   * every later run() return UNKNOWN at once, from any thread. An
+   * interrupt that lands before a backend has started its check may be
+   * dropped; drain() interrupts again until every running check is back.
+   *
+   * A cancellation made with a parent is also cancelled with it, so a
+   * per-call cancellation (the first SAT of a parallel sample()) can nest
+   * in a per-request one (its deadline).
+   */
+  class Cancellation {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Cancellation(Cancellation *parent = nullptr);
+    ~Cancellation();
+
+    Cancellation(const Cancellation &) = delete;
+    Cancellation &operator=(const Cancellation &) = delete;
+
+    /// Runs `check`, a check on `solver`, unless already cancelled (then
+    /// UNKNOWN). A check cancelled while it runs returns what the backend
+    /// answers, UNKNOWN unless it was done already.
+    smt::Result run(smt::ISolver &solver, const std::function<smt::Result()> &check);
+
+    /// Cancels every running and later check. Does not wait.
+    void cancel();
+    /// After cancel(): interrupts the checks still running until all of
+    /// them are back.
+    void drain();
+
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    /// Cancels (and drains) once `deadline` passes, on a watchdog thread
+    /// shared by all cancellations. The cancellation must outlive its
+    /// deadline or be destroyed first.
+    void cancelAt(Clock::time_point deadline);
+
+  private:
+    friend class Watchdog;
+
+    void interruptRunning(); // mu_ held
+
+    Cancellation *parent_;
+    std::atomic<bool> cancelled_{false};
+    std::mutex mu_;
+    std::condition_variable idle_;
+    std::vector<smt::ISolver *> running_;
+    std::vector<Cancellation *> children_;
+    bool watched_ = false;
+  };
+
+} // namespace symir::solver
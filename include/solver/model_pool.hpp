@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace symir::solver {
+
+  /**
+   * The most recent SAT models of each function, shared by executors and
+   * threads.
+   *
+   * Before encoding a path, SymbolicExecutor runs the function concretely
+   * under these models (see Config::model_pool). Paths sampled from the
+   * same template are often satisfied by a model that is already known,
+   * and a concrete run costs far less than a solver call. Models are keyed
+   * by function name only; a model that does not fit simply fails to
+   * replay.
+   */
+  class ModelPool {
+  public:
+    using Model = std::unordered_map<std::string, std::variant<int64_t, double>>;
+
+    explicit ModelPool(std::size_t perFunction = 4) : perFunction_(perFunction) {}
+
+    ModelPool(const ModelPool &) = delete;
+    ModelPool &operator=(const ModelPool &) = delete;
+
+    // Newest first.
+    std::vector<Model> recent(const std::string &function) const;
+
+    // Makes `model` the newest of `function`, dropping the oldest beyond
+    // the per-function limit.
+    void add(const std::string &function, Model model);
+
+  private:
+    std::size_t perFunction_;
+    mutable std::mutex mu_;
+    std::unordered_map<std::string, std::deque<Model>> models_;
+  };
+
+} // namespace symir::solver
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "solver/smt.hpp"
+
+namespace symir::solver {
+
+  /**
+   * ISolver that mirrors every sort, term and assertion into several
+   * backends and races them on each check.
+   *
+   * A check runs every member concurrently on its own thread; the first
+   * definitive answer (SAT/UNSAT) wins and the remaining members are
+   * interrupted and awaited before the call returns, so members are never
+   * used by two threads at once. Model queries go to the member that won
+   * the last check.
+   */
+  class PortfolioSolver : public smt::ISolver {
+  public:
+    struct Member {
+      std::string name;
+      std::unique_ptr<smt::ISolver> solver;
+    };
+
+    explicit PortfolioSolver(std::vector<Member> members);
+
+    // Name of the member that answered the last check ("" before any check).
+    const std::string &winner() const;
+
+    smt::Sort make_bv_sort(uint32_t size) override;
+    smt::Sort make_fp_sort(uint32_t exp, uint32_t sig) override;
+    smt::Sort make_bool_sort() override;
+    smt::Sort make_array_sort(smt::Sort index, smt::Sort elem) override;
+
+    bool is_bv_sort(smt::Sort s) override;
+    bool is_fp_sort(smt::Sort s) override;
+    bool is_bool_sort(smt::Sort s) override;
+    bool is_array_sort(smt::Sort s) override;
+    uint32_t get_bv_width(smt::Sort s) override;
+    std::pair<uint32_t, uint32_t> get_fp_dims(smt::Sort s) override;
+
+    smt::Term make_true() override;
+    smt::Term make_false() override;
+    smt::Term make_bv_value(smt::Sort s, const std::string &val, uint8_t base) override;
+    smt::Term make_bv_value_uint64(smt::Sort s, uint64_t val) override;
+    smt::Term make_bv_value_int64(smt::Sort s, int64_t val) override;
+    smt::Term make_bv_zero(smt::Sort s) override;
+    smt::Term make_bv_one(smt::Sort s) override;
+    smt::Term make_bv_min_signed(smt::Sort s) override;
+    smt::Term make_bv_max_signed(smt::Sort s) override;
+
+    smt::Term make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) override;
+    smt::Term make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) override;
+    smt::Term make_rm_value(smt::RoundingMode rm) override;
+    smt::Term make_const_array(smt::Sort s, smt::Term val) override;
+
+    smt::Term make_const(smt::Sort s, const std::string &name) override;
+
+    using smt::ISolver::make_term;
+    smt::Term make_term(
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+    ) override;
+
+    smt::Sort get_sort(smt::Term t) override;
+    bool is_true(smt::Term t) override;
+    bool is_false(smt::Term t) override;
+
+    void assert_formula(smt::Term t) override;
+    smt::Result check_sat() override;
+
+    void push(uint32_t levels) override;
+    void pop(uint32_t levels) override;
+    smt::Result check_sat_assuming(const std::vector<smt::Term> &assumptions) override;
+    std::vector<smt::Term> get_unsat_assumptions() override;
+    void interrupt() override;
+
+    smt::Term get_value(smt::Term t) override;
+    std::string get_bv_value_string(smt::Term t, uint8_t base) override;
+    std::string get_fp_value_string(smt::Term t) override;
+
+  private:
+    // Handle tables: entry `id * size() + i` is member i's handle for
+    // portfolio handle `id`. Slot 0 is the empty handle.
+    std::size_t size() const { return members_.size(); }
+
+    template<typename Make>
+    smt::Sort makeSort(Make &&make);
+    template<typename Make>
+    smt::Term makeTerm(Make &&make);
+
+    smt::Sort memberSort(smt::Sort s, std::size_t i) const;
+    smt::Term memberTerm(smt::Term t, std::size_t i) const;
+
+    // Runs `check(i)` for every member concurrently; see the class comment.
+    template<typename Check>
+    smt::Result race(Check &&check);
+
+    std::vector<Member> members_;
+    std::vector<smt::Sort> sorts_;
+    std::vector<smt::Term> terms_;
+    std::vector<smt::Term> assumptions_; // of the last check_sat_assuming
+    std::size_t winner_ = 0;
+    bool checked_ = false;
+  };
+
+} // namespace symir::solver
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace symir::solver {
+
+  /**
+   * Persistent cache of definitive solver answers, shared by threads and
+   * processes.
+   *
+   * Queries are keyed by a 128-bit hash of their canonical text (see
+   * TermBuilder::fingerprint). An entry holds the verdict and, for SAT, the
+   * model values of the query's consts by their canonical index.
+   *
+   * The cache is one append-only file, `<dir>/queries.bin`. It is
+   * memory-mapped and indexed when opened. Records appended by other
+   * processes are picked up on a miss. Appends take an exclusive flock, so
+   * concurrent writers never interleave records, and a torn tail left by a
+   * crash is cut off the next time the file is opened.
+   */
+  class QueryCache {
+  public:
+    struct Key {
+      uint64_t lo = 0, hi = 0;
+
+      bool operator==(const Key &o) const { return lo == o.lo && hi == o.hi; }
+    };
+
+    struct Value {
+      uint32_t constIndex = 0; // position of the const in the fingerprint
+      bool isFloat = false;    // `bits` holds a double
+      uint64_t bits = 0;       // otherwise an int64_t
+    };
+
+    struct Entry {
+      bool sat = false;
+      std::vector<Value> model;
+    };
+
+    struct Stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t stores = 0;
+    };
+
+    // Creates `dir` if needed. Throws std::runtime_error if the cache file
+    // cannot be opened.
+    explicit QueryCache(const std::string &dir);
+    ~QueryCache();
+
+    QueryCache(const QueryCache &) = delete;
+    QueryCache &operator=(const QueryCache &) = delete;
+
+    static Key keyOf(std::string_view canonicalText);
+
+    std::optional<Entry> lookup(const Key &key);
+    void insert(const Key &key, const Entry &entry);
+
+    Stats stats() const { return {hits_.load(), misses_.load(), stores_.load()}; }
+
+  private:
+    struct KeyHash {
+      std::size_t operator()(const Key &k) const { return static_cast<std::size_t>(k.lo); }
+    };
+
+    // Indexes the records in [loaded_, file size). Returns the offset right
+    // past the last complete record. Caller holds mu_ and a file lock.
+    uint64_t loadTail();
+
+    std::string path_;
+    int fd_ = -1;
+    uint64_t loaded_ = 0; // bytes of the file already indexed
+    std::mutex mu_;
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+    std::atomic<uint64_t> hits_{0}, misses_{0}, stores_{0};
+  };
+
+} // namespace symir::solver
@@ -1,31 +1,37 @@
 #pragma once
 
 #include <cstdint>
-#include <memory>
+#include <initializer_list>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace symir::smt {
 
-  // Opaque handles for Sort and Term
-  // Implementations should cast these to their concrete types.
-  // We use shared_ptr to allow implementations to manage lifetime (e.g. ref counting)
-  // if necessary.
+  // Opaque handles for Sort and Term: 32-bit indices into a table owned by
+  // the solver that created them. Copying a handle is free; the solver keeps
+  // every term and sort it handed out alive until it is destroyed, so a
+  // handle is only meaningful together with (and during the life of) its
+  // solver. Index 0 is the empty handle.
   struct Sort {
-    std::shared_ptr<void> internal;
+    uint32_t id = 0;
 
-    bool operator==(const Sort &other) const { return internal == other.internal; }
+    explicit operator bool() const { return id != 0; }
 
-    bool operator!=(const Sort &other) const { return internal != other.internal; }
+    bool operator==(const Sort &other) const { return id == other.id; }
+
+    bool operator!=(const Sort &other) const { return id != other.id; }
   };
 
   struct Term {
-    std::shared_ptr<void> internal;
+    uint32_t id = 0;
+
+    explicit operator bool() const { return id != 0; }
 
-    bool operator==(const Term &other) const { return internal == other.internal; }
+    bool operator==(const Term &other) const { return id == other.id; }
 
-    bool operator!=(const Term &other) const { return internal != other.internal; }
+    bool operator!=(const Term &other) const { return id != other.id; }
   };
 
   enum class Kind {
@@ -102,7 +108,11 @@ namespace symir::smt {
     // Overflow checks
     BV_SADD_OVERFLOW,
     BV_SSUB_OVERFLOW,
-    BV_SMUL_OVERFLOW
+    BV_SMUL_OVERFLOW,
+
+    // Arrays
+    ARRAY_SELECT, // (select a i)
+    ARRAY_STORE   // (store a i v)
   };
 
   enum class RoundingMode { RNE, RNA, RTP, RTN, RTZ };
@@ -117,11 +127,13 @@ namespace symir::smt {
     virtual Sort make_bv_sort(uint32_t size) = 0;
     virtual Sort make_fp_sort(uint32_t exp, uint32_t sig) = 0;
     virtual Sort make_bool_sort() = 0;
+    virtual Sort make_array_sort(Sort index, Sort elem) = 0;
 
     // Sort inspection
     virtual bool is_bv_sort(Sort s) = 0;
     virtual bool is_fp_sort(Sort s) = 0;
     virtual bool is_bool_sort(Sort s) = 0;
+    virtual bool is_array_sort(Sort s) = 0;
     virtual uint32_t get_bv_width(Sort s) = 0;
     virtual std::pair<uint32_t, uint32_t> get_fp_dims(Sort s) = 0;
 
@@ -140,18 +152,35 @@ namespace symir::smt {
     virtual Term make_fp_value_from_real(Sort s, double val, RoundingMode rm) = 0;
     virtual Term make_rm_value(RoundingMode rm) = 0;
 
+    // Array whose every element is `val`; `s` must be an array sort.
+    virtual Term make_const_array(Sort s, Term val) = 0;
+
     // Term creation - Variables
     virtual Term make_const(Sort s, const std::string &name) = 0;
 
     // Term creation - Operations
     virtual Term
-    make_term(Kind k, const std::vector<Term> &args, const std::vector<uint32_t> &indices = {}) = 0;
+    make_term(Kind k, std::span<const Term> args, std::span<const uint32_t> indices = {}) = 0;
+
+    // Braced operand lists, e.g. make_term(Kind::BV_EXTRACT, {t}, {31, 0}), without
+    // building a temporary vector.
+    Term make_term(
+        Kind k, std::initializer_list<Term> args, std::initializer_list<uint32_t> indices = {}
+    ) {
+      return make_term(
+          k, std::span<const Term>(args.begin(), args.size()),
+          std::span<const uint32_t>(indices.begin(), indices.size())
+      );
+    }
 
     // Helper for simple binary ops
-    Term make_term(Kind k, Term a, Term b) { return make_term(k, std::vector<Term>{a, b}); }
+    Term make_term(Kind k, Term a, Term b) {
+      const Term args[] = {a, b};
+      return make_term(k, args);
+    }
 
     // Helper for simple unary ops
-    Term make_term(Kind k, Term a) { return make_term(k, std::vector<Term>{a}); }
+    Term make_term(Kind k, Term a) { return make_term(k, std::span<const Term>(&a, 1)); }
 
     // Term inspection
     virtual Sort get_sort(Term t) = 0;
@@ -162,6 +191,22 @@ namespace symir::smt {
     virtual void assert_formula(Term t) = 0;
     virtual Result check_sat() = 0;
 
+    // Incremental solving. Assertions made after a push() are retracted by
+    // the matching pop(); terms created in between stay valid. Assumptions
+    // only hold for the one check and leave the assertion stack untouched.
+    virtual void push(uint32_t levels = 1) = 0;
+    virtual void pop(uint32_t levels = 1) = 0;
+    virtual Result check_sat_assuming(const std::vector<Term> &assumptions) = 0;
+    // After check_sat_assuming() returned UNSAT: a subset of its
+    // assumptions that is already UNSAT together with the assertions (not
+    // necessarily minimal; empty if the assertions alone are UNSAT).
+    virtual std::vector<Term> get_unsat_assumptions() = 0;
+
+    // Asks a check running on another thread to give up and return UNKNOWN.
+    // Safe to call from any thread; a request that arrives while no check is
+    // running may be dropped.
+    virtual void interrupt() = 0;
+
     // Model generation
     virtual Term get_value(Term t) = 0; // Returns a constant term representing the value
     virtual std::string get_bv_value_string(Term t, uint8_t base) = 0;
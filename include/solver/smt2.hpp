@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "solver/smt.hpp"
+
+namespace symir::solver {
+
+  // Answer to one SMT-LIB2 query: the verdict of its last check and what
+  // the `get-value` or `get-unsat-assumptions` after it returned.
+  struct Smt2Answer {
+    smt::Result result = smt::Result::UNKNOWN;
+    // After SAT: const symbol (without `|...|`) -> value literal, e.g. `#b0101`.
+    std::unordered_map<std::string, std::string> values;
+    // After UNSAT of a check-sat-assuming: the assumptions in the core, as
+    // written in the query.
+    std::vector<std::string> unsatAssumptions;
+  };
+
+  // The answer as a solver would print it: `sat`, `unsat` or `unknown`,
+  // then the values or the core as one S-expression.
+  std::string formatSmt2Answer(const Smt2Answer &answer);
+  // Reads formatSmt2Answer() output, or the output of an SMT-LIB2 solver
+  // run on the query (errors after the verdict are skipped). Throws
+  // std::runtime_error if there is no verdict.
+  Smt2Answer parseSmt2Answer(const std::string &text);
+
+  /**
+   * Runs an SMT-LIB2 script on `backend` and answers its last check.
+   *
+   * Only the subset that Smt2Solver writes is read: declare-const,
+   * define-fun without parameters, assert, push, pop, check-sat,
+   * check-sat-assuming, get-value and get-unsat-assumptions over the
+   * operators of smt::Kind (set-logic, set-option and set-info are
+   * skipped). Throws std::runtime_error on anything else.
+   */
+  Smt2Answer runSmt2(const std::string &script, smt::ISolver &backend);
+
+  /**
+   * ISolver that writes SMT-LIB2 instead of solving.
+   *
+   * Terms are kept in a table of its own; each operation reaching an
+   * assertion or assumption is defined once with `define-fun`, so shared
+   * subterms are not repeated. At each check the complete script so far
+   * (declarations, definitions, assertions, pushes and pops), the check
+   * and a `get-value` of all consts become one self-contained query, which
+   * `transport` answers, e.g. by runSmt2() or a remote worker. Model
+   * values are read from the answer; get_value() only works on consts.
+   */
+  class Smt2Solver : public smt::ISolver {
+  public:
+    // Answers a query; `cancel` is set by interrupt() while it runs.
+    using Transport =
+        std::function<Smt2Answer(const std::string &script, const std::atomic<bool> &cancel)>;
+
+    explicit Smt2Solver(Transport transport);
+
+    smt::Sort make_bv_sort(uint32_t size) override;
+    smt::Sort make_fp_sort(uint32_t exp, uint32_t sig) override;
+    smt::Sort make_bool_sort() override;
+    smt::Sort make_array_sort(smt::Sort index, smt::Sort elem) override;
+
+    bool is_bv_sort(smt::Sort s) override;
+    bool is_fp_sort(smt::Sort s) override;
+    bool is_bool_sort(smt::Sort s) override;
+    bool is_array_sort(smt::Sort s) override;
+    uint32_t get_bv_width(smt::Sort s) override;
+    std::pair<uint32_t, uint32_t> get_fp_dims(smt::Sort s) override;
+
+    smt::Term make_true() override;
+    smt::Term make_false() override;
+    smt::Term make_bv_value(smt::Sort s, const std::string &val, uint8_t base) override;
+    smt::Term make_bv_value_uint64(smt::Sort s, uint64_t val) override;
+    smt::Term make_bv_value_int64(smt::Sort s, int64_t val) override;
+    smt::Term make_bv_zero(smt::Sort s) override;
+    smt::Term make_bv_one(smt::Sort s) override;
+    smt::Term make_bv_min_signed(smt::Sort s) override;
+    smt::Term make_bv_max_signed(smt::Sort s) override;
+
+    smt::Term make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) override;
+    smt::Term make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) override;
+    smt::Term make_rm_value(smt::RoundingMode rm) override;
+    smt::Term make_const_array(smt::Sort s, smt::Term val) override;
+
+    smt::Term make_const(smt::Sort s, const std::string &name) override;
+
+    using smt::ISolver::make_term;
+    smt::Term make_term(
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+    ) override;
+
+    smt::Sort get_sort(smt::Term t) override;
+    bool is_true(smt::Term t) override;
+    bool is_false(smt::Term t) override;
+
+    void assert_formula(smt::Term t) override;
+    smt::Result check_sat() override;
+
+    void push(uint32_t levels) override;
+    void pop(uint32_t levels) override;
+    smt::Result check_sat_assuming(const std::vector<smt::Term> &assumptions) override;
+    std::vector<smt::Term> get_unsat_assumptions() override;
+    void interrupt() override;
+
+    smt::Term get_value(smt::Term t) override;
+    std::string get_bv_value_string(smt::Term t, uint8_t base) override;
+    std::string get_fp_value_string(smt::Term t) override;
+
+  private:
+    enum class SortKind { Bool, BV, FP, RM, Array };
+
+    struct SortInfo {
+      SortKind kind;
+      uint32_t a = 0; // BV width, FP exponent width or array index sort id
+      uint32_t b = 0; // FP significand width (incl. hidden bit) or array element sort id
+    };
+
+    struct Node {
+      smt::Sort sort;
+      // Leaves: the literal or symbol. Operations: the operator applied to
+      // `args`, e.g. `bvadd` or `(_ extract 7 0)`.
+      std::string text;
+      std::vector<smt::Term> args;
+      bool leaf = true;
+      bool isConst = false;
+      bool defined = false; // written as `t<id>` already
+      std::string bits;     // BV, FP and Bool literals: their bits, MSB first
+    };
+
+    smt::Sort sortOf(SortKind kind, uint32_t a = 0, uint32_t b = 0);
+    const SortInfo &info(smt::Sort s) const;
+    const Node &node(smt::Term t) const;
+    std::string sortText(smt::Sort s) const;
+    smt::Term leaf(smt::Sort s, std::string text, std::string bits = {});
+    smt::Term bvLiteral(smt::Sort s, std::string bits);
+    // The term as it appears in a command, writing its definition first.
+    std::string ref(smt::Term t);
+    smt::Result check(const std::string &command);
+
+    Transport transport_;
+    std::atomic<bool> cancel_{false};
+    std::vector<SortInfo> sorts_; // sort id - 1
+    std::map<std::tuple<int, uint32_t, uint32_t>, smt::Sort> sortIds_;
+    std::vector<Node> nodes_;     // term id - 1
+    std::vector<smt::Term> consts_;
+    std::string body_; // declarations, definitions, assertions, pushes and pops
+    smt::Term true_, false_;
+
+    Smt2Answer answer_; // of the last check
+    std::vector<std::pair<std::string, smt::Term>> assumptions_;
+    std::unordered_map<uint32_t, smt::Term> values_; // const -> its value in answer_
+  };
+
+} // namespace symir::solver
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "solver/smt.hpp"
+#include "solver/smt2.hpp"
+
+namespace symir::solver {
+
+  /**
+   * Exchange of SMT-LIB2 queries through a shared directory (e.g. on a
+   * network file system) between processes that encode paths with an
+   * Smt2Solver and worker processes that solve them with serve().
+   *
+   * A query is `<dir>/<id>.smt2`, its answer `<dir>/<id>.ans` in the
+   * format of formatSmt2Answer(). Both are written under a temporary name
+   * and renamed into place, and a worker claims a query by renaming it, so
+   * any number of submitters and workers can share one directory.
+   */
+  class Smt2Spool {
+  public:
+    using BackendFactory = std::function<std::unique_ptr<smt::ISolver>()>;
+
+    // Creates `dir` if needed. Throws std::runtime_error if it cannot.
+    explicit Smt2Spool(std::string dir);
+
+    Smt2Spool(const Smt2Spool &) = delete;
+    Smt2Spool &operator=(const Smt2Spool &) = delete;
+
+    // Writes `script` as a new query and returns its path.
+    std::string write(const std::string &script);
+
+    // Writes `script` as a new query and waits until a worker answers it.
+    // Gives up with UNKNOWN (withdrawing the query) once `cancel` is set.
+    Smt2Answer submit(const std::string &script, const std::atomic<bool> &cancel);
+
+    // Worker loop: claims queries, runs each on a fresh backend from
+    // `factory` and writes the answer, until no query arrived for `idleMs`
+    // milliseconds (0 = forever). Safe to run in several threads and
+    // processes at once. Returns the number of queries answered.
+    uint64_t serve(const BackendFactory &factory, uint32_t idleMs);
+
+  private:
+    std::string dir_;
+    std::string prefix_; // host and pid, so ids are unique across processes
+    std::atomic<uint64_t> next_{0};
+  };
+
+} // namespace symir::solver
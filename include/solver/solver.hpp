@@ -1,12 +1,32 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
 #include <span>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include "analysis/analysis_manager.hpp"
+#include "analysis/cfg.hpp"
+#include "analysis/intervals.hpp"
+#include "analysis/points_to.hpp"
 #include "ast/ast.hpp"
+#include "solver/cancel.hpp"
+#include "solver/model_pool.hpp"
+#include "solver/query_cache.hpp"
 #include "solver/smt.hpp"
+#include "solver/solver_stats.hpp"
+#include "solver/term_builder.hpp"
+#include "solver/work_pool.hpp"
 
 namespace symir {
 
@@ -22,6 +42,138 @@ namespace symir {
       uint32_t seed = 0;
       uint32_t num_threads = 1;
       uint32_t num_smt_threads = 1; // Number of threads for the SMT solver backend
+      // Bitwuzla backend: run its preprocessing passes before solving, and
+      // its rewrite level (0 = off to 2 = full, Bitwuzla's default).
+      bool bitwuzla_preprocess = true;
+      uint32_t bitwuzla_rewrite_level = 2;
+      // sample(): keep one solver per worker and only re-encode the suffix
+      // of each path that differs from the previous one (push/pop).
+      bool incremental = false;
+      // sample(): cap (in MiB, split across workers) of the prefix trie that
+      // caches symbolic state per path prefix. 0 disables the cache.
+      uint32_t prefix_cache_mb = 0;
+      // Route all term construction through a hash-consing, constant-folding
+      // TermBuilder in front of the backend (see solver/term_builder.hpp).
+      bool term_builder = true;
+      // Dispatch each load and store only over the lets its pointer may
+      // address (see analysis/points_to.hpp) instead of every let whose
+      // type matches.
+      bool points_to = true;
+      // Run the interval pre-pass (see analysis/intervals.hpp) over every
+      // path before it is solved: paths it refutes are UNSAT without a
+      // solver call, and the sym ranges it narrows are asserted as extra
+      // constraints. sample() also skips edges it proves dead.
+      bool intervals = true;
+      // How arrays of scalars are encoded: one term per element with ITE
+      // chains for symbolic indices, or a single SMT Array(BV32, T) read
+      // and written with select/store. Auto picks SmtArray for arrays of
+      // at least `array_threshold` elements.
+      enum class ArrayEncoding { Auto, Ite, SmtArray };
+      ArrayEncoding array_encoding = ArrayEncoding::Auto;
+      uint32_t array_threshold = 64;
+      // sample(): encode the walk block by block and, at each conditional
+      // branch, only follow a successor whose edge is still satisfiable, so
+      // sampled paths are feasible by construction.
+      bool online_sampling = false;
+      // sample(): timeout escalation. When set, sampling stops after this
+      // many milliseconds of wall-clock time. Every path is first checked
+      // with `initial_timeout_ms`, and paths that come back UNKNOWN are
+      // retried, once all fresh walks are done, with a timeout
+      // `timeout_growth` times larger each round (capped by timeout_ms, if
+      // set, and by the time left). Each check gets a fresh solver, so
+      // incremental sessions are not used.
+      uint32_t time_budget_ms = 0;
+      uint32_t initial_timeout_ms = 100;
+      uint32_t timeout_growth = 4;
+      // sample(): check each path with one assumption per block, and when
+      // it is UNSAT learn the path prefix up to the deepest block in the
+      // UNSAT core as a nogood that later walks steer around. Each path
+      // gets a fresh solver, so incremental sessions are not used; ignored
+      // with online_sampling.
+      bool learn_nogoods = false;
+      // solve()/sample()/enumerateModels(): state merging. At a conditional
+      // br on the path whose arms reconverge at its immediate post-dominator
+      // through a small acyclic region, every block of the region is
+      // encoded under the condition of reaching it and the stores are
+      // merged with ITEs at the join, so one query covers every concrete
+      // path through the region; the path's own choice inside it is only a
+      // representative. Paths with a merged region skip the interval
+      // pre-pass (its refutations hold for one concrete path), and sample()
+      // solves each path on a fresh solver and skips walks that only differ
+      // from a refuted one inside merged regions.
+      bool merge_joins = false;
+      // Assert each distinct UB guard and other path constraint of a path
+      // encoded on a fresh solver once, dropping duplicates and constraints
+      // implied by earlier ones (see GuardSet).
+      bool dedup_guards = true;
+      // Encode pointers of each function on the least tag width that holds
+      // its objects (FunctionContext::ptrBits) instead of 64 bits.
+      bool narrow_pointers = true;
+      // Encode a scalar integer sym whose domain (with the range the
+      // interval pre-pass narrowed it to) fits fewer bits than its type as
+      // a narrower const, zero- or sign-extended (or offset) to the type,
+      // and a sym with a DomainSet as an ITE over a selector const; the
+      // domain is then mostly implied instead of asserted.
+      bool narrow_syms = true;
+      // solve(): split the constraints into groups over disjoint sets of
+      // consts and check each group on its own (needs term_builder).
+      bool slicing = false;
+      // solve(), sample() without sessions, enumerateModels(): SSA encoding.
+      // Each value of a scalar local in the function's SSA form (see
+      // analysis/ssa.hpp) that the path reaches is bound to a const of its
+      // own, `%x.3`, by one definition, and phis are bound to the value
+      // that flows in along the path; later terms refer to the const. A
+      // block's terms then depend only on the SSA values it reads, not on
+      // the path that led to it. Literals and consts are not rebound.
+      bool ssa = false;
+      // solve(), sample() without sessions or nogoods: abstraction refinement of
+      // scalar FP arithmetic. Each FP +, -, *, / and % on the path is first
+      // a const of its own, bound only by cheap sign and monotonicity
+      // facts. A SAT model is checked by evaluating the ops on its values
+      // as the Interpreter does, and only the ops it got wrong get their
+      // full encoding before the next check; after `lazy_fp_rounds`
+      // rounds every op does. Such paths skip slicing and the query cache.
+      bool lazy_fp = false;
+      uint32_t lazy_fp_rounds = 4;
+      // solve(), sample() without sessions or nogoods: memory budget of one
+      // query in MiB (0 = none). The encoder counts the terms it builds
+      // (with term_builder) and the aggregates it merges for symbolic
+      // indices; a query over budget is given up and encoded again with
+      // every array of scalars an SMT Array (as ArrayEncoding::SmtArray),
+      // and answers UNKNOWN with the message "memory" if that is over
+      // budget too. The SolverFactory also gets the budget, for the
+      // backends' own memory limit.
+      uint32_t max_memory_mb = 0;
+      // Cache of definitive answers consulted before every check (not
+      // owned; see solver/query_cache.hpp). Needs term_builder.
+      solver::QueryCache *query_cache = nullptr;
+      // solve()/sample(): run each path concretely under the recent SAT
+      // models of its function first, and answer SAT without the backend
+      // when one follows the path with no UB and meets every assume and
+      // require. SAT models are added to the pool (not owned; see
+      // solver/model_pool.hpp). Functions with params or vector syms are
+      // not replayed.
+      solver::ModelPool *model_pool = nullptr;
+      // Ask the SolverFactory for a portfolio that races every available
+      // backend on each check (see solver/portfolio.hpp). The factory falls
+      // back to a single backend when only one is built in.
+      bool portfolio = false;
+      // Threads that run multi-threaded sample() (not owned). Without one,
+      // the executor starts its own pool of num_threads workers on first
+      // use and keeps it for its lifetime.
+      solver::WorkPool *pool = nullptr;
+      // Every check of the executor runs through this cancellation (not
+      // owned; see solver/cancel.hpp). Once it is cancelled, running
+      // checks are interrupted, later ones answer UNKNOWN at once, and
+      // sampling and enumeration stop drawing paths.
+      solver::Cancellation *cancel = nullptr;
+      // Sink for per-query statistics (not owned; see
+      // solver/solver_stats.hpp). Calls are recorded under `stats_label`.
+      solver::SolverStats *stats = nullptr;
+      // Where CFGs and CFG analyses come from (not owned; must serve the
+      // executor's Program). Null: a cache private to the executor.
+      AnalysisManager *analyses = nullptr;
+      std::string stats_label;
     };
 
     using SolverFactory = std::function<std::unique_ptr<smt::ISolver>(const Config &)>;
@@ -59,6 +211,12 @@ namespace symir {
         const std::unordered_map<std::string, int64_t> &fixedSyms = {}
     );
 
+    /**
+     * Hash-cons hits, folds and backend terms of every TermBuilder this
+     * executor created so far (solvers still alive are not included).
+     */
+    solver::TermBuilder::Stats termBuilderStats() const { return termCounters_.load(); }
+
     /**
      * Samples N paths randomly and tries to solve each of them.
      * Stops and returns the first SAT result found.
@@ -69,10 +227,186 @@ namespace symir {
         const std::unordered_map<std::string, int64_t> &fixedSyms = {}
     );
 
+    struct EnumerateOptions {
+      uint32_t maxPathLen = 100;
+      // How often one path may take each back edge (loop iterations).
+      uint32_t unroll = 4;
+      // Stop once this percentage of both blocks and edges is covered.
+      uint32_t coverageTarget = 100;
+      // Stop after this many milliseconds (0 = no limit).
+      uint32_t budgetMs = 0;
+    };
+
+    struct EnumerateResult {
+      struct Witness {
+        std::vector<std::string> path;
+        Result model;
+      };
+
+      // One feasible complete path (with its model) per new coverage, in
+      // the order they were found.
+      std::vector<Witness> witnesses;
+      std::size_t numBlocks = 0, numEdges = 0;
+      std::size_t coveredBlocks = 0, coveredEdges = 0;
+      // Labels of the blocks on no feasible complete path found, and the
+      // subset of them that no feasible path prefix reached either.
+      std::vector<std::string> uncovered, unreached;
+      // The bounded path space was searched completely (no target or
+      // budget stop, no UNKNOWN), so `unreached` blocks are unreachable
+      // within the bounds.
+      bool exhaustive = false;
+      uint64_t checks = 0; // solver calls
+    };
+
+    /**
+     * Enumerates the paths of a function from its entry, depth-first with
+     * one incremental solver, up to opts.maxPathLen blocks and opts.unroll
+     * traversals of each back edge. At every block the successor whose
+     * edge, block and reachable region add the most uncovered items is
+     * tried first; infeasible edges and subtrees with nothing left to cover
+     * are skipped. A block or edge counts as covered once a feasible path
+     * that ends in a terminator goes through it.
+     */
+    EnumerateResult enumerate(
+        const std::string &funcName, const EnumerateOptions &opts,
+        const std::unordered_map<std::string, int64_t> &fixedSyms = {}
+    );
+
+    struct ConcolicOptions {
+      // Concrete runs, the seed input's included (0 = no limit).
+      uint32_t maxRuns = 100;
+      // Branches after the first maxPathLen blocks of a run are not flipped.
+      uint32_t maxPathLen = 100;
+      // Stop once this percentage of both blocks and edges is covered.
+      uint32_t coverageTarget = 100;
+      // Stop after this many milliseconds (0 = no limit).
+      uint32_t budgetMs = 0;
+      // Blocks one concrete run may enter (0 = no limit).
+      uint64_t maxSteps = 100000;
+    };
+
+    struct ConcolicResult {
+      // One completed run per new coverage, in the order they were found,
+      // with the input it ran on as its model.
+      std::vector<EnumerateResult::Witness> witnesses;
+      std::size_t numBlocks = 0, numEdges = 0;
+      std::size_t coveredBlocks = 0, coveredEdges = 0;
+      std::vector<std::string> uncovered;
+      uint64_t runs = 0;   // concrete runs
+      uint64_t checks = 0; // solver calls, one per flipped branch
+      uint64_t sat = 0;    // of which SAT
+      // SAT flips whose run did not follow the prefix and flipped edge
+      // (the encoding and the interpreter disagree)
+      uint64_t divergent = 0;
+    };
+
+    /**
+     * Generational concolic search (SAGE). The function runs concretely in
+     * the Interpreter, first on a seed input (fixedSyms, otherwise random
+     * in-domain values from Config::seed), and the blocks it enters are
+     * recorded. Expanding a run encodes that block sequence on one
+     * incremental solver and, at each conditional branch past the run's
+     * bound, asks in its own scope for the prefix followed by another edge
+     * whose target or edge is not covered yet. Every SAT model is a new
+     * input: it runs at once, its bound is the flipped branch, and it is
+     * expanded in the order of the coverage its run added. A query's
+     * prefix is a path some input took, so only its last edge may be
+     * infeasible. Coverage counts completed runs (ret or unreachable), as
+     * in enumerate(). Functions with params or vector syms are rejected.
+     */
+    ConcolicResult concolic(
+        const std::string &funcName, const ConcolicOptions &opts,
+        const std::unordered_map<std::string, int64_t> &fixedSyms = {}
+    );
+
+    struct ModelsResult {
+      // Distinct models of the path, in the order the solver found them.
+      std::vector<Result> models;
+      // The path has no further models (all of them were found, or the
+      // path is UNSAT if there are none); false on a solver UNKNOWN or
+      // when the limit was reached first.
+      bool exhausted = false;
+    };
+
+    /**
+     * Finds up to `k` models of one path on a single incremental solver.
+     * After each model a blocking clause asks for different values of the
+     * syms in `projection` (of all syms if it is empty), so no two models
+     * agree on all of them.
+     */
+    ModelsResult enumerateModels(
+        const std::string &funcName, const std::vector<std::string> &path, uint32_t k,
+        const std::unordered_map<std::string, int64_t> &fixedSyms = {},
+        const std::vector<std::string> &projection = {}
+    );
+
+    /**
+     * A path of one function encoded step by step on a single incremental
+     * solver, for callers that write the function as they go (rysmith
+     * --incremental). Each step is checked together with everything
+     * committed before it and committed unless the answer is UNSAT, so an
+     * infeasible step can be replaced by another one. The executor must
+     * have been built with the function's final blocks, labels and lets
+     * (the CFG comes from them); block contents and syms may still grow.
+     * Pointer dispatch ignores Config::points_to, which would only have
+     * seen the blocks as they were then.
+     */
+    class PathSession {
+    public:
+      PathSession(SymbolicExecutor &ex, const std::string &funcName);
+      ~PathSession();
+
+      /**
+       * Runs the instructions of `block` (one of the function's) from
+       * `firstInstr` on next on the path. Syms the function declared since
+       * the last committed step are declared first, here and in take().
+       */
+      smt::Result run(const Block &block, std::size_t firstInstr);
+
+      /**
+       * Runs them, then leaves `block` by its terminator, towards `next`,
+       * or ends the path there if `next` is null.
+       */
+      smt::Result take(const Block &block, std::size_t firstInstr, const std::string *next);
+
+      uint64_t checks() const;
+
+    private:
+      struct State;
+      smt::Result
+      step(const Block &block, std::size_t firstInstr, bool terminator, const std::string *next);
+
+      SymbolicExecutor &ex_;
+      std::unique_ptr<State> state_;
+    };
+
   private:
     const Program &prog_;
     Config config_;
+    AnalysisManager ownAnalyses_; // when config_.analyses is null
     SolverFactory solverFactory_;
+    solver::TermBuilder::Counters termCounters_;
+
+    // solverFactory_ plus, if enabled, the TermBuilder decorator.
+    std::unique_ptr<smt::ISolver> makeSolver();
+
+    struct LazyFill;
+
+    // Config::narrow_syms: how the term of a scalar sym is built from the
+    // narrower const `key` of `bits` bits: as `values[min(key, k - 1)]`
+    // (k > 1) for a DomainSet, else as `offset` plus `key` zero- or (if
+    // `sign`) sign-extended. A set of one value is that value, its key.
+    struct NarrowSym {
+      smt::Term key;
+      uint32_t bits = 0;
+      bool sign = false;
+      int64_t offset = 0;
+      std::vector<int64_t> values;
+
+      // The sym's value for `raw`, the model value of `key` as modelValue()
+      // reads it (sign-extended from `bits`).
+      int64_t decode(int64_t raw) const;
+    };
 
     /**
      * Represents a symbolic value during execution.
@@ -82,14 +416,27 @@ namespace symir {
       // [v0.2.1] Vec: N-lane tuple (held in arrayVal, same shape as Array).
       // Distinguished from Array so the solver can apply lane-wise UB
       // semantics and the C-backend-compatible 0/1 mask representation.
-      enum class Kind { Int, Array, Struct, Undef, Vec } kind = Kind::Undef;
+      // SmtArray: array of scalars held as one Array(BV32, T) term (`term`)
+      // plus an Array(BV32, Bool) of per-element definedness (`is_defined`).
+      enum class Kind { Int, Array, Struct, Undef, Vec, SmtArray } kind = Kind::Undef;
       smt::Term term;       // For scalar Int (the BV value)
       smt::Term is_defined; // Boolean term: true if value is defined
       std::vector<SymbolicValue> arrayVal;
+      std::uint64_t arraySize = 0; // SmtArray and lazy Array: number of elements
       std::unordered_map<std::string, SymbolicValue> structVal;
 
+      // Lazy Array (arrayVal empty): the cells read or written by index so
+      // far; every other cell is `fill` at its index (see cellOf()).
+      std::map<std::uint64_t, SymbolicValue> cells;
+      std::shared_ptr<const LazyFill> fill;
+
+      bool lazy() const { return fill != nullptr; }
+
       smt::Term prov_base; // [v0.2.1] Pointer provenance base tag (BV64)
       smt::Term prov_size; // [v0.2.1] Pointer provenance size in tag-units (BV64)
+      // Config::narrow_syms: set on a scalar sym whose `term` is built from
+      // a narrower const; its model value is decoded from that const.
+      std::shared_ptr<const NarrowSym> narrow;
 
       SymbolicValue() = default;
 
@@ -106,7 +453,37 @@ namespace symir {
       SymbolicValue &operator=(SymbolicValue &&) = default;
     };
 
-    using SymbolicStore = std::unordered_map<std::string, SymbolicValue>;
+    // One access of an lvalue being written: a field, or an index as a
+    // BV32 term (`literal` with its value `k` for an integer literal).
+    struct WriteStep {
+      std::string field; // empty for an index
+      smt::Term idx;
+      bool literal = false;
+      std::uint64_t k = 0;
+    };
+
+    // Contents of the untouched cells of a lazy Array, shared by all copies
+    // of the value. Cell k of a
+    //  - Uniform fill is `value` (an undef or broadcast element);
+    //  - Named fill is createSymbolicValue(elem, name[k]), made once;
+    //  - Write fill is cell k of `prev` with `value` written at `rest`
+    //    below it where `cond` and `idx == k` (a write at a symbolic index);
+    //  - Mux fill is cell k of `prev` where `cond`, else that of `other`.
+    struct LazyFill {
+      enum class Kind { Uniform, Named, Write, Mux } kind = Kind::Uniform;
+      SymbolicValue value;
+      TypePtr elem;
+      std::string name;
+      smt::Term cond;
+      smt::Term idx; // BV32
+      std::vector<WriteStep> rest;
+      std::shared_ptr<const LazyFill> prev, other;
+      // Named: the cells made so far. Terms belong to the solver of the
+      // store holding the value, so this is only touched by its worker.
+      mutable std::unordered_map<std::uint64_t, SymbolicValue> made;
+    };
+
+    using SymbolicStore = std::unordered_map<Symbol, SymbolicValue>;
 
     // --- Symbolic evaluation helpers ---
     SymbolicValue
@@ -160,20 +537,36 @@ namespace symir {
         smt::Term cond, const SymbolicValue &t, const SymbolicValue &f, smt::ISolver &solver
     );
 
+    // Writes `val` at `steps` below `cur` where `pathCond` holds.
     SymbolicValue updateLValueRec(
-        const SymbolicValue &cur, std::span<const Access> accesses, const SymbolicValue &val,
-        smt::Term pathCond, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc,
-        int depth = 0
+        const SymbolicValue &cur, std::span<const WriteStep> steps, const SymbolicValue &val,
+        smt::Term pathCond, smt::ISolver &solver, std::vector<smt::Term> &pc, int depth = 0
     );
 
     smt::Term
     evalCond(const Cond &c, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc);
 
     smt::Sort getSort(const TypePtr &t, smt::ISolver &solver);
+    // SmtArray encoding: whether `at` is encoded as an SMT array, and the
+    // Array(BV32, elem) sort of its values.
+    bool useSmtArray(const ArrayType &at) const;
+    smt::Sort getSmtArraySort(const ArrayType &at, smt::ISolver &solver);
     SymbolicValue createSymbolicValue(
         const TypePtr &t, const std::string &name, smt::ISolver &solver, bool isSymbol = false
     );
 
+    // Lazy Array helpers. arrayLength() also covers dense, Vec and SmtArray
+    // values; cellOf() reads a cell of a dense or lazy Array or a Vec
+    // without materializing it; fillAt() is cell `k` of a fill, or one at a
+    // symbolic BV32 index (nullopt for a Named fill); densify() turns a lazy
+    // Array into a dense one.
+    static std::uint64_t arrayLength(const SymbolicValue &a);
+    SymbolicValue cellOf(const SymbolicValue &a, std::uint64_t k, smt::ISolver &solver);
+    SymbolicValue fillAt(const LazyFill &fill, std::uint64_t k, smt::ISolver &solver);
+    std::optional<SymbolicValue> fillAt(const LazyFill &fill, smt::Term idx, smt::ISolver &solver);
+    void densify(SymbolicValue &a, smt::ISolver &solver);
+    static SymbolicValue lazyArray(std::uint64_t size, std::shared_ptr<const LazyFill> fill);
+
     SymbolicValue makeUndef(const TypePtr &t, smt::ISolver &solver);
     SymbolicValue broadcast(const TypePtr &t, smt::Term val, smt::ISolver &solver);
     SymbolicValue evalInit(
@@ -187,14 +580,185 @@ namespace symir {
     TypePtr resolveAtomType(const Atom &a) const;
     TypePtr resolveSelectValType(const SelectVal &sv) const;
 
-    std::unordered_map<std::string, const StructDecl *> structs_;
+    std::unordered_map<Symbol, const StructDecl *> structs_;
+
+    // Size in pointer-tag units of a struct and the offset and type of each
+    // of its fields, computed once per executor.
+    struct StructLayout {
+      struct Field {
+        std::uint64_t offset;
+        TypePtr type;
+      };
+
+      std::uint64_t size = 0;
+      std::unordered_map<std::string, Field> fields;
+    };
+
+    std::unordered_map<Symbol, StructLayout> layouts_;
+
+    // Tag units of `t` (one per scalar leaf), from layouts_ for structs.
+    std::uint64_t tagUnits(const TypePtr &t) const;
+    // Largest tagUnits() of a pointee reachable through pointers in `t`.
+    std::uint64_t maxPointeeUnits(const TypePtr &t) const;
+
+    // Lookup tables for one function, built for every function when the
+    // executor is constructed and shared read-only by all workers.
+    struct FunctionContext {
+      const FunDecl *fun = nullptr;
+      const CFG *cfg = nullptr; // from the AnalysisManager; set when cfgOk
+      bool cfgOk = false;       // CFG::build reported no errors
+      const std::unordered_map<std::size_t, std::size_t> *nextToRet = nullptr; // when cfgOk
+      const BitVector *canReachRet = nullptr;                                   // when cfgOk
+
+      // Declared type and pointer tag of a let or param. A let shadows a
+      // param of the same name.
+      struct Local {
+        TypePtr type;
+        std::uint64_t tag;
+      };
+
+      std::unordered_map<std::string, Local> locals;
+      std::vector<std::uint64_t> letTags; // parallel to fun->lets
+      // Width of pointer terms: tags, provenance bases and sizes, and
+      // offsets through any pointee all fit as non-negative signed values.
+      uint32_t ptrBits = 64;
+
+      std::optional<PointsToAnalysis> pointsTo; // when cfgOk and enabled
+      std::vector<std::size_t> allLets;         // 0 .. fun->lets.size() - 1
+
+      // Lets a load or store at `site` may go through.
+      template<typename Site>
+      const std::vector<std::size_t> &candidateLets(const Site &site) const {
+        if (pointsTo)
+          if (auto t = pointsTo->targets(site); t && !t->any)
+            return t->lets;
+        return allLets;
+      }
+
+      // Config::merge_joins: the region of a conditional br whose arms meet
+      // again at its immediate post-dominator `join` without a cycle, a
+      // ret or more than kMaxBlocks blocks in between.
+      struct MergeRegion {
+        static constexpr std::size_t kMaxBlocks = 16;
+        std::size_t join;
+        std::vector<std::size_t> blocks; // between the br and `join`, in topological order
+      };
+
+      std::vector<std::optional<MergeRegion>> regions; // by block; when cfgOk and enabled
+
+      const SSAForm *ssa = nullptr; // when cfgOk and Config::ssa
+    };
+
+    // Config::merge_joins: the region between each conditional br and its
+    // immediate post-dominator (`ipdom`, as CFG::postDominators()), when
+    // that is small and acyclic.
+    static std::vector<std::optional<FunctionContext::MergeRegion>>
+    mergeRegions(const CFG &cfg, const std::vector<std::size_t> &ipdom);
+
+    std::unordered_map<std::string, FunctionContext> contexts_;
+
+    // Context of `funcName`; throws if there is no such function or its
+    // CFG is malformed.
+    const FunctionContext &contextOf(const std::string &funcName) const;
 
     // Pointer dispatch helpers (v0.2.0):
-    // Pointers are encoded as BV64 tags identifying their target local. The
-    // current FunDecl is held per-solve via thread_local storage to support
+    // Pointers are encoded as BV tags identifying their target local. The
+    // current function is held per-solve via thread_local storage to support
     // load/store dispatch over candidate targets, while keeping sample() safe
     // for concurrent workers.
     static thread_local const FunDecl *currentFun_;
+    static thread_local const FunctionContext *currentCtx_;
+    // Solver timeout of the check being made on this thread when it
+    // differs from Config::timeout_ms (timeout escalation), else 0.
+    static thread_local uint32_t attemptTimeoutMs_;
+    // The cancellation checks run through: Config::cancel, or the one of a
+    // multi-threaded sample() in progress, nested in it.
+    solver::Cancellation *cancel_ = nullptr;
+    bool cancelled() const { return cancel_ && cancel_->cancelled(); }
+
+    // Pointer width of the current function (kPtrBits outside of one).
+    static uint32_t ptrBits();
+    // Zero-extends a pointer term to kPtrBits, for arithmetic on it.
+    static smt::Term widenPtr(smt::Term t, smt::ISolver &solver);
+    // Truncates a kPtrBits address back to ptrBits(), requiring in `pc`
+    // that it is in the tag range.
+    static smt::Term narrowPtr(smt::Term t, smt::ISolver &solver, std::vector<smt::Term> &pc);
+
+    // Config::ssa: the SSA values encodePath() has defined so far on the
+    // path it is encoding on this thread, or null outside of one. The
+    // n-th definition of a value on the path (a block run again) gets a
+    // const of its own.
+    struct SsaPath {
+      const SSAForm *form;
+      std::vector<std::uint32_t> defined; // by SSA value
+    };
+
+    static thread_local SsaPath *ssaPath_;
+
+    // Config::lazy_fp: the scalar FP ops abstracted so far on the path
+    // solveFresh() is encoding on this thread, or null outside of one.
+    // `kind` is FP_ADD, FP_SUB, FP_MUL, FP_DIV, or FP_REM for SymIR's %
+    // (which is fmod, not IEEE remainder).
+    struct LazyFp {
+      struct Op {
+        smt::Kind kind;
+        smt::Term a, b, r;
+        bool refined = false;
+      };
+      std::vector<Op> ops;
+    };
+
+    static thread_local LazyFp *lazyFp_;
+
+    // Config::max_memory_mb: the budget of the query solveFresh() is
+    // encoding on this thread, or null outside of one.
+    struct MemoryBudget {
+      std::size_t limit;                          // bytes
+      bool smtArrays;                             // every array of scalars is an SMT Array
+      const solver::TermBuilder *terms = nullptr; // of the query, if it has one
+      std::size_t values = 0;                     // SymbolicValue nodes merged so far
+    };
+    // Thrown by chargeMemory() when the query is over its budget.
+    struct MemoryBudgetExceeded : std::runtime_error {
+      MemoryBudgetExceeded() : std::runtime_error("memory") {}
+    };
+
+    static thread_local MemoryBudget *memoryBudget_;
+
+    // Counts `values` more merged nodes against memoryBudget_, if any, and
+    // throws MemoryBudgetExceeded once the query is over it.
+    static void chargeMemory(std::size_t values = 0);
+
+    // Scalar FP `kind` (as in LazyFp::Op) of `a` and `b`, its result
+    // required finite in `pc`. Under lazyFp_ the result is a fresh const
+    // and `pc` only gets the facts about it that hold for any rounding.
+    static smt::Term fpArith(
+        smt::Kind kind, smt::Term a, smt::Term b, smt::ISolver &solver, std::vector<smt::Term> &pc
+    );
+    // The full encoding of an FP op.
+    static smt::Term fpDefinition(smt::Kind kind, smt::Term a, smt::Term b, smt::ISolver &solver);
+
+    // Binds `sv`, the contents of SSA value `value` on the current path,
+    // to a const by a definition appended to `pc` (unless its term is a
+    // literal or a const already).
+    void defineSsaValue(
+        std::size_t value, SymbolicValue &sv, smt::ISolver &solver, std::vector<smt::Term> &pc
+    );
+
+    // Let or param `name` of the current function, or null.
+    static const FunctionContext::Local *currentLocal(const std::string &name);
+
+    // Makes `ctx` the current function for its lifetime; restores the
+    // previous one on exit, so nested calls see their own.
+    class FunScope {
+    public:
+      explicit FunScope(const FunctionContext &ctx);
+      ~FunScope();
+
+    private:
+      const FunDecl *prevFun_;
+      const FunctionContext *prevCtx_;
+    };
 
     // [v0.2.1] Provenance tracking for pointer locals (rule 14, 19).
     // Maps a `ptr T` local name to its provenance base tag and the
@@ -212,7 +776,340 @@ namespace symir {
       std::uint64_t size;
     };
 
-    std::unordered_map<std::string, PtrProvenance> ptrProv_;
+    std::unordered_map<Symbol, PtrProvenance> ptrProv_;
+
+    // --- Path encoding (shared by solve() and the incremental sampler) ---
+    // Declares the function's syms, params and lets in `store`. Domain and
+    // fixed-value constraints on syms are appended to `pathConstraints`, as
+    // are the narrowed ranges `symRanges` (if any) of scalar syms.
+    void encodeEntry(
+        const FunDecl &fun, smt::ISolver &solver, SymbolicStore &store,
+        std::vector<smt::Term> &pathConstraints,
+        const std::unordered_map<std::string, int64_t> &fixedSyms,
+        const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges = nullptr
+    );
+    // Declares sym `s` in `store`, appending its domain, `range` and
+    // fixed-value constraints to `pathConstraints`.
+    void declareSym(
+        const SymDecl &s, smt::ISolver &solver, SymbolicStore &store,
+        std::vector<smt::Term> &pathConstraints,
+        const std::unordered_map<std::string, int64_t> &fixedSyms,
+        const IntervalAnalysis::Interval *range = nullptr
+    );
+    // Config::narrow_syms: re-encodes the fresh scalar sym `sv` on fewer
+    // bits if its domain and `range` allow, appending what the encoding
+    // does not imply to `pathConstraints`. False if `sv` is left as is.
+    bool narrowSym(
+        const SymDecl &s, const IntervalAnalysis::Interval *range, smt::ISolver &solver,
+        SymbolicValue &sv, std::vector<smt::Term> &pathConstraints
+    );
+
+    // Symbolically executes `block` and, if `nextLabel` is given, constrains
+    // its terminator to take the edge to that successor. PathSession runs
+    // a block piecewise: its instructions from `firstInstr` on, and the
+    // terminator only if `terminator`.
+    void encodeBlock(
+        const Block &block, const std::string &label, const std::string *nextLabel,
+        smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pathConstraints,
+        std::vector<smt::Term> &requirements, std::size_t firstInstr = 0, bool terminator = true
+    );
+
+    // Config::merge_joins: if path[i] starts a merge region that the path
+    // leaves through its join along CFG edges, the join's index on the path.
+    std::optional<std::size_t>
+    mergeEnd(const FunctionContext &ctx, const std::vector<std::string> &path, std::size_t i) const;
+    // The path without the blocks inside merged regions: paths with the
+    // same key make the same query.
+    std::string mergeKey(const FunctionContext &ctx, const std::vector<std::string> &path) const;
+    // Encodes the region of block `br`, already encoded up to its branch
+    // condition `cond`, and leaves the store merged at the join in `store`.
+    // Returns false, changing nothing, if the arms disagree on pointer
+    // provenance or their stores cannot be merged.
+    bool encodeRegion(
+        const FunctionContext::MergeRegion &region, std::size_t br, smt::Term cond,
+        smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pathConstraints,
+        std::vector<smt::Term> &requirements
+    );
+    static bool sameValue(const SymbolicValue &a, const SymbolicValue &b);
+
+    Result extractModel(
+        const FunDecl &fun, smt::ISolver &solver, const SymbolicStore &store, smt::Result res
+    );
+    Result::ModelVal modelValue(smt::ISolver &solver, const smt::Term &term);
+
+    // One model value of a sym: a scalar sym or one lane of a vector sym.
+    // Its value is read from `key`, `term` itself unless the sym is narrowed.
+    struct SymSlot {
+      static constexpr std::size_t kScalar = SIZE_MAX;
+      const Symbol *name;
+      std::size_t lane;
+      smt::Term term;
+      smt::Term key;
+      const NarrowSym *narrow = nullptr;
+    };
+
+    std::vector<SymSlot> symSlots(const FunDecl &fun, const SymbolicStore &store) const;
+    Result::ModelVal slotValue(smt::ISolver &solver, const SymSlot &slot);
+    static Result withVerdict(Result res, smt::Result r);
+
+    // Config::stats bookkeeping of the query being encoded on one solver.
+    // Encoding is timed from startQuery() or the previous check.
+    struct QueryProbe {
+      std::chrono::steady_clock::time_point start;
+      uint64_t terms = 0; // TermBuilder requests at `start`
+      uint32_t pathLen = 0;
+      uint64_t guardsDropped = 0; // by the GuardSet of the query
+    };
+
+    QueryProbe startQuery(smt::ISolver &solver) const;
+
+    // Runs `check` as one query over `constraints` and records it in
+    // Config::stats (if any); the probe then starts the next query.
+    smt::Result countedCheck(
+        QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+        const std::function<smt::Result()> &check
+    );
+    void recordQuery(
+        QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+        smt::Result r, double solveMs, bool cached
+    );
+
+    // Records the public call it lives in with Config::stats; calls made
+    // from within another one (sample() solving a path) are not separate.
+    class StatsScope {
+    public:
+      StatsScope(SymbolicExecutor &ex, const char *kind, const std::string &function);
+      ~StatsScope();
+
+    private:
+      SymbolicExecutor &ex_;
+      uint64_t id_ = 0;
+      std::chrono::steady_clock::time_point start_;
+    };
+
+    std::atomic<uint64_t> statsCall_{0}; // id of the current call, 0 if none
+
+    // Config::model_pool: the first recent model that `path` accepts when
+    // run concretely, with `fixedSyms` taking precedence.
+    std::optional<Result> replayModels(
+        const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms
+    );
+    // Adds the model of a SAT `res` to Config::model_pool.
+    void rememberModel(const FunctionContext &ctx, const Result &res);
+    // Config::intervals: the interval pre-pass over `path` (nothing refuted
+    // or narrowed when disabled). Refuted paths are recorded in
+    // Config::stats as queries answered without the backend.
+    IntervalAnalysis::PathResult pathIntervals(
+        const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms
+    );
+    // The distinct constraints of one query (Config::dedup_guards). Every
+    // load, store and arithmetic step pushes its own UB guards, so a loop
+    // unrolled many times over the same pointer repeats them; with the
+    // TermBuilder equal guards are the same term. add() splits
+    // conjunctions and drops a constraint that is literally true, was added
+    // before or is implied by what was (an OR with a known disjunct, an
+    // IMPLIES with a known consequent, an AND of such).
+    class GuardSet {
+    public:
+      explicit GuardSet(smt::ISolver &solver);
+
+      void add(smt::Term t);
+      std::vector<smt::Term> take() { return std::move(kept_); }
+      uint64_t dropped() const { return dropped_; }
+
+    private:
+      bool implied(smt::Term t, int depth) const;
+
+      smt::ISolver &solver_;
+      const solver::TermBuilder *tb_; // term structure, if the solver is one
+      std::unordered_set<uint32_t> known_;
+      std::vector<smt::Term> kept_;
+      uint64_t dropped_ = 0;
+    };
+
+    // Encodes `path` from the entry of ctx's function into `store` and
+    // returns its constraints: the path condition, then the requirements.
+    // `symRanges` are narrowed sym ranges to assert along with the path.
+    // With Config::dedup_guards the constraints are distinct, and the number
+    // dropped is added to `guardsDropped` if given.
+    std::vector<smt::Term> encodePath(
+        const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms,
+        const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges,
+        smt::ISolver &solver, SymbolicStore &store, uint64_t *guardsDropped = nullptr
+    );
+    // solve() once the pre-pass and replay have not answered; `symRanges`
+    // are narrowed sym ranges to assert along with the path. Within
+    // Config::max_memory_mb, trying the SMT Array encoding once if needed.
+    Result solveFresh(
+        const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms,
+        const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges = nullptr
+    );
+    // One attempt of solveFresh(), on a solver of its own.
+    Result solveFreshOnce(
+        const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms,
+        const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges
+    );
+    // Checks `constraints` with the ops of `lazy` abstracted, refining the
+    // ops each SAT model gets wrong (Config::lazy_fp).
+    smt::Result checkLazyFp(
+        QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+        LazyFp &lazy
+    );
+
+    // Runs `check` (which asserts/assumes `constraints` and checks them)
+    // and reads `slots` into `res` if SAT, going through
+    // Config::query_cache when there is one.
+    smt::Result checkQuery(
+        QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+        std::span<const SymSlot> slots, Result &res, const std::function<smt::Result()> &check
+    );
+
+    // Constraint independence slicing (Config::slicing): partitions
+    // `constraints` by the consts they (transitively) mention, checks the
+    // partitions one by one, smallest first, and merges their models.
+    // Returns nullopt when the constraints do not split.
+    std::optional<Result> solveSliced(
+        QueryProbe &probe, const FunDecl &fun, solver::TermBuilder &tb, const SymbolicStore &store,
+        const std::vector<smt::Term> &constraints
+    );
+
+    // Symbolic state after a path prefix. The node for path[0..j] (j >= 1)
+    // snapshots the store/provenance right after block path[j-1] took its
+    // edge to path[j] and records the constraints that block and edge
+    // added; the constraints of the whole prefix are those of its
+    // ancestors. The root holds the entry declarations.
+    struct PrefixNode {
+      std::string label;
+      SymbolicStore store;
+      std::unordered_map<Symbol, PtrProvenance> ptrProv;
+      std::vector<smt::Term> pathConstraints;
+      std::vector<smt::Term> requirements;
+
+      // Trie links, maintained by PrefixCache. Nodes still referenced by a
+      // session stay usable after being evicted (parent is then null).
+      PrefixNode *parent = nullptr;
+      std::unordered_map<std::string, std::shared_ptr<PrefixNode>> children;
+      std::list<PrefixNode *>::iterator lruPos;
+      bool cached = false;
+      std::size_t bytes = 0;
+    };
+
+    // Prefix trie of PrefixNodes with LRU eviction once the estimated size
+    // of the cached snapshots exceeds `capBytes`. Terms in the snapshots
+    // belong to one solver, so each worker owns its own cache.
+    class PrefixCache {
+    public:
+      explicit PrefixCache(std::size_t capBytes) : capBytes_(capBytes) {}
+
+      std::shared_ptr<PrefixNode> find(PrefixNode &parent, const std::string &label);
+      void insert(PrefixNode &parent, const std::shared_ptr<PrefixNode> &child);
+
+      std::size_t bytes() const { return bytes_; }
+
+    private:
+      void evict(PrefixNode &node);
+
+      std::size_t capBytes_;
+      std::size_t bytes_ = 0;
+      std::list<PrefixNode *> lru_; // most recently used first
+    };
+
+    // Per-worker solver state used by sample() with --incremental and/or a
+    // prefix cache. `frames` is the node chain of the previous path; in
+    // incremental mode frames[j] (j >= 1) also owns solver scope j, so a
+    // new path only pops the frames past its common prefix.
+    struct SampleSession {
+      std::unique_ptr<smt::ISolver> solver;
+      std::shared_ptr<PrefixNode> root;
+      std::vector<std::shared_ptr<PrefixNode>> frames;
+      std::optional<PrefixCache> cache;
+    };
+
+    // What a pool worker keeps between multi-threaded sample() calls: its
+    // RNG (reseeded per call) and, when sessions are used, its session for
+    // the function and fixed syms it last sampled. Single-threaded calls
+    // keep nothing, since some backends (AliveSMT) cannot have a solver
+    // outlive the call next to the fresh ones solve() creates.
+    struct WorkerState {
+      std::mt19937 rng;
+      std::optional<SampleSession> session;
+      const FunDecl *sessionFun = nullptr;
+      std::unordered_map<std::string, int64_t> sessionFixed;
+    };
+
+    // Pool for multi-threaded sample() and one WorkerState per pool worker,
+    // created on first use.
+    solver::WorkPool &pool();
+    std::mutex poolMu_;
+    std::unique_ptr<solver::WorkPool> ownPool_;
+    std::vector<std::unique_ptr<WorkerState>> workerStates_;
+
+    // Like solve(), but reuses the solver, scopes and cached prefixes of
+    // `session`. The last block is checked under assumptions so it never
+    // needs a pop.
+    Result solveInSession(
+        SampleSession &session, const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms
+    );
+
+    // One online sample (Config::online_sampling): a random walk from
+    // `prefixPath` that checks, under assumptions, the edge it is about to
+    // take at every block with several successors and falls back to another
+    // successor when that edge is UNSAT. Returns nullopt if the walk is
+    // discarded (length cap hit without a terminator).
+    std::optional<Result> walkOnline(
+        const FunctionContext &ctx, std::mt19937 &rng, const std::vector<std::string> &prefixPath,
+        uint32_t maxPathLen, bool requireTerminal,
+        const std::unordered_map<std::string, int64_t> &fixedSyms
+    );
+
+    // Path prefixes sample() has proven infeasible (Config::learn_nogoods),
+    // shared by all workers. Node for path[0..j] is dead once every path
+    // starting with that prefix is known to be UNSAT; the root stands for
+    // the empty prefix. Nodes are never removed, so pointers stay valid.
+    class NogoodTrie {
+    public:
+      struct Node {
+        std::atomic<bool> dead{false};
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+      };
+
+      const Node *root() const { return &root_; }
+
+      // Child of `n` for `label`, or null if nothing was learned below it.
+      const Node *child(const Node *n, const std::string &label) const;
+      static bool dead(const Node *n) { return n && n->dead.load(); }
+
+      void learn(std::span<const std::string> prefix);
+
+    private:
+      mutable std::mutex mu_;
+      Node root_;
+    };
+
+    // sample() with timeout escalation (Config::time_budget_ms) on
+    // `numThreads` threads: `draw` walks and solves a fresh path (reporting
+    // the path in its second argument, unless the walk is online) and
+    // `retry` solves a path again.
+    using SampleDraw =
+        std::function<std::optional<Result>(std::mt19937 &, std::vector<std::string> *)>;
+    using SampleRetry = std::function<Result(const std::vector<std::string> &)>;
+    Result sampleEscalating(
+        uint32_t n, uint32_t numThreads, const SampleDraw &draw, const SampleRetry &retry
+    );
+
+    // Like solve(), but checks the blocks of `path` as one assumption each
+    // and, when UNSAT, learns the prefix ending right after the deepest
+    // block of the UNSAT core into `nogoods`.
+    Result solveLearning(
+        const FunctionContext &ctx, const std::vector<std::string> &path,
+        const std::unordered_map<std::string, int64_t> &fixedSyms, NogoodTrie &nogoods
+    );
   };
 
 } // namespace symir
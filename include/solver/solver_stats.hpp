@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "solver/smt.hpp"
+
+namespace symir::solver {
+
+  /**
+   * Per-query solver statistics, shared by threads.
+   *
+   * SymbolicExecutor records one Query per solver check: how long the path
+   * was, how much encoding it took and how long the backend ran. Queries
+   * are summed up per executor call (solve(), sample(), enumerate()) and
+   * per thread. The first `maxQueries` queries are also kept one by one.
+   *
+   * Term counts and DAG sizes come from the TermBuilder and are 0 when it
+   * is disabled. Queries answered by model replay or refuted by the
+   * interval pre-pass are recorded as well, with no terms and no solve
+   * time.
+   */
+  class SolverStats {
+  public:
+    struct Query {
+      uint64_t call = 0;       // id from beginCall()
+      uint32_t pathLen = 0;    // blocks encoded so far
+      uint64_t terms = 0;      // terms requested while encoding the query
+      uint64_t assertions = 0; // top-level constraints of the query
+      uint64_t dagSize = 0;    // distinct terms they are built from
+      double encodeMs = 0;     // since the previous check on the solver
+      double solveMs = 0;
+      smt::Result result = smt::Result::UNKNOWN;
+      bool cached = false;   // answered by the query cache
+      bool replayed = false; // answered by replaying a known model
+      bool refuted = false;  // found UNSAT by the interval pre-pass
+      uint64_t guardsDropped = 0; // duplicate or implied constraints not asserted
+    };
+
+    struct Totals {
+      uint64_t queries = 0, sat = 0, unsat = 0, unknown = 0, cached = 0;
+      uint64_t terms = 0, assertions = 0, dagSize = 0, maxDagSize = 0;
+      uint32_t maxPathLen = 0;
+      double encodeMs = 0, solveMs = 0;
+      uint64_t replayed = 0, replayTries = 0; // queries answered / models run
+      double replayMs = 0;
+      uint64_t refuted = 0;
+      uint64_t guardsDropped = 0;
+
+      void add(const Query &q);
+    };
+
+    explicit SolverStats(std::size_t maxQueries = 100000) : maxQueries_(maxQueries) {}
+
+    SolverStats(const SolverStats &) = delete;
+    SolverStats &operator=(const SolverStats &) = delete;
+
+    // Starts one executor call; its queries report the returned id (> 0).
+    uint64_t beginCall(std::string kind, std::string function, std::string label);
+    void endCall(uint64_t id, double wallMs);
+
+    void record(const Query &q);
+
+    // Models replayed before a query (see solver/model_pool.hpp), whether
+    // or not one of them answered it.
+    void recordReplay(uint64_t call, uint32_t tries, double ms);
+
+    Totals total() const;
+
+    // The whole report as one JSON object.
+    void writeJson(std::ostream &os) const;
+
+  private:
+    struct Call {
+      std::string kind, function, label;
+      double wallMs = 0;
+      Totals totals;
+    };
+
+    std::size_t maxQueries_;
+    mutable std::mutex mu_;
+    std::vector<Call> calls_; // call id - 1
+    std::unordered_map<std::thread::id, std::size_t> threadIndex_;
+    std::vector<Totals> threads_;
+    std::vector<std::pair<std::size_t, Query>> queries_; // (thread, query)
+    uint64_t dropped_ = 0;
+    Totals total_;
+  };
+
+} // namespace symir::solver
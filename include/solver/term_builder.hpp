@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "solver/smt.hpp"
+
+namespace symir::solver {
+
+  /**
+   * Caching ISolver decorator placed in front of a backend.
+   *
+   * - Hash-conses terms: structurally identical make_term/value requests
+   *   return the very same handle, so the encoded DAG has no duplicates.
+   * - Folds BV/Bool operations whose operands are all literals (BV widths
+   *   up to 64 bits), with the SMT-LIB semantics of the backends (e.g.
+   *   `bvudiv x 0 = ~0`), and simplifies trivial ITE/AND/OR/IMPLIES/NOT.
+   * - Canonicalizes BV/FP/Bool/array sorts so sort-keyed caches hit as well.
+   * - Resolves `select` through `store`s at literal indices and constant
+   *   arrays, so literal-indexed array reads never reach the backend.
+   *
+   * make_const() is never hash-consed: two consts with the same name are
+   * distinct terms for some backends.
+   */
+  class TermBuilder : public smt::ISolver {
+  public:
+    struct Stats {
+      uint64_t hits = 0;  // requests answered from the hash-cons table
+      uint64_t folds = 0; // requests answered by constant folding/simplification
+      uint64_t built = 0; // terms that reached the backend
+    };
+
+    // Shared sink accumulating the Stats of many builders (e.g. one per
+    // sampled path). Builders flush into it on destruction.
+    struct Counters {
+      std::atomic<uint64_t> hits{0};
+      std::atomic<uint64_t> folds{0};
+      std::atomic<uint64_t> built{0};
+
+      Stats load() const { return {hits.load(), folds.load(), built.load()}; }
+    };
+
+    explicit TermBuilder(std::unique_ptr<smt::ISolver> inner, Counters *sink = nullptr);
+    ~TermBuilder() override;
+
+    const Stats &stats() const { return stats_; }
+
+    // Term structure, e.g. for splitting constraints into independent
+    // groups. operands() lists the arguments of a term this builder sent
+    // to the backend (make_term, or the value of a make_const_array); it is
+    // empty for consts, literals and other leaves.
+    std::span<const smt::Term> operands(smt::Term t) const;
+    // Operator of a term this builder sent to the backend with make_term;
+    // nullopt for all other terms.
+    std::optional<smt::Kind> kind(smt::Term t) const;
+    bool isConst(smt::Term t) const { return consts_.count(t.id) != 0; }
+
+    // Canonical text of the set of formulas `roots`, the same for any two
+    // structurally identical sets no matter what the consts are called:
+    // consts are written as their sort, and appended to `consts` in order of
+    // first appearance. Fails if some term was not built by this builder.
+    bool fingerprint(
+        std::span<const smt::Term> roots, std::string &out, std::vector<smt::Term> &consts
+    ) const;
+
+    smt::Sort make_bv_sort(uint32_t size) override;
+    smt::Sort make_fp_sort(uint32_t exp, uint32_t sig) override;
+    smt::Sort make_bool_sort() override;
+    smt::Sort make_array_sort(smt::Sort index, smt::Sort elem) override;
+
+    bool is_bv_sort(smt::Sort s) override;
+    bool is_fp_sort(smt::Sort s) override;
+    bool is_bool_sort(smt::Sort s) override;
+    bool is_array_sort(smt::Sort s) override;
+    uint32_t get_bv_width(smt::Sort s) override;
+    std::pair<uint32_t, uint32_t> get_fp_dims(smt::Sort s) override;
+
+    smt::Term make_true() override;
+    smt::Term make_false() override;
+    smt::Term make_bv_value(smt::Sort s, const std::string &val, uint8_t base) override;
+    smt::Term make_bv_value_uint64(smt::Sort s, uint64_t val) override;
+    smt::Term make_bv_value_int64(smt::Sort s, int64_t val) override;
+    smt::Term make_bv_zero(smt::Sort s) override;
+    smt::Term make_bv_one(smt::Sort s) override;
+    smt::Term make_bv_min_signed(smt::Sort s) override;
+    smt::Term make_bv_max_signed(smt::Sort s) override;
+
+    smt::Term make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) override;
+    smt::Term make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) override;
+    smt::Term make_rm_value(smt::RoundingMode rm) override;
+    smt::Term make_const_array(smt::Sort s, smt::Term val) override;
+
+    smt::Term make_const(smt::Sort s, const std::string &name) override;
+
+    using smt::ISolver::make_term;
+    smt::Term make_term(
+        smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+    ) override;
+
+    smt::Sort get_sort(smt::Term t) override;
+    bool is_true(smt::Term t) override;
+    bool is_false(smt::Term t) override;
+
+    void assert_formula(smt::Term t) override;
+    smt::Result check_sat() override;
+
+    void push(uint32_t levels) override;
+    void pop(uint32_t levels) override;
+    smt::Result check_sat_assuming(const std::vector<smt::Term> &assumptions) override;
+    std::vector<smt::Term> get_unsat_assumptions() override;
+    void interrupt() override;
+
+    smt::Term get_value(smt::Term t) override;
+    std::string get_bv_value_string(smt::Term t, uint8_t base) override;
+    std::string get_fp_value_string(smt::Term t) override;
+
+  private:
+    enum class SortKind { Bool, BV, FP, Array, Other };
+
+    struct SortInfo {
+      SortKind kind = SortKind::Other;
+      uint32_t width = 0; // BV width
+      uint32_t exp = 0;   // FP exponent width
+      uint32_t sig = 0;   // FP significand width (incl. hidden bit)
+      uint32_t index = 0; // Array index sort id
+      uint32_t elem = 0;  // Array element sort id
+    };
+
+    // Literal value of a Bool or <= 64-bit BV term (Bool: width 0).
+    struct Literal {
+      uint32_t width = 0;
+      uint64_t value = 0;
+    };
+
+    struct NodeKey {
+      smt::Kind kind;
+      std::vector<smt::Term> args;
+      std::vector<uint32_t> indices;
+    };
+
+    // Non-owning view of a make_term request, so lookups need no copies.
+    struct NodeRef {
+      smt::Kind kind;
+      std::span<const smt::Term> args;
+      std::span<const uint32_t> indices;
+    };
+
+    struct NodeKeyHash {
+      using is_transparent = void;
+      std::size_t operator()(const NodeKey &k) const;
+      std::size_t operator()(const NodeRef &k) const;
+    };
+
+    struct NodeKeyEq {
+      using is_transparent = void;
+      bool operator()(const NodeKey &a, const NodeKey &b) const;
+      bool operator()(const NodeRef &a, const NodeKey &b) const;
+      bool operator()(const NodeKey &a, const NodeRef &b) const { return (*this)(b, a); }
+    };
+
+    // A store(base, index, value) node, or a constant array (empty base).
+    struct ArrayNode {
+      smt::Term base;
+      smt::Term index;
+      smt::Term value;
+    };
+
+    smt::Sort canonical(smt::Sort s);
+    bool sortText(smt::Sort s, std::string &out) const;
+    smt::Term remember(const std::string &key, smt::Term t); // into values_
+    const SortInfo *infoOf(const smt::Sort &s) const;
+    const Literal *literalOf(const smt::Term &t) const;
+
+    uint32_t widthOf(const smt::Term &t);
+
+    smt::Term boolLit(bool b);
+    smt::Term bvLit(uint32_t width, uint64_t value);
+
+    // Returns an empty Term when nothing could be simplified.
+    smt::Term
+    fold(smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices);
+    smt::Term foldLogic(smt::Kind k, std::span<const smt::Term> args);
+    smt::Term foldIdentity(smt::Kind k, std::span<const smt::Term> args);
+    smt::Term foldSelect(std::span<const smt::Term> args);
+    static bool foldLiterals(
+        smt::Kind k, const std::vector<Literal> &lits, std::span<const uint32_t> indices,
+        Literal &out
+    );
+
+    std::unique_ptr<smt::ISolver> inner_;
+    Counters *sink_;
+    Stats stats_;
+
+    smt::Term true_, false_;
+    std::unordered_map<uint32_t, smt::Sort> bvSorts_;
+    std::unordered_map<uint64_t, smt::Sort> fpSorts_;
+    smt::Sort boolSort_;
+    std::map<std::pair<uint32_t, uint32_t>, smt::Sort> arraySorts_;
+    std::unordered_map<uint32_t, SortInfo> sortInfo_;
+
+    std::unordered_map<std::string, smt::Term> values_; // literal & rm requests
+    std::unordered_map<NodeKey, smt::Term, NodeKeyHash, NodeKeyEq> nodes_;
+    std::unordered_map<uint32_t, Literal> literals_;
+    std::unordered_map<uint32_t, smt::Term> negation_; // NOT(x) <-> x
+    std::unordered_map<uint32_t, ArrayNode> arrayNodes_;
+    std::map<std::pair<uint32_t, uint32_t>, smt::Term> constArrays_;
+    std::unordered_map<uint32_t, smt::Sort> termSorts_; // cached get_sort() answers
+    std::unordered_map<uint32_t, const NodeKey *> nodeOf_; // built term -> its key in nodes_
+    std::unordered_set<uint32_t> consts_;
+    std::unordered_map<uint32_t, const std::string *> valueKey_; // value term -> key in values_
+    std::optional<smt::Term> falseAssumption_; // refuted the last check_sat_assuming on its own
+  };
+
+} // namespace symir::solver
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace symir::solver {
+
+  /**
+   * Fixed set of worker threads that outlive individual solve()/sample()
+   * calls, with one task deque per worker.
+   *
+   * Tasks submitted by a worker go to the front of its own deque and are
+   * taken from there (LIFO); tasks submitted from outside are dealt round
+   * robin. An idle worker steals from the back of the other deques. Every
+   * task belongs to a Group, which wait() blocks on; a worker that waits
+   * runs pending tasks in the meantime, so groups may nest.
+   *
+   * Tasks receive the index of the worker running them, so callers can keep
+   * per-worker state (solvers, RNGs) in a vector of size() entries.
+   */
+  class WorkPool {
+  public:
+    using Task = std::function<void(unsigned worker)>;
+
+    class Group {
+    public:
+      Group() = default;
+      Group(const Group &) = delete;
+      Group &operator=(const Group &) = delete;
+
+    private:
+      friend class WorkPool;
+      std::mutex mu_;
+      std::condition_variable cv_;
+      std::size_t pending_ = 0;
+      std::exception_ptr error_; // first exception thrown by a task
+    };
+
+    // 0 workers means std::thread::hardware_concurrency().
+    explicit WorkPool(unsigned numWorkers = 0);
+    ~WorkPool();
+
+    WorkPool(const WorkPool &) = delete;
+    WorkPool &operator=(const WorkPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Index of the calling thread if it is one of this pool's workers.
+    std::optional<unsigned> currentWorker() const;
+
+    void submit(Group &group, Task task);
+
+    // Blocks until every task of `group` has run, then rethrows the first
+    // exception one of them threw.
+    void wait(Group &group);
+
+    // Runs fn(worker, i) for every i in [0, n) and waits for all of them.
+    template<typename F>
+    void forEach(std::size_t n, F &&fn) {
+      Group group;
+      for (std::size_t i = 0; i < n; ++i)
+        submit(group, [&fn, i](unsigned worker) { fn(worker, i); });
+      wait(group);
+    }
+
+  private:
+    struct Queued {
+      Task task;
+      Group *group;
+    };
+
+    struct Worker {
+      std::mutex mu;
+      std::deque<Queued> tasks;
+      std::thread thread;
+    };
+
+    void loop(unsigned self);
+    // Pops a task of worker `self` or steals one; false if there is none.
+    bool takeTask(unsigned self, Queued &out);
+    void run(unsigned self, Queued &q);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<unsigned> nextQueue_{0};
+    std::atomic<int64_t> queued_{0}; // tasks in all deques
+    std::mutex sleepMu_;
+    std::condition_variable sleepCv_;
+    bool stop_ = false;
+  };
+
+} // namespace symir::solver
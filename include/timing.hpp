@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace symir::timing {
+
+  /**
+   * Process-wide registry of phase timings behind `--time-passes` and
+   * `--time-trace`.
+   *
+   * A Scope times the code it encloses under a path made of the names of
+   * the Scopes open around it on the same thread (`check/TypeChecker`);
+   * tasks handed to other threads carry their submitter's path along
+   * (Inherit). The registry sums the time and the number of calls per
+   * path, and also keeps every Scope as an event for the Chrome trace.
+   * Counters add up numbers that are not times (tokens, queries).
+   *
+   * Recording is off until enable() is called; until then a Scope costs
+   * one relaxed atomic load.
+   */
+
+  namespace detail {
+    inline std::atomic<bool> on{false};
+    void begin(const char *name);
+    void end(std::chrono::steady_clock::time_point start);
+  } // namespace detail
+
+  /// Starts recording; the clock of the trace starts here.
+  void enable();
+
+  inline bool enabled() { return detail::on.load(std::memory_order_relaxed); }
+
+  class Scope {
+  public:
+    explicit Scope(const char *name) {
+      if (enabled()) {
+        active_ = true;
+        detail::begin(name);
+        start_ = std::chrono::steady_clock::now();
+      }
+    }
+
+    ~Scope() {
+      if (active_)
+        detail::end(start_);
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    bool active_ = false;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  /// The path of the innermost Scope open on this thread ("" if none, or
+  /// when recording is off).
+  std::string currentPath();
+
+  /// Makes Scopes opened on this thread, while it lives, nest below `path`
+  /// (from currentPath() on the thread that handed the work over).
+  class Inherit {
+  public:
+    explicit Inherit(const std::string &path);
+    ~Inherit();
+
+    Inherit(const Inherit &) = delete;
+    Inherit &operator=(const Inherit &) = delete;
+
+  private:
+    bool active_ = false;
+  };
+
+  /// Adds `ns` nanoseconds over `calls` calls below the innermost open
+  /// Scope, as a child named `name`: for work too fine-grained for a Scope
+  /// of its own, such as lexing one token.
+  void addTime(const char *name, std::uint64_t ns, std::uint64_t calls);
+
+  /// Adds `n` to the counter `name`.
+  void count(const char *name, std::uint64_t n = 1);
+
+  /// The time and calls summed per path, as report() prints them.
+  struct Total {
+    std::uint64_t ns = 0;
+    std::uint64_t calls = 0;
+  };
+  std::map<std::string, Total> totals();
+
+  /// The counters, as report() prints them.
+  std::map<std::string, std::uint64_t> counters();
+
+  /// Peak resident set size of the process, in KiB.
+  std::uint64_t peakRssKiB();
+
+  /// The time per path, indented by nesting, with the counters and the
+  /// peak RSS. Times of work done on several threads are summed.
+  void report(std::ostream &out);
+
+  /// Every Scope as a Chrome trace event ("X"), for chrome://tracing or
+  /// Perfetto, with the counters and the peak RSS as metadata.
+  void writeChromeTrace(std::ostream &out);
+
+  /**
+   * `--time-passes` and `--time-trace <file>` of a tool: declared at the
+   * top of main(), it enables recording if either was given and, however
+   * main() returns, prints the report to stderr and writes the trace.
+   */
+  class Session {
+  public:
+    Session(bool report, std::string tracePath);
+    ~Session();
+
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+  private:
+    bool report_;
+    std::string tracePath_;
+  };
+
+} // namespace symir::timing
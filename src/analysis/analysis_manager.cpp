@@ -0,0 +1,247 @@
+#include "analysis/analysis_manager.hpp"
+#include <queue>
+#include "timing.hpp"
+
+namespace symir {
+
+  AnalysisManager::Entry &
+  AnalysisManager::entry(const FunDecl &f, std::unique_lock<std::mutex> &lock) {
+    Entry *e;
+    {
+      std::lock_guard<std::mutex> g(mu_);
+      auto &slot = entries_[&f];
+      if (!slot)
+        slot = std::make_unique<Entry>();
+      e = slot.get();
+    }
+    lock = std::unique_lock<std::mutex>(e->mu);
+    if (!e->built) {
+      timing::Scope scope("cfg");
+      DiagBag diags;
+      e->cfg = CFG::build(f, diags);
+      e->diags = std::move(diags.diags);
+      e->built = true;
+    }
+    return *e;
+  }
+
+  void AnalysisManager::adopt(const FunDecl &f, CFG cfg) {
+    Entry *e;
+    {
+      std::lock_guard<std::mutex> g(mu_);
+      auto &slot = entries_[&f];
+      if (!slot)
+        slot = std::make_unique<Entry>();
+      e = slot.get();
+    }
+    std::lock_guard<std::mutex> lock(e->mu);
+    if (!e->built) {
+      e->cfg = std::move(cfg);
+      e->built = true;
+    }
+  }
+
+  std::optional<AnalysisManager::Shape> AnalysisManager::shape(const FunDecl &f) {
+    if (!validCfg(f))
+      return std::nullopt;
+    Shape s;
+    s.rpo = rpo(f);
+    s.dominators = dominators(f);
+    s.postDominators = postDominators(f);
+    s.domTree = domTree(f);
+    s.postDomTree = postDomTree(f);
+    s.loops = loops(f);
+    s.toRet = shortestPathToRet(f);
+    s.canReachRet = canReachRet(f);
+    s.reachable = reachable(f);
+    std::unique_lock<std::mutex> lock;
+    s.cfg = entry(f, lock).cfg;
+    return s;
+  }
+
+  void AnalysisManager::adoptShape(const FunDecl &f, const Shape &shape) {
+    Entry *e;
+    {
+      std::lock_guard<std::mutex> g(mu_);
+      auto &slot = entries_[&f];
+      if (!slot)
+        slot = std::make_unique<Entry>();
+      e = slot.get();
+    }
+    std::lock_guard<std::mutex> lock(e->mu);
+    if (!e->built) {
+      e->cfg = shape.cfg;
+      e->rpo = shape.rpo;
+      e->dominators = shape.dominators;
+      e->postDominators = shape.postDominators;
+      e->domTree = shape.domTree;
+      e->postDomTree = shape.postDomTree;
+      e->loops = shape.loops;
+      e->toRet = shape.toRet;
+      e->canReachRet = shape.canReachRet;
+      e->reachable = shape.reachable;
+      e->built = true;
+    }
+  }
+
+  const CFG &AnalysisManager::cfg(const FunDecl &f, DiagBag &diags) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    diags.diags.insert(diags.diags.end(), e.diags.begin(), e.diags.end());
+    return e.cfg;
+  }
+
+  const CFG *AnalysisManager::validCfg(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    for (const auto &d: e.diags)
+      if (d.level == DiagLevel::Error)
+        return nullptr;
+    return &e.cfg;
+  }
+
+  const std::vector<std::size_t> &AnalysisManager::rpo(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.rpo)
+      e.rpo = e.cfg.blocks.empty() ? std::vector<std::size_t>{} : e.cfg.rpo();
+    return *e.rpo;
+  }
+
+  const std::vector<std::size_t> &AnalysisManager::dominators(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.dominators)
+      e.dominators = e.cfg.dominators();
+    return *e.dominators;
+  }
+
+  const std::vector<std::size_t> &AnalysisManager::postDominators(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.postDominators)
+      e.postDominators = e.cfg.postDominators();
+    return *e.postDominators;
+  }
+
+  const DomTree &AnalysisManager::domTree(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.domTree) {
+      if (!e.dominators)
+        e.dominators = e.cfg.dominators();
+      e.domTree.emplace(*e.dominators, e.cfg.entry);
+    }
+    return *e.domTree;
+  }
+
+  const DomTree &AnalysisManager::postDomTree(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.postDomTree) {
+      if (!e.postDominators)
+        e.postDominators = e.cfg.postDominators();
+      e.postDomTree.emplace(*e.postDominators, e.cfg.blocks.size());
+    }
+    return *e.postDomTree;
+  }
+
+  const LoopNest &AnalysisManager::loops(const FunDecl &f) {
+    const DomTree &dom = domTree(f);
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.loops)
+      e.loops = LoopNest::build(e.cfg, dom);
+    return *e.loops;
+  }
+
+  const std::vector<BitVector> &AnalysisManager::reachSets(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.reachSets)
+      e.reachSets = e.cfg.reachSets();
+    return *e.reachSets;
+  }
+
+  const BitVector &AnalysisManager::canReachRet(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.canReachRet)
+      e.canReachRet = e.cfg.canReachRet(f);
+    return *e.canReachRet;
+  }
+
+  const std::unordered_map<std::size_t, std::size_t> &
+  AnalysisManager::shortestPathToRet(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.toRet)
+      e.toRet = e.cfg.shortestPathToRet(f);
+    return *e.toRet;
+  }
+
+  const std::vector<char> &AnalysisManager::reachable(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.reachable) {
+      const CFG &g = e.cfg;
+      std::vector<char> seen(g.succ.size(), 0);
+      if (!g.succ.empty()) {
+        std::queue<std::size_t> work;
+        work.push(g.entry);
+        seen[g.entry] = 1;
+        while (!work.empty()) {
+          std::size_t u = work.front();
+          work.pop();
+          for (std::size_t v: g.succ[u])
+            if (!seen[v]) {
+              seen[v] = 1;
+              work.push(v);
+            }
+        }
+      }
+      e.reachable = std::move(seen);
+    }
+    return *e.reachable;
+  }
+
+  const Liveness &AnalysisManager::liveness(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.liveness)
+      e.liveness.emplace(f, e.cfg);
+    return *e.liveness;
+  }
+
+  const SSAForm &AnalysisManager::ssa(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.ssa) {
+      if (!e.dominators)
+        e.dominators = e.cfg.dominators();
+      if (!e.liveness)
+        e.liveness.emplace(f, e.cfg);
+      e.ssa.emplace(f, e.cfg, *e.dominators, *e.liveness);
+    }
+    return *e.ssa;
+  }
+
+  const SymPrefix &AnalysisManager::symPrefix(const FunDecl &f) {
+    std::unique_lock<std::mutex> lock;
+    Entry &e = entry(f, lock);
+    if (!e.symPrefix)
+      e.symPrefix.emplace(f);
+    return *e.symPrefix;
+  }
+
+  void AnalysisManager::invalidate(const FunDecl &f) {
+    std::lock_guard<std::mutex> g(mu_);
+    entries_.erase(&f);
+  }
+
+  void AnalysisManager::clear() {
+    std::lock_guard<std::mutex> g(mu_);
+    entries_.clear();
+  }
+
+} // namespace symir
@@ -118,4 +118,157 @@ namespace symir {
     return nextStep;
   }
 
+  std::vector<std::size_t> CFG::dominators() const {
+    // Cooper-Harvey-Kennedy over the reverse postorder from the entry.
+    const std::size_t n = blocks.size();
+    const std::size_t none = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> idom(n, none);
+    if (n == 0)
+      return idom;
+    std::vector<std::size_t> order = rpo();
+    std::vector<std::size_t> number(n, none); // position in `order`
+    for (std::size_t i = 0; i < order.size(); ++i)
+      number[order[i]] = i;
+
+    idom[entry] = entry;
+    auto intersect = [&](std::size_t a, std::size_t b) {
+      while (a != b) {
+        while (number[a] > number[b])
+          a = idom[a];
+        while (number[b] > number[a])
+          b = idom[b];
+      }
+      return a;
+    };
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (std::size_t b: order) {
+        if (b == entry)
+          continue;
+        std::size_t cur = none;
+        for (auto p: pred[b]) {
+          if (idom[p] == none)
+            continue;
+          cur = cur == none ? p : intersect(p, cur);
+        }
+        if (cur != idom[b]) {
+          idom[b] = cur;
+          changed = true;
+        }
+      }
+    }
+    return idom;
+  }
+
+  std::vector<std::size_t> CFG::postDominators() const {
+    // Cooper-Harvey-Kennedy dominators on the reverse CFG, rooted at the
+    // virtual exit `n`.
+    const std::size_t n = blocks.size();
+    const std::size_t none = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> order; // postorder of the reverse CFG
+    std::vector<std::size_t> number(n + 1, none);
+    std::vector<char> vis(n + 1, 0);
+    std::function<void(std::size_t)> dfs = [&](std::size_t u) {
+      vis[u] = 1;
+      auto visit = [&](std::size_t v) {
+        if (!vis[v])
+          dfs(v);
+      };
+      if (u == n) {
+        for (std::size_t b = 0; b < n; ++b)
+          if (succ[b].empty())
+            visit(b);
+      } else {
+        for (auto v: pred[u])
+          visit(v);
+      }
+      number[u] = order.size();
+      order.push_back(u);
+    };
+    dfs(n);
+
+    std::vector<std::size_t> ipdom(n + 1, none);
+    ipdom[n] = n;
+    auto intersect = [&](std::size_t a, std::size_t b) {
+      while (a != b) {
+        while (number[a] < number[b])
+          a = ipdom[a];
+        while (number[b] < number[a])
+          b = ipdom[b];
+      }
+      return a;
+    };
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        std::size_t b = *it;
+        if (b == n)
+          continue;
+        std::size_t cur = succ[b].empty() ? n : none;
+        for (auto s: succ[b]) {
+          if (ipdom[s] == none)
+            continue;
+          cur = cur == none ? s : intersect(s, cur);
+        }
+        if (cur != ipdom[b]) {
+          ipdom[b] = cur;
+          changed = true;
+        }
+      }
+    }
+    ipdom.pop_back();
+    return ipdom;
+  }
+
+  std::vector<BitVector> CFG::reachSets() const {
+    // Union over the successors until nothing changes; visiting the blocks
+    // in postorder settles an acyclic CFG in one round.
+    const std::size_t n = blocks.size();
+    std::vector<BitVector> reach(n, BitVector(n));
+    std::vector<std::size_t> order = n == 0 ? std::vector<std::size_t>{} : rpo();
+    std::vector<char> inOrder(n, 0);
+    for (std::size_t b: order)
+      inOrder[b] = 1;
+    std::reverse(order.begin(), order.end());
+    for (std::size_t b = 0; b < n; ++b)
+      if (!inOrder[b])
+        order.push_back(b); // blocks the entry does not reach
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (std::size_t b: order) {
+        for (auto s: succ[b]) {
+          if (!reach[b].test(s)) {
+            reach[b].set(s);
+            changed = true;
+          }
+          if (s != b)
+            changed |= reach[b].unionWith(reach[s]);
+        }
+      }
+    }
+    return reach;
+  }
+
+  BitVector CFG::canReachRet(const FunDecl &f) const {
+    BitVector can(blocks.size());
+    std::vector<std::size_t> todo;
+    for (std::size_t i = 0; i < f.blocks.size(); ++i) {
+      if (std::holds_alternative<RetTerm>(f.blocks[i].term)) {
+        can.set(i);
+        todo.push_back(i);
+      }
+    }
+    while (!todo.empty()) {
+      std::size_t u = todo.back();
+      todo.pop_back();
+      for (auto v: pred[u]) {
+        if (!can.test(v)) {
+          can.set(v);
+          todo.push_back(v);
+        }
+      }
+    }
+    return can;
+  }
+
 } // namespace symir
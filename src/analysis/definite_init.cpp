@@ -2,71 +2,66 @@
 
 namespace symir {
 
-  symir::PassResult DefiniteInitAnalysis::run(FunDecl &f, DiagBag &diags) {
-    CFG cfg = CFG::build(f, diags);
+  symir::PassResult DefiniteInitAnalysis::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    const CFG &cfg = am.cfg(f, diags);
     if (diags.hasErrors())
       return symir::PassResult::Error;
 
-    Problem p(f, diags);
-    symir::DataflowSolver<InitSet>::solve(f, cfg, p);
+    Problem p(f);
+    auto res = symir::DataflowSolver<InitSet>::solve(f, cfg, p);
+    // Reads are checked once against the fixpoint, not on every visit.
+    for (std::size_t b: am.rpo(f))
+      p.check(f.blocks[b], res.in[b], diags);
 
     return diags.hasErrors() ? symir::PassResult::Error : symir::PassResult::Success;
   }
 
-  DefiniteInitAnalysis::Problem::Problem(const FunDecl &f, DiagBag &diags) : f_(f), diags_(diags) {}
+  DefiniteInitAnalysis::Problem::Problem(const FunDecl &f) : f_(f) {
+    for (std::size_t k = 0; k < f.lets.size(); ++k)
+      index_[f.lets[k].name.name] = k;
+  }
 
   DefiniteInitAnalysis::InitSet DefiniteInitAnalysis::Problem::bottom() {
-    InitSet s;
-    for (const auto &p: f_.params)
-      s[p.name.name] = true;
-    for (const auto &l: f_.lets)
-      s[l.name.name] = true;
-    for (const auto &sy: f_.syms)
-      s[sy.name.name] = true;
-    return s;
+    return InitSet(f_.lets.size(), true);
   }
 
   DefiniteInitAnalysis::InitSet DefiniteInitAnalysis::Problem::entryState() {
-    InitSet s;
-    // Params and symbols are initialized
-    for (const auto &p: f_.params)
-      s[p.name.name] = true;
-    for (const auto &sy: f_.syms)
-      s[sy.name.name] = true;
     // Locals are initialized only if they have a non-undef initializer
-    for (const auto &l: f_.lets) {
-      s[l.name.name] = (l.init && l.init->kind != InitVal::Kind::Undef);
+    InitSet s(f_.lets.size());
+    for (std::size_t k = 0; k < f_.lets.size(); ++k) {
+      const auto &l = f_.lets[k];
+      s.set(k, l.init && l.init->kind != InitVal::Kind::Undef);
     }
     return s;
   }
 
-  DefiniteInitAnalysis::InitSet
-  DefiniteInitAnalysis::Problem::meet(const InitSet &lhs, const InitSet &rhs) {
-    InitSet r;
-    for (auto const &[key, val]: lhs) {
-      r[key] = val && rhs.at(key);
-    }
-    return r;
+  void DefiniteInitAnalysis::Problem::meetInto(InitSet &acc, const InitSet &in) {
+    acc.intersectWith(in);
   }
 
-  bool DefiniteInitAnalysis::Problem::equal(const InitSet &lhs, const InitSet &rhs) {
-    if (lhs.size() != rhs.size())
-      return false;
-    for (auto const &[key, val]: lhs) {
-      auto it = rhs.find(key);
-      if (it == rhs.end() || it->second != val)
-        return false;
-    }
-    return true;
+  void DefiniteInitAnalysis::Problem::transferInto(const Block &b, InitSet &state) {
+    run(b, state, nullptr);
   }
 
-  DefiniteInitAnalysis::InitSet
-  DefiniteInitAnalysis::Problem::transfer(const Block &b, const InitSet &in) {
+  void DefiniteInitAnalysis::Problem::check(const Block &b, const InitSet &in, DiagBag &diags) {
     InitSet state = in;
+    run(b, state, &diags);
+  }
+
+  void DefiniteInitAnalysis::Problem::run(const Block &b, InitSet &state, DiagBag *diags) {
+    // Params and symbols are always initialized; only lets have a bit.
+    auto uninit = [&](const Symbol &name) {
+      auto it = index_.find(name);
+      return it != index_.end() && !state.test(it->second);
+    };
+    auto report = [&](const std::string &msg, SourceSpan span) {
+      if (diags)
+        diags->error(msg, span);
+    };
 
     auto checkLValue = [&](const LValue &lv) {
-      if (state.count(lv.base.name) && !state.at(lv.base.name)) {
-        diags_.error("Read of possibly uninitialized local: " + lv.base.name, lv.base.span);
+      if (uninit(lv.base.name)) {
+        report("Read of possibly uninitialized local: " + lv.base.name, lv.base.span);
       }
     };
 
@@ -78,8 +73,8 @@ namespace symir {
               if constexpr (std::is_same_v<T, OpAtom>) {
                 if (auto lsid = std::get_if<LocalOrSymId>(&arg.coef)) {
                   if (auto lid = std::get_if<LocalId>(lsid)) {
-                    if (state.count(lid->name) && !state.at(lid->name))
-                      diags_.error("Read of uninitialized local in coef: " + lid->name, lid->span);
+                    if (uninit(lid->name))
+                      report("Read of uninitialized local in coef: " + lid->name, lid->span);
                   }
                 }
                 checkLValue(arg.rval);
@@ -101,8 +96,8 @@ namespace symir {
                   else if (auto cf = std::get_if<Coef>(&sv)) {
                     if (auto lsid = std::get_if<LocalOrSymId>(cf)) {
                       if (auto lid = std::get_if<LocalId>(lsid)) {
-                        if (state.count(lid->name) && !state.at(lid->name))
-                          diags_.error(
+                        if (uninit(lid->name))
+                          report(
                               "Read of uninitialized local in cmp: " + lid->name, lid->span
                           );
                       }
@@ -116,8 +111,8 @@ namespace symir {
               } else if constexpr (std::is_same_v<T, CoefAtom>) {
                 if (auto lsid = std::get_if<LocalOrSymId>(&arg.coef)) {
                   if (auto lid = std::get_if<LocalId>(lsid)) {
-                    if (state.count(lid->name) && !state.at(lid->name))
-                      diags_.error("Read of uninitialized local: " + lid->name, lid->span);
+                    if (uninit(lid->name))
+                      report("Read of uninitialized local: " + lid->name, lid->span);
                   }
                 }
               } else if constexpr (std::is_same_v<T, CastAtom>) {
@@ -152,7 +147,8 @@ namespace symir {
             using T = std::decay_t<decltype(arg)>;
             if constexpr (std::is_same_v<T, AssignInstr>) {
               checkExpr(arg.rhs, checkExpr);
-              state[arg.lhs.base.name] = true;
+              if (auto it = index_.find(arg.lhs.base.name); it != index_.end())
+                state.set(it->second);
             } else if constexpr (std::is_same_v<T, AssumeInstr>) {
               checkExpr(arg.cond.lhs, checkExpr);
               checkExpr(arg.cond.rhs, checkExpr);
@@ -180,8 +176,6 @@ namespace symir {
         },
         b.term
     );
-
-    return state;
   }
 
 } // namespace symir
@@ -0,0 +1,768 @@
+#include "analysis/intervals.hpp"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace symir {
+
+  namespace {
+
+    using Interval = IntervalAnalysis::Interval;
+    using Wide = __int128;
+
+    constexpr Interval kTop{};
+
+    // Width of an integer scalar type, 0 for everything else.
+    int intBits(const TypePtr &t) {
+      if (!t)
+        return 0;
+      auto it = std::get_if<IntType>(&t->v);
+      if (!it)
+        return 0;
+      switch (it->kind) {
+        case IntType::Kind::I32:
+          return 32;
+        case IntType::Kind::I64:
+          return 64;
+        case IntType::Kind::ICustom:
+          return it->bits.value_or(32);
+      }
+      return 0;
+    }
+
+    Interval typeRange(int bits) {
+      if (bits <= 0 || bits >= 64)
+        return kTop;
+      return {-(int64_t(1) << (bits - 1)), (int64_t(1) << (bits - 1)) - 1};
+    }
+
+    // [lo, hi] saturated to int64. Saturating only widens the interval.
+    Interval fromWide(Wide lo, Wide hi) {
+      auto sat = [](Wide v) -> int64_t {
+        return v < Wide(INT64_MIN) ? INT64_MIN : v > Wide(INT64_MAX) ? INT64_MAX : int64_t(v);
+      };
+      return {sat(lo), sat(hi)};
+    }
+
+    Interval intersect(const Interval &a, const Interval &b) {
+      return {std::max(a.lo, b.lo), std::min(a.hi, b.hi)};
+    }
+
+    Interval hull(const Interval &a, const Interval &b) {
+      return {std::min(a.lo, b.lo), std::max(a.hi, b.hi)};
+    }
+
+    Interval single(int64_t v) { return {v, v}; }
+
+    Interval add(const Interval &a, const Interval &b) {
+      return fromWide(Wide(a.lo) + b.lo, Wide(a.hi) + b.hi);
+    }
+
+    Interval sub(const Interval &a, const Interval &b) {
+      return fromWide(Wide(a.lo) - b.hi, Wide(a.hi) - b.lo);
+    }
+
+    Interval corners(const Interval &a, const Interval &b, Wide (*f)(Wide, Wide)) {
+      Wide v[] = {f(a.lo, b.lo), f(a.lo, b.hi), f(a.hi, b.lo), f(a.hi, b.hi)};
+      return fromWide(*std::min_element(v, v + 4), *std::max_element(v, v + 4));
+    }
+
+    Interval mul(const Interval &a, const Interval &b) {
+      return corners(a, b, [](Wide x, Wide y) { return x * y; });
+    }
+
+    // Truncating division; a zero divisor is UB, so it is cut out of `b`.
+    Interval div(const Interval &a, const Interval &b) {
+      auto quot = [](Wide x, Wide y) { return x / y; };
+      std::optional<Interval> r;
+      for (Interval part: {intersect(b, {INT64_MIN, -1}), intersect(b, {1, INT64_MAX})}) {
+        if (part.empty())
+          continue;
+        Interval q = corners(a, part, quot);
+        r = r ? hull(*r, q) : q;
+      }
+      return r.value_or(kTop);
+    }
+
+    // The remainder takes the sign of the dividend and is smaller in
+    // magnitude than the divisor.
+    Interval mod(const Interval &a, const Interval &b) {
+      Wide m = std::max(b.lo < 0 ? -Wide(b.lo) : Wide(b.lo), b.hi < 0 ? -Wide(b.hi) : Wide(b.hi));
+      if (m == 0)
+        return kTop;
+      Wide lo = a.lo >= 0 ? 0 : std::max(Wide(a.lo), 1 - m);
+      Wide hi = a.hi <= 0 ? 0 : std::min(Wide(a.hi), m - 1);
+      return fromWide(lo, hi);
+    }
+
+    // Smallest 2^k - 1 that is at least `v` (v >= 0).
+    int64_t fillBits(int64_t v) {
+      int64_t m = 0;
+      while (m < v)
+        m = m * 2 + 1;
+      return m;
+    }
+
+    Interval bitwise(AtomOpKind op, const Interval &a, const Interval &b) {
+      if (op == AtomOpKind::And) {
+        if (a.lo >= 0 && b.lo >= 0)
+          return {0, std::min(a.hi, b.hi)};
+        if (a.lo >= 0 || b.lo >= 0)
+          return {0, a.lo >= 0 ? a.hi : b.hi};
+        return kTop;
+      }
+      // Or, Xor
+      if (a.lo >= 0 && b.lo >= 0)
+        return {0, fillBits(std::max(a.hi, b.hi))};
+      return kTop;
+    }
+
+    // Shifts by less than 0 or at least the width are UB, and so is
+    // shifting a negative value left.
+    Interval shift(AtomOpKind op, const Interval &a, const Interval &b, int bits) {
+      Interval amt = intersect(b, {0, (bits > 0 ? bits : 64) - 1});
+      if (amt.empty())
+        return kTop;
+      if (op == AtomOpKind::Shl) {
+        Interval v = intersect(a, {0, INT64_MAX});
+        if (v.empty())
+          return kTop;
+        return fromWide(Wide(v.lo) << amt.lo, Wide(v.hi) << amt.hi);
+      }
+      if (op == AtomOpKind::LShr && a.lo < 0)
+        return kTop;
+      return {std::min(a.lo >> amt.lo, a.lo >> amt.hi), std::max(a.hi >> amt.lo, a.hi >> amt.hi)};
+    }
+
+    RelOp negate(RelOp op) {
+      switch (op) {
+        case RelOp::EQ:
+          return RelOp::NE;
+        case RelOp::NE:
+          return RelOp::EQ;
+        case RelOp::LT:
+          return RelOp::GE;
+        case RelOp::LE:
+          return RelOp::GT;
+        case RelOp::GT:
+          return RelOp::LE;
+        case RelOp::GE:
+          return RelOp::LT;
+      }
+      return op;
+    }
+
+    // `a op b` as `b flip(op) a`.
+    RelOp flip(RelOp op) {
+      switch (op) {
+        case RelOp::LT:
+          return RelOp::GT;
+        case RelOp::LE:
+          return RelOp::GE;
+        case RelOp::GT:
+          return RelOp::LT;
+        case RelOp::GE:
+          return RelOp::LE;
+        default:
+          return op;
+      }
+    }
+
+    // No pair of values from `a` and `b` satisfies `a op b`.
+    bool never(const Interval &a, RelOp op, const Interval &b) {
+      switch (op) {
+        case RelOp::EQ:
+          return a.hi < b.lo || b.hi < a.lo;
+        case RelOp::NE:
+          return a.lo == a.hi && b.lo == b.hi && a.lo == b.lo;
+        case RelOp::LT:
+          return a.lo >= b.hi;
+        case RelOp::LE:
+          return a.lo > b.hi;
+        case RelOp::GT:
+          return a.hi <= b.lo;
+        case RelOp::GE:
+          return a.hi < b.lo;
+      }
+      return false;
+    }
+
+    // The values of `a` that may satisfy `a op b`.
+    Interval restrict(const Interval &a, RelOp op, const Interval &b) {
+      switch (op) {
+        case RelOp::EQ:
+          return intersect(a, b);
+        case RelOp::NE:
+          if (b.lo != b.hi)
+            return a;
+          if (a.lo == b.lo && a.lo < INT64_MAX)
+            return {a.lo + 1, a.hi};
+          if (a.hi == b.lo && a.hi > INT64_MIN)
+            return {a.lo, a.hi - 1};
+          return a;
+        case RelOp::LT:
+          return b.hi == INT64_MIN ? Interval{1, 0} : intersect(a, {INT64_MIN, b.hi - 1});
+        case RelOp::LE:
+          return intersect(a, {INT64_MIN, b.hi});
+        case RelOp::GT:
+          return b.lo == INT64_MAX ? Interval{1, 0} : intersect(a, {b.lo + 1, INT64_MAX});
+        case RelOp::GE:
+          return intersect(a, {b.lo, INT64_MAX});
+      }
+      return a;
+    }
+
+    // --- Address-taken lets ---
+
+    void scanExpr(const Expr &e, std::unordered_set<std::string> &out);
+
+    void scanAtom(const Atom &a, std::unordered_set<std::string> &out) {
+      if (auto addr = std::get_if<AddrAtom>(&a.v)) {
+        out.insert(addr->lv.base.name);
+      } else if (auto sel = std::get_if<SelectAtom>(&a.v)) {
+        if (sel->cond) {
+          scanExpr(sel->cond->lhs, out);
+          scanExpr(sel->cond->rhs, out);
+        } else if (sel->maskExpr) {
+          scanExpr(*sel->maskExpr, out);
+        }
+      }
+    }
+
+    void scanExpr(const Expr &e, std::unordered_set<std::string> &out) {
+      scanAtom(e.first, out);
+      for (const auto &t: e.rest)
+        scanAtom(t.atom, out);
+    }
+
+    void scanInit(const InitVal &iv, std::unordered_set<std::string> &out) {
+      if (iv.kind == InitVal::Kind::Atom)
+        scanAtom(*std::get<AtomPtr>(iv.value), out);
+      else if (iv.kind == InitVal::Kind::Aggregate)
+        for (const auto &elem: std::get<std::vector<InitValPtr>>(iv.value))
+          if (elem)
+            scanInit(*elem, out);
+    }
+
+    std::unordered_set<std::string> addressed(const FunDecl &f) {
+      std::unordered_set<std::string> out;
+      for (const auto &l: f.lets)
+        if (l.init)
+          scanInit(*l.init, out);
+      for (const auto &b: f.blocks) {
+        for (const auto &ins: b.instrs) {
+          std::visit(
+              [&](auto &&arg) {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, AssignInstr>) {
+                  scanExpr(arg.rhs, out);
+                } else if constexpr (std::is_same_v<T, StoreInstr>) {
+                  scanExpr(arg.ptr, out);
+                  scanExpr(arg.val, out);
+                } else {
+                  scanExpr(arg.cond.lhs, out);
+                  scanExpr(arg.cond.rhs, out);
+                }
+              },
+              ins
+          );
+        }
+        if (auto br = std::get_if<BrTerm>(&b.term); br && br->cond) {
+          scanExpr(br->cond->lhs, out);
+          scanExpr(br->cond->rhs, out);
+        } else if (auto ret = std::get_if<RetTerm>(&b.term); ret && ret->value) {
+          scanExpr(*ret->value, out);
+        }
+      }
+      return out;
+    }
+
+    // --- Index sites ---
+
+    // Calls `fn` on each index read through by `lv`, `a` or `e`.
+    template <typename Fn> void forEachIndex(const LValue &lv, Fn &fn) {
+      for (const auto &acc: lv.accesses)
+        if (auto ai = std::get_if<AccessIndex>(&acc))
+          fn(ai->index);
+    }
+
+    template <typename Fn> void forEachIndex(const Expr &e, Fn &fn);
+
+    template <typename Fn> void forEachIndex(const SelectVal &sv, Fn &fn) {
+      if (auto rv = std::get_if<RValue>(&sv))
+        forEachIndex(*rv, fn);
+    }
+
+    template <typename Fn> void forEachIndex(const Atom &a, Fn &fn) {
+      std::visit(
+          [&](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, OpAtom> || std::is_same_v<T, RValueAtom> ||
+                          std::is_same_v<T, UnaryAtom> || std::is_same_v<T, LoadAtom> ||
+                          std::is_same_v<T, PtrFieldAtom>) {
+              forEachIndex(arg.rval, fn);
+            } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
+              forEachIndex(arg.rval, fn);
+              fn(arg.index);
+            } else if constexpr (std::is_same_v<T, AddrAtom>) {
+              forEachIndex(arg.lv, fn);
+            } else if constexpr (std::is_same_v<T, SelectAtom>) {
+              if (arg.cond) {
+                forEachIndex(arg.cond->lhs, fn);
+                forEachIndex(arg.cond->rhs, fn);
+              } else if (arg.maskExpr) {
+                forEachIndex(*arg.maskExpr, fn);
+              }
+              forEachIndex(arg.vtrue, fn);
+              forEachIndex(arg.vfalse, fn);
+            } else if constexpr (std::is_same_v<T, CmpAtom>) {
+              forEachIndex(arg.lhs, fn);
+              forEachIndex(arg.rhs, fn);
+            } else if constexpr (std::is_same_v<T, CastAtom>) {
+              if (auto lv = std::get_if<LValue>(&arg.src))
+                forEachIndex(*lv, fn);
+            }
+          },
+          a.v
+      );
+    }
+
+    template <typename Fn> void forEachIndex(const Expr &e, Fn &fn) {
+      forEachIndex(e.first, fn);
+      for (const auto &t: e.rest)
+        forEachIndex(t.atom, fn);
+    }
+
+    // Abstract evaluation against the intervals of one state. `bits` is
+    // the width of the value being computed (0 if unknown); literals that
+    // do not fit it are not interpreted.
+    struct Evaluator {
+      std::vector<Interval> &vals;
+      const std::unordered_map<std::string, std::size_t> &index;
+      const std::vector<int> &widths;
+      const std::vector<bool> &tracked;
+
+      std::size_t slot(const std::string &name) const {
+        auto it = index.find(name);
+        return it == index.end() || !tracked[it->second] ? SIZE_MAX : it->second;
+      }
+
+      Interval var(const std::string &name) const {
+        std::size_t s = slot(name);
+        return s == SIZE_MAX ? kTop : vals[s];
+      }
+
+      static Interval literal(int64_t v, int bits) {
+        Interval r = typeRange(bits);
+        return v < r.lo || v > r.hi ? kTop : single(v);
+      }
+
+      static const Symbol *name(const Coef &c) {
+        if (auto lsid = std::get_if<LocalOrSymId>(&c))
+          return std::visit([](auto &&id) { return &id.name; }, *lsid);
+        return nullptr;
+      }
+
+      Interval coef(const Coef &c, int bits) const {
+        if (auto lit = std::get_if<IntLit>(&c))
+          return literal(lit->value, bits);
+        if (auto n = name(c))
+          return var(*n);
+        return kTop;
+      }
+
+      Interval rvalue(const RValue &rv) const {
+        return rv.accesses.empty() ? var(rv.base.name) : kTop;
+      }
+
+      Interval selectVal(const SelectVal &sv, int bits) const {
+        if (auto rv = std::get_if<RValue>(&sv))
+          return rvalue(*rv);
+        return coef(std::get<Coef>(sv), bits);
+      }
+
+      // Width of the first variable `a` reads: > 0 for an integer scalar,
+      // 0 for anything else, -1 if it reads none.
+      int width(const Atom &a) const {
+        const Symbol *n = nullptr;
+        bool whole = true;
+        if (auto ca = std::get_if<CoefAtom>(&a.v)) {
+          n = name(ca->coef);
+        } else if (auto ra = std::get_if<RValueAtom>(&a.v)) {
+          n = &ra->rval.base.name;
+          whole = ra->rval.accesses.empty();
+        } else if (auto oa = std::get_if<OpAtom>(&a.v)) {
+          n = &oa->rval.base.name;
+          whole = oa->rval.accesses.empty();
+        } else if (auto ua = std::get_if<UnaryAtom>(&a.v)) {
+          n = &ua->rval.base.name;
+          whole = ua->rval.accesses.empty();
+        } else if (std::holds_alternative<CastAtom>(a.v) || std::holds_alternative<LoadAtom>(a.v)) {
+          return 0;
+        }
+        if (!n)
+          return -1;
+        auto it = index.find(*n);
+        return whole && it != index.end() ? widths[it->second] : 0;
+      }
+
+      int width(const Expr &e) const {
+        int w = width(e.first);
+        for (std::size_t i = 0; w < 0 && i < e.rest.size(); ++i)
+          w = width(e.rest[i].atom);
+        return w;
+      }
+
+      Interval atom(const Atom &a, int bits) {
+        return std::visit(
+            [&](auto &&arg) -> Interval {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, CoefAtom>) {
+                return coef(arg.coef, bits);
+              } else if constexpr (std::is_same_v<T, RValueAtom>) {
+                return rvalue(arg.rval);
+              } else if constexpr (std::is_same_v<T, OpAtom>) {
+                Interval c = coef(arg.coef, bits), r = rvalue(arg.rval);
+                switch (arg.op) {
+                  case AtomOpKind::Mul:
+                    return mul(c, r);
+                  case AtomOpKind::Div:
+                    return div(c, r);
+                  case AtomOpKind::Mod:
+                    return mod(c, r);
+                  case AtomOpKind::And:
+                  case AtomOpKind::Or:
+                  case AtomOpKind::Xor:
+                    return bitwise(arg.op, c, r);
+                  case AtomOpKind::Shl:
+                  case AtomOpKind::Shr:
+                  case AtomOpKind::LShr:
+                    return shift(arg.op, c, r, bits);
+                }
+                return kTop;
+              } else if constexpr (std::is_same_v<T, UnaryAtom>) {
+                Interval r = rvalue(arg.rval); // ~x == -x - 1
+                return fromWide(-Wide(r.hi) - 1, -Wide(r.lo) - 1);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                return hull(selectVal(arg.vtrue, bits), selectVal(arg.vfalse, bits));
+              } else {
+                return kTop; // casts, loads, cmp and pointers
+              }
+            },
+            a.v
+        );
+      }
+
+      Interval expr(const Expr &e, int bits) {
+        Interval v = atom(e.first, bits);
+        for (const auto &t: e.rest) {
+          Interval r = atom(t.atom, bits);
+          v = t.op == AddOp::Plus ? add(v, r) : sub(v, r);
+        }
+        return v;
+      }
+
+      // `e` as variable + constant offset, if it has that form.
+      bool linear(const Expr &e, int bits, std::size_t &s, Wide &offset) const {
+        const Symbol *n = nullptr;
+        if (auto ca = std::get_if<CoefAtom>(&e.first.v))
+          n = name(ca->coef);
+        else if (auto ra = std::get_if<RValueAtom>(&e.first.v); ra && ra->rval.accesses.empty())
+          n = &ra->rval.base.name;
+        if (!n || (s = slot(*n)) == SIZE_MAX)
+          return false;
+        offset = 0;
+        for (const auto &t: e.rest) {
+          auto ca = std::get_if<CoefAtom>(&t.atom.v);
+          auto lit = ca ? std::get_if<IntLit>(&ca->coef) : nullptr;
+          if (!lit || literal(lit->value, bits) == kTop)
+            return false;
+          offset += t.op == AddOp::Plus ? Wide(lit->value) : -Wide(lit->value);
+        }
+        return true;
+      }
+
+      // Narrows the variable of `side` (current value `cur`) so that
+      // `side op other` may hold; false if it cannot.
+      bool
+      narrow(const Expr &side, int bits, const Interval &cur, RelOp op, const Interval &other) {
+        std::size_t s;
+        Wide k;
+        if (!linear(side, bits, s, k))
+          return true;
+        Interval r = restrict(cur, op, other);
+        if (r.empty())
+          return false;
+        vals[s] = intersect(vals[s], fromWide(r.lo - k, r.hi - k));
+        return !vals[s].empty();
+      }
+
+      // Assumes `c` holds (or fails); false if it cannot.
+      bool cond(const Cond &c, bool holds) {
+        int lw = width(c.lhs), rw = lw < 0 ? width(c.rhs) : lw;
+        if (rw <= 0)
+          return true; // not an integer comparison
+        RelOp op = holds ? c.op : negate(c.op);
+        Interval l = expr(c.lhs, rw), r = expr(c.rhs, rw);
+        if (never(l, op, r))
+          return false;
+        return narrow(c.lhs, rw, l, op, r) && narrow(c.rhs, rw, r, flip(op), l);
+      }
+
+      Interval init(const InitVal &iv, int bits) {
+        switch (iv.kind) {
+          case InitVal::Kind::Int:
+            return literal(std::get<IntLit>(iv.value).value, bits);
+          case InitVal::Kind::Sym:
+            return var(std::get<SymId>(iv.value).name);
+          case InitVal::Kind::Local:
+            return var(std::get<LocalId>(iv.value).name);
+          case InitVal::Kind::Atom:
+            return atom(*std::get<AtomPtr>(iv.value), bits);
+          default:
+            return kTop;
+        }
+      }
+
+      // Stores `v` into slot `s`, cut to its type; values outside it come
+      // from UB, which the solver refutes on its own.
+      void assign(std::size_t s, const Interval &v) {
+        Interval r = intersect(v, typeRange(widths[s]));
+        vals[s] = r.empty() ? typeRange(widths[s]) : r;
+      }
+    };
+
+  } // namespace
+
+  IntervalAnalysis::Problem::Problem(const FunDecl &f, const FixedSyms &fixedSyms) :
+      f_(f), fixed_(fixedSyms) {
+    auto taken = addressed(f);
+    auto addSlot = [&](const std::string &name, const TypePtr &type, bool addressable) {
+      index_[name] = bits_.size();
+      int bits = intBits(type);
+      bits_.push_back(bits);
+      tracked_.push_back(bits > 1 && !(addressable && taken.count(name)));
+    };
+    for (const auto &s: f.syms)
+      addSlot(s.name.name, s.type, false);
+    for (const auto &p: f.params)
+      addSlot(p.name.name, p.type, false);
+    for (const auto &l: f.lets) // a let shadows a param of the same name
+      addSlot(l.name.name, l.type, true);
+  }
+
+  IntervalAnalysis::State IntervalAnalysis::Problem::bottom() {
+    State s;
+    s.vals.assign(bits_.size(), kTop);
+    return s;
+  }
+
+  IntervalAnalysis::State IntervalAnalysis::Problem::entryState() {
+    State s = bottom();
+    s.reachable = true;
+    for (std::size_t k = 0; k < bits_.size(); ++k)
+      s.vals[k] = typeRange(bits_[k]);
+
+    // Syms: the domain as encodeEntry() asserts it, and the fixed value.
+    for (std::size_t k = 0; k < f_.syms.size(); ++k) {
+      const SymDecl &sym = f_.syms[k];
+      if (!tracked_[k])
+        continue;
+      Interval range = typeRange(bits_[k]);
+      Interval &v = s.vals[k];
+      if (sym.domain) {
+        if (auto in = std::get_if<DomainInterval>(&*sym.domain)) {
+          Interval d = intersect(range, {in->lo, in->hi});
+          if (!d.empty()) // an empty interval constrains nothing
+            v = d;
+        } else if (auto set = std::get_if<DomainSet>(&*sym.domain); set && !set->values.empty()) {
+          Interval d{INT64_MAX, INT64_MIN};
+          for (int64_t x: set->values)
+            d = hull(d, Evaluator::literal(x, bits_[k]));
+          v = intersect(range, d);
+        }
+      }
+      if (auto it = fixed_.find(sym.name.name); it != fixed_.end()) {
+        v = intersect(v, Evaluator::literal(it->second, bits_[k]));
+        if (v.empty()) {
+          s.reachable = false;
+          return s;
+        }
+      }
+    }
+
+    // Initializers run in declaration order and may read earlier lets.
+    Evaluator ev{s.vals, index_, bits_, tracked_};
+    for (const auto &l: f_.lets) {
+      std::size_t k = ev.slot(l.name.name);
+      if (k != SIZE_MAX && l.init)
+        ev.assign(k, ev.init(*l.init, bits_[k]));
+    }
+    return s;
+  }
+
+  IntervalAnalysis::State IntervalAnalysis::Problem::meet(const State &lhs, const State &rhs) {
+    if (!lhs.reachable)
+      return rhs;
+    if (!rhs.reachable)
+      return lhs;
+    State r = lhs;
+    for (std::size_t k = 0; k < r.vals.size(); ++k)
+      r.vals[k] = hull(lhs.vals[k], rhs.vals[k]);
+    return r;
+  }
+
+  bool IntervalAnalysis::Problem::equal(const State &lhs, const State &rhs) {
+    return lhs.reachable == rhs.reachable && (!lhs.reachable || lhs.vals == rhs.vals);
+  }
+
+  IntervalAnalysis::State
+  IntervalAnalysis::Problem::widen(const State &prev, const State &next) {
+    if (!prev.reachable || !next.reachable)
+      return meet(prev, next);
+    State r = prev;
+    for (std::size_t k = 0; k < r.vals.size(); ++k) {
+      if (next.vals[k].lo < prev.vals[k].lo)
+        r.vals[k].lo = INT64_MIN;
+      if (next.vals[k].hi > prev.vals[k].hi)
+        r.vals[k].hi = INT64_MAX;
+    }
+    return r;
+  }
+
+  IntervalAnalysis::State IntervalAnalysis::Problem::transfer(const Block &b, const State &in) {
+    return run(b, in, nullptr);
+  }
+
+  void IntervalAnalysis::Problem::record(
+      const Block &b, const State &in, std::unordered_map<const Index *, Interval> &sites
+  ) {
+    run(b, in, &sites);
+  }
+
+  IntervalAnalysis::State IntervalAnalysis::Problem::run(
+      const Block &b, const State &in, std::unordered_map<const Index *, Interval> *sites
+  ) {
+    if (!in.reachable)
+      return in;
+    State state = in;
+    Evaluator ev{state.vals, index_, bits_, tracked_};
+    auto note = [&](const Index &idx) {
+      auto id = std::get_if<LocalOrSymId>(&idx);
+      std::size_t k = id ? ev.slot(std::visit([](auto &&v) { return v.name; }, *id)) : SIZE_MAX;
+      if (k != SIZE_MAX)
+        (*sites)[&idx] = state.vals[k];
+    };
+    for (const auto &ins: b.instrs) {
+      if (sites)
+        std::visit(
+            [&](auto &&arg) {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, AssignInstr>) {
+                forEachIndex(arg.lhs, note);
+                forEachIndex(arg.rhs, note);
+              } else if constexpr (std::is_same_v<T, StoreInstr>) {
+                forEachIndex(arg.ptr, note);
+                forEachIndex(arg.val, note);
+              } else {
+                forEachIndex(arg.cond.lhs, note);
+                forEachIndex(arg.cond.rhs, note);
+              }
+            },
+            ins
+        );
+      bool ok = std::visit(
+          [&](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, AssignInstr>) {
+              std::size_t k = ev.slot(arg.lhs.base.name);
+              if (k != SIZE_MAX && arg.lhs.accesses.empty())
+                ev.assign(k, ev.expr(arg.rhs, bits_[k]));
+              return true;
+            } else if constexpr (std::is_same_v<T, AssumeInstr> ||
+                                 std::is_same_v<T, RequireInstr>) {
+              return ev.cond(arg.cond, true);
+            } else {
+              return true; // stores never reach a tracked let
+            }
+          },
+          ins
+      );
+      if (!ok) {
+        state.reachable = false;
+        return state;
+      }
+    }
+    if (sites) {
+      if (auto br = std::get_if<BrTerm>(&b.term); br && br->cond) {
+        forEachIndex(br->cond->lhs, note);
+        forEachIndex(br->cond->rhs, note);
+      } else if (auto ret = std::get_if<RetTerm>(&b.term); ret && ret->value) {
+        forEachIndex(*ret->value, note);
+      }
+    }
+    return state;
+  }
+
+  IntervalAnalysis::State
+  IntervalAnalysis::Problem::edge(const Block &b, const std::string &to, const State &out) {
+    auto br = std::get_if<BrTerm>(&b.term);
+    if (!out.reachable || !br || !br->isConditional || !br->cond ||
+        br->thenLabel.name == br->elseLabel.name)
+      return out;
+    bool taken = to == br->thenLabel.name;
+    if (!taken && to != br->elseLabel.name)
+      return out;
+    State state = out;
+    Evaluator ev{state.vals, index_, bits_, tracked_};
+    if (!ev.cond(*br->cond, taken))
+      state.reachable = false;
+    return state;
+  }
+
+  IntervalAnalysis::PathResult IntervalAnalysis::onPath(
+      const FunDecl &f, const CFG &cfg, const std::vector<std::string> &path,
+      const FixedSyms &fixedSyms
+  ) {
+    Problem p(f, fixedSyms);
+    PathResult res;
+    const State start = p.entryState();
+    State state = start;
+    for (std::size_t i = 0; i < path.size() && state.reachable; ++i) {
+      auto it = cfg.indexOf.find(path[i]);
+      if (it == cfg.indexOf.end())
+        throw std::runtime_error("Invalid block label in path: " + path[i]);
+      const Block &block = f.blocks[it->second];
+      state = p.transfer(block, state);
+      if (i + 1 < path.size())
+        state = p.edge(block, path[i + 1], state);
+    }
+    if (!state.reachable) {
+      res.infeasible = true;
+      return res;
+    }
+    for (std::size_t k = 0; k < f.syms.size(); ++k)
+      if (!(state.vals[k] == start.vals[k]))
+        res.syms.emplace(f.syms[k].name.name, state.vals[k]);
+    return res;
+  }
+
+  IntervalAnalysis::IntervalAnalysis(const FunDecl &f, const CFG &cfg, const FixedSyms &fixedSyms) {
+    Problem p(f, fixedSyms);
+    auto res = symir::DataflowSolver<State>::solve(f, cfg, p);
+    dead_.resize(cfg.blocks.size());
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) {
+      p.record(f.blocks[b], res.in[b], sites_);
+      for (std::size_t s: cfg.succ[b])
+        if (!p.edge(f.blocks[b], cfg.blocks[s], res.out[b]).reachable)
+          dead_[b].push_back(s);
+    }
+  }
+
+  bool IntervalAnalysis::feasible(std::size_t from, std::size_t to) const {
+    const auto &d = dead_[from];
+    return std::find(d.begin(), d.end(), to) == d.end();
+  }
+
+} // namespace symir
@@ -0,0 +1,195 @@
+#include "analysis/liveness.hpp"
+
+namespace symir {
+
+  namespace {
+
+    // Collects the locals a block reads before assigning them (gen) and
+    // the locals it assigns as a whole (kill), walking it front to back.
+    struct UseDef {
+      const std::unordered_map<Symbol, std::size_t> &index;
+      BitVector &gen;
+      BitVector &kill;
+      BitVector *addressed; // set while collecting `addr` operands
+
+      void use(const Symbol &name) {
+        auto it = index.find(name);
+        if (it != index.end() && !kill.test(it->second))
+          gen.set(it->second);
+      }
+
+      void def(const Symbol &name) {
+        auto it = index.find(name);
+        if (it != index.end())
+          kill.set(it->second);
+      }
+
+      void id(const LocalOrSymId &lsid) {
+        if (auto lid = std::get_if<LocalId>(&lsid))
+          use(lid->name);
+      }
+
+      void coef(const Coef &c) {
+        if (auto lsid = std::get_if<LocalOrSymId>(&c))
+          id(*lsid);
+      }
+
+      void indexOperand(const Index &i) {
+        if (auto lsid = std::get_if<LocalOrSymId>(&i))
+          id(*lsid);
+      }
+
+      void accesses(const LValue &lv) {
+        for (const auto &acc: lv.accesses)
+          if (auto ai = std::get_if<AccessIndex>(&acc))
+            indexOperand(ai->index);
+      }
+
+      void rvalue(const LValue &lv) {
+        use(lv.base.name);
+        accesses(lv);
+      }
+
+      void selectVal(const SelectVal &sv) {
+        if (auto rv = std::get_if<RValue>(&sv))
+          rvalue(*rv);
+        else
+          coef(std::get<Coef>(sv));
+      }
+
+      void atom(const Atom &a) {
+        std::visit(
+            [&](auto &&arg) {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, OpAtom>) {
+                coef(arg.coef);
+                rvalue(arg.rval);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                if (arg.cond)
+                  cond(*arg.cond);
+                else if (arg.maskExpr)
+                  expr(*arg.maskExpr);
+                selectVal(arg.vtrue);
+                selectVal(arg.vfalse);
+              } else if constexpr (std::is_same_v<T, CmpAtom>) {
+                selectVal(arg.lhs);
+                selectVal(arg.rhs);
+              } else if constexpr (std::is_same_v<T, CoefAtom>) {
+                coef(arg.coef);
+              } else if constexpr (std::is_same_v<T, CastAtom>) {
+                if (auto lv = std::get_if<LValue>(&arg.src))
+                  rvalue(*lv);
+              } else if constexpr (std::is_same_v<T, AddrAtom>) {
+                // The address is not a read, but the storage may be read
+                // through it from here on.
+                accesses(arg.lv);
+                if (auto it = index.find(arg.lv.base.name); it != index.end())
+                  addressed->set(it->second);
+              } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
+                rvalue(arg.rval);
+                indexOperand(arg.index);
+              } else if constexpr (std::is_same_v<T, RValueAtom> || std::is_same_v<T, UnaryAtom> ||
+                                   std::is_same_v<T, LoadAtom> ||
+                                   std::is_same_v<T, PtrFieldAtom>) {
+                rvalue(arg.rval);
+              }
+            },
+            a.v
+        );
+      }
+
+      void expr(const Expr &e) {
+        atom(e.first);
+        for (const auto &t: e.rest)
+          atom(t.atom);
+      }
+
+      void cond(const Cond &c) {
+        expr(c.lhs);
+        expr(c.rhs);
+      }
+
+      void block(const Block &b) {
+        for (const auto &ins: b.instrs) {
+          std::visit(
+              [&](auto &&arg) {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, AssignInstr>) {
+                  expr(arg.rhs);
+                  accesses(arg.lhs);
+                  if (arg.lhs.accesses.empty())
+                    def(arg.lhs.base.name);
+                } else if constexpr (std::is_same_v<T, AssumeInstr> ||
+                                     std::is_same_v<T, RequireInstr>) {
+                  cond(arg.cond);
+                } else if constexpr (std::is_same_v<T, StoreInstr>) {
+                  expr(arg.ptr);
+                  expr(arg.val);
+                }
+              },
+              ins
+          );
+        }
+        std::visit(
+            [&](auto &&t) {
+              using T = std::decay_t<decltype(t)>;
+              if constexpr (std::is_same_v<T, BrTerm>) {
+                if (t.isConditional && t.cond)
+                  cond(*t.cond);
+              } else if constexpr (std::is_same_v<T, RetTerm>) {
+                if (t.value)
+                  expr(*t.value);
+              }
+            },
+            b.term
+        );
+      }
+    };
+
+  } // namespace
+
+  Liveness::Liveness(const FunDecl &f, const CFG &cfg) {
+    for (std::size_t k = 0; k < f.lets.size(); ++k)
+      index_.emplace(f.lets[k].name.name, k);
+    for (std::size_t k = 0; k < f.params.size(); ++k)
+      index_.emplace(f.params[k].name.name, f.lets.size() + k);
+    numSlots_ = f.lets.size() + f.params.size();
+
+    std::size_t numBlocks = f.blocks.size();
+    std::vector<BitVector> gen(numBlocks, BitVector(numSlots_));
+    std::vector<BitVector> kill(numBlocks, BitVector(numSlots_));
+    BitVector addressed(numSlots_);
+    {
+      // Initializers run before the entry block; only their `addr` matters.
+      BitVector uses(numSlots_), defs(numSlots_);
+      UseDef ud{index_, uses, defs, &addressed};
+      for (const auto &l: f.lets)
+        if (l.init && l.init->kind == InitVal::Kind::Atom)
+          if (const auto &a = std::get<AtomPtr>(l.init->value))
+            ud.atom(*a);
+    }
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+      UseDef ud{index_, gen[b], kill[b], &addressed};
+      ud.block(f.blocks[b]);
+    }
+    // Addressed lets are read by any load or store, so no block kills them.
+    if (addressed.any())
+      for (std::size_t b = 0; b < numBlocks; ++b) {
+        gen[b].unionWith(addressed);
+        kill[b].subtract(addressed);
+      }
+
+    Problem p(f, gen, kill, numSlots_);
+    auto res = symir::DataflowSolver<BitVector>::solve(f, cfg, p);
+    in_ = std::move(res.in);
+    out_ = std::move(res.out);
+    addressed_ = std::move(addressed);
+  }
+
+  void Liveness::Problem::transferInto(const Block &block, BitVector &state) {
+    std::size_t b = &block - f_.blocks.data();
+    state.subtract(kill_[b]);
+    state.unionWith(gen_[b]);
+  }
+
+} // namespace symir
@@ -0,0 +1,124 @@
+#include "analysis/loops.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace symir {
+
+  DomTree::DomTree(std::vector<std::size_t> idomIn, std::size_t rootIn) :
+      root(rootIn), idom(std::move(idomIn)) {
+    const std::size_t n = std::max(idom.size(), root + 1);
+    children.assign(n, {});
+    pre.assign(n, npos);
+    post.assign(n, npos);
+    depth.assign(n, npos);
+    for (std::size_t b = 0; b < idom.size(); ++b)
+      if (b != root && idom[b] < n)
+        children[idom[b]].push_back(b);
+
+    // Iterative walk; `next` is the child of each open node to visit next.
+    std::size_t counter = 0;
+    std::vector<std::pair<std::size_t, std::size_t>> stack{{root, 0}};
+    pre[root] = counter++;
+    depth[root] = 0;
+    while (!stack.empty()) {
+      auto &[node, next] = stack.back();
+      if (next == children[node].size()) {
+        post[node] = counter++;
+        stack.pop_back();
+        continue;
+      }
+      std::size_t c = children[node][next++];
+      pre[c] = counter++;
+      depth[c] = depth[node] + 1;
+      stack.emplace_back(c, 0);
+    }
+  }
+
+  LoopNest LoopNest::build(const CFG &cfg, const DomTree &dom) {
+    const std::size_t n = cfg.blocks.size();
+    LoopNest nest;
+    nest.innermost.assign(n, npos);
+    nest.edgeKind.resize(n);
+    for (std::size_t b = 0; b < n; ++b)
+      nest.edgeKind[b].assign(cfg.succ[b].size(), EdgeKind::Cross);
+    if (n == 0)
+      return nest;
+
+    // Depth-first walk from the entry, iterative so that long chains of
+    // blocks do not exhaust the stack.
+    std::vector<std::size_t> pre(n, npos);
+    std::vector<char> onStack(n, 0);
+    std::vector<std::pair<std::size_t, std::size_t>> stack{{cfg.entry, 0}};
+    std::size_t counter = 0;
+    pre[cfg.entry] = counter++;
+    onStack[cfg.entry] = 1;
+    std::vector<std::pair<std::size_t, std::size_t>> backEdges; // (latch, header)
+    while (!stack.empty()) {
+      auto &[u, k] = stack.back();
+      if (k == cfg.succ[u].size()) {
+        onStack[u] = 0;
+        stack.pop_back();
+        continue;
+      }
+      std::size_t slot = k++;
+      std::size_t v = cfg.succ[u][slot];
+      EdgeKind &kind = nest.edgeKind[u][slot];
+      if (pre[v] == npos) {
+        kind = EdgeKind::Tree;
+        pre[v] = counter++;
+        onStack[v] = 1;
+        stack.emplace_back(v, 0);
+      } else if (onStack[v]) {
+        kind = EdgeKind::Back;
+        backEdges.emplace_back(u, v);
+      } else {
+        kind = pre[v] > pre[u] ? EdgeKind::Forward : EdgeKind::Cross;
+      }
+    }
+
+    // One natural loop per header, its body found backward from the latches.
+    std::vector<std::size_t> loopOf(n, npos); // by header
+    for (auto [latch, header]: backEdges) {
+      if (!dom.dominates(header, latch)) {
+        nest.reducible = false;
+        continue;
+      }
+      if (loopOf[header] == npos) {
+        loopOf[header] = nest.loops.size();
+        Loop loop;
+        loop.header = header;
+        loop.blocks = BitVector(n);
+        loop.blocks.set(header);
+        nest.loops.push_back(std::move(loop));
+      }
+      Loop &loop = nest.loops[loopOf[header]];
+      loop.latches.push_back(latch);
+      std::vector<std::size_t> todo{latch};
+      while (!todo.empty()) {
+        std::size_t b = todo.back();
+        todo.pop_back();
+        if (loop.blocks.test(b))
+          continue;
+        loop.blocks.set(b);
+        for (std::size_t p: cfg.pred[b])
+          if (pre[p] != npos)
+            todo.push_back(p);
+      }
+    }
+
+    // Natural loops with distinct headers are nested or disjoint, so the
+    // loops around a header, larger first, run from outermost to innermost.
+    std::stable_sort(nest.loops.begin(), nest.loops.end(), [](const Loop &a, const Loop &b) {
+      return a.blocks.count() > b.blocks.count();
+    });
+    for (std::size_t i = 0; i < nest.loops.size(); ++i) {
+      Loop &loop = nest.loops[i];
+      loop.parent = nest.innermost[loop.header];
+      if (loop.parent != npos)
+        loop.depth = nest.loops[loop.parent].depth + 1;
+      loop.blocks.forEach([&](std::size_t b) { nest.innermost[b] = i; });
+    }
+    return nest;
+  }
+
+} // namespace symir
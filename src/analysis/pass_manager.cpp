@@ -1,20 +1,68 @@
 #include "analysis/pass_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include "timing.hpp"
 
 namespace symir {
 
+  void forEachFunction(
+      std::size_t n, unsigned threads, DiagBag &diags,
+      const std::function<void(std::size_t, DiagBag &)> &fn
+  ) {
+    threads = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), n));
+    if (threads <= 1) {
+      for (std::size_t i = 0; i < n; ++i)
+        fn(i, diags);
+      return;
+    }
+
+    std::vector<DiagBag> bags(n);
+    std::vector<std::exception_ptr> errors(n);
+    std::atomic<std::size_t> next{0};
+    std::string path = timing::currentPath();
+    SymbolTable &symbols = SymbolTable::current();
+    auto worker = [&] {
+      timing::Inherit inherit(path);
+      SymbolTable::Scope scope(symbols);
+      for (std::size_t i; (i = next.fetch_add(1)) < n;) {
+        try {
+          fn(i, bags[i]);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+      pool.emplace_back(worker);
+    worker();
+    for (auto &t: pool)
+      t.join();
+
+    for (std::size_t i = 0; i < n; ++i) {
+      diags.merge(std::move(bags[i]));
+      if (errors[i])
+        std::rethrow_exception(errors[i]);
+    }
+  }
+
   class FunctionPassWrapper : public ModulePass {
   public:
     explicit FunctionPassWrapper(std::unique_ptr<FunctionPass> pass) : pass_(std::move(pass)) {}
 
     std::string name() const override { return pass_->name(); }
 
-    PassResult run(Program &prog, DiagBag &diags) override {
-      bool failed = false;
-      for (auto &f: prog.funs) {
-        if (pass_->run(f, diags) == PassResult::Error) {
+    PassResult run(Program &prog, DiagBag &diags, AnalysisManager &am) override {
+      std::atomic<bool> failed{false};
+      forEachFunction(prog.funs.size(), numThreads(), diags, [&](std::size_t i, DiagBag &bag) {
+        FunDecl &f = prog.funs[i];
+        if (pass_->run(f, bag, am) == PassResult::Error)
           failed = true;
-        }
-      }
+        if (!pass_->preservesAnalyses())
+          am.invalidate(f);
+      });
       return failed ? PassResult::Error : PassResult::Success;
     }
 
@@ -26,9 +74,29 @@ namespace symir {
     addModulePass(std::make_unique<FunctionPassWrapper>(std::move(pass)));
   }
 
+  void PassManager::setNumThreads(unsigned n) {
+    numThreads_ = n ? n : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::string PassManager::pipeline() const {
+    std::string names;
+    for (const auto &pass: modulePasses_) {
+      if (!names.empty())
+        names += ',';
+      names += pass->name();
+    }
+    return names;
+  }
+
   PassResult PassManager::run(Program &prog) {
     for (auto &pass: modulePasses_) {
-      if (pass->run(prog, diags_) == PassResult::Error) {
+      pass->numThreads_ = numThreads_;
+      std::string name = timing::enabled() ? pass->name() : std::string();
+      timing::Scope scope(name.c_str());
+      PassResult r = pass->run(prog, diags_, *am_);
+      if (!pass->preservesAnalyses())
+        am_->clear();
+      if (r == PassResult::Error) {
         return PassResult::Error;
       }
     }
@@ -0,0 +1,250 @@
+#include "analysis/points_to.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace symir {
+
+  namespace {
+
+    using Targets = PointsToAnalysis::Targets;
+
+    Targets anyTarget() {
+      Targets t;
+      t.any = true;
+      return t;
+    }
+
+    // Abstract evaluation of expressions against one state. Loads are read
+    // through the targets of their operand; everything that is not a
+    // pointer evaluates to the empty set.
+    struct Evaluator {
+      std::vector<Targets> &state;
+      const std::unordered_map<std::string, std::size_t> &index;
+      std::size_t numLets;
+      std::unordered_map<const void *, Targets> *sites;
+
+      Targets local(const std::string &name) const {
+        auto it = index.find(name);
+        return it == index.end() ? anyTarget() : state[it->second];
+      }
+
+      // Everything the pointers stored in the lets of `t` may address.
+      Targets deref(const Targets &t) const {
+        if (t.any)
+          return anyTarget();
+        Targets r;
+        for (std::size_t k: t.lets)
+          r.add(state[k]);
+        return r;
+      }
+
+      void note(const void *site, const Targets &t) const {
+        if (sites)
+          (*sites)[site].add(t);
+      }
+
+      Targets coef(const Coef &c) const {
+        if (auto lsid = std::get_if<LocalOrSymId>(&c))
+          if (auto lid = std::get_if<LocalId>(lsid))
+            return local(lid->name);
+        return {}; // literals, null and (non-pointer) symbols
+      }
+
+      Targets atom(const Atom &a) {
+        return std::visit(
+            [&](auto &&arg) -> Targets {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, AddrAtom>) {
+                auto it = index.find(arg.lv.base.name);
+                if (it == index.end() || it->second >= numLets)
+                  return anyTarget();
+                Targets t;
+                t.lets.push_back(it->second);
+                return t;
+              } else if constexpr (std::is_same_v<T, LoadAtom>) {
+                Targets ptr = local(arg.rval.base.name);
+                note(&arg, ptr);
+                return deref(ptr);
+              } else if constexpr (std::is_same_v<T, RValueAtom> ||
+                                   std::is_same_v<T, PtrIndexAtom> ||
+                                   std::is_same_v<T, PtrFieldAtom>) {
+                return local(arg.rval.base.name);
+              } else if constexpr (std::is_same_v<T, CoefAtom>) {
+                return coef(arg.coef);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                if (arg.cond)
+                  cond(*arg.cond);
+                else if (arg.maskExpr)
+                  expr(*arg.maskExpr);
+                Targets t = selectVal(arg.vtrue);
+                t.add(selectVal(arg.vfalse));
+                return t;
+              } else {
+                return {}; // op, unary, cast and cmp never yield pointers
+              }
+            },
+            a.v
+        );
+      }
+
+      Targets selectVal(const SelectVal &sv) const {
+        if (auto rv = std::get_if<RValue>(&sv))
+          return local(rv->base.name);
+        return coef(std::get<Coef>(sv));
+      }
+
+      // Pointer arithmetic keeps the object of the leading pointer.
+      Targets expr(const Expr &e) {
+        Targets t = atom(e.first);
+        for (const auto &tail: e.rest)
+          atom(tail.atom);
+        return t;
+      }
+
+      void cond(const Cond &c) {
+        expr(c.lhs);
+        expr(c.rhs);
+      }
+
+      Targets init(const InitVal &iv) {
+        switch (iv.kind) {
+          case InitVal::Kind::Local:
+            return local(std::get<LocalId>(iv.value).name);
+          case InitVal::Kind::Undef:
+            return anyTarget();
+          case InitVal::Kind::Atom:
+            return atom(*std::get<AtomPtr>(iv.value));
+          case InitVal::Kind::Aggregate: {
+            Targets t;
+            for (const auto &elem: std::get<std::vector<InitValPtr>>(iv.value))
+              if (elem)
+                t.add(init(*elem));
+            return t;
+          }
+          default:
+            return {};
+        }
+      }
+    };
+
+  } // namespace
+
+  void PointsToAnalysis::Targets::add(const Targets &other) {
+    if (any || other.any) {
+      any = true;
+      lets.clear();
+      return;
+    }
+    std::vector<std::size_t> merged;
+    merged.reserve(lets.size() + other.lets.size());
+    std::set_union(
+        lets.begin(), lets.end(), other.lets.begin(), other.lets.end(), std::back_inserter(merged)
+    );
+    lets = std::move(merged);
+  }
+
+  PointsToAnalysis::PointsToAnalysis(const FunDecl &f, const CFG &cfg) {
+    Problem p(f);
+    auto res = symir::DataflowSolver<State>::solve(f, cfg, p);
+    for (std::size_t b: cfg.rpo())
+      p.record(f.blocks[b], res.in[b], sites_);
+  }
+
+  PointsToAnalysis::Problem::Problem(const FunDecl &f) : f_(f) {
+    for (std::size_t k = 0; k < f.lets.size(); ++k)
+      index_.emplace(f.lets[k].name.name, k);
+    for (std::size_t k = 0; k < f.params.size(); ++k)
+      index_.emplace(f.params[k].name.name, f.lets.size() + k);
+  }
+
+  PointsToAnalysis::State PointsToAnalysis::Problem::bottom() {
+    return State(f_.lets.size() + f_.params.size());
+  }
+
+  PointsToAnalysis::State PointsToAnalysis::Problem::entryState() {
+    State s = bottom();
+    for (std::size_t k = 0; k < f_.params.size(); ++k)
+      if (f_.params[k].type && std::holds_alternative<PtrType>(f_.params[k].type->v))
+        s[f_.lets.size() + k] = anyTarget();
+    // Initializers run in declaration order and may read earlier lets.
+    Evaluator ev{s, index_, f_.lets.size(), nullptr};
+    for (std::size_t k = 0; k < f_.lets.size(); ++k)
+      if (f_.lets[k].init)
+        s[k] = ev.init(*f_.lets[k].init);
+    return s;
+  }
+
+  PointsToAnalysis::State PointsToAnalysis::Problem::meet(const State &lhs, const State &rhs) {
+    State r = lhs;
+    for (std::size_t k = 0; k < r.size(); ++k)
+      r[k].add(rhs[k]);
+    return r;
+  }
+
+  bool PointsToAnalysis::Problem::equal(const State &lhs, const State &rhs) { return lhs == rhs; }
+
+  PointsToAnalysis::State PointsToAnalysis::Problem::transfer(const Block &b, const State &in) {
+    return run(b, in, nullptr);
+  }
+
+  void PointsToAnalysis::Problem::record(const Block &b, const State &in, Sites &sites) {
+    run(b, in, &sites);
+  }
+
+  PointsToAnalysis::State
+  PointsToAnalysis::Problem::run(const Block &b, const State &in, Sites *sites) {
+    State state = in;
+    Evaluator ev{state, index_, f_.lets.size(), sites};
+
+    for (const auto &ins: b.instrs) {
+      std::visit(
+          [&](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, AssignInstr>) {
+              Targets v = ev.expr(arg.rhs);
+              auto it = index_.find(arg.lhs.base.name);
+              if (it == index_.end())
+                return;
+              // Writing a whole local replaces what it held; writing one
+              // element or field only adds to the summary.
+              if (arg.lhs.accesses.empty())
+                state[it->second] = std::move(v);
+              else
+                state[it->second].add(v);
+            } else if constexpr (std::is_same_v<T, AssumeInstr> ||
+                                 std::is_same_v<T, RequireInstr>) {
+              ev.cond(arg.cond);
+            } else if constexpr (std::is_same_v<T, StoreInstr>) {
+              Targets ptr = ev.expr(arg.ptr);
+              ev.note(&arg, ptr);
+              Targets v = ev.expr(arg.val);
+              if (ptr.any) {
+                for (std::size_t k = 0; k < f_.lets.size(); ++k)
+                  state[k].add(v);
+              } else {
+                for (std::size_t k: ptr.lets)
+                  state[k].add(v);
+              }
+            }
+          },
+          ins
+      );
+    }
+
+    std::visit(
+        [&](auto &&term) {
+          using T = std::decay_t<decltype(term)>;
+          if constexpr (std::is_same_v<T, BrTerm>) {
+            if (term.cond)
+              ev.cond(*term.cond);
+          } else if constexpr (std::is_same_v<T, RetTerm>) {
+            if (term.value)
+              ev.expr(*term.value);
+          }
+        },
+        b.term
+    );
+    return state;
+  }
+
+} // namespace symir
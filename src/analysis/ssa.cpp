@@ -0,0 +1,176 @@
+#include "analysis/ssa.hpp"
+#include <algorithm>
+
+namespace symir {
+
+  SSAForm::SSAForm(
+      const FunDecl &f, const CFG &cfg, const std::vector<std::size_t> &idom, const Liveness &live
+  ) {
+    std::size_t numSlots = live.numSlots();
+    std::size_t numBlocks = cfg.blocks.size();
+    names_.resize(numSlots);
+    isVar_.assign(numSlots, 0);
+    auto track = [&](std::size_t k, const Symbol &name, const TypePtr &t) {
+      names_[k] = name;
+      bool scalar = std::holds_alternative<IntType>(t->v) ||
+                    std::holds_alternative<FloatType>(t->v) ||
+                    std::holds_alternative<PtrType>(t->v);
+      // A param shadowed by a let of the same name has no slot of its own.
+      isVar_[k] = scalar && live.slot(name) == k && !live.isAddressed(k);
+    };
+    for (std::size_t k = 0; k < f.lets.size(); ++k)
+      track(k, f.lets[k].name.name, f.lets[k].type);
+    for (std::size_t k = 0; k < f.params.size(); ++k)
+      track(f.lets.size() + k, f.params[k].name.name, f.params[k].type);
+
+    phis_.resize(numBlocks);
+    defs_.resize(numBlocks);
+    in_.resize(numBlocks);
+    entry_.assign(numSlots, npos);
+    std::vector<std::uint32_t> nextVersion(numSlots, 0);
+    for (std::size_t v = 0; v < numSlots; ++v) {
+      if (!isVar_[v])
+        continue;
+      entry_[v] = values_.size();
+      values_.push_back(Value{v, npos, npos, nextVersion[v]++});
+    }
+    if (numBlocks == 0)
+      return;
+
+    auto reachable = [&](std::size_t b) { return idom[b] != SIZE_MAX; };
+
+    // Dominance frontiers (Cooper-Harvey-Kennedy). The function's start
+    // dominates the entry block, so a back edge to the entry puts the
+    // entry in its own frontier.
+    std::vector<std::vector<std::size_t>> frontier(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+      if (!reachable(b))
+        continue;
+      bool join = b == cfg.entry ? !cfg.pred[b].empty() : cfg.pred[b].size() > 1;
+      if (!join)
+        continue;
+      for (std::size_t p: cfg.pred[b]) {
+        if (!reachable(p))
+          continue;
+        for (std::size_t runner = p;; runner = idom[runner]) {
+          if (b != cfg.entry && runner == idom[b])
+            break;
+          auto &df = frontier[runner];
+          if (std::find(df.begin(), df.end(), b) == df.end())
+            df.push_back(b);
+          if (runner == cfg.entry)
+            break;
+        }
+      }
+    }
+
+    // Phis on the iterated frontier of each variable's definitions, where
+    // the variable is live.
+    std::vector<std::vector<std::size_t>> defBlocks(numSlots);
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+      if (!reachable(b))
+        continue;
+      defs_[b].assign(f.blocks[b].instrs.size(), npos);
+      for (const auto &ins: f.blocks[b].instrs)
+        if (auto *as = std::get_if<AssignInstr>(&ins); as && as->lhs.accesses.empty()) {
+          std::size_t v = live.slot(as->lhs.base.name);
+          if (isVar(v) && (defBlocks[v].empty() || defBlocks[v].back() != b))
+            defBlocks[v].push_back(b);
+        }
+    }
+    std::vector<std::size_t> hasPhi(numBlocks, npos), queued(numBlocks, npos);
+    for (std::size_t v = 0; v < numSlots; ++v) {
+      if (!isVar_[v])
+        continue;
+      std::vector<std::size_t> work = defBlocks[v];
+      for (std::size_t b: work)
+        queued[b] = v;
+      while (!work.empty()) {
+        std::size_t x = work.back();
+        work.pop_back();
+        for (std::size_t d: frontier[x]) {
+          if (hasPhi[d] == v || !live.liveIn(d).test(v))
+            continue;
+          hasPhi[d] = v;
+          phis_[d].push_back(Phi{values_.size(), std::vector<std::size_t>(cfg.pred[d].size(), npos)});
+          values_.push_back(Value{v, d, npos, 0});
+          if (queued[d] != v) {
+            queued[d] = v;
+            work.push_back(d);
+          }
+        }
+      }
+    }
+
+    // Rename along the dominator tree, keeping the current value of each
+    // variable on a stack.
+    std::vector<std::vector<std::size_t>> children(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; ++b)
+      if (reachable(b) && b != cfg.entry)
+        children[idom[b]].push_back(b);
+    std::vector<std::vector<std::size_t>> current(numSlots);
+    for (std::size_t v = 0; v < numSlots; ++v)
+      if (isVar_[v])
+        current[v].push_back(entry_[v]);
+    for (auto &phi: phis_[cfg.entry])
+      phi.onEntry = entry_[values_[phi.value].var];
+
+    struct Frame {
+      std::size_t block;
+      std::vector<std::size_t> pushed; // vars, in push order
+      std::size_t nextChild = 0;
+    };
+    std::vector<Frame> stack;
+    auto enter = [&](std::size_t b) {
+      Frame fr{b, {}, 0};
+      auto push = [&](std::size_t value) {
+        Value &val = values_[value];
+        val.version = nextVersion[val.var]++;
+        current[val.var].push_back(value);
+        fr.pushed.push_back(val.var);
+      };
+      for (const auto &phi: phis_[b])
+        push(phi.value);
+      in_[b].resize(numSlots, npos);
+      for (std::size_t v = 0; v < numSlots; ++v)
+        if (isVar_[v])
+          in_[b][v] = current[v].back();
+      const auto &instrs = f.blocks[b].instrs;
+      for (std::size_t i = 0; i < instrs.size(); ++i) {
+        auto *as = std::get_if<AssignInstr>(&instrs[i]);
+        if (!as || !as->lhs.accesses.empty())
+          continue;
+        std::size_t v = live.slot(as->lhs.base.name);
+        if (!isVar(v))
+          continue;
+        defs_[b][i] = values_.size();
+        values_.push_back(Value{v, b, i, 0});
+        push(defs_[b][i]);
+      }
+      for (std::size_t s: cfg.succ[b])
+        for (auto &phi: phis_[s])
+          for (std::size_t k = 0; k < cfg.pred[s].size(); ++k)
+            if (cfg.pred[s][k] == b)
+              phi.incoming[k] = current[values_[phi.value].var].back();
+      stack.push_back(std::move(fr));
+    };
+    enter(cfg.entry);
+    while (!stack.empty()) {
+      Frame &top = stack.back();
+      const auto &kids = children[top.block];
+      if (top.nextChild < kids.size()) {
+        enter(kids[top.nextChild++]);
+        continue;
+      }
+      for (auto it = top.pushed.rbegin(); it != top.pushed.rend(); ++it)
+        current[*it].pop_back();
+      stack.pop_back();
+    }
+  }
+
+  std::string SSAForm::name(std::size_t value) const {
+    const Value &v = values_[value];
+    return names_[v.var].str() + "." + std::to_string(v.version);
+  }
+
+} // namespace symir
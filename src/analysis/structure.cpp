@@ -0,0 +1,40 @@
+#include "analysis/structure.hpp"
+
+namespace symir {
+
+  bool StructuredCfg::isReducible(const CFG &cfg, const std::vector<std::size_t> &idom) {
+    return LoopNest::build(cfg, DomTree(idom, cfg.entry)).reducible;
+  }
+
+  std::optional<StructuredCfg> StructuredCfg::build(
+      const FunDecl &f, const CFG &cfg, const std::vector<std::size_t> &idom
+  ) {
+    LoopNest loops = LoopNest::build(cfg, DomTree(idom, cfg.entry));
+    if (!loops.reducible)
+      return std::nullopt;
+    StructuredCfg sc;
+    sc.f = &f;
+    sc.cfg = &cfg;
+    std::vector<std::size_t> order = cfg.rpo();
+    const std::size_t n = cfg.blocks.size();
+    sc.number.assign(n, SIZE_MAX);
+    for (std::size_t i = 0; i < order.size(); ++i)
+      sc.number[order[i]] = i;
+    sc.isLoopHeader.assign(n, false);
+    sc.isMerge.assign(n, false);
+    for (std::size_t b: order) {
+      sc.isLoopHeader[b] = loops.isHeader(b);
+      std::size_t forwardPreds = 0;
+      for (std::size_t p: cfg.pred[b])
+        if (sc.number[p] != SIZE_MAX && sc.number[p] < sc.number[b])
+          ++forwardPreds;
+      sc.isMerge[b] = forwardPreds >= 2;
+    }
+    sc.mergeChildren.assign(n, {});
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+      if (*it != cfg.entry && sc.isMerge[*it])
+        sc.mergeChildren[idom[*it]].push_back(*it);
+    return sc;
+  }
+
+} // namespace symir
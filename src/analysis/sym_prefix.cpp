@@ -0,0 +1,196 @@
+#include "analysis/sym_prefix.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace symir {
+
+  namespace {
+
+    // Whether a construct names one of `deps`, and whether it names a
+    // local, in any position.
+    struct Names {
+      const std::unordered_set<Symbol> &deps;
+      bool found = false;
+      bool local = false;
+
+      void name(const Symbol &s) {
+        if (deps.count(s))
+          found = true;
+      }
+
+      void id(const LocalOrSymId &lsid) {
+        local |= std::holds_alternative<LocalId>(lsid);
+        std::visit([&](auto &&i) { name(i.name); }, lsid);
+      }
+
+      void coef(const Coef &c) {
+        if (auto lsid = std::get_if<LocalOrSymId>(&c))
+          id(*lsid);
+      }
+
+      void indexOperand(const Index &i) {
+        if (auto lsid = std::get_if<LocalOrSymId>(&i))
+          id(*lsid);
+      }
+
+      void lvalue(const LValue &lv) {
+        local = true;
+        name(lv.base.name);
+        for (const auto &acc: lv.accesses)
+          if (auto ai = std::get_if<AccessIndex>(&acc))
+            indexOperand(ai->index);
+      }
+
+      void selectVal(const SelectVal &sv) {
+        if (auto rv = std::get_if<RValue>(&sv))
+          lvalue(*rv);
+        else
+          coef(std::get<Coef>(sv));
+      }
+
+      void atom(const Atom &a) {
+        std::visit(
+            [&](auto &&arg) {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, OpAtom>) {
+                coef(arg.coef);
+                lvalue(arg.rval);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                if (arg.cond)
+                  cond(*arg.cond);
+                else if (arg.maskExpr)
+                  expr(*arg.maskExpr);
+                selectVal(arg.vtrue);
+                selectVal(arg.vfalse);
+              } else if constexpr (std::is_same_v<T, CmpAtom>) {
+                selectVal(arg.lhs);
+                selectVal(arg.rhs);
+              } else if constexpr (std::is_same_v<T, CoefAtom>) {
+                coef(arg.coef);
+              } else if constexpr (std::is_same_v<T, CastAtom>) {
+                if (auto lv = std::get_if<LValue>(&arg.src))
+                  lvalue(*lv);
+                else if (auto sid = std::get_if<SymId>(&arg.src))
+                  name(sid->name);
+              } else if constexpr (std::is_same_v<T, AddrAtom>) {
+                lvalue(arg.lv);
+              } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
+                lvalue(arg.rval);
+                indexOperand(arg.index);
+              } else if constexpr (std::is_same_v<T, RValueAtom> || std::is_same_v<T, UnaryAtom> ||
+                                   std::is_same_v<T, LoadAtom> ||
+                                   std::is_same_v<T, PtrFieldAtom>) {
+                lvalue(arg.rval);
+              }
+            },
+            a.v
+        );
+      }
+
+      void expr(const Expr &e) {
+        atom(e.first);
+        for (const auto &t: e.rest)
+          atom(t.atom);
+      }
+
+      void cond(const Cond &c) {
+        expr(c.lhs);
+        expr(c.rhs);
+      }
+
+      void init(const InitVal &iv) {
+        switch (iv.kind) {
+          case InitVal::Kind::Sym:
+            name(std::get<SymId>(iv.value).name);
+            break;
+          case InitVal::Kind::Local:
+            local = true;
+            name(std::get<LocalId>(iv.value).name);
+            break;
+          case InitVal::Kind::Aggregate:
+            for (const auto &elem: std::get<std::vector<InitValPtr>>(iv.value))
+              if (elem)
+                init(*elem);
+            break;
+          case InitVal::Kind::Atom:
+            if (const auto &a = std::get<AtomPtr>(iv.value))
+              atom(*a);
+            break;
+          default:
+            break;
+        }
+      }
+
+      void block(const Block &b) {
+        for (const auto &ins: b.instrs) {
+          std::visit(
+              [&](auto &&arg) {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, AssignInstr>) {
+                  expr(arg.rhs);
+                  lvalue(arg.lhs);
+                } else if constexpr (std::is_same_v<T, AssumeInstr> ||
+                                     std::is_same_v<T, RequireInstr>) {
+                  cond(arg.cond);
+                } else if constexpr (std::is_same_v<T, StoreInstr>) {
+                  expr(arg.ptr);
+                  expr(arg.val);
+                }
+              },
+              ins
+          );
+        }
+        std::visit(
+            [&](auto &&t) {
+              using T = std::decay_t<decltype(t)>;
+              if constexpr (std::is_same_v<T, BrTerm>) {
+                if (t.isConditional && t.cond)
+                  cond(*t.cond);
+              } else {
+                // The run ends here; a prefix that returned would leave
+                // nothing to resume.
+                found = true;
+              }
+            },
+            b.term
+        );
+      }
+    };
+
+  } // namespace
+
+  SymPrefix::SymPrefix(const FunDecl &f)
+      : deferred_(f.lets.size(), 0), ends_(f.blocks.size(), 1) {
+    std::unordered_set<Symbol> deps;
+    for (const auto &s: f.syms)
+      deps.insert(s.name.name);
+    // Params are bound by the caller, which the prefix does not know.
+    for (const auto &p: f.params)
+      deps.insert(p.name.name);
+
+    numLets_ = f.lets.size();
+    for (std::size_t k = 0; k < f.lets.size(); ++k) {
+      const LetDecl &l = f.lets[k];
+      Names n{deps};
+      if (l.init)
+        n.init(*l.init);
+      if (!n.found)
+        continue;
+      deps.insert(l.name.name);
+      // Naming no local, it takes no address, loads nothing and reads
+      // nothing the prefix assigns, so it may be bound after the prefix.
+      if (!n.local)
+        deferred_[k] = 1;
+      else
+        numLets_ = std::min(numLets_, k);
+    }
+    if (numLets_ < f.lets.size())
+      return;
+    for (std::size_t b = 0; b < f.blocks.size(); ++b) {
+      Names n{deps};
+      n.block(f.blocks[b]);
+      ends_[b] = n.found;
+    }
+  }
+
+} // namespace symir
@@ -0,0 +1,1829 @@
+#include "analysis/transforms.hpp"
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include "analysis/dataflow.hpp"
+#include "analysis/type_utils.hpp"
+#include "ast/type_table.hpp"
+
+namespace symir {
+
+  namespace {
+
+    using Wide = __int128;
+
+    // Calls fn(LocalId &) on every local a node reads. The operand of
+    // `addr` is not read; only the locals in its indices are.
+    template<typename Fn>
+    struct Reads {
+      Fn &fn;
+
+      void id(LocalOrSymId &lsid) {
+        if (auto *lid = std::get_if<LocalId>(&lsid))
+          fn(*lid);
+      }
+
+      void coef(Coef &c) {
+        if (auto *lsid = std::get_if<LocalOrSymId>(&c))
+          id(*lsid);
+      }
+
+      void index(Index &i) {
+        if (auto *lsid = std::get_if<LocalOrSymId>(&i))
+          id(*lsid);
+      }
+
+      void accesses(LValue &lv) {
+        for (auto &acc: lv.accesses)
+          if (auto *ai = std::get_if<AccessIndex>(&acc))
+            index(ai->index);
+      }
+
+      void rvalue(LValue &lv) {
+        fn(lv.base);
+        accesses(lv);
+      }
+
+      void selectVal(SelectVal &sv) {
+        if (auto *rv = std::get_if<RValue>(&sv))
+          rvalue(*rv);
+        else
+          coef(std::get<Coef>(sv));
+      }
+
+      void atom(Atom &a) {
+        std::visit(
+            [&](auto &&arg) {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, OpAtom>) {
+                coef(arg.coef);
+                rvalue(arg.rval);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                if (arg.cond)
+                  cond(*arg.cond);
+                else if (arg.maskExpr)
+                  expr(*arg.maskExpr);
+                selectVal(arg.vtrue);
+                selectVal(arg.vfalse);
+              } else if constexpr (std::is_same_v<T, CmpAtom>) {
+                selectVal(arg.lhs);
+                selectVal(arg.rhs);
+              } else if constexpr (std::is_same_v<T, CoefAtom>) {
+                coef(arg.coef);
+              } else if constexpr (std::is_same_v<T, CastAtom>) {
+                if (auto *lv = std::get_if<LValue>(&arg.src))
+                  rvalue(*lv);
+              } else if constexpr (std::is_same_v<T, AddrAtom>) {
+                accesses(arg.lv);
+              } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
+                rvalue(arg.rval);
+                index(arg.index);
+              } else {
+                rvalue(arg.rval);
+              }
+            },
+            a.v
+        );
+      }
+
+      void expr(Expr &e) {
+        atom(e.first);
+        for (auto &t: e.rest)
+          atom(t.atom);
+      }
+
+      void cond(Cond &c) {
+        expr(c.lhs);
+        expr(c.rhs);
+      }
+
+      void instr(Instr &ins) {
+        std::visit(
+            [&](auto &&arg) {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, AssignInstr>) {
+                expr(arg.rhs);
+                accesses(arg.lhs);
+              } else if constexpr (std::is_same_v<T, StoreInstr>) {
+                expr(arg.ptr);
+                expr(arg.val);
+              } else {
+                cond(arg.cond);
+              }
+            },
+            ins
+        );
+      }
+
+      void term(Terminator &t) {
+        if (auto *br = std::get_if<BrTerm>(&t)) {
+          if (br->isConditional && br->cond)
+            cond(*br->cond);
+        } else if (auto *ret = std::get_if<RetTerm>(&t)) {
+          if (ret->value)
+            expr(*ret->value);
+        }
+      }
+    };
+
+    template<typename Node, typename Fn>
+    void forEachRead(Node &node, Fn &&fn) {
+      Reads<std::remove_reference_t<Fn>> r{fn};
+      if constexpr (std::is_same_v<Node, Instr>)
+        r.instr(node);
+      else if constexpr (std::is_same_v<Node, Terminator>)
+        r.term(node);
+      else if constexpr (std::is_same_v<Node, Cond>)
+        r.cond(node);
+      else if constexpr (std::is_same_v<Node, Atom>)
+        r.atom(node);
+      else
+        r.expr(node);
+    }
+
+    // Calls fn(const Atom &) on every atom of `e`, nested ones included.
+    template<typename Fn>
+    void forEachAtom(const Expr &e, Fn &fn);
+
+    template<typename Fn>
+    void forEachAtom(const Atom &a, Fn &fn) {
+      fn(a);
+      if (auto *sel = std::get_if<SelectAtom>(&a.v)) {
+        if (sel->cond) {
+          forEachAtom(sel->cond->lhs, fn);
+          forEachAtom(sel->cond->rhs, fn);
+        } else if (sel->maskExpr) {
+          forEachAtom(*sel->maskExpr, fn);
+        }
+      }
+    }
+
+    template<typename Fn>
+    void forEachAtom(const Expr &e, Fn &fn) {
+      forEachAtom(e.first, fn);
+      for (const auto &t: e.rest)
+        forEachAtom(t.atom, fn);
+    }
+
+    // The locals whose address is taken somewhere in `f`: they may change
+    // through any store and are never tracked.
+    std::unordered_set<Symbol> addressedLocals(const FunDecl &f) {
+      std::unordered_set<Symbol> out;
+      auto note = [&](const Atom &a) {
+        if (auto *addr = std::get_if<AddrAtom>(&a.v))
+          out.insert(addr->lv.base.name);
+      };
+      auto cond = [&](const Cond &c) {
+        forEachAtom(c.lhs, note);
+        forEachAtom(c.rhs, note);
+      };
+      for (const auto &l: f.lets)
+        if (l.init && l.init->kind == InitVal::Kind::Atom)
+          if (const auto &a = std::get<AtomPtr>(l.init->value))
+            forEachAtom(*a, note);
+      for (const auto &b: f.blocks) {
+        for (const auto &ins: b.instrs) {
+          if (auto *as = std::get_if<AssignInstr>(&ins)) {
+            forEachAtom(as->rhs, note);
+          } else if (auto *st = std::get_if<StoreInstr>(&ins)) {
+            forEachAtom(st->ptr, note);
+            forEachAtom(st->val, note);
+          } else if (auto *am = std::get_if<AssumeInstr>(&ins)) {
+            cond(am->cond);
+          } else {
+            cond(std::get<RequireInstr>(ins).cond);
+          }
+        }
+        if (auto *br = std::get_if<BrTerm>(&b.term)) {
+          if (br->isConditional && br->cond)
+            cond(*br->cond);
+        } else if (auto *ret = std::get_if<RetTerm>(&b.term)) {
+          if (ret->value)
+            forEachAtom(*ret->value, note);
+        }
+      }
+      return out;
+    }
+
+    // Removes the elements of `v` whose flag in `drop` is set.
+    template<typename T>
+    void eraseMarked(std::vector<T> &v, const std::vector<char> &drop) {
+      std::size_t out = 0;
+      for (std::size_t k = 0; k < v.size(); ++k)
+        if (!drop[k]) {
+          if (out != k)
+            v[out] = std::move(v[k]);
+          ++out;
+        }
+      v.erase(v.begin() + static_cast<std::ptrdiff_t>(out), v.end());
+    }
+
+    // The labels a terminator branches to, once per edge.
+    std::vector<Symbol> successors(const Terminator &t) {
+      auto *br = std::get_if<BrTerm>(&t);
+      if (!br)
+        return {};
+      if (br->isConditional)
+        return {br->thenLabel.name, br->elseLabel.name};
+      return {br->dest.name};
+    }
+
+    // Drops the blocks no branch from the entry reaches.
+    void pruneUnreachable(FunDecl &f) {
+      if (f.blocks.empty())
+        return;
+      std::unordered_map<Symbol, std::size_t> indexOf;
+      for (std::size_t k = 0; k < f.blocks.size(); ++k)
+        indexOf.emplace(f.blocks[k].label.name, k);
+      std::vector<char> seen(f.blocks.size(), 0), drop(f.blocks.size(), 1);
+      std::vector<std::size_t> work{0};
+      seen[0] = 1;
+      while (!work.empty()) {
+        std::size_t k = work.back();
+        work.pop_back();
+        for (Symbol s: successors(f.blocks[k].term))
+          if (auto it = indexOf.find(s); it != indexOf.end() && !seen[it->second]) {
+            seen[it->second] = 1;
+            work.push_back(it->second);
+          }
+      }
+      for (std::size_t k = 0; k < seen.size(); ++k)
+        drop[k] = !seen[k];
+      eraseMarked(f.blocks, drop);
+    }
+
+    bool isLiteral(const Atom &a) {
+      auto *ca = std::get_if<CoefAtom>(&a.v);
+      return ca && !std::holds_alternative<LocalOrSymId>(ca->coef);
+    }
+
+    // ---------------------------
+    // Constant propagation
+    // ---------------------------
+
+    /**
+     * The integer scalars of a function that constant propagation tracks,
+     * and the evaluation of expressions over their known values.
+     *
+     * A value is folded only if every step stays in the signed range of
+     * the expression's width, which is the type of the locals it reads;
+     * that is the check the interpreter, the C backend and the solver all
+     * make, so a folded step is one none of them would trap on.
+     */
+    class Folder {
+    public:
+      // Per slot: its constant value, or nullopt when it is not constant.
+      struct State {
+        bool reachable = false;
+        std::vector<std::optional<int64_t>> vals;
+        bool operator==(const State &) const = default;
+      };
+
+      explicit Folder(const FunDecl &f) : f_(f) {
+        auto addressed = addressedLocals(f);
+        auto track = [&](const LocalId &id, const TypePtr &t) {
+          int bits = static_cast<int>(TypeUtils::getBitWidth(t).value_or(0));
+          // i1 is a flag, not a number; leave it alone.
+          if (bits >= 2 && !addressed.count(id.name)) {
+            index_.emplace(id.name, bits_.size());
+            bits_.push_back(bits);
+          }
+        };
+        for (const auto &p: f.params)
+          track(p.name, p.type);
+        for (const auto &l: f.lets)
+          track(l.name, l.type);
+      }
+
+      State bottom() { return State{false, std::vector<std::optional<int64_t>>(bits_.size())}; }
+
+      State entryState() {
+        State s = bottom();
+        s.reachable = true;
+        // Params are unknown; lets start from their initializer, in order.
+        for (const auto &l: f_.lets) {
+          std::size_t k = slot(l.name.name);
+          if (k == SIZE_MAX || !l.init)
+            continue;
+          if (l.init->kind == InitVal::Kind::Int) {
+            int64_t v = std::get<IntLit>(l.init->value).value;
+            if (fits(v, bits_[k]))
+              s.vals[k] = v;
+          } else if (l.init->kind == InitVal::Kind::Local) {
+            std::size_t from = slot(std::get<LocalId>(l.init->value).name);
+            if (from != SIZE_MAX && bits_[from] == bits_[k])
+              s.vals[k] = s.vals[from];
+          }
+        }
+        return s;
+      }
+
+      void meetInto(State &acc, const State &in) {
+        if (!in.reachable)
+          return;
+        if (!acc.reachable) {
+          acc = in;
+          return;
+        }
+        for (std::size_t k = 0; k < acc.vals.size(); ++k)
+          if (acc.vals[k] != in.vals[k])
+            acc.vals[k].reset();
+      }
+
+      void transferInto(const Block &block, State &state) {
+        if (!state.reachable)
+          return;
+        for (const auto &ins: block.instrs)
+          step(ins, state);
+      }
+
+      // A constant branch condition sends nothing down the other edge.
+      State edge(const Block &block, const std::string &to, const State &out) {
+        auto *br = std::get_if<BrTerm>(&block.term);
+        if (!out.reachable || !br || !br->isConditional || !br->cond ||
+            br->thenLabel.name == br->elseLabel.name)
+          return out;
+        auto taken = cond(*br->cond, out);
+        if (!taken || (*taken ? br->thenLabel.name : br->elseLabel.name) == to)
+          return out;
+        return bottom();
+      }
+
+      /// Applies one instruction to `state`.
+      void step(const Instr &ins, State &state) const {
+        auto *as = std::get_if<AssignInstr>(&ins);
+        if (!as || !as->lhs.accesses.empty())
+          return;
+        std::size_t k = slot(as->lhs.base.name);
+        if (k != SIZE_MAX)
+          state.vals[k] = expr(as->rhs, state, bits_[k]);
+      }
+
+      std::size_t slot(Symbol name) const {
+        auto it = index_.find(name);
+        return it == index_.end() ? SIZE_MAX : it->second;
+      }
+
+      int bitsOf(std::size_t k) const { return bits_[k]; }
+
+      static bool fits(Wide v, int bits) {
+        Wide lo = -(Wide(1) << (bits - 1)), hi = (Wide(1) << (bits - 1)) - 1;
+        return v >= lo && v <= hi;
+      }
+
+      // The width of the tracked locals `e` reads, 0 if it reads none.
+      int width(const Expr &e) const {
+        int bits = 0;
+        forEachRead(const_cast<Expr &>(e), [&](const LocalId &id) {
+          std::size_t k = slot(id.name);
+          if (!bits && k != SIZE_MAX)
+            bits = bits_[k];
+        });
+        return bits;
+      }
+
+      /// The value of `e` at width `bits` if it is known and computing it
+      /// cannot trap. With bits 0 only a lone literal has a value.
+      std::optional<int64_t> expr(const Expr &e, const State &s, int bits) const {
+        if (bits == 0) {
+          auto *ca = std::get_if<CoefAtom>(&e.first.v);
+          auto *lit = ca ? std::get_if<IntLit>(&ca->coef) : nullptr;
+          if (!e.rest.empty() || !lit)
+            return std::nullopt;
+          return lit->value;
+        }
+        auto v = atom(e.first, s, bits);
+        for (const auto &t: e.rest) {
+          if (!v)
+            return std::nullopt;
+          auto r = atom(t.atom, s, bits);
+          if (!r)
+            return std::nullopt;
+          Wide w = t.op == AddOp::Plus ? Wide(*v) + *r : Wide(*v) - *r;
+          if (!fits(w, bits))
+            return std::nullopt;
+          v = static_cast<int64_t>(w);
+        }
+        return v;
+      }
+
+      std::optional<int64_t> atom(const Atom &a, const State &s, int bits) const {
+        if (auto *ca = std::get_if<CoefAtom>(&a.v))
+          return coef(ca->coef, s, bits);
+        if (auto *ra = std::get_if<RValueAtom>(&a.v))
+          return rvalue(ra->rval, s);
+        if (auto *op = std::get_if<OpAtom>(&a.v)) {
+          auto c = coef(op->coef, s, bits);
+          auto r = c ? rvalue(op->rval, s) : std::nullopt;
+          if (!r)
+            return std::nullopt;
+          return apply(op->op, *c, *r, bits);
+        }
+        return std::nullopt;
+      }
+
+      std::optional<int64_t> coef(const Coef &c, const State &s, int bits) const {
+        if (auto *lit = std::get_if<IntLit>(&c))
+          return fits(lit->value, bits) ? std::optional<int64_t>(lit->value) : std::nullopt;
+        auto *lsid = std::get_if<LocalOrSymId>(&c);
+        auto *lid = lsid ? std::get_if<LocalId>(lsid) : nullptr;
+        return lid ? local(lid->name, s) : std::nullopt;
+      }
+
+      std::optional<int64_t> rvalue(const LValue &lv, const State &s) const {
+        return lv.accesses.empty() ? local(lv.base.name, s) : std::nullopt;
+      }
+
+      std::optional<int64_t> local(Symbol name, const State &s) const {
+        std::size_t k = slot(name);
+        return k == SIZE_MAX ? std::nullopt : s.vals[k];
+      }
+
+      /// Whether `c` holds in `s`, if that is known and cannot trap.
+      std::optional<bool> cond(const Cond &c, const State &s) const {
+        int bits = width(c.lhs);
+        if (!bits)
+          bits = width(c.rhs);
+        auto l = expr(c.lhs, s, bits);
+        auto r = l ? expr(c.rhs, s, bits) : std::nullopt;
+        if (!r)
+          return std::nullopt;
+        switch (c.op) {
+          case RelOp::EQ:
+            return *l == *r;
+          case RelOp::NE:
+            return *l != *r;
+          case RelOp::LT:
+            return *l < *r;
+          case RelOp::LE:
+            return *l <= *r;
+          case RelOp::GT:
+            return *l > *r;
+          case RelOp::GE:
+            return *l >= *r;
+        }
+        return std::nullopt;
+      }
+
+    private:
+      // `c op r` at width `bits`; nullopt where the op is UB.
+      static std::optional<int64_t> apply(AtomOpKind op, int64_t c, int64_t r, int bits) {
+        int64_t min = bits == 64 ? INT64_MIN : -(int64_t(1) << (bits - 1));
+        Wide v = 0;
+        switch (op) {
+          case AtomOpKind::Mul:
+            v = Wide(c) * r;
+            break;
+          case AtomOpKind::Div:
+          case AtomOpKind::Mod:
+            if (r == 0 || (c == min && r == -1))
+              return std::nullopt;
+            v = op == AtomOpKind::Div ? c / r : c % r;
+            break;
+          case AtomOpKind::And:
+            v = c & r;
+            break;
+          case AtomOpKind::Or:
+            v = c | r;
+            break;
+          case AtomOpKind::Xor:
+            v = c ^ r;
+            break;
+          case AtomOpKind::Shl:
+          case AtomOpKind::Shr:
+          case AtomOpKind::LShr:
+            if (r < 0 || r >= bits)
+              return std::nullopt;
+            if (op == AtomOpKind::Shl) {
+              if (c < 0)
+                return std::nullopt;
+              v = Wide(c) << r;
+            } else if (op == AtomOpKind::Shr) {
+              v = c >> r;
+            } else {
+              uint64_t mask = bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+              uint64_t u = (static_cast<uint64_t>(c) & mask) >> r;
+              // Back to the signed value of the width, as stored.
+              if (bits < 64 && (u >> (bits - 1)) & 1)
+                u |= ~mask;
+              v = static_cast<int64_t>(u);
+            }
+            break;
+        }
+        if (!fits(v, bits))
+          return std::nullopt;
+        return static_cast<int64_t>(v);
+      }
+
+      const FunDecl &f_;
+      std::unordered_map<Symbol, std::size_t> index_; // param or let -> slot
+      std::vector<int> bits_;                         // per slot
+    };
+
+    /**
+     * Rewrites the reads of one block under the constant state before each
+     * instruction.
+     */
+    class ConstantRewriter {
+    public:
+      ConstantRewriter(const FunDecl &f, const Folder &folder) : f_(f), folder_(folder) {}
+
+      void block(Block &b, Folder::State s) {
+        std::vector<Instr> out;
+        out.reserve(b.instrs.size());
+        for (auto &ins: b.instrs) {
+          if (auto *as = std::get_if<AssignInstr>(&ins)) {
+            std::size_t k =
+                as->lhs.accesses.empty() ? folder_.slot(as->lhs.base.name) : SIZE_MAX;
+            auto v = k != SIZE_MAX ? folder_.expr(as->rhs, s, folder_.bitsOf(k)) : std::nullopt;
+            if (v && literal(*v))
+              toLiteral(as->rhs, *v);
+            else
+              expr(as->rhs, s);
+            lvalue(as->lhs, s);
+            if (k != SIZE_MAX)
+              s.vals[k] = v;
+          } else if (auto *st = std::get_if<StoreInstr>(&ins)) {
+            expr(st->ptr, s);
+            expr(st->val, s);
+          } else {
+            Cond &c = std::holds_alternative<AssumeInstr>(ins) ? std::get<AssumeInstr>(ins).cond
+                                                               : std::get<RequireInstr>(ins).cond;
+            if (folder_.cond(c, s) == std::optional<bool>(true))
+              continue;
+            cond(c, s);
+          }
+          out.push_back(std::move(ins));
+        }
+        b.instrs = std::move(out);
+
+        if (auto *br = std::get_if<BrTerm>(&b.term)) {
+          if (br->isConditional && br->cond) {
+            if (auto taken = folder_.cond(*br->cond, s)) {
+              br->dest = *taken ? br->thenLabel : br->elseLabel;
+              br->isConditional = false;
+              br->cond.reset();
+            } else {
+              cond(*br->cond, s);
+            }
+          }
+        } else if (auto *ret = std::get_if<RetTerm>(&b.term)) {
+          if (ret->value) {
+            int bits = static_cast<int>(TypeUtils::getBitWidth(f_.retType).value_or(0));
+            auto v = bits >= 2 ? folder_.expr(*ret->value, s, bits) : std::nullopt;
+            if (v && literal(*v))
+              toLiteral(*ret->value, *v);
+            else
+              expr(*ret->value, s);
+          }
+        }
+      }
+
+    private:
+      // Literals are printed and re-parsed; INT64_MIN has no literal.
+      static bool literal(int64_t v) { return v != INT64_MIN; }
+
+      static void toLiteral(Expr &e, int64_t v) {
+        if (e.rest.empty() && isLiteral(e.first))
+          return;
+        e.first.v = CoefAtom{IntLit{v, e.first.span}, e.first.span};
+        e.rest.clear();
+      }
+
+      std::optional<int64_t> known(Symbol name, const Folder::State &s) const {
+        auto v = folder_.local(name, s);
+        return v && literal(*v) ? v : std::nullopt;
+      }
+
+      // Whether atom `a` of an expression of width `bits` folds to a
+      // literal; `defining` if it sets the width the interpreter checks at.
+      std::optional<int64_t>
+      foldable(const Atom &a, const Folder::State &s, int bits, bool defining) const {
+        if (isLiteral(a) || (defining && bits != 64))
+          return std::nullopt;
+        auto v = folder_.atom(a, s, bits);
+        return v && literal(*v) ? v : std::nullopt;
+      }
+
+      void expr(Expr &e, const Folder::State &s) {
+        int bits = folder_.width(e);
+        if (!bits)
+          return indices(e, s);
+        // An expression of literals alone would lose its type.
+        bool allLiteral = isLiteral(e.first) || foldable(e.first, s, bits, !e.rest.empty());
+        for (const auto &t: e.rest)
+          allLiteral = allLiteral && (isLiteral(t.atom) || foldable(t.atom, s, bits, false));
+        if (allLiteral && !e.rest.empty())
+          return indices(e, s);
+        atom(e.first, s, bits, !e.rest.empty());
+        for (auto &t: e.rest)
+          atom(t.atom, s, bits, false);
+      }
+
+      void cond(Cond &c, const Folder::State &s) {
+        // Both sides would become literals when the condition is known,
+        // or traps; keep it as it is then.
+        int bits = folder_.width(c.lhs);
+        if (!bits)
+          bits = folder_.width(c.rhs);
+        if (bits && folder_.expr(c.lhs, s, bits) && folder_.expr(c.rhs, s, bits)) {
+          indices(c.lhs, s);
+          indices(c.rhs, s);
+          return;
+        }
+        expr(c.lhs, s);
+        expr(c.rhs, s);
+      }
+
+      void atom(Atom &a, const Folder::State &s, int bits, bool defining) {
+        if (auto v = foldable(a, s, bits, defining)) {
+          a.v = CoefAtom{IntLit{*v, a.span}, a.span};
+          return;
+        }
+        std::visit(
+            [&](auto &&arg) {
+              using T = std::decay_t<decltype(arg)>;
+              if constexpr (std::is_same_v<T, OpAtom>) {
+                // The coefficient sets the width of the op.
+                if (bits == 64)
+                  coef(arg.coef, s);
+                lvalue(arg.rval, s);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                if (arg.cond)
+                  cond(*arg.cond, s);
+                else if (arg.maskExpr)
+                  expr(*arg.maskExpr, s);
+              } else if constexpr (std::is_same_v<T, AddrAtom>) {
+                lvalue(arg.lv, s);
+              } else if constexpr (std::is_same_v<T, CastAtom>) {
+                if (auto *lv = std::get_if<LValue>(&arg.src))
+                  lvalue(*lv, s);
+              } else if constexpr (std::is_same_v<T, RValueAtom> || std::is_same_v<T, UnaryAtom> ||
+                                   std::is_same_v<T, LoadAtom> ||
+                                   std::is_same_v<T, PtrFieldAtom> ||
+                                   std::is_same_v<T, PtrIndexAtom>) {
+                lvalue(arg.rval, s);
+              }
+            },
+            a.v
+        );
+      }
+
+      void coef(Coef &c, const Folder::State &s) {
+        auto *lsid = std::get_if<LocalOrSymId>(&c);
+        auto *lid = lsid ? std::get_if<LocalId>(lsid) : nullptr;
+        if (!lid)
+          return;
+        if (auto v = known(lid->name, s))
+          c = IntLit{*v, lid->span};
+      }
+
+      // The indices of an expression only, e.g. `%a[%i]`.
+      void indices(Expr &e, const Folder::State &s) {
+        auto visit = [&](Atom &a) {
+          if (auto *ra = std::get_if<RValueAtom>(&a.v))
+            lvalue(ra->rval, s);
+          else if (auto *op = std::get_if<OpAtom>(&a.v))
+            lvalue(op->rval, s);
+        };
+        visit(e.first);
+        for (auto &t: e.rest)
+          visit(t.atom);
+      }
+
+      // Turns the constant index operands of `lv` into literals. Only the
+      // indices into arrays and vectors reached from the base type are
+      // touched, and only with a value in bounds, which the checker would
+      // otherwise reject.
+      void lvalue(LValue &lv, const Folder::State &s) {
+        TypePtr t = typeOf(lv.base.name);
+        for (auto &acc: lv.accesses) {
+          auto *ai = std::get_if<AccessIndex>(&acc);
+          if (!ai || !t)
+            return;
+          std::uint64_t size = 0;
+          TypePtr elem;
+          if (auto *arr = TypeUtils::asArray(t)) {
+            size = arr->size;
+            elem = arr->elem;
+          } else if (auto *vec = TypeUtils::asVec(t)) {
+            size = vec->size;
+            elem = vec->elem;
+          } else {
+            return;
+          }
+          auto *lsid = std::get_if<LocalOrSymId>(&ai->index);
+          auto *lid = lsid ? std::get_if<LocalId>(lsid) : nullptr;
+          if (lid)
+            if (auto v = known(lid->name, s); v && *v >= 0 && std::uint64_t(*v) < size)
+              ai->index = IntLit{*v, lid->span};
+          t = elem;
+        }
+      }
+
+      TypePtr typeOf(Symbol name) const {
+        for (const auto &l: f_.lets)
+          if (l.name.name == name)
+            return l.type;
+        for (const auto &p: f_.params)
+          if (p.name.name == name)
+            return p.type;
+        return nullptr;
+      }
+
+      const FunDecl &f_;
+      const Folder &folder_;
+    };
+
+    // ---------------------------
+    // Copy propagation
+    // ---------------------------
+
+    /**
+     * Available copies: per scalar local, the local it currently holds a
+     * copy of. Every copy is recorded against the original's own original,
+     * so one lookup resolves a chain.
+     */
+    class Copies {
+    public:
+      static constexpr std::size_t kNone = SIZE_MAX;
+
+      struct State {
+        bool reachable = false;
+        std::vector<std::size_t> of; // per slot: slot copied, or kNone
+        bool operator==(const State &) const = default;
+      };
+
+      explicit Copies(const FunDecl &f) : f_(f) {
+        auto addressed = addressedLocals(f);
+        auto track = [&](const LocalId &id, const TypePtr &t) {
+          bool scalar = t && (std::holds_alternative<IntType>(t->v) ||
+                              std::holds_alternative<FloatType>(t->v) ||
+                              std::holds_alternative<PtrType>(t->v));
+          if (scalar && !addressed.count(id.name)) {
+            index_.emplace(id.name, names_.size());
+            names_.push_back(id);
+            types_.push_back(t);
+          }
+        };
+        for (const auto &p: f.params)
+          track(p.name, p.type);
+        for (const auto &l: f.lets)
+          track(l.name, l.type);
+      }
+
+      State bottom() { return State{false, std::vector<std::size_t>(names_.size(), kNone)}; }
+
+      State entryState() {
+        State s = bottom();
+        s.reachable = true;
+        // A let may copy a param or an earlier let.
+        std::unordered_set<Symbol> ready;
+        for (const auto &p: f_.params)
+          ready.insert(p.name.name);
+        for (const auto &l: f_.lets) {
+          if (l.init && l.init->kind == InitVal::Kind::Local) {
+            Symbol from = std::get<LocalId>(l.init->value).name;
+            if (ready.count(from))
+              record(s, slot(l.name.name), slot(from));
+          }
+          ready.insert(l.name.name);
+        }
+        return s;
+      }
+
+      void meetInto(State &acc, const State &in) {
+        if (!in.reachable)
+          return;
+        if (!acc.reachable) {
+          acc = in;
+          return;
+        }
+        for (std::size_t k = 0; k < acc.of.size(); ++k)
+          if (acc.of[k] != in.of[k])
+            acc.of[k] = kNone;
+      }
+
+      void transferInto(const Block &block, State &state) {
+        if (!state.reachable)
+          return;
+        for (const auto &ins: block.instrs)
+          step(ins, state);
+      }
+
+      /// Applies one instruction to `state`.
+      void step(const Instr &ins, State &state) const {
+        auto *as = std::get_if<AssignInstr>(&ins);
+        if (!as)
+          return;
+        std::size_t k = slot(as->lhs.base.name);
+        if (k == kNone)
+          return;
+        // Whatever held or was copied into the local no longer does.
+        state.of[k] = kNone;
+        for (auto &o: state.of)
+          if (o == k)
+            o = kNone;
+        if (!as->rhs.rest.empty())
+          return;
+        if (auto *ra = std::get_if<RValueAtom>(&as->rhs.first.v); ra && ra->rval.accesses.empty())
+          record(state, k, slot(ra->rval.base.name));
+        else if (auto *ca = std::get_if<CoefAtom>(&as->rhs.first.v))
+          if (auto *lsid = std::get_if<LocalOrSymId>(&ca->coef))
+            if (auto *lid = std::get_if<LocalId>(lsid))
+              record(state, k, slot(lid->name));
+      }
+
+      std::size_t slot(Symbol name) const {
+        auto it = index_.find(name);
+        return it == index_.end() ? kNone : it->second;
+      }
+
+      const LocalId &name(std::size_t k) const { return names_[k]; }
+
+    private:
+      void record(State &s, std::size_t to, std::size_t from) const {
+        if (to == kNone || from == kNone || !TypeUtils::areTypesEqual(types_[to], types_[from]))
+          return;
+        std::size_t root = s.of[from] != kNone ? s.of[from] : from;
+        if (root != to)
+          s.of[to] = root;
+      }
+
+      const FunDecl &f_;
+      std::unordered_map<Symbol, std::size_t> index_; // param or let -> slot
+      std::vector<LocalId> names_;                    // per slot
+      std::vector<TypePtr> types_;                    // per slot
+    };
+
+    // ---------------------------
+    // Dead stores
+    // ---------------------------
+
+    // The locals that are never `undef`: params and scalar lets with an
+    // initializer. Assigning one from an `undef` value would be UB first.
+    std::unordered_set<Symbol> definedLocals(const FunDecl &f) {
+      std::unordered_set<Symbol> out;
+      for (const auto &p: f.params)
+        out.insert(p.name.name);
+      for (const auto &l: f.lets) {
+        bool scalar = l.type && (std::holds_alternative<IntType>(l.type->v) ||
+                                 std::holds_alternative<FloatType>(l.type->v) ||
+                                 std::holds_alternative<PtrType>(l.type->v));
+        if (scalar && l.init && l.init->kind != InitVal::Kind::Undef)
+          out.insert(l.name.name);
+      }
+      return out;
+    }
+
+    // Whether evaluating `e` cannot trap.
+    bool cannotTrap(const Expr &e, const std::unordered_set<Symbol> &defined) {
+      if (!e.rest.empty())
+        return false; // + and - may overflow
+      if (auto *ca = std::get_if<CoefAtom>(&e.first.v)) {
+        auto *lsid = std::get_if<LocalOrSymId>(&ca->coef);
+        auto *lid = lsid ? std::get_if<LocalId>(lsid) : nullptr;
+        return !lid || defined.count(lid->name);
+      }
+      if (auto *ra = std::get_if<RValueAtom>(&e.first.v))
+        return ra->rval.accesses.empty() && defined.count(ra->rval.base.name);
+      return false;
+    }
+
+    // Whether a let's initializer cannot trap: anything but an atom.
+    bool cannotTrap(const std::optional<InitVal> &init) {
+      return !init || init->kind != InitVal::Kind::Atom;
+    }
+
+    // ---------------------------
+    // Loop vectorization
+    // ---------------------------
+
+    // Whether values of type `t` can be vector lanes: integers of two bits
+    // or more (i1 vectors are masks) and floats.
+    bool isLaneType(const TypePtr &t) {
+      if (!t)
+        return false;
+      if (std::holds_alternative<FloatType>(t->v))
+        return true;
+      return std::holds_alternative<IntType>(t->v) && TypeUtils::getBitWidth(t).value_or(0) >= 2;
+    }
+
+    // The local `a` is a read of, if it is one.
+    const LocalId *atomLocal(const Atom &a) {
+      if (auto *ra = std::get_if<RValueAtom>(&a.v))
+        return ra->rval.accesses.empty() ? &ra->rval.base : nullptr;
+      auto *ca = std::get_if<CoefAtom>(&a.v);
+      auto *lsid = ca ? std::get_if<LocalOrSymId>(&ca->coef) : nullptr;
+      return lsid ? std::get_if<LocalId>(lsid) : nullptr;
+    }
+
+    // The local `e` is a lone read of, if it is one.
+    const LocalId *loneLocal(const Expr &e) {
+      return e.rest.empty() ? atomLocal(e.first) : nullptr;
+    }
+
+    Atom makeAtom(Atom::Variant v, SourceSpan span) {
+      Atom a;
+      a.v = std::move(v);
+      a.span = span;
+      return a;
+    }
+
+    Expr makeExpr(Atom first, SourceSpan span) { return Expr{std::move(first), {}, span}; }
+
+    LValue makeLValue(const LocalId &base, std::vector<Access> accesses, SourceSpan span) {
+      return LValue{base, std::move(accesses), span, 0};
+    }
+
+    // `lv` as an atom.
+    Atom readOf(LValue lv) {
+      SourceSpan span = lv.span;
+      return makeAtom(RValueAtom{std::move(lv), span}, span);
+    }
+
+    // Lane `k` of vector `v`.
+    LValue laneOf(const LocalId &v, std::uint64_t k, SourceSpan span) {
+      return makeLValue(v, {AccessIndex{IntLit{static_cast<int64_t>(k), span}, span}}, span);
+    }
+
+    bool sameAccess(const Access &a, const Access &b) {
+      if (auto *fa = std::get_if<AccessField>(&a)) {
+        auto *fb = std::get_if<AccessField>(&b);
+        return fb && fa->field == fb->field;
+      }
+      auto *ia = std::get_if<AccessIndex>(&a);
+      auto *ib = std::get_if<AccessIndex>(&b);
+      if (!ib)
+        return false;
+      if (auto *la = std::get_if<IntLit>(&ia->index)) {
+        auto *lb = std::get_if<IntLit>(&ib->index);
+        return lb && la->value == lb->value;
+      }
+      auto *lsid = std::get_if<LocalOrSymId>(&ib->index);
+      auto name = [](const auto &id) { return id.name; };
+      return lsid && lsid->index() == std::get<LocalOrSymId>(ia->index).index() &&
+             std::visit(name, *lsid) == std::visit(name, std::get<LocalOrSymId>(ia->index));
+    }
+
+    // The local indexing the innermost dimension of `lv`, if one does.
+    const LocalId *lastIndexLocal(const LValue &lv) {
+      auto *ai = lv.accesses.empty() ? nullptr : std::get_if<AccessIndex>(&lv.accesses.back());
+      auto *lsid = ai ? std::get_if<LocalOrSymId>(&ai->index) : nullptr;
+      return lsid ? std::get_if<LocalId>(lsid) : nullptr;
+    }
+
+    // `a` and `b` differ in their last index at most.
+    bool sameRow(const LValue &a, const LValue &b) {
+      if (a.base.name != b.base.name || a.accesses.size() != b.accesses.size())
+        return false;
+      for (std::size_t k = 0; k + 1 < a.accesses.size(); ++k)
+        if (!sameAccess(a.accesses[k], b.accesses[k]))
+          return false;
+      return true;
+    }
+
+    // Lane `k` of a lane run in `ins`: the vector lane `%v[k]` and the
+    // element copied to it (a load) or from it (a store).
+    std::pair<const LValue *, const LValue *> runLane(const Instr &ins, bool store, int64_t k) {
+      auto *as = std::get_if<AssignInstr>(&ins);
+      auto *ra = as && as->rhs.rest.empty() ? std::get_if<RValueAtom>(&as->rhs.first.v) : nullptr;
+      if (!ra)
+        return {};
+      const LValue &vec = store ? ra->rval : as->lhs;
+      const LValue &elem = store ? as->lhs : ra->rval;
+      auto *ai = vec.accesses.size() == 1 ? std::get_if<AccessIndex>(&vec.accesses[0]) : nullptr;
+      auto *lane = ai ? std::get_if<IntLit>(&ai->index) : nullptr;
+      bool sym = vec.base.name.size() > 1 && vec.base.name[1] == '?';
+      if (!lane || lane->value != k || sym || !lastIndexLocal(elem))
+        return {};
+      return {&vec, &elem};
+    }
+
+    /**
+     * Rewrites the counted loops of one function for LoopVectorization.
+     *
+     * check() reads a loop off the CFG and the constants known before it
+     * and keeps what apply() needs; apply() finds the loop's blocks by
+     * label, so the loops checked on one CFG can be rewritten one after
+     * the other.
+     */
+    class LoopVectorizer {
+    public:
+      LoopVectorizer(FunDecl &f, unsigned lanes) :
+          f_(f), lanes_(lanes), addressed_(addressedLocals(f)) {
+        for (const auto &p: f.params)
+          types_.emplace(p.name.name, p.type);
+        for (const auto &l: f.lets) {
+          types_.emplace(l.name.name, l.type);
+          lets_.insert(l.name.name);
+        }
+        for (const auto &s: f.syms)
+          types_.emplace(s.name.name, s.type);
+        for (const auto &entry: types_)
+          taken_.insert(bare(entry.first));
+        for (const auto &b: f.blocks)
+          labels_.insert(b.label.name);
+      }
+
+      /// A loop found by check(), for apply().
+      struct Loop {
+        Symbol header, body;
+        LocalId iv;
+        int64_t mainEnd = 0;
+      };
+
+      /// The loop headed by block `h`, if it can be vectorized.
+      std::optional<Loop> check(
+          std::size_t h, const CFG &cfg, Folder &folder,
+          const DataflowSolver<Folder::State>::Result &res
+      ) {
+        const Block &head = f_.blocks[h];
+        auto *br = std::get_if<BrTerm>(&head.term);
+        if (h == cfg.entry || !head.instrs.empty() || !br || !br->isConditional || !br->cond ||
+            (br->cond->op != RelOp::LT && br->cond->op != RelOp::LE))
+          return std::nullopt;
+        const LocalId *iv = loneLocal(br->cond->lhs);
+        if (!iv || addressed_.count(iv->name))
+          return std::nullopt;
+        TypePtr ivType = typeOf(iv->name);
+        int bits = static_cast<int>(TypeUtils::getBitWidth(ivType).value_or(0));
+        auto bodyIt = cfg.indexOf.find(br->thenLabel.name);
+        if (!ivType || !std::holds_alternative<IntType>(ivType->v) || bits < 2 ||
+            bodyIt == cfg.indexOf.end() || br->thenLabel.name == br->elseLabel.name ||
+            br->thenLabel.name == head.label.name || br->elseLabel.name == head.label.name)
+          return std::nullopt;
+
+        // One entry, one latch: the body.
+        std::size_t b = bodyIt->second;
+        const Block &body = f_.blocks[b];
+        auto *latch = std::get_if<BrTerm>(&body.term);
+        if (cfg.pred[b].size() != 1 || cfg.pred[b][0] != h || cfg.pred[h].size() != 2 || !latch ||
+            latch->isConditional || latch->dest.name != head.label.name)
+          return std::nullopt;
+        std::size_t p = cfg.pred[h][0] == b ? cfg.pred[h][1] : cfg.pred[h][0];
+        if (p == b || p == h || body.instrs.empty() || !isIncrement(body.instrs.back(), *iv))
+          return std::nullopt;
+
+        // The scalars the body assigns; the iv only by the increment.
+        iv_ = *iv;
+        collectAssigned(body);
+        if (assigned_.count(iv->name))
+          return std::nullopt;
+        bool invariantBound = true;
+        forEachRead(const_cast<Expr &>(br->cond->rhs), [&](const LocalId &id) {
+          invariantBound = invariantBound && id.name != iv->name && !assigned_.count(id.name);
+        });
+        if (!invariantBound)
+          return std::nullopt;
+
+        // A constant trip count of at least one vector iteration.
+        Folder::State before = folder.edge(f_.blocks[p], head.label.name, res.out[p]);
+        if (!before.reachable)
+          return std::nullopt;
+        auto start = folder.local(iv->name, before);
+        auto bound = folder.expr(br->cond->rhs, before, bits);
+        if (!start || !bound)
+          return std::nullopt;
+        Wide trips = Wide(*bound) - *start + (br->cond->op == RelOp::LE ? 1 : 0);
+        if (trips < Wide(lanes_))
+          return std::nullopt;
+        Wide mainEnd = *start + trips / lanes_ * lanes_;
+        // The vector of the iv steps one vector past the last iteration.
+        if (!Folder::fits(mainEnd + lanes_ - 1, bits) || mainEnd == INT64_MIN)
+          return std::nullopt;
+
+        std::unordered_set<Symbol> defined;
+        for (std::size_t k = 0; k + 1 < body.instrs.size(); ++k) {
+          auto *as = std::get_if<AssignInstr>(&body.instrs[k]);
+          if (!as || !expr(as->rhs, defined))
+            return std::nullopt;
+          if (as->lhs.accesses.empty()) {
+            if (!temp(as->lhs.base.name))
+              return std::nullopt;
+            defined.insert(as->lhs.base.name);
+          } else if (!element(as->lhs)) {
+            return std::nullopt;
+          }
+        }
+        return Loop{head.label.name, body.label.name, *iv, static_cast<int64_t>(mainEnd)};
+      }
+
+      /// Rewrites a loop check() returned.
+      void apply(const Loop &loop) {
+        std::size_t h = blockIndex(loop.header);
+        SourceSpan span = f_.blocks[h].span;
+        iv_ = loop.iv;
+        collectAssigned(f_.blocks[blockIndex(loop.body)]);
+        vecs_.clear();
+        init_.clear();
+        body_.clear();
+        valid_.clear();
+        span_ = span;
+        std::string base = bare(loop.header.str());
+        BlockLabel vecLabel{freshLabel("^" + base + "_vec"), span};
+        BlockLabel remLabel{freshLabel("^" + base + "_rem"), span};
+
+        // Lane k of the iteration runs at index %i + k.
+        TypePtr ivType = typeOf(iv_.name);
+        index_.assign(1, iv_);
+        for (unsigned k = 1; k < lanes_; ++k) {
+          index_.push_back(newLet(bare(iv_.name) + "_" + std::to_string(k), ivType));
+          body_.push_back(assign(makeLValue(index_[k], {}, span), plus(iv_, k)));
+        }
+
+        // The body, instruction by instruction, all lanes at a time.
+        std::vector<Symbol> temps;
+        const Block &scalarBody = f_.blocks[blockIndex(loop.body)];
+        for (std::size_t k = 0; k + 1 < scalarBody.instrs.size(); ++k) {
+          const auto &as = std::get<AssignInstr>(scalarBody.instrs[k]);
+          Symbol to = as.lhs.base.name;
+          bool temp = as.lhs.accesses.empty();
+          if (temp && std::find(temps.begin(), temps.end(), to) == temps.end())
+            temps.push_back(to);
+          TypePtr lane = temp ? typeOf(to) : elementType(as.lhs);
+          LocalId result;
+          if (literalOnly(as.rhs)) {
+            // A literal has no vector form of its own; its lanes are set
+            // once, on the way in.
+            result = newLet(bare(to) + "_c", vecType(lane));
+            for (unsigned l = 0; l < lanes_; ++l)
+              init_.push_back(assign(laneOf(result, l, span), vecExpr(as.rhs)));
+            if (temp)
+              body_.push_back(assign(makeLValue(tempVec(to), {}, span), localRead(result)));
+          } else {
+            Expr rhs = vecExpr(as.rhs);
+            result = temp ? tempVec(to) : vecOf(elementKey(as.lhs), to, lane);
+            body_.push_back(assign(makeLValue(result, {}, span), std::move(rhs)));
+          }
+          if (temp)
+            continue;
+          scatter(as.lhs, result);
+          invalidate(to);
+          if (!literalOnly(as.rhs))
+            valid_.insert(elementKey(as.lhs));
+        }
+        if (auto it = vecs_.find("i"); it != vecs_.end())
+          body_.push_back(assign(makeLValue(it->second, {}, span), plus(it->second, lanes_)));
+        body_.push_back(assign(makeLValue(iv_, {}, span), plus(iv_, lanes_)));
+
+        // header: br %i < mainEnd, ^vec, ^rem;  ^rem: the original test.
+        Block &head = f_.blocks[h];
+        Block rem{remLabel, {}, std::move(head.term), span};
+        Cond vecCond{
+            makeExpr(readOf(makeLValue(iv_, {}, span)), span), RelOp::LT,
+            makeExpr(makeAtom(CoefAtom{IntLit{loop.mainEnd, span}, span}, span), span), span
+        };
+        std::get<BrTerm>(f_.blocks[blockIndex(loop.body)].term).dest = remLabel;
+        Block vec{vecLabel, std::move(body_), jump(head.label), span};
+
+        // A temp read after the loop holds the value of the last iteration:
+        // the last lane of the last vector one, unless the scalar loop runs.
+        std::optional<Block> exit;
+        if (!temps.empty()) {
+          BlockLabel exitLabel{freshLabel("^" + base + "_vexit"), span};
+          exit = Block{exitLabel, {}, jump(remLabel), span};
+          for (Symbol t: temps)
+            exit->instrs.push_back(
+                assign(makeLValue(LocalId{t, span}, {}, span), laneRead(tempVec(t), lanes_ - 1))
+            );
+        }
+        BlockLabel done = exit ? exit->label : remLabel;
+        head.term = BrTerm{std::move(vecCond), {}, vecLabel, done, true, span};
+
+        // Broadcasts of the invariants and literals and the first lanes of
+        // the iv, once, on the way in.
+        std::optional<Block> init;
+        if (!init_.empty()) {
+          BlockLabel initLabel{freshLabel("^" + base + "_vinit"), span};
+          for (auto &b: f_.blocks) {
+            auto *br = std::get_if<BrTerm>(&b.term);
+            if (!br || b.label.name == loop.body)
+              continue;
+            for (BlockLabel *l: {&br->dest, &br->thenLabel, &br->elseLabel})
+              if (l->name == loop.header)
+                l->name = initLabel.name;
+          }
+          init = Block{initLabel, std::move(init_), jump(head.label), span};
+        }
+
+        auto at = f_.blocks.begin() + static_cast<std::ptrdiff_t>(h);
+        at = f_.blocks.insert(at + 1, std::move(vec));
+        if (exit)
+          at = f_.blocks.insert(at + 1, std::move(*exit));
+        f_.blocks.insert(at + 1, std::move(rem));
+        if (init)
+          f_.blocks.insert(f_.blocks.begin() + static_cast<std::ptrdiff_t>(h), std::move(*init));
+      }
+
+    private:
+      // A name without its sigil (`%x` -> `x`, `%?x` -> `x`), as the C
+      // backend mangles it.
+      static std::string bare(const std::string &name) {
+        std::size_t start = name.empty() ? 0 : 1;
+        if (name.size() > 1 && name[1] == '?')
+          start = 2;
+        return name.substr(start);
+      }
+
+      TypePtr typeOf(Symbol name) const {
+        auto it = types_.find(name);
+        return it == types_.end() ? nullptr : it->second;
+      }
+
+      std::size_t blockIndex(Symbol label) const {
+        for (std::size_t k = 0; k < f_.blocks.size(); ++k)
+          if (f_.blocks[k].label.name == label)
+            return k;
+        return SIZE_MAX;
+      }
+
+      void collectAssigned(const Block &body) {
+        assigned_.clear();
+        for (std::size_t k = 0; k + 1 < body.instrs.size(); ++k)
+          if (auto *as = std::get_if<AssignInstr>(&body.instrs[k]); as && as->lhs.accesses.empty())
+            assigned_.insert(as->lhs.base.name);
+      }
+
+      static bool literalOnly(const Expr &e) {
+        if (!isLiteral(e.first))
+          return false;
+        for (const auto &t: e.rest)
+          if (!isLiteral(t.atom))
+            return false;
+        return true;
+      }
+
+      // `ins` is `%i = %i + 1;`.
+      static bool isIncrement(const Instr &ins, const LocalId &iv) {
+        auto *as = std::get_if<AssignInstr>(&ins);
+        if (!as || !as->lhs.accesses.empty() || as->lhs.base.name != iv.name ||
+            as->rhs.rest.size() != 1 || as->rhs.rest[0].op != AddOp::Plus)
+          return false;
+        auto *ca = std::get_if<CoefAtom>(&as->rhs.rest[0].atom.v);
+        auto *one = ca ? std::get_if<IntLit>(&ca->coef) : nullptr;
+        if (!one || one->value != 1)
+          return false;
+        if (auto *ra = std::get_if<RValueAtom>(&as->rhs.first.v))
+          return ra->rval.accesses.empty() && ra->rval.base.name == iv.name;
+        auto *fc = std::get_if<CoefAtom>(&as->rhs.first.v);
+        auto *lsid = fc ? std::get_if<LocalOrSymId>(&fc->coef) : nullptr;
+        auto *lid = lsid ? std::get_if<LocalId>(lsid) : nullptr;
+        return lid && lid->name == iv.name;
+      }
+
+      // A scalar the body may read: the iv, a temp it assigned before, or
+      // an invariant.
+      bool scalar(Symbol name, const std::unordered_set<Symbol> &defined) const {
+        if (name == iv_.name)
+          return true;
+        if (!isLaneType(typeOf(name)) || addressed_.count(name))
+          return false;
+        return !assigned_.count(name) || defined.count(name);
+      }
+
+      // A scalar the body assigns, which gets a vector of its own.
+      bool temp(Symbol name) const {
+        auto it = types_.find(name);
+        return name != iv_.name && lets_.count(name) && isLaneType(it->second) &&
+               !addressed_.count(name);
+      }
+
+      // An element `%a[..][%i]` of a local array of lanes, indexed by the
+      // iv last and by invariants before.
+      bool element(const LValue &lv) const {
+        if (!lets_.count(lv.base.name) || addressed_.count(lv.base.name) || lv.accesses.empty())
+          return false;
+        TypePtr t = typeOf(lv.base.name);
+        for (std::size_t k = 0; k < lv.accesses.size(); ++k) {
+          auto *ai = std::get_if<AccessIndex>(&lv.accesses[k]);
+          auto *arr = TypeUtils::asArray(t);
+          if (!ai || !arr)
+            return false;
+          auto *lsid = std::get_if<LocalOrSymId>(&ai->index);
+          auto *lid = lsid ? std::get_if<LocalId>(lsid) : nullptr;
+          bool last = k + 1 == lv.accesses.size();
+          if (last ? !lid || lid->name != iv_.name
+                   : lid && (lid->name == iv_.name || assigned_.count(lid->name)))
+            return false;
+          t = arr->elem;
+        }
+        return isLaneType(t);
+      }
+
+      bool coef(const Coef &c, const std::unordered_set<Symbol> &defined) const {
+        if (std::holds_alternative<IntLit>(c) || std::holds_alternative<FloatLit>(c))
+          return true;
+        auto *lsid = std::get_if<LocalOrSymId>(&c);
+        if (!lsid)
+          return false;
+        if (auto *sym = std::get_if<SymId>(lsid))
+          return isLaneType(typeOf(sym->name));
+        return scalar(std::get<LocalId>(*lsid).name, defined);
+      }
+
+      bool rvalue(const LValue &lv, const std::unordered_set<Symbol> &defined) const {
+        return lv.accesses.empty() ? scalar(lv.base.name, defined) : element(lv);
+      }
+
+      bool expr(const Expr &e, const std::unordered_set<Symbol> &defined) const {
+        auto atom = [&](const Atom &a) {
+          if (auto *ca = std::get_if<CoefAtom>(&a.v))
+            return coef(ca->coef, defined);
+          if (auto *ra = std::get_if<RValueAtom>(&a.v))
+            return rvalue(ra->rval, defined);
+          if (auto *op = std::get_if<OpAtom>(&a.v))
+            return coef(op->coef, defined) && rvalue(op->rval, defined);
+          if (auto *un = std::get_if<UnaryAtom>(&a.v))
+            return rvalue(un->rval, defined);
+          return false;
+        };
+        if (!atom(e.first))
+          return false;
+        for (const auto &t: e.rest)
+          if (!atom(t.atom))
+            return false;
+        return true;
+      }
+
+      // The scalar type of an element.
+      TypePtr elementType(const LValue &lv) const {
+        TypePtr t = typeOf(lv.base.name);
+        for (std::size_t k = 0; k < lv.accesses.size(); ++k)
+          t = TypeUtils::asArray(t)->elem;
+        return t;
+      }
+
+      // Names the elements one vector holds: the array and the indices
+      // before the iv, e.g. `e%m[%r]`.
+      static std::string elementKey(const LValue &lv) {
+        std::string key = "e" + lv.base.name.str();
+        for (std::size_t k = 0; k + 1 < lv.accesses.size(); ++k) {
+          const Index &idx = std::get<AccessIndex>(lv.accesses[k]).index;
+          if (auto *lit = std::get_if<IntLit>(&idx))
+            key += "[" + std::to_string(lit->value) + "]";
+          else
+            key += "[" + std::visit([](const auto &id) { return id.name.str(); },
+                                    std::get<LocalOrSymId>(idx)) + "]";
+        }
+        return key;
+      }
+
+      static Symbol baseOfKey(const std::string &key) {
+        return Symbol(key.substr(1, key.find('[') - 1));
+      }
+
+      // Element `lv` of lane `lane`.
+      LValue laneAt(const LValue &lv, unsigned lane) const {
+        LValue out = makeLValue(lv.base, lv.accesses, lv.span);
+        std::get<AccessIndex>(out.accesses.back()).index = LocalOrSymId{index_[lane]};
+        return out;
+      }
+
+      static AssignInstr assign(LValue lhs, Expr rhs) {
+        SourceSpan span = lhs.span;
+        return AssignInstr{std::move(lhs), std::move(rhs), span};
+      }
+
+      BrTerm jump(const BlockLabel &to) const {
+        return BrTerm{std::nullopt, to, {}, {}, false, span_};
+      }
+
+      Expr localRead(const LocalId &x) const {
+        return makeExpr(readOf(makeLValue(x, {}, span_)), span_);
+      }
+
+      // Lane `lane` of `v`, as an expression.
+      Expr laneRead(const LocalId &v, unsigned lane) const {
+        return makeExpr(readOf(laneOf(v, lane, span_)), span_);
+      }
+
+      // The vectors gathered from array `base` no longer hold its elements.
+      void invalidate(Symbol base) {
+        std::erase_if(valid_, [&](const std::string &k) { return baseOfKey(k) == base; });
+      }
+
+      // `%x + n`.
+      Expr plus(const LocalId &x, std::uint64_t n) const {
+        Expr e = localRead(x);
+        e.rest.push_back(
+            {AddOp::Plus, makeAtom(CoefAtom{IntLit{static_cast<int64_t>(n), span_}, span_}, span_),
+             span_}
+        );
+        return e;
+      }
+
+      // A fresh `let mut` of type `type`, zeroed.
+      LocalId newLet(const std::string &base, const TypePtr &type) {
+        LocalId id{freshLocal(base), span_};
+        const TypePtr &lane = TypeUtils::asVec(type) ? TypeUtils::asVec(type)->elem : type;
+        InitVal init = std::holds_alternative<FloatType>(lane->v)
+                           ? InitVal{InitVal::Kind::Float, FloatLit{0.0, span_}, span_}
+                           : InitVal{InitVal::Kind::Int, IntLit{0, span_}, span_};
+        f_.lets.push_back(LetDecl{true, id, type, std::move(init), span_, {}});
+        types_.emplace(id.name, type);
+        return id;
+      }
+
+      TypePtr vecType(const TypePtr &lane) const {
+        return TypeTable::global().intern(Type{VecType{lanes_, lane, {}}, {}});
+      }
+
+      // The vector named by `key`, holding lanes of `lane` named after `of`.
+      LocalId vecOf(const std::string &key, Symbol of, const TypePtr &lane) {
+        if (auto it = vecs_.find(key); it != vecs_.end())
+          return it->second;
+        LocalId v = newLet(bare(of) + "_v", vecType(lane));
+        vecs_.emplace(key, v);
+        return v;
+      }
+
+      // The vector of scalar `name` (or sym) the body reads: the lanes of
+      // the iv, a temp's vector, or an invariant broadcast on the way in.
+      LocalId scalarVec(Symbol name) {
+        if (name == iv_.name) {
+          // %i + k on the way in, stepped by K along with %i.
+          bool made = vecs_.count("i");
+          LocalId v = vecOf("i", name, typeOf(name));
+          if (!made)
+            for (unsigned lane = 0; lane < lanes_; ++lane) {
+              Expr at = lane ? plus(iv_, lane) : localRead(iv_);
+              init_.push_back(assign(laneOf(v, lane, span_), std::move(at)));
+            }
+          return v;
+        }
+        if (assigned_.count(name))
+          return tempVec(name);
+        bool made = vecs_.count("b" + name.str());
+        LocalId v = vecOf("b" + name.str(), name, typeOf(name));
+        if (!made) {
+          bool sym = name.size() > 1 && name[1] == '?';
+          for (unsigned lane = 0; lane < lanes_; ++lane) {
+            Atom copy = sym ? makeAtom(CoefAtom{LocalOrSymId{SymId{name, span_}}, span_}, span_)
+                            : readOf(makeLValue(LocalId{name, span_}, {}, span_));
+            init_.push_back(assign(laneOf(v, lane, span_), makeExpr(std::move(copy), span_)));
+          }
+        }
+        return v;
+      }
+
+      LocalId tempVec(Symbol name) { return vecOf("t" + name.str(), name, typeOf(name)); }
+
+      // The vector of element `lv`, loaded unless it is up to date: lane k
+      // from `%a[..][%i_k]`, one instruction per lane in order, which the
+      // backends emit as one vector load (see findLaneRuns).
+      LocalId gather(const LValue &lv) {
+        std::string key = elementKey(lv);
+        LocalId v = vecOf(key, lv.base.name, elementType(lv));
+        if (valid_.insert(key).second)
+          for (unsigned lane = 0; lane < lanes_; ++lane)
+            body_.push_back(
+                assign(laneOf(v, lane, span_), makeExpr(readOf(laneAt(lv, lane)), span_))
+            );
+        return v;
+      }
+
+      // Stores the lanes of `v` to element `lv`, the way gather() loads them.
+      void scatter(const LValue &lv, const LocalId &v) {
+        for (unsigned lane = 0; lane < lanes_; ++lane)
+          body_.push_back(assign(laneAt(lv, lane), laneRead(v, lane)));
+      }
+
+      LValue vecRValue(const LValue &lv) {
+        LocalId v = lv.accesses.empty() ? scalarVec(lv.base.name) : gather(lv);
+        return makeLValue(v, {}, lv.span);
+      }
+
+      Coef vecCoef(const Coef &c) {
+        auto *lsid = std::get_if<LocalOrSymId>(&c);
+        if (!lsid)
+          return c;
+        Symbol name = std::visit([](const auto &id) { return id.name; }, *lsid);
+        return LocalOrSymId{scalarVec(name)};
+      }
+
+      Atom vecAtom(const Atom &a) {
+        SourceSpan span = a.span;
+        if (auto *ca = std::get_if<CoefAtom>(&a.v))
+          return makeAtom(CoefAtom{vecCoef(ca->coef), span}, span);
+        if (auto *ra = std::get_if<RValueAtom>(&a.v))
+          return makeAtom(RValueAtom{vecRValue(ra->rval), span}, span);
+        if (auto *op = std::get_if<OpAtom>(&a.v)) {
+          Coef c = vecCoef(op->coef);
+          return makeAtom(OpAtom{op->op, std::move(c), vecRValue(op->rval), span}, span);
+        }
+        const auto &un = std::get<UnaryAtom>(a.v);
+        return makeAtom(UnaryAtom{un.op, vecRValue(un.rval), span}, span);
+      }
+
+      Expr vecExpr(const Expr &e) {
+        Expr out = makeExpr(vecAtom(e.first), e.span);
+        for (const auto &t: e.rest)
+          out.rest.push_back({t.op, vecAtom(t.atom), t.span});
+        return out;
+      }
+
+      Symbol freshLocal(const std::string &base) {
+        std::string name = base;
+        for (int n = 2; taken_.count(name); ++n)
+          name = base + "_" + std::to_string(n);
+        taken_.insert(name);
+        return Symbol("%" + name);
+      }
+
+      Symbol freshLabel(const std::string &base) {
+        std::string name = base;
+        for (int n = 2; labels_.count(Symbol(name)); ++n)
+          name = base + "_" + std::to_string(n);
+        labels_.insert(Symbol(name));
+        return Symbol(name);
+      }
+
+      FunDecl &f_;
+      unsigned lanes_;
+      std::unordered_set<Symbol> addressed_;
+      std::unordered_map<Symbol, TypePtr> types_; // params, lets and syms
+      std::unordered_set<Symbol> lets_;           // not params
+      std::unordered_set<std::string> taken_;     // local and sym names, bare
+      std::unordered_set<Symbol> labels_;
+
+      // The loop being checked or applied.
+      LocalId iv_;
+      std::unordered_set<Symbol> assigned_;
+      SourceSpan span_;
+      std::vector<LocalId> index_;                     // per lane
+      std::unordered_map<std::string, LocalId> vecs_;  // by key
+      std::unordered_set<std::string> valid_;          // gathered element keys
+      std::vector<Instr> init_, body_;
+    };
+
+  } // namespace
+
+  PassResult ConstantPropagation::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    (void) diags;
+    const CFG *cfg = am.validCfg(f);
+    if (!cfg)
+      return PassResult::Success;
+    Folder folder(f);
+    auto res = DataflowSolver<Folder::State>::solve(f, *cfg, folder);
+    ConstantRewriter rewriter(f, folder);
+    for (std::size_t b = 0; b < f.blocks.size(); ++b)
+      if (res.in[b].reachable)
+        rewriter.block(f.blocks[b], res.in[b]);
+    return PassResult::Success;
+  }
+
+  PassResult CopyPropagation::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    (void) diags;
+    const CFG *cfg = am.validCfg(f);
+    if (!cfg)
+      return PassResult::Success;
+    Copies copies(f);
+    auto res = DataflowSolver<Copies::State>::solve(f, *cfg, copies);
+    for (std::size_t b = 0; b < f.blocks.size(); ++b) {
+      Copies::State s = res.in[b];
+      if (!s.reachable)
+        continue;
+      auto resolve = [&](LocalId &id) {
+        std::size_t k = copies.slot(id.name);
+        if (k != Copies::kNone && s.of[k] != Copies::kNone)
+          id.name = copies.name(s.of[k]).name;
+      };
+      for (auto &ins: f.blocks[b].instrs) {
+        forEachRead(ins, resolve);
+        copies.step(ins, s);
+      }
+      forEachRead(f.blocks[b].term, resolve);
+    }
+    return PassResult::Success;
+  }
+
+  PassResult DeadStoreElimination::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    (void) diags;
+    if (!am.validCfg(f))
+      return PassResult::Success;
+    const Liveness &live = am.liveness(f);
+    const auto &reachable = am.reachable(f);
+    auto addressed = addressedLocals(f);
+    auto defined = definedLocals(f);
+
+    for (std::size_t b = 0; b < f.blocks.size(); ++b) {
+      if (!reachable[b])
+        continue;
+      Block &block = f.blocks[b];
+      BitVector now = live.liveOut(b);
+      auto use = [&](const LocalId &id) {
+        if (std::size_t k = live.slot(id.name); k != SIZE_MAX)
+          now.set(k);
+      };
+      forEachRead(block.term, use);
+      std::vector<char> dead(block.instrs.size(), 0);
+      for (std::size_t i = block.instrs.size(); i-- > 0;) {
+        Instr &ins = block.instrs[i];
+        if (auto *as = std::get_if<AssignInstr>(&ins); as && as->lhs.accesses.empty()) {
+          std::size_t k = live.slot(as->lhs.base.name);
+          if (k != SIZE_MAX && !now.test(k) && !addressed.count(as->lhs.base.name) &&
+              cannotTrap(as->rhs, defined)) {
+            dead[i] = 1;
+            continue;
+          }
+          if (k != SIZE_MAX)
+            now.reset(k);
+        }
+        forEachRead(ins, use);
+      }
+      eraseMarked(block.instrs, dead);
+    }
+
+    // Lets that nothing mentions any more.
+    std::unordered_set<Symbol> mentioned = addressed;
+    auto mention = [&](const LocalId &id) { mentioned.insert(id.name); };
+    std::function<void(InitVal &)> init = [&](InitVal &iv) {
+      if (iv.kind == InitVal::Kind::Local)
+        mention(std::get<LocalId>(iv.value));
+      else if (iv.kind == InitVal::Kind::Atom && std::get<AtomPtr>(iv.value))
+        forEachRead(*std::get<AtomPtr>(iv.value), mention);
+      else if (iv.kind == InitVal::Kind::Aggregate)
+        for (auto &elem: std::get<std::vector<InitValPtr>>(iv.value))
+          if (elem)
+            init(*elem);
+    };
+    for (auto &l: f.lets)
+      if (l.init)
+        init(*l.init);
+    for (auto &block: f.blocks) {
+      for (auto &ins: block.instrs) {
+        forEachRead(ins, mention);
+        if (auto *as = std::get_if<AssignInstr>(&ins))
+          mentioned.insert(as->lhs.base.name);
+      }
+      forEachRead(block.term, mention);
+    }
+    std::erase_if(f.lets, [&](const LetDecl &l) {
+      return !mentioned.count(l.name.name) && cannotTrap(l.init);
+    });
+    return PassResult::Success;
+  }
+
+  PassResult DeadBlockElimination::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    (void) diags;
+    if (!am.validCfg(f))
+      return PassResult::Success;
+    std::vector<char> unreachable(f.blocks.size(), 0);
+    const auto &reachable = am.reachable(f);
+    for (std::size_t k = 0; k < f.blocks.size(); ++k)
+      unreachable[k] = !reachable[k];
+    eraseMarked(f.blocks, unreachable);
+    return PassResult::Success;
+  }
+
+  PassResult BlockMerging::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    (void) diags;
+    if (!am.validCfg(f) || f.blocks.empty())
+      return PassResult::Success;
+    std::unordered_map<Symbol, std::size_t> indexOf;
+    for (std::size_t k = 0; k < f.blocks.size(); ++k)
+      indexOf.emplace(f.blocks[k].label.name, k);
+
+    // An empty, non-entry block that only jumps on is a hop.
+    auto hopTarget = [&](std::size_t k) -> const BlockLabel * {
+      const Block &b = f.blocks[k];
+      auto *br = std::get_if<BrTerm>(&b.term);
+      if (k == 0 || !b.instrs.empty() || !br || br->isConditional)
+        return nullptr;
+      return &br->dest;
+    };
+    // Where a branch to `label` ends up after the hops; cycles of hops
+    // (an empty infinite loop) are left alone.
+    auto finalTarget = [&](const BlockLabel &label) {
+      BlockLabel cur = label;
+      std::unordered_set<Symbol> seen{cur.name};
+      for (;;) {
+        auto it = indexOf.find(cur.name);
+        const BlockLabel *next = it == indexOf.end() ? nullptr : hopTarget(it->second);
+        if (!next)
+          return BlockLabel{cur.name, label.span};
+        if (!seen.insert(next->name).second)
+          return label;
+        cur = *next;
+      }
+    };
+    for (auto &b: f.blocks)
+      if (auto *br = std::get_if<BrTerm>(&b.term)) {
+        if (br->isConditional) {
+          br->thenLabel = finalTarget(br->thenLabel);
+          br->elseLabel = finalTarget(br->elseLabel);
+        } else {
+          br->dest = finalTarget(br->dest);
+        }
+      }
+    pruneUnreachable(f);
+
+    indexOf.clear();
+    std::unordered_map<Symbol, std::size_t> refs;
+    for (std::size_t k = 0; k < f.blocks.size(); ++k) {
+      indexOf.emplace(f.blocks[k].label.name, k);
+      for (Symbol s: successors(f.blocks[k].term))
+        ++refs[s];
+    }
+    std::vector<char> merged(f.blocks.size(), 0);
+    for (std::size_t k = 0; k < f.blocks.size(); ++k) {
+      if (merged[k])
+        continue;
+      Block &a = f.blocks[k];
+      for (;;) {
+        auto *br = std::get_if<BrTerm>(&a.term);
+        if (!br || br->isConditional)
+          break;
+        auto it = indexOf.find(br->dest.name);
+        if (it == indexOf.end() || it->second == 0 || it->second == k || merged[it->second] ||
+            refs[br->dest.name] != 1)
+          break;
+        Block &b = f.blocks[it->second];
+        merged[it->second] = 1;
+        std::move(b.instrs.begin(), b.instrs.end(), std::back_inserter(a.instrs));
+        a.term = std::move(b.term);
+        a.span.end = b.span.end;
+      }
+    }
+    eraseMarked(f.blocks, merged);
+    return PassResult::Success;
+  }
+
+  PassResult LoopVectorization::run(FunDecl &f, DiagBag &diags, AnalysisManager &am) {
+    (void) diags;
+    const CFG *cfg = am.validCfg(f);
+    if (!cfg)
+      return PassResult::Success;
+    Folder folder(f);
+    auto res = DataflowSolver<Folder::State>::solve(f, *cfg, folder);
+    LoopVectorizer vectorizer(f, lanes_);
+    std::vector<LoopVectorizer::Loop> loops;
+    for (std::size_t h = 0; h < f.blocks.size(); ++h)
+      if (res.in[h].reachable)
+        if (auto loop = vectorizer.check(h, *cfg, folder, res))
+          loops.push_back(*loop);
+    for (const auto &loop: loops)
+      vectorizer.apply(loop);
+    return PassResult::Success;
+  }
+
+  std::vector<LaneRun> findLaneRuns(const Block &b) {
+    std::vector<LaneRun> runs;
+    // The locals known to hold `%j + k`, as (%j, k).
+    std::unordered_map<Symbol, std::pair<Symbol, int64_t>> offsets;
+    for (std::size_t i = 0; i < b.instrs.size();) {
+      for (bool store: {false, true}) {
+        auto [vec, elem] = runLane(b.instrs[i], store, 0);
+        if (!vec)
+          continue;
+        Symbol j = lastIndexLocal(*elem)->name;
+        std::size_t n = 1;
+        for (; i + n < b.instrs.size(); ++n) {
+          auto [v, e] = runLane(b.instrs[i + n], store, static_cast<int64_t>(n));
+          if (!v || v->base.name != vec->base.name || !sameRow(*e, *elem))
+            break;
+          auto it = offsets.find(lastIndexLocal(*e)->name);
+          if (it == offsets.end() || it->second != std::pair(j, static_cast<int64_t>(n)))
+            break;
+        }
+        if (n >= 2) {
+          runs.push_back(LaneRun{i, n, store, elem, vec->base.name});
+          break;
+        }
+      }
+      // A run assigns no scalar.
+      if (!runs.empty() && runs.back().first == i) {
+        i += runs.back().lanes;
+        continue;
+      }
+      auto *as = std::get_if<AssignInstr>(&b.instrs[i]);
+      if (std::holds_alternative<StoreInstr>(b.instrs[i])) {
+        offsets.clear(); // it may write any local whose address is taken
+      } else if (as && as->lhs.accesses.empty()) {
+        Symbol x = as->lhs.base.name;
+        std::erase_if(offsets, [&](const auto &e) { return e.first == x || e.second.first == x; });
+        // `%x = %j + k`
+        const auto &rest = as->rhs.rest;
+        auto *ca = rest.size() == 1 ? std::get_if<CoefAtom>(&rest[0].atom.v) : nullptr;
+        auto *k = ca ? std::get_if<IntLit>(&ca->coef) : nullptr;
+        const LocalId *j = atomLocal(as->rhs.first);
+        if (k && rest[0].op == AddOp::Plus && j && j->name != x)
+          offsets[x] = {j->name, k->value};
+      }
+      ++i;
+    }
+    return runs;
+  }
+
+  void addOptimizationPasses(PassManager &pm) {
+    pm.addFunctionPass(std::make_unique<ConstantPropagation>());
+    pm.addFunctionPass(std::make_unique<DeadBlockElimination>());
+    pm.addFunctionPass(std::make_unique<CopyPropagation>());
+    pm.addFunctionPass(std::make_unique<DeadStoreElimination>());
+    pm.addFunctionPass(std::make_unique<BlockMerging>());
+  }
+
+} // namespace symir
@@ -27,6 +27,8 @@ namespace symir {
       return true;
     if (!a || !b)
       return false;
+    if (a->canonical.on && b->canonical.on)
+      return false; // interned: equal types are the same node
     if (a->v.index() != b->v.index())
       return false;
 
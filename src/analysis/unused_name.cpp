@@ -3,7 +3,7 @@
 
 namespace symir {
 
-  symir::PassResult UnusedNameAnalysis::run(FunDecl &f, DiagBag &diags) {
+  symir::PassResult UnusedNameAnalysis::run(FunDecl &f, DiagBag &diags, AnalysisManager &) {
     std::unordered_set<std::string> used;
 
     auto collectLValue = [&](const LValue &lv) {
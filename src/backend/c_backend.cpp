@@ -7,7 +7,10 @@
 #include <iostream>
 #include <limits>
 #include <sstream>
+#include <thread>
+#include "analysis/pass_manager.hpp"
 #include "analysis/type_utils.hpp"
+#include "timing.hpp"
 
 namespace symir {
 
@@ -145,6 +148,132 @@ namespace symir {
     );
   }
 
+  std::string CBackend::cTypeName(const TypePtr &type) {
+    std::ostringstream tmp;
+    std::streambuf *origBuf = out_.rdbuf(tmp.rdbuf());
+    emitType(type);
+    out_.rdbuf(origBuf);
+    return tmp.str();
+  }
+
+  int CBackend::intWidth(const TypePtr &type) {
+    auto it = type ? std::get_if<IntType>(&type->v) : nullptr;
+    if (!it)
+      return 0;
+    if (it->kind == IntType::Kind::I64)
+      return 64;
+    if (it->kind == IntType::Kind::ICustom)
+      return it->bits.value_or(32);
+    return 32;
+  }
+
+  TypePtr CBackend::exprIntType(const Expr &expr) {
+    auto isIntLit = [](const auto &v) {
+      auto c = std::get_if<Coef>(&v);
+      return c && std::holds_alternative<IntLit>(*c);
+    };
+    TypePtr type;
+    // False if `a` is not an integer; integer literals have no type of
+    // their own (getAtomType guesses i64 for them).
+    auto visit = [&](const Atom &a) {
+      TypePtr t;
+      if (auto c = std::get_if<CoefAtom>(&a.v); c && std::holds_alternative<IntLit>(c->coef))
+        return true;
+      if (auto sel = std::get_if<SelectAtom>(&a.v); sel && isIntLit(sel->vtrue)) {
+        if (isIntLit(sel->vfalse))
+          return true;
+        t = std::holds_alternative<RValue>(sel->vfalse)
+                ? getLValueType(std::get<RValue>(sel->vfalse))
+                : getCoefType(std::get<Coef>(sel->vfalse));
+      } else {
+        t = getAtomType(a);
+      }
+      if (!intWidth(t))
+        return false;
+      if (!type)
+        type = t;
+      return true;
+    };
+    if (!visit(expr.first))
+      return nullptr;
+    for (const auto &term: expr.rest)
+      if (!visit(term.atom))
+        return nullptr;
+    return type;
+  }
+
+  void CBackend::emitUbCheckMacros() {
+    // Statement expressions evaluating their operands once; `w` is the
+    // SymIR width, which may be narrower than the C type `T`.
+    out_ << "// UB checks (--ub-checks=explicit), by rule of docs/UB.md.\n"
+         << "#ifndef SYMIR_UB_TRAP\n"
+         << "#define SYMIR_UB_TRAP(rule) __builtin_trap()\n"
+         << "#endif\n"
+         << "#define SYMIR_MIN(w) (-((int64_t)1 << ((w) - 2)) * 2)\n"
+         << "#define SYMIR_MAX(w) (-(SYMIR_MIN(w) + 1))\n"
+         << "#define SYMIR_ARITH(op, T, w, a, b) ({ T _r; if (__builtin_##op##_overflow((a), "
+            "(b), &_r) || _r < SYMIR_MIN(w) || _r > SYMIR_MAX(w)) SYMIR_UB_TRAP(4); _r; })\n"
+         << "#define SYMIR_DIV(T, w, a, b) ({ T _a = (a), _b = (b); if (_b == 0) "
+            "SYMIR_UB_TRAP(1); if (_b == -1 && _a == SYMIR_MIN(w)) SYMIR_UB_TRAP(4); _a / _b; })\n"
+         << "#define SYMIR_MOD(T, w, a, b) ({ T _a = (a), _b = (b); if (_b == 0) "
+            "SYMIR_UB_TRAP(1); if (_b == -1 && _a == SYMIR_MIN(w)) SYMIR_UB_TRAP(4); _a % _b; })\n"
+         << "#define SYMIR_SHAMT(w, n) ({ int64_t _n = (n); if (_n < 0 || _n >= (w)) "
+            "SYMIR_UB_TRAP(5); _n; })\n"
+         << "#define SYMIR_SHL(T, w, a, n) ({ T _a = (a); int64_t _s = SYMIR_SHAMT(w, n); "
+            "if (_a < 0 || _a > (SYMIR_MAX(w) >> _s)) SYMIR_UB_TRAP(4); (T)(_a << _s); })\n"
+         << "#define SYMIR_INDEX(size, i) ({ int64_t _i = (i); if ((uint64_t)_i >= "
+            "(uint64_t)(size)) SYMIR_UB_TRAP(2); _i; })\n"
+         << "#define SYMIR_FTOI(w, x) ({ double _f = (x); if (!(_f - (double)SYMIR_MIN(w) > -1.0 "
+            "&& _f < -(double)SYMIR_MIN(w))) SYMIR_UB_TRAP(8); _f; })\n\n";
+  }
+
+  bool CBackend::emitCheckedOp(const OpAtom &op) {
+    TypePtr type = getLValueType(op.rval);
+    int w = intWidth(type);
+    if (w < 2)
+      return false;
+    std::string t = cTypeName(type);
+    auto operands = [&] {
+      emitCoef(op.coef);
+      out_ << ", ";
+      emitLValue(op.rval);
+      out_ << ")";
+    };
+    switch (op.op) {
+      case AtomOpKind::Mul:
+        out_ << "SYMIR_ARITH(mul, " << t << ", " << w << ", ";
+        operands();
+        return true;
+      case AtomOpKind::Div:
+        out_ << "SYMIR_DIV(" << t << ", " << w << ", ";
+        operands();
+        return true;
+      case AtomOpKind::Mod:
+        out_ << "SYMIR_MOD(" << t << ", " << w << ", ";
+        operands();
+        return true;
+      case AtomOpKind::Shl:
+        out_ << "SYMIR_SHL(" << t << ", " << w << ", ";
+        operands();
+        return true;
+      case AtomOpKind::Shr:
+        emitCoef(op.coef);
+        out_ << " >> SYMIR_SHAMT(" << w << ", ";
+        emitLValue(op.rval);
+        out_ << ")";
+        return true;
+      case AtomOpKind::LShr:
+        out_ << "(" << t << ")((u" << t << ")";
+        emitCoef(op.coef);
+        out_ << " >> SYMIR_SHAMT(" << w << ", ";
+        emitLValue(op.rval);
+        out_ << "))";
+        return true;
+      default:
+        return false;
+    }
+  }
+
   // [v0.2.1] Walk the program collecting every (N, T) vector shape used so
   // the lowering strategy can emit its preamble (typedefs / struct decls).
   static void collectVecShapesInType(const TypePtr &t, std::vector<VecType> &out) {
@@ -183,16 +312,49 @@ namespace symir {
     return out;
   }
 
+  CBackend::CBackend(const CBackend &parent, std::ostream &out) :
+      out_(out), noRequire_(parent.noRequire_), checkHook_(parent.checkHook_),
+      cfgLowering_(parent.cfgLowering_), ubChecks_(parent.ubChecks_), model_(parent.model_),
+      vecLowering_(parent.vecLowering_), symHooks_(parent.symHooks_),
+      structFields_(parent.structFields_), nodeTypes_(parent.nodeTypes_) {}
+
+  void CBackend::setNumThreads(unsigned n) {
+    numThreads_ = n ? n : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // A first guess at the C text of `f`, so most buffers never grow.
+  static std::size_t estimateFunctionSize(const FunDecl &f) {
+    std::size_t n = 256 + 64 * (f.lets.size() + f.syms.size());
+    for (const auto &b: f.blocks)
+      n += 64 + 96 * b.instrs.size();
+    return n;
+  }
+
   void CBackend::emit(const Program &prog) {
+    timing::Scope timer("emit-c");
+    nodeTypes_ = prog.types.get();
+    if (model_)
+      checkModel(prog);
+    const FunDecl *benchEntry = nullptr;
+    if (!benchEntry_.empty()) {
+      benchEntry = &benchFunction(prog);
+      checkHook_ = "symir_bench_check";
+      // The driver needs clock_gettime and sigsetjmp under -std=c99 too.
+      out_ << "#ifndef _POSIX_C_SOURCE\n#define _POSIX_C_SOURCE 200809L\n#endif\n";
+    }
     out_ << "#include <stdint.h>\n";
     out_ << "#include <stddef.h>\n";
     out_ << "#include <stdbool.h>\n";
     out_ << "#include <float.h>\n";
     out_ << "#include <math.h>\n";
     out_ << "#include <string.h>\n";
-    if (!noRequire_)
+    if (!noRequire_ && checkHook_.empty())
       out_ << "#include <assert.h>\n";
+    if (benchEntry)
+      emitBenchIncludes();
     out_ << "\n";
+    if (!checkHook_.empty())
+      out_ << "void " << checkHook_ << "(int kind, const char *msg);\n\n";
 
     // SPEC §2.9 conformance. C doesn't mandate IEEE 754 — the implementation
     // declares conformance by predefining __STDC_IEC_559__ (C99 §F.1). We
@@ -213,11 +375,15 @@ namespace symir {
     out_ << "#endif\n";
     out_ << "#pragma STDC FP_CONTRACT OFF\n";
     out_ << "\n";
+    if (ubChecks_ == UbChecks::Explicit || (benchEntry && needsBenchProbe()))
+      emitUbCheckMacros();
 
     // [v0.2.1] Vector-lowering strategy. Default to vecext.
     if (!vecLowering_) {
       vecLowering_ = makeVecLowering("vecext");
     }
+    vecLowering_->setUbChecks(ubChecks_);
+    symHooks_ = vecLowering_->needsLaneUnroll() ? makeVecLowering("vecext") : vecLowering_;
     out_ << "// vec-lowering: " << vecLowering_->name() << "\n";
     auto vecShapes = collectVecShapes(prog);
     if (!vecShapes.empty()) {
@@ -241,6 +407,17 @@ namespace symir {
       }
       vecLowering_->emitPreamble(out_, vecShapes);
     }
+    if (symHooks_ != vecLowering_) {
+      std::vector<VecType> symShapes;
+      for (const auto &f: prog.funs)
+        for (const auto &s: f.syms)
+          if (auto vt = std::get_if<VecType>(&s.type->v))
+            symShapes.push_back(*vt);
+      if (!symShapes.empty()) {
+        out_ << "// vector sym hooks return GCC vectors under every strategy\n";
+        symHooks_->emitPreamble(out_, symShapes);
+      }
+    }
 
     // 0. Populate struct fields map (name + type in declaration order).
     structFields_.clear();
@@ -281,6 +458,40 @@ namespace symir {
       out_ << "};\n\n";
     }
 
+    // 3. Functions, each rendered into a buffer of its own by a worker
+    // backend (they share no state), then joined in order and written at
+    // once.
+    std::vector<std::string> funcs(prog.funs.size());
+    DiagBag unused;
+    forEachFunction(prog.funs.size(), numThreads_, unused, [&](std::size_t i, DiagBag &) {
+      std::string text;
+      text.reserve(estimateFunctionSize(prog.funs[i]));
+      std::ostringstream buf(std::move(text));
+      CBackend worker(*this, buf);
+      worker.emitFunction(prog.funs[i]);
+      funcs[i] = std::move(buf).str();
+    });
+    std::size_t size = 0;
+    for (const auto &text: funcs)
+      size += text.size();
+    std::string all;
+    all.reserve(size);
+    for (const auto &text: funcs)
+      all += text;
+    out_.write(all.data(), static_cast<std::streamsize>(all.size()));
+
+    // Before the epilogue: the driver passes vectors in the registers the
+    // strategy's preamble may have enabled.
+    if (benchEntry) {
+      if (needsBenchProbe())
+        emitBenchProbe(*benchEntry);
+      emitBenchDriver(prog, *benchEntry);
+    }
+    if (!vecShapes.empty())
+      vecLowering_->emitEpilogue(out_);
+  }
+
+  void CBackend::emitFunction(const FunDecl &f) {
     auto getWidth = [](const TypePtr &t) -> std::uint32_t {
       if (auto it = std::get_if<IntType>(&t->v)) {
         switch (it->kind) {
@@ -295,395 +506,500 @@ namespace symir {
       return 64;
     };
 
-    // 3. Functions
-    for (const auto &f: prog.funs) {
-      curFuncName_ = f.name.name;
-      curFuncRetType_ = f.retType;
-      varWidths_.clear();
-      varTypes_.clear();
-      auto recordVar = [&](const std::string &name, const TypePtr &t) {
-        if (!t)
-          return;
-        varWidths_[name] = getWidth(t);
-        varTypes_[name] = t;
-      };
-      for (const auto &p: f.params)
-        recordVar(p.name.name, p.type);
-      for (const auto &s: f.syms)
-        recordVar(s.name.name, s.type);
-      for (const auto &l: f.lets)
-        recordVar(l.name.name, l.type);
+    curFuncName_ = f.name.name;
+    curFuncRetType_ = f.retType;
+    varWidths_.clear();
+    varTypes_.clear();
+    auto recordVar = [&](const std::string &name, const TypePtr &t) {
+      if (!t)
+        return;
+      varWidths_[name] = getWidth(t);
+      varTypes_[name] = t;
+    };
+    for (const auto &p: f.params)
+      recordVar(p.name.name, p.type);
+    for (const auto &s: f.syms)
+      recordVar(s.name.name, s.type);
+    for (const auto &l: f.lets)
+      recordVar(l.name.name, l.type);
+    prepareSpecialization(f);
 
-      // 3a. Extern symbols
-      for (const auto &s: f.syms) {
-        out_ << "extern ";
+    // 3a. Extern symbols, but for those specialized to a literal
+    bool externs = false;
+    for (const auto &s: f.syms) {
+      if (symValue(f.name.name, s.name.name))
+        continue;
+      out_ << "extern ";
+      if (auto vt = std::get_if<VecType>(&s.type->v))
+        out_ << symHooks_->typeString(*vt);
+      else
         emitType(s.type);
-        out_ << " " << getMangledSymbolName(f.name.name, s.name.name) << "(void);\n";
-      }
-      if (!f.syms.empty())
-        out_ << "\n";
-
-      // 3b. Function signature
-      emitType(f.retType);
-      out_ << " " << mangleName(f.name.name) << "(";
-      if (f.params.empty()) {
-        out_ << "void";
-      } else {
-        for (size_t i = 0; i < f.params.size(); ++i) {
-          const auto &p = f.params[i];
-          TypePtr cur = p.type;
-          std::vector<uint64_t> dims;
-          while (auto at = std::get_if<ArrayType>(&cur->v)) {
-            dims.push_back(at->size);
-            cur = at->elem;
-          }
-          emitType(cur);
-          out_ << " " << mangleName(p.name.name);
-          for (auto d: dims)
-            out_ << "[" << d << "]";
-          if (i + 1 < f.params.size())
-            out_ << ", ";
-        }
-      }
-      out_ << ") {\n";
-      indent_level_++;
-
-      // 3c. Locals and their initializations
-      for (const auto &l: f.lets) {
-        CtxGuard ctx(isDoubleCtx_, isOrContainsF64(l.type));
-
-        // [v0.2.1] Vector locals route through the strategy: emit the
-        // declaration (which can be `T v[N]`, `T v_0, v_1, …` for scalars,
-        // or `struct ... v`), then emit per-lane initializers as separate
-        // statements so every strategy converges on the same code shape.
-        if (std::holds_alternative<VecType>(l.type->v)) {
-          auto &vt = std::get<VecType>(l.type->v);
-          std::string vName = mangleName(l.name.name);
-          indent();
-          vecLowering_->emitLocalDecl(out_, vName, vt);
-          out_ << ";\n";
-          if (l.init) {
-            if (l.init->kind == InitVal::Kind::Aggregate) {
-              const auto &elems = std::get<std::vector<InitValPtr>>(l.init->value);
-              for (std::uint64_t k = 0; k < vt.size && k < elems.size(); ++k) {
-                indent();
-                std::string lane = vecLowering_->emitLaneRead(vName, vt, std::to_string(k));
-                out_ << lane << " = ";
-                emitInitVal(*elems[k], vt.elem);
-                out_ << ";\n";
-              }
-            } else if (l.init->kind == InitVal::Kind::Undef) {
-              // undef: no init. Reading is UB by spec (caught by definite-init).
-            } else {
-              TypePtr initType = getInitValType(*l.init);
-              if (initType && std::holds_alternative<VecType>(initType->v)) {
-                if (l.init->kind == InitVal::Kind::Local || l.init->kind == InitVal::Kind::Sym) {
-                  std::string srcName;
-                  if (l.init->kind == InitVal::Kind::Local) {
-                    srcName = mangleName(std::get<LocalId>(l.init->value).name);
-                  } else {
-                    srcName = mangleName(std::get<SymId>(l.init->value).name);
-                  }
-                  indent();
-                  vecLowering_->emitWholeCopy(out_, vName, srcName, vt);
-                  out_ << ";\n";
-                } else if (l.init->kind == InitVal::Kind::Atom) {
-                  if (vecLowering_->needsLaneUnroll()) {
-                    for (std::uint64_t k = 0; k < vt.size; ++k) {
-                      indent();
-                      std::string dstLane =
-                          vecLowering_->emitLaneRead(vName, vt, std::to_string(k));
-                      out_ << dstLane << " = "
-                           << emitVecAtomLane(*std::get<AtomPtr>(l.init->value), vt, k) << ";\n";
-                    }
-                  } else {
-                    indent();
-                    out_ << vName << " = ";
-                    emitInitVal(*l.init, l.type);
-                    out_ << ";\n";
-                  }
-                }
-              } else {
-                // Broadcast scalar.
-                for (std::uint64_t k = 0; k < vt.size; ++k) {
-                  indent();
-                  std::string lane = vecLowering_->emitLaneRead(vName, vt, std::to_string(k));
-                  out_ << lane << " = ";
-                  emitInitVal(*l.init, vt.elem);
-                  out_ << ";\n";
-                }
-              }
-            }
-          }
-          continue;
-        }
+      out_ << " " << getMangledSymbolName(f.name.name, s.name.name) << "(void);\n";
+      externs = true;
+    }
+    if (externs)
+      out_ << "\n";
 
-        indent();
-        TypePtr cur = l.type;
+    // 3b. Function signature
+    emitType(f.retType);
+    out_ << " " << mangleName(f.name.name) << nameSuffix_ << "(";
+    if (f.params.empty()) {
+      out_ << "void";
+    } else {
+      for (size_t i = 0; i < f.params.size(); ++i) {
+        const auto &p = f.params[i];
+        TypePtr cur = p.type;
         std::vector<uint64_t> dims;
         while (auto at = std::get_if<ArrayType>(&cur->v)) {
           dims.push_back(at->size);
           cur = at->elem;
         }
         emitType(cur);
-        out_ << " " << mangleName(l.name.name);
+        out_ << " " << mangleName(p.name.name);
         for (auto d: dims)
           out_ << "[" << d << "]";
+        if (i + 1 < f.params.size())
+          out_ << ", ";
+      }
+    }
+    out_ << ") {\n";
+    indent_level_++;
 
-        if (l.init && l.init->kind == InitVal::Kind::Aggregate) {
-          out_ << " = ";
-          emitInitVal(*l.init, l.type);
+    // 3c. Vector syms, under a strategy that unrolls lanes: the lanes of
+    // the hook's value, copied once into a local of the strategy's type
+    // that laneOperand() names.
+    if (vecLowering_->needsLaneUnroll())
+      for (const auto &s: f.syms) {
+        auto vt = std::get_if<VecType>(&s.type->v);
+        if (!vt)
+          continue;
+        std::string local = symLaneLocal(s.name.name);
+        indent();
+        out_ << symHooks_->typeString(*vt) << " " << local << "_in = "
+             << getMangledSymbolName(f.name.name, s.name.name) << "();\n";
+        indent();
+        vecLowering_->emitLocalDecl(out_, local, *vt);
+        out_ << ";\n";
+        for (std::uint64_t k = 0; k < vt->size; ++k) {
+          indent();
+          std::string kS = std::to_string(k);
+          vecLowering_->emitLaneWrite(out_, local, *vt, kS, local + "_in[" + kS + "]");
           out_ << ";\n";
-        } else if (l.init) {
-          TypePtr initType = getInitValType(*l.init);
-          bool isWholeCopy = initType && TypeUtils::areTypesEqual(initType, l.type);
-          if (isWholeCopy) {
-            if (!dims.empty()) {
-              out_ << " = {0};\n";
+        }
+      }
+
+    // 3d. Locals and their initializations
+    for (const auto &l: f.lets) {
+      CtxGuard ctx(isDoubleCtx_, isOrContainsF64(l.type));
+
+      // [v0.2.1] Vector locals route through the strategy: emit the
+      // declaration (which can be `T v[N]`, `T v_0, v_1, …` for scalars,
+      // or `struct ... v`), then emit per-lane initializers as separate
+      // statements so every strategy converges on the same code shape.
+      if (std::holds_alternative<VecType>(l.type->v)) {
+        auto &vt = std::get<VecType>(l.type->v);
+        std::string vName = mangleName(l.name.name);
+        indent();
+        vecLowering_->emitLocalDecl(out_, vName, vt);
+        out_ << ";\n";
+        if (l.init) {
+          if (l.init->kind == InitVal::Kind::Aggregate) {
+            const auto &elems = std::get<std::vector<InitValPtr>>(l.init->value);
+            for (std::uint64_t k = 0; k < vt.size && k < elems.size(); ++k) {
               indent();
-              out_ << "memcpy(&" << mangleName(l.name.name) << ", &";
-              emitInitVal(*l.init, l.type);
-              out_ << ", sizeof(" << mangleName(l.name.name) << "));\n";
-            } else {
-              out_ << " = ";
-              emitInitVal(*l.init, l.type);
+              std::string lane = vecLowering_->emitLaneRead(vName, vt, std::to_string(k));
+              out_ << lane << " = ";
+              emitInitVal(*elems[k], vt.elem);
               out_ << ";\n";
             }
-          } else if (!dims.empty() || std::holds_alternative<StructType>(l.type->v)) {
-            // Aggregate broadcast
-            out_ << " = {0};\n";
-            // Check if we need a loop for non-zero init
-            bool isZero = false;
-            if (l.init->kind == InitVal::Kind::Int && std::get<IntLit>(l.init->value).value == 0)
-              isZero = true;
-
-            if (!isZero) {
-              if (!dims.empty()) {
-                std::function<void(size_t, std::string)> genLoops = [&](size_t dim,
-                                                                        std::string access) {
-                  if (dim == dims.size()) {
+          } else if (l.init->kind == InitVal::Kind::Undef) {
+            // undef: no init. Reading is UB by spec (caught by definite-init).
+          } else {
+            TypePtr initType = getInitValType(*l.init);
+            if (initType && std::holds_alternative<VecType>(initType->v)) {
+              if (l.init->kind == InitVal::Kind::Local || l.init->kind == InitVal::Kind::Sym) {
+                std::string srcName;
+                if (l.init->kind == InitVal::Kind::Local) {
+                  srcName = mangleName(std::get<LocalId>(l.init->value).name);
+                } else {
+                  srcName = laneOperand(std::get<SymId>(l.init->value).name);
+                }
+                indent();
+                vecLowering_->emitWholeCopy(out_, vName, srcName, vt);
+                out_ << ";\n";
+              } else if (l.init->kind == InitVal::Kind::Atom) {
+                if (vecLowering_->needsLaneUnroll()) {
+                  for (std::uint64_t k = 0; k < vt.size; ++k) {
                     indent();
-                    out_ << mangleName(l.name.name) << access << " = ";
-                    emitInitVal(*l.init, cur);
-                    out_ << ";\n";
-                    return;
+                    std::string dstLane =
+                        vecLowering_->emitLaneRead(vName, vt, std::to_string(k));
+                    out_ << dstLane << " = "
+                         << emitVecAtomLane(*std::get<AtomPtr>(l.init->value), vt, k) << ";\n";
                   }
+                } else {
                   indent();
-                  out_ << "for (int i" << dim << " = 0; i" << dim << " < " << dims[dim] << "; ++i"
-                       << dim << ") {\n";
-                  indent_level_++;
-                  genLoops(dim + 1, access + "[i" + std::to_string(dim) + "]");
-                  indent_level_--;
-                  indent();
-                  out_ << "}\n";
-                };
-                genLoops(0, "");
-              } else {
+                  out_ << vName << " = ";
+                  emitInitVal(*l.init, l.type);
+                  out_ << ";\n";
+                }
+              }
+            } else {
+              // Broadcast scalar.
+              for (std::uint64_t k = 0; k < vt.size; ++k) {
                 indent();
-                out_ << "/* Warning: non-zero broadcast init for struct not fully supported */\n";
+                std::string lane = vecLowering_->emitLaneRead(vName, vt, std::to_string(k));
+                out_ << lane << " = ";
+                emitInitVal(*l.init, vt.elem);
+                out_ << ";\n";
               }
             }
+          }
+        }
+        continue;
+      }
+
+      indent();
+      TypePtr cur = l.type;
+      std::vector<uint64_t> dims;
+      while (auto at = std::get_if<ArrayType>(&cur->v)) {
+        dims.push_back(at->size);
+        cur = at->elem;
+      }
+      emitType(cur);
+      out_ << " " << mangleName(l.name.name);
+      for (auto d: dims)
+        out_ << "[" << d << "]";
+
+      if (l.init && l.init->kind == InitVal::Kind::Aggregate) {
+        out_ << " = ";
+        emitInitVal(*l.init, l.type);
+        out_ << ";\n";
+      } else if (l.init) {
+        TypePtr initType = getInitValType(*l.init);
+        bool isWholeCopy = initType && TypeUtils::areTypesEqual(initType, l.type);
+        if (isWholeCopy) {
+          if (!dims.empty()) {
+            out_ << " = {0};\n";
+            indent();
+            out_ << "memcpy(&" << mangleName(l.name.name) << ", &";
+            emitInitVal(*l.init, l.type);
+            out_ << ", sizeof(" << mangleName(l.name.name) << "));\n";
           } else {
-            // Scalar broadcast
             out_ << " = ";
             emitInitVal(*l.init, l.type);
             out_ << ";\n";
           }
+        } else if (!dims.empty() || std::holds_alternative<StructType>(l.type->v)) {
+          // Aggregate broadcast
+          out_ << " = {0};\n";
+          // Check if we need a loop for non-zero init
+          bool isZero = false;
+          if (l.init->kind == InitVal::Kind::Int && std::get<IntLit>(l.init->value).value == 0)
+            isZero = true;
+
+          if (!isZero) {
+            if (!dims.empty()) {
+              std::function<void(size_t, std::string)> genLoops = [&](size_t dim,
+                                                                      std::string access) {
+                if (dim == dims.size()) {
+                  indent();
+                  out_ << mangleName(l.name.name) << access << " = ";
+                  emitInitVal(*l.init, cur);
+                  out_ << ";\n";
+                  return;
+                }
+                indent();
+                out_ << "for (int i" << dim << " = 0; i" << dim << " < " << dims[dim] << "; ++i"
+                     << dim << ") {\n";
+                indent_level_++;
+                genLoops(dim + 1, access + "[i" + std::to_string(dim) + "]");
+                indent_level_--;
+                indent();
+                out_ << "}\n";
+              };
+              genLoops(0, "");
+            } else {
+              indent();
+              out_ << "/* Warning: non-zero broadcast init for struct not fully supported */\n";
+            }
+          }
         } else {
+          // Scalar broadcast
+          out_ << " = ";
+          emitInitVal(*l.init, l.type);
           out_ << ";\n";
         }
+      } else {
+        out_ << ";\n";
       }
+    }
 
-      // 3d. Blocks
-      for (const auto &b: f.blocks) {
-        out_ << mangleName(b.label.name) << ": ;\n"; // semicolon for empty label case
+    // 3e. Blocks
+    emitBlocks(f);
 
-        for (const auto &ins: b.instrs) {
-          indent();
-          std::visit(
-              [this](auto &&arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, AssignInstr>) {
-                  CtxGuard ctx(isDoubleCtx_, isOrContainsF64(getLValueType(arg.lhs)));
-                  // [v0.2.1] Vector LHS goes through strategy-aware paths.
-                  auto lhsTy = getLValueType(arg.lhs);
-                  if (lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
-                      arg.lhs.accesses.empty()) {
-                    auto &vt = std::get<VecType>(lhsTy->v);
-                    // CmpAtom and mask-form SelectAtom are always lane-unroll.
-                    if (arg.rhs.rest.empty()) {
-                      if (auto cmpA = std::get_if<CmpAtom>(&arg.rhs.first.v)) {
-                        emitVecCmpAssign(arg.lhs, *cmpA, vt);
-                        return;
-                      }
-                      if (auto sel = std::get_if<SelectAtom>(&arg.rhs.first.v)) {
-                        if (sel->maskExpr) {
-                          emitVecMaskSelectAssign(arg.lhs, *sel, vt);
-                          return;
-                        }
-                      }
-                    }
-                    // [v0.2.1] Logical right shift (LShr) is the only OpAtom
-                    // that can't be expressed inline on a vec-ext type — the
-                    // signed-to-unsigned reinterpret is illegal on GCC vector
-                    // types. Force lane-unroll for that op regardless of
-                    // strategy.
-                    bool isVecLShr = false;
-                    if (arg.rhs.rest.empty()) {
-                      if (auto op = std::get_if<OpAtom>(&arg.rhs.first.v))
-                        isVecLShr = (op->op == AtomOpKind::LShr);
-                    }
-                    if (vecLowering_->needsLaneUnroll() || isVecLShr) {
-                      emitVecAssign(arg.lhs, arg.rhs, vt);
-                      return;
-                    }
-                    // vecext: fall through to the inline expression path.
-                  }
-                  // [v0.2.1] Scalar `cmp` assignment: emit `(l op r) ? 1 : 0`.
-                  // CmpAtom can't lower as an inline expression (see emitAtom),
-                  // so we special-case it at AssignInstr level for scalars too.
-                  if (arg.rhs.rest.empty()) {
-                    if (auto cmpA = std::get_if<CmpAtom>(&arg.rhs.first.v)) {
-                      emitLValue(arg.lhs);
-                      out_ << " = ((";
-                      emitSelectVal(cmpA->lhs);
-                      const char *op = "==";
-                      switch (cmpA->op) {
-                        case RelOp::EQ:
-                          op = "==";
-                          break;
-                        case RelOp::NE:
-                          op = "!=";
-                          break;
-                        case RelOp::LT:
-                          op = "<";
-                          break;
-                        case RelOp::LE:
-                          op = "<=";
-                          break;
-                        case RelOp::GT:
-                          op = ">";
-                          break;
-                        case RelOp::GE:
-                          op = ">=";
-                          break;
-                      }
-                      out_ << ") " << op << " (";
-                      emitSelectVal(cmpA->rhs);
-                      out_ << ")) ? 1 : 0;\n";
-                      return;
-                    }
-                  }
-                  if (lhsTy && std::holds_alternative<ArrayType>(lhsTy->v)) {
-                    out_ << "memcpy(&(";
-                    emitLValue(arg.lhs);
-                    out_ << "), &(";
-                    emitExpr(arg.rhs);
-                    out_ << "), sizeof(";
-                    emitLValue(arg.lhs);
-                    out_ << "));\n";
-                  } else {
-                    emitLValue(arg.lhs);
-                    out_ << " = ";
-                    emitExpr(arg.rhs);
-                    out_ << ";\n";
-                  }
-                  // [v0.2.1] FP vector lanes: per-lane finite check (rule 21
-                  // lifted to FP rules 6/7 — any lane producing ±∞ or NaN
-                  // is UB). The native vec-ext division won't trap on its
-                  // own and UBSan doesn't catch SIMD div-by-zero, so we
-                  // emit an explicit check.
-                  if (lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
-                      arg.lhs.accesses.empty()) {
-                    auto &vtFp = std::get<VecType>(lhsTy->v);
-                    if (vtFp.elem && std::holds_alternative<FloatType>(vtFp.elem->v)) {
-                      std::string base = mangleName(arg.lhs.base.name);
-                      for (std::uint64_t k = 0; k < vtFp.size; ++k) {
-                        indent();
-                        std::string lane =
-                            vecLowering_->emitLaneRead(base, vtFp, std::to_string(k));
-                        out_ << "if (!__builtin_isfinite(" << lane << ")) __builtin_trap();\n";
-                      }
-                    }
-                  }
-                  // [v0.2.1] Scalar FP UB: any ±∞ or NaN result is UB
-                  // (rules 6/7). UBSan catches some FP issues but not NaN
-                  // from 0.0/0.0; emit an explicit `isfinite` check after
-                  // FP assignments so the spec's semantics are enforced.
-                  // Also fires for FP element writes (array element / struct
-                  // field / vector lane) — the check uses the LHS in place.
-                  bool lhsIsFp = lhsTy && std::holds_alternative<FloatType>(lhsTy->v);
-                  if (lhsIsFp) {
-                    indent();
-                    out_ << "if (!__builtin_isfinite(";
-                    emitLValue(arg.lhs);
-                    out_ << ")) __builtin_trap();\n";
-                  }
-                } else if constexpr (std::is_same_v<T, AssumeInstr>) {
-                  out_ << "// assume ";
-                  emitCond(arg.cond);
-                  out_ << "\n";
-                } else if constexpr (std::is_same_v<T, RequireInstr>) {
-                  if (!noRequire_) {
-                    out_ << "assert(";
-                    emitCond(arg.cond);
-                    if (arg.message)
-                      out_ << " && \"" << *arg.message << "\"";
-                    out_ << ");\n";
-                  }
-                } else if constexpr (std::is_same_v<T, StoreInstr>) {
-                  TypePtr pointeeTy = nullptr;
-                  if (auto ptrTy = getExprType(arg.ptr)) {
-                    if (auto pt = std::get_if<PtrType>(&ptrTy->v))
-                      pointeeTy = pt->pointee;
-                  }
-                  CtxGuard ctx(isDoubleCtx_, isOrContainsF64(pointeeTy));
-                  out_ << "*";
-                  emitExpr(arg.ptr);
-                  out_ << " = ";
-                  emitExpr(arg.val);
-                  out_ << ";\n";
+    indent_level_--;
+    out_ << "}\n\n";
+  }
+
+  void CBackend::emitInstr(const Instr &ins) {
+    indent();
+    std::visit(
+        [this](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, AssignInstr>) {
+            CtxGuard ctx(isDoubleCtx_, isOrContainsF64(getLValueType(arg.lhs)));
+            // [v0.2.1] Vector LHS goes through strategy-aware paths.
+            auto lhsTy = getLValueType(arg.lhs);
+            if (lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
+                arg.lhs.accesses.empty()) {
+              auto &vt = std::get<VecType>(lhsTy->v);
+              // Strategies with native vector operations take what they
+              // can; the rest is unrolled below.
+              if (emitVecNativeAssign(arg.lhs, arg.rhs, vt))
+                return;
+              // CmpAtom and mask-form SelectAtom are otherwise lane-unroll.
+              if (arg.rhs.rest.empty()) {
+                if (auto cmpA = std::get_if<CmpAtom>(&arg.rhs.first.v)) {
+                  emitVecCmpAssign(arg.lhs, *cmpA, vt);
+                  return;
                 }
-              },
-              ins
-          );
-        }
-        indent();
-        std::visit(
-            [this](auto &&arg) {
-              using T = std::decay_t<decltype(arg)>;
-              if constexpr (std::is_same_v<T, BrTerm>) {
-                if (arg.isConditional) {
-                  out_ << "if (";
-                  emitCond(*arg.cond);
-                  out_ << ") goto " << mangleName(arg.thenLabel.name) << ";\n";
-                  indent();
-                  out_ << "else goto " << mangleName(arg.elseLabel.name) << ";\n";
-                } else {
-                  out_ << "goto " << mangleName(arg.dest.name) << ";\n";
+                if (auto sel = std::get_if<SelectAtom>(&arg.rhs.first.v)) {
+                  if (sel->maskExpr) {
+                    emitVecMaskSelectAssign(arg.lhs, *sel, vt);
+                    return;
+                  }
                 }
-              } else if constexpr (std::is_same_v<T, RetTerm>) {
-                out_ << "return";
-                if (arg.value) {
-                  CtxGuard ctx(isDoubleCtx_, isOrContainsF64(curFuncRetType_));
-                  out_ << " ";
-                  emitExpr(*arg.value);
+              }
+              // [v0.2.1] Logical right shift (LShr) is the only OpAtom
+              // that can't be expressed inline on a vec-ext type — the
+              // signed-to-unsigned reinterpret is illegal on GCC vector
+              // types. Force lane-unroll for that op regardless of
+              // strategy.
+              bool isVecLShr = false;
+              if (arg.rhs.rest.empty()) {
+                if (auto op = std::get_if<OpAtom>(&arg.rhs.first.v))
+                  isVecLShr = (op->op == AtomOpKind::LShr);
+              }
+              if (vecLowering_->needsLaneUnroll() || isVecLShr) {
+                emitVecAssign(arg.lhs, arg.rhs, vt);
+                return;
+              }
+              // vecext: fall through to the inline expression path.
+            }
+            // [v0.2.1] Scalar `cmp` assignment: emit `(l op r) ? 1 : 0`.
+            // CmpAtom can't lower as an inline expression (see emitAtom),
+            // so we special-case it at AssignInstr level for scalars too.
+            if (arg.rhs.rest.empty()) {
+              if (auto cmpA = std::get_if<CmpAtom>(&arg.rhs.first.v)) {
+                emitLValue(arg.lhs);
+                out_ << " = ((";
+                emitSelectVal(cmpA->lhs);
+                const char *op = "==";
+                switch (cmpA->op) {
+                  case RelOp::EQ:
+                    op = "==";
+                    break;
+                  case RelOp::NE:
+                    op = "!=";
+                    break;
+                  case RelOp::LT:
+                    op = "<";
+                    break;
+                  case RelOp::LE:
+                    op = "<=";
+                    break;
+                  case RelOp::GT:
+                    op = ">";
+                    break;
+                  case RelOp::GE:
+                    op = ">=";
+                    break;
                 }
-                out_ << ";\n";
-              } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
-                out_ << "// unreachable\n";
+                out_ << ") " << op << " (";
+                emitSelectVal(cmpA->rhs);
+                out_ << ")) ? 1 : 0;\n";
+                return;
               }
-            },
-            b.term
-        );
-      }
+            }
+            if (lhsTy && std::holds_alternative<ArrayType>(lhsTy->v)) {
+              out_ << "memcpy(&(";
+              emitLValue(arg.lhs);
+              out_ << "), &(";
+              emitExpr(arg.rhs);
+              out_ << "), sizeof(";
+              emitLValue(arg.lhs);
+              out_ << "));\n";
+            } else {
+              emitLValue(arg.lhs);
+              out_ << " = ";
+              emitExpr(arg.rhs);
+              out_ << ";\n";
+            }
+            // [v0.2.1] FP vector lanes: per-lane finite check (rule 21
+            // lifted to FP rules 6/7 — any lane producing ±∞ or NaN
+            // is UB). The native vec-ext division won't trap on its
+            // own and UBSan doesn't catch SIMD div-by-zero, so we
+            // emit an explicit check.
+            if (lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
+                arg.lhs.accesses.empty()) {
+              emitVecFiniteChecks(mangleName(arg.lhs.base.name), std::get<VecType>(lhsTy->v));
+            }
+            // [v0.2.1] Scalar FP UB: any ±∞ or NaN result is UB
+            // (rules 6/7). UBSan catches some FP issues but not NaN
+            // from 0.0/0.0; emit an explicit `isfinite` check after
+            // FP assignments so the spec's semantics are enforced.
+            // Also fires for FP element writes (array element / struct
+            // field / vector lane) — the check uses the LHS in place.
+            bool lhsIsFp = lhsTy && std::holds_alternative<FloatType>(lhsTy->v);
+            if (lhsIsFp && !trap(6).empty()) {
+              indent();
+              out_ << "if (!__builtin_isfinite(";
+              emitLValue(arg.lhs);
+              out_ << ")) " << trap(6) << ";\n";
+            }
+          } else if constexpr (std::is_same_v<T, AssumeInstr>) {
+            if (!checkHook_.empty()) {
+              out_ << "if (!(";
+              emitCond(arg.cond);
+              out_ << ")) " << checkHook_ << "(2, NULL);\n";
+            } else if (model_) {
+              // Specialized output hands the fact to the C compiler.
+              out_ << "if (!(";
+              emitCond(arg.cond);
+              out_ << ")) __builtin_unreachable();\n";
+            } else {
+              out_ << "// assume ";
+              emitCond(arg.cond);
+              out_ << "\n";
+            }
+          } else if constexpr (std::is_same_v<T, RequireInstr>) {
+            if (!noRequire_ && !checkHook_.empty()) {
+              out_ << "if (!(";
+              emitCond(arg.cond);
+              out_ << ")) " << checkHook_ << "(1, ";
+              if (arg.message)
+                out_ << "\"" << *arg.message << "\"";
+              else
+                out_ << "NULL";
+              out_ << ");\n";
+            } else if (!noRequire_) {
+              out_ << "assert(";
+              emitCond(arg.cond);
+              if (arg.message)
+                out_ << " && \"" << *arg.message << "\"";
+              out_ << ");\n";
+            }
+          } else if constexpr (std::is_same_v<T, StoreInstr>) {
+            TypePtr pointeeTy = nullptr;
+            if (auto ptrTy = getExprType(arg.ptr)) {
+              if (auto pt = std::get_if<PtrType>(&ptrTy->v))
+                pointeeTy = pt->pointee;
+            }
+            CtxGuard ctx(isDoubleCtx_, isOrContainsF64(pointeeTy));
+            out_ << "*";
+            emitExpr(arg.ptr);
+            out_ << " = ";
+            emitExpr(arg.val);
+            out_ << ";\n";
+          }
+        },
+        ins
+    );
+  }
 
-      indent_level_--;
-      out_ << "}\n\n";
+  void CBackend::emitInstrs(const Block &b) {
+    std::vector<LaneRun> runs = findLaneRuns(b);
+    auto run = runs.begin();
+    for (std::size_t i = 0; i < b.instrs.size(); ++i) {
+      if (run != runs.end() && run->first == i) {
+        bool emitted = emitLaneRun(*run);
+        i += emitted ? run->lanes - 1 : 0;
+        ++run;
+        if (emitted)
+          continue;
+      }
+      emitInstr(b.instrs[i]);
     }
   }
 
+  bool CBackend::emitLaneRun(const LaneRun &run) {
+    auto vecTy = varTypes_.find(run.vec);
+    const VecType *vt = vecTy == varTypes_.end() ? nullptr : TypeUtils::asVec(vecTy->second);
+    LValue row = *run.element;
+    row.accesses.pop_back();
+    row.id = 0; // not the element's type
+    const ArrayType *at = TypeUtils::asArray(getLValueType(row));
+    // i1 lanes are masks, not stored like an array's flags.
+    if (!vt || vt->size != run.lanes || !at || at->size < run.lanes ||
+        !TypeUtils::areTypesEqual(at->elem, vt->elem) || intWidth(vt->elem) == 1)
+      return false;
+
+    // The first element, whose index is checked once for all lanes (rule 2).
+    const Index &first = std::get<AccessIndex>(run.element->accesses.back()).index;
+    std::ostringstream tmp;
+    std::streambuf *origBuf = out_.rdbuf(tmp.rdbuf());
+    emitLValue(row);
+    out_.rdbuf(origBuf);
+    std::string at0 = mangleName(std::get<LocalId>(std::get<LocalOrSymId>(first)).name);
+    std::uint64_t last = at->size - run.lanes;
+    if (!indexWithin(first, last) && !trap(2).empty())
+      at0 = "({ int64_t _i = (" + at0 + "); if ((uint64_t)_i > " + std::to_string(last) +
+            "ull) " + trap(2) + "; _i; })";
+    std::string elems = "&" + tmp.str() + "[" + at0 + "]";
+
+    indent();
+    if (run.store)
+      vecLowering_->emitStoreContiguous(out_, elems, mangleName(run.vec), *vt);
+    else
+      vecLowering_->emitLoadContiguous(out_, mangleName(run.vec), *vt, elems);
+    out_ << ";\n";
+    return true;
+  }
+
+  void CBackend::emitTerm(std::size_t b, const Terminator &term) {
+    std::visit(
+        [&](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, BrTerm>) {
+            emitBranch(b, arg);
+          } else if constexpr (std::is_same_v<T, RetTerm>) {
+            indent();
+            out_ << "return";
+            if (arg.value) {
+              CtxGuard ctx(isDoubleCtx_, isOrContainsF64(curFuncRetType_));
+              out_ << " ";
+              emitExpr(*arg.value);
+            }
+            out_ << ";\n";
+          } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
+            indent();
+            out_ << "// unreachable\n";
+          }
+        },
+        term
+    );
+  }
+
   void CBackend::emitExpr(const Expr &expr) {
+    if (ubChecks_ == UbChecks::Explicit && !expr.rest.empty()) {
+      // Signed overflow of each `+`/`-` (rule 4), left to right.
+      TypePtr type = exprIntType(expr);
+      if (int w = intWidth(type); w > 1) {
+        std::string t = cTypeName(type);
+        out_ << "(";
+        for (auto it = expr.rest.rbegin(); it != expr.rest.rend(); ++it)
+          out_ << "SYMIR_ARITH(" << (it->op == AddOp::Plus ? "add" : "sub") << ", " << t << ", "
+               << w << ", ";
+        emitAtom(expr.first);
+        for (const auto &term: expr.rest) {
+          out_ << ", ";
+          emitAtom(term.atom);
+          out_ << ")";
+        }
+        out_ << ")";
+        return;
+      }
+    }
     out_ << "(";
     emitAtom(expr.first);
     for (const auto &t: expr.rest) {
@@ -699,6 +1015,8 @@ namespace symir {
         [this](auto &&arg) {
           using T = std::decay_t<decltype(arg)>;
           if constexpr (std::is_same_v<T, OpAtom>) {
+            if (ubChecks_ == UbChecks::Explicit && emitCheckedOp(arg))
+              return;
             if (arg.op == AtomOpKind::LShr) {
               // LShr is the logical (unsigned) right shift. C's signed `>>`
               // is implementation-defined for negative LHS, so we cast through
@@ -857,13 +1175,18 @@ namespace symir {
             // pointer that doesn't have enough room for the pointee. Use
             // __builtin_object_size so we trap when the pointer has been
             // walked past its originating field/array.
+            if (ubChecks_ == UbChecks::None) {
+              out_ << "*";
+              emitLValue(arg.rval);
+              return;
+            }
             out_ << "({ __typeof__(";
             emitLValue(arg.rval);
             out_ << ") _pl = ";
             emitLValue(arg.rval);
-            out_ << "; if (!_pl) __builtin_trap();"
+            out_ << "; if (!_pl) " << trap(9) << ";"
                  << " if (__builtin_object_size(_pl, 0) != (size_t)-1 &&"
-                 << "     __builtin_object_size(_pl, 0) < sizeof(*_pl)) __builtin_trap();"
+                 << "     __builtin_object_size(_pl, 0) < sizeof(*_pl)) " << trap(11) << ";"
                  << " *_pl; })";
           } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
             // [v0.2.1] ptrindex p, i → element pointer. Rule 17 (null nav),
@@ -879,15 +1202,22 @@ namespace symir {
                 if (auto at = std::get_if<ArrayType>(&pt->pointee->v))
                   arrSize = at->size;
             }
+            if (ubChecks_ == UbChecks::None) {
+              emitLValue(arg.rval);
+              out_ << " + (int64_t)(";
+              emitIndex(arg.index);
+              out_ << ")";
+              return;
+            }
             out_ << "({ __typeof__(";
             emitLValue(arg.rval);
             out_ << ") _pi = ";
             emitLValue(arg.rval);
             out_ << "; int64_t _ii = (int64_t)(";
             emitIndex(arg.index);
-            out_ << "); if (!_pi) __builtin_trap();";
-            if (arrSize > 0)
-              out_ << " if (_ii < 0 || (uint64_t)_ii > " << arrSize << "ULL) __builtin_trap();";
+            out_ << "); if (!_pi) " << trap(17) << ";";
+            if (arrSize > 0 && !indexWithin(arg.index, arrSize))
+              out_ << " if (_ii < 0 || (uint64_t)_ii > " << arrSize << "ULL) " << trap(16) << ";";
             // The pointer p has C type "T *" (pointee array decayed), so
             // (p + i) is the element-pointer of type T *.
             out_ << " _pi + _ii; })";
@@ -897,12 +1227,18 @@ namespace symir {
             // __builtin_object_size: a valid struct pointer has at least
             // sizeof(struct) bytes of object remaining; one-past-end has
             // zero bytes (and GCC reports 0).
+            if (ubChecks_ == UbChecks::None) {
+              out_ << "&(";
+              emitLValue(arg.rval);
+              out_ << "->" << arg.field << ")";
+              return;
+            }
             out_ << "({ __typeof__(";
             emitLValue(arg.rval);
             out_ << ") _pf = ";
             emitLValue(arg.rval);
-            out_ << "; if (!_pf) __builtin_trap();"
-                 << " if (__builtin_object_size(_pf, 0) < sizeof(*_pf)) __builtin_trap();"
+            out_ << "; if (!_pf) " << trap(17) << ";"
+                 << " if (__builtin_object_size(_pf, 0) < sizeof(*_pf)) " << trap(19) << ";"
                  << " &(_pf->" << arg.field << "); })";
           } else if constexpr (std::is_same_v<T, CastAtom>) {
             // [v0.2.1] Vector cast: a C-style `(target_vec_t)(src_vec)`
@@ -929,6 +1265,19 @@ namespace symir {
             out_ << "(";
             emitType(arg.dstType);
             out_ << ")(";
+            // Float-to-integer out of range (rule 8).
+            int ftoiWidth = 0;
+            if (ubChecks_ == UbChecks::Explicit) {
+              TypePtr srcTy;
+              if (auto lv = std::get_if<LValue>(&arg.src))
+                srcTy = getLValueType(*lv);
+              else if (auto sym = std::get_if<SymId>(&arg.src))
+                srcTy = varTypes_.count(sym->name) ? varTypes_.at(sym->name) : nullptr;
+              if (srcTy && std::holds_alternative<FloatType>(srcTy->v))
+                ftoiWidth = intWidth(arg.dstType);
+            }
+            if (ftoiWidth > 1)
+              out_ << "SYMIR_FTOI(" << ftoiWidth << ", ";
             std::visit(
                 [&](auto &&src) {
                   using S = std::decay_t<decltype(src)>;
@@ -940,13 +1289,15 @@ namespace symir {
                     if (!isDoubleCtx_)
                       out_ << "f";
                   } else if constexpr (std::is_same_v<S, SymId>) {
-                    out_ << getMangledSymbolName(curFuncName_, src.name) << "()";
+                    emitSymRef(src.name);
                   } else {
                     emitLValue(src);
                   }
                 },
                 arg.src
             );
+            if (ftoiWidth > 1)
+              out_ << ")";
             out_ << ")";
           }
         },
@@ -976,7 +1327,12 @@ namespace symir {
       }
       if (auto id = std::get_if<LocalOrSymId>(cf)) {
         std::string nm = std::visit([](auto &&x) { return x.name; }, *id);
-        return mangleName(nm);
+        auto vinfo = varTypes_.find(nm);
+        if (vinfo != varTypes_.end() && std::holds_alternative<VecType>(vinfo->second->v))
+          return vecLowering_->emitLaneRead(
+              laneOperand(nm), std::get<VecType>(vinfo->second->v), kExpr
+          );
+        return laneOperand(nm);
       }
     }
     return "/*?*/";
@@ -1094,9 +1450,9 @@ namespace symir {
               auto vinfo = varTypes_.find(nm);
               if (vinfo != varTypes_.end() && std::holds_alternative<VecType>(vinfo->second->v)) {
                 auto &vvt = std::get<VecType>(vinfo->second->v);
-                return vecLowering_->emitLaneRead(mangleName(nm), vvt, kS);
+                return vecLowering_->emitLaneRead(laneOperand(nm), vvt, kS);
               }
-              return mangleName(nm);
+              return laneOperand(nm);
             }
             return "/*?coef*/";
           } else if constexpr (std::is_same_v<T, OpAtom>) {
@@ -1115,9 +1471,9 @@ namespace symir {
               auto vinfo = varTypes_.find(nm);
               if (vinfo != varTypes_.end() && std::holds_alternative<VecType>(vinfo->second->v)) {
                 auto &vvt = std::get<VecType>(vinfo->second->v);
-                coefLane = vecLowering_->emitLaneRead(mangleName(nm), vvt, kS);
+                coefLane = vecLowering_->emitLaneRead(laneOperand(nm), vvt, kS);
               } else {
-                coefLane = mangleName(nm);
+                coefLane = laneOperand(nm);
               }
             } else {
               coefLane = "/*?coef*/";
@@ -1260,6 +1616,177 @@ namespace symir {
     }
   }
 
+  void CBackend::emitVecFiniteChecks(const std::string &name, const VecType &vt) {
+    if (!vt.elem || !std::holds_alternative<FloatType>(vt.elem->v) || trap(6).empty())
+      return;
+    for (std::uint64_t k = 0; k < vt.size; ++k) {
+      indent();
+      std::string lane = vecLowering_->emitLaneRead(name, vt, std::to_string(k));
+      out_ << "if (!__builtin_isfinite(" << lane << ")) " << trap(6) << ";\n";
+    }
+  }
+
+  std::string CBackend::vecNativeCoefChunk(const Coef &cf, const VecType &vt, std::size_t c) {
+    if (auto i = std::get_if<IntLit>(&cf))
+      return vecLowering_->broadcastChunk(std::to_string(i->value), vt);
+    if (auto f = std::get_if<FloatLit>(&cf)) {
+      std::ostringstream os;
+      os.precision(17);
+      os << f->value;
+      return vecLowering_->broadcastChunk(os.str(), vt);
+    }
+    std::string nm = std::visit([](auto &&x) { return x.name; }, std::get<LocalOrSymId>(cf));
+    auto vinfo = varTypes_.find(nm);
+    if (vinfo != varTypes_.end() && std::holds_alternative<VecType>(vinfo->second->v))
+      return vecLowering_->loadChunk(laneOperand(nm), vt, c);
+    return vecLowering_->broadcastChunk(laneOperand(nm), vt);
+  }
+
+  std::string
+  CBackend::vecNativeSelectValChunk(const SelectVal &sv, const VecType &vt, std::size_t c) {
+    if (auto rv = std::get_if<RValue>(&sv))
+      return rv->accesses.empty() ? vecLowering_->loadChunk(mangleName(rv->base.name), vt, c) : "";
+    return vecNativeCoefChunk(std::get<Coef>(sv), vt, c);
+  }
+
+  std::string CBackend::vecNativeAtomChunk(const Atom &a, const VecType &vt, std::size_t c) {
+    return std::visit(
+        [&](auto &&arg) -> std::string {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, RValueAtom>) {
+            if (!arg.rval.accesses.empty())
+              return "";
+            return vecLowering_->loadChunk(mangleName(arg.rval.base.name), vt, c);
+          } else if constexpr (std::is_same_v<T, CoefAtom>) {
+            return vecNativeCoefChunk(arg.coef, vt, c);
+          } else if constexpr (std::is_same_v<T, OpAtom>) {
+            VecOp op;
+            switch (arg.op) {
+              case AtomOpKind::Mul:
+                op = VecOp::Mul;
+                break;
+              case AtomOpKind::Div:
+                op = VecOp::Div;
+                break;
+              case AtomOpKind::And:
+                op = VecOp::And;
+                break;
+              case AtomOpKind::Or:
+                op = VecOp::Or;
+                break;
+              case AtomOpKind::Xor:
+                op = VecOp::Xor;
+                break;
+              case AtomOpKind::Shl:
+                op = VecOp::Shl;
+                break;
+              case AtomOpKind::Shr:
+                op = VecOp::Shr;
+                break;
+              case AtomOpKind::LShr:
+                op = VecOp::LShr;
+                break;
+              default:
+                return ""; // Mod has no SIMD instruction anywhere
+            }
+            if (!arg.rval.accesses.empty())
+              return "";
+            std::string lhs = vecNativeCoefChunk(arg.coef, vt, c);
+            if (lhs.empty())
+              return "";
+            std::string rhs = vecLowering_->loadChunk(mangleName(arg.rval.base.name), vt, c);
+            return vecLowering_->binaryChunk(op, vt, c, lhs, rhs);
+          } else if constexpr (std::is_same_v<T, UnaryAtom>) {
+            if (!arg.rval.accesses.empty())
+              return "";
+            return vecLowering_->notChunk(
+                vt, vecLowering_->loadChunk(mangleName(arg.rval.base.name), vt, c)
+            );
+          } else {
+            // Casts change the lane width, so chunks don't line up; cmp
+            // and select are handled as whole instructions.
+            return "";
+          }
+        },
+        a.v
+    );
+  }
+
+  bool CBackend::emitVecNativeAssign(const LValue &lhs, const Expr &rhs, const VecType &vt) {
+    std::string dst = mangleName(lhs.base.name);
+    std::vector<std::string> stmts;
+    bool finiteChecks = false;
+    if (rhs.rest.empty() && std::holds_alternative<CmpAtom>(rhs.first.v)) {
+      const auto &cmp = std::get<CmpAtom>(rhs.first.v);
+      auto rv = std::get_if<RValue>(&cmp.lhs);
+      TypePtr t = rv ? getLValueType(*rv) : nullptr;
+      if (!t || !std::holds_alternative<VecType>(t->v))
+        return false;
+      const auto &operandVt = std::get<VecType>(t->v);
+      std::size_t chunks = vecLowering_->nativeChunks(operandVt);
+      for (std::size_t c = 0; c < chunks; ++c) {
+        std::string l = vecNativeSelectValChunk(cmp.lhs, operandVt, c);
+        std::string r = vecNativeSelectValChunk(cmp.rhs, operandVt, c);
+        if (l.empty() || r.empty())
+          return false;
+        stmts.push_back(vecLowering_->compareChunk(dst, cmp.op, operandVt, c, l, r));
+      }
+    } else {
+      std::size_t chunks = vecLowering_->nativeChunks(vt);
+      if (!chunks)
+        return false;
+      auto sel = rhs.rest.empty() ? std::get_if<SelectAtom>(&rhs.first.v) : nullptr;
+      if (sel && !sel->maskExpr)
+        return false;
+      const RValueAtom *mask = nullptr;
+      if (sel) {
+        mask = sel->maskExpr->rest.empty() ? std::get_if<RValueAtom>(&sel->maskExpr->first.v)
+                                           : nullptr;
+        if (!mask || !mask->rval.accesses.empty())
+          return false;
+      } else if (rhs.rest.empty() && std::holds_alternative<RValueAtom>(rhs.first.v)) {
+        return false; // a plain copy: emitWholeCopy does better
+      }
+      for (std::size_t c = 0; c < chunks; ++c) {
+        std::string v;
+        if (sel) {
+          std::string t = vecNativeSelectValChunk(sel->vtrue, vt, c);
+          std::string f = vecNativeSelectValChunk(sel->vfalse, vt, c);
+          if (t.empty() || f.empty())
+            return false;
+          v = vecLowering_->selectChunk(mangleName(mask->rval.base.name), vt, c, t, f);
+        } else {
+          v = vecNativeAtomChunk(rhs.first, vt, c);
+          for (const auto &tail: rhs.rest) {
+            if (v.empty())
+              break;
+            std::string r = vecNativeAtomChunk(tail.atom, vt, c);
+            if (r.empty())
+              return false;
+            v = vecLowering_->binaryChunk(
+                tail.op == AddOp::Plus ? VecOp::Add : VecOp::Sub, vt, c, v, r
+            );
+          }
+        }
+        if (v.empty())
+          return false;
+        stmts.push_back(vecLowering_->storeChunk(dst, vt, c, v));
+      }
+      finiteChecks = !sel;
+    }
+    // Nothing is emitted until every chunk has a native form.
+    if (stmts.empty() || std::find(stmts.begin(), stmts.end(), "") != stmts.end())
+      return false;
+    for (std::size_t i = 0; i < stmts.size(); ++i) {
+      if (i)
+        indent();
+      out_ << stmts[i] << ";\n";
+    }
+    if (finiteChecks)
+      emitVecFiniteChecks(dst, vt);
+    return true;
+  }
+
   void CBackend::emitCond(const Cond &cond) {
     // Take the type from either operand: SymIR requires lhs and rhs to share
     // a type, so the disjunction is just defensive against missing lookups.
@@ -1313,12 +1840,12 @@ namespace symir {
           // an IntLit index the parser already pinned it, so skip the
           // check (the typechecker may also have rejected it).
           bool isLit = std::holds_alternative<IntLit>(ai->index);
-          if (!isLit) {
+          if (!isLit && !indexWithin(ai->index, vt.size - 1) && !trap(20).empty()) {
             // Wrap with a GCC statement-expression: evaluate idx once,
             // trap if out of bounds, then read the lane.
             std::string wrapped = "({ int64_t _vi = (" + idxStr +
                                   "); if ((uint64_t)_vi >= (uint64_t)" + std::to_string(vt.size) +
-                                  "ull) __builtin_trap(); _vi; })";
+                                  "ull) " + trap(20) + "; _vi; })";
             out_ << vecLowering_->emitLaneRead(mangleName(lv.base.name), vt, wrapped);
           } else {
             out_ << vecLowering_->emitLaneRead(mangleName(lv.base.name), vt, idxStr);
@@ -1328,13 +1855,26 @@ namespace symir {
       }
     }
     out_ << mangleName(lv.base.name);
+    // Under UbChecks::Explicit, the type reached so far, for the bounds of
+    // array indices (rule 2).
+    TypePtr type;
+    if (ubChecks_ == UbChecks::Explicit && !lv.accesses.empty())
+      type = getLValueType(LValue{lv.base, {}, lv.span});
     for (const auto &acc: lv.accesses) {
       if (auto ai = std::get_if<AccessIndex>(&acc)) {
-        out_ << "[";
+        auto at = type ? std::get_if<ArrayType>(&type->v) : nullptr;
+        auto lit = std::get_if<IntLit>(&ai->index);
+        bool check = at &&
+                     !(lit && lit->value >= 0 && static_cast<uint64_t>(lit->value) < at->size) &&
+                     !indexWithin(ai->index, at->size - 1);
+        out_ << (check ? "[SYMIR_INDEX(" + std::to_string(at->size) + ", " : "[");
         emitIndex(ai->index);
-        out_ << "]";
+        out_ << (check ? ")]" : "]");
+        type = at ? at->elem : nullptr;
       } else if (auto af = std::get_if<AccessField>(&acc)) {
         out_ << "." << af->field;
+        auto st = type ? std::get_if<StructType>(&type->v) : nullptr;
+        type = st ? findStructFieldType(st->name.name, af->field) : nullptr;
       }
     }
   }
@@ -1355,7 +1895,7 @@ namespace symir {
             std::visit(
                 [this](auto &&id) {
                   if constexpr (std::is_same_v<std::decay_t<decltype(id)>, SymId>) {
-                    out_ << getMangledSymbolName(curFuncName_, id.name) << "()";
+                    emitSymRef(id.name);
                   } else {
                     out_ << mangleName(id.name);
                   }
@@ -1368,6 +1908,46 @@ namespace symir {
     );
   }
 
+  void CBackend::emitSymRef(const std::string &sym) {
+    const SymValue *val = symValue(curFuncName_, sym);
+    auto ty = varTypes_.find(sym);
+    if (!val || ty == varTypes_.end()) {
+      out_ << getMangledSymbolName(curFuncName_, sym) << "()";
+      return;
+    }
+    // A specialized sym: its value, in the type its extern returned.
+    out_ << "((";
+    emitType(ty->second);
+    out_ << ")";
+    if (auto d = std::get_if<double>(val))
+      out_ << formatFloatLit(*d);
+    else if (std::holds_alternative<FloatType>(ty->second->v))
+      out_ << formatFloatLit(static_cast<double>(std::get<int64_t>(*val)));
+    else if (std::get<int64_t>(*val) == INT64_MIN)
+      out_ << "INT64_MIN";
+    else
+      out_ << std::get<int64_t>(*val) << "ll";
+    out_ << ")";
+  }
+
+  std::string CBackend::symLaneLocal(const std::string &sym) {
+    return "_symir_sym_" + stripSigil(sym);
+  }
+
+  std::string CBackend::laneOperand(const std::string &name) {
+    if (name.size() < 2 || name[1] != '?')
+      return mangleName(name);
+    auto ty = varTypes_.find(name);
+    if (vecLowering_->needsLaneUnroll() && ty != varTypes_.end() &&
+        std::holds_alternative<VecType>(ty->second->v))
+      return symLaneLocal(name);
+    std::ostringstream tmp;
+    std::streambuf *origBuf = out_.rdbuf(tmp.rdbuf());
+    emitSymRef(name);
+    out_.rdbuf(origBuf);
+    return tmp.str();
+  }
+
   void CBackend::emitSelectVal(const SelectVal &sv) {
     if (std::holds_alternative<RValue>(sv))
       emitLValue(std::get<RValue>(sv));
@@ -1385,7 +1965,7 @@ namespace symir {
             std::visit(
                 [this](auto &&id) {
                   if constexpr (std::is_same_v<std::decay_t<decltype(id)>, SymId>) {
-                    out_ << getMangledSymbolName(curFuncName_, id.name) << "()";
+                    emitSymRef(id.name);
                   } else {
                     out_ << mangleName(id.name);
                   }
@@ -1413,7 +1993,7 @@ namespace symir {
           out_ << "f";
         break;
       case InitVal::Kind::Sym:
-        out_ << getMangledSymbolName(curFuncName_, std::get<SymId>(iv.value).name) << "()";
+        emitSymRef(std::get<SymId>(iv.value).name);
         break;
       case InitVal::Kind::Local:
         out_ << mangleName(std::get<LocalId>(iv.value).name);
@@ -1453,6 +2033,9 @@ namespace symir {
   }
 
   TypePtr CBackend::getLValueType(const LValue &lv) {
+    if (nodeTypes_)
+      if (auto t = nodeTypes_->of(lv))
+        return t;
     auto it = varTypes_.find(lv.base.name);
     // Every let-local, param, and sym is recorded in ``recordVar`` at the
     // top of each function; reaching this assert means a code path emitted
@@ -1543,6 +2126,12 @@ namespace symir {
   }
 
   TypePtr CBackend::getAtomType(const Atom &atom) {
+    // Pointer-forming atoms would otherwise build a fresh ptr type.
+    if (nodeTypes_ && (std::holds_alternative<AddrAtom>(atom.v) ||
+                       std::holds_alternative<PtrIndexAtom>(atom.v) ||
+                       std::holds_alternative<PtrFieldAtom>(atom.v)))
+      if (auto t = nodeTypes_->of(atom))
+        return t;
     return std::visit(
         [this](auto &&arg) -> TypePtr {
           using T = std::decay_t<decltype(arg)>;
@@ -0,0 +1,501 @@
+// Benchmark driver of `symirc --emit-bench` (CBackend::setBenchEntry).
+//
+// The driver is plain C appended to the translated program: a table of
+// input slots (the entry's parameters, then the syms of every function
+// that specialize() did not compile in, one slot per vector lane),
+// accessors answering each sym from the tuple of the call in progress,
+// and a `main` that fills tuples, drops those a check rejects, and times
+// the entry over the rest.
+
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "backend/c_backend.hpp"
+
+namespace symir {
+
+  namespace {
+
+    struct BenchSlot {
+      std::string name; // `%x`, or `%?v[2]` for a lane
+      TypePtr type;     // scalar
+      const Domain *domain;
+    };
+
+    bool isScalar(const TypePtr &t) {
+      return t &&
+             (std::holds_alternative<IntType>(t->v) || std::holds_alternative<FloatType>(t->v));
+    }
+
+    bool isBenchable(const TypePtr &t) {
+      if (auto vt = std::get_if<VecType>(&t->v))
+        return isScalar(vt->elem);
+      return isScalar(t);
+    }
+
+    int intBits(const IntType &it) {
+      return it.bits.value_or(it.kind == IntType::Kind::I32 ? 32 : 64);
+    }
+
+    std::string cScalarType(const TypePtr &t) {
+      if (auto ft = std::get_if<FloatType>(&t->v))
+        return ft->kind == FloatType::Kind::F32 ? "float" : "double";
+      int bits = intBits(std::get<IntType>(t->v));
+      if (bits <= 8)
+        return "int8_t";
+      if (bits <= 16)
+        return "int16_t";
+      if (bits <= 32)
+        return "int32_t";
+      return "int64_t";
+    }
+
+    std::string sirScalarType(const TypePtr &t) {
+      if (auto ft = std::get_if<FloatType>(&t->v))
+        return ft->kind == FloatType::Kind::F32 ? "f32" : "f64";
+      return "i" + std::to_string(intBits(std::get<IntType>(t->v)));
+    }
+
+    std::string int64Lit(std::int64_t v) {
+      return v == INT64_MIN ? "INT64_MIN" : std::to_string(v) + "ll";
+    }
+
+    // C string literal of a SymIR name; only `"` and `\` need escaping.
+    std::string quoted(const std::string &s) {
+      std::string r = "\"";
+      for (char c: s) {
+        if (c == '"' || c == '\\')
+          r += '\\';
+        r += c;
+      }
+      return r + "\"";
+    }
+
+    // Appends the slots of one value: one, or one per lane of a vector.
+    void addSlots(
+        std::vector<BenchSlot> &slots, const std::string &name, const TypePtr &t, const Domain *d
+    ) {
+      if (auto vt = std::get_if<VecType>(&t->v)) {
+        for (std::uint64_t k = 0; k < vt->size; ++k)
+          slots.push_back({name + "[" + std::to_string(k) + "]", vt->elem, d});
+        return;
+      }
+      slots.push_back({name, t, d});
+    }
+
+    // The C expression reading slot `i` of tuple `t` as `type`.
+    std::string slotRead(const std::string &t, std::size_t i, const TypePtr &type) {
+      std::string raw = t + "[" + std::to_string(i) + "]";
+      if (auto ft = std::get_if<FloatType>(&type->v))
+        return ft->kind == FloatType::Kind::F32 ? "(float)symir_bench_f64(" + raw + ")"
+                                                : "symir_bench_f64(" + raw + ")";
+      return "(" + cScalarType(type) + ")" + raw;
+    }
+
+  } // namespace
+
+  const FunDecl &CBackend::benchFunction(const Program &prog) const {
+    std::string name = benchEntry_[0] == '@' ? benchEntry_ : "@" + benchEntry_;
+    const FunDecl *entry = nullptr;
+    for (const auto &f: prog.funs)
+      if (f.name.name == name)
+        entry = &f;
+    if (!entry)
+      throw std::runtime_error("bench driver: no function " + name);
+    for (const auto &p: entry->params)
+      if (!isBenchable(p.type))
+        throw std::runtime_error(
+            "bench driver: parameter " + p.name.name + " of " + name +
+            " is not a scalar or vector"
+        );
+    if (entry->retType && !isBenchable(entry->retType))
+      throw std::runtime_error("bench driver: " + name + " returns an aggregate");
+    for (const auto &f: prog.funs)
+      for (const auto &s: f.syms) {
+        if (symValue(f.name.name, s.name.name))
+          continue;
+        if (!isBenchable(s.type))
+          throw std::runtime_error(
+              "bench driver: sym " + s.name.name + " of " + f.name.name +
+              " is not a scalar or vector"
+          );
+      }
+    return *entry;
+  }
+
+  void CBackend::emitBenchIncludes() {
+    out_ << "#include <stdio.h>\n"
+         << "#include <stdlib.h>\n"
+         << "#include <setjmp.h>\n"
+         << "#include <signal.h>\n"
+         << "#include <time.h>\n"
+         << "#if defined(__x86_64__) || defined(__i386__)\n"
+         << "#include <x86intrin.h>\n"
+         << "#define SYMIR_BENCH_TSC 1\n"
+         << "#endif\n";
+  }
+
+  // The entry as the driver screens the tuples with it: with the checks of
+  // UbChecks::Explicit and the requires, which the timed entry may leave
+  // out, so that no tuple kept has UB those catch. SymIR has no calls, so
+  // the entry is all a tuple runs.
+  void CBackend::emitBenchProbe(const FunDecl &entry) {
+    CBackend probe(*this, out_);
+    probe.ubChecks_ = UbChecks::Explicit;
+    probe.noRequire_ = false;
+    probe.nameSuffix_ = "_probe";
+    vecLowering_->setUbChecks(UbChecks::Explicit);
+    probe.emitFunction(entry);
+    vecLowering_->setUbChecks(ubChecks_);
+  }
+
+  void CBackend::emitBenchDriver(const Program &prog, const FunDecl &entry) {
+    std::vector<BenchSlot> slots;
+    for (const auto &p: entry.params)
+      addSlots(slots, p.name.name, p.type, nullptr);
+    std::size_t symBase = slots.size();
+    for (const auto &f: prog.funs)
+      for (const auto &s: f.syms)
+        if (!symValue(f.name.name, s.name.name))
+          addSlots(slots, s.name.name, s.type, s.domain ? &*s.domain : nullptr);
+    std::size_t stride = slots.empty() ? 1 : slots.size();
+
+    out_ << "// --- symirc --emit-bench driver for " << entry.name.name << " ---\n\n";
+
+    // The slot table, with the domain of each sym lane.
+    for (std::size_t i = 0; i < slots.size(); ++i)
+      if (auto set = slots[i].domain ? std::get_if<DomainSet>(slots[i].domain) : nullptr) {
+        out_ << "static const int64_t symir_bench_set" << i << "[] = {";
+        for (std::size_t k = 0; k < set->values.size(); ++k)
+          out_ << (k ? ", " : "") << int64Lit(set->values[k]);
+        out_ << "};\n";
+      }
+    out_ << "struct symir_bench_slot {\n"
+         << "  const char *name, *type;\n"
+         << "  int bits; /* 0 for f32 and f64 */\n"
+         << "  int ranged;\n"
+         << "  int64_t lo, hi;\n"
+         << "  const int64_t *set;\n"
+         << "  size_t nset;\n"
+         << "};\n"
+         << "static const struct symir_bench_slot symir_bench_slots[] = {\n";
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+      const BenchSlot &s = slots[i];
+      auto it = std::get_if<IntType>(&s.type->v);
+      auto range = s.domain ? std::get_if<DomainInterval>(s.domain) : nullptr;
+      auto set = s.domain ? std::get_if<DomainSet>(s.domain) : nullptr;
+      out_ << "  {" << quoted(s.name) << ", \"" << sirScalarType(s.type) << "\", "
+           << (it ? intBits(*it) : 0) << ", " << (range ? 1 : 0) << ", "
+           << int64Lit(range ? range->lo : 0) << ", " << int64Lit(range ? range->hi : 0) << ", "
+           << (set ? "symir_bench_set" + std::to_string(i) : "NULL") << ", "
+           << (set ? set->values.size() : 0) << "},\n";
+    }
+    out_ << "  {NULL, NULL, 0, 0, 0, 0, NULL, 0}\n};\n"
+         << "#define SYMIR_BENCH_SLOTS " << slots.size() << "\n"
+         << "#define SYMIR_BENCH_STRIDE " << stride << "\n\n";
+
+    out_ << "static const uint64_t *symir_bench_cur; // tuple of the call in progress\n"
+         << "static volatile sig_atomic_t symir_bench_probing;\n"
+         << "static sigjmp_buf symir_bench_jmp;\n\n"
+         << "static double symir_bench_f64(uint64_t v) {\n"
+         << "  double d;\n  memcpy(&d, &v, sizeof d);\n  return d;\n}\n\n"
+         << "void symir_bench_check(int kind, const char *msg) {\n"
+         << "  if (symir_bench_probing)\n"
+         << "    siglongjmp(symir_bench_jmp, 1);\n"
+         << "  fprintf(stderr, \"bench: %s failed while timing%s%s\\n\", "
+            "kind == 1 ? \"require\" : \"assume\",\n"
+         << "          msg ? \": \" : \"\", msg ? msg : \"\");\n"
+         << "  abort();\n}\n\n"
+         << "static void symir_bench_trap(int sig) {\n"
+         << "  if (symir_bench_probing)\n"
+         << "    siglongjmp(symir_bench_jmp, 1);\n"
+         << "  signal(sig, SIG_DFL);\n  raise(sig);\n}\n\n";
+
+    // Sym accessors, answering from the current tuple.
+    std::size_t slot = symBase;
+    for (const auto &f: prog.funs)
+      for (const auto &s: f.syms) {
+        if (symValue(f.name.name, s.name.name))
+          continue; // compiled in by specialize()
+        std::string fn = getMangledSymbolName(f.name.name, s.name.name);
+        if (auto vt = std::get_if<VecType>(&s.type->v)) {
+          out_ << symHooks_->typeString(*vt) << " " << fn << "(void) {\n  ";
+          symHooks_->emitLocalDecl(out_, "r", *vt);
+          out_ << ";\n";
+          for (std::uint64_t k = 0; k < vt->size; ++k)
+            out_ << "  " << symHooks_->emitLaneRead("r", *vt, std::to_string(k)) << " = "
+                 << slotRead("symir_bench_cur", slot++, vt->elem) << ";\n";
+          out_ << "  return r;\n}\n";
+        } else {
+          out_ << cScalarType(s.type) << " " << fn << "(void) {\n"
+               << "  return " << slotRead("symir_bench_cur", slot++, s.type) << ";\n}\n";
+        }
+      }
+    if (symBase < slots.size())
+      out_ << "\n";
+
+    // One call on tuple `t`, timed or screening it (emitBenchProbe). The
+    // empty asm takes the result's address and clobbers memory, so the
+    // call is neither dropped as dead nor hoisted out of the timing loop.
+    std::string callee = mangleName(entry.name.name);
+    std::string probe = callee + (needsBenchProbe() ? "_probe" : "");
+    for (const auto &[fn, target]: {std::pair(std::string("symir_bench_call"), callee),
+                                    std::pair(std::string("symir_bench_probe"), probe)}) {
+      out_ << "static void " << fn << "(const uint64_t *t) {\n"
+           << "  symir_bench_cur = t;\n";
+      slot = 0;
+      std::vector<std::string> args;
+      for (std::size_t i = 0; i < entry.params.size(); ++i) {
+        const ParamDecl &p = entry.params[i];
+        if (auto vt = std::get_if<VecType>(&p.type->v)) {
+          std::string a = "a" + std::to_string(i);
+          out_ << "  ";
+          vecLowering_->emitLocalDecl(out_, a, *vt);
+          out_ << ";\n";
+          for (std::uint64_t k = 0; k < vt->size; ++k)
+            out_ << "  " << vecLowering_->emitLaneRead(a, *vt, std::to_string(k)) << " = "
+                 << slotRead("t", slot++, vt->elem) << ";\n";
+          args.push_back(a);
+        } else {
+          args.push_back(slotRead("t", slot++, p.type));
+        }
+      }
+      out_ << "  ";
+      if (entry.retType) {
+        emitType(entry.retType);
+        out_ << " r = ";
+      }
+      out_ << target << "(";
+      for (std::size_t i = 0; i < args.size(); ++i)
+        out_ << (i ? ", " : "") << args[i];
+      out_ << ");\n";
+      if (entry.retType)
+        out_ << "  __asm__ volatile(\"\" : : \"r\"(&r) : \"memory\");\n";
+      else
+        out_ << "  __asm__ volatile(\"\" : : : \"memory\");\n";
+      out_ << "}\n\n";
+    }
+
+    out_ << R"(static uint64_t symir_bench_rng;
+
+static uint64_t symir_bench_next(void) { /* splitmix64 */
+  uint64_t z = (symir_bench_rng += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/* A value for slot `s`: in its domain if it has one, else in
+   [-2^(mag-1), 2^(mag-1)) for integers and (-2^mag, 2^mag) for floats. */
+static uint64_t symir_bench_gen(const struct symir_bench_slot *s, int mag) {
+  uint64_t r = symir_bench_next();
+  if (s->nset)
+    return (uint64_t)s->set[r % s->nset];
+  if (s->ranged) {
+    uint64_t span = (uint64_t)s->hi - (uint64_t)s->lo + 1;
+    return (uint64_t)s->lo + (span ? r % span : r);
+  }
+  if (s->bits == 0) {
+    double d = ((double)(r >> 11) / 4503599627370496.0 - 1.0) * (double)(1ull << mag);
+    uint64_t v;
+    memcpy(&v, &d, sizeof v);
+    return v;
+  }
+  int b = mag < s->bits ? mag : s->bits;
+  if (b >= 64)
+    return r;
+  return (uint64_t)((int64_t)(r & ((1ull << b) - 1)) - (int64_t)(1ull << (b - 1)));
+}
+
+static uint64_t *symir_bench_load(const char *path, size_t *n) {
+  FILE *f = fopen(path, "rb");
+  long size;
+  size_t rec = SYMIR_BENCH_SLOTS * sizeof(uint64_t);
+  uint64_t *v;
+  if (!f || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+    perror(path);
+    exit(1);
+  }
+  if (rec == 0) {
+    fprintf(stderr, "bench: the function takes no parameters or syms to read\n");
+    exit(1);
+  }
+  if (size == 0 || (size_t)size % rec != 0) {
+    fprintf(stderr, "bench: %s: %ld bytes is not a whole number of %zu-byte tuples\n", path,
+            size, rec);
+    exit(1);
+  }
+  *n = (size_t)size / rec;
+  v = malloc((size_t)size);
+  if (!v || fread(v, rec, *n, f) != *n) {
+    fprintf(stderr, "bench: %s: read failed\n", path);
+    exit(1);
+  }
+  fclose(f);
+  return v;
+}
+
+static uint64_t symir_bench_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t symir_bench_ticks(void) {
+#ifdef SYMIR_BENCH_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int symir_bench_cmp(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* min, median, mean and max of the `n` values of `v`, which it sorts. */
+static void symir_bench_stats(const char *what, double *v, long n) {
+  double sum = 0;
+  long i;
+  for (i = 0; i < n; ++i)
+    sum += v[i];
+  qsort(v, (size_t)n, sizeof *v, symir_bench_cmp);
+  printf("%-12s min %.3f  median %.3f  mean %.3f  max %.3f\n", what, v[0],
+         n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2, sum / n, v[n - 1]);
+}
+
+static void symir_bench_usage(const char *argv0) {
+  const struct symir_bench_slot *s;
+  int i = 0;
+  fprintf(stderr,
+          "usage: %s [-n calls] [-r reps] [-w warmup] [-t tuples] [-s seed] [-b bits] [-i file]\n"
+          "  -n N  calls per repetition (default 1000000)\n"
+          "  -r N  timed repetitions (default 10)\n"
+          "  -w N  untimed warm-up calls (default 100000)\n"
+          "  -t N  tuples to generate (default 1024)\n"
+          "  -s N  seed of the generated tuples (default 1)\n"
+          "  -b N  generate integers in [-2^(N-1), 2^(N-1)) and floats in (-2^N, 2^N),\n"
+          "        or in the domain of the sym (default 8)\n"
+          "  -i F  read the tuples from F instead: 8-byte slots in host byte order,\n"
+          "        integers sign-extended and floats as f64 bits, %d per tuple:\n",
+          argv0, SYMIR_BENCH_SLOTS);
+  for (s = symir_bench_slots; s->name; ++s)
+    fprintf(stderr, "  %4d  %s %s\n", i++, s->name, s->type);
+}
+
+int main(int argc, char **argv) {
+  long calls = 1000000, reps = 10, warmup = 100000, ntuples = 1024, r, i;
+  unsigned long long seed = 1;
+  int mag = 8;
+  const char *input = NULL;
+  uint64_t *tuples;
+  size_t n = 0, k;
+  volatile size_t kept = 0, at;
+  double *ns, *cycles;
+  struct sigaction sa;
+  static const int sigs[] = {SIGILL, SIGFPE, SIGSEGV, SIGBUS, SIGTRAP, SIGABRT};
+
+  for (i = 1; i < argc; ++i) {
+    const char *a = argv[i];
+    if (a[0] != '-' || !a[1] || a[2] || !strchr("nrwtsbi", a[1]) || i + 1 == argc) {
+      symir_bench_usage(argv[0]);
+      return strcmp(a, "-h") == 0 ? 0 : 1;
+    }
+    const char *v = argv[++i];
+    switch (a[1]) {
+      case 'n': calls = atol(v); break;
+      case 'r': reps = atol(v); break;
+      case 'w': warmup = atol(v); break;
+      case 't': ntuples = atol(v); break;
+      case 's': seed = strtoull(v, NULL, 0); break;
+      case 'b': mag = atoi(v); break;
+      default: input = v; break;
+    }
+  }
+  if (calls < 1 || reps < 1 || warmup < 0 || ntuples < 1 || mag < 1 || mag > 62) {
+    symir_bench_usage(argv[0]);
+    return 1;
+  }
+
+  if (input) {
+    tuples = symir_bench_load(input, &n);
+  } else {
+    n = SYMIR_BENCH_SLOTS ? (size_t)ntuples : 1;
+    tuples = calloc(n, SYMIR_BENCH_STRIDE * sizeof(uint64_t));
+    if (!tuples) {
+      fprintf(stderr, "bench: out of memory\n");
+      return 1;
+    }
+    symir_bench_rng = seed;
+#if SYMIR_BENCH_SLOTS
+    for (k = 0; k < n * SYMIR_BENCH_SLOTS; ++k)
+      tuples[k] = symir_bench_gen(&symir_bench_slots[k % SYMIR_BENCH_SLOTS], mag);
+#endif
+  }
+
+  /* Drop the tuples that fail a check, trap or have UB, once, before timing. */
+  memset(&sa, 0, sizeof sa);
+  sa.sa_handler = symir_bench_trap;
+  sigemptyset(&sa.sa_mask);
+  for (i = 0; i < (long)(sizeof sigs / sizeof *sigs); ++i)
+    sigaction(sigs[i], &sa, NULL);
+  symir_bench_probing = 1;
+  for (at = 0; at < n; ++at) {
+    if (sigsetjmp(symir_bench_jmp, 1))
+      continue;
+    symir_bench_probe(tuples + at * SYMIR_BENCH_STRIDE);
+    memmove(tuples + kept * SYMIR_BENCH_STRIDE, tuples + at * SYMIR_BENCH_STRIDE,
+            SYMIR_BENCH_STRIDE * sizeof(uint64_t));
+    kept = kept + 1;
+  }
+  symir_bench_probing = 0;
+  for (i = 0; i < (long)(sizeof sigs / sizeof *sigs); ++i)
+    signal(sigs[i], SIG_DFL);
+  if (kept == 0) {
+    fprintf(stderr, "bench: all %zu tuples fail a check or trap\n", n);
+    return 1;
+  }
+
+  for (i = 0, k = 0; i < warmup; ++i) {
+    symir_bench_call(tuples + k * SYMIR_BENCH_STRIDE);
+    if (++k == kept)
+      k = 0;
+  }
+  ns = malloc((size_t)reps * sizeof *ns);
+  cycles = malloc((size_t)reps * sizeof *cycles);
+  if (!ns || !cycles) {
+    fprintf(stderr, "bench: out of memory\n");
+    return 1;
+  }
+  for (r = 0; r < reps; ++r) {
+    uint64_t t0 = symir_bench_ns(), c0 = symir_bench_ticks(), c1, t1;
+    for (i = 0; i < calls; ++i) {
+      symir_bench_call(tuples + k * SYMIR_BENCH_STRIDE);
+      if (++k == kept)
+        k = 0;
+    }
+    c1 = symir_bench_ticks();
+    t1 = symir_bench_ns();
+    ns[r] = (double)(t1 - t0) / (double)calls;
+    cycles[r] = (double)(c1 - c0) / (double)calls;
+  }
+
+)";
+    out_ << "  printf(\"" << entry.name.name
+         << ": %zu tuples (%zu rejected), %ld x %ld calls\\n\", (size_t)kept, n - kept, reps, "
+            "calls);\n";
+    out_ << R"(  symir_bench_stats("ns/call", ns, reps);
+#ifdef SYMIR_BENCH_TSC
+  symir_bench_stats("cycles/call", cycles, reps);
+#endif
+  free(ns);
+  free(cycles);
+  free(tuples);
+  return 0;
+}
+)";
+  }
+
+} // namespace symir
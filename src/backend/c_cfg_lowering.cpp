@@ -0,0 +1,201 @@
+// Control-flow lowering of the C backend (`symirc --cfg-lowering`).
+//
+// Goto keeps a label per block, which is cheapest to emit but leaves the C
+// compiler to rediscover loops from an arbitrary goto graph. Structured
+// nests the blocks as StructuredCfg says (the nesting the WASM backend
+// emits), so loops are `for (;;)` and merges close a `do { } while (0)`.
+// Switch numbers the blocks and dispatches on the number in one loop,
+// which compilers handle in time about linear in the number of blocks. The
+// instructions of a block are emitted the same way under all three.
+
+#include "backend/c_backend.hpp"
+
+namespace symir {
+
+  void CBackend::emitBlocks(const FunDecl &f) {
+    curLowering_ = CfgLowering::Goto;
+    curStructure_.reset();
+    constructs_.clear();
+    if (cfgLowering_ != CfgLowering::Goto && !curCfg_) {
+      DiagBag diags;
+      curCfg_.emplace(CFG::build(f, diags));
+      if (diags.hasErrors())
+        curCfg_.reset();
+    }
+    if (cfgLowering_ == CfgLowering::Structured && curCfg_)
+      curStructure_ = StructuredCfg::build(f, *curCfg_, curCfg_->dominators());
+    if (curStructure_)
+      curLowering_ = CfgLowering::Structured;
+    else if (cfgLowering_ == CfgLowering::Switch && curCfg_)
+      curLowering_ = CfgLowering::Switch;
+
+    auto live = [&](std::size_t bi) { return curLive_.empty() || curLive_[bi]; };
+    switch (curLowering_) {
+      case CfgLowering::Goto:
+        for (std::size_t bi = 0; bi < f.blocks.size(); ++bi) {
+          const Block &b = f.blocks[bi];
+          if (!live(bi))
+            continue;
+          out_ << mangleName(b.label.name) << ": ;\n"; // semicolon for empty label case
+          emitInstrs(b);
+          emitTerm(bi, b.term);
+        }
+        break;
+      case CfgLowering::Structured:
+        emitStructuredTree(curCfg_->entry);
+        break;
+      case CfgLowering::Switch:
+        indent();
+        out_ << "uint32_t _symir_pc = " << curCfg_->entry << ";\n";
+        indent();
+        out_ << "for (;;) switch (_symir_pc) {\n";
+        for (std::size_t bi = 0; bi < f.blocks.size(); ++bi) {
+          const Block &b = f.blocks[bi];
+          if (!live(bi))
+            continue;
+          indent();
+          out_ << "case " << bi << ": ; // " << mangleName(b.label.name) << "\n";
+          indent_level_++;
+          emitInstrs(b);
+          emitTerm(bi, b.term);
+          indent_level_--;
+        }
+        indent();
+        out_ << "default: __builtin_unreachable();\n";
+        indent();
+        out_ << "}\n";
+        break;
+    }
+    curStructure_.reset();
+  }
+
+  void CBackend::emitBranch(std::size_t b, const BrTerm &br) {
+    if (!br.isConditional) {
+      if (feasible(b, br.dest)) {
+        emitJump(b, br.dest);
+      } else {
+        indent();
+        out_ << "__builtin_unreachable();\n";
+      }
+      return;
+    }
+    bool thenTaken = feasible(b, br.thenLabel), elseTaken = feasible(b, br.elseLabel);
+    if (!thenTaken || !elseTaken) {
+      // Without the arms no execution takes.
+      if (thenTaken || elseTaken) {
+        emitJump(b, thenTaken ? br.thenLabel : br.elseLabel);
+      } else {
+        indent();
+        out_ << "__builtin_unreachable();\n";
+      }
+      return;
+    }
+    indent();
+    switch (curLowering_) {
+      case CfgLowering::Goto:
+        out_ << "if (";
+        emitCond(*br.cond);
+        out_ << ") goto " << mangleName(br.thenLabel.name) << ";\n";
+        indent();
+        out_ << "else goto " << mangleName(br.elseLabel.name) << ";\n";
+        break;
+      case CfgLowering::Switch:
+        out_ << "_symir_pc = (";
+        emitCond(*br.cond);
+        out_ << ") ? " << curCfg_->indexOf.at(CFG::labelKey(br.thenLabel)) << " : "
+             << curCfg_->indexOf.at(CFG::labelKey(br.elseLabel)) << ";\n";
+        indent();
+        out_ << "continue;\n";
+        break;
+      case CfgLowering::Structured:
+        out_ << "if (";
+        emitCond(*br.cond);
+        out_ << ") {\n";
+        indent_level_++;
+        emitJump(b, br.thenLabel);
+        indent_level_--;
+        indent();
+        out_ << "} else {\n";
+        indent_level_++;
+        emitJump(b, br.elseLabel);
+        indent_level_--;
+        indent();
+        out_ << "}\n";
+        break;
+    }
+  }
+
+  void CBackend::emitJump(std::size_t from, const BlockLabel &to) {
+    if (curLowering_ == CfgLowering::Switch) {
+      indent();
+      out_ << "_symir_pc = " << curCfg_->indexOf.at(CFG::labelKey(to)) << ";\n";
+      indent();
+      out_ << "continue;\n";
+      return;
+    }
+    if (curLowering_ == CfgLowering::Structured) {
+      std::size_t dst = curCfg_->indexOf.at(CFG::labelKey(to));
+      // A branch to the innermost construct leaves or restarts it; one to
+      // an outer construct (C has no labeled break) jumps to its label.
+      bool back = curStructure_->isBackEdge(from, dst);
+      if (!back && !curStructure_->isMerge[dst]) {
+        emitStructuredTree(dst);
+        return;
+      }
+      if (!constructs_.empty() && constructs_.back() == std::make_pair(back, dst)) {
+        indent();
+        out_ << (back ? "continue;\n" : "break;\n");
+        return;
+      }
+    }
+    indent();
+    out_ << "goto " << mangleName(to.name) << ";\n";
+  }
+
+  void CBackend::emitStructuredTree(std::size_t b) {
+    const StructuredCfg &sc = *curStructure_;
+    const std::string &label = sc.f->blocks[b].label.name;
+    // The targets of back edges and merge branches keep their label for
+    // the branches no construct covers.
+    if (sc.isLoopHeader[b] || sc.isMerge[b]) {
+      indent();
+      out_ << mangleName(label) << ": ;\n";
+    }
+    if (sc.isLoopHeader[b]) {
+      indent();
+      out_ << "for (;;) {\n";
+      indent_level_++;
+      constructs_.emplace_back(true, b);
+    }
+    emitStructuredWithin(b, 0);
+    if (sc.isLoopHeader[b]) {
+      constructs_.pop_back();
+      indent_level_--;
+      indent();
+      out_ << "}\n";
+    }
+  }
+
+  void CBackend::emitStructuredWithin(std::size_t b, std::size_t firstChild) {
+    const auto &children = curStructure_->mergeChildren[b];
+    if (firstChild < children.size()) {
+      std::size_t merge = children[firstChild];
+      indent();
+      out_ << "do {\n";
+      indent_level_++;
+      constructs_.emplace_back(false, merge);
+      emitStructuredWithin(b, firstChild + 1);
+      constructs_.pop_back();
+      indent_level_--;
+      indent();
+      out_ << "} while (0);\n";
+      if (curLive_.empty() || curLive_[merge])
+        emitStructuredTree(merge);
+      return;
+    }
+    const Block &block = curStructure_->f->blocks[b];
+    emitInstrs(block);
+    emitTerm(b, block.term);
+  }
+
+} // namespace symir
@@ -0,0 +1,116 @@
+// Specialized output of `symirc --specialize` (CBackend::specialize).
+//
+// Syms with a value in the model become literals, so the downstream
+// compiler sees constants where it would otherwise see extern calls. The
+// interval analysis, run with those values, then says which branch arms
+// no execution takes and which variable indices always lie in bounds; the
+// arms and the blocks only they reach are left out, and so are the bounds
+// checks. The facts hold for executions without UB, as the analysis
+// assumes, and need the `require`s it narrows through to be checked.
+
+#include <climits>
+#include <stdexcept>
+#include "backend/c_backend.hpp"
+
+namespace symir {
+
+  void CBackend::specialize(SymModel model) {
+    model_ = std::make_shared<const SymModel>(std::move(model));
+  }
+
+  void CBackend::checkModel(const Program &prog) const {
+    for (const auto &[func, syms]: *model_) {
+      const FunDecl *f = nullptr;
+      for (const auto &g: prog.funs)
+        if (g.name.name == func)
+          f = &g;
+      if (!f)
+        throw std::runtime_error("specialize: the model names no function of the program: " + func);
+      for (const auto &[name, val]: syms) {
+        const SymDecl *s = nullptr;
+        for (const auto &d: f->syms)
+          if (d.name.name == name)
+            s = &d;
+        if (!s)
+          throw std::runtime_error("specialize: " + func + " has no sym " + name);
+        if (std::holds_alternative<VecType>(s->type->v))
+          throw std::runtime_error(
+              "specialize: vector sym " + name + " of " + func + " cannot take a scalar value"
+          );
+        if (std::holds_alternative<IntType>(s->type->v) && !std::holds_alternative<int64_t>(val))
+          throw std::runtime_error(
+              "specialize: the value of integer sym " + name + " of " + func + " is not an integer"
+          );
+      }
+    }
+  }
+
+  const CBackend::SymValue *
+  CBackend::symValue(const std::string &func, const std::string &sym) const {
+    if (!model_)
+      return nullptr;
+    auto f = model_->find(func);
+    if (f == model_->end())
+      return nullptr;
+    auto it = f->second.find(sym);
+    return it == f->second.end() ? nullptr : &it->second;
+  }
+
+  void CBackend::prepareSpecialization(const FunDecl &f) {
+    curRanges_.reset();
+    curCfg_.reset();
+    curLive_.clear();
+    if (!model_ || noRequire_)
+      return;
+
+    IntervalAnalysis::FixedSyms fixed;
+    for (const auto &s: f.syms)
+      if (auto val = symValue(f.name.name, s.name.name);
+          val && std::holds_alternative<IntType>(s.type->v))
+        fixed.emplace(s.name.name, std::get<int64_t>(*val));
+    DiagBag diags;
+    curCfg_.emplace(CFG::build(f, diags));
+    if (diags.hasErrors()) {
+      curCfg_.reset();
+      return;
+    }
+    curRanges_.emplace(f, *curCfg_, fixed);
+
+    // The blocks reached from the entry along edges some execution takes.
+    curLive_.assign(curCfg_->blocks.size(), 0);
+    std::vector<std::size_t> work{curCfg_->entry};
+    curLive_[curCfg_->entry] = 1;
+    while (!work.empty()) {
+      std::size_t b = work.back();
+      work.pop_back();
+      for (std::size_t s: curCfg_->succ[b])
+        if (!curLive_[s] && curRanges_->feasible(b, s)) {
+          curLive_[s] = 1;
+          work.push_back(s);
+        }
+    }
+  }
+
+  bool CBackend::indexWithin(const Index &idx, uint64_t hi) const {
+    if (!model_)
+      return false;
+    auto within = [&](int64_t v) { return v >= 0 && static_cast<uint64_t>(v) <= hi; };
+    if (auto lit = std::get_if<IntLit>(&idx))
+      return within(lit->value);
+    if (auto sym = std::get_if<SymId>(&std::get<LocalOrSymId>(idx)))
+      if (auto val = symValue(curFuncName_, sym->name); val && std::holds_alternative<int64_t>(*val))
+        return within(std::get<int64_t>(*val));
+    if (!curRanges_)
+      return false;
+    auto range = curRanges_->range(idx);
+    return range && !range->empty() && within(range->lo) && within(range->hi);
+  }
+
+  bool CBackend::feasible(std::size_t from, const BlockLabel &to) const {
+    if (!curRanges_)
+      return true;
+    auto it = curCfg_->indexOf.find(CFG::labelKey(to));
+    return it == curCfg_->indexOf.end() || curRanges_->feasible(from, it->second);
+  }
+
+} // namespace symir
@@ -81,6 +81,20 @@ namespace symir {
       out << "for (int _k = 0; _k < " << vt.size << "; ++_k) " << lhs << "[_k] = " << rhs << "[_k]";
     }
 
+    void emitLoadContiguous(
+        std::ostream &out, const std::string &name, const VecType &vt, const std::string &elems
+    ) override {
+      (void) vt;
+      out << "memcpy(" << name << ", " << elems << ", sizeof(" << name << "))";
+    }
+
+    void emitStoreContiguous(
+        std::ostream &out, const std::string &elems, const std::string &name, const VecType &vt
+    ) override {
+      (void) vt;
+      out << "memcpy(" << elems << ", " << name << ", sizeof(" << name << "))";
+    }
+
     bool canCrossFnBoundary() const override { return false; }
 
     bool needsLaneUnroll() const override { return true; }
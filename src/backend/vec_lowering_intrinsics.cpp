@@ -0,0 +1,653 @@
+// VecLowering strategy: SIMD intrinsics (SSE4.2, AVX2, AVX-512, NEON).
+//
+// `<N> T` lowers to `struct { T l[P]; }`, P being N rounded up to whole
+// registers of the target (`_simd_6_i32` holds 8 lanes under SSE4), so a
+// vector crosses function boundaries by value like `structarray`. Lane
+// access is `v.l[k]`; whole-vector arithmetic, `cmp` and mask-form
+// `select` go through the native chunk hooks of VecLowering, one register
+// (chunk) at a time:
+//
+//   _mm_storeu_si128((__m128i *)&v.l[4], _mm_add_epi32(
+//       _mm_loadu_si128((const __m128i *)&a.l[4]), _mm_set1_epi32((int)(3))))
+//
+// The padding lanes are zeroed and otherwise computed on like any other
+// lane; they are never read back. `<N> i1` masks keep one byte per lane,
+// 0 or 1 as in the other strategies: `cmp` turns the native compare mask
+// into those bytes, and `select` widens them back to a lane-wide mask.
+//
+// Lanes of 8/16/32/64-bit integers and of f32/f64 are native. Integer
+// `+` and `-` check signed overflow in the vector and trap, as UBSan does
+// on the other strategies; integer `*`, `/`, `%` and shifts, whose UB has
+// no cheap vector check, casts, and any other lane width make the backend
+// unroll that instruction lane by lane (needsLaneUnroll).
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include "backend/vec_lowering.hpp"
+
+namespace symir {
+
+  namespace {
+
+    enum class Isa { Sse4, Avx2, Avx512, Neon };
+
+    bool isFloatElem(const TypePtr &elem) { return std::holds_alternative<FloatType>(elem->v); }
+
+    // Bits of the C type a lane is stored in.
+    int storageBits(const TypePtr &elem) {
+      if (auto it = std::get_if<IntType>(&elem->v)) {
+        int bits = it->bits.value_or(it->kind == IntType::Kind::I32 ? 32 : 64);
+        if (bits <= 8)
+          return 8; // i1 included: one byte per mask lane
+        if (bits <= 16)
+          return 16;
+        if (bits <= 32)
+          return 32;
+        return 64;
+      }
+      if (auto ft = std::get_if<FloatType>(&elem->v))
+        return ft->kind == FloatType::Kind::F32 ? 32 : 64;
+      return 0;
+    }
+
+    // Lanes whose arithmetic the intrinsics compute exactly: integers
+    // filling their C type, and floats.
+    bool isNativeElem(const TypePtr &elem) {
+      if (auto it = std::get_if<IntType>(&elem->v)) {
+        int bits = it->bits.value_or(it->kind == IntType::Kind::I32 ? 32 : 64);
+        return bits == 8 || bits == 16 || bits == 32 || bits == 64;
+      }
+      return isFloatElem(elem);
+    }
+
+    std::string elemCType(const TypePtr &elem) {
+      if (isFloatElem(elem))
+        return storageBits(elem) == 32 ? "float" : "double";
+      return "int" + std::to_string(storageBits(elem)) + "_t";
+    }
+
+    std::string elemSuffix(const TypePtr &elem) {
+      if (auto it = std::get_if<IntType>(&elem->v)) {
+        int bits = it->bits.value_or(it->kind == IntType::Kind::I32 ? 32 : 64);
+        return "i" + std::to_string(bits);
+      }
+      if (auto ft = std::get_if<FloatType>(&elem->v))
+        return ft->kind == FloatType::Kind::F32 ? "f32" : "f64";
+      return "u";
+    }
+
+    std::string typeName(const VecType &vt) {
+      return "_simd_" + std::to_string(vt.size) + "_" + elemSuffix(vt.elem);
+    }
+
+  } // namespace
+
+  class IntrinsicsLowering : public VecLowering {
+  public:
+    explicit IntrinsicsLowering(Isa isa) : isa_(isa) {}
+
+    std::string name() const override { return "intrinsics"; }
+
+    void emitPreamble(std::ostream &out, const std::vector<VecType> &usedShapes) override {
+      out << "// vec-target: " << targetName() << "\n";
+      if (isa_ == Isa::Neon) {
+        out << "#if !defined(__aarch64__) || !defined(__ARM_NEON)\n"
+            << "# error \"vec-target neon requires AArch64 with NEON\"\n"
+            << "#endif\n"
+            << "#include <arm_neon.h>\n"
+            << "static inline int8x8_t _simd_mask_bytes(const int8_t *p, size_t n) {\n"
+            << "  int8_t t[8] = {0};\n"
+            << "  memcpy(t, p, n);\n"
+            << "  return vld1_s8(t);\n"
+            << "}\n";
+      } else {
+        // Enable the target for this file only, so that no -m flag is
+        // needed; popped again by emitEpilogue.
+        out << "#if defined(__clang__)\n"
+            << "#pragma clang attribute push (__attribute__((target(\"" << targetFeatures()
+            << "\"))), apply_to = function)\n"
+            << "#elif defined(__GNUC__)\n"
+            << "#pragma GCC push_options\n"
+            << "#pragma GCC target(\"" << targetFeatures() << "\")\n"
+            << "#endif\n"
+            << "#include <immintrin.h>\n";
+        // Mask bytes of a chunk, zero-extended to a register.
+        if (isa_ == Isa::Avx512) {
+          out << "static inline __mmask64 _simd_mask_bits(const int8_t *p, size_t n) {\n"
+              << "  int8_t t[64] = {0};\n"
+              << "  memcpy(t, p, n);\n"
+              << "  __m512i v = _mm512_loadu_si512((const void *)t);\n"
+              << "  return _mm512_test_epi8_mask(v, v);\n"
+              << "}\n";
+        } else {
+          out << "static inline __m128i _simd_mask_bytes(const int8_t *p, size_t n) {\n"
+              << "  int8_t t[16] = {0};\n"
+              << "  memcpy(t, p, n);\n"
+              << "  return _mm_loadu_si128((const __m128i *)t);\n"
+              << "}\n";
+        }
+      }
+      std::set<std::string> emitted;
+      for (const auto &vt: usedShapes) {
+        std::string tn = typeName(vt);
+        if (!emitted.insert(tn).second)
+          continue;
+        out << "typedef struct { _Alignas(" << regBits() / 8 << ") " << elemCType(vt.elem)
+            << " l[" << paddedLanes(vt) << "]; } " << tn << ";\n";
+      }
+      out << "\n";
+    }
+
+    void emitEpilogue(std::ostream &out) override {
+      if (isa_ == Isa::Neon)
+        return;
+      out << "#if defined(__clang__)\n"
+          << "#pragma clang attribute pop\n"
+          << "#elif defined(__GNUC__)\n"
+          << "#pragma GCC pop_options\n"
+          << "#endif\n";
+    }
+
+    std::string typeString(const VecType &vt) override { return typeName(vt); }
+
+    void emitLocalDecl(std::ostream &out, const std::string &name, const VecType &vt) override {
+      out << typeName(vt) << " " << name << " = {{0}}";
+    }
+
+    void emitInit(
+        std::ostream &out, const std::string &name, const VecType &vt, const InitVal &iv
+    ) override {
+      (void) out;
+      (void) name;
+      (void) vt;
+      (void) iv; // per-lane init driven by the C backend.
+    }
+
+    std::string
+    emitLaneRead(const std::string &name, const VecType &vt, const std::string &idxExpr) override {
+      (void) vt;
+      return name + ".l[" + idxExpr + "]";
+    }
+
+    void emitLaneWrite(
+        std::ostream &out, const std::string &name, const VecType &vt, const std::string &idxExpr,
+        const std::string &valExpr
+    ) override {
+      (void) vt;
+      out << name << ".l[" << idxExpr << "] = " << valExpr;
+    }
+
+    void emitWholeCopy(
+        std::ostream &out, const std::string &lhs, const std::string &rhs, const VecType &vt
+    ) override {
+      (void) vt;
+      out << lhs << " = " << rhs;
+    }
+
+    // The live lanes only, not the padding.
+    void emitLoadContiguous(
+        std::ostream &out, const std::string &name, const VecType &vt, const std::string &elems
+    ) override {
+      out << "memcpy(" << name << ".l, " << elems << ", " << vt.size << " * sizeof(" << name
+          << ".l[0]))";
+    }
+
+    void emitStoreContiguous(
+        std::ostream &out, const std::string &elems, const std::string &name, const VecType &vt
+    ) override {
+      out << "memcpy(" << elems << ", " << name << ".l, " << vt.size << " * sizeof(" << name
+          << ".l[0]))";
+    }
+
+    bool canCrossFnBoundary() const override { return true; }
+
+    // C operators don't apply to the struct; what the hooks below can't
+    // lower is unrolled.
+    bool needsLaneUnroll() const override { return true; }
+
+    std::size_t nativeChunks(const VecType &vt) const override {
+      if (!isNativeElem(vt.elem))
+        return 0;
+      return paddedLanes(vt) / lanesPerChunk(vt);
+    }
+
+    std::string loadChunk(const std::string &name, const VecType &vt, std::size_t c) override {
+      std::string p = lanePtr(name, vt, c);
+      if (isa_ == Isa::Neon)
+        return "vld1q_" + neonSuffix(vt) + "(" + p + ")";
+      if (isFloatElem(vt.elem))
+        return prefix() + "loadu_" + floatSuffix(vt) + "(" + p + ")";
+      return prefix() + "loadu_" + siSuffix() + "((const " + intVecType() + " *)" + p + ")";
+    }
+
+    std::string broadcastChunk(const std::string &scalar, const VecType &vt) override {
+      std::string x = "(" + elemCType(vt.elem) + ")(" + scalar + ")";
+      if (isa_ == Isa::Neon)
+        return "vdupq_n_" + neonSuffix(vt) + "(" + x + ")";
+      if (isFloatElem(vt.elem))
+        return prefix() + "set1_" + floatSuffix(vt) + "(" + x + ")";
+      int bits = storageBits(vt.elem);
+      if (bits == 64)
+        return prefix() + (isa_ == Isa::Avx512 ? "set1_epi64" : "set1_epi64x") + "(" + x + ")";
+      return prefix() + "set1_epi" + std::to_string(bits) + "(" + x + ")";
+    }
+
+    std::string binaryChunk(
+        VecOp op, const VecType &vt, std::size_t c, const std::string &a, const std::string &b
+    ) override {
+      std::string fn = isa_ == Isa::Neon ? neonBinary(op, vt) : x86Binary(op, vt);
+      if (fn.empty())
+        return "";
+      std::string trap = ubTrap(ubChecks_, 4);
+      if (isFloatElem(vt.elem) || (op != VecOp::Add && op != VecOp::Sub) || trap.empty())
+        return fn + "(" + a + ", " + b + ")";
+      // Signed overflow is UB (rule 4) and UBSan checks it on the other
+      // strategies, so check it here too: it happened in the lanes where
+      // the sign bit of (a^r)&(b^r) for +, or of (a^b)&(a^r) for -, is set.
+      std::string t = chunkCType(vt);
+      std::string ovf = op == VecOp::Add ? bitAnd(vt, bitXor(vt, "_a", "_r"), bitXor(vt, "_b", "_r"))
+                                         : bitAnd(vt, bitXor(vt, "_a", "_b"), bitXor(vt, "_a", "_r"));
+      return "({ " + t + " _a = " + a + ", _b = " + b + ", _r = " + fn + "(_a, _b); if (" +
+             anySignBit(vt, c, ovf) + ") " + trap + "; _r; })";
+    }
+
+    std::string notChunk(const VecType &vt, const std::string &a) override {
+      if (isFloatElem(vt.elem))
+        return "";
+      if (isa_ == Isa::Neon) {
+        if (storageBits(vt.elem) == 64)
+          return "veorq_s64(" + a + ", vdupq_n_s64(-1))";
+        return "vmvnq_" + neonSuffix(vt) + "(" + a + ")";
+      }
+      return prefix() + "xor_" + siSuffix() + "(" + a + ", " + prefix() + "set1_epi32(-1))";
+    }
+
+    std::string storeChunk(
+        const std::string &name, const VecType &vt, std::size_t c, const std::string &value
+    ) override {
+      std::string p = lanePtr(name, vt, c);
+      if (isa_ == Isa::Neon)
+        return "vst1q_" + neonSuffix(vt) + "(" + p + ", " + value + ")";
+      if (isFloatElem(vt.elem))
+        return prefix() + "storeu_" + floatSuffix(vt) + "(" + p + ", " + value + ")";
+      return prefix() + "storeu_" + siSuffix() + "((" + intVecType() + " *)" + p + ", " + value +
+             ")";
+    }
+
+    std::string compareChunk(
+        const std::string &mask, RelOp op, const VecType &vt, std::size_t c, const std::string &a,
+        const std::string &b
+    ) override {
+      std::size_t w = lanesPerChunk(vt);
+      int bits = storageBits(vt.elem);
+      bool fp = isFloatElem(vt.elem);
+      std::string s = "{ ";
+      // Per lane j of the chunk, the C expression of its 0/1 result.
+      std::string bitOf;
+      std::size_t stride = 1;
+      if (isa_ == Isa::Neon) {
+        std::string u = "u" + std::to_string(bits);
+        std::string cmp;
+        switch (op) {
+          case RelOp::EQ:
+          case RelOp::NE:
+            cmp = "vceqq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+            if (op == RelOp::NE)
+              cmp = bits == 64 ? "veorq_u64(" + cmp + ", vdupq_n_u64(~0ULL))"
+                               : "vmvnq_" + u + "(" + cmp + ")";
+            break;
+          case RelOp::LT:
+            cmp = "vcltq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+            break;
+          case RelOp::LE:
+            cmp = "vcleq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+            break;
+          case RelOp::GT:
+            cmp = "vcgtq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+            break;
+          case RelOp::GE:
+            cmp = "vcgeq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+            break;
+        }
+        s += "uint" + std::to_string(bits) + "_t _t[" + std::to_string(w) + "]; vst1q_" + u +
+             "(_t, " + cmp + "); ";
+        bitOf = "_t[%] & 1";
+      } else if (isa_ == Isa::Avx512) {
+        std::string pred;
+        if (fp) {
+          static const char *preds[] = {"_CMP_EQ_OQ", "_CMP_NEQ_UQ", "_CMP_LT_OQ",
+                                        "_CMP_LE_OQ", "_CMP_GT_OQ",  "_CMP_GE_OQ"};
+          pred = preds[static_cast<int>(op)];
+        } else {
+          static const char *preds[] = {"_MM_CMPINT_EQ", "_MM_CMPINT_NE",  "_MM_CMPINT_LT",
+                                        "_MM_CMPINT_LE", "_MM_CMPINT_NLE", "_MM_CMPINT_NLT"};
+          pred = preds[static_cast<int>(op)];
+        }
+        std::string fn = fp ? "_mm512_cmp_" + floatSuffix(vt) + "_mask"
+                            : "_mm512_cmp_epi" + std::to_string(bits) + "_mask";
+        s += "unsigned long long _m = " + fn + "(" + a + ", " + b + ", " + pred + "); ";
+        bitOf = "(_m >> %) & 1";
+      } else {
+        // SSE4/AVX2: compare, then movemask; integers only have == and >.
+        std::string cmp;
+        bool invert = false;
+        if (fp) {
+          if (isa_ == Isa::Sse4) {
+            static const char *fns[] = {"cmpeq", "cmpneq", "cmplt", "cmple", "cmpgt", "cmpge"};
+            cmp = prefix() + fns[static_cast<int>(op)] + "_" + floatSuffix(vt) + "(" + a + ", " +
+                  b + ")";
+          } else {
+            static const char *preds[] = {"_CMP_EQ_OQ", "_CMP_NEQ_UQ", "_CMP_LT_OQ",
+                                          "_CMP_LE_OQ", "_CMP_GT_OQ",  "_CMP_GE_OQ"};
+            cmp = prefix() + "cmp_" + floatSuffix(vt) + "(" + a + ", " + b + ", " +
+                  preds[static_cast<int>(op)] + ")";
+          }
+          cmp = prefix() + "movemask_" + floatSuffix(vt) + "(" + cmp + ")";
+        } else {
+          std::string eq = prefix() + "cmpeq_epi" + std::to_string(bits);
+          std::string gt = prefix() + "cmpgt_epi" + std::to_string(bits);
+          switch (op) {
+            case RelOp::EQ:
+            case RelOp::NE:
+              cmp = eq + "(" + a + ", " + b + ")";
+              invert = op == RelOp::NE;
+              break;
+            case RelOp::GT:
+            case RelOp::LE:
+              cmp = gt + "(" + a + ", " + b + ")";
+              invert = op == RelOp::LE;
+              break;
+            case RelOp::LT:
+            case RelOp::GE:
+              cmp = gt + "(" + b + ", " + a + ")";
+              invert = op == RelOp::GE;
+              break;
+          }
+          std::string r = std::to_string(regBits());
+          if (bits == 32)
+            cmp = prefix() + "movemask_ps(" + prefix() + "castsi" + r + "_ps(" + cmp + "))";
+          else if (bits == 64)
+            cmp = prefix() + "movemask_pd(" + prefix() + "castsi" + r + "_pd(" + cmp + "))";
+          else
+            cmp = prefix() + "movemask_epi8(" + cmp + ")";
+          stride = bits == 16 ? 2 : 1; // movemask_epi8 has a bit per byte
+        }
+        s += std::string("unsigned _m = ") + (invert ? "~" : "") + "(unsigned)" + cmp + "; ";
+        bitOf = "(_m >> %) & 1";
+      }
+      for (std::size_t j = 0; j < w && c * w + j < vt.size; ++j) {
+        std::string bit = bitOf;
+        bit.replace(bit.find('%'), 1, std::to_string(j * stride));
+        s += mask + ".l[" + std::to_string(c * w + j) + "] = " + bit + "; ";
+      }
+      return s + "}";
+    }
+
+    std::string selectChunk(
+        const std::string &mask, const VecType &vt, std::size_t c, const std::string &t,
+        const std::string &f
+    ) override {
+      std::size_t w = lanesPerChunk(vt);
+      int bits = storageBits(vt.elem);
+      std::string b = std::to_string(bits);
+      std::string p = "&" + mask + ".l[" + std::to_string(c * w) + "]";
+      std::string n = std::to_string(w);
+      bool fp = isFloatElem(vt.elem);
+      if (isa_ == Isa::Avx512) {
+        std::string k = "_simd_mask_bits(" + p + ", " + n + ")";
+        std::string fn = fp ? "_mm512_mask_blend_" + floatSuffix(vt) : "_mm512_mask_blend_epi" + b;
+        return fn + "(" + k + ", " + f + ", " + t + ")";
+      }
+      if (isa_ == Isa::Neon) {
+        std::string s = "s" + b;
+        std::string x;
+        if (bits == 8)
+          x = "vld1q_s8(" + p + ")";
+        else {
+          x = "_simd_mask_bytes(" + p + ", " + n + ")";
+          x = "vmovl_s8(" + x + ")";
+          if (bits >= 32)
+            x = "vmovl_s16(vget_low_s16(" + x + "))";
+          if (bits == 64)
+            x = "vmovl_s32(vget_low_s32(" + x + "))";
+        }
+        // All-ones where the mask byte is 0: those lanes take `f`.
+        std::string z = "vceqq_" + s + "(" + x + ", vdupq_n_" + s + "(0))";
+        return "vbslq_" + neonSuffix(vt) + "(" + z + ", " + f + ", " + t + ")";
+      }
+      std::string x;
+      if (bits == 8)
+        x = loadChunk(mask, vt, c);
+      else
+        x = prefix() + "cvtepi8_epi" + b + "(_simd_mask_bytes(" + p + ", " + n + "))";
+      std::string z =
+          prefix() + "cmpeq_epi" + b + "(" + x + ", " + prefix() + "setzero_" + siSuffix() + "())";
+      if (fp) {
+        z = prefix() + "castsi" + std::to_string(regBits()) + "_" + floatSuffix(vt) + "(" + z + ")";
+        return prefix() + "blendv_" + floatSuffix(vt) + "(" + t + ", " + f + ", " + z + ")";
+      }
+      return prefix() + "blendv_epi8(" + t + ", " + f + ", " + z + ")";
+    }
+
+  private:
+    Isa isa_;
+
+    const char *targetName() const {
+      switch (isa_) {
+        case Isa::Sse4:
+          return "sse4";
+        case Isa::Avx2:
+          return "avx2";
+        case Isa::Avx512:
+          return "avx512";
+        case Isa::Neon:
+          return "neon";
+      }
+      return "";
+    }
+
+    const char *targetFeatures() const {
+      switch (isa_) {
+        case Isa::Sse4:
+          return "sse4.2";
+        case Isa::Avx2:
+          return "avx2";
+        case Isa::Avx512:
+          return "avx512f,avx512bw,avx512dq,avx512vl";
+        case Isa::Neon:
+          return "";
+      }
+      return "";
+    }
+
+    std::size_t regBits() const {
+      switch (isa_) {
+        case Isa::Avx2:
+          return 256;
+        case Isa::Avx512:
+          return 512;
+        default:
+          return 128;
+      }
+    }
+
+    std::size_t lanesPerChunk(const VecType &vt) const {
+      return regBits() / static_cast<std::size_t>(storageBits(vt.elem));
+    }
+
+    std::size_t paddedLanes(const VecType &vt) const {
+      std::size_t w = lanesPerChunk(vt);
+      return (vt.size + w - 1) / w * w;
+    }
+
+    std::string lanePtr(const std::string &name, const VecType &vt, std::size_t c) const {
+      return "&" + name + ".l[" + std::to_string(c * lanesPerChunk(vt)) + "]";
+    }
+
+    // --- x86 ---
+
+    std::string prefix() const {
+      switch (isa_) {
+        case Isa::Avx2:
+          return "_mm256_";
+        case Isa::Avx512:
+          return "_mm512_";
+        default:
+          return "_mm_";
+      }
+    }
+
+    std::string siSuffix() const { return "si" + std::to_string(regBits()); }
+
+    std::string intVecType() const { return "__m" + std::to_string(regBits()) + "i"; }
+
+    static std::string floatSuffix(const VecType &vt) {
+      return storageBits(vt.elem) == 32 ? "ps" : "pd";
+    }
+
+    std::string x86Binary(VecOp op, const VecType &vt) const {
+      std::string pfx = prefix();
+      if (isFloatElem(vt.elem)) {
+        switch (op) {
+          case VecOp::Add:
+            return pfx + "add_" + floatSuffix(vt);
+          case VecOp::Sub:
+            return pfx + "sub_" + floatSuffix(vt);
+          case VecOp::Mul:
+            return pfx + "mul_" + floatSuffix(vt);
+          case VecOp::Div:
+            return pfx + "div_" + floatSuffix(vt);
+          default:
+            return "";
+        }
+      }
+      std::string epi = "epi" + std::to_string(storageBits(vt.elem));
+      switch (op) {
+        case VecOp::Add:
+          return pfx + "add_" + epi;
+        case VecOp::Sub:
+          return pfx + "sub_" + epi;
+        case VecOp::And:
+          return pfx + "and_" + siSuffix();
+        case VecOp::Or:
+          return pfx + "or_" + siSuffix();
+        case VecOp::Xor:
+          return pfx + "xor_" + siSuffix();
+        default:
+          // Integer multiplies and shifts have UB (overflow, shift counts)
+          // with no cheap native check; they are unrolled, where UBSan
+          // sees them. No SIMD integer division.
+          return "";
+      }
+    }
+
+    // --- NEON ---
+
+    static std::string neonSuffix(const VecType &vt) {
+      return (isFloatElem(vt.elem) ? "f" : "s") + std::to_string(storageBits(vt.elem));
+    }
+
+    static std::string neonBinary(VecOp op, const VecType &vt) {
+      std::string s = neonSuffix(vt);
+      bool fp = isFloatElem(vt.elem);
+      switch (op) {
+        case VecOp::Add:
+          return "vaddq_" + s;
+        case VecOp::Sub:
+          return "vsubq_" + s;
+        case VecOp::Mul:
+          return fp ? "vmulq_" + s : ""; // see x86Binary
+        case VecOp::Div:
+          return fp ? "vdivq_" + s : "";
+        case VecOp::And:
+          return fp ? "" : "vandq_" + s;
+        case VecOp::Or:
+          return fp ? "" : "vorrq_" + s;
+        case VecOp::Xor:
+          return fp ? "" : "veorq_" + s;
+        default:
+          return "";
+      }
+    }
+
+    // --- Integer chunk helpers ---
+
+    std::string chunkCType(const VecType &vt) const {
+      if (isa_ != Isa::Neon)
+        return intVecType();
+      int bits = storageBits(vt.elem);
+      return "int" + std::to_string(bits) + "x" + std::to_string(128 / bits) + "_t";
+    }
+
+    std::string bitAnd(const VecType &vt, const std::string &a, const std::string &b) const {
+      if (isa_ == Isa::Neon)
+        return "vandq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+      return prefix() + "and_" + siSuffix() + "(" + a + ", " + b + ")";
+    }
+
+    std::string bitXor(const VecType &vt, const std::string &a, const std::string &b) const {
+      if (isa_ == Isa::Neon)
+        return "veorq_" + neonSuffix(vt) + "(" + a + ", " + b + ")";
+      return prefix() + "xor_" + siSuffix() + "(" + a + ", " + b + ")";
+    }
+
+    /// C condition: the sign bit of some lane of chunk `c` of `vt` in the
+    /// integer chunk `x` is set, padding lanes not counted.
+    std::string anySignBit(const VecType &vt, std::size_t c, const std::string &x) {
+      int bits = storageBits(vt.elem);
+      std::size_t w = lanesPerChunk(vt);
+      std::size_t live = std::min(w, vt.size - c * w);
+      if (isa_ == Isa::Neon) {
+        std::string s = neonSuffix(vt);
+        std::string lanes;
+        for (std::size_t j = 0; j < w; ++j)
+          lanes += std::string(j ? ", " : "") + (j < live ? "-1" : "0");
+        std::string m = "vreinterpretq_u64_" + s + "(vandq_" + s + "(vshrq_n_" + s + "(" + x +
+                        ", " + std::to_string(bits - 1) + "), vld1q_" + s + "((const int" +
+                        std::to_string(bits) + "_t[]){" + lanes + "})))";
+        return "(vgetq_lane_u64(" + m + ", 0) | vgetq_lane_u64(" + m + ", 1))";
+      }
+      std::string min = "INT" + std::to_string(bits) + "_MIN";
+      if (isa_ == Isa::Avx512) {
+        std::string liveBits = live == 64 ? "~0ULL" : "0x" + hex((1ULL << live) - 1) + "ULL";
+        return "(_mm512_test_epi" + std::to_string(bits) + "_mask(" + x + ", " +
+               broadcastChunk(min, vt) + ") & " + liveBits + ")";
+      }
+      // One movemask bit per lane; per byte for 16-bit lanes, the high one
+      // holding the sign.
+      std::string r = std::to_string(regBits());
+      std::string mm;
+      unsigned long long liveBits = 0;
+      if (bits == 32 || bits == 64) {
+        std::string fs = bits == 32 ? "ps" : "pd";
+        mm = prefix() + "movemask_" + fs + "(" + prefix() + "castsi" + r + "_" + fs + "(" + x + "))";
+        liveBits = (1ULL << live) - 1;
+      } else {
+        mm = prefix() + "movemask_epi8(" + x + ")";
+        for (std::size_t j = 0; j < live; ++j)
+          liveBits |= 1ULL << (bits == 16 ? 2 * j + 1 : j);
+      }
+      return "((unsigned)" + mm + " & 0x" + hex(liveBits) + "u)";
+    }
+
+    static std::string hex(unsigned long long v) {
+      char buf[24];
+      std::snprintf(buf, sizeof buf, "%llx", v);
+      return buf;
+    }
+  };
+
+  std::unique_ptr<VecLowering> makeIntrinsicsLowering(const std::string &target) {
+    if (target == "sse4")
+      return std::make_unique<IntrinsicsLowering>(Isa::Sse4);
+    if (target == "avx2")
+      return std::make_unique<IntrinsicsLowering>(Isa::Avx2);
+    if (target == "avx512")
+      return std::make_unique<IntrinsicsLowering>(Isa::Avx512);
+    if (target == "neon")
+      return std::make_unique<IntrinsicsLowering>(Isa::Neon);
+    return nullptr;
+  }
+
+} // namespace symir
@@ -128,6 +128,20 @@ namespace symir {
       out << lhs << " = " << rhs;
     }
 
+    void emitLoadContiguous(
+        std::ostream &out, const std::string &name, const VecType &vt, const std::string &elems
+    ) override {
+      (void) vt;
+      out << "memcpy(" << name << ".lanes, " << elems << ", sizeof(" << name << ".lanes))";
+    }
+
+    void emitStoreContiguous(
+        std::ostream &out, const std::string &elems, const std::string &name, const VecType &vt
+    ) override {
+      (void) vt;
+      out << "memcpy(" << elems << ", " << name << ".lanes, sizeof(" << name << ".lanes))";
+    }
+
     bool canCrossFnBoundary() const override { return true; }
 
     bool needsLaneUnroll() const override { return true; }
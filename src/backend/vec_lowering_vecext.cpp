@@ -134,6 +134,21 @@ namespace symir {
       out << lhs << " = " << rhs;
     }
 
+    // One unaligned copy, which the C compiler turns into a vector load.
+    void emitLoadContiguous(
+        std::ostream &out, const std::string &name, const VecType &vt, const std::string &elems
+    ) override {
+      (void) vt;
+      out << "memcpy(&" << name << ", " << elems << ", sizeof(" << name << "))";
+    }
+
+    void emitStoreContiguous(
+        std::ostream &out, const std::string &elems, const std::string &name, const VecType &vt
+    ) override {
+      (void) vt;
+      out << "memcpy(" << elems << ", &" << name << ", sizeof(" << name << "))";
+    }
+
     bool canCrossFnBoundary() const override { return true; }
 
     bool needsLaneUnroll() const override { return false; }
@@ -156,6 +171,8 @@ namespace symir {
       return makeStructArrayLowering();
     if (name == "structscalars")
       return makeStructScalarsLowering();
+    if (name == "intrinsics")
+      return makeIntrinsicsLowering("sse4");
     return nullptr;
   }
 
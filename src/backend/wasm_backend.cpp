@@ -1,10 +1,14 @@
 #include "backend/wasm_backend.hpp"
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <thread>
+#include "analysis/pass_manager.hpp"
 #include "analysis/type_utils.hpp"
+#include "timing.hpp"
 
 namespace symir {
 
@@ -646,27 +650,10 @@ namespace symir {
           } else if constexpr (std::is_same_v<T, LoadAtom>) {
             // Load through pointer: *ptr
             // Push ptr twice — first copy stays for the actual load,
-            // second copy is used for the null check.
-            const std::string &pname = arg.rval.base.name;
-            // If pname was address-taken, it lives on the shadow stack rather
-            // than as a WASM local; fetch its value from there.
-            auto emitPushPtr = [&]() {
-              if (locals_.count(pname) && locals_.at(pname).isAggregate) {
-                const auto &pinfo = locals_.at(pname);
-                indent();
-                out_ << "local.get $__old_sp\n";
-                indent();
-                out_ << "i32.const " << pinfo.offset << "\n";
-                indent();
-                out_ << "i32.sub\n";
-                indent();
-                out_ << "i32.load\n";
-              } else {
-                indent();
-                out_ << "local.get " << mangleName(pname) << "\n";
-              }
-            };
-            // Null check: push ptr for null test, then keep first for load
+            // second copy is used for the null check. The pointer may be
+            // an element or field, or live on the shadow stack when its
+            // own address was taken; emitLValue reads it from there.
+            auto emitPushPtr = [&]() { emitLValue(arg.rval, false); };
             emitPushPtr();
             emitPushPtr();
             indent();
@@ -682,9 +669,8 @@ namespace symir {
             // stack: [ptr_for_load]; determine pointee type for load instruction
             uint32_t loadWidth = targetWidth;
             bool loadIsFloat = isFloat;
-            if (locals_.count(pname)) {
-              const auto &info = locals_.at(pname);
-              if (auto pt = std::get_if<PtrType>(&info.symirType->v)) {
+            if (TypePtr ptrType = getLValueType(arg.rval)) {
+              if (auto pt = std::get_if<PtrType>(&ptrType->v)) {
                 if (auto bits = TypeUtils::getBitWidth(pt->pointee)) {
                   loadWidth = *bits;
                   loadIsFloat = false;
@@ -1030,6 +1016,9 @@ namespace symir {
         } else if (curType && std::holds_alternative<FloatType>(curType->v)) {
           valIsFloat = true;
           width = (std::get<FloatType>(curType->v).kind == FloatType::Kind::F32) ? 32 : 64;
+        } else if (curType && std::holds_alternative<PtrType>(curType->v)) {
+          // WASM pointers are 32-bit (one i32 cell).
+          width = 32;
         }
 
         if (valIsFloat) {
@@ -1102,8 +1091,8 @@ namespace symir {
                       }
                     }
                   } else {
-                    indent();
-                    out_ << "local.get " << mangleName(id.name) << "\n";
+                    // Loads the index if its address is taken (it lives in memory).
+                    emitLValue({id, {}, SourceSpan{}}, false);
                     if (locals_.count(id.name)) {
                       auto const &li = locals_.at(id.name);
                       std::uint32_t srcWidth = li.bitwidth;
@@ -1191,8 +1180,8 @@ namespace symir {
                       out_ << "i32.wrap_i64\n";
                     }
                   } else {
-                    indent();
-                    out_ << "local.get " << mangleName(id.name) << "\n";
+                    // Loads the index if its address is taken (it lives in memory).
+                    emitLValue({id, {}, SourceSpan{}}, false);
                     if (locals_.count(id.name)) {
                       std::uint32_t srcWidth = getIntWidth(locals_.at(id.name).symirType);
                       if (srcWidth > 32) {
@@ -1507,7 +1496,26 @@ namespace symir {
     }
   }
 
+  WasmBackend::WasmBackend(const WasmBackend &parent, std::ostream &out) :
+      out_(out), indent_level_(parent.indent_level_), noModuleTags_(parent.noModuleTags_),
+      noRequire_(parent.noRequire_), simd_(parent.simd_),
+      structLayouts_(parent.structLayouts_), nodeTypes_(parent.nodeTypes_) {}
+
+  void WasmBackend::setNumThreads(unsigned n) {
+    numThreads_ = n ? n : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // A first guess at the WAT of `f`, so most buffers never grow.
+  static std::size_t estimateFunctionSize(const FunDecl &f) {
+    std::size_t n = 512 + 48 * (f.params.size() + f.lets.size());
+    for (const auto &b: f.blocks)
+      n += 128 + 384 * b.instrs.size();
+    return n;
+  }
+
   void WasmBackend::emit(const Program &prog) {
+    timing::Scope timer("emit-wasm");
+    nodeTypes_ = prog.types.get();
     computeLayouts(prog);
     if (!noModuleTags_) {
       out_ << "(module\n";
@@ -1538,514 +1546,645 @@ namespace symir {
     indent();
     out_ << "(global $__stack_pointer (mut i32) (i32.const 1048576))\n";
 
-    for (const auto &f: prog.funs) {
-      curFuncName_ = f.name.name;
-      locals_.clear();
-      syms_.clear();
-      stackSize_ = 0;
+    // Functions, each rendered into a buffer of its own by a worker backend
+    // (they share no state), then joined in order and written at once.
+    std::vector<std::string> funcs(prog.funs.size());
+    DiagBag unused;
+    forEachFunction(prog.funs.size(), numThreads_, unused, [&](std::size_t i, DiagBag &) {
+      std::string text;
+      text.reserve(estimateFunctionSize(prog.funs[i]));
+      std::ostringstream buf(std::move(text));
+      WasmBackend worker(*this, buf);
+      worker.emitFunction(prog.funs[i]);
+      funcs[i] = std::move(buf).str();
+    });
+    std::size_t size = 0;
+    for (const auto &text: funcs)
+      size += text.size();
+    std::string all;
+    all.reserve(size);
+    for (const auto &text: funcs)
+      all += text;
+    out_.write(all.data(), static_cast<std::streamsize>(all.size()));
 
-      // Pre-scan: collect variables whose address is taken (must be spilled to shadow stack)
-      std::unordered_set<std::string> addrTaken;
-      std::function<void(const Expr &)> scanExpr;
-      std::function<void(const Atom &)> scanAtom;
+    if (!noModuleTags_) {
+      indent_level_--;
+      out_ << ")\n";
+    }
+  }
 
-      scanAtom = [&](const Atom &a) {
-        std::visit(
-            [&](auto &&arg) {
-              using T = std::decay_t<decltype(arg)>;
-              if constexpr (std::is_same_v<T, AddrAtom>) {
-                addrTaken.insert(arg.lv.base.name);
-              } else if constexpr (std::is_same_v<T, SelectAtom>) {
-                if (arg.cond) {
-                  scanExpr(arg.cond->lhs);
-                  scanExpr(arg.cond->rhs);
-                }
-                if (arg.maskExpr) {
-                  scanExpr(*arg.maskExpr);
-                }
-              }
-            },
-            a.v
-        );
-      };
+  void WasmBackend::emitFunction(const FunDecl &f) {
+    curFuncName_ = f.name.name;
+    locals_.clear();
+    syms_.clear();
+    stackSize_ = 0;
 
-      scanExpr = [&](const Expr &e) {
-        scanAtom(e.first);
-        for (const auto &t: e.rest) {
-          scanAtom(t.atom);
-        }
-      };
+    // Pre-scan: collect variables whose address is taken (must be spilled to shadow stack)
+    std::unordered_set<std::string> addrTaken;
+    std::function<void(const Expr &)> scanExpr;
+    std::function<void(const Atom &)> scanAtom;
 
-      auto scanInitVal = [&](auto &self, const InitVal &iv) -> void {
-        if (iv.kind == InitVal::Kind::Atom) {
-          scanAtom(*std::get<AtomPtr>(iv.value));
-        } else if (iv.kind == InitVal::Kind::Aggregate) {
-          const auto &elements = std::get<std::vector<InitValPtr>>(iv.value);
-          for (const auto &el: elements) {
-            self(self, *el);
-          }
-        }
-      };
+    scanAtom = [&](const Atom &a) {
+      std::visit(
+          [&](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, AddrAtom>) {
+              addrTaken.insert(arg.lv.base.name);
+            } else if constexpr (std::is_same_v<T, SelectAtom>) {
+              if (arg.cond) {
+                scanExpr(arg.cond->lhs);
+                scanExpr(arg.cond->rhs);
+              }
+              if (arg.maskExpr) {
+                scanExpr(*arg.maskExpr);
+              }
+            }
+          },
+          a.v
+      );
+    };
 
-      for (const auto &l: f.lets) {
-        if (l.init) {
-          scanInitVal(scanInitVal, *l.init);
-        }
+    scanExpr = [&](const Expr &e) {
+      scanAtom(e.first);
+      for (const auto &t: e.rest) {
+        scanAtom(t.atom);
       }
+    };
 
-      for (const auto &b: f.blocks) {
-        for (const auto &ins: b.instrs) {
-          std::visit(
-              [&](auto &&instr) {
-                using IT = std::decay_t<decltype(instr)>;
-                if constexpr (std::is_same_v<IT, AssignInstr>) {
-                  scanExpr(instr.rhs);
-                } else if constexpr (std::is_same_v<IT, StoreInstr>) {
-                  scanExpr(instr.ptr);
-                  scanExpr(instr.val);
-                }
-              },
-              ins
-          );
-        }
-        if (auto rt = std::get_if<RetTerm>(&b.term)) {
-          if (rt->value) {
-            scanExpr(*rt->value);
-          }
+    auto scanInitVal = [&](auto &self, const InitVal &iv) -> void {
+      if (iv.kind == InitVal::Kind::Atom) {
+        scanAtom(*std::get<AtomPtr>(iv.value));
+      } else if (iv.kind == InitVal::Kind::Aggregate) {
+        const auto &elements = std::get<std::vector<InitValPtr>>(iv.value);
+        for (const auto &el: elements) {
+          self(self, *el);
         }
       }
+    };
 
-      for (const auto &s: f.syms) {
-        syms_[s.name.name] = s.type;
+    for (const auto &l: f.lets) {
+      if (l.init) {
+        scanInitVal(scanInitVal, *l.init);
       }
+    }
 
-      for (const auto &p: f.params) {
-        locals_[p.name.name] = {getWasmType(p.type), true, getIntWidth(p.type), false, 0, p.type};
+    for (const auto &b: f.blocks) {
+      for (const auto &ins: b.instrs) {
+        std::visit(
+            [&](auto &&instr) {
+              using IT = std::decay_t<decltype(instr)>;
+              if constexpr (std::is_same_v<IT, AssignInstr>) {
+                scanExpr(instr.rhs);
+              } else if constexpr (std::is_same_v<IT, StoreInstr>) {
+                scanExpr(instr.ptr);
+                scanExpr(instr.val);
+              }
+            },
+            ins
+        );
       }
-      for (const auto &l: f.lets) {
-        // Mark as aggregate if it's struct/array/vector OR if its address is taken (needs memory
-        // slot)
-        bool isAgg = std::holds_alternative<StructType>(l.type->v) ||
-                     std::holds_alternative<ArrayType>(l.type->v) ||
-                     std::holds_alternative<VecType>(l.type->v) || addrTaken.count(l.name.name);
-        if (isAgg) {
-          std::uint32_t size = getTypeSize(l.type);
-          if (stackSize_ % 8 != 0)
-            stackSize_ += 8 - (stackSize_ % 8);
-          stackSize_ += size;
-          locals_[l.name.name] = {"i32", false, getIntWidth(l.type), true, stackSize_, l.type};
-        } else {
-          locals_[l.name.name] = {
-              getWasmType(l.type), false, getIntWidth(l.type), false, 0, l.type
-          };
+      if (auto rt = std::get_if<RetTerm>(&b.term)) {
+        if (rt->value) {
+          scanExpr(*rt->value);
         }
       }
+    }
+
+    for (const auto &s: f.syms) {
+      syms_[s.name.name] = s.type;
+    }
+
+    for (const auto &p: f.params) {
+      locals_[p.name.name] = {getWasmType(p.type), true, getIntWidth(p.type), false, 0, p.type};
+    }
+    for (const auto &l: f.lets) {
+      // Mark as aggregate if it's struct/array/vector OR if its address is taken (needs memory
+      // slot)
+      bool isAgg = std::holds_alternative<StructType>(l.type->v) ||
+                   std::holds_alternative<ArrayType>(l.type->v) ||
+                   std::holds_alternative<VecType>(l.type->v) || addrTaken.count(l.name.name);
+      if (isAgg) {
+        std::uint32_t size = getTypeSize(l.type);
+        if (stackSize_ % 8 != 0)
+          stackSize_ += 8 - (stackSize_ % 8);
+        stackSize_ += size;
+        locals_[l.name.name] = {"i32", false, getIntWidth(l.type), true, stackSize_, l.type};
+      } else {
+        locals_[l.name.name] = {
+            getWasmType(l.type), false, getIntWidth(l.type), false, 0, l.type
+        };
+      }
+    }
 
+    DiagBag cfgDiags;
+    CFG cfg = CFG::build(f, cfgDiags);
+    std::vector<std::size_t> idom = cfg.dominators();
+    std::optional<StructuredCfg> sc;
+    if (cfgDiags.diags.empty())
+      sc = StructuredCfg::build(f, cfg, idom);
+    bool structured = sc.has_value();
+
+    indent();
+    out_ << "(func " << mangleName(f.name.name);
+    for (const auto &p: f.params) {
+      out_ << " (param " << mangleName(p.name.name) << " " << getWasmType(p.type) << ")";
+    }
+    if (f.retType) {
+      out_ << " (result " << getWasmType(f.retType) << ")";
+    }
+    out_ << "\n";
+    indent_level_++;
+
+    if (!structured) {
       indent();
-      out_ << "(func " << mangleName(f.name.name);
-      for (const auto &p: f.params) {
-        out_ << " (param " << mangleName(p.name.name) << " " << getWasmType(p.type) << ")";
-      }
-      if (f.retType) {
-        out_ << " (result " << getWasmType(f.retType) << ")";
+      out_ << "(local $__pc i32)\n";
+    }
+    indent();
+    out_ << "(local $__old_sp i32)\n";
+    indent();
+    out_ << "(local $__ptr_temp i32)\n"; // scratch register for null-checked ptr ops
+    indent();
+    out_ << "(local $__idx_temp i32)\n"; // scratch register for index bounds checks
+    for (const auto &l: f.lets) {
+      if (!locals_[l.name.name].isAggregate) {
+        indent();
+        out_ << "(local " << mangleName(l.name.name) << " " << locals_[l.name.name].wasmType
+             << ")\n";
       }
-      out_ << "\n";
-      indent_level_++;
+    }
 
+    if (stackSize_ > 0) {
       indent();
-      out_ << "(local $__pc i32)\n";
+      out_ << "global.get $__stack_pointer\n";
+      indent();
+      out_ << "local.set $__old_sp\n";
       indent();
-      out_ << "(local $__old_sp i32)\n";
+      out_ << "global.get $__stack_pointer\n";
       indent();
-      out_ << "(local $__ptr_temp i32)\n"; // scratch register for null-checked ptr ops
+      out_ << "i32.const " << stackSize_ << "\n";
+      indent();
+      out_ << "i32.sub\n";
       indent();
-      out_ << "(local $__idx_temp i32)\n"; // scratch register for index bounds checks
-      for (const auto &l: f.lets) {
-        if (!locals_[l.name.name].isAggregate) {
+      out_ << "global.set $__stack_pointer\n";
+    }
+
+    for (const auto &l: f.lets) {
+      if (l.init) {
+        if (locals_[l.name.name].isAggregate) {
+          emitInitVal(*l.init, l.type, locals_[l.name.name].offset);
+        } else if (l.init->kind == InitVal::Kind::Int) {
+          indent();
+          bool isTargetFloat = std::holds_alternative<FloatType>(l.type->v);
+          if (isTargetFloat) {
+            out_ << (locals_[l.name.name].bitwidth <= 32 ? "f32.const " : "f64.const ")
+                 << std::get<IntLit>(l.init->value).value << ".0\n";
+          } else {
+            out_ << (locals_[l.name.name].bitwidth <= 32 ? "i32.const " : "i64.const ")
+                 << std::get<IntLit>(l.init->value).value << "\n";
+            emitSignExtend(
+                getIntWidth(l.type), (locals_[l.name.name].wasmType == "i32" ? 32 : 64)
+            );
+          }
+          indent();
+          out_ << "local.set " << mangleName(l.name.name) << "\n";
+        } else if (l.init->kind == InitVal::Kind::Float) {
+          indent();
+          out_ << (locals_[l.name.name].wasmType == "f32" ? "f32.const " : "f64.const ")
+               << formatFloatLit(std::get<FloatLit>(l.init->value).value) << "\n";
+          indent();
+          out_ << "local.set " << mangleName(l.name.name) << "\n";
+        } else if (l.init->kind == InitVal::Kind::Null) {
+          // null pointer = i32 0 in WASM
+          indent();
+          out_ << "i32.const 0\n";
+          indent();
+          out_ << "local.set " << mangleName(l.name.name) << "\n";
+        } else if (l.init->kind == InitVal::Kind::Local) {
+          emitLValue({std::get<LocalId>(l.init->value), {}, l.init->span}, false);
+          indent();
+          out_ << "local.set " << mangleName(l.name.name) << "\n";
+        } else if (l.init->kind == InitVal::Kind::Sym) {
+          const auto &sid = std::get<SymId>(l.init->value);
+          indent();
+          out_ << "call " << mangleName(getMangledSymbolName(curFuncName_, sid.name)) << "\n";
+          // Handle int extension if needed
+          std::uint32_t srcWidth = 32;
+          bool srcIsFloat = false;
+          if (syms_.count(sid.name)) {
+            srcWidth = getIntWidth(syms_.at(sid.name));
+            if (std::holds_alternative<FloatType>(syms_.at(sid.name)->v))
+              srcIsFloat = true;
+          }
+          if (!srcIsFloat) {
+            if (srcWidth <= 32 && getIntWidth(l.type) > 32) {
+              indent();
+              out_ << "i64.extend_i32_s\n";
+            } else if (srcWidth > 32 && getIntWidth(l.type) <= 32) {
+              indent();
+              out_ << "i32.wrap_i64\n";
+            }
+          } else {
+            // Handle float promotion if needed
+            if (srcWidth == 32 && getIntWidth(l.type) == 64) {
+              indent();
+              out_ << "f64.promote_f32\n";
+            }
+          }
+          indent();
+          out_ << "local.set " << mangleName(l.name.name) << "\n";
+        } else if (l.init->kind == InitVal::Kind::Atom) {
+          const auto &atom = std::get<AtomPtr>(l.init->value);
+          bool isFloat = std::holds_alternative<FloatType>(l.type->v);
+          emitAtom(*atom, locals_[l.name.name].bitwidth, isFloat);
           indent();
-          out_ << "(local " << mangleName(l.name.name) << " " << locals_[l.name.name].wasmType
-               << ")\n";
+          out_ << "local.set " << mangleName(l.name.name) << "\n";
         }
       }
+    }
 
-      if (stackSize_ > 0) {
-        indent();
-        out_ << "global.get $__stack_pointer\n";
-        indent();
-        out_ << "local.set $__old_sp\n";
-        indent();
-        out_ << "global.get $__stack_pointer\n";
-        indent();
-        out_ << "i32.const " << stackSize_ << "\n";
-        indent();
-        out_ << "i32.sub\n";
-        indent();
-        out_ << "global.set $__stack_pointer\n";
+    if (structured) {
+      emitStructuredTree(*sc, cfg.entry);
+    } else {
+      emitDispatchLoop(f);
+    }
+
+    if (f.retType && !f.blocks.empty()) {
+      indent();
+      bool isFloat = std::holds_alternative<FloatType>(f.retType->v);
+      if (isFloat) {
+        out_ << (getIntWidth(f.retType) <= 32 ? "f32.const 0.0\n" : "f64.const 0.0\n");
+      } else {
+        out_ << (getIntWidth(f.retType) <= 32 ? "i32.const 0\n" : "i64.const 0\n");
       }
+    }
 
-      for (const auto &l: f.lets) {
-        if (l.init) {
-          if (locals_[l.name.name].isAggregate) {
-            emitInitVal(*l.init, l.type, locals_[l.name.name].offset);
-          } else if (l.init->kind == InitVal::Kind::Int) {
-            indent();
-            bool isTargetFloat = std::holds_alternative<FloatType>(l.type->v);
-            if (isTargetFloat) {
-              out_ << (locals_[l.name.name].bitwidth <= 32 ? "f32.const " : "f64.const ")
-                   << std::get<IntLit>(l.init->value).value << ".0\n";
-            } else {
-              out_ << (locals_[l.name.name].bitwidth <= 32 ? "i32.const " : "i64.const ")
-                   << std::get<IntLit>(l.init->value).value << "\n";
-              emitSignExtend(
-                  getIntWidth(l.type), (locals_[l.name.name].wasmType == "i32" ? 32 : 64)
-              );
+    indent_level_--;
+    indent();
+    out_ << ")\n\n";
+    indent();
+    std::string exportedName = stripSigil(f.name.name);
+    if (exportedName == "main")
+      exportedName = "symir_main";
+    out_ << "(export \"" << exportedName << "\" (func " << mangleName(f.name.name) << "))\n";
+  }
+
+  void WasmBackend::emitInstr(const Instr &ins) {
+    std::visit(
+        [this](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, AssignInstr>) {
+            if (locals_.count(arg.lhs.base.name)) {
+              const auto &info = locals_.at(arg.lhs.base.name);
+              TypePtr lhsTy = getLValueType(arg.lhs);
+              if (simd_ && lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
+                  emitVecSimdAssign(arg.lhs, arg.rhs, std::get<VecType>(lhsTy->v))) {
+                // Lowered to v128 operations.
+              } else if (lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
+                         arg.lhs.accesses.empty()) {
+                auto &vt = std::get<VecType>(lhsTy->v);
+                std::uint32_t elemSize = getTypeSize(vt.elem);
+                bool valIsFloat = std::holds_alternative<FloatType>(vt.elem->v);
+                uint32_t width = getIntWidth(vt.elem);
+                for (uint64_t i = 0; i < vt.size; ++i) {
+                  indent();
+                  out_ << "local.get $__old_sp\n";
+                  indent();
+                  out_ << "i32.const " << (info.offset - i * elemSize) << "\n";
+                  indent();
+                  out_ << "i32.sub\n";
+
+                  emitVecExprLane(arg.rhs, vt, i, width, valIsFloat);
+
+                  indent();
+                  if (valIsFloat) {
+                    out_ << (width == 32 ? "f32.store\n" : "f64.store\n");
+                  } else {
+                    out_ << (width <= 8
+                                 ? "i32.store8"
+                                 : (width <= 16 ? "i32.store16"
+                                                : (width <= 32 ? "i32.store" : "i64.store")))
+                         << "\n";
+                  }
+                }
+              } else if (info.isAggregate || !arg.lhs.accesses.empty()) {
+                emitAddress(arg.lhs);
+                TypePtr curType = info.symirType;
+                for (const auto &acc: arg.lhs.accesses) {
+                  if (std::holds_alternative<AccessIndex>(acc)) {
+                    if (auto at = std::get_if<ArrayType>(&curType->v))
+                      curType = at->elem;
+                    else if (auto vt = std::get_if<VecType>(&curType->v))
+                      curType = vt->elem;
+                  } else if (auto af = std::get_if<AccessField>(&acc)) {
+                    if (auto st = std::get_if<StructType>(&curType->v)) {
+                      auto &fld = af->field;
+                      if (structLayouts_.count(st->name.name) &&
+                          structLayouts_.at(st->name.name).fields.count(fld))
+                        curType = structLayouts_.at(st->name.name).fields.at(fld).type;
+                    }
+                  }
+                }
+                std::uint32_t width = 0;
+                bool valIsFloat = false;
+                if (auto bits = TypeUtils::getBitWidth(curType)) {
+                  width = *bits;
+                } else if (curType && std::holds_alternative<FloatType>(curType->v)) {
+                  valIsFloat = true;
+                  width = (std::get<FloatType>(curType->v).kind == FloatType::Kind::F32) ? 32
+                                                                                         : 64;
+                } else if (curType && std::holds_alternative<PtrType>(curType->v)) {
+                  // WASM pointers are 32-bit (one i32 cell).
+                  width = 32;
+                }
+
+                emitExpr(arg.rhs, width, valIsFloat);
+                indent();
+                if (valIsFloat) {
+                  out_ << (width == 32 ? "f32.store\n" : "f64.store\n");
+                } else {
+                  if (width <= 8)
+                    out_ << "i32.store8\n";
+                  else if (width <= 16)
+                    out_ << "i32.store16\n";
+                  else if (width <= 32)
+                    out_ << "i32.store\n";
+                  else
+                    out_ << "i64.store\n";
+                }
+              } else {
+                bool isFloat = std::holds_alternative<FloatType>(info.symirType->v);
+                bool isPtr = std::holds_alternative<PtrType>(info.symirType->v);
+                if (isPtr) {
+                  emitPtrExpr(arg.rhs, info.symirType);
+                } else if (isPtrDiff(arg.rhs)) {
+                  // ptr - ptr → i64 element distance. Emit byte diff, then /sizeof.
+                  emitPtrDiff(arg.rhs);
+                } else {
+                  emitExpr(arg.rhs, info.bitwidth, isFloat);
+                }
+                indent();
+                out_ << "local.set " << mangleName(arg.lhs.base.name) << "\n";
+              }
+            }
+          } else if constexpr (std::is_same_v<T, RequireInstr>) {
+            if (!noRequire_) {
+              emitCond(arg.cond);
+              indent();
+              out_ << "i32.eqz\n";
+              indent();
+              out_ << "if\n";
+              indent_level_++;
+              indent();
+              out_ << "unreachable\n";
+              indent_level_--;
+              indent();
+              out_ << "end\n";
+            }
+          } else if constexpr (std::is_same_v<T, StoreInstr>) {
+            // *ptr = val — with null-pointer trap
+            // Determine pointee type from the pointer expression
+            uint32_t storeWidth = 32;
+            bool storeIsFloat = false;
+            if (auto rva = std::get_if<RValueAtom>(&arg.ptr.first.v)) {
+              if (TypePtr ptrType = getLValueType(rva->rval)) {
+                if (auto pt = std::get_if<PtrType>(&ptrType->v)) {
+                  if (auto bits = TypeUtils::getBitWidth(pt->pointee)) {
+                    storeWidth = *bits;
+                  } else if (pt->pointee &&
+                             std::holds_alternative<FloatType>(pt->pointee->v)) {
+                    storeIsFloat = true;
+                    storeWidth =
+                        (std::get<FloatType>(pt->pointee->v).kind == FloatType::Kind::F32)
+                            ? 32
+                            : 64;
+                  }
+                }
+              }
             }
+            // Emit ptr expr → save to $__ptr_temp, null check, then store
+            emitExpr(arg.ptr, 32, false);
             indent();
-            out_ << "local.set " << mangleName(l.name.name) << "\n";
-          } else if (l.init->kind == InitVal::Kind::Float) {
+            out_ << "local.tee $__ptr_temp\n";
             indent();
-            out_ << (locals_[l.name.name].wasmType == "f32" ? "f32.const " : "f64.const ")
-                 << formatFloatLit(std::get<FloatLit>(l.init->value).value) << "\n";
+            out_ << "i32.eqz\n";
             indent();
-            out_ << "local.set " << mangleName(l.name.name) << "\n";
-          } else if (l.init->kind == InitVal::Kind::Null) {
-            // null pointer = i32 0 in WASM
+            out_ << "if\n";
+            indent_level_++;
             indent();
-            out_ << "i32.const 0\n";
+            out_ << "unreachable\n";
+            indent_level_--;
             indent();
-            out_ << "local.set " << mangleName(l.name.name) << "\n";
-          } else if (l.init->kind == InitVal::Kind::Local) {
-            emitLValue({std::get<LocalId>(l.init->value), {}, l.init->span}, false);
+            out_ << "end\n";
             indent();
-            out_ << "local.set " << mangleName(l.name.name) << "\n";
-          } else if (l.init->kind == InitVal::Kind::Sym) {
-            const auto &sid = std::get<SymId>(l.init->value);
+            out_ << "local.get $__ptr_temp\n";
+            emitExpr(arg.val, storeWidth, storeIsFloat);
             indent();
-            out_ << "call " << mangleName(getMangledSymbolName(curFuncName_, sid.name)) << "\n";
-            // Handle int extension if needed
-            std::uint32_t srcWidth = 32;
-            bool srcIsFloat = false;
-            if (syms_.count(sid.name)) {
-              srcWidth = getIntWidth(syms_.at(sid.name));
-              if (std::holds_alternative<FloatType>(syms_.at(sid.name)->v))
-                srcIsFloat = true;
-            }
-            if (!srcIsFloat) {
-              if (srcWidth <= 32 && getIntWidth(l.type) > 32) {
-                indent();
-                out_ << "i64.extend_i32_s\n";
-              } else if (srcWidth > 32 && getIntWidth(l.type) <= 32) {
-                indent();
-                out_ << "i32.wrap_i64\n";
-              }
+            if (storeIsFloat) {
+              out_ << (storeWidth <= 32 ? "f32.store\n" : "f64.store\n");
             } else {
-              // Handle float promotion if needed
-              if (srcWidth == 32 && getIntWidth(l.type) == 64) {
-                indent();
-                out_ << "f64.promote_f32\n";
-              }
+              out_
+                  << (storeWidth <= 8    ? "i32.store8\n"
+                      : storeWidth <= 16 ? "i32.store16\n"
+                      : storeWidth <= 32 ? "i32.store\n"
+                                         : "i64.store\n");
             }
-            indent();
-            out_ << "local.set " << mangleName(l.name.name) << "\n";
-          } else if (l.init->kind == InitVal::Kind::Atom) {
-            const auto &atom = std::get<AtomPtr>(l.init->value);
-            bool isFloat = std::holds_alternative<FloatType>(l.type->v);
-            emitAtom(*atom, locals_[l.name.name].bitwidth, isFloat);
-            indent();
-            out_ << "local.set " << mangleName(l.name.name) << "\n";
           }
-        }
-      }
+        },
+        ins
+    );
+  }
 
+  void WasmBackend::emitRet(const RetTerm &rt, const FunDecl &f) {
+    if (rt.value) {
+      bool isFloat = std::holds_alternative<FloatType>(f.retType->v);
+      emitExpr(*rt.value, getIntWidth(f.retType), isFloat);
+    }
+    if (stackSize_ > 0) {
       indent();
-      out_ << "i32.const 0\n";
+      out_ << "local.get $__old_sp\n";
       indent();
-      out_ << "local.set $__pc\n";
+      out_ << "global.set $__stack_pointer\n";
+    }
+    indent();
+    out_ << "return\n";
+  }
 
-      indent();
-      out_ << "(loop $__symir_dispatch_loop\n";
-      indent_level_++;
+  void WasmBackend::emitDispatchLoop(const FunDecl &f) {
+    indent();
+    out_ << "i32.const 0\n";
+    indent();
+    out_ << "local.set $__pc\n";
 
-      for (size_t i = 0; i < f.blocks.size(); ++i) {
-        indent();
-        out_ << "(block " << mangleName(f.blocks[i].label.name) << "\n";
-        indent_level_++;
-      }
+    indent();
+    out_ << "(loop $__symir_dispatch_loop\n";
+    indent_level_++;
 
+    for (size_t i = 0; i < f.blocks.size(); ++i) {
       indent();
-      out_ << "local.get $__pc\n";
-      indent();
-      out_ << "br_table";
-      for (int i = f.blocks.size() - 1; i >= 0; --i) {
-        out_ << " " << i;
-      }
-      out_ << " 0\n";
-
-      for (int i = f.blocks.size() - 1; i >= 0; --i) {
-        indent_level_--;
-        indent();
-        out_ << ") ;; " << f.blocks[i].label.name << "\n";
-
-        const auto &b = f.blocks[i];
-        for (const auto &ins: b.instrs) {
-          std::visit(
-              [this](auto &&arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, AssignInstr>) {
-                  if (locals_.count(arg.lhs.base.name)) {
-                    const auto &info = locals_.at(arg.lhs.base.name);
-                    TypePtr lhsTy = getLValueType(arg.lhs);
-                    if (lhsTy && std::holds_alternative<VecType>(lhsTy->v) &&
-                        arg.lhs.accesses.empty()) {
-                      auto &vt = std::get<VecType>(lhsTy->v);
-                      std::uint32_t elemSize = getTypeSize(vt.elem);
-                      bool valIsFloat = std::holds_alternative<FloatType>(vt.elem->v);
-                      uint32_t width = getIntWidth(vt.elem);
-                      for (uint64_t i = 0; i < vt.size; ++i) {
-                        indent();
-                        out_ << "local.get $__old_sp\n";
-                        indent();
-                        out_ << "i32.const " << (info.offset - i * elemSize) << "\n";
-                        indent();
-                        out_ << "i32.sub\n";
+      out_ << "(block " << mangleName(f.blocks[i].label.name) << "\n";
+      indent_level_++;
+    }
 
-                        emitVecExprLane(arg.rhs, vt, i, width, valIsFloat);
+    indent();
+    out_ << "local.get $__pc\n";
+    indent();
+    out_ << "br_table";
+    for (int i = f.blocks.size() - 1; i >= 0; --i) {
+      out_ << " " << i;
+    }
+    out_ << " 0\n";
 
-                        indent();
-                        if (valIsFloat) {
-                          out_ << (width == 32 ? "f32.store\n" : "f64.store\n");
-                        } else {
-                          out_ << (width <= 8
-                                       ? "i32.store8"
-                                       : (width <= 16 ? "i32.store16"
-                                                      : (width <= 32 ? "i32.store" : "i64.store")))
-                               << "\n";
-                        }
-                      }
-                    } else if (info.isAggregate || !arg.lhs.accesses.empty()) {
-                      emitAddress(arg.lhs);
-                      TypePtr curType = info.symirType;
-                      for (const auto &acc: arg.lhs.accesses) {
-                        if (std::holds_alternative<AccessIndex>(acc)) {
-                          if (auto at = std::get_if<ArrayType>(&curType->v))
-                            curType = at->elem;
-                          else if (auto vt = std::get_if<VecType>(&curType->v))
-                            curType = vt->elem;
-                        } else if (auto af = std::get_if<AccessField>(&acc)) {
-                          if (auto st = std::get_if<StructType>(&curType->v)) {
-                            auto &fld = af->field;
-                            if (structLayouts_.count(st->name.name) &&
-                                structLayouts_.at(st->name.name).fields.count(fld))
-                              curType = structLayouts_.at(st->name.name).fields.at(fld).type;
-                          }
-                        }
-                      }
-                      std::uint32_t width = 0;
-                      bool valIsFloat = false;
-                      if (auto bits = TypeUtils::getBitWidth(curType)) {
-                        width = *bits;
-                      } else if (curType && std::holds_alternative<FloatType>(curType->v)) {
-                        valIsFloat = true;
-                        width = (std::get<FloatType>(curType->v).kind == FloatType::Kind::F32) ? 32
-                                                                                               : 64;
-                      } else if (curType && std::holds_alternative<PtrType>(curType->v)) {
-                        // WASM pointers are 32-bit (one i32 cell).
-                        width = 32;
-                      }
+    for (int i = f.blocks.size() - 1; i >= 0; --i) {
+      indent_level_--;
+      indent();
+      out_ << ") ;; " << f.blocks[i].label.name << "\n";
 
-                      emitExpr(arg.rhs, width, valIsFloat);
-                      indent();
-                      if (valIsFloat) {
-                        out_ << (width == 32 ? "f32.store\n" : "f64.store\n");
-                      } else {
-                        if (width <= 8)
-                          out_ << "i32.store8\n";
-                        else if (width <= 16)
-                          out_ << "i32.store16\n";
-                        else if (width <= 32)
-                          out_ << "i32.store\n";
-                        else
-                          out_ << "i64.store\n";
-                      }
-                    } else {
-                      bool isFloat = std::holds_alternative<FloatType>(info.symirType->v);
-                      bool isPtr = std::holds_alternative<PtrType>(info.symirType->v);
-                      if (isPtr) {
-                        emitPtrExpr(arg.rhs, info.symirType);
-                      } else if (isPtrDiff(arg.rhs)) {
-                        // ptr - ptr → i64 element distance. Emit byte diff, then /sizeof.
-                        emitPtrDiff(arg.rhs);
-                      } else {
-                        emitExpr(arg.rhs, info.bitwidth, isFloat);
-                      }
-                      indent();
-                      out_ << "local.set " << mangleName(arg.lhs.base.name) << "\n";
-                    }
-                  }
-                } else if constexpr (std::is_same_v<T, RequireInstr>) {
-                  if (!noRequire_) {
-                    emitCond(arg.cond);
-                    indent();
-                    out_ << "i32.eqz\n";
-                    indent();
-                    out_ << "if\n";
-                    indent_level_++;
-                    indent();
-                    out_ << "unreachable\n";
-                    indent_level_--;
-                    indent();
-                    out_ << "end\n";
-                  }
-                } else if constexpr (std::is_same_v<T, StoreInstr>) {
-                  // *ptr = val — with null-pointer trap
-                  // Determine pointee type from the pointer expression
-                  uint32_t storeWidth = 32;
-                  bool storeIsFloat = false;
-                  if (auto rva = std::get_if<RValueAtom>(&arg.ptr.first.v)) {
-                    if (locals_.count(rva->rval.base.name)) {
-                      const auto &pinfo = locals_.at(rva->rval.base.name);
-                      if (auto pt = std::get_if<PtrType>(&pinfo.symirType->v)) {
-                        if (auto bits = TypeUtils::getBitWidth(pt->pointee)) {
-                          storeWidth = *bits;
-                        } else if (pt->pointee &&
-                                   std::holds_alternative<FloatType>(pt->pointee->v)) {
-                          storeIsFloat = true;
-                          storeWidth =
-                              (std::get<FloatType>(pt->pointee->v).kind == FloatType::Kind::F32)
-                                  ? 32
-                                  : 64;
-                        }
-                      }
-                    }
-                  }
-                  // Emit ptr expr → save to $__ptr_temp, null check, then store
-                  emitExpr(arg.ptr, 32, false);
-                  indent();
-                  out_ << "local.tee $__ptr_temp\n";
-                  indent();
-                  out_ << "i32.eqz\n";
-                  indent();
-                  out_ << "if\n";
-                  indent_level_++;
-                  indent();
-                  out_ << "unreachable\n";
-                  indent_level_--;
-                  indent();
-                  out_ << "end\n";
-                  indent();
-                  out_ << "local.get $__ptr_temp\n";
-                  emitExpr(arg.val, storeWidth, storeIsFloat);
-                  indent();
-                  if (storeIsFloat) {
-                    out_ << (storeWidth <= 32 ? "f32.store\n" : "f64.store\n");
-                  } else {
-                    out_
-                        << (storeWidth <= 8    ? "i32.store8\n"
-                            : storeWidth <= 16 ? "i32.store16\n"
-                            : storeWidth <= 32 ? "i32.store\n"
-                                               : "i64.store\n");
-                  }
-                }
-              },
-              ins
-          );
-        }
+      const auto &b = f.blocks[i];
+      emitInstrs(b);
 
-        std::visit(
-            [this, &f, &f_blocks = f.blocks](auto &&arg) {
-              using T = std::decay_t<decltype(arg)>;
-              if constexpr (std::is_same_v<T, BrTerm>) {
-                if (arg.isConditional) {
-                  emitCond(*arg.cond);
-                  indent();
-                  out_ << "if\n";
-                  indent_level_++;
-                  int thenIdx = -1;
-                  for (size_t j = 0; j < f_blocks.size(); ++j)
-                    if (f_blocks[j].label.name == arg.thenLabel.name)
-                      thenIdx = j;
-                  indent();
-                  out_ << "i32.const " << thenIdx << "\n";
-                  indent();
-                  out_ << "local.set $__pc\n";
-                  indent_level_--;
-                  indent();
-                  out_ << "else\n";
-                  indent_level_++;
-                  int elseIdx = -1;
-                  for (size_t j = 0; j < f_blocks.size(); ++j)
-                    if (f_blocks[j].label.name == arg.elseLabel.name)
-                      elseIdx = j;
-                  indent();
-                  out_ << "i32.const " << elseIdx << "\n";
-                  indent();
-                  out_ << "local.set $__pc\n";
-                  indent_level_--;
-                  indent();
-                  out_ << "end\n";
-                  indent();
-                  out_ << "br $__symir_dispatch_loop\n";
-                } else {
-                  int destIdx = -1;
-                  for (size_t j = 0; j < f_blocks.size(); ++j)
-                    if (f_blocks[j].label.name == arg.dest.name)
-                      destIdx = j;
-                  indent();
-                  out_ << "i32.const " << destIdx << "\n";
-                  indent();
-                  out_ << "local.set $__pc\n";
-                  indent();
-                  out_ << "br $__symir_dispatch_loop\n";
-                }
-              } else if constexpr (std::is_same_v<T, RetTerm>) {
-                if (arg.value) {
-                  bool isFloat = std::holds_alternative<FloatType>(f.retType->v);
-                  emitExpr(*arg.value, getIntWidth(f.retType), isFloat);
-                }
-                if (stackSize_ > 0) {
-                  indent();
-                  out_ << "local.get $__old_sp\n";
-                  indent();
-                  out_ << "global.set $__stack_pointer\n";
-                }
+      std::visit(
+          [this, &f, &f_blocks = f.blocks](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, BrTerm>) {
+              if (arg.isConditional) {
+                emitCond(*arg.cond);
+                indent();
+                out_ << "if\n";
+                indent_level_++;
+                int thenIdx = -1;
+                for (size_t j = 0; j < f_blocks.size(); ++j)
+                  if (f_blocks[j].label.name == arg.thenLabel.name)
+                    thenIdx = j;
+                indent();
+                out_ << "i32.const " << thenIdx << "\n";
+                indent();
+                out_ << "local.set $__pc\n";
+                indent_level_--;
+                indent();
+                out_ << "else\n";
+                indent_level_++;
+                int elseIdx = -1;
+                for (size_t j = 0; j < f_blocks.size(); ++j)
+                  if (f_blocks[j].label.name == arg.elseLabel.name)
+                    elseIdx = j;
                 indent();
-                out_ << "return\n";
-              } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
+                out_ << "i32.const " << elseIdx << "\n";
                 indent();
-                out_ << "unreachable\n";
+                out_ << "local.set $__pc\n";
+                indent_level_--;
+                indent();
+                out_ << "end\n";
+                indent();
+                out_ << "br $__symir_dispatch_loop\n";
+              } else {
+                int destIdx = -1;
+                for (size_t j = 0; j < f_blocks.size(); ++j)
+                  if (f_blocks[j].label.name == arg.dest.name)
+                    destIdx = j;
+                indent();
+                out_ << "i32.const " << destIdx << "\n";
+                indent();
+                out_ << "local.set $__pc\n";
+                indent();
+                out_ << "br $__symir_dispatch_loop\n";
               }
-            },
-            b.term
-        );
-      }
+            } else if constexpr (std::is_same_v<T, RetTerm>) {
+              emitRet(arg, f);
+            } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
+              indent();
+              out_ << "unreachable\n";
+            }
+          },
+          b.term
+      );
+    }
 
+    indent_level_--;
+    indent();
+    out_ << ") ;; dispatch loop\n";
+  }
+
+  void WasmBackend::emitStructuredTree(const StructuredCfg &sc, std::size_t b) {
+    const auto &label = sc.f->blocks[b].label.name;
+    bool loop = sc.isLoopHeader[b];
+    if (loop) {
+      indent();
+      out_ << "(loop $__loop_" << stripSigil(label) << "\n";
+      indent_level_++;
+    }
+    emitStructuredWithin(sc, b, 0);
+    if (loop) {
       indent_level_--;
       indent();
-      out_ << ") ;; dispatch loop\n";
-
-      if (f.retType && !f.blocks.empty()) {
-        indent();
-        bool isFloat = std::holds_alternative<FloatType>(f.retType->v);
-        if (isFloat) {
-          out_ << (getIntWidth(f.retType) <= 32 ? "f32.const 0.0\n" : "f64.const 0.0\n");
-        } else {
-          out_ << (getIntWidth(f.retType) <= 32 ? "i32.const 0\n" : "i64.const 0\n");
-        }
-      }
+      out_ << ") ;; loop " << label << "\n";
+    }
+  }
 
-      indent_level_--;
+  void WasmBackend::emitStructuredWithin(
+      const StructuredCfg &sc, std::size_t b, std::size_t firstChild
+  ) {
+    const auto &children = sc.mergeChildren[b];
+    if (firstChild < children.size()) {
+      // Branches to the child leave this block; its code follows.
+      const auto &label = sc.f->blocks[children[firstChild]].label.name;
       indent();
-      out_ << ")\n\n";
+      out_ << "(block " << mangleName(label) << "\n";
+      indent_level_++;
+      emitStructuredWithin(sc, b, firstChild + 1);
+      indent_level_--;
       indent();
-      std::string exportedName = stripSigil(f.name.name);
-      if (exportedName == "main")
-        exportedName = "symir_main";
-      out_ << "(export \"" << exportedName << "\" (func " << mangleName(f.name.name) << "))\n";
+      out_ << ") ;; " << label << "\n";
+      emitStructuredTree(sc, children[firstChild]);
+      return;
     }
 
-    if (!noModuleTags_) {
-      indent_level_--;
-      out_ << ")\n";
+    const auto &blk = sc.f->blocks[b];
+    emitInstrs(blk);
+    std::visit(
+        [&](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, BrTerm>) {
+            if (arg.isConditional) {
+              emitCond(*arg.cond);
+              indent();
+              out_ << "if\n";
+              indent_level_++;
+              emitStructuredBranch(sc, b, arg.thenLabel);
+              indent_level_--;
+              indent();
+              out_ << "else\n";
+              indent_level_++;
+              emitStructuredBranch(sc, b, arg.elseLabel);
+              indent_level_--;
+              indent();
+              out_ << "end\n";
+            } else {
+              emitStructuredBranch(sc, b, arg.dest);
+            }
+          } else if constexpr (std::is_same_v<T, RetTerm>) {
+            emitRet(arg, *sc.f);
+          } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
+            indent();
+            out_ << "unreachable\n";
+          }
+        },
+        blk.term
+    );
+  }
+
+  void WasmBackend::emitStructuredBranch(
+      const StructuredCfg &sc, std::size_t from, const BlockLabel &to
+  ) {
+    std::size_t dst = sc.cfg->indexOf.at(CFG::labelKey(to));
+    indent();
+    if (sc.isBackEdge(from, dst)) {
+      out_ << "br $__loop_" << stripSigil(to.name) << "\n";
+    } else if (sc.isMerge[dst]) {
+      out_ << "br " << mangleName(to.name) << "\n";
+    } else {
+      // The only forward edge into `dst`: its code goes right here.
+      out_ << ";; -> " << to.name << "\n";
+      emitStructuredTree(sc, dst);
     }
   }
 
@@ -2113,6 +2252,9 @@ namespace symir {
   }
 
   TypePtr WasmBackend::getLValueType(const LValue &lv) {
+    if (nodeTypes_)
+      if (auto t = nodeTypes_->of(lv))
+        return t;
     if (!locals_.count(lv.base.name))
       return nullptr;
     const auto &info = locals_.at(lv.base.name);
@@ -2640,4 +2782,379 @@ namespace symir {
     }
   }
 
+  const char *WasmBackend::simdShape(const VecType &vt) {
+    if (!vt.elem || getTypeSize(vt.elem) * vt.size % 16 != 0)
+      return nullptr;
+    if (auto ft = std::get_if<FloatType>(&vt.elem->v))
+      return ft->kind == FloatType::Kind::F32 ? "f32x4" : "f64x2";
+    switch (getIntWidth(vt.elem)) {
+      case 8:
+        return "i8x16";
+      case 16:
+        return "i16x8";
+      case 32:
+        return "i32x4";
+      case 64:
+        return "i64x2";
+      default:
+        return nullptr; // odd widths need the per-lane sign extension
+    }
+  }
+
+  bool WasmBackend::isSimdVecLocal(const std::string &name) {
+    auto it = locals_.find(name);
+    return it != locals_.end() && it->second.isAggregate && it->second.symirType &&
+           std::holds_alternative<VecType>(it->second.symirType->v);
+  }
+
+  bool WasmBackend::canSimdCoef(const Coef &coef) {
+    if (std::holds_alternative<IntLit>(coef) || std::holds_alternative<FloatLit>(coef))
+      return true;
+    // Syms are read through one import per lane.
+    auto id = std::get_if<LocalOrSymId>(&coef);
+    if (!id || !std::holds_alternative<LocalId>(*id))
+      return false;
+    const auto &name = std::get<LocalId>(*id).name;
+    return locals_.count(name) != 0;
+  }
+
+  bool WasmBackend::canSimdAtom(const Atom &atom) {
+    return std::visit(
+        [this](auto &&arg) -> bool {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, RValueAtom>) {
+            return arg.rval.accesses.empty() && isSimdVecLocal(arg.rval.base.name);
+          } else if constexpr (std::is_same_v<T, CoefAtom>) {
+            return canSimdCoef(arg.coef);
+          } else if constexpr (std::is_same_v<T, OpAtom>) {
+            return arg.rval.accesses.empty() && isSimdVecLocal(arg.rval.base.name) &&
+                   canSimdCoef(arg.coef);
+          } else if constexpr (std::is_same_v<T, UnaryAtom>) {
+            return arg.rval.accesses.empty() && isSimdVecLocal(arg.rval.base.name);
+          } else {
+            return false;
+          }
+        },
+        atom.v
+    );
+  }
+
+  bool WasmBackend::canSimdAssign(const LValue &lhs, const Expr &rhs, const VecType &vt) {
+    if (!lhs.accesses.empty() || !isSimdVecLocal(lhs.base.name))
+      return false;
+    auto selectValOk = [&](const SelectVal &sv) {
+      if (auto rv = std::get_if<RValue>(&sv))
+        return rv->accesses.empty() && isSimdVecLocal(rv->base.name);
+      return canSimdCoef(std::get<Coef>(sv));
+    };
+    if (rhs.rest.empty()) {
+      if (auto cmp = std::get_if<CmpAtom>(&rhs.first.v)) {
+        TypePtr opTy = getSelectValType(cmp->lhs);
+        return opTy && std::holds_alternative<VecType>(opTy->v) &&
+               simdShape(std::get<VecType>(opTy->v)) && selectValOk(cmp->lhs) &&
+               selectValOk(cmp->rhs);
+      }
+      if (auto sel = std::get_if<SelectAtom>(&rhs.first.v)) {
+        if (!sel->maskExpr || !sel->maskExpr->rest.empty() || !simdShape(vt))
+          return false;
+        auto mask = std::get_if<RValueAtom>(&sel->maskExpr->first.v);
+        return mask && mask->rval.accesses.empty() && isSimdVecLocal(mask->rval.base.name) &&
+               selectValOk(sel->vtrue) && selectValOk(sel->vfalse);
+      }
+    }
+    std::string shape = simdShape(vt) ? simdShape(vt) : "";
+    if (shape.empty())
+      return false;
+    bool isFloat = shape[0] == 'f';
+    auto atomOk = [&](const Atom &a) {
+      if (!canSimdAtom(a))
+        return false;
+      auto op = std::get_if<OpAtom>(&a.v);
+      if (!op)
+        return true;
+      switch (op->op) {
+        case AtomOpKind::Mul:
+          return shape != "i8x16";
+        case AtomOpKind::Div:
+          return isFloat;
+        case AtomOpKind::And:
+        case AtomOpKind::Or:
+        case AtomOpKind::Xor:
+          return !isFloat;
+        default:
+          // No integer division or remainder, and SIMD128 shifts take one
+          // count for all lanes.
+          return false;
+      }
+    };
+    if (!atomOk(rhs.first))
+      return false;
+    for (const auto &t: rhs.rest)
+      if (!atomOk(t.atom))
+        return false;
+    return true;
+  }
+
+  void WasmBackend::emitSimdAddress(const std::string &name, std::uint32_t byteOffset) {
+    indent();
+    out_ << "local.get $__old_sp\n";
+    indent();
+    out_ << "i32.const " << (locals_.at(name).offset - byteOffset) << "\n";
+    indent();
+    out_ << "i32.sub\n";
+  }
+
+  void WasmBackend::emitSimdCoef(const Coef &coef, const VecType &vt, std::uint64_t chunk) {
+    if (auto id = std::get_if<LocalOrSymId>(&coef)) {
+      const auto &name = std::get<LocalId>(*id).name;
+      if (isSimdVecLocal(name)) {
+        emitSimdAddress(name, static_cast<std::uint32_t>(chunk * 16));
+        indent();
+        out_ << "v128.load\n";
+        return;
+      }
+    }
+    // A scalar: lane 0 of the broadcast, splatted.
+    bool isFloat = std::holds_alternative<FloatType>(vt.elem->v);
+    std::uint32_t width = isFloat ? getTypeSize(vt.elem) * 8 : getIntWidth(vt.elem);
+    emitVecCoefLane(coef, vt, 0, width, isFloat);
+    indent();
+    out_ << simdShape(vt) << ".splat\n";
+  }
+
+  void WasmBackend::emitSimdSelectVal(const SelectVal &sv, const VecType &vt, std::uint64_t chunk) {
+    if (auto rv = std::get_if<RValue>(&sv)) {
+      emitSimdAddress(rv->base.name, static_cast<std::uint32_t>(chunk * 16));
+      indent();
+      out_ << "v128.load\n";
+    } else {
+      emitSimdCoef(std::get<Coef>(sv), vt, chunk);
+    }
+  }
+
+  void WasmBackend::emitSimdAtom(const Atom &atom, const VecType &vt, std::uint64_t chunk) {
+    std::string shape = simdShape(vt);
+    bool isFloat = shape[0] == 'f';
+    std::visit(
+        [&](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, RValueAtom>) {
+            emitSimdAddress(arg.rval.base.name, static_cast<std::uint32_t>(chunk * 16));
+            indent();
+            out_ << "v128.load\n";
+          } else if constexpr (std::is_same_v<T, CoefAtom>) {
+            emitSimdCoef(arg.coef, vt, chunk);
+          } else if constexpr (std::is_same_v<T, OpAtom>) {
+            emitSimdCoef(arg.coef, vt, chunk);
+            emitSimdAddress(arg.rval.base.name, static_cast<std::uint32_t>(chunk * 16));
+            indent();
+            out_ << "v128.load\n";
+            indent();
+            switch (arg.op) {
+              case AtomOpKind::Mul:
+                out_ << shape << ".mul\n";
+                break;
+              case AtomOpKind::Div:
+                out_ << shape << ".div\n";
+                break;
+              case AtomOpKind::And:
+                out_ << "v128.and\n";
+                break;
+              case AtomOpKind::Or:
+                out_ << "v128.or\n";
+                break;
+              case AtomOpKind::Xor:
+                out_ << "v128.xor\n";
+                break;
+              default:
+                break; // rejected by canSimdAssign
+            }
+          } else if constexpr (std::is_same_v<T, UnaryAtom>) {
+            emitSimdAddress(arg.rval.base.name, static_cast<std::uint32_t>(chunk * 16));
+            indent();
+            out_ << "v128.load\n";
+            indent();
+            out_ << (isFloat ? shape + ".neg\n" : std::string("v128.not\n"));
+          }
+        },
+        atom.v
+    );
+  }
+
+  void WasmBackend::emitInstrs(const Block &b) {
+    std::vector<LaneRun> runs = findLaneRuns(b);
+    auto run = runs.begin();
+    for (std::size_t i = 0; i < b.instrs.size(); ++i) {
+      if (run != runs.end() && run->first == i) {
+        bool emitted = emitLaneRun(*run);
+        i += emitted ? run->lanes - 1 : 0;
+        ++run;
+        if (emitted)
+          continue;
+      }
+      emitInstr(b.instrs[i]);
+    }
+  }
+
+  bool WasmBackend::emitLaneRun(const LaneRun &run) {
+    if (!simd_ || !isSimdVecLocal(run.vec))
+      return false;
+    const auto &vt = std::get<VecType>(locals_.at(run.vec).symirType->v);
+    LValue row = *run.element;
+    row.accesses.pop_back();
+    row.id = 0; // not the element's type
+    TypePtr rowType = getLValueType(row);
+    if (vt.size != run.lanes || !simdShape(vt) || !TypeUtils::asArray(rowType) ||
+        !TypeUtils::areTypesEqual(TypeUtils::asArray(rowType)->elem, vt.elem))
+      return false;
+    // The elements, like the vector, lie in memory lane after lane.
+    auto emitElements = [&](std::uint32_t byteOffset) {
+      emitAddress(*run.element);
+      if (byteOffset) {
+        indent();
+        out_ << "i32.const " << byteOffset << "\n";
+        indent();
+        out_ << "i32.add\n";
+      }
+    };
+    std::uint64_t chunks = vt.size * getTypeSize(vt.elem) / 16;
+    for (std::uint32_t c = 0; c < chunks; ++c) {
+      if (run.store) {
+        emitElements(c * 16);
+        emitSimdAddress(run.vec, c * 16);
+      } else {
+        emitSimdAddress(run.vec, c * 16);
+        emitElements(c * 16);
+      }
+      indent();
+      out_ << "v128.load\n";
+      indent();
+      out_ << "v128.store\n";
+    }
+    return true;
+  }
+
+  bool WasmBackend::emitVecSimdAssign(const LValue &lhs, const Expr &rhs, const VecType &vt) {
+    if (!canSimdAssign(lhs, rhs, vt))
+      return false;
+    const std::string &dst = lhs.base.name;
+
+    if (auto cmp = rhs.rest.empty() ? std::get_if<CmpAtom>(&rhs.first.v) : nullptr) {
+      const auto &opVt = std::get<VecType>(getSelectValType(cmp->lhs)->v);
+      std::string shape = simdShape(opVt);
+      bool isFloat = shape[0] == 'f';
+      std::uint32_t laneBytes = getTypeSize(opVt.elem);
+      std::uint32_t lanes = 16 / laneBytes;
+      static const char *intOps[] = {"eq", "ne", "lt_s", "le_s", "gt_s", "ge_s"};
+      static const char *floatOps[] = {"eq", "ne", "lt", "le", "gt", "ge"};
+      for (std::uint64_t c = 0; c < opVt.size / lanes; ++c) {
+        // One 0/1 byte per lane of the `<N> i1`: the low byte of each
+        // all-ones/all-zeros lane, masked to bit 0.
+        emitSimdAddress(dst, static_cast<std::uint32_t>(c * lanes));
+        emitSimdSelectVal(cmp->lhs, opVt, c);
+        emitSimdSelectVal(cmp->rhs, opVt, c);
+        indent();
+        out_ << shape << "." << (isFloat ? floatOps : intOps)[static_cast<int>(cmp->op)] << "\n";
+        if (lanes < 16) {
+          indent();
+          out_ << "v128.const i64x2 0 0\n";
+          indent();
+          out_ << "i8x16.shuffle";
+          for (std::uint32_t j = 0; j < 16; ++j)
+            out_ << " " << (j < lanes ? j * laneBytes : 0);
+          out_ << "\n";
+        }
+        indent();
+        out_ << "v128.const i8x16 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1\n";
+        indent();
+        out_ << "v128.and\n";
+        indent();
+        switch (lanes) {
+          case 16:
+            out_ << "v128.store\n";
+            break;
+          case 8:
+            out_ << "i64x2.extract_lane 0\n";
+            indent();
+            out_ << "i64.store\n";
+            break;
+          case 4:
+            out_ << "i32x4.extract_lane 0\n";
+            indent();
+            out_ << "i32.store\n";
+            break;
+          default:
+            out_ << "i16x8.extract_lane_u 0\n";
+            indent();
+            out_ << "i32.store16\n";
+            break;
+        }
+      }
+      return true;
+    }
+
+    std::string shape = simdShape(vt);
+    std::uint32_t laneBytes = getTypeSize(vt.elem);
+    std::uint32_t lanes = 16 / laneBytes;
+    for (std::uint64_t c = 0; c < vt.size / lanes; ++c) {
+      emitSimdAddress(dst, static_cast<std::uint32_t>(c * 16));
+      if (auto sel = rhs.rest.empty() ? std::get_if<SelectAtom>(&rhs.first.v) : nullptr) {
+        emitSimdSelectVal(sel->vtrue, vt, c);
+        emitSimdSelectVal(sel->vfalse, vt, c);
+        // Widen the chunk's 0/1 mask bytes to lanes, then negate them into
+        // all-ones/all-zeros lanes for bitselect.
+        const auto &mask = std::get<RValueAtom>(sel->maskExpr->first.v).rval.base.name;
+        emitSimdAddress(mask, static_cast<std::uint32_t>(c * lanes));
+        indent();
+        switch (lanes) {
+          case 16:
+            out_ << "v128.load\n";
+            break;
+          case 8:
+            out_ << "i64.load\n";
+            indent();
+            out_ << "i64x2.splat\n";
+            break;
+          case 4:
+            out_ << "i32.load\n";
+            indent();
+            out_ << "i32x4.splat\n";
+            break;
+          default:
+            out_ << "i32.load16_u\n";
+            indent();
+            out_ << "i32x4.splat\n";
+            break;
+        }
+        if (lanes <= 8) {
+          indent();
+          out_ << "i16x8.extend_low_i8x16_u\n";
+        }
+        if (lanes <= 4) {
+          indent();
+          out_ << "i32x4.extend_low_i16x8_u\n";
+        }
+        if (lanes <= 2) {
+          indent();
+          out_ << "i64x2.extend_low_i32x4_u\n";
+        }
+        static const char *intShape[] = {"", "i8x16", "i16x8", "", "i32x4", "", "", "", "i64x2"};
+        indent();
+        out_ << intShape[laneBytes] << ".neg\n";
+        indent();
+        out_ << "v128.bitselect\n";
+      } else {
+        emitSimdAtom(rhs.first, vt, c);
+        for (const auto &t: rhs.rest) {
+          emitSimdAtom(t.atom, vt, c);
+          indent();
+          out_ << shape << (t.op == AddOp::Plus ? ".add\n" : ".sub\n");
+        }
+      }
+      indent();
+      out_ << "v128.store\n";
+    }
+    return true;
+  }
+
 } // namespace symir
@@ -0,0 +1,731 @@
+#include "backend/wasm_binary.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace symir {
+
+  namespace {
+
+    struct SExpr {
+      bool isList = false;
+      std::string atom;
+      std::vector<SExpr> items;
+    };
+
+    [[noreturn]] void fail(const std::string &msg) {
+      throw std::runtime_error("wasm-bin: " + msg);
+    }
+
+    std::vector<SExpr> parseSExprs(const std::string &src) {
+      std::vector<std::vector<SExpr>> open(1);
+      std::size_t i = 0;
+      const std::size_t n = src.size();
+      while (i < n) {
+        char c = src[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+          ++i;
+        } else if (c == ';' && i + 1 < n && src[i + 1] == ';') {
+          while (i < n && src[i] != '\n')
+            ++i;
+        } else if (c == '(') {
+          open.emplace_back();
+          ++i;
+        } else if (c == ')') {
+          if (open.size() < 2)
+            fail("unbalanced ')'");
+          SExpr list;
+          list.isList = true;
+          list.items = std::move(open.back());
+          open.pop_back();
+          open.back().push_back(std::move(list));
+          ++i;
+        } else {
+          std::size_t start = i;
+          if (c == '"') {
+            i = src.find('"', i + 1);
+            if (i == std::string::npos)
+              fail("unterminated string");
+            ++i;
+          } else {
+            while (i < n && !std::isspace(static_cast<unsigned char>(src[i])) && src[i] != '(' &&
+                   src[i] != ')')
+              ++i;
+          }
+          SExpr atom;
+          atom.atom = src.substr(start, i - start);
+          open.back().push_back(std::move(atom));
+        }
+      }
+      if (open.size() != 1)
+        fail("unbalanced '('");
+      return std::move(open[0]);
+    }
+
+    // --- Encoding primitives ---
+
+    void putU(std::string &out, std::uint64_t v) {
+      do {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        out.push_back(static_cast<char>(v ? b | 0x80 : b));
+      } while (v);
+    }
+
+    void putS(std::string &out, std::int64_t v) {
+      for (;;) {
+        std::uint8_t b = v & 0x7f;
+        v >>= 7;
+        bool last = (v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40));
+        out.push_back(static_cast<char>(last ? b : b | 0x80));
+        if (last)
+          return;
+      }
+    }
+
+    void putName(std::string &out, const std::string &s) {
+      putU(out, s.size());
+      out += s;
+    }
+
+    void putSection(std::string &out, std::uint8_t id, std::uint32_t count, const std::string &body) {
+      std::string payload;
+      putU(payload, count);
+      payload += body;
+      out.push_back(static_cast<char>(id));
+      putU(out, payload.size());
+      out += payload;
+    }
+
+    template<typename T>
+    void putLE(std::string &out, T v) {
+      char bytes[sizeof(T)];
+      std::memcpy(bytes, &v, sizeof(T)); // WASM is little-endian, as are our hosts
+      out.append(bytes, sizeof(T));
+    }
+
+    std::uint8_t valType(const std::string &t) {
+      if (t == "i32")
+        return 0x7f;
+      if (t == "i64")
+        return 0x7e;
+      if (t == "f32")
+        return 0x7d;
+      if (t == "f64")
+        return 0x7c;
+      if (t == "v128")
+        return 0x7b;
+      fail("unknown value type '" + t + "'");
+    }
+
+    std::uint64_t parseInt(const std::string &s) {
+      std::size_t pos = (!s.empty() && (s[0] == '-' || s[0] == '+')) ? 1 : 0;
+      int base = 10;
+      if (s.compare(pos, 2, "0x") == 0 || s.compare(pos, 2, "0X") == 0) {
+        base = 16;
+        pos += 2;
+      }
+      std::string digits;
+      for (std::size_t i = pos; i < s.size(); ++i)
+        if (s[i] != '_')
+          digits += s[i];
+      errno = 0;
+      char *end = nullptr;
+      unsigned long long v = std::strtoull(digits.c_str(), &end, base);
+      if (digits.empty() || *end || errno)
+        fail("bad integer literal '" + s + "'");
+      return s[0] == '-' ? 0 - static_cast<std::uint64_t>(v) : static_cast<std::uint64_t>(v);
+    }
+
+    template<typename F>
+    F parseFloat(const std::string &s) {
+      char *end = nullptr;
+      F v = std::is_same_v<F, float> ? std::strtof(s.c_str(), &end) : std::strtod(s.c_str(), &end);
+      if (s.empty() || *end)
+        fail("bad float literal '" + s + "'");
+      return v;
+    }
+
+    const std::unordered_map<std::string, std::uint8_t> &coreOps() {
+      static const std::unordered_map<std::string, std::uint8_t> ops = {
+        {"unreachable", 0x00}, {"nop", 0x01},
+        {"br", 0x0c}, {"br_if", 0x0d}, {"br_table", 0x0e}, {"return", 0x0f}, {"call", 0x10},
+        {"drop", 0x1a}, {"select", 0x1b}, {"local.get", 0x20}, {"local.set", 0x21},
+        {"local.tee", 0x22}, {"global.get", 0x23}, {"global.set", 0x24}, {"i32.load", 0x28},
+        {"i64.load", 0x29}, {"f32.load", 0x2a}, {"f64.load", 0x2b}, {"i32.load8_s", 0x2c},
+        {"i32.load8_u", 0x2d}, {"i32.load16_s", 0x2e}, {"i32.load16_u", 0x2f},
+        {"i64.load8_s", 0x30}, {"i64.load8_u", 0x31}, {"i64.load16_s", 0x32},
+        {"i64.load16_u", 0x33}, {"i64.load32_s", 0x34}, {"i64.load32_u", 0x35}, {"i32.store", 0x36},
+        {"i64.store", 0x37}, {"f32.store", 0x38}, {"f64.store", 0x39}, {"i32.store8", 0x3a},
+        {"i32.store16", 0x3b}, {"i64.store8", 0x3c}, {"i64.store16", 0x3d}, {"i64.store32", 0x3e},
+        {"i32.const", 0x41}, {"i64.const", 0x42}, {"f32.const", 0x43}, {"f64.const", 0x44},
+        {"i32.eqz", 0x45}, {"i32.eq", 0x46}, {"i32.ne", 0x47}, {"i32.lt_s", 0x48},
+        {"i32.lt_u", 0x49}, {"i32.gt_s", 0x4a}, {"i32.gt_u", 0x4b}, {"i32.le_s", 0x4c},
+        {"i32.le_u", 0x4d}, {"i32.ge_s", 0x4e}, {"i32.ge_u", 0x4f}, {"i64.eqz", 0x50},
+        {"i64.eq", 0x51}, {"i64.ne", 0x52}, {"i64.lt_s", 0x53}, {"i64.lt_u", 0x54},
+        {"i64.gt_s", 0x55}, {"i64.gt_u", 0x56}, {"i64.le_s", 0x57}, {"i64.le_u", 0x58},
+        {"i64.ge_s", 0x59}, {"i64.ge_u", 0x5a}, {"f32.eq", 0x5b}, {"f32.ne", 0x5c},
+        {"f32.lt", 0x5d}, {"f32.gt", 0x5e}, {"f32.le", 0x5f}, {"f32.ge", 0x60}, {"f64.eq", 0x61},
+        {"f64.ne", 0x62}, {"f64.lt", 0x63}, {"f64.gt", 0x64}, {"f64.le", 0x65}, {"f64.ge", 0x66},
+        {"i32.clz", 0x67}, {"i32.ctz", 0x68}, {"i32.popcnt", 0x69}, {"i32.add", 0x6a},
+        {"i32.sub", 0x6b}, {"i32.mul", 0x6c}, {"i32.div_s", 0x6d}, {"i32.div_u", 0x6e},
+        {"i32.rem_s", 0x6f}, {"i32.rem_u", 0x70}, {"i32.and", 0x71}, {"i32.or", 0x72},
+        {"i32.xor", 0x73}, {"i32.shl", 0x74}, {"i32.shr_s", 0x75}, {"i32.shr_u", 0x76},
+        {"i32.rotl", 0x77}, {"i32.rotr", 0x78}, {"i64.clz", 0x79}, {"i64.ctz", 0x7a},
+        {"i64.popcnt", 0x7b}, {"i64.add", 0x7c}, {"i64.sub", 0x7d}, {"i64.mul", 0x7e},
+        {"i64.div_s", 0x7f}, {"i64.div_u", 0x80}, {"i64.rem_s", 0x81}, {"i64.rem_u", 0x82},
+        {"i64.and", 0x83}, {"i64.or", 0x84}, {"i64.xor", 0x85}, {"i64.shl", 0x86},
+        {"i64.shr_s", 0x87}, {"i64.shr_u", 0x88}, {"i64.rotl", 0x89}, {"i64.rotr", 0x8a},
+        {"f32.abs", 0x8b}, {"f32.neg", 0x8c}, {"f32.ceil", 0x8d}, {"f32.floor", 0x8e},
+        {"f32.trunc", 0x8f}, {"f32.nearest", 0x90}, {"f32.sqrt", 0x91}, {"f32.add", 0x92},
+        {"f32.sub", 0x93}, {"f32.mul", 0x94}, {"f32.div", 0x95}, {"f32.min", 0x96},
+        {"f32.max", 0x97}, {"f32.copysign", 0x98}, {"f64.abs", 0x99}, {"f64.neg", 0x9a},
+        {"f64.ceil", 0x9b}, {"f64.floor", 0x9c}, {"f64.trunc", 0x9d}, {"f64.nearest", 0x9e},
+        {"f64.sqrt", 0x9f}, {"f64.add", 0xa0}, {"f64.sub", 0xa1}, {"f64.mul", 0xa2},
+        {"f64.div", 0xa3}, {"f64.min", 0xa4}, {"f64.max", 0xa5}, {"f64.copysign", 0xa6},
+        {"i32.wrap_i64", 0xa7}, {"i32.trunc_f32_s", 0xa8}, {"i32.trunc_f32_u", 0xa9},
+        {"i32.trunc_f64_s", 0xaa}, {"i32.trunc_f64_u", 0xab}, {"i64.extend_i32_s", 0xac},
+        {"i64.extend_i32_u", 0xad}, {"i64.trunc_f32_s", 0xae}, {"i64.trunc_f32_u", 0xaf},
+        {"i64.trunc_f64_s", 0xb0}, {"i64.trunc_f64_u", 0xb1}, {"f32.convert_i32_s", 0xb2},
+        {"f32.convert_i32_u", 0xb3}, {"f32.convert_i64_s", 0xb4}, {"f32.convert_i64_u", 0xb5},
+        {"f32.demote_f64", 0xb6}, {"f64.convert_i32_s", 0xb7}, {"f64.convert_i32_u", 0xb8},
+        {"f64.convert_i64_s", 0xb9}, {"f64.convert_i64_u", 0xba}, {"f64.promote_f32", 0xbb},
+        {"i32.reinterpret_f32", 0xbc}, {"i64.reinterpret_f64", 0xbd}, {"f32.reinterpret_i32", 0xbe},
+        {"f64.reinterpret_i64", 0xbf}, {"i32.extend8_s", 0xc0}, {"i32.extend16_s", 0xc1},
+        {"i64.extend8_s", 0xc2}, {"i64.extend16_s", 0xc3}, {"i64.extend32_s", 0xc4},
+      };
+      return ops;
+    }
+
+    // Opcodes after the 0xfd prefix.
+    const std::unordered_map<std::string, std::uint32_t> &simdOps() {
+      static const std::unordered_map<std::string, std::uint32_t> ops = {
+        {"v128.load", 0}, {"v128.load8x8_s", 1}, {"v128.load8x8_u", 2}, {"v128.load16x4_s", 3},
+        {"v128.load16x4_u", 4}, {"v128.load32x2_s", 5}, {"v128.load32x2_u", 6},
+        {"v128.load8_splat", 7}, {"v128.load16_splat", 8}, {"v128.load32_splat", 9},
+        {"v128.load64_splat", 10}, {"v128.store", 11}, {"v128.const", 12}, {"i8x16.shuffle", 13},
+        {"i8x16.swizzle", 14}, {"i8x16.splat", 15}, {"i16x8.splat", 16}, {"i32x4.splat", 17},
+        {"i64x2.splat", 18}, {"f32x4.splat", 19}, {"f64x2.splat", 20}, {"i8x16.extract_lane_s", 21},
+        {"i8x16.extract_lane_u", 22}, {"i8x16.replace_lane", 23}, {"i16x8.extract_lane_s", 24},
+        {"i16x8.extract_lane_u", 25}, {"i16x8.replace_lane", 26}, {"i32x4.extract_lane", 27},
+        {"i32x4.replace_lane", 28}, {"i64x2.extract_lane", 29}, {"i64x2.replace_lane", 30},
+        {"f32x4.extract_lane", 31}, {"f32x4.replace_lane", 32}, {"f64x2.extract_lane", 33},
+        {"f64x2.replace_lane", 34}, {"i8x16.eq", 35}, {"i8x16.ne", 36}, {"i8x16.lt_s", 37},
+        {"i8x16.lt_u", 38}, {"i8x16.gt_s", 39}, {"i8x16.gt_u", 40}, {"i8x16.le_s", 41},
+        {"i8x16.le_u", 42}, {"i8x16.ge_s", 43}, {"i8x16.ge_u", 44}, {"i16x8.eq", 45},
+        {"i16x8.ne", 46}, {"i16x8.lt_s", 47}, {"i16x8.lt_u", 48}, {"i16x8.gt_s", 49},
+        {"i16x8.gt_u", 50}, {"i16x8.le_s", 51}, {"i16x8.le_u", 52}, {"i16x8.ge_s", 53},
+        {"i16x8.ge_u", 54}, {"i32x4.eq", 55}, {"i32x4.ne", 56}, {"i32x4.lt_s", 57},
+        {"i32x4.lt_u", 58}, {"i32x4.gt_s", 59}, {"i32x4.gt_u", 60}, {"i32x4.le_s", 61},
+        {"i32x4.le_u", 62}, {"i32x4.ge_s", 63}, {"i32x4.ge_u", 64}, {"f32x4.eq", 65},
+        {"f32x4.ne", 66}, {"f32x4.lt", 67}, {"f32x4.gt", 68}, {"f32x4.le", 69}, {"f32x4.ge", 70},
+        {"f64x2.eq", 71}, {"f64x2.ne", 72}, {"f64x2.lt", 73}, {"f64x2.gt", 74}, {"f64x2.le", 75},
+        {"f64x2.ge", 76}, {"v128.not", 77}, {"v128.and", 78}, {"v128.andnot", 79}, {"v128.or", 80},
+        {"v128.xor", 81}, {"v128.bitselect", 82}, {"v128.any_true", 83}, {"i8x16.abs", 96},
+        {"i8x16.neg", 97}, {"i8x16.popcnt", 98}, {"i8x16.all_true", 99}, {"i8x16.bitmask", 100},
+        {"i8x16.shl", 107}, {"i8x16.shr_s", 108}, {"i8x16.shr_u", 109}, {"i8x16.add", 110},
+        {"i8x16.add_sat_s", 111}, {"i8x16.add_sat_u", 112}, {"i8x16.sub", 113}, {"i16x8.abs", 128},
+        {"i16x8.neg", 129}, {"i16x8.extend_low_i8x16_s", 135}, {"i16x8.extend_high_i8x16_s", 136},
+        {"i16x8.extend_low_i8x16_u", 137}, {"i16x8.extend_high_i8x16_u", 138}, {"i16x8.shl", 139},
+        {"i16x8.shr_s", 140}, {"i16x8.shr_u", 141}, {"i16x8.add", 142}, {"i16x8.sub", 145},
+        {"i16x8.mul", 149}, {"i32x4.abs", 160}, {"i32x4.neg", 161},
+        {"i32x4.extend_low_i16x8_s", 167}, {"i32x4.extend_high_i16x8_s", 168},
+        {"i32x4.extend_low_i16x8_u", 169}, {"i32x4.extend_high_i16x8_u", 170}, {"i32x4.shl", 171},
+        {"i32x4.shr_s", 172}, {"i32x4.shr_u", 173}, {"i32x4.add", 174}, {"i32x4.sub", 177},
+        {"i32x4.mul", 181}, {"i64x2.abs", 192}, {"i64x2.neg", 193},
+        {"i64x2.extend_low_i32x4_s", 199}, {"i64x2.extend_high_i32x4_s", 200},
+        {"i64x2.extend_low_i32x4_u", 201}, {"i64x2.extend_high_i32x4_u", 202}, {"i64x2.shl", 203},
+        {"i64x2.shr_s", 204}, {"i64x2.shr_u", 205}, {"i64x2.add", 206}, {"i64x2.sub", 209},
+        {"i64x2.mul", 213}, {"i64x2.eq", 214}, {"i64x2.ne", 215}, {"i64x2.lt_s", 216},
+        {"i64x2.gt_s", 217}, {"i64x2.le_s", 218}, {"i64x2.ge_s", 219}, {"f32x4.abs", 224},
+        {"f32x4.neg", 225}, {"f32x4.sqrt", 227}, {"f32x4.add", 228}, {"f32x4.sub", 229},
+        {"f32x4.mul", 230}, {"f32x4.div", 231}, {"f64x2.abs", 236}, {"f64x2.neg", 237},
+        {"f64x2.sqrt", 239}, {"f64x2.add", 240}, {"f64x2.sub", 241}, {"f64x2.mul", 242},
+        {"f64x2.div", 243},
+      };
+      return ops;
+    }
+
+    /// Log2 of the natural alignment of a load or store.
+    std::uint32_t naturalAlign(const std::string &op) {
+      if (op.rfind("v128.", 0) == 0)
+        return 4;
+      for (const char *w: {"8", "16", "32"}) {
+        std::string suffix = std::string(op.find(".load") != std::string::npos ? "load" : "store") + w;
+        auto at = op.find(suffix);
+        if (at != std::string::npos &&
+            (at + suffix.size() == op.size() || op[at + suffix.size()] == '_'))
+          return w[0] == '8' ? 0 : (w[0] == '1' ? 1 : 2);
+      }
+      return op[1] == '6' ? 3 : 2; // i64/f64 : i32/f32
+    }
+
+    bool isLabelRef(const SExpr &e) {
+      return !e.isList && !e.atom.empty() &&
+             (e.atom[0] == '$' || std::isdigit(static_cast<unsigned char>(e.atom[0])));
+    }
+
+    class Assembler {
+    public:
+      std::string run(const SExpr &module, bool names);
+
+    private:
+      using Locals = std::unordered_map<std::string, std::uint32_t>;
+
+      std::vector<std::pair<std::string, std::string>> types_; // param, result valtypes
+      std::unordered_map<std::string, std::uint32_t> funcIdx_, globalIdx_;
+      std::vector<std::string> funcNames_; // by function index
+      std::vector<std::vector<std::pair<std::uint32_t, std::string>>> localNames_;
+
+      static std::size_t headerEnd(const std::vector<SExpr> &items, std::size_t from);
+      std::uint32_t typeOf(const std::vector<SExpr> &items, std::size_t from);
+      std::string code(const SExpr &func);
+      void emitSeq(
+          const std::vector<SExpr> &items, std::size_t from, std::string &out, const Locals &locals,
+          std::vector<std::string> &labels
+      );
+      std::uint32_t resolveLabel(const std::string &ref, const std::vector<std::string> &labels);
+    };
+
+    std::size_t Assembler::headerEnd(const std::vector<SExpr> &items, std::size_t from) {
+      while (from < items.size() && items[from].isList && !items[from].items.empty() &&
+             (items[from].items[0].atom == "param" || items[from].items[0].atom == "result" ||
+              items[from].items[0].atom == "local"))
+        ++from;
+      return from;
+    }
+
+    std::uint32_t Assembler::typeOf(const std::vector<SExpr> &items, std::size_t from) {
+      std::string params, results;
+      for (std::size_t i = from, end = headerEnd(items, from); i < end; ++i) {
+        const auto &decl = items[i].items;
+        if (decl[0].atom == "local")
+          continue;
+        std::string &dst = decl[0].atom == "param" ? params : results;
+        for (std::size_t k = 1; k < decl.size(); ++k)
+          if (decl[k].atom[0] != '$')
+            dst.push_back(static_cast<char>(valType(decl[k].atom)));
+      }
+      for (std::size_t t = 0; t < types_.size(); ++t)
+        if (types_[t].first == params && types_[t].second == results)
+          return t;
+      types_.emplace_back(params, results);
+      return types_.size() - 1;
+    }
+
+    std::uint32_t
+    Assembler::resolveLabel(const std::string &ref, const std::vector<std::string> &labels) {
+      if (ref[0] != '$')
+        return static_cast<std::uint32_t>(parseInt(ref));
+      for (std::size_t d = 0; d < labels.size(); ++d)
+        if (labels[labels.size() - 1 - d] == ref)
+          return d;
+      fail("unknown label " + ref);
+    }
+
+    std::string Assembler::code(const SExpr &func) {
+      const auto &items = func.items;
+      std::size_t from = items.size() > 1 && !items[1].isList ? 2 : 1;
+      Locals locals;
+      std::vector<std::pair<std::uint32_t, std::string>> names;
+      std::vector<std::uint8_t> declared; // types of the non-param locals
+      std::uint32_t next = 0;
+      std::size_t bodyStart = headerEnd(items, from);
+      for (std::size_t i = from; i < bodyStart; ++i) {
+        const auto &decl = items[i].items;
+        if (decl[0].atom == "result")
+          continue;
+        bool isLocal = decl[0].atom == "local";
+        for (std::size_t k = 1; k < decl.size(); ++k) {
+          if (decl[k].atom[0] == '$') {
+            locals[decl[k].atom] = next;
+            names.emplace_back(next, decl[k].atom.substr(1));
+            continue;
+          }
+          if (isLocal)
+            declared.push_back(valType(decl[k].atom));
+          ++next;
+        }
+      }
+      localNames_.push_back(std::move(names));
+
+      std::string body;
+      std::uint32_t groups = 0;
+      std::string groupBytes;
+      for (std::size_t i = 0; i < declared.size();) {
+        std::size_t j = i;
+        while (j < declared.size() && declared[j] == declared[i])
+          ++j;
+        putU(groupBytes, j - i);
+        groupBytes.push_back(static_cast<char>(declared[i]));
+        ++groups;
+        i = j;
+      }
+      putU(body, groups);
+      body += groupBytes;
+      std::vector<std::string> labels;
+      emitSeq(items, bodyStart, body, locals, labels);
+      body.push_back(0x0b);
+
+      std::string sized;
+      putU(sized, body.size());
+      return sized + body;
+    }
+
+    void Assembler::emitSeq(
+        const std::vector<SExpr> &items, std::size_t from, std::string &out, const Locals &locals,
+        std::vector<std::string> &labels
+    ) {
+      // `block`/`loop`/`if` immediates: an optional label and `(result T)`.
+      auto blockHeader = [&](std::size_t &i, const std::vector<SExpr> &seq) {
+        std::string label;
+        if (i < seq.size() && !seq[i].isList && !seq[i].atom.empty() && seq[i].atom[0] == '$')
+          label = seq[i++].atom;
+        if (i < seq.size() && seq[i].isList && !seq[i].items.empty() &&
+            seq[i].items[0].atom == "result") {
+          out.push_back(static_cast<char>(valType(seq[i].items.at(1).atom)));
+          ++i;
+        } else {
+          out.push_back(0x40);
+        }
+        labels.push_back(label);
+      };
+      auto atomAt = [&](std::size_t i, const std::string &op) -> const std::string & {
+        if (i >= items.size() || items[i].isList)
+          fail("missing immediate of " + op);
+        return items[i].atom;
+      };
+
+      const auto &core = coreOps();
+      const auto &simd = simdOps();
+      for (std::size_t i = from; i < items.size();) {
+        const SExpr &it = items[i++];
+        if (it.isList) {
+          const std::string &head = it.items.empty() ? std::string() : it.items[0].atom;
+          if (head != "block" && head != "loop")
+            fail("unsupported folded instruction (" + head + " ...)");
+          out.push_back(head == "block" ? 0x02 : 0x03);
+          std::size_t k = 1;
+          blockHeader(k, it.items);
+          emitSeq(it.items, k, out, locals, labels);
+          labels.pop_back();
+          out.push_back(0x0b);
+          continue;
+        }
+
+        const std::string &op = it.atom;
+        if (op == "block" || op == "loop" || op == "if") {
+          out.push_back(op == "block" ? 0x02 : (op == "loop" ? 0x03 : 0x04));
+          blockHeader(i, items);
+        } else if (op == "else") {
+          out.push_back(0x05);
+        } else if (op == "end") {
+          if (labels.empty())
+            fail("'end' without a block");
+          labels.pop_back();
+          out.push_back(0x0b);
+        } else if (op == "local.get" || op == "local.set" || op == "local.tee") {
+          const std::string &ref = atomAt(i++, op);
+          out.push_back(static_cast<char>(core.at(op)));
+          if (ref[0] == '$') {
+            auto l = locals.find(ref);
+            if (l == locals.end())
+              fail("unknown local " + ref);
+            putU(out, l->second);
+          } else {
+            putU(out, parseInt(ref));
+          }
+        } else if (op == "global.get" || op == "global.set") {
+          const std::string &ref = atomAt(i++, op);
+          auto g = globalIdx_.find(ref);
+          if (g == globalIdx_.end())
+            fail("unknown global " + ref);
+          out.push_back(static_cast<char>(core.at(op)));
+          putU(out, g->second);
+        } else if (op == "call") {
+          const std::string &ref = atomAt(i++, op);
+          auto f = funcIdx_.find(ref);
+          if (f == funcIdx_.end())
+            fail("unknown function " + ref);
+          out.push_back(static_cast<char>(core.at(op)));
+          putU(out, f->second);
+        } else if (op == "br" || op == "br_if") {
+          out.push_back(static_cast<char>(core.at(op)));
+          putU(out, resolveLabel(atomAt(i++, op), labels));
+        } else if (op == "br_table") {
+          std::vector<std::uint32_t> targets;
+          while (i < items.size() && isLabelRef(items[i]))
+            targets.push_back(resolveLabel(items[i++].atom, labels));
+          if (targets.empty())
+            fail("br_table without a default label");
+          out.push_back(static_cast<char>(core.at(op)));
+          putU(out, targets.size() - 1);
+          for (auto t: targets)
+            putU(out, t);
+        } else if (op == "i32.const") {
+          out.push_back(0x41);
+          putS(out, static_cast<std::int32_t>(static_cast<std::uint32_t>(parseInt(atomAt(i++, op)))));
+        } else if (op == "i64.const") {
+          out.push_back(0x42);
+          putS(out, static_cast<std::int64_t>(parseInt(atomAt(i++, op))));
+        } else if (op == "f32.const") {
+          out.push_back(0x43);
+          putLE(out, parseFloat<float>(atomAt(i++, op)));
+        } else if (op == "f64.const") {
+          out.push_back(0x44);
+          putLE(out, parseFloat<double>(atomAt(i++, op)));
+        } else if (op == "v128.const") {
+          const std::string &shape = atomAt(i++, op);
+          out.push_back(static_cast<char>(0xfd));
+          putU(out, simd.at(op));
+          std::size_t lanes = shape == "i8x16"                       ? 16
+                              : shape == "i16x8"                     ? 8
+                              : shape == "i32x4" || shape == "f32x4" ? 4
+                              : shape == "i64x2" || shape == "f64x2" ? 2
+                                                                     : 0;
+          if (!lanes)
+            fail("bad v128.const shape '" + shape + "'");
+          for (std::size_t l = 0; l < lanes; ++l) {
+            const std::string &v = atomAt(i++, op);
+            if (shape == "f32x4") {
+              putLE(out, parseFloat<float>(v));
+            } else if (shape == "f64x2") {
+              putLE(out, parseFloat<double>(v));
+            } else {
+              std::uint64_t bits = parseInt(v);
+              out.append(reinterpret_cast<const char *>(&bits), 16 / lanes);
+            }
+          }
+        } else if (op == "i8x16.shuffle") {
+          out.push_back(static_cast<char>(0xfd));
+          putU(out, simd.at(op));
+          for (int l = 0; l < 16; ++l)
+            out.push_back(static_cast<char>(parseInt(atomAt(i++, op))));
+        } else if (op.find("_lane") != std::string::npos && simd.count(op)) {
+          out.push_back(static_cast<char>(0xfd));
+          putU(out, simd.at(op));
+          out.push_back(static_cast<char>(parseInt(atomAt(i++, op))));
+        } else if (op.find(".load") != std::string::npos ||
+                   op.find(".store") != std::string::npos) {
+          std::uint64_t offset = 0;
+          std::uint32_t align = naturalAlign(op);
+          for (; i < items.size() && !items[i].isList && items[i].atom.find('=') != std::string::npos;
+               ++i) {
+            const std::string &kv = items[i].atom;
+            std::uint64_t v = parseInt(kv.substr(kv.find('=') + 1));
+            if (kv.rfind("offset=", 0) == 0) {
+              offset = v;
+            } else {
+              align = 0;
+              while ((std::uint64_t(1) << align) < v)
+                ++align;
+            }
+          }
+          if (auto s = simd.find(op); s != simd.end()) {
+            out.push_back(static_cast<char>(0xfd));
+            putU(out, s->second);
+          } else if (auto c = core.find(op); c != core.end()) {
+            out.push_back(static_cast<char>(c->second));
+          } else {
+            fail("unsupported instruction " + op);
+          }
+          putU(out, align);
+          putU(out, offset);
+        } else if (auto s = simd.find(op); s != simd.end()) {
+          out.push_back(static_cast<char>(0xfd));
+          putU(out, s->second);
+        } else if (auto c = core.find(op); c != core.end()) {
+          out.push_back(static_cast<char>(c->second));
+        } else {
+          fail("unsupported instruction " + op);
+        }
+      }
+    }
+
+    std::string Assembler::run(const SExpr &module, bool names) {
+      const auto &fields = module.items;
+      auto headOf = [](const SExpr &e) {
+        return e.isList && !e.items.empty() ? e.items[0].atom : std::string();
+      };
+      auto unquote = [](const std::string &s) {
+        return s.size() >= 2 && s.front() == '"' ? s.substr(1, s.size() - 2) : s;
+      };
+
+      // Imported functions come first in the function index space.
+      std::string imports;
+      std::uint32_t numImports = 0;
+      for (std::size_t i = 1; i < fields.size(); ++i) {
+        if (headOf(fields[i]) != "import")
+          continue;
+        const auto &imp = fields[i].items;
+        if (imp.size() != 4 || headOf(imp[3]) != "func")
+          fail("only function imports are supported");
+        const auto &fn = imp[3].items;
+        std::size_t from = fn.size() > 1 && !fn[1].isList ? 2 : 1;
+        if (from == 2)
+          funcIdx_[fn[1].atom] = funcNames_.size();
+        funcNames_.push_back(from == 2 ? fn[1].atom.substr(1) : std::string());
+        putName(imports, unquote(imp[1].atom));
+        putName(imports, unquote(imp[2].atom));
+        imports.push_back(0x00);
+        putU(imports, typeOf(fn, from));
+        ++numImports;
+      }
+
+      std::vector<const SExpr *> funcs, globals, exports;
+      const SExpr *memory = nullptr;
+      for (std::size_t i = 1; i < fields.size(); ++i) {
+        std::string head = headOf(fields[i]);
+        if (head == "func") {
+          const auto &fn = fields[i].items;
+          if (fn.size() > 1 && !fn[1].isList)
+            funcIdx_[fn[1].atom] = funcNames_.size();
+          funcNames_.push_back(fn.size() > 1 && !fn[1].isList ? fn[1].atom.substr(1) : "");
+          funcs.push_back(&fields[i]);
+        } else if (head == "global") {
+          if (fields[i].items.size() > 1 && !fields[i].items[1].isList)
+            globalIdx_[fields[i].items[1].atom] = globals.size();
+          globals.push_back(&fields[i]);
+        } else if (head == "memory") {
+          memory = &fields[i];
+        } else if (head == "export") {
+          exports.push_back(&fields[i]);
+        } else if (head != "import") {
+          fail("unsupported module field (" + head + " ...)");
+        }
+      }
+
+      std::string functions, codes;
+      for (const SExpr *f: funcs) {
+        std::size_t from = f->items.size() > 1 && !f->items[1].isList ? 2 : 1;
+        putU(functions, typeOf(f->items, from));
+        codes += code(*f);
+      }
+
+      std::string globalDefs;
+      for (const SExpr *g: globals) {
+        const auto &items = g->items;
+        std::size_t k = items.size() > 1 && !items[1].isList ? 2 : 1;
+        if (k + 1 >= items.size())
+          fail("global without an initializer");
+        const SExpr &type = items[k];
+        bool mut = type.isList && headOf(type) == "mut";
+        globalDefs.push_back(static_cast<char>(valType(mut ? type.items.at(1).atom : type.atom)));
+        globalDefs.push_back(mut ? 0x01 : 0x00);
+        std::vector<std::string> labels;
+        emitSeq(items[k + 1].items, 0, globalDefs, {}, labels);
+        globalDefs.push_back(0x0b);
+      }
+
+      std::string exportDefs;
+      for (const SExpr *e: exports) {
+        const auto &items = e->items;
+        if (items.size() != 3 || !items[2].isList || items[2].items.size() != 2)
+          fail("malformed export");
+        putName(exportDefs, unquote(items[1].atom));
+        std::string kind = headOf(items[2]);
+        const std::string &ref = items[2].items[1].atom;
+        if (kind == "func") {
+          auto f = funcIdx_.find(ref);
+          if (f == funcIdx_.end())
+            fail("export of unknown function " + ref);
+          exportDefs.push_back(0x00);
+          putU(exportDefs, f->second);
+        } else if (kind == "memory") {
+          exportDefs.push_back(0x02);
+          putU(exportDefs, 0);
+        } else if (kind == "global") {
+          exportDefs.push_back(0x03);
+          putU(exportDefs, globalIdx_.at(ref));
+        } else {
+          fail("unsupported export kind " + kind);
+        }
+      }
+
+      std::string typeDefs;
+      for (const auto &[params, results]: types_) {
+        typeDefs.push_back(0x60);
+        putName(typeDefs, params);
+        putName(typeDefs, results);
+      }
+
+      std::string wasm("\0asm\1\0\0\0", 8);
+      putSection(wasm, 1, types_.size(), typeDefs);
+      if (numImports)
+        putSection(wasm, 2, numImports, imports);
+      putSection(wasm, 3, funcs.size(), functions);
+      if (memory) {
+        std::string limits;
+        const auto &m = memory->items;
+        std::size_t k = m.size() > 1 && m[1].atom[0] == '$' ? 2 : 1;
+        if (k >= m.size())
+          fail("memory without limits");
+        bool hasMax = k + 1 < m.size();
+        limits.push_back(hasMax ? 0x01 : 0x00);
+        putU(limits, parseInt(m[k].atom));
+        if (hasMax)
+          putU(limits, parseInt(m[k + 1].atom));
+        putSection(wasm, 5, 1, limits);
+      }
+      if (!globals.empty())
+        putSection(wasm, 6, globals.size(), globalDefs);
+      if (!exports.empty())
+        putSection(wasm, 7, exports.size(), exportDefs);
+      putSection(wasm, 10, funcs.size(), codes);
+
+      if (names) {
+        // Custom "name" section: function names (1), then local names (2).
+        std::string fnNames, localNames;
+        std::uint32_t numNamed = 0;
+        for (std::size_t f = 0; f < funcNames_.size(); ++f) {
+          if (funcNames_[f].empty())
+            continue;
+          putU(fnNames, f);
+          putName(fnNames, funcNames_[f]);
+          ++numNamed;
+        }
+        for (std::size_t f = 0; f < localNames_.size(); ++f) {
+          putU(localNames, numImports + f);
+          putU(localNames, localNames_[f].size());
+          for (const auto &[idx, name]: localNames_[f]) {
+            putU(localNames, idx);
+            putName(localNames, name);
+          }
+        }
+        std::string custom;
+        putName(custom, "name");
+        auto subsection = [&](std::uint8_t id, std::uint32_t count, const std::string &body) {
+          std::string payload;
+          putU(payload, count);
+          payload += body;
+          custom.push_back(static_cast<char>(id));
+          putU(custom, payload.size());
+          custom += payload;
+        };
+        subsection(1, numNamed, fnNames);
+        subsection(2, localNames_.size(), localNames);
+        wasm.push_back(0x00);
+        putU(wasm, custom.size());
+        wasm += custom;
+      }
+      return wasm;
+    }
+
+  } // namespace
+
+  std::string WasmBinaryEncoder::encode(const std::string &wat) const {
+    std::vector<SExpr> top = parseSExprs(wat);
+    if (top.size() != 1 || !top[0].isList || top[0].items.empty() ||
+        top[0].items[0].atom != "module")
+      fail("expected a single (module ...)");
+    return Assembler().run(top[0], names_);
+  }
+
+} // namespace symir
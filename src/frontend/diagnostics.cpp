@@ -5,7 +5,7 @@
 namespace symir {
 
   void printMessage(
-      std::ostream &os, const std::string &src, const SourceSpan &span, const std::string &msg,
+      std::ostream &os, std::string_view src, const SourceSpan &span, const std::string &msg,
       DiagLevel level
   ) {
     std::string_view sv = src;
@@ -0,0 +1,243 @@
+#include "frontend/incremental_checker.hpp"
+#include <cctype>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+#include "analysis/definite_init.hpp"
+#include "analysis/pass_manager.hpp"
+#include "analysis/reachability.hpp"
+#include "analysis/unused_name.hpp"
+#include "frontend/lexer.hpp"
+#include "frontend/parser.hpp"
+#include "frontend/semchecker.hpp"
+#include "frontend/typechecker.hpp"
+
+namespace symir {
+
+  namespace {
+
+    // A piece with serial s is lexed at offset s << kSerialShift.
+    constexpr unsigned kSerialShift = 40;
+
+    struct Cut {
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      int line = 1; // of `begin`
+    };
+
+    bool startsDecl(std::string_view rest) {
+      for (std::string_view kw: {std::string_view("fun"), std::string_view("struct")})
+        if (rest.size() > kw.size() && rest.starts_with(kw) &&
+            std::isspace(static_cast<unsigned char>(rest[kw.size()])))
+          return true;
+      return false;
+    }
+
+    // Cuts `text` before every line that starts a declaration. Lines are
+    // scanned for comments and string literals only, to tell whether the
+    // next line starts inside a block comment.
+    std::vector<Cut> cut(std::string_view text) {
+      std::vector<Cut> cuts;
+      Cut cur;
+      bool inComment = false;
+      int line = 1;
+      std::size_t i = 0;
+      while (i < text.size()) {
+        if (!inComment && i != cur.begin && startsDecl(text.substr(i))) {
+          cur.end = i;
+          cuts.push_back(cur);
+          cur = Cut{i, i, line};
+        }
+        bool inString = false;
+        for (; i < text.size() && text[i] != '\n'; ++i) {
+          char c = text[i];
+          char next = i + 1 < text.size() ? text[i + 1] : '\0';
+          if (inComment) {
+            if (c == '*' && next == '/') {
+              inComment = false;
+              ++i;
+            }
+          } else if (inString) {
+            if (c == '\\')
+              ++i;
+            else if (c == '"')
+              inString = false;
+          } else if (c == '"') {
+            inString = true;
+          } else if (c == '/' && next == '/') {
+            while (i + 1 < text.size() && text[i + 1] != '\n')
+              ++i;
+          } else if (c == '/' && next == '*') {
+            inComment = true;
+            ++i;
+          }
+        }
+        if (i < text.size()) {
+          ++i;
+          ++line;
+        }
+      }
+      cur.end = text.size();
+      cuts.push_back(cur);
+      return cuts;
+    }
+
+    void addPasses(PassManager &pm, bool structsOnly) {
+      pm.addModulePass(std::make_unique<SemChecker>());
+      pm.addModulePass(std::make_unique<TypeChecker>());
+      if (structsOnly)
+        return;
+      pm.addFunctionPass(std::make_unique<ReachabilityAnalysis>());
+      pm.addFunctionPass(std::make_unique<DefiniteInitAnalysis>());
+      pm.addFunctionPass(std::make_unique<UnusedNameAnalysis>());
+    }
+
+  } // namespace
+
+  struct IncrementalChecker::Piece {
+    std::uint64_t serial = 0;
+    std::string text;
+    Program prog; // empty if the text does not parse
+    std::vector<Diagnostic> parseDiags;
+    // The diagnostics of checking the functions, and the structSerials_
+    // they were checked against.
+    bool checked = false;
+    std::vector<std::uint64_t> checkedWith;
+    std::vector<Diagnostic> checkDiags;
+  };
+
+  IncrementalChecker::IncrementalChecker() = default;
+  IncrementalChecker::~IncrementalChecker() = default;
+
+  void IncrementalChecker::parse(Piece &piece) {
+    try {
+      Lexer lx(piece.text, SourcePos{piece.serial << kSerialShift, 1, 1});
+      Parser ps(lx);
+      piece.prog = ps.parseProgram();
+    } catch (const ParseError &e) {
+      piece.parseDiags.push_back(Diagnostic{DiagLevel::Error, e.what(), e.span});
+    }
+  }
+
+  void IncrementalChecker::checkFunctions(Piece &piece) {
+    Program prog;
+    prog.structs = structs_;
+    prog.funs = std::move(piece.prog.funs);
+    prog.arena = piece.prog.arena;
+    prog.numNodeIds = piece.prog.numNodeIds;
+    DiagBag diags;
+    {
+      PassManager pm(diags);
+      addPasses(pm, false);
+      pm.run(prog);
+    }
+    piece.prog.funs = std::move(prog.funs);
+
+    // What the structs' pieces report is reported once, by the structs.
+    piece.checkDiags.clear();
+    for (auto &d: diags.diags) {
+      std::uint64_t owner = d.span.begin.offset >> kSerialShift;
+      if (owner == piece.serial || owner == 0)
+        piece.checkDiags.push_back(std::move(d));
+    }
+    piece.checked = true;
+    piece.checkedWith = structSerials_;
+  }
+
+  std::vector<Diagnostic> IncrementalChecker::update(std::string_view text) {
+    stats_ = Stats{};
+    std::vector<Cut> cuts = cut(text);
+
+    auto old = std::move(pieces_);
+    pieces_.clear();
+    std::vector<std::shared_ptr<Piece>> pieces;
+    pieces.reserve(cuts.size());
+    for (const auto &c: cuts) {
+      std::string_view t = text.substr(c.begin, c.end - c.begin);
+      std::shared_ptr<Piece> p;
+      if (auto it = old.find(t); it != old.end() && !it->second.empty()) {
+        p = std::move(it->second.back());
+        it->second.pop_back();
+      } else {
+        p = std::make_shared<Piece>();
+        p->serial = nextSerial_++;
+        p->text = std::string(t);
+        parse(*p);
+        ++stats_.parsed;
+      }
+      pieces_[p->text].push_back(p);
+      pieces.push_back(std::move(p));
+    }
+    stats_.pieces = pieces.size();
+
+    std::vector<std::uint64_t> structSerials;
+    for (const auto &p: pieces)
+      if (!p->prog.structs.empty())
+        structSerials.push_back(p->serial);
+    if (structSerials != structSerials_) {
+      structs_.clear();
+      for (const auto &p: pieces)
+        structs_.insert(structs_.end(), p->prog.structs.begin(), p->prog.structs.end());
+      structSerials_ = std::move(structSerials);
+      Program prog;
+      prog.structs = structs_;
+      DiagBag diags;
+      PassManager pm(diags);
+      addPasses(pm, true);
+      pm.run(prog);
+      structDiags_ = std::move(diags.diags);
+    }
+
+    for (const auto &p: pieces) {
+      if (p->prog.funs.empty() || (p->checked && p->checkedWith == structSerials_))
+        continue;
+      checkFunctions(*p);
+      ++stats_.checked;
+    }
+
+    // Map the diagnostics from the pieces' positions to the text's.
+    std::unordered_map<std::uint64_t, std::size_t> where;
+    for (std::size_t k = 0; k < pieces.size(); ++k)
+      where.emplace(pieces[k]->serial, k);
+    auto place = [&](const SourcePos &pos, std::size_t fallback) {
+      auto it = where.find(pos.offset >> kSerialShift);
+      if (it == where.end())
+        return SourcePos{cuts[fallback].begin, cuts[fallback].line, 1};
+      const Cut &c = cuts[it->second];
+      std::size_t rel = pos.offset - (pieces[it->second]->serial << kSerialShift);
+      return SourcePos{c.begin + rel, c.line + pos.line - 1, pos.col};
+    };
+    std::vector<Diagnostic> out;
+    std::set<std::tuple<DiagLevel, std::string, std::size_t, std::size_t>> seen;
+    auto emit = [&](const Diagnostic &d, std::size_t fallback) {
+      Diagnostic m{d.level, d.message, {place(d.span.begin, fallback), place(d.span.end, fallback)}};
+      if (seen.emplace(m.level, m.message, m.span.begin.offset, m.span.end.offset).second)
+        out.push_back(std::move(m));
+    };
+
+    std::size_t firstStruct = 0;
+    while (firstStruct + 1 < pieces.size() && pieces[firstStruct]->prog.structs.empty())
+      ++firstStruct;
+    for (const auto &d: structDiags_)
+      emit(d, firstStruct);
+    // Each piece was checked without the other functions, so duplicate
+    // function names are caught here.
+    std::unordered_set<Symbol> funNames;
+    for (std::size_t k = 0; k < pieces.size(); ++k) {
+      for (const auto &d: pieces[k]->parseDiags)
+        emit(d, k);
+      for (const auto &f: pieces[k]->prog.funs)
+        if (!funNames.insert(f.name.name).second)
+          emit(
+              Diagnostic{
+                  DiagLevel::Error, "Duplicate global name (function): " + f.name.name, f.span
+              },
+              k
+          );
+      for (const auto &d: pieces[k]->checkDiags)
+        emit(d, k);
+    }
+    return out;
+  }
+
+} // namespace symir
@@ -6,16 +6,8 @@ namespace symir {
 
   Lexer::Lexer(std::string_view src) : src_(src) {}
 
-  std::vector<Token> Lexer::lexAll() {
-    std::vector<Token> out;
-    while (true) {
-      Token t = next();
-      out.push_back(t);
-      if (t.kind == TokenKind::End)
-        break;
-    }
-    return out;
-  }
+  Lexer::Lexer(std::string_view src, SourcePos start) :
+      src_(src), base_(start.offset), line_(start.line), col_(start.col) {}
 
   char Lexer::peek(std::size_t k) const {
     if (i_ + k >= src_.size())
@@ -37,7 +29,7 @@ namespace symir {
     return c;
   }
 
-  SourcePos Lexer::pos() const { return SourcePos{i_, line_, col_}; }
+  SourcePos Lexer::pos() const { return SourcePos{base_ + i_, line_, col_}; }
 
   void Lexer::skipWhitespaceAndComments() {
     while (true) {
@@ -77,8 +69,15 @@ namespace symir {
     return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
   }
 
-  Token Lexer::make(TokenKind k, std::string lex, SourcePos b, SourcePos e) {
-    return Token{k, std::move(lex), SourceSpan{b, e}};
+  Token Lexer::make(TokenKind k, SourcePos b, SourcePos e) const {
+    return Token{k, src_.substr(b.offset - base_, e.offset - b.offset), SourceSpan{b, e}};
+  }
+
+  std::string_view Lexer::scanIdent() {
+    std::size_t start = i_;
+    while (isIdentCont(peek()))
+      get();
+    return src_.substr(start, i_ - start);
   }
 
   Token Lexer::next() {
@@ -86,13 +85,16 @@ namespace symir {
     SourcePos b = pos();
     char c = peek();
     if (c == '\0') {
-      return make(TokenKind::End, "", b, pos());
+      return make(TokenKind::End, b, pos());
     }
 
     // String literal
     if (c == '"') {
       get(); // "
+      // Without escapes the text is the slice between the quotes.
+      std::size_t start = i_;
       std::string val;
+      bool escaped = false;
       while (true) {
         char ch = get();
         if (ch == '\0' || ch == '\n') {
@@ -101,6 +103,9 @@ namespace symir {
         if (ch == '"')
           break;
         if (ch == '\\') {
+          if (!escaped)
+            val.assign(src_.substr(start, i_ - 1 - start));
+          escaped = true;
           char esc = get();
           if (esc == 'n')
             val.push_back('\n');
@@ -115,11 +120,14 @@ namespace symir {
           else {
             val.push_back(esc);
           }
-        } else {
+        } else if (escaped) {
           val.push_back(ch);
         }
       }
-      return make(TokenKind::StringLit, val, b, pos());
+      std::string_view lex = src_.substr(start, i_ - 1 - start);
+      if (escaped)
+        lex = decoded_.emplace_back(std::move(val));
+      return Token{TokenKind::StringLit, lex, SourceSpan{b, pos()}};
     }
 
     // Sigiled identifiers
@@ -134,96 +142,89 @@ namespace symir {
       if (!isIdentStart(peek())) {
         throw LexError("Expected identifier after sigil", SourceSpan{b, pos()});
       }
-      std::string name;
-      while (isIdentCont(peek()))
-        name.push_back(get());
-      std::string lex = std::string(1, c) + (isSym ? "?" : "") + name;
+      scanIdent();
       return make(
-          isSym ? TokenKind::SymId : (c == '@' ? TokenKind::GlobalId : TokenKind::LocalId), lex, b,
-          pos()
+          isSym ? TokenKind::SymId : (c == '@' ? TokenKind::GlobalId : TokenKind::LocalId), b, pos()
       );
     }
 
     if (c == '^') {
       if (isIdentStart(peek(1))) {
         get();
-        std::string name;
-        while (isIdentCont(peek()))
-          name.push_back(get());
-        return make(TokenKind::BlockLabel, "^" + name, b, pos());
+        scanIdent();
+        return make(TokenKind::BlockLabel, b, pos());
       } else {
         get();
-        return make(TokenKind::Caret, "^", b, pos());
+        return make(TokenKind::Caret, b, pos());
       }
     }
 
     // Number literal (Int or Float)
     if (std::isdigit(static_cast<unsigned char>(c)) ||
         (c == '-' && std::isdigit(static_cast<unsigned char>(peek(1))))) {
-      std::string num;
       if (c == '-')
-        num.push_back(get());
+        get();
 
       bool isHex = false, isOct = false, isBin = false;
 
       if (peek() == '0') {
         if (peek(1) == 'x' || peek(1) == 'X') {
           isHex = true;
-          num.push_back(get()); // '0'
-          num.push_back(get()); // 'x'
+          get(); // '0'
+          get(); // 'x'
         } else if (peek(1) == 'o' || peek(1) == 'O') {
           isOct = true;
-          num.push_back(get()); // '0'
-          num.push_back(get()); // 'o'
+          get(); // '0'
+          get(); // 'o'
         } else if (peek(1) == 'b' || peek(1) == 'B') {
           isBin = true;
-          num.push_back(get()); // '0'
-          num.push_back(get()); // 'b'
+          get(); // '0'
+          get(); // 'b'
         }
       }
 
       if (isHex) {
         while (std::isxdigit(static_cast<unsigned char>(peek())))
-          num.push_back(get());
-        return make(TokenKind::IntLit, num, b, pos());
+          get();
+        return make(TokenKind::IntLit, b, pos());
       } else if (isOct) {
         while (peek() >= '0' && peek() <= '7')
-          num.push_back(get());
-        return make(TokenKind::IntLit, num, b, pos());
+          get();
+        return make(TokenKind::IntLit, b, pos());
       } else if (isBin) {
         while (peek() == '0' || peek() == '1')
-          num.push_back(get());
-        return make(TokenKind::IntLit, num, b, pos());
+          get();
+        return make(TokenKind::IntLit, b, pos());
       }
 
       // Decimal (potentially Float)
       while (std::isdigit(static_cast<unsigned char>(peek())))
-        num.push_back(get());
+        get();
 
       bool isFloat = false;
 
       // Fraction
       if (peek() == '.') {
         isFloat = true;
-        num.push_back(get()); // '.'
+        get(); // '.'
         while (std::isdigit(static_cast<unsigned char>(peek())))
-          num.push_back(get());
+          get();
       }
 
       // Exponent
       if (peek() == 'e' || peek() == 'E') {
         isFloat = true;
-        num.push_back(get()); // 'e'
+        get(); // 'e'
         if (peek() == '+' || peek() == '-')
-          num.push_back(get());
+          get();
         if (!std::isdigit(static_cast<unsigned char>(peek()))) {
           throw LexError("Expected digits in exponent", SourceSpan{b, pos()});
         }
         while (std::isdigit(static_cast<unsigned char>(peek())))
-          num.push_back(get());
+          get();
       }
 
-      return make(isFloat ? TokenKind::FloatLit : TokenKind::IntLit, num, b, pos());
+      return make(isFloat ? TokenKind::FloatLit : TokenKind::IntLit, b, pos());
     }
 
     // Punctuators / three-char ops
@@ -232,7 +233,7 @@ namespace symir {
       get();
       get();
       get();
-      return make(TokenKind::LShr, ">>>", b, pos());
+      return make(TokenKind::LShr, b, pos());
     }
 
     // Punctuators / two-char ops
@@ -240,153 +241,151 @@ namespace symir {
     if (two == "==") {
       get();
       get();
-      return make(TokenKind::EqEq, "==", b, pos());
+      return make(TokenKind::EqEq, b, pos());
     }
     if (two == "!=") {
       get();
       get();
-      return make(TokenKind::NotEq, "!=", b, pos());
+      return make(TokenKind::NotEq, b, pos());
     }
     if (two == "<=") {
       get();
       get();
-      return make(TokenKind::Le, "<=", b, pos());
+      return make(TokenKind::Le, b, pos());
     }
     if (two == ">=") {
       get();
       get();
-      return make(TokenKind::Ge, ">=", b, pos());
+      return make(TokenKind::Ge, b, pos());
     }
     if (two == "<<") {
       get();
       get();
-      return make(TokenKind::Shl, "<<", b, pos());
+      return make(TokenKind::Shl, b, pos());
     }
     if (two == ">>") {
       get();
       get();
-      return make(TokenKind::Shr, ">>", b, pos());
+      return make(TokenKind::Shr, b, pos());
     }
 
     // Single-char tokens
     switch (c) {
       case '{':
         get();
-        return make(TokenKind::LBrace, "{", b, pos());
+        return make(TokenKind::LBrace, b, pos());
       case '}':
         get();
-        return make(TokenKind::RBrace, "}", b, pos());
+        return make(TokenKind::RBrace, b, pos());
       case '(':
         get();
-        return make(TokenKind::LParen, "(", b, pos());
+        return make(TokenKind::LParen, b, pos());
       case ')':
         get();
-        return make(TokenKind::RParen, ")", b, pos());
+        return make(TokenKind::RParen, b, pos());
       case '[':
         get();
-        return make(TokenKind::LBracket, "[", b, pos());
+        return make(TokenKind::LBracket, b, pos());
       case ']':
         get();
-        return make(TokenKind::RBracket, "]", b, pos());
+        return make(TokenKind::RBracket, b, pos());
       case ':':
         get();
-        return make(TokenKind::Colon, ":", b, pos());
+        return make(TokenKind::Colon, b, pos());
       case ';':
         get();
-        return make(TokenKind::Semicolon, ";", b, pos());
+        return make(TokenKind::Semicolon, b, pos());
       case ',':
         get();
-        return make(TokenKind::Comma, ",", b, pos());
+        return make(TokenKind::Comma, b, pos());
       case '.':
         get();
-        return make(TokenKind::Dot, ".", b, pos());
+        return make(TokenKind::Dot, b, pos());
       case '+':
         get();
-        return make(TokenKind::Plus, "+", b, pos());
+        return make(TokenKind::Plus, b, pos());
       case '-':
         get();
-        return make(TokenKind::Minus, "-", b, pos());
+        return make(TokenKind::Minus, b, pos());
       case '*':
         get();
-        return make(TokenKind::Star, "*", b, pos());
+        return make(TokenKind::Star, b, pos());
       case '/':
         get();
-        return make(TokenKind::Slash, "/", b, pos());
+        return make(TokenKind::Slash, b, pos());
       case '%':
         get();
-        return make(TokenKind::Percent, "%", b, pos());
+        return make(TokenKind::Percent, b, pos());
       case '&':
         get();
-        return make(TokenKind::Amp, "&", b, pos());
+        return make(TokenKind::Amp, b, pos());
       case '|':
         get();
-        return make(TokenKind::Pipe, "|", b, pos());
+        return make(TokenKind::Pipe, b, pos());
       case '~':
         get();
-        return make(TokenKind::Tilde, "~", b, pos());
+        return make(TokenKind::Tilde, b, pos());
       case '=':
         get();
-        return make(TokenKind::Equal, "=", b, pos());
+        return make(TokenKind::Equal, b, pos());
       case '<':
         get();
-        return make(TokenKind::Lt, "<", b, pos());
+        return make(TokenKind::Lt, b, pos());
       case '>':
         get();
-        return make(TokenKind::Gt, ">", b, pos());
+        return make(TokenKind::Gt, b, pos());
       default:
         break;
     }
 
     // Identifier / keyword
     if (isIdentStart(c)) {
-      std::string name;
-      while (isIdentCont(peek()))
-        name.push_back(get());
+      std::string_view name = scanIdent();
 
       if (name == "struct")
-        return make(TokenKind::KwStruct, name, b, pos());
+        return make(TokenKind::KwStruct, b, pos());
       if (name == "fun")
-        return make(TokenKind::KwFun, name, b, pos());
+        return make(TokenKind::KwFun, b, pos());
       if (name == "sym")
-        return make(TokenKind::KwSym, name, b, pos());
+        return make(TokenKind::KwSym, b, pos());
       if (name == "let")
-        return make(TokenKind::KwLet, name, b, pos());
+        return make(TokenKind::KwLet, b, pos());
       if (name == "mut")
-        return make(TokenKind::KwMut, name, b, pos());
+        return make(TokenKind::KwMut, b, pos());
       if (name == "assume")
-        return make(TokenKind::KwAssume, name, b, pos());
+        return make(TokenKind::KwAssume, b, pos());
       if (name == "require")
-        return make(TokenKind::KwRequire, name, b, pos());
+        return make(TokenKind::KwRequire, b, pos());
       if (name == "br")
-        return make(TokenKind::KwBr, name, b, pos());
+        return make(TokenKind::KwBr, b, pos());
       if (name == "ret")
-        return make(TokenKind::KwRet, name, b, pos());
+        return make(TokenKind::KwRet, b, pos());
       if (name == "unreachable")
-        return make(TokenKind::KwUnreachable, name, b, pos());
+        return make(TokenKind::KwUnreachable, b, pos());
       if (name == "in")
-        return make(TokenKind::KwIn, name, b, pos());
+        return make(TokenKind::KwIn, b, pos());
       if (name == "select")
-        return make(TokenKind::KwSelect, name, b, pos());
+        return make(TokenKind::KwSelect, b, pos());
       if (name == "undef")
-        return make(TokenKind::KwUndef, name, b, pos());
+        return make(TokenKind::KwUndef, b, pos());
       if (name == "as")
-        return make(TokenKind::KwAs, name, b, pos());
+        return make(TokenKind::KwAs, b, pos());
       if (name == "ptr")
-        return make(TokenKind::KwPtr, name, b, pos());
+        return make(TokenKind::KwPtr, b, pos());
       if (name == "addr")
-        return make(TokenKind::KwAddr, name, b, pos());
+        return make(TokenKind::KwAddr, b, pos());
       if (name == "load")
-        return make(TokenKind::KwLoad, name, b, pos());
+        return make(TokenKind::KwLoad, b, pos());
       if (name == "store")
-        return make(TokenKind::KwStore, name, b, pos());
+        return make(TokenKind::KwStore, b, pos());
       if (name == "null")
-        return make(TokenKind::KwNull, name, b, pos());
+        return make(TokenKind::KwNull, b, pos());
       if (name == "cmp")
-        return make(TokenKind::KwCmp, name, b, pos());
+        return make(TokenKind::KwCmp, b, pos());
       if (name == "ptrindex")
-        return make(TokenKind::KwPtrIndex, name, b, pos());
+        return make(TokenKind::KwPtrIndex, b, pos());
       if (name == "ptrfield")
-        return make(TokenKind::KwPtrField, name, b, pos());
+        return make(TokenKind::KwPtrField, b, pos());
 
       if (name.size() >= 2 && name[0] == 'i' && std::isdigit(static_cast<unsigned char>(name[1]))) {
         bool allDigits = true;
@@ -397,14 +396,14 @@ namespace symir {
           }
         }
         if (allDigits)
-          return make(TokenKind::IntType, name, b, pos());
+          return make(TokenKind::IntType, b, pos());
       }
 
       if (name == "f32" || name == "f64") {
-        return make(TokenKind::FloatType, name, b, pos());
+        return make(TokenKind::FloatType, b, pos());
       }
 
-      return make(TokenKind::Ident, name, b, pos());
+      return make(TokenKind::Ident, b, pos());
     }
 
     // Unknown character
@@ -0,0 +1,1260 @@
+#include "frontend/module_cache.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <unordered_map>
+#include "ast/type_annotations.hpp"
+#include "ast/type_table.hpp"
+#include "frontend/lexer.hpp"
+#include "frontend/parser.hpp"
+#include "frontend/source_buffer.hpp"
+#include "timing.hpp"
+
+namespace symir {
+
+  namespace {
+
+    // Entry layout: magic, version (u32), source size (u64), FNV-1a of the
+    // rest (u64), then varints: pipeline, symbol table, type table, structs,
+    // funs, program span, numNodeIds, node types, CFGs, diagnostics.
+    // Symbols and types are table indices; a type index of 0 is null. Bump
+    // kVersion whenever the layout or the AST changes.
+    constexpr char kMagic[4] = {'S', 'I', 'R', 'M'};
+    constexpr std::uint32_t kVersion = 1;
+
+    std::uint64_t mix64(std::uint64_t x) {
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9ull;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111ebull;
+      x ^= x >> 31;
+      return x;
+    }
+
+    std::uint64_t fnv1a(std::string_view text, std::uint64_t h = 0xcbf29ce484222325ull) {
+      for (unsigned char c: text) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+      }
+      return h;
+    }
+
+    std::uint64_t zigzag(std::int64_t v) {
+      return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t v) {
+      return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+    }
+
+    class Writer {
+    public:
+      void u8(std::uint8_t v) { out_->push_back(static_cast<char>(v)); }
+
+      void varint(std::uint64_t v) {
+        while (v >= 0x80) {
+          u8(static_cast<std::uint8_t>(v | 0x80));
+          v >>= 7;
+        }
+        u8(static_cast<std::uint8_t>(v));
+      }
+
+      void sint(std::int64_t v) { varint(zigzag(v)); }
+
+      void f64(double v) {
+        char buf[sizeof v];
+        std::memcpy(buf, &v, sizeof v);
+        out_->append(buf, sizeof v);
+      }
+
+      void str(std::string_view s) {
+        varint(s.size());
+        out_->append(s);
+      }
+
+      void sym(Symbol s) {
+        auto [it, added] = symIndex_.try_emplace(s.id(), syms_.size());
+        if (added)
+          syms_.push_back(s);
+        varint(it->second);
+      }
+
+      void span(const SourceSpan &sp) {
+        varint(sp.begin.offset);
+        sint(sp.begin.line);
+        sint(sp.begin.col);
+        varint(sp.end.offset);
+        sint(sp.end.line);
+        sint(sp.end.col);
+      }
+
+      void type(const TypePtr &t) { varint(typeRef(t)); }
+
+      template<typename Id>
+      void id(const Id &i) {
+        sym(i.name);
+        span(i.span);
+      }
+
+      void localOrSym(const LocalOrSymId &i) {
+        u8(static_cast<std::uint8_t>(i.index()));
+        std::visit([&](const auto &x) { id(x); }, i);
+      }
+
+      void intLit(const IntLit &l) {
+        sint(l.value);
+        span(l.span);
+      }
+
+      void floatLit(const FloatLit &l) {
+        f64(l.value);
+        span(l.span);
+      }
+
+      void coef(const Coef &c) {
+        u8(static_cast<std::uint8_t>(c.index()));
+        std::visit(
+            [&](const auto &x) {
+              using T = std::decay_t<decltype(x)>;
+              if constexpr (std::is_same_v<T, IntLit>)
+                intLit(x);
+              else if constexpr (std::is_same_v<T, FloatLit>)
+                floatLit(x);
+              else if constexpr (std::is_same_v<T, LocalOrSymId>)
+                localOrSym(x);
+              else
+                span(x.span);
+            },
+            c
+        );
+      }
+
+      void index(const Index &i) {
+        u8(static_cast<std::uint8_t>(i.index()));
+        if (auto lit = std::get_if<IntLit>(&i))
+          intLit(*lit);
+        else
+          localOrSym(std::get<LocalOrSymId>(i));
+      }
+
+      void lvalue(const LValue &lv) {
+        id(lv.base);
+        varint(lv.accesses.size());
+        for (const auto &acc: lv.accesses) {
+          u8(static_cast<std::uint8_t>(acc.index()));
+          if (auto ai = std::get_if<AccessIndex>(&acc)) {
+            index(ai->index);
+            span(ai->span);
+          } else {
+            const auto &af = std::get<AccessField>(acc);
+            sym(af.field);
+            span(af.span);
+          }
+        }
+        span(lv.span);
+        varint(lv.id);
+      }
+
+      void selectVal(const SelectVal &sv) {
+        u8(static_cast<std::uint8_t>(sv.index()));
+        if (auto rv = std::get_if<RValue>(&sv))
+          lvalue(*rv);
+        else
+          coef(std::get<Coef>(sv));
+      }
+
+      void atom(const Atom &a) {
+        u8(static_cast<std::uint8_t>(a.v.index()));
+        std::visit(
+            [&](const auto &x) {
+              using T = std::decay_t<decltype(x)>;
+              if constexpr (std::is_same_v<T, OpAtom>) {
+                u8(static_cast<std::uint8_t>(x.op));
+                coef(x.coef);
+                lvalue(x.rval);
+              } else if constexpr (std::is_same_v<T, SelectAtom>) {
+                u8((x.cond ? 1 : 0) | (x.maskExpr ? 2 : 0));
+                if (x.cond)
+                  cond(*x.cond);
+                if (x.maskExpr)
+                  expr(*x.maskExpr);
+                selectVal(x.vtrue);
+                selectVal(x.vfalse);
+              } else if constexpr (std::is_same_v<T, CoefAtom>) {
+                coef(x.coef);
+              } else if constexpr (std::is_same_v<T, RValueAtom> || std::is_same_v<T, LoadAtom>) {
+                lvalue(x.rval);
+              } else if constexpr (std::is_same_v<T, CastAtom>) {
+                u8(static_cast<std::uint8_t>(x.src.index()));
+                std::visit(
+                    [&](const auto &s) {
+                      using S = std::decay_t<decltype(s)>;
+                      if constexpr (std::is_same_v<S, IntLit>)
+                        intLit(s);
+                      else if constexpr (std::is_same_v<S, FloatLit>)
+                        floatLit(s);
+                      else if constexpr (std::is_same_v<S, SymId>)
+                        id(s);
+                      else
+                        lvalue(s);
+                    },
+                    x.src
+                );
+                type(x.dstType);
+                span(x.dstSpan);
+              } else if constexpr (std::is_same_v<T, UnaryAtom>) {
+                u8(static_cast<std::uint8_t>(x.op));
+                lvalue(x.rval);
+              } else if constexpr (std::is_same_v<T, AddrAtom>) {
+                lvalue(x.lv);
+              } else if constexpr (std::is_same_v<T, CmpAtom>) {
+                u8(static_cast<std::uint8_t>(x.op));
+                selectVal(x.lhs);
+                selectVal(x.rhs);
+              } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
+                lvalue(x.rval);
+                index(x.index);
+              } else if constexpr (std::is_same_v<T, PtrFieldAtom>) {
+                lvalue(x.rval);
+                sym(x.field);
+              }
+              span(x.span);
+            },
+            a.v
+        );
+        span(a.span);
+        varint(a.id);
+      }
+
+      void expr(const Expr &e) {
+        atom(e.first);
+        varint(e.rest.size());
+        for (const auto &t: e.rest) {
+          u8(static_cast<std::uint8_t>(t.op));
+          atom(t.atom);
+          span(t.span);
+        }
+        span(e.span);
+      }
+
+      void cond(const Cond &c) {
+        expr(c.lhs);
+        u8(static_cast<std::uint8_t>(c.op));
+        expr(c.rhs);
+        span(c.span);
+      }
+
+      void block(const Block &b) {
+        id(b.label);
+        varint(b.instrs.size());
+        for (const auto &ins: b.instrs) {
+          u8(static_cast<std::uint8_t>(ins.index()));
+          std::visit(
+              [&](const auto &x) {
+                using T = std::decay_t<decltype(x)>;
+                if constexpr (std::is_same_v<T, AssignInstr>) {
+                  lvalue(x.lhs);
+                  expr(x.rhs);
+                } else if constexpr (std::is_same_v<T, AssumeInstr>) {
+                  cond(x.cond);
+                } else if constexpr (std::is_same_v<T, RequireInstr>) {
+                  cond(x.cond);
+                  u8(x.message.has_value());
+                  if (x.message)
+                    str(*x.message);
+                } else {
+                  expr(x.ptr);
+                  expr(x.val);
+                }
+                span(x.span);
+              },
+              ins
+          );
+        }
+        u8(static_cast<std::uint8_t>(b.term.index()));
+        std::visit(
+            [&](const auto &t) {
+              using T = std::decay_t<decltype(t)>;
+              if constexpr (std::is_same_v<T, BrTerm>) {
+                u8(t.cond.has_value());
+                if (t.cond)
+                  cond(*t.cond);
+                id(t.dest);
+                id(t.thenLabel);
+                id(t.elseLabel);
+                u8(t.isConditional);
+              } else if constexpr (std::is_same_v<T, RetTerm>) {
+                u8(t.value.has_value());
+                if (t.value)
+                  expr(*t.value);
+              }
+              span(t.span);
+            },
+            b.term
+        );
+        span(b.span);
+      }
+
+      void initVal(const InitVal &iv) {
+        u8(static_cast<std::uint8_t>(iv.kind));
+        u8(static_cast<std::uint8_t>(iv.value.index()));
+        std::visit(
+            [&](const auto &x) {
+              using T = std::decay_t<decltype(x)>;
+              if constexpr (std::is_same_v<T, IntLit>) {
+                intLit(x);
+              } else if constexpr (std::is_same_v<T, FloatLit>) {
+                floatLit(x);
+              } else if constexpr (std::is_same_v<T, SymId> || std::is_same_v<T, LocalId>) {
+                id(x);
+              } else if constexpr (std::is_same_v<T, AtomPtr>) {
+                u8(x != nullptr);
+                if (x)
+                  atom(*x);
+              } else {
+                varint(x.size());
+                for (const auto &elem: x) {
+                  u8(elem != nullptr);
+                  if (elem)
+                    initVal(*elem);
+                }
+              }
+            },
+            iv.value
+        );
+        span(iv.span);
+      }
+
+      void fun(const FunDecl &f) {
+        id(f.name);
+        varint(f.params.size());
+        for (const auto &p: f.params) {
+          id(p.name);
+          type(p.type);
+          span(p.span);
+          span(p.typeSpan);
+        }
+        type(f.retType);
+        varint(f.syms.size());
+        for (const auto &s: f.syms) {
+          id(s.name);
+          u8(static_cast<std::uint8_t>(s.kind));
+          type(s.type);
+          u8(s.domain ? 1 + s.domain->index() : 0);
+          if (s.domain) {
+            if (auto iv = std::get_if<DomainInterval>(&*s.domain)) {
+              sint(iv->lo);
+              sint(iv->hi);
+              span(iv->span);
+            } else {
+              const auto &ds = std::get<DomainSet>(*s.domain);
+              varint(ds.values.size());
+              for (auto v: ds.values)
+                sint(v);
+              span(ds.span);
+            }
+          }
+          span(s.span);
+          span(s.typeSpan);
+        }
+        varint(f.lets.size());
+        for (const auto &l: f.lets) {
+          u8(l.isMutable);
+          id(l.name);
+          type(l.type);
+          u8(l.init.has_value());
+          if (l.init)
+            initVal(*l.init);
+          span(l.span);
+          span(l.typeSpan);
+        }
+        varint(f.blocks.size());
+        for (const auto &b: f.blocks)
+          block(b);
+        span(f.span);
+        span(f.retTypeSpan);
+      }
+
+      void program(const Program &prog, const DiagBag &diags, AnalysisManager &am) {
+        varint(prog.structs.size());
+        for (const auto &s: prog.structs) {
+          id(s.name);
+          varint(s.fields.size());
+          for (const auto &fd: s.fields) {
+            sym(fd.name);
+            type(fd.type);
+            span(fd.span);
+            span(fd.typeSpan);
+          }
+          span(s.span);
+        }
+        varint(prog.funs.size());
+        for (const auto &f: prog.funs)
+          fun(f);
+        span(prog.span);
+        varint(prog.numNodeIds);
+
+        NodeId numTypes = prog.types ? prog.types->size() : 0;
+        varint(numTypes);
+        for (NodeId k = 0; k < numTypes; ++k)
+          type(prog.types->of(k));
+
+        // Edges only: the block list and the predecessors follow from the
+        // function, as in CFG::build.
+        for (const auto &f: prog.funs) {
+          const CFG *g = am.validCfg(f);
+          u8(g != nullptr);
+          if (!g)
+            continue;
+          varint(g->entry);
+          for (const auto &succ: g->succ) {
+            varint(succ.size());
+            for (auto s: succ)
+              varint(s);
+          }
+        }
+
+        varint(diags.diags.size());
+        for (const auto &d: diags.diags) {
+          u8(static_cast<std::uint8_t>(d.level));
+          str(d.message);
+          span(d.span);
+        }
+      }
+
+      /// The entry: header, tables, then everything written so far.
+      std::string finish(std::uint64_t sourceSize, const std::string &pipeline) {
+        std::string body = std::move(body_);
+        std::string rest;
+        out_ = &rest;
+        str(pipeline);
+        varint(syms_.size());
+        for (const auto &s: syms_)
+          str(s.str());
+        varint(numTypes_);
+        rest += types_;
+        rest += body;
+
+        std::string head(kMagic, sizeof kMagic);
+        std::uint64_t sum = fnv1a(rest);
+        char buf[sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t)];
+        std::memcpy(buf, &kVersion, sizeof(std::uint32_t));
+        std::memcpy(buf + sizeof(std::uint32_t), &sourceSize, sizeof(std::uint64_t));
+        std::memcpy(buf + sizeof(std::uint32_t) + sizeof(std::uint64_t), &sum, sizeof sum);
+        head.append(buf, sizeof buf);
+        return head + rest;
+      }
+
+    private:
+      std::uint64_t typeRef(const TypePtr &t) {
+        if (!t)
+          return 0;
+        if (auto it = typeIndex_.find(t.get()); it != typeIndex_.end())
+          return it->second;
+        std::uint64_t child = 0;
+        if (auto at = std::get_if<ArrayType>(&t->v))
+          child = typeRef(at->elem);
+        else if (auto pt = std::get_if<PtrType>(&t->v))
+          child = typeRef(pt->pointee);
+        else if (auto vt = std::get_if<VecType>(&t->v))
+          child = typeRef(vt->elem);
+
+        std::string *saved = out_;
+        out_ = &types_;
+        u8(static_cast<std::uint8_t>(t->v.index()));
+        u8(t->canonical.on);
+        std::visit(
+            [&](const auto &x) {
+              using T = std::decay_t<decltype(x)>;
+              if constexpr (std::is_same_v<T, IntType>) {
+                u8(static_cast<std::uint8_t>(x.kind));
+                u8(x.bits.has_value());
+                if (x.bits)
+                  sint(*x.bits);
+              } else if constexpr (std::is_same_v<T, FloatType>) {
+                u8(static_cast<std::uint8_t>(x.kind));
+              } else if constexpr (std::is_same_v<T, StructType>) {
+                id(x.name);
+              } else if constexpr (std::is_same_v<T, PtrType>) {
+                varint(child);
+              } else {
+                varint(x.size);
+                varint(child);
+              }
+              span(x.span);
+            },
+            t->v
+        );
+        span(t->span);
+        out_ = saved;
+        typeIndex_.emplace(t.get(), ++numTypes_);
+        return numTypes_;
+      }
+
+      std::string body_, types_;
+      std::string *out_ = &body_;
+      std::vector<Symbol> syms_;
+      std::unordered_map<std::uint32_t, std::uint64_t> symIndex_;
+      std::unordered_map<const Type *, std::uint64_t> typeIndex_;
+      std::uint64_t numTypes_ = 0;
+    };
+
+    struct Malformed : std::runtime_error {
+      Malformed() : std::runtime_error("Malformed module cache entry") {}
+    };
+
+    class Reader {
+    public:
+      Reader(std::string_view data, std::shared_ptr<AstArena> arena) :
+          p_(data.data()), end_(data.data() + data.size()), arena_(std::move(arena)) {}
+
+      bool atEnd() const { return p_ == end_; }
+
+      std::uint8_t u8() {
+        if (p_ == end_)
+          throw Malformed();
+        return static_cast<std::uint8_t>(*p_++);
+      }
+
+      std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+          std::uint8_t b = u8();
+          v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+          if (!(b & 0x80))
+            return v;
+        }
+        throw Malformed();
+      }
+
+      std::int64_t sint() { return unzigzag(varint()); }
+
+      int small() { return static_cast<int>(sint()); }
+
+      /// A count of items of at least one byte each.
+      std::size_t count() {
+        std::uint64_t n = varint();
+        if (n > static_cast<std::uint64_t>(end_ - p_))
+          throw Malformed();
+        return static_cast<std::size_t>(n);
+      }
+
+      /// A tag or enum value in [0, limit).
+      std::uint8_t tag(std::uint8_t limit) {
+        std::uint8_t t = u8();
+        if (t >= limit)
+          throw Malformed();
+        return t;
+      }
+
+      template<typename E>
+      E enumOf(E last) {
+        return static_cast<E>(tag(static_cast<std::uint8_t>(last) + 1));
+      }
+
+      bool flag() { return tag(2) != 0; }
+
+      double f64() {
+        double v;
+        if (end_ - p_ < static_cast<std::ptrdiff_t>(sizeof v))
+          throw Malformed();
+        std::memcpy(&v, p_, sizeof v);
+        p_ += sizeof v;
+        return v;
+      }
+
+      std::string_view str() {
+        std::size_t n = count();
+        std::string_view s(p_, n);
+        p_ += n;
+        return s;
+      }
+
+      std::string_view rest() const { return {p_, static_cast<std::size_t>(end_ - p_)}; }
+
+      std::string_view raw(std::size_t n) {
+        if (static_cast<std::size_t>(end_ - p_) < n)
+          throw Malformed();
+        std::string_view s(p_, n);
+        p_ += n;
+        return s;
+      }
+
+      void symbols() {
+        std::size_t n = count();
+        syms_.reserve(n);
+        for (std::size_t k = 0; k < n; ++k)
+          syms_.emplace_back(str());
+      }
+
+      Symbol sym() {
+        std::uint64_t k = varint();
+        if (k >= syms_.size())
+          throw Malformed();
+        return syms_[k];
+      }
+
+      SourceSpan span() {
+        SourceSpan sp;
+        sp.begin.offset = varint();
+        sp.begin.line = small();
+        sp.begin.col = small();
+        sp.end.offset = varint();
+        sp.end.line = small();
+        sp.end.col = small();
+        return sp;
+      }
+
+      TypePtr type() {
+        std::uint64_t k = varint();
+        if (k > types_.size())
+          throw Malformed();
+        return k ? types_[k - 1] : nullptr;
+      }
+
+      void types() {
+        std::size_t n = count();
+        types_.reserve(n);
+        for (std::size_t k = 0; k < n; ++k) {
+          Type t;
+          std::uint8_t kind = tag(std::variant_size_v<Type::Variant>);
+          bool canonical = flag();
+          switch (kind) {
+            case 0: {
+              IntType it;
+              it.kind = enumOf(IntType::Kind::ICustom);
+              if (flag())
+                it.bits = small();
+              it.span = span();
+              t.v = it;
+              break;
+            }
+            case 1: {
+              FloatType ft;
+              ft.kind = enumOf(FloatType::Kind::F64);
+              ft.span = span();
+              t.v = ft;
+              break;
+            }
+            case 2: {
+              StructType st;
+              st.name = id<GlobalId>();
+              st.span = span();
+              t.v = st;
+              break;
+            }
+            case 4: {
+              PtrType pt;
+              pt.pointee = type();
+              pt.span = span();
+              t.v = pt;
+              break;
+            }
+            default: {
+              std::uint64_t size = varint();
+              TypePtr elem = type();
+              SourceSpan sp = span();
+              if (kind == 3)
+                t.v = ArrayType{size, elem, sp};
+              else
+                t.v = VecType{size, elem, sp};
+              break;
+            }
+          }
+          t.span = span();
+          types_.push_back(canonical ? TypeTable::global().intern(t) : std::make_shared<Type>(t));
+        }
+      }
+
+      template<typename Id>
+      Id id() {
+        Id i;
+        i.name = sym();
+        i.span = span();
+        return i;
+      }
+
+      LocalOrSymId localOrSym() {
+        if (tag(2) == 0)
+          return id<LocalId>();
+        return id<SymId>();
+      }
+
+      IntLit intLit() {
+        IntLit l;
+        l.value = sint();
+        l.span = span();
+        return l;
+      }
+
+      FloatLit floatLit() {
+        FloatLit l;
+        l.value = f64();
+        l.span = span();
+        return l;
+      }
+
+      Coef coef() {
+        switch (tag(std::variant_size_v<Coef>)) {
+          case 0:
+            return intLit();
+          case 1:
+            return floatLit();
+          case 2:
+            return localOrSym();
+          default:
+            return NullLit{span()};
+        }
+      }
+
+      Index index() {
+        if (tag(2) == 0)
+          return intLit();
+        return localOrSym();
+      }
+
+      LValue lvalue() {
+        LValue lv;
+        lv.base = id<LocalId>();
+        std::size_t n = count();
+        lv.accesses.reserve(n);
+        for (std::size_t k = 0; k < n; ++k) {
+          if (tag(2) == 0) {
+            AccessIndex ai;
+            ai.index = index();
+            ai.span = span();
+            lv.accesses.push_back(std::move(ai));
+          } else {
+            AccessField af;
+            af.field = sym();
+            af.span = span();
+            lv.accesses.push_back(std::move(af));
+          }
+        }
+        lv.span = span();
+        lv.id = nodeId();
+        return lv;
+      }
+
+      SelectVal selectVal() {
+        if (tag(2) == 0)
+          return lvalue();
+        return coef();
+      }
+
+      Atom atom() {
+        Atom a;
+        switch (tag(std::variant_size_v<Atom::Variant>)) {
+          case 0: {
+            OpAtom x;
+            x.op = enumOf(AtomOpKind::LShr);
+            x.coef = coef();
+            x.rval = lvalue();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 1: {
+            SelectAtom x;
+            std::uint8_t forms = tag(4);
+            if (forms & 1)
+              x.cond = std::make_unique<Cond>(cond());
+            if (forms & 2)
+              x.maskExpr = std::make_unique<Expr>(expr());
+            x.vtrue = selectVal();
+            x.vfalse = selectVal();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 2: {
+            CoefAtom x;
+            x.coef = coef();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 3: {
+            RValueAtom x;
+            x.rval = lvalue();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 4: {
+            CastAtom x;
+            switch (tag(std::variant_size_v<CastAtom::Variant>)) {
+              case 0:
+                x.src = intLit();
+                break;
+              case 1:
+                x.src = floatLit();
+                break;
+              case 2:
+                x.src = id<SymId>();
+                break;
+              default:
+                x.src = lvalue();
+                break;
+            }
+            x.dstType = type();
+            x.dstSpan = span();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 5: {
+            UnaryAtom x;
+            x.op = enumOf(UnaryOpKind::Not);
+            x.rval = lvalue();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 6: {
+            AddrAtom x;
+            x.lv = lvalue();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 7: {
+            LoadAtom x;
+            x.rval = lvalue();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 8: {
+            CmpAtom x;
+            x.op = enumOf(RelOp::GE);
+            x.lhs = selectVal();
+            x.rhs = selectVal();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          case 9: {
+            PtrIndexAtom x;
+            x.rval = lvalue();
+            x.index = index();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+          default: {
+            PtrFieldAtom x;
+            x.rval = lvalue();
+            x.field = sym();
+            x.span = span();
+            a.v = std::move(x);
+            break;
+          }
+        }
+        a.span = span();
+        a.id = nodeId();
+        return a;
+      }
+
+      Expr expr() {
+        Expr e;
+        e.first = atom();
+        std::size_t n = count();
+        e.rest.reserve(n);
+        for (std::size_t k = 0; k < n; ++k) {
+          Expr::Tail t;
+          t.op = enumOf(AddOp::Minus);
+          t.atom = atom();
+          t.span = span();
+          e.rest.push_back(std::move(t));
+        }
+        e.span = span();
+        return e;
+      }
+
+      Cond cond() {
+        Cond c;
+        c.lhs = expr();
+        c.op = enumOf(RelOp::GE);
+        c.rhs = expr();
+        c.span = span();
+        return c;
+      }
+
+      Block block() {
+        Block b;
+        b.label = id<BlockLabel>();
+        std::size_t n = count();
+        b.instrs.reserve(n);
+        for (std::size_t k = 0; k < n; ++k) {
+          switch (tag(std::variant_size_v<Instr>)) {
+            case 0: {
+              AssignInstr x;
+              x.lhs = lvalue();
+              x.rhs = expr();
+              x.span = span();
+              b.instrs.push_back(std::move(x));
+              break;
+            }
+            case 1: {
+              AssumeInstr x;
+              x.cond = cond();
+              x.span = span();
+              b.instrs.push_back(std::move(x));
+              break;
+            }
+            case 2: {
+              RequireInstr x;
+              x.cond = cond();
+              if (flag())
+                x.message = std::string(str());
+              x.span = span();
+              b.instrs.push_back(std::move(x));
+              break;
+            }
+            default: {
+              StoreInstr x;
+              x.ptr = expr();
+              x.val = expr();
+              x.span = span();
+              b.instrs.push_back(std::move(x));
+              break;
+            }
+          }
+        }
+        switch (tag(std::variant_size_v<Terminator>)) {
+          case 0: {
+            BrTerm t;
+            if (flag())
+              t.cond = cond();
+            t.dest = id<BlockLabel>();
+            t.thenLabel = id<BlockLabel>();
+            t.elseLabel = id<BlockLabel>();
+            t.isConditional = flag();
+            t.span = span();
+            b.term = std::move(t);
+            break;
+          }
+          case 1: {
+            RetTerm t;
+            if (flag())
+              t.value = expr();
+            t.span = span();
+            b.term = std::move(t);
+            break;
+          }
+          default:
+            b.term = UnreachableTerm{span()};
+            break;
+        }
+        b.span = span();
+        return b;
+      }
+
+      InitVal initVal() {
+        InitVal iv;
+        iv.kind = enumOf(InitVal::Kind::Atom);
+        switch (tag(std::variant_size_v<decltype(iv.value)>)) {
+          case 0:
+            iv.value = intLit();
+            break;
+          case 1:
+            iv.value = floatLit();
+            break;
+          case 2:
+            iv.value = id<SymId>();
+            break;
+          case 3:
+            iv.value = id<LocalId>();
+            break;
+          case 4: {
+            std::vector<InitValPtr> elems(count());
+            for (auto &elem: elems)
+              if (flag())
+                elem = makeNode<InitVal>(arena_, initVal());
+            iv.value = std::move(elems);
+            break;
+          }
+          default: {
+            AtomPtr a;
+            if (flag())
+              a = makeNode<Atom>(arena_, atom());
+            iv.value = std::move(a);
+            break;
+          }
+        }
+        iv.span = span();
+        return iv;
+      }
+
+      FunDecl fun() {
+        FunDecl f;
+        f.name = id<GlobalId>();
+        f.params.resize(count());
+        for (auto &p: f.params) {
+          p.name = id<LocalId>();
+          p.type = type();
+          p.span = span();
+          p.typeSpan = span();
+        }
+        f.retType = type();
+        f.syms.resize(count());
+        for (auto &s: f.syms) {
+          s.name = id<SymId>();
+          s.kind = enumOf(SymKind::Index);
+          s.type = type();
+          switch (tag(3)) {
+            case 1: {
+              DomainInterval iv;
+              iv.lo = sint();
+              iv.hi = sint();
+              iv.span = span();
+              s.domain = iv;
+              break;
+            }
+            case 2: {
+              DomainSet ds;
+              ds.values.resize(count());
+              for (auto &v: ds.values)
+                v = sint();
+              ds.span = span();
+              s.domain = std::move(ds);
+              break;
+            }
+            default:
+              break;
+          }
+          s.span = span();
+          s.typeSpan = span();
+        }
+        f.lets.resize(count());
+        for (auto &l: f.lets) {
+          l.isMutable = flag();
+          l.name = id<LocalId>();
+          l.type = type();
+          if (flag())
+            l.init = initVal();
+          l.span = span();
+          l.typeSpan = span();
+        }
+        std::size_t n = count();
+        f.blocks.reserve(n);
+        for (std::size_t k = 0; k < n; ++k)
+          f.blocks.push_back(block());
+        f.span = span();
+        f.retTypeSpan = span();
+        return f;
+      }
+
+      /// The CFG of `f` whose edges follow, rebuilt as CFG::build would.
+      CFG cfg(const FunDecl &f) {
+        CFG g;
+        std::size_t n = f.blocks.size();
+        g.blocks.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+          g.indexOf[f.blocks[i].label.name] = i;
+          g.blocks.push_back(f.blocks[i].label.name);
+        }
+        g.succ.assign(n, {});
+        g.pred.assign(n, {});
+        g.entry = blockIndex(n);
+        for (std::size_t i = 0; i < n; ++i) {
+          std::size_t m = count();
+          g.succ[i].reserve(m);
+          for (std::size_t k = 0; k < m; ++k)
+            g.succ[i].push_back(blockIndex(n));
+        }
+        for (std::size_t i = 0; i < n; ++i)
+          for (auto s: g.succ[i])
+            g.pred[s].push_back(i);
+        return g;
+      }
+
+      void setNumNodeIds(NodeId n) { numNodeIds_ = n; }
+
+    private:
+      NodeId nodeId() {
+        std::uint64_t k = varint();
+        if (k >= numNodeIds_)
+          throw Malformed();
+        return static_cast<NodeId>(k);
+      }
+
+      std::size_t blockIndex(std::size_t n) {
+        std::uint64_t k = varint();
+        if (k >= n)
+          throw Malformed();
+        return static_cast<std::size_t>(k);
+      }
+
+      const char *p_;
+      const char *end_;
+      std::shared_ptr<AstArena> arena_;
+      std::vector<Symbol> syms_;
+      std::vector<TypePtr> types_;
+      // Ids are range-checked once the Program's count is known; until then
+      // any 32-bit id is accepted.
+      std::uint64_t numNodeIds_ = std::uint64_t(1) << 32;
+    };
+
+  } // namespace
+
+  ModuleCache::ModuleCache(const std::string &dir) : dir_(dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+  }
+
+  std::string ModuleCache::pathOf(std::string_view source, const std::string &pipeline) const {
+    // Two independent 64-bit hashes of the source, both seeded with the
+    // pipeline: FNV-1a and a word-wise multiply-mix.
+    std::uint64_t seed = fnv1a(pipeline);
+    std::uint64_t lo = fnv1a(source, seed);
+    std::uint64_t hi = mix64(seed ^ source.size());
+    std::size_t i = 0;
+    for (; i + 8 <= source.size(); i += 8) {
+      std::uint64_t w;
+      std::memcpy(&w, source.data() + i, 8);
+      hi = mix64(hi ^ w);
+    }
+    std::uint64_t rest = 0;
+    std::memcpy(&rest, source.data() + i, source.size() - i);
+    hi = mix64(hi ^ rest);
+
+    char name[40];
+    std::snprintf(
+        name, sizeof name, "%016llx%016llx.sirm", static_cast<unsigned long long>(mix64(lo)),
+        static_cast<unsigned long long>(hi)
+    );
+    return (std::filesystem::path(dir_) / name).string();
+  }
+
+  bool ModuleCache::load(
+      std::string_view source, const std::string &pipeline, Program &prog, DiagBag &diags,
+      AnalysisManager &am
+  ) const {
+    auto file = SourceBuffer::open(pathOf(source, pipeline));
+    if (!file)
+      return false;
+
+    Program loaded;
+    loaded.arena = std::make_shared<AstArena>();
+    std::vector<std::optional<CFG>> cfgs;
+    std::vector<Diagnostic> replay;
+    try {
+      Reader in(file->text(), loaded.arena);
+      if (in.raw(sizeof kMagic) != std::string_view(kMagic, sizeof kMagic))
+        return false;
+      std::uint32_t version;
+      std::uint64_t sourceSize, sum;
+      std::memcpy(&version, in.raw(sizeof version).data(), sizeof version);
+      std::memcpy(&sourceSize, in.raw(sizeof sourceSize).data(), sizeof sourceSize);
+      std::memcpy(&sum, in.raw(sizeof sum).data(), sizeof sum);
+      if (version != kVersion || sourceSize != source.size() || sum != fnv1a(in.rest()) ||
+          in.str() != pipeline)
+        return false;
+      in.symbols();
+      in.types();
+
+      loaded.structs.resize(in.count());
+      for (auto &s: loaded.structs) {
+        s.name = in.id<GlobalId>();
+        s.fields.resize(in.count());
+        for (auto &fd: s.fields) {
+          fd.name = in.sym();
+          fd.type = in.type();
+          fd.span = in.span();
+          fd.typeSpan = in.span();
+        }
+        s.span = in.span();
+      }
+      std::size_t numFuns = in.count();
+      loaded.funs.reserve(numFuns);
+      for (std::size_t k = 0; k < numFuns; ++k)
+        loaded.funs.push_back(in.fun());
+      loaded.span = in.span();
+      std::uint64_t numNodeIds = in.varint();
+      if (numNodeIds == 0 || numNodeIds > UINT32_MAX)
+        return false;
+      loaded.numNodeIds = static_cast<NodeId>(numNodeIds);
+      in.setNumNodeIds(loaded.numNodeIds);
+
+      std::uint64_t numTypes = in.varint();
+      if (numTypes > loaded.numNodeIds)
+        return false;
+      if (numTypes) {
+        auto ann = std::make_shared<TypeAnnotations>(static_cast<NodeId>(numTypes));
+        for (NodeId k = 0; k < numTypes; ++k)
+          ann->set(k, in.type());
+        loaded.types = std::move(ann);
+      }
+
+      for (const auto &f: loaded.funs)
+        cfgs.push_back(in.flag() ? std::optional<CFG>(in.cfg(f)) : std::nullopt);
+
+      replay.resize(in.count());
+      for (auto &d: replay) {
+        d.level = in.enumOf(DiagLevel::Note);
+        d.message = std::string(in.str());
+        d.span = in.span();
+      }
+      if (!in.atEnd())
+        return false;
+    } catch (const Malformed &) {
+      return false;
+    }
+
+    prog = std::move(loaded);
+    for (std::size_t k = 0; k < prog.funs.size(); ++k)
+      if (cfgs[k])
+        am.adopt(prog.funs[k], std::move(*cfgs[k]));
+    diags.diags.insert(diags.diags.end(), replay.begin(), replay.end());
+    return true;
+  }
+
+  void ModuleCache::store(
+      std::string_view source, const std::string &pipeline, const Program &prog,
+      const DiagBag &diags, AnalysisManager &am
+  ) const {
+    Writer out;
+    out.program(prog, diags, am);
+    std::string data = out.finish(source.size(), pipeline);
+
+    // Write aside and rename, so readers never see a partial entry.
+    static std::atomic<unsigned> serial{0};
+    std::string path = pathOf(source, pipeline);
+    std::string tmp =
+        path + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(serial.fetch_add(1));
+    {
+      std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+      if (!os || !os.write(data.data(), static_cast<std::streamsize>(data.size())))
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+      std::filesystem::remove(tmp, ec);
+  }
+
+  PassResult
+  parseAndCheck(std::string_view source, PassManager &pm, const ModuleCache *cache, Program &prog) {
+    if (cache && cache->load(source, pm.pipeline(), prog, pm.diags(), pm.analyses())) {
+      timing::count("module-cache-hits");
+      return PassResult::Success;
+    }
+    if (cache)
+      timing::count("module-cache-misses");
+
+    Lexer lx(source);
+    Parser ps(lx);
+    prog = ps.parseProgram();
+    PassResult r = pm.run(prog);
+    if (cache && r == PassResult::Success)
+      cache->store(source, pm.pipeline(), prog, pm.diags(), pm.analyses());
+    return r;
+  }
+
+} // namespace symir
@@ -1,37 +1,104 @@
 #include "frontend/parser.hpp"
+#include "ast/type_table.hpp"
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include "timing.hpp"
 
 namespace symir {
 
-  Parser::Parser(std::vector<Token> toks) : toks_(std::move(toks)) {}
+  // Keeps the tokens from the current one on, so the parser can return to
+  // it after trying an alternative.
+  struct Parser::Backtrack {
+    Parser &p;
+    std::size_t at;
+
+    explicit Backtrack(Parser &parser) : p(parser), at(parser.idx_) { ++p.pins_; }
+    ~Backtrack() { --p.pins_; }
+    Backtrack(const Backtrack &) = delete;
+    Backtrack &operator=(const Backtrack &) = delete;
+
+    void rewind() { p.idx_ = at; }
+  };
+
+  Parser::Parser(Lexer &lexer) : lexer_(lexer), arena_(std::make_shared<AstArena>()) {}
 
   Program Parser::parseProgram() {
+    timing::Scope scope("parse");
+    // Reports the lexing as a child of "parse", however parsing ends.
+    struct LexTime {
+      Parser &p;
+      ~LexTime() {
+        timing::addTime("lex", p.lexNs_, p.lexTokens_);
+        timing::count("tokens", p.lexTokens_);
+      }
+    } lexTime{*this};
     Program prog;
-    while (!is(TokenKind::End)) {
-      if (is(TokenKind::KwStruct)) {
-        prog.structs.push_back(parseStructDecl());
-      } else if (is(TokenKind::KwFun)) {
-        prog.funs.push_back(parseFunDecl());
-      } else {
-        errorHere("Expected struct or function declaration");
+    prog.arena = arena_;
+    SourcePos b = peek().span.begin;
+    try {
+      while (!is(TokenKind::End)) {
+        if (is(TokenKind::KwStruct)) {
+          prog.structs.push_back(parseStructDecl());
+        } else if (is(TokenKind::KwFun)) {
+          prog.funs.push_back(parseFunDecl());
+        } else {
+          errorHere("Expected struct or function declaration");
+        }
+      }
+    } catch (const LexError &) {
+      throw;
+    } catch (const ParseError &) {
+      // A lex error anywhere in the input takes precedence over a parse
+      // error, so lex the rest before reporting it.
+      while (lex().kind != TokenKind::End) {
       }
+      throw;
     }
-    prog.span = SourceSpan{toks_.front().span.begin, prevEnd()};
+    prog.span = SourceSpan{b, prevEnd()};
+    prog.numNodeIds = nextNodeId_;
     return prog;
   }
 
+  Token Parser::lex() const {
+    if (!timing::enabled())
+      return lexer_.next();
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    Token t = lexer_.next();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    lexNs_ += static_cast<std::uint64_t>(ns.count());
+    ++lexTokens_;
+    return t;
+  }
+
   const Token &Parser::peek(std::size_t k) const {
-    if (idx_ + k >= toks_.size())
-      return toks_.back();
-    return toks_[idx_ + k];
+    while (base_ + window_.size() <= idx_ + k) {
+      if (!window_.empty() && window_.back().kind == TokenKind::End)
+        return window_.back();
+      window_.push_back(lex());
+    }
+    return window_[idx_ + k - base_];
+  }
+
+  void Parser::advance() {
+    peek();
+    ++idx_;
+    if (pins_)
+      return;
+    while (base_ + 1 < idx_) {
+      window_.pop_front();
+      ++base_;
+    }
   }
 
   bool Parser::is(TokenKind k) const { return peek().kind == k; }
 
-  const Token &Parser::consume(TokenKind k, const char *what) {
+  Token Parser::consume(TokenKind k, const char *what) {
     if (is(k)) {
-      return toks_[idx_++];
+      Token t = peek();
+      advance();
+      return t;
     }
     std::string msg = "Expected ";
     msg += what;
@@ -43,7 +110,7 @@ namespace symir {
 
   bool Parser::tryConsume(TokenKind k) {
     if (is(k)) {
-      idx_++;
+      advance();
       return true;
     }
     return false;
@@ -55,28 +122,34 @@ namespace symir {
 
   GlobalId Parser::parseGlobalId() {
     const Token &t = consume(TokenKind::GlobalId, "global identifier (@name)");
-    return GlobalId{t.lexeme, t.span};
+    return GlobalId{std::string(t.lexeme), t.span};
   }
 
   LocalId Parser::parseLocalId() {
     const Token &t = consume(TokenKind::LocalId, "local identifier (%name)");
-    return LocalId{t.lexeme, t.span};
+    return LocalId{std::string(t.lexeme), t.span};
   }
 
   SymId Parser::parseSymId() {
     const Token &t = consume(TokenKind::SymId, "symbol identifier (%?name or @?name)");
-    return SymId{t.lexeme, t.span};
+    return SymId{std::string(t.lexeme), t.span};
   }
 
   BlockLabel Parser::parseBlockLabel() {
     const Token &t = consume(TokenKind::BlockLabel, "block label (^name)");
-    return BlockLabel{t.lexeme, t.span};
+    return BlockLabel{std::string(t.lexeme), t.span};
   }
 
-  TypePtr Parser::parseType() {
+  TypePtr Parser::parseType(SourceSpan &span) {
     SourcePos b = peek().span.begin;
+    TypePtr t = parseType();
+    span = SourceSpan{b, prevEnd()};
+    return t;
+  }
+
+  TypePtr Parser::parseType() {
     if (is(TokenKind::IntType)) {
-      std::string lex = consume(TokenKind::IntType, "integer type").lexeme;
+      std::string lex(consume(TokenKind::IntType, "integer type").lexeme);
       int bits = std::stoi(lex.substr(1));
       IntType it;
       if (bits == 32)
@@ -87,56 +160,46 @@ namespace symir {
         it.kind = IntType::Kind::ICustom;
         it.bits = bits;
       }
-      it.span = SourceSpan{b, prevEnd()};
-      return std::make_shared<Type>(it, SourceSpan{b, prevEnd()});
+      return TypeTable::global().intern(Type{it, {}});
     }
     if (is(TokenKind::FloatType)) {
-      std::string lex = consume(TokenKind::FloatType, "float type").lexeme;
+      std::string lex(consume(TokenKind::FloatType, "float type").lexeme);
       FloatType ft;
       ft.kind = (lex == "f32") ? FloatType::Kind::F32 : FloatType::Kind::F64;
-      ft.span = SourceSpan{b, prevEnd()};
-      return std::make_shared<Type>(ft, SourceSpan{b, prevEnd()});
+      return TypeTable::global().intern(Type{ft, {}});
     }
     if (is(TokenKind::GlobalId)) {
       GlobalId name = parseGlobalId();
-      return std::make_shared<Type>(
-          StructType{std::move(name), SourceSpan{b, prevEnd()}}, SourceSpan{b, prevEnd()}
-      );
+      return TypeTable::global().intern(Type{StructType{std::move(name), {}}, {}});
     }
     if (tryConsume(TokenKind::LBracket)) {
       Token t = consume(TokenKind::IntLit, "array size");
-      std::size_t size = std::stoull(t.lexeme);
+      std::size_t size = std::stoull(std::string(t.lexeme));
       consume(TokenKind::RBracket, "']' after array size");
       TypePtr elem = parseType();
-      return std::make_shared<Type>(
-          ArrayType{size, std::move(elem), SourceSpan{b, prevEnd()}}, SourceSpan{b, prevEnd()}
-      );
+      return TypeTable::global().intern(Type{ArrayType{size, std::move(elem), {}}, {}});
     }
     if (is(TokenKind::KwPtr)) {
       consume(TokenKind::KwPtr, "'ptr'");
       TypePtr pointee = parseType();
-      return std::make_shared<Type>(
-          PtrType{std::move(pointee), SourceSpan{b, prevEnd()}}, SourceSpan{b, prevEnd()}
-      );
+      return TypeTable::global().intern(Type{PtrType{std::move(pointee), {}}, {}});
     }
     // [v0.2.1] vector type: <N> ScalarType. N is parsed as IntLit; the
     // typechecker enforces N >= 2 and the elem-is-scalar restriction.
     if (tryConsume(TokenKind::Lt)) {
       Token t = consume(TokenKind::IntLit, "vector lane count N");
-      std::size_t size = std::stoull(t.lexeme);
+      std::size_t size = std::stoull(std::string(t.lexeme));
       consume(TokenKind::Gt, "'>' after vector lane count");
       TypePtr elem = parseType();
-      return std::make_shared<Type>(
-          VecType{size, std::move(elem), SourceSpan{b, prevEnd()}}, SourceSpan{b, prevEnd()}
-      );
+      return TypeTable::global().intern(Type{VecType{size, std::move(elem), {}}, {}});
     }
     errorHere("Expected a type (iN, f32/f64, array type, struct type @Name, ptr T, or <N> T)");
   }
 
   SourcePos Parser::prevEnd() const {
     if (idx_ == 0)
-      return toks_[0].span.begin;
-    return toks_[idx_ - 1].span.end;
+      return peek().span.begin;
+    return window_[idx_ - 1 - base_].span.end;
   }
 
   StructDecl Parser::parseStructDecl() {
@@ -149,9 +212,10 @@ namespace symir {
     while (!is(TokenKind::RBrace)) {
       const Token &fname = consume(TokenKind::Ident, "field name");
       consume(TokenKind::Colon, "':'");
-      TypePtr ty = parseType();
+      SourceSpan tsp;
+      TypePtr ty = parseType(tsp);
       consume(TokenKind::Semicolon, "';'");
-      FieldDecl f{fname.lexeme, ty, SourceSpan{fname.span.begin, prevEnd()}};
+      FieldDecl f{std::string(fname.lexeme), ty, SourceSpan{fname.span.begin, prevEnd()}, tsp};
       fields.push_back(std::move(f));
     }
     consume(TokenKind::RBrace, "'}'");
@@ -166,7 +230,8 @@ namespace symir {
     std::vector<ParamDecl> params = parseParamList();
     consume(TokenKind::RParen, "')'");
     consume(TokenKind::Colon, "':'");
-    TypePtr ret = parseType();
+    SourceSpan retSpan;
+    TypePtr ret = parseType(retSpan);
     consume(TokenKind::LBrace, "'{'");
 
     std::vector<SymDecl> syms;
@@ -179,14 +244,18 @@ namespace symir {
       lets.push_back(parseLetDecl());
     }
 
-    std::vector<Block> blocks;
+    blockScratch_.clear();
     while (!is(TokenKind::RBrace)) {
-      blocks.push_back(parseBlock());
+      blockScratch_.push_back(parseBlock());
     }
+    std::vector<Block> blocks(
+        std::make_move_iterator(blockScratch_.begin()), std::make_move_iterator(blockScratch_.end())
+    );
     consume(TokenKind::RBrace, "'}'");
 
-    return FunDecl{std::move(name), std::move(params), std::move(ret),          std::move(syms),
-                   std::move(lets), std::move(blocks), SourceSpan{b, prevEnd()}};
+    return FunDecl{std::move(name), std::move(params), std::move(ret),
+                   std::move(syms), std::move(lets),   std::move(blocks),
+                   SourceSpan{b, prevEnd()}, retSpan};
   }
 
   std::vector<ParamDecl> Parser::parseParamList() {
@@ -198,8 +267,9 @@ namespace symir {
       SourcePos b = peek().span.begin;
       LocalId id = parseLocalId();
       consume(TokenKind::Colon, "':'");
-      TypePtr ty = parseType();
-      params.push_back(ParamDecl{std::move(id), std::move(ty), SourceSpan{b, prevEnd()}});
+      SourceSpan tsp;
+      TypePtr ty = parseType(tsp);
+      params.push_back(ParamDecl{std::move(id), std::move(ty), SourceSpan{b, prevEnd()}, tsp});
       if (!tryConsume(TokenKind::Comma))
         break;
     }
@@ -214,7 +284,7 @@ namespace symir {
       return SymKind::Coef;
     if (t.lexeme == "index")
       return SymKind::Index;
-    throw ParseError("Unknown symbol kind: " + t.lexeme, t.span);
+    throw ParseError("Unknown symbol kind: " + std::string(t.lexeme), t.span);
   }
 
   std::optional<Domain> Parser::parseOptionalDomain() {
@@ -229,8 +299,8 @@ namespace symir {
       const Token &hiT = consume(TokenKind::IntLit, "domain interval upper bound");
       consume(TokenKind::RBracket, "']'");
       DomainInterval di;
-      di.lo = parseIntegerLiteral(loT.lexeme);
-      di.hi = parseIntegerLiteral(hiT.lexeme);
+      di.lo = parseIntegerLiteral(std::string(loT.lexeme));
+      di.hi = parseIntegerLiteral(std::string(hiT.lexeme));
       di.span = SourceSpan{b, prevEnd()};
       return Domain{di};
     }
@@ -241,7 +311,7 @@ namespace symir {
       if (!is(TokenKind::RBrace)) {
         while (true) {
           const Token &v = consume(TokenKind::IntLit, "domain set element");
-          ds.values.push_back(parseIntegerLiteral(v.lexeme));
+          ds.values.push_back(parseIntegerLiteral(std::string(v.lexeme)));
           if (!tryConsume(TokenKind::Comma))
             break;
         }
@@ -262,11 +332,12 @@ namespace symir {
     consume(TokenKind::Colon, "':'");
 
     SymKind kind = parseSymKind();
-    TypePtr ty = parseType();
+    SourceSpan tsp;
+    TypePtr ty = parseType(tsp);
 
     std::optional<Domain> dom = parseOptionalDomain();
     consume(TokenKind::Semicolon, "';'");
-    return SymDecl{sid, kind, ty, dom, SourceSpan{b, prevEnd()}};
+    return SymDecl{sid, kind, ty, dom, SourceSpan{b, prevEnd()}, tsp};
   }
 
   LetDecl Parser::parseLetDecl() {
@@ -276,14 +347,15 @@ namespace symir {
 
     LocalId id = parseLocalId();
     consume(TokenKind::Colon, "':'");
-    TypePtr ty = parseType();
+    SourceSpan tsp;
+    TypePtr ty = parseType(tsp);
 
     std::optional<InitVal> init;
     if (tryConsume(TokenKind::Equal)) {
       init = parseInitVal();
     }
     consume(TokenKind::Semicolon, "';'");
-    return LetDecl{isMut, id, ty, init, SourceSpan{b, prevEnd()}};
+    return LetDecl{isMut, id, ty, std::move(init), SourceSpan{b, prevEnd()}, tsp};
   }
 
   InitVal Parser::parseInitVal(bool allowAtom) {
@@ -296,7 +368,7 @@ namespace symir {
       }
       while (true) {
         // Inside braces: forbid atom-form (spec §3.4.2).
-        elements.push_back(std::make_shared<InitVal>(parseInitVal(/*allowAtom=*/false)));
+        elements.push_back(makeNode<InitVal>(arena_, parseInitVal(/*allowAtom=*/false)));
         if (!tryConsume(TokenKind::Comma))
           break;
       }
@@ -326,7 +398,7 @@ namespace symir {
 
     if (is(TokenKind::IntLit)) {
       const Token &t = consume(TokenKind::IntLit, "integer literal");
-      IntLit lit{parseIntegerLiteral(t.lexeme), t.span};
+      IntLit lit{parseIntegerLiteral(std::string(t.lexeme)), t.span};
       InitVal iv;
       iv.kind = InitVal::Kind::Int;
       iv.value = lit;
@@ -336,7 +408,7 @@ namespace symir {
 
     if (is(TokenKind::FloatLit)) {
       const Token &t = consume(TokenKind::FloatLit, "float literal");
-      FloatLit lit{parseFloatLiteral(t.lexeme), t.span};
+      FloatLit lit{parseFloatLiteral(std::string(t.lexeme)), t.span};
       InitVal iv;
       iv.kind = InitVal::Kind::Float;
       iv.value = lit;
@@ -371,12 +443,10 @@ namespace symir {
             "aggregate braces (§3.4.2)"
         );
       RValueAtom ra{std::move(lv), SourceSpan{b, prevEnd()}};
-      Atom atom{std::move(ra), ra.span};
-      InitVal iv;
-      iv.kind = InitVal::Kind::Atom;
-      iv.value = std::make_shared<Atom>(std::move(atom));
-      iv.span = SourceSpan{b, prevEnd()};
-      return iv;
+      Atom atom{std::move(ra), ra.span, nextNodeId_++};
+      return InitVal{
+          InitVal::Kind::Atom, makeNode<Atom>(arena_, std::move(atom)), SourceSpan{b, prevEnd()}
+      };
     }
 
     // [v0.2.1] §3.4.2: an atom (addr / load / cmp / ptrindex / ptrfield /
@@ -388,11 +458,9 @@ namespace symir {
       if (!allowAtom)
         errorHere("Atom-form initializer is not permitted inside aggregate braces (§3.4.2)");
       Atom atom = parseAtom();
-      InitVal iv;
-      iv.kind = InitVal::Kind::Atom;
-      iv.value = std::make_shared<Atom>(std::move(atom));
-      iv.span = SourceSpan{b, prevEnd()};
-      return iv;
+      return InitVal{
+          InitVal::Kind::Atom, makeNode<Atom>(arena_, std::move(atom)), SourceSpan{b, prevEnd()}
+      };
     }
 
     errorHere(
@@ -406,10 +474,15 @@ namespace symir {
     BlockLabel lab = parseBlockLabel();
     consume(TokenKind::Colon, "':'");
 
-    std::vector<Instr> instrs;
+    // Collected in a scratch vector that keeps its capacity, so the
+    // block's own vector is allocated once, at its final size.
+    instrScratch_.clear();
     while (isStartOfInstr()) {
-      instrs.push_back(parseInstr());
+      instrScratch_.push_back(parseInstr());
     }
+    std::vector<Instr> instrs(
+        std::make_move_iterator(instrScratch_.begin()), std::make_move_iterator(instrScratch_.end())
+    );
 
     Terminator term = parseTerminator();
     return Block{lab, std::move(instrs), std::move(term), SourceSpan{b, prevEnd()}};
@@ -442,7 +515,7 @@ namespace symir {
     // Wrap the LValue into a minimal Expr (single RValueAtom) so the AST
     // field type (Expr) is satisfied while enforcing the RValue restriction.
     RValueAtom ra{ptrLV, ptrSpan};
-    Atom ptrAtom{ra, ptrSpan};
+    Atom ptrAtom{ra, ptrSpan, nextNodeId_++};
     Expr ptr;
     ptr.first = std::move(ptrAtom);
     ptr.span = ptrSpan;
@@ -555,19 +628,19 @@ namespace symir {
       }
       if (tryConsume(TokenKind::Dot)) {
         const Token &fld = consume(TokenKind::Ident, "field name after '.'");
-        acc.push_back(AccessField{fld.lexeme, fld.span});
+        acc.push_back(AccessField{std::string(fld.lexeme), fld.span});
         continue;
       }
       break;
     }
 
-    return LValue{base, std::move(acc), SourceSpan{b, prevEnd()}};
+    return LValue{base, std::move(acc), SourceSpan{b, prevEnd()}, nextNodeId_++};
   }
 
   Index Parser::parseIndex() {
     if (is(TokenKind::IntLit)) {
       const Token &t = consume(TokenKind::IntLit, "index");
-      return Index{IntLit{parseIntegerLiteral(t.lexeme), t.span}};
+      return Index{IntLit{parseIntegerLiteral(std::string(t.lexeme)), t.span}};
     }
     if (is(TokenKind::LocalId)) {
       return Index{LocalOrSymId{parseLocalId()}};
@@ -581,11 +654,11 @@ namespace symir {
   Coef Parser::parseCoef() {
     if (is(TokenKind::IntLit)) {
       const Token &t = consume(TokenKind::IntLit, "coefficient");
-      return Coef{IntLit{parseIntegerLiteral(t.lexeme), t.span}};
+      return Coef{IntLit{parseIntegerLiteral(std::string(t.lexeme)), t.span}};
     }
     if (is(TokenKind::FloatLit)) {
       const Token &t = consume(TokenKind::FloatLit, "float coefficient");
-      return Coef{FloatLit{parseFloatLiteral(t.lexeme), t.span}};
+      return Coef{FloatLit{parseFloatLiteral(std::string(t.lexeme)), t.span}};
     }
     if (is(TokenKind::LocalId)) {
       return Coef{LocalOrSymId{parseLocalId()}};
@@ -633,7 +706,7 @@ namespace symir {
     while (is(TokenKind::Plus) || is(TokenKind::Minus)) {
       SourcePos tb = peek().span.begin;
       AddOp op = is(TokenKind::Plus) ? AddOp::Plus : AddOp::Minus;
-      idx_++; // consume +/-
+      advance(); // consume +/-
       Atom a = parseAtom();
       e.rest.push_back(Expr::Tail{op, std::move(a), SourceSpan{tb, prevEnd()}});
     }
@@ -643,6 +716,12 @@ namespace symir {
   }
 
   Atom Parser::parseAtom() {
+    Atom a = parseAtomForm();
+    a.id = nextNodeId_++;
+    return a;
+  }
+
+  Atom Parser::parseAtomForm() {
     SourcePos b = peek().span.begin;
 
     if (is(TokenKind::KwAddr)) {
@@ -713,7 +792,7 @@ namespace symir {
       RValue rv = parseLValue();
       consume(TokenKind::Comma, "','");
       const Token &fld = consume(TokenKind::Ident, "field name");
-      PtrFieldAtom pa{std::move(rv), fld.lexeme, SourceSpan{b, prevEnd()}};
+      PtrFieldAtom pa{std::move(rv), std::string(fld.lexeme), SourceSpan{b, prevEnd()}};
       return Atom{std::move(pa), pa.span};
     }
 
@@ -724,7 +803,7 @@ namespace symir {
     }
 
     // Try binary op or cast
-    std::size_t save = idx_;
+    Backtrack save(*this);
     try {
       Coef c = parseCoef();
       if (is(TokenKind::Star) || is(TokenKind::Slash) || is(TokenKind::Percent) ||
@@ -734,7 +813,7 @@ namespace symir {
         // Disallow accessed lvalues as coefficients
         if (auto lsid = std::get_if<LocalOrSymId>(&c)) {
           if (std::holds_alternative<LocalId>(*lsid)) {
-            idx_ = save;
+            save.rewind();
             LValue lv = parseLValue();
             if (!lv.accesses.empty()) {
               throw ParseError(
@@ -742,7 +821,7 @@ namespace symir {
                   peek().span
               );
             }
-            idx_ = save;
+            save.rewind();
             c = parseCoef(); // re-consume
           }
         }
@@ -760,23 +839,22 @@ namespace symir {
       if (auto lsid = std::get_if<LocalOrSymId>(&c)) {
         if (std::holds_alternative<LocalId>(*lsid)) {
           // Re-parse as full LValue (consumes accesses), then look for 'as'
-          idx_ = save;
+          save.rewind();
           LValue lv = parseLValue();
           if (tryConsume(TokenKind::KwAs)) {
-            TypePtr dst = parseType();
             CastAtom ca;
             ca.src = std::move(lv);
-            ca.dstType = std::move(dst);
+            ca.dstType = parseType(ca.dstSpan);
             ca.span = SourceSpan{b, prevEnd()};
             return Atom{std::move(ca), ca.span};
           }
           // No 'as' — not a cast; reset and fall through to leaf atom
-          idx_ = save;
+          save.rewind();
         }
       }
       if (tryConsume(TokenKind::KwAs)) {
-        TypePtr dst = parseType();
         CastAtom ca;
+        TypePtr dst = parseType(ca.dstSpan);
         if (auto lit = std::get_if<IntLit>(&c)) {
           ca.src = *lit;
         } else if (auto flit = std::get_if<FloatLit>(&c)) {
@@ -791,28 +869,30 @@ namespace symir {
           } else {
             // Simple LocalId (no accesses) — use as-is
             auto &lid = std::get<LocalId>(lsid);
-            ca.src = LValue{lid, {}, {}};
+            ca.src = LValue{lid, {}, {}, nextNodeId_++};
           }
         }
         ca.dstType = std::move(dst);
         ca.span = SourceSpan{b, prevEnd()};
         return Atom{std::move(ca), ca.span};
       }
+    } catch (const LexError &) {
+      throw; // the lexer cannot back up
     } catch (const ParseError &e) {
       // If it's a specific "accessed lvalue" error, propagate it
       if (std::string(e.what()).find("accessed lvalue") != std::string::npos)
         throw;
     }
-    idx_ = save;
+    save.rewind();
 
     // Leaf Atom
     if (is(TokenKind::IntLit) || is(TokenKind::FloatLit) || is(TokenKind::SymId) ||
         is(TokenKind::LocalId) || is(TokenKind::KwNull)) {
-      std::size_t save_leaf = idx_;
+      Backtrack saveLeaf(*this);
       Coef c = parseCoef();
       if (auto lsid = std::get_if<LocalOrSymId>(&c)) {
         if (std::holds_alternative<LocalId>(*lsid)) {
-          idx_ = save_leaf;
+          saveLeaf.rewind();
           LValue lv = parseLValue();
           return Atom{
               RValueAtom{std::move(lv), SourceSpan{b, prevEnd()}}, SourceSpan{b, prevEnd()}
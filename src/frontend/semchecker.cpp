@@ -3,8 +3,8 @@
 
 namespace symir {
 
-  symir::PassResult SemChecker::run(Program &prog, DiagBag &diags) {
-    std::unordered_set<std::string> globalNames;
+  symir::PassResult SemChecker::run(Program &prog, DiagBag &diags, AnalysisManager &) {
+    std::unordered_set<Symbol> globalNames;
 
     for (const auto &s: prog.structs) {
       if (globalNames.count(s.name.name)) {
@@ -14,18 +14,22 @@ namespace symir {
       checkStruct(s, diags);
     }
 
-    for (const auto &f: prog.funs) {
-      if (globalNames.count(f.name.name)) {
-        diags.error("Duplicate global name (function): " + f.name.name, f.span);
-      }
-      globalNames.insert(f.name.name);
-      checkFunction(f, diags);
-    }
+    // Global names are resolved up front; the per-function checks then
+    // run independently, each reporting after its own duplicate error.
+    std::vector<char> duplicate(prog.funs.size());
+    for (std::size_t i = 0; i < prog.funs.size(); ++i)
+      duplicate[i] = !globalNames.insert(prog.funs[i].name.name).second;
+    forEachFunction(prog.funs.size(), numThreads(), diags, [&](std::size_t i, DiagBag &bag) {
+      const FunDecl &f = prog.funs[i];
+      if (duplicate[i])
+        bag.error("Duplicate global name (function): " + f.name.name, f.span);
+      checkFunction(f, bag);
+    });
     return diags.hasErrors() ? symir::PassResult::Error : symir::PassResult::Success;
   }
 
   void SemChecker::checkStruct(const StructDecl &s, DiagBag &diags) {
-    std::unordered_set<std::string> fields;
+    std::unordered_set<Symbol> fields;
     for (const auto &f: s.fields) {
       if (fields.count(f.name)) {
         diags.error("Duplicate field name: " + f.name, f.span);
@@ -68,8 +72,8 @@ namespace symir {
   }
 
   void SemChecker::checkDuplicates(const FunDecl &f, DiagBag &diags) {
-    std::unordered_set<std::string> locals;
-    std::unordered_set<std::string> labels;
+    std::unordered_set<Symbol> locals;
+    std::unordered_set<Symbol> labels;
 
     for (const auto &p: f.params) {
       if (locals.count(p.name.name)) {
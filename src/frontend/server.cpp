@@ -0,0 +1,369 @@
+#include "frontend/server.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "error.hpp"
+#include "frontend/source_buffer.hpp"
+#include "timing.hpp"
+
+namespace symir {
+
+  std::string LoadedModule::warnings() const {
+    std::ostringstream os;
+    for (const auto &d: diags.diags)
+      if (d.level == DiagLevel::Warning)
+        printMessage(os, source, d.span, d.message, d.level);
+    return os.str();
+  }
+
+  // --- ModuleStore ---
+
+  ModuleStore::ModuleStore(Pipeline pipeline, const ModuleCache *moduleCache)
+      : pipeline_(std::move(pipeline)), moduleCache_(moduleCache) {}
+
+  void ModuleStore::check(LoadedModule &m) const {
+    std::ostringstream err;
+    try {
+      PassManager pm(m.diags, &m.analyses);
+      pipeline_(pm);
+      PassResult checked;
+      {
+        timing::Scope timer("frontend");
+        checked = parseAndCheck(m.source, pm, moduleCache_, m.prog);
+      }
+      if (checked == PassResult::Error) {
+        for (const auto &d: m.diags.diags) {
+          if (d.level == DiagLevel::Error)
+            printMessage(err, m.source, d.span, d.message, d.level);
+        }
+      }
+    } catch (const LexError &e) {
+      printMessage(err, m.source, e.span, e.what(), DiagLevel::Error);
+    } catch (const ParseError &e) {
+      printMessage(err, m.source, e.span, e.what(), DiagLevel::Error);
+    }
+    m.error = err.str();
+  }
+
+  std::shared_ptr<const LoadedModule> ModuleStore::lookup(
+      const std::string &key, const Stamp &stamp, std::string input, std::string source
+  ) {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto it = modules_.find(key);
+    if (it != modules_.end() && it->second.first == stamp) {
+      ++hits_;
+      auto ready = it->second.second;
+      lock.unlock();
+      return ready.get();
+    }
+    // New, or its file has changed: requests from now on wait for this load.
+    std::promise<std::shared_ptr<const LoadedModule>> loaded;
+    modules_[key] = {stamp, loaded.get_future().share()};
+    ++loads_;
+    lock.unlock();
+
+    auto m = std::make_shared<LoadedModule>();
+    m->input = std::move(input);
+    if (m->input.empty()) {
+      m->source = std::move(source);
+    } else if (auto buf = SourceBuffer::open(m->input)) {
+      m->source = buf->text();
+    } else {
+      m->error = "Could not open file " + m->input;
+    }
+    if (m->error.empty()) {
+      SymbolTable::Scope symbols(m->symbols);
+      check(*m);
+    }
+    loaded.set_value(m);
+    return m;
+  }
+
+  std::shared_ptr<const LoadedModule> ModuleStore::get(const std::string &path) {
+    // A file that cannot be stat'ed is looked up as missing (and retried
+    // once it exists).
+    Stamp stamp;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0) {
+      stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+      stamp.size = static_cast<int64_t>(st.st_size);
+    }
+    return lookup("file:" + path, stamp, path, {});
+  }
+
+  std::shared_ptr<const LoadedModule> ModuleStore::getSource(const std::string &source) {
+    return lookup("text:" + source, {}, {}, source);
+  }
+
+  bool ModuleStore::drop(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return modules_.erase("file:" + path) > 0;
+  }
+
+  ModuleStore::Stats ModuleStore::stats() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return {modules_.size(), loads_, hits_};
+  }
+
+  // --- RpcServer ---
+
+  namespace {
+
+    // Lines of a file descriptor, read in large chunks.
+    class LineReader {
+    public:
+      explicit LineReader(int fd) : fd_(fd) {}
+
+      bool next(std::string &line) {
+        for (;;) {
+          auto nl = buf_.find('\n', pos_);
+          if (nl != std::string::npos) {
+            line.assign(buf_, pos_, nl - pos_);
+            pos_ = nl + 1;
+            return true;
+          }
+          buf_.erase(0, pos_);
+          pos_ = 0;
+          char chunk[65536];
+          ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n <= 0) {
+            // A last line without a newline still counts.
+            line = std::move(buf_);
+            buf_.clear();
+            return !line.empty();
+          }
+          buf_.append(chunk, static_cast<std::size_t>(n));
+        }
+      }
+
+    private:
+      int fd_;
+      std::string buf_;
+      std::size_t pos_ = 0;
+    };
+
+    // Writes all of `text`; false once the peer is gone.
+    bool writeAll(int fd, std::string_view text) {
+      while (!text.empty()) {
+        ssize_t n = ::write(fd, text.data(), text.size());
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n <= 0)
+          return false;
+        text.remove_prefix(static_cast<std::size_t>(n));
+      }
+      return true;
+    }
+
+    // The JSON text of a request id (a number, a string or null).
+    std::string idText(const json::Value *id) {
+      if (!id || id->isNull())
+        return "null";
+      return id->isString() ? json::quote(id->text) : id->text;
+    }
+
+    std::string errorReply(const std::string &id, int code, const std::string &message) {
+      return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"error\":{\"code\":" + std::to_string(code) +
+             ",\"message\":" + json::quote(message) + "}}";
+    }
+
+  } // namespace
+
+  RpcServer::RpcServer(std::string name, unsigned numWorkers)
+      : name_(std::move(name)), pool_(numWorkers) {}
+
+  void RpcServer::on(const std::string &method, Handler handler) {
+    handlers_[method] = std::move(handler);
+  }
+
+  std::string RpcServer::dispatch(const json::Value &msg, const std::string &id) {
+    ++requests_;
+    const json::Value *method = msg.find("method");
+    if (!method || !method->isString()) {
+      ++errors_;
+      return errorReply(id, kInvalidRequest, "request has no \"method\"");
+    }
+    auto it = handlers_.find(method->text);
+    if (it == handlers_.end()) {
+      ++errors_;
+      return errorReply(id, kMethodNotFound, "Unknown method " + method->text);
+    }
+    static const json::Value kNull;
+    const json::Value *params = msg.find("params");
+    try {
+      std::string result = it->second(params ? *params : kNull);
+      return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":" + result + "}";
+    } catch (const Error &e) {
+      ++errors_;
+      return errorReply(id, e.code, e.what());
+    } catch (const std::exception &e) {
+      ++errors_;
+      return errorReply(id, kServerError, e.what());
+    }
+  }
+
+  void RpcServer::serveConnection(int in, int out) {
+    std::mutex outMu;
+    auto reply = [&](const std::string &text) {
+      std::lock_guard<std::mutex> lock(outMu);
+      writeAll(out, text + "\n");
+    };
+    solver::WorkPool::Group pending;
+    LineReader reader(in);
+    std::string line;
+    while (!stop_ && reader.next(line)) {
+      if (line.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+      json::Value msg;
+      try {
+        msg = json::parse(line);
+      } catch (const std::exception &e) {
+        reply(errorReply("null", kParseError, e.what()));
+        continue;
+      }
+      const json::Value *id = msg.find("id");
+      const json::Value *method = msg.find("method");
+      if (method && method->isString() && method->text == "shutdown") {
+        pool_.wait(pending);
+        stop_ = true;
+        if (id)
+          reply("{\"jsonrpc\":\"2.0\",\"id\":" + idText(id) + ",\"result\":null}");
+        break;
+      }
+      if (method && method->isString() && method->text == "ping") {
+        if (id)
+          reply(
+              "{\"jsonrpc\":\"2.0\",\"id\":" + idText(id) +
+              ",\"result\":{\"server\":" + json::quote(name_) +
+              ",\"requests\":" + std::to_string(requests_.load()) +
+              ",\"errors\":" + std::to_string(errors_.load()) + "}}"
+          );
+        continue;
+      }
+      pool_.submit(pending, [this, &reply, msg = std::move(msg)](unsigned) {
+        const json::Value *id = msg.find("id");
+        std::string text = dispatch(msg, idText(id));
+        if (id)
+          reply(text);
+      });
+    }
+    pool_.wait(pending);
+  }
+
+  int RpcServer::serveStdio() {
+    // Replies get their own descriptor; stray writes to stdout (e.g. from a
+    // library) go to stderr instead of into the protocol.
+    std::cout.flush();
+    int out = ::dup(STDOUT_FILENO);
+    if (out < 0 || ::dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+      std::cerr << "Error: cannot set up stdout: " << std::strerror(errno) << std::endl;
+      return ExitCode::Error;
+    }
+    serveConnection(STDIN_FILENO, out);
+    ::close(out);
+    return ExitCode::Success;
+  }
+
+  int RpcServer::serveUnix(const std::string &path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+      std::cerr << "Error: socket path too long: " << path << std::endl;
+      return ExitCode::Error;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int lfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(path.c_str());
+    if (lfd < 0 || ::bind(lfd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(lfd, 64) < 0) {
+      std::cerr << "Error: cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+      if (lfd >= 0)
+        ::close(lfd);
+      return ExitCode::Error;
+    }
+    // A client that hangs up must not take the server down with it.
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cerr << name_ << ": serving on " << path << std::endl;
+
+    std::mutex connMu;
+    std::vector<int> conns;
+    std::vector<std::thread> threads;
+    while (!stop_) {
+      pollfd p{lfd, POLLIN, 0};
+      if (::poll(&p, 1, 100) <= 0)
+        continue;
+      int fd = ::accept(lfd, nullptr, nullptr);
+      if (fd < 0)
+        continue;
+      std::lock_guard<std::mutex> lock(connMu);
+      conns.push_back(fd);
+      threads.emplace_back([this, fd, &connMu, &conns] {
+        serveConnection(fd, fd);
+        std::lock_guard<std::mutex> lock(connMu);
+        std::erase(conns, fd);
+        ::close(fd);
+      });
+    }
+    ::close(lfd);
+    ::unlink(path.c_str());
+    {
+      // Wake the connections still waiting for a request.
+      std::lock_guard<std::mutex> lock(connMu);
+      for (int fd: conns)
+        ::shutdown(fd, SHUT_RD);
+    }
+    for (auto &t: threads)
+      t.join();
+    return ExitCode::Success;
+  }
+
+  // --- Module methods ---
+
+  std::shared_ptr<const LoadedModule> requestModule(ModuleStore &store, const json::Value &params) {
+    std::shared_ptr<const LoadedModule> m;
+    if (const json::Value *input = params.find("input"))
+      m = store.get(input->asString());
+    else if (const json::Value *source = params.find("source"))
+      m = store.getSource(source->asString());
+    else
+      throw RpcServer::Error(RpcServer::kInvalidParams, "request has no \"input\" or \"source\"");
+    if (!m->error.empty())
+      throw RpcServer::Error(RpcServer::kServerError, m->error);
+    return m;
+  }
+
+  void addModuleMethods(RpcServer &server, ModuleStore &store) {
+    server.on("load", [&store](const json::Value &params) {
+      auto m = requestModule(store, params);
+      SymbolTable::Scope symbols(m->symbols);
+      std::string out = "{\"functions\":[";
+      for (std::size_t i = 0; i < m->prog.funs.size(); ++i)
+        out += (i ? "," : "") + json::quote(m->prog.funs[i].name.name);
+      return out + "],\"warnings\":" + json::quote(m->warnings()) + "}";
+    });
+    server.on("drop", [&store](const json::Value &params) {
+      const json::Value *input = params.find("input");
+      if (!input)
+        throw RpcServer::Error(RpcServer::kInvalidParams, "request has no \"input\"");
+      return std::string("{\"dropped\":") + (store.drop(input->asString()) ? "true" : "false") +
+             "}";
+    });
+    server.on("stats", [&store](const json::Value &) {
+      auto s = store.stats();
+      return "{\"modules\":" + std::to_string(s.modules) + ",\"loads\":" +
+             std::to_string(s.loads) + ",\"hits\":" + std::to_string(s.hits) + "}";
+    });
+  }
+
+} // namespace symir
@@ -1,4 +1,8 @@
 #include "ast/sir_printer.hpp"
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include "analysis/pass_manager.hpp"
 
 namespace symir {
 
@@ -29,7 +33,50 @@ namespace symir {
     out << s;
   }
 
+  SIRPrinter::SIRPrinter(const SIRPrinter &parent, std::ostream &out, const FunDecl &f) :
+      out_(out) {
+    if (!parent.perFunction_) {
+      model_ = parent.model_;
+      vecModel_ = parent.vecModel_;
+    } else if (auto it = parent.functionModels_.find(f.name.name);
+               it != parent.functionModels_.end()) {
+      model_ = it->second.model;
+      vecModel_ = it->second.vecModel;
+    }
+  }
+
+  void SIRPrinter::setNumThreads(unsigned n) {
+    numThreads_ = n ? n : std::max(1u, std::thread::hardware_concurrency());
+  }
+
   void SIRPrinter::print(const Program &p) {
+    // The structs, then each function rendered into a buffer of its own by
+    // a worker printer; all joined in order and written at once.
+    std::vector<std::string> parts(p.funs.size() + 1);
+    {
+      std::ostringstream buf;
+      SIRPrinter structs(buf);
+      structs.printStructs(p);
+      parts[0] = std::move(buf).str();
+    }
+    DiagBag unused;
+    forEachFunction(p.funs.size(), numThreads_, unused, [&](std::size_t i, DiagBag &) {
+      std::ostringstream buf;
+      SIRPrinter worker(*this, buf, p.funs[i]);
+      worker.printFunction(p.funs[i]);
+      parts[i + 1] = std::move(buf).str();
+    });
+    std::size_t size = 0;
+    for (const auto &part: parts)
+      size += part.size();
+    std::string text;
+    text.reserve(size);
+    for (const auto &part: parts)
+      text += part;
+    out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+  }
+
+  void SIRPrinter::printStructs(const Program &p) {
     for (const auto &s: p.structs) {
       out_ << "struct " << s.name.name << " {\n";
       indent_level_++;
@@ -42,144 +89,144 @@ namespace symir {
       indent_level_--;
       out_ << "} \n\n";
     }
+  }
 
-    for (const auto &f: p.funs) {
-      out_ << "fun " << f.name.name << "(";
-      for (size_t i = 0; i < f.params.size(); ++i) {
-        out_ << f.params[i].name.name << ": ";
-        printType(f.params[i].type);
-        if (i + 1 < f.params.size())
-          out_ << ", ";
-      }
-      out_ << ") : ";
-      printType(f.retType);
-      out_ << " {\n";
-      indent_level_++;
-
-      // 1. Symbols. If a model is present, scalar syms get substituted
-      //    inline at use sites and are dropped here; vec syms get
-      //    materialized as synthetic let-decls (see step 1b).
-      bool hasModel = !model_.empty() || !vecModel_.empty();
-      if (!hasModel) {
-        for (const auto &s: f.syms) {
-          indent();
-          out_ << "sym " << s.name.name << " : ";
-          switch (s.kind) {
-            case SymKind::Value:
-              out_ << "value ";
-              break;
-            case SymKind::Coef:
-              out_ << "coef ";
-              break;
-            case SymKind::Index:
-              out_ << "index ";
-              break;
-          }
-          printType(s.type);
-          if (s.domain) {
-            out_ << " ";
-            printDomain(*s.domain);
-          }
-          out_ << ";\n";
-        }
-      }
+  void SIRPrinter::printFunction(const FunDecl &f) {
+    out_ << "fun " << f.name.name << "(";
+    for (size_t i = 0; i < f.params.size(); ++i) {
+      out_ << f.params[i].name.name << ": ";
+      printType(f.params[i].type);
+      if (i + 1 < f.params.size())
+        out_ << ", ";
+    }
+    out_ << ") : ";
+    printType(f.retType);
+    out_ << " {\n";
+    indent_level_++;
 
-      // 1b. Synthetic let-decls for each vec sym in vecModel. Vector
-      //     sym references can't be substituted inline (Atom grammar has
-      //     no vector literal), so we lower them to a constant let.
+    // 1. Symbols. If a model is present, scalar syms get substituted
+    //    inline at use sites and are dropped here; vec syms get
+    //    materialized as synthetic let-decls (see step 1b).
+    bool hasModel = !model_.empty() || !vecModel_.empty();
+    if (!hasModel) {
       for (const auto &s: f.syms) {
-        auto it = vecModel_.find(s.name.name);
-        if (it == vecModel_.end())
-          continue;
         indent();
-        out_ << "let " << vecSymLocalName(s.name.name) << ": ";
+        out_ << "sym " << s.name.name << " : ";
+        switch (s.kind) {
+          case SymKind::Value:
+            out_ << "value ";
+            break;
+          case SymKind::Coef:
+            out_ << "coef ";
+            break;
+          case SymKind::Index:
+            out_ << "index ";
+            break;
+        }
         printType(s.type);
-        out_ << " = {";
-        for (size_t k = 0; k < it->second.size(); ++k) {
-          const auto &v = it->second[k];
-          if (std::holds_alternative<int64_t>(v))
-            out_ << std::get<int64_t>(v);
-          else
-            printDouble(out_, std::get<double>(v));
-          if (k + 1 < it->second.size())
-            out_ << ", ";
+        if (s.domain) {
+          out_ << " ";
+          printDomain(*s.domain);
         }
-        out_ << "};\n";
+        out_ << ";\n";
       }
+    }
 
-      // 2. Locals
-      for (const auto &l: f.lets) {
-        indent();
-        out_ << "let " << (l.isMutable ? "mut " : "") << l.name.name << ": ";
-        printType(l.type);
-        if (l.init) {
-          out_ << " = ";
-          printInitVal(*l.init);
-        }
-        out_ << ";\n";
+    // 1b. Synthetic let-decls for each vec sym in vecModel. Vector
+    //     sym references can't be substituted inline (Atom grammar has
+    //     no vector literal), so we lower them to a constant let.
+    for (const auto &s: f.syms) {
+      auto it = vecModel_.find(s.name.name);
+      if (it == vecModel_.end())
+        continue;
+      indent();
+      out_ << "let " << vecSymLocalName(s.name.name) << ": ";
+      printType(s.type);
+      out_ << " = {";
+      for (size_t k = 0; k < it->second.size(); ++k) {
+        const auto &v = it->second[k];
+        if (std::holds_alternative<int64_t>(v))
+          out_ << std::get<int64_t>(v);
+        else
+          printDouble(out_, std::get<double>(v));
+        if (k + 1 < it->second.size())
+          out_ << ", ";
       }
+      out_ << "};\n";
+    }
 
-      // 3. Blocks
-      for (const auto &b: f.blocks) {
-        out_ << b.label.name << ":\n";
-        for (const auto &ins: b.instrs) {
-          indent();
-          std::visit(
-              [this](auto &&arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, AssignInstr>) {
-                  printLValue(arg.lhs);
-                  out_ << " = ";
-                  printExpr(arg.rhs);
-                } else if constexpr (std::is_same_v<T, AssumeInstr>) {
-                  out_ << "assume ";
-                  printCond(arg.cond);
-                } else if constexpr (std::is_same_v<T, RequireInstr>) {
-                  out_ << "require ";
-                  printCond(arg.cond);
-                  if (arg.message)
-                    out_ << ", \"" << *arg.message << "\"";
-                } else if constexpr (std::is_same_v<T, StoreInstr>) {
-                  out_ << "store ";
-                  printExpr(arg.ptr);
-                  out_ << ", ";
-                  printExpr(arg.val);
-                }
-                out_ << ";\n";
-              },
-              ins
-          );
-        }
+    // 2. Locals
+    for (const auto &l: f.lets) {
+      indent();
+      out_ << "let " << (l.isMutable ? "mut " : "") << l.name.name << ": ";
+      printType(l.type);
+      if (l.init) {
+        out_ << " = ";
+        printInitVal(*l.init);
+      }
+      out_ << ";\n";
+    }
+
+    // 3. Blocks
+    for (const auto &b: f.blocks) {
+      out_ << b.label.name << ":\n";
+      for (const auto &ins: b.instrs) {
         indent();
         std::visit(
             [this](auto &&arg) {
               using T = std::decay_t<decltype(arg)>;
-              if constexpr (std::is_same_v<T, BrTerm>) {
-                out_ << "br ";
-                if (arg.isConditional) {
-                  printCond(*arg.cond);
-                  out_ << ", " << arg.thenLabel.name << ", " << arg.elseLabel.name;
-                } else {
-                  out_ << arg.dest.name;
-                }
-              } else if constexpr (std::is_same_v<T, RetTerm>) {
-                out_ << "ret";
-                if (arg.value) {
-                  out_ << " ";
-                  printExpr(*arg.value);
-                }
-              } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
-                out_ << "unreachable";
+              if constexpr (std::is_same_v<T, AssignInstr>) {
+                printLValue(arg.lhs);
+                out_ << " = ";
+                printExpr(arg.rhs);
+              } else if constexpr (std::is_same_v<T, AssumeInstr>) {
+                out_ << "assume ";
+                printCond(arg.cond);
+              } else if constexpr (std::is_same_v<T, RequireInstr>) {
+                out_ << "require ";
+                printCond(arg.cond);
+                if (arg.message)
+                  out_ << ", \"" << *arg.message << "\"";
+              } else if constexpr (std::is_same_v<T, StoreInstr>) {
+                out_ << "store ";
+                printExpr(arg.ptr);
+                out_ << ", ";
+                printExpr(arg.val);
               }
               out_ << ";\n";
             },
-            b.term
+            ins
         );
       }
-
-      indent_level_--;
-      out_ << "} \n\n";
+      indent();
+      std::visit(
+          [this](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, BrTerm>) {
+              out_ << "br ";
+              if (arg.isConditional) {
+                printCond(*arg.cond);
+                out_ << ", " << arg.thenLabel.name << ", " << arg.elseLabel.name;
+              } else {
+                out_ << arg.dest.name;
+              }
+            } else if constexpr (std::is_same_v<T, RetTerm>) {
+              out_ << "ret";
+              if (arg.value) {
+                out_ << " ";
+                printExpr(*arg.value);
+              }
+            } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
+              out_ << "unreachable";
+            }
+            out_ << ";\n";
+          },
+          b.term
+      );
     }
+
+    indent_level_--;
+    out_ << "} \n\n";
   }
 
   void SIRPrinter::printType(const TypePtr &t) {
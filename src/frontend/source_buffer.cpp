@@ -0,0 +1,73 @@
+#include "frontend/source_buffer.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace symir {
+
+  std::optional<SourceBuffer> SourceBuffer::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return std::nullopt;
+    SourceBuffer buf;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      auto size = static_cast<std::size_t>(st.st_size);
+      void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        ::close(fd);
+        buf.data_ = static_cast<const char *>(p);
+        buf.size_ = size;
+        buf.mapped_ = true;
+        return buf;
+      }
+    }
+    // Not mappable: read it through.
+    char chunk[65536];
+    for (;;) {
+      ssize_t n = ::read(fd, chunk, sizeof chunk);
+      if (n < 0) {
+        ::close(fd);
+        return std::nullopt;
+      }
+      if (n == 0)
+        break;
+      buf.own_.insert(buf.own_.end(), chunk, chunk + n);
+    }
+    ::close(fd);
+    buf.data_ = buf.own_.data();
+    buf.size_ = buf.own_.size();
+    return buf;
+  }
+
+  // A moved vector keeps its storage, so data_ stays valid.
+  SourceBuffer::SourceBuffer(SourceBuffer &&other) noexcept :
+      data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+      mapped_(std::exchange(other.mapped_, false)), own_(std::move(other.own_)) {}
+
+  SourceBuffer &SourceBuffer::operator=(SourceBuffer &&other) noexcept {
+    if (this != &other) {
+      release();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      mapped_ = std::exchange(other.mapped_, false);
+      own_ = std::move(other.own_);
+    }
+    return *this;
+  }
+
+  SourceBuffer::~SourceBuffer() { release(); }
+
+  void SourceBuffer::release() {
+    if (mapped_)
+      ::munmap(const_cast<char *>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    own_.clear();
+  }
+
+} // namespace symir
@@ -0,0 +1,43 @@
+#include "ast/symbol.hpp"
+#include <stdexcept>
+
+namespace symir {
+
+  SymbolTable &SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+  }
+
+  SymbolTable::SymbolTable() { intern(""); }
+
+  SymbolTable::~SymbolTable() {
+    for (auto &chunk: chunks_)
+      delete[] chunk.load(std::memory_order_relaxed);
+  }
+
+  Symbol SymbolTable::intern(std::string_view text) {
+    std::lock_guard<std::mutex> lock(mu_);
+    Symbol s;
+    if (auto it = index_.find(text); it != index_.end()) {
+      s.id_ = it->second;
+      return s;
+    }
+    std::uint32_t id = size_.load(std::memory_order_relaxed);
+    auto [chunk, i] = locate(id);
+    if (chunk >= kMaxChunks)
+      throw std::runtime_error("Too many distinct identifiers");
+    Entry *entries = chunks_[chunk].load(std::memory_order_relaxed);
+    if (!entries) {
+      entries = new Entry[std::size_t(1) << (kFirstBits + chunk)];
+      chunks_[chunk].store(entries, std::memory_order_release);
+    }
+    Entry &e = entries[i];
+    e.text = std::string(text);
+    e.hash = std::hash<std::string_view>{}(e.text);
+    index_.emplace(e.text, id);
+    size_.store(id + 1, std::memory_order_release);
+    s.id_ = id;
+    return s;
+  }
+
+} // namespace symir
@@ -0,0 +1,69 @@
+#include "ast/type_table.hpp"
+#include <functional>
+
+namespace symir {
+
+  TypeTable &TypeTable::global() {
+    static TypeTable table;
+    return table;
+  }
+
+  std::size_t TypeTable::KeyHash::operator()(const Key &k) const noexcept {
+    std::size_t h = std::hash<std::uint64_t>{}(k.n);
+    auto mix = [&h](std::size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+    mix(k.tag);
+    mix(k.kind);
+    mix(k.name);
+    mix(std::hash<const Type *>{}(k.child));
+    return h;
+  }
+
+  TypePtr TypeTable::intern(const Type &t) {
+    // Children first, outside the lock: intern() recurses through it.
+    Type node;
+    Key key;
+    key.tag = static_cast<std::uint8_t>(t.v.index());
+    std::visit(
+        [&](const auto &arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, IntType>) {
+            key.kind = static_cast<std::uint8_t>(arg.kind);
+            if (arg.kind == IntType::Kind::ICustom)
+              key.n = static_cast<std::uint64_t>(arg.bits.value_or(0));
+            node.v = IntType{arg.kind, arg.kind == IntType::Kind::ICustom ? arg.bits : std::nullopt,
+                             {}};
+          } else if constexpr (std::is_same_v<T, FloatType>) {
+            key.kind = static_cast<std::uint8_t>(arg.kind);
+            node.v = FloatType{arg.kind, {}};
+          } else if constexpr (std::is_same_v<T, StructType>) {
+            key.name = arg.name.name.id();
+            node.v = StructType{GlobalId{arg.name.name, {}}, {}};
+          } else if constexpr (std::is_same_v<T, ArrayType>) {
+            TypePtr elem = intern(arg.elem);
+            key.n = arg.size;
+            key.child = elem.get();
+            node.v = ArrayType{arg.size, std::move(elem), {}};
+          } else if constexpr (std::is_same_v<T, PtrType>) {
+            TypePtr pointee = intern(arg.pointee);
+            key.child = pointee.get();
+            node.v = PtrType{std::move(pointee), {}};
+          } else if constexpr (std::is_same_v<T, VecType>) {
+            TypePtr elem = intern(arg.elem);
+            key.n = arg.size;
+            key.child = elem.get();
+            node.v = VecType{arg.size, std::move(elem), {}};
+          }
+        },
+        t.v
+    );
+
+    std::lock_guard<std::mutex> lock(mu_);
+    auto [it, fresh] = index_.try_emplace(key);
+    if (fresh) {
+      it->second = std::make_shared<Type>(std::move(node));
+      it->second->canonical.on = true;
+    }
+    return it->second;
+  }
+
+} // namespace symir
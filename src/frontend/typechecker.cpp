@@ -1,15 +1,19 @@
 #include "frontend/typechecker.hpp"
 #include "analysis/cfg.hpp"
 #include "analysis/type_utils.hpp"
+#include "ast/type_table.hpp"
 
 namespace symir {
 
-  symir::PassResult TypeChecker::run(Program &prog, DiagBag &diags) {
+  symir::PassResult TypeChecker::run(Program &prog, DiagBag &diags, AnalysisManager &am) {
     collectStructs(prog, diags);
-    for (const auto &f: prog.funs) {
-      TypeAnnotations ann;
-      checkFunction(f, ann, diags);
-    }
+    // Functions only read the struct table, so they check independently;
+    // each fills the annotation slots of its own nodes.
+    auto ann = std::make_shared<TypeAnnotations>(prog.numNodeIds);
+    forEachFunction(prog.funs.size(), numThreads(), diags, [&](std::size_t i, DiagBag &bag) {
+      checkFunction(prog.funs[i], *ann, bag, am);
+    });
+    prog.types = std::move(ann);
     return diags.hasErrors() ? symir::PassResult::Error : symir::PassResult::Success;
   }
 
@@ -18,8 +22,8 @@ namespace symir {
   // ptr to vector, no vector with N<2, no vector as struct field, no array
   // of vector.
   static void validateTypeWF(
-      const TypePtr &t, DiagBag &diags, bool insideVec = false, bool insideField = false,
-      bool insideArray = false
+      const TypePtr &t, const SourceSpan &at, DiagBag &diags, bool insideVec = false,
+      bool insideField = false, bool insideArray = false
   ) {
     if (!t)
       return;
@@ -28,13 +32,13 @@ namespace symir {
           using X = std::decay_t<decltype(x)>;
           if constexpr (std::is_same_v<X, VecType>) {
             if (insideVec)
-              diags.error("Vectors cannot be nested (<N> <M> T)", t->span);
+              diags.error("Vectors cannot be nested (<N> <M> T)", at);
             if (insideField)
-              diags.error("Vectors cannot appear as struct fields", t->span);
+              diags.error("Vectors cannot appear as struct fields", at);
             if (insideArray)
-              diags.error("Arrays of vectors are not supported", t->span);
+              diags.error("Arrays of vectors are not supported", at);
             if (x.size < 2)
-              diags.error("Vector lane count must be >= 2; got " + std::to_string(x.size), t->span);
+              diags.error("Vector lane count must be >= 2; got " + std::to_string(x.size), at);
             // The lane element must itself be scalar (Int or Float). Recurse
             // with insideVec=true so the recursion catches nested vectors;
             // PtrType / StructType / ArrayType / VecType inside a vector
@@ -42,16 +46,16 @@ namespace symir {
             // below).
             if (x.elem && !std::holds_alternative<IntType>(x.elem->v) &&
                 !std::holds_alternative<FloatType>(x.elem->v)) {
-              diags.error("Vector lane type must be a scalar (iN, f32, f64)", t->span);
+              diags.error("Vector lane type must be a scalar (iN, f32, f64)", at);
             }
-            validateTypeWF(x.elem, diags, true, false, false);
+            validateTypeWF(x.elem, at, diags, true, false, false);
           } else if constexpr (std::is_same_v<X, PtrType>) {
             // ptr <N> T is forbidden (§6.8.1).
             if (x.pointee && std::holds_alternative<VecType>(x.pointee->v))
-              diags.error("Pointer to vector (ptr <N> T) is not supported", t->span);
-            validateTypeWF(x.pointee, diags, false, false, false);
+              diags.error("Pointer to vector (ptr <N> T) is not supported", at);
+            validateTypeWF(x.pointee, at, diags, false, false, false);
           } else if constexpr (std::is_same_v<X, ArrayType>) {
-            validateTypeWF(x.elem, diags, false, false, true);
+            validateTypeWF(x.elem, at, diags, false, false, true);
           }
           // StructType: validated separately in collectStructs.
         },
@@ -66,7 +70,7 @@ namespace symir {
       for (const auto &fd: sd.fields) {
         // [v0.2.1] Validate per-field type: in particular reject vector
         // fields explicitly with insideField=true.
-        validateTypeWF(fd.type, diags, false, true, false);
+        validateTypeWF(fd.type, fd.typeSpan, diags, false, true, false);
         si.fields[fd.name] = fd.type;
         si.fieldList.push_back({fd.name, fd.type});
       }
@@ -76,8 +80,8 @@ namespace symir {
 
   void TypeChecker::checkInitVal(
       const InitVal &iv, const TypePtr &targetType,
-      const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags
+      const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, DiagBag &diags
   ) {
     if (iv.kind == InitVal::Kind::Undef)
       return;
@@ -232,15 +236,17 @@ namespace symir {
     }
   }
 
-  void TypeChecker::checkFunction(const FunDecl &f, TypeAnnotations &ann, DiagBag &diags) {
-    std::unordered_map<std::string, VarInfo> vars;
-    std::unordered_map<std::string, SymInfo> syms;
+  void TypeChecker::checkFunction(
+      const FunDecl &f, TypeAnnotations &ann, DiagBag &diags, AnalysisManager &am
+  ) {
+    std::unordered_map<Symbol, VarInfo> vars;
+    std::unordered_map<Symbol, SymInfo> syms;
 
     // [v0.2.1] Up-front type validation so structural errors fire before
     // any expression check that would also touch the type.
-    validateTypeWF(f.retType, diags);
+    validateTypeWF(f.retType, f.retTypeSpan, diags);
     for (const auto &p: f.params) {
-      validateTypeWF(p.type, diags);
+      validateTypeWF(p.type, p.typeSpan, diags);
       vars[p.name.name] = VarInfo{p.type, false, true, p.span};
     }
     for (const auto &s: f.syms) {
@@ -249,21 +255,21 @@ namespace symir {
       if (s.type && std::holds_alternative<PtrType>(s.type->v)) {
         diags.error("sym of pointer type is not allowed in v0.2.0: " + s.name.name, s.span);
       }
-      validateTypeWF(s.type, diags);
+      validateTypeWF(s.type, s.typeSpan, diags);
       syms[s.name.name] = SymInfo{s.type, s.kind, s.span};
     }
     for (const auto &l: f.lets) {
       if (vars.count(l.name.name)) {
         diags.error("Duplicate name: " + l.name.name, l.span);
       }
-      validateTypeWF(l.type, diags);
+      validateTypeWF(l.type, l.typeSpan, diags);
       vars[l.name.name] = VarInfo{l.type, l.isMutable, false, l.span};
       if (l.init) {
         checkInitVal(*l.init, l.type, vars, syms, diags);
       }
     }
 
-    CFG::build(f, diags);
+    am.cfg(f, diags);
 
     auto retBits = TypeUtils::getBitWidth(f.retType);
     bool isRetFloat = f.retType && std::holds_alternative<FloatType>(f.retType->v);
@@ -283,7 +289,7 @@ namespace symir {
                 if (it != vars.end() && !it->second.isMutable) {
                   diags.error("Assignment to immutable local: " + arg.lhs.base.name, arg.lhs.span);
                 }
-                auto lt = typeOfLValue(arg.lhs, vars, syms, diags);
+                auto lt = typeOfLValue(arg.lhs, vars, syms, ann, diags);
                 if (lt) {
                   if (std::holds_alternative<PtrType>(lt->v)) {
                     // Pointer assignment: RHS must be ptr T or null
@@ -425,8 +431,8 @@ namespace symir {
   }
 
   TypePtr TypeChecker::typeOfLValue(
-      const LValue &lv, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags
+      const LValue &lv, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags
   ) {
     auto it = vars.find(lv.base.name);
     if (it == vars.end()) {
@@ -480,12 +486,13 @@ namespace symir {
         cur = fit->second;
       }
     }
+    ann.set(lv.id, cur);
     return cur;
   }
 
   void TypeChecker::checkIndex(
-      const Index &idx, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags
+      const Index &idx, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, DiagBag &diags
   ) {
     if (std::holds_alternative<IntLit>(idx))
       return;
@@ -511,8 +518,8 @@ namespace symir {
   }
 
   Ty TypeChecker::typeOfExpr(
-      const Expr &e, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
+      const Expr &e, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
       std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx
   ) {
     auto t = typeOfAtom(e.first, vars, syms, ann, diags, expectedBits, ptrCtx);
@@ -575,15 +582,15 @@ namespace symir {
   }
 
   Ty TypeChecker::typeOfAtom(
-      const Atom &a, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
+      const Atom &a, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags,
       std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx
   ) {
-    return std::visit(
+    Ty ty = std::visit(
         [&](auto &&arg) -> Ty {
           using T = std::decay_t<decltype(arg)>;
           if constexpr (std::is_same_v<T, OpAtom>) {
-            auto rt = typeOfLValue(arg.rval, vars, syms, diags);
+            auto rt = typeOfLValue(arg.rval, vars, syms, ann, diags);
             auto rb = TypeUtils::getBitWidth(rt);
 
             // [v0.2.1] Vector OpAtom: Coef can be a vector LValue of the
@@ -641,7 +648,7 @@ namespace symir {
             }
             return Ty{std::monostate{}};
           } else if constexpr (std::is_same_v<T, UnaryAtom>) {
-            auto rt = typeOfLValue(arg.rval, vars, syms, diags);
+            auto rt = typeOfLValue(arg.rval, vars, syms, ann, diags);
             if (auto rb = TypeUtils::getBitWidth(rt)) {
               return Ty{Ty::BVTy{*rb}};
             }
@@ -727,7 +734,7 @@ namespace symir {
               return Ty{Ty::StructTy{ct}};
             return Ty{std::monostate{}};
           } else if constexpr (std::is_same_v<T, RValueAtom>) {
-            auto rt = typeOfLValue(arg.rval, vars, syms, diags);
+            auto rt = typeOfLValue(arg.rval, vars, syms, ann, diags);
             if (auto rb = TypeUtils::getBitWidth(rt))
               return Ty{Ty::BVTy{*rb}};
             if (rt && std::holds_alternative<FloatType>(rt->v))
@@ -759,10 +766,9 @@ namespace symir {
               }
               // Result type: <N> i1
               auto vt = std::get_if<VecType>(&t1.vecType()->v);
-              auto i1 = std::make_shared<Type>();
-              i1->v = IntType{IntType::Kind::ICustom, 1, {}};
-              auto resVec = std::make_shared<Type>();
-              resVec->v = VecType{vt->size, i1, {}};
+              auto &types = TypeTable::global();
+              auto i1 = types.intern(Type{IntType{IntType::Kind::ICustom, 1, {}}, {}});
+              auto resVec = types.intern(Type{VecType{vt->size, i1, {}}, {}});
               return Ty{Ty::VecTy{resVec}};
             }
             // Scalar cmp: both operands must agree (BV/Float/Ptr); result i1
@@ -783,7 +789,7 @@ namespace symir {
               if (it != syms.end())
                 srcType = it->second.type;
             } else if (auto lv = std::get_if<LValue>(&arg.src)) {
-              srcType = typeOfLValue(*lv, vars, syms, diags);
+              srcType = typeOfLValue(*lv, vars, syms, ann, diags);
             }
 
             // Check destination
@@ -804,11 +810,11 @@ namespace symir {
               }
               return Ty{Ty::VecTy{arg.dstType}};
             }
-            diags.error("Destination of 'as' must be scalar or vector", arg.dstType->span);
+            diags.error("Destination of 'as' must be scalar or vector", arg.dstSpan);
             return Ty{std::monostate{}};
           } else if constexpr (std::is_same_v<T, AddrAtom>) {
             // addr <lv> : result is ptr T where T = type(lv)
-            auto lvTy = typeOfLValue(arg.lv, vars, syms, diags);
+            auto lvTy = typeOfLValue(arg.lv, vars, syms, ann, diags);
             if (!lvTy)
               return Ty{std::monostate{}};
             // v0.2.0 §3.4.2: only a `let mut` local may have its address taken.
@@ -855,11 +861,11 @@ namespace symir {
               if (curT && std::holds_alternative<VecType>(curT->v))
                 diags.error("addr is forbidden on a vector-typed lvalue (§2.11)", arg.span);
             }
-            auto ptrNode = std::make_shared<Type>(PtrType{lvTy, arg.span}, arg.span);
+            auto ptrNode = TypeTable::global().intern(Type{PtrType{lvTy, {}}, {}});
             return Ty{Ty::PtrTy{ptrNode}};
           } else if constexpr (std::is_same_v<T, LoadAtom>) {
             // load <rval> : rval must be ptr T, result type is T
-            auto rvTy = typeOfLValue(arg.rval, vars, syms, diags);
+            auto rvTy = typeOfLValue(arg.rval, vars, syms, ann, diags);
             if (!rvTy)
               return Ty{std::monostate{}};
             auto pt = std::get_if<PtrType>(&rvTy->v);
@@ -892,7 +898,7 @@ namespace symir {
           } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
             // [v0.2.1] §6.8.9: ptrindex <ptr>, <index> where ptr : ptr [N] T,
             // index : iN, result : ptr T.
-            auto rvTy = typeOfLValue(arg.rval, vars, syms, diags);
+            auto rvTy = typeOfLValue(arg.rval, vars, syms, ann, diags);
             if (!rvTy)
               return Ty{std::monostate{}};
             auto pt = std::get_if<PtrType>(&rvTy->v);
@@ -934,12 +940,12 @@ namespace symir {
                 },
                 arg.index
             );
-            auto resultPtr = std::make_shared<Type>(PtrType{at->elem, arg.span}, arg.span);
+            auto resultPtr = TypeTable::global().intern(Type{PtrType{at->elem, {}}, {}});
             return Ty{Ty::PtrTy{resultPtr}};
           } else if constexpr (std::is_same_v<T, PtrFieldAtom>) {
             // [v0.2.1] §6.8.10: ptrfield <ptr>, <fld> where ptr : ptr @S,
             // result : ptr F where F is the declared type of @S.fld.
-            auto rvTy = typeOfLValue(arg.rval, vars, syms, diags);
+            auto rvTy = typeOfLValue(arg.rval, vars, syms, ann, diags);
             if (!rvTy)
               return Ty{std::monostate{}};
             auto pt = std::get_if<PtrType>(&rvTy->v);
@@ -967,24 +973,32 @@ namespace symir {
               );
               return Ty{std::monostate{}};
             }
-            auto resultPtr = std::make_shared<Type>(PtrType{fit->second, arg.span}, arg.span);
+            auto resultPtr = TypeTable::global().intern(Type{PtrType{fit->second, {}}, {}});
             return Ty{Ty::PtrTy{resultPtr}};
           }
           return Ty{std::monostate{}};
         },
         a.v
     );
+    if (ty.isPtr())
+      ann.set(a.id, ty.ptrType());
+    else if (ty.isVec())
+      ann.set(a.id, ty.vecType());
+    else if (ty.isArray())
+      ann.set(a.id, ty.arrayType());
+    else if (ty.isStruct())
+      ann.set(a.id, ty.structType());
+    return ty;
   }
 
   TypePtr TypeChecker::typeOfCoef(
-      const Coef &c, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, DiagBag &diags,
+      const Coef &c, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, DiagBag &diags,
       std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx
   ) {
     if (auto lit = std::get_if<IntLit>(&c)) {
       uint32_t bits = expectedBits.value_or(32);
       checkLiteralRange(lit->value, bits, lit->span, diags);
-      auto t = std::make_shared<Type>();
       IntType it;
       if (bits == 32)
         it.kind = IntType::Kind::I32;
@@ -994,20 +1008,13 @@ namespace symir {
         it.kind = IntType::Kind::ICustom;
         it.bits = bits;
       }
-      it.span = lit->span;
-      t->v = it;
-      t->span = lit->span;
-      return t;
+      return TypeTable::global().intern(Type{it, {}});
     }
-    if (auto flit = std::get_if<FloatLit>(&c)) {
+    if (std::holds_alternative<FloatLit>(c)) {
       uint32_t bits = expectedBits.value_or(32);
-      auto t = std::make_shared<Type>();
       FloatType ft;
       ft.kind = (bits == 64) ? FloatType::Kind::F64 : FloatType::Kind::F32;
-      ft.span = flit->span;
-      t->v = ft;
-      t->span = flit->span;
-      return t;
+      return TypeTable::global().intern(Type{ft, {}});
     }
     if (auto nl = std::get_if<NullLit>(&c)) {
       if (ptrCtx && std::holds_alternative<PtrType>(ptrCtx->v))
@@ -1043,13 +1050,13 @@ namespace symir {
   }
 
   Ty TypeChecker::typeOfSelectVal(
-      const SelectVal &sv, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, [[maybe_unused]] TypeAnnotations &ann,
+      const SelectVal &sv, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, [[maybe_unused]] TypeAnnotations &ann,
       DiagBag &diags, std::optional<std::uint32_t> expectedBits, TypePtr ptrCtx
   ) {
     TypePtr t;
     if (auto rv = std::get_if<RValue>(&sv)) {
-      t = typeOfLValue(*rv, vars, syms, diags);
+      t = typeOfLValue(*rv, vars, syms, ann, diags);
     } else {
       t = typeOfCoef(std::get<Coef>(sv), vars, syms, diags, expectedBits, ptrCtx);
     }
@@ -1076,8 +1083,8 @@ namespace symir {
   }
 
   void TypeChecker::checkCond(
-      const Cond &c, const std::unordered_map<std::string, VarInfo> &vars,
-      const std::unordered_map<std::string, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags
+      const Cond &c, const std::unordered_map<Symbol, VarInfo> &vars,
+      const std::unordered_map<Symbol, SymInfo> &syms, TypeAnnotations &ann, DiagBag &diags
   ) {
     auto t1 = typeOfExpr(c.lhs, vars, syms, ann, diags, std::nullopt);
     // If LHS is a pointer, pass it as ptrCtx for RHS (null inference)
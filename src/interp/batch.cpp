@@ -0,0 +1,974 @@
+#include <algorithm>
+#include <cfenv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "analysis/type_utils.hpp"
+#include "error.hpp"
+#include "interp/bytecode.hpp"
+#include "interp/interpreter.hpp"
+#include "timing.hpp"
+
+// Lock-step runs of one bytecode function over many bindings (callBatch()).
+// Each frame slot becomes a column with one lane per binding, and an
+// instruction runs as a loop over the lanes of a group: the bindings that
+// reached it together. A conditional jump splits its group by the outcome
+// of each lane, and the pending groups run smallest (block in reverse
+// postorder, instruction) first, so lanes that took different arms meet
+// again at the join and merge into one group. The lane loops are plain
+// and branch-free where they can be, so the compiler vectorizes them as it
+// does the kernels of vector.cpp; a lane that trips UB gets a code in a
+// flags array and leaves its group with the message call() would report
+// for it, after the checks that precede it on the scalar path.
+
+namespace symir {
+
+  namespace {
+
+    enum class ColumnKind : std::uint8_t { Undef, Int, Float };
+
+    // One frame slot across the lanes. `kind` and `bits` are those of
+    // every lane not flagged undef.
+    struct Column {
+      ColumnKind kind = ColumnKind::Undef;
+      std::uint16_t bits = 64;
+      std::vector<std::int64_t> ints;
+      std::vector<double> floats;
+      std::vector<std::uint8_t> undef;
+
+      explicit Column(std::size_t n = 0) : ints(n), floats(n), undef(n, 1) {}
+    };
+
+    // Lanes that would need different kinds or widths in one column; the
+    // rows are then run one call() at a time.
+    struct Diverged {};
+
+    std::int64_t canonicalLane(std::int64_t x, unsigned bits) {
+      if (bits >= 64)
+        return x;
+      unsigned sh = 64 - bits;
+      return static_cast<std::int64_t>(static_cast<std::uint64_t>(x) << sh) >> sh;
+    }
+
+    // Sign-extends every lane from `bits`.
+    void canonicalLanes(std::int64_t *x, std::size_t n, unsigned bits) {
+      if (bits >= 64)
+        return;
+      unsigned sh = 64 - bits;
+      for (std::size_t k = 0; k < n; ++k)
+        x[k] = static_cast<std::int64_t>(static_cast<std::uint64_t>(x[k]) << sh) >> sh;
+    }
+
+    std::int64_t smaxOf(unsigned bits) {
+      return bits >= 64 ? INT64_MAX : (INT64_C(1) << (bits - 1)) - 1;
+    }
+
+    std::int64_t sminOf(unsigned bits) {
+      return bits >= 64 ? INT64_MIN : -(INT64_C(1) << (bits - 1));
+    }
+
+    bool isFloatPair(const Column &a, const Column &b) {
+      return (a.kind == ColumnKind::Float && b.kind != ColumnKind::Undef) ||
+             (a.kind == ColumnKind::Int && b.kind == ColumnKind::Float);
+    }
+
+    // Messages by UB code of the lane kernels; code 0 is no UB.
+    constexpr const char *kNoUb[] = {""};
+    constexpr const char *kMulUb[] = {"", "UB: Signed integer overflow in multiplication"};
+    constexpr const char *kDivUb[] = {
+        "", "UB: Division by zero", "UB: Signed integer overflow in division"
+    };
+    constexpr const char *kModUb[] = {
+        "", "UB: Modulo by zero", "UB: Signed integer overflow in modulo"
+    };
+    constexpr const char *kShiftUb[] = {
+        "", "UB: Overshift", "UB: Left shift of negative", "UB: Signed integer overflow in shift"
+    };
+    constexpr const char *kFloatUb[] = {
+        "", "UB: Floating-point result is infinity", "UB: Floating-point result is NaN"
+    };
+
+    // Calls `f` with the comparison of `op`, so the lane loop inside `f`
+    // has no switch.
+    template<typename F> void withRelation(RelOp op, F &&f) {
+      switch (op) {
+        case RelOp::EQ:
+          return f(std::equal_to<>{});
+        case RelOp::NE:
+          return f(std::not_equal_to<>{});
+        case RelOp::LT:
+          return f(std::less<>{});
+        case RelOp::LE:
+          return f(std::less_equal<>{});
+        case RelOp::GT:
+          return f(std::greater<>{});
+        case RelOp::GE:
+          return f(std::greater_equal<>{});
+      }
+    }
+
+  } // namespace
+
+  struct Interpreter::Lockstep {
+    using Op = Bytecode::Op;
+    using Operand = Bytecode::Operand;
+    using Instr = Bytecode::Instr;
+    using Status = CallResult::Status;
+    using Mask = std::vector<std::uint8_t>;
+    using Key = std::pair<std::uint32_t, std::uint32_t>; // (block rank, ip)
+
+    const Bytecode &bc;
+    std::size_t n;
+    CallResult *results; // by lane
+    std::vector<Column> frame;
+    std::vector<Column> consts; // bc.consts, splat
+    std::vector<std::uint32_t> rank; // by ip: reverse postorder of its block
+    std::map<Key, Mask> pending;
+    Mask waiting;            // lanes of the pending groups
+    bool waitingMid = false; // some group waits inside an instruction
+    bool loaded = false;     // some lane was loaded
+    // Scratch of one instruction
+    std::vector<std::int64_t> zi;
+    std::vector<double> zf, yf;
+    std::vector<std::uint8_t> bad;
+    Mask other;
+    std::vector<std::uint64_t> steps; // by lane
+    // Budget of each lane; a lane is charged the time its groups run
+    Budget budget;
+    std::vector<std::chrono::nanoseconds> spent; // by lane
+    std::chrono::steady_clock::time_point mark;  // last charge
+    std::uint64_t unclocked = 0;                 // blocks entered since `mark`
+
+    // Whether `bc` only moves scalars between slots: no lvalue paths, and
+    // no constants other than numbers and undef.
+    static bool supports(const Bytecode &bc) {
+      for (const auto &in: bc.code) {
+        if (in.op == Op::SetPath || in.a.kind == Operand::Kind::Path ||
+            in.b.kind == Operand::Kind::Path)
+          return false;
+      }
+      for (const auto &c: bc.consts) {
+        if (c.kind != RuntimeValue::Kind::Int && c.kind != RuntimeValue::Kind::Float &&
+            c.kind != RuntimeValue::Kind::Undef)
+          return false;
+      }
+      return true;
+    }
+
+    Lockstep(
+        const Bytecode &code, const CFG &cfg, std::vector<CallResult> &out, Budget limits
+    )
+        : bc(code), n(out.size()), results(out.data()), frame(code.frameSize, Column(n)),
+          rank(code.code.size()), waiting(n), zi(n), zf(n), yf(n), bad(n), other(n), steps(n),
+          budget(limits), spent(n) {
+      for (const auto &c: bc.consts) {
+        Column col(n);
+        col.bits = c.bits;
+        if (c.kind != RuntimeValue::Kind::Undef) {
+          col.kind = c.kind == RuntimeValue::Kind::Int ? ColumnKind::Int : ColumnKind::Float;
+          std::fill(col.ints.begin(), col.ints.end(), c.intVal);
+          std::fill(col.floats.begin(), col.floats.end(), c.floatVal);
+          std::fill(col.undef.begin(), col.undef.end(), 0);
+        }
+        consts.push_back(std::move(col));
+      }
+      std::vector<std::uint32_t> blockRank(cfg.blocks.size(), UINT32_MAX);
+      auto order = cfg.rpo();
+      for (std::size_t i = 0; i < order.size(); ++i)
+        blockRank[order[i]] = static_cast<std::uint32_t>(i);
+      std::uint32_t cur = UINT32_MAX;
+      for (std::size_t ip = 0; ip < bc.code.size(); ++ip) {
+        if (bc.code[ip].op == Op::Enter && bc.code[ip].dst < blockRank.size())
+          cur = blockRank[bc.code[ip].dst];
+        rank[ip] = cur;
+      }
+    }
+
+    // Moves the frame bound for lane `k` into the columns; false if some
+    // local is not a scalar, or differs in kind or width from another lane.
+    bool load(std::size_t k, const Store &store) {
+      for (std::size_t i = 0; i < bc.slotNames.size(); ++i) {
+        const RuntimeValue &v = store.at(bc.slotNames[i]);
+        Column &col = frame[i];
+        ColumnKind kind;
+        if (v.kind == RuntimeValue::Kind::Int)
+          kind = ColumnKind::Int;
+        else if (v.kind == RuntimeValue::Kind::Float)
+          kind = ColumnKind::Float;
+        else if (v.kind == RuntimeValue::Kind::Undef)
+          kind = ColumnKind::Undef;
+        else
+          return false;
+        if (!loaded)
+          col.bits = v.bits;
+        else if (col.bits != v.bits)
+          return false;
+        if (kind != ColumnKind::Undef) {
+          if (col.kind != ColumnKind::Undef && col.kind != kind)
+            return false;
+          col.kind = kind;
+        }
+        col.ints[k] = v.intVal;
+        col.floats[k] = v.floatVal;
+        col.undef[k] = kind == ColumnKind::Undef;
+      }
+      loaded = true;
+      return true;
+    }
+
+    // --- Lanes leaving their group ---
+
+    static bool any(const Mask &m) { return std::find(m.begin(), m.end(), 1) != m.end(); }
+
+    void fail(Mask &m, std::size_t k, Status status, const std::string &msg) {
+      results[k].status = status;
+      results[k].message = msg;
+      m[k] = 0;
+    }
+
+    // Fails every lane whose `bad` code is nonzero with `msgs[code]`;
+    // false if no lane is left.
+    bool retire(Mask &m, Status status, const char *const *msgs) {
+      const std::uint8_t *mk = m.data(), *bd = bad.data();
+      std::uint8_t hit = 0;
+      for (std::size_t k = 0; k < n; ++k)
+        hit |= mk[k] & (bd[k] != 0);
+      if (!hit)
+        return true;
+      for (std::size_t k = 0; k < n; ++k) {
+        if (m[k] && bad[k])
+          fail(m, k, status, msgs[bad[k]]);
+      }
+      return any(m);
+    }
+
+    bool failAll(Mask &m, Status status, const std::string &msg) {
+      for (std::size_t k = 0; k < n; ++k) {
+        if (m[k])
+          fail(m, k, status, msg);
+      }
+      return false;
+    }
+
+    // Charges the time since `mark` to the lanes of `m`.
+    void charge(const Mask &m) {
+      auto now = std::chrono::steady_clock::now();
+      for (std::size_t k = 0; k < n; ++k) {
+        if (m[k])
+          spent[k] += now - mark;
+      }
+      mark = now;
+      unclocked = 0;
+    }
+
+    // At a block entry of `m`: fails the lanes out of budget, like
+    // Interpreter::budgetCheck(); false if no lane is left.
+    bool withinBudget(Mask &m) {
+      if (budget.maxSteps) {
+        for (std::size_t k = 0; k < n; ++k) {
+          if (m[k] && steps[k] >= budget.maxSteps)
+            fail(
+                m, k, Status::BudgetExhausted,
+                "Step budget exhausted after " + std::to_string(steps[k]) + " blocks"
+            );
+        }
+      }
+      if (budget.maxMs && ++unclocked >= kClockBlocks) {
+        charge(m);
+        for (std::size_t k = 0; k < n; ++k) {
+          if (m[k] && spent[k] >= std::chrono::milliseconds(budget.maxMs))
+            fail(
+                m, k, Status::BudgetExhausted,
+                "Time budget of " + std::to_string(budget.maxMs) + " ms exhausted after " +
+                    std::to_string(steps[k]) + " blocks"
+            );
+        }
+      }
+      return any(m);
+    }
+
+    // UB `msg` in the lanes undef in `a` (or `b`).
+    bool retireUndef(Mask &m, const char *msg, const Column &a, const Column *b = nullptr) {
+      const std::uint8_t *mk = m.data(), *x = a.undef.data(), *y = (b ? *b : a).undef.data();
+      std::uint8_t hit = 0;
+      for (std::size_t k = 0; k < n; ++k)
+        hit |= mk[k] & (x[k] | y[k]);
+      if (!hit)
+        return true;
+      std::uint8_t *bd = bad.data();
+      for (std::size_t k = 0; k < n; ++k)
+        bd[k] = x[k] | y[k];
+      const char *msgs[] = {"", msg};
+      return retire(m, Status::UndefinedBehavior, msgs);
+    }
+
+    // --- Operands and results ---
+
+    // The column of `o`; lanes reading undef through a checked operand
+    // fail. Null if no lane is left.
+    const Column *read(const Operand &o, Mask &m) {
+      const Column &col = o.kind == Operand::Kind::Const ? consts[o.index] : frame[o.index];
+      if (o.checked && !retireUndef(m, "UB: Reading undef value", col))
+        return nullptr;
+      return &col;
+    }
+
+    // Slot `dst`, retyped for a result of `kind` and `bits`. Lanes outside
+    // the group keep their values, so that is only allowed while none of
+    // them can still read the slot.
+    Column &define(std::uint32_t dst, ColumnKind kind, std::uint16_t bits) {
+      Column &c = frame[dst];
+      if (c.kind == kind && c.bits == bits)
+        return c;
+      if (c.kind != ColumnKind::Undef || c.bits != bits) {
+        bool named = dst < bc.slotNames.size();
+        if (named ? any(waiting) : waitingMid)
+          throw Diverged{};
+      }
+      c.kind = kind;
+      c.bits = bits;
+      return c;
+    }
+
+    // The lanes of `m` in `dst` become `zi` (or `zf`).
+    void writeInts(Column &dst, const Mask &m) {
+      const std::uint8_t *mk = m.data();
+      const std::int64_t *z = zi.data();
+      std::int64_t *d = dst.ints.data();
+      std::uint8_t *u = dst.undef.data();
+      for (std::size_t k = 0; k < n; ++k) {
+        d[k] = mk[k] ? z[k] : d[k];
+        u[k] &= !mk[k];
+      }
+    }
+
+    void writeFloats(Column &dst, const Mask &m) {
+      const std::uint8_t *mk = m.data();
+      const double *z = zf.data();
+      double *d = dst.floats.data();
+      std::uint8_t *u = dst.undef.data();
+      for (std::size_t k = 0; k < n; ++k) {
+        d[k] = mk[k] ? z[k] : d[k];
+        u[k] &= !mk[k];
+      }
+    }
+
+    // The lanes of `m` in `dst` become those of `src`, undef included;
+    // `assign` keeps the width of `dst`, as assignValue() does.
+    void blend(Column &dst, const Column &src, const Mask &m, bool assign) {
+      const std::uint8_t *mk = m.data(), *su = src.undef.data();
+      const std::int64_t *si = src.ints.data();
+      const double *sf = src.floats.data();
+      std::int64_t *di = dst.ints.data();
+      double *df = dst.floats.data();
+      std::uint8_t *du = dst.undef.data();
+      unsigned bits = assign ? dst.bits : 64;
+      bool round = assign && dst.kind == ColumnKind::Float && dst.bits == 32;
+      for (std::size_t k = 0; k < n; ++k) {
+        std::int64_t i = canonicalLane(si[k], bits);
+        double f = round ? static_cast<double>(static_cast<float>(sf[k])) : sf[k];
+        di[k] = mk[k] ? i : di[k];
+        df[k] = mk[k] ? f : df[k];
+        du[k] = mk[k] ? su[k] : du[k];
+      }
+    }
+
+    // The lanes of `c` as doubles, into `out`.
+    void floatsOf(const Column &c, double *out) const {
+      if (c.kind == ColumnKind::Float) {
+        std::copy(c.floats.begin(), c.floats.end(), out);
+      } else {
+        const std::int64_t *x = c.ints.data();
+        for (std::size_t k = 0; k < n; ++k)
+          out[k] = static_cast<double>(x[k]);
+      }
+    }
+
+    // Rounds `zf` to f32 if `bits` is 32, then flags code 1 for an
+    // infinite lane and 2 for a NaN one.
+    void finishFloats(unsigned bits) {
+      double *z = zf.data();
+      std::uint8_t *bd = bad.data();
+      if (bits == 32) {
+        for (std::size_t k = 0; k < n; ++k)
+          z[k] = static_cast<double>(static_cast<float>(z[k]));
+      }
+      for (std::size_t k = 0; k < n; ++k)
+        bd[k] = std::isinf(z[k]) ? 1 : std::isnan(z[k]) ? 2 : 0;
+    }
+
+    // --- Instructions ---
+
+    bool apply(const Instr &in, Mask &m) {
+      const Column *c = read(in.a, m);
+      const Column *r = c ? read(in.b, m) : nullptr;
+      if (!r || !retireUndef(m, "UB: Reading undef in op", *c, r))
+        return false;
+      auto op = static_cast<AtomOpKind>(in.sub);
+      if (c->kind == ColumnKind::Int && r->kind == ColumnKind::Int) {
+        unsigned bits = c->bits;
+        std::int64_t smax = smaxOf(bits), smin = sminOf(bits);
+        const std::int64_t *x = c->ints.data(), *y = r->ints.data();
+        std::int64_t *z = zi.data();
+        std::uint8_t *bd = bad.data();
+        const char *const *msgs = kNoUb;
+        std::fill(bad.begin(), bad.end(), 0);
+        switch (op) {
+          case AtomOpKind::Mul:
+            for (std::size_t k = 0; k < n; ++k) {
+              __int128 p = static_cast<__int128>(x[k]) * y[k];
+              bd[k] = p > smax || p < smin;
+              z[k] = static_cast<std::int64_t>(p);
+            }
+            msgs = kMulUb;
+            break;
+          case AtomOpKind::Div:
+          case AtomOpKind::Mod:
+            for (std::size_t k = 0; k < n; ++k) {
+              bool zero = y[k] == 0, ov = x[k] == smin && y[k] == -1;
+              bd[k] = zero ? 1 : ov ? 2 : 0;
+              // Lanes outside the group hold anything; keep them from trapping.
+              std::int64_t d = zero || (y[k] == -1 && x[k] == INT64_MIN) ? 1 : y[k];
+              z[k] = op == AtomOpKind::Div ? x[k] / d : x[k] % d;
+            }
+            msgs = op == AtomOpKind::Div ? kDivUb : kModUb;
+            break;
+          case AtomOpKind::And:
+            for (std::size_t k = 0; k < n; ++k)
+              z[k] = x[k] & y[k];
+            break;
+          case AtomOpKind::Or:
+            for (std::size_t k = 0; k < n; ++k)
+              z[k] = x[k] | y[k];
+            break;
+          case AtomOpKind::Xor:
+            for (std::size_t k = 0; k < n; ++k)
+              z[k] = x[k] ^ y[k];
+            break;
+          case AtomOpKind::Shl:
+          case AtomOpKind::Shr:
+          case AtomOpKind::LShr: {
+            std::uint64_t mask = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+            for (std::size_t k = 0; k < n; ++k) {
+              bool over = y[k] < 0 || static_cast<std::uint64_t>(y[k]) >= bits;
+              unsigned sh = over ? 0 : static_cast<unsigned>(y[k]);
+              if (op == AtomOpKind::Shl) {
+                __int128 p = static_cast<__int128>(x[k]) << sh;
+                bd[k] = over ? 1 : x[k] < 0 ? 2 : p > smax || p < smin ? 3 : 0;
+                z[k] = static_cast<std::int64_t>(p);
+              } else {
+                std::uint64_t u = static_cast<std::uint64_t>(x[k]) & mask;
+                bd[k] = over;
+                z[k] = op == AtomOpKind::Shr ? x[k] >> sh : static_cast<std::int64_t>(u >> sh);
+              }
+            }
+            msgs = kShiftUb;
+            break;
+          }
+        }
+        if (!retire(m, Status::UndefinedBehavior, msgs))
+          return false;
+        canonicalLanes(z, n, bits);
+        writeInts(define(in.dst, ColumnKind::Int, bits), m);
+        return true;
+      }
+      if (isFloatPair(*c, *r)) {
+        if (op != AtomOpKind::Mul && op != AtomOpKind::Div && op != AtomOpKind::Mod)
+          return failAll(m, Status::Error, "Unsupported op for floats");
+        unsigned bits = std::min(c->bits, r->bits);
+        double *z = zf.data(), *y = yf.data();
+        floatsOf(*c, z);
+        floatsOf(*r, y);
+        if (op == AtomOpKind::Mul) {
+          for (std::size_t k = 0; k < n; ++k)
+            z[k] *= y[k];
+        } else if (op == AtomOpKind::Div) {
+          for (std::size_t k = 0; k < n; ++k)
+            z[k] /= y[k];
+        } else {
+          for (std::size_t k = 0; k < n; ++k)
+            z[k] = std::fmod(z[k], y[k]);
+        }
+        finishFloats(bits);
+        if (!retire(m, Status::UndefinedBehavior, kFloatUb))
+          return false;
+        writeFloats(define(in.dst, ColumnKind::Float, static_cast<std::uint16_t>(bits)), m);
+        return true;
+      }
+      return failAll(m, Status::Error, "OpAtom requires same scalar kinds");
+    }
+
+    bool addSub(const Instr &in, Mask &m) {
+      const Column *b = read(in.b, m);
+      const Column &v = frame[in.dst];
+      if (!b || !retireUndef(m, "UB: Reading undef in expr", v, b))
+        return false;
+      bool plus = static_cast<AddOp>(in.sub) == AddOp::Plus;
+      if (v.kind == ColumnKind::Int && b->kind == ColumnKind::Int) {
+        unsigned bits = v.bits;
+        std::int64_t smax = smaxOf(bits), smin = sminOf(bits);
+        const std::int64_t *x = v.ints.data(), *y = b->ints.data();
+        std::int64_t *z = zi.data();
+        std::uint8_t *bd = bad.data();
+        // Wrapping arithmetic; a narrower sum cannot wrap, so its range is
+        // checked instead.
+        for (std::size_t k = 0; k < n; ++k) {
+          auto ux = static_cast<std::uint64_t>(x[k]), uy = static_cast<std::uint64_t>(y[k]);
+          std::int64_t s = static_cast<std::int64_t>(plus ? ux + uy : ux - uy);
+          bool wrapped = plus ? ((x[k] ^ s) & (y[k] ^ s)) < 0 : ((x[k] ^ y[k]) & (x[k] ^ s)) < 0;
+          bd[k] = bits >= 64 ? wrapped : s > smax || s < smin;
+          z[k] = s;
+        }
+        const char *msgs[] = {
+            "", plus ? "UB: Signed integer overflow in addition"
+                     : "UB: Signed integer overflow in subtraction"
+        };
+        if (!retire(m, Status::UndefinedBehavior, msgs))
+          return false;
+        writeInts(frame[in.dst], m);
+        return true;
+      }
+      if (isFloatPair(v, *b)) {
+        unsigned bits = std::min(v.bits, b->bits);
+        double *z = zf.data(), *y = yf.data();
+        floatsOf(v, z);
+        floatsOf(*b, y);
+        if (plus) {
+          for (std::size_t k = 0; k < n; ++k)
+            z[k] += y[k];
+        } else {
+          for (std::size_t k = 0; k < n; ++k)
+            z[k] -= y[k];
+        }
+        finishFloats(bits);
+        if (!retire(m, Status::UndefinedBehavior, kFloatUb))
+          return false;
+        writeFloats(define(in.dst, ColumnKind::Float, static_cast<std::uint16_t>(bits)), m);
+        return true;
+      }
+      return failAll(m, Status::Error, "Expr ops only on same scalar kinds (Int/Float)");
+    }
+
+    bool cast(const Instr &in, Mask &m) {
+      const Column *v = read(in.a, m);
+      if (!v || !retireUndef(m, "UB: Reading undef in cast", *v))
+        return false;
+      const TypePtr &type = bc.types[in.target];
+      std::uint8_t *bd = bad.data();
+      if (auto bits = TypeUtils::getBitWidth(type)) {
+        std::int64_t *z = zi.data();
+        std::fill(bad.begin(), bad.end(), 0);
+        if (v->kind == ColumnKind::Int) {
+          std::copy(v->ints.begin(), v->ints.end(), z);
+          canonicalLanes(z, n, *bits);
+        } else {
+          // Valid range [lo, hi), as in castScalar().
+          double lo = -std::ldexp(1.0, static_cast<int>(*bits) - 1);
+          double hi = std::ldexp(1.0, static_cast<int>(*bits) - 1);
+          const double *x = v->floats.data();
+          for (std::size_t k = 0; k < n; ++k) {
+            bool out = !(x[k] >= lo && x[k] < hi);
+            bd[k] = out;
+            z[k] = out ? 0 : static_cast<std::int64_t>(x[k]);
+          }
+        }
+        const char *msgs[] = {"", "UB: Float-to-integer cast out of range"};
+        if (!retire(m, Status::UndefinedBehavior, msgs))
+          return false;
+        writeInts(define(in.dst, ColumnKind::Int, static_cast<std::uint16_t>(*bits)), m);
+      } else if (type && std::holds_alternative<FloatType>(type->v)) {
+        bool isF32 = std::get<FloatType>(type->v).kind == FloatType::Kind::F32;
+        double *z = zf.data();
+        floatsOf(*v, z);
+        for (std::size_t k = 0; k < n; ++k) {
+          if (isF32)
+            z[k] = static_cast<double>(static_cast<float>(z[k]));
+          bd[k] = isF32 && std::isinf(z[k]);
+        }
+        const char *msgs[] = {"", "UB: Float narrowing cast overflows to infinity"};
+        if (!retire(m, Status::UndefinedBehavior, msgs))
+          return false;
+        writeFloats(define(in.dst, ColumnKind::Float, isF32 ? 32 : 64), m);
+      } else {
+        Column &dst = define(in.dst, ColumnKind::Undef, 64);
+        for (std::size_t k = 0; k < n; ++k)
+          dst.undef[k] |= m[k];
+      }
+      return true;
+    }
+
+    // Whether `a <op> b` holds, into `out`, for the lanes of `m` (0
+    // elsewhere). The i1 operands of a condition compare masked.
+    void compare(RelOp op, const Column &a, const Column &b, const Mask &m, std::uint8_t *out,
+                 bool maskI1) {
+      const std::uint8_t *mk = m.data();
+      if (a.kind == ColumnKind::Float || b.kind == ColumnKind::Float) {
+        double *x = zf.data(), *y = yf.data();
+        floatsOf(a, x);
+        floatsOf(b, y);
+        withRelation(op, [&](auto rel) {
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = mk[k] & rel(x[k], y[k]);
+        });
+      } else {
+        std::int64_t am = maskI1 && a.bits == 1 ? 1 : -1, bm = maskI1 && b.bits == 1 ? 1 : -1;
+        const std::int64_t *x = a.ints.data(), *y = b.ints.data();
+        withRelation(op, [&](auto rel) {
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = mk[k] & rel(x[k] & am, y[k] & bm);
+        });
+      }
+    }
+
+    // The lanes of `m` for which `a <sub> b` holds, into `t`.
+    bool test(const Instr &in, Mask &m, Mask &t) {
+      const Column *l = read(in.a, m);
+      const Column *r = l ? read(in.b, m) : nullptr;
+      if (!r || !retireUndef(m, "UB: Reading undef in condition", *l, r))
+        return false;
+      bool ints = l->kind == ColumnKind::Int && r->kind == ColumnKind::Int;
+      if (!ints && !isFloatPair(*l, *r))
+        return failAll(m, Status::Error, "Cond operands must be same scalar kind");
+      t.resize(n);
+      compare(static_cast<RelOp>(in.sub), *l, *r, m, t.data(), true);
+      return true;
+    }
+
+    // The key of the group waiting at `ip`.
+    Key keyOf(std::uint32_t ip) const { return {rank[ip], ip}; }
+
+    void push(std::uint32_t ip, const Mask &m) {
+      if (!any(m))
+        return;
+      auto [it, fresh] = pending.try_emplace(keyOf(ip), m);
+      if (!fresh) {
+        for (std::size_t k = 0; k < n; ++k)
+          it->second[k] |= m[k];
+      }
+    }
+
+    // Whether the group can go on at `ip` rather than wait: no pending
+    // group comes first or could merge with it.
+    bool runsNext(std::uint32_t ip) const {
+      return pending.empty() || keyOf(ip) < pending.begin()->first;
+    }
+
+    // Sends the lanes of `m` to `target` where `t` holds and to `alt`
+    // elsewhere. Returns whether the group goes on, at `ip`.
+    bool
+    branch(std::uint32_t &ip, Mask &m, const Mask &t, std::uint32_t target, std::uint32_t alt) {
+      Mask &f = other;
+      const std::uint8_t *mk = m.data(), *tk = t.data();
+      std::uint8_t *fk = f.data();
+      std::uint8_t anyT = 0, anyF = 0;
+      for (std::size_t k = 0; k < n; ++k) {
+        fk[k] = mk[k] & !tk[k];
+        anyT |= tk[k];
+        anyF |= fk[k];
+      }
+      if (!anyF || !anyT) {
+        std::uint32_t next = anyT ? target : alt;
+        if (runsNext(next)) {
+          ip = next;
+          return true;
+        }
+        push(next, m);
+        return false;
+      }
+      push(target, t);
+      push(alt, f);
+      return false;
+    }
+
+    // Runs the group `m` from `ip` until it waits, returns or fails.
+    void runGroup(std::uint32_t ip, Mask &m) {
+      Mask t;
+      for (;;) {
+        const Instr &in = bc.code[ip++];
+        switch (in.op) {
+          case Op::Enter: {
+            if ((budget.maxSteps || budget.maxMs) && !withinBudget(m))
+              return;
+            const std::uint8_t *mk = m.data();
+            std::uint64_t *st = steps.data();
+            for (std::size_t k = 0; k < n; ++k)
+              st[k] += mk[k];
+            break;
+          }
+          case Op::Move: {
+            const Column *a = read(in.a, m);
+            if (!a)
+              return;
+            Column &dst = define(in.dst, a->kind, a->bits);
+            blend(dst, *a, m, false);
+            break;
+          }
+          case Op::Apply:
+            if (!apply(in, m))
+              return;
+            break;
+          case Op::Not: {
+            const Column *a = read(in.a, m);
+            if (!a || !retireUndef(m, "UB: Reading undef in unary op", *a))
+              return;
+            if (a->kind != ColumnKind::Int) {
+              failAll(m, Status::Error, "Unary op requires int");
+              return;
+            }
+            for (std::size_t k = 0; k < n; ++k)
+              zi[k] = ~a->ints[k];
+            writeInts(define(in.dst, ColumnKind::Int, 64), m);
+            break;
+          }
+          case Op::Cmp: {
+            const Column *l = read(in.a, m);
+            const Column *r = l ? read(in.b, m) : nullptr;
+            if (!r || !retireUndef(m, "UB: undef in cmp", *l, r))
+              return;
+            compare(static_cast<RelOp>(in.sub), *l, *r, m, bad.data(), false);
+            for (std::size_t k = 0; k < n; ++k)
+              zi[k] = bad[k];
+            writeInts(define(in.dst, ColumnKind::Int, 1), m);
+            break;
+          }
+          case Op::Cast:
+            if (!cast(in, m))
+              return;
+            break;
+          case Op::AddSub:
+            if (!addSub(in, m))
+              return;
+            break;
+          case Op::Set: {
+            const Column *a = read(in.a, m);
+            if (!a)
+              return;
+            Column &cur = frame[in.dst];
+            if (a->kind != ColumnKind::Undef)
+              define(in.dst, a->kind, cur.bits);
+            blend(cur, *a, m, true);
+            break;
+          }
+          case Op::SetPath:
+            throw Diverged{}; // excluded by supports()
+          case Op::Jump:
+          case Op::Br:
+            if (!runsNext(in.target)) {
+              push(in.target, m);
+              return;
+            }
+            ip = in.target;
+            break;
+          case Op::CondJump:
+          case Op::CondBr:
+            if (!test(in, m, t) || !branch(ip, m, t, in.target, in.alt))
+              return;
+            break;
+          case Op::MaskJump: {
+            const Column *a = read(in.a, m);
+            if (!a || !retireUndef(m, "UB: undef scalar mask", *a))
+              return;
+            t.resize(n);
+            for (std::size_t k = 0; k < n; ++k)
+              t[k] = m[k] & (a->ints[k] != 0);
+            if (!branch(ip, m, t, in.target, in.alt))
+              return;
+            break;
+          }
+          case Op::Assume:
+          case Op::Require:
+            if (!test(in, m, t))
+              return;
+            for (std::size_t k = 0; k < n; ++k) {
+              if (m[k] && !t[k]) {
+                if (in.op == Op::Assume)
+                  fail(m, k, Status::Error, "Assumption failed");
+                else
+                  fail(m, k, Status::RequireViolation, bc.messages[in.target]);
+              }
+            }
+            if (!any(m))
+              return;
+            break;
+          case Op::Ret: {
+            const Column *a = read(in.a, m);
+            if (!a || !retireUndef(m, "UB: Reading undef in ret", *a))
+              return;
+            for (std::size_t k = 0; k < n; ++k) {
+              if (!m[k])
+                continue;
+              if (a->kind == ColumnKind::Int)
+                results[k].value = a->ints[k];
+              else
+                results[k].value = a->floats[k];
+            }
+            return;
+          }
+          case Op::RetVoid:
+            return;
+          case Op::Unreachable:
+            failAll(m, Status::Error, "Reached unreachable");
+            return;
+        }
+      }
+    }
+
+    // Runs `lanes` to completion.
+    void run(const Mask &lanes) {
+      push(bc.entry, lanes);
+      while (!pending.empty()) {
+        auto it = pending.begin();
+        std::uint32_t ip = it->first.second;
+        Mask m = std::move(it->second);
+        pending.erase(it);
+        std::fill(waiting.begin(), waiting.end(), 0);
+        waitingMid = false;
+        for (const auto &[key, group]: pending) {
+          for (std::size_t k = 0; k < n; ++k)
+            waiting[k] |= group[k];
+          waitingMid |= bc.code[key.second].op != Op::Enter;
+        }
+        if (!budget.maxMs) {
+          runGroup(ip, m);
+          continue;
+        }
+        // Lanes leaving the group to wait are charged for it too.
+        Mask group = m;
+        mark = std::chrono::steady_clock::now();
+        unclocked = 0;
+        runGroup(ip, m);
+        charge(group);
+      }
+      for (std::size_t k = 0; k < n; ++k) {
+        if (lanes[k])
+          results[k].steps = steps[k];
+      }
+    }
+  };
+
+  bool Interpreter::checkpoint(const PreparedFunction &fn, Checkpoint &cp) {
+    const FunDecl &f = *fn.fun;
+    if (!f.params.empty() || blockLog_)
+      return false;
+    const SymPrefix &prefix = analyses_->symPrefix(f);
+    CallResult res = guardedCall([&](RuntimeValue &) {
+      prefix_ = &prefix;
+      struct PrefixScope {
+        const SymPrefix *&active;
+        ~PrefixScope() { active = nullptr; }
+      } scope{prefix_};
+      cp.prefix = &prefix;
+      cp.store = enterFrame(f, {});
+      cp.lets = prefix.numLets();
+      for (std::size_t k = 0; k < cp.lets; ++k)
+        if (!prefix.deferred(k))
+          bindLets(f, k, k + 1, cp.store);
+      // Stops on entering the block the prefix ends at, the entry block
+      // included, before counting it.
+      execAst(f, *fn.cfg, cp.store, nullptr, nullptr);
+      cp.pc = prefixEnd_;
+    });
+    if (res.status != CallResult::Status::Returned)
+      return false;
+    cp.steps = res.steps;
+    if (cp.store.empty() && cp.steps == 0)
+      return false;
+    cp.mem = mem_;
+    cp.defined = defined_;
+    cp.ptrCells = ptrCells_;
+    cp.objects = objects_;
+    cp.byBase = byBase_;
+    cp.parent = parent_;
+    cp.nested = nested_;
+    cp.addrMap = addrMap_;
+    cp.nextAddr = nextAddr_;
+    cp.nextProvId = nextProvId_;
+    return true;
+  }
+
+  Interpreter::CallResult Interpreter::fork(
+      const PreparedFunction &fn, const Checkpoint &cp, const SymBindings &symBindings
+  ) {
+    return guardedCall([&](RuntimeValue &res) {
+      const FunDecl &f = *fn.fun;
+      enterFrame(f, {});
+      mem_ = cp.mem;
+      defined_ = cp.defined;
+      ptrCells_ = cp.ptrCells;
+      objects_ = cp.objects;
+      byBase_ = cp.byBase;
+      parent_ = cp.parent;
+      nested_ = cp.nested;
+      addrMap_ = cp.addrMap;
+      nextAddr_ = cp.nextAddr;
+      nextProvId_ = cp.nextProvId;
+      Store store = cp.store;
+      // The syms bind before any let, as in enterFunction(); the lets
+      // bound late read no other let and allocate nothing, so binding
+      // them after the prefix's lets and blocks changes nothing.
+      bindSyms(f, symBindings, store);
+      for (std::size_t k = 0; k < cp.lets; ++k)
+        if (cp.prefix->deferred(k))
+          bindLets(f, k, k + 1, store);
+      bindLets(f, cp.lets, f.lets.size(), store);
+      // The prefix's blocks count as in call(); with no fuel, entering the
+      // next block checks the budget.
+      steps_ = cp.steps;
+      fuel_ = 0;
+      if (fn.bytecode)
+        execBytecode(*fn.bytecode, store, nullptr, &res, cp.pc);
+      else
+        execAst(f, *fn.cfg, store, nullptr, &res, cp.pc);
+    });
+  }
+
+  std::vector<Interpreter::CallResult> Interpreter::callBatch(
+      const PreparedFunction &fn, const std::vector<const SymBindings *> &rows
+  ) {
+    std::vector<CallResult> out(rows.size());
+    auto oneByOne = [&] {
+      Checkpoint cp;
+      bool shared = rows.size() > 1 && checkpoint(fn, cp);
+      if (shared)
+        timing::count("rows-forked", rows.size());
+      for (std::size_t i = 0; i < rows.size(); ++i)
+        out[i] = shared ? fork(fn, cp, *rows[i]) : call(fn, {}, *rows[i]);
+      return out;
+    };
+    if (!fn.bytecode || !fn.fun->params.empty() || rows.size() < 2 ||
+        !Lockstep::supports(*fn.bytecode))
+      return oneByOne();
+
+    std::fesetround(FE_TONEAREST);
+    Lockstep ls(*fn.bytecode, *fn.cfg, out, budget_);
+    Lockstep::Mask lanes(rows.size(), 0);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      Store store;
+      try {
+        store = enterFunction(*fn.fun, {}, *rows[i]);
+      } catch (const std::exception &) {
+        // E.g. a missing binding: fails as call() reports it.
+        out[i] = call(fn, {}, *rows[i]);
+        continue;
+      }
+      // A scalar frame holds no memory, so the next row may be bound once
+      // this one is in the columns.
+      if (!ls.load(i, store))
+        return oneByOne();
+      lanes[i] = 1;
+    }
+    try {
+      ls.run(lanes);
+    } catch (const Diverged &) {
+      return oneByOne();
+    }
+    return out;
+  }
+
+} // namespace symir
@@ -0,0 +1,582 @@
+#include "interp/bytecode.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "analysis/cfg.hpp"
+#include "error.hpp"
+#include "frontend/diagnostics.hpp"
+
+// Threaded dispatch through a table of label addresses where the compiler
+// has it (GCC and Clang), a switch otherwise.
+#if defined(__GNUC__)
+#define SYMIR_BYTECODE_THREADED 1
+#endif
+
+namespace symir {
+
+  namespace {
+
+    // Thrown by the Builder on constructs it leaves to the AST walker.
+    struct Unsupported {};
+
+    bool isPlainRead(const Expr &e) {
+      return e.rest.empty() && (std::holds_alternative<CoefAtom>(e.first.v) ||
+                                std::holds_alternative<RValueAtom>(e.first.v));
+    }
+
+  } // namespace
+
+  struct Interpreter::Bytecode::Builder {
+    Bytecode &bc;
+    const std::unordered_map<Symbol, const StructDecl *> &structs;
+    std::unordered_map<Symbol, std::uint32_t> slots;
+    std::vector<TypePtr> slotTypes;
+    std::uint32_t named = 0;
+    std::uint32_t nextTemp = 0;
+
+    Builder(Bytecode &bc, const std::unordered_map<Symbol, const StructDecl *> &structs) :
+        bc(bc), structs(structs) {}
+
+    // Scalars and arrays and structs of them; pointers and vectors stay
+    // with the AST walker, which owns the memory model.
+    bool supported(const TypePtr &t) const {
+      if (!t)
+        return false;
+      if (std::holds_alternative<IntType>(t->v) || std::holds_alternative<FloatType>(t->v))
+        return true;
+      if (auto at = std::get_if<ArrayType>(&t->v))
+        return supported(at->elem);
+      if (auto st = std::get_if<StructType>(&t->v)) {
+        auto it = structs.find(st->name.name);
+        if (it == structs.end())
+          return false;
+        return std::all_of(it->second->fields.begin(), it->second->fields.end(), [&](auto &f) {
+          return supported(f.type);
+        });
+      }
+      return false;
+    }
+
+    void bind(const std::string &name, const TypePtr &type) {
+      if (!supported(type))
+        throw Unsupported{};
+      slots[name] = static_cast<std::uint32_t>(bc.slotNames.size());
+      bc.slotNames.push_back(name);
+      slotTypes.push_back(type);
+    }
+
+    std::uint32_t slotOf(const std::string &name) const {
+      auto it = slots.find(name);
+      if (it == slots.end())
+        throw std::runtime_error("Internal error: Unbound name " + name);
+      return it->second;
+    }
+
+    std::uint32_t temp() {
+      bc.frameSize = std::max(bc.frameSize, nextTemp + 1);
+      return nextTemp++;
+    }
+
+    std::uint32_t pc() const { return static_cast<std::uint32_t>(bc.code.size()); }
+
+    std::uint32_t
+    emit(Op op, std::uint32_t dst = 0, Operand a = {}, Operand b = {}, std::uint8_t sub = 0) {
+      Instr in;
+      in.op = op;
+      in.sub = sub;
+      in.dst = dst;
+      in.a = a;
+      in.b = b;
+      bc.code.push_back(in);
+      return pc() - 1;
+    }
+
+    static Operand slot(std::uint32_t index, bool checked = false) {
+      return {Operand::Kind::Slot, checked, index};
+    }
+
+    Operand constant(RuntimeValue v) {
+      bc.consts.push_back(std::move(v));
+      return {Operand::Kind::Const, false, static_cast<std::uint32_t>(bc.consts.size() - 1)};
+    }
+
+    Operand intConst(std::int64_t value) {
+      RuntimeValue v;
+      v.kind = RuntimeValue::Kind::Int;
+      v.intVal = value;
+      v.bits = 64;
+      return constant(std::move(v));
+    }
+
+    Operand floatConst(double value) {
+      RuntimeValue v;
+      v.kind = RuntimeValue::Kind::Float;
+      v.floatVal = value;
+      v.bits = 64;
+      return constant(std::move(v));
+    }
+
+    // evalCoef(): names read without the undef check.
+    Operand coef(const Coef &c) {
+      if (auto il = std::get_if<IntLit>(&c))
+        return intConst(il->value);
+      if (auto fl = std::get_if<FloatLit>(&c))
+        return floatConst(fl->value);
+      if (auto id = std::get_if<LocalOrSymId>(&c))
+        return slot(std::visit([&](auto &&n) { return slotOf(n.name); }, *id));
+      throw Unsupported{}; // null
+    }
+
+    // Field steps are resolved to StructDecl order along the static type.
+    Path path(const LValue &lv) {
+      Path p;
+      p.base = slotOf(lv.base.name);
+      TypePtr type = slotTypes[p.base];
+      for (const auto &acc: lv.accesses) {
+        Step s;
+        if (auto ai = std::get_if<AccessIndex>(&acc)) {
+          auto at = std::get_if<ArrayType>(&type->v);
+          if (!at)
+            throw Unsupported{};
+          type = at->elem;
+          if (auto il = std::get_if<IntLit>(&ai->index)) {
+            s.kind = Step::Kind::Const;
+            s.index = intConst(il->value).index;
+          } else {
+            s.kind = Step::Kind::Slot;
+            s.index = std::visit(
+                [&](auto &&n) { return slotOf(n.name); }, std::get<LocalOrSymId>(ai->index)
+            );
+          }
+        } else {
+          auto st = std::get_if<StructType>(&type->v);
+          if (!st)
+            throw Unsupported{};
+          const StructDecl &sd = *structs.at(st->name.name);
+          int index = fieldIndex(sd, std::get<AccessField>(acc).field);
+          if (index < 0)
+            throw Unsupported{};
+          s.kind = Step::Kind::Field;
+          s.index = static_cast<std::uint32_t>(index);
+          type = sd.fields[index].type;
+        }
+        p.steps.push_back(std::move(s));
+      }
+      return p;
+    }
+
+    // evalLValue(): reading undef is UB.
+    Operand rvalue(const LValue &lv) {
+      if (lv.accesses.empty())
+        return slot(slotOf(lv.base.name), true);
+      bc.paths.push_back(path(lv));
+      return {Operand::Kind::Path, true, static_cast<std::uint32_t>(bc.paths.size() - 1)};
+    }
+
+    Operand selectVal(const SelectVal &sv) {
+      if (auto rv = std::get_if<RValue>(&sv))
+        return rvalue(*rv);
+      return coef(std::get<Coef>(sv));
+    }
+
+    // Reads `o` now, so that its UB is raised before that of code emitted
+    // after it, as the walker would.
+    Operand force(Operand o) {
+      if (!o.checked)
+        return o;
+      std::uint32_t t = temp();
+      emit(Op::Move, t, o);
+      return slot(t);
+    }
+
+    Operand atom(const Atom &a) {
+      return std::visit(
+          [&](auto &&arg) -> Operand {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, OpAtom>) {
+              Operand c = coef(arg.coef);
+              Operand r = rvalue(arg.rval);
+              std::uint32_t d = temp();
+              emit(Op::Apply, d, c, r, static_cast<std::uint8_t>(arg.op));
+              return slot(d);
+            } else if constexpr (std::is_same_v<T, UnaryAtom>) {
+              Operand r = rvalue(arg.rval);
+              std::uint32_t d = temp();
+              emit(Op::Not, d, r);
+              return slot(d);
+            } else if constexpr (std::is_same_v<T, SelectAtom>) {
+              std::uint32_t d = temp();
+              std::uint32_t test;
+              if (arg.cond) {
+                auto [l, r] = cond(*arg.cond);
+                test = emit(Op::CondJump, 0, l, r, static_cast<std::uint8_t>(arg.cond->op));
+              } else {
+                test = emit(Op::MaskJump, 0, expr(*arg.maskExpr));
+              }
+              bc.code[test].target = pc();
+              emit(Op::Move, d, selectVal(arg.vtrue));
+              std::uint32_t skip = emit(Op::Jump);
+              bc.code[test].alt = pc();
+              emit(Op::Move, d, selectVal(arg.vfalse));
+              bc.code[skip].target = pc();
+              return slot(d);
+            } else if constexpr (std::is_same_v<T, CmpAtom>) {
+              Operand l = selectVal(arg.lhs);
+              Operand r = selectVal(arg.rhs);
+              std::uint32_t d = temp();
+              emit(Op::Cmp, d, l, r, static_cast<std::uint8_t>(arg.op));
+              return slot(d);
+            } else if constexpr (std::is_same_v<T, CoefAtom>) {
+              return coef(arg.coef);
+            } else if constexpr (std::is_same_v<T, RValueAtom>) {
+              return rvalue(arg.rval);
+            } else if constexpr (std::is_same_v<T, CastAtom>) {
+              if (!arg.dstType || !(std::holds_alternative<IntType>(arg.dstType->v) ||
+                                    std::holds_alternative<FloatType>(arg.dstType->v)))
+                throw Unsupported{};
+              Operand src = std::visit(
+                  [&](auto &&s) -> Operand {
+                    using S = std::decay_t<decltype(s)>;
+                    if constexpr (std::is_same_v<S, IntLit>)
+                      return intConst(s.value);
+                    else if constexpr (std::is_same_v<S, FloatLit>)
+                      return floatConst(s.value);
+                    else if constexpr (std::is_same_v<S, SymId>)
+                      return slot(slotOf(s.name));
+                    else
+                      return rvalue(s);
+                  },
+                  arg.src
+              );
+              std::uint32_t d = temp();
+              std::uint32_t in = emit(Op::Cast, d, src);
+              bc.types.push_back(arg.dstType);
+              bc.code[in].target = static_cast<std::uint32_t>(bc.types.size() - 1);
+              return slot(d);
+            } else {
+              throw Unsupported{}; // addr, load, ptrindex, ptrfield
+            }
+          },
+          a.v
+      );
+    }
+
+    Operand expr(const Expr &e) {
+      Operand first = atom(e.first);
+      if (e.rest.empty())
+        return first;
+      std::uint32_t acc;
+      if (first.kind == Operand::Kind::Slot && first.index >= named) {
+        acc = first.index;
+      } else {
+        acc = temp();
+        emit(Op::Move, acc, first);
+      }
+      for (const auto &tail: e.rest) {
+        Operand right = atom(tail.atom);
+        emit(Op::AddSub, acc, {}, right, static_cast<std::uint8_t>(tail.op));
+      }
+      return slot(acc);
+    }
+
+    std::pair<Operand, Operand> cond(const Cond &c) {
+      Operand l = expr(c.lhs);
+      if (!isPlainRead(c.rhs))
+        l = force(l);
+      Operand r = expr(c.rhs);
+      return {l, r};
+    }
+
+    void instr(const symir::Instr &ins) {
+      nextTemp = named;
+      std::visit(
+          [&](auto &&i) {
+            using T = std::decay_t<decltype(i)>;
+            if constexpr (std::is_same_v<T, AssignInstr>) {
+              Operand rhs = expr(i.rhs);
+              if (i.lhs.accesses.empty()) {
+                emit(Op::Set, slotOf(i.lhs.base.name), rhs);
+              } else {
+                bc.paths.push_back(path(i.lhs));
+                emit(Op::SetPath, static_cast<std::uint32_t>(bc.paths.size() - 1), rhs);
+              }
+            } else if constexpr (std::is_same_v<T, AssumeInstr>) {
+              auto [l, r] = cond(i.cond);
+              emit(Op::Assume, 0, l, r, static_cast<std::uint8_t>(i.cond.op));
+            } else if constexpr (std::is_same_v<T, RequireInstr>) {
+              auto [l, r] = cond(i.cond);
+              std::uint32_t in = emit(Op::Require, 0, l, r, static_cast<std::uint8_t>(i.cond.op));
+              bc.messages.push_back(i.message.value_or("Requirement failed"));
+              bc.code[in].target = static_cast<std::uint32_t>(bc.messages.size() - 1);
+            } else {
+              throw Unsupported{}; // store
+            }
+          },
+          ins
+      );
+    }
+
+    // Branch targets are block indices until function() patches them.
+    void term(const Terminator &t, const CFG &cfg) {
+      nextTemp = named;
+      std::visit(
+          [&](auto &&tm) {
+            using T = std::decay_t<decltype(tm)>;
+            if constexpr (std::is_same_v<T, BrTerm>) {
+              if (tm.isConditional) {
+                auto [l, r] = cond(*tm.cond);
+                std::uint32_t in = emit(Op::CondBr, 0, l, r, static_cast<std::uint8_t>(tm.cond->op));
+                bc.code[in].target = static_cast<std::uint32_t>(cfg.indexOf.at(tm.thenLabel.name));
+                bc.code[in].alt = static_cast<std::uint32_t>(cfg.indexOf.at(tm.elseLabel.name));
+              } else {
+                std::uint32_t in = emit(Op::Br);
+                bc.code[in].target = static_cast<std::uint32_t>(cfg.indexOf.at(tm.dest.name));
+              }
+            } else if constexpr (std::is_same_v<T, RetTerm>) {
+              if (tm.value)
+                emit(Op::Ret, 0, expr(*tm.value));
+              else
+                emit(Op::RetVoid);
+            } else {
+              emit(Op::Unreachable);
+            }
+          },
+          t
+      );
+    }
+
+    void function(const FunDecl &f, const CFG &cfg) {
+      if (!f.params.empty())
+        throw Unsupported{};
+      for (const auto &s: f.syms)
+        bind(s.name.name, s.type);
+      for (const auto &l: f.lets)
+        bind(l.name.name, l.type);
+      named = static_cast<std::uint32_t>(bc.slotNames.size());
+      bc.frameSize = named;
+
+      std::vector<std::uint32_t> &starts = bc.starts;
+      for (std::size_t i = 0; i < f.blocks.size(); ++i) {
+        starts.push_back(pc());
+        bc.labels.push_back(f.blocks[i].label.name);
+        emit(Op::Enter, static_cast<std::uint32_t>(i));
+        for (const auto &ins: f.blocks[i].instrs)
+          instr(ins);
+        term(f.blocks[i].term, cfg);
+      }
+      for (auto &in: bc.code) {
+        if (in.op == Op::Br || in.op == Op::CondBr) {
+          in.target = starts[in.target];
+          in.alt = in.op == Op::CondBr ? starts[in.alt] : 0;
+        }
+      }
+      bc.entry = starts[cfg.entry];
+    }
+  };
+
+  const Interpreter::Bytecode *Interpreter::bytecodeFor(const FunDecl &f) {
+    auto it = bytecode_.find(&f);
+    if (it != bytecode_.end())
+      return it->second.get();
+    std::unique_ptr<Bytecode> bc;
+    if (const CFG *cfg = analyses_->validCfg(f)) {
+      bc = std::make_unique<Bytecode>();
+      try {
+        Bytecode::Builder(*bc, structs_).function(f, *cfg);
+      } catch (const Unsupported &) {
+        bc.reset();
+      }
+    }
+    return (bytecode_[&f] = std::move(bc)).get();
+  }
+
+  bool Interpreter::execBytecode(
+      const Bytecode &bc, Store &store, const std::vector<std::string> *path, RuntimeValue *ret,
+      std::size_t from
+  ) {
+    using Op = Bytecode::Op;
+    using Operand = Bytecode::Operand;
+    using Step = Bytecode::Step;
+
+    std::vector<RuntimeValue> frame(bc.frameSize);
+    for (std::size_t i = 0; i < bc.slotNames.size(); ++i)
+      frame[i] = std::move(store.at(bc.slotNames[i]));
+
+    auto indexOf = [&](const Step &s) -> const RuntimeValue & {
+      return s.kind == Step::Kind::Const ? bc.consts[s.index] : frame[s.index];
+    };
+    auto read = [&](const Operand &o) -> const RuntimeValue & {
+      const RuntimeValue *cur;
+      if (o.kind == Operand::Kind::Const)
+        return bc.consts[o.index];
+      if (o.kind == Operand::Kind::Slot) {
+        cur = &frame[o.index];
+      } else {
+        const Bytecode::Path &p = bc.paths[o.index];
+        cur = &frame[p.base];
+        for (const auto &s: p.steps)
+          cur = s.kind == Step::Kind::Field ? &readField(*cur, s.index)
+                                            : &readElement(*cur, indexOf(s));
+      }
+      if (o.checked && cur->kind == RuntimeValue::Kind::Undef)
+        throw UndefinedBehaviorError("UB: Reading undef value");
+      return *cur;
+    };
+    auto test = [&](const Bytecode::Instr &in) {
+      const RuntimeValue &l = read(in.a);
+      const RuntimeValue &r = read(in.b);
+      return condValues(static_cast<RelOp>(in.sub), l, r);
+    };
+
+    const Bytecode::Instr *code = bc.code.data();
+    const Bytecode::Instr *in = nullptr;
+    std::uint32_t ip = from == SIZE_MAX ? bc.entry : bc.starts[from];
+    std::size_t step = 0; // position on `path`
+
+#ifdef SYMIR_BYTECODE_THREADED
+    // In the order of Bytecode::Op.
+    static const void *const kDispatch[] = {
+        &&op_Enter,    &&op_Move,     &&op_Apply,   &&op_Not,     &&op_Cmp,
+        &&op_Cast,     &&op_AddSub,   &&op_Set,     &&op_SetPath, &&op_Jump,
+        &&op_CondJump, &&op_MaskJump, &&op_Br,      &&op_CondBr,  &&op_Assume,
+        &&op_Require,  &&op_Ret,      &&op_RetVoid, &&op_Unreachable,
+    };
+    static_assert(
+        std::size(kDispatch) == static_cast<std::size_t>(Op::Unreachable) + 1,
+        "dispatch table out of sync with Bytecode::Op"
+    );
+#define VM_CASE(name) op_##name:
+#define VM_NEXT()                                                                                  \
+  do {                                                                                             \
+    in = &code[ip++];                                                                              \
+    goto *kDispatch[static_cast<std::size_t>(in->op)];                                             \
+  } while (0)
+    VM_NEXT();
+#else
+#define VM_CASE(name) case Op::name:
+#define VM_NEXT() continue
+    for (;;) {
+      in = &code[ip++];
+      switch (in->op) {
+#endif
+
+    VM_CASE(Enter) {
+      if (fuel_-- == 0)
+        budgetCheck();
+      ++steps_;
+      if (path && (step >= path->size() || (*path)[step] != bc.labels[in->dst]))
+        return false;
+      VM_NEXT();
+    }
+    VM_CASE(Move) {
+      frame[in->dst] = read(in->a);
+      VM_NEXT();
+    }
+    VM_CASE(Apply) {
+      const RuntimeValue &c = read(in->a);
+      const RuntimeValue &r = read(in->b);
+      frame[in->dst] = applyScalar(static_cast<AtomOpKind>(in->sub), c, r);
+      VM_NEXT();
+    }
+    VM_CASE(Not) {
+      frame[in->dst] = notScalar(read(in->a));
+      VM_NEXT();
+    }
+    VM_CASE(Cmp) {
+      const RuntimeValue &l = read(in->a);
+      const RuntimeValue &r = read(in->b);
+      RuntimeValue res;
+      res.kind = RuntimeValue::Kind::Int;
+      res.bits = 1;
+      res.intVal = compareValues(static_cast<RelOp>(in->sub), l, r) ? 1 : 0;
+      frame[in->dst] = std::move(res);
+      VM_NEXT();
+    }
+    VM_CASE(Cast) {
+      frame[in->dst] = castScalar(read(in->a), bc.types[in->target]);
+      VM_NEXT();
+    }
+    VM_CASE(AddSub) {
+      addScalar(frame[in->dst], read(in->b), static_cast<AddOp>(in->sub));
+      VM_NEXT();
+    }
+    VM_CASE(Set) {
+      assignValue(frame[in->dst], read(in->a));
+      VM_NEXT();
+    }
+    VM_CASE(SetPath) {
+      // The value is read before the lvalue is walked, as in the walker;
+      // a copy, since unsharing a node on the walk may release it.
+      RuntimeValue val = read(in->a);
+      const Bytecode::Path &p = bc.paths[in->dst];
+      RuntimeValue *cur = &frame[p.base];
+      for (const auto &s: p.steps)
+        cur = s.kind == Step::Kind::Field ? &writeField(*cur, s.index)
+                                          : &writeElement(*cur, indexOf(s).intVal);
+      assignValue(*cur, val);
+      VM_NEXT();
+    }
+    VM_CASE(Jump) {
+      ip = in->target;
+      VM_NEXT();
+    }
+    VM_CASE(CondJump) {
+      ip = test(*in) ? in->target : in->alt;
+      VM_NEXT();
+    }
+    VM_CASE(MaskJump) {
+      const RuntimeValue &mask = read(in->a);
+      if (mask.kind == RuntimeValue::Kind::Undef)
+        throw UndefinedBehaviorError("UB: undef scalar mask");
+      ip = mask.intVal != 0 ? in->target : in->alt;
+      VM_NEXT();
+    }
+    VM_CASE(Br) {
+      if (path && ++step == path->size())
+        return true;
+      ip = in->target;
+      VM_NEXT();
+    }
+    VM_CASE(CondBr) {
+      std::uint32_t next = test(*in) ? in->target : in->alt;
+      if (path && ++step == path->size())
+        return true;
+      ip = next;
+      VM_NEXT();
+    }
+    VM_CASE(Assume) {
+      if (!test(*in))
+        throw std::runtime_error("Assumption failed");
+      VM_NEXT();
+    }
+    VM_CASE(Require) {
+      if (!test(*in))
+        throw RequireViolationError(bc.messages[in->target]);
+      VM_NEXT();
+    }
+    VM_CASE(Ret) {
+      const RuntimeValue &res = read(in->a);
+      if (res.kind == RuntimeValue::Kind::Undef)
+        throw UndefinedBehaviorError("UB: Reading undef in ret");
+      if (path)
+        return ++step == path->size();
+      *ret = res;
+      return true;
+    }
+    VM_CASE(RetVoid) {
+      if (path)
+        return ++step == path->size();
+      return true;
+    }
+    VM_CASE(Unreachable) { throw std::runtime_error("Reached unreachable"); }
+
+#ifndef SYMIR_BYTECODE_THREADED
+      }
+    }
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+    return false;
+  }
+
+} // namespace symir
@@ -1,14 +1,18 @@
 #include "interp/interpreter.hpp"
+#include <algorithm>
 #include <cfenv>
 #include <cmath>
 #include <cstdio>
-#include <functional>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include "analysis/cfg.hpp"
 #include "analysis/type_utils.hpp"
+#include "ast/type_annotations.hpp"
 #include "error.hpp"
 #include "frontend/diagnostics.hpp"
+#include "interp/bytecode.hpp"
+#include "timing.hpp"
 
 namespace symir {
 
@@ -24,12 +28,95 @@ namespace symir {
     return val;
   }
 
+  // Int/Float operand pairs that evaluate in floating point, the Int side
+  // promoted (literal inference support).
+  template<typename V> static bool isFloatPair(const V &a, const V &b) {
+    using K = typename V::Kind;
+    return (a.kind == K::Float && (b.kind == K::Float || b.kind == K::Int)) ||
+           (a.kind == K::Int && b.kind == K::Float);
+  }
+
+  template<typename V> static double asFloat(const V &v) {
+    return v.kind == V::Kind::Float ? v.floatVal : static_cast<double>(v.intVal);
+  }
+
   Interpreter::Interpreter(const Program &prog) : prog_(prog) {
     for (const auto &s: prog_.structs) {
       structs_[s.name.name] = &s;
     }
   }
 
+  Interpreter::~Interpreter() = default;
+
+  // ---- Aggregate storage ----
+
+  Interpreter::Aggregate *Interpreter::AggregateArena::make(const StructDecl *decl) {
+    Aggregate *node;
+    if (free_.empty()) {
+      node = &nodes_.emplace_back();
+      node->arena = this;
+    } else {
+      node = free_.back();
+      free_.pop_back();
+    }
+    node->refs = 1;
+    node->decl = decl;
+    return node;
+  }
+
+  void Interpreter::AggregateArena::recycle(Aggregate *node) {
+    node->elems.clear(); // keeps the capacity; releases nested nodes
+    node->ints.clear();
+    node->floats.clear();
+    node->undef.clear();
+    free_.push_back(node);
+  }
+
+  void Interpreter::RuntimeValue::release() {
+    if (--agg->refs == 0)
+      agg->arena->recycle(agg);
+  }
+
+  void Interpreter::RuntimeValue::unshare() {
+    Aggregate *copy = agg->arena->make(agg->decl);
+    copy->elems = agg->elems;
+    copy->floatLanes = agg->floatLanes;
+    copy->ints = agg->ints;
+    copy->floats = agg->floats;
+    copy->undef = agg->undef;
+    --agg->refs;
+    agg = copy;
+  }
+
+  const Interpreter::RuntimeValue *
+  Interpreter::RuntimeValue::field(const std::string &name) const {
+    if (kind != Kind::Struct || !agg->decl)
+      return nullptr;
+    int i = fieldIndex(*agg->decl, name);
+    return i < 0 || static_cast<std::size_t>(i) >= agg->elems.size() ? nullptr : &agg->elems[i];
+  }
+
+  Interpreter::RuntimeValue *Interpreter::RuntimeValue::mutableField(const std::string &name) {
+    if (!field(name))
+      return nullptr;
+    return &mutableElements()[fieldIndex(*agg->decl, name)];
+  }
+
+  Interpreter::RuntimeValue
+  Interpreter::makeAggregate(RuntimeValue::Kind kind, const StructDecl *decl) {
+    RuntimeValue v;
+    v.agg = arena_.make(decl);
+    v.kind = kind;
+    return v;
+  }
+
+  int Interpreter::fieldIndex(const StructDecl &s, const std::string &field) {
+    for (std::size_t i = 0; i < s.fields.size(); ++i)
+      if (s.fields[i].name == field)
+        return static_cast<int>(i);
+    return -1;
+  }
+
   // ---- Memory helpers ----
 
   std::uint64_t Interpreter::sizeofType(const TypePtr &t) const {
@@ -86,6 +173,9 @@ namespace symir {
   }
 
   TypePtr Interpreter::getLValueType(const LValue &lv) const {
+    if (prog_.types)
+      if (auto t = prog_.types->of(lv))
+        return t;
     auto tit = typeMap_.find(lv.base.name);
     if (tit == typeMap_.end())
       return nullptr;
@@ -125,17 +215,16 @@ namespace symir {
   }
 
   // Allocate (or return existing) base address for varName with type t.
-  // Syncs the current store value into the heap.
+  // Moves the current store value into memory, which holds the variable
+  // from then on.
   std::uint64_t
   Interpreter::allocObject(const std::string &varName, const TypePtr &t, const Store &store) {
     auto it = addrMap_.find(varName);
     if (it != addrMap_.end())
       return it->second;
 
-    uint64_t base = nextAddr_;
     uint64_t totalSize = sizeofType(t);
-    // Align allocation to 8 bytes
-    nextAddr_ += (totalSize + 7) & ~7ULL;
+    uint64_t base = allocBytes(totalSize);
 
     uint64_t elemSize =
         sizeofType(std::get_if<ArrayType>(&t->v) ? std::get<ArrayType>(t->v).elem : t);
@@ -148,10 +237,8 @@ namespace symir {
     );
     addrMap_[varName] = base;
 
-    // Sync current store value into heap. For arrays-of-structs the
-    // element storage isn't itself a flat scalar — we recurse so that
-    // every leaf field has its own per-byte heap entry and ObjectInfo.
-    // This lets `ptrfield %p, f` for `%p = addr %arr[k]` resolve to a
+    // For arrays-of-structs every leaf field gets its own ObjectInfo. This
+    // lets `ptrfield %p, f` for `%p = addr %arr[k]` resolve to a
     // valid object-bound load address even when %p has been advanced
     // via pointer arithmetic.
     auto sit = store.find(varName);
@@ -167,7 +254,8 @@ namespace symir {
           if (sIt != structs_.end())
             sd = sIt->second;
         }
-        for (std::size_t i = 0; i < sv.arrayVal.size(); ++i) {
+        const auto &elems = sv.elements();
+        for (std::size_t i = 0; i < elems.size(); ++i) {
           uint64_t elemBase = base + i * elemSize;
           if (sd) {
             // Per-element struct: create a whole-element ObjectInfo (for
@@ -193,54 +281,61 @@ namespace symir {
                       f.type
                   }
               );
-              if (sv.arrayVal[i].kind == RuntimeValue::Kind::Struct) {
-                auto fit = sv.arrayVal[i].structVal.find(f.name);
-                if (fit != sv.arrayVal[i].structVal.end())
-                  heap_[elemBase + off] = fit->second;
-              }
               off += fSize;
             }
-          } else if (sv.arrayVal[i].kind == RuntimeValue::Kind::Array) {
+          } else if (elems[i].kind == RuntimeValue::Kind::Array) {
             // [v0.2.1 fix] Nested array element (e.g., [3] i32 inside
-            // [2][3] i32): create a sub-array ObjectInfo and recursively
-            // flatten leaf elements into per-address heap entries so that
-            // ptrindex can navigate into sub-arrays and load individual
-            // elements.
+            // [2][3] i32): create a sub-array ObjectInfo so that ptrindex
+            // can navigate into sub-arrays and load individual elements.
             auto subAt = elemTy ? std::get_if<ArrayType>(&elemTy->v) : nullptr;
             uint64_t subElemSize = subAt ? sizeofType(subAt->elem) : 4;
-            uint64_t subCount = subAt ? subAt->size : sv.arrayVal[i].arrayVal.size();
+            uint64_t subCount = subAt ? subAt->size : elems[i].elements().size();
             addObject(
                 ObjectInfo{
                     varName, "", elemBase, elemBase + elemSize, subElemSize, subCount,
                     static_cast<std::uint64_t>(-1), 0, elemTy
                 }
             );
-            // Recursively flatten leaves into heap.
-            std::function<void(uint64_t, const RuntimeValue &, const TypePtr &)> flattenToHeap =
-                [&](uint64_t addr, const RuntimeValue &rv, const TypePtr &ty) {
-                  if (rv.kind == RuntimeValue::Kind::Array) {
-                    auto innerAt = ty ? std::get_if<ArrayType>(&ty->v) : nullptr;
-                    auto innerElem = innerAt ? innerAt->elem : TypePtr{};
-                    uint64_t innerElemSz = innerElem ? sizeofType(innerElem) : 4;
-                    for (std::size_t j = 0; j < rv.arrayVal.size(); ++j)
-                      flattenToHeap(addr + j * innerElemSz, rv.arrayVal[j], innerElem);
-                  } else {
-                    heap_[addr] = rv;
-                  }
-                };
-            flattenToHeap(elemBase, sv.arrayVal[i], elemTy);
-          } else {
-            heap_[elemBase] = sv.arrayVal[i];
           }
         }
-      } else {
-        heap_[base] = sv;
       }
+      storeCell(base, t, sv);
     }
     return base;
   }
 
+  std::uint32_t Interpreter::innermostObject(std::uint64_t addr) const {
+    auto it = byBase_.upper_bound(addr);
+    if (it == byBase_.begin())
+      return kNoObject;
+    // The latest object at the greatest base <= addr is the innermost
+    // there; if it ends before addr, the innermost one containing addr is
+    // among its ancestors.
+    std::uint32_t i = std::prev(it)->second.back();
+    while (i != kNoObject && objects_[i].end <= addr)
+      i = parent_[i];
+    return i;
+  }
+
+  // Smallest object containing addr; among equal sizes the earliest,
+  // preferring a field object to a whole one.
   const Interpreter::ObjectInfo *Interpreter::findObject(std::uint64_t addr) const {
+    if (nested_) {
+      std::uint32_t i = innermostObject(addr);
+      if (i == kNoObject)
+        return nullptr;
+      // Objects with equal extents nest latest-innermost.
+      const ObjectInfo *best = &objects_[i];
+      const ObjectInfo *field = best->fieldName.empty() ? nullptr : best;
+      for (std::uint32_t p = parent_[i];
+           p != kNoObject && objects_[p].base == best->base && objects_[p].end == best->end;
+           p = parent_[p]) {
+        best = &objects_[p];
+        if (!best->fieldName.empty())
+          field = best;
+      }
+      return field ? field : best;
+    }
     const ObjectInfo *best = nullptr;
     for (const auto &o: objects_) {
       if (addr >= o.base && addr < o.end) {
@@ -262,8 +357,23 @@ namespace symir {
 
   // Like findObject, but also matches the one-past-the-end address (valid for arithmetic).
   // Two-pass: interior membership wins over one-past-the-end so that consecutive
-  // allocations (where src.end == dst.base) are unambiguous.
+  // allocations (where src.end == dst.base) are unambiguous. Either pass takes the
+  // earliest match, which for nested objects is the outermost.
   const Interpreter::ObjectInfo *Interpreter::findObjectForArith(std::uint64_t addr) const {
+    if (nested_) {
+      std::uint32_t i = innermostObject(addr);
+      if (i != kNoObject) {
+        while (parent_[i] != kNoObject)
+          i = parent_[i];
+        return &objects_[i];
+      }
+      // Whatever ends at addr contains addr - 1.
+      const ObjectInfo *found = nullptr;
+      for (i = addr ? innermostObject(addr - 1) : kNoObject; i != kNoObject; i = parent_[i])
+        if (objects_[i].end == addr)
+          found = &objects_[i];
+      return found;
+    }
     for (const auto &o: objects_)
       if (addr >= o.base && addr < o.end)
         return &o;
@@ -275,31 +385,41 @@ namespace symir {
 
   Interpreter::ObjectInfo &Interpreter::addObject(ObjectInfo obj) {
     obj.provId = nextProvId_++;
+    std::uint32_t parent = kNoObject;
+    if (nested_) {
+      // Nesting holds if the innermost object containing the new base
+      // encloses the new object whole, and no object starts inside it.
+      auto next = byBase_.upper_bound(obj.base);
+      parent = innermostObject(obj.base);
+      if (obj.end <= obj.base || (parent != kNoObject && objects_[parent].end < obj.end) ||
+          (next != byBase_.end() && next->first < obj.end))
+        nested_ = false;
+    }
+    byBase_[obj.base].push_back(static_cast<std::uint32_t>(objects_.size()));
+    parent_.push_back(parent);
     objects_.push_back(std::move(obj));
     return objects_.back();
   }
 
   const Interpreter::ObjectInfo *Interpreter::findObjectByProvId(std::uint64_t provId) const {
-    for (const auto &o: objects_)
-      if (o.provId == provId)
-        return &o;
-    return nullptr;
+    if (provId == 0 || provId > objects_.size())
+      return nullptr;
+    return &objects_[provId - 1];
   }
 
   const Interpreter::ObjectInfo *Interpreter::findObjectByBaseAddress(std::uint64_t base) const {
-    for (const auto &o: objects_)
-      if (o.base == base)
-        return &o;
-    return nullptr;
+    auto it = byBase_.find(base);
+    return it == byBase_.end() ? nullptr : &objects_[it->second.front()];
   }
 
   const Interpreter::ObjectInfo *
   Interpreter::findFieldOrStructObject(std::uint64_t addr, const TypePtr &type) const {
     uint64_t size = sizeofType(type);
-    for (const auto &o: objects_) {
-      if (o.base == addr && (o.end - o.base) == size) {
-        return &o;
-      }
+    auto it = byBase_.find(addr);
+    if (it != byBase_.end()) {
+      for (std::uint32_t i: it->second)
+        if (objects_[i].end - objects_[i].base == size)
+          return &objects_[i];
     }
     return findObject(addr);
   }
@@ -315,7 +435,7 @@ namespace symir {
     throw std::runtime_error("Internal: field '" + fieldName + "' not found in struct");
   }
 
-  // Materialize a struct variable into the heap: allocate one ObjectInfo per field
+  // Materialize a struct variable into memory: allocate one ObjectInfo per field
   // with provenance [fieldBase, fieldBase+sizeof(T)).  Idempotent (no-op if already done).
   std::uint64_t Interpreter::materializeStruct(
       const std::string &varName, const StructDecl &s, const Store &store
@@ -329,8 +449,7 @@ namespace symir {
     for (const auto &f: s.fields)
       totalSize += sizeofType(f.type);
 
-    uint64_t base = nextAddr_;
-    nextAddr_ += (totalSize + 7) & ~7ULL;
+    uint64_t base = allocBytes(totalSize);
     addrMap_[varName] = base;
 
     // [v0.2.1] Create a whole-struct ObjectInfo so that ptrfield-derived
@@ -343,14 +462,15 @@ namespace symir {
       if (fs < minFieldSize)
         minFieldSize = fs;
     }
+    auto structType = std::make_shared<Type>(StructType{s.name, s.span});
     addObject(
         ObjectInfo{
             varName, "", base, base + totalSize, minFieldSize, totalSize / minFieldSize,
-            static_cast<std::uint64_t>(-1), 0, std::make_shared<Type>(StructType{s.name, s.span})
+            static_cast<std::uint64_t>(-1), 0, structType
         }
     );
 
-    // Create one ObjectInfo per field and sync its value into the heap.
+    // Create one ObjectInfo per field.
     // [v0.2.1] Recurse into nested struct fields so that Rule 15b
     // typed-access mismatch checks can resolve nested field ObjectInfos.
     uint64_t offset = 0;
@@ -398,40 +518,26 @@ namespace symir {
                   static_cast<std::uint64_t>(-1), 0, sf.type
               }
           );
-          // Sync nested struct field value into heap.
-          if (sv != store.end() && sv->second.kind == RuntimeValue::Kind::Struct) {
-            auto fit = sv->second.structVal.find(f.name);
-            if (fit != sv->second.structVal.end() &&
-                fit->second.kind == RuntimeValue::Kind::Struct) {
-              auto sfit = fit->second.structVal.find(sf.name);
-              if (sfit != fit->second.structVal.end())
-                heap_[fBase + subOff] = sfit->second;
-            }
-          }
           subOff += sfSize;
         }
-      } else if (sv != store.end() && sv->second.kind == RuntimeValue::Kind::Struct) {
-        auto fit = sv->second.structVal.find(f.name);
-        if (fit != sv->second.structVal.end()) {
-          if (fit->second.kind == RuntimeValue::Kind::Array) {
-            for (size_t i = 0; i < fit->second.arrayVal.size(); ++i)
-              heap_[fBase + i * fElemSize] = fit->second.arrayVal[i];
-          } else {
-            heap_[fBase] = fit->second;
-          }
-        }
       }
       offset += fSize;
     }
+    if (sv != store.end())
+      storeCell(base, structType, sv->second);
     return base;
   }
 
   void Interpreter::run(
       const std::string &entryFuncName, const SymBindings &symBindings, bool dumpExec
   ) {
+    timing::Scope timer("interpret");
     // Ensure IEEE 754 RNE rounding mode regardless of process FP environment.
     std::fesetround(FE_TONEAREST);
     dumpExec_ = dumpExec;
+    tracing_ = dumpExec_ || trace_;
+    profiling_ = profile_ != nullptr;
+    logging_ = false;
     const FunDecl *entry = nullptr;
     for (const auto &f: prog_.funs) {
       if (f.name.name == entryFuncName) {
@@ -444,7 +550,166 @@ namespace symir {
     }
 
     std::vector<RuntimeValue> args;
-    execFunction(*entry, args, symBindings);
+    RuntimeValue res;
+    if (profiling_) {
+      bool timed = profile_->timed;
+      *profile_ = Profile();
+      profile_->timed = timed;
+      profile_->fun = entry;
+      profile_->blockCounts.assign(entry->blocks.size(), 0);
+      if (profile_->timed)
+        profile_->blockSeconds.assign(entry->blocks.size(), 0.0);
+      profBlock_ = SIZE_MAX;
+      try {
+        execFunction(*entry, args, symBindings, nullptr, &res);
+      } catch (...) {
+        profileEnd();
+        throw;
+      }
+      profileEnd();
+    } else {
+      execFunction(*entry, args, symBindings, nullptr, &res);
+    }
+    if (res.kind == RuntimeValue::Kind::Undef)
+      *out_ << "Result: void\n";
+    else
+      printResult(res);
+  }
+
+  bool Interpreter::runPath(
+      const std::string &entryFuncName, const SymBindings &symBindings,
+      const std::vector<std::string> &path
+  ) {
+    timing::Scope timer("interpret");
+    std::fesetround(FE_TONEAREST);
+    dumpExec_ = false;
+    tracing_ = false;
+    profiling_ = false;
+    logging_ = false;
+    for (const auto &f: prog_.funs) {
+      if (f.name.name == entryFuncName) {
+        std::vector<RuntimeValue> args;
+        return execFunction(f, args, symBindings, &path, nullptr);
+      }
+    }
+    throw std::runtime_error("Entry function not found: " + entryFuncName);
+  }
+
+  Interpreter::PreparedFunction Interpreter::prepare(const std::string &entryFuncName) {
+    PreparedFunction fn;
+    for (const auto &f: prog_.funs) {
+      if (f.name.name == entryFuncName) {
+        fn.fun = &f;
+        break;
+      }
+    }
+    if (!fn.fun)
+      throw std::runtime_error("Entry function not found: " + entryFuncName);
+    fn.cfg = analyses_->validCfg(*fn.fun);
+    if (!fn.cfg)
+      throw std::runtime_error("CFG Build failed during interp");
+    if (engine_ == Engine::Bytecode)
+      fn.bytecode = bytecodeFor(*fn.fun);
+    return fn;
+  }
+
+  Interpreter::CallResult Interpreter::call(
+      const PreparedFunction &fn, const std::vector<std::variant<std::int64_t, double>> &args,
+      const SymBindings &symBindings
+  ) {
+    return guardedCall([&](RuntimeValue &res) {
+      const FunDecl &f = *fn.fun;
+      if (args.size() != f.params.size())
+        throw std::runtime_error(
+            "Expected " + std::to_string(f.params.size()) + " arguments, got " +
+            std::to_string(args.size())
+        );
+      std::vector<RuntimeValue> argv(args.size());
+      for (std::size_t i = 0; i < args.size(); ++i) {
+        RuntimeValue &v = argv[i];
+        bool isFloat = std::holds_alternative<FloatType>(f.params[i].type->v);
+        std::visit(
+            [&](auto val) {
+              if (isFloat) {
+                v.kind = RuntimeValue::Kind::Float;
+                v.floatVal = static_cast<double>(val);
+              } else {
+                v.kind = RuntimeValue::Kind::Int;
+                v.intVal = static_cast<std::int64_t>(val);
+              }
+            },
+            args[i]
+        );
+      }
+      Store store = enterFunction(f, argv, symBindings);
+      if (logging_)
+        blockLog_->clear();
+      if (fn.bytecode && !logging_)
+        execBytecode(*fn.bytecode, store, nullptr, &res);
+      else
+        execAst(f, *fn.cfg, store, nullptr, &res);
+    });
+  }
+
+  Interpreter::CallResult
+  Interpreter::guardedCall(const std::function<void(RuntimeValue &)> &body) {
+    std::fesetround(FE_TONEAREST);
+    dumpExec_ = false;
+    tracing_ = false;
+    profiling_ = false;
+    logging_ = blockLog_ != nullptr;
+    steps_ = 0;
+    startBudget();
+    CallResult out;
+    try {
+      RuntimeValue res;
+      body(res);
+      if (res.kind == RuntimeValue::Kind::Int)
+        out.value = res.intVal;
+      else if (res.kind == RuntimeValue::Kind::Float)
+        out.value = res.floatVal;
+      else if (res.kind == RuntimeValue::Kind::Ptr) {
+        out.value = static_cast<std::int64_t>(res.ptrVal);
+        out.pointer = true;
+      }
+    } catch (const UndefinedBehaviorError &e) {
+      out.status = CallResult::Status::UndefinedBehavior;
+      out.message = e.what();
+    } catch (const RequireViolationError &e) {
+      out.status = CallResult::Status::RequireViolation;
+      out.message = e.what();
+    } catch (const BudgetExhaustedError &e) {
+      out.status = CallResult::Status::BudgetExhausted;
+      out.message = e.what();
+    } catch (const std::exception &e) {
+      out.status = CallResult::Status::Error;
+      out.message = e.what();
+    }
+    out.steps = steps_;
+    return out;
+  }
+
+  void Interpreter::startBudget() {
+    fuel_ = budget_.maxSteps ? budget_.maxSteps : UINT64_MAX;
+    if (budget_.maxMs) {
+      deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(budget_.maxMs);
+      fuel_ = std::min(fuel_, kClockBlocks);
+    }
+  }
+
+  void Interpreter::budgetCheck() {
+    if (budget_.maxSteps && steps_ >= budget_.maxSteps)
+      throw BudgetExhaustedError(
+          "Step budget exhausted after " + std::to_string(steps_) + " blocks"
+      );
+    if (budget_.maxMs && std::chrono::steady_clock::now() >= deadline_)
+      throw BudgetExhaustedError(
+          "Time budget of " + std::to_string(budget_.maxMs) + " ms exhausted after " +
+          std::to_string(steps_) + " blocks"
+      );
+    // This block is within budget; refuel for the ones after it.
+    std::uint64_t left = budget_.maxSteps ? budget_.maxSteps - steps_ - 1 : UINT64_MAX;
+    fuel_ = budget_.maxMs ? std::min(left, kClockBlocks) : left;
   }
 
   std::string Interpreter::rvToString(const RuntimeValue &rv) const {
@@ -463,10 +728,10 @@ namespace symir {
         return "ptr(0x" + std::to_string(rv.ptrVal) + ")";
       case RuntimeValue::Kind::Vec: {
         std::string s = "<";
-        for (size_t i = 0; i < rv.arrayVal.size(); ++i) {
+        for (size_t i = 0; i < laneCount(rv); ++i) {
           if (i)
             s += ", ";
-          s += rvToString(rv.arrayVal[i]);
+          s += rvToString(laneAt(rv, i));
         }
         s += ">";
         return s;
@@ -492,19 +757,22 @@ namespace symir {
       // [v0.2.1] Undef vector: every lane is undef. A subsequent lane
       // write produces a defined value at that lane; remaining lanes
       // stay undef until a whole-vector copy assigns them (rule 22).
-      res.kind = RuntimeValue::Kind::Vec;
-      for (size_t i = 0; i < vt->size; ++i)
-        res.arrayVal.push_back(makeUndef(vt->elem));
+      res = splatVec(*vt, RuntimeValue{});
     } else if (auto at = TypeUtils::asArray(t)) {
-      res.kind = RuntimeValue::Kind::Array;
-      for (size_t i = 0; i < at->size; ++i)
-        res.arrayVal.push_back(makeUndef(at->elem));
+      res = makeAggregate(RuntimeValue::Kind::Array);
+      if (at->size) {
+        // Elements of one type start out alike: share the first.
+        RuntimeValue elem = makeUndef(at->elem);
+        res.mutableElements().assign(at->size, elem);
+      }
     } else if (auto st = TypeUtils::asStruct(t)) {
-      res.kind = RuntimeValue::Kind::Struct;
       auto it = structs_.find(st->name.name);
-      if (it != structs_.end()) {
-        for (const auto &f: it->second->fields)
-          res.structVal[f.name] = makeUndef(f.type);
+      const StructDecl *sd = it != structs_.end() ? it->second : nullptr;
+      res = makeAggregate(RuntimeValue::Kind::Struct, sd);
+      if (sd) {
+        auto &fields = res.mutableElements();
+        for (const auto &f: sd->fields)
+          fields.push_back(makeUndef(f.type));
       }
     } else {
       auto bits = TypeUtils::getBitWidth(t);
@@ -532,25 +800,21 @@ namespace symir {
     }
     if (auto vt = TypeUtils::asVec(t)) {
       // [v0.2.1] Broadcast init for vector: each lane gets a copy of `v`
-      // canonicalized to the lane scalar type.
-      RuntimeValue res;
-      res.kind = RuntimeValue::Kind::Vec;
-      for (size_t i = 0; i < vt->size; ++i)
-        res.arrayVal.push_back(broadcast(vt->elem, v));
-      return res;
+      // converted to the lane scalar type.
+      return splatVec(*vt, v);
     } else if (auto at = TypeUtils::asArray(t)) {
-      RuntimeValue res;
-      res.kind = RuntimeValue::Kind::Array;
-      for (size_t i = 0; i < at->size; ++i)
-        res.arrayVal.push_back(broadcast(at->elem, v));
+      RuntimeValue res = makeAggregate(RuntimeValue::Kind::Array);
+      if (at->size)
+        res.mutableElements().assign(at->size, broadcast(at->elem, v));
       return res;
     } else if (auto st = TypeUtils::asStruct(t)) {
-      RuntimeValue res;
-      res.kind = RuntimeValue::Kind::Struct;
       auto it = structs_.find(st->name.name);
-      if (it != structs_.end()) {
-        for (const auto &f: it->second->fields)
-          res.structVal[f.name] = broadcast(f.type, v);
+      const StructDecl *sd = it != structs_.end() ? it->second : nullptr;
+      RuntimeValue res = makeAggregate(RuntimeValue::Kind::Struct, sd);
+      if (sd) {
+        auto &fields = res.mutableElements();
+        for (const auto &f: sd->fields)
+          fields.push_back(broadcast(f.type, v));
       }
       return res;
     } else {
@@ -583,26 +847,26 @@ namespace symir {
       const auto &elements = std::get<std::vector<InitValPtr>>(iv.value);
       if (auto vt = TypeUtils::asVec(t)) {
         // [v0.2.1] Brace init for vector: each lane init is a scalar.
-        RuntimeValue res;
-        res.kind = RuntimeValue::Kind::Vec;
+        RuntimeValue zero;
+        zero.kind = RuntimeValue::Kind::Int;
+        RuntimeValue res = splatVec(*vt, zero);
         for (size_t i = 0; i < elements.size(); ++i)
-          res.arrayVal.push_back(evalInit(*elements[i], vt->elem, store));
+          writeLane(res, static_cast<std::int64_t>(i), evalInit(*elements[i], vt->elem, store));
         return res;
       } else if (auto at = TypeUtils::asArray(t)) {
-        RuntimeValue res;
-        res.kind = RuntimeValue::Kind::Array;
+        RuntimeValue res = makeAggregate(RuntimeValue::Kind::Array);
+        auto &elems = res.mutableElements();
         for (size_t i = 0; i < elements.size(); ++i)
-          res.arrayVal.push_back(evalInit(*elements[i], at->elem, store));
+          elems.push_back(evalInit(*elements[i], at->elem, store));
         return res;
       } else if (auto st = TypeUtils::asStruct(t)) {
-        RuntimeValue res;
-        res.kind = RuntimeValue::Kind::Struct;
         auto sit = structs_.find(st->name.name);
-        if (sit != structs_.end()) {
-          for (size_t i = 0; i < sit->second->fields.size(); ++i) {
-            res.structVal[sit->second->fields[i].name] =
-                evalInit(*elements[i], sit->second->fields[i].type, store);
-          }
+        const StructDecl *sd = sit != structs_.end() ? sit->second : nullptr;
+        RuntimeValue res = makeAggregate(RuntimeValue::Kind::Struct, sd);
+        if (sd) {
+          auto &fields = res.mutableElements();
+          for (size_t i = 0; i < sd->fields.size(); ++i)
+            fields.push_back(evalInit(*elements[i], sd->fields[i].type, store));
         }
         return res;
       }
@@ -649,27 +913,246 @@ namespace symir {
     return v;
   }
 
-  void Interpreter::execFunction(
+  // ---- Flat memory ----
+
+  std::uint64_t Interpreter::allocBytes(std::uint64_t size) {
+    uint64_t base = nextAddr_;
+    // Align allocation to 8 bytes
+    nextAddr_ += (size + 7) & ~7ULL;
+    mem_.resize(nextAddr_ - kMemoryBase);
+    defined_.resize(nextAddr_ - kMemoryBase);
+    return base;
+  }
+
+  Interpreter::RuntimeValue Interpreter::loadCell(std::uint64_t addr, const TypePtr &t) {
+    if (auto at = TypeUtils::asArray(t)) {
+      RuntimeValue res = makeAggregate(RuntimeValue::Kind::Array);
+      uint64_t elemSz = sizeofType(at->elem);
+      auto &elems = res.mutableElements();
+      for (uint64_t i = 0; i < at->size; ++i)
+        elems.push_back(loadCell(addr + i * elemSz, at->elem));
+      return res;
+    }
+    if (auto st = TypeUtils::asStruct(t)) {
+      auto it = structs_.find(st->name.name);
+      const StructDecl *sd = it != structs_.end() ? it->second : nullptr;
+      RuntimeValue res = makeAggregate(RuntimeValue::Kind::Struct, sd);
+      if (sd) {
+        auto &fields = res.mutableElements();
+        for (const auto &f: sd->fields) {
+          fields.push_back(loadCell(addr, f.type));
+          addr += sizeofType(f.type);
+        }
+      }
+      return res;
+    }
+
+    uint64_t size = sizeofType(t);
+    uint64_t off = addr - kMemoryBase;
+    if (addr < kMemoryBase || off + size > mem_.size())
+      throw UndefinedBehaviorError("UB: Load from unknown address");
+    for (uint64_t i = 0; i < size; ++i)
+      if (!defined_[off + i])
+        return makeUndef(t);
+    uint64_t raw = 0;
+    std::memcpy(&raw, &mem_[off], std::min<uint64_t>(size, sizeof(raw)));
+
+    RuntimeValue res;
+    if (auto ft = std::get_if<FloatType>(&t->v)) {
+      res.kind = RuntimeValue::Kind::Float;
+      if (ft->kind == FloatType::Kind::F32) {
+        float f;
+        std::memcpy(&f, &raw, sizeof(f));
+        res.bits = 32;
+        res.floatVal = f;
+      } else {
+        std::memcpy(&res.floatVal, &raw, sizeof(double));
+      }
+    } else if (auto pt = std::get_if<PtrType>(&t->v)) {
+      res.kind = RuntimeValue::Kind::Ptr;
+      res.ptrVal = raw;
+      auto it = ptrCells_.find(addr);
+      if (it != ptrCells_.end()) {
+        res.ptrBase = it->second.provId;
+        res.elemSize = it->second.elemSize;
+      } else {
+        res.elemSize = static_cast<std::uint32_t>(sizeofType(pt->pointee));
+      }
+    } else {
+      res.kind = RuntimeValue::Kind::Int;
+      res.bits = TypeUtils::getBitWidth(t).value_or(64);
+      res.intVal = canonicalize(static_cast<std::int64_t>(raw), res.bits);
+    }
+    return res;
+  }
+
+  void Interpreter::storeCell(std::uint64_t addr, const TypePtr &t, const RuntimeValue &v) {
+    uint64_t size = sizeofType(t);
+    uint64_t off = addr - kMemoryBase;
+    if (addr < kMemoryBase || off + size > mem_.size())
+      throw UndefinedBehaviorError("UB: Store to unknown address");
+    if (auto at = TypeUtils::asArray(t)) {
+      uint64_t elemSz = sizeofType(at->elem);
+      if (v.kind != RuntimeValue::Kind::Array) {
+        std::fill_n(defined_.begin() + off, size, false);
+        return;
+      }
+      const auto &elems = v.elements();
+      for (uint64_t i = 0; i < at->size && i < elems.size(); ++i)
+        storeCell(addr + i * elemSz, at->elem, elems[i]);
+      return;
+    }
+    if (auto st = TypeUtils::asStruct(t)) {
+      auto it = structs_.find(st->name.name);
+      if (it == structs_.end() || v.kind != RuntimeValue::Kind::Struct) {
+        std::fill_n(defined_.begin() + off, size, false);
+        return;
+      }
+      const auto &fields = v.elements();
+      std::size_t i = 0;
+      for (const auto &f: it->second->fields) {
+        if (i < fields.size())
+          storeCell(addr, f.type, fields[i++]);
+        addr += sizeofType(f.type);
+      }
+      return;
+    }
+
+    if (!ptrCells_.empty())
+      ptrCells_.erase(addr);
+    if (v.kind == RuntimeValue::Kind::Undef) {
+      std::fill_n(defined_.begin() + off, size, false);
+      return;
+    }
+    // The cell's type sets the precision (SPEC §6.4): ints wrap to their
+    // width through the truncated bytes and f32 cells hold the f32 image.
+    uint64_t raw = 0;
+    if (auto ft = std::get_if<FloatType>(&t->v)) {
+      double d = v.kind == RuntimeValue::Kind::Float ? v.floatVal
+                                                     : static_cast<double>(v.intVal);
+      if (ft->kind == FloatType::Kind::F32) {
+        float f = static_cast<float>(d);
+        std::memcpy(&raw, &f, sizeof(f));
+      } else {
+        std::memcpy(&raw, &d, sizeof(d));
+      }
+    } else if (v.kind == RuntimeValue::Kind::Ptr) {
+      raw = v.ptrVal;
+      if (v.ptrBase)
+        ptrCells_[addr] = PtrCell{v.ptrBase, v.elemSize};
+    } else if (v.kind == RuntimeValue::Kind::Float) {
+      raw = static_cast<uint64_t>(static_cast<std::int64_t>(v.floatVal));
+    } else {
+      raw = static_cast<uint64_t>(v.intVal);
+    }
+    std::memcpy(&mem_[off], &raw, std::min<uint64_t>(size, sizeof(raw)));
+    std::fill_n(defined_.begin() + off, size, true);
+  }
+
+  TypePtr Interpreter::cellTypeAt(std::uint64_t addr) const {
+    const ObjectInfo *obj = findObject(addr);
+    if (!obj || !obj->type)
+      return nullptr;
+    TypePtr t = getCellTypeAtOffset(obj->type, addr - obj->base);
+    if (!t || TypeUtils::asArray(t) || TypeUtils::asStruct(t))
+      return nullptr;
+    return t;
+  }
+
+  Interpreter::RuntimeValue Interpreter::readVar(const std::string &name, const Store &store) {
+    if (!addrMap_.empty()) {
+      auto it = addrMap_.find(name);
+      if (it != addrMap_.end())
+        return loadCell(it->second, typeMap_.at(name));
+    }
+    return store.at(name);
+  }
+
+  std::uint64_t Interpreter::lvalueAddress(
+      const LValue &lv, std::uint64_t base, TypePtr &type, const Store &store, bool read
+  ) {
+    type = typeMap_.at(lv.base.name);
+    for (const auto &acc: lv.accesses) {
+      if (auto ai = std::get_if<AccessIndex>(&acc)) {
+        auto at = TypeUtils::asArray(type);
+        if (!at)
+          throw std::runtime_error("Indexing non-array");
+        RuntimeValue idx;
+        if (auto il = std::get_if<IntLit>(&ai->index)) {
+          idx.kind = RuntimeValue::Kind::Int;
+          idx.intVal = il->value;
+        } else {
+          const auto &id = std::get<LocalOrSymId>(ai->index);
+          if (auto lid = std::get_if<LocalId>(&id))
+            idx = readVar(lid->name, store);
+          else
+            idx = store.at(std::get<SymId>(id).name);
+        }
+        if (read && idx.kind == RuntimeValue::Kind::Undef)
+          throw UndefinedBehaviorError("UB: Undef index");
+        if (idx.intVal < 0 || static_cast<uint64_t>(idx.intVal) >= at->size)
+          throw UndefinedBehaviorError("UB: Array index out of bounds");
+        type = at->elem;
+        base += static_cast<uint64_t>(idx.intVal) * sizeofType(type);
+      } else if (auto af = std::get_if<AccessField>(&acc)) {
+        auto st = TypeUtils::asStruct(type);
+        if (!st)
+          throw std::runtime_error("Accessing field of non-struct");
+        auto it = structs_.find(st->name.name);
+        if (it == structs_.end())
+          throw std::runtime_error("Unknown struct: " + st->name.name);
+        TypePtr fieldType;
+        for (const auto &f: it->second->fields) {
+          if (f.name == af->field) {
+            fieldType = f.type;
+            break;
+          }
+          base += sizeofType(f.type);
+        }
+        if (!fieldType)
+          throw std::runtime_error("Unknown field: " + af->field);
+        type = fieldType;
+      }
+    }
+    return base;
+  }
+
+  Interpreter::Store Interpreter::enterFunction(
       const FunDecl &f, const std::vector<RuntimeValue> &args, const SymBindings &symBindings
   ) {
+    Store store = enterFrame(f, args);
+    bindSyms(f, symBindings, store);
+    bindLets(f, 0, f.lets.size(), store);
+    return store;
+  }
+
+  Interpreter::Store
+  Interpreter::enterFrame(const FunDecl &f, const std::vector<RuntimeValue> &args) {
     // Reset per-function memory state
-    heap_.clear();
+    mem_.clear();
+    defined_.clear();
+    ptrCells_.clear();
     objects_.clear();
+    byBase_.clear();
+    parent_.clear();
+    nested_ = true;
     addrMap_.clear();
-    typeMap_.clear();
-    nextAddr_ = 4096; // leave address 0 for null
+    nextAddr_ = kMemoryBase;
     nextProvId_ = 1;
 
     // Build name→type map for addr provenance lookups.
-    for (const auto &p: f.params)
-      typeMap_[p.name.name] = p.type;
-    for (const auto &s: f.syms)
-      typeMap_[s.name.name] = s.type;
-    for (const auto &l: f.lets)
-      typeMap_[l.name.name] = l.type;
+    if (typeMapOf_ != &f) {
+      typeMap_.clear();
+      for (const auto &p: f.params)
+        typeMap_[p.name.name] = p.type;
+      for (const auto &s: f.syms)
+        typeMap_[s.name.name] = s.type;
+      for (const auto &l: f.lets)
+        typeMap_[l.name.name] = l.type;
+      typeMapOf_ = &f;
+    }
 
     Store store;
-    DiagBag diags;
 
     for (size_t i = 0; i < f.params.size(); ++i) {
       RuntimeValue v = args[i];
@@ -677,7 +1160,11 @@ namespace symir {
       v.intVal = canonicalize(v.intVal, v.bits);
       store[f.params[i].name.name] = v;
     }
+    return store;
+  }
 
+  void
+  Interpreter::bindSyms(const FunDecl &f, const SymBindings &symBindings, Store &store) {
     for (const auto &s: f.syms) {
       auto it = symBindings.find(s.name.name);
       if (it == symBindings.end()) {
@@ -737,61 +1224,185 @@ namespace symir {
         store[s.name.name] = v;
       }
     }
+  }
 
-    // Init locals
-    for (const auto &l: f.lets) {
+  void Interpreter::bindLets(const FunDecl &f, std::size_t from, std::size_t to, Store &store) {
+    for (std::size_t k = from; k < to; ++k) {
+      const LetDecl &l = f.lets[k];
       if (l.init) {
         store[l.name.name] = evalInit(*l.init, l.type, store);
       } else {
         store[l.name.name] = makeUndef(l.type);
       }
     }
+  }
+
+  void Interpreter::traceBlock(const Block &block) {
+    if (dumpExec_)
+      *out_ << block.label.name << ":\n";
+    if (trace_) {
+      auto [it, fresh] = traceIds_.try_emplace(&block, 0);
+      if (fresh)
+        it->second = trace_->intern(block.label.name);
+      trace_->block(it->second);
+    }
+  }
 
-    CFG cfg = CFG::build(f, diags);
-    if (diags.hasErrors())
+  void Interpreter::traceAssign(const LValue &lv, const RuntimeValue &v, const Store &store) {
+    if (dumpExec_)
+      *out_ << "  " << lvalueText(lv, store) << " = " << rvToString(v) << "\n";
+    if (!trace_)
+      return;
+    std::uint32_t id;
+    bool dynamic = std::any_of(lv.accesses.begin(), lv.accesses.end(), [](const auto &acc) {
+      auto ai = std::get_if<AccessIndex>(&acc);
+      return ai && !std::holds_alternative<IntLit>(ai->index);
+    });
+    if (dynamic) {
+      id = trace_->intern(lvalueText(lv, store));
+    } else {
+      auto [it, fresh] = traceIds_.try_emplace(&lv, 0);
+      if (fresh)
+        it->second = trace_->intern(lvalueText(lv, store));
+      id = it->second;
+    }
+    switch (v.kind) {
+      case RuntimeValue::Kind::Int:
+        trace_->assignInt(id, v.intVal, v.bits);
+        break;
+      case RuntimeValue::Kind::Float:
+        trace_->assignFloat(id, v.floatVal, v.bits);
+        break;
+      case RuntimeValue::Kind::Ptr:
+        trace_->assignPtr(id, v.ptrVal);
+        break;
+      case RuntimeValue::Kind::Undef:
+        trace_->assignUndef(id);
+        break;
+      default:
+        trace_->assignText(id, rvToString(v));
+        break;
+    }
+  }
+
+  void Interpreter::profileBlock(std::size_t pc) {
+    Profile &p = *profile_;
+    ++p.blockCounts[pc];
+    if (profBlock_ != SIZE_MAX)
+      ++p.edgeCounts[Profile::edgeKey(profBlock_, pc)];
+    if (p.timed) {
+      auto now = std::chrono::steady_clock::now();
+      if (profBlock_ != SIZE_MAX)
+        p.blockSeconds[profBlock_] += std::chrono::duration<double>(now - profSince_).count();
+      profSince_ = now;
+    }
+    profBlock_ = pc;
+  }
+
+  void Interpreter::profileEnd() {
+    Profile &p = *profile_;
+    p.steps = steps_;
+    if (p.timed && profBlock_ != SIZE_MAX) {
+      auto now = std::chrono::steady_clock::now();
+      p.blockSeconds[profBlock_] += std::chrono::duration<double>(now - profSince_).count();
+    }
+  }
+
+  std::string Interpreter::lvalueText(const LValue &lv, const Store &store) {
+    std::string s = lv.base.name;
+    for (const auto &acc: lv.accesses) {
+      if (auto ai = std::get_if<AccessIndex>(&acc)) {
+        s += "[";
+        if (auto ilit = std::get_if<IntLit>(&ai->index)) {
+          s += std::to_string(ilit->value);
+        } else {
+          std::visit(
+              [&](auto &&id) {
+                if (store.count(id.name))
+                  s += std::to_string(readVar(id.name, store).intVal);
+                else
+                  s += id.name;
+              },
+              std::get<LocalOrSymId>(ai->index)
+          );
+        }
+        s += "]";
+      } else if (auto af = std::get_if<AccessField>(&acc)) {
+        s += "." + af->field;
+      }
+    }
+    return s;
+  }
+
+  void Interpreter::printResult(const RuntimeValue &res) const {
+    if (res.kind == RuntimeValue::Kind::Int)
+      *out_ << "Result: " << res.intVal << "\n";
+    else if (res.kind == RuntimeValue::Kind::Float) {
+      // Print floats as IEEE 754 hex (printf %a) so the output is
+      // bit-exact: round-trips losslessly, distinguishes +0/-0,
+      // and handles subnormals correctly. This is the format used
+      // for interp ⇄ compiled-C cross-validation in the xval
+      // tests; decimal would silently lose bits at the boundary.
+      char buf[64];
+      std::snprintf(buf, sizeof(buf), "%a", res.floatVal);
+      *out_ << "Result: " << buf << "\n";
+    } else if (res.kind == RuntimeValue::Kind::Ptr)
+      *out_ << "Result: ptr(0x" << std::hex << res.ptrVal << std::dec << ")\n";
+  }
+
+  bool Interpreter::execFunction(
+      const FunDecl &f, const std::vector<RuntimeValue> &args, const SymBindings &symBindings,
+      const std::vector<std::string> *path, RuntimeValue *ret
+  ) {
+    steps_ = 0;
+    startBudget();
+    Store store = enterFunction(f, args, symBindings);
+    if (engine_ == Engine::Bytecode && !tracing_ && !profiling_) {
+      if (const Bytecode *bc = bytecodeFor(f))
+        return execBytecode(*bc, store, path, ret);
+    }
+
+    const CFG *cfg = analyses_->validCfg(f);
+    if (!cfg)
       throw std::runtime_error("CFG Build failed during interp");
+    return execAst(f, *cfg, store, path, ret);
+  }
 
-    std::size_t pc = cfg.entry;
+  bool Interpreter::execAst(
+      const FunDecl &f, const CFG &cfg, Store &store, const std::vector<std::string> *path,
+      RuntimeValue *ret, std::size_t from
+  ) {
+    std::size_t pc = from == SIZE_MAX ? cfg.entry : from;
+    std::size_t step = 0; // position on `path`
 
     while (true) {
-      const Block &block = f.blocks[pc];
-      if (dumpExec_) {
-        std::cout << block.label.name << ":\n";
+      if (prefix_ && prefix_->endsAt(pc)) {
+        prefixEnd_ = pc;
+        return false;
       }
+      const Block &block = f.blocks[pc];
+      if (fuel_-- == 0)
+        budgetCheck();
+      ++steps_;
+      if (path && (step >= path->size() || (*path)[step] != block.label.name))
+        return false;
+      if (logging_)
+        blockLog_->push_back(pc);
+      if (tracing_)
+        traceBlock(block);
+      if (profiling_)
+        profileBlock(pc);
 
       for (const auto &ins: block.instrs) {
+        if (profiling_)
+          ++profile_->instrCounts[ins.index()];
         std::visit(
             [&](auto &&i) {
               using T = std::decay_t<decltype(i)>;
               if constexpr (std::is_same_v<T, AssignInstr>) {
                 RuntimeValue rhs = evalExpr(i.rhs, store);
-                if (dumpExec_) {
-                  std::cout << "  " << i.lhs.base.name;
-                  for (const auto &acc: i.lhs.accesses) {
-                    if (auto ai = std::get_if<AccessIndex>(&acc)) {
-                      std::cout << "[";
-                      if (auto ilit = std::get_if<IntLit>(&ai->index)) {
-                        std::cout << ilit->value;
-                      } else {
-                        auto id = std::get<LocalOrSymId>(ai->index);
-                        std::visit(
-                            [&](auto &&id_val) {
-                              auto it = store.find(id_val.name);
-                              if (it != store.end())
-                                std::cout << it->second.intVal;
-                              else
-                                std::cout << id_val.name;
-                            },
-                            id
-                        );
-                      }
-                      std::cout << "]";
-                    } else if (auto af = std::get_if<AccessField>(&acc)) {
-                      std::cout << "." << af->field;
-                    }
-                  }
-                  std::cout << " = " << rvToString(rhs) << "\n";
-                }
+                if (tracing_ && traceFilter_.wantsAssign(i.lhs.base.name))
+                  traceAssign(i.lhs, rhs, store);
                 setLValue(i.lhs, rhs, store);
               } else if constexpr (std::is_same_v<T, AssumeInstr>) {
                 if (!evalCond(i.cond, store))
@@ -821,8 +1432,8 @@ namespace symir {
                 // atom — supports AddrAtom, RValueAtom, LoadAtom, PtrIndexAtom,
                 // PtrFieldAtom, etc.
                 const ObjectInfo *cellObj = findObject(ptrVal.ptrVal);
+                TypePtr ptrPointeeType = nullptr;
                 if (cellObj && cellObj->type) {
-                  TypePtr ptrPointeeType = nullptr;
                   std::visit(
                       [&](auto &&atom) {
                         using A = std::decay_t<decltype(atom)>;
@@ -846,49 +1457,14 @@ namespace symir {
                       throw UndefinedBehaviorError("UB: Typed-access mismatch (rule 15b) on store");
                   }
                 }
-                // SPEC §6.4: enforce destination precision. The pointee object
-                // has an elemSize that reflects the pointee type; for f32 this
-                // is 4, for f64 it is 8. Round float values to f32 if the
-                // pointee is f32-sized so the stored bits match what C/WASM
-                // would compute. (Int canonicalization is already handled in
-                // AssignInstr's setLValue and is left to the store-side mirror
-                // for now since the heap holds full int64 bits.)
-                if (val.kind == RuntimeValue::Kind::Float && obj->elemSize == 4) {
-                  val.bits = 32;
-                  val.floatVal = static_cast<double>(static_cast<float>(val.floatVal));
-                }
-                heap_[ptrVal.ptrVal] = val;
-                // Sync back to store for Store/Heap consistency.
-                // Strategy: find the most specific ObjectInfo that
-                // contains the store address. If it's a field-level
-                // ObjectInfo, sync to that field. If it's a whole-struct
-                // ObjectInfo (from ptrfield provenance), find the field
-                // ObjectInfo that contains the address and sync there.
-                const ObjectInfo *syncObj = findObject(ptrVal.ptrVal);
-                if (syncObj && !syncObj->fieldName.empty()) {
-                  if (syncObj->arrayIdx != static_cast<std::uint64_t>(-1) &&
-                      store.count(syncObj->varName) &&
-                      store.at(syncObj->varName).kind == RuntimeValue::Kind::Array) {
-                    auto &arr = store[syncObj->varName].arrayVal;
-                    if (syncObj->arrayIdx < arr.size() &&
-                        arr[syncObj->arrayIdx].kind == RuntimeValue::Kind::Struct)
-                      arr[syncObj->arrayIdx].structVal[syncObj->fieldName] = val;
-                  } else if (store.count(syncObj->varName) &&
-                             store.at(syncObj->varName).kind == RuntimeValue::Kind::Struct) {
-                    store[syncObj->varName].structVal[syncObj->fieldName] = val;
-                  }
-                } else if (obj->count == 1 && obj->fieldName.empty() &&
-                           obj->arrayIdx == static_cast<std::uint64_t>(-1) &&
-                           store.count(obj->varName) &&
-                           store.at(obj->varName).kind != RuntimeValue::Kind::Array &&
-                           store.at(obj->varName).kind != RuntimeValue::Kind::Vec) {
-                  store[obj->varName] = val;
-                } else {
-                  uint64_t idx = (ptrVal.ptrVal - obj->base) / obj->elemSize;
-                  if (store.count(obj->varName) &&
-                      store.at(obj->varName).kind == RuntimeValue::Kind::Array)
-                    store[obj->varName].arrayVal[idx] = val;
-                }
+                // SPEC §6.4: the cell's type sets the destination precision,
+                // so f32 cells round and ints wrap to their width.
+                TypePtr cellType = cellTypeAt(ptrVal.ptrVal);
+                if (!cellType)
+                  cellType = ptrPointeeType;
+                if (!cellType)
+                  throw std::runtime_error("Store to a cell of unknown type");
+                storeCell(ptrVal.ptrVal, cellType, val);
               }
             },
             ins
@@ -902,11 +1478,11 @@ namespace symir {
             if constexpr (std::is_same_v<T, BrTerm>) {
               if (t.isConditional) {
                 if (evalCond(*t.cond, store))
-                  pc = cfg.indexOf[t.thenLabel.name];
+                  pc = cfg.indexOf.at(t.thenLabel.name);
                 else
-                  pc = cfg.indexOf[t.elseLabel.name];
+                  pc = cfg.indexOf.at(t.elseLabel.name);
               } else {
-                pc = cfg.indexOf[t.dest.name];
+                pc = cfg.indexOf.at(t.dest.name);
               }
               jumped = true;
             } else if constexpr (std::is_same_v<T, RetTerm>) {
@@ -914,21 +1490,8 @@ namespace symir {
                 RuntimeValue res = evalExpr(*t.value, store);
                 if (res.kind == RuntimeValue::Kind::Undef)
                   throw UndefinedBehaviorError("UB: Reading undef in ret");
-                if (res.kind == RuntimeValue::Kind::Int)
-                  std::cout << "Result: " << res.intVal << "\n";
-                else if (res.kind == RuntimeValue::Kind::Float) {
-                  // Print floats as IEEE 754 hex (printf %a) so the output is
-                  // bit-exact: round-trips losslessly, distinguishes +0/-0,
-                  // and handles subnormals correctly. This is the format used
-                  // for interp ⇄ compiled-C cross-validation in the xval
-                  // tests; decimal would silently lose bits at the boundary.
-                  char buf[64];
-                  std::snprintf(buf, sizeof(buf), "%a", res.floatVal);
-                  std::cout << "Result: " << buf << "\n";
-                } else if (res.kind == RuntimeValue::Kind::Ptr)
-                  std::cout << "Result: ptr(0x" << std::hex << res.ptrVal << std::dec << ")\n";
-              } else {
-                std::cout << "Result: void\n";
+                if (!path)
+                  *ret = std::move(res);
               }
               return;
             } else if constexpr (std::is_same_v<T, UnreachableTerm>) {
@@ -938,9 +1501,12 @@ namespace symir {
           block.term
       );
 
+      if (path && ++step == path->size())
+        return true;
       if (!jumped)
         break;
     }
+    return !path;
   }
 
   Interpreter::RuntimeValue Interpreter::evalExpr(const Expr &e, const Store &store) {
@@ -951,92 +1517,12 @@ namespace symir {
       // another Vec OR a scalar literal that broadcasts (matches the
       // typechecker rule allowing literal broadcast in vec chains).
       if (v.kind == RuntimeValue::Kind::Vec &&
-          (right.kind == RuntimeValue::Kind::Int || right.kind == RuntimeValue::Kind::Float)) {
-        RuntimeValue bvec;
-        bvec.kind = RuntimeValue::Kind::Vec;
-        bvec.arrayVal.reserve(v.arrayVal.size());
-        for (auto &laneL: v.arrayVal) {
-          RuntimeValue lane = right;
-          lane.bits = laneL.bits;
-          if (lane.kind == RuntimeValue::Kind::Int)
-            lane.intVal = canonicalize(lane.intVal, lane.bits);
-          else if (lane.bits == 32)
-            lane.floatVal = static_cast<double>(static_cast<float>(lane.floatVal));
-          bvec.arrayVal.push_back(std::move(lane));
-        }
-        right = std::move(bvec);
-      }
-      if (v.kind == RuntimeValue::Kind::Vec && right.kind == RuntimeValue::Kind::Vec) {
-        if (v.arrayVal.size() != right.arrayVal.size())
-          throw std::runtime_error("Vector lane count mismatch in +/-");
-        for (size_t k = 0; k < v.arrayVal.size(); ++k) {
-          auto &lhsLane = v.arrayVal[k];
-          auto &rhsLane = right.arrayVal[k];
-          if (lhsLane.kind == RuntimeValue::Kind::Undef ||
-              rhsLane.kind == RuntimeValue::Kind::Undef)
-            throw UndefinedBehaviorError("UB: Reading undef vector lane");
-          if (lhsLane.kind == RuntimeValue::Kind::Int) {
-            __int128 a = lhsLane.intVal, b = rhsLane.intVal;
-            __int128 r = (tail.op == AddOp::Plus) ? (a + b) : (a - b);
-            int64_t smax =
-                (lhsLane.bits == 64) ? INT64_MAX : ((INT64_C(1) << (lhsLane.bits - 1)) - 1);
-            int64_t smin = (lhsLane.bits == 64) ? INT64_MIN : (-(INT64_C(1) << (lhsLane.bits - 1)));
-            if (r > (__int128) smax || r < (__int128) smin)
-              throw UndefinedBehaviorError("UB: vector lane overflow in +/-");
-            lhsLane.intVal = canonicalize(static_cast<int64_t>(r), lhsLane.bits);
-          } else if (lhsLane.kind == RuntimeValue::Kind::Float) {
-            uint32_t opBits = std::min(lhsLane.bits, rhsLane.bits);
-            if (tail.op == AddOp::Plus)
-              lhsLane.floatVal = checkFPResult(lhsLane.floatVal + rhsLane.floatVal, opBits);
-            else
-              lhsLane.floatVal = checkFPResult(lhsLane.floatVal - rhsLane.floatVal, opBits);
-            lhsLane.bits = opBits;
-          } else {
-            throw std::runtime_error("Unsupported lane kind in vector +/-");
-          }
-        }
+          (right.kind == RuntimeValue::Kind::Vec || right.kind == RuntimeValue::Kind::Int ||
+           right.kind == RuntimeValue::Kind::Float)) {
+        v = addVec(v, right, tail.op);
         continue;
       }
-      if (v.kind == RuntimeValue::Kind::Undef || right.kind == RuntimeValue::Kind::Undef)
-        throw UndefinedBehaviorError("UB: Reading undef in expr");
-
-      // Promote Int to Float if needed (Literal inference support)
-      if (v.kind == RuntimeValue::Kind::Float && right.kind == RuntimeValue::Kind::Int) {
-        right.floatVal = static_cast<double>(right.intVal);
-        right.kind = RuntimeValue::Kind::Float;
-      } else if (v.kind == RuntimeValue::Kind::Int && right.kind == RuntimeValue::Kind::Float) {
-        v.floatVal = static_cast<double>(v.intVal);
-        v.kind = RuntimeValue::Kind::Float;
-      }
-
-      if (v.kind == RuntimeValue::Kind::Int && right.kind == RuntimeValue::Kind::Int) {
-        // Check overflow against the *declared* bitwidth, not int64.
-        // Use __int128 so the intermediate result never overflows before the check.
-        __int128 a = v.intVal, b = right.intVal;
-        __int128 result = (tail.op == AddOp::Plus) ? (a + b) : (a - b);
-        int64_t smax = (v.bits == 64) ? INT64_MAX : ((INT64_C(1) << (v.bits - 1)) - 1);
-        int64_t smin = (v.bits == 64) ? INT64_MIN : (-(INT64_C(1) << (v.bits - 1)));
-        if (result > (__int128) smax || result < (__int128) smin) {
-          if (tail.op == AddOp::Plus)
-            throw UndefinedBehaviorError("UB: Signed integer overflow in addition");
-          else
-            throw UndefinedBehaviorError("UB: Signed integer overflow in subtraction");
-        }
-        v.intVal = static_cast<int64_t>(result);
-        v.intVal = canonicalize(v.intVal, v.bits);
-      } else if (v.kind == RuntimeValue::Kind::Float && right.kind == RuntimeValue::Kind::Float) {
-        // SPEC §6.7: FP expressions are homogeneous, but evalCoef tags
-        // FloatLit with bits=64 (it has no context). Take the narrower of the
-        // two operands so an Expr like `0.125 + (-268435449 as f32)` rounds
-        // at f32 precision instead of inheriting the literal's bits=64. The
-        // result's effective type also narrows for downstream chain steps.
-        uint32_t opBits = std::min(v.bits, right.bits);
-        if (tail.op == AddOp::Plus)
-          v.floatVal = checkFPResult(v.floatVal + right.floatVal, opBits);
-        else
-          v.floatVal = checkFPResult(v.floatVal - right.floatVal, opBits);
-        v.bits = opBits;
-      } else if (v.kind == RuntimeValue::Kind::Ptr && right.kind == RuntimeValue::Kind::Int) {
+      if (v.kind == RuntimeValue::Kind::Ptr && right.kind == RuntimeValue::Kind::Int) {
         // ptr ± int: scale offset by element size; result must stay in [base, end].
         // One-past-the-end (== end) is valid for arithmetic but not for dereference.
         // Use ptrBase to find the exact provenance object (enforces field-level boundaries).
@@ -1063,13 +1549,206 @@ namespace symir {
         v.intVal = diff / static_cast<int64_t>(elemSize);
         v.bits = 64;
       } else {
-        throw std::runtime_error("Expr ops only on same scalar kinds (Int/Float)");
+        addScalar(v, right, tail.op);
       }
     }
     return v;
   }
 
+  void Interpreter::addScalar(RuntimeValue &v, const RuntimeValue &right, AddOp op) {
+    if (v.kind == RuntimeValue::Kind::Undef || right.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading undef in expr");
+
+    if (v.kind == RuntimeValue::Kind::Int && right.kind == RuntimeValue::Kind::Int) {
+      // Check overflow against the *declared* bitwidth, not int64.
+      // Use __int128 so the intermediate result never overflows before the check.
+      __int128 a = v.intVal, b = right.intVal;
+      __int128 result = (op == AddOp::Plus) ? (a + b) : (a - b);
+      int64_t smax = (v.bits == 64) ? INT64_MAX : ((INT64_C(1) << (v.bits - 1)) - 1);
+      int64_t smin = (v.bits == 64) ? INT64_MIN : (-(INT64_C(1) << (v.bits - 1)));
+      if (result > (__int128) smax || result < (__int128) smin) {
+        if (op == AddOp::Plus)
+          throw UndefinedBehaviorError("UB: Signed integer overflow in addition");
+        else
+          throw UndefinedBehaviorError("UB: Signed integer overflow in subtraction");
+      }
+      v.intVal = static_cast<int64_t>(result);
+      v.intVal = canonicalize(v.intVal, v.bits);
+    } else if (isFloatPair(v, right)) {
+      // SPEC §6.7: FP expressions are homogeneous, but evalCoef tags
+      // FloatLit with bits=64 (it has no context). Take the narrower of the
+      // two operands so an Expr like `0.125 + (-268435449 as f32)` rounds
+      // at f32 precision instead of inheriting the literal's bits=64. The
+      // result's effective type also narrows for downstream chain steps.
+      uint32_t opBits = std::min(v.bits, right.bits);
+      double lhs = asFloat(v), rhs = asFloat(right);
+      v.kind = RuntimeValue::Kind::Float;
+      if (op == AddOp::Plus)
+        v.floatVal = checkFPResult(lhs + rhs, opBits);
+      else
+        v.floatVal = checkFPResult(lhs - rhs, opBits);
+      v.bits = opBits;
+    } else {
+      throw std::runtime_error("Expr ops only on same scalar kinds (Int/Float)");
+    }
+  }
+
+  Interpreter::RuntimeValue
+  Interpreter::applyScalar(AtomOpKind op, const RuntimeValue &c, const RuntimeValue &r) {
+    if (c.kind == RuntimeValue::Kind::Undef || r.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading undef in op");
+
+    if (c.kind == RuntimeValue::Kind::Int && r.kind == RuntimeValue::Kind::Int) {
+      RuntimeValue res;
+      res.kind = RuntimeValue::Kind::Int;
+      res.bits = c.bits;
+
+      // Compute bitwidth-specific signed min/max for overflow detection.
+      int64_t bw_smax = (c.bits == 64) ? INT64_MAX : ((INT64_C(1) << (c.bits - 1)) - 1);
+      int64_t bw_smin = (c.bits == 64) ? INT64_MIN : (-(INT64_C(1) << (c.bits - 1)));
+
+      if (op == AtomOpKind::Mul) {
+        __int128 prod = (__int128) c.intVal * (__int128) r.intVal;
+        if (prod > (__int128) bw_smax || prod < (__int128) bw_smin)
+          throw UndefinedBehaviorError("UB: Signed integer overflow in multiplication");
+        res.intVal = static_cast<int64_t>(prod);
+      } else if (op == AtomOpKind::Div) {
+        if (r.intVal == 0)
+          throw UndefinedBehaviorError("UB: Division by zero");
+        if (c.intVal == bw_smin && r.intVal == -1)
+          throw UndefinedBehaviorError("UB: Signed integer overflow in division");
+        res.intVal = c.intVal / r.intVal;
+      } else if (op == AtomOpKind::Mod) {
+        if (r.intVal == 0)
+          throw UndefinedBehaviorError("UB: Modulo by zero");
+        if (c.intVal == bw_smin && r.intVal == -1)
+          throw UndefinedBehaviorError("UB: Signed integer overflow in modulo");
+        res.intVal = c.intVal % r.intVal;
+      } else if (op == AtomOpKind::And) {
+        res.intVal = c.intVal & r.intVal;
+      } else if (op == AtomOpKind::Or) {
+        res.intVal = c.intVal | r.intVal;
+      } else if (op == AtomOpKind::Xor) {
+        res.intVal = c.intVal ^ r.intVal;
+      } else if (op == AtomOpKind::Shl || op == AtomOpKind::Shr || op == AtomOpKind::LShr) {
+        if (r.intVal < 0 || (uint64_t) r.intVal >= (uint64_t) res.bits) {
+          throw UndefinedBehaviorError("UB: Overshift");
+        }
+        if (op == AtomOpKind::Shl) {
+          // SPEC §7.1 rule 4: SHL on a negative operand is UB, and
+          // result overflow on a non-negative operand is also UB
+          // (signed-integer overflow, same footing as +/-/*).
+          if (c.intVal < 0)
+            throw UndefinedBehaviorError("UB: Left shift of negative");
+          __int128 prod = (__int128) c.intVal << r.intVal;
+          if (prod > (__int128) bw_smax || prod < (__int128) bw_smin)
+            throw UndefinedBehaviorError("UB: Signed integer overflow in shift");
+          res.intVal = static_cast<int64_t>(prod);
+        } else if (op == AtomOpKind::Shr) {
+          res.intVal = c.intVal >> r.intVal;
+        } else {
+          // Logical shift right: mask to width first
+          uint64_t mask = (res.bits >= 64) ? ~0ULL : (1ULL << res.bits) - 1;
+          res.intVal = (int64_t) ((static_cast<uint64_t>(c.intVal) & mask) >> r.intVal);
+        }
+      }
+      res.intVal = canonicalize(res.intVal, res.bits);
+      return res;
+    } else if (isFloatPair(c, r)) {
+      double cf = asFloat(c), rf = asFloat(r);
+      RuntimeValue res;
+      res.kind = RuntimeValue::Kind::Float;
+      // SPEC §6.7: float expressions are homogeneous — all atoms must
+      // have the same FP type. evalCoef always tags FloatLit with
+      // bits=64 (it has no context), so use the rval's precision (the
+      // typed variable) to recover the expression's true type. Without
+      // this, e.g. `-4.0 * %v0` for %v0:f32 would yield bits=64 and
+      // the surrounding chain would round at f64 precision.
+      res.bits = std::min(c.bits, r.bits);
+      if (op == AtomOpKind::Mul)
+        res.floatVal = checkFPResult(cf * rf, res.bits);
+      else if (op == AtomOpKind::Div)
+        res.floatVal = checkFPResult(cf / rf, res.bits);
+      else if (op == AtomOpKind::Mod)
+        res.floatVal = checkFPResult(std::fmod(cf, rf), res.bits);
+      else
+        throw std::runtime_error("Unsupported op for floats");
+      return res;
+    }
+    throw std::runtime_error("OpAtom requires same scalar kinds");
+  }
+
+  Interpreter::RuntimeValue Interpreter::notScalar(const RuntimeValue &r) {
+    if (r.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading undef in unary op");
+    if (r.kind != RuntimeValue::Kind::Int)
+      throw std::runtime_error("Unary op requires int");
+    RuntimeValue res;
+    res.kind = RuntimeValue::Kind::Int;
+    res.intVal = ~r.intVal;
+    return res;
+  }
+
+  bool Interpreter::compareValues(RelOp op, const RuntimeValue &a, const RuntimeValue &b) {
+    if (a.kind == RuntimeValue::Kind::Undef || b.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: undef in cmp");
+    // [v0.2.1] Rule 14: relational compare of pointers from
+    // different objects (or null vs non-null in a relational
+    // op) is UB. Equality / inequality remain legal.
+    if (a.kind == RuntimeValue::Kind::Ptr || b.kind == RuntimeValue::Kind::Ptr) {
+      bool relational =
+          op == RelOp::LT || op == RelOp::LE || op == RelOp::GT || op == RelOp::GE;
+      if (relational) {
+        uint64_t aBase = (a.kind == RuntimeValue::Kind::Ptr) ? a.ptrBase : 0;
+        uint64_t bBase = (b.kind == RuntimeValue::Kind::Ptr) ? b.ptrBase : 0;
+        if (a.kind != b.kind)
+          throw UndefinedBehaviorError("UB: relational compare between pointer and non-pointer");
+        if (aBase != bBase)
+          throw UndefinedBehaviorError("UB: relational compare of cross-object pointers");
+      }
+      // A non-pointer operand compares as address 0.
+      uint64_t ap = (a.kind == RuntimeValue::Kind::Ptr) ? a.ptrVal : 0;
+      uint64_t bp = (b.kind == RuntimeValue::Kind::Ptr) ? b.ptrVal : 0;
+      switch (op) {
+        case RelOp::EQ:
+          return ap == bp;
+        case RelOp::NE:
+          return ap != bp;
+        case RelOp::LT:
+          return ap < bp;
+        case RelOp::LE:
+          return ap <= bp;
+        case RelOp::GT:
+          return ap > bp;
+        case RelOp::GE:
+          return ap >= bp;
+      }
+      return false;
+    }
+    double af = (a.kind == RuntimeValue::Kind::Float) ? a.floatVal : static_cast<double>(a.intVal);
+    double bf = (b.kind == RuntimeValue::Kind::Float) ? b.floatVal : static_cast<double>(b.intVal);
+    int64_t ai = a.intVal, bi = b.intVal;
+    bool isFP = (a.kind == RuntimeValue::Kind::Float || b.kind == RuntimeValue::Kind::Float);
+    switch (op) {
+      case RelOp::EQ:
+        return isFP ? af == bf : ai == bi;
+      case RelOp::NE:
+        return isFP ? af != bf : ai != bi;
+      case RelOp::LT:
+        return isFP ? af < bf : ai < bi;
+      case RelOp::LE:
+        return isFP ? af <= bf : ai <= bi;
+      case RelOp::GT:
+        return isFP ? af > bf : ai > bi;
+      case RelOp::GE:
+        return isFP ? af >= bf : ai >= bi;
+    }
+    return false;
+  }
+
   Interpreter::RuntimeValue Interpreter::evalAtom(const Atom &a, const Store &store) {
+    if (profiling_)
+      ++profile_->atomCounts[a.v.index()];
     return std::visit(
         [&](auto &&arg) -> RuntimeValue {
           using T = std::decay_t<decltype(arg)>;
@@ -1077,215 +1756,16 @@ namespace symir {
             RuntimeValue c = evalCoef(arg.coef, store);
             RuntimeValue r = evalLValue(arg.rval, store);
             // [v0.2.1] Vector OpAtom: rval is Vec; coef is either Vec or a
-            // scalar literal that broadcasts. Build a per-lane Coef-LValue
-            // and recurse into a synthetic OpAtom evaluation for each lane.
-            if (r.kind == RuntimeValue::Kind::Vec) {
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Vec;
-              res.arrayVal.reserve(r.arrayVal.size());
-              for (size_t k = 0; k < r.arrayVal.size(); ++k) {
-                auto &rL = r.arrayVal[k];
-                RuntimeValue cL = (c.kind == RuntimeValue::Kind::Vec) ? c.arrayVal[k] : c;
-                if (rL.kind == RuntimeValue::Kind::Undef || cL.kind == RuntimeValue::Kind::Undef)
-                  throw UndefinedBehaviorError("UB: Reading undef vector lane");
-                // Inherit the lane's bits for the coef literal (broadcast).
-                if (c.kind != RuntimeValue::Kind::Vec) {
-                  if (cL.kind == RuntimeValue::Kind::Int)
-                    cL.bits = rL.bits;
-                  if (cL.kind == RuntimeValue::Kind::Float)
-                    cL.bits = rL.bits;
-                }
-                // Build a fake one-atom Atom { OpAtom with these scalar
-                // operands } and reuse evalAtom — too involved; inline.
-                RuntimeValue laneRes;
-                if (rL.kind == RuntimeValue::Kind::Int) {
-                  laneRes.kind = RuntimeValue::Kind::Int;
-                  laneRes.bits = rL.bits;
-                  int64_t bw_smax =
-                      (rL.bits == 64) ? INT64_MAX : ((INT64_C(1) << (rL.bits - 1)) - 1);
-                  int64_t bw_smin = (rL.bits == 64) ? INT64_MIN : (-(INT64_C(1) << (rL.bits - 1)));
-                  if (arg.op == AtomOpKind::Mul) {
-                    __int128 p = (__int128) cL.intVal * rL.intVal;
-                    if (p > (__int128) bw_smax || p < (__int128) bw_smin)
-                      throw UndefinedBehaviorError("UB: vector lane overflow in *");
-                    laneRes.intVal = static_cast<int64_t>(p);
-                  } else if (arg.op == AtomOpKind::Div) {
-                    if (rL.intVal == 0)
-                      throw UndefinedBehaviorError("UB: vector lane division by zero");
-                    if (cL.intVal == bw_smin && rL.intVal == -1)
-                      throw UndefinedBehaviorError("UB: vector lane overflow in /");
-                    laneRes.intVal = cL.intVal / rL.intVal;
-                  } else if (arg.op == AtomOpKind::Mod) {
-                    if (rL.intVal == 0)
-                      throw UndefinedBehaviorError("UB: vector lane modulo by zero");
-                    if (cL.intVal == bw_smin && rL.intVal == -1)
-                      throw UndefinedBehaviorError("UB: vector lane overflow in %");
-                    laneRes.intVal = cL.intVal % rL.intVal;
-                  } else if (arg.op == AtomOpKind::And)
-                    laneRes.intVal = cL.intVal & rL.intVal;
-                  else if (arg.op == AtomOpKind::Or)
-                    laneRes.intVal = cL.intVal | rL.intVal;
-                  else if (arg.op == AtomOpKind::Xor)
-                    laneRes.intVal = cL.intVal ^ rL.intVal;
-                  else if (arg.op == AtomOpKind::Shl || arg.op == AtomOpKind::Shr ||
-                           arg.op == AtomOpKind::LShr) {
-                    if (rL.intVal < 0 || (uint64_t) rL.intVal >= (uint64_t) laneRes.bits)
-                      throw UndefinedBehaviorError("UB: vector lane overshift");
-                    if (arg.op == AtomOpKind::Shl) {
-                      if (cL.intVal < 0)
-                        throw UndefinedBehaviorError("UB: vector lane left shift of negative");
-                      __int128 p = (__int128) cL.intVal << rL.intVal;
-                      if (p > (__int128) bw_smax || p < (__int128) bw_smin)
-                        throw UndefinedBehaviorError("UB: vector lane overflow in <<");
-                      laneRes.intVal = static_cast<int64_t>(p);
-                    } else if (arg.op == AtomOpKind::Shr) {
-                      laneRes.intVal = cL.intVal >> rL.intVal;
-                    } else {
-                      uint64_t mask = (laneRes.bits >= 64) ? ~0ULL : (1ULL << laneRes.bits) - 1;
-                      laneRes.intVal =
-                          (int64_t) ((static_cast<uint64_t>(cL.intVal) & mask) >> rL.intVal);
-                    }
-                  }
-                  laneRes.intVal = canonicalize(laneRes.intVal, laneRes.bits);
-                } else if (rL.kind == RuntimeValue::Kind::Float) {
-                  laneRes.kind = RuntimeValue::Kind::Float;
-                  laneRes.bits = std::min(cL.bits, rL.bits);
-                  if (arg.op == AtomOpKind::Mul)
-                    laneRes.floatVal = checkFPResult(cL.floatVal * rL.floatVal, laneRes.bits);
-                  else if (arg.op == AtomOpKind::Div)
-                    laneRes.floatVal = checkFPResult(cL.floatVal / rL.floatVal, laneRes.bits);
-                  else if (arg.op == AtomOpKind::Mod)
-                    laneRes.floatVal =
-                        checkFPResult(std::fmod(cL.floatVal, rL.floatVal), laneRes.bits);
-                  else
-                    throw std::runtime_error("Unsupported op for float vector lane");
-                } else {
-                  throw std::runtime_error("Unsupported vector lane kind in OpAtom");
-                }
-                res.arrayVal.push_back(std::move(laneRes));
-              }
-              return res;
-            }
-            if (c.kind == RuntimeValue::Kind::Undef || r.kind == RuntimeValue::Kind::Undef)
-              throw UndefinedBehaviorError("UB: Reading undef in op");
-
-            // Promote Int to Float if needed (Literal inference support)
-            if (c.kind == RuntimeValue::Kind::Float && r.kind == RuntimeValue::Kind::Int) {
-              r.floatVal = static_cast<double>(r.intVal);
-              r.kind = RuntimeValue::Kind::Float;
-            } else if (c.kind == RuntimeValue::Kind::Int && r.kind == RuntimeValue::Kind::Float) {
-              c.floatVal = static_cast<double>(c.intVal);
-              c.kind = RuntimeValue::Kind::Float;
-            }
-
-            if (c.kind == RuntimeValue::Kind::Int && r.kind == RuntimeValue::Kind::Int) {
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Int;
-              res.bits = c.bits;
-
-              // Compute bitwidth-specific signed min/max for overflow detection.
-              int64_t bw_smax = (c.bits == 64) ? INT64_MAX : ((INT64_C(1) << (c.bits - 1)) - 1);
-              int64_t bw_smin = (c.bits == 64) ? INT64_MIN : (-(INT64_C(1) << (c.bits - 1)));
-
-              if (arg.op == AtomOpKind::Mul) {
-                __int128 prod = (__int128) c.intVal * (__int128) r.intVal;
-                if (prod > (__int128) bw_smax || prod < (__int128) bw_smin)
-                  throw UndefinedBehaviorError("UB: Signed integer overflow in multiplication");
-                res.intVal = static_cast<int64_t>(prod);
-              } else if (arg.op == AtomOpKind::Div) {
-                if (r.intVal == 0)
-                  throw UndefinedBehaviorError("UB: Division by zero");
-                if (c.intVal == bw_smin && r.intVal == -1)
-                  throw UndefinedBehaviorError("UB: Signed integer overflow in division");
-                res.intVal = c.intVal / r.intVal;
-              } else if (arg.op == AtomOpKind::Mod) {
-                if (r.intVal == 0)
-                  throw UndefinedBehaviorError("UB: Modulo by zero");
-                if (c.intVal == bw_smin && r.intVal == -1)
-                  throw UndefinedBehaviorError("UB: Signed integer overflow in modulo");
-                res.intVal = c.intVal % r.intVal;
-              } else if (arg.op == AtomOpKind::And) {
-                res.intVal = c.intVal & r.intVal;
-              } else if (arg.op == AtomOpKind::Or) {
-                res.intVal = c.intVal | r.intVal;
-              } else if (arg.op == AtomOpKind::Xor) {
-                res.intVal = c.intVal ^ r.intVal;
-              } else if (arg.op == AtomOpKind::Shl || arg.op == AtomOpKind::Shr ||
-                         arg.op == AtomOpKind::LShr) {
-                if (r.intVal < 0 || (uint64_t) r.intVal >= (uint64_t) res.bits) {
-                  throw UndefinedBehaviorError("UB: Overshift");
-                }
-                if (arg.op == AtomOpKind::Shl) {
-                  // SPEC §7.1 rule 4: SHL on a negative operand is UB, and
-                  // result overflow on a non-negative operand is also UB
-                  // (signed-integer overflow, same footing as +/-/*).
-                  if (c.intVal < 0)
-                    throw UndefinedBehaviorError("UB: Left shift of negative");
-                  __int128 prod = (__int128) c.intVal << r.intVal;
-                  if (prod > (__int128) bw_smax || prod < (__int128) bw_smin)
-                    throw UndefinedBehaviorError("UB: Signed integer overflow in shift");
-                  res.intVal = static_cast<int64_t>(prod);
-                } else if (arg.op == AtomOpKind::Shr) {
-                  res.intVal = c.intVal >> r.intVal;
-                } else {
-                  // Logical shift right: mask to width first
-                  uint64_t mask = (res.bits >= 64) ? ~0ULL : (1ULL << res.bits) - 1;
-                  res.intVal = (int64_t) ((static_cast<uint64_t>(c.intVal) & mask) >> r.intVal);
-                }
-              }
-              res.intVal = canonicalize(res.intVal, res.bits);
-              return res;
-            } else if (c.kind == RuntimeValue::Kind::Float && r.kind == RuntimeValue::Kind::Float) {
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Float;
-              // SPEC §6.7: float expressions are homogeneous — all atoms must
-              // have the same FP type. evalCoef always tags FloatLit with
-              // bits=64 (it has no context), so use the rval's precision (the
-              // typed variable) to recover the expression's true type. Without
-              // this, e.g. `-4.0 * %v0` for %v0:f32 would yield bits=64 and
-              // the surrounding chain would round at f64 precision.
-              res.bits = std::min(c.bits, r.bits);
-              if (arg.op == AtomOpKind::Mul)
-                res.floatVal = checkFPResult(c.floatVal * r.floatVal, res.bits);
-              else if (arg.op == AtomOpKind::Div)
-                res.floatVal = checkFPResult(c.floatVal / r.floatVal, res.bits);
-              else if (arg.op == AtomOpKind::Mod)
-                res.floatVal = checkFPResult(std::fmod(c.floatVal, r.floatVal), res.bits);
-              else
-                throw std::runtime_error("Unsupported op for floats");
-              return res;
-            }
-            throw std::runtime_error("OpAtom requires same scalar kinds");
+            // scalar literal that broadcasts.
+            if (r.kind == RuntimeValue::Kind::Vec)
+              return applyVec(arg.op, c, r);
+            return applyScalar(arg.op, c, r);
           } else if constexpr (std::is_same_v<T, UnaryAtom>) {
             RuntimeValue r = evalLValue(arg.rval, store);
             // [v0.2.1] Vector unary ~: lane-wise.
-            if (r.kind == RuntimeValue::Kind::Vec) {
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Vec;
-              res.arrayVal.reserve(r.arrayVal.size());
-              for (auto &lane: r.arrayVal) {
-                if (lane.kind == RuntimeValue::Kind::Undef)
-                  throw UndefinedBehaviorError("UB: Reading undef lane in unary");
-                if (lane.kind != RuntimeValue::Kind::Int)
-                  throw std::runtime_error("Vector unary ~ requires integer lanes");
-                RuntimeValue laneRes;
-                laneRes.kind = RuntimeValue::Kind::Int;
-                laneRes.bits = lane.bits;
-                laneRes.intVal = canonicalize(~lane.intVal, lane.bits);
-                res.arrayVal.push_back(std::move(laneRes));
-              }
-              return res;
-            }
-            if (r.kind == RuntimeValue::Kind::Undef)
-              throw UndefinedBehaviorError("UB: Reading undef in unary op");
-            if (r.kind != RuntimeValue::Kind::Int)
-              throw std::runtime_error("Unary op requires int");
-            RuntimeValue res;
-            res.kind = RuntimeValue::Kind::Int;
-            if (arg.op == UnaryOpKind::Not) {
-              res.intVal = ~r.intVal;
-            }
-            return res;
+            if (r.kind == RuntimeValue::Kind::Vec)
+              return notVec(r);
+            return notScalar(r);
           } else if constexpr (std::is_same_v<T, SelectAtom>) {
             // [v0.2.1] Two forms. Mask form requires lane-wise (or scalar
             // i1) blend; Cond form is the existing scalar boolean select.
@@ -1298,24 +1778,7 @@ namespace symir {
             if (mask.kind == RuntimeValue::Kind::Vec) {
               RuntimeValue vt = evalSelectVal(arg.vtrue, store);
               RuntimeValue vf = evalSelectVal(arg.vfalse, store);
-              if (vt.kind != RuntimeValue::Kind::Vec || vf.kind != RuntimeValue::Kind::Vec ||
-                  vt.arrayVal.size() != mask.arrayVal.size() ||
-                  vf.arrayVal.size() != mask.arrayVal.size())
-                throw std::runtime_error("Mask-based select: lane count mismatch");
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Vec;
-              res.arrayVal.reserve(mask.arrayVal.size());
-              for (size_t k = 0; k < mask.arrayVal.size(); ++k) {
-                const auto &mL = mask.arrayVal[k];
-                if (mL.kind == RuntimeValue::Kind::Undef)
-                  throw UndefinedBehaviorError("UB: undef mask lane");
-                bool pick = (mL.intVal != 0);
-                const auto &chosen = pick ? vt.arrayVal[k] : vf.arrayVal[k];
-                if (chosen.kind == RuntimeValue::Kind::Undef)
-                  throw UndefinedBehaviorError("UB: undef lane selected by mask");
-                res.arrayVal.push_back(chosen);
-              }
-              return res;
+              return selectVec(mask, vt, vf);
             }
             // Scalar i1 mask: all-or-nothing.
             if (mask.kind == RuntimeValue::Kind::Undef)
@@ -1326,83 +1789,12 @@ namespace symir {
             // [v0.2.1] Reified comparison. Both operands are SelectVal.
             RuntimeValue lv = evalSelectVal(arg.lhs, store);
             RuntimeValue rv = evalSelectVal(arg.rhs, store);
-            auto cmpScalar = [&](const RuntimeValue &a, const RuntimeValue &b) -> bool {
-              if (a.kind == RuntimeValue::Kind::Undef || b.kind == RuntimeValue::Kind::Undef)
-                throw UndefinedBehaviorError("UB: undef in cmp");
-              // [v0.2.1] Rule 14: relational compare of pointers from
-              // different objects (or null vs non-null in a relational
-              // op) is UB. Equality / inequality remain legal.
-              if (a.kind == RuntimeValue::Kind::Ptr || b.kind == RuntimeValue::Kind::Ptr) {
-                bool relational = arg.op == RelOp::LT || arg.op == RelOp::LE ||
-                                  arg.op == RelOp::GT || arg.op == RelOp::GE;
-                if (relational) {
-                  uint64_t aBase = (a.kind == RuntimeValue::Kind::Ptr) ? a.ptrBase : 0;
-                  uint64_t bBase = (b.kind == RuntimeValue::Kind::Ptr) ? b.ptrBase : 0;
-                  if (a.kind != b.kind)
-                    throw UndefinedBehaviorError(
-                        "UB: relational compare between pointer and non-pointer"
-                    );
-                  if (aBase != bBase)
-                    throw UndefinedBehaviorError("UB: relational compare of cross-object pointers");
-                }
-                bool eq = a.ptrVal == b.ptrVal;
-                switch (arg.op) {
-                  case RelOp::EQ:
-                    return eq;
-                  case RelOp::NE:
-                    return !eq;
-                  case RelOp::LT:
-                    return a.ptrVal < b.ptrVal;
-                  case RelOp::LE:
-                    return a.ptrVal <= b.ptrVal;
-                  case RelOp::GT:
-                    return a.ptrVal > b.ptrVal;
-                  case RelOp::GE:
-                    return a.ptrVal >= b.ptrVal;
-                }
-                return false;
-              }
-              double af = (a.kind == RuntimeValue::Kind::Float) ? a.floatVal
-                                                                : static_cast<double>(a.intVal);
-              double bf = (b.kind == RuntimeValue::Kind::Float) ? b.floatVal
-                                                                : static_cast<double>(b.intVal);
-              int64_t ai = a.intVal, bi = b.intVal;
-              bool isFP =
-                  (a.kind == RuntimeValue::Kind::Float || b.kind == RuntimeValue::Kind::Float);
-              switch (arg.op) {
-                case RelOp::EQ:
-                  return isFP ? af == bf : ai == bi;
-                case RelOp::NE:
-                  return isFP ? af != bf : ai != bi;
-                case RelOp::LT:
-                  return isFP ? af < bf : ai < bi;
-                case RelOp::LE:
-                  return isFP ? af <= bf : ai <= bi;
-                case RelOp::GT:
-                  return isFP ? af > bf : ai > bi;
-                case RelOp::GE:
-                  return isFP ? af >= bf : ai >= bi;
-              }
-              return false;
-            };
-            if (lv.kind == RuntimeValue::Kind::Vec) {
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Vec;
-              res.arrayVal.reserve(lv.arrayVal.size());
-              for (size_t k = 0; k < lv.arrayVal.size(); ++k) {
-                bool b = cmpScalar(lv.arrayVal[k], rv.arrayVal[k]);
-                RuntimeValue lane;
-                lane.kind = RuntimeValue::Kind::Int;
-                lane.bits = 1;
-                lane.intVal = b ? 1 : 0;
-                res.arrayVal.push_back(std::move(lane));
-              }
-              return res;
-            }
+            if (lv.kind == RuntimeValue::Kind::Vec)
+              return cmpVec(arg.op, lv, rv);
             RuntimeValue res;
             res.kind = RuntimeValue::Kind::Int;
             res.bits = 1;
-            res.intVal = cmpScalar(lv, rv) ? 1 : 0;
+            res.intVal = compareValues(arg.op, lv, rv) ? 1 : 0;
             return res;
           } else if constexpr (std::is_same_v<T, CoefAtom>) {
             return evalCoef(arg.coef, store);
@@ -1437,20 +1829,20 @@ namespace symir {
                 const RuntimeValue &sv = store.at(varName);
                 uint64_t elemSize = 8, count = 1;
                 if (sv.kind == RuntimeValue::Kind::Array) {
-                  count = sv.arrayVal.size();
-                  elemSize = sv.arrayVal.empty() ? 4
-                             : (sv.arrayVal[0].kind == RuntimeValue::Kind::Int)
-                                 ? (sv.arrayVal[0].bits + 7) / 8
-                             : (sv.arrayVal[0].kind == RuntimeValue::Kind::Float)
-                                 ? sv.arrayVal[0].bits / 8
+                  const auto &elems = sv.elements();
+                  count = elems.size();
+                  elemSize = elems.empty() ? 4
+                             : (elems[0].kind == RuntimeValue::Kind::Int)
+                                 ? (elems[0].bits + 7) / 8
+                             : (elems[0].kind == RuntimeValue::Kind::Float)
+                                 ? elems[0].bits / 8
                                  : 8;
                 } else if (sv.kind == RuntimeValue::Kind::Int) {
                   elemSize = (sv.bits + 7) / 8;
                 } else if (sv.kind == RuntimeValue::Kind::Float) {
                   elemSize = sv.bits / 8;
                 }
-                base = nextAddr_;
-                nextAddr_ += (elemSize * count + 7) & ~7ULL;
+                base = allocBytes(elemSize * count);
                 TypePtr varType = typeMap_.at(varName);
                 addObject(
                     ObjectInfo{
@@ -1459,21 +1851,18 @@ namespace symir {
                     }
                 );
                 addrMap_[varName] = base;
-                if (sv.kind == RuntimeValue::Kind::Array) {
-                  for (size_t i = 0; i < sv.arrayVal.size(); ++i)
-                    heap_[base + i * elemSize] = sv.arrayVal[i];
-                } else {
-                  heap_[base] = sv;
-                }
+                storeCell(base, varType, sv);
               }
             }
 
             // Find the top-level ObjectInfo for the variable.
             const ObjectInfo *curObj = nullptr;
-            for (const auto &o: objects_) {
-              if (o.varName == varName && o.fieldName.empty() && o.base == base) {
-                curObj = &o;
-                break;
+            if (auto bit = byBase_.find(base); bit != byBase_.end()) {
+              for (std::uint32_t i: bit->second) {
+                if (objects_[i].varName == varName && objects_[i].fieldName.empty()) {
+                  curObj = &objects_[i];
+                  break;
+                }
               }
             }
             if (!curObj) {
@@ -1501,7 +1890,7 @@ namespace symir {
                 } else {
                   const auto &id = std::get<LocalOrSymId>(ai->index);
                   RuntimeValue idxRv = std::get_if<LocalId>(&id)
-                                           ? store.at(std::get_if<LocalId>(&id)->name)
+                                           ? readVar(std::get_if<LocalId>(&id)->name, store)
                                            : store.at(std::get_if<SymId>(&id)->name);
                   idx = idxRv.intVal;
                 }
@@ -1594,20 +1983,22 @@ namespace symir {
             // the pointer's type doesn't match that ObjectInfo's type,
             // the types disagree.
             const ObjectInfo *cellObj = findObject(ptrRv.ptrVal);
-            if (cellObj && cellObj->type) {
-              if (auto ptrTy = getLValueType(arg.rval)) {
-                if (auto pt = std::get_if<PtrType>(&ptrTy->v)) {
-                  TypePtr cellType =
-                      getCellTypeAtOffset(cellObj->type, ptrRv.ptrVal - cellObj->base);
-                  if (!TypeUtils::areTypesEqual(pt->pointee, cellType))
-                    throw UndefinedBehaviorError("UB: Typed-access mismatch (rule 15b)");
-                }
-              }
+            TypePtr pointee;
+            if (auto ptrTy = getLValueType(arg.rval)) {
+              if (auto pt = std::get_if<PtrType>(&ptrTy->v))
+                pointee = pt->pointee;
+            }
+            if (cellObj && cellObj->type && pointee) {
+              TypePtr cellType = getCellTypeAtOffset(cellObj->type, ptrRv.ptrVal - cellObj->base);
+              if (!TypeUtils::areTypesEqual(pointee, cellType))
+                throw UndefinedBehaviorError("UB: Typed-access mismatch (rule 15b)");
             }
-            auto hit = heap_.find(ptrRv.ptrVal);
-            if (hit == heap_.end())
+            TypePtr cellType = cellTypeAt(ptrRv.ptrVal);
+            if (!cellType)
+              cellType = pointee;
+            if (!cellType)
               throw UndefinedBehaviorError("UB: Load from uninitialized memory");
-            return hit->second;
+            return loadCell(ptrRv.ptrVal, cellType);
           } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
             // [v0.2.1] §6.8.9: ptrindex <ptr>, <index> navigates a ptr [N] T
             // to ptr T at element `index`. Strict UB at the navigation site
@@ -1653,7 +2044,7 @@ namespace symir {
             } else {
               const auto &id = std::get<LocalOrSymId>(arg.index);
               RuntimeValue idxRv = std::get_if<LocalId>(&id)
-                                       ? store.at(std::get_if<LocalId>(&id)->name)
+                                       ? readVar(std::get_if<LocalId>(&id)->name, store)
                                        : store.at(std::get_if<SymId>(&id)->name);
               if (idxRv.kind == RuntimeValue::Kind::Undef)
                 throw UndefinedBehaviorError("UB: 'ptrindex' index is undef");
@@ -1821,94 +2212,11 @@ namespace symir {
                 },
                 arg.src
             );
-            if (v.kind == RuntimeValue::Kind::Undef)
-              throw UndefinedBehaviorError("UB: Reading undef in cast");
-
             // [v0.2.1] Vector cast: lane-wise. v is a Vec; dstType is <N> U.
-            if (v.kind == RuntimeValue::Kind::Vec) {
-              auto vt = TypeUtils::asVec(arg.dstType);
-              if (!vt)
-                throw std::runtime_error("Vector cast requires vector dst");
-              if (v.arrayVal.size() != vt->size)
-                throw std::runtime_error("Vector cast: lane count mismatch");
-              RuntimeValue res;
-              res.kind = RuntimeValue::Kind::Vec;
-              res.arrayVal.reserve(vt->size);
-              auto laneBits = TypeUtils::getBitWidth(vt->elem);
-              bool isFp = vt->elem && std::holds_alternative<FloatType>(vt->elem->v);
-              bool isF32 = isFp && std::get<FloatType>(vt->elem->v).kind == FloatType::Kind::F32;
-              uint32_t fpBits = isFp ? (isF32 ? 32u : 64u) : 0u;
-              for (auto &lane: v.arrayVal) {
-                if (lane.kind == RuntimeValue::Kind::Undef)
-                  throw UndefinedBehaviorError("UB: undef lane in cast");
-                RuntimeValue r;
-                if (laneBits) {
-                  r.kind = RuntimeValue::Kind::Int;
-                  r.bits = *laneBits;
-                  if (lane.kind == RuntimeValue::Kind::Int) {
-                    r.intVal = canonicalize(lane.intVal, r.bits);
-                  } else {
-                    double lo = -std::ldexp(1.0, static_cast<int>(r.bits) - 1);
-                    double hi = std::ldexp(1.0, static_cast<int>(r.bits) - 1);
-                    if (std::isnan(lane.floatVal) || std::isinf(lane.floatVal) ||
-                        lane.floatVal < lo || lane.floatVal >= hi)
-                      throw UndefinedBehaviorError("UB: vector lane float->int OOR");
-                    r.intVal = static_cast<int64_t>(lane.floatVal);
-                  }
-                } else if (isFp) {
-                  r.kind = RuntimeValue::Kind::Float;
-                  r.bits = fpBits;
-                  double raw = (lane.kind == RuntimeValue::Kind::Int)
-                                   ? static_cast<double>(lane.intVal)
-                                   : lane.floatVal;
-                  r.floatVal = isF32 ? static_cast<double>(static_cast<float>(raw)) : raw;
-                  if (isF32 && std::isinf(r.floatVal))
-                    throw UndefinedBehaviorError("UB: vector lane f32 overflow to inf");
-                } else {
-                  throw std::runtime_error("Vector cast: unsupported lane dst type");
-                }
-                res.arrayVal.push_back(std::move(r));
-              }
-              return res;
-            }
+            if (v.kind == RuntimeValue::Kind::Vec)
+              return castVec(v, arg.dstType);
 
-            RuntimeValue res;
-            auto dstBits = TypeUtils::getBitWidth(arg.dstType);
-            if (dstBits) {
-              res.kind = RuntimeValue::Kind::Int;
-              res.bits = *dstBits;
-              if (v.kind == RuntimeValue::Kind::Int) {
-                res.intVal = canonicalize(v.intVal, res.bits);
-              } else {
-                // Float to Int: check for out-of-range (spec §7.4 rule 8).
-                // lo = -2^(bits-1), hi = 2^(bits-1); valid range is [lo, hi).
-                double lo = -std::ldexp(1.0, static_cast<int>(res.bits) - 1);
-                double hi = std::ldexp(1.0, static_cast<int>(res.bits) - 1);
-                if (std::isnan(v.floatVal) || std::isinf(v.floatVal) || v.floatVal < lo ||
-                    v.floatVal >= hi)
-                  throw UndefinedBehaviorError("UB: Float-to-integer cast out of range");
-                res.intVal = static_cast<int64_t>(v.floatVal);
-              }
-            } else if (arg.dstType && std::holds_alternative<FloatType>(arg.dstType->v)) {
-              res.kind = RuntimeValue::Kind::Float;
-              bool isF32 = std::get<FloatType>(arg.dstType->v).kind == FloatType::Kind::F32;
-              res.bits = isF32 ? 32 : 64;
-              double raw =
-                  (v.kind == RuntimeValue::Kind::Int) ? static_cast<double>(v.intVal) : v.floatVal;
-              // For f32 destination, round to f32 precision so the stored
-              // value matches what C/WASM lowering would compute. Without
-              // this, e.g. `268435457 as f32` would stay as 268435457.0 in
-              // double precision instead of being rounded to 268435456.0f
-              // (round-to-nearest-even at the f32 boundary).
-              res.floatVal = isF32 ? static_cast<double>(static_cast<float>(raw)) : raw;
-              // SPEC §6.4 / §7.4 rule 6: f64 -> f32 narrowing is UB if the
-              // result overflows to ±∞ (e.g. 1e40 as f32). Trap here for any
-              // FP -> f32 that produced ±∞ after rounding (integer sources
-              // can't overflow per spec, but the check covers them harmlessly).
-              if (isF32 && std::isinf(res.floatVal))
-                throw UndefinedBehaviorError("UB: Float narrowing cast overflows to infinity");
-            }
-            return res;
+            return castScalar(v, arg.dstType);
           }
           return RuntimeValue{};
         },
@@ -1916,6 +2224,50 @@ namespace symir {
     );
   }
 
+  Interpreter::RuntimeValue
+  Interpreter::castScalar(const RuntimeValue &v, const TypePtr &dstType) {
+    if (v.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading undef in cast");
+
+    RuntimeValue res;
+    auto dstBits = TypeUtils::getBitWidth(dstType);
+    if (dstBits) {
+      res.kind = RuntimeValue::Kind::Int;
+      res.bits = *dstBits;
+      if (v.kind == RuntimeValue::Kind::Int) {
+        res.intVal = canonicalize(v.intVal, res.bits);
+      } else {
+        // Float to Int: check for out-of-range (spec §7.4 rule 8).
+        // lo = -2^(bits-1), hi = 2^(bits-1); valid range is [lo, hi).
+        double lo = -std::ldexp(1.0, static_cast<int>(res.bits) - 1);
+        double hi = std::ldexp(1.0, static_cast<int>(res.bits) - 1);
+        if (std::isnan(v.floatVal) || std::isinf(v.floatVal) || v.floatVal < lo ||
+            v.floatVal >= hi)
+          throw UndefinedBehaviorError("UB: Float-to-integer cast out of range");
+        res.intVal = static_cast<int64_t>(v.floatVal);
+      }
+    } else if (dstType && std::holds_alternative<FloatType>(dstType->v)) {
+      res.kind = RuntimeValue::Kind::Float;
+      bool isF32 = std::get<FloatType>(dstType->v).kind == FloatType::Kind::F32;
+      res.bits = isF32 ? 32 : 64;
+      double raw =
+          (v.kind == RuntimeValue::Kind::Int) ? static_cast<double>(v.intVal) : v.floatVal;
+      // For f32 destination, round to f32 precision so the stored
+      // value matches what C/WASM lowering would compute. Without
+      // this, e.g. `268435457 as f32` would stay as 268435457.0 in
+      // double precision instead of being rounded to 268435456.0f
+      // (round-to-nearest-even at the f32 boundary).
+      res.floatVal = isF32 ? static_cast<double>(static_cast<float>(raw)) : raw;
+      // SPEC §6.4 / §7.4 rule 6: f64 -> f32 narrowing is UB if the
+      // result overflows to ±∞ (e.g. 1e40 as f32). Trap here for any
+      // FP -> f32 that produced ±∞ after rounding (integer sources
+      // can't overflow per spec, but the check covers them harmlessly).
+      if (isF32 && std::isinf(res.floatVal))
+        throw UndefinedBehaviorError("UB: Float narrowing cast overflows to infinity");
+    }
+    return res;
+  }
+
   Interpreter::RuntimeValue Interpreter::evalCoef(const Coef &c, const Store &store) {
     if (std::holds_alternative<IntLit>(c)) {
       RuntimeValue rv;
@@ -1940,7 +2292,7 @@ namespace symir {
     }
     const auto &id = std::get<LocalOrSymId>(c);
     if (auto lid = std::get_if<LocalId>(&id))
-      return store.at(lid->name);
+      return readVar(lid->name, store);
     auto sid = std::get_if<SymId>(&id);
     if (store.count(sid->name))
       return store.at(sid->name);
@@ -1954,15 +2306,21 @@ namespace symir {
   }
 
   Interpreter::RuntimeValue Interpreter::evalLValue(const LValue &lv, const Store &store) {
+    if (!addrMap_.empty()) {
+      auto ait = addrMap_.find(lv.base.name);
+      if (ait != addrMap_.end()) {
+        TypePtr t;
+        std::uint64_t addr = lvalueAddress(lv, ait->second, t, store, true);
+        RuntimeValue v = loadCell(addr, t);
+        if (v.kind == RuntimeValue::Kind::Undef)
+          throw UndefinedBehaviorError("UB: Reading undef value");
+        return v;
+      }
+    }
     const RuntimeValue *cur = &store.at(lv.base.name);
 
     for (const auto &acc: lv.accesses) {
       if (auto ai = std::get_if<AccessIndex>(&acc)) {
-        if (cur->kind == RuntimeValue::Kind::Undef)
-          throw UndefinedBehaviorError("UB: Reading field of undef");
-        if (cur->kind != RuntimeValue::Kind::Array && cur->kind != RuntimeValue::Kind::Vec)
-          throw std::runtime_error("Indexing non-array");
-
         // Eval index
         RuntimeValue idxVal;
         const auto &idx = ai->index;
@@ -1972,31 +2330,22 @@ namespace symir {
         } else {
           const auto &id = std::get<LocalOrSymId>(idx);
           if (auto lid = std::get_if<LocalId>(&id))
-            idxVal = store.at(lid->name);
+            idxVal = readVar(lid->name, store);
           else { // SymId
             auto sid = std::get_if<SymId>(&id);
             idxVal = store.at(sid->name);
           }
         }
-        if (idxVal.kind == RuntimeValue::Kind::Undef)
-          throw UndefinedBehaviorError("UB: Undef index");
-
-        if (idxVal.intVal < 0 || (size_t) idxVal.intVal >= cur->arrayVal.size())
-          throw UndefinedBehaviorError(
-              cur->kind == RuntimeValue::Kind::Vec ? "UB: Vector lane index out of bounds"
-                                                   : "UB: Array index out of bounds"
-          );
-
-        cur = &cur->arrayVal[idxVal.intVal];
+        // Lanes are packed, and a lane is the last access of its lvalue.
+        if (cur->kind == RuntimeValue::Kind::Vec) {
+          RuntimeValue lane = readLane(*cur, idxVal);
+          if (lane.kind == RuntimeValue::Kind::Undef)
+            throw UndefinedBehaviorError("UB: Reading undef value");
+          return lane;
+        }
+        cur = &readElement(*cur, idxVal);
       } else if (auto af = std::get_if<AccessField>(&acc)) {
-        if (cur->kind == RuntimeValue::Kind::Undef)
-          throw UndefinedBehaviorError("UB: Reading field of undef");
-        if (cur->kind != RuntimeValue::Kind::Struct)
-          throw std::runtime_error("Accessing field of non-struct");
-        auto it = cur->structVal.find(af->field);
-        if (it == cur->structVal.end())
-          throw UndefinedBehaviorError("UB: Uninitialized field read");
-        cur = &it->second;
+        cur = &readField(*cur, af->field);
       }
     }
     if (cur->kind == RuntimeValue::Kind::Undef)
@@ -2004,13 +2353,95 @@ namespace symir {
     return *cur;
   }
 
+  const Interpreter::RuntimeValue &
+  Interpreter::readElement(const RuntimeValue &cur, const RuntimeValue &idx) {
+    if (cur.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading field of undef");
+    if (cur.kind != RuntimeValue::Kind::Array)
+      throw std::runtime_error("Indexing non-array");
+    if (idx.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Undef index");
+    if (idx.intVal < 0 || (size_t) idx.intVal >= cur.elements().size())
+      throw UndefinedBehaviorError("UB: Array index out of bounds");
+    return cur.elements()[idx.intVal];
+  }
+
+  const Interpreter::RuntimeValue &
+  Interpreter::readField(const RuntimeValue &cur, const std::string &field) {
+    if (cur.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading field of undef");
+    if (cur.kind != RuntimeValue::Kind::Struct)
+      throw std::runtime_error("Accessing field of non-struct");
+    const RuntimeValue *v = cur.field(field);
+    if (!v)
+      throw UndefinedBehaviorError("UB: Uninitialized field read");
+    return *v;
+  }
+
+  const Interpreter::RuntimeValue &
+  Interpreter::readField(const RuntimeValue &cur, std::uint32_t index) {
+    if (cur.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading field of undef");
+    if (cur.kind != RuntimeValue::Kind::Struct)
+      throw std::runtime_error("Accessing field of non-struct");
+    return cur.elements()[index];
+  }
+
+  Interpreter::RuntimeValue &Interpreter::writeElement(RuntimeValue &cur, std::int64_t idx) {
+    if (cur.kind != RuntimeValue::Kind::Array)
+      throw std::runtime_error("Indexing non-array");
+    if (idx < 0 || (size_t) idx >= cur.elements().size())
+      throw UndefinedBehaviorError("UB: Array index out of bounds");
+    return cur.mutableElements()[idx];
+  }
+
+  Interpreter::RuntimeValue &Interpreter::writeField(RuntimeValue &cur, const std::string &field) {
+    if (cur.kind != RuntimeValue::Kind::Struct)
+      throw std::runtime_error("Accessing field of non-struct");
+    RuntimeValue *v = cur.mutableField(field);
+    if (!v)
+      throw std::runtime_error("Unknown field: " + field);
+    return *v;
+  }
+
+  Interpreter::RuntimeValue &Interpreter::writeField(RuntimeValue &cur, std::uint32_t index) {
+    if (cur.kind != RuntimeValue::Kind::Struct)
+      throw std::runtime_error("Accessing field of non-struct");
+    return cur.mutableElements()[index];
+  }
+
+  void Interpreter::assignValue(RuntimeValue &cur, const RuntimeValue &val) {
+    // Enforce destination precision.
+    //   Int:   canonicalize to bit width.
+    //   Float: round to declared precision (f32 destinations must store the
+    //          f32 image, not the wider double the RHS evaluator may have
+    //          produced — evalCoef tags FloatLit with bits=64 by default).
+    std::uint32_t bits = cur.bits;
+    cur = val;
+    if (cur.kind == RuntimeValue::Kind::Int) {
+      cur.bits = bits;
+      cur.intVal = canonicalize(cur.intVal, bits);
+    } else if (cur.kind == RuntimeValue::Kind::Float) {
+      cur.bits = bits;
+      if (bits == 32)
+        cur.floatVal = static_cast<double>(static_cast<float>(cur.floatVal));
+    }
+  }
+
   void Interpreter::setLValue(const LValue &lv, RuntimeValue val, Store &store) {
+    if (!addrMap_.empty()) {
+      auto ait = addrMap_.find(lv.base.name);
+      if (ait != addrMap_.end()) {
+        TypePtr t;
+        std::uint64_t addr = lvalueAddress(lv, ait->second, t, store, false);
+        storeCell(addr, t, val);
+        return;
+      }
+    }
     RuntimeValue *cur = &store.at(lv.base.name);
 
     for (const auto &acc: lv.accesses) {
       if (auto ai = std::get_if<AccessIndex>(&acc)) {
-        if (cur->kind != RuntimeValue::Kind::Array && cur->kind != RuntimeValue::Kind::Vec)
-          throw std::runtime_error("Indexing non-array");
         RuntimeValue idxVal;
         const auto &idx = ai->index;
         if (std::holds_alternative<IntLit>(idx)) {
@@ -2019,149 +2450,34 @@ namespace symir {
         } else {
           const auto &id = std::get<LocalOrSymId>(idx);
           if (auto lid = std::get_if<LocalId>(&id))
-            idxVal = store.at(lid->name);
+            idxVal = readVar(lid->name, store);
           else {
             auto sid = std::get_if<SymId>(&id);
             idxVal = store.at(sid->name);
           }
         }
-        if (idxVal.intVal < 0 || (size_t) idxVal.intVal >= cur->arrayVal.size())
-          throw UndefinedBehaviorError(
-              cur->kind == RuntimeValue::Kind::Vec ? "UB: Vector lane index out of bounds"
-                                                   : "UB: Array index out of bounds"
-          );
-        cur = &cur->arrayVal[idxVal.intVal];
-      } else if (auto af = std::get_if<AccessField>(&acc)) {
-        if (cur->kind != RuntimeValue::Kind::Struct)
-          throw std::runtime_error("Accessing field of non-struct");
-        cur = &cur->structVal[af->field];
-      }
-    }
-
-    // Enforce destination precision.
-    //   Int:   canonicalize to bit width.
-    //   Float: round to declared precision (f32 destinations must store the
-    //          f32 image, not the wider double the RHS evaluator may have
-    //          produced — evalCoef tags FloatLit with bits=64 by default).
-    if (val.kind == RuntimeValue::Kind::Int) {
-      val.bits = cur->bits;
-      val.intVal = canonicalize(val.intVal, val.bits);
-    } else if (val.kind == RuntimeValue::Kind::Float) {
-      val.bits = cur->bits;
-      if (val.bits == 32)
-        val.floatVal = static_cast<double>(static_cast<float>(val.floatVal));
-    }
-    *cur = val;
-
-    // Spec §9.4.7 / interp Store↔Heap consistency: when an addr-taken local
-    // is updated via a direct assignment, the heap-side mirror must reflect
-    // the new value so subsequent loads through `load <ptr>` see it.
-    auto ait = addrMap_.find(lv.base.name);
-    if (ait == addrMap_.end())
-      return;
-    uint64_t base = ait->second;
-    const RuntimeValue &top = store.at(lv.base.name);
-
-    // For nested accesses, recompute the offset relative to base.
-    uint64_t addr = base;
-    const RuntimeValue *walk = &top;
-    auto typeIt = typeMap_.find(lv.base.name);
-    TypePtr curType = (typeIt != typeMap_.end()) ? typeIt->second : nullptr;
-    for (const auto &acc: lv.accesses) {
-      if (auto ai = std::get_if<AccessIndex>(&acc)) {
-        if (walk->kind != RuntimeValue::Kind::Array)
+        if (cur->kind == RuntimeValue::Kind::Vec) {
+          writeLane(*cur, idxVal.intVal, val);
           return;
-        int64_t idx = 0;
-        if (std::holds_alternative<IntLit>(ai->index))
-          idx = std::get<IntLit>(ai->index).value;
-        else {
-          const auto &id = std::get<LocalOrSymId>(ai->index);
-          idx = std::visit([&](auto &&v) { return store.at(v.name).intVal; }, id);
         }
-        if (idx < 0 || (size_t) idx >= walk->arrayVal.size())
-          return;
-        uint64_t elemSize = 0;
-        if (curType) {
-          if (auto at = std::get_if<ArrayType>(&curType->v)) {
-            elemSize = sizeofType(at->elem);
-            curType = at->elem;
-          }
-        }
-        if (elemSize == 0)
-          return; // no type info — give up syncing nested case
-        addr += idx * elemSize;
-        walk = &walk->arrayVal[idx];
+        cur = &writeElement(*cur, idxVal.intVal);
       } else if (auto af = std::get_if<AccessField>(&acc)) {
-        if (walk->kind != RuntimeValue::Kind::Struct)
-          return;
-        if (!curType)
-          return;
-        auto st = std::get_if<StructType>(&curType->v);
-        if (!st)
-          return;
-        auto sit = structs_.find(st->name.name);
-        if (sit == structs_.end())
-          return;
-        addr += fieldOffset(*sit->second, af->field);
-        for (const auto &f: sit->second->fields)
-          if (f.name == af->field) {
-            curType = f.type;
-            break;
-          }
-        auto sfit = walk->structVal.find(af->field);
-        if (sfit == walk->structVal.end())
-          return;
-        walk = &sfit->second;
+        cur = &writeField(*cur, af->field);
       }
     }
-
-    std::function<void(uint64_t, const RuntimeValue &, const TypePtr &)> flattenToHeap =
-        [&](uint64_t targetAddr, const RuntimeValue &rv, const TypePtr &ty) {
-          if (rv.kind == RuntimeValue::Kind::Array) {
-            auto innerAt = ty ? std::get_if<ArrayType>(&ty->v) : nullptr;
-            auto innerElem = innerAt ? innerAt->elem : TypePtr{};
-            uint64_t innerElemSz = innerElem ? sizeofType(innerElem) : 4;
-            for (std::size_t j = 0; j < rv.arrayVal.size(); ++j)
-              flattenToHeap(targetAddr + j * innerElemSz, rv.arrayVal[j], innerElem);
-          } else if (rv.kind == RuntimeValue::Kind::Struct) {
-            auto innerSt = ty ? std::get_if<StructType>(&ty->v) : nullptr;
-            if (innerSt) {
-              auto sd = structs_.find(innerSt->name.name);
-              if (sd != structs_.end()) {
-                uint64_t off = 0;
-                for (const auto &f: sd->second->fields) {
-                  auto fit = rv.structVal.find(f.name);
-                  if (fit != rv.structVal.end()) {
-                    flattenToHeap(targetAddr + off, fit->second, f.type);
-                  }
-                  off += sizeofType(f.type);
-                }
-              }
-            }
-          } else {
-            heap_[targetAddr] = rv;
-          }
-        };
-
-    flattenToHeap(addr, *walk, curType);
+    assignValue(*cur, val);
   }
 
   bool Interpreter::evalCond(const Cond &c, const Store &store) {
     RuntimeValue l = evalExpr(c.lhs, store);
     RuntimeValue r = evalExpr(c.rhs, store);
+    return condValues(c.op, l, r);
+  }
 
+  bool Interpreter::condValues(RelOp op, const RuntimeValue &l, const RuntimeValue &r) {
     if (l.kind == RuntimeValue::Kind::Undef || r.kind == RuntimeValue::Kind::Undef)
       throw UndefinedBehaviorError("UB: Reading undef in condition");
 
-    // Promote Int to Float if needed (Literal inference support)
-    if (l.kind == RuntimeValue::Kind::Float && r.kind == RuntimeValue::Kind::Int) {
-      r.floatVal = static_cast<double>(r.intVal);
-      r.kind = RuntimeValue::Kind::Float;
-    } else if (l.kind == RuntimeValue::Kind::Int && r.kind == RuntimeValue::Kind::Float) {
-      l.floatVal = static_cast<double>(l.intVal);
-      l.kind = RuntimeValue::Kind::Float;
-    }
-
     if (l.kind == RuntimeValue::Kind::Int && r.kind == RuntimeValue::Kind::Int) {
       // [v0.2.1] For comparisons involving i1 (boolean) values, use the
       // unsigned (masked) representation so that `true` (canonicalized as
@@ -2171,7 +2487,7 @@ namespace symir {
         li = li & 1;
       if (r.bits == 1)
         ri = ri & 1;
-      switch (c.op) {
+      switch (op) {
         case RelOp::EQ:
           return li == ri;
         case RelOp::NE:
@@ -2185,24 +2501,25 @@ namespace symir {
         case RelOp::GE:
           return li >= ri;
       }
-    } else if (l.kind == RuntimeValue::Kind::Float && r.kind == RuntimeValue::Kind::Float) {
-      switch (c.op) {
+    } else if (isFloatPair(l, r)) {
+      double lf = asFloat(l), rf = asFloat(r);
+      switch (op) {
         case RelOp::EQ:
-          return l.floatVal == r.floatVal;
+          return lf == rf;
         case RelOp::NE:
-          return l.floatVal != r.floatVal;
+          return lf != rf;
         case RelOp::LT:
-          return l.floatVal < r.floatVal;
+          return lf < rf;
         case RelOp::LE:
-          return l.floatVal <= r.floatVal;
+          return lf <= rf;
         case RelOp::GT:
-          return l.floatVal > r.floatVal;
+          return lf > rf;
         case RelOp::GE:
-          return l.floatVal >= r.floatVal;
+          return lf >= rf;
       }
     }
     if (l.kind == RuntimeValue::Kind::Ptr && r.kind == RuntimeValue::Kind::Ptr) {
-      switch (c.op) {
+      switch (op) {
         case RelOp::EQ:
           return l.ptrVal == r.ptrVal;
         case RelOp::NE:
@@ -2217,11 +2534,11 @@ namespace symir {
             throw UndefinedBehaviorError(
                 "UB: Relational pointer comparison across different objects"
             );
-          if (c.op == RelOp::LT)
+          if (op == RelOp::LT)
             return l.ptrVal < r.ptrVal;
-          if (c.op == RelOp::LE)
+          if (op == RelOp::LE)
             return l.ptrVal <= r.ptrVal;
-          if (c.op == RelOp::GT)
+          if (op == RelOp::GT)
             return l.ptrVal > r.ptrVal;
           return l.ptrVal >= r.ptrVal;
         }
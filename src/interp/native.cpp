@@ -0,0 +1,466 @@
+#include "interp/native.hpp"
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include "analysis/type_utils.hpp"
+#include "backend/c_backend.hpp"
+
+extern char **environ;
+
+namespace symir {
+
+  namespace {
+
+    namespace fs = std::filesystem;
+
+    // Flags of every native build. The UBSan checks trap (SIGILL) instead
+    // of calling into a sanitizer runtime, which a dlopen()ed object
+    // cannot rely on.
+    const char *const kCFlags[] = {
+        "-O2",
+        "-fPIC",
+        "-shared",
+        "-w",
+        "-fsanitize=undefined,float-cast-overflow",
+        "-fsanitize-undefined-trap-on-error",
+        "-fno-sanitize-recover=all",
+    };
+
+    // Shared with the shim below: what one call passes to the native code.
+    struct Frame {
+      const std::int64_t *ints;
+      const double *floats;
+      std::int64_t iret;
+      double fret;
+      int failKind; // 1 require, 2 assume (see CBackend::setCheckHook)
+      const char *failMsg;
+    };
+
+    using RunFn = void (*)(Frame *);
+
+    // The call in progress on this thread, where a trap jumps back to.
+    struct Active {
+      sigjmp_buf jmp;
+      Frame frame;
+      bool running = false;
+    };
+    thread_local Active active;
+
+    void onTrap(int sig) {
+      if (!active.running) {
+        ::signal(sig, SIG_DFL); // not ours: crash as usual
+        ::raise(sig);
+        return;
+      }
+      siglongjmp(active.jmp, sig);
+    }
+
+    void installTrapHandlers() {
+      static std::once_flag once;
+      std::call_once(once, [] {
+        struct sigaction sa {};
+        sa.sa_handler = onTrap;
+        sigemptyset(&sa.sa_mask);
+        for (int sig: {SIGILL, SIGFPE, SIGSEGV, SIGBUS, SIGTRAP})
+          sigaction(sig, &sa, nullptr);
+      });
+    }
+
+    std::string fnv1a(const std::string &s) {
+      std::uint64_t h = 0xcbf29ce484222325ull;
+      for (unsigned char c: s) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+      }
+      char buf[17];
+      std::snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(h));
+      return buf;
+    }
+
+    const char *signalName(int sig) {
+      switch (sig) {
+        case SIGILL:
+          return "SIGILL";
+        case SIGFPE:
+          return "SIGFPE";
+        case SIGSEGV:
+          return "SIGSEGV";
+        case SIGBUS:
+          return "SIGBUS";
+        default:
+          return "SIGTRAP";
+      }
+    }
+
+    std::vector<std::string> compilerCommand() {
+      const char *cc = std::getenv("CC");
+      std::istringstream ss(cc && *cc ? cc : "cc");
+      std::vector<std::string> cmd;
+      for (std::string w; ss >> w;)
+        cmd.push_back(w);
+      return cmd;
+    }
+
+    // Runs `argv`, with stdout and stderr going to `logPath`.
+    bool runCompiler(const std::vector<std::string> &argv, const std::string &logPath) {
+      std::vector<char *> args;
+      for (const auto &a: argv)
+        args.push_back(const_cast<char *>(a.c_str()));
+      args.push_back(nullptr);
+      posix_spawn_file_actions_t fa;
+      posix_spawn_file_actions_init(&fa);
+      posix_spawn_file_actions_addopen(&fa, 1, logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      posix_spawn_file_actions_adddup2(&fa, 1, 2);
+      pid_t pid;
+      int err = posix_spawnp(&pid, args[0], &fa, nullptr, args.data(), environ);
+      posix_spawn_file_actions_destroy(&fa);
+      if (err)
+        return false;
+      int status = 0;
+      while (waitpid(pid, &status, 0) < 0)
+        if (errno != EINTR)
+          return false;
+      return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    const FunDecl &findFunction(const Program &prog, const std::string &entry) {
+      for (const auto &f: prog.funs)
+        if (f.name.name == entry)
+          return f;
+      throw std::runtime_error("Entry function not found: " + entry);
+    }
+
+    std::string typeReason(const Program &prog, const TypePtr &t) {
+      if (!t)
+        return "";
+      if (auto it = std::get_if<IntType>(&t->v)) {
+        int bits = it->kind == IntType::Kind::I32   ? 32
+                   : it->kind == IntType::Kind::I64 ? 64
+                                                    : it->bits.value_or(32);
+        // Narrower C integers promote to int, so their overflow goes unseen.
+        if (bits != 32 && bits != 64)
+          return "i" + std::to_string(bits) + " values";
+        return "";
+      }
+      if (std::holds_alternative<FloatType>(t->v))
+        return "";
+      if (auto at = std::get_if<ArrayType>(&t->v))
+        return typeReason(prog, at->elem);
+      if (auto st = std::get_if<StructType>(&t->v)) {
+        for (const auto &s: prog.structs) {
+          if (s.name.name != st->name.name)
+            continue;
+          for (const auto &fd: s.fields)
+            if (auto r = typeReason(prog, fd.type); !r.empty())
+              return r;
+        }
+        return "";
+      }
+      // Vector lanes and pointer provenance are not checked by UBSan.
+      if (std::holds_alternative<VecType>(t->v))
+        return "vectors";
+      return "pointers";
+    }
+
+    bool holdsUndef(const InitVal &iv) {
+      if (iv.kind == InitVal::Kind::Undef)
+        return true;
+      if (auto elems = std::get_if<std::vector<InitValPtr>>(&iv.value))
+        for (const auto &e: *elems)
+          if (e && holdsUndef(*e))
+            return true;
+      return false;
+    }
+
+    std::string exprReason(const Program &prog, const Expr &e);
+
+    std::string condReason(const Program &prog, const Cond &c) {
+      auto r = exprReason(prog, c.lhs);
+      return r.empty() ? exprReason(prog, c.rhs) : r;
+    }
+
+    // Atoms whose type no declaration names: casts and cmp results.
+    std::string atomReason(const Program &prog, const Atom &a) {
+      if (auto c = std::get_if<CastAtom>(&a.v))
+        return typeReason(prog, c->dstType);
+      if (std::holds_alternative<CmpAtom>(a.v))
+        return "i1 values";
+      if (auto s = std::get_if<SelectAtom>(&a.v)) {
+        if (s->cond)
+          return condReason(prog, *s->cond);
+        if (s->maskExpr)
+          return exprReason(prog, *s->maskExpr);
+      }
+      return "";
+    }
+
+    std::string exprReason(const Program &prog, const Expr &e) {
+      auto r = atomReason(prog, e.first);
+      for (const auto &t: e.rest)
+        if (r.empty())
+          r = atomReason(prog, t.atom);
+      return r;
+    }
+
+    std::string blockReason(const Program &prog, const Block &b) {
+      for (const auto &ins: b.instrs) {
+        std::string r = std::visit(
+            [&](const auto &i) -> std::string {
+              using T = std::decay_t<decltype(i)>;
+              if constexpr (std::is_same_v<T, AssignInstr>)
+                return exprReason(prog, i.rhs);
+              else if constexpr (std::is_same_v<T, StoreInstr>)
+                return "pointers";
+              else
+                return condReason(prog, i.cond);
+            },
+            ins
+        );
+        if (!r.empty())
+          return r;
+      }
+      if (auto br = std::get_if<BrTerm>(&b.term); br && br->cond)
+        return condReason(prog, *br->cond);
+      if (auto ret = std::get_if<RetTerm>(&b.term); ret && ret->value)
+        return exprReason(prog, *ret->value);
+      return "";
+    }
+
+  } // namespace
+
+  std::string NativeFunction::unsupportedReason(const Program &prog, const std::string &entry) {
+    const FunDecl &f = findFunction(prog, entry);
+    if (!f.params.empty())
+      return entry + " takes parameters";
+    if (f.retType && !std::holds_alternative<IntType>(f.retType->v) &&
+        !std::holds_alternative<FloatType>(f.retType->v))
+      return entry + " returns an aggregate";
+    if (auto r = typeReason(prog, f.retType); !r.empty())
+      return entry + " uses " + r;
+    for (const auto &s: f.syms)
+      if (auto r = typeReason(prog, s.type); !r.empty())
+        return entry + " uses " + r;
+    for (const auto &l: f.lets) {
+      if (auto r = typeReason(prog, l.type); !r.empty())
+        return entry + " uses " + r;
+      // Undef scalars are rejected statically (DefiniteInitAnalysis); undef
+      // elements are only found when read, which native code cannot see.
+      bool scalar = std::holds_alternative<IntType>(l.type->v) ||
+                    std::holds_alternative<FloatType>(l.type->v);
+      if (l.init ? holdsUndef(*l.init) : !scalar)
+        return "local " + l.name.name + " may hold undef";
+    }
+    for (const auto &b: f.blocks) {
+      if (auto r = blockReason(prog, b); !r.empty())
+        return entry + " uses " + r;
+      if (auto ret = std::get_if<RetTerm>(&b.term); ret && !ret->value && f.retType)
+        return entry + " returns without a value";
+    }
+    return "";
+  }
+
+  std::string NativeFunction::defaultCacheDir() {
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+      return std::string(xdg) + "/symir/native";
+    if (const char *home = std::getenv("HOME"); home && *home)
+      return std::string(home) + "/.cache/symir/native";
+    return "/tmp/symir-native-" + std::to_string(::getuid());
+  }
+
+  NativeFunction::NativeFunction(
+      const Program &prog, const std::string &entry, const std::string &cacheDir
+  ) {
+    std::vector<std::string> sources{source(prog, entry, "")};
+    std::string path;
+    auto handle = load(sources, cacheDir, path);
+    bind(std::move(handle), path, "");
+  }
+
+  std::vector<std::unique_ptr<NativeFunction>>
+  NativeFunction::buildAll(const std::vector<Entry> &entries, const std::string &cacheDir) {
+    std::vector<std::unique_ptr<NativeFunction>> fns;
+    std::vector<std::string> sources;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      fns.emplace_back(new NativeFunction());
+      sources.push_back(fns.back()->source(*entries[i].prog, entries[i].entry, std::to_string(i)));
+    }
+    if (fns.empty())
+      return fns;
+    std::string path;
+    auto handle = load(sources, cacheDir, path);
+    for (std::size_t i = 0; i < fns.size(); ++i)
+      fns[i]->bind(handle, path, std::to_string(i));
+    return fns;
+  }
+
+  std::string
+  NativeFunction::source(const Program &prog, const std::string &entry, const std::string &tag) {
+    fun_ = &findFunction(prog, entry);
+    for (const auto &s: fun_->syms)
+      syms_.push_back({s.name.name, std::holds_alternative<FloatType>(s.type->v)});
+    hasRet_ = fun_->retType != nullptr;
+    retFloat_ = hasRet_ && std::holds_alternative<FloatType>(fun_->retType->v);
+
+    std::string check = "symiri_native_check" + tag;
+    std::ostringstream src;
+    {
+      CBackend backend(src);
+      backend.setCheckHook(check);
+      backend.emit(prog);
+    }
+    // The entry shim. Symbol values and the results of a call live in its
+    // Frame, reached through a thread-local so that threads do not share.
+    src << "\n// symiri --native shim\n"
+        << "struct symiri_native_frame {\n"
+        << "  const int64_t *ints;\n  const double *floats;\n  int64_t iret;\n  double fret;\n"
+        << "  int fail_kind;\n  const char *fail_msg;\n};\n"
+        << "static _Thread_local struct symiri_native_frame *symiri_native_cur;\n\n"
+        << "void " << check << "(int kind, const char *msg) {\n"
+        << "  symiri_native_cur->fail_kind = kind;\n"
+        << "  symiri_native_cur->fail_msg = msg;\n"
+        << "  __builtin_trap();\n}\n\n";
+    for (std::size_t i = 0; i < fun_->syms.size(); ++i) {
+      const SymDecl &s = fun_->syms[i];
+      bool f32 = syms_[i].isFloat && std::get<FloatType>(s.type->v).kind == FloatType::Kind::F32;
+      // The C type CBackend declares the getter with.
+      unsigned bits = syms_[i].isFloat ? 0u : TypeUtils::getBitWidth(s.type).value_or(64);
+      const char *type = syms_[i].isFloat ? (f32 ? "float" : "double")
+                         : bits <= 8      ? "int8_t"
+                         : bits <= 16     ? "int16_t"
+                         : bits <= 32     ? "int32_t"
+                                          : "int64_t";
+      src << type << " " << CBackend::getMangledSymbolName(entry, s.name.name) << "(void) {\n"
+          << "  return (" << type << ")symiri_native_cur->"
+          << (syms_[i].isFloat ? "floats" : "ints") << "[" << i << "];\n}\n";
+    }
+    src << "\nvoid symiri_native_run" << tag << "(struct symiri_native_frame *f) {\n"
+        << "  symiri_native_cur = f;\n  ";
+    if (hasRet_)
+      src << "f->" << (retFloat_ ? "fret" : "iret") << " = ";
+    src << CBackend::mangleName(entry) << "();\n}\n";
+    return src.str();
+  }
+
+  std::shared_ptr<void> NativeFunction::load(
+      const std::vector<std::string> &sources, const std::string &cacheDir, std::string &path
+  ) {
+    std::vector<std::string> cmd = compilerCommand();
+    cmd.insert(cmd.end(), std::begin(kCFlags), std::end(kCFlags));
+    std::string key;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+      if (i)
+        key += '\0';
+      key += sources[i];
+    }
+    for (const auto &a: cmd)
+      key += '\0' + a;
+    std::string base = (fs::path(cacheDir) / fnv1a(key)).string();
+    path = base + ".so";
+
+    if (!fs::exists(path)) {
+      fs::create_directories(cacheDir);
+      std::vector<std::string> files;
+      for (std::size_t i = 0; i < sources.size(); ++i) {
+        files.push_back(sources.size() == 1 ? base + ".c" : base + "_" + std::to_string(i) + ".c");
+        std::ofstream out(files.back());
+        out << sources[i];
+        if (!out)
+          throw std::runtime_error("Could not write " + files.back());
+      }
+      // Build under a private name, then publish atomically: concurrent
+      // symiri processes may build the same program.
+      std::string tmp = base + "." + std::to_string(::getpid()) + ".tmp";
+      cmd.insert(cmd.end(), {"-o", tmp});
+      cmd.insert(cmd.end(), files.begin(), files.end());
+      cmd.push_back("-lm");
+      if (!runCompiler(cmd, base + ".log")) {
+        fs::remove(tmp);
+        throw std::runtime_error("Native build failed; see " + base + ".log");
+      }
+      fs::rename(tmp, path);
+    }
+
+    void *handle = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+      throw std::runtime_error(std::string("Could not load native code: ") + ::dlerror());
+    installTrapHandlers();
+    return std::shared_ptr<void>(handle, [](void *h) { ::dlclose(h); });
+  }
+
+  void NativeFunction::bind(
+      std::shared_ptr<void> handle, const std::string &path, const std::string &tag
+  ) {
+    handle_ = std::move(handle);
+    libPath_ = path;
+    run_ = ::dlsym(handle_.get(), ("symiri_native_run" + tag).c_str());
+    if (!run_)
+      throw std::runtime_error("Native code has no entry shim: " + libPath_);
+  }
+
+  NativeFunction::~NativeFunction() = default;
+
+  Interpreter::CallResult NativeFunction::call(const Interpreter::SymBindings &symBindings) const {
+    using Status = Interpreter::CallResult::Status;
+    Interpreter::CallResult out;
+    std::vector<std::int64_t> ints(syms_.size());
+    std::vector<double> floats(syms_.size());
+    for (std::size_t i = 0; i < syms_.size(); ++i) {
+      auto it = symBindings.find(syms_[i].name);
+      if (it == symBindings.end()) {
+        out.status = Status::Error;
+        out.message = "Symbol " + syms_[i].name + " has no binding (provide --sym " +
+                      syms_[i].name + "=<value>)";
+        return out;
+      }
+      // Converted as the interpreter binds symbols.
+      std::visit(
+          [&](auto v) {
+            if (syms_[i].isFloat)
+              floats[i] = static_cast<double>(v);
+            else
+              ints[i] = static_cast<std::int64_t>(v);
+          },
+          it->second
+      );
+    }
+
+    active.frame = Frame{ints.data(), floats.data(), 0, 0.0, 0, nullptr};
+    active.running = true;
+    if (int sig = sigsetjmp(active.jmp, 1)) {
+      active.running = false;
+      const Frame &f = active.frame;
+      if (f.failKind == 1) {
+        out.status = Status::RequireViolation;
+        out.message = f.failMsg ? f.failMsg : "Requirement failed";
+      } else if (f.failKind == 2) {
+        out.status = Status::Error;
+        out.message = "Assumption failed";
+      } else {
+        out.status = Status::UndefinedBehavior;
+        out.message = std::string("UB: Native code trapped (") + signalName(sig) + ")";
+      }
+      return out;
+    }
+    reinterpret_cast<RunFn>(run_)(&active.frame);
+    active.running = false;
+    if (hasRet_) {
+      if (retFloat_)
+        out.value = active.frame.fret;
+      else
+        out.value = active.frame.iret;
+    }
+    return out;
+  }
+
+} // namespace symir
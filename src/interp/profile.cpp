@@ -0,0 +1,118 @@
+#include "interp/profile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include "analysis/cfg.hpp"
+#include "frontend/diagnostics.hpp"
+#include "json.hpp"
+
+namespace symir {
+
+  namespace {
+
+    CFG profileCfg(const Profile &p) {
+      if (!p.fun)
+        throw std::runtime_error("Empty profile");
+      DiagBag diags;
+      CFG cfg = CFG::build(*p.fun, diags);
+      if (diags.hasErrors())
+        throw std::runtime_error("CFG build failed for profile");
+      return cfg;
+    }
+
+    std::uint64_t edgeCount(const Profile &p, std::size_t from, std::size_t to) {
+      auto it = p.edgeCounts.find(Profile::edgeKey(from, to));
+      return it == p.edgeCounts.end() ? 0 : it->second;
+    }
+
+    // Edges into a block no later in reverse postorder: loop back edges.
+    std::vector<std::size_t> rpoIndex(const CFG &cfg) {
+      std::vector<std::size_t> at(cfg.blocks.size(), cfg.blocks.size());
+      auto order = cfg.rpo();
+      for (std::size_t i = 0; i < order.size(); ++i)
+        at[order[i]] = i;
+      return at;
+    }
+
+    std::string seconds(double s) {
+      char buf[32];
+      std::snprintf(buf, sizeof buf, "%.9f", s);
+      return buf;
+    }
+
+  } // namespace
+
+  void writeProfileJson(const Profile &p, std::ostream &os) {
+    CFG cfg = profileCfg(p);
+    auto rpo = rpoIndex(cfg);
+    os << "{\n  \"function\": " << json::quote(p.fun->name.name) << ",\n";
+    os << "  \"steps\": " << p.steps << ",\n";
+    os << "  \"blocks\": [";
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) {
+      os << (b ? ",\n" : "\n") << "    {\"label\": " << json::quote(cfg.blocks[b])
+         << ", \"count\": " << p.blockCounts[b];
+      if (p.timed)
+        os << ", \"seconds\": " << seconds(p.blockSeconds[b]);
+      os << "}";
+    }
+    os << "\n  ],\n  \"edges\": [";
+    bool first = true;
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) {
+      for (std::size_t s: cfg.succ[b]) {
+        os << (first ? "\n" : ",\n") << "    {\"from\": " << json::quote(cfg.blocks[b])
+           << ", \"to\": " << json::quote(cfg.blocks[s]) << ", \"count\": " << edgeCount(p, b, s);
+        if (rpo[s] <= rpo[b])
+          os << ", \"back\": true";
+        os << "}";
+        first = false;
+      }
+    }
+    os << "\n  ],\n  \"instructions\": {";
+    for (std::size_t i = 0; i < p.instrCounts.size(); ++i)
+      os << (i ? ", " : "") << json::quote(Profile::kInstrNames[i]) << ": " << p.instrCounts[i];
+    os << "},\n  \"atoms\": {";
+    for (std::size_t i = 0; i < p.atomCounts.size(); ++i)
+      os << (i ? ", " : "") << json::quote(Profile::kAtomNames[i]) << ": " << p.atomCounts[i];
+    os << "}\n}\n";
+  }
+
+  void writeProfileDot(const Profile &p, std::ostream &os) {
+    CFG cfg = profileCfg(p);
+    auto rpo = rpoIndex(cfg);
+    std::uint64_t hottest = 1;
+    for (auto c: p.blockCounts)
+      hottest = std::max(hottest, c);
+    os << "digraph " << json::quote(p.fun->name.name) << " {\n";
+    os << "  node [shape=box, style=filled, colorscheme=ylorrd9];\n";
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) {
+      std::uint64_t n = p.blockCounts[b];
+      // Heat 1 (pale) .. 9 (hottest), linear in the count.
+      unsigned heat = n ? 1 + static_cast<unsigned>(8 * n / hottest) : 1;
+      heat = std::min(heat, 9u);
+      std::string label = cfg.blocks[b] + "\\n" + std::to_string(n);
+      if (p.timed)
+        label += "\\n" + seconds(p.blockSeconds[b]) + " s";
+      os << "  b" << b << " [label=\"" << label << "\", fillcolor=" << heat;
+      if (heat >= 7)
+        os << ", fontcolor=white";
+      if (!n)
+        os << ", style=\"filled,dashed\"";
+      os << "];\n";
+    }
+    for (std::size_t b = 0; b < cfg.blocks.size(); ++b) {
+      for (std::size_t s: cfg.succ[b]) {
+        std::uint64_t n = edgeCount(p, b, s);
+        double width = 1.0 + 4.0 * static_cast<double>(n) / static_cast<double>(hottest);
+        os << "  b" << b << " -> b" << s << " [label=\"" << n << "\", penwidth=" << width;
+        if (!n)
+          os << ", style=dashed";
+        if (rpo[s] <= rpo[b])
+          os << ", constraint=false";
+        os << "];\n";
+      }
+    }
+    os << "}\n";
+  }
+
+} // namespace symir
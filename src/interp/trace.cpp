@@ -0,0 +1,280 @@
+#include "interp/trace.hpp"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#ifdef SYMIR_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace symir {
+
+  namespace {
+
+    constexpr char kMagic[4] = {'S', 'Y', 'T', 'R'};
+    constexpr std::uint8_t kVersion = 1;
+
+    std::uint64_t zigzag(std::int64_t v) {
+      return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t v) {
+      return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+    }
+
+    // Buffered byte source over a plain or (with zlib) gzip file.
+    class TraceReader {
+    public:
+      explicit TraceReader(const std::string &path) {
+#ifdef SYMIR_HAVE_ZLIB
+        file_ = gzopen(path.c_str(), "rb"); // also reads uncompressed files
+#else
+        file_ = std::fopen(path.c_str(), "rb");
+#endif
+        if (!file_)
+          throw std::runtime_error("Could not open trace file " + path);
+      }
+      ~TraceReader() {
+#ifdef SYMIR_HAVE_ZLIB
+        gzclose(static_cast<gzFile>(file_));
+#else
+        std::fclose(static_cast<std::FILE *>(file_));
+#endif
+      }
+
+      bool atEnd() {
+        return pos_ == len_ && !fill();
+      }
+      std::uint8_t get() {
+        if (atEnd())
+          throw std::runtime_error("Truncated trace file");
+        return buf_[pos_++];
+      }
+      std::uint64_t getVarint() {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+          std::uint8_t b = get();
+          v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+          if (!(b & 0x80))
+            return v;
+        }
+        throw std::runtime_error("Malformed varint in trace file");
+      }
+
+    private:
+      bool fill() {
+#ifdef SYMIR_HAVE_ZLIB
+        int n = gzread(static_cast<gzFile>(file_), buf_, sizeof(buf_));
+        len_ = n > 0 ? static_cast<std::size_t>(n) : 0;
+#else
+        len_ = std::fread(buf_, 1, sizeof(buf_), static_cast<std::FILE *>(file_));
+#endif
+        pos_ = 0;
+        return len_ > 0;
+      }
+
+      void *file_ = nullptr;
+      std::size_t pos_ = 0, len_ = 0;
+      std::uint8_t buf_[1 << 16];
+    };
+
+  } // namespace
+
+  bool traceCompressionAvailable() {
+#ifdef SYMIR_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  TraceWriter::TraceWriter(const std::string &path, bool compress) {
+    if (compress) {
+#ifdef SYMIR_HAVE_ZLIB
+      // The fastest level: records are written from the interpreter loop.
+      file_ = gzopen(path.c_str(), "wb1");
+      gz_ = true;
+#else
+      throw std::runtime_error("Compressed traces need a build with zlib");
+#endif
+    } else {
+      file_ = std::fopen(path.c_str(), "wb");
+    }
+    if (!file_)
+      throw std::runtime_error("Could not open trace file " + path);
+    for (char c: kMagic)
+      put(static_cast<std::uint8_t>(c));
+    put(kVersion);
+  }
+
+  TraceWriter::~TraceWriter() {
+    put(static_cast<std::uint8_t>(Record::End));
+    flush();
+#ifdef SYMIR_HAVE_ZLIB
+    if (gz_) {
+      gzclose(static_cast<gzFile>(file_));
+      return;
+    }
+#endif
+    std::fclose(static_cast<std::FILE *>(file_));
+  }
+
+  void TraceWriter::flush() {
+    if (!len_)
+      return;
+#ifdef SYMIR_HAVE_ZLIB
+    if (gz_) {
+      gzwrite(static_cast<gzFile>(file_), buf_, static_cast<unsigned>(len_));
+      len_ = 0;
+      return;
+    }
+#endif
+    std::fwrite(buf_, 1, len_, static_cast<std::FILE *>(file_));
+    len_ = 0;
+  }
+
+  void TraceWriter::putVarint(std::uint64_t v) {
+    while (v >= 0x80) {
+      put(static_cast<std::uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    put(static_cast<std::uint8_t>(v));
+  }
+
+  std::uint32_t TraceWriter::intern(const std::string &s) {
+    auto [it, fresh] = ids_.try_emplace(s, static_cast<std::uint32_t>(ids_.size()));
+    if (fresh) {
+      put(static_cast<std::uint8_t>(Record::String));
+      putVarint(it->second);
+      putVarint(s.size());
+      for (char c: s)
+        put(static_cast<std::uint8_t>(c));
+    }
+    return it->second;
+  }
+
+  void TraceWriter::block(std::uint32_t label) {
+    put(static_cast<std::uint8_t>(Record::Block));
+    putVarint(label);
+  }
+
+  void TraceWriter::assignUndef(std::uint32_t lv) {
+    put(static_cast<std::uint8_t>(Record::Assign));
+    putVarint(lv);
+    put(static_cast<std::uint8_t>(Value::Undef));
+  }
+
+  void TraceWriter::assignInt(std::uint32_t lv, std::int64_t value, std::uint32_t bits) {
+    put(static_cast<std::uint8_t>(Record::Assign));
+    putVarint(lv);
+    put(static_cast<std::uint8_t>(Value::Int));
+    putVarint(zigzag(value));
+    put(static_cast<std::uint8_t>(bits));
+  }
+
+  void TraceWriter::assignFloat(std::uint32_t lv, double value, std::uint32_t bits) {
+    put(static_cast<std::uint8_t>(Record::Assign));
+    putVarint(lv);
+    put(static_cast<std::uint8_t>(Value::Float));
+    put(static_cast<std::uint8_t>(bits));
+    std::uint64_t raw;
+    std::memcpy(&raw, &value, sizeof raw);
+    for (int i = 0; i < 8; ++i)
+      put(static_cast<std::uint8_t>(raw >> (8 * i)));
+  }
+
+  void TraceWriter::assignPtr(std::uint32_t lv, std::uint64_t addr) {
+    put(static_cast<std::uint8_t>(Record::Assign));
+    putVarint(lv);
+    put(static_cast<std::uint8_t>(Value::Ptr));
+    putVarint(addr);
+  }
+
+  void TraceWriter::assignText(std::uint32_t lv, const std::string &text) {
+    std::uint32_t id = intern(text);
+    put(static_cast<std::uint8_t>(Record::Assign));
+    putVarint(lv);
+    put(static_cast<std::uint8_t>(Value::Text));
+    putVarint(id);
+  }
+
+  void decodeTrace(const std::string &path, std::ostream &os) {
+    TraceReader in(path);
+    char magic[4];
+    for (char &c: magic)
+      c = static_cast<char>(in.get());
+    if (std::memcmp(magic, kMagic, sizeof magic) != 0) {
+      auto *m = reinterpret_cast<const std::uint8_t *>(magic);
+      if (m[0] == 0x1f && m[1] == 0x8b) // gzip
+        throw std::runtime_error("Compressed trace files need a build with zlib");
+      throw std::runtime_error("Not a SymIR trace file: " + path);
+    }
+    if (in.get() != kVersion)
+      throw std::runtime_error("Unsupported trace file version");
+
+    std::vector<std::string> strings;
+    auto str = [&](std::uint64_t id) -> const std::string & {
+      if (id >= strings.size())
+        throw std::runtime_error("Trace refers to an undefined string");
+      return strings[id];
+    };
+    using Record = TraceWriter::Record;
+    using Value = TraceWriter::Value;
+    while (true) {
+      auto rec = static_cast<Record>(in.get());
+      switch (rec) {
+        case Record::End:
+          return;
+        case Record::String: {
+          std::uint64_t id = in.getVarint();
+          std::uint64_t len = in.getVarint();
+          if (id != strings.size())
+            throw std::runtime_error("Trace string ids out of order");
+          std::string s(len, '\0');
+          for (char &c: s)
+            c = static_cast<char>(in.get());
+          strings.push_back(std::move(s));
+          break;
+        }
+        case Record::Block:
+          os << str(in.getVarint()) << ":\n";
+          break;
+        case Record::Assign: {
+          os << "  " << str(in.getVarint()) << " = ";
+          // Values print as rvToString() does in the text trace.
+          switch (static_cast<Value>(in.get())) {
+            case Value::Undef:
+              os << "undef";
+              break;
+            case Value::Int:
+              os << std::to_string(unzigzag(in.getVarint()));
+              in.get(); // bits
+              break;
+            case Value::Float: {
+              in.get(); // bits
+              std::uint64_t raw = 0;
+              for (int i = 0; i < 8; ++i)
+                raw |= static_cast<std::uint64_t>(in.get()) << (8 * i);
+              double d;
+              std::memcpy(&d, &raw, sizeof d);
+              os << std::to_string(d);
+              break;
+            }
+            case Value::Ptr:
+              os << "ptr(0x" << std::to_string(in.getVarint()) << ")";
+              break;
+            case Value::Text:
+              os << str(in.getVarint());
+              break;
+            default:
+              throw std::runtime_error("Unknown value tag in trace file");
+          }
+          os << "\n";
+          break;
+        }
+        default:
+          throw std::runtime_error("Unknown record in trace file");
+      }
+    }
+  }
+
+} // namespace symir
@@ -0,0 +1,588 @@
+#include "interp/interpreter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include "analysis/type_utils.hpp"
+#include "error.hpp"
+
+// Vector ops run as kernels over the packed lanes of their operands. Each
+// kernel is a plain loop over contiguous lanes with no calls or early
+// exits, so GCC and Clang vectorize it for the SIMD width of the target
+// (SSE/AVX on x86-64, NEON on AArch64) from the same source. A lane that
+// trips a UB predicate gets a nonzero code in the flags array instead of
+// throwing from inside the loop; the op then looks for the first flagged
+// lane, which only costs a scan when some lane is bad.
+
+namespace symir {
+
+  namespace {
+
+    // Flag of a lane that is undef in some operand; it fails before any
+    // other check of its lane.
+    constexpr std::uint8_t kUndefLane = 0xff;
+
+    // A scalar operand, broadcast to every lane.
+    template<typename T> struct Splat {
+      T v;
+      T operator[](std::size_t) const { return v; }
+    };
+
+    std::int64_t canonicalLane(std::int64_t x, unsigned bits) {
+      if (bits >= 64)
+        return x;
+      unsigned sh = 64 - bits;
+      return static_cast<std::int64_t>(static_cast<std::uint64_t>(x) << sh) >> sh;
+    }
+
+    // Sign-extends every lane from `bits`.
+    void canonicalLanes(std::int64_t *x, std::size_t n, unsigned bits) {
+      if (bits >= 64)
+        return;
+      unsigned sh = 64 - bits;
+      for (std::size_t k = 0; k < n; ++k)
+        x[k] = static_cast<std::int64_t>(static_cast<std::uint64_t>(x[k]) << sh) >> sh;
+    }
+
+    void roundLanesToF32(double *x, std::size_t n) {
+      for (std::size_t k = 0; k < n; ++k)
+        x[k] = static_cast<double>(static_cast<float>(x[k]));
+    }
+
+    // Code 1 for an infinite lane, 2 for a NaN one (spec §7.4 rules 6–7).
+    void flagNonFinite(const double *x, std::uint8_t *bad, std::size_t n) {
+      for (std::size_t k = 0; k < n; ++k)
+        bad[k] = std::isinf(x[k]) ? 1 : std::isnan(x[k]) ? 2 : 0;
+    }
+
+    void flagUndef(std::uint8_t *bad, const std::vector<std::uint8_t> &undef) {
+      for (std::size_t k = 0; k < undef.size(); ++k)
+        bad[k] = undef[k] ? kUndefLane : bad[k];
+    }
+
+    // Runs `f(k)` on every lane, storing the UB code it returns.
+    template<typename F> void eachLane(std::uint8_t *bad, std::size_t n, F f) {
+      for (std::size_t k = 0; k < n; ++k)
+        bad[k] = f(k);
+    }
+
+    // Throws the UB of the first flagged lane: `undefMsg` for an undef
+    // lane, else the message of its code (1-based).
+    void raiseFirst(
+        const std::uint8_t *bad, std::size_t n, const char *undefMsg,
+        std::initializer_list<const char *> msgs
+    ) {
+      std::uint8_t any = 0;
+      for (std::size_t k = 0; k < n; ++k)
+        any |= bad[k];
+      if (!any)
+        return;
+      std::size_t k = std::find_if(bad, bad + n, [](std::uint8_t b) { return b != 0; }) - bad;
+      if (bad[k] == kUndefLane)
+        throw UndefinedBehaviorError(undefMsg);
+      throw UndefinedBehaviorError(msgs.begin()[bad[k] - 1]);
+    }
+
+    template<typename A, typename B>
+    void compareLanes(RelOp op, A a, B b, std::int64_t *out, std::size_t n) {
+      switch (op) {
+        case RelOp::EQ:
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = a[k] == b[k];
+          break;
+        case RelOp::NE:
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = a[k] != b[k];
+          break;
+        case RelOp::LT:
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = a[k] < b[k];
+          break;
+        case RelOp::LE:
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = a[k] <= b[k];
+          break;
+        case RelOp::GT:
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = a[k] > b[k];
+          break;
+        case RelOp::GE:
+          for (std::size_t k = 0; k < n; ++k)
+            out[k] = a[k] >= b[k];
+          break;
+      }
+    }
+
+  } // namespace
+
+  Interpreter::RuntimeValue
+  Interpreter::makeVec(std::size_t lanes, std::uint32_t bits, bool floatLanes) {
+    RuntimeValue v = makeAggregate(RuntimeValue::Kind::Vec);
+    v.bits = bits;
+    Aggregate &a = *v.agg;
+    a.floatLanes = floatLanes;
+    if (floatLanes)
+      a.floats.resize(lanes);
+    else
+      a.ints.resize(lanes);
+    return v;
+  }
+
+  Interpreter::RuntimeValue Interpreter::splatVec(const VecType &t, const RuntimeValue &v) {
+    bool isFloat = t.elem && std::holds_alternative<FloatType>(t.elem->v);
+    std::uint32_t bits =
+        isFloat ? (std::get<FloatType>(t.elem->v).kind == FloatType::Kind::F32 ? 32 : 64)
+                : TypeUtils::getBitWidth(t.elem).value_or(64);
+    RuntimeValue res = makeVec(t.size, bits, isFloat);
+    Aggregate &a = *res.agg;
+    if (v.kind == RuntimeValue::Kind::Undef) {
+      a.undef.assign(t.size, 1);
+    } else if (isFloat) {
+      double x = v.kind == RuntimeValue::Kind::Float ? v.floatVal : static_cast<double>(v.intVal);
+      if (bits == 32)
+        x = static_cast<double>(static_cast<float>(x));
+      std::fill(a.floats.begin(), a.floats.end(), x);
+    } else {
+      std::fill(a.ints.begin(), a.ints.end(), canonicalLane(v.intVal, bits));
+    }
+    return res;
+  }
+
+  std::size_t Interpreter::laneCount(const RuntimeValue &v) {
+    return v.agg->floatLanes ? v.agg->floats.size() : v.agg->ints.size();
+  }
+
+  Interpreter::RuntimeValue Interpreter::laneAt(const RuntimeValue &v, std::size_t k) {
+    const Aggregate &a = *v.agg;
+    RuntimeValue lane;
+    lane.bits = v.bits;
+    if (!a.undef.empty() && a.undef[k]) {
+      lane.kind = RuntimeValue::Kind::Undef;
+    } else if (a.floatLanes) {
+      lane.kind = RuntimeValue::Kind::Float;
+      lane.floatVal = a.floats[k];
+    } else {
+      lane.kind = RuntimeValue::Kind::Int;
+      lane.intVal = a.ints[k];
+    }
+    return lane;
+  }
+
+  Interpreter::RuntimeValue Interpreter::readLane(const RuntimeValue &v, const RuntimeValue &idx) {
+    if (idx.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Undef index");
+    if (idx.intVal < 0 || static_cast<std::size_t>(idx.intVal) >= laneCount(v))
+      throw UndefinedBehaviorError("UB: Vector lane index out of bounds");
+    return laneAt(v, static_cast<std::size_t>(idx.intVal));
+  }
+
+  void Interpreter::writeLane(RuntimeValue &v, std::int64_t idx, const RuntimeValue &val) {
+    std::size_t n = laneCount(v);
+    if (idx < 0 || static_cast<std::size_t>(idx) >= n)
+      throw UndefinedBehaviorError("UB: Vector lane index out of bounds");
+    Aggregate &a = v.mutableNode();
+    if (val.kind == RuntimeValue::Kind::Undef) {
+      if (a.undef.empty())
+        a.undef.assign(n, 0);
+      a.undef[idx] = 1;
+      return;
+    }
+    // Lane stores take the lane precision, as assignValue() does for
+    // scalars.
+    if (a.floatLanes) {
+      if (val.kind != RuntimeValue::Kind::Float && val.kind != RuntimeValue::Kind::Int)
+        throw std::runtime_error("Vector lane store requires a number");
+      double x =
+          val.kind == RuntimeValue::Kind::Float ? val.floatVal : static_cast<double>(val.intVal);
+      a.floats[idx] = v.bits == 32 ? static_cast<double>(static_cast<float>(x)) : x;
+    } else {
+      if (val.kind != RuntimeValue::Kind::Int)
+        throw std::runtime_error("Vector lane store requires an integer");
+      a.ints[idx] = canonicalLane(val.intVal, v.bits);
+    }
+    if (!a.undef.empty())
+      a.undef[idx] = 0;
+  }
+
+  Interpreter::RuntimeValue
+  Interpreter::addVec(const RuntimeValue &l, const RuntimeValue &r, AddOp op) {
+    std::size_t n = laneCount(l);
+    bool rVec = r.kind == RuntimeValue::Kind::Vec;
+    if (rVec && laneCount(r) != n)
+      throw std::runtime_error("Vector lane count mismatch in +/-");
+    const Aggregate &la = *l.agg;
+    laneFlags_.assign(n, 0);
+    std::uint8_t *bad = laneFlags_.data();
+    RuntimeValue res;
+
+    if (!la.floatLanes) {
+      unsigned bits = l.bits;
+      res = makeVec(n, bits, false);
+      const std::int64_t *a = la.ints.data();
+      std::int64_t *out = res.agg->ints.data();
+      std::int64_t smax = bits >= 64 ? INT64_MAX : (INT64_C(1) << (bits - 1)) - 1;
+      std::int64_t smin = bits >= 64 ? INT64_MIN : -(INT64_C(1) << (bits - 1));
+      auto kernel = [&](auto b) {
+        // Narrower lanes cannot overflow int64, so a range test finds UB.
+        if (bits < 64 && op == AddOp::Plus)
+          eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+            out[k] = a[k] + b[k];
+            return out[k] > smax || out[k] < smin;
+          });
+        else if (bits < 64)
+          eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+            out[k] = a[k] - b[k];
+            return out[k] > smax || out[k] < smin;
+          });
+        else if (op == AddOp::Plus)
+          eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+            return __builtin_add_overflow(a[k], b[k], &out[k]);
+          });
+        else
+          eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+            return __builtin_sub_overflow(a[k], b[k], &out[k]);
+          });
+      };
+      if (rVec)
+        kernel(r.agg->ints.data());
+      else
+        kernel(Splat<std::int64_t>{canonicalLane(r.intVal, bits)});
+      flagUndef(bad, la.undef);
+      if (rVec)
+        flagUndef(bad, r.agg->undef);
+      raiseFirst(bad, n, "UB: Reading undef vector lane", {"UB: vector lane overflow in +/-"});
+      return res;
+    }
+
+    std::uint32_t bits = rVec ? std::min(l.bits, r.bits) : l.bits;
+    res = makeVec(n, bits, true);
+    const double *a = la.floats.data();
+    double *out = res.agg->floats.data();
+    auto kernel = [&](auto b) {
+      if (op == AddOp::Plus)
+        for (std::size_t k = 0; k < n; ++k)
+          out[k] = a[k] + b[k];
+      else
+        for (std::size_t k = 0; k < n; ++k)
+          out[k] = a[k] - b[k];
+    };
+    if (rVec) {
+      kernel(r.agg->floats.data());
+    } else {
+      double x = r.kind == RuntimeValue::Kind::Float ? r.floatVal : static_cast<double>(r.intVal);
+      kernel(Splat<double>{l.bits == 32 ? static_cast<double>(static_cast<float>(x)) : x});
+    }
+    if (bits == 32)
+      roundLanesToF32(out, n);
+    flagNonFinite(out, bad, n);
+    flagUndef(bad, la.undef);
+    if (rVec)
+      flagUndef(bad, r.agg->undef);
+    raiseFirst(
+        bad, n, "UB: Reading undef vector lane",
+        {"UB: Floating-point result is infinity", "UB: Floating-point result is NaN"}
+    );
+    return res;
+  }
+
+  Interpreter::RuntimeValue
+  Interpreter::applyVec(AtomOpKind op, const RuntimeValue &c, const RuntimeValue &r) {
+    std::size_t n = laneCount(r);
+    bool cVec = c.kind == RuntimeValue::Kind::Vec;
+    if (cVec && laneCount(c) != n)
+      throw std::runtime_error("Vector lane count mismatch in OpAtom");
+    if (c.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: Reading undef vector lane");
+    const Aggregate &ra = *r.agg;
+    laneFlags_.assign(n, 0);
+    std::uint8_t *bad = laneFlags_.data();
+    RuntimeValue res;
+
+    if (!ra.floatLanes) {
+      unsigned bits = r.bits;
+      res = makeVec(n, bits, false);
+      const std::int64_t *y = ra.ints.data();
+      std::int64_t *out = res.agg->ints.data();
+      std::int64_t smax = bits >= 64 ? INT64_MAX : (INT64_C(1) << (bits - 1)) - 1;
+      std::int64_t smin = bits >= 64 ? INT64_MIN : -(INT64_C(1) << (bits - 1));
+      // The plain product of two 32-bit lanes cannot overflow int64.
+      bool narrow = bits <= 32 && (cVec || (c.intVal >= INT32_MIN && c.intVal <= INT32_MAX));
+      const char *msg1 = nullptr, *msg2 = nullptr, *msg3 = nullptr;
+      // `x` is the coefficient lane, `y` the rvalue lane.
+      auto kernel = [&](auto x) {
+        switch (op) {
+          case AtomOpKind::Mul:
+            msg1 = "UB: vector lane overflow in *";
+            if (narrow)
+              eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+                out[k] = x[k] * y[k];
+                return out[k] > smax || out[k] < smin;
+              });
+            else
+              eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+                bool ov = __builtin_mul_overflow(x[k], y[k], &out[k]);
+                return ov || out[k] > smax || out[k] < smin;
+              });
+            break;
+          case AtomOpKind::Div:
+          case AtomOpKind::Mod: {
+            bool div = op == AtomOpKind::Div;
+            msg1 = div ? "UB: vector lane division by zero" : "UB: vector lane modulo by zero";
+            msg2 = div ? "UB: vector lane overflow in /" : "UB: vector lane overflow in %";
+            eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+              bool zero = y[k] == 0;
+              bool ov = x[k] == smin && y[k] == -1;
+              // An out-of-range coefficient may still be INT64_MIN.
+              bool trap = x[k] == INT64_MIN && y[k] == -1;
+              std::int64_t d = zero || ov || trap ? 1 : y[k];
+              out[k] = div ? x[k] / d : x[k] % d;
+              return zero ? 1 : ov ? 2 : 0;
+            });
+            break;
+          }
+          case AtomOpKind::And:
+            for (std::size_t k = 0; k < n; ++k)
+              out[k] = x[k] & y[k];
+            break;
+          case AtomOpKind::Or:
+            for (std::size_t k = 0; k < n; ++k)
+              out[k] = x[k] | y[k];
+            break;
+          case AtomOpKind::Xor:
+            for (std::size_t k = 0; k < n; ++k)
+              out[k] = x[k] ^ y[k];
+            break;
+          case AtomOpKind::Shl:
+            msg1 = "UB: vector lane overshift";
+            msg2 = "UB: vector lane left shift of negative";
+            msg3 = "UB: vector lane overflow in <<";
+            eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+              bool over = y[k] < 0 || static_cast<std::uint64_t>(y[k]) >= bits;
+              std::int64_t s = over ? 0 : y[k];
+              out[k] = static_cast<std::int64_t>(static_cast<std::uint64_t>(x[k]) << s);
+              return over ? 1 : x[k] < 0 ? 2 : x[k] > (smax >> s) ? 3 : 0;
+            });
+            break;
+          case AtomOpKind::Shr:
+          case AtomOpKind::LShr: {
+            msg1 = "UB: vector lane overshift";
+            std::uint64_t mask = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+            bool logical = op == AtomOpKind::LShr;
+            eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+              bool over = y[k] < 0 || static_cast<std::uint64_t>(y[k]) >= bits;
+              std::int64_t s = over ? 0 : y[k];
+              out[k] = logical ? static_cast<std::int64_t>(
+                                     (static_cast<std::uint64_t>(x[k]) & mask) >> s
+                                 )
+                               : x[k] >> s;
+              return over;
+            });
+            break;
+          }
+        }
+      };
+      if (cVec)
+        kernel(c.agg->ints.data());
+      else
+        kernel(Splat<std::int64_t>{c.intVal});
+      canonicalLanes(out, n, bits);
+      flagUndef(bad, ra.undef);
+      if (cVec)
+        flagUndef(bad, c.agg->undef);
+      raiseFirst(bad, n, "UB: Reading undef vector lane", {msg1, msg2, msg3});
+      return res;
+    }
+
+    if (op != AtomOpKind::Mul && op != AtomOpKind::Div && op != AtomOpKind::Mod)
+      throw std::runtime_error("Unsupported op for float vector lane");
+    std::uint32_t bits = cVec ? std::min(c.bits, r.bits) : r.bits;
+    res = makeVec(n, bits, true);
+    const double *y = ra.floats.data();
+    double *out = res.agg->floats.data();
+    auto kernel = [&](auto x) {
+      if (op == AtomOpKind::Mul)
+        for (std::size_t k = 0; k < n; ++k)
+          out[k] = x[k] * y[k];
+      else if (op == AtomOpKind::Div)
+        for (std::size_t k = 0; k < n; ++k)
+          out[k] = x[k] / y[k];
+      else
+        for (std::size_t k = 0; k < n; ++k)
+          out[k] = std::fmod(x[k], y[k]);
+    };
+    if (cVec)
+      kernel(c.agg->floats.data());
+    else
+      kernel(Splat<double>{
+          c.kind == RuntimeValue::Kind::Float ? c.floatVal : static_cast<double>(c.intVal)
+      });
+    if (bits == 32)
+      roundLanesToF32(out, n);
+    flagNonFinite(out, bad, n);
+    flagUndef(bad, ra.undef);
+    if (cVec)
+      flagUndef(bad, c.agg->undef);
+    raiseFirst(
+        bad, n, "UB: Reading undef vector lane",
+        {"UB: Floating-point result is infinity", "UB: Floating-point result is NaN"}
+    );
+    return res;
+  }
+
+  Interpreter::RuntimeValue Interpreter::notVec(const RuntimeValue &r) {
+    std::size_t n = laneCount(r);
+    const Aggregate &ra = *r.agg;
+    laneFlags_.assign(n, 0);
+    flagUndef(laneFlags_.data(), ra.undef);
+    raiseFirst(laneFlags_.data(), n, "UB: Reading undef lane in unary", {});
+    if (ra.floatLanes)
+      throw std::runtime_error("Vector unary ~ requires integer lanes");
+    RuntimeValue res = makeVec(n, r.bits, false);
+    const std::int64_t *x = ra.ints.data();
+    std::int64_t *out = res.agg->ints.data();
+    for (std::size_t k = 0; k < n; ++k)
+      out[k] = ~x[k];
+    canonicalLanes(out, n, r.bits);
+    return res;
+  }
+
+  Interpreter::RuntimeValue
+  Interpreter::cmpVec(RelOp op, const RuntimeValue &l, const RuntimeValue &r) {
+    std::size_t n = laneCount(l);
+    bool rVec = r.kind == RuntimeValue::Kind::Vec;
+    if (rVec && laneCount(r) != n)
+      throw std::runtime_error("Vector cmp: lane count mismatch");
+    if (r.kind == RuntimeValue::Kind::Undef)
+      throw UndefinedBehaviorError("UB: undef in cmp");
+    const Aggregate &la = *l.agg;
+    laneFlags_.assign(n, 0);
+    flagUndef(laneFlags_.data(), la.undef);
+    if (rVec)
+      flagUndef(laneFlags_.data(), r.agg->undef);
+    raiseFirst(laneFlags_.data(), n, "UB: undef in cmp", {});
+
+    RuntimeValue res = makeVec(n, 1, false);
+    std::int64_t *out = res.agg->ints.data();
+    bool rFloat = rVec ? r.agg->floatLanes : r.kind == RuntimeValue::Kind::Float;
+    if (!la.floatLanes && !rFloat) {
+      if (rVec)
+        compareLanes(op, la.ints.data(), r.agg->ints.data(), out, n);
+      else
+        compareLanes(op, la.ints.data(), Splat<std::int64_t>{r.intVal}, out, n);
+      return res;
+    }
+    // An integer side compares as floating point, as compareValues() does.
+    std::vector<double> lw, rw;
+    const double *a = la.floats.data();
+    if (!la.floatLanes) {
+      lw.assign(la.ints.begin(), la.ints.end());
+      a = lw.data();
+    }
+    if (!rVec) {
+      double x = r.kind == RuntimeValue::Kind::Float ? r.floatVal : static_cast<double>(r.intVal);
+      compareLanes(op, a, Splat<double>{x}, out, n);
+    } else if (rFloat) {
+      compareLanes(op, a, r.agg->floats.data(), out, n);
+    } else {
+      rw.assign(r.agg->ints.begin(), r.agg->ints.end());
+      compareLanes(op, a, rw.data(), out, n);
+    }
+    return res;
+  }
+
+  Interpreter::RuntimeValue Interpreter::selectVec(
+      const RuntimeValue &mask, const RuntimeValue &t, const RuntimeValue &f
+  ) {
+    std::size_t n = laneCount(mask);
+    if (t.kind != RuntimeValue::Kind::Vec || f.kind != RuntimeValue::Kind::Vec ||
+        laneCount(t) != n || laneCount(f) != n)
+      throw std::runtime_error("Mask-based select: lane count mismatch");
+    const Aggregate &ma = *mask.agg, &ta = *t.agg, &fa = *f.agg;
+    if (ma.floatLanes || ta.floatLanes != fa.floatLanes)
+      throw std::runtime_error("Mask-based select: lane type mismatch");
+    const std::int64_t *m = ma.ints.data();
+    laneFlags_.assign(n, 0);
+    std::uint8_t *bad = laneFlags_.data();
+    // Code 1 for an undef mask lane, 2 for an undef lane it selects.
+    if (!ta.undef.empty())
+      for (std::size_t k = 0; k < n; ++k)
+        bad[k] |= (m[k] != 0 && ta.undef[k]) ? 2 : 0;
+    if (!fa.undef.empty())
+      for (std::size_t k = 0; k < n; ++k)
+        bad[k] |= (m[k] == 0 && fa.undef[k]) ? 2 : 0;
+    for (std::size_t k = 0; k < ma.undef.size(); ++k)
+      bad[k] = ma.undef[k] ? 1 : bad[k];
+    raiseFirst(bad, n, "", {"UB: undef mask lane", "UB: undef lane selected by mask"});
+
+    RuntimeValue res = makeVec(n, t.bits, ta.floatLanes);
+    if (ta.floatLanes) {
+      const double *a = ta.floats.data(), *b = fa.floats.data();
+      double *out = res.agg->floats.data();
+      for (std::size_t k = 0; k < n; ++k)
+        out[k] = m[k] != 0 ? a[k] : b[k];
+    } else {
+      const std::int64_t *a = ta.ints.data(), *b = fa.ints.data();
+      std::int64_t *out = res.agg->ints.data();
+      for (std::size_t k = 0; k < n; ++k)
+        out[k] = m[k] != 0 ? a[k] : b[k];
+    }
+    return res;
+  }
+
+  Interpreter::RuntimeValue Interpreter::castVec(const RuntimeValue &v, const TypePtr &dstType) {
+    auto vt = TypeUtils::asVec(dstType);
+    if (!vt)
+      throw std::runtime_error("Vector cast requires vector dst");
+    std::size_t n = laneCount(v);
+    if (n != vt->size)
+      throw std::runtime_error("Vector cast: lane count mismatch");
+    auto laneBits = TypeUtils::getBitWidth(vt->elem);
+    bool isFp = vt->elem && std::holds_alternative<FloatType>(vt->elem->v);
+    bool isF32 = isFp && std::get<FloatType>(vt->elem->v).kind == FloatType::Kind::F32;
+    if (!laneBits && !isFp)
+      throw std::runtime_error("Vector cast: unsupported lane dst type");
+    const Aggregate &va = *v.agg;
+    laneFlags_.assign(n, 0);
+    std::uint8_t *bad = laneFlags_.data();
+    RuntimeValue res;
+
+    if (laneBits) {
+      res = makeVec(n, *laneBits, false);
+      std::int64_t *out = res.agg->ints.data();
+      if (!va.floatLanes) {
+        std::copy(va.ints.begin(), va.ints.end(), out);
+        canonicalLanes(out, n, *laneBits);
+      } else {
+        double lo = -std::ldexp(1.0, static_cast<int>(*laneBits) - 1);
+        double hi = std::ldexp(1.0, static_cast<int>(*laneBits) - 1);
+        const double *x = va.floats.data();
+        // The range test is false for NaN and both infinities.
+        eachLane(bad, n, [&](std::size_t k) -> std::uint8_t {
+          bool ok = x[k] >= lo && x[k] < hi;
+          out[k] = ok ? static_cast<std::int64_t>(x[k]) : 0;
+          return !ok;
+        });
+      }
+    } else {
+      res = makeVec(n, isF32 ? 32 : 64, true);
+      double *out = res.agg->floats.data();
+      if (va.floatLanes)
+        std::copy(va.floats.begin(), va.floats.end(), out);
+      else
+        std::copy(va.ints.begin(), va.ints.end(), out);
+      if (isF32) {
+        roundLanesToF32(out, n);
+        for (std::size_t k = 0; k < n; ++k)
+          bad[k] = std::isinf(out[k]) ? 2 : 0;
+      }
+    }
+    flagUndef(bad, va.undef);
+    raiseFirst(
+        bad, n, "UB: undef lane in cast",
+        {"UB: vector lane float->int OOR", "UB: vector lane f32 overflow to inf"}
+    );
+    return res;
+  }
+
+} // namespace symir
@@ -0,0 +1,119 @@
+#include "reify/adaptive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace symir::reify {
+
+  namespace {
+
+    // Inits' worth of the run's average a kind's yield starts from.
+    constexpr double kPriorInits = 4.0;
+
+    hp::IntAtom kind(int k) { return static_cast<hp::IntAtom>(k); }
+
+    std::array<int, hp::kNumIntAtoms> widths(const hp::Params &p) {
+      std::array<int, hp::kNumIntAtoms> w{};
+      int prev = 0;
+      for (int k = 0; k < hp::kNumIntAtoms; k++) {
+        int end = p.*hp::intOnPathEnd(kind(k));
+        w[k] = end - prev;
+        prev = end;
+      }
+      return w;
+    }
+
+  } // namespace
+
+  AdaptiveMix::AdaptiveMix(const hp::Params &base, double coverage)
+      : base_(base), coverage_(std::clamp(coverage, 0.01, 1.0)), current_(base) {}
+
+  hp::Params AdaptiveMix::next() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return current_;
+  }
+
+  void AdaptiveMix::record(
+      const std::array<int, hp::kNumIntAtoms> &atoms, double seconds, bool valid
+  ) {
+    std::lock_guard<std::mutex> lock(mu_);
+    int n = 0;
+    for (int a: atoms)
+      n += a;
+    for (int k = 0; k < hp::kNumIntAtoms && n; k++) {
+      double share = (double) atoms[k] / n;
+      seconds_[k] += share * seconds;
+      if (valid)
+        valid_[k] += share;
+    }
+    totalSeconds_ += seconds;
+    totalValid_ += valid;
+    if (++inits_ % kUpdateEvery == 0)
+      update();
+  }
+
+  void AdaptiveMix::update() {
+    if (totalValid_ == 0 || totalSeconds_ <= 0)
+      return; // nothing to prefer yet
+    double yield = totalValid_ / totalSeconds_;
+    double priorValid = kPriorInits * totalValid_ / inits_;
+    double priorSeconds = kPriorInits * totalSeconds_ / inits_;
+
+    auto base = widths(base_);
+    int total = 0;
+    for (int b: base)
+      total += b;
+    if (total == 0)
+      return;
+
+    std::array<double, hp::kNumIntAtoms> w{};
+    for (int k = 0; k < hp::kNumIntAtoms; k++) {
+      double y = (valid_[k] + priorValid) / (seconds_[k] + priorSeconds);
+      w[k] = base[k] * std::clamp(y / yield, coverage_, 1.0 / coverage_);
+    }
+    // Renormalise to the base total; the bounds hold to within rounding
+    // after a few rounds of clamping.
+    for (int round = 0; round < 4; round++) {
+      double sum = 0;
+      for (double x: w)
+        sum += x;
+      for (int k = 0; k < hp::kNumIntAtoms; k++)
+        w[k] = std::clamp(w[k] * total / sum, base[k] * coverage_, base[k] / coverage_);
+    }
+
+    // Round the running sum, so that the last end stays the base's; a kind
+    // the base generates keeps at least one slot.
+    double sum = 0;
+    for (double x: w)
+      sum += x;
+    double run = 0;
+    int prev = 0;
+    for (int k = 0; k < hp::kNumIntAtoms; k++) {
+      run += w[k];
+      int end = (int) std::lround(run * total / sum);
+      if (base[k] > 0)
+        end = std::max(end, prev + 1);
+      end = std::clamp(end, prev, 100);
+      current_.*hp::intOnPathEnd(kind(k)) = end;
+      prev = end;
+    }
+  }
+
+  std::string AdaptiveMix::report() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto base = widths(base_), now = widths(current_);
+    std::string out;
+    char line[128];
+    for (int k = 0; k < hp::kNumIntAtoms; k++) {
+      double y = seconds_[k] > 0 ? valid_[k] / seconds_[k] : 0.0;
+      std::snprintf(
+          line, sizeof line, "  %-9s %3d%% -> %3d%%  (%.1f valid/s)\n", hp::intAtomName(kind(k)),
+          base[k], now[k], y
+      );
+      out += line;
+    }
+    return out;
+  }
+
+} // namespace symir::reify
@@ -16,14 +16,20 @@ namespace symir::reify {
   }
 
   void RyCFG::addEdge(const std::string &src, const std::string &dst) {
-    auto *s = get(src);
-    auto *d = get(dst);
-    if (!s || !d)
+    auto si = blockIndex.find(src);
+    auto di = blockIndex.find(dst);
+    if (si == blockIndex.end() || di == blockIndex.end())
       return;
-    if (std::find(s->succs.begin(), s->succs.end(), dst) == s->succs.end())
-      s->succs.push_back(dst);
-    if (std::find(d->preds.begin(), d->preds.end(), src) == d->preds.end())
-      d->preds.push_back(src);
+    auto &s = blocks[si->second];
+    auto &d = blocks[di->second];
+    if (std::find(s.succs.begin(), s.succs.end(), dst) == s.succs.end()) {
+      s.succs.push_back(dst);
+      s.succIds.push_back(di->second);
+    }
+    if (std::find(d.preds.begin(), d.preds.end(), src) == d.preds.end()) {
+      d.preds.push_back(src);
+      d.predIds.push_back(si->second);
+    }
   }
 
   std::vector<std::string> RyCFG::labels() const {
@@ -51,8 +57,10 @@ namespace symir::reify {
     cfg.exitLabel = "exit";
     for (const auto &lbl: labels) {
       cfg.blockIndex[lbl] = cfg.blocks.size();
-      cfg.blocks.push_back(RyCFGBlock{lbl, {}, {}});
+      cfg.blocks.push_back(RyCFGBlock{lbl, {}, {}, {}, {}});
     }
+    cfg.entryId = 0;
+    cfg.exitId = cfg.blocks.size() - 1;
 
     // Spanning chain: entry -> b0 -> ... -> b_{n-1} -> exit
     for (std::size_t i = 0; i + 1 < labels.size(); i++)
@@ -274,6 +274,7 @@ namespace symir::reify {
     //  85-89: div/mod (if enableDiv, requires rval)
     //  90-99: CoefAtom{sym} fallback
 
+    const hp::Params &p = hp::params();
     std::uniform_int_distribution<int> slot(0, 99);
     int s = slot(rng);
 
@@ -282,22 +283,32 @@ namespace symir::reify {
       auto *v = pickOne(rng, scalarsOfT);
       return localLV(v->name);
     };
+    auto tally = [&](hp::IntAtom kind, Atom atom) {
+      sym.intAtoms[(int) kind]++;
+      return atom;
+    };
 
-    if (s < hp::kIntOnPath_CoefBareEnd) {
+    if (s < p.intOnPath_CoefBareEnd) {
       // Standalone coef sym
-      return coefAtom(symCoef(sym.nextCoef(targetType)));
+      return tally(hp::IntAtom::CoefBare, coefAtom(symCoef(sym.nextCoef(targetType))));
     }
-    if (s < hp::kIntOnPath_MulEnd && hasRval) {
+    if (s < p.intOnPath_MulEnd && hasRval) {
       // Linear: sym * rval
-      return opAtom(AtomOpKind::Mul, symCoef(sym.nextCoef(targetType)), pickRval());
+      return tally(
+          hp::IntAtom::Mul,
+          opAtom(AtomOpKind::Mul, symCoef(sym.nextCoef(targetType)), pickRval())
+      );
     }
-    if (s < hp::kIntOnPath_BitwiseEnd && cfg.enableAllOps && hasRval) {
+    if (s < p.intOnPath_BitwiseEnd && cfg.enableAllOps && hasRval) {
       // Bitwise
       static const AtomOpKind bops[] = {AtomOpKind::And, AtomOpKind::Or, AtomOpKind::Xor};
       std::uniform_int_distribution<int> opPick(0, 2);
-      return opAtom(bops[opPick(rng)], symCoef(sym.nextCoef(targetType)), pickRval());
+      return tally(
+          hp::IntAtom::Bitwise,
+          opAtom(bops[opPick(rng)], symCoef(sym.nextCoef(targetType)), pickRval())
+      );
     }
-    if (s < hp::kIntOnPath_ShiftEnd && cfg.enableAllOps && hasRval) {
+    if (s < p.intOnPath_ShiftEnd && cfg.enableAllOps && hasRval) {
       // Shift: index_sym << rval  (coef=index sym, rval=variable being shifted)
       // Per the existing pattern: index sym is the VALUE being shifted, rval is shift amount
       // But shift amount must be i32 — we need an i32 rval for the shift amount
@@ -318,7 +329,10 @@ namespace symir::reify {
         if (intBitWidth(targetType) == 32) {
           if (!i32scalars.empty()) {
             auto *shiftAmt = pickOne(rng, i32scalars);
-            return opAtom(sops[opPick(rng)], symCoef(idxSym), localLV(shiftAmt->name));
+            return tally(
+                hp::IntAtom::Shift,
+                opAtom(sops[opPick(rng)], symCoef(idxSym), localLV(shiftAmt->name))
+            );
           }
         } else {
           // Non-i32 target: use coef sym of targetType << i32 literal for shift amount
@@ -327,24 +341,24 @@ namespace symir::reify {
           // Use a concrete integer rval instead:
           (void) idxSym; // index sym was consumed, drop it
           // Just fall through to coef standalone
-          return coefAtom(symCoef(sym.nextCoef(targetType)));
+          return tally(hp::IntAtom::CoefBare, coefAtom(symCoef(sym.nextCoef(targetType))));
         }
       }
-      return coefAtom(symCoef(sym.nextCoef(targetType)));
+      return tally(hp::IntAtom::CoefBare, coefAtom(symCoef(sym.nextCoef(targetType))));
     }
-    if (s < hp::kIntOnPath_UnaryNotEnd && hasRval) {
+    if (s < p.intOnPath_UnaryNotEnd && hasRval) {
       // Unary NOT
-      return unaryAtom(pickRval());
+      return tally(hp::IntAtom::UnaryNot, unaryAtom(pickRval()));
     }
-    if (s < hp::kIntOnPath_CastEnd && !otherIntScalars.empty()) {
+    if (s < p.intOnPath_CastEnd && !otherIntScalars.empty()) {
       // CastAtom from another int width
       auto *srcVar = pickOne(rng, otherIntScalars);
       CastAtom ca;
       ca.src = LValue{LocalId{srcVar->name, {}}, {}, {}};
       ca.dstType = targetType;
-      return Atom{std::move(ca), {}};
+      return tally(hp::IntAtom::Cast, Atom{std::move(ca), {}});
     }
-    if (s < hp::kIntOnPath_DivModEnd && cfg.enableDiv && hasRval) {
+    if (s < p.intOnPath_DivModEnd && cfg.enableDiv && hasRval) {
       // Div/Mod: OpAtom{Div/Mod, sym_coef, rval}  = sym / rval
       // We need a require(rval != 0) guard on-path
       std::uniform_int_distribution<int> dm(0, 1);
@@ -358,21 +372,21 @@ namespace symir::reify {
       req.cond.rhs = simpleExpr(coefAtom(intCoef(0)));
       req.message = "div nonzero";
       extraRequires.push_back(Instr{std::move(req)});
-      return opAtom(op, symCoef(symName), localLV(rv->name));
+      return tally(hp::IntAtom::DivMod, opAtom(op, symCoef(symName), localLV(rv->name)));
     }
-    if (s < hp::kIntOnPath_LoadEnd) {
+    if (s < p.intOnPath_LoadEnd) {
       // Load from a ptr T var if any exist
       auto ptrs = vars.ptrsOf(targetType);
       if (!ptrs.empty()) {
         auto *pv = pickOne(rng, ptrs);
-        return Atom{LoadAtom{localLV(pv->name), {}}, {}};
+        return tally(hp::IntAtom::Load, Atom{LoadAtom{localLV(pv->name), {}}, {}});
       }
     }
-    if (s < hp::kIntOnPath_SelectEnd && cfg.enableSelect) {
-      return genSelectAtom(rng, &sym, vars, targetType);
+    if (s < p.intOnPath_SelectEnd && cfg.enableSelect) {
+      return tally(hp::IntAtom::Select, genSelectAtom(rng, &sym, vars, targetType));
     }
     // Fallback: standalone sym
-    return coefAtom(symCoef(sym.nextCoef(targetType)));
+    return tally(hp::IntAtom::CoefBare, coefAtom(symCoef(sym.nextCoef(targetType))));
   }
 
   // Generate a single Atom of the given integer type (off-path, concrete only)
@@ -389,13 +403,14 @@ namespace symir::reify {
       if (isIntType(v->type) && !typeEquals(v->type, targetType))
         otherIntScalars.push_back(v);
 
+    const hp::Params &p = hp::params();
     std::uniform_int_distribution<int> slot(0, 99);
     int s = slot(rng);
 
-    if (s < hp::kIntOffPath_ConcreteEnd || !hasRval) {
+    if (s < p.intOffPath_ConcreteEnd || !hasRval) {
       return genConcreteIntAtom(rng, targetType);
     }
-    if (s < hp::kIntOffPath_MulEnd) {
+    if (s < p.intOffPath_MulEnd) {
       auto *v = pickOne(rng, scalarsOfT);
       uint32_t bits = intBitWidth(targetType);
       int64_t lo = hp::kOffPathCoef_Lo, hi = hp::kOffPathCoef_Hi;
@@ -406,32 +421,32 @@ namespace symir::reify {
       std::uniform_int_distribution<int64_t> cd(lo, hi);
       return opAtom(AtomOpKind::Mul, intCoef(cd(rng)), localLV(v->name));
     }
-    if (s < hp::kIntOffPath_BitwiseEnd && cfg.enableAllOps) {
+    if (s < p.intOffPath_BitwiseEnd && cfg.enableAllOps) {
       auto *v = pickOne(rng, scalarsOfT);
       static const AtomOpKind bops[] = {AtomOpKind::And, AtomOpKind::Or, AtomOpKind::Xor};
       std::uniform_int_distribution<int> op(0, 2);
       std::uniform_int_distribution<int64_t> cv(hp::kOffPathCoef_Lo, hp::kOffPathCoef_Hi);
       return opAtom(bops[op(rng)], intCoef(cv(rng)), localLV(v->name));
     }
-    if (s < hp::kIntOffPath_CastEnd && !otherIntScalars.empty()) {
+    if (s < p.intOffPath_CastEnd && !otherIntScalars.empty()) {
       auto *v = pickOne(rng, otherIntScalars);
       CastAtom ca;
       ca.src = LValue{LocalId{v->name, {}}, {}, {}};
       ca.dstType = targetType;
       return Atom{std::move(ca), {}};
     }
-    if (s < hp::kIntOffPath_DivModEnd && cfg.enableDiv && hasRval) {
+    if (s < p.intOffPath_DivModEnd && cfg.enableDiv && hasRval) {
       auto *v = pickOne(rng, scalarsOfT);
       std::uniform_int_distribution<int> dm(0, 1);
       AtomOpKind op = dm(rng) ? AtomOpKind::Mod : AtomOpKind::Div;
       std::uniform_int_distribution<int64_t> cd(hp::kOffPathDivisor_Lo, hp::kOffPathDivisor_Hi);
       return opAtom(op, intCoef(cd(rng)), localLV(v->name));
     }
-    if (s < hp::kIntOffPath_PlainRvalEnd) {
+    if (s < p.intOffPath_PlainRvalEnd) {
       auto *v = pickOne(rng, scalarsOfT);
       return rvalAtom(localLV(v->name));
     }
-    if (s < hp::kIntOffPath_LoadEnd) {
+    if (s < p.intOffPath_LoadEnd) {
       // Load from a ptr T var if available
       auto ptrs = vars.ptrsOf(targetType);
       if (!ptrs.empty()) {
@@ -439,7 +454,7 @@ namespace symir::reify {
         return Atom{LoadAtom{localLV(pv->name), {}}, {}};
       }
     }
-    if (s < hp::kIntOffPath_SelectEnd && cfg.enableSelect) {
+    if (s < p.intOffPath_SelectEnd && cfg.enableSelect) {
       return genSelectAtom(rng, /*sym=*/nullptr, vars, targetType);
     }
     return genConcreteIntAtom(rng, targetType);
@@ -453,10 +468,11 @@ namespace symir::reify {
     auto fpVars = vars.scalarsOf(targetType);
     auto i32scalars = vars.scalarsOf(makeI32());
 
+    const hp::Params &p = hp::params();
     std::uniform_int_distribution<int> slot(0, 99);
     int s = slot(rng);
 
-    if (s < hp::kFloatOnPath_CastFromI32SymEnd) {
+    if (s < p.floatOnPath_CastFromI32SymEnd) {
       // Cast from i32 sym to float (keeps SMT in BV theory)
       auto symName = sym.nextValue();
       CastAtom ca;
@@ -464,13 +480,13 @@ namespace symir::reify {
       ca.dstType = targetType;
       return Atom{std::move(ca), {}};
     }
-    if (s < hp::kFloatOnPath_MulLitEnd && !fpVars.empty()) {
+    if (s < p.floatOnPath_MulLitEnd && !fpVars.empty()) {
       // Multiply by concrete float literal
       auto *v = pickOne(rng, fpVars);
       std::uniform_int_distribution<std::size_t> ld(0, hp::kFloatMulCoefPoolSize - 1);
       return opAtom(AtomOpKind::Mul, floatCoef(hp::kFloatMulCoefPool[ld(rng)]), localLV(v->name));
     }
-    if (s < hp::kFloatOnPath_CastFromVarEnd && !i32scalars.empty()) {
+    if (s < p.floatOnPath_CastFromVarEnd && !i32scalars.empty()) {
       // CastAtom from i32 var
       auto *v = pickOne(rng, i32scalars);
       CastAtom ca;
@@ -478,7 +494,7 @@ namespace symir::reify {
       ca.dstType = targetType;
       return Atom{std::move(ca), {}};
     }
-    if (s < hp::kFloatOnPath_SelectEnd && cfg.enableSelect) {
+    if (s < p.floatOnPath_SelectEnd && cfg.enableSelect) {
       return genSelectAtom(rng, &sym, vars, targetType);
     }
     // Concrete float literal
@@ -578,7 +594,8 @@ namespace symir::reify {
     std::vector<Atom> atoms;
 
     // Determine number of atoms in this expression
-    std::uniform_int_distribution<int> nAtomsDist(hp::kMinAtomsPerExpr, hp::kMaxAtomsPerExpr);
+    const hp::Params &p = hp::params();
+    std::uniform_int_distribution<int> nAtomsDist(p.minAtomsPerExpr, p.maxAtomsPerExpr);
     int nAtoms = nAtomsDist(rng);
 
     // For ptr types, always single atom
@@ -621,13 +638,13 @@ namespace symir::reify {
           if (!vecs.empty()) {
             std::uniform_int_distribution<int> slot(0, 99);
             int s = slot(rng);
-            if (s < hp::kVecCopyEnd) {
+            if (s < p.vecCopyEnd) {
               auto *v = pickOne(rng, vecs);
               a = rvalAtom(localLV(v->name));
-            } else if (s < hp::kVecSymMulEnd && onPath && sym) {
+            } else if (s < p.vecSymMulEnd && onPath && sym) {
               auto *v = pickOne(rng, vecs);
               a = opAtom(AtomOpKind::Mul, symCoef(sym->nextCoef(vt.elem)), localLV(v->name));
-            } else if (s < hp::kVecConcMulEnd) {
+            } else if (s < p.vecConcMulEnd) {
               auto *v = pickOne(rng, vecs);
               int64_t c = std::uniform_int_distribution<int64_t>(-4, 4)(rng);
               if (c == 0)
@@ -772,7 +789,8 @@ namespace symir::reify {
     std::vector<Instr> reqs;
     std::vector<Atom> atoms;
 
-    std::uniform_int_distribution<int> nAtomsDist(hp::kMinAtomsPerExpr, hp::kMaxAtomsPerExpr);
+    const hp::Params &p = hp::params();
+    std::uniform_int_distribution<int> nAtomsDist(p.minAtomsPerExpr, p.maxAtomsPerExpr);
     int nAtoms = nAtomsDist(rng);
 
     if (isPtrType(targetType))
@@ -911,6 +929,7 @@ namespace symir::reify {
       bool safeOffPath, const ExprGenConfig &cfg
   ) {
     std::vector<Instr> result;
+    const hp::Params &p = hp::params();
     std::uniform_real_distribution<double> prob(0.0, 1.0);
 
     // Collect mutable (non-ptr) vars for assignment targets
@@ -1046,7 +1065,7 @@ namespace symir::reify {
         auto sameVecs = vars.vecsOf(lhsVar->type);
         bool canWholeVec = !sameVecs.empty();
         std::uniform_int_distribution<int> vslot(0, 99);
-        if (canWholeVec && vslot(rng) >= hp::kVecLaneWriteProb) {
+        if (canWholeVec && vslot(rng) >= p.vecLaneWriteProb) {
           // Whole-vec assign (copy or broadcast-mul)
           lhs = localLV(lhsVar->name);
           assignType = lhsVar->type;
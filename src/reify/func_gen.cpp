@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <unordered_map>
 #include <unordered_set>
+#include "reify/hyperparameters.hpp"
 
 namespace symir::reify {
 
@@ -59,7 +61,7 @@ namespace symir::reify {
       }
       InitVal iv;
       iv.kind = InitVal::Kind::Aggregate;
-      iv.value = std::move(children);
+      iv.value.emplace<std::vector<InitValPtr>>(std::move(children));
       return iv;
     }
     if (std::holds_alternative<StructType>(t->v)) {
@@ -77,7 +79,7 @@ namespace symir::reify {
         }
         InitVal iv;
         iv.kind = InitVal::Kind::Aggregate;
-        iv.value = std::move(children);
+        iv.value.emplace<std::vector<InitValPtr>>(std::move(children));
         return iv;
       }
     }
@@ -90,7 +92,7 @@ namespace symir::reify {
       }
       InitVal iv;
       iv.kind = InitVal::Kind::Aggregate;
-      iv.value = std::move(children);
+      iv.value.emplace<std::vector<InitValPtr>>(std::move(children));
       return iv;
     }
     InitVal iv;
@@ -247,6 +249,104 @@ namespace symir::reify {
     return instrs;
   }
 
+  static Terminator branchTerm(const RyCFGBlock &blk, Cond cond) {
+    BrTerm br;
+    br.cond = std::move(cond);
+    br.thenLabel = BlockLabel{"^" + blk.succs[0], {}};
+    br.elseLabel = BlockLabel{"^" + blk.succs[1], {}};
+    br.dest = br.thenLabel;
+    br.isConditional = true;
+    return Terminator{std::move(br)};
+  }
+
+  // ---------------------------------------------------------------------------
+  // Incremental generation
+  // ---------------------------------------------------------------------------
+
+  // Writes the blocks of `path` into `fun`, whose skeleton genFunction made,
+  // in the order the path runs them, checking each with the oracle: its
+  // statements (with the interest requires), then its branch condition,
+  // each generated anew while the oracle refutes them. Statements refuted
+  // kIncrementalRegens times are left out. Once a step cannot be replaced
+  // (a branch condition, or a block the path runs again), the rest is
+  // generated unchecked and false is returned.
+  static bool genPathIncrementally(
+      std::mt19937 &rng, SymCounter &sym, FunDecl &fun, const Program &prog, const RyCFG &cfg,
+      const std::vector<std::string> &path, const VarCatalogue &vars, const FuncGenConfig &fcfg
+  ) {
+    PathOracle &oracle = *fcfg.oracle;
+    oracle.start(prog, fun.name.name);
+
+    std::unordered_map<std::string, Block *> blocks;
+    for (auto &b: fun.blocks)
+      blocks[b.label.name] = &b;
+
+    bool feasible = true;
+    std::unordered_set<std::string> written;
+    for (std::size_t i = 0; i < path.size(); i++) {
+      Block &block = *blocks.at("^" + path[i]);
+      std::string next = i + 1 < path.size() ? "^" + path[i + 1] : "";
+      const std::string *nextLabel = i + 1 < path.size() ? &next : nullptr;
+
+      // The exit block, or one the path runs again, is what it is.
+      if (path[i] == cfg.exitLabel || !written.insert(path[i]).second) {
+        feasible = feasible && oracle.take(block, 0, nextLabel);
+        continue;
+      }
+
+      // A block that only jumps on is checked with its edge, a branching
+      // one before its condition is generated.
+      const auto *blk = cfg.get(path[i]);
+      auto check = [&] {
+        if (!feasible)
+          return true;
+        if (blk->isBranch())
+          return block.instrs.empty() || oracle.run(block, 0);
+        return oracle.take(block, 0, nextLabel);
+      };
+
+      // The entry's pointer setup and interest-init require stay.
+      std::size_t prologue = block.instrs.size();
+      bool accepted = false;
+      for (int attempt = 0; attempt < hp::kIncrementalRegens && !accepted; attempt++) {
+        SymCounter saved = sym;
+        int coefsBefore = sym.countOfKind(SymKind::Coef);
+        auto stmts = genBlockStmts(rng, &sym, vars, fcfg.nStmts, true, false, fcfg.exprCfg);
+        if (fcfg.enableInterestCoefs)
+          for (auto &r: interestCoefRequires(sym, coefsBefore))
+            stmts.push_back(std::move(r));
+        for (auto &ins: stmts)
+          block.instrs.push_back(std::move(ins));
+        fun.syms = sym.makeDecls();
+        accepted = check();
+        if (!accepted) {
+          block.instrs.erase(block.instrs.begin() + (std::ptrdiff_t) prologue, block.instrs.end());
+          sym = std::move(saved);
+          fun.syms = sym.makeDecls();
+        }
+      }
+      if (!accepted)
+        feasible = check();
+
+      if (!blk->isBranch())
+        continue;
+      std::size_t body = block.instrs.size();
+      for (int attempt = 0;; attempt++) {
+        SymCounter saved = sym;
+        block.term = branchTerm(*blk, genCond(rng, &sym, vars, true, fcfg.exprCfg));
+        fun.syms = sym.makeDecls();
+        if (!feasible || oracle.take(block, body, nextLabel))
+          break;
+        if (attempt + 1 == hp::kIncrementalRegens) {
+          feasible = false;
+          break;
+        }
+        sym = std::move(saved);
+      }
+    }
+    return feasible;
+  }
+
   // ---------------------------------------------------------------------------
   // genFunction
   // ---------------------------------------------------------------------------
@@ -278,6 +378,8 @@ namespace symir::reify {
       const auto *blk = cfg.get(blkLabel);
       bool onPath = pathSet.count(blkLabel) > 0;
       bool isExit = (blkLabel == cfg.exitLabel);
+      // With an oracle, on-path blocks are filled in path order afterwards.
+      bool deferred = fcfg.oracle && onPath && !isExit;
 
       Block block;
       block.label = BlockLabel{"^" + blkLabel, {}};
@@ -322,12 +424,13 @@ namespace symir::reify {
           }
         }
 
-        // Generate statements for on-path non-exit blocks
-        if (onPath) {
+        // Generate statements for on-path non-exit blocks (deferred ones
+        // are left to genPathIncrementally)
+        if (onPath && !deferred) {
           auto stmts = genBlockStmts(rng, &sym, vars, fcfg.nStmts, true, false, fcfg.exprCfg);
           for (auto &s: stmts)
             block.instrs.push_back(std::move(s));
-        } else {
+        } else if (!onPath) {
           // Off-path: concrete-only stmts
           auto stmts =
               genBlockStmts(rng, nullptr, vars, fcfg.nStmts, false, fcfg.safeOffPath, fcfg.exprCfg);
@@ -336,22 +439,26 @@ namespace symir::reify {
         }
 
         // Interest coef requires (on-path only, before terminator)
-        if (fcfg.enableInterestCoefs && onPath) {
+        if (fcfg.enableInterestCoefs && onPath && !deferred) {
           auto reqs = interestCoefRequires(sym, coefsBefore);
           for (auto &r: reqs)
             block.instrs.push_back(std::move(r));
         }
 
         // Terminator
-        if (blk->isBranch()) {
-          Cond cond = genCond(rng, onPath ? &sym : nullptr, vars, onPath, fcfg.exprCfg);
-          BrTerm br;
-          br.cond = std::move(cond);
-          br.thenLabel = BlockLabel{"^" + blk->succs[0], {}};
-          br.elseLabel = BlockLabel{"^" + blk->succs[1], {}};
-          br.dest = br.thenLabel;
-          br.isConditional = true;
-          block.term = Terminator{std::move(br)};
+        if (blk->isBranch() && deferred) {
+          // `0 == 0` keeps the skeleton a whole program for oracle.start. It
+          // is never evaluated: the block is on the path, and
+          // genPathIncrementally generates its condition before the
+          // oracle's first take() of it, the only call that runs a
+          // terminator.
+          Cond cond{simpleExpr(coefAtom(IntLit{0, {}})), RelOp::EQ,
+                    simpleExpr(coefAtom(IntLit{0, {}})), {}};
+          block.term = branchTerm(*blk, std::move(cond));
+        } else if (blk->isBranch()) {
+          block.term = branchTerm(
+              *blk, genCond(rng, onPath ? &sym : nullptr, vars, onPath, fcfg.exprCfg)
+          );
         } else if (blk->isGoto()) {
           BrTerm br;
           br.dest = BlockLabel{"^" + blk->succs[0], {}};
@@ -373,7 +480,8 @@ namespace symir::reify {
     // Assemble Program
     // ---------------------------------------------------------------------------
 
-    Program prog;
+    FuncGenResult res;
+    Program &prog = res.prog;
     prog.structs = vars.structDecls;
 
     FunDecl fun;
@@ -416,13 +524,17 @@ namespace symir::reify {
     fun.blocks = std::move(blocks);
     prog.funs.push_back(std::move(fun));
 
+    if (fcfg.oracle)
+      res.refuted =
+          !genPathIncrementally(rng, sym, prog.funs.back(), prog, cfg, path, vars, fcfg);
+    res.intAtoms = sym.intAtoms;
+
     // Build path labels with ^ prefix
-    std::vector<std::string> pathLabels;
-    pathLabels.reserve(path.size());
+    res.pathLabels.reserve(path.size());
     for (const auto &lbl: path)
-      pathLabels.push_back("^" + lbl);
+      res.pathLabels.push_back("^" + lbl);
 
-    return FuncGenResult{std::move(prog), std::move(pathLabels)};
+    return res;
   }
 
 } // namespace symir::reify
@@ -0,0 +1,217 @@
+#include "reify/hyperparameters.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace symir::reify::hp {
+
+  namespace {
+
+    Params processParams;
+    thread_local const Params *current = nullptr;
+
+    struct IntField {
+      const char *name;
+      int Params::*field;
+    };
+
+    struct RealField {
+      const char *name;
+      double Params::*field;
+    };
+
+    // Slot tables, each in the order its generator walks it.
+    const IntField kIntOnPathEnds[] = {
+        {"IntOnPath_CoefBareEnd", &Params::intOnPath_CoefBareEnd},
+        {"IntOnPath_MulEnd", &Params::intOnPath_MulEnd},
+        {"IntOnPath_BitwiseEnd", &Params::intOnPath_BitwiseEnd},
+        {"IntOnPath_ShiftEnd", &Params::intOnPath_ShiftEnd},
+        {"IntOnPath_UnaryNotEnd", &Params::intOnPath_UnaryNotEnd},
+        {"IntOnPath_CastEnd", &Params::intOnPath_CastEnd},
+        {"IntOnPath_DivModEnd", &Params::intOnPath_DivModEnd},
+        {"IntOnPath_LoadEnd", &Params::intOnPath_LoadEnd},
+        {"IntOnPath_SelectEnd", &Params::intOnPath_SelectEnd},
+    };
+    const IntField kIntOffPathEnds[] = {
+        {"IntOffPath_ConcreteEnd", &Params::intOffPath_ConcreteEnd},
+        {"IntOffPath_MulEnd", &Params::intOffPath_MulEnd},
+        {"IntOffPath_BitwiseEnd", &Params::intOffPath_BitwiseEnd},
+        {"IntOffPath_CastEnd", &Params::intOffPath_CastEnd},
+        {"IntOffPath_DivModEnd", &Params::intOffPath_DivModEnd},
+        {"IntOffPath_PlainRvalEnd", &Params::intOffPath_PlainRvalEnd},
+        {"IntOffPath_LoadEnd", &Params::intOffPath_LoadEnd},
+        {"IntOffPath_SelectEnd", &Params::intOffPath_SelectEnd},
+    };
+    const IntField kFloatOnPathEnds[] = {
+        {"FloatOnPath_CastFromI32SymEnd", &Params::floatOnPath_CastFromI32SymEnd},
+        {"FloatOnPath_MulLitEnd", &Params::floatOnPath_MulLitEnd},
+        {"FloatOnPath_CastFromVarEnd", &Params::floatOnPath_CastFromVarEnd},
+        {"FloatOnPath_SelectEnd", &Params::floatOnPath_SelectEnd},
+    };
+    const IntField kVecEnds[] = {
+        {"VecCopyEnd", &Params::vecCopyEnd},
+        {"VecSymMulEnd", &Params::vecSymMulEnd},
+        {"VecConcMulEnd", &Params::vecConcMulEnd},
+    };
+    const IntField kOtherInts[] = {
+        {"MinAtomsPerExpr", &Params::minAtomsPerExpr},
+        {"MaxAtomsPerExpr", &Params::maxAtomsPerExpr},
+        {"VecLaneWriteProb", &Params::vecLaneWriteProb},
+    };
+
+    // Weights, normalised at the use site.
+    const RealField kTypeWeights[] = {
+        {"PTypeScalar", &Params::pTypeScalar},
+        {"PTypeArray", &Params::pTypeArray},
+        {"PTypeStruct", &Params::pTypeStruct},
+        {"PTypePtr", &Params::pTypePtr},
+        {"PTypeVec", &Params::pTypeVec},
+    };
+    const RealField kFractions[] = {
+        {"FracNonPtrVars", &Params::fracNonPtrVars},
+        {"FracPtr1Vars", &Params::fracPtr1Vars},
+        {"FracAggPtrVars", &Params::fracAggPtrVars},
+        {"PStructFieldIsArray", &Params::pStructFieldIsArray},
+    };
+
+    template<typename F>
+    void forEachIntField(F &&f) {
+      for (const auto &x: kIntOnPathEnds)
+        f(x);
+      for (const auto &x: kIntOffPathEnds)
+        f(x);
+      for (const auto &x: kFloatOnPathEnds)
+        f(x);
+      for (const auto &x: kOtherInts)
+        f(x);
+      for (const auto &x: kVecEnds)
+        f(x);
+    }
+
+    template<typename F>
+    void forEachRealField(F &&f) {
+      for (const auto &x: kTypeWeights)
+        f(x);
+      for (const auto &x: kFractions)
+        f(x);
+    }
+
+    template<std::size_t N>
+    std::string checkEnds(const Params &p, const IntField (&ends)[N]) {
+      int prev = 0;
+      for (const auto &e: ends) {
+        int v = p.*e.field;
+        if (v < prev || v > 100)
+          return std::string(e.name) + " = " + std::to_string(v) + " is not in [" +
+                 std::to_string(prev) + ", 100]";
+        prev = v;
+      }
+      return "";
+    }
+
+    std::string trim(const std::string &s) {
+      auto b = s.find_first_not_of(" \t\r");
+      if (b == std::string::npos)
+        return "";
+      auto e = s.find_last_not_of(" \t\r");
+      return s.substr(b, e - b + 1);
+    }
+
+    template<typename T>
+    bool parseNumber(const std::string &text, T &out) {
+      const char *end = text.data() + text.size();
+      auto [ptr, ec] = std::from_chars(text.data(), end, out);
+      return ec == std::errc() && ptr == end;
+    }
+
+  } // namespace
+
+  const char *intAtomName(IntAtom k) {
+    static const char *const names[] = {"CoefBare", "Mul",    "Bitwise", "Shift", "UnaryNot",
+                                        "Cast",     "DivMod", "Load",    "Select"};
+    return names[(int) k];
+  }
+
+  int Params::*intOnPathEnd(IntAtom k) { return kIntOnPathEnds[(int) k].field; }
+
+  const Params &params() { return current ? *current : processParams; }
+
+  void configure(const Params &p) { processParams = p; }
+
+  Scope::Scope(const Params &p) : prev_(current) { current = &p; }
+
+  Scope::~Scope() { current = prev_; }
+
+  std::string validate(const Params &p) {
+    for (const auto &err: {checkEnds(p, kIntOnPathEnds), checkEnds(p, kIntOffPathEnds),
+                           checkEnds(p, kFloatOnPathEnds), checkEnds(p, kVecEnds)})
+      if (!err.empty())
+        return err;
+    if (p.vecLaneWriteProb < 0 || p.vecLaneWriteProb > 100)
+      return "VecLaneWriteProb is not in [0, 100]";
+    if (p.minAtomsPerExpr < 1 || p.maxAtomsPerExpr < p.minAtomsPerExpr)
+      return "need 1 <= MinAtomsPerExpr <= MaxAtomsPerExpr";
+    for (const auto &r: kTypeWeights)
+      if (!(p.*r.field >= 0.0))
+        return std::string(r.name) + " is negative";
+    for (const auto &r: kFractions)
+      if (!(p.*r.field >= 0.0 && p.*r.field <= 1.0))
+        return std::string(r.name) + " is not in [0, 1]";
+    if (p.fracNonPtrVars + p.fracPtr1Vars > 1.0)
+      return "FracNonPtrVars + FracPtr1Vars exceeds 1";
+    return "";
+  }
+
+  Params loadParams(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+      throw std::runtime_error("cannot open hyperparameter file: " + path);
+    Params p;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); lineNo++) {
+      auto where = [&] { return path + ":" + std::to_string(lineNo) + ": "; };
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty())
+        continue;
+      auto eq = line.find('=');
+      if (eq == std::string::npos)
+        throw std::runtime_error(where() + "expected `Name = value`");
+      std::string name = trim(line.substr(0, eq));
+      std::string value = trim(line.substr(eq + 1));
+      bool known = false, ok = false;
+      auto match = [&](const auto &f) {
+        if (!known && name == f.name) {
+          known = true;
+          ok = parseNumber(value, p.*f.field);
+        }
+      };
+      forEachIntField(match);
+      forEachRealField(match);
+      if (!known)
+        throw std::runtime_error(where() + "unknown hyperparameter `" + name + "`");
+      if (!ok)
+        throw std::runtime_error(where() + "bad value `" + value + "` for " + name);
+    }
+    auto err = validate(p);
+    if (!err.empty())
+      throw std::runtime_error(path + ": " + err);
+    return p;
+  }
+
+  std::string formatParams(const Params &p) {
+    std::ostringstream os;
+    // Shortest form that reads back as the same value.
+    auto write = [&](const auto &f) {
+      char buf[32];
+      auto res = std::to_chars(buf, buf + sizeof buf, p.*f.field);
+      os << f.name << " = " << std::string_view(buf, res.ptr - buf) << "\n";
+    };
+    forEachIntField(write);
+    forEachRealField(write);
+    return os.str();
+  }
+
+} // namespace symir::reify::hp
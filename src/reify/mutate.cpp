@@ -0,0 +1,268 @@
+#include "reify/mutate.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include "frontend/lexer.hpp"
+#include "frontend/parser.hpp"
+#include "reify/var_catalogue.hpp"
+
+namespace fs = std::filesystem;
+
+namespace symir::reify {
+
+  // ---------------------------------------------------------------------------
+  // Corpus
+  // ---------------------------------------------------------------------------
+
+  // The labels of a `// path: entry -> b0 -> exit` line, with their `^`.
+  static std::vector<std::string> pathOfHeader(const std::string &text) {
+    std::istringstream in(text);
+    std::string line;
+    static const std::string kPrefix = "// path:";
+    while (std::getline(in, line)) {
+      if (line.rfind(kPrefix, 0) != 0)
+        continue;
+      std::vector<std::string> path;
+      std::istringstream words(line.substr(kPrefix.size()));
+      std::string w;
+      while (words >> w)
+        if (w != "->")
+          path.push_back("^" + w);
+      return path;
+    }
+    return {};
+  }
+
+  std::vector<CorpusEntry> loadCorpus(const std::string &dir, std::vector<std::string> &skipped) {
+    std::vector<fs::path> files;
+    for (const auto &e: fs::directory_iterator(dir))
+      if (e.is_regular_file() && e.path().extension() == ".sir")
+        files.push_back(e.path());
+    std::sort(files.begin(), files.end()); // the same corpus for the same directory
+
+    std::vector<CorpusEntry> corpus;
+    for (const auto &file: files) {
+      std::ifstream in(file);
+      std::stringstream text;
+      text << in.rdbuf();
+      CorpusEntry entry;
+      entry.name = file.filename().string();
+      entry.path = pathOfHeader(text.str());
+      try {
+        std::string src = text.str();
+        Lexer lexer(src);
+        Parser parser(lexer);
+        entry.prog = parser.parseProgram();
+      } catch (const std::exception &) {
+        entry.prog.funs.clear();
+      }
+      if (entry.path.size() < 2 || entry.prog.funs.empty()) {
+        skipped.push_back(entry.name);
+        continue;
+      }
+      corpus.push_back(std::move(entry));
+    }
+    return corpus;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Mutations
+  // ---------------------------------------------------------------------------
+
+  template<typename T>
+  static T &pickOne(std::mt19937 &rng, std::vector<T> &v) {
+    std::uniform_int_distribution<std::size_t> pick(0, v.size() - 1);
+    return v[pick(rng)];
+  }
+
+  static Block *findBlock(FunDecl &fun, const std::string &label) {
+    for (auto &b: fun.blocks)
+      if (b.label.name == label)
+        return &b;
+    return nullptr;
+  }
+
+  // The op atoms of the statements of the blocks on the path, but the exit
+  // (whose checksum stays as it is).
+  static std::vector<OpAtom *> onPathOpAtoms(FunDecl &fun, const std::vector<std::string> &path) {
+    std::unordered_set<std::string> onPath(path.begin(), path.end() - 1);
+    std::vector<OpAtom *> atoms;
+    auto visit = [&](Expr &e) {
+      if (auto *op = std::get_if<OpAtom>(&e.first.v))
+        atoms.push_back(op);
+      for (auto &t: e.rest)
+        if (auto *op = std::get_if<OpAtom>(&t.atom.v))
+          atoms.push_back(op);
+    };
+    for (auto &b: fun.blocks) {
+      if (!onPath.count(b.label.name))
+        continue;
+      for (auto &instr: b.instrs) {
+        if (auto *a = std::get_if<AssignInstr>(&instr))
+          visit(a->rhs);
+        else if (auto *s = std::get_if<StoreInstr>(&instr))
+          visit(s->val);
+      }
+    }
+    return atoms;
+  }
+
+  static const char *opSpelling(AtomOpKind op) {
+    static const char *const kSpellings[] = {"*", "/", "%", "&", "|", "^", "<<", ">>", ">>>"};
+    return kSpellings[(int) op];
+  }
+
+  static std::string swapOp(std::mt19937 &rng, FunDecl &fun, const std::vector<std::string> &path) {
+    auto atoms = onPathOpAtoms(fun, path);
+    if (atoms.empty())
+      return "";
+    static const std::vector<std::vector<AtomOpKind>> families = {
+        {AtomOpKind::Mul, AtomOpKind::And, AtomOpKind::Or, AtomOpKind::Xor},
+        {AtomOpKind::Shl, AtomOpKind::Shr, AtomOpKind::LShr},
+        {AtomOpKind::Div, AtomOpKind::Mod},
+    };
+    OpAtom *atom = pickOne(rng, atoms);
+    for (auto family: families) {
+      auto it = std::find(family.begin(), family.end(), atom->op);
+      if (it == family.end())
+        continue;
+      family.erase(it);
+      AtomOpKind from = atom->op;
+      atom->op = pickOne(rng, family);
+      return std::string("swap ") + opSpelling(from) + " for " + opSpelling(atom->op) +
+             " on the path";
+    }
+    return "";
+  }
+
+  static std::string narrowSym(std::mt19937 &rng, FunDecl &fun) {
+    std::vector<SymDecl *> syms;
+    for (auto &s: fun.syms)
+      if (s.domain && std::holds_alternative<DomainInterval>(*s.domain))
+        if (auto &d = std::get<DomainInterval>(*s.domain); d.hi > d.lo)
+          syms.push_back(&s);
+    if (syms.empty())
+      return "";
+    SymDecl *sym = pickOne(rng, syms);
+    auto &d = std::get<DomainInterval>(*sym->domain);
+    // A random part of [lo, hi], from half of it down to 1/65536th.
+    uint64_t width = (uint64_t) d.hi - (uint64_t) d.lo;
+    std::uniform_int_distribution<int> shift(1, 16);
+    uint64_t narrowed = width >> shift(rng);
+    std::uniform_int_distribution<uint64_t> offset(0, width - narrowed);
+    d.lo = (int64_t) ((uint64_t) d.lo + offset(rng));
+    d.hi = (int64_t) ((uint64_t) d.lo + narrowed);
+    return "narrow " + sym->name.name + " to [" + std::to_string(d.lo) + ", " +
+           std::to_string(d.hi) + "]";
+  }
+
+  // The locals of `fun` as genBlockStmts sees them; pointers keep the
+  // targets their lets or the entry block gave them.
+  static VarCatalogue catalogueOf(const Program &prog, const FunDecl &fun) {
+    VarCatalogue vars;
+    vars.structDecls = prog.structs;
+    for (const auto &let: fun.lets) {
+      if (let.name.name == "%_chk")
+        continue;
+      VarEntry v;
+      v.name = let.name.name;
+      v.type = let.type;
+      TypePtr t = let.type;
+      if (auto *at = std::get_if<ArrayType>(&t->v))
+        t = at->elem;
+      if (auto *st = std::get_if<StructType>(&t->v))
+        v.structTypeName = st->name.name;
+      vars.vars.push_back(std::move(v));
+    }
+    return vars;
+  }
+
+  static std::string insertBlock(
+      std::mt19937 &rng, Program &prog, FunDecl &fun, std::vector<std::string> &path,
+      const MutateConfig &cfg
+  ) {
+    // An edge the path takes, and the branch that takes it
+    std::uniform_int_distribution<std::size_t> pickEdge(0, path.size() - 2);
+    std::size_t at = pickEdge(rng);
+    const std::string from = path[at], to = path[at + 1];
+    Block *src = findBlock(fun, from);
+    auto *br = src ? std::get_if<BrTerm>(&src->term) : nullptr;
+    if (!br)
+      return "";
+
+    std::string label;
+    for (int k = 0; label.empty() || findBlock(fun, label); k++)
+      label = "^m" + std::to_string(k);
+
+    // New syms are numbered on from the function's own.
+    SymCounter sym;
+    sym.coefLo = cfg.coefLo;
+    sym.coefHi = cfg.coefHi;
+    sym.valueLo = cfg.valueLo;
+    sym.valueHi = cfg.valueHi;
+    sym.indexLo = cfg.indexLo;
+    sym.indexHi = cfg.indexHi;
+    for (const auto &s: fun.syms)
+      if (s.name.name.rfind("%?s", 0) == 0)
+        sym.n = std::max(sym.n, std::atoi(s.name.name.c_str() + 3) + 1);
+
+    VarCatalogue vars = catalogueOf(prog, fun);
+    if (vars.vars.empty())
+      return "";
+    Block block;
+    block.label = BlockLabel{label, {}};
+    block.instrs = genBlockStmts(rng, &sym, vars, cfg.nStmts, true, false, cfg.exprCfg);
+    if (cfg.enableInterestCoefs)
+      for (auto &r: interestCoefRequires(sym, 0))
+        block.instrs.push_back(std::move(r));
+    BrTerm jump;
+    jump.dest = BlockLabel{to, {}};
+    jump.thenLabel = jump.dest;
+    jump.elseLabel = jump.dest;
+    block.term = Terminator{std::move(jump)};
+    for (auto &d: sym.makeDecls())
+      fun.syms.push_back(std::move(d));
+
+    // Retarget the edge, here and on the path.
+    if (br->isConditional) {
+      if (br->thenLabel.name == to)
+        br->thenLabel.name = label;
+      if (br->elseLabel.name == to)
+        br->elseLabel.name = label;
+    } else {
+      br->dest.name = label;
+      br->thenLabel = br->dest;
+      br->elseLabel = br->dest;
+    }
+    for (std::size_t i = 0; i + 1 < path.size(); i++)
+      if (path[i] == from && path[i + 1] == to)
+        path.insert(path.begin() + (std::ptrdiff_t) ++i, label);
+
+    auto pos = std::find_if(fun.blocks.begin(), fun.blocks.end(), [&](const Block &b) {
+      return b.label.name == from;
+    });
+    fun.blocks.insert(pos + 1, std::move(block));
+    return "insert " + label + " on " + from + " -> " + to;
+  }
+
+  std::string mutate(
+      std::mt19937 &rng, Program &prog, std::vector<std::string> &path, const MutateConfig &cfg
+  ) {
+    if (prog.funs.empty() || path.size() < 2)
+      return "";
+    FunDecl &fun = prog.funs.front();
+    std::uniform_int_distribution<int> kind(0, 2);
+    switch (kind(rng)) {
+      case 0:
+        return narrowSym(rng, fun);
+      case 1:
+        return swapOp(rng, fun, path);
+      default:
+        return insertBlock(rng, prog, fun, path, cfg);
+    }
+  }
+
+} // namespace symir::reify
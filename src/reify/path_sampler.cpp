@@ -3,136 +3,136 @@
 #include <algorithm>
 #include <deque>
 #include <random>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace symir::reify {
 
-  static std::optional<std::vector<std::string>>
-  shortestToExit(const RyCFG &cfg, const std::string &start) {
-    std::deque<std::vector<std::string>> q;
-    q.push_back({start});
-    std::unordered_set<std::string> visited{start};
-
-    while (!q.empty()) {
-      auto p = std::move(q.front());
-      q.pop_front();
-      if (p.back() == cfg.exitLabel)
-        return std::vector<std::string>(p.begin() + 1, p.end());
-      const auto *blk = cfg.get(p.back());
-      if (!blk)
-        continue;
-      for (const auto &s: blk->succs) {
-        if (!visited.count(s)) {
-          visited.insert(s);
-          auto np = p;
-          np.push_back(s);
-          q.push_back(std::move(np));
+  PathSampler::PathSampler(const RyCFG &cfg) : cfg_(cfg) {
+    std::size_t n = cfg.blocks.size();
+    edgeBase_.assign(n + 1, 0);
+    for (std::size_t i = 0; i < n; i++)
+      edgeBase_[i + 1] = edgeBase_[i] + cfg.blocks[i].succIds.size();
+
+    // Breadth-first from the exit over the reversed edges.
+    distToExit_.assign(n, -1);
+    if (cfg.exitId < n) {
+      std::deque<std::size_t> q{cfg.exitId};
+      distToExit_[cfg.exitId] = 0;
+      while (!q.empty()) {
+        std::size_t cur = q.front();
+        q.pop_front();
+        for (std::size_t p: cfg.blocks[cur].predIds)
+          if (distToExit_[p] < 0) {
+            distToExit_[p] = distToExit_[cur] + 1;
+            q.push_back(p);
+          }
+      }
+    }
+
+    // Static back edges: the destination comes no later than the source in
+    // block order. The CFG is built so that block order matches a forward
+    // spanning chain (entry -> b0 -> ... -> exit), so these edges form the
+    // loops.
+    for (std::size_t i = 0; i < n; i++) {
+      const auto &succs = cfg.blocks[i].succIds;
+      for (std::size_t k = 0; k < succs.size(); k++) {
+        if (succs[k] > i)
+          continue;
+        BackEdge be{i, k, succs[k], BitVector(n)};
+        std::deque<std::size_t> q{i};
+        be.reachesSrc.set(i);
+        while (!q.empty()) {
+          std::size_t cur = q.front();
+          q.pop_front();
+          for (std::size_t p: cfg.blocks[cur].predIds)
+            if (!be.reachesSrc.test(p)) {
+              be.reachesSrc.set(p);
+              q.push_back(p);
+            }
         }
+        backEdges_.push_back(std::move(be));
       }
     }
-    return std::nullopt;
   }
 
-  std::optional<std::vector<std::string>>
-  samplePath(const RyCFG &cfg, const SamplePathParams &params) {
-    std::mt19937 rng(params.seed);
-
-    // Identify static back edges (dst appears earlier in the label order than src).
-    // The CFG is built so that label-order matches a forward spanning chain
-    // (entry -> b0 -> ... -> exit), so these edges form the loops.
-    std::vector<std::pair<std::string, std::string>> staticBackEdges;
-    for (std::size_t i = 0; i < cfg.blocks.size(); i++) {
-      const auto &blk = cfg.blocks[i];
-      for (const auto &s: blk.succs) {
-        auto it = cfg.blockIndex.find(s);
-        if (it != cfg.blockIndex.end() && it->second <= i)
-          staticBackEdges.push_back({blk.label, s});
-      }
+  // Takes, at each step, the first successor one step closer to the exit:
+  // the shortest path a breadth-first search over the successors in order
+  // finds first.
+  bool PathSampler::appendShortestToExit(std::vector<std::size_t> &path) const {
+    std::size_t cur = path.back();
+    if (distToExit_[cur] < 0)
+      return false;
+    while (cur != cfg_.exitId) {
+      for (std::size_t s: cfg_.blocks[cur].succIds)
+        if (distToExit_[s] == distToExit_[cur] - 1) {
+          cur = s;
+          break;
+        }
+      path.push_back(cur);
     }
+    return true;
+  }
+
+  std::optional<std::vector<std::size_t>> PathSampler::walk(const SamplePathParams &params
+  ) const {
+    std::mt19937 rng(params.seed);
 
     // If a minimum is requested but the CFG has no loops, we cannot satisfy it.
-    if (params.minLoopIter > 0 && staticBackEdges.empty())
+    if (params.minLoopIter > 0 && backEdges_.empty())
       return std::nullopt;
 
-    // Pick a single target back edge to force-traverse the required number of times.
-    std::string targetSrc, targetDst;
-    std::unordered_set<std::string> canReachTarget;
+    // Pick a single target back edge to force-traverse the required number
+    // of times. The walk is biased toward the blocks that can reach its
+    // source while iterations are still owed.
+    const BackEdge *target = nullptr;
     if (params.minLoopIter > 0) {
-      std::uniform_int_distribution<std::size_t> pick(0, staticBackEdges.size() - 1);
-      auto [s, d] = staticBackEdges[pick(rng)];
-      targetSrc = s;
-      targetDst = d;
-
-      // BFS in reverse from targetSrc to mark blocks that can reach it.
-      // The walk will be biased toward these while iterations are still owed.
-      std::unordered_map<std::string, std::vector<std::string>> rev;
-      for (const auto &b: cfg.blocks)
-        for (const auto &succ: b.succs)
-          rev[succ].push_back(b.label);
-      std::deque<std::string> q{targetSrc};
-      canReachTarget.insert(targetSrc);
-      while (!q.empty()) {
-        auto cur = q.front();
-        q.pop_front();
-        for (const auto &p: rev[cur])
-          if (canReachTarget.insert(p).second)
-            q.push_back(p);
-      }
+      std::uniform_int_distribution<std::size_t> pick(0, backEdges_.size() - 1);
+      target = &backEdges_[pick(rng)];
     }
 
-    std::vector<std::string> path{cfg.entry};
-    // back_edge_count[(src, dst)] = traversal count
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> backEdgeCount;
-
-    // A back edge is one whose destination already appears in the path walked so far
-    auto isBackEdge = [&](const std::string &dst) -> bool {
-      return std::find(path.begin(), path.end(), dst) != path.end();
-    };
+    std::vector<std::size_t> path{cfg_.entryId};
+    // A back edge is one whose destination already appears in the path
+    // walked so far; edgeCount[edge id] counts its traversals.
+    BitVector onPath(cfg_.blocks.size());
+    onPath.set(cfg_.entryId);
+    std::vector<int> edgeCount(edgeBase_.back(), 0);
+    auto targetCount = [&] { return edgeCount[edgeBase_[target->src] + target->slot]; };
 
+    std::vector<std::size_t> allowed, biased; // successor slots
     for (int i = 0; i < params.maxPathLen; i++) {
-      const std::string &cur = path.back();
-      if (cur == cfg.exitLabel)
+      std::size_t cur = path.back();
+      if (cur == cfg_.exitId)
         break;
-
-      const auto *blk = cfg.get(cur);
-      if (!blk || blk->succs.empty())
+      const auto &succs = cfg_.blocks[cur].succIds;
+      if (succs.empty())
         break;
 
       // Filter: exclude back edges that hit the iteration limit
-      std::vector<std::string> allowed;
-      for (const auto &s: blk->succs) {
-        if (isBackEdge(s)) {
-          if (backEdgeCount[cur][s] < params.maxLoopIter)
-            allowed.push_back(s);
-        } else {
-          allowed.push_back(s);
-        }
-      }
+      allowed.clear();
+      for (std::size_t k = 0; k < succs.size(); k++)
+        if (!onPath.test(succs[k]) || edgeCount[edgeBase_[cur] + k] < params.maxLoopIter)
+          allowed.push_back(k);
 
       if (allowed.empty()) {
-        auto tail = shortestToExit(cfg, cur);
-        if (!tail)
+        if (!appendShortestToExit(path))
           return std::nullopt;
-        path.insert(path.end(), tail->begin(), tail->end());
         break;
       }
 
-      // While we still owe iterations on the target back edge: at targetSrc
-      // force-take the back edge; elsewhere bias the random walk toward
-      // successors that can still reach targetSrc.
-      std::string chosen;
+      // While we still owe iterations on the target back edge: at its
+      // source force-take it; elsewhere bias the random walk toward
+      // successors that can still reach its source.
+      std::size_t chosen = 0;
       bool forced = false;
-      if (!targetSrc.empty() && backEdgeCount[targetSrc][targetDst] < params.minLoopIter) {
-        if (cur == targetSrc &&
-            std::find(allowed.begin(), allowed.end(), targetDst) != allowed.end()) {
-          chosen = targetDst;
+      if (target && targetCount() < params.minLoopIter) {
+        if (cur == target->src &&
+            std::find(allowed.begin(), allowed.end(), target->slot) != allowed.end()) {
+          chosen = target->slot;
           forced = true;
         } else {
-          std::vector<std::string> biased;
-          for (const auto &s: allowed)
-            if (canReachTarget.count(s))
-              biased.push_back(s);
+          biased.clear();
+          for (std::size_t k: allowed)
+            if (target->reachesSrc.test(succs[k]))
+              biased.push_back(k);
           if (!biased.empty()) {
             std::uniform_int_distribution<int> pick(0, (int) biased.size() - 1);
             chosen = biased[pick(rng)];
@@ -145,24 +145,65 @@ namespace symir::reify {
         chosen = allowed[pick(rng)];
       }
 
-      if (isBackEdge(chosen))
-        backEdgeCount[cur][chosen]++;
-      path.push_back(chosen);
+      std::size_t next = succs[chosen];
+      if (onPath.test(next))
+        edgeCount[edgeBase_[cur] + chosen]++;
+      onPath.set(next);
+      path.push_back(next);
     }
 
-    if (path.back() != cfg.exitLabel) {
-      auto tail = shortestToExit(cfg, path.back());
-      if (!tail)
-        return std::nullopt;
-      path.insert(path.end(), tail->begin(), tail->end());
-    }
+    if (path.back() != cfg_.exitId && !appendShortestToExit(path))
+      return std::nullopt;
 
     // Safety net: if the forced edge never got enough iterations (e.g. ran out
     // of maxPathLen budget), reject so the caller can retry with a fresh seed.
-    if (params.minLoopIter > 0 && backEdgeCount[targetSrc][targetDst] < params.minLoopIter)
+    if (target && targetCount() < params.minLoopIter)
       return std::nullopt;
 
     return path;
   }
 
+  std::vector<std::string> PathSampler::labelsOf(const std::vector<std::size_t> &path) const {
+    std::vector<std::string> labels;
+    labels.reserve(path.size());
+    for (std::size_t id: path)
+      labels.push_back(cfg_.blocks[id].label);
+    return labels;
+  }
+
+  std::optional<std::vector<std::string>> PathSampler::sample(const SamplePathParams &params
+  ) const {
+    auto path = walk(params);
+    if (!path)
+      return std::nullopt;
+    return labelsOf(*path);
+  }
+
+  std::vector<std::vector<std::string>>
+  PathSampler::sample(const SamplePathParams &params, int k) const {
+    std::vector<std::vector<std::size_t>> found;
+    SamplePathParams p = params;
+    for (int attempt = 0; attempt < 4 * k && (int) found.size() < k; attempt++) {
+      p.seed = params.seed + (uint32_t) attempt;
+      auto path = walk(p);
+      if (path && std::find(found.begin(), found.end(), *path) == found.end())
+        found.push_back(std::move(*path));
+    }
+    std::vector<std::vector<std::string>> paths;
+    paths.reserve(found.size());
+    for (const auto &path: found)
+      paths.push_back(labelsOf(path));
+    return paths;
+  }
+
+  std::optional<std::vector<std::string>>
+  samplePath(const RyCFG &cfg, const SamplePathParams &params) {
+    return PathSampler(cfg).sample(params);
+  }
+
+  std::vector<std::vector<std::string>>
+  samplePaths(const RyCFG &cfg, const SamplePathParams &params, int k) {
+    return PathSampler(cfg).sample(params, k);
+  }
+
 } // namespace symir::reify
@@ -149,12 +149,13 @@ namespace symir::reify {
   TypePtr genRandomType(std::mt19937 &rng, const TypeGenConfig &cfg, int depth) {
     // Type-kind probability buckets — see hp::kPType*. Aggregates are zeroed
     // past maxAggNesting and pointers past maxPtrDepth, then renormalized.
-    double pScalar = hp::kPTypeScalar;
-    double pArray = (depth >= cfg.maxAggNesting) ? 0.0 : hp::kPTypeArray;
-    double pStruct = (depth >= cfg.maxAggNesting) ? 0.0 : hp::kPTypeStruct;
-    double pPtr = (depth >= cfg.maxPtrDepth) ? 0.0 : hp::kPTypePtr;
+    const hp::Params &hpp = hp::params();
+    double pScalar = hpp.pTypeScalar;
+    double pArray = (depth >= cfg.maxAggNesting) ? 0.0 : hpp.pTypeArray;
+    double pStruct = (depth >= cfg.maxAggNesting) ? 0.0 : hpp.pTypeStruct;
+    double pPtr = (depth >= cfg.maxPtrDepth) ? 0.0 : hpp.pTypePtr;
     // [v0.2.1] Vectors only at depth 0 (no nested vec, no vec in arrays/structs).
-    double pVec = (depth == 0 && cfg.enableVec) ? hp::kPTypeVec : 0.0;
+    double pVec = (depth == 0 && cfg.enableVec) ? hpp.pTypeVec : 0.0;
 
     // Renormalize
     double total = pScalar + pArray + pStruct + pPtr + pVec;
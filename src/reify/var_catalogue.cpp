@@ -123,7 +123,7 @@ namespace symir::reify {
         FieldDecl fd;
         fd.name = "f" + std::to_string(fi);
         // Struct field is an array with probability hp::kPStructFieldIsArray
-        if (prob(rng) < hp::kPStructFieldIsArray && tcfg.maxAggElems >= 1) {
+        if (prob(rng) < hp::params().pStructFieldIsArray && tcfg.maxAggElems >= 1) {
           std::uniform_int_distribution<int> szd(1, std::max(1, tcfg.maxAggElems));
           uint64_t sz = (uint64_t) szd(rng);
           ArrayType at;
@@ -140,8 +140,8 @@ namespace symir::reify {
     };
 
     // Split cfg.nVars between phases — see hp::kFracNonPtrVars / kFracPtr1Vars.
-    int nNonPtr = std::max(1, (int) (cfg.nVars * hp::kFracNonPtrVars));
-    int nPtr1 = std::max(0, (int) (cfg.nVars * hp::kFracPtr1Vars));
+    int nNonPtr = std::max(1, (int) (cfg.nVars * hp::params().fracNonPtrVars));
+    int nPtr1 = std::max(0, (int) (cfg.nVars * hp::params().fracPtr1Vars));
     int nPtr2 = cfg.nVars - nNonPtr - nPtr1;
     if (nPtr2 < 0)
       nPtr2 = 0;
@@ -279,7 +279,7 @@ namespace symir::reify {
         else if (std::holds_alternative<StructType>(v.type->v))
           aggTargets.push_back({v.name, v.type});
       }
-      int nAggPtr = std::max(0, (int) (cfg.nVars * hp::kFracAggPtrVars));
+      int nAggPtr = std::max(0, (int) (cfg.nVars * hp::params().fracAggPtrVars));
       for (int i = 0; i < nAggPtr && !aggTargets.empty(); i++) {
         std::uniform_int_distribution<int> ad(0, (int) aggTargets.size() - 1);
         const auto &tgt = aggTargets[ad(rng)];
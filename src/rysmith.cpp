@@ -15,10 +15,17 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -31,11 +38,19 @@
 #include "frontend/diagnostics.hpp"
 #include "frontend/semchecker.hpp"
 #include "frontend/typechecker.hpp"
+#include "interp/interpreter.hpp"
+#include "interp/native.hpp"
+#include "json.hpp"
+#include "reify/adaptive.hpp"
 #include "reify/cfg_gen.hpp"
 #include "reify/func_gen.hpp"
+#include "reify/mutate.hpp"
 #include "reify/path_sampler.hpp"
 #include "reify/var_catalogue.hpp"
 #include "solver/solver.hpp"
+#include "solver/solver_stats.hpp"
+#include "solver/work_pool.hpp"
+#include "timing.hpp"
 #if defined(USE_BITWUZLA)
 #include "solver/bitwuzla_impl.hpp"
 #elif defined(USE_ALIVESMT)
@@ -66,7 +81,10 @@ static std::pair<int64_t, int64_t> parseDomain(const std::string &s) {
 static auto makeSolverFactory() {
   return [](const SymbolicExecutor::Config &cfg) -> std::unique_ptr<smt::ISolver> {
 #if defined(USE_BITWUZLA)
-    return std::make_unique<solver::BitwuzlaSolver>(cfg.timeout_ms, cfg.seed, cfg.num_smt_threads);
+    return std::make_unique<solver::BitwuzlaSolver>(solver::BitwuzlaSolver::Options{
+        cfg.timeout_ms, cfg.seed, cfg.num_smt_threads, cfg.bitwuzla_preprocess,
+        cfg.bitwuzla_rewrite_level
+    });
 #elif defined(USE_ALIVESMT)
     return std::make_unique<solver::AliveSolver>(cfg.timeout_ms, cfg.seed, cfg.num_smt_threads);
 #else
@@ -76,6 +94,64 @@ static auto makeSolverFactory() {
   };
 }
 
+// --incremental: answers genFunction's PathOracle from one PathSession on
+// the skeleton program, so that statements or a branch condition that make
+// the path infeasible are generated anew on the spot. An UNKNOWN step, or a
+// session that failed, lets generation go on: the final solve decides.
+class SessionOracle : public PathOracle {
+public:
+  // A step is one small query; a slow one is not worth the wait.
+  static constexpr uint32_t kStepTimeoutMs = 50;
+
+  SessionOracle(uint32_t timeoutMs, uint32_t seed) {
+    cfg_.timeout_ms = std::min(timeoutMs, kStepTimeoutMs);
+    cfg_.seed = seed;
+    cfg_.num_threads = 1;
+    cfg_.num_smt_threads = 1;
+    cfg_.points_to = false;
+  }
+
+  void start(const Program &prog, const std::string &funcName) override {
+    guard([&] {
+      executor_.emplace(prog, cfg_, makeSolverFactory());
+      session_.emplace(*executor_, funcName);
+      return smt::Result::SAT;
+    });
+  }
+
+  bool run(const Block &block, std::size_t firstInstr) override {
+    return guard([&] { return session_->run(block, firstInstr); });
+  }
+
+  bool take(const Block &block, std::size_t firstInstr, const std::string *next) override {
+    return guard([&] { return session_->take(block, firstInstr, next); });
+  }
+
+  uint64_t checks() const { return session_ ? session_->checks() : 0; }
+
+private:
+  // Once a step comes back UNKNOWN, the longer prefixes after it are no
+  // easier: the session stops there, as it does when it fails.
+  template<typename F>
+  bool guard(F &&f) {
+    if (stopped_)
+      return true;
+    try {
+      smt::Result r = f();
+      stopped_ = r == smt::Result::UNKNOWN;
+      return r != smt::Result::UNSAT;
+    } catch (const std::exception &) {
+      stopped_ = true;
+      return true;
+    }
+  }
+
+  SymbolicExecutor::Config cfg_;
+  std::optional<SymbolicExecutor> executor_;
+  std::optional<SymbolicExecutor::PathSession> session_;
+  bool stopped_ = false;
+};
+
 static bool validateWithSymiri(
     const fs::path &symiriPath, const fs::path &sirPath, const std::string &funcName, bool verbose
 ) {
@@ -111,8 +187,27 @@ static std::string pickVecLowering(std::mt19937 &rng, const std::string &request
   return strategies[d(rng)];
 }
 
+// A file to write, kept in memory until the ordered writer in main() gets
+// to its function.
+struct OutputFile {
+  fs::path path;
+  std::string text;
+  bool concrete; // a concrete .sir, as opposed to a symbolic one
+};
+
+// A concrete program kept in memory by --diff, with what the interpreter
+// made of it, until a native build of its batch is checked against that.
+struct DiffCase {
+  OutputFile sir;                // written only if the two disagree
+  std::unique_ptr<Program> prog; // entry renamed to the stem of `sir`
+  std::string entry;
+  Interpreter::SymBindings model;
+  Interpreter::CallResult expected;
+};
+
 struct GenerateResult {
-  std::vector<fs::path> produced;
+  std::vector<OutputFile> files;
+  std::vector<DiffCase> cases; // --diff: the concrete programs instead
 };
 
 static GenerateResult generateLeaf(
@@ -127,13 +222,18 @@ static GenerateResult generateLeaf(
     int64_t coefLo, int64_t coefHi, int64_t valueLo, int64_t valueHi, int64_t indexLo,
     int64_t indexHi, const ExprGenConfig &exprCfg,
     // Solver params
-    uint32_t timeoutMs,
+    uint32_t timeoutMs, bool incremental, solver::QueryCache *queryCache,
+    solver::SolverStats *stats,
     // Retry params
     int maxRetries, int nInits,
     // IO
-    const fs::path &outDir, bool keepSymbolic, bool verbose,
+    const fs::path &outDir, bool keepSymbolic, bool diff, bool verbose,
     // RNG (by value — safe to run in a detached thread)
-    std::mt19937 rng, uint32_t baseSeed
+    std::mt19937 rng, uint32_t baseSeed,
+    // Runs the inits of an attempt concurrently if set
+    solver::WorkPool *pool,
+    // --adaptive: where the inits take their atom mix from
+    AdaptiveMix *adaptive
 ) {
   // S1: CFG
   GenCFGParams cfgParams;
@@ -141,18 +241,27 @@ static GenerateResult generateLeaf(
   cfgParams.seed = rng();
   cfgParams.pBranch = pBranch;
   cfgParams.pBackedge = pBackedge;
-  auto cfg = genCFG(cfgParams);
+  auto cfg = [&] {
+    timing::Scope timer("gen-cfg");
+    return genCFG(cfgParams);
+  }();
 
   if (verbose)
     std::cout << "[cfg] " << cfg.blocks.size() << " blocks\n";
 
   // Generate VarCatalogue (shared across all inits for the same CFG)
-  VarCatalogue vars = genVarCatalogue(rng, varCfg);
+  VarCatalogue vars = [&] {
+    timing::Scope timer("gen-vars");
+    return genVarCatalogue(rng, varCfg);
+  }();
 
   if (verbose)
     std::cout << "[vars] " << vars.vars.size() << " vars, " << vars.structDecls.size()
               << " structs\n";
 
+  // The attempts sample their paths from the same CFG.
+  PathSampler sampler(cfg);
+  GenerateResult last;
   for (int attempt = 0; attempt <= maxRetries; attempt++) {
     // Path sampling (reduce loop iterations on retry)
     SamplePathParams pathParams;
@@ -161,7 +270,10 @@ static GenerateResult generateLeaf(
     pathParams.maxLoopIter = std::max(minLoopIter, maxLoopIter - attempt);
     pathParams.minLoopIter = minLoopIter;
 
-    auto maybePath = samplePath(cfg, pathParams);
+    auto maybePath = [&] {
+      timing::Scope timer("sample-path");
+      return sampler.sample(pathParams);
+    }();
     if (!maybePath) {
       if (verbose)
         std::cerr << "[sampler] attempt=" << attempt
@@ -174,12 +286,33 @@ static GenerateResult generateLeaf(
     if (verbose)
       std::cout << "[sampler] attempt=" << attempt << " EP len=" << path.size() << "\n";
 
-    // Generate nInits independently-seeded programs
-    std::vector<fs::path> produced;
-    for (int initIdx = 0; initIdx < nInits; initIdx++) {
+    auto pathHeader = [&] {
+      std::string header = "// path:";
+      for (std::size_t k = 0; k < path.size(); k++)
+        header += (k == 0 ? " " : " -> ") + path[k];
+      return header + "\n\n";
+    }();
+
+    // Generate nInits independently-seeded programs. The seeds are drawn
+    // up front, so that the inits may run in any order.
+    std::vector<uint32_t> initSeeds(nInits);
+    for (auto &seed: initSeeds)
+      seed = rng();
+    std::vector<std::vector<OutputFile>> initFiles(nInits);
+    std::vector<std::optional<DiffCase>> initCases(nInits);
+    // The inits share their blocks and edges, and so the analyses of their
+    // CFG: the first to be checked builds them for all. Their statements,
+    // and so their solving, have nothing in common.
+    std::once_flag shapeOnce;
+    std::optional<AnalysisManager::Shape> shape;
+
+    // Generates, checks and solves an init; true if it is a concrete
+    // program. `atoms` receives the on-path int atoms of its function.
+    auto tryInit = [&](int initIdx, std::array<int, hp::kNumIntAtoms> &atoms) -> bool {
+      std::vector<OutputFile> &files = initFiles[initIdx];
       FuncGenConfig fcfg;
       fcfg.funcName = funcName;
-      fcfg.seed = rng();
+      fcfg.seed = initSeeds[initIdx];
       fcfg.nStmts = nStmts;
       fcfg.safeOffPath = safeOffPath;
       fcfg.enableInterestCoefs = enableInterestCoefs;
@@ -191,25 +324,41 @@ static GenerateResult generateLeaf(
       fcfg.valueHi = valueHi;
       fcfg.indexLo = indexLo;
       fcfg.indexHi = indexHi;
+      std::optional<SessionOracle> oracle;
+      if (incremental) {
+        oracle.emplace(timeoutMs, baseSeed + (uint32_t) (attempt * 100 + initIdx));
+        fcfg.oracle = &*oracle;
+      }
 
-      auto [prog, pathLabels] = genFunction(cfg, path, vars, fcfg);
-
-      auto writePathHeader = [&](std::ostream &os) {
-        os << "// path:";
-        for (std::size_t k = 0; k < path.size(); k++)
-          os << (k == 0 ? " " : " -> ") << path[k];
-        os << "\n\n";
-      };
+      auto [prog, pathLabels, refuted, intAtoms] = [&] {
+        timing::Scope timer("gen-function");
+        return genFunction(cfg, path, vars, fcfg);
+      }();
+      atoms = intAtoms;
+      if (oracle) {
+        if (verbose)
+          std::cout << "[incremental] init " << initIdx << ": " << oracle->checks()
+                    << " checks" << (refuted ? ", path refuted" : "") << "\n";
+        oracle.reset();
+      }
 
       // Optionally dump symbolic program
       if (keepSymbolic) {
-        auto symPath = outDir / (funcName + "_sym" + std::to_string(initIdx) + ".sir");
-        std::ofstream ofs(symPath);
-        writePathHeader(ofs);
-        SIRPrinter printer(ofs);
+        timing::Scope timer("print");
+        std::ostringstream os;
+        os << pathHeader;
+        SIRPrinter printer(os);
         printer.print(prog);
-        if (verbose)
-          std::cout << "  symbolic: " << symPath << "\n";
+        files.push_back(
+            {outDir / (funcName + "_sym" + std::to_string(initIdx) + ".sir"), os.str(), false}
+        );
+      }
+
+      // The oracle proved the path infeasible: the solver would only agree.
+      timing::count("inits");
+      if (refuted) {
+        timing::count("inits-refuted");
+        return false;
       }
 
       // Validate AST
@@ -217,14 +366,24 @@ static GenerateResult generateLeaf(
       PassManager pm(diags);
       pm.addModulePass(std::make_unique<SemChecker>());
       pm.addModulePass(std::make_unique<TypeChecker>());
-      if (pm.run(prog) == PassResult::Error) {
+      const FunDecl &fun = prog.funs.front();
+      std::call_once(shapeOnce, [&] { shape = AnalysisManager().shape(fun); });
+      if (shape)
+        pm.analyses().adoptShape(fun, *shape);
+      PassResult checked;
+      {
+        timing::Scope timer("typecheck");
+        checked = pm.run(prog);
+      }
+      if (checked == PassResult::Error) {
+        timing::count("inits-invalid");
         if (verbose) {
           std::cerr << "[validate] init " << initIdx << ": generated program failed validation\n";
           for (const auto &d: diags.diags)
             if (d.level == DiagLevel::Error)
               std::cerr << "  error: " << d.message << "\n";
         }
-        continue;
+        return false;
       }
 
       // Solve
@@ -233,54 +392,418 @@ static GenerateResult generateLeaf(
       solverCfg.seed = baseSeed + (uint32_t) (attempt * 100 + initIdx);
       solverCfg.num_threads = 1;
       solverCfg.num_smt_threads = 1;
+      solverCfg.query_cache = queryCache;
+      solverCfg.stats = stats;
+      solverCfg.stats_label =
+          funcName + " attempt " + std::to_string(attempt) + " init " + std::to_string(initIdx);
+      solverCfg.analyses = &pm.analyses();
 
       SymbolicExecutor executor(prog, solverCfg, makeSolverFactory());
       SymbolicExecutor::Result res;
       try {
         res = executor.solve("@" + funcName, pathLabels);
       } catch (const std::exception &e) {
+        timing::count("inits-error");
         if (verbose)
           std::cerr << "[solver] init " << initIdx << ": exception: " << e.what() << "\n";
-        res.unknown = true;
-        continue;
+        return false;
       } catch (...) {
+        timing::count("inits-error");
         if (verbose)
           std::cerr << "[solver] init " << initIdx << ": unknown exception\n";
-        res.unknown = true;
-        continue;
+        return false;
       }
 
+      timing::count(res.sat ? "inits-sat" : res.unsat ? "inits-unsat" : "inits-unknown");
       if (res.sat) {
-        std::string outName =
-            nInits > 1 ? funcName + "_" + std::to_string(initIdx) + ".sir" : funcName + ".sir";
-        auto concretePath = outDir / outName;
+        std::string stem = nInits > 1 ? funcName + "_" + std::to_string(initIdx) : funcName;
+        OutputFile concrete{outDir / (stem + ".sir"), pathHeader, true};
         {
-          std::ofstream ofs(concretePath);
-          if (!ofs) {
-            std::cerr << "error: cannot open " << concretePath << "\n";
-            continue;
-          }
-          writePathHeader(ofs);
-          SIRPrinter printer(ofs, res.model);
+          timing::Scope timer("print");
+          std::ostringstream os;
+          SIRPrinter printer(os, res.model);
           printer.print(prog);
+          concrete.text += os.str();
         }
-        produced.push_back(concretePath);
-        if (verbose)
-          std::cout << "[emit] init " << initIdx << ": " << concretePath << "\n";
+        if (!diff) {
+          files.push_back(std::move(concrete));
+          return true;
+        }
+        // The interpreter runs the symbolic program on the model, as it
+        // would run the concrete one.
+        DiffCase dc{std::move(concrete), std::make_unique<Program>(std::move(prog)), "@" + stem,
+                    res.model, {}};
+        {
+          timing::Scope timer("interpret");
+          Interpreter interp(*dc.prog);
+          dc.expected = interp.call(interp.prepare("@" + funcName), {}, dc.model);
+        }
+        // All the programs of a native batch share one object.
+        for (auto &f: dc.prog->funs)
+          if (f.name.name == "@" + funcName)
+            f.name.name = dc.entry;
+        initCases[initIdx] = std::move(dc);
+        return true;
       } else if (verbose) {
         std::cerr << "[solver] init " << initIdx << ": " << (res.unsat ? "UNSAT" : "UNKNOWN")
                   << "\n";
       }
+      return false;
+    };
+
+    // Each init draws its atom mix from --adaptive, and reports back to it.
+    auto generateInit = [&](int initIdx) {
+      hp::Params mix = adaptive ? adaptive->next() : hp::params();
+      hp::Scope mixScope(mix);
+      std::array<int, hp::kNumIntAtoms> atoms{};
+      auto start = std::chrono::steady_clock::now();
+      bool valid = tryInit(initIdx, atoms);
+      if (adaptive)
+        adaptive->record(
+            atoms,
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), valid
+        );
+    };
+
+    if (pool) {
+      std::string timingPath = timing::currentPath();
+      pool->forEach(nInits, [&](unsigned, std::size_t initIdx) {
+        timing::Inherit inherit(timingPath);
+        generateInit((int) initIdx);
+      });
+    } else {
+      for (int initIdx = 0; initIdx < nInits; initIdx++)
+        generateInit(initIdx);
     }
 
-    if (!produced.empty())
-      return GenerateResult{std::move(produced)};
+    // The symbolic files of a failed attempt are kept until the next one.
+    last.files.clear();
+    bool anyConcrete = false;
+    for (auto &files: initFiles)
+      for (auto &file: files) {
+        anyConcrete |= file.concrete;
+        last.files.push_back(std::move(file));
+      }
+    for (auto &dc: initCases)
+      if (dc) {
+        anyConcrete = true;
+        last.cases.push_back(std::move(*dc));
+      }
+    if (anyConcrete)
+      return last;
 
     if (verbose)
       std::cerr << "[solver] attempt=" << attempt << ": all inits failed, retrying\n";
   }
 
-  return GenerateResult{};
+  return last;
+}
+
+// --mutate: derives function `funcName` from a random program of the corpus
+// by one or two mutations, and re-solves it. Each try starts over from a
+// fresh copy of a corpus program; the first that is sat is kept.
+static GenerateResult mutateLeaf(
+    const std::vector<CorpusEntry> &corpus, const MutateConfig &mcfg, const std::string &funcName,
+    // Solver params
+    uint32_t timeoutMs, solver::QueryCache *queryCache, solver::SolverStats *stats,
+    // Tries
+    int nTries,
+    // IO
+    const fs::path &outDir, bool keepSymbolic, bool diff, bool verbose,
+    // RNG (by value — safe to run in a detached thread)
+    std::mt19937 rng, uint32_t baseSeed
+) {
+  GenerateResult last;
+  for (int tryIdx = 0; tryIdx < nTries; tryIdx++) {
+    std::uniform_int_distribution<std::size_t> pickSeed(0, corpus.size() - 1);
+    const CorpusEntry &seed = corpus[pickSeed(rng)];
+    Program prog = seed.prog;
+    std::vector<std::string> pathLabels = seed.path;
+    std::string what;
+    {
+      timing::Scope timer("mutate");
+      std::uniform_int_distribution<int> nMutations(1, 2);
+      for (int m = nMutations(rng); m > 0; m--) {
+        std::string did = mutate(rng, prog, pathLabels, mcfg);
+        if (!did.empty())
+          what += (what.empty() ? "" : ", ") + did;
+      }
+    }
+    if (what.empty())
+      continue;
+    // A mutant counts as an init, for --bench and --time-passes.
+    timing::count("inits");
+    FunDecl &fun = prog.funs.front();
+    fun.name.name = "@" + funcName;
+
+    std::string header = "// mutant of " + seed.name + ": " + what + "\n// path:";
+    for (std::size_t k = 0; k < pathLabels.size(); k++)
+      header += (k == 0 ? " " : " -> ") + pathLabels[k].substr(1);
+    header += "\n\n";
+    if (verbose)
+      std::cout << "[mutate] try " << tryIdx << ": " << seed.name << ": " << what << "\n";
+
+    last.files.clear();
+    if (keepSymbolic) {
+      timing::Scope timer("print");
+      std::ostringstream os;
+      os << header;
+      SIRPrinter printer(os);
+      printer.print(prog);
+      last.files.push_back({outDir / (funcName + "_sym0.sir"), os.str(), false});
+    }
+
+    DiagBag diags;
+    PassManager pm(diags);
+    pm.addModulePass(std::make_unique<SemChecker>());
+    pm.addModulePass(std::make_unique<TypeChecker>());
+    PassResult checked;
+    {
+      timing::Scope timer("typecheck");
+      checked = pm.run(prog);
+    }
+    if (checked == PassResult::Error) {
+      timing::count("inits-invalid");
+      if (verbose)
+        for (const auto &d: diags.diags)
+          if (d.level == DiagLevel::Error)
+            std::cerr << "  error: " << d.message << "\n";
+      continue;
+    }
+
+    SymbolicExecutor::Config solverCfg;
+    solverCfg.timeout_ms = timeoutMs;
+    solverCfg.seed = baseSeed + (uint32_t) tryIdx;
+    solverCfg.num_threads = 1;
+    solverCfg.num_smt_threads = 1;
+    solverCfg.query_cache = queryCache;
+    solverCfg.stats = stats;
+    solverCfg.stats_label = funcName + " mutant " + std::to_string(tryIdx);
+    solverCfg.analyses = &pm.analyses();
+
+    SymbolicExecutor executor(prog, solverCfg, makeSolverFactory());
+    SymbolicExecutor::Result res;
+    try {
+      res = executor.solve("@" + funcName, pathLabels);
+    } catch (const std::exception &e) {
+      timing::count("inits-error");
+      if (verbose)
+        std::cerr << "[solver] mutant " << tryIdx << ": exception: " << e.what() << "\n";
+      continue;
+    }
+    timing::count(res.sat ? "inits-sat" : res.unsat ? "inits-unsat" : "inits-unknown");
+    if (!res.sat) {
+      if (verbose)
+        std::cerr << "[solver] mutant " << tryIdx << ": " << (res.unsat ? "UNSAT" : "UNKNOWN")
+                  << "\n";
+      continue;
+    }
+
+    OutputFile concrete{outDir / (funcName + ".sir"), header, true};
+    {
+      timing::Scope timer("print");
+      std::ostringstream os;
+      SIRPrinter printer(os, res.model);
+      printer.print(prog);
+      concrete.text += os.str();
+    }
+    if (!diff) {
+      last.files.push_back(std::move(concrete));
+      return last;
+    }
+    DiffCase dc{std::move(concrete), std::make_unique<Program>(std::move(prog)), "@" + funcName,
+                res.model, {}};
+    {
+      timing::Scope timer("interpret");
+      Interpreter interp(*dc.prog);
+      dc.expected = interp.call(interp.prepare(dc.entry), {}, dc.model);
+    }
+    last.cases.push_back(std::move(dc));
+    return last;
+  }
+  return last;
+}
+
+// Writes the files of one function, symbolic ones included, and returns the
+// concrete ones written. Only main() calls it, one function at a time and in
+// order, so that the output does not depend on which worker finished first.
+static std::vector<fs::path> writeOutputs(const GenerateResult &res, bool verbose) {
+  std::vector<fs::path> produced;
+  for (const auto &file: res.files) {
+    std::ofstream ofs(file.path);
+    if (!ofs) {
+      std::cerr << "error: cannot open " << file.path << "\n";
+      continue;
+    }
+    ofs << file.text;
+    if (!file.concrete) {
+      if (verbose)
+        std::cout << "  symbolic: " << file.path << "\n";
+      continue;
+    }
+    produced.push_back(file.path);
+    if (verbose)
+      std::cout << "[emit] " << file.path << "\n";
+  }
+  return produced;
+}
+
+struct DiffStats {
+  int passed = 0;
+  int mismatched = 0; // both returned, different values
+  int trapped = 0;    // the native code hit UB or failed a check
+  int unbuilt = 0;    // the native code did not build
+  int uninterpreted = 0; // the interpreter did not return on the model
+  int failures() const { return mismatched + trapped + unbuilt + uninterpreted; }
+};
+
+static std::string describe(const Interpreter::CallResult &r) {
+  using Status = Interpreter::CallResult::Status;
+  if (r.status != Status::Returned)
+    return r.message.empty() ? "no result" : r.message;
+  if (!r.value)
+    return "void";
+  std::ostringstream os;
+  std::visit([&](auto v) { os << v; }, *r.value);
+  return os.str();
+}
+
+static bool sameResult(const Interpreter::CallResult &a, const Interpreter::CallResult &b) {
+  using Status = Interpreter::CallResult::Status;
+  if (a.status != Status::Returned || b.status != Status::Returned)
+    return false;
+  if (!a.value || !b.value)
+    return !a.value && !b.value;
+  if (a.value->index() != b.value->index())
+    return false;
+  if (auto *x = std::get_if<double>(&*a.value)) {
+    double y = std::get<double>(*b.value);
+    return *x == y || (std::isnan(*x) && std::isnan(y));
+  }
+  return *a.value == *b.value;
+}
+
+// --diff: builds `cases` into one shared object under `nativeDir`, runs
+// each on its model and compares with the interpreter, then clears them.
+// Only the .sir of a case that disagrees is written. If the batch does not
+// build, its cases are built one by one to find those that do not.
+static void diffBatch(
+    std::vector<DiffCase> &cases, const fs::path &nativeDir, DiffStats &stats, bool verbose
+) {
+  auto fail = [&](const DiffCase &dc, const char *kind, const std::string &what) {
+    std::cerr << "[" << kind << "] " << dc.sir.path.filename().string() << ": " << what << "\n";
+    std::ofstream ofs(dc.sir.path);
+    ofs << dc.sir.text;
+    if (!ofs)
+      std::cerr << "error: cannot open " << dc.sir.path << "\n";
+    else
+      std::cerr << "  written: " << dc.sir.path << "\n";
+  };
+
+  std::vector<DiffCase *> run;
+  for (auto &dc: cases) {
+    if (dc.expected.status == Interpreter::CallResult::Status::Returned)
+      run.push_back(&dc);
+    else {
+      stats.uninterpreted++;
+      fail(dc, "INTERP FAIL", describe(dc.expected));
+    }
+  }
+
+  std::vector<NativeFunction::Entry> entries;
+  for (auto *dc: run)
+    entries.push_back({dc->prog.get(), dc->entry});
+  std::vector<std::unique_ptr<NativeFunction>> natives;
+  bool unbuilt = false;
+  {
+    timing::Scope timer("native-build");
+    try {
+      natives = NativeFunction::buildAll(entries, nativeDir.string());
+    } catch (const std::exception &e) {
+      if (verbose)
+        std::cerr << "[diff] batch build failed, building one by one: " << e.what() << "\n";
+      natives.clear();
+      for (auto *dc: run) {
+        try {
+          natives.push_back(std::make_unique<NativeFunction>(*dc->prog, dc->entry, nativeDir));
+        } catch (const std::exception &e) {
+          natives.push_back(nullptr);
+          stats.unbuilt++;
+          unbuilt = true;
+          fail(*dc, "BUILD FAIL", e.what());
+        }
+      }
+    }
+  }
+
+  {
+    timing::Scope timer("native-run");
+    for (std::size_t i = 0; i < run.size(); ++i) {
+      if (!natives[i])
+        continue;
+      const DiffCase &dc = *run[i];
+      auto got = natives[i]->call(dc.model);
+      if (sameResult(dc.expected, got)) {
+        stats.passed++;
+        continue;
+      }
+      bool returned = got.status == Interpreter::CallResult::Status::Returned;
+      (returned ? stats.mismatched : stats.trapped)++;
+      fail(
+          dc, returned ? "MISMATCH" : "TRAP",
+          "interp=" + describe(dc.expected) + " native=" + describe(got)
+      );
+    }
+  }
+  natives.clear();
+  cases.clear();
+  // The objects of a batch are of no further use, unlike the sources and
+  // logs of one that did not build.
+  if (!unbuilt)
+    fs::remove_all(nativeDir);
+}
+
+// --bench: the JSON summary of a run. Phase times are summed over
+// threads, like those of --time-passes; an init is one generated program,
+// which ends as one of the outcomes counted.
+static void writeBenchJson(
+    std::ostream &os, double elapsed, uint32_t seed, unsigned jobs, int nOk, int nFail,
+    int nTimedOut, int nPrograms
+) {
+  auto totals = timing::totals();
+  auto counters = timing::counters();
+  auto perSec = [&](double n) { return elapsed > 0 ? n / elapsed : 0.0; };
+
+  os << "{\n  \"seconds\": " << elapsed << ",\n  \"seed\": " << seed << ",\n  \"jobs\": " << jobs
+     << ",\n  \"functions\": {\"generated\": " << nOk << ", \"failed\": " << nFail
+     << ", \"timed_out\": " << nTimedOut << "},\n  \"programs\": " << nPrograms
+     << ",\n  \"programs_per_sec\": " << perSec(nPrograms)
+     << ",\n  \"functions_per_sec\": " << perSec(nOk) << ",\n";
+
+  static const std::pair<const char *, const char *> outcomes[] = {
+      {"sat", "inits-sat"},         {"unsat", "inits-unsat"},     {"unknown", "inits-unknown"},
+      {"invalid", "inits-invalid"}, {"refuted", "inits-refuted"}, {"error", "inits-error"},
+  };
+  uint64_t inits = counters["inits"];
+  os << "  \"inits\": " << inits << ",\n  \"rates\": {";
+  for (std::size_t k = 0; k < std::size(outcomes); k++)
+    os << (k ? ", " : "") << json::quote(outcomes[k].first) << ": "
+       << (inits ? (double) counters[outcomes[k].second] / (double) inits : 0.0);
+  os << "},\n";
+
+  // Phases by the name of their timing::Scope, wherever it nests.
+  static const char *phases[] = {"gen-cfg", "gen-vars",  "sample-path", "gen-function",
+                                 "mutate",  "typecheck", "solve",       "print"};
+  os << "  \"phases_ms\": {";
+  for (std::size_t k = 0; k < std::size(phases); k++) {
+    std::string name = phases[k];
+    uint64_t ns = 0;
+    for (const auto &[path, t]: totals)
+      if (path == name || path.ends_with("/" + name))
+        ns += t.ns;
+    os << (k ? ", " : "") << json::quote(name) << ": " << (double) ns / 1e6;
+  }
+  os << "},\n  \"peak_rss_kib\": " << timing::peakRssKiB() << "\n}\n";
 }
 
 int main(int argc, char **argv) {
@@ -290,6 +813,8 @@ int main(int argc, char **argv) {
   opts.add_options()
     ("n,n-funcs",         "Number of leaf functions to generate",
                           cxxopts::value<int>()->default_value("1"))
+    ("j,num-threads",     "Number of threads generating functions, and the inits of each, concurrently (0 = hardware concurrency)",
+                          cxxopts::value<uint32_t>()->default_value("1"))
     // Type control
     ("no-fp",             "Disable f32/f64 types entirely")
     ("no-vec",            "Disable <N> T vector type generation")
@@ -323,6 +848,11 @@ int main(int argc, char **argv) {
                           cxxopts::value<uint32_t>()->default_value("2000"))
     ("seed",              "Master RNG seed (default: random)",
                           cxxopts::value<uint32_t>())
+    ("incremental",       "Check the path's feasibility while generating it, and regenerate what refutes it")
+    ("query-cache",       "Directory of a persistent cache of solver answers",
+                          cxxopts::value<std::string>())
+    ("stats",             "Write per-query solver statistics as JSON to this file",
+                          cxxopts::value<std::string>())
     // Domains
     ("coef-domain",       "Domain for coef symbols",
                           cxxopts::value<std::string>()->default_value("[-2147483647, 2147483647]"))
@@ -342,12 +872,29 @@ int main(int argc, char **argv) {
     // Output
     ("o,output-dir",      "Output directory",
                           cxxopts::value<std::string>()->default_value("reify_out"))
-    ("target",            "Compile concrete .sir to target (sir, c, wasm); sir = no compilation",
+    ("target",            "Compile concrete .sir to target (sir, c, wasm, wasm-bin); sir = no compilation",
                           cxxopts::value<std::string>()->default_value("sir"))
     ("keep-require",      "Include require checks in compiled output (default: omitted)")
     ("keep-symbolic",     "Write intermediate symbolic .sir files to disk")
     ("validate",          "Run symiri on each concrete .sir to validate")
+    ("diff",              "Compare the interpreter with native C on each model in-process; write only the .sir that disagree")
+    ("diff-batch",        "Concrete programs compiled into one shared object with --diff",
+                          cxxopts::value<int>()->default_value("32"))
+    ("bench",             "Generate for this many seconds, writing nothing, and print throughput as JSON",
+                          cxxopts::value<double>())
+    ("mutate",            "Derive each function from a program of this directory of rysmith output by AST mutations, and re-solve it",
+                          cxxopts::value<std::string>())
+    // Hyperparameters
+    ("hyperparams",       "Load the generator's slot tables and probabilities from this file",
+                          cxxopts::value<std::string>())
+    ("adaptive",          "Reweight the on-path int atom kinds towards those yielding valid programs fastest; =C keeps each kind at least C (0..1] of its share",
+                          cxxopts::value<double>()->implicit_value("0.25"))
+    ("hyperparams-out",   "Write the hyperparameters in effect at the end of the run to this file",
+                          cxxopts::value<std::string>())
     ("v,verbose",         "Verbose output")
+    ("time-passes",       "Print the time of each phase, and the peak RSS, to stderr")
+    ("time-trace",        "Write the phase timings as Chrome trace-event JSON to this file",
+                          cxxopts::value<std::string>())
     ("h,help",            "Print usage");
   // clang-format on
 
@@ -364,6 +911,11 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  timing::Session timingSession(
+      result.count("time-passes") > 0,
+      result.count("time-trace") ? result["time-trace"].as<std::string>() : std::string()
+  );
+
   // ---- Parse domains -------------------------------------------------------
   int64_t coefLo, coefHi, valueLo, valueHi, indexLo, indexHi;
   try {
@@ -384,11 +936,18 @@ int main(int argc, char **argv) {
   // ---- Setup ---------------------------------------------------------------
   uint32_t masterSeed =
       result.count("seed") ? result["seed"].as<uint32_t>() : (uint32_t) std::random_device{}();
-  std::cout << "rysmith: master seed = " << masterSeed << "\n";
+  // --bench: generate until this many seconds have passed, write nothing
+  // and print nothing but a JSON summary.
+  std::optional<double> benchSeconds;
+  if (result.count("bench"))
+    benchSeconds = result["bench"].as<double>();
+  if (!benchSeconds)
+    std::cout << "rysmith: master seed = " << masterSeed << "\n";
   std::mt19937 rng(masterSeed);
 
   fs::path outDir = result["output-dir"].as<std::string>();
-  fs::create_directories(outDir);
+  if (!benchSeconds)
+    fs::create_directories(outDir);
 
   // Type config
   TypeGenConfig typeCfg;
@@ -423,21 +982,109 @@ int main(int argc, char **argv) {
   bool safeOffPath = result.count("safe-off-path") > 0;
   bool enableInterestCoefs = true; // kept in code; not user-exposed
   uint32_t timeoutMs = result["timeout"].as<uint32_t>();
+  unsigned jobs = result["num-threads"].as<uint32_t>();
+  if (jobs == 0)
+    jobs = std::max(1u, std::thread::hardware_concurrency());
   // Wall-clock budget per function: covers all retries × inits plus 50 ms for non-solver overhead
   // (CFG gen, path sampling, formula construction, SIRPrinter). Compilation runs outside the
-  // thread.
-  uint32_t funcTimeoutMs = (uint32_t) ((uint64_t) (maxRetries + 1) * nInits * timeoutMs + 50);
+  // thread. With -j, the inits of an attempt may first wait for those of the other running
+  // functions, at most as many rounds of the pool as there are inits.
+  uint32_t funcTimeoutMs =
+      (uint32_t) ((uint64_t) (maxRetries + 1) * nInits * timeoutMs * (jobs > 1 ? 2 : 1) + 50);
   bool keepSymbolic = result.count("keep-symbolic") > 0;
   bool doValidate = result.count("validate") > 0;
   bool verbose = result.count("verbose") > 0;
   std::string target = result["target"].as<std::string>();
   bool noRequire = !result.count("keep-require");
   std::string vecLoweringOpt = result["vec-lowering"].as<std::string>();
+  bool diff = result.count("diff") > 0;
+  bool incremental = result.count("incremental") > 0;
+  // The generators read the loaded values before any thread starts.
+  if (result.count("hyperparams")) {
+    try {
+      hp::configure(hp::loadParams(result["hyperparams"].as<std::string>()));
+    } catch (const std::exception &e) {
+      std::cerr << "error: " << e.what() << "\n";
+      return 1;
+    }
+  }
+  std::unique_ptr<AdaptiveMix> adaptive;
+  if (result.count("adaptive")) {
+    double coverage = result["adaptive"].as<double>();
+    if (!(coverage > 0 && coverage <= 1)) {
+      std::cerr << "error: --adaptive coverage must be in (0, 1]\n";
+      return 1;
+    }
+    adaptive = std::make_unique<AdaptiveMix>(hp::params(), coverage);
+  }
+  int diffBatchSize = std::max(1, result["diff-batch"].as<int>());
+  // --mutate: the corpus is parsed once, before any thread starts.
+  std::vector<CorpusEntry> corpus;
+  MutateConfig mutateCfg;
+  mutateCfg.nStmts = nStmts;
+  mutateCfg.enableInterestCoefs = enableInterestCoefs;
+  mutateCfg.exprCfg = exprCfg;
+  mutateCfg.coefLo = coefLo;
+  mutateCfg.coefHi = coefHi;
+  mutateCfg.valueLo = valueLo;
+  mutateCfg.valueHi = valueHi;
+  mutateCfg.indexLo = indexLo;
+  mutateCfg.indexHi = indexHi;
+  if (result.count("mutate")) {
+    if (incremental || adaptive) {
+      std::cerr << "error: --mutate takes neither --incremental nor --adaptive\n";
+      return 1;
+    }
+    std::string corpusDir = result["mutate"].as<std::string>();
+    std::vector<std::string> skipped;
+    try {
+      timing::Scope timer("load-corpus");
+      corpus = loadCorpus(corpusDir, skipped);
+    } catch (const std::exception &e) {
+      std::cerr << "error: " << e.what() << "\n";
+      return 1;
+    }
+    // Programs that do not check (symbolic inits the checker rejected) would
+    // only yield mutants that do not either.
+    std::erase_if(corpus, [&](const CorpusEntry &entry) {
+      Program copy = entry.prog;
+      DiagBag diags;
+      PassManager pm(diags);
+      pm.addModulePass(std::make_unique<SemChecker>());
+      pm.addModulePass(std::make_unique<TypeChecker>());
+      timing::Scope timer("typecheck");
+      if (pm.run(copy) != PassResult::Error)
+        return false;
+      skipped.push_back(entry.name);
+      return true;
+    });
+    if (verbose)
+      for (const auto &name: skipped)
+        std::cerr << "[mutate] skipped " << name << ": no path header, or does not check\n";
+    if (corpus.empty()) {
+      std::cerr << "error: no valid program with a path header in " << corpusDir << "\n";
+      return 1;
+    }
+  }
 
-  if (target != "sir" && target != "c" && target != "wasm") {
-    std::cerr << "error: unknown target '" << target << "' (expected sir, c, wasm)\n";
+  if (target != "sir" && target != "c" && target != "wasm" && target != "wasm-bin") {
+    std::cerr << "error: unknown target '" << target << "' (expected sir, c, wasm, wasm-bin)\n";
+    return 1;
+  }
+  if (diff && (target != "sir" || doValidate)) {
+    std::cerr << "error: --diff takes neither --target nor --validate\n";
+    return 1;
+  }
+  if (benchSeconds && (diff || target != "sir" || doValidate)) {
+    std::cerr << "error: --bench takes none of --diff, --target and --validate\n";
     return 1;
   }
+  if (benchSeconds) {
+    // The phase times and init outcomes come from the timing registry.
+    if (!timing::enabled())
+      timing::enable();
+    nFuncs = std::numeric_limits<int>::max();
+  }
 
   // Find symiri for validation (sibling of this binary)
   fs::path symiriPath;
@@ -459,73 +1106,211 @@ int main(int argc, char **argv) {
     }
   }
 
+  std::unique_ptr<solver::QueryCache> queryCache;
+  if (result.count("query-cache")) {
+    try {
+      queryCache = std::make_unique<solver::QueryCache>(result["query-cache"].as<std::string>());
+    } catch (const std::exception &e) {
+      std::cerr << "error: " << e.what() << "\n";
+      return 1;
+    }
+  }
+  std::unique_ptr<solver::SolverStats> stats;
+  if (result.count("stats"))
+    stats = std::make_unique<solver::SolverStats>();
+
   // ---- Main loop -----------------------------------------------------------
+  // Up to `jobs` functions run at a time, each on a thread of its own, and
+  // the inits of an attempt on a pool shared by all of them. The seeds of
+  // all functions are drawn before any starts and functions are reported,
+  // written and compiled strictly in order, so the output of a --seed does
+  // not depend on -j.
   auto wallStart = std::chrono::steady_clock::now();
   int nOk = 0, nFail = 0;
+  int nTimedOut = 0, nPrograms = 0; // --bench
 
-  for (int i = 0; i < nFuncs; i++) {
-    std::string funcName = "func" + std::to_string(i);
-    uint32_t funcSeed = rng();
-    std::cout << "[" << (i + 1) << "/" << nFuncs << "] generating " << funcName
-              << " (seed=" << funcSeed << ")\n";
-
-    // Heap-allocated state lets us safely detach the thread on timeout without
-    // dangling references. Leaked on timeout — bounded by nFuncs, cleaned at exit.
-    struct FuncState {
-      std::mt19937 rng;
-      GenerateResult result;
-      std::atomic<bool> done{false};
-    };
+  // With --bench, seeds are drawn as functions are launched, in the same
+  // order.
+  std::vector<uint32_t> funcSeeds(benchSeconds ? 0 : nFuncs);
+  for (auto &seed: funcSeeds)
+    seed = rng();
 
-    auto *state = new FuncState{std::mt19937(funcSeed), {}, false};
+  std::unique_ptr<solver::WorkPool> pool;
+  if (jobs > 1)
+    pool = std::make_unique<solver::WorkPool>(jobs);
 
-    std::thread t([&, state]() {
-      state->result = generateLeaf(
-          nBbls, pBranch, pBackedge, maxLoopIter, minLoopIter, varCfg, funcName, nStmts,
-          safeOffPath, enableInterestCoefs, coefLo, coefHi, valueLo, valueHi, indexLo, indexHi,
-          exprCfg, timeoutMs, maxRetries, nInits, outDir, keepSymbolic, verbose, state->rng,
-          funcSeed
-      );
-      state->done.store(true, std::memory_order_release);
+  // Heap-allocated state lets us safely detach a thread on timeout without
+  // dangling references. Leaked on timeout — bounded by nFuncs, cleaned at exit.
+  struct FuncState {
+    std::mt19937 rng;
+    GenerateResult result;
+    std::atomic<bool> done{false};
+  };
+  struct Signal {
+    std::mutex mu;
+    std::condition_variable cv;
+  };
+  struct Running {
+    int index;
+    FuncState *state;
+    std::thread thread;
+    std::chrono::steady_clock::time_point deadline;
+  };
+  struct Outcome {
+    bool timedOut;
+    GenerateResult result;
+  };
+  auto signal = std::make_shared<Signal>();
+  std::vector<Running> running;
+  std::vector<std::optional<Outcome>> finished(funcSeeds.size());
+  bool anyTimedOut = false;
+  int nextFunc = 0;
+  // --diff: the concrete programs not yet run natively
+  std::vector<DiffCase> pending;
+  DiffStats diffStats;
+  fs::path nativeDir = outDir / "native";
+
+  auto launch = [&](int i) {
+    if ((std::size_t) i == funcSeeds.size()) {
+      funcSeeds.push_back(rng());
+      finished.emplace_back();
+    }
+    auto *state = new FuncState{std::mt19937(funcSeeds[i]), {}, false};
+    std::thread t([&, state, signal, i, funcSeed = funcSeeds[i]]() {
+      if (!corpus.empty())
+        state->result = mutateLeaf(
+            corpus, mutateCfg, "func" + std::to_string(i), timeoutMs, queryCache.get(),
+            stats.get(), (maxRetries + 1) * nInits, outDir, keepSymbolic, diff, verbose,
+            state->rng, funcSeed
+        );
+      else
+        state->result = generateLeaf(
+            nBbls, pBranch, pBackedge, maxLoopIter, minLoopIter, varCfg,
+            "func" + std::to_string(i), nStmts, safeOffPath, enableInterestCoefs, coefLo, coefHi,
+            valueLo, valueHi, indexLo, indexHi, exprCfg, timeoutMs, incremental,
+            queryCache.get(), stats.get(), maxRetries, nInits, outDir, keepSymbolic, diff,
+            verbose, state->rng, funcSeed, pool.get(), adaptive.get()
+        );
+      {
+        std::lock_guard<std::mutex> lock(signal->mu);
+        state->done.store(true, std::memory_order_release);
+      }
+      signal->cv.notify_all();
     });
+    running.push_back(
+        {i, state, std::move(t),
+         std::chrono::steady_clock::now() + std::chrono::milliseconds(funcTimeoutMs)}
+    );
+  };
 
-    bool timedOut = false;
-    if (funcTimeoutMs > 0) {
-      auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(funcTimeoutMs);
-      while (!state->done.load(std::memory_order_acquire)) {
-        if (std::chrono::steady_clock::now() >= deadline) {
-          timedOut = true;
-          break;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // Waits until a running function is done or overdue, and retires those
+  // that are.
+  auto retire = [&] {
+    {
+      auto deadline = running.front().deadline;
+      for (const auto &r: running)
+        deadline = std::min(deadline, r.deadline);
+      std::unique_lock<std::mutex> lock(signal->mu);
+      signal->cv.wait_until(lock, deadline, [&] {
+        return std::any_of(running.begin(), running.end(), [](const Running &r) {
+          return r.state->done.load(std::memory_order_acquire);
+        });
+      });
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = running.begin(); it != running.end();) {
+      if (it->state->done.load(std::memory_order_acquire)) {
+        it->thread.join();
+        finished[it->index] = Outcome{false, std::move(it->state->result)};
+        delete it->state;
+      } else if (now >= it->deadline) {
+        it->thread.detach(); // state leaked; thread completes or dies with the process
+        finished[it->index] = Outcome{true, {}};
+        anyTimedOut = true;
+      } else {
+        ++it;
+        continue;
       }
+      it = running.erase(it);
     }
+  };
 
-    if (timedOut) {
-      t.detach(); // state leaked; thread completes or dies with the process
+  // With --bench, no function is launched once its time is up.
+  auto benchEnd = wallStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(benchSeconds.value_or(0))
+                              );
+  auto canLaunch = [&] {
+    return nextFunc < nFuncs && !(benchSeconds && std::chrono::steady_clock::now() >= benchEnd);
+  };
+
+  for (int i = 0; i < nFuncs; i++) {
+    if (i == nextFunc) {
+      if (!canLaunch())
+        break;
+      launch(nextFunc++);
+    }
+    std::string funcName = "func" + std::to_string(i);
+    if (!benchSeconds)
+      std::cout << "[" << (i + 1) << "/" << nFuncs << "] generating " << funcName
+                << " (seed=" << funcSeeds[i] << ")\n";
+
+    while (!finished[i]) {
+      while (canLaunch() && running.size() < jobs)
+        launch(nextFunc++);
+      retire();
+    }
+    uint32_t funcSeed = funcSeeds[i];
+    Outcome outcome = std::move(*finished[i]);
+    finished[i].reset();
+
+    if (outcome.timedOut) {
       std::cerr << "[TIMEOUT] " << funcName << " exceeded " << funcTimeoutMs << "ms wall clock\n";
       nFail++;
+      nTimedOut++;
+      continue;
+    }
+    if (benchSeconds) {
+      int concrete = (int) std::count_if(
+          outcome.result.files.begin(), outcome.result.files.end(),
+          [](const OutputFile &f) { return f.concrete; }
+      );
+      nPrograms += concrete;
+      (concrete ? nOk : nFail)++;
       continue;
     }
-    t.join();
-    GenerateResult genRes = std::move(state->result);
-    delete state;
+    std::vector<fs::path> produced = writeOutputs(outcome.result, verbose);
 
-    if (genRes.produced.empty()) {
+    if (diff) {
+      if (outcome.result.cases.empty()) {
+        std::cerr << "[FAIL] all attempts failed for " << funcName << " (seed=" << funcSeed
+                  << ")\n";
+        nFail++;
+        continue;
+      }
+      nOk++;
+      for (auto &dc: outcome.result.cases)
+        pending.push_back(std::move(dc));
+      if ((int) pending.size() >= diffBatchSize)
+        diffBatch(pending, nativeDir, diffStats, verbose);
+      continue;
+    }
+
+    if (produced.empty()) {
       std::cerr << "[FAIL] all attempts failed for " << funcName << " (seed=" << funcSeed << ")\n";
       nFail++;
       continue;
     }
 
-    for (const auto &p: genRes.produced) {
+    for (const auto &p: produced) {
       std::cout << "  concrete: " << p << "\n";
 
       if (target != "sir") {
-        std::string ext = (target == "c") ? ".c" : ".wat";
+        std::string ext = target == "c" ? ".c" : (target == "wasm" ? ".wat" : ".wasm");
         fs::path outPath = p.parent_path() / (p.stem().string() + ext);
         std::string vecLowering = pickVecLowering(rng, vecLoweringOpt);
         if (verbose && !vecLowering.empty())
           std::cout << "  vec-lowering: " << vecLowering << "\n";
+        timing::Scope timer("compile");
         bool ok =
             compileWithSymirc(symircPath, p, target, outPath, noRequire, vecLowering, verbose);
         if (ok)
@@ -537,7 +1322,7 @@ int main(int argc, char **argv) {
 
     if (doValidate) {
       bool allOk = true;
-      for (const auto &p: genRes.produced) {
+      for (const auto &p: produced) {
         // Strip "_N" suffix from stem to get base function name
         std::string stem = p.stem().string();
         std::string baseFuncName = stem;
@@ -551,7 +1336,10 @@ int main(int argc, char **argv) {
           if (isNum)
             baseFuncName = stem.substr(0, pos);
         }
-        bool ok = validateWithSymiri(symiriPath, p, baseFuncName, verbose);
+        bool ok = [&] {
+          timing::Scope timer("validate");
+          return validateWithSymiri(symiriPath, p, baseFuncName, verbose);
+        }();
         std::cout << "  validated: " << (ok ? "OK" : "FAIL") << " (" << p.filename() << ")\n";
         if (!ok) {
           allOk = false;
@@ -566,11 +1354,57 @@ int main(int argc, char **argv) {
     }
   }
 
+  if (!pending.empty())
+    diffBatch(pending, nativeDir, diffStats, verbose);
+
+  // A timed-out function may still have inits queued on the pool, which
+  // must not be waited for on the way out.
+  if (anyTimedOut)
+    (void) pool.release();
+
   auto elapsed =
       std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
   double throughput = elapsed > 0 ? nOk / elapsed : 0.0;
-  std::cout << "\nDone: " << nOk << " succeeded, " << nFail << " failed (total " << nFuncs << ")"
-            << "  [" << elapsed << "s, " << throughput << " funcs/s]\n";
+  if (benchSeconds) {
+    writeBenchJson(std::cout, elapsed, masterSeed, jobs, nOk, nFail, nTimedOut, nPrograms);
+  } else {
+    std::cout << "\nDone: " << nOk << " succeeded, " << nFail << " failed (total " << nFuncs
+              << ")  [" << elapsed << "s, " << throughput << " funcs/s]\n";
+    if (diff)
+      std::cout << "Diff: " << diffStats.passed << " passed, " << diffStats.mismatched
+                << " mismatched, " << diffStats.trapped << " trapped, " << diffStats.unbuilt
+                << " failed to build, " << diffStats.uninterpreted << " failed to interpret\n";
+    if (queryCache) {
+      auto qs = queryCache->stats();
+      std::cout << "Query cache: " << qs.hits << " hits, " << qs.misses << " misses, "
+                << qs.stores << " stored\n";
+    }
+  }
+  if (adaptive && !benchSeconds)
+    std::cout << "Adaptive mix (default -> now share of on-path int atoms):\n"
+              << adaptive->report();
+  if (result.count("hyperparams-out")) {
+    std::ofstream hfs(result["hyperparams-out"].as<std::string>());
+    if (!hfs) {
+      std::cerr << "error: cannot open " << result["hyperparams-out"].as<std::string>() << "\n";
+      return 1;
+    }
+    hfs << hp::formatParams(adaptive ? adaptive->next() : hp::params());
+  }
+  if (stats) {
+    std::ofstream sfs(result["stats"].as<std::string>());
+    if (!sfs) {
+      std::cerr << "error: cannot open " << result["stats"].as<std::string>() << "\n";
+      return 1;
+    }
+    stats->writeJson(sfs);
+  }
 
+  // With --diff, a function that cannot be generated is no finding, nor
+  // with --bench, where rates are what counts.
+  if (benchSeconds)
+    return 0;
+  if (diff)
+    return diffStats.failures() == 0 ? 0 : 1;
   return nFail == 0 ? 0 : 1;
 }
@@ -1,6 +1,10 @@
 #include "solver/alive_impl.hpp"
+#include "alivesmt/ctx.h"
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <z3.h>
 
@@ -8,110 +12,256 @@ namespace symir::solver {
 
   // Global mutex to protect Z3 operations.
   // Z3's reference counting and global context are NOT thread-safe,
-  // so we must serialize all AliveSMT operations across threads.
-  static std::mutex z3_global_mutex;
+  // so we must serialize all AliveSMT operations across threads: every
+  // public method that builds, copies or inspects an expr takes it, as
+  // solvers on different threads share the one context. Recursive, as
+  // make_term() builds the sorts of FP conversions with make_fp_sort().
+  static std::recursive_mutex z3_global_mutex;
+
+  // The Z3 context is global to AliveSMT too, so the solvers alive at the
+  // same time share it: the first creates it, the last one destroys it.
+  static std::optional<::alivesmt::smt_initializer> z3_context;
+  static unsigned live_solvers = 0;
+  // Z3's global sat.threads as last set: setting it is not cheap, and it
+  // only changes when solvers ask for different thread counts.
+  static uint32_t sat_threads = 1;
+
+  // The solver whose check runs on the context, if any. Z3_interrupt stops
+  // whatever check runs on it, so interrupt() only calls it for its own.
+  static std::mutex checking_mutex;
+  static const AliveSolver *checking = nullptr;
+
+  namespace {
+    struct CheckingScope {
+      explicit CheckingScope(const AliveSolver *s) {
+        std::lock_guard<std::mutex> lock(checking_mutex);
+        checking = s;
+      }
+      ~CheckingScope() {
+        std::lock_guard<std::mutex> lock(checking_mutex);
+        checking = nullptr;
+      }
+    };
+
+    // Z3's memory watermark, past which it gives up checks as
+    // resource-limited, counts everything the shared context holds. A check
+    // with a budget raises it to what Z3 holds when the check starts plus
+    // the budget, and lifts it again after.
+    struct WatermarkScope {
+      bool set = false;
+      explicit WatermarkScope(uint32_t max_memory_mb) {
+        if (max_memory_mb == 0)
+          return;
+        uint64_t bytes = Z3_get_estimated_alloc_size() + (uint64_t(max_memory_mb) << 20);
+        Z3_global_param_set("memory_high_watermark", std::to_string(bytes).c_str());
+        set = true;
+      }
+      ~WatermarkScope() {
+        if (set)
+          Z3_global_param_set("memory_high_watermark", "0");
+      }
+    };
+  } // namespace
 
-  // Helper to detect RM sort from Alive2 expr
   static bool is_expr_rm(const ::alivesmt::expr &e) {
-    // We need to access the underlying Z3 sort.
-    // Alive2's expr class doesn't expose it directly in a public stable way without headers,
-    // but we can hack it via Z3 API if we have the AST.
-    // However, alivesmt::expr::ast() is private.
-    // Let's use a different approach: compare sort with a known RM.
-    return e.isSameTypeOf(::alivesmt::expr::rne());
+    return Z3_get_sort_kind(::alivesmt::ctx(), e.z3Sort()) == Z3_ROUNDING_MODE_SORT;
   }
 
-  AliveSolver::AliveSolver(uint32_t timeout_ms, uint32_t seed, uint32_t num_smt_threads) {
+  AliveSolver::AliveSolver(
+      uint32_t timeout_ms, uint32_t seed, uint32_t num_smt_threads, uint32_t max_memory_mb
+  ) {
     // Z3's global context and reference counting are not thread-safe.
     // We must serialize all Z3 operations across threads.
-    std::lock_guard<std::mutex> lock(z3_global_mutex);
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
 
-    // initializer member handles smt::smt_initializer::init() which calls ctx.init() and
-    // solver_init()
     if (timeout_ms > 0) {
       ::alivesmt::set_query_timeout(std::to_string(timeout_ms));
     }
     if (seed > 0) {
       ::alivesmt::set_random_seed(std::to_string(seed));
     }
+    // smt_initializer::init() calls ctx.init() and solver_init(), which
+    // read the timeout and seed set above.
+    if (live_solvers++ == 0)
+      z3_context.emplace();
     // Set Z3 thread parameters for parallel solving
     // Z3's SAT solver supports internal parallelism
-    if (num_smt_threads > 1) {
+    if (num_smt_threads > 1 && num_smt_threads != sat_threads) {
       Z3_global_param_set("sat.threads", std::to_string(num_smt_threads).c_str());
+      sat_threads = num_smt_threads;
     }
+    maxMemoryMb_ = max_memory_mb;
     solver = std::make_unique<::alivesmt::Solver>();
+    // The global timeout and seed are only read when the Z3 context is
+    // created, so later solvers, or ones sharing it, need theirs set on them.
+    if (timeout_ms > 0)
+      solver->set_timeout(timeout_ms);
+    if (seed > 0)
+      solver->set_seed(seed);
+    terms_.emplace_back();
+    sorts_.emplace_back();
+    sortInfo_.emplace_back();
   }
 
   AliveSolver::~AliveSolver() {
-    std::lock_guard<std::mutex> lock(z3_global_mutex);
-    // Destroy solver while holding the lock
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    // Destroy solver and the handle tables while holding the lock
     solver.reset();
-    // optional: ::alivesmt::solver_destroy();
-    // Usually better to leave it if other instances exist, but here we likely run one.
+    last_result.reset();
+    memo_.clear();
+    bvZero_.clear();
+    bvOne_.clear();
+    terms_.clear();
+    sorts_.clear();
+    if (--live_solvers == 0)
+      z3_context.reset();
   }
 
-  ::alivesmt::expr AliveSolver::unwrap(smt::Term t) const {
-    if (!t.internal)
+  const ::alivesmt::expr &AliveSolver::unwrap(smt::Term t) const {
+    if (!t || t.id >= terms_.size())
       throw std::runtime_error("Empty term handle");
-    return *static_cast<::alivesmt::expr *>(t.internal.get());
+    return terms_[t.id];
   }
 
-  ::alivesmt::expr AliveSolver::unwrap(smt::Sort s) const {
-    if (!s.internal)
+  const ::alivesmt::expr &AliveSolver::unwrap(smt::Sort s) const {
+    if (!s || s.id >= sorts_.size())
       throw std::runtime_error("Empty sort handle");
-    return *static_cast<::alivesmt::expr *>(s.internal.get());
+    return sorts_[s.id];
+  }
+
+  smt::Term AliveSolver::wrap(::alivesmt::expr t) {
+    terms_.push_back(std::move(t));
+    return {static_cast<uint32_t>(terms_.size() - 1)};
   }
 
-  smt::Term AliveSolver::wrap(const ::alivesmt::expr &t) const {
-    return {std::make_shared<::alivesmt::expr>(t)};
+  const AliveSolver::SortInfo &AliveSolver::info(smt::Sort s) const {
+    if (!s || s.id >= sortInfo_.size())
+      throw std::runtime_error("Empty sort handle");
+    return sortInfo_[s.id];
   }
 
-  smt::Sort AliveSolver::wrap_sort(const ::alivesmt::expr &s) const {
-    return {std::make_shared<::alivesmt::expr>(s)};
+  smt::Sort AliveSolver::wrap_sort(const ::alivesmt::expr &s) {
+    Z3_sort z3 = s.z3Sort();
+    auto [it, inserted] = sortIds_.try_emplace(z3, static_cast<uint32_t>(sorts_.size()));
+    if (!inserted)
+      return {it->second};
+    auto c = ::alivesmt::ctx();
+    SortInfo si;
+    si.z3 = z3;
+    switch (Z3_get_sort_kind(c, z3)) {
+      case Z3_BOOL_SORT:
+        si.kind = SortInfo::Kind::Bool;
+        break;
+      case Z3_BV_SORT:
+        si.kind = SortInfo::Kind::BV;
+        si.width = Z3_get_bv_sort_size(c, z3);
+        break;
+      case Z3_FLOATING_POINT_SORT:
+        si.kind = SortInfo::Kind::FP;
+        si.exp = Z3_fpa_get_ebits(c, z3);
+        si.sig = Z3_fpa_get_sbits(c, z3);
+        break;
+      case Z3_ARRAY_SORT:
+        si.kind = SortInfo::Kind::Array;
+        break;
+      case Z3_ROUNDING_MODE_SORT:
+        si.kind = SortInfo::Kind::RM;
+        break;
+      default:
+        break;
+    }
+    sorts_.push_back(s);
+    sortInfo_.push_back(si);
+    return {it->second};
   }
 
   smt::Sort AliveSolver::make_bv_sort(uint32_t size) {
-    return wrap_sort(::alivesmt::expr::mkUInt(0, size));
+    if (size < bvSorts_.size() && bvSorts_[size])
+      return bvSorts_[size];
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    smt::Sort s = wrap_sort(::alivesmt::expr::mkUInt(0, size));
+    if (size >= bvSorts_.size())
+      bvSorts_.resize(size + 1);
+    return bvSorts_[size] = s;
   }
 
   smt::Sort AliveSolver::make_fp_sort(uint32_t exp, uint32_t sig) {
-    if (exp == 8 && sig == 24)
-      return wrap_sort(::alivesmt::expr::mkFloat(0.0f));
-    if (exp == 11 && sig == 53)
-      return wrap_sort(::alivesmt::expr::mkDouble(0.0));
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    if (exp == 8 && sig == 24) {
+      if (!floatSort_)
+        floatSort_ = wrap_sort(::alivesmt::expr::mkFloat(0.0f));
+      return floatSort_;
+    }
+    if (exp == 11 && sig == 53) {
+      if (!doubleSort_)
+        doubleSort_ = wrap_sort(::alivesmt::expr::mkDouble(0.0));
+      return doubleSort_;
+    }
 
     throw std::runtime_error("Unsupported FP sort dims in AliveSolver");
   }
 
   smt::Sort AliveSolver::make_bool_sort() {
-    return wrap_sort(::alivesmt::expr(false)); // boolean false as representative
+    if (!boolSort_) {
+      std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+      boolSort_ = wrap_sort(::alivesmt::expr(false)); // boolean false as representative
+    }
+    return boolSort_;
   }
 
-  bool AliveSolver::is_bv_sort(smt::Sort s) { return unwrap(s).isBV(); }
+  smt::Sort AliveSolver::make_array_sort(smt::Sort index, smt::Sort elem) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    // constant array of the element representative
+    return wrap_sort(::alivesmt::expr::mkConstArray(unwrap(index), unwrap(elem)));
+  }
+
+  // The sort queries only read this solver's tables: no Z3 call, no lock.
+
+  bool AliveSolver::is_bv_sort(smt::Sort s) { return info(s).kind == SortInfo::Kind::BV; }
 
-  bool AliveSolver::is_fp_sort(smt::Sort s) { return unwrap(s).isFloat(); }
+  bool AliveSolver::is_fp_sort(smt::Sort s) { return info(s).kind == SortInfo::Kind::FP; }
 
-  bool AliveSolver::is_bool_sort(smt::Sort s) { return unwrap(s).isBool(); }
+  bool AliveSolver::is_bool_sort(smt::Sort s) { return info(s).kind == SortInfo::Kind::Bool; }
 
-  bool AliveSolver::is_rm_sort(smt::Sort s) { return is_expr_rm(unwrap(s)); }
+  bool AliveSolver::is_array_sort(smt::Sort s) { return info(s).kind == SortInfo::Kind::Array; }
 
-  uint32_t AliveSolver::get_bv_width(smt::Sort s) { return unwrap(s).bits(); }
+  bool AliveSolver::is_rm_sort(smt::Sort s) { return info(s).kind == SortInfo::Kind::RM; }
+
+  uint32_t AliveSolver::get_bv_width(smt::Sort s) { return info(s).width; }
 
   std::pair<uint32_t, uint32_t> AliveSolver::get_fp_dims(smt::Sort s) {
-    auto e = unwrap(s);
-    if (e.isSameTypeOf(::alivesmt::expr::mkFloat(0.0f)))
-      return {8, 24};
-    if (e.isSameTypeOf(::alivesmt::expr::mkDouble(0.0)))
-      return {11, 53};
+    const auto &si = info(s);
+    return {si.exp, si.sig}; // {0, 0} if not FP
+  }
 
-    return {0, 0}; // Error/Unknown
+  smt::Term AliveSolver::make_true() {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return wrap(::alivesmt::expr(true));
   }
 
-  smt::Term AliveSolver::make_true() { return wrap(::alivesmt::expr(true)); }
+  smt::Term AliveSolver::make_false() {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return wrap(::alivesmt::expr(false));
+  }
 
-  smt::Term AliveSolver::make_false() { return wrap(::alivesmt::expr(false)); }
+  smt::Term AliveSolver::make_bv_literal(smt::Sort s, uint64_t val) {
+    return wrap(
+        ::alivesmt::expr::fromZ3(Z3_mk_unsigned_int64(::alivesmt::ctx(), val, info(s).z3))
+    );
+  }
 
   smt::Term AliveSolver::make_bv_value(smt::Sort s, const std::string &val, uint8_t base) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    // Literals that fit 64 bits are made from their value, not parsed by Z3.
+    if (info(s).width <= 64 && (base == 2 || base == 10 || base == 16)) {
+      const char *first = val.data(), *last = val.data() + val.size();
+      uint64_t u;
+      int64_t i;
+      if (std::from_chars(first, last, u, base) == std::from_chars_result{last, {}})
+        return make_bv_literal(s, u);
+      if (base == 10 && std::from_chars(first, last, i) == std::from_chars_result{last, {}})
+        return make_bv_literal(s, static_cast<uint64_t>(i));
+    }
     auto type = unwrap(s);
     if (base == 10) {
       return wrap(::alivesmt::expr::mkNumber(val.c_str(), type));
@@ -127,26 +277,42 @@ namespace symir::solver {
   }
 
   smt::Term AliveSolver::make_bv_value_uint64(smt::Sort s, uint64_t val) {
-    return wrap(::alivesmt::expr::mkUInt(val, unwrap(s)));
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return make_bv_literal(s, val);
   }
 
   smt::Term AliveSolver::make_bv_value_int64(smt::Sort s, int64_t val) {
-    return wrap(::alivesmt::expr::mkInt(val, unwrap(s)));
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return wrap(::alivesmt::expr::fromZ3(Z3_mk_int64(::alivesmt::ctx(), val, info(s).z3)));
   }
 
   smt::Term AliveSolver::make_bv_zero(smt::Sort s) {
-    return wrap(::alivesmt::expr::mkUInt(0, unwrap(s)));
+    if (s.id >= bvZero_.size())
+      bvZero_.resize(s.id + 1);
+    if (!bvZero_[s.id]) {
+      std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+      bvZero_[s.id] = make_bv_literal(s, 0);
+    }
+    return bvZero_[s.id];
   }
 
   smt::Term AliveSolver::make_bv_one(smt::Sort s) {
-    return wrap(::alivesmt::expr::mkUInt(1, unwrap(s)));
+    if (s.id >= bvOne_.size())
+      bvOne_.resize(s.id + 1);
+    if (!bvOne_[s.id]) {
+      std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+      bvOne_[s.id] = make_bv_literal(s, 1);
+    }
+    return bvOne_[s.id];
   }
 
   smt::Term AliveSolver::make_bv_min_signed(smt::Sort s) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     return wrap(::alivesmt::expr::IntSMin(unwrap(s).bits()));
   }
 
   smt::Term AliveSolver::make_bv_max_signed(smt::Sort s) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     return wrap(::alivesmt::expr::IntSMax(unwrap(s).bits()));
   }
 
@@ -166,31 +332,157 @@ namespace symir::solver {
     return ::alivesmt::expr::rne();
   }
 
-  smt::Term AliveSolver::make_rm_value(smt::RoundingMode rm) { return wrap(map_rm(rm)); }
+  smt::Term AliveSolver::make_rm_value(smt::RoundingMode rm) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return wrap(map_rm(rm));
+  }
+
+  smt::Term AliveSolver::make_const_array(smt::Sort s, smt::Term val) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return wrap(unwrap(s).mkConstArrayLike(unwrap(val)));
+  }
 
   smt::Term
   AliveSolver::make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode /*rm*/) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     return wrap(::alivesmt::expr::mkNumber(val.c_str(), unwrap(s)));
   }
 
   smt::Term
   AliveSolver::make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode /*rm*/) {
-    auto type = unwrap(s);
-    if (type.isSameTypeOf(::alivesmt::expr::mkFloat(0.0f)))
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    if (info(s).exp == 8 && info(s).sig == 24)
       return wrap(::alivesmt::expr::mkFloat((float) val));
-    if (type.isSameTypeOf(::alivesmt::expr::mkDouble(0.0)))
-      return wrap(::alivesmt::expr::mkDouble(val));
-    return wrap(::alivesmt::expr::mkDouble(val)); // Fallback
+    return wrap(::alivesmt::expr::mkDouble(val)); // also the fallback
   }
 
   smt::Term AliveSolver::make_const(smt::Sort s, const std::string &name) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     return wrap(::alivesmt::expr::mkFreshVar(name.c_str(), unwrap(s)));
   }
 
+  std::size_t AliveSolver::KeyHash::operator()(const std::vector<uint32_t> &key) const {
+    std::size_t h = key.size();
+    for (uint32_t v: key)
+      h = h * 0x9e3779b97f4a7c15ull + v;
+    return h;
+  }
+
   smt::Term AliveSolver::make_term(
-      smt::Kind k, const std::vector<smt::Term> &args, const std::vector<uint32_t> &indices
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+  ) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    std::vector<uint32_t> key;
+    key.reserve(2 + args.size() + indices.size());
+    key.push_back(static_cast<uint32_t>(k));
+    key.push_back(static_cast<uint32_t>(args.size()));
+    for (const auto &a: args)
+      key.push_back(a.id);
+    key.insert(key.end(), indices.begin(), indices.end());
+    if (auto it = memo_.find(key); it != memo_.end())
+      return it->second;
+
+    smt::Term t;
+    if (Z3_ast raw = make_z3_term(k, args, indices))
+      t = wrap(::alivesmt::expr::fromZ3(raw));
+    else
+      t = wrap(make_alive_term(k, args, indices));
+    memo_.emplace(std::move(key), t);
+    return t;
+  }
+
+  Z3_ast AliveSolver::make_z3_term(
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+  ) {
+    auto c = ::alivesmt::ctx();
+    std::vector<Z3_ast> a(std::max<std::size_t>(args.size(), 3), nullptr);
+    for (std::size_t i = 0; i < args.size(); ++i)
+      a[i] = unwrap(args[i]).toZ3();
+    auto n = static_cast<unsigned>(args.size());
+
+    switch (k) {
+      case smt::Kind::BV_ADD:
+        return Z3_mk_bvadd(c, a[0], a[1]);
+      case smt::Kind::BV_SUB:
+        return Z3_mk_bvsub(c, a[0], a[1]);
+      case smt::Kind::BV_MUL:
+        return Z3_mk_bvmul(c, a[0], a[1]);
+      case smt::Kind::BV_SDIV:
+        return Z3_mk_bvsdiv(c, a[0], a[1]);
+      case smt::Kind::BV_UDIV:
+        return Z3_mk_bvudiv(c, a[0], a[1]);
+      case smt::Kind::BV_SREM:
+        return Z3_mk_bvsrem(c, a[0], a[1]);
+      case smt::Kind::BV_UREM:
+        return Z3_mk_bvurem(c, a[0], a[1]);
+      case smt::Kind::BV_AND:
+        return Z3_mk_bvand(c, a[0], a[1]);
+      case smt::Kind::BV_OR:
+        return Z3_mk_bvor(c, a[0], a[1]);
+      case smt::Kind::BV_XOR:
+        return Z3_mk_bvxor(c, a[0], a[1]);
+      case smt::Kind::BV_NOT:
+        return Z3_mk_bvnot(c, a[0]);
+      case smt::Kind::BV_SHL:
+        return Z3_mk_bvshl(c, a[0], a[1]);
+      case smt::Kind::BV_ASHR:
+        return Z3_mk_bvashr(c, a[0], a[1]);
+      case smt::Kind::BV_SHR:
+        return Z3_mk_bvlshr(c, a[0], a[1]);
+      case smt::Kind::BV_NEG:
+        return Z3_mk_bvneg(c, a[0]);
+      case smt::Kind::BV_SLT:
+        return Z3_mk_bvslt(c, a[0], a[1]);
+      case smt::Kind::BV_SLE:
+        return Z3_mk_bvsle(c, a[0], a[1]);
+      case smt::Kind::BV_SGT:
+        return Z3_mk_bvsgt(c, a[0], a[1]);
+      case smt::Kind::BV_SGE:
+        return Z3_mk_bvsge(c, a[0], a[1]);
+      case smt::Kind::BV_ULT:
+        return Z3_mk_bvult(c, a[0], a[1]);
+      case smt::Kind::BV_ULE:
+        return Z3_mk_bvule(c, a[0], a[1]);
+      case smt::Kind::BV_UGT:
+        return Z3_mk_bvugt(c, a[0], a[1]);
+      case smt::Kind::BV_UGE:
+        return Z3_mk_bvuge(c, a[0], a[1]);
+      case smt::Kind::EQUAL:
+        return Z3_mk_eq(c, a[0], a[1]);
+      case smt::Kind::DISTINCT:
+        return Z3_mk_distinct(c, n, a.data());
+      case smt::Kind::ITE:
+        return Z3_mk_ite(c, a[0], a[1], a[2]);
+      case smt::Kind::AND:
+        return Z3_mk_and(c, n, a.data());
+      case smt::Kind::OR:
+        return Z3_mk_or(c, n, a.data());
+      case smt::Kind::NOT:
+        return Z3_mk_not(c, a[0]);
+      case smt::Kind::IMPLIES:
+        return Z3_mk_implies(c, a[0], a[1]);
+      case smt::Kind::BV_SIGN_EXTEND:
+        return Z3_mk_sign_ext(c, indices[0], a[0]);
+      case smt::Kind::BV_ZERO_EXTEND:
+        return Z3_mk_zero_ext(c, indices[0], a[0]);
+      case smt::Kind::BV_EXTRACT:
+        return Z3_mk_extract(c, indices[0], indices[1], a[0]);
+      case smt::Kind::BV_CONCAT:
+        return Z3_mk_concat(c, a[0], a[1]);
+      case smt::Kind::ARRAY_SELECT:
+        return Z3_mk_select(c, a[0], a[1]);
+      case smt::Kind::ARRAY_STORE:
+        return Z3_mk_store(c, a[0], a[1], a[2]);
+      default:
+        return nullptr;
+    }
+  }
+
+  ::alivesmt::expr AliveSolver::make_alive_term(
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
   ) {
     std::vector<::alivesmt::expr> eargs;
+    eargs.reserve(args.size());
     for (auto &a: args)
       eargs.push_back(unwrap(a));
 
@@ -204,150 +496,156 @@ namespace symir::solver {
     // Map kinds to Alive2 expr operations
     switch (k) {
       case smt::Kind::BV_ADD:
-        return wrap(eargs[0] + eargs[1]);
+        return (eargs[0] + eargs[1]);
       case smt::Kind::BV_SUB:
-        return wrap(eargs[0] - eargs[1]);
+        return (eargs[0] - eargs[1]);
       case smt::Kind::BV_MUL:
-        return wrap(eargs[0] * eargs[1]);
+        return (eargs[0] * eargs[1]);
       case smt::Kind::BV_SDIV:
-        return wrap(eargs[0].sdiv(eargs[1]));
+        return (eargs[0].sdiv(eargs[1]));
       case smt::Kind::BV_UDIV:
-        return wrap(eargs[0].udiv(eargs[1]));
+        return (eargs[0].udiv(eargs[1]));
       case smt::Kind::BV_SREM:
-        return wrap(eargs[0].srem(eargs[1]));
+        return (eargs[0].srem(eargs[1]));
       case smt::Kind::BV_UREM:
-        return wrap(eargs[0].urem(eargs[1]));
+        return (eargs[0].urem(eargs[1]));
       case smt::Kind::BV_AND:
-        return wrap(eargs[0] & eargs[1]);
+        return (eargs[0] & eargs[1]);
       case smt::Kind::BV_OR:
-        return wrap(eargs[0] | eargs[1]);
+        return (eargs[0] | eargs[1]);
       case smt::Kind::BV_XOR:
-        return wrap(eargs[0] ^ eargs[1]);
+        return (eargs[0] ^ eargs[1]);
       case smt::Kind::BV_NOT:
-        return wrap(~eargs[0]); // bitwise not
+        return (~eargs[0]); // bitwise not
       case smt::Kind::BV_SHL:
-        return wrap(eargs[0] << eargs[1]);
+        return (eargs[0] << eargs[1]);
       case smt::Kind::BV_ASHR:
-        return wrap(eargs[0].ashr(eargs[1]));
+        return (eargs[0].ashr(eargs[1]));
       case smt::Kind::BV_SHR:
-        return wrap(eargs[0].lshr(eargs[1]));
+        return (eargs[0].lshr(eargs[1]));
       case smt::Kind::BV_NEG:
-        return wrap(::alivesmt::expr::mkUInt(0, eargs[0]) - eargs[0]); // negation 0 - x
+        return (::alivesmt::expr::mkUInt(0, eargs[0]) - eargs[0]); // negation 0 - x
 
       case smt::Kind::BV_SLT:
-        return wrap(eargs[0].slt(eargs[1]));
+        return (eargs[0].slt(eargs[1]));
       case smt::Kind::BV_SLE:
-        return wrap(eargs[0].sle(eargs[1]));
+        return (eargs[0].sle(eargs[1]));
       case smt::Kind::BV_SGT:
-        return wrap(eargs[0].sgt(eargs[1]));
+        return (eargs[0].sgt(eargs[1]));
       case smt::Kind::BV_SGE:
-        return wrap(eargs[0].sge(eargs[1]));
+        return (eargs[0].sge(eargs[1]));
       case smt::Kind::BV_ULT:
-        return wrap(eargs[0].ult(eargs[1]));
+        return (eargs[0].ult(eargs[1]));
       case smt::Kind::BV_ULE:
-        return wrap(eargs[0].ule(eargs[1]));
+        return (eargs[0].ule(eargs[1]));
       case smt::Kind::BV_UGT:
-        return wrap(eargs[0].ugt(eargs[1]));
+        return (eargs[0].ugt(eargs[1]));
       case smt::Kind::BV_UGE:
-        return wrap(eargs[0].uge(eargs[1]));
+        return (eargs[0].uge(eargs[1]));
 
       case smt::Kind::EQUAL:
-        return wrap(eargs[0] == eargs[1]);
+        return (eargs[0] == eargs[1]);
       case smt::Kind::DISTINCT:
-        return wrap(eargs[0] != eargs[1]);
+        return (eargs[0] != eargs[1]);
 
       case smt::Kind::ITE:
-        return wrap(::alivesmt::expr::mkIf(eargs[0], eargs[1], eargs[2]));
+        return (::alivesmt::expr::mkIf(eargs[0], eargs[1], eargs[2]));
       case smt::Kind::AND:
-        return wrap(eargs[0] && eargs[1]);
+        return (eargs[0] && eargs[1]);
       case smt::Kind::OR:
-        return wrap(eargs[0] || eargs[1]);
+        return (eargs[0] || eargs[1]);
       case smt::Kind::NOT:
-        return wrap(!eargs[0]); // boolean not
+        return (!eargs[0]); // boolean not
       case smt::Kind::IMPLIES:
-        return wrap(eargs[0].implies(eargs[1]));
+        return (eargs[0].implies(eargs[1]));
 
       case smt::Kind::FP_ADD:
         injectRM(eargs);
-        return wrap(eargs[1].fadd(eargs[2], eargs[0])); // args: RM, a, b -> a.fadd(b, rm)
+        return (eargs[1].fadd(eargs[2], eargs[0])); // args: RM, a, b -> a.fadd(b, rm)
       case smt::Kind::FP_SUB:
         injectRM(eargs);
-        return wrap(eargs[1].fsub(eargs[2], eargs[0]));
+        return (eargs[1].fsub(eargs[2], eargs[0]));
       case smt::Kind::FP_MUL:
         injectRM(eargs);
-        return wrap(eargs[1].fmul(eargs[2], eargs[0]));
+        return (eargs[1].fmul(eargs[2], eargs[0]));
       case smt::Kind::FP_DIV:
         injectRM(eargs);
-        return wrap(eargs[1].fdiv(eargs[2], eargs[0]));
+        return (eargs[1].fdiv(eargs[2], eargs[0]));
       case smt::Kind::FP_REM:
-        return wrap(eargs[0].frem(eargs[1])); // no RM for frem
+        return (eargs[0].frem(eargs[1])); // no RM for frem
       case smt::Kind::FP_SQRT:
         injectRM(eargs);
-        return wrap(eargs[1].sqrt(eargs[0]));
+        return (eargs[1].sqrt(eargs[0]));
       case smt::Kind::FP_RTI:
         injectRM(eargs);
-        return wrap(eargs[1].round(eargs[0])); // Round to integral
+        return (eargs[1].round(eargs[0])); // Round to integral
       case smt::Kind::FP_MIN:
-        return wrap(eargs[0].fmin(eargs[1]));
+        return (eargs[0].fmin(eargs[1]));
       case smt::Kind::FP_MAX:
-        return wrap(eargs[0].fmax(eargs[1]));
+        return (eargs[0].fmax(eargs[1]));
 
       case smt::Kind::FP_EQUAL:
-        return wrap(eargs[0].foeq(eargs[1]));
+        return (eargs[0].foeq(eargs[1]));
       case smt::Kind::FP_LT:
-        return wrap(eargs[0].folt(eargs[1]));
+        return (eargs[0].folt(eargs[1]));
       case smt::Kind::FP_LEQ:
-        return wrap(eargs[0].fole(eargs[1]));
+        return (eargs[0].fole(eargs[1]));
       case smt::Kind::FP_GT:
-        return wrap(eargs[0].fogt(eargs[1]));
+        return (eargs[0].fogt(eargs[1]));
       case smt::Kind::FP_GEQ:
-        return wrap(eargs[0].foge(eargs[1]));
+        return (eargs[0].foge(eargs[1]));
 
       case smt::Kind::FP_TO_SBV:
         // args: RM, val. indices: {width}.
         injectRM(eargs);
-        return wrap(eargs[1].fp2sint(indices[0], eargs[0]));
+        return (eargs[1].fp2sint(indices[0], eargs[0]));
 
       case smt::Kind::FP_TO_UBV:
         injectRM(eargs);
-        return wrap(eargs[1].fp2uint(indices[0], eargs[0]));
+        return (eargs[1].fp2uint(indices[0], eargs[0]));
 
       case smt::Kind::FP_TO_FP_FROM_FP:
         // args: RM, val. indices: {exp, sig} -> we need target type.
         injectRM(eargs);
-        return wrap(eargs[1].float2Float(unwrap(make_fp_sort(indices[0], indices[1])), eargs[0]));
+        return (eargs[1].float2Float(unwrap(make_fp_sort(indices[0], indices[1])), eargs[0]));
 
       case smt::Kind::FP_TO_FP_FROM_SBV:
         // args: RM, val. indices: {exp, sig}.
         injectRM(eargs);
-        return wrap(eargs[1].sint2fp(unwrap(make_fp_sort(indices[0], indices[1])), eargs[0]));
+        return (eargs[1].sint2fp(unwrap(make_fp_sort(indices[0], indices[1])), eargs[0]));
 
       case smt::Kind::FP_TO_FP_FROM_UBV:
         injectRM(eargs);
-        return wrap(eargs[1].uint2fp(unwrap(make_fp_sort(indices[0], indices[1])), eargs[0]));
+        return (eargs[1].uint2fp(unwrap(make_fp_sort(indices[0], indices[1])), eargs[0]));
 
       case smt::Kind::BV_SIGN_EXTEND:
         // args: val. indices: {amount}
-        return wrap(eargs[0].sext(indices[0]));
+        return (eargs[0].sext(indices[0]));
 
       case smt::Kind::BV_ZERO_EXTEND:
-        return wrap(eargs[0].zext(indices[0]));
+        return (eargs[0].zext(indices[0]));
 
       case smt::Kind::BV_EXTRACT:
         // args: val. indices: {high, low}
-        return wrap(eargs[0].extract(indices[0], indices[1]));
+        return (eargs[0].extract(indices[0], indices[1]));
 
       case smt::Kind::BV_CONCAT:
-        return wrap(eargs[0].concat(eargs[1]));
+        return (eargs[0].concat(eargs[1]));
 
       case smt::Kind::BV_SADD_OVERFLOW:
-        return wrap(!eargs[0].add_no_soverflow(eargs[1]));
+        return (!eargs[0].add_no_soverflow(eargs[1]));
 
       case smt::Kind::BV_SSUB_OVERFLOW:
-        return wrap(!eargs[0].sub_no_soverflow(eargs[1]));
+        return (!eargs[0].sub_no_soverflow(eargs[1]));
 
       case smt::Kind::BV_SMUL_OVERFLOW:
-        return wrap(!eargs[0].mul_no_soverflow(eargs[1]));
+        return (!eargs[0].mul_no_soverflow(eargs[1]));
+
+      case smt::Kind::ARRAY_SELECT:
+        return (eargs[0].load(eargs[1]));
+
+      case smt::Kind::ARRAY_STORE:
+        return (eargs[0].store(eargs[1], eargs[2]));
 
       default:
         throw std::runtime_error("Unknown/Unimplemented kind in AliveSolver");
@@ -355,21 +653,30 @@ namespace symir::solver {
   }
 
   smt::Sort AliveSolver::get_sort(smt::Term t) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     auto e = unwrap(t);
     return wrap_sort(e);
   }
 
-  bool AliveSolver::is_true(smt::Term t) { return unwrap(t).isTrue(); }
+  bool AliveSolver::is_true(smt::Term t) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return unwrap(t).isTrue();
+  }
 
-  bool AliveSolver::is_false(smt::Term t) { return unwrap(t).isFalse(); }
+  bool AliveSolver::is_false(smt::Term t) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    return unwrap(t).isFalse();
+  }
 
   void AliveSolver::assert_formula(smt::Term t) {
-    std::lock_guard<std::mutex> lock(z3_global_mutex);
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     solver->add(unwrap(t));
   }
 
   smt::Result AliveSolver::check_sat() {
-    std::lock_guard<std::mutex> lock(z3_global_mutex);
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    CheckingScope scope(this);
+    WatermarkScope watermark(maxMemoryMb_);
     auto res = solver->check("check_sat");
     if (res.isSat()) {
       last_result = std::make_unique<::alivesmt::Result>(std::move(res));
@@ -380,8 +687,62 @@ namespace symir::solver {
     return smt::Result::UNKNOWN;
   }
 
+  void AliveSolver::push(uint32_t levels) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    for (uint32_t i = 0; i < levels; ++i)
+      solver->push();
+  }
+
+  void AliveSolver::pop(uint32_t levels) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    solver->pop(levels);
+  }
+
+  smt::Result AliveSolver::check_sat_assuming(const std::vector<smt::Term> &assumptions) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    std::vector<::alivesmt::expr> eassumptions;
+    eassumptions.reserve(assumptions.size());
+    for (const auto &a: assumptions)
+      eassumptions.push_back(unwrap(a));
+    last_assumptions = assumptions;
+    CheckingScope scope(this);
+    WatermarkScope watermark(maxMemoryMb_);
+    auto res = solver->check(eassumptions, "check_sat_assuming");
+    if (res.isSat()) {
+      last_result = std::make_unique<::alivesmt::Result>(std::move(res));
+      return smt::Result::SAT;
+    }
+    if (res.isUnsat())
+      return smt::Result::UNSAT;
+    return smt::Result::UNKNOWN;
+  }
+
+  std::vector<smt::Term> AliveSolver::get_unsat_assumptions() {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
+    // Z3 hands back the assumption ASTs themselves; map them to the handles
+    // they were passed as.
+    std::vector<smt::Term> core;
+    for (const auto &c: solver->unsatCore()) {
+      for (const auto &a: last_assumptions) {
+        if (unwrap(a).eq(c)) {
+          core.push_back(a);
+          break;
+        }
+      }
+    }
+    return core;
+  }
+
+  void AliveSolver::interrupt() {
+    // Not under z3_global_mutex, which the running check holds: Z3_interrupt
+    // is meant to be called from another thread.
+    std::lock_guard<std::mutex> lock(checking_mutex);
+    if (checking == this)
+      Z3_interrupt(::alivesmt::ctx());
+  }
+
   smt::Term AliveSolver::get_value(smt::Term t) {
-    std::lock_guard<std::mutex> lock(z3_global_mutex);
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     if (!last_result || !last_result->isSat())
       throw std::runtime_error("get_value called without SAT result");
 
@@ -389,6 +750,7 @@ namespace symir::solver {
   }
 
   std::string AliveSolver::get_bv_value_string(smt::Term t, uint8_t base) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     auto e = unwrap(t);
 
     if (base == 10) {
@@ -402,6 +764,7 @@ namespace symir::solver {
   }
 
   std::string AliveSolver::get_fp_value_string(smt::Term t) {
+    std::lock_guard<std::recursive_mutex> lock(z3_global_mutex);
     auto e = unwrap(t);
     auto bv = e.float2BV();
 
@@ -1,42 +1,111 @@
 #include "solver/bitwuzla_impl.hpp"
+#include <bit>
+#include <cmath>
 #include <stdexcept>
 
 namespace symir::solver {
 
-  static bitwuzla::Options
-  create_options(uint32_t timeout, uint32_t seed, uint32_t num_smt_threads) {
+  std::shared_ptr<BitwuzlaContext> BitwuzlaContext::forThisThread() {
+    thread_local std::shared_ptr<BitwuzlaContext> ctx = std::make_shared<BitwuzlaContext>();
+    return ctx;
+  }
+
+  const bitwuzla::Sort &BitwuzlaContext::boolSort() {
+    if (bool_.is_null())
+      bool_ = tm_.mk_bool_sort();
+    return bool_;
+  }
+
+  const bitwuzla::Sort &BitwuzlaContext::bvSort(uint32_t width) {
+    if (width >= bv_.size())
+      bv_.resize(width + 1);
+    if (bv_[width].is_null())
+      bv_[width] = tm_.mk_bv_sort(width);
+    return bv_[width];
+  }
+
+  const bitwuzla::Sort &BitwuzlaContext::fpSort(uint32_t exp, uint32_t sig) {
+    auto [it, inserted] = fp_.try_emplace({exp, sig});
+    if (inserted)
+      it->second = tm_.mk_fp_sort(exp, sig);
+    return it->second;
+  }
+
+  const bitwuzla::Term &BitwuzlaContext::rm(bitwuzla::RoundingMode mode) {
+    auto &t = rm_[static_cast<std::size_t>(mode)];
+    if (t.is_null())
+      t = tm_.mk_rm_value(mode);
+    return t;
+  }
+
+  const bitwuzla::Term &BitwuzlaContext::bvZero(uint32_t width) {
+    if (width >= zero_.size())
+      zero_.resize(width + 1);
+    if (zero_[width].is_null())
+      zero_[width] = tm_.mk_bv_zero(bvSort(width));
+    return zero_[width];
+  }
+
+  const bitwuzla::Term &BitwuzlaContext::bvOne(uint32_t width) {
+    if (width >= one_.size())
+      one_.resize(width + 1);
+    if (one_[width].is_null())
+      one_[width] = tm_.mk_bv_one(bvSort(width));
+    return one_[width];
+  }
+
+  static bitwuzla::Options create_options(const BitwuzlaSolver::Options &opts) {
     bitwuzla::Options options;
     options.set(bitwuzla::Option::PRODUCE_MODELS, true);
-    if (timeout > 0)
-      options.set(bitwuzla::Option::TIME_LIMIT_PER, (uint64_t) timeout);
-    if (seed > 0)
-      options.set(bitwuzla::Option::SEED, (uint64_t) seed);
-    if (num_smt_threads > 0)
-      options.set(bitwuzla::Option::NTHREADS, (uint64_t) num_smt_threads);
+    options.set(bitwuzla::Option::PRODUCE_UNSAT_ASSUMPTIONS, true);
+    if (opts.timeout_ms > 0)
+      options.set(bitwuzla::Option::TIME_LIMIT_PER, (uint64_t) opts.timeout_ms);
+    if (opts.seed > 0)
+      options.set(bitwuzla::Option::SEED, (uint64_t) opts.seed);
+    if (opts.num_smt_threads > 0)
+      options.set(bitwuzla::Option::NTHREADS, (uint64_t) opts.num_smt_threads);
+    options.set(bitwuzla::Option::PREPROCESS, opts.preprocess);
+    options.set(bitwuzla::Option::REWRITE_LEVEL, (uint64_t) opts.rewrite_level);
+    if (opts.memory_limit_mb > 0)
+      options.set(bitwuzla::Option::MEMORY_LIMIT, (uint64_t) opts.memory_limit_mb);
     return options;
   }
 
   BitwuzlaSolver::BitwuzlaSolver(uint32_t timeout_ms, uint32_t seed, uint32_t num_smt_threads) :
-      tm(), solver(tm, create_options(timeout_ms, seed, num_smt_threads)) {}
+      BitwuzlaSolver(Options{timeout_ms, seed, num_smt_threads}) {}
+
+  BitwuzlaSolver::BitwuzlaSolver(
+      const Options &options, std::shared_ptr<BitwuzlaContext> context
+  ) :
+      ctx(std::move(context)), tm(ctx->tm()), solver(tm, create_options(options)), sorts_(1),
+      terms_(1) {
+    solver.configure_terminator(&terminator);
+  }
 
-  bitwuzla::Sort BitwuzlaSolver::unwrap(smt::Sort s) const {
-    if (!s.internal)
+  const bitwuzla::Sort &BitwuzlaSolver::unwrap(smt::Sort s) const {
+    if (!s || s.id >= sorts_.size())
       throw std::runtime_error("Empty sort handle");
-    return *static_cast<bitwuzla::Sort *>(s.internal.get());
+    return sorts_[s.id];
   }
 
-  bitwuzla::Term BitwuzlaSolver::unwrap(smt::Term t) const {
-    if (!t.internal)
+  const bitwuzla::Term &BitwuzlaSolver::unwrap(smt::Term t) const {
+    if (!t || t.id >= terms_.size())
       throw std::runtime_error("Empty term handle");
-    return *static_cast<bitwuzla::Term *>(t.internal.get());
+    return terms_[t.id];
   }
 
-  smt::Sort BitwuzlaSolver::wrap(bitwuzla::Sort s) const {
-    return {std::make_shared<bitwuzla::Sort>(s)};
+  smt::Sort BitwuzlaSolver::wrap(const bitwuzla::Sort &s) {
+    auto [it, inserted] = sortIds_.try_emplace(s, static_cast<uint32_t>(sorts_.size()));
+    if (inserted)
+      sorts_.push_back(s);
+    return {it->second};
   }
 
-  smt::Term BitwuzlaSolver::wrap(bitwuzla::Term t) const {
-    return {std::make_shared<bitwuzla::Term>(t)};
+  smt::Term BitwuzlaSolver::wrap(const bitwuzla::Term &t) {
+    auto [it, inserted] = termIds_.try_emplace(t, static_cast<uint32_t>(terms_.size()));
+    if (inserted)
+      terms_.push_back(t);
+    return {it->second};
   }
 
   bitwuzla::RoundingMode BitwuzlaSolver::map_rm(smt::RoundingMode rm) const {
@@ -173,17 +242,25 @@ namespace symir::solver {
         return bitwuzla::Kind::BV_SSUB_OVERFLOW;
       case smt::Kind::BV_SMUL_OVERFLOW:
         return bitwuzla::Kind::BV_SMUL_OVERFLOW;
+      case smt::Kind::ARRAY_SELECT:
+        return bitwuzla::Kind::ARRAY_SELECT;
+      case smt::Kind::ARRAY_STORE:
+        return bitwuzla::Kind::ARRAY_STORE;
     }
     throw std::runtime_error("Unknown kind");
   }
 
-  smt::Sort BitwuzlaSolver::make_bv_sort(uint32_t size) { return wrap(tm.mk_bv_sort(size)); }
+  smt::Sort BitwuzlaSolver::make_bv_sort(uint32_t size) { return wrap(ctx->bvSort(size)); }
 
   smt::Sort BitwuzlaSolver::make_fp_sort(uint32_t exp, uint32_t sig) {
-    return wrap(tm.mk_fp_sort(exp, sig));
+    return wrap(ctx->fpSort(exp, sig));
   }
 
-  smt::Sort BitwuzlaSolver::make_bool_sort() { return wrap(tm.mk_bool_sort()); }
+  smt::Sort BitwuzlaSolver::make_bool_sort() { return wrap(ctx->boolSort()); }
+
+  smt::Sort BitwuzlaSolver::make_array_sort(smt::Sort index, smt::Sort elem) {
+    return wrap(tm.mk_array_sort(unwrap(index), unwrap(elem)));
+  }
 
   bool BitwuzlaSolver::is_bv_sort(smt::Sort s) { return unwrap(s).is_bv(); }
 
@@ -191,6 +268,8 @@ namespace symir::solver {
 
   bool BitwuzlaSolver::is_bool_sort(smt::Sort s) { return unwrap(s).is_bool(); }
 
+  bool BitwuzlaSolver::is_array_sort(smt::Sort s) { return unwrap(s).is_array(); }
+
   bool BitwuzlaSolver::is_rm_sort(smt::Sort s) { return unwrap(s).is_rm(); }
 
   uint32_t BitwuzlaSolver::get_bv_width(smt::Sort s) { return unwrap(s).bv_size(); }
@@ -209,17 +288,20 @@ namespace symir::solver {
   }
 
   smt::Term BitwuzlaSolver::make_bv_value_uint64(smt::Sort s, uint64_t val) {
-    return wrap(tm.mk_bv_value(unwrap(s), std::to_string(val), 10)); // Bitwuzla < 0.4.0 style
-    // Or: return wrap(tm.mk_bv_value_uint64(unwrap(s), val)); if available
+    return wrap(tm.mk_bv_value_uint64(unwrap(s), val));
   }
 
   smt::Term BitwuzlaSolver::make_bv_value_int64(smt::Sort s, int64_t val) {
     return wrap(tm.mk_bv_value_int64(unwrap(s), val));
   }
 
-  smt::Term BitwuzlaSolver::make_bv_zero(smt::Sort s) { return wrap(tm.mk_bv_zero(unwrap(s))); }
+  smt::Term BitwuzlaSolver::make_bv_zero(smt::Sort s) {
+    return wrap(ctx->bvZero(unwrap(s).bv_size()));
+  }
 
-  smt::Term BitwuzlaSolver::make_bv_one(smt::Sort s) { return wrap(tm.mk_bv_one(unwrap(s))); }
+  smt::Term BitwuzlaSolver::make_bv_one(smt::Sort s) {
+    return wrap(ctx->bvOne(unwrap(s).bv_size()));
+  }
 
   smt::Term BitwuzlaSolver::make_bv_min_signed(smt::Sort s) {
     return wrap(tm.mk_bv_min_signed(unwrap(s)));
@@ -231,17 +313,35 @@ namespace symir::solver {
 
   smt::Term
   BitwuzlaSolver::make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) {
-    auto rm_term = tm.mk_rm_value(map_rm(rm));
-    return wrap(tm.mk_fp_value(unwrap(s), rm_term, val));
+    return wrap(tm.mk_fp_value(unwrap(s), ctx->rm(map_rm(rm)), val));
   }
 
   smt::Term BitwuzlaSolver::make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) {
-    // Bitwuzla might not support double directly, usually strings.
-    return wrap(tm.mk_fp_value(unwrap(s), tm.mk_rm_value(map_rm(rm)), std::to_string(val)));
+    // Doubles, and floats that hold the value exactly, are built from their
+    // IEEE fields; other sorts round from the decimal string.
+    const auto &sort = unwrap(s);
+    auto fields = [&](uint64_t bits, uint32_t exp, uint32_t sig) {
+      uint32_t frac = sig - 1;
+      return wrap(tm.mk_fp_value(
+          tm.mk_bv_value_uint64(ctx->bvSort(1), bits >> (exp + frac)),
+          tm.mk_bv_value_uint64(ctx->bvSort(exp), (bits >> frac) & ((1ull << exp) - 1)),
+          tm.mk_bv_value_uint64(ctx->bvSort(frac), bits & ((1ull << frac) - 1))
+      ));
+    };
+    if (sort.fp_exp_size() == 11 && sort.fp_sig_size() == 53)
+      return fields(std::bit_cast<uint64_t>(val), 11, 53);
+    if (sort.fp_exp_size() == 8 && sort.fp_sig_size() == 24 &&
+        ((double) (float) val == val || std::isnan(val)))
+      return fields(std::bit_cast<uint32_t>((float) val), 8, 24);
+    return wrap(tm.mk_fp_value(sort, ctx->rm(map_rm(rm)), std::to_string(val)));
   }
 
   smt::Term BitwuzlaSolver::make_rm_value(smt::RoundingMode rm) {
-    return wrap(tm.mk_rm_value(map_rm(rm)));
+    return wrap(ctx->rm(map_rm(rm)));
+  }
+
+  smt::Term BitwuzlaSolver::make_const_array(smt::Sort s, smt::Term val) {
+    return wrap(tm.mk_const_array(unwrap(s), unwrap(val)));
   }
 
   smt::Term BitwuzlaSolver::make_const(smt::Sort s, const std::string &name) {
@@ -249,7 +349,7 @@ namespace symir::solver {
   }
 
   smt::Term BitwuzlaSolver::make_term(
-      smt::Kind k, const std::vector<smt::Term> &args, const std::vector<uint32_t> &indices
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
   ) {
     std::vector<bitwuzla::Term> bargs;
     bargs.reserve(args.size());
@@ -269,10 +369,8 @@ namespace symir::solver {
         hasRM = true;
       }
 
-      if (!hasRM) {
-        auto rm = tm.mk_rm_value(bitwuzla::RoundingMode::RNE);
-        bargs.insert(bargs.begin(), rm);
-      }
+      if (!hasRM)
+        bargs.insert(bargs.begin(), ctx->rm(bitwuzla::RoundingMode::RNE));
     }
 
     if (indices.empty())
@@ -292,6 +390,7 @@ namespace symir::solver {
   void BitwuzlaSolver::assert_formula(smt::Term t) { solver.assert_formula(unwrap(t)); }
 
   smt::Result BitwuzlaSolver::check_sat() {
+    interrupted.store(false);
     auto res = solver.check_sat();
     if (res == bitwuzla::Result::SAT)
       return smt::Result::SAT;
@@ -300,6 +399,33 @@ namespace symir::solver {
     return smt::Result::UNKNOWN;
   }
 
+  void BitwuzlaSolver::push(uint32_t levels) { solver.push(levels); }
+
+  void BitwuzlaSolver::pop(uint32_t levels) { solver.pop(levels); }
+
+  smt::Result BitwuzlaSolver::check_sat_assuming(const std::vector<smt::Term> &assumptions) {
+    std::vector<bitwuzla::Term> bargs;
+    bargs.reserve(assumptions.size());
+    for (const auto &a: assumptions)
+      bargs.push_back(unwrap(a));
+    interrupted.store(false);
+    auto res = solver.check_sat(bargs);
+    if (res == bitwuzla::Result::SAT)
+      return smt::Result::SAT;
+    if (res == bitwuzla::Result::UNSAT)
+      return smt::Result::UNSAT;
+    return smt::Result::UNKNOWN;
+  }
+
+  std::vector<smt::Term> BitwuzlaSolver::get_unsat_assumptions() {
+    std::vector<smt::Term> core;
+    for (const auto &t: solver.get_unsat_assumptions())
+      core.push_back(wrap(t));
+    return core;
+  }
+
+  void BitwuzlaSolver::interrupt() { interrupted.store(true); }
+
   smt::Term BitwuzlaSolver::get_value(smt::Term t) { return wrap(solver.get_value(unwrap(t))); }
 
   std::string BitwuzlaSolver::get_bv_value_string(smt::Term t, uint8_t base) {
@@ -0,0 +1,136 @@
+#include "solver/cancel.hpp"
+#include <algorithm>
+#include <map>
+#include <thread>
+
+namespace symir::solver {
+
+  /// The thread that cancels the cancellations whose deadline passed.
+  class Watchdog {
+  public:
+    static Watchdog &instance() {
+      static Watchdog dog;
+      return dog;
+    }
+
+    void watch(Cancellation *c, Cancellation::Clock::time_point deadline) {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!thread_.joinable())
+        thread_ = std::thread([this] { loop(); });
+      c->watched_ = true;
+      deadlines_.emplace(deadline, c);
+      wake_.notify_one();
+    }
+
+    void forget(Cancellation *c) {
+      std::lock_guard<std::mutex> lock(mu_);
+      std::erase_if(deadlines_, [c](const auto &d) { return d.second == c; });
+    }
+
+    ~Watchdog() {
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+        wake_.notify_one();
+      }
+      if (thread_.joinable())
+        thread_.join();
+    }
+
+  private:
+    Watchdog() = default;
+
+    void loop() {
+      std::unique_lock<std::mutex> lock(mu_);
+      while (!stop_) {
+        if (deadlines_.empty()) {
+          wake_.wait(lock);
+          continue;
+        }
+        auto first = deadlines_.begin();
+        if (Cancellation::Clock::now() < first->first) {
+          wake_.wait_until(lock, first->first);
+          continue;
+        }
+        // Cancelled under mu_, so that forget() waits for it.
+        Cancellation *c = first->second;
+        deadlines_.erase(first);
+        c->cancel();
+        c->drain();
+      }
+    }
+
+    std::mutex mu_;
+    std::condition_variable wake_;
+    std::multimap<Cancellation::Clock::time_point, Cancellation *> deadlines_;
+    std::thread thread_;
+    bool stop_ = false;
+  };
+
+  Cancellation::Cancellation(Cancellation *parent) : parent_(parent) {
+    if (!parent_)
+      return;
+    std::lock_guard<std::mutex> lock(parent_->mu_);
+    parent_->children_.push_back(this);
+    if (parent_->cancelled())
+      cancelled_.store(true);
+  }
+
+  Cancellation::~Cancellation() {
+    if (watched_)
+      Watchdog::instance().forget(this);
+    if (parent_) {
+      std::lock_guard<std::mutex> lock(parent_->mu_);
+      std::erase(parent_->children_, this);
+    }
+  }
+
+  smt::Result
+  Cancellation::run(smt::ISolver &solver, const std::function<smt::Result()> &check) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (cancelled())
+        return smt::Result::UNKNOWN;
+      running_.push_back(&solver);
+    }
+    struct Done {
+      Cancellation &c;
+      smt::ISolver *solver;
+      ~Done() {
+        std::lock_guard<std::mutex> lock(c.mu_);
+        c.running_.erase(std::find(c.running_.begin(), c.running_.end(), solver));
+        c.idle_.notify_all();
+      }
+    } done{*this, &solver};
+    return check();
+  }
+
+  void Cancellation::interruptRunning() {
+    // Under mu_, so no solver is unregistered (and destroyed) meanwhile.
+    for (smt::ISolver *s: running_)
+      s->interrupt();
+  }
+
+  void Cancellation::cancel() {
+    std::lock_guard<std::mutex> lock(mu_);
+    cancelled_.store(true);
+    interruptRunning();
+    for (Cancellation *child: children_)
+      child->cancel();
+  }
+
+  void Cancellation::drain() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!running_.empty()) {
+      interruptRunning();
+      idle_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    for (Cancellation *child: children_)
+      child->drain();
+  }
+
+  void Cancellation::cancelAt(Clock::time_point deadline) {
+    Watchdog::instance().watch(this, deadline);
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,27 @@
+#include "solver/model_pool.hpp"
+#include <algorithm>
+
+namespace symir::solver {
+
+  std::vector<ModelPool::Model> ModelPool::recent(const std::string &function) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = models_.find(function);
+    if (it == models_.end())
+      return {};
+    return {it->second.begin(), it->second.end()};
+  }
+
+  void ModelPool::add(const std::string &function, Model model) {
+    if (perFunction_ == 0)
+      return;
+    std::lock_guard<std::mutex> lock(mu_);
+    auto &models = models_[function];
+    auto dup = std::find(models.begin(), models.end(), model);
+    if (dup != models.end())
+      models.erase(dup);
+    models.push_front(std::move(model));
+    if (models.size() > perFunction_)
+      models.pop_back();
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,326 @@
+#include "solver/portfolio.hpp"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include "ast/symbol.hpp"
+#include "solver/cancel.hpp"
+
+namespace symir::solver {
+
+  PortfolioSolver::PortfolioSolver(std::vector<Member> members) : members_(std::move(members)) {
+    if (members_.empty())
+      throw std::runtime_error("PortfolioSolver: no backend solvers");
+    for (const auto &m: members_)
+      if (!m.solver)
+        throw std::runtime_error("PortfolioSolver: null backend solver " + m.name);
+    sorts_.resize(size());
+    terms_.resize(size());
+  }
+
+  const std::string &PortfolioSolver::winner() const {
+    static const std::string none;
+    return checked_ ? members_[winner_].name : none;
+  }
+
+  template<typename Make>
+  smt::Sort PortfolioSolver::makeSort(Make &&make) {
+    uint32_t id = static_cast<uint32_t>(sorts_.size() / size());
+    for (std::size_t i = 0; i < size(); ++i)
+      sorts_.push_back(make(*members_[i].solver, i));
+    return {id};
+  }
+
+  template<typename Make>
+  smt::Term PortfolioSolver::makeTerm(Make &&make) {
+    uint32_t id = static_cast<uint32_t>(terms_.size() / size());
+    for (std::size_t i = 0; i < size(); ++i)
+      terms_.push_back(make(*members_[i].solver, i));
+    return {id};
+  }
+
+  smt::Sort PortfolioSolver::memberSort(smt::Sort s, std::size_t i) const {
+    if (!s || s.id * size() >= sorts_.size())
+      throw std::runtime_error("Empty sort handle");
+    return sorts_[s.id * size() + i];
+  }
+
+  smt::Term PortfolioSolver::memberTerm(smt::Term t, std::size_t i) const {
+    if (!t || t.id * size() >= terms_.size())
+      throw std::runtime_error("Empty term handle");
+    return terms_[t.id * size() + i];
+  }
+
+  // --- Sorts ---
+
+  smt::Sort PortfolioSolver::make_bv_sort(uint32_t size) {
+    return makeSort([&](smt::ISolver &s, std::size_t) { return s.make_bv_sort(size); });
+  }
+
+  smt::Sort PortfolioSolver::make_fp_sort(uint32_t exp, uint32_t sig) {
+    return makeSort([&](smt::ISolver &s, std::size_t) { return s.make_fp_sort(exp, sig); });
+  }
+
+  smt::Sort PortfolioSolver::make_bool_sort() {
+    return makeSort([&](smt::ISolver &s, std::size_t) { return s.make_bool_sort(); });
+  }
+
+  smt::Sort PortfolioSolver::make_array_sort(smt::Sort index, smt::Sort elem) {
+    return makeSort([&](smt::ISolver &s, std::size_t i) {
+      return s.make_array_sort(memberSort(index, i), memberSort(elem, i));
+    });
+  }
+
+  // Sort and term inspection is answered by the first member; all members
+  // hold structurally identical terms.
+
+  bool PortfolioSolver::is_bv_sort(smt::Sort s) {
+    return members_[0].solver->is_bv_sort(memberSort(s, 0));
+  }
+
+  bool PortfolioSolver::is_fp_sort(smt::Sort s) {
+    return members_[0].solver->is_fp_sort(memberSort(s, 0));
+  }
+
+  bool PortfolioSolver::is_bool_sort(smt::Sort s) {
+    return members_[0].solver->is_bool_sort(memberSort(s, 0));
+  }
+
+  bool PortfolioSolver::is_array_sort(smt::Sort s) {
+    return members_[0].solver->is_array_sort(memberSort(s, 0));
+  }
+
+  uint32_t PortfolioSolver::get_bv_width(smt::Sort s) {
+    return members_[0].solver->get_bv_width(memberSort(s, 0));
+  }
+
+  std::pair<uint32_t, uint32_t> PortfolioSolver::get_fp_dims(smt::Sort s) {
+    return members_[0].solver->get_fp_dims(memberSort(s, 0));
+  }
+
+  // --- Terms ---
+
+  smt::Term PortfolioSolver::make_true() {
+    return makeTerm([&](smt::ISolver &s, std::size_t) { return s.make_true(); });
+  }
+
+  smt::Term PortfolioSolver::make_false() {
+    return makeTerm([&](smt::ISolver &s, std::size_t) { return s.make_false(); });
+  }
+
+  smt::Term PortfolioSolver::make_bv_value(smt::Sort s, const std::string &val, uint8_t base) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_bv_value(memberSort(s, i), val, base);
+    });
+  }
+
+  smt::Term PortfolioSolver::make_bv_value_uint64(smt::Sort s, uint64_t val) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_bv_value_uint64(memberSort(s, i), val);
+    });
+  }
+
+  smt::Term PortfolioSolver::make_bv_value_int64(smt::Sort s, int64_t val) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_bv_value_int64(memberSort(s, i), val);
+    });
+  }
+
+  smt::Term PortfolioSolver::make_bv_zero(smt::Sort s) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_bv_zero(memberSort(s, i));
+    });
+  }
+
+  smt::Term PortfolioSolver::make_bv_one(smt::Sort s) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) { return m.make_bv_one(memberSort(s, i)); }
+    );
+  }
+
+  smt::Term PortfolioSolver::make_bv_min_signed(smt::Sort s) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_bv_min_signed(memberSort(s, i));
+    });
+  }
+
+  smt::Term PortfolioSolver::make_bv_max_signed(smt::Sort s) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_bv_max_signed(memberSort(s, i));
+    });
+  }
+
+  smt::Term
+  PortfolioSolver::make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_fp_value(memberSort(s, i), val, rm);
+    });
+  }
+
+  smt::Term PortfolioSolver::make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_fp_value_from_real(memberSort(s, i), val, rm);
+    });
+  }
+
+  smt::Term PortfolioSolver::make_rm_value(smt::RoundingMode rm) {
+    return makeTerm([&](smt::ISolver &m, std::size_t) { return m.make_rm_value(rm); });
+  }
+
+  smt::Term PortfolioSolver::make_const_array(smt::Sort s, smt::Term val) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_const_array(memberSort(s, i), memberTerm(val, i));
+    });
+  }
+
+  smt::Term PortfolioSolver::make_const(smt::Sort s, const std::string &name) {
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      return m.make_const(memberSort(s, i), name);
+    });
+  }
+
+  smt::Term PortfolioSolver::make_term(
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+  ) {
+    std::vector<smt::Term> margs(args.size());
+    return makeTerm([&](smt::ISolver &m, std::size_t i) {
+      for (std::size_t a = 0; a < args.size(); ++a)
+        margs[a] = memberTerm(args[a], i);
+      return m.make_term(k, margs, indices);
+    });
+  }
+
+  smt::Sort PortfolioSolver::get_sort(smt::Term t) {
+    return makeSort([&](smt::ISolver &m, std::size_t i) { return m.get_sort(memberTerm(t, i)); });
+  }
+
+  bool PortfolioSolver::is_true(smt::Term t) {
+    return members_[0].solver->is_true(memberTerm(t, 0));
+  }
+
+  bool PortfolioSolver::is_false(smt::Term t) {
+    return members_[0].solver->is_false(memberTerm(t, 0));
+  }
+
+  // --- Solving ---
+
+  void PortfolioSolver::assert_formula(smt::Term t) {
+    for (std::size_t i = 0; i < size(); ++i)
+      members_[i].solver->assert_formula(memberTerm(t, i));
+  }
+
+  void PortfolioSolver::push(uint32_t levels) {
+    for (auto &m: members_)
+      m.solver->push(levels);
+  }
+
+  void PortfolioSolver::pop(uint32_t levels) {
+    for (auto &m: members_)
+      m.solver->pop(levels);
+  }
+
+  template<typename Check>
+  smt::Result PortfolioSolver::race(Check &&check) {
+    checked_ = true;
+    if (size() == 1) {
+      winner_ = 0;
+      return check(std::size_t(0));
+    }
+
+    std::mutex mu;
+    std::condition_variable cv;
+    std::size_t finished = 0;
+    std::optional<std::size_t> first;
+    std::vector<smt::Result> results(size(), smt::Result::UNKNOWN);
+    std::exception_ptr error;
+    Cancellation losers;
+
+    std::vector<std::thread> threads;
+    threads.reserve(size());
+    SymbolTable &symbols = SymbolTable::current();
+    for (std::size_t i = 0; i < size(); ++i) {
+      threads.emplace_back([&, i] {
+        SymbolTable::Scope scope(symbols);
+        smt::Result r = smt::Result::UNKNOWN;
+        std::exception_ptr e;
+        try {
+          r = losers.run(*members_[i].solver, [&] { return check(i); });
+        } catch (...) {
+          e = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mu);
+        results[i] = r;
+        if (e && !error)
+          error = e;
+        if (r != smt::Result::UNKNOWN && !first)
+          first = i;
+        ++finished;
+        cv.notify_all();
+      });
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(mu);
+      cv.wait(lock, [&] { return first || finished == size(); });
+    }
+    // Only the losers are still checking; a loser yet to start does not.
+    losers.cancel();
+    losers.drain();
+    for (auto &t: threads)
+      t.join();
+
+    if (!first && error)
+      std::rethrow_exception(error);
+    winner_ = first.value_or(0);
+    return results[winner_];
+  }
+
+  smt::Result PortfolioSolver::check_sat() {
+    return race([&](std::size_t i) { return members_[i].solver->check_sat(); });
+  }
+
+  smt::Result PortfolioSolver::check_sat_assuming(const std::vector<smt::Term> &assumptions) {
+    assumptions_ = assumptions;
+    std::vector<std::vector<smt::Term>> massumptions(size());
+    for (std::size_t i = 0; i < size(); ++i)
+      for (const auto &a: assumptions)
+        massumptions[i].push_back(memberTerm(a, i));
+    return race([&](std::size_t i) {
+      return members_[i].solver->check_sat_assuming(massumptions[i]);
+    });
+  }
+
+  std::vector<smt::Term> PortfolioSolver::get_unsat_assumptions() {
+    std::vector<smt::Term> core;
+    for (const auto &c: members_[winner_].solver->get_unsat_assumptions())
+      for (const auto &a: assumptions_)
+        if (memberTerm(a, winner_) == c) {
+          core.push_back(a);
+          break;
+        }
+    return core;
+  }
+
+  void PortfolioSolver::interrupt() {
+    for (auto &m: members_)
+      m.solver->interrupt();
+  }
+
+  // --- Model (from the last winner) ---
+
+  smt::Term PortfolioSolver::get_value(smt::Term t) {
+    smt::Term v = members_[winner_].solver->get_value(memberTerm(t, winner_));
+    // Only the winner has a model; the other members' slots stay empty.
+    return makeTerm([&](smt::ISolver &, std::size_t i) { return i == winner_ ? v : smt::Term{}; });
+  }
+
+  std::string PortfolioSolver::get_bv_value_string(smt::Term t, uint8_t base) {
+    return members_[winner_].solver->get_bv_value_string(memberTerm(t, winner_), base);
+  }
+
+  std::string PortfolioSolver::get_fp_value_string(smt::Term t) {
+    return members_[winner_].solver->get_fp_value_string(memberTerm(t, winner_));
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,203 @@
+#include "solver/query_cache.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace symir::solver {
+
+  namespace {
+
+    constexpr char kFileMagic[8] = {'S', 'Y', 'M', 'I', 'R', 'Q', 'C', '1'};
+    constexpr uint32_t kRecordMagic = 0x52514353; // "SCQR"
+
+    // Record: magic, payload length, then the payload
+    //   lo, hi (u64), sat (u8), n (u32), n x {constIndex (u32), isFloat (u8), bits (u64)}
+    constexpr std::size_t kRecordHeader = 8;
+    constexpr std::size_t kPayloadFixed = 8 + 8 + 1 + 4;
+    constexpr std::size_t kValueBytes = 4 + 1 + 8;
+
+    uint64_t mix64(uint64_t x) {
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9ull;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111ebull;
+      x ^= x >> 31;
+      return x;
+    }
+
+    template<typename T>
+    void put(std::string &out, T v) {
+      char buf[sizeof(T)];
+      std::memcpy(buf, &v, sizeof(T));
+      out.append(buf, sizeof(T));
+    }
+
+    template<typename T>
+    T get(const unsigned char *p) {
+      T v;
+      std::memcpy(&v, p, sizeof(T));
+      return v;
+    }
+
+    // flock() for the lifetime of the guard.
+    struct FileLock {
+      int fd;
+
+      FileLock(int fd, int op) : fd(fd) { ::flock(fd, op); }
+
+      ~FileLock() { ::flock(fd, LOCK_UN); }
+    };
+
+  } // namespace
+
+  QueryCache::QueryCache(const std::string &dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    path_ = (std::filesystem::path(dir) / "queries.bin").string();
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+      throw std::runtime_error("Cannot open query cache " + path_ + ": " + std::strerror(errno));
+
+    FileLock lock(fd_, LOCK_EX);
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+      ::close(fd_);
+      throw std::runtime_error("Cannot stat query cache " + path_);
+    }
+    if (st.st_size == 0) {
+      if (::pwrite(fd_, kFileMagic, sizeof(kFileMagic), 0) != sizeof(kFileMagic)) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot initialize query cache " + path_);
+      }
+    } else {
+      char magic[sizeof(kFileMagic)] = {};
+      if (::pread(fd_, magic, sizeof(magic), 0) != sizeof(magic) ||
+          std::memcmp(magic, kFileMagic, sizeof(magic)) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Not a query cache file: " + path_);
+      }
+    }
+    loaded_ = sizeof(kFileMagic);
+    uint64_t end = loadTail();
+    // Writers hold the lock for the whole append, so anything past the last
+    // complete record was torn by a crash.
+    if (::fstat(fd_, &st) == 0 && uint64_t(st.st_size) > end &&
+        ::ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+      ::close(fd_);
+      throw std::runtime_error("Cannot repair query cache " + path_);
+    }
+  }
+
+  QueryCache::~QueryCache() {
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  QueryCache::Key QueryCache::keyOf(std::string_view text) {
+    // Two independent 64-bit hashes: FNV-1a and a word-wise multiply-mix.
+    uint64_t lo = 0xcbf29ce484222325ull;
+    for (unsigned char c: text) {
+      lo ^= c;
+      lo *= 0x100000001b3ull;
+    }
+    uint64_t hi = 0x9e3779b97f4a7c15ull ^ text.size();
+    std::size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8)
+      hi = mix64(hi ^ get<uint64_t>(reinterpret_cast<const unsigned char *>(text.data() + i)));
+    uint64_t rest = 0;
+    std::memcpy(&rest, text.data() + i, text.size() - i);
+    hi = mix64(hi ^ rest);
+    return {mix64(lo), hi};
+  }
+
+  uint64_t QueryCache::loadTail() {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || uint64_t(st.st_size) <= loaded_)
+      return loaded_;
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+      return loaded_;
+    const auto *base = static_cast<const unsigned char *>(map);
+
+    uint64_t off = loaded_;
+    while (off + kRecordHeader <= size) {
+      const unsigned char *p = base + off;
+      uint32_t len = get<uint32_t>(p + 4);
+      if (get<uint32_t>(p) != kRecordMagic || len < kPayloadFixed ||
+          off + kRecordHeader + len > size)
+        break;
+      p += kRecordHeader;
+      Key key{get<uint64_t>(p), get<uint64_t>(p + 8)};
+      Entry entry;
+      entry.sat = p[16] != 0;
+      uint32_t n = get<uint32_t>(p + 17);
+      if (kPayloadFixed + std::size_t(n) * kValueBytes != len)
+        break;
+      p += kPayloadFixed;
+      entry.model.resize(n);
+      for (auto &v: entry.model) {
+        v.constIndex = get<uint32_t>(p);
+        v.isFloat = p[4] != 0;
+        v.bits = get<uint64_t>(p + 5);
+        p += kValueBytes;
+      }
+      entries_.emplace(key, std::move(entry));
+      off += kRecordHeader + len;
+    }
+    ::munmap(map, size);
+    loaded_ = off;
+    return off;
+  }
+
+  std::optional<QueryCache::Entry> QueryCache::lookup(const Key &key) {
+    std::lock_guard<std::mutex> guard(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      // Another process may have answered it since we last looked.
+      FileLock lock(fd_, LOCK_SH);
+      loadTail();
+      it = entries_.find(key);
+    }
+    if (it == entries_.end()) {
+      ++misses_;
+      return std::nullopt;
+    }
+    ++hits_;
+    return it->second;
+  }
+
+  void QueryCache::insert(const Key &key, const Entry &entry) {
+    std::string rec;
+    rec.reserve(kRecordHeader + kPayloadFixed + entry.model.size() * kValueBytes);
+    put<uint32_t>(rec, kRecordMagic);
+    put<uint32_t>(rec, static_cast<uint32_t>(kPayloadFixed + entry.model.size() * kValueBytes));
+    put<uint64_t>(rec, key.lo);
+    put<uint64_t>(rec, key.hi);
+    put<uint8_t>(rec, entry.sat ? 1 : 0);
+    put<uint32_t>(rec, static_cast<uint32_t>(entry.model.size()));
+    for (const auto &v: entry.model) {
+      put<uint32_t>(rec, v.constIndex);
+      put<uint8_t>(rec, v.isFloat ? 1 : 0);
+      put<uint64_t>(rec, v.bits);
+    }
+
+    std::lock_guard<std::mutex> guard(mu_);
+    FileLock lock(fd_, LOCK_EX);
+    uint64_t end = loadTail();
+    if (entries_.count(key))
+      return;
+    if (::pwrite(fd_, rec.data(), rec.size(), static_cast<off_t>(end)) !=
+        static_cast<ssize_t>(rec.size()))
+      return; // best effort: a failed append only costs a future miss
+    loaded_ = end + rec.size();
+    entries_.emplace(key, entry);
+    ++stores_;
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,1161 @@
+#include "solver/smt2.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace symir::solver {
+
+  namespace {
+
+    using K = smt::Kind;
+
+    // --- Bit strings (MSB first) ---
+
+    std::string toBits(uint64_t v, uint32_t width, bool signExtend) {
+      std::string bits(width, '0');
+      for (uint32_t i = 0; i < width; ++i) {
+        bool bit = i < 64 ? (v >> i) & 1 : signExtend && (v >> 63);
+        bits[width - 1 - i] = bit ? '1' : '0';
+      }
+      return bits;
+    }
+
+    // `digits` (decimal, optionally negative) modulo 2^width.
+    std::string decimalToBits(const std::string &digits, uint32_t width) {
+      bool neg = !digits.empty() && digits[0] == '-';
+      std::string num = digits.substr(neg ? 1 : 0);
+      if (num.empty() || !std::all_of(num.begin(), num.end(), ::isdigit))
+        throw std::runtime_error("SMT-LIB2: bad decimal literal " + digits);
+      std::string bits(width, '0');
+      for (uint32_t i = 0; i < width; ++i) {
+        // Halve `num`; the remainder is bit i.
+        int rem = 0;
+        std::string half;
+        for (char c: num) {
+          int cur = rem * 10 + (c - '0');
+          if (!half.empty() || cur / 2)
+            half += static_cast<char>('0' + cur / 2);
+          rem = cur % 2;
+        }
+        bits[width - 1 - i] = rem ? '1' : '0';
+        num = half.empty() ? "0" : half;
+      }
+      if (neg) {
+        for (auto &b: bits)
+          b = b == '1' ? '0' : '1';
+        for (std::size_t i = bits.size(); i-- > 0;) {
+          bool carry = bits[i] == '1';
+          bits[i] = carry ? '0' : '1';
+          if (!carry)
+            break;
+        }
+      }
+      return bits;
+    }
+
+    std::string hexToBits(const std::string &hex) {
+      std::string bits;
+      for (char c: hex) {
+        int v = std::isdigit(c) ? c - '0' : (std::tolower(c) - 'a' + 10);
+        if (v < 0 || v > 15)
+          throw std::runtime_error("SMT-LIB2: bad hex literal " + hex);
+        for (int i = 3; i >= 0; --i)
+          bits += (v >> i) & 1 ? '1' : '0';
+      }
+      return bits;
+    }
+
+    std::string bitsToDecimal(const std::string &bits) {
+      std::string dec = "0"; // least significant digit first
+      for (char b: bits) {
+        int carry = b == '1';
+        for (auto &d: dec) {
+          int v = (d - '0') * 2 + carry;
+          d = static_cast<char>('0' + v % 10);
+          carry = v / 10;
+        }
+        if (carry)
+          dec += static_cast<char>('0' + carry);
+      }
+      std::reverse(dec.begin(), dec.end());
+      return dec;
+    }
+
+    std::string bitsToHex(const std::string &bits) {
+      std::string padded(std::string((4 - bits.size() % 4) % 4, '0') + bits), hex;
+      for (std::size_t i = 0; i < padded.size(); i += 4)
+        hex += "0123456789abcdef"[std::stoi(padded.substr(i, 4), nullptr, 2)];
+      return hex;
+    }
+
+    uint64_t doubleBits(double d) {
+      uint64_t u;
+      std::memcpy(&u, &d, sizeof(u));
+      return u;
+    }
+
+    // `(fp sign exp sig)` of a float with `exp` exponent and `sig`
+    // significand bits (incl. the hidden one).
+    std::string fpText(const std::string &bits, uint32_t exp) {
+      return "(fp #b" + bits.substr(0, 1) + " #b" + bits.substr(1, exp) + " #b" +
+             bits.substr(1 + exp) + ")";
+    }
+
+    // The value of a float given by its bits (exp <= 11, sig <= 53).
+    double bitsToDouble(const std::string &bits, uint32_t exp, uint32_t sig) {
+      bool neg = bits[0] == '1';
+      uint64_t e = std::stoull(bits.substr(1, exp), nullptr, 2);
+      uint64_t m = sig > 1 ? std::stoull(bits.substr(1 + exp), nullptr, 2) : 0;
+      int64_t bias = (int64_t(1) << (exp - 1)) - 1;
+      double d;
+      if (e == (uint64_t(1) << exp) - 1)
+        d = m ? std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::infinity();
+      else if (e == 0)
+        d = std::ldexp(static_cast<double>(m), static_cast<int>(1 - bias - (sig - 1)));
+      else
+        d = std::ldexp(
+            static_cast<double>(m + (uint64_t(1) << (sig - 1))),
+            static_cast<int>(static_cast<int64_t>(e) - bias - (sig - 1))
+        );
+      return neg ? -d : d;
+    }
+
+    const char *rmText(smt::RoundingMode rm) {
+      switch (rm) {
+        case smt::RoundingMode::RNE:
+          return "RNE";
+        case smt::RoundingMode::RNA:
+          return "RNA";
+        case smt::RoundingMode::RTP:
+          return "RTP";
+        case smt::RoundingMode::RTN:
+          return "RTN";
+        case smt::RoundingMode::RTZ:
+          return "RTZ";
+      }
+      return "RNE";
+    }
+
+    // SMT-LIB2 names of the kinds without indices.
+    const std::vector<std::pair<K, const char *>> &opNames() {
+      static const std::vector<std::pair<K, const char *>> names = {
+          {K::BV_ADD, "bvadd"},
+          {K::BV_SUB, "bvsub"},
+          {K::BV_MUL, "bvmul"},
+          {K::BV_SDIV, "bvsdiv"},
+          {K::BV_UDIV, "bvudiv"},
+          {K::BV_SREM, "bvsrem"},
+          {K::BV_UREM, "bvurem"},
+          {K::BV_AND, "bvand"},
+          {K::BV_OR, "bvor"},
+          {K::BV_XOR, "bvxor"},
+          {K::BV_NOT, "bvnot"},
+          {K::BV_SHL, "bvshl"},
+          {K::BV_ASHR, "bvashr"},
+          {K::BV_SHR, "bvlshr"},
+          {K::BV_NEG, "bvneg"},
+          {K::BV_SLT, "bvslt"},
+          {K::BV_SLE, "bvsle"},
+          {K::BV_SGT, "bvsgt"},
+          {K::BV_SGE, "bvsge"},
+          {K::BV_ULT, "bvult"},
+          {K::BV_ULE, "bvule"},
+          {K::BV_UGT, "bvugt"},
+          {K::BV_UGE, "bvuge"},
+          {K::EQUAL, "="},
+          {K::DISTINCT, "distinct"},
+          {K::ITE, "ite"},
+          {K::AND, "and"},
+          {K::OR, "or"},
+          {K::NOT, "not"},
+          {K::IMPLIES, "=>"},
+          {K::FP_ADD, "fp.add"},
+          {K::FP_SUB, "fp.sub"},
+          {K::FP_MUL, "fp.mul"},
+          {K::FP_DIV, "fp.div"},
+          {K::FP_REM, "fp.rem"},
+          {K::FP_SQRT, "fp.sqrt"},
+          {K::FP_RTI, "fp.roundToIntegral"},
+          {K::FP_MIN, "fp.min"},
+          {K::FP_MAX, "fp.max"},
+          {K::FP_EQUAL, "fp.eq"},
+          {K::FP_LT, "fp.lt"},
+          {K::FP_LEQ, "fp.leq"},
+          {K::FP_GT, "fp.gt"},
+          {K::FP_GEQ, "fp.geq"},
+          {K::FP_IS_INF, "fp.isInfinite"},
+          {K::FP_IS_NAN, "fp.isNaN"},
+          {K::BV_CONCAT, "concat"},
+          {K::BV_SADD_OVERFLOW, "bvsaddo"},
+          {K::BV_SSUB_OVERFLOW, "bvssubo"},
+          {K::BV_SMUL_OVERFLOW, "bvsmulo"},
+          {K::ARRAY_SELECT, "select"},
+          {K::ARRAY_STORE, "store"},
+      };
+      return names;
+    }
+
+    // Kinds whose first operand is a rounding mode (RNE if left out).
+    bool takesRM(K k) {
+      switch (k) {
+        case K::FP_ADD:
+        case K::FP_SUB:
+        case K::FP_MUL:
+        case K::FP_DIV:
+        case K::FP_SQRT:
+        case K::FP_RTI:
+        case K::FP_TO_SBV:
+        case K::FP_TO_UBV:
+        case K::FP_TO_FP_FROM_FP:
+        case K::FP_TO_FP_FROM_SBV:
+        case K::FP_TO_FP_FROM_UBV:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    bool isPredicate(K k) {
+      switch (k) {
+        case K::BV_SLT:
+        case K::BV_SLE:
+        case K::BV_SGT:
+        case K::BV_SGE:
+        case K::BV_ULT:
+        case K::BV_ULE:
+        case K::BV_UGT:
+        case K::BV_UGE:
+        case K::EQUAL:
+        case K::DISTINCT:
+        case K::AND:
+        case K::OR:
+        case K::NOT:
+        case K::IMPLIES:
+        case K::FP_EQUAL:
+        case K::FP_LT:
+        case K::FP_LEQ:
+        case K::FP_GT:
+        case K::FP_GEQ:
+        case K::FP_IS_INF:
+        case K::FP_IS_NAN:
+        case K::BV_SADD_OVERFLOW:
+        case K::BV_SSUB_OVERFLOW:
+        case K::BV_SMUL_OVERFLOW:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    // A quoted symbol for `name`, unique through `id`.
+    std::string constSymbol(const std::string &name, uint32_t id) {
+      std::string sym = "|";
+      for (char c: name)
+        sym += c == '|' || c == '\\' ? '_' : c;
+      return sym + "!" + std::to_string(id) + "|";
+    }
+
+    std::string unquote(const std::string &sym) {
+      if (sym.size() >= 2 && sym.front() == '|' && sym.back() == '|')
+        return sym.substr(1, sym.size() - 2);
+      return sym;
+    }
+
+    // --- S-expressions ---
+
+    struct SExpr {
+      std::string atom; // empty for lists
+      std::vector<SExpr> list;
+
+      bool isAtom() const { return !atom.empty(); }
+    };
+
+    class SExprParser {
+    public:
+      explicit SExprParser(const std::string &text) : text_(text) {}
+
+      // False at the end of the text.
+      bool next(SExpr &out) {
+        skip();
+        if (pos_ >= text_.size())
+          return false;
+        out = parse();
+        return true;
+      }
+
+    private:
+      void skip() {
+        while (pos_ < text_.size()) {
+          if (std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+          } else if (text_[pos_] == ';') {
+            while (pos_ < text_.size() && text_[pos_] != '\n')
+              ++pos_;
+          } else {
+            break;
+          }
+        }
+      }
+
+      SExpr parse() {
+        SExpr e;
+        char c = text_[pos_];
+        if (c == ')')
+          throw std::runtime_error("SMT-LIB2: unexpected ')'");
+        if (c == '(') {
+          ++pos_;
+          for (;;) {
+            skip();
+            if (pos_ >= text_.size())
+              throw std::runtime_error("SMT-LIB2: missing ')'");
+            if (text_[pos_] == ')') {
+              ++pos_;
+              return e;
+            }
+            e.list.push_back(parse());
+          }
+        }
+        std::size_t start = pos_;
+        if (c == '|' || c == '"') {
+          for (++pos_; pos_ < text_.size(); ++pos_) {
+            if (text_[pos_] != c)
+              continue;
+            if (c == '"' && pos_ + 1 < text_.size() && text_[pos_ + 1] == '"') {
+              ++pos_; // "" inside a string
+              continue;
+            }
+            break;
+          }
+          if (pos_ >= text_.size())
+            throw std::runtime_error("SMT-LIB2: unterminated literal");
+          ++pos_;
+        } else {
+          while (pos_ < text_.size() && !std::isspace(static_cast<unsigned char>(text_[pos_])) &&
+                 text_[pos_] != '(' && text_[pos_] != ')' && text_[pos_] != ';')
+            ++pos_;
+        }
+        e.atom = text_.substr(start, pos_ - start);
+        return e;
+      }
+
+      const std::string &text_;
+      std::size_t pos_ = 0;
+    };
+
+    std::string write(const SExpr &e) {
+      if (e.isAtom())
+        return e.atom;
+      std::string out = "(";
+      for (std::size_t i = 0; i < e.list.size(); ++i)
+        out += (i ? " " : "") + write(e.list[i]);
+      return out + ")";
+    }
+
+    bool isAtom(const SExpr &e, const char *atom) { return e.isAtom() && e.atom == atom; }
+
+    uint32_t numeral(const SExpr &e) {
+      if (!e.isAtom() || !std::all_of(e.atom.begin(), e.atom.end(), ::isdigit))
+        throw std::runtime_error("SMT-LIB2: expected a numeral, got " + write(e));
+      return static_cast<uint32_t>(std::stoul(e.atom));
+    }
+
+    // Bits of a BV literal (#b, #x or (_ bvN w)); empty if `e` is none.
+    std::string bvLiteralBits(const SExpr &e) {
+      if (e.isAtom() && e.atom.size() > 2 && e.atom[0] == '#') {
+        if (e.atom[1] == 'b')
+          return e.atom.substr(2);
+        if (e.atom[1] == 'x')
+          return hexToBits(e.atom.substr(2));
+      }
+      if (e.list.size() == 3 && isAtom(e.list[0], "_") && e.list[1].isAtom() &&
+          e.list[1].atom.rfind("bv", 0) == 0)
+        return decimalToBits(e.list[1].atom.substr(2), numeral(e.list[2]));
+      return {};
+    }
+
+    // Bits of a Bool, BV or FP value literal. Throws if `e` is none.
+    std::string valueBits(const SExpr &e) {
+      if (isAtom(e, "true"))
+        return "1";
+      if (isAtom(e, "false"))
+        return "0";
+      if (auto bits = bvLiteralBits(e); !bits.empty())
+        return bits;
+      if (e.list.size() == 4 && isAtom(e.list[0], "fp")) {
+        std::string bits;
+        for (std::size_t i = 1; i < 4; ++i) {
+          auto part = bvLiteralBits(e.list[i]);
+          if (part.empty())
+            throw std::runtime_error("SMT-LIB2: bad fp literal " + write(e));
+          bits += part;
+        }
+        return bits;
+      }
+      if (e.list.size() == 4 && isAtom(e.list[0], "_") && e.list[1].isAtom()) {
+        uint32_t exp = numeral(e.list[2]), sig = numeral(e.list[3]);
+        const std::string &name = e.list[1].atom;
+        std::string ones(exp, '1'), zeros(sig - 1, '0');
+        if (name == "+zero" || name == "-zero")
+          return (name[0] == '-' ? "1" : "0") + std::string(exp, '0') + zeros;
+        if (name == "+oo" || name == "-oo")
+          return (name[0] == '-' ? "1" : "0") + ones + zeros;
+        if (name == "NaN")
+          return "0" + ones + "1" + std::string(sig - 2, '0');
+      }
+      throw std::runtime_error("SMT-LIB2: not a value literal: " + write(e));
+    }
+
+    // --- Reading scripts into a backend ---
+
+    class Reader {
+    public:
+      explicit Reader(smt::ISolver &backend) : s_(backend) {}
+
+      Smt2Answer run(const std::string &script) {
+        SExprParser parser(script);
+        SExpr cmd;
+        while (parser.next(cmd))
+          command(cmd);
+        return answer_;
+      }
+
+    private:
+      void command(const SExpr &cmd) {
+        if (cmd.list.empty() || !cmd.list[0].isAtom())
+          throw std::runtime_error("SMT-LIB2: bad command " + write(cmd));
+        const std::string &name = cmd.list[0].atom;
+        auto arg = [&](std::size_t i) -> const SExpr & {
+          if (i >= cmd.list.size())
+            throw std::runtime_error("SMT-LIB2: missing argument in " + write(cmd));
+          return cmd.list[i];
+        };
+
+        if (name == "set-logic" || name == "set-option" || name == "set-info" ||
+            name == "exit" || name == "get-model") {
+          return;
+        } else if (name == "declare-const" || name == "declare-fun") {
+          const SExpr &sortExpr = arg(name == "declare-fun" ? 3 : 2);
+          if (name == "declare-fun" && !arg(2).list.empty())
+            throw std::runtime_error("SMT-LIB2: functions with parameters are not supported");
+          std::string sym = unquote(arg(1).atom);
+          env_[sym] = s_.make_const(sort(sortExpr), sym);
+        } else if (name == "define-fun") {
+          if (!arg(2).list.empty())
+            throw std::runtime_error("SMT-LIB2: functions with parameters are not supported");
+          env_[unquote(arg(1).atom)] = term(arg(4));
+        } else if (name == "assert") {
+          s_.assert_formula(term(arg(1)));
+        } else if (name == "push" || name == "pop") {
+          uint32_t n = cmd.list.size() > 1 ? numeral(arg(1)) : 1;
+          name == "push" ? s_.push(n) : s_.pop(n);
+        } else if (name == "check-sat") {
+          assumptions_.clear();
+          verdict(s_.check_sat());
+        } else if (name == "check-sat-assuming") {
+          assumptions_.clear();
+          std::vector<smt::Term> terms;
+          for (const auto &a: arg(1).list) {
+            terms.push_back(term(a));
+            assumptions_.emplace_back(write(a), terms.back());
+          }
+          verdict(s_.check_sat_assuming(terms));
+        } else if (name == "get-value") {
+          if (answer_.result != smt::Result::SAT)
+            return;
+          for (const auto &e: arg(1).list)
+            answer_.values[e.isAtom() ? unquote(e.atom) : write(e)] = value(term(e));
+        } else if (name == "get-unsat-assumptions") {
+          if (answer_.result != smt::Result::UNSAT || assumptions_.empty())
+            return;
+          for (auto t: s_.get_unsat_assumptions())
+            for (const auto &[text, a]: assumptions_)
+              if (a == t) {
+                answer_.unsatAssumptions.push_back(text);
+                break;
+              }
+        } else {
+          throw std::runtime_error("SMT-LIB2: unsupported command " + name);
+        }
+      }
+
+      void verdict(smt::Result r) {
+        answer_ = {};
+        answer_.result = r;
+      }
+
+      smt::Sort sort(const SExpr &e) {
+        if (isAtom(e, "Bool"))
+          return s_.make_bool_sort();
+        if (isAtom(e, "Float16"))
+          return s_.make_fp_sort(5, 11);
+        if (isAtom(e, "Float32"))
+          return s_.make_fp_sort(8, 24);
+        if (isAtom(e, "Float64"))
+          return s_.make_fp_sort(11, 53);
+        if (e.list.size() == 3 && isAtom(e.list[0], "_") && isAtom(e.list[1], "BitVec"))
+          return s_.make_bv_sort(numeral(e.list[2]));
+        if (e.list.size() == 4 && isAtom(e.list[0], "_") && isAtom(e.list[1], "FloatingPoint"))
+          return s_.make_fp_sort(numeral(e.list[2]), numeral(e.list[3]));
+        if (e.list.size() == 3 && isAtom(e.list[0], "Array"))
+          return s_.make_array_sort(sort(e.list[1]), sort(e.list[2]));
+        throw std::runtime_error("SMT-LIB2: unsupported sort " + write(e));
+      }
+
+      static std::optional<smt::RoundingMode> roundingMode(const SExpr &e) {
+        static const std::vector<std::pair<const char *, smt::RoundingMode>> names = {
+            {"RNE", smt::RoundingMode::RNE},
+            {"roundNearestTiesToEven", smt::RoundingMode::RNE},
+            {"RNA", smt::RoundingMode::RNA},
+            {"roundNearestTiesToAway", smt::RoundingMode::RNA},
+            {"RTP", smt::RoundingMode::RTP},
+            {"roundTowardPositive", smt::RoundingMode::RTP},
+            {"RTN", smt::RoundingMode::RTN},
+            {"roundTowardNegative", smt::RoundingMode::RTN},
+            {"RTZ", smt::RoundingMode::RTZ},
+            {"roundTowardZero", smt::RoundingMode::RTZ},
+        };
+        if (e.isAtom())
+          for (const auto &[name, rm]: names)
+            if (e.atom == name)
+              return rm;
+        return std::nullopt;
+      }
+
+      // A real literal `1.5` or `(- 1.5)`, as make_fp_value() takes it.
+      static std::optional<std::string> realLiteral(const SExpr &e) {
+        auto isReal = [](const SExpr &a) {
+          return a.isAtom() && std::isdigit(static_cast<unsigned char>(a.atom[0]));
+        };
+        if (isReal(e))
+          return e.atom;
+        if (e.list.size() == 2 && isAtom(e.list[0], "-") && isReal(e.list[1]))
+          return "-" + e.list[1].atom;
+        return std::nullopt;
+      }
+
+      smt::Term term(const SExpr &e) {
+        if (e.isAtom()) {
+          if (e.atom == "true")
+            return s_.make_true();
+          if (e.atom == "false")
+            return s_.make_false();
+          if (auto rm = roundingMode(e))
+            return s_.make_rm_value(*rm);
+          if (auto bits = bvLiteralBits(e); !bits.empty())
+            return bv(bits);
+          auto it = env_.find(unquote(e.atom));
+          if (it == env_.end())
+            throw std::runtime_error("SMT-LIB2: unknown symbol " + e.atom);
+          return it->second;
+        }
+        if (e.list.empty())
+          throw std::runtime_error("SMT-LIB2: empty term");
+
+        const SExpr &head = e.list[0];
+        if (isAtom(head, "_")) {
+          if (auto bits = bvLiteralBits(e); !bits.empty())
+            return bv(bits);
+          uint32_t exp = numeral(e.list.at(2)), sig = numeral(e.list.at(3));
+          return fpLiteral(s_.make_fp_sort(exp, sig), valueBits(e), exp, sig);
+        }
+        if (isAtom(head, "fp")) {
+          uint32_t exp = static_cast<uint32_t>(bvLiteralBits(e.list.at(2)).size());
+          uint32_t sig = static_cast<uint32_t>(bvLiteralBits(e.list.at(3)).size()) + 1;
+          return fpLiteral(s_.make_fp_sort(exp, sig), valueBits(e), exp, sig);
+        }
+        if (head.list.size() == 3 && isAtom(head.list[0], "as") &&
+            isAtom(head.list[1], "const"))
+          return s_.make_const_array(sort(head.list[2]), term(e.list.at(1)));
+        if (!head.isAtom() && head.list.size() >= 2 && isAtom(head.list[0], "_"))
+          return indexed(head, e);
+
+        std::vector<smt::Term> args;
+        for (std::size_t i = 1; i < e.list.size(); ++i)
+          args.push_back(term(e.list[i]));
+        auto &names = opNames();
+        auto op = std::find_if(names.begin(), names.end(), [&](const auto &n) {
+          return head.isAtom() && head.atom == n.second;
+        });
+        if (op == names.end())
+          throw std::runtime_error("SMT-LIB2: unsupported operator " + write(head));
+        // Backends take AND and OR with two operands.
+        if ((op->first == K::AND || op->first == K::OR) && args.size() > 2) {
+          smt::Term acc = args[0];
+          for (std::size_t i = 1; i < args.size(); ++i)
+            acc = s_.make_term(op->first, {acc, args[i]});
+          return acc;
+        }
+        return s_.make_term(op->first, std::span<const smt::Term>(args));
+      }
+
+      smt::Term indexed(const SExpr &head, const SExpr &e) {
+        const std::string &name = head.list[1].atom;
+        std::vector<uint32_t> indices;
+        for (std::size_t i = 2; i < head.list.size(); ++i)
+          indices.push_back(numeral(head.list[i]));
+
+        if ((name == "to_fp" || name == "to_fp_unsigned") && indices.size() == 2 &&
+            e.list.size() == 3) {
+          auto rm = roundingMode(e.list[1]);
+          if (!rm)
+            throw std::runtime_error("SMT-LIB2: to_fp needs a rounding mode: " + write(e));
+          smt::Sort target = s_.make_fp_sort(indices[0], indices[1]);
+          if (auto real = realLiteral(e.list[2]))
+            return s_.make_fp_value(target, *real, *rm);
+          smt::Term x = term(e.list[2]);
+          if (auto lit = fpLits_.find(x.id); lit != fpLits_.end())
+            return s_.make_fp_value_from_real(target, lit->second, *rm);
+          K k = name == "to_fp_unsigned"                 ? K::FP_TO_FP_FROM_UBV
+                : s_.is_bv_sort(s_.get_sort(x)) ? K::FP_TO_FP_FROM_SBV
+                                                : K::FP_TO_FP_FROM_FP;
+          return s_.make_term(k, {s_.make_rm_value(*rm), x}, {indices[0], indices[1]});
+        }
+
+        static const std::vector<std::pair<const char *, K>> kinds = {
+            {"extract", K::BV_EXTRACT},     {"sign_extend", K::BV_SIGN_EXTEND},
+            {"zero_extend", K::BV_ZERO_EXTEND}, {"fp.to_sbv", K::FP_TO_SBV},
+            {"fp.to_ubv", K::FP_TO_UBV},
+        };
+        auto it = std::find_if(kinds.begin(), kinds.end(), [&](const auto &p) {
+          return name == p.first;
+        });
+        if (it == kinds.end())
+          throw std::runtime_error("SMT-LIB2: unsupported operator " + write(head));
+        std::vector<smt::Term> args;
+        for (std::size_t i = 1; i < e.list.size(); ++i)
+          args.push_back(term(e.list[i]));
+        return s_.make_term(
+            it->second, std::span<const smt::Term>(args), std::span<const uint32_t>(indices)
+        );
+      }
+
+      // Backends parse decimal literals most reliably.
+      smt::Term bv(const std::string &bits) {
+        return s_.make_bv_value(
+            s_.make_bv_sort(static_cast<uint32_t>(bits.size())), bitsToDecimal(bits), 10
+        );
+      }
+
+      smt::Term fpLiteral(smt::Sort s, const std::string &bits, uint32_t exp, uint32_t sig) {
+        if (exp > 11 || sig > 53 || bits.size() != exp + sig)
+          throw std::runtime_error("SMT-LIB2: unsupported float literal width");
+        double d = bitsToDouble(bits, exp, sig);
+        smt::Term t = s_.make_fp_value_from_real(s, d, smt::RoundingMode::RNE);
+        fpLits_[t.id] = d;
+        return t;
+      }
+
+      std::string value(smt::Term t) {
+        smt::Sort sort = s_.get_sort(t);
+        smt::Term v = s_.get_value(t);
+        if (s_.is_bool_sort(sort))
+          return s_.is_true(v) ? "true" : "false";
+        if (s_.is_bv_sort(sort)) {
+          std::string bits = s_.get_bv_value_string(v, 2);
+          uint32_t width = s_.get_bv_width(sort);
+          if (bits.size() < width)
+            bits.insert(0, width - bits.size(), '0');
+          return "#b" + bits;
+        }
+        if (s_.is_fp_sort(sort))
+          return fpText(s_.get_fp_value_string(v), s_.get_fp_dims(sort).first);
+        throw std::runtime_error("SMT-LIB2: get-value of an unsupported sort");
+      }
+
+      smt::ISolver &s_;
+      std::unordered_map<std::string, smt::Term> env_;
+      std::unordered_map<uint32_t, double> fpLits_; // float literal term -> value
+      std::vector<std::pair<std::string, smt::Term>> assumptions_;
+      Smt2Answer answer_;
+    };
+
+    const char *resultText(smt::Result r) {
+      switch (r) {
+        case smt::Result::SAT:
+          return "sat";
+        case smt::Result::UNSAT:
+          return "unsat";
+        case smt::Result::UNKNOWN:
+          return "unknown";
+      }
+      return "unknown";
+    }
+
+  } // namespace
+
+  std::string formatSmt2Answer(const Smt2Answer &answer) {
+    std::string out = resultText(answer.result);
+    out += '\n';
+    if (answer.result == smt::Result::SAT && !answer.values.empty()) {
+      std::map<std::string, std::string> sorted(answer.values.begin(), answer.values.end());
+      out += '(';
+      bool first = true;
+      for (const auto &[name, val]: sorted) {
+        out += (first ? "(|" : " (|") + name + "| " + val + ")";
+        first = false;
+      }
+      out += ")\n";
+    } else if (answer.result == smt::Result::UNSAT && !answer.unsatAssumptions.empty()) {
+      out += '(';
+      for (std::size_t i = 0; i < answer.unsatAssumptions.size(); ++i)
+        out += (i ? " " : "") + answer.unsatAssumptions[i];
+      out += ")\n";
+    }
+    return out;
+  }
+
+  Smt2Answer parseSmt2Answer(const std::string &text) {
+    SExprParser parser(text);
+    SExpr e;
+    std::optional<Smt2Answer> answer;
+    while (parser.next(e)) {
+      if (!answer) {
+        if (isAtom(e, "sat") || isAtom(e, "unsat") || isAtom(e, "unknown")) {
+          answer.emplace();
+          answer->result = e.atom == "sat"     ? smt::Result::SAT
+                           : e.atom == "unsat" ? smt::Result::UNSAT
+                                               : smt::Result::UNKNOWN;
+        }
+        continue;
+      }
+      if (e.isAtom() || (!e.list.empty() && isAtom(e.list[0], "error")))
+        continue;
+      if (answer->result == smt::Result::SAT) {
+        for (const auto &pair: e.list)
+          if (pair.list.size() == 2)
+            answer->values[unquote(write(pair.list[0]))] = write(pair.list[1]);
+      } else if (answer->result == smt::Result::UNSAT) {
+        for (const auto &a: e.list)
+          answer->unsatAssumptions.push_back(write(a));
+      }
+    }
+    if (!answer)
+      throw std::runtime_error("SMT-LIB2: answer has no verdict");
+    return *answer;
+  }
+
+  Smt2Answer runSmt2(const std::string &script, smt::ISolver &backend) {
+    return Reader(backend).run(script);
+  }
+
+  // --- Smt2Solver ---
+
+  Smt2Solver::Smt2Solver(Transport transport) : transport_(std::move(transport)) {}
+
+  smt::Sort Smt2Solver::sortOf(SortKind kind, uint32_t a, uint32_t b) {
+    auto key = std::make_tuple(static_cast<int>(kind), a, b);
+    auto it = sortIds_.find(key);
+    if (it != sortIds_.end())
+      return it->second;
+    sorts_.push_back({kind, a, b});
+    smt::Sort s{static_cast<uint32_t>(sorts_.size())};
+    sortIds_.emplace(key, s);
+    return s;
+  }
+
+  const Smt2Solver::SortInfo &Smt2Solver::info(smt::Sort s) const {
+    if (!s || s.id > sorts_.size())
+      throw std::runtime_error("Smt2Solver: invalid sort");
+    return sorts_[s.id - 1];
+  }
+
+  const Smt2Solver::Node &Smt2Solver::node(smt::Term t) const {
+    if (!t || t.id > nodes_.size())
+      throw std::runtime_error("Smt2Solver: invalid term");
+    return nodes_[t.id - 1];
+  }
+
+  std::string Smt2Solver::sortText(smt::Sort s) const {
+    const SortInfo &i = info(s);
+    switch (i.kind) {
+      case SortKind::Bool:
+        return "Bool";
+      case SortKind::BV:
+        return "(_ BitVec " + std::to_string(i.a) + ")";
+      case SortKind::FP:
+        return "(_ FloatingPoint " + std::to_string(i.a) + " " + std::to_string(i.b) + ")";
+      case SortKind::RM:
+        return "RoundingMode";
+      case SortKind::Array:
+        return "(Array " + sortText({i.a}) + " " + sortText({i.b}) + ")";
+    }
+    return "Bool";
+  }
+
+  smt::Sort Smt2Solver::make_bv_sort(uint32_t size) { return sortOf(SortKind::BV, size); }
+
+  smt::Sort Smt2Solver::make_fp_sort(uint32_t exp, uint32_t sig) {
+    return sortOf(SortKind::FP, exp, sig);
+  }
+
+  smt::Sort Smt2Solver::make_bool_sort() { return sortOf(SortKind::Bool); }
+
+  smt::Sort Smt2Solver::make_array_sort(smt::Sort index, smt::Sort elem) {
+    return sortOf(SortKind::Array, index.id, elem.id);
+  }
+
+  bool Smt2Solver::is_bv_sort(smt::Sort s) { return info(s).kind == SortKind::BV; }
+
+  bool Smt2Solver::is_fp_sort(smt::Sort s) { return info(s).kind == SortKind::FP; }
+
+  bool Smt2Solver::is_bool_sort(smt::Sort s) { return info(s).kind == SortKind::Bool; }
+
+  bool Smt2Solver::is_array_sort(smt::Sort s) { return info(s).kind == SortKind::Array; }
+
+  uint32_t Smt2Solver::get_bv_width(smt::Sort s) {
+    const SortInfo &i = info(s);
+    if (i.kind != SortKind::BV)
+      throw std::runtime_error("Smt2Solver: not a bit-vector sort");
+    return i.a;
+  }
+
+  std::pair<uint32_t, uint32_t> Smt2Solver::get_fp_dims(smt::Sort s) {
+    const SortInfo &i = info(s);
+    if (i.kind != SortKind::FP)
+      throw std::runtime_error("Smt2Solver: not a floating-point sort");
+    return {i.a, i.b};
+  }
+
+  smt::Term Smt2Solver::leaf(smt::Sort s, std::string text, std::string bits) {
+    Node n;
+    n.sort = s;
+    n.text = std::move(text);
+    n.bits = std::move(bits);
+    nodes_.push_back(std::move(n));
+    return {static_cast<uint32_t>(nodes_.size())};
+  }
+
+  smt::Term Smt2Solver::bvLiteral(smt::Sort s, std::string bits) {
+    std::string text = "#b" + bits;
+    return leaf(s, std::move(text), std::move(bits));
+  }
+
+  smt::Term Smt2Solver::make_true() {
+    if (!true_)
+      true_ = leaf(make_bool_sort(), "true", "1");
+    return true_;
+  }
+
+  smt::Term Smt2Solver::make_false() {
+    if (!false_)
+      false_ = leaf(make_bool_sort(), "false", "0");
+    return false_;
+  }
+
+  smt::Term Smt2Solver::make_bv_value(smt::Sort s, const std::string &val, uint8_t base) {
+    uint32_t width = get_bv_width(s);
+    std::string bits;
+    if (base == 2 || base == 16) {
+      bits = base == 2 ? val : hexToBits(val);
+      if (bits.size() > width)
+        bits = bits.substr(bits.size() - width);
+      else
+        bits.insert(0, width - bits.size(), '0');
+    } else {
+      bits = decimalToBits(val, width);
+    }
+    return bvLiteral(s, std::move(bits));
+  }
+
+  smt::Term Smt2Solver::make_bv_value_uint64(smt::Sort s, uint64_t val) {
+    return bvLiteral(s, toBits(val, get_bv_width(s), false));
+  }
+
+  smt::Term Smt2Solver::make_bv_value_int64(smt::Sort s, int64_t val) {
+    return bvLiteral(s, toBits(static_cast<uint64_t>(val), get_bv_width(s), true));
+  }
+
+  smt::Term Smt2Solver::make_bv_zero(smt::Sort s) {
+    return bvLiteral(s, std::string(get_bv_width(s), '0'));
+  }
+
+  smt::Term Smt2Solver::make_bv_one(smt::Sort s) { return make_bv_value_uint64(s, 1); }
+
+  smt::Term Smt2Solver::make_bv_min_signed(smt::Sort s) {
+    return bvLiteral(s, "1" + std::string(get_bv_width(s) - 1, '0'));
+  }
+
+  smt::Term Smt2Solver::make_bv_max_signed(smt::Sort s) {
+    return bvLiteral(s, "0" + std::string(get_bv_width(s) - 1, '1'));
+  }
+
+  smt::Term Smt2Solver::make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) {
+    auto [exp, sig] = get_fp_dims(s);
+    std::string dims = std::to_string(exp) + " " + std::to_string(sig);
+    double d = std::strtod(val.c_str(), nullptr);
+    if (std::isnan(d))
+      return leaf(s, "(_ NaN " + dims + ")");
+    if (std::isinf(d))
+      return leaf(s, std::string(d < 0 ? "(_ -oo " : "(_ +oo ") + dims + ")");
+    std::string real = val[0] == '-' ? "(- " + val.substr(1) + ")" : val;
+    return leaf(s, "((_ to_fp " + dims + ") " + rmText(rm) + " " + real + ")");
+  }
+
+  smt::Term Smt2Solver::make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) {
+    auto [exp, sig] = get_fp_dims(s);
+    std::string f64 = fpText(toBits(doubleBits(val), 64, false), 11);
+    if (exp == 11 && sig == 53)
+      return leaf(s, f64, toBits(doubleBits(val), 64, false));
+    return leaf(
+        s, "((_ to_fp " + std::to_string(exp) + " " + std::to_string(sig) + ") " + rmText(rm) +
+               " " + f64 + ")"
+    );
+  }
+
+  smt::Term Smt2Solver::make_rm_value(smt::RoundingMode rm) {
+    return leaf(sortOf(SortKind::RM), rmText(rm));
+  }
+
+  smt::Term Smt2Solver::make_const_array(smt::Sort s, smt::Term val) {
+    Node n;
+    n.sort = s;
+    n.text = "(as const " + sortText(s) + ")";
+    n.args = {val};
+    n.leaf = false;
+    nodes_.push_back(std::move(n));
+    return {static_cast<uint32_t>(nodes_.size())};
+  }
+
+  smt::Term Smt2Solver::make_const(smt::Sort s, const std::string &name) {
+    smt::Term t = leaf(s, constSymbol(name, static_cast<uint32_t>(nodes_.size() + 1)));
+    nodes_.back().isConst = true;
+    consts_.push_back(t);
+    body_ += "(declare-const " + nodes_.back().text + " " + sortText(s) + ")\n";
+    return t;
+  }
+
+  smt::Term Smt2Solver::make_term(
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+  ) {
+    std::vector<smt::Term> ops(args.begin(), args.end());
+    if (takesRM(k) && (ops.empty() || info(get_sort(ops[0])).kind != SortKind::RM))
+      ops.insert(ops.begin(), make_rm_value(smt::RoundingMode::RNE));
+    if (ops.empty())
+      throw std::runtime_error("Smt2Solver: operation without operands");
+    auto idx = [&](std::size_t i) {
+      if (i >= indices.size())
+        throw std::runtime_error("Smt2Solver: missing index");
+      return indices[i];
+    };
+    auto indexedOp = [&](const char *name, std::size_t n) {
+      std::string text = std::string("(_ ") + name;
+      for (std::size_t i = 0; i < n; ++i)
+        text += " " + std::to_string(idx(i));
+      return text + ")";
+    };
+
+    Node n;
+    n.leaf = false;
+    switch (k) {
+      case K::BV_EXTRACT:
+        n.text = indexedOp("extract", 2);
+        n.sort = make_bv_sort(idx(0) - idx(1) + 1);
+        break;
+      case K::BV_SIGN_EXTEND:
+      case K::BV_ZERO_EXTEND:
+        n.text = indexedOp(k == K::BV_SIGN_EXTEND ? "sign_extend" : "zero_extend", 1);
+        n.sort = make_bv_sort(get_bv_width(get_sort(ops[0])) + idx(0));
+        break;
+      case K::FP_TO_SBV:
+      case K::FP_TO_UBV:
+        n.text = indexedOp(k == K::FP_TO_SBV ? "fp.to_sbv" : "fp.to_ubv", 1);
+        n.sort = make_bv_sort(idx(0));
+        break;
+      case K::FP_TO_FP_FROM_FP:
+      case K::FP_TO_FP_FROM_SBV:
+      case K::FP_TO_FP_FROM_UBV:
+        n.text = indexedOp(k == K::FP_TO_FP_FROM_UBV ? "to_fp_unsigned" : "to_fp", 2);
+        n.sort = make_fp_sort(idx(0), idx(1));
+        break;
+      default: {
+        auto &names = opNames();
+        auto it = std::find_if(names.begin(), names.end(), [&](const auto &p) {
+          return p.first == k;
+        });
+        n.text = it->second;
+        if (isPredicate(k)) {
+          n.sort = make_bool_sort();
+        } else if (k == K::ITE) {
+          n.sort = get_sort(ops.at(1));
+        } else if (k == K::BV_CONCAT) {
+          uint32_t width = 0;
+          for (auto op: ops)
+            width += get_bv_width(get_sort(op));
+          n.sort = make_bv_sort(width);
+        } else if (k == K::ARRAY_SELECT) {
+          n.sort = {info(get_sort(ops[0])).b};
+        } else {
+          // BV operations and stores take the sort of their first operand,
+          // FP operations that of their last one (after the rounding mode).
+          bool fp = k >= K::FP_ADD && k <= K::FP_MAX;
+          n.sort = get_sort(fp ? ops.back() : ops[0]);
+        }
+      }
+    }
+    n.args = std::move(ops);
+    nodes_.push_back(std::move(n));
+    return {static_cast<uint32_t>(nodes_.size())};
+  }
+
+  smt::Sort Smt2Solver::get_sort(smt::Term t) { return node(t).sort; }
+
+  bool Smt2Solver::is_true(smt::Term t) {
+    const Node &n = node(t);
+    return n.bits == "1" && info(n.sort).kind == SortKind::Bool;
+  }
+
+  bool Smt2Solver::is_false(smt::Term t) {
+    const Node &n = node(t);
+    return n.bits == "0" && info(n.sort).kind == SortKind::Bool;
+  }
+
+  std::string Smt2Solver::ref(smt::Term t) {
+    std::vector<std::pair<smt::Term, bool>> stack{{t, false}};
+    while (!stack.empty()) {
+      auto [u, expanded] = stack.back();
+      stack.pop_back();
+      Node &n = nodes_[u.id - 1];
+      if (n.leaf || n.defined)
+        continue;
+      if (!expanded) {
+        stack.emplace_back(u, true);
+        for (auto it = n.args.rbegin(); it != n.args.rend(); ++it)
+          stack.emplace_back(*it, false);
+        continue;
+      }
+      std::string def = "(define-fun t" + std::to_string(u.id) + " () " + sortText(n.sort) +
+                        " (" + n.text;
+      for (auto a: n.args) {
+        const Node &arg = nodes_[a.id - 1];
+        def += " " + (arg.leaf ? arg.text : "t" + std::to_string(a.id));
+      }
+      body_ += def + "))\n";
+      n.defined = true;
+    }
+    const Node &n = node(t);
+    return n.leaf ? n.text : "t" + std::to_string(t.id);
+  }
+
+  void Smt2Solver::assert_formula(smt::Term t) {
+    std::string r = ref(t);
+    body_ += "(assert " + r + ")\n";
+  }
+
+  void Smt2Solver::push(uint32_t levels) { body_ += "(push " + std::to_string(levels) + ")\n"; }
+
+  void Smt2Solver::pop(uint32_t levels) { body_ += "(pop " + std::to_string(levels) + ")\n"; }
+
+  smt::Result Smt2Solver::check(const std::string &command) {
+    // Definitions must outlive pops, as terms stay valid after them.
+    std::string script = "(set-option :produce-models true)\n"
+                         "(set-option :produce-unsat-assumptions true)\n"
+                         "(set-option :global-declarations true)\n"
+                         "(set-logic ALL)\n";
+    script += body_;
+    script += command;
+    std::string names;
+    for (auto c: consts_) {
+      const Node &n = node(c);
+      auto kind = info(n.sort).kind;
+      if (kind == SortKind::Bool || kind == SortKind::BV || kind == SortKind::FP)
+        names += (names.empty() ? "" : " ") + n.text;
+    }
+    if (!names.empty())
+      script += "(get-value (" + names + "))\n";
+    if (!assumptions_.empty())
+      script += "(get-unsat-assumptions)\n";
+
+    cancel_.store(false);
+    values_.clear();
+    answer_ = transport_(script, cancel_);
+    return answer_.result;
+  }
+
+  smt::Result Smt2Solver::check_sat() {
+    assumptions_.clear();
+    return check("(check-sat)\n");
+  }
+
+  smt::Result Smt2Solver::check_sat_assuming(const std::vector<smt::Term> &assumptions) {
+    assumptions_.clear();
+    std::string command = "(check-sat-assuming (";
+    for (std::size_t i = 0; i < assumptions.size(); ++i) {
+      assumptions_.emplace_back(ref(assumptions[i]), assumptions[i]);
+      command += (i ? " " : "") + assumptions_.back().first;
+    }
+    return check(command + "))\n");
+  }
+
+  std::vector<smt::Term> Smt2Solver::get_unsat_assumptions() {
+    std::vector<smt::Term> core;
+    for (const auto &text: answer_.unsatAssumptions)
+      for (const auto &[a, t]: assumptions_)
+        if (a == text) {
+          core.push_back(t);
+          break;
+        }
+    return core;
+  }
+
+  void Smt2Solver::interrupt() { cancel_.store(true); }
+
+  smt::Term Smt2Solver::get_value(smt::Term t) {
+    const Node &n = node(t);
+    if (!n.bits.empty())
+      return t;
+    if (!n.isConst)
+      throw std::runtime_error("Smt2Solver: get_value only supports consts");
+    if (answer_.result != smt::Result::SAT)
+      throw std::runtime_error("get_value called without SAT result");
+    if (auto it = values_.find(t.id); it != values_.end())
+      return it->second;
+    auto v = answer_.values.find(unquote(n.text));
+    if (v == answer_.values.end())
+      throw std::runtime_error("Smt2Solver: the answer has no value for " + n.text);
+
+    SExprParser parser(v->second);
+    SExpr e;
+    if (!parser.next(e))
+      throw std::runtime_error("Smt2Solver: empty value for " + n.text);
+    std::string bits = valueBits(e);
+    smt::Sort sort = n.sort; // `n` dangles once a node is added
+    const SortInfo &si = info(sort);
+    smt::Term val;
+    if (si.kind == SortKind::BV) {
+      if (bits.size() != si.a)
+        throw std::runtime_error("Smt2Solver: value of the wrong width for " + n.text);
+      val = bvLiteral(sort, bits);
+    } else if (si.kind == SortKind::FP) {
+      if (bits.size() != si.a + si.b)
+        throw std::runtime_error("Smt2Solver: value of the wrong width for " + n.text);
+      val = leaf(sort, fpText(bits, si.a), bits);
+    } else {
+      val = bits == "1" ? make_true() : make_false();
+    }
+    values_.emplace(t.id, val);
+    return val;
+  }
+
+  std::string Smt2Solver::get_bv_value_string(smt::Term t, uint8_t base) {
+    const std::string &bits = node(t).bits;
+    if (bits.empty())
+      throw std::runtime_error("Smt2Solver: not a bit-vector value");
+    if (base == 2)
+      return bits;
+    if (base == 16)
+      return bitsToHex(bits);
+    return bitsToDecimal(bits);
+  }
+
+  std::string Smt2Solver::get_fp_value_string(smt::Term t) {
+    const Node &n = node(t);
+    if (n.bits.empty() || info(n.sort).kind != SortKind::FP)
+      throw std::runtime_error("Smt2Solver: not a floating-point value");
+    return n.bits;
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,151 @@
+#include "solver/smt2_spool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace symir::solver {
+
+  namespace fs = std::filesystem;
+
+  namespace {
+
+    constexpr const char *kQuery = ".smt2";
+    constexpr const char *kAnswer = ".ans";
+
+    bool endsWith(const std::string &s, const std::string &suffix) {
+      return s.size() >= suffix.size() &&
+             s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Writes `text` to `path` through a temporary file, so readers never
+    // see it half-written.
+    void writeAtomically(const fs::path &path, const std::string &text) {
+      fs::path tmp = path;
+      tmp += ".tmp";
+      {
+        std::ofstream out(tmp, std::ios::binary);
+        out << text;
+        if (!out)
+          throw std::runtime_error("Could not write " + tmp.string());
+      }
+      fs::rename(tmp, path);
+    }
+
+    std::string readFile(const fs::path &path) {
+      std::ifstream in(path, std::ios::binary);
+      std::stringstream ss;
+      ss << in.rdbuf();
+      return ss.str();
+    }
+
+    // Sleeps a little longer each time nothing happened, up to 50 ms.
+    struct Backoff {
+      std::chrono::milliseconds wait{1};
+
+      void sleep() {
+        std::this_thread::sleep_for(wait);
+        wait = std::min(wait * 2, std::chrono::milliseconds(50));
+      }
+
+      void reset() { wait = std::chrono::milliseconds(1); }
+    };
+
+  } // namespace
+
+  Smt2Spool::Smt2Spool(std::string dir) : dir_(std::move(dir)) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (!fs::is_directory(dir_))
+      throw std::runtime_error("Could not create SMT-LIB2 directory " + dir_);
+    char host[256] = {0};
+    if (::gethostname(host, sizeof(host) - 1) != 0 || !host[0])
+      std::snprintf(host, sizeof(host), "host");
+    prefix_ = "q-" + std::string(host) + "-" + std::to_string(::getpid()) + "-";
+  }
+
+  std::string Smt2Spool::write(const std::string &script) {
+    char seq[32];
+    std::snprintf(seq, sizeof(seq), "%08llu", static_cast<unsigned long long>(next_++));
+    fs::path path = fs::path(dir_) / (prefix_ + seq + kQuery);
+    writeAtomically(path, script);
+    return path.string();
+  }
+
+  Smt2Answer Smt2Spool::submit(const std::string &script, const std::atomic<bool> &cancel) {
+    fs::path query = write(script);
+    fs::path answer = query;
+    answer.replace_extension(kAnswer);
+    Backoff backoff;
+    while (!cancel.load()) {
+      std::error_code ec;
+      if (fs::exists(answer, ec)) {
+        std::string text = readFile(answer);
+        fs::remove(answer, ec);
+        return parseSmt2Answer(text);
+      }
+      backoff.sleep();
+    }
+    // Withdraw the query if no worker has claimed it yet.
+    std::error_code ec;
+    fs::remove(query, ec);
+    return {};
+  }
+
+  uint64_t Smt2Spool::serve(const BackendFactory &factory, uint32_t idleMs) {
+    std::string claim = ".claimed-" + std::to_string(::getpid()) + "-" +
+                        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    uint64_t answered = 0;
+    auto lastWork = std::chrono::steady_clock::now();
+    Backoff backoff;
+    for (;;) {
+      std::vector<fs::path> queries;
+      std::error_code ec;
+      for (const auto &entry: fs::directory_iterator(dir_, ec))
+        if (endsWith(entry.path().filename().string(), kQuery))
+          queries.push_back(entry.path());
+      std::sort(queries.begin(), queries.end());
+
+      bool worked = false;
+      for (const auto &query: queries) {
+        fs::path claimed = query;
+        claimed += claim;
+        fs::rename(query, claimed, ec);
+        if (ec)
+          continue; // another worker was faster, or the query was withdrawn
+        Smt2Answer answer;
+        try {
+          auto backend = factory();
+          answer = runSmt2(readFile(claimed), *backend);
+        } catch (const std::exception &e) {
+          std::cerr << "Worker: " << query.filename().string() << ": " << e.what() << "\n";
+          answer = {}; // UNKNOWN
+        }
+        fs::path out = query;
+        out.replace_extension(kAnswer);
+        writeAtomically(out, formatSmt2Answer(answer));
+        fs::remove(claimed, ec);
+        ++answered;
+        worked = true;
+      }
+
+      if (worked) {
+        lastWork = std::chrono::steady_clock::now();
+        backoff.reset();
+        continue;
+      }
+      if (idleMs && std::chrono::steady_clock::now() - lastWork >=
+                        std::chrono::milliseconds(idleMs))
+        return answered;
+      backoff.sleep();
+    }
+  }
+
+} // namespace symir::solver
@@ -1,33 +1,53 @@
 #include "solver/solver.hpp"
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <optional>
 #include <random>
 #include <stdexcept>
 #include <thread>
+#include <unordered_set>
+#include <utility>
 #include "analysis/cfg.hpp"
+#include "analysis/type_utils.hpp"
+#include "ast/type_annotations.hpp"
+#include "interp/interpreter.hpp"
+#include "timing.hpp"
 
 namespace symir {
 
   thread_local const FunDecl *SymbolicExecutor::currentFun_ = nullptr;
-
-  // Pointers are encoded as 64-bit BV tags identifying the addressed local.
-  // Tag 0 is reserved for null. Tags are derived deterministically from the
-  // local name via FNV-1a so they remain stable across solver invocations.
+  thread_local const SymbolicExecutor::FunctionContext *SymbolicExecutor::currentCtx_ = nullptr;
+  thread_local uint32_t SymbolicExecutor::attemptTimeoutMs_ = 0;
+  thread_local SymbolicExecutor::SsaPath *SymbolicExecutor::ssaPath_ = nullptr;
+  thread_local SymbolicExecutor::LazyFp *SymbolicExecutor::lazyFp_ = nullptr;
+  thread_local SymbolicExecutor::MemoryBudget *SymbolicExecutor::memoryBudget_ = nullptr;
+
+  // Pointers are encoded as BV tags identifying the addressed cell. Tag 0
+  // is reserved for null; each let and param of a function owns the tags
+  // from its base up to base + its tag units, laid out one after the other
+  // in declaration order with one unused tag in between (so one past the
+  // end of an object is never the start of the next). The tag width is the
+  // least that holds every tag and object size as a non-negative signed
+  // value (FunctionContext::ptrBits), at most kPtrBits. Pointer arithmetic
+  // and pointer differences are computed on kPtrBits and narrowed back.
   static constexpr uint32_t kPtrBits = 64;
 
-  static uint64_t tagOfLocal(const std::string &name) {
-    uint64_t h = 1469598103934665603ULL; // FNV-1a 64-bit offset basis
-    for (unsigned char c: name) {
-      h ^= c;
-      h *= 1099511628211ULL; // FNV-1a 64-bit prime
-    }
-    if (h == 0)
-      h = 1; // never collide with null
-    return h;
+  // The SMT array index (BV32) of a pointer tag's offset `delta` from the
+  // first element, which the caller has checked to be below the array size.
+  static smt::Term arrayIndexOf(smt::Term delta, smt::ISolver &solver) {
+    uint32_t w = solver.get_bv_width(solver.get_sort(delta));
+    if (w < 32)
+      return solver.make_term(smt::Kind::BV_ZERO_EXTEND, {delta}, {32 - w});
+    return solver.make_term(smt::Kind::BV_EXTRACT, {delta}, {31, 0});
   }
 
   // Map RelOp to the appropriate SMT comparison kind, choosing BV or FP
@@ -57,7 +77,7 @@ namespace symir {
   //   * `ptrfield`/`ptrindex` adds the right offset for nested aggregates
   // Forward-declared so other helpers can refer to it; defined below.
   static std::uint64_t sizeofTagUnits(
-      const TypePtr &t, const std::unordered_map<std::string, const StructDecl *> &structs
+      const TypePtr &t, const std::unordered_map<Symbol, const StructDecl *> &structs
   ) {
     if (!t)
       return 1;
@@ -75,20 +95,6 @@ namespace symir {
     return 1; // scalar / ptr / vec
   }
 
-  // Byte offset (in tag units) of the named struct field.
-  static std::uint64_t fieldOffsetTagUnits(
-      const StructDecl &s, const std::string &field,
-      const std::unordered_map<std::string, const StructDecl *> &structs
-  ) {
-    std::uint64_t off = 0;
-    for (const auto &f: s.fields) {
-      if (f.name == field)
-        return off;
-      off += sizeofTagUnits(f.type, structs);
-    }
-    return off;
-  }
-
   // Compare SymIR types for structural equality at the level we care about
   // (matters when enumerating candidate ptr targets in load/store dispatch).
   static bool typeMatch(const TypePtr &a, const TypePtr &b) {
@@ -125,12 +131,199 @@ namespace symir {
     return false;
   }
 
+  std::vector<std::optional<SymbolicExecutor::FunctionContext::MergeRegion>>
+  SymbolicExecutor::mergeRegions(const CFG &cfg, const std::vector<std::size_t> &ipdom) {
+    using MergeRegion = FunctionContext::MergeRegion;
+    const std::size_t n = cfg.blocks.size();
+    std::vector<std::optional<MergeRegion>> regions(n);
+    for (std::size_t br = 0; br < n; ++br) {
+      std::size_t join = ipdom[br];
+      if (cfg.succ[br].size() != 2 || join >= n)
+        continue;
+      // Blocks reachable from the br before the join; the br itself among
+      // them means a cycle.
+      std::vector<std::size_t> blocks;
+      std::vector<char> in(n, 0);
+      std::vector<std::size_t> todo(cfg.succ[br].begin(), cfg.succ[br].end());
+      bool ok = true;
+      while (ok && !todo.empty()) {
+        std::size_t b = todo.back();
+        todo.pop_back();
+        if (b == join || in[b])
+          continue;
+        if (b == br || blocks.size() == MergeRegion::kMaxBlocks) {
+          ok = false;
+          break;
+        }
+        in[b] = 1;
+        blocks.push_back(b);
+        todo.insert(todo.end(), cfg.succ[b].begin(), cfg.succ[b].end());
+      }
+      if (!ok)
+        continue;
+      // Topological order (Kahn) over the edges inside the region.
+      std::vector<std::size_t> indeg(n, 0);
+      for (std::size_t b: blocks)
+        for (std::size_t s: cfg.succ[b])
+          if (in[s])
+            ++indeg[s];
+      std::vector<std::size_t> ready, order;
+      for (std::size_t b: blocks)
+        if (indeg[b] == 0)
+          ready.push_back(b);
+      while (!ready.empty()) {
+        std::size_t b = ready.back();
+        ready.pop_back();
+        order.push_back(b);
+        for (std::size_t s: cfg.succ[b])
+          if (in[s] && --indeg[s] == 0)
+            ready.push_back(s);
+      }
+      if (order.size() != blocks.size())
+        continue;
+      regions[br] = MergeRegion{join, std::move(order)};
+    }
+    return regions;
+  }
+
   SymbolicExecutor::SymbolicExecutor(
       const Program &prog, const Config &config, SolverFactory solverFactory
-  ) : prog_(prog), config_(config), solverFactory_(solverFactory) {
+  ) : prog_(prog), config_(config), solverFactory_(solverFactory), cancel_(config.cancel) {
     for (const auto &s: prog_.structs) {
       structs_[s.name.name] = &s;
     }
+    for (const auto &s: prog_.structs) {
+      StructLayout layout;
+      for (const auto &f: s.fields) {
+        layout.fields.emplace(f.name, StructLayout::Field{layout.size, f.type});
+        layout.size += sizeofTagUnits(f.type, structs_);
+      }
+      layouts_.emplace(s.name.name, std::move(layout));
+    }
+
+    AnalysisManager &am = config_.analyses ? *config_.analyses : ownAnalyses_;
+    for (const auto &f: prog_.funs) {
+      FunctionContext ctx;
+      ctx.fun = &f;
+      ctx.cfg = am.validCfg(f);
+      ctx.cfgOk = ctx.cfg != nullptr;
+      if (ctx.cfgOk) {
+        ctx.nextToRet = &am.shortestPathToRet(f);
+        ctx.canReachRet = &am.canReachRet(f);
+      }
+      uint64_t nextTag = 1;
+      auto place = [&](const TypePtr &t) {
+        uint64_t tag = nextTag;
+        nextTag += tagUnits(t) + 1;
+        return tag;
+      };
+      for (const auto &l: f.lets) {
+        uint64_t tag = place(l.type);
+        ctx.letTags.push_back(tag);
+        ctx.locals.emplace(l.name.name, FunctionContext::Local{l.type, tag});
+      }
+      for (const auto &p: f.params)
+        ctx.locals.emplace(p.name.name, FunctionContext::Local{p.type, place(p.type)});
+      if (config_.narrow_pointers) {
+        // Offsets and sizes through a pointer are bounded by its pointee.
+        uint64_t maxTag = nextTag;
+        for (const auto &[name, local]: ctx.locals)
+          maxTag = std::max(maxTag, maxPointeeUnits(local.type));
+        ctx.ptrBits = std::min<uint32_t>(kPtrBits, std::bit_width(maxTag) + 1);
+      }
+      for (std::size_t k = 0; k < f.lets.size(); ++k)
+        ctx.allLets.push_back(k);
+      if (ctx.cfgOk && config_.points_to)
+        ctx.pointsTo.emplace(f, *ctx.cfg);
+      if (ctx.cfgOk && config_.merge_joins)
+        ctx.regions = mergeRegions(*ctx.cfg, am.postDominators(f));
+      if (ctx.cfgOk && config_.ssa)
+        ctx.ssa = &am.ssa(f);
+      contexts_.emplace(f.name.name, std::move(ctx));
+    }
+  }
+
+  std::uint64_t SymbolicExecutor::maxPointeeUnits(const TypePtr &t) const {
+    std::uint64_t units = 0;
+    std::unordered_set<std::string> seen; // structs, which may point to themselves
+    std::function<void(const TypePtr &)> visit = [&](const TypePtr &ty) {
+      if (!ty)
+        return;
+      if (auto pt = std::get_if<PtrType>(&ty->v)) {
+        units = std::max(units, tagUnits(pt->pointee));
+        visit(pt->pointee);
+      } else if (auto at = std::get_if<ArrayType>(&ty->v)) {
+        visit(at->elem);
+      } else if (auto st = std::get_if<StructType>(&ty->v)) {
+        auto it = structs_.find(st->name.name);
+        if (it != structs_.end() && seen.insert(st->name.name).second)
+          for (const auto &f: it->second->fields)
+            visit(f.type);
+      }
+    };
+    visit(t);
+    return units;
+  }
+
+  uint32_t SymbolicExecutor::ptrBits() { return currentCtx_ ? currentCtx_->ptrBits : kPtrBits; }
+
+  smt::Term SymbolicExecutor::widenPtr(smt::Term t, smt::ISolver &solver) {
+    uint32_t w = solver.get_bv_width(solver.get_sort(t));
+    if (w >= kPtrBits)
+      return t;
+    return solver.make_term(smt::Kind::BV_ZERO_EXTEND, {t}, {kPtrBits - w});
+  }
+
+  smt::Term
+  SymbolicExecutor::narrowPtr(smt::Term t, smt::ISolver &solver, std::vector<smt::Term> &pc) {
+    uint32_t w = ptrBits();
+    if (w >= kPtrBits)
+      return t;
+    // A pointer outside the tag range addresses no object of the function.
+    auto limit = solver.make_bv_value_uint64(solver.get_sort(t), uint64_t(1) << (w - 1));
+    pc.push_back(solver.make_term(smt::Kind::BV_ULT, {t, limit}));
+    return solver.make_term(smt::Kind::BV_EXTRACT, {t}, {w - 1, 0});
+  }
+
+  std::uint64_t SymbolicExecutor::tagUnits(const TypePtr &t) const {
+    if (!t)
+      return 1;
+    if (auto at = std::get_if<ArrayType>(&t->v))
+      return at->size * tagUnits(at->elem);
+    if (auto st = std::get_if<StructType>(&t->v)) {
+      auto it = layouts_.find(st->name.name);
+      return it == layouts_.end() ? 1 : it->second.size;
+    }
+    return 1; // scalar / ptr / vec
+  }
+
+  const SymbolicExecutor::FunctionContext &
+  SymbolicExecutor::contextOf(const std::string &funcName) const {
+    auto it = contexts_.find(funcName);
+    if (it == contexts_.end())
+      throw std::runtime_error("Function not found: " + funcName);
+    if (!it->second.cfgOk)
+      throw std::runtime_error("CFG build failed");
+    return it->second;
+  }
+
+  const SymbolicExecutor::FunctionContext::Local *
+  SymbolicExecutor::currentLocal(const std::string &name) {
+    if (!currentCtx_)
+      return nullptr;
+    auto it = currentCtx_->locals.find(name);
+    return it == currentCtx_->locals.end() ? nullptr : &it->second;
+  }
+
+  SymbolicExecutor::FunScope::FunScope(const FunctionContext &ctx)
+      : prevFun_(currentFun_), prevCtx_(currentCtx_) {
+    currentFun_ = ctx.fun;
+    currentCtx_ = &ctx;
+  }
+
+  SymbolicExecutor::FunScope::~FunScope() {
+    currentFun_ = prevFun_;
+    currentCtx_ = prevCtx_;
   }
 
   smt::Sort SymbolicExecutor::getSort(const TypePtr &t, smt::ISolver &solver) {
@@ -165,7 +358,7 @@ namespace symir {
       }
     }
     if (std::holds_alternative<PtrType>(t->v)) {
-      return solver.make_bv_sort(kPtrBits);
+      return solver.make_bv_sort(ptrBits());
     }
     if (auto vt = std::get_if<VecType>(&t->v)) {
       // [v0.2.1] Vectors aren't a single SMT sort; lanes are held as N
@@ -177,17 +370,143 @@ namespace symir {
     throw std::runtime_error("Unknown type or empty struct in getSort");
   }
 
+  bool SymbolicExecutor::useSmtArray(const ArrayType &at) const {
+    using Enc = Config::ArrayEncoding;
+    // The retry of a query over Config::max_memory_mb encodes them all so.
+    bool forced = memoryBudget_ && memoryBudget_->smtArrays;
+    if (at.size == 0 || (config_.array_encoding == Enc::Ite && !forced))
+      return false;
+    // Only arrays of non-pointer scalars: pointer elements carry provenance
+    // and nested aggregates are addressed field by field.
+    if (!std::holds_alternative<IntType>(at.elem->v) &&
+        !std::holds_alternative<FloatType>(at.elem->v))
+      return false;
+    return forced || config_.array_encoding == Enc::SmtArray ||
+           at.size >= config_.array_threshold;
+  }
+
+  smt::Sort SymbolicExecutor::getSmtArraySort(const ArrayType &at, smt::ISolver &solver) {
+    return solver.make_array_sort(solver.make_bv_sort(32), getSort(at.elem, solver));
+  }
+
+  std::uint64_t SymbolicExecutor::arrayLength(const SymbolicValue &a) {
+    if (a.kind == SymbolicValue::Kind::SmtArray || a.lazy())
+      return a.arraySize;
+    return a.arrayVal.size();
+  }
+
+  SymbolicExecutor::SymbolicValue
+  SymbolicExecutor::cellOf(const SymbolicValue &a, std::uint64_t k, smt::ISolver &solver) {
+    if (!a.lazy())
+      return a.arrayVal.at(k);
+    if (auto it = a.cells.find(k); it != a.cells.end())
+      return it->second;
+    return fillAt(*a.fill, k, solver);
+  }
+
+  SymbolicExecutor::SymbolicValue
+  SymbolicExecutor::fillAt(const LazyFill &fill, std::uint64_t k, smt::ISolver &solver) {
+    using FK = LazyFill::Kind;
+    switch (fill.kind) {
+    case FK::Uniform:
+      return fill.value;
+    case FK::Named: {
+      auto it = fill.made.find(k);
+      if (it == fill.made.end())
+        it = fill.made
+                 .emplace(k, createSymbolicValue(
+                                 fill.elem, fill.name + "[" + std::to_string(k) + "]", solver
+                             ))
+                 .first;
+      return it->second;
+    }
+    case FK::Write: {
+      auto kT = solver.make_bv_value_uint64(solver.make_bv_sort(32), k);
+      auto at = solver.make_term(
+          smt::Kind::AND, {fill.cond, solver.make_term(smt::Kind::EQUAL, {fill.idx, kT})}
+      );
+      // The write pushed its UB guards already.
+      std::vector<smt::Term> guards;
+      return updateLValueRec(
+          fillAt(*fill.prev, k, solver), fill.rest, fill.value, at, solver, guards
+      );
+    }
+    case FK::Mux:
+      return muxSymbolicValue(
+          fill.cond, fillAt(*fill.prev, k, solver), fillAt(*fill.other, k, solver), solver
+      );
+    }
+    throw std::runtime_error("Unknown lazy array fill");
+  }
+
+  std::optional<SymbolicExecutor::SymbolicValue>
+  SymbolicExecutor::fillAt(const LazyFill &fill, smt::Term idx, smt::ISolver &solver) {
+    using FK = LazyFill::Kind;
+    switch (fill.kind) {
+    case FK::Uniform:
+      return fill.value;
+    case FK::Named:
+      return std::nullopt; // a different const per cell
+    case FK::Write: {
+      auto prev = fillAt(*fill.prev, idx, solver);
+      if (!prev)
+        return std::nullopt;
+      auto at = solver.make_term(
+          smt::Kind::AND, {fill.cond, solver.make_term(smt::Kind::EQUAL, {fill.idx, idx})}
+      );
+      std::vector<smt::Term> guards;
+      return updateLValueRec(*prev, fill.rest, fill.value, at, solver, guards);
+    }
+    case FK::Mux: {
+      auto t = fillAt(*fill.prev, idx, solver);
+      auto f = t ? fillAt(*fill.other, idx, solver) : std::nullopt;
+      if (!f)
+        return std::nullopt;
+      return muxSymbolicValue(fill.cond, *t, *f, solver);
+    }
+    }
+    throw std::runtime_error("Unknown lazy array fill");
+  }
+
+  void SymbolicExecutor::densify(SymbolicValue &a, smt::ISolver &solver) {
+    if (!a.lazy())
+      return;
+    a.arrayVal.reserve(a.arraySize);
+    for (std::uint64_t k = 0; k < a.arraySize; ++k)
+      a.arrayVal.push_back(cellOf(a, k, solver));
+    a.cells.clear();
+    a.fill.reset();
+    a.arraySize = 0;
+  }
+
+  SymbolicExecutor::SymbolicValue
+  SymbolicExecutor::lazyArray(std::uint64_t size, std::shared_ptr<const LazyFill> fill) {
+    SymbolicValue res(SymbolicValue::Kind::Array);
+    res.arraySize = size;
+    res.fill = std::move(fill);
+    return res;
+  }
+
   SymbolicExecutor::SymbolicValue SymbolicExecutor::createSymbolicValue(
       const TypePtr &t, const std::string &name, smt::ISolver &solver, bool
   ) {
     SymbolicValue res;
-    if (auto at = std::get_if<ArrayType>(&t->v)) {
-      res.kind = SymbolicValue::Kind::Array;
-      for (size_t i = 0; i < at->size; ++i) {
-        res.arrayVal.push_back(
-            createSymbolicValue(at->elem, name + "[" + std::to_string(i) + "]", solver)
-        );
-      }
+    if (auto at = std::get_if<ArrayType>(&t->v); at && useSmtArray(*at)) {
+      res.kind = SymbolicValue::Kind::SmtArray;
+      res.arraySize = at->size;
+      auto sort = getSmtArraySort(*at, solver);
+      res.term = solver.make_const(sort, name);
+      res.is_defined = solver.make_const_array(
+          solver.make_array_sort(solver.make_bv_sort(32), solver.make_bool_sort()),
+          solver.make_true()
+      );
+    } else if (at) {
+      // Elements are made when first touched.
+      auto fill = std::make_shared<LazyFill>();
+      fill->kind = LazyFill::Kind::Named;
+      fill->elem = at->elem;
+      fill->name = name;
+      res = lazyArray(at->size, std::move(fill));
     } else if (auto vt = std::get_if<VecType>(&t->v)) {
       // [v0.2.1] Vector sym: N independent lane-symbolic constants
       // (§9.5.1). Same shape as Array but tagged Vec so downstream
@@ -217,10 +536,18 @@ namespace symir {
   SymbolicExecutor::SymbolicValue
   SymbolicExecutor::makeUndef(const TypePtr &t, smt::ISolver &solver) {
     SymbolicValue res;
-    if (auto at = std::get_if<ArrayType>(&t->v)) {
-      res.kind = SymbolicValue::Kind::Array;
-      for (size_t i = 0; i < at->size; ++i)
-        res.arrayVal.push_back(makeUndef(at->elem, solver));
+    if (auto at = std::get_if<ArrayType>(&t->v); at && useSmtArray(*at)) {
+      res.kind = SymbolicValue::Kind::SmtArray;
+      res.arraySize = at->size;
+      res.term = solver.make_const(getSmtArraySort(*at, solver), "undef");
+      res.is_defined = solver.make_const_array(
+          solver.make_array_sort(solver.make_bv_sort(32), solver.make_bool_sort()),
+          solver.make_false()
+      );
+    } else if (at) {
+      auto fill = std::make_shared<LazyFill>();
+      fill->value = makeUndef(at->elem, solver);
+      res = lazyArray(at->size, std::move(fill));
     } else if (auto vt = std::get_if<VecType>(&t->v)) {
       res.kind = SymbolicValue::Kind::Vec;
       for (size_t i = 0; i < vt->size; ++i)
@@ -244,11 +571,21 @@ namespace symir {
   SymbolicExecutor::broadcast(const TypePtr &t, smt::Term val, smt::ISolver &solver) {
     if (std::holds_alternative<ArrayType>(t->v)) {
       SymbolicValue res;
-      res.kind = SymbolicValue::Kind::Array;
       const auto &at = std::get<ArrayType>(t->v);
-      for (size_t i = 0; i < at.size; ++i)
-        res.arrayVal.push_back(broadcast(at.elem, val, solver));
-      return res;
+      if (useSmtArray(at)) {
+        res.kind = SymbolicValue::Kind::SmtArray;
+        res.arraySize = at.size;
+        auto leaf = broadcast(at.elem, val, solver);
+        res.term = solver.make_const_array(getSmtArraySort(at, solver), leaf.term);
+        res.is_defined = solver.make_const_array(
+            solver.make_array_sort(solver.make_bv_sort(32), solver.make_bool_sort()),
+            leaf.is_defined
+        );
+        return res;
+      }
+      auto fill = std::make_shared<LazyFill>();
+      fill->value = broadcast(at.elem, val, solver);
+      return lazyArray(at.size, std::move(fill));
     } else if (std::holds_alternative<VecType>(t->v)) {
       SymbolicValue res;
       res.kind = SymbolicValue::Kind::Vec;
@@ -317,6 +654,19 @@ namespace symir {
       const auto &elements = std::get<std::vector<InitValPtr>>(iv.value);
       if (auto at = std::get_if<ArrayType>(&t->v)) {
         SymbolicValue res;
+        if (useSmtArray(*at)) {
+          // Elements past the initializer list stay undefined.
+          res = makeUndef(t, solver);
+          auto idxSort = solver.make_bv_sort(32);
+          for (size_t i = 0; i < elements.size(); ++i) {
+            auto elem = evalInit(*elements[i], at->elem, solver, store, pc);
+            auto k = solver.make_bv_value_uint64(idxSort, i);
+            res.term = solver.make_term(smt::Kind::ARRAY_STORE, {res.term, k, elem.term});
+            res.is_defined =
+                solver.make_term(smt::Kind::ARRAY_STORE, {res.is_defined, k, elem.is_defined});
+          }
+          return res;
+        }
         res.kind = SymbolicValue::Kind::Array;
         for (size_t i = 0; i < elements.size(); ++i)
           res.arrayVal.push_back(evalInit(*elements[i], at->elem, solver, store, pc));
@@ -343,8 +693,8 @@ namespace symir {
     // Scalar
     smt::Term val;
     if (iv.kind == InitVal::Kind::Null) {
-      // null pointer: BV64 zero.
-      val = solver.make_bv_value(solver.make_bv_sort(kPtrBits), "0", 10);
+      // null pointer: tag zero.
+      val = solver.make_bv_value(solver.make_bv_sort(ptrBits()), "0", 10);
       return broadcast(t, val, solver);
     }
     if (iv.kind == InitVal::Kind::Int) {
@@ -372,578 +722,751 @@ namespace symir {
     return broadcast(t, val, solver);
   }
 
-  SymbolicExecutor::Result SymbolicExecutor::solve(
-      const std::string &funcName, const std::vector<std::string> &path,
-      const std::unordered_map<std::string, int64_t> &fixedSyms
+  std::unique_ptr<smt::ISolver> SymbolicExecutor::makeSolver() {
+    std::unique_ptr<smt::ISolver> backend;
+    if (attemptTimeoutMs_) {
+      Config cfg = config_;
+      cfg.timeout_ms = attemptTimeoutMs_;
+      backend = solverFactory_(cfg);
+    } else {
+      backend = solverFactory_(config_);
+    }
+    if (!config_.term_builder)
+      return backend;
+    return std::make_unique<solver::TermBuilder>(std::move(backend), &termCounters_);
+  }
+
+  void SymbolicExecutor::encodeEntry(
+      const FunDecl &fun, smt::ISolver &solver, SymbolicStore &store,
+      std::vector<smt::Term> &pathConstraints,
+      const std::unordered_map<std::string, int64_t> &fixedSyms,
+      const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges
   ) {
+    // 1. Declare symbols and fix values if requested
+    for (const auto &s: fun.syms) {
+      const IntervalAnalysis::Interval *range = nullptr;
+      if (symRanges)
+        if (auto it = symRanges->find(s.name.name); it != symRanges->end())
+          range = &it->second;
+      declareSym(s, solver, store, pathConstraints, fixedSyms, range);
+    }
 
-    const FunDecl *entry = nullptr;
-    for (const auto &f: prog_.funs) {
-      if (f.name.name == funcName) {
-        entry = &f;
-        break;
+    // 2. Declare locals (parameters are also in store)
+    for (const auto &p: fun.params) {
+      store[p.name.name] = createSymbolicValue(p.type, p.name.name, solver);
+    }
+    for (const auto &l: fun.lets) {
+      if (l.init) {
+        store[l.name.name] = evalInit(*l.init, l.type, solver, store, pathConstraints);
+      } else {
+        store[l.name.name] = makeUndef(l.type, solver);
       }
     }
-    if (!entry)
-      throw std::runtime_error("Function not found: " + funcName);
-
-    // Make the current FunDecl visible to evalAtom/StoreInstr handlers via
-    // thread_local storage. Restored on scope exit so nested or concurrent
-    // solve() invocations on different threads see their own value.
-    struct FunGuard {
-      const FunDecl *prev;
-
-      ~FunGuard() { SymbolicExecutor::currentFun_ = prev; }
-    } funGuard{currentFun_};
-
-    currentFun_ = entry;
-
-    auto solverPtr = solverFactory_(config_);
-    smt::ISolver &solver = *solverPtr;
-
-    SymbolicStore store;
-    std::vector<smt::Term> pathConstraints;
-    std::vector<smt::Term> requirements;
 
-    // [v0.2.1] Reset per-solve provenance tracking. Each call to solve()
-    // walks a fresh CFG path, so prior provenance state must not leak.
-    ptrProv_.clear();
+    // 3. The SSA values on entry: lets' initializers (params are consts).
+    if (ssaPath_)
+      for (std::size_t k = 0; k < fun.lets.size(); ++k)
+        if (ssaPath_->form->isVar(k))
+          defineSsaValue(
+              ssaPath_->form->entryValue(k), store.at(fun.lets[k].name.name), solver,
+              pathConstraints
+          );
+  }
 
-    // 1. Declare symbols and fix values if requested
-    for (const auto &s: entry->syms) {
-      auto sv = createSymbolicValue(s.type, s.name.name, solver, true);
-      store[s.name.name] = sv;
-
-      // [v0.2.1] Vector sym: collect the per-lane terms so the domain/fix
-      // logic below can apply constraints per lane. For scalar sym this
-      // is just `{sv.term}` (one element).
-      std::vector<smt::Term> symLaneTerms;
-      TypePtr symLaneType;
-      if (sv.kind == SymbolicValue::Kind::Vec) {
-        for (const auto &lane: sv.arrayVal)
-          symLaneTerms.push_back(lane.term);
-        if (auto vt = std::get_if<VecType>(&s.type->v))
-          symLaneType = vt->elem;
-      } else {
-        symLaneTerms.push_back(sv.term);
-        symLaneType = s.type;
-      }
+  void SymbolicExecutor::declareSym(
+      const SymDecl &s, smt::ISolver &solver, SymbolicStore &store,
+      std::vector<smt::Term> &pathConstraints,
+      const std::unordered_map<std::string, int64_t> &fixedSyms,
+      const IntervalAnalysis::Interval *range
+  ) {
+    auto sv = createSymbolicValue(s.type, s.name.name, solver, true);
+    bool narrowed = sv.kind == SymbolicValue::Kind::Int && config_.narrow_syms &&
+                    narrowSym(s, range, solver, sv, pathConstraints);
+    store[s.name.name] = sv;
+
+    // [v0.2.1] Vector sym: collect the per-lane terms so the domain/fix
+    // logic below can apply constraints per lane. For scalar sym this
+    // is just `{sv.term}` (one element).
+    std::vector<smt::Term> symLaneTerms;
+    TypePtr symLaneType;
+    if (sv.kind == SymbolicValue::Kind::Vec) {
+      for (const auto &lane: sv.arrayVal)
+        symLaneTerms.push_back(lane.term);
+      if (auto vt = std::get_if<VecType>(&s.type->v))
+        symLaneType = vt->elem;
+    } else {
+      symLaneTerms.push_back(sv.term);
+      symLaneType = s.type;
+    }
 
-      // Add domain constraints
-      if (s.domain) {
-        std::visit(
-            [&](auto &&d) {
-              using T = std::decay_t<decltype(d)>;
-              // Domain constraints apply per-lane for vector syms (§3.4.1
-              // says each lane gets the same domain).
-              auto laneSort = getSort(symLaneType, solver);
-              if constexpr (std::is_same_v<T, DomainInterval>) {
-                uint32_t bits = 64;
-                if (auto *it = std::get_if<IntType>(&symLaneType->v)) {
-                  switch (it->kind) {
-                    case IntType::Kind::I32:
-                      bits = 32;
-                      break;
-                    case IntType::Kind::I64:
-                      bits = 64;
-                      break;
-                    case IntType::Kind::ICustom:
-                      bits = it->bits.value_or(32);
-                      break;
-                  }
+    // Add domain constraints
+    if (s.domain && !narrowed) {
+      std::visit(
+          [&](auto &&d) {
+            using T = std::decay_t<decltype(d)>;
+            // Domain constraints apply per-lane for vector syms (§3.4.1
+            // says each lane gets the same domain).
+            auto laneSort = getSort(symLaneType, solver);
+            if constexpr (std::is_same_v<T, DomainInterval>) {
+              uint32_t bits = 64;
+              if (auto *it = std::get_if<IntType>(&symLaneType->v)) {
+                switch (it->kind) {
+                  case IntType::Kind::I32:
+                    bits = 32;
+                    break;
+                  case IntType::Kind::I64:
+                    bits = 64;
+                    break;
+                  case IntType::Kind::ICustom:
+                    bits = it->bits.value_or(32);
+                    break;
                 }
-                int64_t effLo = d.lo, effHi = d.hi;
-                if (bits < 64) {
-                  int64_t typeLo = -(1LL << (bits - 1));
-                  int64_t typeHi = (1LL << (bits - 1)) - 1;
-                  effLo = std::max(effLo, typeLo);
-                  effHi = std::min(effHi, typeHi);
+              }
+              int64_t effLo = d.lo, effHi = d.hi;
+              if (bits < 64) {
+                int64_t typeLo = -(1LL << (bits - 1));
+                int64_t typeHi = (1LL << (bits - 1)) - 1;
+                effLo = std::max(effLo, typeLo);
+                effHi = std::min(effHi, typeHi);
+              }
+              if (effLo <= effHi) {
+                auto lo = solver.make_bv_value_int64(laneSort, effLo);
+                auto hi = solver.make_bv_value_int64(laneSort, effHi);
+                for (const auto &t: symLaneTerms) {
+                  pathConstraints.push_back(solver.make_term(smt::Kind::BV_SLE, {lo, t}));
+                  pathConstraints.push_back(solver.make_term(smt::Kind::BV_SLE, {t, hi}));
                 }
-                if (effLo <= effHi) {
-                  auto lo = solver.make_bv_value_int64(laneSort, effLo);
-                  auto hi = solver.make_bv_value_int64(laneSort, effHi);
-                  for (const auto &t: symLaneTerms) {
-                    pathConstraints.push_back(solver.make_term(smt::Kind::BV_SLE, {lo, t}));
-                    pathConstraints.push_back(solver.make_term(smt::Kind::BV_SLE, {t, hi}));
-                  }
+              }
+            } else if constexpr (std::is_same_v<T, DomainSet>) {
+              for (const auto &t: symLaneTerms) {
+                std::vector<smt::Term> or_terms;
+                for (auto v: d.values) {
+                  auto vt = solver.make_bv_value_int64(laneSort, v);
+                  or_terms.push_back(solver.make_term(smt::Kind::EQUAL, {t, vt}));
                 }
-              } else if constexpr (std::is_same_v<T, DomainSet>) {
-                for (const auto &t: symLaneTerms) {
-                  std::vector<smt::Term> or_terms;
-                  for (auto v: d.values) {
-                    auto vt = solver.make_bv_value_int64(laneSort, v);
-                    or_terms.push_back(solver.make_term(smt::Kind::EQUAL, {t, vt}));
-                  }
-                  if (!or_terms.empty()) {
-                    smt::Term or_all = or_terms[0];
-                    for (size_t i = 1; i < or_terms.size(); ++i)
-                      or_all = solver.make_term(smt::Kind::OR, {or_all, or_terms[i]});
-                    pathConstraints.push_back(or_all);
-                  }
+                if (!or_terms.empty()) {
+                  smt::Term or_all = or_terms[0];
+                  for (size_t i = 1; i < or_terms.size(); ++i)
+                    or_all = solver.make_term(smt::Kind::OR, {or_all, or_terms[i]});
+                  pathConstraints.push_back(or_all);
                 }
               }
-            },
-            *s.domain
-        );
-      }
+            }
+          },
+          *s.domain
+      );
+    }
 
-      if (fixedSyms.count(s.name.name)) {
-        auto val =
-            solver.make_bv_value_int64(getSort(symLaneType, solver), fixedSyms.at(s.name.name));
-        for (const auto &t: symLaneTerms)
-          pathConstraints.push_back(solver.make_term(smt::Kind::EQUAL, {t, val}));
-      }
+    // The range the interval pre-pass narrowed the sym to holds in every
+    // model of the path; asserting it up front helps the backend prune.
+    if (range && !narrowed && sv.kind == SymbolicValue::Kind::Int) {
+      auto sort = solver.get_sort(sv.term);
+      auto lo = solver.make_bv_value_int64(sort, range->lo);
+      auto hi = solver.make_bv_value_int64(sort, range->hi);
+      pathConstraints.push_back(solver.make_term(smt::Kind::BV_SLE, {lo, sv.term}));
+      pathConstraints.push_back(solver.make_term(smt::Kind::BV_SLE, {sv.term, hi}));
     }
 
-    // 2. Declare locals (parameters are also in store)
-    for (const auto &p: entry->params) {
-      store[p.name.name] = createSymbolicValue(p.type, p.name.name, solver);
+    if (fixedSyms.count(s.name.name)) {
+      auto val =
+          solver.make_bv_value_int64(getSort(symLaneType, solver), fixedSyms.at(s.name.name));
+      for (const auto &t: symLaneTerms)
+        pathConstraints.push_back(solver.make_term(smt::Kind::EQUAL, {t, val}));
     }
-    for (const auto &l: entry->lets) {
-      if (l.init) {
-        store[l.name.name] = evalInit(*l.init, l.type, solver, store, pathConstraints);
+  }
+
+  bool SymbolicExecutor::narrowSym(
+      const SymDecl &s, const IntervalAnalysis::Interval *range, smt::ISolver &solver,
+      SymbolicValue &sv, std::vector<smt::Term> &pathConstraints
+  ) {
+    auto *it = std::get_if<IntType>(&s.type->v);
+    if (!it || (!s.domain && !range))
+      return false;
+    uint32_t bits = it->bits.value_or(32);
+    if (it->kind != IntType::Kind::ICustom)
+      bits = it->kind == IntType::Kind::I64 ? 64 : 32;
+    int64_t lo = bits >= 64 ? INT64_MIN : -(int64_t(1) << (bits - 1));
+    int64_t hi = bits >= 64 ? INT64_MAX : (int64_t(1) << (bits - 1)) - 1;
+    if (range) {
+      lo = std::max(lo, range->lo);
+      hi = std::min(hi, range->hi);
+    }
+    auto sort = solver.get_sort(sv.term);
+    const std::string name = s.name.name + ".n";
+    auto narrow = std::make_shared<NarrowSym>();
+    smt::Term value;
+    std::vector<smt::Term> bounds; // what the encoding does not imply
+
+    if (auto *set = s.domain ? std::get_if<DomainSet>(&*s.domain) : nullptr) {
+      // ite(n == 0, v0, ite(n == 1, v1, ... v[k-1])) over the distinct
+      // members in range: every selector value picks one of them.
+      std::vector<int64_t> values;
+      for (int64_t v: set->values) {
+        if (bits < 64) // as the type holds it
+          v = static_cast<int64_t>(static_cast<uint64_t>(v) << (64 - bits)) >> (64 - bits);
+        if (lo <= v && v <= hi && std::find(values.begin(), values.end(), v) == values.end())
+          values.push_back(v);
+      }
+      if (values.empty())
+        return false;
+      value = solver.make_bv_value_int64(sort, values.back());
+      narrow->key = value;
+      if (values.size() > 1) {
+        narrow->bits = std::bit_width(values.size() - 1);
+        auto selSort = solver.make_bv_sort(narrow->bits);
+        smt::Term sel = solver.make_const(selSort, name);
+        narrow->key = sel;
+        for (std::size_t k = values.size() - 1; k-- > 0;) {
+          auto pick =
+              solver.make_term(smt::Kind::EQUAL, {sel, solver.make_bv_value_uint64(selSort, k)});
+          value = solver.make_term(
+              smt::Kind::ITE, {pick, solver.make_bv_value_int64(sort, values[k]), value}
+          );
+        }
+      }
+      narrow->values = std::move(values);
+    } else {
+      if (s.domain) {
+        const auto &d = std::get<DomainInterval>(*s.domain);
+        lo = std::max(lo, d.lo);
+        hi = std::min(hi, d.hi);
+      }
+      if (lo > hi)
+        return false;
+      // Zero-extended if lo >= 0, else sign-extended, unless lo plus a
+      // zero-extended offset takes fewer bits (as for [lo, hi] far from 0).
+      const auto ubits = [](uint64_t v) { return static_cast<uint32_t>(std::bit_width(v)); };
+      uint32_t w = lo >= 0 ? ubits(static_cast<uint64_t>(hi))
+                           : 1 + std::max(ubits(~static_cast<uint64_t>(lo)),
+                                          hi < 0 ? 0 : ubits(static_cast<uint64_t>(hi)));
+      w = std::max<uint32_t>(w, 1);
+      const uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+      const uint32_t offsetBits = std::max<uint32_t>(ubits(span), 1);
+      const bool offset = offsetBits < w;
+      if (offset)
+        w = offsetBits;
+      if (w >= bits)
+        return false;
+      auto nSort = solver.make_bv_sort(w);
+      smt::Term n = solver.make_const(nSort, name);
+      narrow->key = n;
+      narrow->bits = w;
+      // The bounds of [lo, hi] the w bits do not hold, compared on n.
+      const uint64_t max = w >= 64 ? UINT64_MAX : (uint64_t(1) << w) - 1;
+      if (offset) {
+        value = solver.make_term(
+            smt::Kind::BV_ADD, {solver.make_bv_value_int64(sort, lo),
+                                solver.make_term(smt::Kind::BV_ZERO_EXTEND, {n}, {bits - w})}
+        );
+        narrow->offset = lo;
+        if (span < max)
+          bounds.push_back(solver.make_term(
+              smt::Kind::BV_ULE, {n, solver.make_bv_value_uint64(nSort, span)}
+          ));
+      } else if (lo >= 0) {
+        value = solver.make_term(smt::Kind::BV_ZERO_EXTEND, {n}, {bits - w});
+        if (lo > 0)
+          bounds.push_back(solver.make_term(
+              smt::Kind::BV_ULE, {solver.make_bv_value_uint64(nSort, lo), n}
+          ));
+        if (static_cast<uint64_t>(hi) < max)
+          bounds.push_back(solver.make_term(
+              smt::Kind::BV_ULE, {n, solver.make_bv_value_uint64(nSort, hi)}
+          ));
       } else {
-        store[l.name.name] = makeUndef(l.type, solver);
+        value = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {n}, {bits - w});
+        narrow->sign = true;
+        if (lo > -static_cast<int64_t>(max / 2) - 1)
+          bounds.push_back(solver.make_term(
+              smt::Kind::BV_SLE, {solver.make_bv_value_int64(nSort, lo), n}
+          ));
+        if (hi < static_cast<int64_t>(max / 2))
+          bounds.push_back(solver.make_term(
+              smt::Kind::BV_SLE, {n, solver.make_bv_value_int64(nSort, hi)}
+          ));
       }
     }
 
-    // 3. CFG Build for label mapping
-    DiagBag diags;
-    CFG cfg = CFG::build(*entry, diags);
-    if (diags.hasErrors())
-      throw std::runtime_error("CFG build failed");
+    sv.term = value;
+    sv.narrow = std::move(narrow);
+    pathConstraints.insert(pathConstraints.end(), bounds.begin(), bounds.end());
+    return true;
+  }
 
-    // 4. Path traversal
-    for (size_t i = 0; i < path.size(); ++i) {
-      const std::string &label = path[i];
-      if (cfg.indexOf.find(label) == cfg.indexOf.end())
-        throw std::runtime_error("Invalid block label in path: " + label);
+  int64_t SymbolicExecutor::NarrowSym::decode(int64_t raw) const {
+    uint64_t u = static_cast<uint64_t>(raw);
+    if (bits < 64)
+      u &= (uint64_t(1) << bits) - 1;
+    if (!values.empty())
+      return values[std::min<uint64_t>(u, values.size() - 1)];
+    return offset + (sign ? raw : static_cast<int64_t>(u));
+  }
 
-      const Block &block = entry->blocks[cfg.indexOf.at(label)];
+  void SymbolicExecutor::defineSsaValue(
+      std::size_t value, SymbolicValue &sv, smt::ISolver &solver, std::vector<smt::Term> &pc
+  ) {
+    std::uint32_t n = ssaPath_->defined[value]++;
+    if (sv.kind != SymbolicValue::Kind::Int || !sv.term)
+      return;
+    if (auto *tb = dynamic_cast<const solver::TermBuilder *>(&solver))
+      if (tb->isConst(sv.term) || (!tb->kind(sv.term) && tb->operands(sv.term).empty()))
+        return;
+    std::string name = ssaPath_->form->name(value);
+    if (n > 0)
+      name += "#" + std::to_string(n + 1);
+    smt::Term c = solver.make_const(solver.get_sort(sv.term), name);
+    pc.push_back(solver.make_term(smt::Kind::EQUAL, {c, sv.term}));
+    sv.term = c;
+  }
 
-      for (const auto &ins: block.instrs) {
-        std::visit(
-            [&](auto &&arg) {
-              using T = std::decay_t<decltype(arg)>;
-              if constexpr (std::is_same_v<T, AssignInstr>) {
-                auto lhsVal =
-                    evalLValue(arg.lhs, solver, store, pathConstraints, /*forWrite=*/true);
-                // [v0.2.1] Vector LHS: evaluate RHS as a SymbolicValue::Vec.
-                if (lhsVal.kind == SymbolicValue::Kind::Vec && arg.lhs.accesses.empty()) {
-                  // Find the LHS local's declared VecType.
-                  TypePtr lhsType;
-                  if (currentFun_) {
-                    for (const auto &l: currentFun_->lets)
-                      if (l.name.name == arg.lhs.base.name) {
-                        lhsType = l.type;
-                        break;
-                      }
-                    if (!lhsType)
-                      for (const auto &p: currentFun_->params)
-                        if (p.name.name == arg.lhs.base.name) {
-                          lhsType = p.type;
-                          break;
-                        }
-                  }
-                  if (lhsType && std::holds_alternative<VecType>(lhsType->v)) {
-                    auto &vt = std::get<VecType>(lhsType->v);
-                    SymbolicValue rhsV = evalVecExpr(arg.rhs, vt, solver, store, pathConstraints);
-                    setLValue(arg.lhs, rhsV, solver, store, pathConstraints);
-                    return;
-                  }
+  void SymbolicExecutor::encodeBlock(
+      const Block &block, const std::string &label, const std::string *nextLabel,
+      smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pathConstraints,
+      std::vector<smt::Term> &requirements, std::size_t firstInstr, bool terminator
+  ) {
+    // Config::ssa: the phis of the block take the values the store holds
+    // on the edge the path came in by.
+    std::size_t blockIdx = currentFun_ ? &block - currentFun_->blocks.data() : 0;
+    if (ssaPath_ && firstInstr == 0)
+      for (const auto &phi: ssaPath_->form->phis(blockIdx)) {
+        Symbol local = ssaPath_->form->local(ssaPath_->form->values()[phi.value].var);
+        defineSsaValue(phi.value, store.at(local), solver, pathConstraints);
+      }
+    for (std::size_t n = firstInstr; n < block.instrs.size(); ++n) {
+      chargeMemory();
+      const Instr &ins = block.instrs[n];
+      std::visit(
+          [&](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, AssignInstr>) {
+              auto lhsVal =
+                  evalLValue(arg.lhs, solver, store, pathConstraints, /*forWrite=*/true);
+              // [v0.2.1] Vector LHS: evaluate RHS as a SymbolicValue::Vec.
+              if (lhsVal.kind == SymbolicValue::Kind::Vec && arg.lhs.accesses.empty()) {
+                // Find the LHS local's declared VecType.
+                TypePtr lhsType;
+                if (auto *local = currentLocal(arg.lhs.base.name))
+                  lhsType = local->type;
+                if (lhsType && std::holds_alternative<VecType>(lhsType->v)) {
+                  auto &vt = std::get<VecType>(lhsType->v);
+                  SymbolicValue rhsV = evalVecExpr(arg.rhs, vt, solver, store, pathConstraints);
+                  setLValue(arg.lhs, rhsV, solver, store, pathConstraints);
+                  return;
                 }
-                auto rhs = evalExpr(
-                    arg.rhs, solver, store, pathConstraints,
-                    lhsVal.kind == SymbolicValue::Kind::Int
-                        ? std::optional(solver.get_sort(lhsVal.term))
-                        : std::nullopt
-                );
-                setLValue(arg.lhs, rhs, solver, store, pathConstraints);
-                // [v0.2.1] Track ptr provenance for cross-object and one-
-                // past-end UB checks. The LHS is either a whole-local ptr
-                // or a ptr-typed struct field path (`%s.p1`); we mirror
-                // the RHS atom's provenance (addr / ptrindex / ptrfield
-                // set a known provenance, pointer arithmetic preserves
-                // it, load-derived ptrs are unknown).
-                if (currentFun_) {
-                  // Resolve the LHS type by walking accesses.
-                  auto resolveLhsType = [&]() -> TypePtr {
-                    TypePtr cur;
-                    for (const auto &l: currentFun_->lets)
-                      if (l.name.name == arg.lhs.base.name) {
-                        cur = l.type;
-                        break;
-                      }
+              }
+              auto rhs = evalExpr(
+                  arg.rhs, solver, store, pathConstraints,
+                  lhsVal.kind == SymbolicValue::Kind::Int
+                      ? std::optional(solver.get_sort(lhsVal.term))
+                      : std::nullopt
+              );
+              setLValue(arg.lhs, rhs, solver, store, pathConstraints);
+              if (ssaPath_) {
+                std::size_t v = ssaPath_->form->def(blockIdx, &ins - block.instrs.data());
+                if (v != SSAForm::npos)
+                  defineSsaValue(v, store.at(arg.lhs.base.name), solver, pathConstraints);
+              }
+              // [v0.2.1] Track ptr provenance for cross-object and one-
+              // past-end UB checks. The LHS is either a whole-local ptr
+              // or a ptr-typed struct field path (`%s.p1`); we mirror
+              // the RHS atom's provenance (addr / ptrindex / ptrfield
+              // set a known provenance, pointer arithmetic preserves
+              // it, load-derived ptrs are unknown).
+              if (currentFun_) {
+                // Resolve the LHS type by walking accesses.
+                auto resolveLhsType = [&]() -> TypePtr {
+                  if (prog_.types)
+                    if (auto t = prog_.types->of(arg.lhs))
+                      return t;
+                  TypePtr cur;
+                  if (auto *local = currentLocal(arg.lhs.base.name))
+                    cur = local->type;
+                  for (const auto &acc: arg.lhs.accesses) {
                     if (!cur)
-                      for (const auto &p: currentFun_->params)
-                        if (p.name.name == arg.lhs.base.name) {
-                          cur = p.type;
-                          break;
-                        }
-                    for (const auto &acc: arg.lhs.accesses) {
-                      if (!cur)
+                      return nullptr;
+                    if (auto af = std::get_if<AccessField>(&acc)) {
+                      auto st = std::get_if<StructType>(&cur->v);
+                      if (!st)
+                        return nullptr;
+                      auto lIt = layouts_.find(st->name.name);
+                      if (lIt == layouts_.end())
+                        return nullptr;
+                      auto fIt = lIt->second.fields.find(af->field);
+                      cur = fIt == lIt->second.fields.end() ? nullptr : fIt->second.type;
+                    } else if (auto ai = std::get_if<AccessIndex>(&acc)) {
+                      (void) ai;
+                      if (auto at = std::get_if<ArrayType>(&cur->v))
+                        cur = at->elem;
+                      else if (auto vt = std::get_if<VecType>(&cur->v))
+                        cur = vt->elem;
+                      else
                         return nullptr;
-                      if (auto af = std::get_if<AccessField>(&acc)) {
-                        auto st = std::get_if<StructType>(&cur->v);
-                        if (!st)
-                          return nullptr;
-                        auto sIt = structs_.find(st->name.name);
-                        if (sIt == structs_.end())
-                          return nullptr;
-                        cur = nullptr;
-                        for (const auto &f: sIt->second->fields)
-                          if (f.name == af->field) {
-                            cur = f.type;
-                            break;
-                          }
-                      } else if (auto ai = std::get_if<AccessIndex>(&acc)) {
-                        (void) ai;
-                        if (auto at = std::get_if<ArrayType>(&cur->v))
-                          cur = at->elem;
-                        else if (auto vt = std::get_if<VecType>(&cur->v))
-                          cur = vt->elem;
-                        else
-                          return nullptr;
-                      }
                     }
-                    return cur;
-                  };
-                  auto isPtr = [&]() {
-                    auto t = resolveLhsType();
-                    return t && std::holds_alternative<PtrType>(t->v);
-                  };
-                  auto buildLhsKey = [&]() -> std::string {
-                    // Only field-keyed accesses (no dynamic indices).
-                    std::string key = arg.lhs.base.name;
-                    for (const auto &acc: arg.lhs.accesses) {
-                      if (auto af = std::get_if<AccessField>(&acc)) {
-                        key += "." + af->field;
-                      } else {
-                        return {};
-                      }
+                  }
+                  return cur;
+                };
+                auto isPtr = [&]() {
+                  auto t = resolveLhsType();
+                  return t && std::holds_alternative<PtrType>(t->v);
+                };
+                auto buildLhsKey = [&]() -> std::string {
+                  // Only field-keyed accesses (no dynamic indices).
+                  std::string key = arg.lhs.base.name;
+                  for (const auto &acc: arg.lhs.accesses) {
+                    if (auto af = std::get_if<AccessField>(&acc)) {
+                      key += "." + af->field;
+                    } else {
+                      return {};
                     }
-                    return key;
+                  }
+                  return key;
+                };
+                std::string lhsKey = isPtr() ? buildLhsKey() : "";
+                if (!lhsKey.empty()) {
+                  auto provFromName =
+                      [&](const std::string &src) -> std::optional<PtrProvenance> {
+                    auto it = ptrProv_.find(src);
+                    if (it != ptrProv_.end())
+                      return it->second;
+                    return std::nullopt;
                   };
-                  std::string lhsKey = isPtr() ? buildLhsKey() : "";
-                  if (!lhsKey.empty()) {
-                    auto provFromName =
-                        [&](const std::string &src) -> std::optional<PtrProvenance> {
-                      auto it = ptrProv_.find(src);
-                      if (it != ptrProv_.end())
-                        return it->second;
-                      return std::nullopt;
-                    };
-                    auto compute = [&]() -> std::optional<PtrProvenance> {
-                      if (arg.rhs.rest.empty()) {
-                        const auto &a = arg.rhs.first.v;
-                        if (auto addr = std::get_if<AddrAtom>(&a)) {
-                          // Provenance = the addressed local; size is the
-                          // immediate containing object's total tag-unit
-                          // span (spec rule 15). For `addr %arr[k]` that
-                          // remains the whole array; for `addr %s.f` the
-                          // whole struct.
-                          uint64_t baseTag = tagOfLocal(addr->lv.base.name);
-                          TypePtr ty;
-                          for (const auto &l: currentFun_->lets)
-                            if (l.name.name == addr->lv.base.name) {
-                              ty = l.type;
-                              break;
-                            }
-                          if (!ty)
-                            for (const auto &p: currentFun_->params)
-                              if (p.name.name == addr->lv.base.name) {
-                                ty = p.type;
-                                break;
-                              }
-                          std::uint64_t size = sizeofTagUnits(ty, structs_);
-                          return PtrProvenance{baseTag, size};
-                        }
-                        if (auto pi = std::get_if<PtrIndexAtom>(&a)) {
-                          // [v0.2.1 fix] Narrow provenance for ptrindex.
-                          // The result pointer's provenance = the array the
-                          // source points to. Compute the narrowed sub-array
-                          // range from the source's type (ptr [N] T).
-                          auto srcProv = provFromName(buildLValueKey(pi->rval));
-                          if (srcProv && currentFun_) {
-                            TypePtr baseType = resolveLValueType(pi->rval);
-                            if (baseType) {
-                              if (auto pt = std::get_if<PtrType>(&baseType->v)) {
-                                if (auto at = std::get_if<ArrayType>(&pt->pointee->v)) {
-                                  // Narrowed size = N * sizeofTagUnits(T)
-                                  std::uint64_t elemUnits = sizeofTagUnits(at->elem, structs_);
-                                  std::uint64_t narrowSize = at->size * elemUnits;
-                                  // The narrowed base = source ptrVal at
-                                  // assignment time. We don't have the
-                                  // concrete tag here, so approximate:
-                                  // baseTag stays at the source's base but
-                                  // size is narrowed.
-                                  return PtrProvenance{srcProv->baseTag, narrowSize};
-                                }
+                  auto compute = [&]() -> std::optional<PtrProvenance> {
+                    if (arg.rhs.rest.empty()) {
+                      const auto &a = arg.rhs.first.v;
+                      if (auto addr = std::get_if<AddrAtom>(&a)) {
+                        // Provenance = the addressed local; size is the
+                        // immediate containing object's total tag-unit
+                        // span (spec rule 15). For `addr %arr[k]` that
+                        // remains the whole array; for `addr %s.f` the
+                        // whole struct.
+                        const auto *local = currentLocal(addr->lv.base.name);
+                        if (!local)
+                          throw std::runtime_error("addr of unknown local: " + addr->lv.base.name);
+                        uint64_t baseTag = local->tag;
+                        TypePtr ty = local->type;
+                        std::uint64_t size = tagUnits(ty);
+                        return PtrProvenance{baseTag, size};
+                      }
+                      if (auto pi = std::get_if<PtrIndexAtom>(&a)) {
+                        // [v0.2.1 fix] Narrow provenance for ptrindex.
+                        // The result pointer's provenance = the array the
+                        // source points to. Compute the narrowed sub-array
+                        // range from the source's type (ptr [N] T).
+                        auto srcProv = provFromName(buildLValueKey(pi->rval));
+                        if (srcProv && currentFun_) {
+                          TypePtr baseType = resolveLValueType(pi->rval);
+                          if (baseType) {
+                            if (auto pt = std::get_if<PtrType>(&baseType->v)) {
+                              if (auto at = std::get_if<ArrayType>(&pt->pointee->v)) {
+                                // Narrowed size = N * sizeofTagUnits(T)
+                                std::uint64_t elemUnits = tagUnits(at->elem);
+                                std::uint64_t narrowSize = at->size * elemUnits;
+                                // The narrowed base = source ptrVal at
+                                // assignment time. We don't have the
+                                // concrete tag here, so approximate:
+                                // baseTag stays at the source's base but
+                                // size is narrowed.
+                                return PtrProvenance{srcProv->baseTag, narrowSize};
                               }
                             }
                           }
-                          return srcProv;
-                        }
-                        if (auto pf = std::get_if<PtrFieldAtom>(&a))
-                          return provFromName(buildLValueKey(pf->rval));
-                        if (auto ca = std::get_if<CoefAtom>(&a)) {
-                          if (auto id = std::get_if<LocalOrSymId>(&ca->coef))
-                            if (auto lid = std::get_if<LocalId>(id))
-                              return provFromName(lid->name);
-                        }
-                        if (auto rv = std::get_if<RValueAtom>(&a)) {
-                          return provFromName(buildLValueKey(rv->rval));
-                        }
-                        // LoadAtom-derived ptrs: provenance unknown.
-                      } else {
-                        // `%p = %q + i` style: provenance carries from %q.
-                        const auto &a = arg.rhs.first.v;
-                        if (auto ca = std::get_if<CoefAtom>(&a)) {
-                          if (auto id = std::get_if<LocalOrSymId>(&ca->coef))
-                            if (auto lid = std::get_if<LocalId>(id))
-                              return provFromName(lid->name);
-                        }
-                        if (auto rv = std::get_if<RValueAtom>(&a)) {
-                          return provFromName(buildLValueKey(rv->rval));
                         }
+                        return srcProv;
                       }
-                      return std::nullopt;
-                    };
-                    auto newProv = compute();
-                    if (newProv)
-                      ptrProv_[lhsKey] = *newProv;
-                    else
-                      ptrProv_.erase(lhsKey);
+                      if (auto pf = std::get_if<PtrFieldAtom>(&a))
+                        return provFromName(buildLValueKey(pf->rval));
+                      if (auto ca = std::get_if<CoefAtom>(&a)) {
+                        if (auto id = std::get_if<LocalOrSymId>(&ca->coef))
+                          if (auto lid = std::get_if<LocalId>(id))
+                            return provFromName(lid->name);
+                      }
+                      if (auto rv = std::get_if<RValueAtom>(&a)) {
+                        return provFromName(buildLValueKey(rv->rval));
+                      }
+                      // LoadAtom-derived ptrs: provenance unknown.
+                    } else {
+                      // `%p = %q + i` style: provenance carries from %q.
+                      const auto &a = arg.rhs.first.v;
+                      if (auto ca = std::get_if<CoefAtom>(&a)) {
+                        if (auto id = std::get_if<LocalOrSymId>(&ca->coef))
+                          if (auto lid = std::get_if<LocalId>(id))
+                            return provFromName(lid->name);
+                      }
+                      if (auto rv = std::get_if<RValueAtom>(&a)) {
+                        return provFromName(buildLValueKey(rv->rval));
+                      }
+                    }
+                    return std::nullopt;
+                  };
+                  auto newProv = compute();
+                  if (newProv)
+                    ptrProv_[lhsKey] = *newProv;
+                  else
+                    ptrProv_.erase(lhsKey);
+                }
+              }
+            } else if constexpr (std::is_same_v<T, AssumeInstr>) {
+              pathConstraints.push_back(evalCond(arg.cond, solver, store, pathConstraints));
+            } else if constexpr (std::is_same_v<T, RequireInstr>) {
+              requirements.push_back(evalCond(arg.cond, solver, store, pathConstraints));
+            } else if constexpr (std::is_same_v<T, StoreInstr>) {
+              // store %p, %v — mux-update every candidate target's value:
+              //   for each %t of pointee type it may address:
+              //     %t := ite(p == tag_t, v, %t)
+              if (!currentFun_)
+                throw std::runtime_error("store encountered without active FunDecl");
+
+              // Evaluate ptr term (BV64) and stored value term.
+              SymbolicValue ptrVal = evalExpr(arg.ptr, solver, store, pathConstraints);
+              smt::Term ptrTerm = ptrVal.term;
+
+              // [v0.2.1] Rule 9/11: store through null or OOB is UB.
+              // The evalExpr above already pushes rule-10 OOB constraints
+              // for ptr-arith expressions, but a bare `store %pa, v`
+              // where %pa was set earlier still needs a null check.
+              auto bv64Store = solver.make_bv_sort(ptrBits());
+              auto nullStore = solver.make_bv_value_int64(bv64Store, 0);
+              pathConstraints.push_back(
+                  solver.make_term(smt::Kind::DISTINCT, {ptrTerm, nullStore})
+              );
+
+              if (ptrVal.prov_base && ptrVal.prov_size) {
+                auto zero = solver.make_bv_value_int64(bv64Store, 0);
+                auto hasProv = solver.make_term(smt::Kind::DISTINCT, {ptrVal.prov_base, zero});
+                auto inBoundsLower =
+                    solver.make_term(smt::Kind::BV_ULE, {ptrVal.prov_base, ptrTerm});
+                auto endAddr =
+                    solver.make_term(smt::Kind::BV_ADD, {ptrVal.prov_base, ptrVal.prov_size});
+                auto inBoundsUpper = solver.make_term(smt::Kind::BV_ULT, {ptrTerm, endAddr});
+                auto cond = solver.make_term(
+                    smt::Kind::IMPLIES,
+                    {hasProv, solver.make_term(smt::Kind::AND, {inBoundsLower, inBoundsUpper})}
+                );
+                pathConstraints.push_back(cond);
+              }
+
+              // Determine pointee type from the ptr expression's first atom.
+              TypePtr pointeeType;
+              if (auto *rv = std::get_if<RValueAtom>(&arg.ptr.first.v)) {
+                TypePtr rvalType = resolveLValueType(rv->rval);
+                if (rvalType) {
+                  if (auto pt = std::get_if<PtrType>(&rvalType->v)) {
+                    pointeeType = pt->pointee;
                   }
                 }
-              } else if constexpr (std::is_same_v<T, AssumeInstr>) {
-                pathConstraints.push_back(evalCond(arg.cond, solver, store, pathConstraints));
-              } else if constexpr (std::is_same_v<T, RequireInstr>) {
-                requirements.push_back(evalCond(arg.cond, solver, store, pathConstraints));
-              } else if constexpr (std::is_same_v<T, StoreInstr>) {
-                // store %p, %v — mux-update every candidate target's value:
-                //   for each %t of pointee type: %t := ite(p == tag_t, v, %t)
-                if (!currentFun_)
-                  throw std::runtime_error("store encountered without active FunDecl");
-
-                // Evaluate ptr term (BV64) and stored value term.
-                SymbolicValue ptrVal = evalExpr(arg.ptr, solver, store, pathConstraints);
-                smt::Term ptrTerm = ptrVal.term;
-
-                // [v0.2.1] Rule 9/11: store through null or OOB is UB.
-                // The evalExpr above already pushes rule-10 OOB constraints
-                // for ptr-arith expressions, but a bare `store %pa, v`
-                // where %pa was set earlier still needs a null check.
-                auto bv64Store = solver.make_bv_sort(kPtrBits);
-                auto nullStore = solver.make_bv_value_int64(bv64Store, 0);
-                pathConstraints.push_back(
-                    solver.make_term(smt::Kind::DISTINCT, {ptrTerm, nullStore})
+              }
+              if (!pointeeType)
+                throw std::runtime_error(
+                    "store: cannot derive pointee type (only `store %p, ...` "
+                    "with a ptr-typed local or parameter %p is currently supported)"
                 );
 
-                if (ptrVal.prov_base.internal && ptrVal.prov_size.internal) {
-                  auto zero = solver.make_bv_value_int64(bv64Store, 0);
-                  auto hasProv = solver.make_term(smt::Kind::DISTINCT, {ptrVal.prov_base, zero});
-                  auto inBoundsLower =
-                      solver.make_term(smt::Kind::BV_ULE, {ptrVal.prov_base, ptrTerm});
-                  auto endAddr =
-                      solver.make_term(smt::Kind::BV_ADD, {ptrVal.prov_base, ptrVal.prov_size});
-                  auto inBoundsUpper = solver.make_term(smt::Kind::BV_ULT, {ptrTerm, endAddr});
+              auto pointeeSort = getSort(pointeeType, solver);
+              SymbolicValue valVal =
+                  evalExpr(arg.val, solver, store, pathConstraints, std::optional(pointeeSort));
+              smt::Term valTerm = valVal.term;
+
+              auto bv64 = solver.make_bv_sort(ptrBits());
+              // Mirror the load enumeration: recurse over (type, value,
+              // offset) so a store can target any scalar leaf of a
+              // nested aggregate — array-of-structs, struct-of-arrays.
+              std::function<void(const TypePtr &, SymbolicValue &, std::uint64_t, std::uint64_t)>
+                  enumStore;
+              std::vector<smt::Term> storeMatchConds;
+              enumStore = [&](const TypePtr &ty, SymbolicValue &sv, std::uint64_t baseTag,
+                              std::uint64_t off) {
+                if (!ty)
+                  return;
+                if (sv.kind == SymbolicValue::Kind::SmtArray) {
+                  // Scalar elements take one tag unit each, so the whole
+                  // array is one range check and one store.
+                  auto at = std::get_if<ArrayType>(&ty->v);
+                  if (!at || !typeMatch(at->elem, pointeeType))
+                    return;
+                  auto firstTag =
+                      solver.make_bv_value_int64(bv64, static_cast<int64_t>(baseTag + off));
+                  auto delta = solver.make_term(smt::Kind::BV_SUB, {ptrTerm, firstTag});
                   auto cond = solver.make_term(
-                      smt::Kind::IMPLIES,
-                      {hasProv, solver.make_term(smt::Kind::AND, {inBoundsLower, inBoundsUpper})}
+                      smt::Kind::BV_ULT, {delta, solver.make_bv_value_uint64(bv64, sv.arraySize)}
                   );
-                  pathConstraints.push_back(cond);
+                  storeMatchConds.push_back(cond);
+                  auto idx = arrayIndexOf(delta, solver);
+                  auto old = solver.make_term(smt::Kind::ARRAY_SELECT, {sv.term, idx});
+                  sv.term = solver.make_term(
+                      smt::Kind::ARRAY_STORE,
+                      {sv.term, idx, solver.make_term(smt::Kind::ITE, {cond, valTerm, old})}
+                  );
+                  return;
                 }
-
-                // Determine pointee type from the ptr expression's first atom.
-                TypePtr pointeeType;
-                if (auto *rv = std::get_if<RValueAtom>(&arg.ptr.first.v)) {
-                  TypePtr rvalType = resolveLValueType(rv->rval);
-                  if (rvalType) {
-                    if (auto pt = std::get_if<PtrType>(&rvalType->v)) {
-                      pointeeType = pt->pointee;
-                    }
+                if (typeMatch(ty, pointeeType)) {
+                  auto tagTerm =
+                      solver.make_bv_value_int64(bv64, static_cast<int64_t>(baseTag + off));
+                  auto cond = solver.make_term(smt::Kind::EQUAL, {ptrTerm, tagTerm});
+                  storeMatchConds.push_back(cond);
+                  sv.term = solver.make_term(smt::Kind::ITE, {cond, valTerm, sv.term});
+                  // A stored pointer brings its provenance along.
+                  if (valVal.prov_base || sv.prov_base) {
+                    auto zero = solver.make_bv_value_int64(bv64, 0);
+                    auto pick = [&](const smt::Term &v, const smt::Term &old) {
+                      return solver.make_term(
+                          smt::Kind::ITE, {cond, v ? v : zero, old ? old : zero}
+                      );
+                    };
+                    sv.prov_base = pick(valVal.prov_base, sv.prov_base);
+                    sv.prov_size = pick(valVal.prov_size, sv.prov_size);
                   }
+                  return;
                 }
-                if (!pointeeType)
-                  throw std::runtime_error(
-                      "store: cannot derive pointee type (only `store %p, ...` "
-                      "with a ptr-typed local or parameter %p is currently supported)"
-                  );
-
-                auto pointeeSort = getSort(pointeeType, solver);
-                SymbolicValue valVal =
-                    evalExpr(arg.val, solver, store, pathConstraints, std::optional(pointeeSort));
-                smt::Term valTerm = valVal.term;
-
-                auto bv64 = solver.make_bv_sort(kPtrBits);
-                // Mirror the load enumeration: recurse over (type, value,
-                // offset) so a store can target any scalar leaf of a
-                // nested aggregate — array-of-structs, struct-of-arrays.
-                std::function<void(const TypePtr &, SymbolicValue &, std::uint64_t, std::uint64_t)>
-                    enumStore;
-                std::vector<smt::Term> storeMatchConds;
-                enumStore = [&](const TypePtr &ty, SymbolicValue &sv, std::uint64_t baseTag,
-                                std::uint64_t off) {
-                  if (!ty)
-                    return;
-                  if (typeMatch(ty, pointeeType)) {
-                    auto tagTerm =
-                        solver.make_bv_value_int64(bv64, static_cast<int64_t>(baseTag + off));
-                    auto cond = solver.make_term(smt::Kind::EQUAL, {ptrTerm, tagTerm});
-                    storeMatchConds.push_back(cond);
-                    sv.term = solver.make_term(smt::Kind::ITE, {cond, valTerm, sv.term});
-                    return;
-                  }
-                  if (auto at = std::get_if<ArrayType>(&ty->v)) {
-                    std::uint64_t stride = sizeofTagUnits(at->elem, structs_);
-                    for (std::uint64_t k = 0; k < at->size && k < sv.arrayVal.size(); ++k)
-                      enumStore(at->elem, sv.arrayVal[k], baseTag, off + k * stride);
-                    return;
-                  }
-                  if (auto st = std::get_if<StructType>(&ty->v)) {
-                    auto sIt = structs_.find(st->name.name);
-                    if (sIt == structs_.end())
-                      return;
-                    std::uint64_t fOff = 0;
-                    for (const auto &f: sIt->second->fields) {
-                      auto fIt = sv.structVal.find(f.name);
-                      if (fIt != sv.structVal.end())
-                        enumStore(f.type, fIt->second, baseTag, off + fOff);
-                      fOff += sizeofTagUnits(f.type, structs_);
-                    }
-                    return;
-                  }
-                };
-                for (const auto &l: currentFun_->lets) {
-                  std::uint64_t baseTag = tagOfLocal(l.name.name);
-                  enumStore(l.type, store.at(l.name.name), baseTag, 0);
-                }
-                // [v0.2.1] Rule 11/15b: the store must land on a valid
-                // T-typed cell — same as load's anyMatch constraint.
-                if (!storeMatchConds.empty()) {
-                  smt::Term anyMatch = storeMatchConds[0];
-                  for (size_t j = 1; j < storeMatchConds.size(); ++j)
-                    anyMatch = solver.make_term(smt::Kind::OR, {anyMatch, storeMatchConds[j]});
-                  pathConstraints.push_back(anyMatch);
+                if (auto at = std::get_if<ArrayType>(&ty->v)) {
+                  std::uint64_t stride = tagUnits(at->elem);
+                  densify(sv, solver);
+                  for (std::uint64_t k = 0; k < at->size && k < sv.arrayVal.size(); ++k)
+                    enumStore(at->elem, sv.arrayVal[k], baseTag, off + k * stride);
+                  return;
                 }
-              }
-            },
-            ins
-        );
-      }
-
-      // Evaluate the terminator. For a conditional br on a non-final block
-      // we also pick a side (then/else) per the path; the cond is evaluated
-      // either way so that any UB triggered by computing the cond (e.g.
-      // rule 14 cross-object pointer compare) is captured as a path
-      // constraint even when the br is the final block.
-      const std::string *nextLabel = (i + 1 < path.size()) ? &path[i + 1] : nullptr;
-      std::visit(
-          [&](auto &&term) {
-            using T = std::decay_t<decltype(term)>;
-            if constexpr (std::is_same_v<T, BrTerm>) {
-              if (term.isConditional) {
-                auto cond = evalCond(*term.cond, solver, store, pathConstraints);
-                if (nextLabel) {
-                  if (term.thenLabel.name == *nextLabel) {
-                    pathConstraints.push_back(cond);
-                  } else if (term.elseLabel.name == *nextLabel) {
-                    pathConstraints.push_back(solver.make_term(smt::Kind::NOT, {cond}));
-                  } else {
-                    throw std::runtime_error(
-                        "Path edge not in CFG: " + label + " -> " + *nextLabel
-                    );
+                if (auto st = std::get_if<StructType>(&ty->v)) {
+                  auto sIt = structs_.find(st->name.name);
+                  if (sIt == structs_.end())
+                    return;
+                  std::uint64_t fOff = 0;
+                  for (const auto &f: sIt->second->fields) {
+                    auto fIt = sv.structVal.find(f.name);
+                    if (fIt != sv.structVal.end())
+                      enumStore(f.type, fIt->second, baseTag, off + fOff);
+                    fOff += tagUnits(f.type);
                   }
+                  return;
                 }
-                // No next block: cond was evaluated for UB side-effects only.
-              } else if (nextLabel) {
-                if (term.dest.name != *nextLabel)
-                  throw std::runtime_error("Path edge not in CFG: " + label + " -> " + *nextLabel);
-              }
-            } else if constexpr (std::is_same_v<T, RetTerm>) {
-              if (nextLabel)
-                throw std::runtime_error(
-                    "Block " + label + " ends with ret but path has more blocks"
-                );
-              // [v0.2.1] Evaluate the return value's expression so that
-              // any UB checks it raises (div/mod by zero, signed overflow,
-              // load OOB, read of undef, etc.) become path constraints.
-              if (term.value) {
-                (void) evalExpr(*term.value, solver, store, pathConstraints);
+              };
+              const auto &lets = currentFun_->lets;
+              for (std::size_t k: currentCtx_->candidateLets(arg))
+                enumStore(lets[k].type, store.at(lets[k].name.name), currentCtx_->letTags[k], 0);
+              // [v0.2.1] Rule 11/15b: the store must land on a valid
+              // T-typed cell — same as load's anyMatch constraint.
+              if (!storeMatchConds.empty()) {
+                smt::Term anyMatch = storeMatchConds[0];
+                for (size_t j = 1; j < storeMatchConds.size(); ++j)
+                  anyMatch = solver.make_term(smt::Kind::OR, {anyMatch, storeMatchConds[j]});
+                pathConstraints.push_back(anyMatch);
               }
-            } else {
-              if (nextLabel)
-                throw std::runtime_error(
-                    "Block " + label + " ends with non-branch terminator but path has more blocks"
-                );
             }
           },
-          block.term
+          ins
       );
     }
 
-    // 5. Solve
-    for (auto c: pathConstraints)
-      solver.assert_formula(c);
-    for (auto r: requirements)
-      solver.assert_formula(r);
+    // Evaluate the terminator. For a conditional br on a non-final block
+    // we also pick a side (then/else) per the path; the cond is evaluated
+    // either way so that any UB triggered by computing the cond (e.g.
+    // rule 14 cross-object pointer compare) is captured as a path
+    // constraint even when the br is the final block.
+    if (!terminator)
+      return;
+    std::visit(
+        [&](auto &&term) {
+          using T = std::decay_t<decltype(term)>;
+          if constexpr (std::is_same_v<T, BrTerm>) {
+            if (term.isConditional) {
+              auto cond = evalCond(*term.cond, solver, store, pathConstraints);
+              if (nextLabel) {
+                if (term.thenLabel.name == *nextLabel) {
+                  pathConstraints.push_back(cond);
+                } else if (term.elseLabel.name == *nextLabel) {
+                  pathConstraints.push_back(solver.make_term(smt::Kind::NOT, {cond}));
+                } else {
+                  throw std::runtime_error(
+                      "Path edge not in CFG: " + label + " -> " + *nextLabel
+                  );
+                }
+              }
+              // No next block: cond was evaluated for UB side-effects only.
+            } else if (nextLabel) {
+              if (term.dest.name != *nextLabel)
+                throw std::runtime_error("Path edge not in CFG: " + label + " -> " + *nextLabel);
+            }
+          } else if constexpr (std::is_same_v<T, RetTerm>) {
+            if (nextLabel)
+              throw std::runtime_error(
+                  "Block " + label + " ends with ret but path has more blocks"
+              );
+            // [v0.2.1] Evaluate the return value's expression so that
+            // any UB checks it raises (div/mod by zero, signed overflow,
+            // load OOB, read of undef, etc.) become path constraints.
+            if (term.value) {
+              (void) evalExpr(*term.value, solver, store, pathConstraints);
+            }
+          } else {
+            if (nextLabel)
+              throw std::runtime_error(
+                  "Block " + label + " ends with non-branch terminator but path has more blocks"
+              );
+          }
+        },
+        block.term
+    );
+  }
 
-    smt::Result res = solver.check_sat();
+  // Concrete value of one BV/FP term (a scalar sym or a vector lane) in
+  // the solver's current model.
+  SymbolicExecutor::Result::ModelVal
+  SymbolicExecutor::modelValue(smt::ISolver &solver, const smt::Term &term) {
+    auto val_term = solver.get_value(term);
+    if (solver.is_fp_sort(solver.get_sort(term))) {
+      std::string bin = solver.get_fp_value_string(val_term);
+      uint64_t bits = 0;
+      for (char c: bin)
+        bits = (bits << 1) | (c - '0');
+      double d;
+      if (bin.size() <= 32) {
+        uint32_t b32 = (uint32_t) bits;
+        float f;
+        std::memcpy(&f, &b32, sizeof(f));
+        d = f;
+      } else {
+        std::memcpy(&d, &bits, sizeof(d));
+      }
+      return d;
+    } else {
+      auto val_str = solver.get_bv_value_string(val_term, 10);
+      uint64_t uraw = std::stoull(val_str, nullptr, 10);
+      uint32_t width = solver.get_bv_width(solver.get_sort(term));
+      int64_t raw;
+      if (width < 64) {
+        uint64_t mask = (uint64_t(1) << width) - 1;
+        uraw &= mask;
+        if (uraw >= (uint64_t(1) << (width - 1)))
+          raw = static_cast<int64_t>(uraw) - static_cast<int64_t>(mask + 1);
+        else
+          raw = static_cast<int64_t>(uraw);
+      } else {
+        raw = static_cast<int64_t>(uraw);
+      }
+      return raw;
+    }
+  }
+
+  SymbolicExecutor::Result SymbolicExecutor::extractModel(
+      const FunDecl &fun, smt::ISolver &solver, const SymbolicStore &store, smt::Result res
+  ) {
     Result finalRes;
     if (res == smt::Result::SAT) {
       finalRes.sat = true;
-      // Local helper: extract one BV/FP lane's concrete value into a
-      // ModelVal. Pulled out so the vector branch below can reuse it
-      // without duplicating the FP bit-pattern reconstruction.
-      auto extractValue = [&](const smt::Term &term) -> Result::ModelVal {
-        auto val_term = solver.get_value(term);
-        if (solver.is_fp_sort(solver.get_sort(term))) {
-          std::string bin = solver.get_fp_value_string(val_term);
-          uint64_t bits = 0;
-          for (char c: bin)
-            bits = (bits << 1) | (c - '0');
-          double d;
-          if (bin.size() <= 32) {
-            uint32_t b32 = (uint32_t) bits;
-            float f;
-            std::memcpy(&f, &b32, sizeof(f));
-            d = f;
-          } else {
-            std::memcpy(&d, &bits, sizeof(d));
-          }
-          return d;
-        } else {
-          auto val_str = solver.get_bv_value_string(val_term, 10);
-          uint64_t uraw = std::stoull(val_str, nullptr, 10);
-          uint32_t width = solver.get_bv_width(solver.get_sort(term));
-          int64_t raw;
-          if (width < 64) {
-            uint64_t mask = (uint64_t(1) << width) - 1;
-            uraw &= mask;
-            if (uraw >= (uint64_t(1) << (width - 1)))
-              raw = static_cast<int64_t>(uraw) - static_cast<int64_t>(mask + 1);
-            else
-              raw = static_cast<int64_t>(uraw);
-          } else {
-            raw = static_cast<int64_t>(uraw);
-          }
-          return raw;
-        }
-      };
-
-      for (const auto &s: entry->syms) {
+      for (const auto &s: fun.syms) {
         const auto &sv = store.at(s.name.name);
         // [v0.2.1] Vector sym: extract one model value per lane.
         if (sv.kind == SymbolicValue::Kind::Vec) {
           std::vector<Result::ModelVal> lanes;
           lanes.reserve(sv.arrayVal.size());
           for (const auto &lane: sv.arrayVal)
-            lanes.push_back(extractValue(lane.term));
+            lanes.push_back(modelValue(solver, lane.term));
           finalRes.vecModel[s.name.name] = std::move(lanes);
           continue;
         }
-        finalRes.model[s.name.name] = extractValue(sv.term);
+        finalRes.model[s.name.name] = sv.narrow
+                                          ? sv.narrow->decode(std::get<int64_t>(
+                                                modelValue(solver, sv.narrow->key)
+                                            ))
+                                          : modelValue(solver, sv.term);
       }
     } else if (res == smt::Result::UNSAT) {
       finalRes.unsat = true;
@@ -953,9 +1476,970 @@ namespace symir {
     return finalRes;
   }
 
+  SymbolicExecutor::Result SymbolicExecutor::solve(
+      const std::string &funcName, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
+  ) {
+    StatsScope statsScope(*this, "solve", funcName);
+    timing::Scope timer("solve");
+    const FunctionContext &ctx = contextOf(funcName);
+    auto ranges = pathIntervals(ctx, path, fixedSyms);
+    if (ranges.infeasible) {
+      Result res;
+      res.unsat = true;
+      return res;
+    }
+    if (auto hit = replayModels(ctx, path, fixedSyms))
+      return *hit;
+    Result res = solveFresh(ctx, path, fixedSyms, &ranges.syms);
+    rememberModel(ctx, res);
+    return res;
+  }
+
+  IntervalAnalysis::PathResult SymbolicExecutor::pathIntervals(
+      const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
+  ) {
+    if (!config_.intervals)
+      return {};
+    if (config_.merge_joins)
+      for (std::size_t i = 0; i < path.size(); ++i)
+        if (mergeEnd(ctx, path, i))
+          return {};
+    auto res = IntervalAnalysis::onPath(*ctx.fun, *ctx.cfg, path, fixedSyms);
+    if (res.infeasible && config_.stats) {
+      solver::SolverStats::Query q;
+      q.call = statsCall_.load();
+      q.pathLen = static_cast<uint32_t>(path.size());
+      q.result = smt::Result::UNSAT;
+      q.refuted = true;
+      config_.stats->record(q);
+    }
+    return res;
+  }
+
+  // Rough footprint of a term built for a query: its hash-cons entry in
+  // the TermBuilder, its node in the backend and its share of the store
+  // (about 1 KiB each with Z3 on array-heavy paths).
+  static constexpr std::size_t kTermBytes = 1024;
+
+  void SymbolicExecutor::chargeMemory(std::size_t values) {
+    MemoryBudget *budget = memoryBudget_;
+    if (!budget)
+      return;
+    budget->values += values;
+    std::size_t bytes = budget->values * sizeof(SymbolicValue);
+    if (budget->terms)
+      bytes += budget->terms->stats().built * kTermBytes;
+    if (bytes > budget->limit)
+      throw MemoryBudgetExceeded();
+  }
+
+  SymbolicExecutor::Result SymbolicExecutor::solveFresh(
+      const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms,
+      const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges
+  ) {
+    if (!config_.max_memory_mb)
+      return solveFreshOnce(ctx, path, fixedSyms, symRanges);
+    // Over budget, the arrays of scalars are the usual culprits: their ITE
+    // chains for symbolic indices grow with the product of the array's
+    // size and the number of accesses, their select/store terms do not.
+    MemoryBudget budget{std::size_t(config_.max_memory_mb) << 20, false};
+    struct BudgetScope {
+      MemoryBudget *prev;
+      ~BudgetScope() { memoryBudget_ = prev; }
+    } budgetScope{std::exchange(memoryBudget_, &budget)};
+    for (;;) {
+      try {
+        return solveFreshOnce(ctx, path, fixedSyms, symRanges);
+      } catch (const MemoryBudgetExceeded &) {
+      }
+      if (budget.smtArrays || config_.array_encoding == Config::ArrayEncoding::SmtArray)
+        break;
+      timing::count("memory-budget-retries");
+      budget = MemoryBudget{budget.limit, true};
+    }
+    timing::count("memory-budget-exceeded");
+    Result res;
+    res.unknown = true;
+    res.message = "memory";
+    return res;
+  }
+
+  SymbolicExecutor::Result SymbolicExecutor::solveFreshOnce(
+      const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms,
+      const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges
+  ) {
+    const FunDecl *entry = ctx.fun;
+
+    // Make the current function visible to evalAtom/StoreInstr handlers via
+    // thread_local storage. Restored on scope exit so nested or concurrent
+    // solve() invocations on different threads see their own value.
+    FunScope funScope(ctx);
+
+    auto solverPtr = makeSolver();
+    smt::ISolver &solver = *solverPtr;
+    QueryProbe probe = startQuery(solver);
+    probe.pathLen = static_cast<uint32_t>(path.size());
+    if (memoryBudget_)
+      memoryBudget_->terms = dynamic_cast<const solver::TermBuilder *>(&solver);
+
+    std::optional<LazyFp> lazy;
+    if (config_.lazy_fp)
+      lazy.emplace();
+    struct LazyFpScope {
+      LazyFp *prev;
+      ~LazyFpScope() { lazyFp_ = prev; }
+    } lazyScope{std::exchange(lazyFp_, lazy ? &*lazy : nullptr)};
+
+    SymbolicStore store;
+    std::vector<smt::Term> constraints =
+        encodePath(ctx, path, fixedSyms, symRanges, solver, store, &probe.guardsDropped);
+    lazyFp_ = lazyScope.prev;
+
+    if (lazy && !lazy->ops.empty()) {
+      smt::Result r = checkLazyFp(probe, solver, constraints, *lazy);
+      return extractModel(*entry, solver, store, r);
+    }
+    if (config_.slicing) {
+      if (auto *tb = dynamic_cast<solver::TermBuilder *>(&solver)) {
+        if (auto res = solveSliced(probe, *entry, *tb, store, constraints))
+          return *res;
+      }
+    }
+    Result res;
+    smt::Result r = checkQuery(probe, solver, constraints, symSlots(*entry, store), res, [&] {
+      for (auto c: constraints)
+        solver.assert_formula(c);
+      return solver.check_sat();
+    });
+    return withVerdict(std::move(res), r);
+  }
+
+  // One scalar FP op on concrete operands, as the Interpreter computes it:
+  // in double, rounded to float for f32.
+  static double fpConcrete(smt::Kind kind, double a, double b, bool f32) {
+    double r;
+    switch (kind) {
+      case smt::Kind::FP_ADD:
+        r = a + b;
+        break;
+      case smt::Kind::FP_SUB:
+        r = a - b;
+        break;
+      case smt::Kind::FP_MUL:
+        r = a * b;
+        break;
+      case smt::Kind::FP_DIV:
+        r = a / b;
+        break;
+      default:
+        r = std::fmod(a, b);
+        break;
+    }
+    return f32 ? static_cast<double>(static_cast<float>(r)) : r;
+  }
+
+  smt::Result SymbolicExecutor::checkLazyFp(
+      QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+      LazyFp &lazy
+  ) {
+    for (auto c: constraints)
+      solver.assert_formula(c);
+    auto refine = [&](LazyFp::Op &op) {
+      solver.assert_formula(
+          solver.make_term(smt::Kind::EQUAL, {op.r, fpDefinition(op.kind, op.a, op.b, solver)})
+      );
+      op.refined = true;
+      timing::count("lazy-fp-refinements");
+    };
+    for (uint32_t round = 0;; ++round) {
+      smt::Result r = countedCheck(probe, solver, constraints, [&] { return solver.check_sat(); });
+      // The abstraction only drops constraints: UNSAT is final, and so is
+      // any answer once every op is refined.
+      if (r != smt::Result::SAT)
+        return r;
+      bool wrong = false, unrefined = false;
+      for (auto &op: lazy.ops) {
+        if (op.refined)
+          continue;
+        bool f32 = solver.get_fp_dims(solver.get_sort(op.r)).first == 8;
+        double a = std::get<double>(modelValue(solver, op.a));
+        double b = std::get<double>(modelValue(solver, op.b));
+        double got = std::get<double>(modelValue(solver, op.r));
+        double want = fpConcrete(op.kind, a, b, f32);
+        // Bit for bit: the sign of a zero result is observable.
+        if (std::memcmp(&got, &want, sizeof(got)) == 0) {
+          unrefined = true;
+          continue;
+        }
+        refine(op);
+        wrong = true;
+      }
+      if (!wrong)
+        return r;
+      if (round + 1 >= config_.lazy_fp_rounds && unrefined) {
+        for (auto &op: lazy.ops)
+          if (!op.refined)
+            refine(op);
+      }
+    }
+  }
+
+  std::vector<smt::Term> SymbolicExecutor::encodePath(
+      const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms,
+      const std::unordered_map<std::string, IntervalAnalysis::Interval> *symRanges,
+      smt::ISolver &solver, SymbolicStore &store, uint64_t *guardsDropped
+  ) {
+    timing::Scope timer("encode");
+    const FunDecl *entry = ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    std::vector<smt::Term> pathConstraints;
+    std::vector<smt::Term> requirements;
+
+    // [v0.2.1] Reset per-solve provenance tracking. Each call to solve()
+    // walks a fresh CFG path, so prior provenance state must not leak.
+    ptrProv_.clear();
+
+    std::optional<SsaPath> ssaPath;
+    if (ctx.ssa)
+      ssaPath.emplace(SsaPath{ctx.ssa, std::vector<std::uint32_t>(ctx.ssa->values().size())});
+    struct SsaScope {
+      SsaPath *prev;
+      ~SsaScope() { ssaPath_ = prev; }
+    } ssaScope{std::exchange(ssaPath_, ssaPath ? &*ssaPath : nullptr)};
+
+    // 1. Declare symbols and locals, fixing symbol values if requested
+    encodeEntry(*entry, solver, store, pathConstraints, fixedSyms, symRanges);
+
+    // 2. Path traversal
+    for (size_t i = 0; i < path.size(); ++i) {
+      const std::string &label = path[i];
+      if (cfg.indexOf.find(label) == cfg.indexOf.end())
+        throw std::runtime_error("Invalid block label in path: " + label);
+
+      const Block &block = entry->blocks[cfg.indexOf.at(label)];
+      const std::string *nextLabel = (i + 1 < path.size()) ? &path[i + 1] : nullptr;
+      if (auto end = mergeEnd(ctx, path, i)) {
+        // Encode the br block without taking a side, then both arms at once;
+        // if they cannot be merged, follow the path after all.
+        encodeBlock(block, label, nullptr, solver, store, pathConstraints, requirements);
+        const auto &br = std::get<BrTerm>(block.term);
+        std::vector<smt::Term> scratch; // its UB is in pathConstraints already
+        smt::Term cond = evalCond(*br.cond, solver, store, scratch);
+        std::size_t b = cfg.indexOf.at(label);
+        if (encodeRegion(*ctx.regions[b], b, cond, solver, store, pathConstraints, requirements)) {
+          i = *end - 1;
+          continue;
+        }
+        pathConstraints.push_back(
+            br.thenLabel.name == *nextLabel ? cond : solver.make_term(smt::Kind::NOT, {cond})
+        );
+        continue;
+      }
+      encodeBlock(block, label, nextLabel, solver, store, pathConstraints, requirements);
+    }
+
+    std::vector<smt::Term> constraints = std::move(pathConstraints);
+    constraints.insert(constraints.end(), requirements.begin(), requirements.end());
+    if (!config_.dedup_guards)
+      return constraints;
+    GuardSet guards(solver);
+    for (auto c: constraints)
+      guards.add(c);
+    if (guardsDropped)
+      *guardsDropped += guards.dropped();
+    return guards.take();
+  }
+
+  SymbolicExecutor::GuardSet::GuardSet(smt::ISolver &solver) :
+      solver_(solver), tb_(dynamic_cast<const solver::TermBuilder *>(&solver)) {}
+
+  void SymbolicExecutor::GuardSet::add(smt::Term t) {
+    if (tb_ && tb_->kind(t) == smt::Kind::AND) {
+      for (auto op: tb_->operands(t))
+        add(op);
+      return;
+    }
+    if (implied(t, 0)) {
+      ++dropped_;
+      return;
+    }
+    known_.insert(t.id);
+    kept_.push_back(t);
+  }
+
+  bool SymbolicExecutor::GuardSet::implied(smt::Term t, int depth) const {
+    if (known_.count(t.id) || solver_.is_true(t))
+      return true;
+    // Merged regions and nested aggregates build deep formulas; looking
+    // a few levels down catches the guards repeated in them.
+    if (!tb_ || depth == 4)
+      return false;
+    auto kind = tb_->kind(t);
+    auto ops = tb_->operands(t);
+    auto sub = [&](smt::Term op) { return implied(op, depth + 1); };
+    if (kind == smt::Kind::AND)
+      return std::all_of(ops.begin(), ops.end(), sub);
+    if (kind == smt::Kind::OR)
+      return std::any_of(ops.begin(), ops.end(), sub);
+    if (kind == smt::Kind::IMPLIES)
+      return ops.size() == 2 && sub(ops[1]);
+    return false;
+  }
+
+  std::optional<std::size_t> SymbolicExecutor::mergeEnd(
+      const FunctionContext &ctx, const std::vector<std::string> &path, std::size_t i
+  ) const {
+    if (!config_.merge_joins || ctx.regions.empty())
+      return std::nullopt;
+    const CFG &cfg = *ctx.cfg;
+    auto it = cfg.indexOf.find(path[i]);
+    if (it == cfg.indexOf.end() || !ctx.regions[it->second])
+      return std::nullopt;
+    const auto &region = *ctx.regions[it->second];
+    std::size_t prev = it->second;
+    for (std::size_t j = i + 1; j < path.size(); ++j) {
+      auto jt = cfg.indexOf.find(path[j]);
+      if (jt == cfg.indexOf.end())
+        return std::nullopt;
+      const auto &succ = cfg.succ[prev];
+      if (std::find(succ.begin(), succ.end(), jt->second) == succ.end())
+        return std::nullopt; // left for encodeBlock to report
+      if (jt->second == region.join)
+        return j;
+      prev = jt->second;
+    }
+    return std::nullopt; // the path ends inside the region
+  }
+
+  std::string SymbolicExecutor::mergeKey(
+      const FunctionContext &ctx, const std::vector<std::string> &path
+  ) const {
+    std::string key;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+      key += path[i];
+      key += ' ';
+      if (auto end = mergeEnd(ctx, path, i))
+        i = *end - 1;
+    }
+    return key;
+  }
+
+  bool SymbolicExecutor::sameValue(const SymbolicValue &a, const SymbolicValue &b) {
+    if (a.kind != b.kind || a.term != b.term || a.is_defined != b.is_defined ||
+        a.prov_base != b.prov_base || a.prov_size != b.prov_size ||
+        a.arraySize != b.arraySize || a.arrayVal.size() != b.arrayVal.size() ||
+        a.structVal.size() != b.structVal.size() || a.fill != b.fill ||
+        a.cells.size() != b.cells.size())
+      return false;
+    for (std::size_t k = 0; k < a.arrayVal.size(); ++k)
+      if (!sameValue(a.arrayVal[k], b.arrayVal[k]))
+        return false;
+    for (const auto &[k, v]: a.cells) {
+      auto it = b.cells.find(k);
+      if (it == b.cells.end() || !sameValue(v, it->second))
+        return false;
+    }
+    for (const auto &[name, v]: a.structVal) {
+      auto it = b.structVal.find(name);
+      if (it == b.structVal.end() || !sameValue(v, it->second))
+        return false;
+    }
+    return true;
+  }
+
+  bool SymbolicExecutor::encodeRegion(
+      const FunctionContext::MergeRegion &region, std::size_t br, smt::Term cond,
+      smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pathConstraints,
+      std::vector<smt::Term> &requirements
+  ) {
+    const FunDecl &fun = *currentFun_;
+    const CFG &cfg = *currentCtx_->cfg;
+
+    // An edge into a block: taken iff `guard` holds, with `store` and
+    // `prov` the state on leaving its source. At most one edge into a
+    // block is taken, since the region is acyclic with one entry.
+    struct Edge {
+      smt::Term guard;
+      const SymbolicStore *store;
+      const std::unordered_map<Symbol, PtrProvenance> *prov;
+    };
+
+    std::unordered_map<std::size_t, std::vector<Edge>> incoming;
+    std::unordered_map<std::size_t, SymbolicStore> stores;
+    std::unordered_map<std::size_t, std::unordered_map<Symbol, PtrProvenance>> provs;
+    std::vector<std::pair<smt::Term, smt::Term>> guarded; // (guard, constraint)
+    std::vector<std::pair<smt::Term, smt::Term>> guardedReqs;
+
+    // Out-edges of a block left with `guard`, condition `c` (conditional
+    // br) and the state in `stores`/`provs`.
+    auto leave = [&](std::size_t b, smt::Term guard, smt::Term c) {
+      const auto &term = std::get<BrTerm>(fun.blocks[b].term);
+      auto edge = [&](const BlockLabel &to, smt::Term g) {
+        incoming[cfg.indexOf.at(to.name)].push_back(Edge{g, &stores.at(b), &provs.at(b)});
+      };
+      if (!term.isConditional) {
+        edge(term.dest, guard);
+        return;
+      }
+      auto notC = solver.make_term(smt::Kind::NOT, {c});
+      edge(term.thenLabel, solver.make_term(smt::Kind::AND, {guard, c}));
+      edge(term.elseLabel, solver.make_term(smt::Kind::AND, {guard, notC}));
+    };
+
+    // State on entering block `b`: the stores of its edges merged by guard.
+    using ProvMap = std::unordered_map<Symbol, PtrProvenance>;
+    auto enter = [&](std::size_t b, SymbolicStore &out,
+                     ProvMap &prov) -> std::optional<smt::Term> {
+      const auto &in = incoming.at(b);
+      const auto &last = in.back();
+      out = *last.store;
+      prov = *last.prov;
+      smt::Term guard = last.guard;
+      for (std::size_t k = in.size() - 1; k-- > 0;) {
+        const Edge &e = in[k];
+        if (e.prov->size() != prov.size())
+          return std::nullopt;
+        for (const auto &[name, p]: *e.prov) {
+          auto it = prov.find(name);
+          if (it == prov.end() || it->second.baseTag != p.baseTag || it->second.size != p.size)
+            return std::nullopt;
+        }
+        for (auto &[name, v]: out) {
+          auto it = e.store->find(name);
+          if (it == e.store->end() || it->second.kind != v.kind)
+            return std::nullopt;
+          if (!sameValue(it->second, v))
+            v = muxSymbolicValue(e.guard, it->second, v, solver);
+        }
+        guard = solver.make_term(smt::Kind::OR, {e.guard, guard});
+      }
+      return guard;
+    };
+
+    auto provBefore = ptrProv_;
+    SymbolicStore joined;
+    std::unordered_map<Symbol, PtrProvenance> joinedProv;
+    auto merge = [&]() {
+      stores.emplace(br, store);
+      provs.emplace(br, ptrProv_);
+      leave(br, solver.make_true(), cond);
+      for (std::size_t b: region.blocks) {
+        SymbolicStore &bStore = stores[b];
+        auto guard = enter(b, bStore, ptrProv_);
+        if (!guard)
+          return false;
+        std::vector<smt::Term> pc, req;
+        const Block &block = fun.blocks[b];
+        encodeBlock(block, cfg.blocks[b], nullptr, solver, bStore, pc, req);
+        for (auto c: pc)
+          guarded.emplace_back(*guard, c);
+        for (auto c: req)
+          guardedReqs.emplace_back(*guard, c);
+        smt::Term c;
+        if (const auto &t = std::get<BrTerm>(block.term); t.isConditional) {
+          std::vector<smt::Term> scratch;
+          c = evalCond(*t.cond, solver, bStore, scratch);
+        }
+        provs[b] = ptrProv_;
+        leave(b, *guard, c);
+      }
+      return enter(region.join, joined, joinedProv).has_value();
+    };
+    bool merged = false;
+    try {
+      merged = merge();
+    } catch (const std::runtime_error &) {
+      // Errors in blocks the path takes resurface when it is followed.
+    }
+    if (!merged) {
+      ptrProv_ = std::move(provBefore);
+      return false;
+    }
+    for (const auto &[g, c]: guarded)
+      pathConstraints.push_back(solver.make_term(smt::Kind::IMPLIES, {g, c}));
+    for (const auto &[g, c]: guardedReqs)
+      requirements.push_back(solver.make_term(smt::Kind::IMPLIES, {g, c}));
+    store = std::move(joined);
+    ptrProv_ = std::move(joinedProv);
+    return true;
+  }
+
+  std::vector<SymbolicExecutor::SymSlot>
+  SymbolicExecutor::symSlots(const FunDecl &fun, const SymbolicStore &store) const {
+    std::vector<SymSlot> slots;
+    for (const auto &sym: fun.syms) {
+      const auto &sv = store.at(sym.name.name);
+      if (sv.kind == SymbolicValue::Kind::Vec) {
+        for (std::size_t l = 0; l < sv.arrayVal.size(); ++l)
+          slots.push_back({&sym.name.name, l, sv.arrayVal[l].term, sv.arrayVal[l].term});
+      } else {
+        const auto *n = sv.narrow.get();
+        slots.push_back({&sym.name.name, SymSlot::kScalar, sv.term, n ? n->key : sv.term, n});
+      }
+    }
+    return slots;
+  }
+
+  SymbolicExecutor::Result::ModelVal
+  SymbolicExecutor::slotValue(smt::ISolver &solver, const SymSlot &slot) {
+    auto v = modelValue(solver, slot.key);
+    if (slot.narrow)
+      v = slot.narrow->decode(std::get<int64_t>(v));
+    return v;
+  }
+
+  // Stores a model value of sym `name`; lane SIZE_MAX is a scalar sym.
+  static void setSlot(
+      SymbolicExecutor::Result &res, const std::string &name, std::size_t lane,
+      SymbolicExecutor::Result::ModelVal v
+  ) {
+    if (lane == SIZE_MAX) {
+      res.model[name] = v;
+      return;
+    }
+    auto &lanes = res.vecModel[name];
+    if (lanes.size() <= lane)
+      lanes.resize(lane + 1);
+    lanes[lane] = v;
+  }
+
+  SymbolicExecutor::Result SymbolicExecutor::withVerdict(Result res, smt::Result r) {
+    if (r == smt::Result::SAT) {
+      res.sat = true;
+      return res;
+    }
+    Result out;
+    out.unsat = r == smt::Result::UNSAT;
+    out.unknown = !out.unsat;
+    return out;
+  }
+
+  SymbolicExecutor::ModelsResult SymbolicExecutor::enumerateModels(
+      const std::string &funcName, const std::vector<std::string> &path, uint32_t k,
+      const std::unordered_map<std::string, int64_t> &fixedSyms,
+      const std::vector<std::string> &projection
+  ) {
+    StatsScope statsScope(*this, "models", funcName);
+    timing::Scope timer("models");
+    const FunctionContext &ctx = contextOf(funcName);
+    const FunDecl &fun = *ctx.fun;
+    for (const auto &name: projection) {
+      bool known = std::any_of(fun.syms.begin(), fun.syms.end(), [&](const SymDecl &s) {
+        return s.name.name == name;
+      });
+      if (!known)
+        throw std::runtime_error("Unknown sym in projection: " + name);
+    }
+
+    ModelsResult out;
+    auto ranges = pathIntervals(ctx, path, fixedSyms);
+    if (ranges.infeasible) {
+      out.exhausted = true;
+      return out;
+    }
+
+    FunScope funScope(ctx);
+    auto solverPtr = makeSolver();
+    smt::ISolver &solver = *solverPtr;
+    QueryProbe probe = startQuery(solver);
+    probe.pathLen = static_cast<uint32_t>(path.size());
+
+    SymbolicStore store;
+    std::vector<smt::Term> constraints =
+        encodePath(ctx, path, fixedSyms, &ranges.syms, solver, store, &probe.guardsDropped);
+    for (auto c: constraints)
+      solver.assert_formula(c);
+
+    auto slots = symSlots(fun, store);
+    std::vector<const SymSlot *> blocked; // the slots two models must differ in
+    for (const auto &slot: slots) {
+      if (projection.empty() ||
+          std::find(projection.begin(), projection.end(), *slot.name) != projection.end())
+        blocked.push_back(&slot);
+    }
+
+    // One solver for all models: after each one, a blocking clause rules
+    // out its values of the projected syms and the solver is asked again.
+    while (out.models.size() < k && !cancelled()) {
+      smt::Result r = countedCheck(probe, solver, constraints, [&] { return solver.check_sat(); });
+      if (r != smt::Result::SAT) {
+        out.exhausted = r == smt::Result::UNSAT;
+        break;
+      }
+      Result res;
+      res.sat = true;
+      for (const auto &slot: slots)
+        setSlot(res, *slot.name, slot.lane, slotValue(solver, slot));
+      rememberModel(ctx, res);
+      out.models.push_back(std::move(res));
+
+      if (blocked.empty()) {
+        // Nothing to tell models apart: the one found is all there is.
+        out.exhausted = true;
+        break;
+      }
+      smt::Term clause;
+      const auto &model = out.models.back().model;
+      for (const SymSlot *slot: blocked) {
+        // A narrowed sym's term is no const: block the value decoded.
+        smt::Term val;
+        if (slot->narrow)
+          val = solver.make_bv_value_int64(
+              solver.get_sort(slot->term), std::get<int64_t>(model.at(*slot->name))
+          );
+        else
+          val = solver.get_value(slot->term);
+        auto differs = solver.make_term(smt::Kind::DISTINCT, {slot->term, val});
+        clause = clause ? solver.make_term(smt::Kind::OR, {clause, differs}) : differs;
+      }
+      solver.assert_formula(clause);
+      constraints.push_back(clause);
+    }
+    return out;
+  }
+
+  // Terms requested from `tb` so far, whether hash-consed, folded or built.
+  static uint64_t termRequests(const solver::TermBuilder &tb) {
+    const auto &st = tb.stats();
+    return st.hits + st.folds + st.built;
+  }
+
+  static double msSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+  }
+
+  SymbolicExecutor::StatsScope::StatsScope(
+      SymbolicExecutor &ex, const char *kind, const std::string &function
+  )
+      : ex_(ex) {
+    if (!ex.config_.stats || ex.statsCall_.load() != 0)
+      return;
+    id_ = ex.config_.stats->beginCall(kind, function, ex.config_.stats_label);
+    ex.statsCall_.store(id_);
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  SymbolicExecutor::StatsScope::~StatsScope() {
+    if (!id_)
+      return;
+    ex_.config_.stats->endCall(id_, msSince(start_));
+    ex_.statsCall_.store(0);
+  }
+
+  SymbolicExecutor::QueryProbe SymbolicExecutor::startQuery(smt::ISolver &solver) const {
+    QueryProbe probe;
+    if (!config_.stats)
+      return probe;
+    probe.start = std::chrono::steady_clock::now();
+    if (auto *tb = dynamic_cast<const solver::TermBuilder *>(&solver))
+      probe.terms = termRequests(*tb);
+    return probe;
+  }
+
+  smt::Result SymbolicExecutor::countedCheck(
+      QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+      const std::function<smt::Result()> &check
+  ) {
+    timing::Scope timer("check");
+    timing::count("solver-checks");
+    auto run = [&] { return cancel_ ? cancel_->run(solver, check) : check(); };
+    if (!config_.stats)
+      return run();
+    auto solveStart = std::chrono::steady_clock::now();
+    smt::Result r = run();
+    recordQuery(probe, solver, constraints, r, msSince(solveStart), false);
+    return r;
+  }
+
+  void SymbolicExecutor::recordQuery(
+      QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+      smt::Result r, double solveMs, bool cached
+  ) {
+    solver::SolverStats::Query q;
+    q.call = statsCall_.load();
+    q.pathLen = probe.pathLen;
+    q.assertions = constraints.size();
+    q.encodeMs = std::max(0.0, msSince(probe.start) - solveMs);
+    q.solveMs = solveMs;
+    q.result = r;
+    q.cached = cached;
+    q.guardsDropped = probe.guardsDropped;
+    probe.guardsDropped = 0;
+    if (auto *tb = dynamic_cast<const solver::TermBuilder *>(&solver)) {
+      uint64_t terms = termRequests(*tb);
+      q.terms = terms - probe.terms;
+      probe.terms = terms;
+      std::unordered_set<uint32_t> seen;
+      std::vector<smt::Term> stack(constraints.begin(), constraints.end());
+      while (!stack.empty()) {
+        smt::Term t = stack.back();
+        stack.pop_back();
+        if (!seen.insert(t.id).second)
+          continue;
+        for (auto op: tb->operands(t))
+          stack.push_back(op);
+      }
+      q.dagSize = seen.size();
+    }
+    config_.stats->record(q);
+    probe.start = std::chrono::steady_clock::now();
+  }
+
+  // Whether the solver could give sym `s` the value `v` (its domain).
+  static bool inDomain(const SymDecl &s, const SymbolicExecutor::Result::ModelVal &v) {
+    if (!s.domain)
+      return true;
+    auto *iv = std::get_if<int64_t>(&v);
+    if (!iv)
+      return false;
+    if (auto *d = std::get_if<DomainInterval>(&*s.domain))
+      return d->lo <= *iv && *iv <= d->hi;
+    const auto &values = std::get<DomainSet>(*s.domain).values;
+    return std::find(values.begin(), values.end(), *iv) != values.end();
+  }
+
+  std::optional<SymbolicExecutor::Result> SymbolicExecutor::replayModels(
+      const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
+  ) {
+    // The Interpreter binds neither params nor per-lane vector syms.
+    const FunDecl &fun = *ctx.fun;
+    if (!config_.model_pool || !fun.params.empty())
+      return std::nullopt;
+    for (const auto &s: fun.syms)
+      if (std::holds_alternative<VecType>(s.type->v))
+        return std::nullopt;
+    auto models = config_.model_pool->recent(fun.name.name);
+    if (models.empty())
+      return std::nullopt;
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t tries = 0;
+    std::optional<Result> hit;
+    for (auto &model: models) {
+      for (const auto &[name, v]: fixedSyms)
+        model[name] = v;
+      bool fits = std::all_of(fun.syms.begin(), fun.syms.end(), [&](const SymDecl &s) {
+        auto it = model.find(s.name.name);
+        return it != model.end() && inDomain(s, it->second);
+      });
+      if (!fits)
+        continue;
+      ++tries;
+      try {
+        Interpreter interp(prog_);
+        if (!interp.runPath(fun.name.name, model, path))
+          continue;
+      } catch (const std::exception &) {
+        continue; // UB, or a failed assume or require
+      }
+      hit.emplace();
+      hit->sat = true;
+      for (const auto &s: fun.syms)
+        hit->model[s.name.name] = model.at(s.name.name);
+      break;
+    }
+
+    if (config_.stats && tries > 0) {
+      config_.stats->recordReplay(statsCall_.load(), tries, msSince(start));
+      if (hit) {
+        solver::SolverStats::Query q;
+        q.call = statsCall_.load();
+        q.pathLen = static_cast<uint32_t>(path.size());
+        q.result = smt::Result::SAT;
+        q.replayed = true;
+        config_.stats->record(q);
+      }
+    }
+    return hit;
+  }
+
+  void SymbolicExecutor::rememberModel(const FunctionContext &ctx, const Result &res) {
+    if (config_.model_pool && res.sat && res.vecModel.empty() && ctx.fun->params.empty())
+      config_.model_pool->add(ctx.fun->name.name, res.model);
+  }
+
+  smt::Result SymbolicExecutor::checkQuery(
+      QueryProbe &probe, smt::ISolver &solver, std::span<const smt::Term> constraints,
+      std::span<const SymSlot> slots, Result &res, const std::function<smt::Result()> &check
+  ) {
+    using solver::QueryCache;
+    std::optional<QueryCache::Key> key;
+    std::unordered_map<uint32_t, uint32_t> constIndex; // const term id -> canonical index
+    if (config_.query_cache) {
+      if (auto *tb = dynamic_cast<solver::TermBuilder *>(&solver)) {
+        std::string text;
+        std::vector<smt::Term> consts;
+        if (tb->fingerprint(constraints, text, consts)) {
+          key = QueryCache::keyOf(text);
+          for (uint32_t i = 0; i < consts.size(); ++i)
+            constIndex.emplace(consts[i].id, i);
+        }
+      }
+    }
+
+    if (key) {
+      if (auto hit = config_.query_cache->lookup(*key)) {
+        if (config_.stats) {
+          smt::Result r = hit->sat ? smt::Result::SAT : smt::Result::UNSAT;
+          recordQuery(probe, solver, constraints, r, 0, true);
+        }
+        if (!hit->sat)
+          return smt::Result::UNSAT;
+        std::unordered_map<uint32_t, const QueryCache::Value *> byIndex;
+        for (const auto &v: hit->model)
+          byIndex.emplace(v.constIndex, &v);
+        for (const auto &slot: slots) {
+          // Syms the query does not mention are unconstrained: any value does.
+          const QueryCache::Value *v = nullptr;
+          if (auto ci = constIndex.find(slot.key.id); ci != constIndex.end())
+            if (auto bi = byIndex.find(ci->second); bi != byIndex.end())
+              v = bi->second;
+          Result::ModelVal val = int64_t(0);
+          if (v && v->isFloat) {
+            double d;
+            std::memcpy(&d, &v->bits, sizeof(d));
+            val = d;
+          } else if (v) {
+            val = static_cast<int64_t>(v->bits);
+          } else if (slot.narrow) {
+            val = slot.narrow->decode(0);
+          } else if (solver.is_fp_sort(solver.get_sort(slot.term))) {
+            val = 0.0;
+          }
+          setSlot(res, *slot.name, slot.lane, val);
+        }
+        return smt::Result::SAT;
+      }
+    }
+
+    smt::Result r = countedCheck(probe, solver, constraints, check);
+    if (r == smt::Result::SAT) {
+      for (const auto &slot: slots)
+        setSlot(res, *slot.name, slot.lane, slotValue(solver, slot));
+    }
+    // Timeouts and other UNKNOWNs are not cached.
+    if (key && r != smt::Result::UNKNOWN) {
+      QueryCache::Entry entry;
+      entry.sat = r == smt::Result::SAT;
+      if (entry.sat) {
+        for (const auto &slot: slots) {
+          auto ci = constIndex.find(slot.key.id);
+          if (ci == constIndex.end())
+            continue;
+          const auto &val = slot.lane == SymSlot::kScalar ? res.model.at(*slot.name)
+                                                          : res.vecModel.at(*slot.name)[slot.lane];
+          QueryCache::Value v;
+          v.constIndex = ci->second;
+          if (auto *d = std::get_if<double>(&val)) {
+            v.isFloat = true;
+            std::memcpy(&v.bits, d, sizeof(v.bits));
+          } else {
+            v.bits = static_cast<uint64_t>(std::get<int64_t>(val));
+          }
+          entry.model.push_back(v);
+        }
+      }
+      config_.query_cache->insert(*key, entry);
+    }
+    return r;
+  }
+
+  std::optional<SymbolicExecutor::Result> SymbolicExecutor::solveSliced(
+      QueryProbe &probe, const FunDecl &fun, solver::TermBuilder &tb, const SymbolicStore &store,
+      const std::vector<smt::Term> &constraints
+  ) {
+    // Union-find over the non-leaf terms and consts reachable from the
+    // constraints. Literals are shared by everything and never link terms.
+    std::unordered_map<uint32_t, uint32_t> parent;
+    auto find = [&](uint32_t x) {
+      while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+      }
+      return x;
+    };
+    std::vector<smt::Term> stack;
+    for (auto c: constraints) {
+      if (parent.emplace(c.id, c.id).second)
+        stack.push_back(c);
+      while (!stack.empty()) {
+        smt::Term t = stack.back();
+        stack.pop_back();
+        for (auto op: tb.operands(t)) {
+          if (!tb.isConst(op) && tb.operands(op).empty())
+            continue;
+          if (parent.emplace(op.id, op.id).second)
+            stack.push_back(op);
+          uint32_t a = find(t.id), b = find(op.id);
+          if (a != b)
+            parent[a] = b;
+        }
+      }
+    }
+
+    std::unordered_map<uint32_t, std::vector<smt::Term>> groups;
+    for (auto c: constraints)
+      groups[find(c.id)].push_back(c);
+    if (groups.size() < 2)
+      return std::nullopt;
+
+    // Each sym (or vector lane) is read from the model of its own group;
+    // syms no constraint mentions take the first model's completion.
+    std::unordered_map<uint32_t, std::vector<SymSlot>> groupSlots;
+    std::vector<SymSlot> freeSlots;
+    for (const auto &slot: symSlots(fun, store)) {
+      if (parent.count(slot.key.id))
+        groupSlots[find(slot.key.id)].push_back(slot);
+      else
+        freeSlots.push_back(slot);
+    }
+
+    std::vector<std::pair<uint32_t, const std::vector<smt::Term> *>> order;
+    for (const auto &[root, cs]: groups)
+      order.emplace_back(root, &cs);
+    std::sort(order.begin(), order.end(), [](const auto &a, const auto &b) {
+      return a.second->size() < b.second->size() ||
+             (a.second->size() == b.second->size() && a.first < b.first);
+    });
+
+    Result res;
+    bool unknown = false;
+    for (const auto &[root, cs]: order) {
+      std::vector<SymSlot> slots = std::move(groupSlots[root]);
+      slots.insert(slots.end(), freeSlots.begin(), freeSlots.end());
+      tb.push(1);
+      smt::Result r;
+      try {
+        r = checkQuery(probe, tb, *cs, slots, res, [&] {
+          for (auto c: *cs)
+            tb.assert_formula(c);
+          return tb.check_sat();
+        });
+      } catch (...) {
+        tb.pop(1);
+        throw;
+      }
+      tb.pop(1);
+      if (r == smt::Result::UNSAT)
+        return withVerdict({}, r);
+      if (r == smt::Result::SAT)
+        freeSlots.clear();
+      unknown |= r != smt::Result::SAT;
+    }
+    return withVerdict(std::move(res), unknown ? smt::Result::UNKNOWN : smt::Result::SAT);
+  }
+
+
   SymbolicExecutor::SymbolicValue SymbolicExecutor::mergeAggregate(
       const std::vector<SymbolicValue> &elements, smt::Term idx, smt::ISolver &solver
   ) {
+    chargeMemory(1);
     if (elements.empty())
       return {SymbolicValue::Kind::Undef};
 
@@ -986,14 +2470,23 @@ namespace symir {
         defined = solver.make_term(smt::Kind::ITE, {cond, elements[i].is_defined, defined});
       }
       return SymbolicValue(SymbolicValue::Kind::Int, res, defined);
+    } else if (elements[0].kind == SymbolicValue::Kind::SmtArray) {
+      SymbolicValue res = elements[0];
+      auto idxSort = solver.get_sort(idx);
+      for (size_t i = 1; i < elements.size(); ++i) {
+        auto i_term = solver.make_bv_value(idxSort, std::to_string(i), 10);
+        auto cond = solver.make_term(smt::Kind::EQUAL, {idx, i_term});
+        res = muxSymbolicValue(cond, elements[i], res, solver);
+      }
+      return res;
     } else if (elements[0].kind == SymbolicValue::Kind::Array) {
       SymbolicValue res;
       res.kind = SymbolicValue::Kind::Array;
-      size_t inner_size = elements[0].arrayVal.size();
+      size_t inner_size = arrayLength(elements[0]);
       for (size_t j = 0; j < inner_size; ++j) {
         std::vector<SymbolicValue> inner_elements;
         for (size_t i = 0; i < elements.size(); ++i)
-          inner_elements.push_back(elements[i].arrayVal[j]);
+          inner_elements.push_back(cellOf(elements[i], j, solver));
         res.arrayVal.push_back(mergeAggregate(inner_elements, idx, solver));
       }
       return res;
@@ -1018,11 +2511,33 @@ namespace symir {
     SymbolicValue res = store.at(lv.base.name);
     for (const auto &acc: lv.accesses) {
       if (auto ai = std::get_if<AccessIndex>(&acc)) {
-        if (res.kind != SymbolicValue::Kind::Array && res.kind != SymbolicValue::Kind::Vec)
+        if (res.kind != SymbolicValue::Kind::Array && res.kind != SymbolicValue::Kind::Vec &&
+            res.kind != SymbolicValue::Kind::SmtArray)
           throw std::runtime_error("Indexing non-array");
-        size_t array_size = res.arrayVal.size();
+        bool smtArray = res.kind == SymbolicValue::Kind::SmtArray;
+        size_t array_size = arrayLength(res);
         smt::Term idx;
-        if (auto lit = std::get_if<IntLit>(&ai->index)) {
+        auto symbolicIndex = [&]() {
+          auto id = std::get<LocalOrSymId>(ai->index);
+          auto t = std::visit([&](auto &&v) { return store.at(v.name).term; }, id);
+          auto idxSort = solver.get_sort(t);
+          if (solver.get_bv_width(idxSort) != 32)
+            t = solver.make_term(
+                smt::Kind::BV_SIGN_EXTEND, {t}, {32 - solver.get_bv_width(idxSort)}
+            );
+          return t;
+        };
+        if (smtArray) {
+          // A literal and a symbolic index are one and the same select.
+          if (auto lit = std::get_if<IntLit>(&ai->index))
+            idx = solver.make_bv_value(solver.make_bv_sort(32), std::to_string(lit->value), 10);
+          else
+            idx = symbolicIndex();
+          res = SymbolicValue(
+              SymbolicValue::Kind::Int, solver.make_term(smt::Kind::ARRAY_SELECT, {res.term, idx}),
+              solver.make_term(smt::Kind::ARRAY_SELECT, {res.is_defined, idx})
+          );
+        } else if (auto lit = std::get_if<IntLit>(&ai->index)) {
           idx = solver.make_bv_value(solver.make_bv_sort(32), std::to_string(lit->value), 10);
           // [v0.2.1] Out-of-range literal index is UB at compile time —
           // emit the bounds constraint (it'll be false → UNSAT) without
@@ -1030,24 +2545,33 @@ namespace symir {
           if (lit->value < 0 || static_cast<uint64_t>(lit->value) >= array_size) {
             pc.push_back(solver.make_false());
             // Use the last element as a dummy value (we won't be used).
-            if (!res.arrayVal.empty())
-              res = res.arrayVal.back();
+            if (array_size > 0)
+              res = cellOf(res, array_size - 1, solver);
             else
               res = SymbolicValue{SymbolicValue::Kind::Undef};
           } else {
-            SymbolicValue next = res.arrayVal.at(lit->value);
+            SymbolicValue next = cellOf(res, lit->value, solver);
             res = std::move(next);
           }
         } else {
-          auto id = std::get<LocalOrSymId>(ai->index);
-          idx = std::visit([&](auto &&v) { return store.at(v.name).term; }, id);
-          auto idxSort = solver.get_sort(idx);
-          if (solver.get_bv_width(idxSort) != 32) {
-            idx = solver.make_term(
-                smt::Kind::BV_SIGN_EXTEND, {idx}, {32 - solver.get_bv_width(idxSort)}
-            );
+          idx = symbolicIndex();
+          std::optional<SymbolicValue> untouched;
+          if (res.lazy())
+            untouched = fillAt(*res.fill, idx, solver);
+          if (untouched) {
+            // The cells touched so far, over what the others hold at `idx`.
+            SymbolicValue next = std::move(*untouched);
+            for (const auto &[k, cell]: res.cells) {
+              auto kT = solver.make_bv_value_uint64(solver.get_sort(idx), k);
+              next = muxSymbolicValue(
+                  solver.make_term(smt::Kind::EQUAL, {idx, kT}), cell, next, solver
+              );
+            }
+            res = std::move(next);
+          } else {
+            densify(res, solver);
+            res = mergeAggregate(res.arrayVal, idx, solver);
           }
-          res = mergeAggregate(res.arrayVal, idx, solver);
         }
         // Strict UB: bounds check
         auto size_term =
@@ -1065,7 +2589,7 @@ namespace symir {
     // [v0.2.1] Strict UB rule 3: reading an `undef` scalar is UB. Add
     // is_defined as a path constraint. Suppressed on the LHS-eval of
     // an AssignInstr (the caller is about to overwrite the value).
-    if (!forWrite && res.kind == SymbolicValue::Kind::Int && res.is_defined.internal)
+    if (!forWrite && res.kind == SymbolicValue::Kind::Int && res.is_defined)
       pc.push_back(res.is_defined);
     return res;
   }
@@ -1096,19 +2620,48 @@ namespace symir {
       }
       res.term = solver.make_term(smt::Kind::ITE, {cond, tTerm, fTerm});
       res.is_defined = solver.make_term(smt::Kind::ITE, {cond, t.is_defined, f.is_defined});
-      auto bv64 = solver.make_bv_sort(64);
+      auto bv64 = solver.make_bv_sort(ptrBits());
       auto zero = solver.make_bv_value_int64(bv64, 0);
-      auto tBase = t.prov_base.internal ? t.prov_base : zero;
-      auto fBase = f.prov_base.internal ? f.prov_base : zero;
-      auto tSize = t.prov_size.internal ? t.prov_size : zero;
-      auto fSize = f.prov_size.internal ? f.prov_size : zero;
+      auto tBase = t.prov_base ? t.prov_base : zero;
+      auto fBase = f.prov_base ? f.prov_base : zero;
+      auto tSize = t.prov_size ? t.prov_size : zero;
+      auto fSize = f.prov_size ? f.prov_size : zero;
       res.prov_base = solver.make_term(smt::Kind::ITE, {cond, tBase, fBase});
       res.prov_size = solver.make_term(smt::Kind::ITE, {cond, tSize, fSize});
+    } else if (t.kind == SymbolicValue::Kind::SmtArray) {
+      if (t.arraySize != f.arraySize)
+        throw std::runtime_error("Muxing arrays/vectors of different sizes");
+      res.arraySize = t.arraySize;
+      res.term = solver.make_term(smt::Kind::ITE, {cond, t.term, f.term});
+      res.is_defined = solver.make_term(smt::Kind::ITE, {cond, t.is_defined, f.is_defined});
     } else if (t.kind == SymbolicValue::Kind::Array || t.kind == SymbolicValue::Kind::Vec) {
-      if (t.arrayVal.size() != f.arrayVal.size())
+      if (arrayLength(t) != arrayLength(f))
         throw std::runtime_error("Muxing arrays/vectors of different sizes");
-      for (size_t i = 0; i < t.arrayVal.size(); ++i) {
-        res.arrayVal.push_back(muxSymbolicValue(cond, t.arrayVal[i], f.arrayVal[i], solver));
+      if (t.lazy() && f.lazy()) {
+        // Mux the cells touched on either side; the others stay lazy.
+        res.arraySize = t.arraySize;
+        if (t.fill == f.fill) {
+          res.fill = t.fill;
+        } else {
+          auto fill = std::make_shared<LazyFill>();
+          fill->kind = LazyFill::Kind::Mux;
+          fill->cond = cond;
+          fill->prev = t.fill;
+          fill->other = f.fill;
+          res.fill = std::move(fill);
+        }
+        for (const auto &[k, _]: t.cells)
+          res.cells[k] = muxSymbolicValue(cond, cellOf(t, k, solver), cellOf(f, k, solver), solver);
+        for (const auto &[k, _]: f.cells)
+          if (!res.cells.count(k))
+            res.cells[k] =
+                muxSymbolicValue(cond, cellOf(t, k, solver), cellOf(f, k, solver), solver);
+        return res;
+      }
+      for (size_t i = 0; i < arrayLength(t); ++i) {
+        res.arrayVal.push_back(
+            muxSymbolicValue(cond, cellOf(t, i, solver), cellOf(f, i, solver), solver)
+        );
       }
     } else if (t.kind == SymbolicValue::Kind::Struct) {
       for (const auto &[key, val]: t.structVal) {
@@ -1121,40 +2674,29 @@ namespace symir {
   }
 
   SymbolicExecutor::SymbolicValue SymbolicExecutor::updateLValueRec(
-      const SymbolicValue &cur, std::span<const Access> accesses, const SymbolicValue &val,
-      smt::Term pathCond, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc,
-      int depth
+      const SymbolicValue &cur, std::span<const WriteStep> steps, const SymbolicValue &val,
+      smt::Term pathCond, smt::ISolver &solver, std::vector<smt::Term> &pc, int depth
   ) {
     if (depth > 100)
       throw std::runtime_error("Recursion depth exceeded in updateLValueRec");
 
-    if (accesses.empty()) {
+    if (steps.empty()) {
       return muxSymbolicValue(pathCond, val, cur, solver);
     }
 
-    const Access &acc = accesses[0];
-    auto nextAccesses = accesses.subspan(1);
+    const WriteStep &step = steps[0];
+    auto nextSteps = steps.subspan(1);
     SymbolicValue newCur = cur; // Copy
 
-    if (auto ai = std::get_if<AccessIndex>(&acc)) {
-      if (cur.kind != SymbolicValue::Kind::Array && cur.kind != SymbolicValue::Kind::Vec)
+    if (step.field.empty()) {
+      if (cur.kind != SymbolicValue::Kind::Array && cur.kind != SymbolicValue::Kind::Vec &&
+          cur.kind != SymbolicValue::Kind::SmtArray)
         throw std::runtime_error("Indexing non-array in setLValue");
 
-      smt::Term idx;
-      if (auto lit = std::get_if<IntLit>(&ai->index)) {
-        idx = solver.make_bv_value(solver.make_bv_sort(32), std::to_string(lit->value), 10);
-      } else {
-        auto id = std::get<LocalOrSymId>(ai->index);
-        idx = std::visit([&](auto &&v) { return store.at(v.name).term; }, id);
-        if (solver.get_bv_width(solver.get_sort(idx)) != 32) {
-          idx = solver.make_term(
-              smt::Kind::BV_SIGN_EXTEND, {idx}, {32 - solver.get_bv_width(solver.get_sort(idx))}
-          );
-        }
-      }
+      const smt::Term &idx = step.idx;
 
       // Bounds check UB
-      size_t size = cur.arrayVal.size();
+      size_t size = arrayLength(cur);
       if (size == 0)
         throw std::runtime_error("Indexing empty array");
 
@@ -1168,35 +2710,86 @@ namespace symir {
           smt::Kind::IMPLIES, {pathCond, solver.make_term(smt::Kind::BV_SLT, {idx, size_term})}
       ));
 
-      if (auto lit = std::get_if<IntLit>(&ai->index)) {
+      if (cur.kind == SymbolicValue::Kind::SmtArray) {
+        // One store, whatever the index; off the taken path it rewrites
+        // the old element.
+        if (!nextSteps.empty())
+          throw std::runtime_error("Accessing into a scalar array element in setLValue");
+        auto oldVal = solver.make_term(smt::Kind::ARRAY_SELECT, {cur.term, idx});
+        auto oldDef = solver.make_term(smt::Kind::ARRAY_SELECT, {cur.is_defined, idx});
+        smt::Term v = val.term;
+        auto vSort = solver.get_sort(v);
+        auto eSort = solver.get_sort(oldVal);
+        if (solver.is_bv_sort(vSort) && solver.is_bv_sort(eSort)) {
+          auto vw = solver.get_bv_width(vSort);
+          auto ew = solver.get_bv_width(eSort);
+          if (vw < ew)
+            v = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {v}, {ew - vw});
+          else if (vw > ew)
+            v = solver.make_term(smt::Kind::BV_EXTRACT, {v}, {ew - 1, 0});
+        }
+        auto def = val.is_defined ? val.is_defined : solver.make_true();
+        v = solver.make_term(smt::Kind::ITE, {pathCond, v, oldVal});
+        def = solver.make_term(smt::Kind::ITE, {pathCond, def, oldDef});
+        newCur.term = solver.make_term(smt::Kind::ARRAY_STORE, {cur.term, idx, v});
+        newCur.is_defined = solver.make_term(smt::Kind::ARRAY_STORE, {cur.is_defined, idx, def});
+      } else if (step.literal) {
         // Constant index
-        uint64_t k = lit->value;
-        if (k < newCur.arrayVal.size()) {
-          newCur.arrayVal[k] = updateLValueRec(
-              cur.arrayVal[k], nextAccesses, val, pathCond, solver, store, pc, depth + 1
+        uint64_t k = step.k;
+        if (k < size) {
+          auto cell = updateLValueRec(
+              cellOf(cur, k, solver), nextSteps, val, pathCond, solver, pc, depth + 1
           );
+          if (newCur.lazy())
+            newCur.cells[k] = std::move(cell);
+          else
+            newCur.arrayVal[k] = std::move(cell);
         }
       } else {
         // Symbolic index
         auto idxSort = solver.get_sort(idx);
-        for (size_t k = 0; k < newCur.arrayVal.size(); ++k) {
+        auto at = [&](std::uint64_t k) {
           auto k_term = solver.make_bv_value(idxSort, std::to_string(k), 10);
           auto match = solver.make_term(smt::Kind::EQUAL, {idx, k_term});
-          auto cond = solver.make_term(smt::Kind::AND, {pathCond, match});
-          newCur.arrayVal[k] = updateLValueRec(
-              cur.arrayVal[k], nextAccesses, val, cond, solver, store, pc, depth + 1
-          );
+          return solver.make_term(smt::Kind::AND, {pathCond, match});
+        };
+        if (newCur.lazy()) {
+          // Update the touched cells; the others get the write in their fill.
+          for (auto &[k, cell]: newCur.cells)
+            cell = updateLValueRec(cell, nextSteps, val, at(k), solver, pc, depth + 1);
+          if (!nextSteps.empty()) {
+            // The UB guards below this index only depend on the element
+            // type, so one cell pushes them for all untouched ones.
+            const LazyFill *base = newCur.fill.get();
+            while (base->prev)
+              base = base->prev.get();
+            updateLValueRec(
+                fillAt(*base, 0, solver), nextSteps, val, pathCond, solver, pc, depth + 1
+            );
+          }
+          auto fill = std::make_shared<LazyFill>();
+          fill->kind = LazyFill::Kind::Write;
+          fill->value = val;
+          fill->cond = pathCond;
+          fill->idx = idx;
+          fill->rest.assign(nextSteps.begin(), nextSteps.end());
+          fill->prev = newCur.fill;
+          newCur.fill = std::move(fill);
+        } else {
+          for (size_t k = 0; k < newCur.arrayVal.size(); ++k)
+            newCur.arrayVal[k] = updateLValueRec(
+                newCur.arrayVal[k], nextSteps, val, at(k), solver, pc, depth + 1
+            );
         }
       }
     } else {
-      auto &af = std::get<AccessField>(acc);
       if (cur.kind != SymbolicValue::Kind::Struct)
         throw std::runtime_error("Field access on non-struct in setLValue");
-      if (cur.structVal.find(af.field) == cur.structVal.end())
-        throw std::runtime_error("Field not found: " + af.field);
+      if (cur.structVal.find(step.field) == cur.structVal.end())
+        throw std::runtime_error("Field not found: " + step.field);
 
-      newCur.structVal[af.field] = updateLValueRec(
-          cur.structVal.at(af.field), nextAccesses, val, pathCond, solver, store, pc, depth + 1
+      newCur.structVal[step.field] = updateLValueRec(
+          cur.structVal.at(step.field), nextSteps, val, pathCond, solver, pc, depth + 1
       );
     }
     return newCur;
@@ -1206,10 +2799,31 @@ namespace symir {
       const LValue &lv, const SymbolicValue &val, smt::ISolver &solver, SymbolicStore &store,
       std::vector<smt::Term> &pc
   ) {
+    std::vector<WriteStep> steps;
+    for (const auto &acc: lv.accesses) {
+      WriteStep step;
+      if (auto ai = std::get_if<AccessIndex>(&acc)) {
+        if (auto lit = std::get_if<IntLit>(&ai->index)) {
+          step.idx =
+              solver.make_bv_value(solver.make_bv_sort(32), std::to_string(lit->value), 10);
+          step.literal = true;
+          step.k = static_cast<std::uint64_t>(lit->value);
+        } else {
+          auto id = std::get<LocalOrSymId>(ai->index);
+          step.idx = std::visit([&](auto &&v) { return store.at(v.name).term; }, id);
+          uint32_t w = solver.get_bv_width(solver.get_sort(step.idx));
+          if (w != 32)
+            step.idx = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {step.idx}, {32 - w});
+        }
+      } else {
+        step.field = std::get<AccessField>(acc).field;
+      }
+      steps.push_back(std::move(step));
+    }
     SymbolicValue &root = store.at(lv.base.name);
     // Use true condition because the instruction itself is unconditional *at this point in the
     // trace* The path constraints handle the reachability of the instruction.
-    root = updateLValueRec(root, lv.accesses, val, solver.make_true(), solver, store, pc, 0);
+    root = updateLValueRec(root, steps, val, solver.make_true(), solver, pc, 0);
   }
 
   // Enforce spec §7.4 rules 6–7: add NOT(fp.isInfinite(t)) AND NOT(fp.isNaN(t)) to pc.
@@ -1220,6 +2834,79 @@ namespace symir {
     pc.push_back(notNaN);
   }
 
+  smt::Term SymbolicExecutor::fpDefinition(
+      smt::Kind kind, smt::Term a, smt::Term b, smt::ISolver &solver
+  ) {
+    // SPEC §2.9: all FP ops use RNE. The fmod encoding additionally uses
+    // RTZ for the quotient-to-integer step.
+    auto rmRNE = solver.make_rm_value(smt::RoundingMode::RNE);
+    if (kind != smt::Kind::FP_REM)
+      return solver.make_term(kind, {rmRNE, a, b});
+    // fmod(x,y) = x - trunc(x/y)*y  (truncated-quotient, matches integer %)
+    // Encode as: fp.sub(x, fp.mul(fp.roundToIntegral[RTZ](fp.div(x,y)), y))
+    auto rmRTZ = solver.make_rm_value(smt::RoundingMode::RTZ);
+    auto q = solver.make_term(smt::Kind::FP_DIV, {rmRNE, a, b});
+    auto qi = solver.make_term(smt::Kind::FP_RTI, {rmRTZ, q});
+    auto prod = solver.make_term(smt::Kind::FP_MUL, {rmRNE, qi, b});
+    return solver.make_term(smt::Kind::FP_SUB, {rmRNE, a, prod});
+  }
+
+  smt::Term SymbolicExecutor::fpArith(
+      smt::Kind kind, smt::Term a, smt::Term b, smt::ISolver &solver, std::vector<smt::Term> &pc
+  ) {
+    if (!lazyFp_) {
+      smt::Term r = fpDefinition(kind, a, b, solver);
+      assertFPFinite(r, solver, pc);
+      return r;
+    }
+    auto sort = solver.get_sort(a);
+    smt::Term r = solver.make_const(sort, "%fp." + std::to_string(lazyFp_->ops.size()));
+    lazyFp_->ops.push_back({kind, a, b, r});
+    assertFPFinite(r, solver, pc);
+
+    // Rounding is monotone and keeps the sign of the exact result, so these
+    // hold whatever the op rounds to. fp.geq/fp.leq do not tell the zeros
+    // apart, which makes them hold for a -0 result as well.
+    auto zero = solver.make_fp_value_from_real(sort, 0.0, smt::RoundingMode::RNE);
+    auto geq = [&](smt::Term x, smt::Term y) {
+      return solver.make_term(smt::Kind::FP_GEQ, {x, y});
+    };
+    auto leq = [&](smt::Term x, smt::Term y) {
+      return solver.make_term(smt::Kind::FP_LEQ, {x, y});
+    };
+    auto both = [&](smt::Term x, smt::Term y) {
+      return solver.make_term(smt::Kind::AND, {x, y});
+    };
+    auto implies = [&](smt::Term p, smt::Term q) {
+      pc.push_back(solver.make_term(smt::Kind::IMPLIES, {p, q}));
+    };
+    auto aPos = geq(a, zero), aNeg = leq(a, zero);
+    auto bPos = geq(b, zero), bNeg = leq(b, zero);
+    switch (kind) {
+      case smt::Kind::FP_ADD:
+        implies(bPos, geq(r, a));
+        implies(bNeg, leq(r, a));
+        implies(aPos, geq(r, b));
+        implies(aNeg, leq(r, b));
+        break;
+      case smt::Kind::FP_SUB:
+        implies(bPos, leq(r, a));
+        implies(bNeg, geq(r, a));
+        break;
+      case smt::Kind::FP_MUL:
+      case smt::Kind::FP_DIV: {
+        auto same = solver.make_term(smt::Kind::OR, {both(aPos, bPos), both(aNeg, bNeg)});
+        auto opposite = solver.make_term(smt::Kind::OR, {both(aPos, bNeg), both(aNeg, bPos)});
+        implies(same, geq(r, zero));
+        implies(opposite, leq(r, zero));
+        break;
+      }
+      default: // %: its encoding rounds twice, so nothing cheap is certain
+        break;
+    }
+    return r;
+  }
+
   SymbolicExecutor::SymbolicValue SymbolicExecutor::evalExpr(
       const Expr &e, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc,
       std::optional<smt::Sort> expectedSort
@@ -1229,7 +2916,7 @@ namespace symir {
     // caller didn't supply an expected sort, propagate the first atom's sort
     // to subsequent atoms.
     std::optional<smt::Sort> chainSort = expectedSort;
-    if (!chainSort && res.term.internal)
+    if (!chainSort && res.term)
       chainSort = solver.get_sort(res.term);
 
     // Detect pointer arithmetic or pointer subtraction dynamically.
@@ -1238,7 +2925,14 @@ namespace symir {
     uint64_t ptrStep = 0;
     if (isPtrExpr) {
       auto pointeeTy = std::get<PtrType>(firstTy->v).pointee;
-      ptrStep = sizeofTagUnits(pointeeTy, structs_);
+      ptrStep = tagUnits(pointeeTy);
+    }
+    // Pointer arithmetic is done on kPtrBits: offsets are i64 and so is the
+    // difference of two pointers. A pointer result is narrowed back at the end.
+    bool isPtrResult = isPtrExpr;
+    if (isPtrExpr && !e.rest.empty()) {
+      res.term = widenPtr(res.term, solver);
+      chainSort = solver.make_bv_sort(kPtrBits);
     }
 
     for (const auto &tail: e.rest) {
@@ -1246,18 +2940,15 @@ namespace symir {
       bool rhsIsPtr = rightTy && std::holds_alternative<PtrType>(rightTy->v);
 
       SymbolicValue right = evalAtom(tail.atom, solver, store, pc, chainSort);
+      if (rhsIsPtr)
+        right.term = widenPtr(right.term, solver);
 
       auto lSort = solver.get_sort(res.term);
       auto rSort = solver.get_sort(right.term);
 
       if (solver.is_fp_sort(lSort)) {
-        auto rmRNE = solver.make_rm_value(smt::RoundingMode::RNE);
-        if (tail.op == AddOp::Plus) {
-          res.term = solver.make_term(smt::Kind::FP_ADD, {rmRNE, res.term, right.term});
-        } else {
-          res.term = solver.make_term(smt::Kind::FP_SUB, {rmRNE, res.term, right.term});
-        }
-        assertFPFinite(res.term, solver, pc);
+        auto kind = tail.op == AddOp::Plus ? smt::Kind::FP_ADD : smt::Kind::FP_SUB;
+        res.term = fpArith(kind, res.term, right.term, solver, pc);
       } else if (solver.is_bv_sort(lSort) && solver.is_bv_sort(rSort)) {
         auto lWidth = solver.get_bv_width(lSort);
         auto rWidth = solver.get_bv_width(rSort);
@@ -1287,9 +2978,9 @@ namespace symir {
           if (isPtrSub) {
             // Pointer subtraction:
             // 1. Rule 12 dynamic assertion (matching bases, non-zero)
-            auto bv64 = solver.make_bv_sort(64);
+            auto bv64 = solver.make_bv_sort(ptrBits());
             auto zero = solver.make_bv_value_int64(bv64, 0);
-            if (res.prov_base.internal && right.prov_base.internal) {
+            if (res.prov_base && right.prov_base) {
               auto eqBase = solver.make_term(smt::Kind::EQUAL, {res.prov_base, right.prov_base});
               auto nonZeroBase = solver.make_term(smt::Kind::DISTINCT, {res.prov_base, zero});
               pc.push_back(solver.make_term(smt::Kind::AND, {eqBase, nonZeroBase}));
@@ -1310,6 +3001,7 @@ namespace symir {
             // 4. Result is an integer, so clear provenance
             res.prov_base = {};
             res.prov_size = {};
+            isPtrResult = false;
           } else {
             res.term = solver.make_term(smt::Kind::BV_SUB, {res.term, right.term});
           }
@@ -1317,14 +3009,19 @@ namespace symir {
 
         // [v0.2.1] Rule 10 (ptr arith OOB): for ptr ± int, result must stay in [base, base + size].
         if (isPtrIntArith) {
-          if (res.prov_base.internal && res.prov_size.internal) {
-            auto end = solver.make_term(smt::Kind::BV_ADD, {res.prov_base, res.prov_size});
-            pc.push_back(solver.make_term(smt::Kind::BV_ULE, {res.prov_base, res.term}));
+          if (res.prov_base && res.prov_size) {
+            auto base = widenPtr(res.prov_base, solver);
+            auto end = widenPtr(
+                solver.make_term(smt::Kind::BV_ADD, {res.prov_base, res.prov_size}), solver
+            );
+            pc.push_back(solver.make_term(smt::Kind::BV_ULE, {base, res.term}));
             pc.push_back(solver.make_term(smt::Kind::BV_ULE, {res.term, end}));
           }
         }
       }
     }
+    if (isPtrResult && !e.rest.empty())
+      res.term = narrowPtr(res.term, solver, pc);
     return res;
   }
 
@@ -1343,25 +3040,16 @@ namespace symir {
             auto rSort = solver.get_sort(r);
 
             if (solver.is_fp_sort(cSort)) {
-              // SPEC §2.9: all FP ops use RNE. The fmod encoding additionally
-              // uses RTZ for the quotient-to-integer step.
-              auto rmRNE = solver.make_rm_value(smt::RoundingMode::RNE);
-              smt::Term fpRes;
+              smt::Kind kind;
               if (arg.op == AtomOpKind::Mul)
-                fpRes = solver.make_term(smt::Kind::FP_MUL, {rmRNE, c, r});
+                kind = smt::Kind::FP_MUL;
               else if (arg.op == AtomOpKind::Div)
-                fpRes = solver.make_term(smt::Kind::FP_DIV, {rmRNE, c, r});
-              else if (arg.op == AtomOpKind::Mod) {
-                // fmod(x,y) = x - trunc(x/y)*y  (truncated-quotient, matches integer %)
-                // Encode as: fp.sub(x, fp.mul(fp.roundToIntegral[RTZ](fp.div(x,y)), y))
-                auto rmRTZ = solver.make_rm_value(smt::RoundingMode::RTZ);
-                auto q = solver.make_term(smt::Kind::FP_DIV, {rmRNE, c, r});
-                auto qi = solver.make_term(smt::Kind::FP_RTI, {rmRTZ, q});
-                auto prod = solver.make_term(smt::Kind::FP_MUL, {rmRNE, qi, r});
-                fpRes = solver.make_term(smt::Kind::FP_SUB, {rmRNE, c, prod});
-              } else
+                kind = smt::Kind::FP_DIV;
+              else if (arg.op == AtomOpKind::Mod)
+                kind = smt::Kind::FP_REM;
+              else
                 return {};
-              assertFPFinite(fpRes, solver, pc);
+              smt::Term fpRes = fpArith(kind, c, r, solver, pc);
               return SymbolicValue(SymbolicValue::Kind::Int, fpRes, solver.make_true());
             }
 
@@ -1512,7 +3200,7 @@ namespace symir {
             return muxSymbolicValue(cond, vt, vf, solver);
           } else if constexpr (std::is_same_v<T, CoefAtom>) {
             smt::Term term = evalCoef(arg.coef, solver, store, expectedSort);
-            auto bv64 = solver.make_bv_sort(64);
+            auto bv64 = solver.make_bv_sort(ptrBits());
             auto zero = solver.make_bv_value_int64(bv64, 0);
             return SymbolicValue(SymbolicValue::Kind::Int, term, solver.make_true(), zero, zero);
           } else if constexpr (std::is_same_v<T, RValueAtom>) {
@@ -1602,9 +3290,9 @@ namespace symir {
             if (isLhsPtr || isRhsPtr) {
               if (arg.op == RelOp::LT || arg.op == RelOp::LE || arg.op == RelOp::GT ||
                   arg.op == RelOp::GE) {
-                auto bv64 = solver.make_bv_sort(64);
+                auto bv64 = solver.make_bv_sort(ptrBits());
                 auto zero = solver.make_bv_value_int64(bv64, 0);
-                if (lVal.prov_base.internal && rVal.prov_base.internal) {
+                if (lVal.prov_base && rVal.prov_base) {
                   auto eqBase =
                       solver.make_term(smt::Kind::EQUAL, {lVal.prov_base, rVal.prov_base});
                   auto nonZeroBase = solver.make_term(smt::Kind::DISTINCT, {lVal.prov_base, zero});
@@ -1645,25 +3333,14 @@ namespace symir {
             );
           } else if constexpr (std::is_same_v<T, AddrAtom>) {
             const std::string targetName = arg.lv.base.name;
-            auto bv64 = solver.make_bv_sort(kPtrBits);
-            smt::Term tag =
-                solver.make_bv_value_int64(bv64, static_cast<int64_t>(tagOfLocal(targetName)));
-            TypePtr cur;
-            if (currentFun_) {
-              for (const auto &l: currentFun_->lets)
-                if (l.name.name == targetName) {
-                  cur = l.type;
-                  break;
-                }
-              if (!cur)
-                for (const auto &p: currentFun_->params)
-                  if (p.name.name == targetName) {
-                    cur = p.type;
-                    break;
-                  }
-            }
+            auto bv64 = solver.make_bv_sort(ptrBits());
+            const auto *local = currentLocal(targetName);
+            if (!local)
+              throw std::runtime_error("addr of unknown local: " + targetName);
+            smt::Term tag = solver.make_bv_value_int64(bv64, static_cast<int64_t>(local->tag));
+            TypePtr cur = local->type;
             smt::Term prov_base = tag;
-            std::uint64_t initial_size = sizeofTagUnits(cur, structs_);
+            std::uint64_t initial_size = tagUnits(cur);
             smt::Term prov_size =
                 solver.make_bv_value_int64(bv64, static_cast<int64_t>(initial_size));
 
@@ -1672,7 +3349,7 @@ namespace symir {
                 auto at = std::get_if<ArrayType>(&cur->v);
                 if (!at)
                   throw std::runtime_error("addr: index on non-array");
-                std::uint64_t stride = sizeofTagUnits(at->elem, structs_);
+                std::uint64_t stride = tagUnits(at->elem);
                 prov_base = tag;
                 prov_size =
                     solver.make_bv_value_int64(bv64, static_cast<int64_t>(at->size * stride));
@@ -1693,10 +3370,15 @@ namespace symir {
                   if (iw < kPtrBits)
                     idxT = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {idxT}, {kPtrBits - iw});
                   if (stride != 1) {
-                    auto stT = solver.make_bv_value_int64(bv64, static_cast<int64_t>(stride));
+                    auto stT = solver.make_bv_value_int64(
+                        solver.make_bv_sort(kPtrBits), static_cast<int64_t>(stride)
+                    );
                     idxT = solver.make_term(smt::Kind::BV_MUL, {idxT, stT});
                   }
-                  tag = solver.make_term(smt::Kind::BV_ADD, {tag, idxT});
+                  tag = narrowPtr(
+                      solver.make_term(smt::Kind::BV_ADD, {widenPtr(tag, solver), idxT}), solver,
+                      pc
+                  );
                   cur = at->elem;
                   continue;
                 }
@@ -1705,22 +3387,19 @@ namespace symir {
                 auto st = std::get_if<StructType>(&cur->v);
                 if (!st)
                   throw std::runtime_error("'addr' field access on non-struct base: " + targetName);
-                auto sIt = structs_.find(st->name.name);
-                if (sIt == structs_.end())
+                auto lIt = layouts_.find(st->name.name);
+                if (lIt == layouts_.end())
                   throw std::runtime_error("unknown struct in addr field access");
                 prov_base = tag;
-                std::uint64_t stSize = sizeofTagUnits(cur, structs_);
+                std::uint64_t stSize = lIt->second.size;
                 prov_size = solver.make_bv_value_int64(bv64, static_cast<int64_t>(stSize));
 
-                std::uint64_t off = fieldOffsetTagUnits(*sIt->second, af->field, structs_);
-                TypePtr fieldTy;
-                for (const auto &f: sIt->second->fields)
-                  if (f.name == af->field) {
-                    fieldTy = f.type;
-                    break;
-                  }
-                if (!fieldTy)
+                const auto &fields = lIt->second.fields;
+                auto fIt = fields.find(af->field);
+                if (fIt == fields.end())
                   throw std::runtime_error("addr: unknown field " + af->field);
+                std::uint64_t off = fIt->second.offset;
+                TypePtr fieldTy = fIt->second.type;
                 if (off != 0) {
                   auto ofT = solver.make_bv_value_int64(bv64, static_cast<int64_t>(off));
                   tag = solver.make_term(smt::Kind::BV_ADD, {tag, ofT});
@@ -1734,14 +3413,15 @@ namespace symir {
                 SymbolicValue::Kind::Int, tag, solver.make_true(), prov_base, prov_size
             );
           } else if constexpr (std::is_same_v<T, PtrIndexAtom>) {
-            auto bv64 = solver.make_bv_sort(kPtrBits);
+            auto bv64 = solver.make_bv_sort(ptrBits());
+            auto wide = solver.make_bv_sort(kPtrBits); // index arithmetic
             SymbolicValue ptrVal = evalLValue(arg.rval, solver, store, pc);
             smt::Term ptrTerm = ptrVal.term;
 
             auto nullTerm = solver.make_bv_value_int64(bv64, 0);
             pc.push_back(solver.make_term(smt::Kind::DISTINCT, {ptrTerm, nullTerm}));
 
-            if (ptrVal.prov_base.internal && ptrVal.prov_size.internal) {
+            if (ptrVal.prov_base && ptrVal.prov_size) {
               auto endAddr =
                   solver.make_term(smt::Kind::BV_ADD, {ptrVal.prov_base, ptrVal.prov_size});
               pc.push_back(solver.make_term(smt::Kind::DISTINCT, {ptrTerm, endAddr}));
@@ -1749,7 +3429,7 @@ namespace symir {
 
             smt::Term idxT;
             if (auto il = std::get_if<IntLit>(&arg.index)) {
-              idxT = solver.make_bv_value_int64(bv64, il->value);
+              idxT = solver.make_bv_value_int64(wide, il->value);
             } else if (auto id = std::get_if<LocalOrSymId>(&arg.index)) {
               smt::Term raw = std::visit([&](auto &&v) { return store.at(v.name).term; }, *id);
               auto rawSort = solver.get_sort(raw);
@@ -1766,7 +3446,7 @@ namespace symir {
               if (baseType) {
                 if (auto pt = std::get_if<PtrType>(&baseType->v)) {
                   if (auto at = std::get_if<ArrayType>(&pt->pointee->v)) {
-                    elemUnits = sizeofTagUnits(at->elem, structs_);
+                    elemUnits = tagUnits(at->elem);
                     arrSize = at->size;
                   }
                 }
@@ -1774,17 +3454,19 @@ namespace symir {
             }
 
             if (arrSize > 0) {
-              auto zero = solver.make_bv_value_int64(bv64, 0);
-              auto N = solver.make_bv_value_int64(bv64, static_cast<int64_t>(arrSize));
+              auto zero = solver.make_bv_value_int64(wide, 0);
+              auto N = solver.make_bv_value_int64(wide, static_cast<int64_t>(arrSize));
               pc.push_back(solver.make_term(smt::Kind::BV_SLE, {zero, idxT}));
               pc.push_back(solver.make_term(smt::Kind::BV_SLE, {idxT, N}));
             }
 
             if (elemUnits != 1) {
-              auto stride = solver.make_bv_value_int64(bv64, static_cast<int64_t>(elemUnits));
+              auto stride = solver.make_bv_value_int64(wide, static_cast<int64_t>(elemUnits));
               idxT = solver.make_term(smt::Kind::BV_MUL, {idxT, stride});
             }
-            smt::Term newAddr = solver.make_term(smt::Kind::BV_ADD, {ptrTerm, idxT});
+            smt::Term newAddr = narrowPtr(
+                solver.make_term(smt::Kind::BV_ADD, {widenPtr(ptrTerm, solver), idxT}), solver, pc
+            );
 
             smt::Term prov_base = ptrTerm;
             smt::Term prov_size =
@@ -1795,14 +3477,14 @@ namespace symir {
           } else if constexpr (std::is_same_v<T, PtrFieldAtom>) {
             if (!currentFun_)
               throw std::runtime_error("ptrfield encountered without active FunDecl");
-            auto bv64 = solver.make_bv_sort(kPtrBits);
+            auto bv64 = solver.make_bv_sort(ptrBits());
             SymbolicValue ptrVal = evalLValue(arg.rval, solver, store, pc);
             smt::Term ptrTerm = ptrVal.term;
 
             auto nullTerm = solver.make_bv_value_int64(bv64, 0);
             pc.push_back(solver.make_term(smt::Kind::DISTINCT, {ptrTerm, nullTerm}));
 
-            if (ptrVal.prov_base.internal && ptrVal.prov_size.internal) {
+            if (ptrVal.prov_base && ptrVal.prov_size) {
               auto endAddr =
                   solver.make_term(smt::Kind::BV_ADD, {ptrVal.prov_base, ptrVal.prov_size});
               pc.push_back(solver.make_term(smt::Kind::DISTINCT, {ptrTerm, endAddr}));
@@ -1815,32 +3497,22 @@ namespace symir {
             if (!std::holds_alternative<StructType>(pt.pointee->v))
               throw std::runtime_error("ptrfield: pointee is not a struct");
             auto &st = std::get<StructType>(pt.pointee->v);
-            auto sIt = structs_.find(st.name.name);
-            if (sIt == structs_.end())
+            auto lIt = layouts_.find(st.name.name);
+            if (lIt == layouts_.end())
               throw std::runtime_error("ptrfield: unknown struct " + st.name.name);
-            bool found = false;
-            for (const auto &f: sIt->second->fields)
-              if (f.name == arg.field) {
-                found = true;
-                break;
-              }
-            if (!found)
+            const auto &fields = lIt->second.fields;
+            auto fIt = fields.find(arg.field);
+            if (fIt == fields.end())
               throw std::runtime_error("ptrfield: unknown field " + arg.field);
-            std::uint64_t off = fieldOffsetTagUnits(*sIt->second, arg.field, structs_);
+            std::uint64_t off = fIt->second.offset;
             smt::Term newAddr = ptrTerm;
             if (off != 0) {
               auto offT = solver.make_bv_value_int64(bv64, static_cast<int64_t>(off));
               newAddr = solver.make_term(smt::Kind::BV_ADD, {ptrTerm, offT});
             }
 
-            TypePtr fieldTy;
-            for (const auto &f: sIt->second->fields)
-              if (f.name == arg.field) {
-                fieldTy = f.type;
-                break;
-              }
             smt::Term prov_base = ptrTerm;
-            std::uint64_t structSize = sizeofTagUnits(pt.pointee, structs_);
+            std::uint64_t structSize = tagUnits(pt.pointee);
             smt::Term prov_size =
                 solver.make_bv_value_int64(bv64, static_cast<int64_t>(structSize));
             return SymbolicValue(
@@ -1867,10 +3539,10 @@ namespace symir {
             } else {
               result = solver.make_bv_value(pointeeSort, "0", 10);
             }
-            auto bv64 = solver.make_bv_sort(kPtrBits);
+            auto bv64 = solver.make_bv_sort(ptrBits());
             auto zero = solver.make_bv_value_int64(bv64, 0);
 
-            if (ptrVal.prov_base.internal && ptrVal.prov_size.internal) {
+            if (ptrVal.prov_base && ptrVal.prov_size) {
               auto hasProv = solver.make_term(smt::Kind::DISTINCT, {ptrVal.prov_base, zero});
               auto inBoundsLower = solver.make_term(smt::Kind::BV_ULE, {ptrVal.prov_base, ptrTerm});
               auto endAddr =
@@ -1887,12 +3559,35 @@ namespace symir {
             smt::Term res_prov_size = zero;
 
             std::vector<smt::Term> matchConds;
-            std::function<void(const TypePtr &, SymbolicValue &, std::uint64_t, std::uint64_t)>
+            std::function<void(
+                const TypePtr &, const SymbolicValue &, std::uint64_t, std::uint64_t
+            )>
                 enumLoad;
-            enumLoad = [&](const TypePtr &ty, SymbolicValue &sv, std::uint64_t baseTag,
+            enumLoad = [&](const TypePtr &ty, const SymbolicValue &sv, std::uint64_t baseTag,
                            std::uint64_t off) {
               if (!ty)
                 return;
+              if (sv.kind == SymbolicValue::Kind::SmtArray) {
+                // See enumStore: one range check and one select.
+                auto at = std::get_if<ArrayType>(&ty->v);
+                if (!at || !typeMatch(at->elem, pointeeType))
+                  return;
+                auto firstTag =
+                    solver.make_bv_value_int64(bv64, static_cast<int64_t>(baseTag + off));
+                auto delta = solver.make_term(smt::Kind::BV_SUB, {ptrTerm, firstTag});
+                auto cond = solver.make_term(
+                    smt::Kind::BV_ULT, {delta, solver.make_bv_value_uint64(bv64, sv.arraySize)}
+                );
+                matchConds.push_back(cond);
+                auto idx = arrayIndexOf(delta, solver);
+                result = solver.make_term(
+                    smt::Kind::ITE,
+                    {cond, solver.make_term(smt::Kind::ARRAY_SELECT, {sv.term, idx}), result}
+                );
+                res_prov_base = solver.make_term(smt::Kind::ITE, {cond, zero, res_prov_base});
+                res_prov_size = solver.make_term(smt::Kind::ITE, {cond, zero, res_prov_size});
+                return;
+              }
               if (typeMatch(ty, pointeeType)) {
                 auto tagTerm =
                     solver.make_bv_value_int64(bv64, static_cast<int64_t>(baseTag + off));
@@ -1900,16 +3595,16 @@ namespace symir {
                 matchConds.push_back(cond);
                 result = solver.make_term(smt::Kind::ITE, {cond, sv.term, result});
 
-                auto svBase = sv.prov_base.internal ? sv.prov_base : zero;
-                auto svSize = sv.prov_size.internal ? sv.prov_size : zero;
+                auto svBase = sv.prov_base ? sv.prov_base : zero;
+                auto svSize = sv.prov_size ? sv.prov_size : zero;
                 res_prov_base = solver.make_term(smt::Kind::ITE, {cond, svBase, res_prov_base});
                 res_prov_size = solver.make_term(smt::Kind::ITE, {cond, svSize, res_prov_size});
                 return;
               }
               if (auto at = std::get_if<ArrayType>(&ty->v)) {
-                std::uint64_t stride = sizeofTagUnits(at->elem, structs_);
-                for (std::uint64_t k = 0; k < at->size && k < sv.arrayVal.size(); ++k)
-                  enumLoad(at->elem, sv.arrayVal[k], baseTag, off + k * stride);
+                std::uint64_t stride = tagUnits(at->elem);
+                for (std::uint64_t k = 0; k < at->size && k < arrayLength(sv); ++k)
+                  enumLoad(at->elem, cellOf(sv, k, solver), baseTag, off + k * stride);
                 return;
               }
               if (auto st = std::get_if<StructType>(&ty->v)) {
@@ -1921,15 +3616,14 @@ namespace symir {
                   auto fIt = sv.structVal.find(f.name);
                   if (fIt != sv.structVal.end())
                     enumLoad(f.type, fIt->second, baseTag, off + fOff);
-                  fOff += sizeofTagUnits(f.type, structs_);
+                  fOff += tagUnits(f.type);
                 }
                 return;
               }
             };
-            for (const auto &l: currentFun_->lets) {
-              std::uint64_t baseTag = tagOfLocal(l.name.name);
-              enumLoad(l.type, store.at(l.name.name), baseTag, 0);
-            }
+            const auto &lets = currentFun_->lets;
+            for (std::size_t k: currentCtx_->candidateLets(arg))
+              enumLoad(lets[k].type, store.at(lets[k].name.name), currentCtx_->letTags[k], 0);
             auto nullPtr = solver.make_bv_value_int64(bv64, 0);
             pc.push_back(solver.make_term(smt::Kind::DISTINCT, {ptrTerm, nullPtr}));
             if (!matchConds.empty()) {
@@ -2185,7 +3879,7 @@ namespace symir {
               // lane is still undef. Use the lane's source is_defined if
               // present; default to "defined" otherwise.
               smt::Term chosenDef;
-              if (vtArm.arrayVal[k].is_defined.internal && vfArm.arrayVal[k].is_defined.internal) {
+              if (vtArm.arrayVal[k].is_defined && vfArm.arrayVal[k].is_defined) {
                 chosenDef = solver.make_term(
                     smt::Kind::ITE,
                     {cond, vtArm.arrayVal[k].is_defined, vfArm.arrayVal[k].is_defined}
@@ -2420,110 +4114,1142 @@ namespace symir {
     );
   }
 
-  smt::Term SymbolicExecutor::evalCoef(
-      const Coef &c, smt::ISolver &solver, SymbolicStore &store,
-      std::optional<smt::Sort> expectedSort
+  smt::Term SymbolicExecutor::evalCoef(
+      const Coef &c, smt::ISolver &solver, SymbolicStore &store,
+      std::optional<smt::Sort> expectedSort
+  ) {
+    if (auto lit = std::get_if<IntLit>(&c)) {
+      smt::Sort s = expectedSort.value_or(solver.make_bv_sort(32));
+      return solver.make_bv_value(s, std::to_string(lit->value), 10);
+    }
+    if (auto flit = std::get_if<FloatLit>(&c)) {
+      smt::Sort s = expectedSort.value_or(solver.make_fp_sort(8, 24));
+      return solver.make_fp_value(s, std::to_string(flit->value), smt::RoundingMode::RNE);
+    }
+    if (std::get_if<NullLit>(&c)) {
+      // null = tag 0 (pointer width)
+      return solver.make_bv_value(solver.make_bv_sort(ptrBits()), "0", 10);
+    }
+    auto id = std::get<LocalOrSymId>(c);
+    return std::visit([&](auto &&v) { return store.at(v.name).term; }, id);
+  }
+
+  SymbolicExecutor::SymbolicValue SymbolicExecutor::evalSelectVal(
+      const SelectVal &sv, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc,
+      std::optional<smt::Sort> expectedSort
+  ) {
+    if (auto rv = std::get_if<RValue>(&sv))
+      return evalLValue(*rv, solver, store, pc);
+    smt::Term t = evalCoef(std::get<Coef>(sv), solver, store, expectedSort);
+    return SymbolicValue(SymbolicValue::Kind::Int, t, solver.make_true());
+  }
+
+  smt::Term SymbolicExecutor::evalCond(
+      const Cond &c, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc
+  ) {
+    SymbolicValue lhsVal = evalExpr(c.lhs, solver, store, pc);
+    smt::Term lhs = lhsVal.term;
+    SymbolicValue rhsVal = evalExpr(c.rhs, solver, store, pc, solver.get_sort(lhs));
+    smt::Term rhs = rhsVal.term;
+
+    // [v0.2.1] Dynamic Rule 14 Relational Comparison check
+    TypePtr lhsType = resolveExprType(c.lhs);
+    TypePtr rhsType = resolveExprType(c.rhs);
+    bool isLhsPtr = lhsType && std::holds_alternative<PtrType>(lhsType->v);
+    bool isRhsPtr = rhsType && std::holds_alternative<PtrType>(rhsType->v);
+    bool isRelational =
+        (c.op == RelOp::LT || c.op == RelOp::LE || c.op == RelOp::GT || c.op == RelOp::GE);
+    if (isRelational && isLhsPtr && isRhsPtr) {
+      auto bv64 = solver.make_bv_sort(ptrBits());
+      auto zero = solver.make_bv_value_int64(bv64, 0);
+      if (lhsVal.prov_base && rhsVal.prov_base) {
+        auto eqBase = solver.make_term(smt::Kind::EQUAL, {lhsVal.prov_base, rhsVal.prov_base});
+        auto nonZeroBase = solver.make_term(smt::Kind::DISTINCT, {lhsVal.prov_base, zero});
+        pc.push_back(solver.make_term(smt::Kind::AND, {eqBase, nonZeroBase}));
+      } else {
+        pc.push_back(solver.make_false());
+      }
+    }
+
+    auto lSort = solver.get_sort(lhs);
+    auto rSort = solver.get_sort(rhs);
+
+    if (solver.is_fp_sort(lSort)) {
+      switch (c.op) {
+        case RelOp::EQ:
+          return solver.make_term(smt::Kind::FP_EQUAL, {lhs, rhs});
+        case RelOp::NE:
+          return solver.make_term(
+              smt::Kind::NOT, {solver.make_term(smt::Kind::FP_EQUAL, {lhs, rhs})}
+          );
+        case RelOp::LT:
+          return solver.make_term(smt::Kind::FP_LT, {lhs, rhs});
+        case RelOp::LE:
+          return solver.make_term(smt::Kind::FP_LEQ, {lhs, rhs});
+        case RelOp::GT:
+          return solver.make_term(smt::Kind::FP_GT, {lhs, rhs});
+        case RelOp::GE:
+          return solver.make_term(smt::Kind::FP_GEQ, {lhs, rhs});
+      }
+    }
+
+    if (solver.is_bv_sort(lSort) && solver.is_bv_sort(rSort)) {
+      auto lWidth = solver.get_bv_width(lSort);
+      auto rWidth = solver.get_bv_width(rSort);
+      if (lWidth < rWidth) {
+        lhs = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {lhs}, {rWidth - lWidth});
+      } else if (rWidth < lWidth) {
+        rhs = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {rhs}, {lWidth - rWidth});
+      }
+    }
+
+    switch (c.op) {
+      case RelOp::EQ:
+        return solver.make_term(smt::Kind::EQUAL, {lhs, rhs});
+      case RelOp::NE:
+        return solver.make_term(smt::Kind::DISTINCT, {lhs, rhs});
+      case RelOp::LT:
+        return solver.make_term(smt::Kind::BV_SLT, {lhs, rhs});
+      case RelOp::LE:
+        return solver.make_term(smt::Kind::BV_SLE, {lhs, rhs});
+      case RelOp::GT:
+        return solver.make_term(smt::Kind::BV_SGT, {lhs, rhs});
+      case RelOp::GE:
+        return solver.make_term(smt::Kind::BV_SGE, {lhs, rhs});
+    }
+    return {};
+  }
+
+  // Rough heap footprint of a snapshot, used to enforce the prefix cache
+  // cap. Terms are counted as handles only: their payload is shared with
+  // the solver and usually with other snapshots.
+  static std::size_t keyBytes(const std::string &s) { return s.capacity(); }
+  static std::size_t keyBytes(Symbol) { return 0; } // interned once
+
+  template<typename Value>
+  static std::size_t approxValueBytes(const Value &v) {
+    std::size_t n = sizeof(v);
+    for (const auto &e: v.arrayVal)
+      n += approxValueBytes(e);
+    for (const auto &[k, e]: v.cells)
+      n += approxValueBytes(e);
+    for (const auto &[field, e]: v.structVal)
+      n += keyBytes(field) + approxValueBytes(e);
+    return n;
+  }
+
+  template<typename Store>
+  static std::size_t approxStoreBytes(const Store &store) {
+    std::size_t n = 0;
+    for (const auto &[name, v]: store)
+      n += keyBytes(name) + approxValueBytes(v);
+    return n;
+  }
+
+  std::shared_ptr<SymbolicExecutor::PrefixNode>
+  SymbolicExecutor::PrefixCache::find(PrefixNode &parent, const std::string &label) {
+    auto it = parent.children.find(label);
+    if (it == parent.children.end())
+      return nullptr;
+    auto &node = it->second;
+    lru_.splice(lru_.begin(), lru_, node->lruPos);
+    return node;
+  }
+
+  void SymbolicExecutor::PrefixCache::insert(
+      PrefixNode &parent, const std::shared_ptr<PrefixNode> &child
+  ) {
+    // An evicted parent is unreachable from the root: caching below it
+    // would only hold memory that no lookup can hit.
+    if (!parent.cached || capBytes_ == 0)
+      return;
+    child->bytes = sizeof(PrefixNode) + child->label.capacity() +
+                   approxStoreBytes(child->store) +
+                   child->ptrProv.size() * (sizeof(PtrProvenance) + sizeof(std::string)) +
+                   (child->pathConstraints.size() + child->requirements.size()) *
+                       sizeof(smt::Term);
+    child->parent = &parent;
+    child->cached = true;
+    lru_.push_front(child.get());
+    child->lruPos = lru_.begin();
+    bytes_ += child->bytes;
+    parent.children[child->label] = child;
+
+    while (bytes_ > capBytes_ && !lru_.empty())
+      evict(*lru_.back());
+  }
+
+  void SymbolicExecutor::PrefixCache::evict(PrefixNode &node) {
+    // Children go first; `node` itself may be freed once its parent drops
+    // the last owning reference, so unlink it last.
+    while (!node.children.empty())
+      evict(*node.children.begin()->second);
+    lru_.erase(node.lruPos);
+    bytes_ -= node.bytes;
+    node.cached = false;
+    PrefixNode *parent = node.parent;
+    node.parent = nullptr;
+    if (parent) {
+      std::string label = node.label;
+      parent->children.erase(label);
+    }
+  }
+
+  SymbolicExecutor::Result SymbolicExecutor::solveInSession(
+      SampleSession &session, const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
+  ) {
+    const FunDecl &fun = *ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    FunScope funScope(ctx);
+
+    // The entry declarations do not depend on the path: encode them once
+    // per session. Incremental sessions keep them at the base level.
+    QueryProbe probe = session.solver ? startQuery(*session.solver) : QueryProbe{};
+    if (!session.solver) {
+      auto solverPtr = makeSolver();
+      probe = startQuery(*solverPtr);
+      auto root = std::make_shared<PrefixNode>();
+      ptrProv_.clear();
+      encodeEntry(fun, *solverPtr, root->store, root->pathConstraints, fixedSyms);
+      if (config_.incremental) {
+        for (auto c: root->pathConstraints)
+          solverPtr->assert_formula(c);
+      }
+      root->label = path.empty() ? std::string() : path.front();
+      root->ptrProv = ptrProv_;
+      root->cached = true;
+      session.root = root;
+      session.frames.assign(1, root);
+      session.solver = std::move(solverPtr);
+    }
+    smt::ISolver &solver = *session.solver;
+    probe.pathLen = static_cast<uint32_t>(path.size());
+
+    auto blockOf = [&](const std::string &label) -> const Block & {
+      auto it = cfg.indexOf.find(label);
+      if (it == cfg.indexOf.end())
+        throw std::runtime_error("Invalid block label in path: " + label);
+      return fun.blocks[it->second];
+    };
+
+    // frames[j] (j >= 1) stands for path[0..j]; keep the frames strictly
+    // inside the common prefix with the previous path and drop the rest.
+    // The labels of the previous path are recovered from the frames.
+    if (!path.empty() && path.front() != session.root->label)
+      throw std::runtime_error("Sampled path does not start at the session's first block");
+    std::size_t keep = 1;
+    while (keep < session.frames.size() && keep < path.size() &&
+           session.frames[keep]->label == path[keep])
+      ++keep;
+    if (keep < session.frames.size()) {
+      if (config_.incremental)
+        solver.pop(static_cast<uint32_t>(session.frames.size() - keep));
+      session.frames.resize(keep);
+    }
+
+    // `store`/ptrProv_ are only materialized from the last frame when a
+    // block actually has to be encoded; cache hits just move along.
+    SymbolicStore store;
+    bool stale = true;
+    auto materialize = [&]() {
+      if (!stale)
+        return;
+      store = session.frames.back()->store;
+      ptrProv_ = session.frames.back()->ptrProv;
+      stale = false;
+    };
+
+    // Extend the chain edge by edge, taking each step from the prefix cache
+    // when it is there. In incremental mode every edge gets its own scope,
+    // opened only once the step is known, so an exception leaves the
+    // session consistent.
+    for (std::size_t i = session.frames.size(); i < path.size(); ++i) {
+      PrefixNode &parent = *session.frames.back();
+      std::shared_ptr<PrefixNode> node;
+      if (session.cache)
+        node = session.cache->find(parent, path[i]);
+      if (node) {
+        stale = true;
+      } else {
+        materialize();
+        node = std::make_shared<PrefixNode>();
+        node->label = path[i];
+        encodeBlock(
+            blockOf(path[i - 1]), path[i - 1], &path[i], solver, store, node->pathConstraints,
+            node->requirements
+        );
+        node->store = store;
+        node->ptrProv = ptrProv_;
+        if (session.cache)
+          session.cache->insert(parent, node);
+      }
+      if (config_.incremental) {
+        solver.push();
+        for (auto c: node->pathConstraints)
+          solver.assert_formula(c);
+        for (auto r: node->requirements)
+          solver.assert_formula(r);
+      }
+      session.frames.push_back(std::move(node));
+    }
+
+    // The last block has no outgoing edge and is what differs most often
+    // between consecutive samples; check it under assumptions.
+    std::vector<smt::Term> assumptions;
+    std::vector<smt::Term> requirements;
+    materialize();
+    if (!path.empty()) {
+      encodeBlock(
+          blockOf(path.back()), path.back(), nullptr, solver, store, assumptions, requirements
+      );
+    }
+    assumptions.insert(assumptions.end(), requirements.begin(), requirements.end());
+
+    // The query as a whole, for the query cache and the statistics.
+    std::vector<smt::Term> query;
+    if (config_.query_cache || config_.stats) {
+      for (const auto &frame: session.frames) {
+        query.insert(query.end(), frame->pathConstraints.begin(), frame->pathConstraints.end());
+        query.insert(query.end(), frame->requirements.begin(), frame->requirements.end());
+      }
+      query.insert(query.end(), assumptions.begin(), assumptions.end());
+    }
+    auto slots = symSlots(fun, store);
+    Result res;
+    if (config_.incremental) {
+      smt::Result r = checkQuery(probe, solver, query, slots, res, [&] {
+        return solver.check_sat_assuming(assumptions);
+      });
+      return withVerdict(std::move(res), r);
+    }
+
+    // Otherwise the solver is only shared for its terms: assert the whole
+    // chain in a scope of its own and retract it again after the check.
+    solver.push();
+    smt::Result r;
+    try {
+      r = checkQuery(probe, solver, query, slots, res, [&] {
+        for (const auto &frame: session.frames) {
+          for (auto c: frame->pathConstraints)
+            solver.assert_formula(c);
+          for (auto req: frame->requirements)
+            solver.assert_formula(req);
+        }
+        return solver.check_sat_assuming(assumptions);
+      });
+    } catch (...) {
+      solver.pop();
+      throw;
+    }
+    solver.pop();
+    return withVerdict(std::move(res), r);
+  }
+
+  std::optional<SymbolicExecutor::Result> SymbolicExecutor::walkOnline(
+      const FunctionContext &ctx, std::mt19937 &rng, const std::vector<std::string> &prefixPath,
+      uint32_t maxPathLen, bool requireTerminal,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
+  ) {
+    const FunDecl &fun = *ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    FunScope funScope(ctx);
+
+    auto solverPtr = makeSolver();
+    smt::ISolver &solver = *solverPtr;
+    QueryProbe probe = startQuery(solver);
+    SymbolicStore store;
+    // Everything asserted so far; with the assumptions of a check on top,
+    // the query that check answers.
+    std::vector<smt::Term> asserted;
+    ptrProv_.clear();
+    encodeEntry(fun, solver, store, asserted, fixedSyms);
+    for (auto c: asserted)
+      solver.assert_formula(c);
+
+    auto indexOf = [&](const std::string &label) {
+      auto it = cfg.indexOf.find(label);
+      if (it == cfg.indexOf.end())
+        throw std::runtime_error("Invalid block label in path: " + label);
+      return it->second;
+    };
+    auto isTerminal = [&](std::size_t idx) {
+      return std::holds_alternative<RetTerm>(fun.blocks[idx].term) ||
+             std::holds_alternative<UnreachableTerm>(fun.blocks[idx].term);
+    };
+
+    std::vector<std::string> path{prefixPath.empty() ? cfg.blocks[cfg.entry] : prefixPath[0]};
+    std::size_t currentIdx = indexOf(path.front());
+
+    // Encodes the last block of `path` with its edge to `next` and asserts
+    // the result for good.
+    auto commitEdge = [&](std::size_t next) {
+      std::vector<smt::Term> pc, req;
+      encodeBlock(
+          fun.blocks[currentIdx], path.back(), &cfg.blocks[next], solver, store, pc, req
+      );
+      pc.insert(pc.end(), req.begin(), req.end());
+      for (auto c: pc)
+        solver.assert_formula(c);
+      asserted.insert(asserted.end(), pc.begin(), pc.end());
+      path.push_back(cfg.blocks[next]);
+      currentIdx = next;
+    };
+
+    // Checks the assertions under `assumptions` as one query.
+    auto check = [&](const std::vector<smt::Term> &assumptions) {
+      std::size_t base = asserted.size();
+      asserted.insert(asserted.end(), assumptions.begin(), assumptions.end());
+      smt::Result r = countedCheck(probe, solver, asserted, [&] {
+        return solver.check_sat_assuming(assumptions);
+      });
+      asserted.resize(base);
+      return r;
+    };
+
+    // The prefix is taken as given; only the random part is pruned.
+    for (std::size_t i = 1; i < prefixPath.size(); ++i)
+      commitEdge(indexOf(prefixPath[i]));
+
+    auto unsatResult = [&]() {
+      Result res;
+      res.unsat = true;
+      return res;
+    };
+
+    // With requireTerminal, no edge is checked from a block that cannot
+    // reach a ret or onto one.
+    auto deadEnd = [&](std::size_t b) {
+      return requireTerminal && !ctx.canReachRet->test(b);
+    };
+    while (!isTerminal(currentIdx) && path.size() < maxPathLen) {
+      if (deadEnd(currentIdx))
+        return std::nullopt;
+      std::vector<std::size_t> successors = cfg.succ[currentIdx];
+      if (successors.empty())
+        break;
+      if (successors.size() == 1) {
+        commitEdge(successors[0]);
+        continue;
+      }
+
+      // Try the successors in random order, each on a copy of the state,
+      // until one edge is not refuted. UNKNOWN counts as feasible.
+      std::shuffle(successors.begin(), successors.end(), rng);
+      bool moved = false, skipped = false;
+      for (std::size_t next: successors) {
+        if (deadEnd(next)) {
+          skipped = true;
+          continue;
+        }
+        SymbolicStore trial = store;
+        auto provBefore = ptrProv_;
+        std::vector<smt::Term> pc, req;
+        encodeBlock(
+            fun.blocks[currentIdx], path.back(), &cfg.blocks[next], solver, trial, pc, req
+        );
+        std::vector<smt::Term> assumptions = pc;
+        assumptions.insert(assumptions.end(), req.begin(), req.end());
+        probe.pathLen = static_cast<uint32_t>(path.size());
+        if (check(assumptions) == smt::Result::UNSAT) {
+          ptrProv_ = std::move(provBefore);
+          continue;
+        }
+        for (auto c: assumptions)
+          solver.assert_formula(c);
+        asserted.insert(asserted.end(), assumptions.begin(), assumptions.end());
+        store = std::move(trial);
+        path.push_back(cfg.blocks[next]);
+        currentIdx = next;
+        moved = true;
+        break;
+      }
+      // Every edge is refuted: the path so far is already infeasible.
+      if (!moved)
+        return skipped ? std::nullopt : std::optional<Result>(unsatResult());
+    }
+
+    if (!isTerminal(currentIdx)) {
+      if (!requireTerminal)
+        return std::nullopt;
+      while (!std::holds_alternative<RetTerm>(fun.blocks[currentIdx].term)) {
+        auto it = ctx.nextToRet->find(currentIdx);
+        if (it == ctx.nextToRet->end())
+          return std::nullopt;
+        commitEdge(it->second);
+      }
+    }
+
+    std::vector<smt::Term> assumptions, requirements;
+    encodeBlock(
+        fun.blocks[currentIdx], path.back(), nullptr, solver, store, assumptions, requirements
+    );
+    assumptions.insert(assumptions.end(), requirements.begin(), requirements.end());
+    probe.pathLen = static_cast<uint32_t>(path.size());
+    return extractModel(fun, solver, store, check(assumptions));
+  }
+
+  struct SymbolicExecutor::PathSession::State {
+    FunctionContext ctx;
+    std::unique_ptr<smt::ISolver> solver;
+    QueryProbe probe;
+    SymbolicStore store;
+    std::unordered_map<Symbol, PtrProvenance> ptrProv;
+    std::vector<smt::Term> asserted; // everything committed so far
+    std::size_t declared = 0;        // syms of the function in `store`
+    uint32_t length = 0;             // blocks left so far
+    uint64_t checks = 0;
+  };
+
+  SymbolicExecutor::PathSession::PathSession(SymbolicExecutor &ex, const std::string &funcName) :
+      ex_(ex), state_(std::make_unique<State>()) {
+    // Everything of the function's context but what analyses of its blocks
+    // (points-to, merge regions, SSA) derived from them.
+    const FunctionContext &full = ex.contextOf(funcName);
+    State &st = *state_;
+    st.ctx.fun = full.fun;
+    st.ctx.cfg = full.cfg;
+    st.ctx.cfgOk = full.cfgOk;
+    st.ctx.nextToRet = full.nextToRet;
+    st.ctx.canReachRet = full.canReachRet;
+    st.ctx.locals = full.locals;
+    st.ctx.letTags = full.letTags;
+    st.ctx.ptrBits = full.ptrBits;
+    st.ctx.allLets = full.allLets;
+
+    FunScope funScope(st.ctx);
+    st.solver = ex.makeSolver();
+    st.probe = ex.startQuery(*st.solver);
+    ex.ptrProv_.clear();
+    ex.encodeEntry(*st.ctx.fun, *st.solver, st.store, st.asserted, {});
+    st.declared = st.ctx.fun->syms.size();
+    for (auto c: st.asserted)
+      st.solver->assert_formula(c);
+    st.ptrProv = ex.ptrProv_;
+  }
+
+  SymbolicExecutor::PathSession::~PathSession() = default;
+
+  uint64_t SymbolicExecutor::PathSession::checks() const { return state_->checks; }
+
+  smt::Result
+  SymbolicExecutor::PathSession::run(const Block &block, std::size_t firstInstr) {
+    return step(block, firstInstr, false, nullptr);
+  }
+
+  smt::Result SymbolicExecutor::PathSession::take(
+      const Block &block, std::size_t firstInstr, const std::string *next
+  ) {
+    smt::Result r = step(block, firstInstr, true, next);
+    if (r != smt::Result::UNSAT)
+      state_->length++;
+    return r;
+  }
+
+  smt::Result SymbolicExecutor::PathSession::step(
+      const Block &block, std::size_t firstInstr, bool terminator, const std::string *next
+  ) {
+    State &st = *state_;
+    const FunDecl &fun = *st.ctx.fun;
+    StatsScope statsScope(ex_, "extend", fun.name.name);
+    FunScope funScope(st.ctx);
+    smt::ISolver &solver = *st.solver;
+
+    // Encoded on copies, so that an UNSAT step leaves no trace.
+    SymbolicStore trial = st.store;
+    ex_.ptrProv_ = st.ptrProv;
+    std::vector<smt::Term> assumptions, requirements;
+    for (std::size_t k = st.declared; k < fun.syms.size(); ++k)
+      ex_.declareSym(fun.syms[k], solver, trial, assumptions, {});
+    ex_.encodeBlock(
+        block, block.label.name, next, solver, trial, assumptions, requirements, firstInstr,
+        terminator
+    );
+    assumptions.insert(assumptions.end(), requirements.begin(), requirements.end());
+
+    std::size_t base = st.asserted.size();
+    st.asserted.insert(st.asserted.end(), assumptions.begin(), assumptions.end());
+    st.probe.pathLen = st.length + 1;
+    st.checks++;
+    smt::Result r = ex_.countedCheck(st.probe, solver, st.asserted, [&] {
+      return solver.check_sat_assuming(assumptions);
+    });
+    if (r == smt::Result::UNSAT) {
+      st.asserted.resize(base);
+      return r;
+    }
+    for (auto c: assumptions)
+      solver.assert_formula(c);
+    st.store = std::move(trial);
+    st.ptrProv = ex_.ptrProv_;
+    st.declared = fun.syms.size();
+    return r;
+  }
+
+  // The distinct edges of `cfg`, numbered: out[u] holds (target, edge id).
+  static std::vector<std::vector<std::pair<std::size_t, std::size_t>>>
+  numberEdges(const CFG &cfg, std::size_t &numEdges) {
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> out(cfg.blocks.size());
+    numEdges = 0;
+    for (std::size_t u = 0; u < cfg.blocks.size(); ++u) {
+      for (std::size_t v: cfg.succ[u]) {
+        bool seen = std::any_of(out[u].begin(), out[u].end(), [&](const auto &e) {
+          return e.first == v;
+        });
+        if (!seen)
+          out[u].push_back({v, numEdges++});
+      }
+    }
+    return out;
+  }
+
+  SymbolicExecutor::EnumerateResult SymbolicExecutor::enumerate(
+      const std::string &funcName, const EnumerateOptions &opts,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
   ) {
-    if (auto lit = std::get_if<IntLit>(&c)) {
-      smt::Sort s = expectedSort.value_or(solver.make_bv_sort(32));
-      return solver.make_bv_value(s, std::to_string(lit->value), 10);
+    StatsScope statsScope(*this, "enumerate", funcName);
+    timing::Scope timer("enumerate");
+    const FunctionContext &ctx = contextOf(funcName);
+    const FunDecl *entry = ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    FunScope funScope(ctx);
+
+    const std::size_t numBlocks = cfg.blocks.size();
+    std::size_t numEdges;
+    auto out = numberEdges(cfg, numEdges);
+
+    // Back edges: edges to a block still on the DFS stack from the entry.
+    std::vector<char> isBack(numEdges, 0);
+    {
+      std::vector<char> state(numBlocks, 0); // 0 new, 1 on stack, 2 done
+      std::vector<std::pair<std::size_t, std::size_t>> stack{{cfg.entry, 0}};
+      state[cfg.entry] = 1;
+      while (!stack.empty()) {
+        auto &[u, next] = stack.back();
+        if (next == out[u].size()) {
+          state[u] = 2;
+          stack.pop_back();
+          continue;
+        }
+        auto [v, e] = out[u][next++];
+        if (state[v] == 1) {
+          isBack[e] = 1;
+        } else if (state[v] == 0) {
+          state[v] = 1;
+          stack.push_back({v, 0});
+        }
+      }
     }
-    if (auto flit = std::get_if<FloatLit>(&c)) {
-      smt::Sort s = expectedSort.value_or(solver.make_fp_sort(8, 24));
-      return solver.make_fp_value(s, std::to_string(flit->value), smt::RoundingMode::RNE);
+
+    // Blocks reachable from each block (itself included).
+    std::vector<std::vector<std::size_t>> reach(numBlocks);
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+      std::vector<char> seen(numBlocks, 0);
+      std::vector<std::size_t> work{b};
+      seen[b] = 1;
+      while (!work.empty()) {
+        std::size_t u = work.back();
+        work.pop_back();
+        reach[b].push_back(u);
+        for (auto [v, e]: out[u])
+          if (!seen[v]) {
+            seen[v] = 1;
+            work.push_back(v);
+          }
+      }
     }
-    if (std::get_if<NullLit>(&c)) {
-      // null = 0 as BV64 (pointer width)
-      return solver.make_bv_value(solver.make_bv_sort(64), "0", 10);
+
+    EnumerateResult res;
+    res.numBlocks = numBlocks;
+    res.numEdges = numEdges;
+    std::vector<char> blockCov(numBlocks, 0), edgeCov(numEdges, 0), reached(numBlocks, 0);
+
+    // Uncovered blocks and edges any path through `b` could still reach.
+    auto uncoveredFrom = [&](std::size_t b) {
+      std::size_t n = 0;
+      for (std::size_t u: reach[b]) {
+        n += !blockCov[u];
+        for (auto [v, e]: out[u])
+          n += !edgeCov[e];
+      }
+      return n;
+    };
+    auto isTerminal = [&](std::size_t b) {
+      return std::holds_alternative<RetTerm>(entry->blocks[b].term) ||
+             std::holds_alternative<UnreachableTerm>(entry->blocks[b].term);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    bool stopped = false, sawUnknown = false;
+    auto shouldStop = [&]() {
+      if (stopped)
+        return true;
+      if (res.coveredBlocks * 100 >= std::size_t(opts.coverageTarget) * numBlocks &&
+          res.coveredEdges * 100 >= std::size_t(opts.coverageTarget) * numEdges)
+        stopped = true;
+      else if (cancelled() || (opts.budgetMs && std::chrono::steady_clock::now() - start >=
+                                                      std::chrono::milliseconds(opts.budgetMs)))
+        stopped = true;
+      return stopped;
+    };
+
+    auto solverPtr = makeSolver();
+    smt::ISolver &solver = *solverPtr;
+    QueryProbe probe = startQuery(solver);
+    SymbolicStore store;
+    // Everything asserted in the current scopes, for the statistics.
+    std::vector<smt::Term> asserted;
+    ptrProv_.clear();
+    encodeEntry(*entry, solver, store, asserted, fixedSyms);
+    for (auto c: asserted)
+      solver.assert_formula(c);
+
+    std::vector<std::string> path;
+    std::vector<std::size_t> pathBlocks, pathEdges;
+    std::vector<uint32_t> backTaken(numEdges, 0);
+    auto check = [&]() {
+      ++res.checks;
+      probe.pathLen = static_cast<uint32_t>(path.size());
+      smt::Result r = countedCheck(probe, solver, asserted, [&] { return solver.check_sat(); });
+      sawUnknown |= r == smt::Result::UNKNOWN;
+      return r;
+    };
+
+    // Each level owns one solver scope: the encoding of `cur` with its edge.
+    std::function<void(std::size_t, const SymbolicStore &)> visit =
+        [&](std::size_t cur, const SymbolicStore &st) {
+          if (isTerminal(cur)) {
+            SymbolicStore last = st;
+            std::vector<smt::Term> pc, req;
+            std::size_t base = asserted.size();
+            solver.push(1);
+            encodeBlock(entry->blocks[cur], path.back(), nullptr, solver, last, pc, req);
+            pc.insert(pc.end(), req.begin(), req.end());
+            for (auto c: pc)
+              solver.assert_formula(c);
+            asserted.insert(asserted.end(), pc.begin(), pc.end());
+            smt::Result r = check();
+            if (r == smt::Result::SAT) {
+              bool fresh = false;
+              for (std::size_t b: pathBlocks)
+                if (!blockCov[b]) {
+                  blockCov[b] = 1;
+                  ++res.coveredBlocks;
+                  fresh = true;
+                }
+              for (std::size_t e: pathEdges)
+                if (!edgeCov[e]) {
+                  edgeCov[e] = 1;
+                  ++res.coveredEdges;
+                  fresh = true;
+                }
+              if (fresh)
+                res.witnesses.push_back({path, extractModel(*entry, solver, last, r)});
+            }
+            solver.pop(1);
+            asserted.resize(base);
+            return;
+          }
+          if (path.size() >= opts.maxPathLen)
+            return;
+
+          std::vector<std::pair<std::size_t, std::size_t>> candidates;
+          for (auto edge: out[cur])
+            if (!isBack[edge.second] || backTaken[edge.second] < opts.unroll)
+              candidates.push_back(edge);
+
+          while (!candidates.empty() && !shouldStop()) {
+            // Best first: an uncovered edge, then an uncovered target, then
+            // the most uncovered items beyond it. Re-ranked after every
+            // subtree since coverage has moved on.
+            auto best = std::max_element(
+                candidates.begin(), candidates.end(),
+                [&](const auto &a, const auto &b) {
+                  auto key = [&](const auto &c) {
+                    return std::make_tuple(
+                        !edgeCov[c.second], !blockCov[c.first], uncoveredFrom(c.first)
+                    );
+                  };
+                  return key(a) < key(b);
+                }
+            );
+            auto [next, edge] = *best;
+            candidates.erase(best);
+            if (edgeCov[edge] && uncoveredFrom(next) == 0)
+              continue; // nothing left to cover down there
+
+            SymbolicStore trial = st;
+            auto provBefore = ptrProv_;
+            std::vector<smt::Term> pc, req;
+            std::size_t base = asserted.size();
+            solver.push(1);
+            encodeBlock(
+                entry->blocks[cur], path.back(), &cfg.blocks[next], solver, trial, pc, req
+            );
+            pc.insert(pc.end(), req.begin(), req.end());
+            for (auto c: pc)
+              solver.assert_formula(c);
+            asserted.insert(asserted.end(), pc.begin(), pc.end());
+            bool feasible = true;
+            if (out[cur].size() > 1) {
+              smt::Result r = check();
+              feasible = r != smt::Result::UNSAT;
+              if (r == smt::Result::SAT) {
+                for (std::size_t b: pathBlocks)
+                  reached[b] = 1;
+                reached[next] = 1;
+              }
+            }
+            if (feasible) {
+              path.push_back(cfg.blocks[next]);
+              pathBlocks.push_back(next);
+              pathEdges.push_back(edge);
+              ++backTaken[edge];
+              visit(next, trial);
+              --backTaken[edge];
+              pathEdges.pop_back();
+              pathBlocks.pop_back();
+              path.pop_back();
+            }
+            solver.pop(1);
+            asserted.resize(base);
+            ptrProv_ = std::move(provBefore);
+          }
+        };
+
+    path.push_back(cfg.blocks[cfg.entry]);
+    pathBlocks.push_back(cfg.entry);
+    visit(cfg.entry, store);
+
+    res.exhaustive = !stopped && !sawUnknown;
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+      if (blockCov[b])
+        continue;
+      res.uncovered.push_back(cfg.blocks[b]);
+      if (!reached[b])
+        res.unreached.push_back(cfg.blocks[b]);
     }
-    auto id = std::get<LocalOrSymId>(c);
-    return std::visit([&](auto &&v) { return store.at(v.name).term; }, id);
+    return res;
   }
 
-  SymbolicExecutor::SymbolicValue SymbolicExecutor::evalSelectVal(
-      const SelectVal &sv, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc,
-      std::optional<smt::Sort> expectedSort
-  ) {
-    if (auto rv = std::get_if<RValue>(&sv))
-      return evalLValue(*rv, solver, store, pc);
-    smt::Term t = evalCoef(std::get<Coef>(sv), solver, store, expectedSort);
-    return SymbolicValue(SymbolicValue::Kind::Int, t, solver.make_true());
+  // A value of sym `s` for the seed input of concolic(): uniform over its
+  // domain or, without one, over its type. Floats start at 0.
+  static Interpreter::SymBindings::mapped_type seedValue(const SymDecl &s, std::mt19937 &rng) {
+    if (std::holds_alternative<FloatType>(s.type->v))
+      return 0.0;
+    if (s.domain) {
+      if (auto *set = std::get_if<DomainSet>(&*s.domain)) {
+        if (set->values.empty())
+          return int64_t(0);
+        std::uniform_int_distribution<std::size_t> pick(0, set->values.size() - 1);
+        return set->values[pick(rng)];
+      }
+    }
+    uint32_t bits = TypeUtils::getBitWidth(s.type).value_or(32);
+    int64_t lo = bits >= 64 ? INT64_MIN : -(int64_t(1) << (bits - 1));
+    int64_t hi = bits >= 64 ? INT64_MAX : (int64_t(1) << (bits - 1)) - 1;
+    if (s.domain) {
+      const auto &d = std::get<DomainInterval>(*s.domain);
+      if (std::max(lo, d.lo) <= std::min(hi, d.hi)) {
+        lo = std::max(lo, d.lo);
+        hi = std::min(hi, d.hi);
+      }
+    }
+    return std::uniform_int_distribution<int64_t>(lo, hi)(rng);
   }
 
-  smt::Term SymbolicExecutor::evalCond(
-      const Cond &c, smt::ISolver &solver, SymbolicStore &store, std::vector<smt::Term> &pc
+  SymbolicExecutor::ConcolicResult SymbolicExecutor::concolic(
+      const std::string &funcName, const ConcolicOptions &opts,
+      const std::unordered_map<std::string, int64_t> &fixedSyms
   ) {
-    SymbolicValue lhsVal = evalExpr(c.lhs, solver, store, pc);
-    smt::Term lhs = lhsVal.term;
-    SymbolicValue rhsVal = evalExpr(c.rhs, solver, store, pc, solver.get_sort(lhs));
-    smt::Term rhs = rhsVal.term;
+    StatsScope statsScope(*this, "concolic", funcName);
+    timing::Scope timer("concolic");
+    const FunctionContext &ctx = contextOf(funcName);
+    const FunDecl &fun = *ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    FunScope funScope(ctx);
+    // The Interpreter binds neither params nor per-lane vector syms.
+    if (!fun.params.empty())
+      throw std::runtime_error("Concolic search needs a function without parameters: " + funcName);
+    for (const auto &s: fun.syms)
+      if (std::holds_alternative<VecType>(s.type->v))
+        throw std::runtime_error("Concolic search does not support the vector sym " + s.name.name);
+
+    const std::size_t numBlocks = cfg.blocks.size();
+    std::size_t numEdges;
+    auto out = numberEdges(cfg, numEdges);
+    auto edgeOf = [&](std::size_t u, std::size_t v) {
+      for (auto [w, e]: out[u])
+        if (w == v)
+          return e;
+      return SIZE_MAX;
+    };
 
-    // [v0.2.1] Dynamic Rule 14 Relational Comparison check
-    TypePtr lhsType = resolveExprType(c.lhs);
-    TypePtr rhsType = resolveExprType(c.rhs);
-    bool isLhsPtr = lhsType && std::holds_alternative<PtrType>(lhsType->v);
-    bool isRhsPtr = rhsType && std::holds_alternative<PtrType>(rhsType->v);
-    bool isRelational =
-        (c.op == RelOp::LT || c.op == RelOp::LE || c.op == RelOp::GT || c.op == RelOp::GE);
-    if (isRelational && isLhsPtr && isRhsPtr) {
-      auto bv64 = solver.make_bv_sort(64);
-      auto zero = solver.make_bv_value_int64(bv64, 0);
-      if (lhsVal.prov_base.internal && rhsVal.prov_base.internal) {
-        auto eqBase = solver.make_term(smt::Kind::EQUAL, {lhsVal.prov_base, rhsVal.prov_base});
-        auto nonZeroBase = solver.make_term(smt::Kind::DISTINCT, {lhsVal.prov_base, zero});
-        pc.push_back(solver.make_term(smt::Kind::AND, {eqBase, nonZeroBase}));
-      } else {
-        pc.push_back(solver.make_false());
+    ConcolicResult res;
+    res.numBlocks = numBlocks;
+    res.numEdges = numEdges;
+    std::vector<char> blockCov(numBlocks, 0), edgeCov(numEdges, 0);
+
+    Interpreter interp(prog_);
+    interp.setAnalysisManager(config_.analyses ? *config_.analyses : ownAnalyses_);
+    interp.setBudget({opts.maxSteps, 0});
+    std::vector<std::size_t> log;
+    interp.setBlockLog(&log);
+    auto fn = interp.prepare(funcName);
+
+    // An input that ran, waiting to be expanded: its branches from `bound`
+    // on are flipped.
+    struct Input {
+      std::size_t score;
+      uint64_t order;
+      Interpreter::SymBindings binding;
+      std::vector<std::size_t> blocks;
+      std::size_t bound;
+    };
+    auto later = [](const Input &a, const Input &b) {
+      return a.score != b.score ? a.score < b.score : a.order > b.order;
+    };
+    std::vector<Input> queue; // a heap by `later`
+
+    // Runs `binding` and queues it, scored by the coverage it adds.
+    auto runInput = [&](Interpreter::SymBindings binding, std::size_t bound) {
+      ++res.runs;
+      auto cr = interp.call(fn, {}, binding);
+      bool completed =
+          cr.status == Interpreter::CallResult::Status::Returned ||
+          (cr.status == Interpreter::CallResult::Status::Error && !log.empty() &&
+           std::holds_alternative<UnreachableTerm>(fun.blocks[log.back()].term));
+      std::size_t fresh = 0;
+      if (completed) {
+        for (std::size_t i = 0; i < log.size(); ++i) {
+          if (!blockCov[log[i]]) {
+            blockCov[log[i]] = 1;
+            ++res.coveredBlocks;
+            ++fresh;
+          }
+          std::size_t e = i + 1 < log.size() ? edgeOf(log[i], log[i + 1]) : SIZE_MAX;
+          if (e != SIZE_MAX && !edgeCov[e]) {
+            edgeCov[e] = 1;
+            ++res.coveredEdges;
+            ++fresh;
+          }
+        }
       }
-    }
+      if (fresh) {
+        EnumerateResult::Witness w;
+        for (std::size_t b: log)
+          w.path.push_back(cfg.blocks[b]);
+        w.model.sat = true;
+        w.model.model = binding;
+        res.witnesses.push_back(std::move(w));
+      }
+      queue.push_back({fresh, res.runs, std::move(binding), log, bound});
+      std::push_heap(queue.begin(), queue.end(), later);
+    };
 
-    auto lSort = solver.get_sort(lhs);
-    auto rSort = solver.get_sort(rhs);
+    auto start = std::chrono::steady_clock::now();
+    auto shouldStop = [&]() {
+      if (res.coveredBlocks * 100 >= std::size_t(opts.coverageTarget) * numBlocks &&
+          res.coveredEdges * 100 >= std::size_t(opts.coverageTarget) * numEdges)
+        return true;
+      if (cancelled() || (opts.maxRuns && res.runs >= opts.maxRuns))
+        return true;
+      return opts.budgetMs &&
+             std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(opts.budgetMs);
+    };
 
-    if (solver.is_fp_sort(lSort)) {
-      switch (c.op) {
-        case RelOp::EQ:
-          return solver.make_term(smt::Kind::FP_EQUAL, {lhs, rhs});
-        case RelOp::NE:
-          return solver.make_term(
-              smt::Kind::NOT, {solver.make_term(smt::Kind::FP_EQUAL, {lhs, rhs})}
-          );
-        case RelOp::LT:
-          return solver.make_term(smt::Kind::FP_LT, {lhs, rhs});
-        case RelOp::LE:
-          return solver.make_term(smt::Kind::FP_LEQ, {lhs, rhs});
-        case RelOp::GT:
-          return solver.make_term(smt::Kind::FP_GT, {lhs, rhs});
-        case RelOp::GE:
-          return solver.make_term(smt::Kind::FP_GEQ, {lhs, rhs});
+    std::mt19937 rng(config_.seed);
+    Interpreter::SymBindings seed;
+    for (const auto &s: fun.syms) {
+      auto fixed = fixedSyms.find(s.name.name);
+      seed[s.name.name] = fixed != fixedSyms.end() ? Interpreter::SymBindings::mapped_type(
+                                                         fixed->second
+                                                     )
+                                                   : seedValue(s, rng);
+    }
+    runInput(std::move(seed), 0);
+
+    // Hashes of the prefixes (with their flipped edge) already asked for.
+    std::unordered_set<uint64_t> asked;
+    while (!queue.empty() && !shouldStop()) {
+      std::pop_heap(queue.begin(), queue.end(), later);
+      Input input = std::move(queue.back());
+      queue.pop_back();
+      const auto &blocks = input.blocks;
+      std::size_t last = std::min<std::size_t>(blocks.size(), opts.maxPathLen);
+      if (input.bound + 1 >= last)
+        continue; // no branch left to flip
+
+      auto solverPtr = makeSolver();
+      smt::ISolver &solver = *solverPtr;
+      QueryProbe probe = startQuery(solver);
+      SymbolicStore store;
+      std::vector<smt::Term> asserted;
+      ptrProv_.clear();
+      encodeEntry(fun, solver, store, asserted, fixedSyms);
+      for (auto c: asserted)
+        solver.assert_formula(c);
+
+      uint64_t hash = 0;
+      for (std::size_t i = 0; i + 1 < last && !shouldStop(); ++i) {
+        std::size_t b = blocks[i];
+        const std::string &label = cfg.blocks[b];
+        if (i >= input.bound && out[b].size() > 1) {
+          for (auto [alt, edge]: out[b]) {
+            if (alt == blocks[i + 1] || edgeCov[edge] || !asked.insert(hash * 31 + edge + 1).second)
+              continue;
+            SymbolicStore trial = store;
+            auto provBefore = ptrProv_;
+            std::vector<smt::Term> pc, req;
+            std::size_t base = asserted.size();
+            solver.push(1);
+            encodeBlock(fun.blocks[b], label, &cfg.blocks[alt], solver, trial, pc, req);
+            pc.insert(pc.end(), req.begin(), req.end());
+            for (auto c: pc)
+              solver.assert_formula(c);
+            asserted.insert(asserted.end(), pc.begin(), pc.end());
+            ++res.checks;
+            probe.pathLen = static_cast<uint32_t>(i + 2);
+            smt::Result r =
+                countedCheck(probe, solver, asserted, [&] { return solver.check_sat(); });
+            Result model;
+            if (r == smt::Result::SAT) {
+              ++res.sat;
+              model = extractModel(fun, solver, trial, r);
+            }
+            solver.pop(1);
+            asserted.resize(base);
+            ptrProv_ = std::move(provBefore);
+            if (r != smt::Result::SAT)
+              continue;
+
+            runInput(std::move(model.model), i + 1);
+            bool followed = log.size() > i + 1 && log[i + 1] == alt &&
+                            std::equal(blocks.begin(), blocks.begin() + i + 1, log.begin());
+            res.divergent += !followed;
+            if (shouldStop())
+              break;
+          }
+        }
+
+        // Commit the block towards the edge the input took.
+        std::vector<smt::Term> pc, req;
+        encodeBlock(fun.blocks[b], label, &cfg.blocks[blocks[i + 1]], solver, store, pc, req);
+        pc.insert(pc.end(), req.begin(), req.end());
+        for (auto c: pc)
+          solver.assert_formula(c);
+        asserted.insert(asserted.end(), pc.begin(), pc.end());
+        hash = hash * 31 + edgeOf(b, blocks[i + 1]) + 1;
       }
     }
 
-    if (solver.is_bv_sort(lSort) && solver.is_bv_sort(rSort)) {
-      auto lWidth = solver.get_bv_width(lSort);
-      auto rWidth = solver.get_bv_width(rSort);
-      if (lWidth < rWidth) {
-        lhs = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {lhs}, {rWidth - lWidth});
-      } else if (rWidth < lWidth) {
-        rhs = solver.make_term(smt::Kind::BV_SIGN_EXTEND, {rhs}, {lWidth - rWidth});
+    for (std::size_t b = 0; b < numBlocks; ++b)
+      if (!blockCov[b])
+        res.uncovered.push_back(cfg.blocks[b]);
+    return res;
+  }
+
+  const SymbolicExecutor::NogoodTrie::Node *
+  SymbolicExecutor::NogoodTrie::child(const Node *n, const std::string &label) const {
+    if (!n)
+      return nullptr;
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = n->children.find(label);
+    return it == n->children.end() ? nullptr : it->second.get();
+  }
+
+  void SymbolicExecutor::NogoodTrie::learn(std::span<const std::string> prefix) {
+    std::lock_guard<std::mutex> lock(mu_);
+    Node *n = &root_;
+    for (const auto &label: prefix) {
+      if (n->dead.load())
+        return; // already covered by a shorter nogood
+      auto &slot = n->children[label];
+      if (!slot)
+        slot = std::make_unique<Node>();
+      n = slot.get();
+    }
+    n->dead.store(true);
+  }
+
+  SymbolicExecutor::Result SymbolicExecutor::solveLearning(
+      const FunctionContext &ctx, const std::vector<std::string> &path,
+      const std::unordered_map<std::string, int64_t> &fixedSyms, NogoodTrie &nogoods
+  ) {
+    const FunDecl &fun = *ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    FunScope funScope(ctx);
+
+    auto solverPtr = makeSolver();
+    smt::ISolver &solver = *solverPtr;
+    QueryProbe probe = startQuery(solver);
+    probe.pathLen = static_cast<uint32_t>(path.size());
+    SymbolicStore store;
+    std::vector<smt::Term> constraints;
+    ptrProv_.clear();
+    encodeEntry(fun, solver, store, constraints, fixedSyms);
+    std::size_t numEntry = constraints.size();
+
+    // Assumption i is everything block path[i] adds, including the
+    // condition of its edge to path[i + 1].
+    std::vector<smt::Term> assumptions;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+      auto it = cfg.indexOf.find(path[i]);
+      if (it == cfg.indexOf.end())
+        throw std::runtime_error("Invalid block label in path: " + path[i]);
+      const std::string *nextLabel = (i + 1 < path.size()) ? &path[i + 1] : nullptr;
+      std::vector<smt::Term> pc, req;
+      encodeBlock(fun.blocks[it->second], path[i], nextLabel, solver, store, pc, req);
+      pc.insert(pc.end(), req.begin(), req.end());
+      smt::Term a = pc.empty() ? solver.make_true() : pc[0];
+      for (std::size_t k = 1; k < pc.size(); ++k)
+        a = solver.make_term(smt::Kind::AND, a, pc[k]);
+      assumptions.push_back(a);
+      constraints.push_back(a);
+    }
+
+    Result res;
+    bool checked = false;
+    smt::Result r = checkQuery(probe, solver, constraints, symSlots(fun, store), res, [&] {
+      checked = true;
+      for (std::size_t i = 0; i < numEntry; ++i)
+        solver.assert_formula(constraints[i]);
+      return solver.check_sat_assuming(assumptions);
+    });
+    if (r != smt::Result::UNSAT)
+      return withVerdict(std::move(res), r);
+
+    // Block i's constraints only depend on path[0..i + 1], so every path
+    // sharing the prefix up to the deepest core block is UNSAT too. An
+    // answer from the query cache has no core: learn the whole path.
+    std::size_t prefixLen = path.size();
+    if (checked) {
+      prefixLen = 0;
+      for (const auto &c: solver.get_unsat_assumptions()) {
+        auto pos = std::find(assumptions.begin(), assumptions.end(), c);
+        if (pos == assumptions.end()) {
+          prefixLen = path.size();
+          break;
+        }
+        prefixLen = std::max(prefixLen, std::size_t(pos - assumptions.begin()) + 2);
       }
+      prefixLen = std::min(prefixLen, path.size());
     }
+    nogoods.learn(std::span<const std::string>(path.data(), prefixLen));
+    return withVerdict(std::move(res), r);
+  }
 
-    switch (c.op) {
-      case RelOp::EQ:
-        return solver.make_term(smt::Kind::EQUAL, {lhs, rhs});
-      case RelOp::NE:
-        return solver.make_term(smt::Kind::DISTINCT, {lhs, rhs});
-      case RelOp::LT:
-        return solver.make_term(smt::Kind::BV_SLT, {lhs, rhs});
-      case RelOp::LE:
-        return solver.make_term(smt::Kind::BV_SLE, {lhs, rhs});
-      case RelOp::GT:
-        return solver.make_term(smt::Kind::BV_SGT, {lhs, rhs});
-      case RelOp::GE:
-        return solver.make_term(smt::Kind::BV_SGE, {lhs, rhs});
+  solver::WorkPool &SymbolicExecutor::pool() {
+    std::lock_guard<std::mutex> lock(poolMu_);
+    solver::WorkPool *p = config_.pool;
+    if (!p) {
+      if (!ownPool_)
+        ownPool_ = std::make_unique<solver::WorkPool>(config_.num_threads);
+      p = ownPool_.get();
     }
-    return {};
+    while (workerStates_.size() < p->size())
+      workerStates_.push_back(std::make_unique<WorkerState>());
+    return *p;
   }
 
   SymbolicExecutor::Result SymbolicExecutor::sample(
@@ -2531,22 +5257,13 @@ namespace symir {
       const std::vector<std::string> &prefixPath,
       const std::unordered_map<std::string, int64_t> &fixedSyms
   ) {
-    const FunDecl *entry = nullptr;
-    for (const auto &f: prog_.funs) {
-      if (f.name.name == funcName) {
-        entry = &f;
-        break;
-      }
-    }
-    if (!entry)
-      throw std::runtime_error("Function not found: " + funcName);
-
-    DiagBag diags;
-    CFG cfg = CFG::build(*entry, diags);
-    if (diags.hasErrors())
-      throw std::runtime_error("CFG build failed");
-
-    auto nextToRet = cfg.shortestPathToRet(*entry);
+    StatsScope statsScope(*this, "sample", funcName);
+    timing::Scope timer("sample");
+    const FunctionContext &ctx = contextOf(funcName);
+    const FunDecl *entry = ctx.fun;
+    const CFG &cfg = *ctx.cfg;
+    const auto &nextToRet = *ctx.nextToRet;
+    const BitVector &canReachRet = *ctx.canReachRet;
 
     // Determine number of threads
     uint32_t num_threads = config_.num_threads;
@@ -2558,7 +5275,95 @@ namespace symir {
 
     // Lambda to generate a random path and attempt to solve it
     // Returns optional Result: nullopt if path should be skipped, otherwise the solve result
-    auto tryOneSample = [&](std::mt19937 &rng) -> std::optional<Result> {
+    // Workers keep their own session (solver plus prefix cache) whenever
+    // incremental solving or the prefix cache is enabled.
+    // Online walks build their own solver and ignore sessions.
+    // Nogood learning checks every path on a fresh solver as well.
+    std::optional<NogoodTrie> nogoods;
+    // Merged paths are encoded by encodePath() on a fresh solver only.
+    if (config_.learn_nogoods && !config_.online_sampling && !config_.merge_joins)
+      nogoods.emplace();
+    bool escalate = config_.time_budget_ms > 0;
+    bool useSession = !config_.online_sampling && !nogoods && !escalate &&
+                      !config_.merge_joins &&
+                      (config_.incremental || config_.prefix_cache_mb > 0);
+    std::size_t cacheBytesPerWorker =
+        std::size_t(config_.prefix_cache_mb) * 1024 * 1024 / std::max<uint32_t>(num_threads, 1);
+    auto makeSession = [&]() {
+      SampleSession session;
+      if (config_.prefix_cache_mb > 0)
+        session.cache.emplace(cacheBytesPerWorker);
+      return session;
+    };
+
+    auto errorResult = [](const std::exception &e) {
+      Result errRes;
+      errRes.unknown = true;
+      errRes.message = e.what();
+      return errRes;
+    };
+
+    auto unsatResult = []() {
+      Result res;
+      res.unsat = true;
+      return res;
+    };
+
+    // Edges the interval analysis proves no execution takes; walks never
+    // step onto them.
+    std::optional<IntervalAnalysis> edges;
+    if (config_.intervals && !config_.online_sampling)
+      edges.emplace(*entry, cfg, fixedSyms);
+
+    // Config::merge_joins: keys of the refuted paths; other paths through
+    // the same merged regions make the same query.
+    std::mutex refutedMu;
+    std::unordered_set<std::string> refuted;
+
+    // Solves one walked path, trying the cheap answers first.
+    auto solvePath = [&](const std::vector<std::string> &path, SampleSession *ses) -> Result {
+      try {
+        std::string key;
+        if (config_.merge_joins) {
+          key = mergeKey(ctx, path);
+          std::lock_guard<std::mutex> lock(refutedMu);
+          if (refuted.count(key))
+            return unsatResult();
+        }
+        auto ranges = pathIntervals(ctx, path, fixedSyms);
+        if (ranges.infeasible)
+          return unsatResult();
+        if (auto hit = replayModels(ctx, path, fixedSyms))
+          return *hit;
+        Result res = ses       ? solveInSession(*ses, ctx, path, fixedSyms)
+                     : nogoods ? solveLearning(ctx, path, fixedSyms, *nogoods)
+                               : solveFresh(ctx, path, fixedSyms, &ranges.syms);
+        rememberModel(ctx, res);
+        if (!key.empty() && res.unsat) {
+          std::lock_guard<std::mutex> lock(refutedMu);
+          refuted.insert(key);
+        }
+        return res;
+      } catch (const std::exception &e) {
+        return errorResult(e);
+      }
+    };
+
+    // `walked`, if given, receives the path that was solved (left empty
+    // for online walks).
+    auto tryOneSample = [&](std::mt19937 &rng, SampleSession *ses,
+                            std::vector<std::string> *walked = nullptr) -> std::optional<Result> {
+      if (config_.online_sampling) {
+        try {
+          auto res = walkOnline(ctx, rng, prefixPath, maxPathLen, requireTerminal, fixedSyms);
+          if (res)
+            rememberModel(ctx, *res);
+          return res;
+        } catch (const std::exception &e) {
+          return errorResult(e);
+        }
+      }
+
       std::vector<std::string> path = prefixPath;
       if (path.empty()) {
         path.push_back(cfg.blocks[cfg.entry]);
@@ -2568,14 +5373,55 @@ namespace symir {
       bool terminated = std::holds_alternative<RetTerm>(entry->blocks[currentIdx].term) ||
                         std::holds_alternative<UnreachableTerm>(entry->blocks[currentIdx].term);
 
-      // Random walk
+      // Trie node of the walk so far (null once off every learned prefix)
+      const NogoodTrie::Node *at = nullptr;
+      if (nogoods) {
+        at = nogoods->root();
+        for (const auto &label: path)
+          at = nogoods->child(at, label);
+        if (NogoodTrie::dead(nogoods->root()) || NogoodTrie::dead(at))
+          return unsatResult();
+      }
+
+      // Random walk. With requireTerminal, a walk that can no longer reach
+      // a ret would only be discarded at the end: it is dropped at once, and
+      // successors from which no ret is reachable are not taken.
+      std::vector<std::size_t> live;
+      auto deadEnd = [&](std::size_t b) {
+        return requireTerminal && !canReachRet.test(b);
+      };
       while (!terminated && path.size() < maxPathLen) {
+        if (deadEnd(currentIdx))
+          return std::nullopt;
         const auto &successors = cfg.succ[currentIdx];
         if (successors.empty())
           break;
 
-        std::uniform_int_distribution<std::size_t> dist(0, successors.size() - 1);
-        std::size_t nextIdx = successors[dist(rng)];
+        std::size_t nextIdx;
+        if (nogoods || edges || std::any_of(successors.begin(), successors.end(), deadEnd)) {
+          // Only step onto edges that may be taken and do not complete a
+          // known nogood; if none is left, the walk so far is infeasible.
+          live.clear();
+          for (std::size_t s: successors)
+            if ((!edges || edges->feasible(currentIdx, s)) &&
+                (!nogoods || !NogoodTrie::dead(nogoods->child(at, cfg.blocks[s]))))
+              live.push_back(s);
+          if (live.empty()) {
+            if (nogoods)
+              nogoods->learn(path);
+            return unsatResult();
+          }
+          std::erase_if(live, deadEnd);
+          if (live.empty())
+            return std::nullopt;
+          std::uniform_int_distribution<std::size_t> dist(0, live.size() - 1);
+          nextIdx = live[dist(rng)];
+          if (nogoods)
+            at = nogoods->child(at, cfg.blocks[nextIdx]);
+        } else {
+          std::uniform_int_distribution<std::size_t> dist(0, successors.size() - 1);
+          nextIdx = successors[dist(rng)];
+        }
         path.push_back(cfg.blocks[nextIdx]);
         currentIdx = nextIdx;
         terminated = std::holds_alternative<RetTerm>(entry->blocks[currentIdx].term) ||
@@ -2594,6 +5440,11 @@ namespace symir {
             }
             currentIdx = it->second;
             path.push_back(cfg.blocks[currentIdx]);
+            if (nogoods) {
+              at = nogoods->child(at, path.back());
+              if (NogoodTrie::dead(at))
+                return unsatResult();
+            }
           }
         } else {
           // Discard if not terminated
@@ -2602,24 +5453,29 @@ namespace symir {
       }
 
       // Try to solve this path
-      try {
-        return solve(funcName, path, fixedSyms);
-      } catch (const std::exception &e) {
-        Result errRes;
-        errRes.unknown = true;
-        errRes.message = e.what();
-        return errRes;
-      }
+      if (walked)
+        *walked = path;
+      return solvePath(path, ses);
     };
 
+    if (escalate)
+      return sampleEscalating(
+          n, num_threads,
+          [&](std::mt19937 &rng, std::vector<std::string> *walked) {
+            return tryOneSample(rng, nullptr, walked);
+          },
+          [&](const std::vector<std::string> &path) { return solvePath(path, nullptr); }
+      );
+
     // Single-threaded execution
     if (num_threads == 1) {
       std::mt19937 rng(config_.seed);
+      SampleSession session = makeSession();
       Result lastRes;
       lastRes.unknown = true;
 
-      for (uint32_t i = 0; i < n; ++i) {
-        auto res = tryOneSample(rng);
+      for (uint32_t i = 0; i < n && !cancelled(); ++i) {
+        auto res = tryOneSample(rng, useSession ? &session : nullptr);
         if (!res)
           continue; // Path was skipped
 
@@ -2631,33 +5487,51 @@ namespace symir {
       return lastRes;
     }
 
-    // Multi-threaded execution
-    std::atomic<bool> found(false);
+    // Multi-threaded execution. The first SAT cancels the checks still
+    // running on the other workers, rather than letting them run out.
+    solver::Cancellation found(cancel_);
+    struct Restore {
+      solver::Cancellation *&slot, *prev;
+      ~Restore() { slot = prev; }
+    } restore{cancel_, std::exchange(cancel_, &found)};
     std::atomic<uint32_t> samplesProcessed(0);
     std::mutex resultMutex;
     Result satResult;
+    bool haveSat = false;
     Result lastRes;
     lastRes.unknown = true;
 
-    auto workerFunc = [&](uint32_t threadId) {
-      std::mt19937 rng(config_.seed + threadId);
+    solver::WorkPool &workers = pool();
+    auto workerFunc = [&](unsigned worker, std::size_t taskId) {
+      WorkerState &ws = *workerStates_[worker];
+      ws.rng.seed(config_.seed + static_cast<uint32_t>(taskId));
+      SampleSession *session = nullptr;
+      if (useSession) {
+        if (!ws.session || ws.sessionFun != entry || ws.sessionFixed != fixedSyms) {
+          ws.session = makeSession();
+          ws.sessionFun = entry;
+          ws.sessionFixed = fixedSyms;
+        }
+        session = &*ws.session;
+      }
       Result threadLastRes;
       threadLastRes.unknown = true;
 
-      while (samplesProcessed.fetch_add(1) < n && !found.load()) {
-        if (found.load())
-          break;
-
-        auto res = tryOneSample(rng);
+      while (samplesProcessed.fetch_add(1) < n && !found.cancelled()) {
+        auto res = tryOneSample(ws.rng, session);
         if (!res)
           continue; // Path was skipped
 
         if (res->sat) {
-          std::lock_guard<std::mutex> lock(resultMutex);
-          if (!found.load()) {
+          {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (haveSat)
+              return;
             satResult = std::move(*res);
-            found.store(true);
+            haveSat = true;
           }
+          found.cancel();
+          found.drain();
           return;
         }
         threadLastRes = std::move(*res);
@@ -2671,43 +5545,140 @@ namespace symir {
       }
     };
 
-    // Launch worker threads
-    std::vector<std::thread> threads;
-    for (uint32_t i = 0; i < num_threads; ++i) {
-      threads.emplace_back(workerFunc, i);
-    }
-
-    // Wait for all threads to complete
-    for (auto &t: threads) {
-      t.join();
-    }
+    // One task per thread; the pool's workers outlive this call
+    workers.forEach(std::min<std::size_t>(num_threads, workers.size()), workerFunc);
 
-    if (found.load()) {
+    if (haveSat) {
       return satResult;
     }
 
     return lastRes;
   }
 
+  SymbolicExecutor::Result SymbolicExecutor::sampleEscalating(
+      uint32_t n, uint32_t numThreads, const SampleDraw &draw, const SampleRetry &retry
+  ) {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(config_.time_budget_ms);
+    const uint32_t initial = std::max<uint32_t>(config_.initial_timeout_ms, 1);
+    const uint32_t growth = std::max<uint32_t>(config_.timeout_growth, 2);
+
+    // Fresh walks come first; then timed-out paths by increasing timeout,
+    // in the order they timed out.
+    std::mutex mu;
+    std::condition_variable cv;
+    uint32_t drawn = 0, inFlight = 0;
+    std::multimap<uint32_t, std::vector<std::string>> retries;
+    std::optional<Result> satResult, unsatResult, unknownResult;
+
+    auto work = [&](std::mt19937 &rng) {
+      for (;;) {
+        uint32_t timeout = initial;
+        std::vector<std::string> path;
+        {
+          std::unique_lock<std::mutex> lock(mu);
+          for (;;) {
+            if (satResult || cancelled() || Clock::now() >= deadline)
+              return;
+            if (drawn < n) {
+              ++drawn;
+              break;
+            }
+            if (!retries.empty()) {
+              timeout = retries.begin()->first;
+              path = std::move(retries.begin()->second);
+              retries.erase(retries.begin());
+              break;
+            }
+            if (inFlight == 0)
+              return;
+            cv.wait_until(lock, deadline);
+          }
+          ++inFlight;
+        }
+
+        // The check may use its timeout, the time left and no more than
+        // Config::timeout_ms.
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        uint32_t limit = static_cast<uint32_t>(std::max<int64_t>(left.count(), 1));
+        if (config_.timeout_ms)
+          limit = std::min(limit, config_.timeout_ms);
+        uint32_t prevTimeout = attemptTimeoutMs_;
+        attemptTimeoutMs_ = std::min(timeout, limit);
+        // Errors are caught by draw() and retry() and come back as results.
+        std::optional<Result> res = path.empty() ? draw(rng, &path) : retry(path);
+        attemptTimeoutMs_ = prevTimeout;
+
+        std::unique_lock<std::mutex> lock(mu);
+        --inFlight;
+        cv.notify_all();
+        if (!res)
+          continue; // walk discarded
+        if (res->sat) {
+          if (satResult)
+            return;
+          satResult = std::move(*res);
+          lock.unlock();
+          // The other workers' checks are moot now (cancel_ is the
+          // cancellation of this call when there are several).
+          if (numThreads > 1) {
+            cancel_->cancel();
+            cancel_->drain();
+          }
+          return;
+        } else if (res->unsat) {
+          if (!unsatResult)
+            unsatResult = std::move(*res);
+        } else if (res->message.empty() && !path.empty() && timeout < limit) {
+          // Timed out below the cap: worth another, longer try.
+          uint64_t next = std::min<uint64_t>(uint64_t(timeout) * growth, UINT32_MAX);
+          retries.emplace(static_cast<uint32_t>(next), std::move(path));
+        } else {
+          unknownResult = std::move(*res);
+        }
+      }
+    };
+
+    if (numThreads == 1) {
+      std::mt19937 rng(config_.seed);
+      work(rng);
+    } else {
+      solver::Cancellation found(cancel_);
+      struct Restore {
+        solver::Cancellation *&slot, *prev;
+        ~Restore() { slot = prev; }
+      } restore{cancel_, std::exchange(cancel_, &found)};
+      solver::WorkPool &workers = pool();
+      auto worker = [&](unsigned w, std::size_t taskId) {
+        WorkerState &ws = *workerStates_[w];
+        ws.rng.seed(config_.seed + static_cast<uint32_t>(taskId));
+        work(ws.rng);
+      };
+      workers.forEach(std::min<std::size_t>(numThreads, workers.size()), worker);
+    }
+
+    // Paths still waiting for a retry when time ran out are UNKNOWN.
+    if (satResult)
+      return *satResult;
+    if (unknownResult)
+      return *unknownResult;
+    Result res;
+    if (unsatResult && retries.empty())
+      return *unsatResult;
+    res.unknown = true;
+    return res;
+  }
+
   TypePtr SymbolicExecutor::resolveLValueType(const LValue &lv) const {
     if (!currentFun_)
       throw std::runtime_error("resolveLValueType: no active FunDecl");
-    const std::string baseName = lv.base.name;
+    if (prog_.types)
+      if (auto t = prog_.types->of(lv))
+        return t;
+    const std::string &baseName = lv.base.name;
     TypePtr cur;
-    for (const auto &l: currentFun_->lets) {
-      if (l.name.name == baseName) {
-        cur = l.type;
-        break;
-      }
-    }
-    if (!cur) {
-      for (const auto &p: currentFun_->params) {
-        if (p.name.name == baseName) {
-          cur = p.type;
-          break;
-        }
-      }
-    }
+    if (auto *local = currentLocal(baseName))
+      cur = local->type;
     if (!cur)
       throw std::runtime_error("resolveLValueType: base local not found: " + baseName);
 
@@ -2723,19 +5694,13 @@ namespace symir {
         }
       } else if (auto af = std::get_if<AccessField>(&acc)) {
         if (auto st = std::get_if<StructType>(&cur->v)) {
-          auto sIt = structs_.find(st->name.name);
-          if (sIt == structs_.end())
+          auto lIt = layouts_.find(st->name.name);
+          if (lIt == layouts_.end())
             throw std::runtime_error("resolveLValueType: unknown struct type: " + st->name.name);
-          bool found = false;
-          for (const auto &f: sIt->second->fields) {
-            if (f.name == af->field) {
-              cur = f.type;
-              found = true;
-              break;
-            }
-          }
-          if (!found)
+          auto fIt = lIt->second.fields.find(af->field);
+          if (fIt == lIt->second.fields.end())
             throw std::runtime_error("resolveLValueType: field not found in struct: " + af->field);
+          cur = fIt->second.type;
         } else {
           throw std::runtime_error("resolveLValueType: field access on non-struct type");
         }
@@ -2763,6 +5728,12 @@ namespace symir {
   }
 
   TypePtr SymbolicExecutor::resolveAtomType(const Atom &a) const {
+    // Pointer-forming atoms would otherwise build a fresh ptr type.
+    if (prog_.types && (std::holds_alternative<AddrAtom>(a.v) ||
+                        std::holds_alternative<PtrIndexAtom>(a.v) ||
+                        std::holds_alternative<PtrFieldAtom>(a.v)))
+      if (auto t = prog_.types->of(a))
+        return t;
     return std::visit(
         [&](auto &&arg) -> TypePtr {
           using T = std::decay_t<decltype(arg)>;
@@ -0,0 +1,133 @@
+#include "solver/solver_stats.hpp"
+#include <algorithm>
+#include "json.hpp"
+
+namespace symir::solver {
+
+  namespace {
+
+    const char *resultName(smt::Result r) {
+      switch (r) {
+        case smt::Result::SAT:
+          return "sat";
+        case smt::Result::UNSAT:
+          return "unsat";
+        default:
+          return "unknown";
+      }
+    }
+
+    void writeTotals(std::ostream &os, const SolverStats::Totals &t) {
+      os << "\"queries\":" << t.queries << ",\"sat\":" << t.sat << ",\"unsat\":" << t.unsat
+         << ",\"unknown\":" << t.unknown << ",\"cached\":" << t.cached << ",\"terms\":" << t.terms
+         << ",\"assertions\":" << t.assertions << ",\"dag_size\":" << t.dagSize
+         << ",\"max_dag_size\":" << t.maxDagSize << ",\"max_path_len\":" << t.maxPathLen
+         << ",\"encode_ms\":" << t.encodeMs << ",\"solve_ms\":" << t.solveMs
+         << ",\"replayed\":" << t.replayed << ",\"replay_tries\":" << t.replayTries
+         << ",\"replay_ms\":" << t.replayMs << ",\"refuted\":" << t.refuted
+         << ",\"guards_dropped\":" << t.guardsDropped;
+    }
+
+  } // namespace
+
+  void SolverStats::Totals::add(const Query &q) {
+    ++queries;
+    sat += q.result == smt::Result::SAT;
+    unsat += q.result == smt::Result::UNSAT;
+    unknown += q.result == smt::Result::UNKNOWN;
+    cached += q.cached;
+    terms += q.terms;
+    assertions += q.assertions;
+    dagSize += q.dagSize;
+    maxDagSize = std::max(maxDagSize, q.dagSize);
+    maxPathLen = std::max(maxPathLen, q.pathLen);
+    encodeMs += q.encodeMs;
+    solveMs += q.solveMs;
+    replayed += q.replayed;
+    refuted += q.refuted;
+    guardsDropped += q.guardsDropped;
+  }
+
+  uint64_t SolverStats::beginCall(std::string kind, std::string function, std::string label) {
+    std::lock_guard<std::mutex> lock(mu_);
+    calls_.push_back({std::move(kind), std::move(function), std::move(label), 0, {}});
+    return calls_.size();
+  }
+
+  void SolverStats::endCall(uint64_t id, double wallMs) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (id >= 1 && id <= calls_.size())
+      calls_[id - 1].wallMs = wallMs;
+  }
+
+  void SolverStats::record(const Query &q) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto [it, fresh] = threadIndex_.emplace(std::this_thread::get_id(), threads_.size());
+    if (fresh)
+      threads_.emplace_back();
+    threads_[it->second].add(q);
+    if (q.call >= 1 && q.call <= calls_.size())
+      calls_[q.call - 1].totals.add(q);
+    total_.add(q);
+    if (queries_.size() < maxQueries_)
+      queries_.emplace_back(it->second, q);
+    else
+      ++dropped_;
+  }
+
+  void SolverStats::recordReplay(uint64_t call, uint32_t tries, double ms) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto [it, fresh] = threadIndex_.emplace(std::this_thread::get_id(), threads_.size());
+    if (fresh)
+      threads_.emplace_back();
+    for (Totals *t: {&threads_[it->second], &total_}) {
+      t->replayTries += tries;
+      t->replayMs += ms;
+    }
+    if (call >= 1 && call <= calls_.size()) {
+      calls_[call - 1].totals.replayTries += tries;
+      calls_[call - 1].totals.replayMs += ms;
+    }
+  }
+
+  SolverStats::Totals SolverStats::total() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return total_;
+  }
+
+  void SolverStats::writeJson(std::ostream &os) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    os << "{\n  \"total\": {";
+    writeTotals(os, total_);
+    os << "},\n  \"calls\": [";
+    for (std::size_t i = 0; i < calls_.size(); ++i) {
+      const Call &c = calls_[i];
+      os << (i ? ",\n" : "\n") << "    {\"id\":" << i + 1 << ",\"kind\":" << json::quote(c.kind)
+         << ",\"function\":" << json::quote(c.function) << ",\"label\":" << json::quote(c.label)
+         << ",\"wall_ms\":" << c.wallMs << ",";
+      writeTotals(os, c.totals);
+      os << "}";
+    }
+    os << (calls_.empty() ? "" : "\n  ") << "],\n  \"threads\": [";
+    for (std::size_t i = 0; i < threads_.size(); ++i) {
+      os << (i ? ",\n" : "\n") << "    {\"thread\":" << i << ",";
+      writeTotals(os, threads_[i]);
+      os << "}";
+    }
+    os << (threads_.empty() ? "" : "\n  ") << "],\n  \"queries\": [";
+    for (std::size_t i = 0; i < queries_.size(); ++i) {
+      const auto &[thread, q] = queries_[i];
+      os << (i ? ",\n" : "\n") << "    {\"call\":" << q.call << ",\"thread\":" << thread
+         << ",\"path_len\":" << q.pathLen << ",\"terms\":" << q.terms
+         << ",\"assertions\":" << q.assertions << ",\"dag_size\":" << q.dagSize
+         << ",\"encode_ms\":" << q.encodeMs << ",\"solve_ms\":" << q.solveMs
+         << ",\"result\":\"" << resultName(q.result) << "\",\"cached\":"
+         << (q.cached ? "true" : "false") << ",\"replayed\":" << (q.replayed ? "true" : "false")
+         << ",\"refuted\":" << (q.refuted ? "true" : "false")
+         << ",\"guards_dropped\":" << q.guardsDropped << "}";
+    }
+    os << (queries_.empty() ? "" : "\n  ") << "],\n  \"dropped_queries\": " << dropped_
+       << "\n}\n";
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,934 @@
+#include "solver/term_builder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace symir::solver {
+
+  static uint64_t maskOf(uint32_t width) {
+    return width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+  }
+
+  static int64_t toSigned(uint64_t v, uint32_t width) {
+    if (width < 64 && (v >> (width - 1)) & 1)
+      v |= ~maskOf(width);
+    return static_cast<int64_t>(v);
+  }
+
+  // Parses a literal in the format accepted by ISolver::make_bv_value into
+  // a value modulo 2^width. Fails on anything it does not understand so the
+  // request is simply passed through to the backend.
+  static bool parseBVLiteral(const std::string &val, uint8_t base, uint32_t width, uint64_t &out) {
+    if (val.empty() || (base != 2 && base != 10 && base != 16))
+      return false;
+    std::size_t i = 0;
+    bool neg = false;
+    if (base == 10 && val[0] == '-') {
+      neg = true;
+      i = 1;
+    }
+    if (i == val.size())
+      return false;
+    uint64_t v = 0;
+    for (; i < val.size(); ++i) {
+      char c = val[i];
+      unsigned d;
+      if (c >= '0' && c <= '9')
+        d = unsigned(c - '0');
+      else if (c >= 'a' && c <= 'f')
+        d = unsigned(c - 'a' + 10);
+      else if (c >= 'A' && c <= 'F')
+        d = unsigned(c - 'A' + 10);
+      else
+        return false;
+      if (d >= base)
+        return false;
+      v = v * base + d; // wraps modulo 2^64, which is fine for width <= 64
+    }
+    out = (neg ? ~v + 1 : v) & maskOf(width);
+    return true;
+  }
+
+  static std::size_t
+  hashNode(smt::Kind kind, std::span<const smt::Term> args, std::span<const uint32_t> indices) {
+    std::size_t h = std::hash<int>()(static_cast<int>(kind));
+    auto mix = [&h](std::size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+    for (const auto &a: args)
+      mix(std::hash<uint32_t>()(a.id));
+    for (auto i: indices)
+      mix(std::hash<uint32_t>()(i));
+    return h;
+  }
+
+  std::size_t TermBuilder::NodeKeyHash::operator()(const NodeKey &k) const {
+    return hashNode(k.kind, k.args, k.indices);
+  }
+
+  std::size_t TermBuilder::NodeKeyHash::operator()(const NodeRef &k) const {
+    return hashNode(k.kind, k.args, k.indices);
+  }
+
+  bool TermBuilder::NodeKeyEq::operator()(const NodeKey &a, const NodeKey &b) const {
+    return a.kind == b.kind && a.args == b.args && a.indices == b.indices;
+  }
+
+  bool TermBuilder::NodeKeyEq::operator()(const NodeRef &a, const NodeKey &b) const {
+    return a.kind == b.kind && std::ranges::equal(a.args, b.args) &&
+           std::ranges::equal(a.indices, b.indices);
+  }
+
+  TermBuilder::TermBuilder(std::unique_ptr<smt::ISolver> inner, Counters *sink) :
+      inner_(std::move(inner)), sink_(sink) {
+    if (!inner_)
+      throw std::runtime_error("TermBuilder: no backend solver");
+  }
+
+  TermBuilder::~TermBuilder() {
+    if (sink_) {
+      sink_->hits += stats_.hits;
+      sink_->folds += stats_.folds;
+      sink_->built += stats_.built;
+    }
+  }
+
+  // --- Sorts ---
+
+  smt::Sort TermBuilder::make_bv_sort(uint32_t size) {
+    auto it = bvSorts_.find(size);
+    if (it != bvSorts_.end())
+      return it->second;
+    smt::Sort s = inner_->make_bv_sort(size);
+    SortInfo info;
+    info.kind = SortKind::BV;
+    info.width = size;
+    sortInfo_[s.id] = info;
+    return bvSorts_[size] = s;
+  }
+
+  smt::Sort TermBuilder::make_fp_sort(uint32_t exp, uint32_t sig) {
+    uint64_t key = (uint64_t(exp) << 32) | sig;
+    auto it = fpSorts_.find(key);
+    if (it != fpSorts_.end())
+      return it->second;
+    smt::Sort s = inner_->make_fp_sort(exp, sig);
+    SortInfo info;
+    info.kind = SortKind::FP;
+    info.exp = exp;
+    info.sig = sig;
+    sortInfo_[s.id] = info;
+    return fpSorts_[key] = s;
+  }
+
+  smt::Sort TermBuilder::make_bool_sort() {
+    if (!boolSort_) {
+      boolSort_ = inner_->make_bool_sort();
+      SortInfo info;
+      info.kind = SortKind::Bool;
+      sortInfo_[boolSort_.id] = info;
+    }
+    return boolSort_;
+  }
+
+  smt::Sort TermBuilder::make_array_sort(smt::Sort index, smt::Sort elem) {
+    index = canonical(index);
+    elem = canonical(elem);
+    auto key = std::make_pair(index.id, elem.id);
+    auto it = arraySorts_.find(key);
+    if (it != arraySorts_.end())
+      return it->second;
+    smt::Sort s = inner_->make_array_sort(index, elem);
+    SortInfo info;
+    info.kind = SortKind::Array;
+    info.index = index.id;
+    info.elem = elem.id;
+    sortInfo_[s.id] = info;
+    return arraySorts_[key] = s;
+  }
+
+  const TermBuilder::SortInfo *TermBuilder::infoOf(const smt::Sort &s) const {
+    auto it = sortInfo_.find(s.id);
+    return it == sortInfo_.end() ? nullptr : &it->second;
+  }
+
+  smt::Sort TermBuilder::canonical(smt::Sort s) {
+    if (infoOf(s))
+      return s;
+    if (inner_->is_bool_sort(s))
+      return make_bool_sort();
+    if (inner_->is_bv_sort(s))
+      return make_bv_sort(inner_->get_bv_width(s));
+    if (inner_->is_fp_sort(s)) {
+      auto [e, sig] = inner_->get_fp_dims(s);
+      if (e != 0)
+        return make_fp_sort(e, sig);
+    }
+    sortInfo_[s.id] = SortInfo{};
+    return s;
+  }
+
+  bool TermBuilder::is_bv_sort(smt::Sort s) {
+    auto *info = infoOf(s);
+    return info && info->kind != SortKind::Other ? info->kind == SortKind::BV
+                                                 : inner_->is_bv_sort(s);
+  }
+
+  bool TermBuilder::is_fp_sort(smt::Sort s) {
+    auto *info = infoOf(s);
+    return info && info->kind != SortKind::Other ? info->kind == SortKind::FP
+                                                 : inner_->is_fp_sort(s);
+  }
+
+  bool TermBuilder::is_bool_sort(smt::Sort s) {
+    auto *info = infoOf(s);
+    return info && info->kind != SortKind::Other ? info->kind == SortKind::Bool
+                                                 : inner_->is_bool_sort(s);
+  }
+
+  bool TermBuilder::is_array_sort(smt::Sort s) {
+    auto *info = infoOf(s);
+    return info && info->kind != SortKind::Other ? info->kind == SortKind::Array
+                                                 : inner_->is_array_sort(s);
+  }
+
+  uint32_t TermBuilder::get_bv_width(smt::Sort s) {
+    auto *info = infoOf(s);
+    return info && info->kind == SortKind::BV ? info->width : inner_->get_bv_width(s);
+  }
+
+  std::pair<uint32_t, uint32_t> TermBuilder::get_fp_dims(smt::Sort s) {
+    auto *info = infoOf(s);
+    if (info && info->kind == SortKind::FP)
+      return {info->exp, info->sig};
+    return inner_->get_fp_dims(s);
+  }
+
+  // --- Values ---
+
+  const TermBuilder::Literal *TermBuilder::literalOf(const smt::Term &t) const {
+    auto it = literals_.find(t.id);
+    return it == literals_.end() ? nullptr : &it->second;
+  }
+
+  smt::Term TermBuilder::remember(const std::string &key, smt::Term t) {
+    auto it = values_.emplace(key, t).first;
+    valueKey_.emplace(t.id, &it->first);
+    return t;
+  }
+
+  smt::Term TermBuilder::boolLit(bool b) {
+    smt::Term &slot = b ? true_ : false_;
+    if (!slot) {
+      slot = b ? inner_->make_true() : inner_->make_false();
+      ++stats_.built;
+      literals_[slot.id] = Literal{0, b ? 1u : 0u};
+      termSorts_[slot.id] = make_bool_sort();
+    }
+    return slot;
+  }
+
+  smt::Term TermBuilder::bvLit(uint32_t width, uint64_t value) {
+    value &= maskOf(width);
+    std::string key = "bv" + std::to_string(width) + ":" + std::to_string(value);
+    auto it = values_.find(key);
+    if (it != values_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    smt::Sort s = make_bv_sort(width);
+    smt::Term t = inner_->make_bv_value_uint64(s, value);
+    ++stats_.built;
+    literals_[t.id] = Literal{width, value};
+    termSorts_[t.id] = s;
+    return remember(key, t);
+  }
+
+  smt::Term TermBuilder::make_true() { return boolLit(true); }
+
+  smt::Term TermBuilder::make_false() { return boolLit(false); }
+
+  smt::Term TermBuilder::make_bv_value(smt::Sort s, const std::string &val, uint8_t base) {
+    s = canonical(s);
+    uint32_t width = get_bv_width(s);
+    uint64_t v;
+    if (width <= 64 && parseBVLiteral(val, base, width, v))
+      return bvLit(width, v);
+
+    // Wide (or unparsable) literal: only hash-consed, never folded.
+    std::string key = "bv" + std::to_string(width) + ":" + std::to_string(base) + ":" + val;
+    auto it = values_.find(key);
+    if (it != values_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.built;
+    return remember(key, inner_->make_bv_value(s, val, base));
+  }
+
+  smt::Term TermBuilder::make_bv_value_uint64(smt::Sort s, uint64_t val) {
+    uint32_t width = get_bv_width(canonical(s));
+    if (width > 64)
+      return make_bv_value(s, std::to_string(val), 10);
+    return bvLit(width, val);
+  }
+
+  smt::Term TermBuilder::make_bv_value_int64(smt::Sort s, int64_t val) {
+    uint32_t width = get_bv_width(canonical(s));
+    if (width > 64)
+      return make_bv_value(s, std::to_string(val), 10);
+    return bvLit(width, static_cast<uint64_t>(val));
+  }
+
+  smt::Term TermBuilder::make_bv_zero(smt::Sort s) { return make_bv_value_uint64(s, 0); }
+
+  smt::Term TermBuilder::make_bv_one(smt::Sort s) { return make_bv_value_uint64(s, 1); }
+
+  smt::Term TermBuilder::make_bv_min_signed(smt::Sort s) {
+    uint32_t width = get_bv_width(canonical(s));
+    if (width > 64 || width == 0) {
+      ++stats_.built;
+      return inner_->make_bv_min_signed(s);
+    }
+    return bvLit(width, uint64_t(1) << (width - 1));
+  }
+
+  smt::Term TermBuilder::make_bv_max_signed(smt::Sort s) {
+    uint32_t width = get_bv_width(canonical(s));
+    if (width > 64 || width == 0) {
+      ++stats_.built;
+      return inner_->make_bv_max_signed(s);
+    }
+    return bvLit(width, maskOf(width) >> 1);
+  }
+
+  smt::Term TermBuilder::make_fp_value(smt::Sort s, const std::string &val, smt::RoundingMode rm) {
+    s = canonical(s);
+    auto [e, sig] = get_fp_dims(s);
+    std::string key = "fp" + std::to_string(e) + "," + std::to_string(sig) + ":" +
+                      std::to_string(static_cast<int>(rm)) + ":" + val;
+    auto it = values_.find(key);
+    if (it != values_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.built;
+    return remember(key, inner_->make_fp_value(s, val, rm));
+  }
+
+  smt::Term TermBuilder::make_fp_value_from_real(smt::Sort s, double val, smt::RoundingMode rm) {
+    s = canonical(s);
+    auto [e, sig] = get_fp_dims(s);
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    std::string key = "fpr" + std::to_string(e) + "," + std::to_string(sig) + ":" +
+                      std::to_string(static_cast<int>(rm)) + ":" + std::to_string(bits);
+    auto it = values_.find(key);
+    if (it != values_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.built;
+    return remember(key, inner_->make_fp_value_from_real(s, val, rm));
+  }
+
+  smt::Term TermBuilder::make_rm_value(smt::RoundingMode rm) {
+    std::string key = "rm" + std::to_string(static_cast<int>(rm));
+    auto it = values_.find(key);
+    if (it != values_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.built;
+    return remember(key, inner_->make_rm_value(rm));
+  }
+
+  smt::Term TermBuilder::make_const_array(smt::Sort s, smt::Term val) {
+    s = canonical(s);
+    auto key = std::make_pair(s.id, val.id);
+    auto it = constArrays_.find(key);
+    if (it != constArrays_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.built;
+    smt::Term t = inner_->make_const_array(s, val);
+    termSorts_[t.id] = s;
+    arrayNodes_[t.id] = ArrayNode{{}, {}, val};
+    return constArrays_[key] = t;
+  }
+
+  smt::Term TermBuilder::make_const(smt::Sort s, const std::string &name) {
+    ++stats_.built;
+    smt::Term t = inner_->make_const(s, name);
+    termSorts_[t.id] = canonical(s);
+    consts_.insert(t.id);
+    return t;
+  }
+
+  std::span<const smt::Term> TermBuilder::operands(smt::Term t) const {
+    if (auto it = nodeOf_.find(t.id); it != nodeOf_.end())
+      return it->second->args;
+    if (auto it = arrayNodes_.find(t.id); it != arrayNodes_.end() && !it->second.base)
+      return {&it->second.value, 1};
+    return {};
+  }
+
+  std::optional<smt::Kind> TermBuilder::kind(smt::Term t) const {
+    if (auto it = nodeOf_.find(t.id); it != nodeOf_.end())
+      return it->second->kind;
+    return std::nullopt;
+  }
+
+  bool TermBuilder::sortText(smt::Sort s, std::string &out) const {
+    auto *info = infoOf(s);
+    if (!info)
+      return false;
+    switch (info->kind) {
+      case SortKind::Bool:
+        out += 'b';
+        return true;
+      case SortKind::BV:
+        out += 'v' + std::to_string(info->width);
+        return true;
+      case SortKind::FP:
+        out += 'f' + std::to_string(info->exp) + ',' + std::to_string(info->sig);
+        return true;
+      case SortKind::Array:
+        out += 'a';
+        if (!sortText({info->index}, out))
+          return false;
+        out += ',';
+        return sortText({info->elem}, out);
+      case SortKind::Other:
+        break;
+    }
+    return false;
+  }
+
+  bool TermBuilder::fingerprint(
+      std::span<const smt::Term> roots, std::string &out, std::vector<smt::Term> &consts
+  ) const {
+    // Post-order walk numbering every distinct term; a node refers to its
+    // operands by those numbers, so shared subterms are written once.
+    std::unordered_map<uint32_t, uint32_t> num;
+    std::vector<std::pair<smt::Term, bool>> stack;
+    for (auto root: roots) {
+      stack.emplace_back(root, false);
+      while (!stack.empty()) {
+        auto [t, expanded] = stack.back();
+        stack.pop_back();
+        if (num.count(t.id))
+          continue;
+        auto ops = operands(t);
+        if (!expanded && !ops.empty()) {
+          stack.emplace_back(t, true);
+          for (auto it = ops.rbegin(); it != ops.rend(); ++it)
+            if (!num.count(it->id))
+              stack.emplace_back(*it, false);
+          continue;
+        }
+
+        if (auto *l = literalOf(t)) {
+          out += 'l' + std::to_string(l->width) + ':' + std::to_string(l->value);
+        } else if (auto v = valueKey_.find(t.id); v != valueKey_.end()) {
+          out += 'v' + *v->second;
+        } else if (consts_.count(t.id)) {
+          // Alpha-renaming: a const is its sort and order of appearance.
+          auto sort = termSorts_.find(t.id);
+          out += 'c';
+          if (sort == termSorts_.end() || !sortText(sort->second, out))
+            return false;
+          consts.push_back(t);
+        } else if (auto n = nodeOf_.find(t.id); n != nodeOf_.end()) {
+          out += 'n' + std::to_string(static_cast<int>(n->second->kind));
+          for (auto i: n->second->indices)
+            out += '/' + std::to_string(i);
+          for (const auto &a: n->second->args)
+            out += ' ' + std::to_string(num.at(a.id));
+        } else if (ops.size() == 1) { // constant array
+          auto sort = termSorts_.find(t.id);
+          out += 'k';
+          if (sort == termSorts_.end() || !sortText(sort->second, out))
+            return false;
+          out += ' ' + std::to_string(num.at(ops[0].id));
+        } else {
+          return false; // built outside this builder's view
+        }
+        out += ';';
+        num.emplace(t.id, static_cast<uint32_t>(num.size()));
+      }
+    }
+    out += 'R';
+    for (auto root: roots)
+      out += ' ' + std::to_string(num.at(root.id));
+    return true;
+  }
+
+  // --- Operations ---
+
+  uint32_t TermBuilder::widthOf(const smt::Term &t) {
+    if (auto *lit = literalOf(t))
+      return lit->width;
+    smt::Sort s = get_sort(t);
+    auto *info = infoOf(s);
+    return info && info->kind == SortKind::BV ? info->width : 0;
+  }
+
+  bool TermBuilder::foldLiterals(
+      smt::Kind k, const std::vector<Literal> &lits, std::span<const uint32_t> indices,
+      Literal &out
+  ) {
+    using K = smt::Kind;
+    uint32_t w = lits[0].width;
+    if (w == 0 || w > 64)
+      return false;
+    uint64_t m = maskOf(w);
+    uint64_t a = lits[0].value;
+    uint64_t b = lits.size() > 1 ? lits[1].value : 0;
+    int64_t sa = toSigned(a, w);
+    int64_t sb = toSigned(b, w);
+    auto bv = [&](uint64_t v) {
+      out = Literal{w, v & m};
+      return true;
+    };
+    auto boolean = [&](bool v) {
+      out = Literal{0, v ? 1u : 0u};
+      return true;
+    };
+    // Signed overflow of the exact result at width w.
+    auto overflows = [&](__int128 r) {
+      __int128 lo = -(__int128(1) << (w - 1));
+      __int128 hi = (__int128(1) << (w - 1)) - 1;
+      return boolean(r < lo || r > hi);
+    };
+    // |x| as an unsigned w-bit value (MIN maps to itself, as in SMT-LIB).
+    auto uabs = [&](int64_t x, uint64_t raw) { return x < 0 ? (~raw + 1) & m : raw; };
+
+    if (lits.size() == 1) {
+      switch (k) {
+        case K::BV_NOT:
+          return bv(~a);
+        case K::BV_NEG:
+          return bv(~a + 1);
+        case K::BV_ZERO_EXTEND:
+          if (indices.size() != 1 || w + indices[0] > 64)
+            return false;
+          out = Literal{w + indices[0], a};
+          return true;
+        case K::BV_SIGN_EXTEND:
+          if (indices.size() != 1 || w + indices[0] > 64)
+            return false;
+          out = Literal{w + indices[0], static_cast<uint64_t>(sa) & maskOf(w + indices[0])};
+          return true;
+        case K::BV_EXTRACT: {
+          if (indices.size() != 2 || indices[0] < indices[1] || indices[0] >= w)
+            return false;
+          uint32_t ow = indices[0] - indices[1] + 1;
+          out = Literal{ow, (a >> indices[1]) & maskOf(ow)};
+          return true;
+        }
+        default:
+          return false;
+      }
+    }
+
+    if (lits.size() != 2 || lits[1].width != w)
+      return false;
+    switch (k) {
+      case K::BV_ADD:
+        return bv(a + b);
+      case K::BV_SUB:
+        return bv(a - b);
+      case K::BV_MUL:
+        return bv(a * b);
+      case K::BV_AND:
+        return bv(a & b);
+      case K::BV_OR:
+        return bv(a | b);
+      case K::BV_XOR:
+        return bv(a ^ b);
+      case K::BV_SHL:
+        return bv(b >= w ? 0 : a << b);
+      case K::BV_SHR:
+        return bv(b >= w ? 0 : a >> b);
+      case K::BV_ASHR:
+        return bv(b >= w ? (sa < 0 ? m : 0) : static_cast<uint64_t>(sa >> b));
+      case K::BV_UDIV:
+        return bv(b == 0 ? m : a / b);
+      case K::BV_UREM:
+        return bv(b == 0 ? a : a % b);
+      case K::BV_SDIV: {
+        uint64_t ua = uabs(sa, a), ub = uabs(sb, b);
+        uint64_t q = ub == 0 ? m : ua / ub;
+        return bv((sa < 0) != (sb < 0) ? ~q + 1 : q);
+      }
+      case K::BV_SREM: {
+        uint64_t ua = uabs(sa, a), ub = uabs(sb, b);
+        uint64_t r = ub == 0 ? ua : ua % ub;
+        return bv(sa < 0 ? ~r + 1 : r);
+      }
+      case K::BV_SLT:
+        return boolean(sa < sb);
+      case K::BV_SLE:
+        return boolean(sa <= sb);
+      case K::BV_SGT:
+        return boolean(sa > sb);
+      case K::BV_SGE:
+        return boolean(sa >= sb);
+      case K::BV_ULT:
+        return boolean(a < b);
+      case K::BV_ULE:
+        return boolean(a <= b);
+      case K::BV_UGT:
+        return boolean(a > b);
+      case K::BV_UGE:
+        return boolean(a >= b);
+      case K::BV_SADD_OVERFLOW:
+        return overflows(__int128(sa) + sb);
+      case K::BV_SSUB_OVERFLOW:
+        return overflows(__int128(sa) - sb);
+      case K::BV_SMUL_OVERFLOW:
+        return overflows(__int128(sa) * sb);
+      default:
+        return false;
+    }
+  }
+
+  smt::Term TermBuilder::foldLogic(smt::Kind k, std::span<const smt::Term> args) {
+    using K = smt::Kind;
+    auto litOf = [&](const smt::Term &t) -> int {
+      auto *l = literalOf(t);
+      return l && l->width == 0 ? int(l->value) : -1;
+    };
+    auto isNegationOf = [&](const smt::Term &a, const smt::Term &b) {
+      auto it = negation_.find(a.id);
+      return it != negation_.end() && it->second == b;
+    };
+
+    switch (k) {
+      case K::NOT: {
+        if (args.size() != 1)
+          return {};
+        if (int l = litOf(args[0]); l >= 0)
+          return boolLit(!l);
+        auto it = negation_.find(args[0].id);
+        if (it != negation_.end())
+          return it->second;
+        return {};
+      }
+      case K::AND:
+      case K::OR: {
+        // absorbing element: false for AND, true for OR
+        int absorbing = k == K::AND ? 0 : 1;
+        std::vector<smt::Term> kept;
+        kept.reserve(args.size());
+        for (const auto &a: args) {
+          int l = litOf(a);
+          if (l == absorbing)
+            return boolLit(absorbing);
+          if (l >= 0)
+            continue; // neutral element
+          bool redundant = false;
+          for (const auto &b: kept) {
+            if (b == a) {
+              redundant = true;
+              break;
+            }
+            if (isNegationOf(a, b))
+              return boolLit(absorbing);
+          }
+          if (!redundant)
+            kept.push_back(a);
+        }
+        if (kept.empty())
+          return boolLit(!absorbing);
+        if (kept.size() == 1)
+          return kept[0];
+        if (kept.size() < args.size())
+          return make_term(k, kept, {});
+        return {};
+      }
+      case K::IMPLIES: {
+        if (args.size() != 2)
+          return {};
+        int la = litOf(args[0]), lb = litOf(args[1]);
+        if (la == 0 || lb == 1 || args[0] == args[1])
+          return boolLit(true);
+        if (la == 1)
+          return args[1];
+        if (lb == 0)
+          return make_term(K::NOT, {args[0]}, {});
+        return {};
+      }
+      case K::ITE: {
+        if (args.size() != 3)
+          return {};
+        const auto &c = args[0], &t = args[1], &e = args[2];
+        if (int lc = litOf(c); lc >= 0)
+          return lc ? t : e;
+        if (t == e)
+          return t;
+        int lt = litOf(t), le = litOf(e);
+        if (lt == 1 && le == 0)
+          return c;
+        if (lt == 0 && le == 1)
+          return make_term(K::NOT, {c}, {});
+        if (lt == 1)
+          return make_term(K::OR, {c, e}, {});
+        if (le == 0)
+          return make_term(K::AND, {c, t}, {});
+        if (lt == 0)
+          return make_term(K::AND, {make_term(K::NOT, {c}, {}), e}, {});
+        if (le == 1)
+          return make_term(K::OR, {make_term(K::NOT, {c}, {}), t}, {});
+        return {};
+      }
+      case K::EQUAL:
+      case K::DISTINCT: {
+        if (args.size() != 2)
+          return {};
+        bool eq = k == K::EQUAL;
+        if (args[0] == args[1])
+          return boolLit(eq);
+        auto *la = literalOf(args[0]);
+        auto *lb = literalOf(args[1]);
+        if (la && lb && la->width == lb->width)
+          return boolLit((la->value == lb->value) == eq);
+        // Bool equalities against a literal: (= x true) -> x, etc.
+        for (int i = 0; i < 2; ++i) {
+          int l = litOf(args[i]);
+          if (l < 0)
+            continue;
+          const auto &other = args[1 - i];
+          return bool(l) == eq ? other : make_term(K::NOT, {other}, {});
+        }
+        return {};
+      }
+      default:
+        return {};
+    }
+  }
+
+  // Algebraic identities on BV operations with one literal operand.
+  smt::Term TermBuilder::foldIdentity(smt::Kind k, std::span<const smt::Term> args) {
+    using K = smt::Kind;
+    if (args.size() != 2)
+      return {};
+    const auto &x = args[0], &y = args[1];
+    auto *lx = literalOf(x);
+    auto *ly = literalOf(y);
+    auto isZero = [](const Literal *l) { return l && l->width > 0 && l->value == 0; };
+    auto isOne = [](const Literal *l) { return l && l->width > 0 && l->value == 1; };
+    auto isOnes = [](const Literal *l) {
+      return l && l->width > 0 && l->value == maskOf(l->width);
+    };
+
+    switch (k) {
+      case K::BV_ADD:
+      case K::BV_OR:
+      case K::BV_XOR:
+        if (isZero(ly))
+          return x;
+        if (isZero(lx))
+          return y;
+        if (k == K::BV_OR && (isOnes(lx) || isOnes(ly)))
+          return isOnes(lx) ? x : y;
+        if (k == K::BV_OR && x == y)
+          return x;
+        if (k == K::BV_XOR && x == y)
+          return bvLit(widthOf(x), 0);
+        return {};
+      case K::BV_SUB:
+        if (isZero(ly))
+          return x;
+        if (x == y)
+          return bvLit(widthOf(x), 0);
+        return {};
+      case K::BV_MUL:
+        if (isOne(ly))
+          return x;
+        if (isOne(lx))
+          return y;
+        if (isZero(lx) || isZero(ly))
+          return isZero(lx) ? x : y;
+        return {};
+      case K::BV_AND:
+        if (isZero(lx) || isZero(ly))
+          return isZero(lx) ? x : y;
+        if (isOnes(ly))
+          return x;
+        if (isOnes(lx))
+          return y;
+        if (x == y)
+          return x;
+        return {};
+      case K::BV_SHL:
+      case K::BV_SHR:
+      case K::BV_ASHR:
+      case K::BV_UDIV:
+      case K::BV_SDIV:
+        if (k == K::BV_UDIV || k == K::BV_SDIV ? isOne(ly) : isZero(ly))
+          return x;
+        return {};
+      default:
+        return {};
+    }
+  }
+
+  smt::Term TermBuilder::fold(
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+  ) {
+    if (args.empty())
+      return {};
+
+    std::vector<Literal> lits;
+    lits.reserve(args.size());
+    for (const auto &a: args) {
+      auto *l = literalOf(a);
+      if (!l)
+        break;
+      lits.push_back(*l);
+    }
+    if (lits.size() == args.size()) {
+      Literal out;
+      if (foldLiterals(k, lits, indices, out))
+        return out.width == 0 ? boolLit(out.value != 0) : bvLit(out.width, out.value);
+    }
+
+    if (k == smt::Kind::ARRAY_SELECT && args.size() == 2)
+      return foldSelect(args);
+    if (k == smt::Kind::ARRAY_STORE && args.size() == 3) {
+      // Storing a constant array's own value changes nothing.
+      auto it = arrayNodes_.find(args[0].id);
+      if (it != arrayNodes_.end() && !it->second.base && it->second.value == args[2])
+        return args[0];
+      return {};
+    }
+    if (auto t = foldLogic(k, args); t)
+      return t;
+    return foldIdentity(k, args);
+  }
+
+  smt::Term TermBuilder::foldSelect(std::span<const smt::Term> args) {
+    smt::Term arr = args[0];
+    const smt::Term &idx = args[1];
+    auto *idxLit = literalOf(idx);
+    for (auto it = arrayNodes_.find(arr.id); it != arrayNodes_.end();
+         it = arrayNodes_.find(arr.id)) {
+      const ArrayNode &node = it->second;
+      if (!node.base || node.index == idx)
+        return node.value;
+      // Skip stores at literal indices that provably differ from ours.
+      auto *storeLit = literalOf(node.index);
+      if (!idxLit || !storeLit || storeLit->value == idxLit->value)
+        break;
+      arr = node.base;
+    }
+    if (arr == args[0])
+      return {};
+    return make_term(smt::Kind::ARRAY_SELECT, {arr, idx}, {});
+  }
+
+  smt::Term TermBuilder::make_term(
+      smt::Kind k, std::span<const smt::Term> args, std::span<const uint32_t> indices
+  ) {
+    if (auto t = fold(k, args, indices); t) {
+      ++stats_.folds;
+      return t;
+    }
+
+    auto it = nodes_.find(NodeRef{k, args, indices});
+    if (it != nodes_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+
+    smt::Term t = inner_->make_term(k, args, indices);
+    ++stats_.built;
+    if (k == smt::Kind::NOT && args.size() == 1) {
+      negation_[t.id] = args[0];
+      negation_.emplace(args[0].id, t);
+    }
+    if (k == smt::Kind::ARRAY_STORE && args.size() == 3)
+      arrayNodes_[t.id] = ArrayNode{args[0], args[1], args[2]};
+    auto node = nodes_.emplace(
+        NodeKey{k, {args.begin(), args.end()}, {indices.begin(), indices.end()}}, t
+    );
+    // A backend may hand back an existing leaf (e.g. `x + 0` -> `x`); it
+    // keeps describing itself as that leaf.
+    if (!literalOf(t) && !consts_.count(t.id) && !valueKey_.count(t.id))
+      nodeOf_.emplace(t.id, &node.first->first);
+    return t;
+  }
+
+  smt::Sort TermBuilder::get_sort(smt::Term t) {
+    auto it = termSorts_.find(t.id);
+    if (it != termSorts_.end())
+      return it->second;
+    smt::Sort s = canonical(inner_->get_sort(t));
+    termSorts_[t.id] = s;
+    return s;
+  }
+
+  bool TermBuilder::is_true(smt::Term t) {
+    if (auto *l = literalOf(t))
+      return l->width == 0 && l->value == 1;
+    return inner_->is_true(t);
+  }
+
+  bool TermBuilder::is_false(smt::Term t) {
+    if (auto *l = literalOf(t))
+      return l->width == 0 && l->value == 0;
+    return inner_->is_false(t);
+  }
+
+  // --- Solving (forwarded) ---
+
+  void TermBuilder::assert_formula(smt::Term t) {
+    if (auto *l = literalOf(t); l && l->width == 0 && l->value == 1)
+      return;
+    inner_->assert_formula(t);
+  }
+
+  smt::Result TermBuilder::check_sat() { return inner_->check_sat(); }
+
+  void TermBuilder::push(uint32_t levels) { inner_->push(levels); }
+
+  void TermBuilder::pop(uint32_t levels) { inner_->pop(levels); }
+
+  void TermBuilder::interrupt() { inner_->interrupt(); }
+
+  smt::Result TermBuilder::check_sat_assuming(const std::vector<smt::Term> &assumptions) {
+    std::vector<smt::Term> kept;
+    kept.reserve(assumptions.size());
+    falseAssumption_.reset();
+    for (const auto &a: assumptions) {
+      if (auto *l = literalOf(a); l && l->width == 0) {
+        if (l->value == 0) {
+          falseAssumption_ = a;
+          return smt::Result::UNSAT;
+        }
+        continue;
+      }
+      kept.push_back(a);
+    }
+    return inner_->check_sat_assuming(kept);
+  }
+
+  std::vector<smt::Term> TermBuilder::get_unsat_assumptions() {
+    if (falseAssumption_)
+      return {*falseAssumption_};
+    return inner_->get_unsat_assumptions();
+  }
+
+  smt::Term TermBuilder::get_value(smt::Term t) { return inner_->get_value(t); }
+
+  std::string TermBuilder::get_bv_value_string(smt::Term t, uint8_t base) {
+    return inner_->get_bv_value_string(t, base);
+  }
+
+  std::string TermBuilder::get_fp_value_string(smt::Term t) {
+    return inner_->get_fp_value_string(t);
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,160 @@
+#include "solver/work_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include "ast/symbol.hpp"
+#include "timing.hpp"
+
+namespace symir::solver {
+
+  namespace {
+
+    // Pool and index of the worker running on this thread, if any.
+    struct CurrentWorker {
+      const WorkPool *pool = nullptr;
+      unsigned index = 0;
+    };
+
+    thread_local CurrentWorker current;
+
+  } // namespace
+
+  WorkPool::WorkPool(unsigned numWorkers) {
+    if (numWorkers == 0)
+      numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(numWorkers);
+    for (unsigned i = 0; i < numWorkers; ++i)
+      workers_.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < numWorkers; ++i)
+      workers_[i]->thread = std::thread([this, i] { loop(i); });
+  }
+
+  WorkPool::~WorkPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMu_);
+      stop_ = true;
+    }
+    sleepCv_.notify_all();
+    for (auto &w: workers_)
+      w->thread.join();
+  }
+
+  std::optional<unsigned> WorkPool::currentWorker() const {
+    if (current.pool == this)
+      return current.index;
+    return std::nullopt;
+  }
+
+  void WorkPool::submit(Group &group, Task task) {
+    // Names in the task refer to the submitter's SymbolTable.
+    task = [inner = std::move(task), symbols = &SymbolTable::current()](unsigned worker) {
+      SymbolTable::Scope scope(*symbols);
+      inner(worker);
+    };
+    if (timing::enabled()) {
+      // Time the task below the Scope that submitted it.
+      task = [inner = std::move(task), path = timing::currentPath()](unsigned worker) {
+        timing::Inherit inherit(path);
+        inner(worker);
+      };
+    }
+    {
+      std::lock_guard<std::mutex> lock(group.mu_);
+      ++group.pending_;
+    }
+    if (auto self = currentWorker()) {
+      std::lock_guard<std::mutex> lock(workers_[*self]->mu);
+      workers_[*self]->tasks.push_front({std::move(task), &group});
+    } else {
+      Worker &w = *workers_[nextQueue_.fetch_add(1) % size()];
+      std::lock_guard<std::mutex> lock(w.mu);
+      w.tasks.push_back({std::move(task), &group});
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleepMu_);
+      ++queued_;
+    }
+    sleepCv_.notify_one();
+  }
+
+  bool WorkPool::takeTask(unsigned self, Queued &out) {
+    {
+      Worker &w = *workers_[self];
+      std::lock_guard<std::mutex> lock(w.mu);
+      if (!w.tasks.empty()) {
+        out = std::move(w.tasks.front());
+        w.tasks.pop_front();
+        --queued_;
+        return true;
+      }
+    }
+    for (unsigned k = 1; k < size(); ++k) {
+      Worker &victim = *workers_[(self + k) % size()];
+      std::lock_guard<std::mutex> lock(victim.mu);
+      if (!victim.tasks.empty()) {
+        out = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        --queued_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void WorkPool::run(unsigned self, Queued &q) {
+    std::exception_ptr error;
+    try {
+      q.task(self);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    Group &g = *q.group;
+    std::lock_guard<std::mutex> lock(g.mu_);
+    if (error && !g.error_)
+      g.error_ = error;
+    if (--g.pending_ == 0)
+      g.cv_.notify_all();
+  }
+
+  void WorkPool::loop(unsigned self) {
+    current = {this, self};
+    Queued q;
+    for (;;) {
+      if (takeTask(self, q)) {
+        run(self, q);
+        q = {};
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMu_);
+      sleepCv_.wait(lock, [&] { return stop_ || queued_.load() > 0; });
+      if (stop_ && queued_.load() <= 0)
+        return;
+    }
+  }
+
+  void WorkPool::wait(Group &group) {
+    auto self = currentWorker();
+    std::unique_lock<std::mutex> lock(group.mu_);
+    while (group.pending_ > 0) {
+      if (!self) {
+        group.cv_.wait(lock, [&] { return group.pending_ == 0; });
+        break;
+      }
+      // Help out instead of blocking a worker. Whatever runs here may
+      // belong to another group; ours is only re-checked in between.
+      lock.unlock();
+      Queued q;
+      bool ran = takeTask(*self, q);
+      if (ran)
+        run(*self, q);
+      lock.lock();
+      if (!ran)
+        group.cv_.wait_for(lock, std::chrono::milliseconds(1), [&] {
+          return group.pending_ == 0;
+        });
+    }
+    if (auto error = std::exchange(group.error_, nullptr))
+      std::rethrow_exception(error);
+  }
+
+} // namespace symir::solver
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "cxxopts.hpp"
+#include "ast/symbol.hpp"
+#include "error.hpp"
+#include "frontend/incremental_checker.hpp"
+#include "json.hpp"
+
+namespace {
+
+  using symir::json::quote;
+
+  // A Language Server Protocol message: `Content-Length` header, blank
+  // line, JSON body. False at the end of the input.
+  bool readMessage(std::istream &in, std::string &body) {
+    std::size_t length = 0;
+    bool haveLength = false;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (line.empty()) {
+        if (!haveLength)
+          continue;
+        body.resize(length);
+        return static_cast<bool>(in.read(body.data(), static_cast<std::streamsize>(length)));
+      }
+      constexpr std::string_view kLength = "Content-Length:";
+      if (line.compare(0, kLength.size(), kLength) == 0) {
+        length = std::stoull(line.substr(kLength.size()));
+        haveLength = true;
+      }
+    }
+    return false;
+  }
+
+  void writeMessage(std::ostream &out, const std::string &body) {
+    out << "Content-Length: " << body.size() << "\r\n\r\n" << body << std::flush;
+  }
+
+  // A JSON-RPC error response to the request with id `id` (JSON text).
+  std::string errorMessage(const std::string &id, int code, const std::string &message) {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"error\":{\"code\":" + std::to_string(code) +
+           ",\"message\":" + quote(message) + "}}";
+  }
+
+  // Member `key` of `obj`; throws if there is none.
+  const symir::json::Value &member(const symir::json::Value *obj, std::string_view key) {
+    const symir::json::Value *v = obj ? obj->find(key) : nullptr;
+    if (!v)
+      throw std::runtime_error("missing \"" + std::string(key) + "\" in message");
+    return *v;
+  }
+
+  // The JSON text of a request id (a number or a string).
+  std::string idText(const symir::json::Value &id) {
+    return id.isString() ? quote(id.text) : id.text;
+  }
+
+  std::string position(const symir::SourcePos &p) {
+    return "{\"line\":" + std::to_string(p.line > 0 ? p.line - 1 : 0) +
+           ",\"character\":" + std::to_string(p.col > 0 ? p.col - 1 : 0) + "}";
+  }
+
+  // The offset in `text` of an LSP position (lines from 0, characters
+  // counted as bytes), clamped to the text.
+  std::size_t offsetOf(const std::string &text, const symir::json::Value &pos) {
+    int64_t line = member(&pos, "line").asInt64();
+    int64_t character = member(&pos, "character").asInt64();
+    std::size_t i = 0;
+    for (; line > 0 && i < text.size(); ++i)
+      if (text[i] == '\n')
+        --line;
+    for (; character > 0 && i < text.size() && text[i] != '\n'; ++i)
+      --character;
+    return i;
+  }
+
+  class Server {
+  public:
+    Server(std::ostream &out, bool verbose) : out_(out), verbose_(verbose) {}
+
+    /// Handles one message; false once the client has sent `exit`.
+    bool handle(const symir::json::Value &msg) {
+      const auto *method = msg.find("method");
+      const auto *id = msg.find("id");
+      if (!method || !method->isString())
+        return true; // a response to a request of ours; we send none
+      const std::string &m = method->text;
+      const symir::json::Value *params = msg.find("params");
+
+      if (m == "initialize") {
+        // Incremental sync: edits arrive as ranges.
+        reply(
+            member(&msg, "id"),
+            "{\"capabilities\":{\"textDocumentSync\":{\"openClose\":true,\"change\":2}},"
+            "\"serverInfo\":{\"name\":\"symir-lsp\"}}"
+        );
+      } else if (m == "shutdown") {
+        shutdown_ = true;
+        reply(member(&msg, "id"), "null");
+      } else if (m == "exit") {
+        return false;
+      } else if (m == "textDocument/didOpen") {
+        const auto &doc = member(params, "textDocument");
+        const std::string &uri = member(&doc, "uri").asString();
+        docs_[uri].text = member(&doc, "text").asString();
+        publish(uri);
+      } else if (m == "textDocument/didChange") {
+        const std::string &uri = member(&member(params, "textDocument"), "uri").asString();
+        auto &doc = docs_[uri];
+        for (const auto &change: member(params, "contentChanges").items) {
+          const std::string &text = member(&change, "text").asString();
+          if (const auto *range = change.find("range")) {
+            std::size_t b = offsetOf(doc.text, member(range, "start"));
+            std::size_t e = std::max(b, offsetOf(doc.text, member(range, "end")));
+            doc.text.replace(b, e - b, text);
+          } else {
+            doc.text = text;
+          }
+        }
+        publish(uri);
+      } else if (m == "textDocument/didClose") {
+        const std::string &uri = member(&member(params, "textDocument"), "uri").asString();
+        docs_.erase(uri);
+        notify("textDocument/publishDiagnostics", "{\"uri\":" + quote(uri) + ",\"diagnostics\":[]}");
+      } else if (id) {
+        writeMessage(out_, errorMessage(idText(*id), -32601, "Unknown method " + m));
+      }
+      return true;
+    }
+
+    bool shutDown() const { return shutdown_; }
+
+  private:
+    // A document's names are interned in a table of its own, which goes
+    // when the document is closed. Old names stay in it as long as the
+    // checker, so once edits have doubled it, the checker starts over.
+    struct Document {
+      std::string text;
+      std::unique_ptr<symir::SymbolTable> symbols;
+      std::unique_ptr<symir::IncrementalChecker> checker;
+      std::uint32_t fresh = 0; // size of `symbols` after a check from scratch
+    };
+    static constexpr std::uint32_t kSymbolSlack = 4096;
+
+    void reply(const symir::json::Value &id, const std::string &result) {
+      writeMessage(
+          out_, "{\"jsonrpc\":\"2.0\",\"id\":" + idText(id) + ",\"result\":" + result + "}"
+      );
+    }
+
+    void notify(const std::string &method, const std::string &params) {
+      writeMessage(
+          out_, "{\"jsonrpc\":\"2.0\",\"method\":" + quote(method) + ",\"params\":" + params + "}"
+      );
+    }
+
+    void publish(const std::string &uri) {
+      auto &doc = docs_[uri];
+      auto start = std::chrono::steady_clock::now();
+      if (!doc.checker || doc.symbols->size() > 2 * doc.fresh + kSymbolSlack) {
+        doc.checker.reset();
+        doc.symbols = std::make_unique<symir::SymbolTable>();
+        doc.fresh = 0;
+      }
+      symir::SymbolTable::Scope symbols(*doc.symbols);
+      if (!doc.checker)
+        doc.checker = std::make_unique<symir::IncrementalChecker>();
+      auto diags = doc.checker->update(doc.text);
+      if (!doc.fresh)
+        doc.fresh = doc.symbols->size();
+      if (verbose_) {
+        const auto &st = doc.checker->stats();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start
+        )
+                      .count();
+        std::cerr << uri << ": " << st.pieces << " declarations, " << st.parsed << " parsed, "
+                  << st.checked << " checked, " << diags.size() << " diagnostics in " << us
+                  << " us\n";
+      }
+
+      std::string list = "[";
+      for (const auto &d: diags) {
+        if (list.size() > 1)
+          list += ',';
+        int severity = d.level == symir::DiagLevel::Error     ? 1
+                       : d.level == symir::DiagLevel::Warning ? 2
+                                                              : 3;
+        list += "{\"range\":{\"start\":" + position(d.span.begin) +
+                ",\"end\":" + position(d.span.end) + "},\"severity\":" + std::to_string(severity) +
+                ",\"source\":\"symir\",\"message\":" + quote(d.message) + "}";
+      }
+      list += "]";
+      notify(
+          "textDocument/publishDiagnostics",
+          "{\"uri\":" + quote(uri) + ",\"diagnostics\":" + list + "}"
+      );
+    }
+
+    std::ostream &out_;
+    bool verbose_;
+    bool shutdown_ = false;
+    std::map<std::string, Document> docs_;
+  };
+
+} // namespace
+
+int main(int argc, char **argv) {
+  using namespace symir;
+
+  cxxopts::Options options("symir-lsp", "SymIR Language Server (LSP over stdin/stdout)");
+
+  // clang-format off
+  options.add_options()
+    ("stdio", "Talk LSP over stdin/stdout (the default; accepted for client compatibility)", cxxopts::value<bool>()->default_value("false"))
+    ("v,verbose", "Log what each update re-parsed and re-checked to stderr", cxxopts::value<bool>()->default_value("false"))
+    ("h,help", "Print usage");
+  // clang-format on
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("help")) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  std::ios::sync_with_stdio(false);
+  Server server(std::cout, result["verbose"].as<bool>());
+  std::string body;
+  while (readMessage(std::cin, body)) {
+    json::Value msg;
+    try {
+      msg = json::parse(body);
+    } catch (const std::exception &e) {
+      // Not even its id can be read: answer with a null one (JSON-RPC Parse error).
+      writeMessage(std::cout, errorMessage("null", -32700, e.what()));
+      continue;
+    }
+    try {
+      if (!server.handle(msg))
+        return server.shutDown() ? ExitCode::Success : ExitCode::Error;
+    } catch (const std::exception &e) {
+      std::cerr << "symir-lsp: " << e.what() << "\n";
+    }
+  }
+  return server.shutDown() ? ExitCode::Success : ExitCode::Error;
+}
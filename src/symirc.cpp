@@ -1,21 +1,296 @@
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <string>
 
 #include "analysis/definite_init.hpp"
 #include "analysis/pass_manager.hpp"
 #include "analysis/reachability.hpp"
+#include "analysis/transforms.hpp"
 #include "analysis/unused_name.hpp"
 #include "ast/ast_dumper.hpp"
 #include "backend/c_backend.hpp"
 #include "backend/wasm_backend.hpp"
+#include "backend/wasm_binary.hpp"
 #include "cxxopts.hpp"
 #include "error.hpp"
 #include "frontend/lexer.hpp"
+#include "frontend/module_cache.hpp"
 #include "frontend/parser.hpp"
 #include "frontend/semchecker.hpp"
+#include "frontend/server.hpp"
+#include "frontend/source_buffer.hpp"
 #include "frontend/typechecker.hpp"
+#include "json.hpp"
+#include "timing.hpp"
+
+namespace {
+
+  // The sym values of a `symirsolve --emit-model` document, read from
+  // `what` (for messages).
+  symir::CBackend::SymModel parseModel(const symir::json::Value &doc, const std::string &what) {
+    if (!doc.isObject())
+      throw std::runtime_error(what + ": expected an object of functions");
+    symir::CBackend::SymModel model;
+    for (const auto &[func, syms]: doc.members) {
+      if (!syms.isObject())
+        throw std::runtime_error(what + ": expected an object of syms for " + func);
+      auto &vals = model[func];
+      for (const auto &[name, val]: syms.members) {
+        if (!val.isNumber())
+          throw std::runtime_error(what + ": the value of " + name + " is not a number");
+        if (val.text.find_first_of(".eE") == std::string::npos)
+          vals[name] = val.asInt64();
+        else
+          vals[name] = std::stod(val.text);
+      }
+    }
+    return model;
+  }
+
+  // The sym values in a `symirsolve --emit-model` file, for --specialize.
+  symir::CBackend::SymModel readModel(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+      throw std::runtime_error("Could not open model file " + path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return parseModel(symir::json::parse(text.str()), path);
+  }
+
+  // The front end and analyses a program is checked by before it is
+  // compiled.
+  void checkPipeline(symir::PassManager &pm) {
+    pm.addModulePass(std::make_unique<symir::SemChecker>());
+    pm.addModulePass(std::make_unique<symir::TypeChecker>());
+    pm.addFunctionPass(std::make_unique<symir::ReachabilityAnalysis>());
+    pm.addFunctionPass(std::make_unique<symir::DefiniteInitAnalysis>());
+    pm.addFunctionPass(std::make_unique<symir::UnusedNameAnalysis>());
+  }
+
+  // An option value no backend knows; main() prints it as an error.
+  struct OptionError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  // What to emit, and how: the backend options of the command line, or of
+  // a --serve request.
+  struct EmitOptions {
+    std::string target = "c";
+    std::string ubChecks = "sanitizer";
+    bool noRequire = false;
+    std::string vecLowering = "vecext";
+    std::string vecTarget = "sse4";
+    std::string cfgLowering = "goto";
+    std::optional<std::string> benchEntry;
+    std::optional<symir::CBackend::SymModel> specialize;
+    bool noModuleTags = false;
+    bool wasmSimd = false;
+    bool wasmNames = false;
+    unsigned numThreads = 1;
+  };
+
+  // GCC and Clang only take vector_size types of 2^n lanes, so vecext can
+  // lower no other `--vectorize` width.
+  void checkVectorize(uint32_t lanes, const EmitOptions &opts) {
+    if (opts.target == "c" && opts.vecLowering == "vecext" && (lanes & (lanes - 1)) != 0)
+      throw OptionError(
+          "--vectorize=" + std::to_string(lanes) +
+          " needs a power of two under --vec-lowering vecext (try array|structarray|intrinsics)"
+      );
+  }
+
+  // Emits `prog` for opts.target to `out`.
+  void emitProgram(const symir::Program &prog, const EmitOptions &opts, std::ostream &out) {
+    using namespace symir;
+    bool noRequire = opts.noRequire;
+    if (opts.target == "c") {
+      CBackend cb(out);
+      if (opts.ubChecks == "none") {
+        cb.setUbChecks(UbChecks::None);
+        noRequire = true;
+      } else if (opts.ubChecks == "explicit") {
+        cb.setUbChecks(UbChecks::Explicit);
+      } else if (opts.ubChecks != "sanitizer") {
+        throw OptionError(
+            "unknown --ub-checks '" + opts.ubChecks + "' (try none|explicit|sanitizer)"
+        );
+      }
+      cb.setNoRequire(noRequire);
+      cb.setNumThreads(opts.numThreads);
+      // [v0.2.1] Set up the vector-lowering strategy.
+      std::unique_ptr<VecLowering> vl;
+      if (opts.vecLowering == "intrinsics") {
+        vl = makeIntrinsicsLowering(opts.vecTarget);
+        if (!vl)
+          throw OptionError(
+              "unknown --vec-target '" + opts.vecTarget + "' (try sse4|avx2|avx512|neon)"
+          );
+      } else {
+        vl = makeVecLowering(opts.vecLowering);
+      }
+      if (!vl)
+        throw OptionError(
+            "unknown --vec-lowering '" + opts.vecLowering +
+            "' (try vecext|scalars|array|structscalars|structarray|intrinsics)"
+        );
+      cb.setVecLowering(std::move(vl));
+      if (opts.cfgLowering == "goto") {
+        cb.setCfgLowering(CBackend::CfgLowering::Goto);
+      } else if (opts.cfgLowering == "structured") {
+        cb.setCfgLowering(CBackend::CfgLowering::Structured);
+      } else if (opts.cfgLowering == "switch") {
+        cb.setCfgLowering(CBackend::CfgLowering::Switch);
+      } else {
+        throw OptionError(
+            "unknown --cfg-lowering '" + opts.cfgLowering + "' (try goto|structured|switch)"
+        );
+      }
+      if (opts.benchEntry)
+        cb.setBenchEntry(*opts.benchEntry);
+      if (opts.specialize)
+        cb.specialize(*opts.specialize);
+      cb.emit(prog);
+    } else if (opts.target == "wasm" || opts.target == "wasm-bin") {
+      bool binary = opts.target == "wasm-bin";
+      std::ostringstream wat;
+      WasmBackend wb(binary ? wat : out);
+      if (!binary)
+        wb.setNoModuleTags(opts.noModuleTags);
+      wb.setNoRequire(noRequire);
+      wb.setSimd(opts.wasmSimd);
+      wb.setNumThreads(opts.numThreads);
+      wb.emit(prog);
+      if (binary) {
+        timing::Scope timer("encode-wasm");
+        out << WasmBinaryEncoder(opts.wasmNames).encode(wat.str());
+      }
+    } else {
+      throw OptionError("Unsupported target: " + opts.target);
+    }
+  }
+
+  std::string base64(std::string_view bytes) {
+    static const char kDigits[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+      uint32_t n = static_cast<uint8_t>(bytes[i]) << 16;
+      if (i + 1 < bytes.size())
+        n |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+      if (i + 2 < bytes.size())
+        n |= static_cast<uint8_t>(bytes[i + 2]);
+      out += kDigits[n >> 18];
+      out += kDigits[(n >> 12) & 63];
+      out += i + 1 < bytes.size() ? kDigits[(n >> 6) & 63] : '=';
+      out += i + 2 < bytes.size() ? kDigits[n & 63] : '=';
+    }
+    return out;
+  }
+
+  // --- Server mode (--serve) ---
+
+  // Answers `compile` requests on `numThreads` workers (0 = hardware
+  // concurrency) until a `shutdown`, keeping modules checked between
+  // requests. The params name the module and override `defaults`:
+  //
+  //   {"input": "t.sir", "target": "c", "ub_checks": "explicit",
+  //    "no_require": true, "vec_lowering": "scalars", "vec_target": "avx2",
+  //    "cfg_lowering": "switch", "emit_bench": "@main", "specialize": {...},
+  //    "wasm_simd": true, "wasm_names": true, "no_module_tags": true,
+  //    "optimize": true, "vectorize": 4}
+  //
+  // `specialize` is an --emit-model object (or true for ranges only). The
+  // answer is {"output": text}, or {"output_base64": ...} for wasm-bin.
+  // Optimization and vectorization rewrite the program, so a request that
+  // asks for them checks its own copy from the module's text.
+  int runServer(
+      const std::string &where, unsigned numThreads, const EmitOptions &defaults, bool werror,
+      const symir::ModuleCache *moduleCache
+  ) {
+    using symir::RpcServer;
+    using symir::json::Value;
+    symir::ModuleStore modules(checkPipeline, moduleCache);
+    RpcServer server("symirc", numThreads);
+    symir::addModuleMethods(server, modules);
+    server.on("compile", [&](const Value &params) {
+      auto module = symir::requestModule(modules, params);
+      symir::SymbolTable::Scope symbols(module->symbols);
+      if (werror && module->diags.hasWarnings())
+        throw RpcServer::Error(RpcServer::kServerError, module->warnings());
+      EmitOptions opts = defaults;
+      bool optimize = false;
+      uint32_t vectorize = 0;
+      try {
+        auto str = [&](const char *key, std::string &into) {
+          if (auto *v = params.find(key))
+            into = v->asString();
+        };
+        auto flag = [&](const char *key, bool &into) {
+          if (auto *v = params.find(key))
+            into = v->asBool();
+        };
+        str("target", opts.target);
+        str("ub_checks", opts.ubChecks);
+        str("vec_lowering", opts.vecLowering);
+        str("vec_target", opts.vecTarget);
+        str("cfg_lowering", opts.cfgLowering);
+        flag("no_require", opts.noRequire);
+        flag("wasm_simd", opts.wasmSimd);
+        flag("wasm_names", opts.wasmNames);
+        flag("no_module_tags", opts.noModuleTags);
+        flag("optimize", optimize);
+        if (auto *v = params.find("emit_bench"))
+          opts.benchEntry = v->asString();
+        if (auto *v = params.find("specialize")) {
+          if (v->isBool())
+            opts.specialize = v->asBool() ? std::optional(symir::CBackend::SymModel{})
+                                          : std::nullopt;
+          else
+            opts.specialize = parseModel(*v, "specialize");
+        }
+        if (auto *v = params.find("vectorize"))
+          vectorize = static_cast<uint32_t>(v->asInt64());
+      } catch (const std::exception &e) {
+        throw RpcServer::Error(RpcServer::kInvalidParams, e.what());
+      }
+
+      std::ostringstream out;
+      try {
+        checkVectorize(vectorize, opts);
+        if (!optimize && !vectorize) {
+          emitProgram(module->prog, opts, out);
+        } else {
+          symir::Program prog;
+          symir::DiagBag diags;
+          symir::PassManager pm(diags);
+          checkPipeline(pm);
+          symir::parseAndCheck(module->source, pm, moduleCache, prog);
+          if (optimize) {
+            symir::PassManager opt(diags, &pm.analyses());
+            symir::addOptimizationPasses(opt);
+            opt.run(prog);
+          }
+          if (vectorize) {
+            symir::PassManager vec(diags, &pm.analyses());
+            vec.addFunctionPass(std::make_unique<symir::LoopVectorization>(vectorize));
+            vec.run(prog);
+          }
+          emitProgram(prog, opts, out);
+        }
+      } catch (const OptionError &e) {
+        throw RpcServer::Error(RpcServer::kInvalidParams, e.what());
+      }
+      if (opts.target == "wasm-bin")
+        return "{\"output_base64\":\"" + base64(out.str()) + "\"}";
+      return "{\"output\":" + symir::json::quote(out.str()) + "}";
+    });
+    return where == "-" ? server.serveStdio() : server.serveUnix(where);
+  }
+
+} // namespace
 
 int main(int argc, char **argv) {
   using namespace symir;
@@ -26,13 +301,27 @@ int main(int argc, char **argv) {
   options.add_options()
     ("input", "Input .sir file", cxxopts::value<std::string>())
     ("o,output", "Output file (default: stdout)", cxxopts::value<std::string>())
-    ("target", "Backend target (c, wasm)", cxxopts::value<std::string>()->default_value("c"))
+    ("target", "Backend target (c, wasm, wasm-bin)", cxxopts::value<std::string>()->default_value("c"))
     ("dump-ast", "Dump AST to stdout and exit", cxxopts::value<bool>()->default_value("false"))
     ("w", "Inhibit all warning messages", cxxopts::value<bool>()->default_value("false"))
     ("Werror", "Make all warnings into errors", cxxopts::value<bool>()->default_value("false"))
     ("no-module-tags", "Omit (module ...) tags in WASM output", cxxopts::value<bool>()->default_value("false"))
+    ("wasm-simd", "Lower vector operations to WASM SIMD128 (v128) instructions", cxxopts::value<bool>()->default_value("false"))
+    ("wasm-names", "Add a name section (function and local names) to --target wasm-bin output", cxxopts::value<bool>()->default_value("false"))
+    ("emit-bench", "Append a main that times the given function (default: main) over generated or loaded inputs (C target)", cxxopts::value<std::string>()->implicit_value("main"))
+    ("specialize", "Compile in the sym values of this --emit-model file and drop the branches and bounds checks their ranges rule out (C target; no file: ranges only)", cxxopts::value<std::string>()->implicit_value(""))
+    ("ub-checks", "C-backend UB checks: none (no checks or requires)|explicit (inline checks calling SYMIR_UB_TRAP)|sanitizer (leave the rest to UBSan)", cxxopts::value<std::string>()->default_value("sanitizer"))
     ("no-require", "Omit require checks from emitted code (useful for compiler testing)", cxxopts::value<bool>()->default_value("false"))
-    ("vec-lowering", "C-backend vector lowering: vecext|scalars|array|structscalars|structarray", cxxopts::value<std::string>()->default_value("vecext"))
+    ("cache-dir", "Directory of checked modules to load instead of re-checking, shared across runs and tools", cxxopts::value<std::string>())
+    ("j,num-threads", "Number of threads for checking and emitting functions (0 = hardware concurrency)", cxxopts::value<uint32_t>()->default_value("1"))
+    ("O,optimize", "Fold constants, propagate copies and drop dead stores and blocks before emitting", cxxopts::value<bool>()->default_value("false"))
+    ("vectorize", "Rewrite counted element-wise loops over arrays into vector operations of this many lanes", cxxopts::value<uint32_t>()->implicit_value("4"))
+    ("vec-lowering", "C-backend vector lowering: vecext|scalars|array|structscalars|structarray|intrinsics", cxxopts::value<std::string>()->default_value("vecext"))
+    ("cfg-lowering", "C-backend branch lowering: goto|structured|switch", cxxopts::value<std::string>()->default_value("goto"))
+    ("vec-target", "Instruction set of --vec-lowering intrinsics: sse4|avx2|avx512|neon", cxxopts::value<std::string>()->default_value("sse4"))
+    ("time-passes", "Print the time of each phase and pass, and the peak RSS, to stderr", cxxopts::value<bool>()->default_value("false"))
+    ("time-trace", "Write the phase timings as Chrome trace-event JSON to this file", cxxopts::value<std::string>())
+    ("serve", "Answer JSON-RPC compile requests on stdin/stdout, or (--serve=PATH) on a Unix socket, keeping modules checked", cxxopts::value<std::string>()->implicit_value("-"))
     ("h,help", "Print usage");
   options.parse_positional({"input"});
   // clang-format on
@@ -44,6 +333,45 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  EmitOptions emitOpts;
+  emitOpts.target = result["target"].as<std::string>();
+  emitOpts.ubChecks = result["ub-checks"].as<std::string>();
+  emitOpts.noRequire = result["no-require"].as<bool>();
+  emitOpts.vecLowering = result["vec-lowering"].as<std::string>();
+  emitOpts.vecTarget = result["vec-target"].as<std::string>();
+  emitOpts.cfgLowering = result["cfg-lowering"].as<std::string>();
+  if (result.count("emit-bench"))
+    emitOpts.benchEntry = result["emit-bench"].as<std::string>();
+  emitOpts.noModuleTags = result["no-module-tags"].as<bool>();
+  emitOpts.wasmSimd = result["wasm-simd"].as<bool>();
+  emitOpts.wasmNames = result["wasm-names"].as<bool>();
+  emitOpts.numThreads = result["num-threads"].as<uint32_t>();
+  if (result.count("vectorize")) {
+    try {
+      checkVectorize(result["vectorize"].as<uint32_t>(), emitOpts);
+    } catch (const OptionError &e) {
+      std::cerr << "Error: " << e.what() << "\n";
+      return 1;
+    }
+  }
+
+  if (result.count("serve")) {
+    if (result.count("specialize") || result["optimize"].as<bool>() || result.count("vectorize")) {
+      std::cerr << "Error: with --serve, --specialize, -O and --vectorize are request params\n";
+      return 1;
+    }
+    // Requests run concurrently; each emits on one thread.
+    EmitOptions defaults = emitOpts;
+    defaults.numThreads = 1;
+    std::optional<ModuleCache> cache;
+    if (result.count("cache-dir"))
+      cache.emplace(result["cache-dir"].as<std::string>());
+    return runServer(
+        result["serve"].as<std::string>(), result["num-threads"].as<uint32_t>(), defaults,
+        result["Werror"].as<bool>(), cache ? &*cache : nullptr
+    );
+  }
+
   if (!result.count("input")) {
     std::cerr << "Error: No input file specified." << std::endl;
     std::cerr << options.help() << std::endl;
@@ -51,41 +379,48 @@ int main(int argc, char **argv) {
   }
 
   std::string inputPath = result["input"].as<std::string>();
-  std::ifstream ifs(inputPath);
-  if (!ifs) {
+  auto input = SourceBuffer::open(inputPath);
+  if (!input) {
     std::cerr << "Error: Could not open file " << inputPath << "\n";
     return 1;
   }
-  std::stringstream ss;
-  ss << ifs.rdbuf();
-  std::string src = ss.str();
+  std::string_view src = input->text();
 
-  try {
-    // 1. Frontend
-    Lexer lx(src);
-    auto toks = lx.lexAll();
-    Parser ps(std::move(toks));
-    Program prog = ps.parseProgram();
+  timing::Session timingSession(
+      result["time-passes"].as<bool>(),
+      result.count("time-trace") ? result["time-trace"].as<std::string>() : std::string()
+  );
 
+  try {
     if (result["dump-ast"].as<bool>()) {
+      Lexer lx(src);
+      Parser ps(lx);
+      Program prog = ps.parseProgram();
       ASTDumper dumper(std::cout);
       dumper.dump(prog);
       return 0;
     }
 
-    // 2. Analysis
+    std::optional<ModuleCache> cache;
+    if (result.count("cache-dir"))
+      cache.emplace(result["cache-dir"].as<std::string>());
+
+    // 1. Frontend and analysis
+    Program prog;
     DiagBag diags;
     symir::PassManager pm(diags);
-    pm.addModulePass(std::make_unique<SemChecker>());
-    pm.addModulePass(std::make_unique<TypeChecker>());
-    pm.addFunctionPass(std::make_unique<ReachabilityAnalysis>());
-    pm.addFunctionPass(std::make_unique<DefiniteInitAnalysis>());
-    pm.addFunctionPass(std::make_unique<UnusedNameAnalysis>());
+    pm.setNumThreads(result["num-threads"].as<uint32_t>());
+    checkPipeline(pm);
 
     bool werror = result["Werror"].as<bool>();
     bool nowarn = result["w"].as<bool>();
 
-    if (pm.run(prog) == symir::PassResult::Error || (werror && diags.hasWarnings())) {
+    PassResult checked;
+    {
+      timing::Scope timer("frontend");
+      checked = parseAndCheck(src, pm, cache ? &*cache : nullptr, prog);
+    }
+    if (checked == symir::PassResult::Error || (werror && diags.hasWarnings())) {
       std::cerr << "Errors:\n";
       for (const auto &d: diags.diags) {
         if (d.level == DiagLevel::Error || (werror && d.level == DiagLevel::Warning)) {
@@ -104,14 +439,29 @@ int main(int argc, char **argv) {
       }
     }
 
+    // 2. Optimization
+    if (result["optimize"].as<bool>()) {
+      timing::Scope timer("optimize");
+      PassManager opt(diags, &pm.analyses());
+      opt.setNumThreads(result["num-threads"].as<uint32_t>());
+      addOptimizationPasses(opt);
+      opt.run(prog);
+    }
+    if (result.count("vectorize")) {
+      timing::Scope timer("vectorize");
+      PassManager vec(diags, &pm.analyses());
+      vec.setNumThreads(result["num-threads"].as<uint32_t>());
+      vec.addFunctionPass(std::make_unique<LoopVectorization>(result["vectorize"].as<uint32_t>()));
+      vec.run(prog);
+    }
+
     // 3. Backend
-    std::string target = result["target"].as<std::string>();
     std::ostream *outStream = &std::cout;
     std::ofstream ofs;
 
     if (result.count("output")) {
       std::string outPath = result["output"].as<std::string>();
-      ofs.open(outPath);
+      ofs.open(outPath, std::ios::binary);
       if (!ofs) {
         std::cerr << "Error: Could not open output file " << outPath << "\n";
         return 1;
@@ -119,29 +469,14 @@ int main(int argc, char **argv) {
       outStream = &ofs;
     }
 
-    bool noRequire = result["no-require"].as<bool>();
-    if (target == "c") {
-      CBackend cb(*outStream);
-      cb.setNoRequire(noRequire);
-      // [v0.2.1] Set up the vector-lowering strategy.
-      std::string vlName = result["vec-lowering"].as<std::string>();
-      auto vl = makeVecLowering(vlName);
-      if (!vl) {
-        std::cerr << "Error: unknown --vec-lowering '" << vlName
-                  << "' (try vecext|scalars|array|structscalars|structarray)\n";
-        return 1;
-      }
-      cb.setVecLowering(std::move(vl));
-      cb.emit(prog);
-    } else if (target == "wasm") {
-      WasmBackend wb(*outStream);
-      if (result.count("no-module-tags")) {
-        wb.setNoModuleTags(result["no-module-tags"].as<bool>());
-      }
-      wb.setNoRequire(noRequire);
-      wb.emit(prog);
-    } else {
-      std::cerr << "Error: Unsupported target: " << target << "\n";
+    if (result.count("specialize")) {
+      std::string modelPath = result["specialize"].as<std::string>();
+      emitOpts.specialize = modelPath.empty() ? CBackend::SymModel{} : readModel(modelPath);
+    }
+    try {
+      emitProgram(prog, emitOpts, *outStream);
+    } catch (const OptionError &e) {
+      std::cerr << "Error: " << e.what() << "\n";
       return 1;
     }
 
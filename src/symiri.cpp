@@ -1,7 +1,14 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "analysis/cfg.hpp"
@@ -12,10 +19,351 @@
 #include "cxxopts.hpp"
 #include "error.hpp"
 #include "frontend/lexer.hpp"
+#include "frontend/module_cache.hpp"
 #include "frontend/parser.hpp"
 #include "frontend/semchecker.hpp"
+#include "frontend/server.hpp"
+#include "frontend/source_buffer.hpp"
 #include "frontend/typechecker.hpp"
 #include "interp/interpreter.hpp"
+#include "interp/native.hpp"
+#include "interp/profile.hpp"
+#include "interp/trace.hpp"
+#include "json.hpp"
+#include "timing.hpp"
+
+// --- Many bindings in one run (--sym-file) ---
+
+namespace {
+
+  using symir::Interpreter;
+
+  // One row of a sym file: the bindings of one run, or why they are unusable.
+  struct SymRow {
+    std::size_t line = 0;
+    Interpreter::SymBindings syms;
+    std::string error;
+  };
+
+  std::string trim(const std::string &s) {
+    auto b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos)
+      return "";
+    return s.substr(b, s.find_last_not_of(" \t\r\n") - b + 1);
+  }
+
+  std::vector<std::string> splitCsv(const std::string &line) {
+    std::vector<std::string> cells;
+    std::stringstream ss(line);
+    std::string cell;
+    while (std::getline(ss, cell, ','))
+      cells.push_back(trim(cell));
+    if (!line.empty() && line.back() == ',')
+      cells.push_back("");
+    return cells;
+  }
+
+  void bindSym(SymRow &row, const std::string &name, const std::string &value) {
+    try {
+      row.syms[name] = symir::parseNumberLiteral(value);
+    } catch (...) {
+      throw std::runtime_error("Invalid number value for symbol " + name + ": " + value);
+    }
+  }
+
+  // Reads a `.csv` file (a header of symbol names, then one row of values
+  // per run) or a `.jsonl` file (one object of name -> value per run). Each
+  // row starts from `defaults`. Blank lines and `#` comments are skipped.
+  std::vector<SymRow>
+  readSymFile(const std::string &path, const Interpreter::SymBindings &defaults) {
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    bool jsonl = path.size() >= 6 && path.compare(path.size() - 6, 6, ".jsonl") == 0;
+    if (!csv && !jsonl)
+      throw std::runtime_error("Sym file must end in .csv or .jsonl: " + path);
+    std::ifstream in(path);
+    if (!in)
+      throw std::runtime_error("Could not open sym file " + path);
+
+    std::vector<SymRow> rows;
+    std::vector<std::string> header;
+    std::string text;
+    for (std::size_t lineNo = 1; std::getline(in, text); ++lineNo) {
+      std::string line = trim(text);
+      if (line.empty() || line[0] == '#')
+        continue;
+      if (csv && header.empty()) {
+        header = splitCsv(line);
+        continue;
+      }
+      SymRow row;
+      row.line = lineNo;
+      row.syms = defaults;
+      try {
+        if (csv) {
+          auto cells = splitCsv(line);
+          if (cells.size() != header.size())
+            throw std::runtime_error(
+                "Expected " + std::to_string(header.size()) + " values, got " +
+                std::to_string(cells.size())
+            );
+          for (std::size_t i = 0; i < cells.size(); ++i)
+            bindSym(row, header[i], cells[i]);
+        } else {
+          symir::json::Value v = symir::json::parse(line);
+          if (!v.isObject())
+            throw std::runtime_error("Row is not a JSON object");
+          for (const auto &[name, val]: v.members) {
+            if (!val.isNumber() && !val.isString())
+              throw std::runtime_error("Value of " + name + " must be a number or a string");
+            bindSym(row, name, val.text);
+          }
+        }
+      } catch (const std::exception &e) {
+        row.error = e.what();
+      }
+      rows.push_back(std::move(row));
+    }
+    return rows;
+  }
+
+  // What run() prints after `Result: ` for a returned call.
+  std::string resultText(const Interpreter::CallResult &res) {
+    if (!res.value)
+      return "void";
+    if (auto d = std::get_if<double>(&*res.value)) {
+      char buf[64];
+      std::snprintf(buf, sizeof(buf), "%a", *d);
+      return buf;
+    }
+    std::int64_t v = std::get<std::int64_t>(*res.value);
+    if (!res.pointer)
+      return std::to_string(v);
+    std::ostringstream os;
+    os << "ptr(0x" << std::hex << static_cast<std::uint64_t>(v) << ")";
+    return os.str();
+  }
+
+  // The native build of `entry` for --native, or null (after a note) when
+  // it cannot run natively and the interpreter is used instead.
+  std::unique_ptr<symir::NativeFunction> loadNative(
+      const symir::Program &prog, const std::string &entry, const std::string &cacheDir, bool quiet
+  ) {
+    std::string why = symir::NativeFunction::unsupportedReason(prog, entry);
+    if (why.empty()) {
+      try {
+        return std::make_unique<symir::NativeFunction>(prog, entry, cacheDir);
+      } catch (const std::exception &e) {
+        why = e.what();
+      }
+    }
+    if (!quiet)
+      std::cerr << "note: --native: " << why << "; using the interpreter\n";
+    return nullptr;
+  }
+
+  // Runs `entry` once per row on `numThreads` threads, each with its own
+  // Interpreter (or all on `native`, if given), and streams one JSON line
+  // per row as soon as it is done: {"line":N,"exit":E,"status":"ok",
+  // "result":R} with R the text after `Result: `, or status "ub",
+  // "require", "budget" or "error" with a "message". E is the exit code a
+  // single run with these bindings would have. With `lockstep` > 1, each
+  // thread takes that many rows at a time and runs them with
+  // Interpreter::callBatch(). Each row gets all of `budget`. The
+  // interpreters share the CFGs in `am`.
+  void runSymRows(
+      const symir::Program &prog, const std::string &entry, Interpreter::Engine engine,
+      const std::vector<SymRow> &rows, unsigned numThreads, const symir::NativeFunction *native,
+      std::size_t lockstep, Interpreter::Budget budget, symir::AnalysisManager &am
+  ) {
+    using symir::json::quote;
+    namespace ExitCode = symir::ExitCode;
+    symir::timing::Scope timer("interpret");
+    symir::timing::count("rows", rows.size());
+    std::mutex outMu;
+    auto emit = [&](const SymRow &row, int exit, const char *status, const std::string &text) {
+      std::ostringstream os;
+      os << "{\"line\":" << row.line << ",\"exit\":" << exit << ",\"status\":\"" << status
+         << "\"," << (exit == ExitCode::Success ? "\"result\":" : "\"message\":") << quote(text)
+         << "}\n";
+      std::lock_guard<std::mutex> lock(outMu);
+      std::cout << os.str() << std::flush;
+    };
+    auto report = [&](const SymRow &row, const Interpreter::CallResult &res) {
+      switch (res.status) {
+        case Interpreter::CallResult::Status::Returned:
+          emit(row, ExitCode::Success, "ok", resultText(res));
+          break;
+        case Interpreter::CallResult::Status::UndefinedBehavior:
+          emit(row, ExitCode::UndefinedBehavior, "ub", res.message);
+          break;
+        case Interpreter::CallResult::Status::RequireViolation:
+          emit(row, ExitCode::RequireViolation, "require", res.message);
+          break;
+        case Interpreter::CallResult::Status::BudgetExhausted:
+          emit(row, ExitCode::BudgetExhausted, "budget", res.message);
+          break;
+        case Interpreter::CallResult::Status::Error:
+          emit(row, ExitCode::Error, "error", res.message);
+          break;
+      }
+    };
+
+    {
+      Interpreter probe(prog);
+      probe.setAnalysisManager(am);
+      probe.prepare(entry); // an unknown entry fails the whole run
+    }
+
+    std::size_t chunk = native ? 1 : std::max<std::size_t>(lockstep, 1);
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+      Interpreter interp(prog);
+      interp.setEngine(engine);
+      interp.setBudget(budget);
+      interp.setAnalysisManager(am);
+      Interpreter::PreparedFunction fn;
+      if (!native)
+        fn = interp.prepare(entry);
+      std::vector<const Interpreter::SymBindings *> batch;
+      std::vector<std::size_t> batchRows;
+      for (std::size_t b; (b = next.fetch_add(chunk)) < rows.size();) {
+        batch.clear();
+        batchRows.clear();
+        for (std::size_t i = b; i < std::min(b + chunk, rows.size()); ++i) {
+          const SymRow &row = rows[i];
+          if (!row.error.empty()) {
+            emit(row, ExitCode::Error, "error", row.error);
+          } else if (chunk == 1) {
+            report(row, native ? native->call(row.syms) : interp.call(fn, {}, row.syms));
+          } else {
+            batch.push_back(&row.syms);
+            batchRows.push_back(i);
+          }
+        }
+        if (batch.empty())
+          continue;
+        auto results = interp.callBatch(fn, batch);
+        for (std::size_t k = 0; k < results.size(); ++k)
+          report(rows[batchRows[k]], results[k]);
+      }
+    };
+
+    numThreads = std::max(1u, std::min<unsigned>(numThreads, rows.size()));
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t)
+      threads.emplace_back(worker);
+    worker();
+    for (auto &t: threads)
+      t.join();
+  }
+
+  // The front end and analyses a program is checked by before it runs.
+  void checkPipeline(symir::PassManager &pm) {
+    pm.addModulePass(std::make_unique<symir::SemChecker>());
+    pm.addModulePass(std::make_unique<symir::TypeChecker>());
+    pm.addFunctionPass(std::make_unique<symir::ReachabilityAnalysis>());
+    pm.addFunctionPass(std::make_unique<symir::DefiniteInitAnalysis>());
+    pm.addFunctionPass(std::make_unique<symir::UnusedNameAnalysis>());
+  }
+
+  // --- Server mode (--serve) ---
+
+  // Answers `interpret` requests on `numThreads` workers (0 = hardware
+  // concurrency) until a `shutdown`, keeping modules checked between
+  // requests:
+  //
+  //   {"input": "t.sir", "main": "@f", "syms": {"%?n": 4}, "args": [1, 2],
+  //    "engine": "ast", "max_steps": 1000, "max_ms": 50}
+  //
+  // answered like a --sym-file row: {"exit":0,"status":"ok","result":"5",
+  // "steps":12}, or a status of ub, require, budget or error with a
+  // message. A request's syms start from `defaults`; `engine` and the
+  // budget default to the command line's.
+  int runServer(
+      const std::string &where, unsigned numThreads, const Interpreter::SymBindings &defaults,
+      Interpreter::Engine engine, Interpreter::Budget budget, bool werror,
+      const symir::ModuleCache *moduleCache
+  ) {
+    using symir::RpcServer;
+    using symir::json::quote;
+    namespace ExitCode = symir::ExitCode;
+    symir::ModuleStore modules(checkPipeline, moduleCache);
+    RpcServer server("symiri", numThreads);
+    symir::addModuleMethods(server, modules);
+    server.on("interpret", [&](const symir::json::Value &params) {
+      auto module = symir::requestModule(modules, params);
+      symir::SymbolTable::Scope symbols(module->symbols);
+      if (werror && module->diags.hasWarnings())
+        throw RpcServer::Error(RpcServer::kServerError, module->warnings());
+      std::string entry = "@main";
+      Interpreter::SymBindings syms = defaults;
+      std::vector<std::variant<std::int64_t, double>> args;
+      Interpreter::Engine eng = engine;
+      Interpreter::Budget bud = budget;
+      try {
+        if (auto *m = params.find("main"))
+          entry = m->asString();
+        if (auto *v = params.find("syms")) {
+          if (!v->isObject())
+            throw std::runtime_error("\"syms\" must be an object");
+          for (const auto &[name, val]: v->members)
+            syms[name] = symir::parseNumberLiteral(val.isString() ? val.asString() : val.text);
+        }
+        if (auto *v = params.find("args")) {
+          for (const auto &a: v->items)
+            args.push_back(symir::parseNumberLiteral(a.isString() ? a.asString() : a.text));
+        }
+        if (auto *v = params.find("engine")) {
+          if (v->asString() != "bytecode" && v->asString() != "ast")
+            throw std::runtime_error("Unknown engine: " + v->asString());
+          eng = v->asString() == "ast" ? Interpreter::Engine::Ast : Interpreter::Engine::Bytecode;
+        }
+        if (auto *v = params.find("max_steps"))
+          bud.maxSteps = static_cast<std::uint64_t>(v->asInt64());
+        if (auto *v = params.find("max_ms"))
+          bud.maxMs = static_cast<std::uint64_t>(v->asInt64());
+      } catch (const std::exception &e) {
+        throw RpcServer::Error(RpcServer::kInvalidParams, e.what());
+      }
+
+      Interpreter interp(module->prog);
+      interp.setEngine(eng);
+      interp.setBudget(bud);
+      interp.setAnalysisManager(module->analyses);
+      auto res = interp.call(interp.prepare(entry), args, syms);
+      int exit = ExitCode::Success;
+      const char *status = "ok";
+      switch (res.status) {
+        case Interpreter::CallResult::Status::Returned:
+          break;
+        case Interpreter::CallResult::Status::UndefinedBehavior:
+          exit = ExitCode::UndefinedBehavior;
+          status = "ub";
+          break;
+        case Interpreter::CallResult::Status::RequireViolation:
+          exit = ExitCode::RequireViolation;
+          status = "require";
+          break;
+        case Interpreter::CallResult::Status::BudgetExhausted:
+          exit = ExitCode::BudgetExhausted;
+          status = "budget";
+          break;
+        case Interpreter::CallResult::Status::Error:
+          exit = ExitCode::Error;
+          status = "error";
+          break;
+      }
+      std::ostringstream os;
+      os << "{\"exit\":" << exit << ",\"status\":\"" << status << "\","
+         << (exit == ExitCode::Success ? "\"result\":" + quote(resultText(res))
+                                       : "\"message\":" + quote(res.message))
+         << ",\"steps\":" << res.steps << "}";
+      return os.str();
+    });
+    return where == "-" ? server.serveStdio() : server.serveUnix(where);
+  }
+
+} // namespace
 
 int main(int argc, char **argv) {
   using namespace symir;
@@ -29,8 +377,28 @@ int main(int argc, char **argv) {
     ("sym", "Bind a symbol (name=value)", cxxopts::value<std::vector<std::string>>())
     ("check", "Check semantics only (do not execute)", cxxopts::value<bool>()->default_value("false"))
     ("dump-trace", "Dump executed blocks and variable updates", cxxopts::value<bool>()->default_value("false"))
+    ("trace-file", "Write a binary trace of executed blocks and variable updates to this file", cxxopts::value<std::string>())
+    ("trace-compress", "Gzip-compress the --trace-file trace", cxxopts::value<bool>()->default_value("false"))
+    ("trace-blocks-only", "Trace executed blocks but no variable updates", cxxopts::value<bool>()->default_value("false"))
+    ("trace-var", "Trace updates of this local only (repeatable)", cxxopts::value<std::vector<std::string>>())
+    ("profile", "Write per-block, per-edge and per-instruction-kind execution counts to this JSON file", cxxopts::value<std::string>())
+    ("profile-dot", "Write the CFG annotated with execution counts to this DOT file", cxxopts::value<std::string>())
+    ("profile-time", "Also sample wall time per block for --profile/--profile-dot", cxxopts::value<bool>()->default_value("false"))
+    ("decode-trace", "Print a --trace-file trace as --dump-trace text and exit", cxxopts::value<std::string>())
+    ("native", "Compile the entry function to native code via the C backend and run that, falling back to the interpreter when it cannot", cxxopts::value<bool>()->default_value("false"))
+    ("native-cache", "Cache directory for --native builds", cxxopts::value<std::string>())
+    ("cache-dir", "Directory of checked modules to load instead of re-checking, shared across runs and tools", cxxopts::value<std::string>())
+    ("engine", "Execution engine: bytecode, or ast for the reference AST walker", cxxopts::value<std::string>()->default_value("bytecode"))
+    ("sym-file", "Run once per row of this .csv or .jsonl file of bindings, streaming one JSON result per row", cxxopts::value<std::string>())
+    ("j,num-threads", "Number of threads for checking functions and for --sym-file rows (0 = hardware concurrency)", cxxopts::value<uint32_t>()->default_value("1"))
+    ("lockstep", "Run --sym-file rows this many at a time in lock-step, one lane per row (0 = one at a time)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("max-steps", "Stop a run that would enter more than this many blocks (0 = unlimited)", cxxopts::value<uint64_t>()->default_value("0"))
+    ("max-ms", "Stop a run still going after this many milliseconds (0 = unlimited)", cxxopts::value<uint64_t>()->default_value("0"))
     ("w", "Inhibit all warning messages", cxxopts::value<bool>()->default_value("false"))
     ("Werror", "Make all warnings into errors", cxxopts::value<bool>()->default_value("false"))
+    ("time-passes", "Print the time of each phase and pass, and the peak RSS, to stderr", cxxopts::value<bool>()->default_value("false"))
+    ("time-trace", "Write the phase timings as Chrome trace-event JSON to this file", cxxopts::value<std::string>())
+    ("serve", "Answer JSON-RPC interpret requests on stdin/stdout, or (--serve=PATH) on a Unix socket, keeping modules checked", cxxopts::value<std::string>()->implicit_value("-"))
     ("h,help", "Print usage");
   options.parse_positional({"input"});
   // clang-format on
@@ -42,14 +410,69 @@ int main(int argc, char **argv) {
     return 0;
   }
 
-  if (!result.count("input")) {
+  if (result.count("decode-trace")) {
+    try {
+      decodeTrace(result["decode-trace"].as<std::string>(), std::cout);
+    } catch (const std::exception &e) {
+      std::cerr << "Error: " << e.what() << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  bool serve = result.count("serve") > 0;
+  if (!result.count("input") && !serve) {
     std::cerr << "Error: No input file specified." << std::endl;
     std::cerr << options.help() << std::endl;
     return 1;
   }
 
-  std::string inputPath = result["input"].as<std::string>();
+  std::string inputPath = serve ? "" : result["input"].as<std::string>();
   std::string mainFunc = result["main"].as<std::string>();
+  std::string engine = result["engine"].as<std::string>();
+  if (engine != "bytecode" && engine != "ast") {
+    std::cerr << "Error: Unknown engine: " << engine << " (expected bytecode or ast)\n";
+    return 1;
+  }
+  bool symFile = result.count("sym-file") > 0;
+  bool traceFile = result.count("trace-file") > 0;
+  bool profile = result.count("profile") || result.count("profile-dot");
+  if (symFile && (result["dump-trace"].as<bool>() || traceFile || profile)) {
+    std::cerr << "Error: --dump-trace, --trace-file and --profile cannot be combined with "
+                 "--sym-file\n";
+    return 1;
+  }
+  bool native = result["native"].as<bool>();
+  unsigned lockstep = result["lockstep"].as<uint32_t>();
+  if (lockstep && (!symFile || native)) {
+    std::cerr << "Error: --lockstep needs --sym-file and cannot be combined with --native\n";
+    return 1;
+  }
+  if (native && (result["dump-trace"].as<bool>() || traceFile || profile)) {
+    std::cerr << "Error: --native cannot be combined with --dump-trace, --trace-file or "
+                 "--profile\n";
+    return 1;
+  }
+  Interpreter::Budget budget;
+  budget.maxSteps = result["max-steps"].as<uint64_t>();
+  budget.maxMs = result["max-ms"].as<uint64_t>();
+  if (native && (budget.maxSteps || budget.maxMs)) {
+    std::cerr << "Error: --max-steps and --max-ms cannot be combined with --native\n";
+    return 1;
+  }
+  if (result["trace-compress"].as<bool>() && !traceCompressionAvailable()) {
+    std::cerr << "Error: --trace-compress needs a symiri built with zlib\n";
+    return 1;
+  }
+  TraceFilter traceFilter;
+  traceFilter.blocksOnly = result["trace-blocks-only"].as<bool>();
+  if (result.count("trace-var")) {
+    for (auto name: result["trace-var"].as<std::vector<std::string>>()) {
+      if (name.empty() || name[0] != '%')
+        name = "%" + name;
+      traceFilter.vars.insert(name);
+    }
+  }
   Interpreter::SymBindings symBindings;
 
   if (result.count("sym")) {
@@ -70,35 +493,56 @@ int main(int argc, char **argv) {
     }
   }
 
-  std::ifstream ifs(inputPath);
-  if (!ifs) {
+  if (serve) {
+    if (symFile || native || traceFile || profile || result["dump-trace"].as<bool>() ||
+        result["check"].as<bool>()) {
+      std::cerr << "Error: --serve cannot be combined with --sym-file, --native, --check, "
+                   "--dump-trace, --trace-file or --profile\n";
+      return 1;
+    }
+    std::optional<ModuleCache> cache;
+    if (result.count("cache-dir"))
+      cache.emplace(result["cache-dir"].as<std::string>());
+    return runServer(
+        result["serve"].as<std::string>(), result["num-threads"].as<uint32_t>(), symBindings,
+        engine == "ast" ? Interpreter::Engine::Ast : Interpreter::Engine::Bytecode, budget,
+        result["Werror"].as<bool>(), cache ? &*cache : nullptr
+    );
+  }
+
+  auto input = SourceBuffer::open(inputPath);
+  if (!input) {
     std::cerr << "Error: Could not open file " << inputPath << "\n";
     return 1;
   }
-  std::stringstream ss;
-  ss << ifs.rdbuf();
-  std::string src = ss.str();
+  std::string_view src = input->text();
+
+  timing::Session timingSession(
+      result["time-passes"].as<bool>(),
+      result.count("time-trace") ? result["time-trace"].as<std::string>() : std::string()
+  );
 
   try {
-    // 1. Frontend: Lex & Parse
-    Lexer lx(src);
-    auto toks = lx.lexAll();
-    Parser ps(std::move(toks));
-    Program prog = ps.parseProgram();
+    std::optional<ModuleCache> cache;
+    if (result.count("cache-dir"))
+      cache.emplace(result["cache-dir"].as<std::string>());
 
-    // 2. Analysis: Pass Manager orchestration
+    // 1-2. Frontend and analysis, or the checked module from --cache-dir
+    Program prog;
     DiagBag diags;
     symir::PassManager pm(diags);
-    pm.addModulePass(std::make_unique<SemChecker>());
-    pm.addModulePass(std::make_unique<TypeChecker>());
-    pm.addFunctionPass(std::make_unique<ReachabilityAnalysis>());
-    pm.addFunctionPass(std::make_unique<DefiniteInitAnalysis>());
-    pm.addFunctionPass(std::make_unique<UnusedNameAnalysis>());
+    pm.setNumThreads(result["num-threads"].as<uint32_t>());
+    checkPipeline(pm);
 
     bool werror = result["Werror"].as<bool>();
     bool nowarn = result["w"].as<bool>();
 
-    if (pm.run(prog) == symir::PassResult::Error || (werror && diags.hasWarnings())) {
+    PassResult checked;
+    {
+      timing::Scope timer("frontend");
+      checked = parseAndCheck(src, pm, cache ? &*cache : nullptr, prog);
+    }
+    if (checked == symir::PassResult::Error || (werror && diags.hasWarnings())) {
       std::cerr << "Errors:\n";
       for (const auto &d: diags.diags) {
         if (d.level == DiagLevel::Error || (werror && d.level == DiagLevel::Warning)) {
@@ -121,8 +565,82 @@ int main(int argc, char **argv) {
     }
 
     // 4. Interpret
+    auto eng = engine == "ast" ? Interpreter::Engine::Ast : Interpreter::Engine::Bytecode;
+    std::unique_ptr<NativeFunction> nativeFn;
+    if (native) {
+      std::string cacheDir = result.count("native-cache") ? result["native-cache"].as<std::string>()
+                                                          : NativeFunction::defaultCacheDir();
+      nativeFn = loadNative(prog, mainFunc, cacheDir, nowarn);
+    }
+    if (symFile) {
+      auto rows = readSymFile(result["sym-file"].as<std::string>(), symBindings);
+      unsigned threads = result["num-threads"].as<uint32_t>();
+      if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      runSymRows(
+          prog, mainFunc, eng, rows, threads, nativeFn.get(), lockstep, budget, pm.analyses()
+      );
+      return 0;
+    }
+    if (nativeFn) {
+      Interpreter::CallResult res = nativeFn->call(symBindings);
+      switch (res.status) {
+        case Interpreter::CallResult::Status::Returned:
+          std::cout << "Result: " << resultText(res) << "\n";
+          return 0;
+        case Interpreter::CallResult::Status::UndefinedBehavior:
+          std::cerr << res.message << "\n";
+          return ExitCode::UndefinedBehavior;
+        case Interpreter::CallResult::Status::RequireViolation:
+          std::cerr << "Requirement failed: " << res.message << "\n";
+          return ExitCode::RequireViolation;
+        case Interpreter::CallResult::Status::BudgetExhausted:
+          std::cerr << res.message << "\n";
+          return ExitCode::BudgetExhausted;
+        case Interpreter::CallResult::Status::Error:
+          std::cerr << "Exception: " << res.message << "\n";
+          return ExitCode::Error;
+      }
+    }
     Interpreter interp(prog);
-    interp.run(mainFunc, symBindings, result["dump-trace"].as<bool>());
+    interp.setEngine(eng);
+    interp.setBudget(budget);
+    interp.setAnalysisManager(pm.analyses());
+    // Destroyed, and so completed, even when the run ends in UB.
+    std::unique_ptr<TraceWriter> trace;
+    if (traceFile)
+      trace = std::make_unique<TraceWriter>(
+          result["trace-file"].as<std::string>(), result["trace-compress"].as<bool>()
+      );
+    interp.setTrace(trace.get(), std::move(traceFilter));
+    Profile prof;
+    prof.timed = result["profile-time"].as<bool>();
+    if (profile)
+      interp.setProfile(&prof);
+    // The profile is written even when the run ends in UB or runs out of
+    // budget, covering the blocks run so far.
+    auto writeProfile = [&] {
+      if (!prof.fun)
+        return;
+      for (const char *opt: {"profile", "profile-dot"}) {
+        if (!result.count(opt))
+          continue;
+        std::ofstream out(result[opt].as<std::string>());
+        if (!out)
+          throw std::runtime_error("Could not write " + result[opt].as<std::string>());
+        if (std::string(opt) == "profile")
+          writeProfileJson(prof, out);
+        else
+          writeProfileDot(prof, out);
+      }
+    };
+    try {
+      interp.run(mainFunc, symBindings, result["dump-trace"].as<bool>());
+    } catch (...) {
+      writeProfile();
+      throw;
+    }
+    writeProfile();
 
   } catch (const UndefinedBehaviorError &e) {
     std::cerr << e.what() << "\n";
@@ -130,6 +648,9 @@ int main(int argc, char **argv) {
   } catch (const RequireViolationError &e) {
     std::cerr << "Requirement failed: " << e.what() << "\n";
     return ExitCode::RequireViolation;
+  } catch (const BudgetExhaustedError &e) {
+    std::cerr << e.what() << "\n";
+    return ExitCode::BudgetExhausted;
   } catch (const LexError &e) {
     printMessage(std::cerr, src, e.span, e.what(), DiagLevel::Error);
     return ExitCode::LexError;
@@ -1,22 +1,46 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "analysis/transforms.hpp"
 #include "ast/ast_dumper.hpp"
 #include "ast/sir_printer.hpp"
 #include "cxxopts.hpp"
 #include "error.hpp"
 #include "frontend/lexer.hpp"
+#include "frontend/module_cache.hpp"
 #include "frontend/parser.hpp"
 #include "frontend/semchecker.hpp"
+#include "frontend/server.hpp"
+#include "frontend/source_buffer.hpp"
 #include "frontend/typechecker.hpp"
+#include "json.hpp"
+#include "solver/model_pool.hpp"
+#include "solver/portfolio.hpp"
+#include "solver/smt2.hpp"
+#include "solver/smt2_spool.hpp"
 #include "solver/solver.hpp"
+#include "solver/solver_stats.hpp"
+#include "solver/work_pool.hpp"
+#include "timing.hpp"
 #if defined(USE_ALIVESMT)
 #include "solver/alive_impl.hpp"
-#elif defined(USE_BITWUZLA)
+#endif
+#if defined(USE_BITWUZLA)
 #include "solver/bitwuzla_impl.hpp"
 #endif
 
@@ -32,6 +56,427 @@ std::vector<std::string> split(const std::string &s, char delimiter) {
   return tokens;
 }
 
+// Writes what `print` prints to `out`. With `optimize` the printed,
+// concretized program is checked again and run through the optimization
+// passes first; should it not check, it is written as printed.
+static void writeSir(
+    std::ostream &out, const std::function<void(std::ostream &)> &print, bool optimize
+) {
+  if (!optimize) {
+    print(out);
+    return;
+  }
+  std::ostringstream text;
+  print(text);
+  std::string src = text.str();
+  try {
+    timing::Scope timer("optimize");
+    Lexer lx(src);
+    Parser ps(lx);
+    Program prog = ps.parseProgram();
+    DiagBag diags;
+    PassManager pm(diags);
+    pm.addModulePass(std::make_unique<SemChecker>());
+    pm.addModulePass(std::make_unique<TypeChecker>());
+    addOptimizationPasses(pm);
+    if (pm.run(prog) == PassResult::Success) {
+      SIRPrinter(out).print(prog);
+      return;
+    }
+  } catch (const ParseError &) {
+  }
+  out << src;
+}
+
+#if defined(USE_BITWUZLA)
+static symir::solver::BitwuzlaSolver::Options
+bitwuzlaOptions(const SymbolicExecutor::Config &cfg) {
+  return {
+      cfg.timeout_ms, cfg.seed, cfg.num_smt_threads, cfg.bitwuzla_preprocess,
+      cfg.bitwuzla_rewrite_level, cfg.max_memory_mb
+  };
+}
+#endif
+
+static std::unique_ptr<smt::ISolver> makeBackend(const SymbolicExecutor::Config &cfg) {
+#if defined(USE_ALIVESMT) && defined(USE_BITWUZLA)
+  if (cfg.portfolio) {
+    std::vector<symir::solver::PortfolioSolver::Member> members;
+    members.push_back(
+        {"bitwuzla", std::make_unique<symir::solver::BitwuzlaSolver>(bitwuzlaOptions(cfg))}
+    );
+    members.push_back(
+        {"z3", std::make_unique<symir::solver::AliveSolver>(
+                   cfg.timeout_ms, cfg.seed, cfg.num_smt_threads, cfg.max_memory_mb
+               )}
+    );
+    return std::make_unique<symir::solver::PortfolioSolver>(std::move(members));
+  }
+#endif
+#if defined(USE_ALIVESMT)
+  return std::make_unique<symir::solver::AliveSolver>(
+      cfg.timeout_ms, cfg.seed, cfg.num_smt_threads, cfg.max_memory_mb
+  );
+#elif defined(USE_BITWUZLA)
+  return std::make_unique<symir::solver::BitwuzlaSolver>(bitwuzlaOptions(cfg));
+#else
+  (void) cfg;
+  throw std::runtime_error("No solver backend available");
+#endif
+}
+
+// --- Batch mode (--batch) ---
+
+namespace {
+
+  // The passes every job's module is checked by.
+  void checkPipeline(PassManager &pm) {
+    pm.addModulePass(std::make_unique<SemChecker>());
+    pm.addModulePass(std::make_unique<TypeChecker>());
+  }
+
+  struct BatchJob {
+    std::size_t line = 0;
+    std::string id; // JSON text of the job's "id", echoed back
+    std::string input;
+    std::string source; // module text instead of an input file (server requests)
+    std::string funcName;
+    std::vector<std::string> path;
+    std::optional<uint32_t> sample;
+    uint32_t maxPathLen = 100;
+    bool requireTerminal = false;
+    std::optional<uint32_t> seed;
+    uint32_t deadlineMs = 0; // 0 = none
+    std::unordered_map<std::string, int64_t> fixedSyms;
+  };
+
+  BatchJob parseJob(const json::Value &v, const BatchJob &defaults) {
+    if (!v.isObject())
+      throw std::runtime_error("job is not a JSON object");
+    BatchJob job = defaults;
+    if (auto *id = v.find("id")) {
+      if (id->isString())
+        job.id = json::quote(id->text);
+      else if (id->isNumber())
+        job.id = id->text;
+      else
+        throw std::runtime_error("\"id\" must be a string or a number");
+    }
+    if (auto *input = v.find("input"))
+      job.input = input->asString();
+    else if (auto *source = v.find("source"))
+      job.source = source->asString();
+    else
+      throw std::runtime_error("job has no \"input\"");
+    if (auto *m = v.find("main"))
+      job.funcName = m->asString();
+    if (auto *p = v.find("path")) {
+      if (p->isArray()) {
+        for (const auto &label: p->items)
+          job.path.push_back(label.asString());
+      } else {
+        job.path = split(p->asString(), ',');
+      }
+    }
+    if (auto *n = v.find("sample"))
+      job.sample = static_cast<uint32_t>(n->asInt64());
+    if (auto *n = v.find("max_path_len"))
+      job.maxPathLen = static_cast<uint32_t>(n->asInt64());
+    if (auto *b = v.find("require_terminal"))
+      job.requireTerminal = b->asBool();
+    if (auto *n = v.find("seed"))
+      job.seed = static_cast<uint32_t>(n->asInt64());
+    if (auto *n = v.find("deadline_ms"))
+      job.deadlineMs = static_cast<uint32_t>(n->asInt64());
+    if (auto *syms = v.find("syms")) {
+      if (!syms->isObject())
+        throw std::runtime_error("\"syms\" must be an object");
+      for (const auto &[name, val]: syms->members)
+        job.fixedSyms[name] = val.asInt64();
+    }
+    if (job.path.empty() && !job.sample)
+      throw std::runtime_error("job needs a \"path\" or a \"sample\" count");
+    return job;
+  }
+
+  std::string jsonModelValue(const SymbolicExecutor::Result::ModelVal &val) {
+    if (std::holds_alternative<int64_t>(val))
+      return std::to_string(std::get<int64_t>(val));
+    double d = std::get<double>(val);
+    if (std::isnan(d))
+      return "\"nan\"";
+    if (std::isinf(d))
+      return d > 0 ? "\"inf\"" : "\"-inf\"";
+    std::ostringstream os;
+    os << std::setprecision(17) << d;
+    return os.str();
+  }
+
+  // The "result", "model", "vec_model", "message" and "time_ms" members of
+  // the JSON answer to a job, each after a comma.
+  void writeResultMembers(std::ostream &os, const SymbolicExecutor::Result *res, double ms) {
+    os << ",\"result\":\"" << (res->sat ? "sat" : res->unsat ? "unsat" : "unknown") << "\"";
+    if (res->sat) {
+      os << ",\"model\":{";
+      bool first = true;
+      for (const auto &[name, val]: std::map(res->model.begin(), res->model.end())) {
+        os << (first ? "" : ",") << json::quote(name) << ":" << jsonModelValue(val);
+        first = false;
+      }
+      os << "}";
+      if (!res->vecModel.empty()) {
+        os << ",\"vec_model\":{";
+        first = true;
+        for (const auto &[name, lanes]: std::map(res->vecModel.begin(), res->vecModel.end())) {
+          os << (first ? "" : ",") << json::quote(name) << ":[";
+          for (std::size_t l = 0; l < lanes.size(); ++l)
+            os << (l ? "," : "") << jsonModelValue(lanes[l]);
+          os << "]";
+          first = false;
+        }
+        os << "}";
+      }
+    }
+    if (!res->message.empty())
+      os << ",\"message\":" << json::quote(res->message);
+    os << ",\"time_ms\":" << std::fixed << std::setprecision(3) << ms;
+  }
+
+  // The JSON result line of a job; `res` is null if the job failed with
+  // `error`.
+  std::string batchResultLine(
+      const BatchJob &job, const SymbolicExecutor::Result *res, const std::string &error,
+      double ms
+  ) {
+    std::ostringstream os;
+    os << "{\"line\":" << job.line;
+    if (!job.id.empty())
+      os << ",\"id\":" << job.id;
+    if (!job.input.empty())
+      os << ",\"input\":" << json::quote(job.input) << ",\"main\":" << json::quote(job.funcName);
+    if (!res) {
+      os << ",\"result\":\"error\",\"message\":" << json::quote(error) << "}";
+      return os.str();
+    }
+    writeResultMembers(os, res, ms);
+    os << "}";
+    return os.str();
+  }
+
+  // Solves or samples `job` on `module` with one executor of its own. A
+  // job still running when its deadline passes has its check interrupted
+  // and answers UNKNOWN.
+  SymbolicExecutor::Result runJob(
+      const LoadedModule &module, const BatchJob &job, const SymbolicExecutor::Config &jobConfig,
+      const SymbolicExecutor::SolverFactory &factory, std::string label
+  ) {
+    symir::solver::Cancellation cancel;
+    if (job.deadlineMs)
+      cancel.cancelAt(
+          symir::solver::Cancellation::Clock::now() + std::chrono::milliseconds(job.deadlineMs)
+      );
+    SymbolicExecutor::Config cfg = jobConfig;
+    cfg.analyses = &module.analyses;
+    if (job.seed)
+      cfg.seed = *job.seed;
+    cfg.stats_label = std::move(label);
+    cfg.cancel = &cancel;
+    SymbolicExecutor executor(module.prog, cfg, factory);
+    SymbolicExecutor::Result res =
+        job.sample ? executor.sample(
+                         job.funcName, *job.sample, job.maxPathLen, job.requireTerminal, job.path,
+                         job.fixedSyms
+                     )
+                   : executor.solve(job.funcName, job.path, job.fixedSyms);
+    if (cancel.cancelled() && !res.sat && !res.unsat && res.message.empty())
+      res.message = "deadline passed";
+    return res;
+  }
+
+  // Reads one job per line from `jobsPath` ("-" for stdin) and streams one
+  // JSON result line per job to stdout as soon as it is done. Jobs run on
+  // config.num_threads workers, each job single-threaded.
+  int runBatch(
+      const std::string &jobsPath, const SymbolicExecutor::Config &config,
+      const BatchJob &defaults, const SymbolicExecutor::SolverFactory &factory,
+      const ModuleCache *moduleCache
+  ) {
+    std::ifstream file;
+    if (jobsPath != "-") {
+      file.open(jobsPath);
+      if (!file) {
+        std::cerr << "Error: Could not open batch file " << jobsPath << std::endl;
+        return ExitCode::Error;
+      }
+    }
+    std::istream &in = jobsPath == "-" ? std::cin : file;
+
+    ModuleStore programs(checkPipeline, moduleCache);
+    std::mutex outMu;
+    auto emit = [&](const std::string &line) {
+      std::lock_guard<std::mutex> lock(outMu);
+      std::cout << line << '\n' << std::flush;
+    };
+
+    SymbolicExecutor::Config jobConfig = config;
+    jobConfig.num_threads = 1;
+    jobConfig.pool = nullptr;
+
+    symir::solver::WorkPool pool(std::max<uint32_t>(config.num_threads, 1));
+    symir::solver::WorkPool::Group jobs;
+    std::string text;
+    for (std::size_t lineNo = 1; std::getline(in, text); ++lineNo) {
+      if (text.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+      BatchJob job;
+      try {
+        job = parseJob(json::parse(text), defaults);
+      } catch (const std::exception &e) {
+        BatchJob bad;
+        bad.line = lineNo;
+        emit(batchResultLine(bad, nullptr, e.what(), 0));
+        continue;
+      }
+      job.line = lineNo;
+      pool.submit(jobs, [&, job = std::move(job)](unsigned) {
+        auto lp = job.input.empty() ? programs.getSource(job.source) : programs.get(job.input);
+        SymbolTable::Scope symbols(lp->symbols);
+        if (!lp->error.empty()) {
+          emit(batchResultLine(job, nullptr, lp->error, 0));
+          return;
+        }
+        // Stats calls are labelled with the job's id, or its line.
+        std::string label;
+        if (job.id.empty())
+          label = "line " + std::to_string(job.line);
+        else if (job.id.front() == '"')
+          label = json::parse(job.id).asString();
+        else
+          label = job.id;
+        auto start = std::chrono::steady_clock::now();
+        try {
+          SymbolicExecutor::Result res = runJob(*lp, job, jobConfig, factory, std::move(label));
+          std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+          emit(batchResultLine(job, &res, "", ms.count()));
+        } catch (const std::exception &e) {
+          emit(batchResultLine(job, nullptr, e.what(), 0));
+        }
+      });
+    }
+    pool.wait(jobs);
+    return ExitCode::Success;
+  }
+
+  // --- Server mode (--serve) ---
+
+  // Answers `solve` and `sample` requests, whose params are those of a
+  // batch job, on config.num_threads workers until a `shutdown`. Modules
+  // stay checked between requests; `where` is "-" for stdin/stdout, or the
+  // path of a Unix socket.
+  int runServer(
+      const std::string &where, const SymbolicExecutor::Config &config, const BatchJob &defaults,
+      const SymbolicExecutor::SolverFactory &factory, const ModuleCache *moduleCache
+  ) {
+    ModuleStore modules(checkPipeline, moduleCache);
+    SymbolicExecutor::Config jobConfig = config;
+    jobConfig.num_threads = 1;
+    jobConfig.pool = nullptr;
+    RpcServer server("symirsolve", std::max<uint32_t>(config.num_threads, 1));
+    addModuleMethods(server, modules);
+
+    auto answer = [&](const json::Value &params, const BatchJob &jobDefaults) {
+      BatchJob job;
+      try {
+        job = parseJob(params, jobDefaults);
+      } catch (const std::exception &e) {
+        throw RpcServer::Error(RpcServer::kInvalidParams, e.what());
+      }
+      auto lp = requestModule(modules, params);
+      SymbolTable::Scope symbols(lp->symbols);
+      // Stats calls are labelled with the module and the function.
+      std::string label = (job.input.empty() ? "source" : job.input) + " " + job.funcName;
+      auto start = std::chrono::steady_clock::now();
+      SymbolicExecutor::Result res = runJob(*lp, job, jobConfig, factory, std::move(label));
+      std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+      std::ostringstream os;
+      os << "{\"main\":" << json::quote(job.funcName);
+      writeResultMembers(os, &res, ms.count());
+      os << "}";
+      return os.str();
+    };
+    server.on("solve", [&](const json::Value &params) {
+      if (params.find("sample"))
+        throw RpcServer::Error(RpcServer::kInvalidParams, "solve takes no \"sample\"; use sample");
+      return answer(params, defaults);
+    });
+    BatchJob sampleDefaults = defaults;
+    sampleDefaults.sample = 1;
+    server.on("sample", [&](const json::Value &params) { return answer(params, sampleDefaults); });
+
+#if defined(USE_ALIVESMT)
+    // The Z3 context lives as long as some AliveSolver does; one that lives
+    // as long as the server keeps it from being torn down between requests.
+    auto warm = makeBackend(config);
+#endif
+    return where == "-" ? server.serveStdio() : server.serveUnix(where);
+  }
+
+  // --- All functions (--all-functions) ---
+
+  struct FunctionOutcome {
+    SymbolicExecutor::Result res;
+    std::string error; // set if sampling threw
+  };
+
+  // Samples every function of `prog` as one task of a pool of
+  // config.num_threads workers. The syms of different functions are
+  // independent, so all tasks share one executor, each sampling
+  // single-threaded.
+  std::vector<FunctionOutcome> sampleAllFunctions(
+      const Program &prog, const SymbolicExecutor::Config &config,
+      const SymbolicExecutor::SolverFactory &factory, uint32_t numSamples, uint32_t maxPathLen,
+      bool requireTerminal, const std::unordered_map<std::string, int64_t> &fixedSyms
+  ) {
+    SymbolicExecutor::Config funConfig = config;
+    funConfig.num_threads = 1;
+    funConfig.pool = nullptr;
+    SymbolicExecutor executor(prog, funConfig, factory);
+
+    std::vector<FunctionOutcome> outcomes(prog.funs.size());
+    symir::solver::WorkPool pool(std::max<uint32_t>(config.num_threads, 1));
+    pool.forEach(prog.funs.size(), [&](unsigned, std::size_t i) {
+      try {
+        outcomes[i].res = executor.sample(
+            prog.funs[i].name.name, numSamples, maxPathLen, requireTerminal, {}, fixedSyms
+        );
+      } catch (const std::exception &e) {
+        outcomes[i].error = e.what();
+      }
+    });
+    return outcomes;
+  }
+
+  void writeModelJson(
+      std::ostream &out,
+      const std::vector<std::pair<std::string, const SymbolicExecutor::Result *>> &funs
+  ) {
+    out << "{\n";
+    for (std::size_t f = 0; f < funs.size(); ++f) {
+      out << "  \"" << funs[f].first << "\": {\n";
+      bool first = true;
+      for (const auto &[name, val]: funs[f].second->model) {
+        if (!first)
+          out << ",\n";
+        out << "    \"" << name << "\": " << jsonModelValue(val);
+        first = false;
+      }
+      out << "\n  }" << (f + 1 < funs.size() ? "," : "") << "\n";
+    }
+    out << "}\n";
+  }
+
+} // namespace
+
 int main(int argc, char **argv) {
   cxxopts::Options options("symirsolve", "SymIR SMT-based Concretizer");
 
@@ -39,18 +484,64 @@ int main(int argc, char **argv) {
   options.add_options()
     ("input", "Input .sir file", cxxopts::value<std::string>())
     ("main", "Function to concretize", cxxopts::value<std::string>()->default_value("@main"))
+    ("all-functions", "With --sample: concretize every function, sampling them concurrently on --num-threads threads", cxxopts::value<bool>()->default_value("false"))
     ("path", "Comma-separated block labels for execution path (acts as prefix if --sample is used)", cxxopts::value<std::string>())
     ("sample", "Number of paths to sample randomly", cxxopts::value<uint32_t>())
     ("max-path-len", "Maximum random path length", cxxopts::value<uint32_t>()->default_value("100"))
+    ("num-models", "With --path: find up to this many distinct models of the path", cxxopts::value<uint32_t>())
+    ("project", "With --num-models: comma-separated syms the models must differ in (default: all)", cxxopts::value<std::string>())
+    ("enumerate", "Enumerate paths depth-first, uncovered blocks/edges first, and report coverage", cxxopts::value<bool>()->default_value("false"))
+    ("unroll", "With --enumerate: times one path may take each back edge", cxxopts::value<uint32_t>()->default_value("4"))
+    ("concolic", "Run concrete inputs and solve for flips of their branches (generational search), and report coverage", cxxopts::value<bool>()->default_value("false"))
+    ("concolic-runs", "With --concolic: concrete runs (0 = no limit)", cxxopts::value<uint32_t>()->default_value("100"))
+    ("coverage-target", "With --enumerate or --concolic: stop at this percentage of blocks and edges covered", cxxopts::value<uint32_t>()->default_value("100"))
+    ("enum-budget-ms", "With --enumerate or --concolic: stop after this many milliseconds (0 = no limit)", cxxopts::value<uint32_t>()->default_value("0"))
     ("require-terminal", "Force paths to reach 'ret' by appending shortest path if needed", cxxopts::value<bool>()->default_value("false"))
+    ("incremental", "Reuse one solver per worker across sampled paths, re-encoding only the differing suffix", cxxopts::value<bool>()->default_value("false"))
+    ("online", "Sample feasible paths only: check each branch edge as the random walk takes it", cxxopts::value<bool>()->default_value("false"))
+    ("nogoods", "Learn infeasible path prefixes from UNSAT cores and avoid them in later samples", cxxopts::value<bool>()->default_value("false"))
+    ("slice", "Solve independent groups of constraints (disjoint symbols) separately", cxxopts::value<bool>()->default_value("false"))
+    ("merge-joins", "Encode both arms of branches that reconverge and merge the state at the join", cxxopts::value<bool>()->default_value("false"))
+    ("ssa", "Encode paths over the SSA form of scalar locals: one definition per SSA value", cxxopts::value<bool>()->default_value("false"))
+    ("lazy-fp", "Solve with FP arithmetic abstracted first, refining the ops a model gets wrong", cxxopts::value<bool>()->default_value("false"))
+    ("lazy-fp-rounds", "With --lazy-fp: refinement rounds before every FP op is fully encoded", cxxopts::value<uint32_t>()->default_value("4"))
+    ("no-term-builder", "Pass terms straight to the backend (no hash-consing/constant folding)", cxxopts::value<bool>()->default_value("false"))
+    ("no-points-to", "Dispatch loads and stores over every same-typed local (no points-to narrowing)", cxxopts::value<bool>()->default_value("false"))
+    ("no-intervals", "Skip the interval pre-pass that refutes paths and narrows sym ranges before solving", cxxopts::value<bool>()->default_value("false"))
+    ("no-guard-dedup", "Assert every UB guard as encoded, duplicates included", cxxopts::value<bool>()->default_value("false"))
+    ("no-narrow-pointers", "Encode pointers as 64-bit tags instead of the least width per function", cxxopts::value<bool>()->default_value("false"))
+    ("no-narrow-syms", "Encode syms with small domains at the full width of their type", cxxopts::value<bool>()->default_value("false"))
+    ("prefix-cache-mb", "Cache symbolic state per sampled path prefix, up to this many MiB (0 = off)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("array-encoding", "Encoding of scalar arrays: auto, ite or smt-array", cxxopts::value<std::string>()->default_value("auto"))
+    ("array-threshold", "Minimum array size encoded as an SMT array under --array-encoding=auto", cxxopts::value<uint32_t>()->default_value("64"))
+    ("max-memory-mb", "Memory budget of one query in MiB; over it, retry with SMT arrays, then answer UNKNOWN (0 = none)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("query-cache", "Directory of a persistent cache of solver answers, shared across runs and processes", cxxopts::value<std::string>())
+    ("cache-dir", "Directory of checked modules to load instead of re-checking, shared across runs and tools", cxxopts::value<std::string>())
+    ("replay-models", "Before solving a path, run it concretely under this many recent SAT models of the function (0 = off)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("portfolio", "Race every built-in backend (Bitwuzla, Z3) on each check; the first answer wins", cxxopts::value<bool>()->default_value("false"))
     ("o,output", "Output .sir file", cxxopts::value<std::string>())
+    ("O,optimize", "Fold the constants the model leaves and drop dead stores and branches in the output .sir", cxxopts::value<bool>()->default_value("false"))
     ("dump-ast", "Dump concretized AST to stdout", cxxopts::value<bool>()->default_value("false"))
     ("timeout-ms", "Solver timeout in milliseconds", cxxopts::value<uint32_t>()->default_value("0"))
+    ("time-budget-ms", "Sampling: stop after this many ms, checking every path with a short timeout first and retrying UNKNOWN paths with growing timeouts (0 = off)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("initial-timeout-ms", "Sampling with --time-budget-ms: timeout of the first check of each path", cxxopts::value<uint32_t>()->default_value("100"))
     ("seed", "Solver seed", cxxopts::value<uint32_t>()->default_value("0"))
-    ("j,num-threads", "Number of threads for parallel solving (0 = hardware concurrency)", cxxopts::value<uint32_t>()->default_value("1"))
+    ("j,num-threads", "Number of threads for checking functions and parallel solving (0 = hardware concurrency)", cxxopts::value<uint32_t>()->default_value("1"))
     ("num-smt-threads", "Number of threads for the SMT solver backend (Bitwuzla/Z3 internal parallelism)", cxxopts::value<uint32_t>()->default_value("1"))
+    ("no-bitwuzla-preprocess", "Bitwuzla: skip the preprocessing passes before solving", cxxopts::value<bool>()->default_value("false"))
+    ("bitwuzla-rewrite-level", "Bitwuzla: term rewrite level, 0 (off) to 2 (full)", cxxopts::value<uint32_t>()->default_value("2"))
     ("emit-model", "Emit symbol assignments to a JSON-like file", cxxopts::value<std::string>())
     ("sym", "Fix a symbol to a value (name=val)", cxxopts::value<std::vector<std::string>>())
+    ("batch", "Run the jobs in this JSON-lines file ('-' = stdin), streaming one JSON result per line", cxxopts::value<std::string>())
+    ("serve", "Answer JSON-RPC solve/sample requests on stdin/stdout, or (--serve=PATH) on a Unix socket, keeping modules checked", cxxopts::value<std::string>()->implicit_value("-"))
+    ("deadline-ms", "With --batch or --serve: answer UNKNOWN to a job not done this many ms after it starts, interrupting its check (0 = none)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("emit-smt2", "Write every solver query as an SMT-LIB2 file into this directory (solved locally)", cxxopts::value<std::string>())
+    ("remote", "Send solver queries as SMT-LIB2 files to --worker processes sharing this directory", cxxopts::value<std::string>())
+    ("worker", "Answer the SMT-LIB2 queries that appear in this directory until killed (no input needed)", cxxopts::value<std::string>())
+    ("worker-idle-ms", "With --worker: exit after this many ms without queries (0 = never)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("stats", "Write per-query solver statistics (encoding/solving time, term counts) as JSON to this file", cxxopts::value<std::string>())
+    ("time-passes", "Print the time of each phase and pass, and the peak RSS, to stderr", cxxopts::value<bool>()->default_value("false"))
+    ("time-trace", "Write the phase timings as Chrome trace-event JSON to this file", cxxopts::value<std::string>())
     ("h,help", "Print usage");
   options.parse_positional({"input"});
   // clang-format on
@@ -62,11 +553,228 @@ int main(int argc, char **argv) {
     return 0;
   }
 
-  if (!result.count("input") || (!result.count("path") && !result.count("sample"))) {
-    std::cerr << "Error: input and either --path or --sample are required." << std::endl;
+  timing::Session timingSession(
+      result["time-passes"].as<bool>(),
+      result.count("time-trace") ? result["time-trace"].as<std::string>() : std::string()
+  );
+
+  bool batch = result.count("batch") > 0;
+  bool worker = result.count("worker") > 0;
+  bool serve = result.count("serve") > 0;
+  bool enumerate = result["enumerate"].as<bool>();
+  bool concolic = result["concolic"].as<bool>();
+  if (!batch && !worker && !serve &&
+      (!result.count("input") ||
+       (!result.count("path") && !result.count("sample") && !enumerate && !concolic))) {
+    std::cerr << "Error: input and one of --path, --sample, --enumerate or --concolic (or "
+                 "--batch, --serve or --worker) are required."
+              << std::endl;
     std::cerr << options.help() << std::endl;
     return 1;
   }
+  if (concolic && (enumerate || result.count("path") || result.count("sample"))) {
+    std::cerr << "Error: --concolic cannot be combined with --path, --sample or --enumerate."
+              << std::endl;
+    return 1;
+  }
+  if (batch + worker + serve > 1) {
+    std::cerr << "Error: --batch, --serve and --worker cannot be combined." << std::endl;
+    return 1;
+  }
+
+  bool allFunctions = result["all-functions"].as<bool>();
+  if (allFunctions &&
+      (batch || worker || serve || !result.count("sample") || result.count("path") ||
+       result.count("num-models") || enumerate || concolic || result["dump-ast"].as<bool>())) {
+    std::cerr << "Error: --all-functions needs --sample, without --path, --num-models, "
+                 "--enumerate, --concolic, --dump-ast, --batch, --serve or --worker."
+              << std::endl;
+    return 1;
+  }
+
+  uint32_t numModels = result.count("num-models") ? result["num-models"].as<uint32_t>() : 0;
+  if (!batch && !serve && result.count("num-models") &&
+      (!result.count("path") || result.count("sample") || enumerate || numModels == 0)) {
+    std::cerr << "Error: --num-models needs a positive count and --path, without --sample or "
+                 "--enumerate."
+              << std::endl;
+    return 1;
+  }
+
+  SymbolicExecutor::Config config;
+  config.timeout_ms = result["timeout-ms"].as<uint32_t>();
+  config.time_budget_ms = result["time-budget-ms"].as<uint32_t>();
+  config.initial_timeout_ms = result["initial-timeout-ms"].as<uint32_t>();
+  config.seed = result["seed"].as<uint32_t>();
+  config.num_threads = result["num-threads"].as<uint32_t>();
+  config.num_smt_threads = result["num-smt-threads"].as<uint32_t>();
+  config.bitwuzla_preprocess = !result["no-bitwuzla-preprocess"].as<bool>();
+  config.bitwuzla_rewrite_level = result["bitwuzla-rewrite-level"].as<uint32_t>();
+  config.incremental = result["incremental"].as<bool>();
+  config.online_sampling = result["online"].as<bool>();
+  config.learn_nogoods = result["nogoods"].as<bool>();
+  config.slicing = result["slice"].as<bool>();
+  config.ssa = result["ssa"].as<bool>();
+  config.merge_joins = result["merge-joins"].as<bool>();
+  config.lazy_fp = result["lazy-fp"].as<bool>();
+  config.lazy_fp_rounds = result["lazy-fp-rounds"].as<uint32_t>();
+  config.prefix_cache_mb = result["prefix-cache-mb"].as<uint32_t>();
+  config.term_builder = !result["no-term-builder"].as<bool>();
+  config.points_to = !result["no-points-to"].as<bool>();
+  config.intervals = !result["no-intervals"].as<bool>();
+  config.dedup_guards = !result["no-guard-dedup"].as<bool>();
+  config.narrow_pointers = !result["no-narrow-pointers"].as<bool>();
+  config.narrow_syms = !result["no-narrow-syms"].as<bool>();
+  config.portfolio = result["portfolio"].as<bool>();
+  std::unique_ptr<symir::solver::QueryCache> queryCache;
+  if (result.count("query-cache")) {
+    try {
+      queryCache =
+          std::make_unique<symir::solver::QueryCache>(result["query-cache"].as<std::string>());
+    } catch (const std::exception &e) {
+      std::cerr << "Exception: " << e.what() << std::endl;
+      return ExitCode::Error;
+    }
+    config.query_cache = queryCache.get();
+  }
+  std::optional<ModuleCache> moduleCache;
+  if (result.count("cache-dir"))
+    moduleCache.emplace(result["cache-dir"].as<std::string>());
+  std::unique_ptr<symir::solver::ModelPool> modelPool;
+  if (uint32_t n = result["replay-models"].as<uint32_t>()) {
+    modelPool = std::make_unique<symir::solver::ModelPool>(n);
+    config.model_pool = modelPool.get();
+  }
+  std::unique_ptr<symir::solver::SolverStats> stats;
+  if (result.count("stats")) {
+    stats = std::make_unique<symir::solver::SolverStats>();
+    config.stats = stats.get();
+  }
+  auto writeStats = [&]() {
+    if (!stats)
+      return true;
+    std::string statsPath = result["stats"].as<std::string>();
+    std::ofstream sfs(statsPath);
+    if (!sfs) {
+      std::cerr << "Error: Could not open stats file " << statsPath << std::endl;
+      return false;
+    }
+    stats->writeJson(sfs);
+    return true;
+  };
+  config.array_threshold = result["array-threshold"].as<uint32_t>();
+  config.max_memory_mb = result["max-memory-mb"].as<uint32_t>();
+  std::string arrayEncoding = result["array-encoding"].as<std::string>();
+  if (arrayEncoding == "auto") {
+    config.array_encoding = SymbolicExecutor::Config::ArrayEncoding::Auto;
+  } else if (arrayEncoding == "ite") {
+    config.array_encoding = SymbolicExecutor::Config::ArrayEncoding::Ite;
+  } else if (arrayEncoding == "smt-array") {
+    config.array_encoding = SymbolicExecutor::Config::ArrayEncoding::SmtArray;
+  } else {
+    std::cerr << "Error: --array-encoding must be one of auto, ite, smt-array." << std::endl;
+    return 1;
+  }
+  if (config.bitwuzla_rewrite_level > 2) {
+    std::cerr << "Error: --bitwuzla-rewrite-level must be 0, 1 or 2." << std::endl;
+    return 1;
+  }
+
+#if defined(USE_ALIVESMT)
+  // AliveSMT (Z3) uses a global context that is not thread-safe.
+  // Force single-threaded execution for AliveSMT backend, unless the
+  // queries are solved by --remote workers.
+  if (config.num_threads > 1 && !result.count("remote")) {
+    std::cerr << "Warning: AliveSMT backend does not support multi-threading. "
+              << "Forcing single-threaded execution (num_threads=1).\n";
+    config.num_threads = 1;
+  }
+#endif
+
+#if !(defined(USE_ALIVESMT) && defined(USE_BITWUZLA))
+  if (config.portfolio) {
+    std::cerr << "Warning: --portfolio needs both Bitwuzla and AliveSMT (build with "
+              << "SOLVER=both). Using the single built-in backend.\n";
+    config.portfolio = false;
+  }
+#endif
+
+  if (result.count("emit-smt2") && result.count("remote")) {
+    std::cerr << "Error: --emit-smt2 and --remote cannot be combined." << std::endl;
+    return 1;
+  }
+  // --emit-smt2 and --remote encode every query as an SMT-LIB2 script; it is
+  // then solved here (from the script) or by a worker.
+  SymbolicExecutor::SolverFactory factory = makeBackend;
+  std::unique_ptr<symir::solver::Smt2Spool> spool;
+  try {
+    for (const char *opt: {"emit-smt2", "remote", "worker"})
+      if (result.count(opt))
+        spool = std::make_unique<symir::solver::Smt2Spool>(result[opt].as<std::string>());
+  } catch (const std::exception &e) {
+    std::cerr << "Exception: " << e.what() << std::endl;
+    return ExitCode::Error;
+  }
+  using symir::solver::Smt2Solver;
+  if (result.count("emit-smt2")) {
+    factory = [&spool](const SymbolicExecutor::Config &cfg) -> std::unique_ptr<smt::ISolver> {
+      return std::make_unique<Smt2Solver>([&spool, cfg](const std::string &script, const auto &) {
+        spool->write(script);
+        auto backend = makeBackend(cfg);
+        return symir::solver::runSmt2(script, *backend);
+      });
+    };
+  } else if (result.count("remote")) {
+    factory = [&spool](const SymbolicExecutor::Config &) -> std::unique_ptr<smt::ISolver> {
+      return std::make_unique<Smt2Solver>(
+          [&spool](const std::string &script, const std::atomic<bool> &cancel) {
+            return spool->submit(script, cancel);
+          }
+      );
+    };
+  }
+
+  if (worker) {
+    // Each thread serves queries on its own backends.
+    uint32_t n = config.num_threads ? config.num_threads : std::thread::hardware_concurrency();
+    uint32_t idleMs = result["worker-idle-ms"].as<uint32_t>();
+    std::atomic<uint64_t> answered{0};
+    auto serve = [&] {
+      answered += spool->serve([&] { return makeBackend(config); }, idleMs);
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < std::max(n, 1u); ++i)
+      threads.emplace_back(serve);
+    serve();
+    for (auto &t: threads)
+      t.join();
+    std::cerr << "Worker: answered " << answered.load() << " queries\n";
+    return 0;
+  }
+
+  if (batch || serve) {
+    BatchJob defaults;
+    defaults.funcName = result["main"].as<std::string>();
+    defaults.maxPathLen = result["max-path-len"].as<uint32_t>();
+    defaults.requireTerminal = result["require-terminal"].as<bool>();
+    defaults.deadlineMs = result["deadline-ms"].as<uint32_t>();
+    int rc = batch ? runBatch(
+                         result["batch"].as<std::string>(), config, defaults, factory,
+                         moduleCache ? &*moduleCache : nullptr
+                     )
+                   : runServer(
+                         result["serve"].as<std::string>(), config, defaults, factory,
+                         moduleCache ? &*moduleCache : nullptr
+                     );
+    if (queryCache) {
+      auto qs = queryCache->stats();
+      std::cerr << "Query cache: " << qs.hits << " hits, " << qs.misses << " misses, "
+                << qs.stores << " stored\n";
+    }
+    if (!writeStats())
+      return ExitCode::Error;
+    return rc;
+  }
 
   std::string inputPath = result["input"].as<std::string>();
   std::string funcName = result["main"].as<std::string>();
@@ -91,26 +799,28 @@ int main(int argc, char **argv) {
     }
   }
 
-  std::ifstream ifs(inputPath);
-  if (!ifs) {
+  auto input = SourceBuffer::open(inputPath);
+  if (!input) {
     std::cerr << "Error: Could not open file " << inputPath << std::endl;
     return 1;
   }
-  std::stringstream ss;
-  ss << ifs.rdbuf();
-  std::string src = ss.str();
+  std::string_view src = input->text();
 
   try {
-    Lexer lx(src);
-    auto toks = lx.lexAll();
-    Parser ps(std::move(toks));
-    Program prog = ps.parseProgram();
-
+    Program prog;
     DiagBag diags;
     PassManager pm(diags);
+    // Checking does not touch the solver, so it takes -j even under AliveSMT.
+    pm.setNumThreads(result["num-threads"].as<uint32_t>());
     pm.addModulePass(std::make_unique<SemChecker>());
     pm.addModulePass(std::make_unique<TypeChecker>());
-    if (pm.run(prog) == PassResult::Error) {
+    config.analyses = &pm.analyses();
+    PassResult checked;
+    {
+      timing::Scope timer("frontend");
+      checked = parseAndCheck(src, pm, moduleCache ? &*moduleCache : nullptr, prog);
+    }
+    if (checked == PassResult::Error) {
       std::cerr << "Errors in input program:" << std::endl;
       for (const auto &d: diags.diags) {
         if (d.level == DiagLevel::Error)
@@ -119,90 +829,218 @@ int main(int argc, char **argv) {
       return ExitCode::StaticError;
     }
 
-    SymbolicExecutor::Config config;
-    config.timeout_ms = result["timeout-ms"].as<uint32_t>();
-    config.seed = result["seed"].as<uint32_t>();
-    config.num_threads = result["num-threads"].as<uint32_t>();
-    config.num_smt_threads = result["num-smt-threads"].as<uint32_t>();
+    if (allFunctions) {
+      auto outcomes = sampleAllFunctions(
+          prog, config, factory, result["sample"].as<uint32_t>(),
+          result["max-path-len"].as<uint32_t>(), result["require-terminal"].as<bool>(), fixedSyms
+      );
+      if (queryCache) {
+        auto qs = queryCache->stats();
+        std::cerr << "Query cache: " << qs.hits << " hits, " << qs.misses << " misses, "
+                  << qs.stores << " stored\n";
+      }
+      if (!writeStats())
+        return ExitCode::Error;
 
-#if defined(USE_ALIVESMT)
-    // AliveSMT (Z3) uses a global context that is not thread-safe.
-    // Force single-threaded execution for AliveSMT backend.
-    if (config.num_threads > 1) {
-      std::cerr << "Warning: AliveSMT backend does not support multi-threading. "
-                << "Forcing single-threaded execution (num_threads=1).\n";
-      config.num_threads = 1;
-    }
-#endif
+      bool allSat = true;
+      for (std::size_t i = 0; i < outcomes.size(); ++i) {
+        const auto &o = outcomes[i];
+        std::cout << prog.funs[i].name.name << ": ";
+        if (!o.error.empty())
+          std::cout << "ERROR " << o.error;
+        else
+          std::cout << (o.res.sat ? "SAT" : o.res.unsat ? "UNSAT" : "UNKNOWN");
+        std::cout << "\n";
+        allSat &= o.error.empty() && o.res.sat;
+      }
+      if (!allSat) {
+        std::cout << "INCOMPLETE" << std::endl;
+        return 1;
+      }
+      std::cout << "SAT" << std::endl;
 
-    auto solverFactory =
-        [](const SymbolicExecutor::Config &cfg) -> std::unique_ptr<symir::smt::ISolver> {
-#if defined(USE_ALIVESMT)
-      return std::make_unique<symir::solver::AliveSolver>(
-          cfg.timeout_ms, cfg.seed, cfg.num_smt_threads
-      );
-#elif defined(USE_BITWUZLA)
-      return std::make_unique<symir::solver::BitwuzlaSolver>(
-          cfg.timeout_ms, cfg.seed, cfg.num_smt_threads
-      );
-#else
-      (void) cfg;
-      throw std::runtime_error("No solver backend available");
-#endif
-    };
+      if (result.count("emit-model")) {
+        std::ofstream mfs(result["emit-model"].as<std::string>());
+        std::vector<std::pair<std::string, const SymbolicExecutor::Result *>> funs;
+        for (std::size_t i = 0; i < outcomes.size(); ++i)
+          funs.emplace_back(prog.funs[i].name.name, &outcomes[i].res);
+        writeModelJson(mfs, funs);
+      }
+      if (result.count("output")) {
+        std::string file = result["output"].as<std::string>();
+        std::ofstream ofs(file);
+        if (!ofs) {
+          std::cerr << "Error: Could not open output file " << file << std::endl;
+          return 1;
+        }
+        std::unordered_map<std::string, SIRPrinter::FunctionModel> models;
+        for (std::size_t i = 0; i < outcomes.size(); ++i)
+          models[prog.funs[i].name.name] = {outcomes[i].res.model, outcomes[i].res.vecModel};
+        writeSir(
+            ofs,
+            [&](std::ostream &os) {
+              SIRPrinter printer(os, std::move(models));
+              printer.print(prog);
+            },
+            result["optimize"].as<bool>()
+        );
+      }
+      return 0;
+    }
 
-    SymbolicExecutor executor(prog, config, solverFactory);
+    SymbolicExecutor executor(prog, config, factory);
     SymbolicExecutor::Result res;
-    if (result.count("sample")) {
+    std::vector<SymbolicExecutor::Result> models; // --num-models
+    if (enumerate) {
+      SymbolicExecutor::EnumerateOptions opts;
+      opts.maxPathLen = result["max-path-len"].as<uint32_t>();
+      opts.unroll = result["unroll"].as<uint32_t>();
+      opts.coverageTarget = result["coverage-target"].as<uint32_t>();
+      opts.budgetMs = result["enum-budget-ms"].as<uint32_t>();
+      auto er = executor.enumerate(funcName, opts, fixedSyms);
+      std::cout << "Coverage: " << er.coveredBlocks << "/" << er.numBlocks << " blocks, "
+                << er.coveredEdges << "/" << er.numEdges << " edges, " << er.witnesses.size()
+                << " paths, " << er.checks << " solver checks\n";
+      for (const auto &w: er.witnesses) {
+        std::cout << "PATH ";
+        for (std::size_t i = 0; i < w.path.size(); ++i)
+          std::cout << (i ? "," : "") << w.path[i];
+        std::cout << "\n";
+      }
+      for (const auto &label: er.uncovered) {
+        bool unreachable = er.exhaustive && std::find(
+                                                er.unreached.begin(), er.unreached.end(), label
+                                            ) != er.unreached.end();
+        std::cout << (unreachable ? "UNREACHABLE " : "NOT COVERED ") << label << "\n";
+      }
+      // The model of the first path feeds the usual outputs.
+      if (!er.witnesses.empty())
+        res = er.witnesses.front().model;
+      else if (er.exhaustive)
+        res.unsat = true;
+      else
+        res.unknown = true;
+    } else if (concolic) {
+      SymbolicExecutor::ConcolicOptions opts;
+      opts.maxRuns = result["concolic-runs"].as<uint32_t>();
+      opts.maxPathLen = result["max-path-len"].as<uint32_t>();
+      opts.coverageTarget = result["coverage-target"].as<uint32_t>();
+      opts.budgetMs = result["enum-budget-ms"].as<uint32_t>();
+      auto cr = executor.concolic(funcName, opts, fixedSyms);
+      std::cout << "Coverage: " << cr.coveredBlocks << "/" << cr.numBlocks << " blocks, "
+                << cr.coveredEdges << "/" << cr.numEdges << " edges, " << cr.witnesses.size()
+                << " paths, " << cr.runs << " runs, " << cr.checks << " solver checks ("
+                << cr.sat << " SAT)\n";
+      if (cr.divergent)
+        std::cerr << "Warning: " << cr.divergent
+                  << " inputs did not take the branch they were solved for\n";
+      for (const auto &w: cr.witnesses) {
+        std::cout << "PATH ";
+        for (std::size_t i = 0; i < w.path.size(); ++i)
+          std::cout << (i ? "," : "") << w.path[i];
+        std::cout << "\n";
+      }
+      for (const auto &label: cr.uncovered)
+        std::cout << "NOT COVERED " << label << "\n";
+      // The model of the first path feeds the usual outputs.
+      if (!cr.witnesses.empty())
+        res = cr.witnesses.front().model;
+      else
+        res.unknown = true;
+    } else if (result.count("sample")) {
       res = executor.sample(
           funcName, result["sample"].as<uint32_t>(), result["max-path-len"].as<uint32_t>(),
           result["require-terminal"].as<bool>(), path, fixedSyms
       );
+    } else if (numModels > 0) {
+      std::vector<std::string> projection;
+      if (result.count("project"))
+        projection = split(result["project"].as<std::string>(), ',');
+      auto mr = executor.enumerateModels(funcName, path, numModels, fixedSyms, projection);
+      models = std::move(mr.models);
+      for (std::size_t i = 0; i < models.size(); ++i) {
+        // Sorted by name, so runs are easy to compare.
+        std::map<std::string, SymbolicExecutor::Result::ModelVal> sorted(
+            models[i].model.begin(), models[i].model.end()
+        );
+        std::cout << "MODEL " << i + 1 << ":";
+        for (const auto &[name, val]: sorted) {
+          std::cout << " " << name << "=";
+          if (std::holds_alternative<int64_t>(val))
+            std::cout << std::get<int64_t>(val);
+          else
+            std::cout << std::get<double>(val);
+        }
+        std::cout << "\n";
+      }
+      if (!models.empty())
+        res = models.front();
+      else if (mr.exhausted)
+        res.unsat = true;
+      else
+        res.unknown = true;
     } else {
       res = executor.solve(funcName, path, fixedSyms);
     }
+    if (queryCache) {
+      auto qs = queryCache->stats();
+      std::cerr << "Query cache: " << qs.hits << " hits, " << qs.misses << " misses, "
+                << qs.stores << " stored\n";
+    }
+    if (!writeStats())
+      return ExitCode::Error;
 
     if (res.sat) {
       std::cout << "SAT" << std::endl;
 
-      if (result.count("emit-model")) {
-        std::ofstream mfs(result["emit-model"].as<std::string>());
-        mfs << "{\n";
-        mfs << "  \"" << funcName << "\": {\n";
-        bool first = true;
-        for (const auto &[name, val]: res.model) {
-          if (!first)
-            mfs << ",\n";
-          mfs << "    \"" << name << "\": ";
-          if (std::holds_alternative<int64_t>(val))
-            mfs << std::get<int64_t>(val);
-          else
-            mfs << std::get<double>(val);
-          first = false;
+      // With --num-models, every model gets its own files, numbered from 1
+      // before the extension (out.sir -> out.1.sir, out.2.sir, ...).
+      if (models.empty())
+        models.push_back(res);
+      auto outputPath = [&](const std::string &opt, std::size_t i) {
+        std::string file = result[opt].as<std::string>();
+        if (numModels == 0)
+          return file;
+        auto dot = file.find_last_of('.');
+        auto slash = file.find_last_of('/');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+          return file + "." + std::to_string(i + 1);
+        return file.substr(0, dot) + "." + std::to_string(i + 1) + file.substr(dot);
+      };
+
+      for (std::size_t i = 0; i < models.size(); ++i) {
+        const auto &m = models[i];
+        if (result.count("emit-model")) {
+          std::ofstream mfs(outputPath("emit-model", i));
+          writeModelJson(mfs, {{funcName, &m}});
         }
-        mfs << "\n  }\n";
-        mfs << "}\n";
-      }
 
-      if (result["dump-ast"].as<bool>()) {
-        std::unordered_map<std::string, int64_t> intModel;
-        for (const auto &[name, val]: res.model) {
-          if (std::holds_alternative<int64_t>(val))
-            intModel[name] = std::get<int64_t>(val);
+        if (result["dump-ast"].as<bool>()) {
+          std::unordered_map<std::string, int64_t> intModel;
+          for (const auto &[name, val]: m.model) {
+            if (std::holds_alternative<int64_t>(val))
+              intModel[name] = std::get<int64_t>(val);
+          }
+          ASTDumper dumper(std::cout, intModel);
+          dumper.dump(prog);
         }
-        ASTDumper dumper(std::cout, intModel);
-        dumper.dump(prog);
-      }
 
-      if (result.count("output")) {
-        std::ofstream ofs(result["output"].as<std::string>());
-        if (!ofs) {
-          std::cerr << "Error: Could not open output file " << result["output"].as<std::string>()
-                    << std::endl;
-          return 1;
+        if (result.count("output")) {
+          std::string file = outputPath("output", i);
+          std::ofstream ofs(file);
+          if (!ofs) {
+            std::cerr << "Error: Could not open output file " << file << std::endl;
+            return 1;
+          }
+          writeSir(
+              ofs,
+              [&](std::ostream &os) {
+                SIRPrinter printer(os, m.model, m.vecModel);
+                printer.print(prog);
+              },
+              result["optimize"].as<bool>()
+          );
         }
-        SIRPrinter printer(ofs, res.model, res.vecModel);
-        printer.print(prog);
       }
 
     } else if (res.unsat) {
@@ -210,6 +1048,8 @@ int main(int argc, char **argv) {
       return 1;
     } else {
       std::cout << "UNKNOWN" << std::endl;
+      if (!res.message.empty())
+        std::cerr << "Reason: " << res.message << std::endl;
       return 1;
     }
 
@@ -0,0 +1,283 @@
+#include "timing.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "json.hpp"
+
+namespace symir::timing {
+
+  namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Events kept for the trace; later Scopes still count in the report.
+    constexpr std::size_t kMaxEvents = std::size_t(1) << 20;
+
+    struct Entry {
+      std::uint64_t ns = 0;
+      std::uint64_t calls = 0;
+    };
+
+    struct Event {
+      std::string path;
+      std::uint64_t startUs;
+      std::uint64_t durUs;
+      unsigned tid;
+    };
+
+    struct Registry {
+      std::mutex mu;
+      Clock::time_point origin;
+      std::unordered_map<std::string, Entry> entries;
+      std::vector<std::string> order; // paths, in the order first opened
+      std::vector<Event> events;
+      std::size_t droppedEvents = 0;
+      std::map<std::string, std::uint64_t> counters;
+      unsigned nextTid = 0;
+    };
+
+    // Never destroyed: a thread left running at exit may still record.
+    Registry &registry() {
+      static Registry *r = new Registry;
+      return *r;
+    }
+
+    thread_local std::vector<std::string> openPaths; // innermost last
+    thread_local unsigned threadId = UINT_MAX;
+
+    std::string childPath(const char *name) {
+      return openPaths.empty() ? std::string(name) : openPaths.back() + "/" + name;
+    }
+
+    // With the registry locked.
+    Entry &entryOf(Registry &r, const std::string &path) {
+      auto [it, fresh] = r.entries.try_emplace(path);
+      if (fresh)
+        r.order.push_back(path);
+      return it->second;
+    }
+
+    std::string_view leaf(std::string_view path) {
+      auto slash = path.rfind('/');
+      return slash == std::string_view::npos ? path : path.substr(slash + 1);
+    }
+
+    std::string_view parentOf(std::string_view path) {
+      auto slash = path.rfind('/');
+      return slash == std::string_view::npos ? std::string_view() : path.substr(0, slash);
+    }
+
+  } // namespace
+
+  namespace detail {
+
+    void begin(const char *name) {
+      openPaths.push_back(childPath(name));
+      Registry &r = registry();
+      std::lock_guard<std::mutex> lock(r.mu);
+      entryOf(r, openPaths.back());
+    }
+
+    void end(Clock::time_point start) {
+      auto now = Clock::now();
+      std::string path = std::move(openPaths.back());
+      openPaths.pop_back();
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+      Registry &r = registry();
+      std::lock_guard<std::mutex> lock(r.mu);
+      Entry &e = entryOf(r, path);
+      e.ns += static_cast<std::uint64_t>(ns);
+      ++e.calls;
+      if (r.events.size() >= kMaxEvents) {
+        ++r.droppedEvents;
+        return;
+      }
+      if (threadId == UINT_MAX)
+        threadId = r.nextTid++;
+      auto us = [&](Clock::time_point t) {
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(
+            0, std::chrono::duration_cast<std::chrono::microseconds>(t - r.origin).count()
+        ));
+      };
+      r.events.push_back(Event{std::move(path), us(start), us(now) - us(start), threadId});
+    }
+
+  } // namespace detail
+
+  void enable() {
+    Registry &r = registry();
+    {
+      std::lock_guard<std::mutex> lock(r.mu);
+      r.origin = Clock::now();
+    }
+    detail::on.store(true);
+  }
+
+  std::string currentPath() {
+    return enabled() && !openPaths.empty() ? openPaths.back() : std::string();
+  }
+
+  Inherit::Inherit(const std::string &path) {
+    if (!enabled() || path.empty())
+      return;
+    active_ = true;
+    openPaths.push_back(path);
+  }
+
+  Inherit::~Inherit() {
+    if (active_)
+      openPaths.pop_back();
+  }
+
+  void addTime(const char *name, std::uint64_t ns, std::uint64_t calls) {
+    if (!enabled())
+      return;
+    std::string path = childPath(name);
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    Entry &e = entryOf(r, path);
+    e.ns += ns;
+    e.calls += calls;
+  }
+
+  void count(const char *name, std::uint64_t n) {
+    if (!enabled())
+      return;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    r.counters[name] += n;
+  }
+
+  std::map<std::string, Total> totals() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    std::map<std::string, Total> out;
+    for (const auto &[path, e]: r.entries)
+      out[path] = Total{e.ns, e.calls};
+    return out;
+  }
+
+  std::map<std::string, std::uint64_t> counters() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    return r.counters;
+  }
+
+  std::uint64_t peakRssKiB() {
+    rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+      return 0;
+    return static_cast<std::uint64_t>(ru.ru_maxrss); // KiB on Linux
+  }
+
+  void report(std::ostream &out) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+
+    // Children of each path, in the order they were first opened.
+    std::unordered_map<std::string_view, std::vector<std::string_view>> children;
+    std::vector<std::string_view> roots;
+    for (const auto &path: r.order) {
+      std::string_view parent = parentOf(path);
+      if (parent.empty() || !r.entries.count(std::string(parent)))
+        roots.push_back(path);
+      else
+        children[parent].push_back(path);
+    }
+
+    out << "===-------------------------------------------------------------------------===\n"
+        << "  Time report (ms; time on several threads is summed)\n"
+        << "===-------------------------------------------------------------------------===\n"
+        << "       Total        Self      Calls  Name\n";
+    char line[64];
+    auto visit = [&](auto &self, std::string_view path, int depth) -> void {
+      const Entry &e = r.entries.at(std::string(path));
+      std::uint64_t childNs = 0;
+      auto it = children.find(path);
+      if (it != children.end())
+        for (auto c: it->second)
+          childNs += r.entries.at(std::string(c)).ns;
+      double total = static_cast<double>(e.ns) / 1e6;
+      double own = e.ns > childNs ? static_cast<double>(e.ns - childNs) / 1e6 : 0.0;
+      std::snprintf(
+          line, sizeof line, "%12.3f %11.3f %10llu  ", total, own,
+          static_cast<unsigned long long>(e.calls)
+      );
+      out << line << std::string(static_cast<std::size_t>(depth) * 2, ' ') << leaf(path)
+          << "\n";
+      if (it != children.end())
+        for (auto c: it->second)
+          self(self, c, depth + 1);
+    };
+    for (auto root: roots)
+      visit(visit, root, 0);
+
+    if (!r.counters.empty()) {
+      out << "\n  Counters\n";
+      for (const auto &[name, n]: r.counters)
+        out << "  " << name << ": " << n << "\n";
+    }
+    std::snprintf(line, sizeof line, "%.1f", static_cast<double>(peakRssKiB()) / 1024.0);
+    out << "\n  Peak RSS: " << line << " MiB\n";
+  }
+
+  void writeChromeTrace(std::ostream &out) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    auto endUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - r.origin)
+                     .count();
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    auto sep = [&] {
+      if (!first)
+        out << ",\n";
+      first = false;
+    };
+    for (const auto &ev: r.events) {
+      sep();
+      out << "{\"name\":" << json::quote(std::string(leaf(ev.path)))
+          << ",\"cat\":\"symir\",\"ph\":\"X\",\"ts\":" << ev.startUs << ",\"dur\":" << ev.durUs
+          << ",\"pid\":1,\"tid\":" << ev.tid << ",\"args\":{\"path\":" << json::quote(ev.path)
+          << "}}";
+    }
+    sep();
+    out << "{\"name\":\"peak_rss_kib\",\"ph\":\"C\",\"ts\":" << endUs
+        << ",\"pid\":1,\"tid\":0,\"args\":{\"value\":" << peakRssKiB() << "}}";
+    out << "],\n\"displayTimeUnit\":\"ms\",\"otherData\":{";
+    first = true;
+    for (const auto &[name, n]: r.counters) {
+      sep();
+      out << json::quote(name) << ":" << n;
+    }
+    sep();
+    out << "\"dropped_events\":" << r.droppedEvents << "}}\n";
+  }
+
+  Session::Session(bool report, std::string tracePath) :
+      report_(report), tracePath_(std::move(tracePath)) {
+    if (report_ || !tracePath_.empty())
+      enable();
+  }
+
+  Session::~Session() {
+    if (report_)
+      report(std::cerr);
+    if (tracePath_.empty())
+      return;
+    std::ofstream out(tracePath_);
+    if (!out) {
+      std::cerr << "Error: Could not open trace file " << tracePath_ << "\n";
+      return;
+    }
+    writeChromeTrace(out);
+  }
+
+} // namespace symir::timing
@@ -0,0 +1,166 @@
+"""Verify the benchmark driver of `symirc --emit-bench`.
+
+Builds the driver of a small fixture with the host C compiler and runs it
+twice: on generated tuples, where the `require` must reject some of them,
+and on a tuple file, where exactly the one bad tuple must be rejected.
+Then does the same for a fixture indexing an array with a sym, under the
+default --ub-checks and under none, which check no index in the timed
+code: the driver must still reject exactly the out-of-bounds tuples, and
+time the others without faulting. Checks the report lines rather than
+the timings, which vary.
+"""
+
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# A parameter, a sym with a domain, a vector sym in another function, and
+# a require that fails on about half of the generated tuples.
+SIR_FIXTURE = """\
+fun @lanes() : i32 {
+  sym %?v: value <4> i32;
+  let mut %x: <4> i32 = 0;
+^entry:
+  %x = %?v;
+  ret %x[0] + %x[3];
+}
+
+fun @steps(%n: i32) : i64 {
+  sym %?k: value i32 in [1, 4];
+  let mut %i: i32 = 0;
+  let mut %acc: i64 = 0;
+^entry:
+  require %n >= 0, "n non-negative";
+  br ^loop;
+^loop:
+  br %i < %n, ^body, ^done;
+^body:
+  %acc = %acc + 3;
+  %i = %i + %?k;
+  br ^loop;
+^done:
+  ret %acc;
+}
+"""
+
+# A sym index most generated tuples put out of bounds. Nothing in the
+# timed build checks it under the default --ub-checks, nor under none.
+OOB_FIXTURE = """\
+fun @pick() : i32 {
+  sym %?i: value i32;
+  let mut %a: [8] i32 = 7;
+^entry:
+  %a[%?i] = 1;
+  ret %a[%?i];
+}
+"""
+
+# Slot %?i: in bounds, just out, far out (a write there faults).
+OOB_TUPLES = (0, 7, 8, -1, 1 << 30, 3)
+
+# (fixture, entry, symirc flags, tuple file rows (packed), driver runs:
+# (arguments, (kept, rejected) or None for generated tuples)). The slots
+# of @steps are %n, %?v[0..3], %?k; its last tuple fails the require.
+BUILDS = [
+  (SIR_FIXTURE, "steps", [], [struct.pack("<6q", n, 0, 0, 0, 0, 1) for n in (10, 100, -1)],
+   [(["-t", "64"], None), (["-i"], (2, 1))]),
+  (OOB_FIXTURE, "pick", [], [struct.pack("<q", i) for i in OOB_TUPLES],
+   [(["-t", "64"], None), (["-i"], (3, 3))]),
+  (OOB_FIXTURE, "pick", ["--ub-checks", "none"], [struct.pack("<q", i) for i in OOB_TUPLES],
+   [(["-i"], (3, 3))]),
+]
+
+REPORT_RE = re.compile(r"^@(\w+): (\d+) tuples \((\d+) rejected\), 2 x 1000 calls$", re.M)
+STATS_RE = re.compile(r"^ns/call +min [0-9.]+ +median [0-9.]+ +mean [0-9.]+ +max [0-9.]+$", re.M)
+
+
+def run(symirc):
+  cc = os.environ.get("CC") or shutil.which("cc") or shutil.which("gcc")
+  tmp = tempfile.mkdtemp()
+  sir = os.path.join(tmp, "bench.sir")
+  src = os.path.join(tmp, "bench.c")
+  exe = os.path.join(tmp, "bench")
+  tuples = os.path.join(tmp, "tuples.bin")
+
+  start = time.time()
+  print(f"Testing C bench driver via {symirc}...", end=" ", flush=True)
+  failures = []
+  try:
+    for fixture, entry, flags, rows, runs in BUILDS:
+      what = " ".join([f"--emit-bench={entry}"] + flags)
+      with open(sir, "w") as f:
+        f.write(fixture)
+      with open(tuples, "wb") as f:
+        f.write(b"".join(rows))
+      r = subprocess.run(
+        [symirc, sir, "-w", f"--emit-bench={entry}", "-o", src] + flags,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )
+      if r.returncode != 0:
+        failures.append(f"symirc {what} failed:\n{r.stderr}")
+        continue
+      if cc is None:
+        failures.append("no C compiler found (set CC)")
+        break
+      r = subprocess.run(
+        [cc, "-std=c99", "-O2", "-w", src, "-o", exe, "-lm"],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )
+      if r.returncode != 0:
+        failures.append(f"{cc} failed on {what}:\n{r.stderr}")
+        continue
+      for args, want in runs:
+        if args == ["-i"]:
+          args = ["-i", tuples]
+        r = subprocess.run(
+          [exe, "-n", "1000", "-r", "2", "-w", "10"] + args,
+          stdout=subprocess.PIPE,
+          stderr=subprocess.PIPE,
+          text=True,
+          timeout=60,
+        )
+        report = REPORT_RE.search(r.stdout)
+        if r.returncode != 0 or not report or not STATS_RE.search(r.stdout):
+          failures.append(f"{what} driver {' '.join(args)}: exit {r.returncode}\n{r.stdout}{r.stderr}")
+          continue
+        kept, rejected = int(report.group(2)), int(report.group(3))
+        if report.group(1) != entry:
+          failures.append(f"{what}: the driver times @{report.group(1)}")
+        if want is None and (kept + rejected != 64 or kept == 0 or rejected == 0):
+          failures.append(f"{what} generated tuples: {kept} kept, {rejected} rejected")
+        if want is not None and (kept, rejected) != want:
+          failures.append(f"{what} tuple file: {kept} kept, {rejected} rejected; expected {want}")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('C bench driver checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirc = sys.argv[1]
+  else:
+    symirc = os.path.join(CWD, "symirc")
+  sys.exit(run(symirc))
@@ -0,0 +1,166 @@
+"""Verify the specialized C output of `symirc --specialize`.
+
+Compiles a small fixture twice, with a model file and with ranges only,
+and checks the C text (which syms stay externs, which arm and bounds
+checks are gone) and the value the program computes, built with the host
+C compiler. A model naming a sym the program lacks must be rejected.
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# With %?n = 7 the ^big arm is dead; %i stays in [0, 3] in ^body, so the
+# lane read and the ptrindex need no bounds check, nor does %v[%?k] (the
+# domain of %?k) even when %?k is not compiled in. Returns 23.
+SIR_FIXTURE = """\
+fun @main() : i32 {
+  sym %?n: value i32 in [0, 100];
+  sym %?k: value i32 in [0, 3];
+  let mut %arr: [4] i32 = {1, 2, 3, 4};
+  let %p: ptr [4] i32 = addr %arr;
+  let %v: <4> i32 = {1, 2, 3, 4};
+  let mut %q: ptr i32 = null;
+  let mut %i: i32 = 0;
+  let mut %acc: i32 = 0;
+^entry:
+  br %?n > 50, ^big, ^small;
+^big:
+  %acc = 1000;
+  br ^loop;
+^small:
+  assume %?n >= 1;
+  br ^loop;
+^loop:
+  br %i < 4, ^body, ^done;
+^body:
+  %acc = %acc + %v[%i];
+  %q = ptrindex %p, %i;
+  %acc = %acc + load %q;
+  %i = %i + 1;
+  br ^loop;
+^done:
+  ret %acc + %v[%?k];
+}
+"""
+
+MODEL = {"@main": {"%?n": 7, "%?k": 2}}
+
+# Linked with each build; the sym accessors are only called when the
+# syms stay externs.
+DRIVER = """\
+#include <stdint.h>
+#include <stdio.h>
+int32_t main__n(void) { return 7; }
+int32_t main__k(void) { return 2; }
+int32_t symir_main(void);
+int main(void) {
+  printf("%d\\n", symir_main());
+  return 0;
+}
+"""
+
+
+def run(symirc):
+  cc = os.environ.get("CC") or shutil.which("cc") or shutil.which("gcc")
+  tmp = tempfile.mkdtemp()
+  sir = os.path.join(tmp, "spec.sir")
+  model = os.path.join(tmp, "model.json")
+  bad_model = os.path.join(tmp, "bad.json")
+  driver = os.path.join(tmp, "driver.c")
+  with open(sir, "w") as f:
+    f.write(SIR_FIXTURE)
+  with open(model, "w") as f:
+    json.dump(MODEL, f)
+  with open(bad_model, "w") as f:
+    json.dump({"@main": {"%?m": 1}}, f)
+  with open(driver, "w") as f:
+    f.write(DRIVER)
+
+  # (flag, strings the C must contain, strings it must not)
+  builds = [
+    (
+      f"--specialize={model}",
+      ["goto symir_small;", "__builtin_unreachable()"],
+      ["extern", "symir_big:", "_vi", "_ii < 0"],
+    ),
+    ("--specialize", ["extern int32_t main__n(void);", "symir_big:"], ["_vi", "_ii < 0"]),
+  ]
+
+  start = time.time()
+  print(f"Testing C specialization via {symirc}...", end=" ", flush=True)
+  failures = []
+  try:
+    for flag, want, unwanted in builds:
+      src = os.path.join(tmp, "spec.c")
+      exe = os.path.join(tmp, "spec")
+      r = subprocess.run(
+        [symirc, sir, "-w", flag, "-o", src],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )
+      if r.returncode != 0:
+        failures.append(f"symirc {flag} failed:\n{r.stderr}")
+        continue
+      with open(src) as f:
+        text = f.read()
+      for s in want:
+        if s not in text:
+          failures.append(f"{flag}: output lacks {s!r}")
+      for s in unwanted:
+        if s in text:
+          failures.append(f"{flag}: output still has {s!r}")
+      if cc is None:
+        failures.append("no C compiler found (set CC)")
+        continue
+      r = subprocess.run(
+        [cc, "-std=gnu99", "-O2", "-w", src, driver, "-o", exe, "-lm"],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )
+      if r.returncode != 0:
+        failures.append(f"{cc} failed on {flag} output:\n{r.stderr}")
+        continue
+      r = subprocess.run([exe], stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60)
+      if r.returncode != 0 or r.stdout.strip() != "23":
+        failures.append(f"{flag}: exit {r.returncode}, printed {r.stdout.strip()!r}; expected 23")
+
+    r = subprocess.run(
+      [symirc, sir, "-w", f"--specialize={bad_model}"],
+      stdout=subprocess.PIPE,
+      stderr=subprocess.PIPE,
+      text=True,
+    )
+    if r.returncode == 0 or "has no sym %?m" not in r.stderr:
+      failures.append(f"a model with an unknown sym was not rejected: exit {r.returncode}\n{r.stderr}")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('C specialization checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirc = sys.argv[1]
+  else:
+    symirc = os.path.join(CWD, "symirc")
+  sys.exit(run(symirc))
@@ -0,0 +1,159 @@
+"""Verify the UB checks of `symirc --ub-checks`.
+
+Builds small programs that each hit one UB rule with
+`--ub-checks=explicit` and no sanitizer, with SYMIR_UB_TRAP defined to
+report the rule, and checks the rule reported. A program free of UB must
+run through. `--ub-checks=none` must leave no check or require in the C.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# (name, lets, statement, UB rule; None for no UB). `%r` is returned.
+CASES = [
+  ("div by zero", "let mut %a: i32 = 7; let mut %b: i32 = 0;", "%r = %a / %b;", 1),
+  ("INT_MIN / -1", "let mut %a: i32 = -2147483648; let mut %b: i32 = -1;", "%r = %a / %b;", 4),
+  (
+    "i8 add overflow",
+    "let mut %a: i8 = 100; let mut %b: i8 = 100; let mut %s: i8 = 0;",
+    "%s = %a + %b; %r = %s as i32;",
+    4,
+  ),
+  ("i32 mul overflow", "let mut %a: i32 = 65536;", "%r = %a * %a;", 4),
+  ("shl overflow", "let mut %a: i32 = 3; let mut %n: i32 = 31;", "%r = %a << %n;", 4),
+  ("overshift", "let mut %a: i32 = 3; let mut %n: i32 = 32;", "%r = %a >> %n;", 5),
+  ("array index", "let mut %arr: [3] i32 = {1, 2, 3}; let mut %i: i32 = 3;", "%r = %arr[%i];", 2),
+  ("float to int", "let mut %f: f64 = 3000000000.0;", "%r = %f as i32;", 8),
+  ("fp overflow", "let mut %x: f64 = 1.0; let mut %z: f64 = 0.0; let mut %d: f64 = 0.0;", "%d = %x / %z;", 6),
+  (
+    "no UB",
+    "let mut %a: i32 = 6; let mut %n: i32 = 2; let mut %arr: [3] i32 = {1, 2, 3};",
+    "%r = %a << %n; %r = %r + %arr[%n] - %a / %n - %a % %n;",
+    None,
+  ),
+]
+
+PROGRAM = """\
+fun @main() : i32 {{
+  {lets}
+  let mut %r: i32 = 0;
+^entry:
+  {stmt}
+  ret %r;
+}}
+"""
+
+# Reports the rule of a failed check and exits; included before the C.
+HOOK_H = "void symir_test_trap(int rule);\n"
+DRIVER = """\
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+void symir_test_trap(int rule) {
+  printf("trap %d\\n", rule);
+  exit(3);
+}
+int32_t symir_main(void);
+int main(void) {
+  printf("ret %d\\n", symir_main());
+  return 0;
+}
+"""
+
+
+def run(symirc):
+  cc = os.environ.get("CC") or shutil.which("cc") or shutil.which("gcc")
+  tmp = tempfile.mkdtemp()
+  sir = os.path.join(tmp, "ub.sir")
+  src = os.path.join(tmp, "ub.c")
+  exe = os.path.join(tmp, "ub")
+  hook = os.path.join(tmp, "hook.h")
+  driver = os.path.join(tmp, "driver.c")
+  with open(hook, "w") as f:
+    f.write(HOOK_H)
+  with open(driver, "w") as f:
+    f.write(DRIVER)
+
+  def symirc_run(flags):
+    return subprocess.run(
+      [symirc, sir, "-w", "-o", src] + flags, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True
+    )
+
+  start = time.time()
+  print(f"Testing C UB checks via {symirc}...", end=" ", flush=True)
+  failures = []
+  try:
+    for name, lets, stmt, rule in CASES:
+      with open(sir, "w") as f:
+        f.write(PROGRAM.format(lets=lets, stmt=stmt))
+      r = symirc_run(["--ub-checks=explicit"])
+      if r.returncode != 0:
+        failures.append(f"{name}: symirc failed:\n{r.stderr}")
+        continue
+      if cc is None:
+        failures.append("no C compiler found (set CC)")
+        break
+      r = subprocess.run(
+        [
+          cc, "-std=gnu99", "-O1", "-w", "-include", hook,
+          "-DSYMIR_UB_TRAP(rule)=symir_test_trap(rule)", src, driver, "-o", exe, "-lm",
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )  # fmt: skip
+      if r.returncode != 0:
+        failures.append(f"{name}: {cc} failed:\n{r.stderr}")
+        continue
+      r = subprocess.run([exe], stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60)
+      got = r.stdout.strip()
+      if rule is None and not got.startswith("ret "):
+        failures.append(f"{name}: expected no trap, got {got!r} (exit {r.returncode})")
+      elif rule is not None and got != f"trap {rule}":
+        failures.append(f"{name}: expected 'trap {rule}', got {got!r} (exit {r.returncode})")
+
+      # The same program without checks.
+      with open(sir, "a") as f:
+        f.write("fun @g() : i32 {\n^entry:\n  require 1 == 1;\n  ret 0;\n}\n")
+      r = symirc_run(["--ub-checks=none"])
+      if r.returncode != 0:
+        failures.append(f"{name}: symirc --ub-checks=none failed:\n{r.stderr}")
+        continue
+      with open(src) as f:
+        text = f.read()
+      for s in ["__builtin_trap", "SYMIR_", "assert("]:
+        if s in text:
+          failures.append(f"{name}: --ub-checks=none output still has {s!r}")
+
+    r = symirc_run(["--ub-checks=all"])
+    if r.returncode == 0 or "unknown --ub-checks" not in r.stderr:
+      failures.append(f"--ub-checks=all was not rejected: exit {r.returncode}\n{r.stderr}")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('C UB check failures')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirc = sys.argv[1]
+  else:
+    symirc = os.path.join(CWD, "symirc")
+  sys.exit(run(symirc))
@@ -1,3 +1,4 @@
+import json
 import os
 import shutil
 
@@ -97,7 +98,7 @@ def extract_sir_info(file_path, entry_func="main"):
   return info
 
 
-def run_symirc_test(symirc_path, target="c"):
+def run_symirc_test(symirc_path, target="c", symirc_extra=None, sanitize=True):
   temp_dir = "build/test_tmp"
   os.makedirs(temp_dir, exist_ok=True)
 
@@ -108,19 +109,26 @@ def run_symirc_test(symirc_path, target="c"):
       wasm_runtime = "wasmtime"
     elif shutil.which("wasmer"):
       wasm_runtime = "wasmer"
+  elif target == "wasm-bin":
+    # The binary module needs no assembler; node instantiates it directly.
+    if shutil.which("node"):
+      wasm_runtime = "node"
 
   def test_func(file_path, expectation, args, skips):
     if "COMPILER" in skips:
       return TestResult.SKIP, "Skipped by COMPILER tag"
 
-    if target == "wasm" and "WASM" in skips:
+    if target != "c" and "WASM" in skips:
       return TestResult.SKIP, "Skipped by WASM tag"
 
     if target == "wasm" and not wasm_runtime:
       return TestResult.SKIP, "No WASM runtime found (wasmtime or wasmer)"
 
+    if target == "wasm-bin" and not wasm_runtime:
+      return TestResult.SKIP, "No WASM runtime found (node)"
+
     base_name = os.path.basename(file_path)
-    output_ext = ".c" if target == "c" else ".wat"
+    output_ext = {"c": ".c", "wasm": ".wat", "wasm-bin": ".wasm"}[target]
     gen_out = os.path.join(temp_dir, base_name + output_ext)
     exe_out = os.path.join(temp_dir, base_name + ".exe")
 
@@ -128,6 +136,8 @@ def run_symirc_test(symirc_path, target="c"):
     cmd = [symirc_path, file_path, "--target", target, "-o", gen_out, "-w"]
     if target == "wasm":
       cmd.append("--no-module-tags")
+    if symirc_extra:
+      cmd.extend(symirc_extra)
 
     result, err = run_command(cmd, timeout=10)
     if err == "TIMEOUT":
@@ -285,16 +295,19 @@ def run_symirc_test(symirc_path, target="c"):
         "-o",
         exe_out,
         "-w",
+        "-g",
+        "-lm",
+      ]
+      if sanitize:
         # [v0.2.1] pointer-compare and pointer-subtract are AddressSanitizer
         # add-ons that catch cross-object pointer relational / subtraction
         # at runtime — needed for spec rule 14. ASAN_OPTIONS below also
         # turn on detect_invalid_pointer_pairs=2 to enable the runtime
         # check.
-        "-fsanitize=address,undefined,float-cast-overflow,pointer-compare,pointer-subtract",
-        "-fno-sanitize-recover=all",
-        "-g",
-        "-lm",
-      ]
+        gcc_cmd[6:6] = [
+          "-fsanitize=address,undefined,float-cast-overflow,pointer-compare,pointer-subtract",
+          "-fno-sanitize-recover=all",
+        ]
       res_gcc, err_gcc = run_command(gcc_cmd, timeout=10)
       if err_gcc == "TIMEOUT":
         return TestResult.TIMEOUT, "GCC timeout"
@@ -310,6 +323,35 @@ def run_symirc_test(symirc_path, target="c"):
         "ASAN_OPTIONS=detect_invalid_pointer_pairs=2",
         exe_out,
       ]
+    elif target == "wasm-bin":
+      sir_info = extract_sir_info(file_path, entry_func)
+      if "test/solver/" in file_path and (sir_info["syms"] or sir_info.get("vec_syms")):
+        bound = {strip_sigil(k) for k in bindings.keys()}
+        unbound_syms = [s for s in sir_info["syms"] if s not in bound]
+        unbound_vec = [s for s in sir_info.get("vec_syms", {}) if s not in bound]
+        if unbound_syms or unbound_vec:
+          return TestResult.PASS, ""
+
+      # Import name -> [WASM type, value] for every sym, 0 when unbound.
+      wasm_type = lambda t: "i32" if t in ("i1", "i8", "i16") else t
+      imports = {}
+      for sk, t in sir_info["syms"].items():
+        imports[sk] = [wasm_type(t), "0"]
+      for sk, shape in sir_info.get("vec_syms", {}).items():
+        for i in range(shape["n"]):
+          imports[f"{sk}__{i}"] = [wasm_type(shape["elem"]), "0"]
+      for k, v in bindings.items():
+        sk = strip_sigil(k)
+        if sk in sir_info.get("vec_syms", {}):
+          for i, lane in enumerate(s.strip() for s in v.split(",")):
+            if f"{sk}__{i}" in imports:
+              imports[f"{sk}__{i}"][1] = lane
+        elif sk in imports:
+          imports[sk][1] = v
+
+      export = "symir_main" if entry_func == "main" else entry_func
+      run_js = os.path.join(os.path.dirname(os.path.abspath(__file__)), "run_wasm.mjs")
+      run_cmd = [wasm_runtime, run_js, gen_out, export, json.dumps(imports)]
     else:
       # WASM execution
       sir_info = extract_sir_info(file_path, entry_func)
@@ -434,10 +476,20 @@ if __name__ == "__main__":
   parser = argparse.ArgumentParser()
   parser.add_argument("test_dir")
   parser.add_argument("symirc_path")
-  parser.add_argument("--target", choices=["c", "wasm"], default="c")
+  parser.add_argument("--target", choices=["c", "wasm", "wasm-bin"], default="c")
+  parser.add_argument(
+    "--symirc-extra", default="", help="Extra arguments passed verbatim to symirc, e.g. '-O'"
+  )
+  parser.add_argument(
+    "--no-sanitize",
+    action="store_true",
+    help="Build the C without sanitizers, for output that checks UB itself (--ub-checks=explicit)",
+  )
   args = parser.parse_args()
 
-  test_func, temp_dir = run_symirc_test(args.symirc_path, args.target)
+  test_func, temp_dir = run_symirc_test(
+    args.symirc_path, args.target, args.symirc_extra.split(), sanitize=not args.no_sanitize
+  )
   try:
     run_test_suite("compiler_tests", args.test_dir, test_func)
   finally:
@@ -1,3 +1,4 @@
+import re
 import sys
 
 from test.lib.framework import TestResult, run_command, run_test_suite
@@ -9,8 +10,21 @@ FAIL_EXIT_CODES = {
   "FAIL:StaticError": 4,
   "FAIL:UndefinedBehavior": 5,
   "FAIL:RequireViolation": 6,
+  "FAIL:BudgetExhausted": 7,
 }
 
+# `// EXPECT_ERRORS: <n>`: the run must report exactly n errors.
+_EXPECT_ERRORS_RE = re.compile(r"//\s*EXPECT_ERRORS:\s*(\d+)")
+
+
+def _parse_expect_errors(file_path):
+  with open(file_path, "r") as f:
+    for line in f:
+      m = _EXPECT_ERRORS_RE.search(line)
+      if m:
+        return int(m.group(1))
+  return None
+
 
 def run_symiri_test(binary_cmd_parts):
   def test_func(file_path, expectation, args, skips):
@@ -33,6 +47,13 @@ def run_symiri_test(binary_cmd_parts):
     else:
       passed = result.returncode != 0  # unknown subtype: any failure
 
+    errors = _parse_expect_errors(file_path)
+    if passed and errors is not None and result.stderr.count("error:") != errors:
+      return (
+        TestResult.FAIL,
+        f"{result.stderr.count('error:')} errors reported (expected {errors})\n"
+        f"STDERR:\n{result.stderr}",
+      )
     if passed:
       return TestResult.PASS, ""
     else:
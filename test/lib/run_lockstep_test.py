@@ -0,0 +1,187 @@
+"""Verify the --lockstep mode of symiri against one-at-a-time rows.
+
+Runs a fixture over many --sym-file rows whose paths diverge: loops of
+different trip counts, a branch taken by some lanes only, a division by a
+zero sym in some rows, a failed require and an exhausted step budget in
+others. A second fixture fills an array before it uses a sym, so that the
+rows of each batch fork from that shared prefix, as --time-passes must
+count. The output of every --lockstep width must equal that of
+--lockstep 0, which runs each row from the start, byte for byte on one
+thread, and line for line on three.
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# Odd iterations divide by %?d; n = 3, d = 9 sums to the unlucky 13.
+DIVERGE = """\
+fun @main() : i32 {
+  sym %?n : value i32;
+  sym %?d : value i32;
+  let mut %i: i32 = 0;
+  let mut %acc: i32 = 0;
+  let mut %t: i32 = 0;
+^entry:
+  br ^loop;
+^loop:
+  br %i < %?n, ^body, ^done;
+^body:
+  %t = 1 & %i;
+  br %t == 0, ^even, ^odd;
+^even:
+  %acc = %acc + %i;
+  br ^latch;
+^odd:
+  %t = %?d;
+  %acc = %acc + 100 / %t;
+  br ^latch;
+^latch:
+  %i = %i + 1;
+  br ^loop;
+^done:
+  require %acc != 13, "unlucky";
+  ret %acc;
+}
+"""
+
+ROWS = [{"%?n": n, "%?d": d} for n in range(-1, 12) for d in (0, 1, 3, -7, 9)]
+
+# No sym is used until ^sum: every row fills the array and takes an address
+# alike, then forks from there. The array keeps it out of lock-step. k = 2
+# sums to the unlucky 1.
+PREFIX = """\
+fun @main() : i32 {
+  sym %?k : value i32;
+  sym %?m : value i32;
+  let mut %a: [32] i32 = 0;
+  let mut %i: i32 = 0;
+  let mut %t: i32 = 0;
+  let mut %s: i32 = 0;
+  let mut %p: ptr i32 = null;
+^entry:
+  %p = addr %s;
+  br ^fill;
+^fill:
+  br %i < 32, ^fill_body, ^setup;
+^fill_body:
+  %a[%i] = %i * %i;
+  %i = %i + 1;
+  br ^fill;
+^setup:
+  %i = 0;
+  br ^sum;
+^sum:
+  br %i < %?k, ^sum_body, ^done;
+^sum_body:
+  %t = 31 & %i;
+  store %p, load %p + %a[%t];
+  %i = %i + 1;
+  br ^sum;
+^done:
+  require %s != 1, "unlucky";
+  %t = %?m;
+  %s = %s + 1000 / %t;
+  ret %s;
+}
+"""
+
+PREFIX_ROWS = [{"%?k": k, "%?m": m} for k in (-3, 0, 1, 2, 5, 31, 40, 200) for m in (0, 1, 7)]
+
+# (name, module, rows, symiri arguments, how the rows end, rows forked
+# from a shared prefix at each --lockstep width)
+FIXTURES = [
+  ("diverge", DIVERGE, ROWS, ["--max-steps", "30"], {"ok", "ub", "require", "budget"}, False),
+  ("prefix", PREFIX, PREFIX_ROWS, ["--max-steps", "300"], {"ok", "ub", "require", "budget"}, True),
+]
+
+FORKED_RE = re.compile(r"^  rows-forked: (\d+)$", re.M)
+
+
+def symiri_rows(symiri, sir, rows_file, extra):
+  r = subprocess.run(
+    [symiri, sir, "--sym-file", rows_file] + extra,
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=60,
+  )
+  return r.returncode, r.stdout
+
+
+def forked_rows(symiri, sir, rows_file, extra):
+  """The rows-forked counter of --time-passes, 0 if there is none."""
+  r = subprocess.run(
+    [symiri, sir, "--sym-file", rows_file, "--time-passes"] + extra,
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=60,
+  )
+  m = FORKED_RE.search(r.stderr)
+  return int(m.group(1)) if m else 0
+
+
+def run(symiri):
+  tmp = tempfile.mkdtemp()
+
+  start = time.time()
+  print(f"Testing --lockstep via {symiri}...", end=" ", flush=True)
+  failures = []
+  try:
+    for name, text, rows, extra, want, forks in FIXTURES:
+      sir = os.path.join(tmp, name + ".sir")
+      rows_file = os.path.join(tmp, name + ".jsonl")
+      with open(sir, "w") as f:
+        f.write(text)
+      with open(rows_file, "w") as f:
+        f.write("".join(json.dumps(row) + "\n" for row in rows))
+
+      rc, ref = symiri_rows(symiri, sir, rows_file, extra + ["--lockstep", "0"])
+      statuses = {json.loads(line)["status"] for line in ref.splitlines()}
+      if rc != 0 or len(ref.splitlines()) != len(rows) or statuses != want:
+        failures.append(f"{name} --lockstep 0: exit {rc}, statuses {sorted(statuses)}")
+        continue
+      for width in ("2", "4", "64"):
+        for engine in ("bytecode", "ast"):
+          args = extra + ["--lockstep", width, "--engine", engine]
+          rc, out = symiri_rows(symiri, sir, rows_file, args)
+          if rc != 0 or out != ref:
+            failures.append(f"{name} {' '.join(args)}: output differs from --lockstep 0")
+        rc, out = symiri_rows(symiri, sir, rows_file, extra + ["--lockstep", width, "-j", "3"])
+        if rc != 0 or sorted(out.splitlines()) != sorted(ref.splitlines()):
+          failures.append(f"{name} --lockstep {width} -j 3: rows differ from --lockstep 0")
+        if forks and forked_rows(symiri, sir, rows_file, extra + ["--lockstep", width]) != len(rows):
+          failures.append(f"{name} --lockstep {width}: not every row forked from the prefix")
+  except (subprocess.TimeoutExpired, ValueError, KeyError) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--lockstep checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symiri = sys.argv[1]
+  else:
+    symiri = os.path.join(CWD, "symiri")
+  sys.exit(run(symiri))
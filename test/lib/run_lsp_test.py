@@ -0,0 +1,204 @@
+"""Verify symir-lsp, the SymIR language server.
+
+Talks LSP to the server over stdin/stdout: initialize, open a module with
+an error, fix it with a ranged edit, break another declaration, close the
+document, send a body that is not JSON and an unknown request, and shut
+down. Every publishDiagnostics must carry the messages `symiri --check`
+reports for the same text, at the right lines, and an edit must re-parse
+only the declaration it touched (per --verbose). The malformed body must
+get a JSON-RPC Parse error with a null id.
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+URI = "file:///lsp_test.sir"
+
+# @broken returns an undeclared local (line 11, counting from 0).
+BROKEN = """\
+fun @first() : i32 {
+  let mut %a: i32 = 1;
+^entry:
+  ret %a;
+}
+
+fun @broken() : i32 {
+  let mut %b: i32 = 2;
+^entry:
+  %b = %b + 1;
+  br ^exit;
+^exit:
+  ret %c;
+}
+
+fun @third() : i32 {
+^entry:
+  ret 3;
+}
+"""
+
+VERBOSE_RE = re.compile(r"(\d+) declarations, (\d+) parsed, (\d+) checked, (\d+) diagnostics")
+
+
+class Client:
+  def __init__(self, binary):
+    self.proc = subprocess.Popen(
+      [binary, "--verbose"], stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE
+    )
+
+  def send(self, msg):
+    self.send_raw(json.dumps(dict(msg, jsonrpc="2.0")).encode())
+
+  def send_raw(self, body):
+    self.proc.stdin.write(b"Content-Length: %d\r\n\r\n" % len(body) + body)
+    self.proc.stdin.flush()
+
+  def recv(self):
+    length = None
+    while True:
+      line = self.proc.stdout.readline()
+      if not line:
+        raise RuntimeError("symir-lsp closed its output")
+      line = line.strip()
+      if not line:
+        break
+      if line.startswith(b"Content-Length:"):
+        length = int(line.split(b":")[1])
+    return json.loads(self.proc.stdout.read(length))
+
+  def stats(self):
+    m = VERBOSE_RE.search(self.proc.stderr.readline().decode())
+    return tuple(int(g) for g in m.groups()) if m else None
+
+
+def check_messages(symiri, text, tmp):
+  """The messages and 0-based lines `symiri --check` reports for `text`."""
+  sir = os.path.join(tmp, "check.sir")
+  with open(sir, "w") as f:
+    f.write(text)
+  r = subprocess.run([symiri, sir, "--check"], stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+  out = r.stdout + r.stderr
+  lines = [int(n) - 1 for n in re.findall(r"^\s*(\d+) \|", out, re.M)]
+  messages = re.findall(r"(?:error|warning): (.*)$", out, re.M)
+  return sorted(zip(lines, messages))
+
+
+def published(msg):
+  if msg.get("method") != "textDocument/publishDiagnostics" or msg["params"]["uri"] != URI:
+    raise RuntimeError(f"expected diagnostics, got {msg}")
+  return sorted((d["range"]["start"]["line"], d["message"]) for d in msg["params"]["diagnostics"])
+
+
+def run(symir_lsp, symiri):
+  tmp = tempfile.mkdtemp()
+  start = time.time()
+  print(f"Testing symir-lsp via {symir_lsp}...", end=" ", flush=True)
+  failures = []
+  c = Client(symir_lsp)
+  try:
+    c.send({"id": 1, "method": "initialize", "params": {"capabilities": {}}})
+    answer = c.recv()
+    sync = answer.get("result", {}).get("capabilities", {}).get("textDocumentSync", {})
+    if answer.get("id") != 1 or sync.get("change") != 2:
+      failures.append(f"initialize: {answer}")
+
+    c.send(
+      {
+        "method": "textDocument/didOpen",
+        "params": {"textDocument": {"uri": URI, "languageId": "symir", "version": 1, "text": BROKEN}},
+      }
+    )
+    diags = published(c.recv())
+    expected = check_messages(symiri, BROKEN, tmp)
+    if not diags or diags != expected:
+      failures.append(f"didOpen: {diags}, symiri --check says {expected}")
+    if c.stats() != (3, 3, 3, len(expected)):
+      failures.append("didOpen did not check all three declarations")
+
+    # Fix `ret %c;` in place: only @broken is parsed again.
+    fixed = BROKEN.replace("ret %c;", "ret %b;")
+    line = BROKEN.splitlines().index("  ret %c;")
+    edit = {"start": {"line": line, "character": 6}, "end": {"line": line, "character": 8}}
+    c.send(
+      {
+        "method": "textDocument/didChange",
+        "params": {
+          "textDocument": {"uri": URI, "version": 2},
+          "contentChanges": [{"range": edit, "text": "%b"}],
+        },
+      }
+    )
+    diags = published(c.recv())
+    if diags != check_messages(symiri, fixed, tmp):
+      failures.append(f"after the fix: {diags}")
+    stats = c.stats()
+    if not stats or stats[:2] != (3, 1):
+      failures.append(f"the fix re-parsed {stats}, expected 1 of 3 declarations")
+
+    # A whole-text change that breaks @third.
+    broken = fixed.replace("ret 3;", "ret 3")
+    c.send(
+      {
+        "method": "textDocument/didChange",
+        "params": {"textDocument": {"uri": URI, "version": 3}, "contentChanges": [{"text": broken}]},
+      }
+    )
+    diags = published(c.recv())
+    expected = check_messages(symiri, broken, tmp)
+    if not diags or diags != expected:
+      failures.append(f"parse error: {diags}, symiri --check says {expected}")
+    c.stats()
+
+    c.send({"method": "textDocument/didClose", "params": {"textDocument": {"uri": URI}}})
+    if published(c.recv()) != []:
+      failures.append("didClose did not clear the diagnostics")
+
+    # A body that is not JSON: its id cannot be read, so the answer has
+    # none. The request after it shows up first if it goes unanswered.
+    c.send_raw(b'{"jsonrpc": "2.0", "id": 4, "method": ')
+    c.send({"id": 2, "method": "textDocument/hover", "params": {}})
+    answer = c.recv()
+    if answer.get("error", {}).get("code") != -32700 or answer.get("id", 0) is not None:
+      failures.append(f"malformed JSON is not answered with -32700 and a null id: {answer}")
+    else:
+      answer = c.recv()
+    if answer.get("error", {}).get("code") != -32601:
+      failures.append("an unknown request is not answered with -32601")
+
+    c.send({"id": 3, "method": "shutdown"})
+    if c.recv().get("id") != 3:
+      failures.append("shutdown is not answered")
+    c.send({"method": "exit"})
+    if c.proc.wait(timeout=60) != 0:
+      failures.append(f"exit code {c.proc.returncode} after shutdown")
+  except (RuntimeError, ValueError, KeyError, subprocess.TimeoutExpired) as e:
+    failures.append(str(e))
+  finally:
+    c.proc.kill()
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('symir-lsp checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  bindir = sys.argv[1] if len(sys.argv) > 1 else CWD
+  sys.exit(run(os.path.join(bindir, "symir-lsp"), os.path.join(bindir, "symiri")))
@@ -0,0 +1,124 @@
+"""Verify the checked-module cache (--cache-dir) of symirc, symiri and
+symirsolve.
+
+Runs each tool on a few modules without a cache, then twice with one: the
+cold run must miss and the warm run must hit, as the module-cache counters
+of --time-passes report. All three runs must print the same output and
+the same warnings. A changed source must miss, and a damaged cache entry
+must count as a miss rather than be loaded.
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# Warnings are replayed from the cache, not reported anew.
+WARNS = """\
+fun @main() : i32 {
+  sym %?a : value i32 in [0, 100];
+  let mut %r: i32 = 0;
+  let mut %unused: i32 = 0;
+^entry:
+  %r = %?a + %?a;
+  require %r == 42, "twice a";
+  ret %r;
+^dead:
+  ret 0;
+}
+"""
+
+# (module, tool, arguments); structs, pointers and a vector sym module
+# from the tree next to the fixture above.
+RUNS = [
+  ("warns.sir", "symirc", ["--target", "c"]),
+  ("warns.sir", "symiri", ["--sym", "%?a=21"]),
+  ("warns.sir", "symirsolve", ["--path", "^entry"]),
+  ("examples/ptr_swap.sir", "symirc", ["--target", "wasm"]),
+  ("examples/ptr_swap.sir", "symirsolve", ["--path", "^entry,^loop,^body,^loop,^body,^loop,^exit"]),
+  ("examples/brainfuck_v021.sir", "symiri", []),
+  ("test/compile/compile_nested_structs.sir", "symirc", ["--target", "c"]),
+  ("test/compile/vec_sym_codegen.sir", "symirc", ["--target", "c"]),
+]
+
+COUNTER_RE = re.compile(r"^  module-cache-(hits|misses): (\d+)$", re.M)
+
+
+def tool_run(bindir, tool, sir, args, cache):
+  cmd = [os.path.join(bindir, tool), sir] + args
+  if cache:
+    cmd += ["--cache-dir", cache, "--time-passes"]
+  r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60)
+  report = r.stderr.find("===---")
+  stderr = r.stderr if report < 0 else r.stderr[:report]
+  counts = {kind: int(n) for kind, n in COUNTER_RE.findall(r.stderr[max(report, 0) :])}
+  return (r.returncode, r.stdout, stderr), counts
+
+
+def run(bindir):
+  tmp = tempfile.mkdtemp()
+  warns = os.path.join(tmp, "warns.sir")
+  with open(warns, "w") as f:
+    f.write(WARNS)
+
+  start = time.time()
+  print(f"Testing --cache-dir via {bindir}...", end=" ", flush=True)
+  failures = []
+  try:
+    for module, tool, args in RUNS:
+      sir = warns if module == "warns.sir" else os.path.join(CWD, module)
+      what = f"{tool} {module}"
+      cache = os.path.join(tmp, "cache")
+      shutil.rmtree(cache, ignore_errors=True)
+      ref, _ = tool_run(bindir, tool, sir, args, None)
+      for run_name, want in (("cold", {"misses": 1}), ("warm", {"hits": 1})):
+        out, counts = tool_run(bindir, tool, sir, args, cache)
+        if counts != want:
+          failures.append(f"{what} {run_name}: module cache {counts}, expected {want}")
+        if out != ref:
+          failures.append(f"{what} {run_name}: output differs from an uncached run")
+
+    # A changed module misses; a damaged entry is not loaded.
+    cache = os.path.join(tmp, "cache")
+    shutil.rmtree(cache, ignore_errors=True)
+    args = ["--sym", "%?a=21"]
+    tool_run(bindir, "symiri", warns, args, cache)
+    with open(warns, "w") as f:
+      f.write(WARNS.replace("%unused", "%other"))
+    ref, _ = tool_run(bindir, "symiri", warns, args, None)
+    out, counts = tool_run(bindir, "symiri", warns, args, cache)
+    if counts != {"misses": 1} or out != ref:
+      failures.append(f"changed module: module cache {counts}")
+    for entry in os.listdir(cache):
+      with open(os.path.join(cache, entry), "r+b") as f:
+        f.seek(os.path.getsize(os.path.join(cache, entry)) // 2)
+        f.write(b"\xff" * 16)
+    out, counts = tool_run(bindir, "symiri", warns, args, cache)
+    if counts != {"misses": 1} or out != ref:
+      failures.append(f"damaged entry: module cache {counts}, output {out}")
+  except (subprocess.TimeoutExpired, OSError) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--cache-dir checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(run(sys.argv[1] if len(sys.argv) > 1 else CWD))
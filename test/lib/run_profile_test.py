@@ -0,0 +1,130 @@
+"""Verify the execution profile of symiri (--profile, --profile-dot).
+
+Runs test/interp/profile_nested_loops.sir with its INTERP_ARGS, the
+outputs redirected from /dev/null to temporary files, and checks the
+per-block and per-edge counts of its two nested loops, the back-edge
+marks, the instruction counts and the timings in the JSON profile, and the
+same counts in the DOT graph. A run cut short by --max-steps must still
+write the counts of the blocks it ran.
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.framework import get_metadata
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+FIXTURE = os.path.join(CWD, "test", "interp", "profile_nested_loops.sir")
+
+# Three outer iterations of four inner ones.
+BLOCKS = {"^entry": 1, "^outer": 4, "^reset": 3, "^inner": 15, "^body": 12, "^next": 3, "^done": 1}
+EDGES = {
+  ("^entry", "^outer"): (1, False),
+  ("^outer", "^reset"): (3, False),
+  ("^outer", "^done"): (1, False),
+  ("^reset", "^inner"): (3, False),
+  ("^inner", "^body"): (12, False),
+  ("^inner", "^next"): (3, False),
+  ("^body", "^inner"): (12, True),
+  ("^next", "^outer"): (3, True),
+}
+# Two assignments per ^body, one per ^reset and ^next.
+INSTRUCTIONS = {"assign": 30, "assume": 0, "require": 1, "store": 0}
+
+# The first ten blocks: ^entry, ^outer, ^reset, then ^inner/^body x3, ^inner.
+BUDGET_BLOCKS = {"^entry": 1, "^outer": 1, "^reset": 1, "^inner": 4, "^body": 3, "^next": 0, "^done": 0}
+
+DOT_NODE_RE = re.compile(r'^\s*(b\d+) \[label="(\^\w+)\\n(\d+)(?:\\n[0-9.]+ s)?"', re.M)
+DOT_EDGE_RE = re.compile(r'^\s*(b\d+) -> (b\d+) \[label="(\d+)"', re.M)
+
+
+def check_profile(profile, blocks, what, failures):
+  got = {b["label"]: b["count"] for b in profile.get("blocks", [])}
+  if got != blocks:
+    failures.append(f"{what}: block counts {got}, expected {blocks}")
+  if profile.get("steps") != sum(blocks.values()):
+    failures.append(f"{what}: steps {profile.get('steps')}, expected {sum(blocks.values())}")
+
+
+def run(symiri):
+  tmp = tempfile.mkdtemp()
+  json_out = os.path.join(tmp, "run.json")
+  dot_out = os.path.join(tmp, "run.dot")
+
+  start = time.time()
+  print(f"Testing --profile via {symiri}...", end=" ", flush=True)
+  failures = []
+  try:
+    _, args, _ = get_metadata(FIXTURE)
+    outputs = iter([json_out, dot_out])
+    interp_args = [next(outputs) if a == "/dev/null" else a for a in args["INTERP_ARGS"]]
+    r = subprocess.run(
+      [symiri, FIXTURE] + interp_args, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60
+    )
+    if r.returncode != 0:
+      failures.append(f"fixture: exit {r.returncode}\n{r.stderr}")
+    else:
+      with open(json_out) as f:
+        profile = json.load(f)
+      check_profile(profile, BLOCKS, "fixture", failures)
+      if not all(b.get("seconds", -1) >= 0 for b in profile["blocks"]):
+        failures.append("--profile-time: a block has no time")
+      edges = {(e["from"], e["to"]): (e["count"], e.get("back", False)) for e in profile["edges"]}
+      if edges != EDGES:
+        failures.append(f"edge counts {edges}, expected {EDGES}")
+      if profile.get("instructions") != INSTRUCTIONS:
+        failures.append(f"instruction counts {profile.get('instructions')}, expected {INSTRUCTIONS}")
+
+      with open(dot_out) as f:
+        dot = f.read()
+      labels = {node: label for node, label, _ in DOT_NODE_RE.findall(dot)}
+      nodes = {label: int(count) for _, label, count in DOT_NODE_RE.findall(dot)}
+      if nodes != BLOCKS:
+        failures.append(f"DOT block counts {nodes}, expected {BLOCKS}")
+      dot_edges = {(labels.get(a), labels.get(b)): int(n) for a, b, n in DOT_EDGE_RE.findall(dot)}
+      if dot_edges != {k: v[0] for k, v in EDGES.items()}:
+        failures.append(f"DOT edge counts {dot_edges}")
+
+    r = subprocess.run(
+      [symiri, FIXTURE, "--profile", json_out, "--max-steps", "10"],
+      stdout=subprocess.PIPE,
+      stderr=subprocess.PIPE,
+      text=True,
+      timeout=60,
+    )
+    if r.returncode != 7:
+      failures.append(f"--max-steps 10: exit {r.returncode}, expected 7")
+    else:
+      with open(json_out) as f:
+        check_profile(json.load(f), BUDGET_BLOCKS, "--max-steps 10", failures)
+  except (subprocess.TimeoutExpired, ValueError, KeyError, OSError) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--profile checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symiri = sys.argv[1]
+  else:
+    symiri = os.path.join(CWD, "symiri")
+  sys.exit(run(symiri))
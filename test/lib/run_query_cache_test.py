@@ -0,0 +1,130 @@
+"""Verify the persistent query cache of symirsolve (--query-cache).
+
+Solves a fixture three times against one cache directory: the first run
+must miss and store, the second must answer every query from the cache,
+and a copy of the fixture with its sym renamed must hit as well. Each run
+must produce the concretized program and model of an uncached run. An
+UNSAT verdict must be cached and stay UNSAT on a hit.
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+SAT_FIXTURE = """\
+fun @main() : i32 {
+  sym %?a : value i32 in [0, 100];
+  let mut %r: i32 = 0;
+^entry:
+  %r = %?a + %?a;
+  require %r == 42, "twice a";
+  ret %r;
+}
+"""
+
+UNSAT_FIXTURE = """\
+fun @main() : i32 {
+  sym %?a : value i32 in [0, 10];
+  let mut %r: i32 = 0;
+^entry:
+  %r = %?a + %?a;
+  require %r == 43, "odd";
+  ret %r;
+}
+"""
+
+STATS_RE = re.compile(r"^Query cache: (\d+) hits, (\d+) misses, (\d+) stored$", re.M)
+
+
+def solve(symirsolve, sir, tmp, tag, extra):
+  out = os.path.join(tmp, tag + ".out.sir")
+  model = os.path.join(tmp, tag + ".model.json")
+  r = subprocess.run(
+    [symirsolve, sir, "--path", "^entry", "-o", out, "--emit-model", model] + extra,
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=60,
+  )
+  files = []
+  for path in (out, model):
+    if os.path.exists(path):
+      with open(path) as f:
+        files.append(f.read())
+    else:
+      files.append(None)
+  m = STATS_RE.search(r.stderr)
+  counts = tuple(int(g) for g in m.groups()) if m else None
+  return r.returncode, r.stdout.strip(), files, counts
+
+
+def run(symirsolve):
+  tmp = tempfile.mkdtemp()
+  cache = os.path.join(tmp, "cache")
+  sat = os.path.join(tmp, "sat.sir")
+  renamed = os.path.join(tmp, "renamed.sir")
+  unsat = os.path.join(tmp, "unsat.sir")
+  with open(sat, "w") as f:
+    f.write(SAT_FIXTURE)
+  with open(renamed, "w") as f:
+    f.write(SAT_FIXTURE.replace("%?a", "%?b"))
+  with open(unsat, "w") as f:
+    f.write(UNSAT_FIXTURE)
+
+  start = time.time()
+  print(f"Testing --query-cache via {symirsolve}...", end=" ", flush=True)
+  failures = []
+  try:
+    ref = solve(symirsolve, sat, tmp, "ref", [])
+    if ref[:2] != (0, "SAT"):
+      failures.append(f"uncached solve: exit {ref[0]}, {ref[1]}")
+    cached = ["--query-cache", cache]
+    for tag, sir, want in (
+      ("miss", sat, (0, 1, 1)),
+      ("hit", sat, (1, 0, 0)),
+      ("renamed", renamed, (1, 0, 0)),
+    ):
+      rc, verdict, files, counts = solve(symirsolve, sir, tmp, tag, cached)
+      if counts != want:
+        failures.append(f"{tag}: cache counts {counts}, expected {want}")
+      expected = ref[2] if tag != "renamed" else [t.replace("%?a", "%?b") for t in ref[2]]
+      if (rc, verdict) != ref[:2] or files != expected:
+        failures.append(f"{tag}: output differs from the uncached run")
+
+    # The interval pre-pass would refute this path before the solver.
+    cached.append("--no-intervals")
+    for tag, want in (("unsat-miss", (0, 1, 1)), ("unsat-hit", (1, 0, 0))):
+      rc, verdict, _, counts = solve(symirsolve, unsat, tmp, tag, cached)
+      if (rc, verdict) != (1, "UNSAT") or counts != want:
+        failures.append(f"{tag}: exit {rc}, {verdict}, cache counts {counts}")
+  except subprocess.TimeoutExpired as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--query-cache checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirsolve = sys.argv[1]
+  else:
+    symirsolve = os.path.join(CWD, "symirsolve")
+  sys.exit(run(symirsolve))
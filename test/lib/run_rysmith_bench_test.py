@@ -0,0 +1,89 @@
+"""Verify `rysmith --bench`, which generates for a while, writes nothing and
+prints a JSON summary of its throughput.
+
+Checks that stdout is that JSON alone, with programs generated, outcome
+rates that add up to one, and the phases timed, and that no output
+directory was created.
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+ARGS = ["--bench", "2", "--seed", "1", "--no-fp", "--n-bbls", "6"]
+
+PHASES = [
+  "gen-cfg", "gen-vars", "sample-path", "gen-function", "mutate", "typecheck", "solve", "print"
+]
+RATES = ["sat", "unsat", "unknown", "invalid", "refuted", "error"]
+
+
+def run(rysmith):
+  tmp = tempfile.mkdtemp()
+  out_dir = os.path.join(tmp, "out")
+  start = time.time()
+  print(f"Testing rysmith --bench via {rysmith}...", end=" ", flush=True)
+  failures = []
+  try:
+    r = subprocess.run(
+      [rysmith] + ARGS + ["-o", out_dir],
+      stdout=subprocess.PIPE,
+      stderr=subprocess.PIPE,
+      text=True,
+      timeout=600,
+    )
+    if r.returncode != 0:
+      failures.append(f"exit code {r.returncode}:\n{r.stderr}")
+    try:
+      summary = json.loads(r.stdout)
+    except json.JSONDecodeError as e:
+      summary = None
+      failures.append(f"stdout is not JSON ({e}):\n{r.stdout}")
+    if summary is not None:
+      if summary.get("seed") != 1:
+        failures.append(f"seed {summary.get('seed')}, expected 1")
+      if summary.get("programs", 0) <= 0 or summary.get("programs_per_sec", 0) <= 0:
+        failures.append("no program generated:\n" + r.stdout)
+      rates = summary.get("rates", {})
+      if sorted(rates) != sorted(RATES):
+        failures.append(f"rates {sorted(rates)}, expected {sorted(RATES)}")
+      elif summary.get("inits", 0) > 0 and abs(sum(rates.values()) - 1) > 1e-6:
+        failures.append(f"rates add up to {sum(rates.values())}")
+      phases = summary.get("phases_ms", {})
+      if sorted(phases) != sorted(PHASES):
+        failures.append(f"phases {sorted(phases)}, expected {sorted(PHASES)}")
+      elif phases["solve"] <= 0:
+        failures.append("solving not timed")
+    if os.path.exists(out_dir):
+      failures.append("output directory created")
+  except subprocess.TimeoutExpired:
+    failures.append("rysmith timed out")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('rysmith --bench checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    rysmith = sys.argv[1]
+  else:
+    rysmith = os.path.join(CWD, "rysmith")
+  sys.exit(run(rysmith))
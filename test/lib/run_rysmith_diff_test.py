@@ -0,0 +1,96 @@
+"""Verify `rysmith --diff`, which runs each concrete program in-process on
+the interpreter and as native code and writes only those that disagree.
+
+Checks that a run agrees on every program it generates and writes none,
+and that with a compiler that always fails (CC=false) every program is
+reported, written, and fails the run.
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+ARGS = ["--diff", "-n", "12", "--seed", "1", "--no-fp", "--n-bbls", "6", "--diff-batch", "8"]
+
+SUMMARY = re.compile(
+  r"Diff: (\d+) passed, (\d+) mismatched, (\d+) trapped, (\d+) failed to build, "
+  r"(\d+) failed to interpret"
+)
+
+
+def diff(rysmith, out_dir, env=None):
+  r = subprocess.run(
+    [rysmith] + ARGS + ["-o", out_dir],
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=600,
+    env=env,
+  )
+  m = SUMMARY.search(r.stdout)
+  counts = [int(n) for n in m.groups()] if m else None
+  written = sorted(name for name in os.listdir(out_dir) if name.endswith(".sir"))
+  return r.returncode, counts, written, r.stdout + r.stderr
+
+
+def run(rysmith):
+  tmp = tempfile.mkdtemp()
+  start = time.time()
+  print(f"Testing rysmith --diff via {rysmith}...", end=" ", flush=True)
+  failures = []
+  try:
+    code, counts, written, log = diff(rysmith, os.path.join(tmp, "ok"))
+    if counts is None:
+      failures.append("no Diff summary:\n" + log)
+    else:
+      if counts[0] == 0:
+        failures.append("no program compared")
+      if sum(counts[1:]):
+        failures.append("disagreements:\n" + log)
+    if code != (0 if counts and not sum(counts[1:]) else 1):
+      failures.append(f"exit code {code}")
+    if counts and not sum(counts[1:]) and written:
+      failures.append(f"programs written although all agree: {written}")
+
+    env = dict(os.environ, CC="false")
+    code, bad, written, log = diff(rysmith, os.path.join(tmp, "cc"), env)
+    if bad is None:
+      failures.append("CC=false: no Diff summary:\n" + log)
+    else:
+      if counts and bad[3] != counts[0]:
+        failures.append(f"CC=false: {bad[3]} of {counts[0]} programs failed to build")
+      if len(written) != bad[3]:
+        failures.append(f"CC=false: {len(written)} programs written, expected {bad[3]}")
+    if code != 1:
+      failures.append(f"CC=false: exit code {code}")
+  except subprocess.TimeoutExpired:
+    failures.append("rysmith timed out")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('rysmith --diff checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    rysmith = sys.argv[1]
+  else:
+    rysmith = os.path.join(CWD, "rysmith")
+  sys.exit(run(rysmith))
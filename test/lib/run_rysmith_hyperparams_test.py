@@ -0,0 +1,124 @@
+"""Verify `rysmith --hyperparams`, `--hyperparams-out` and `--adaptive`.
+
+Checks that the defaults written by --hyperparams-out read back to the very
+same programs, that another table changes them, that a malformed file is
+rejected naming its line, and that an --adaptive run reports its mix and
+writes a table that loads again.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+ARGS = [
+  "-n", "4", "--seed", "1", "--no-fp", "--n-bbls", "6", "--timeout", "20000", "--keep-symbolic"
+]
+
+# Every on-path int atom a bare coef sym, one atom per expression.
+BARE = """\
+# comments and blank lines are skipped
+
+IntOnPath_CoefBareEnd = 100
+IntOnPath_MulEnd = 100
+IntOnPath_BitwiseEnd = 100
+IntOnPath_ShiftEnd = 100
+IntOnPath_UnaryNotEnd = 100
+IntOnPath_CastEnd = 100
+IntOnPath_DivModEnd = 100
+IntOnPath_LoadEnd = 100
+IntOnPath_SelectEnd = 100
+MaxAtomsPerExpr = 1
+"""
+
+
+def rysmith_run(rysmith, out_dir, extra):
+  r = subprocess.run(
+    [rysmith] + ARGS + extra + ["-o", out_dir],
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=600,
+  )
+  files = {}
+  if os.path.isdir(out_dir):
+    for name in sorted(os.listdir(out_dir)):
+      if name.endswith("_sym0.sir"):
+        with open(os.path.join(out_dir, name)) as f:
+          files[name] = f.read()
+  return r.returncode, files, r.stdout + r.stderr
+
+
+def write(path, text):
+  with open(path, "w") as f:
+    f.write(text)
+  return path
+
+
+def run(rysmith):
+  tmp = tempfile.mkdtemp()
+  start = time.time()
+  print(f"Testing rysmith --hyperparams via {rysmith}...", end=" ", flush=True)
+  failures = []
+  try:
+    defaults = os.path.join(tmp, "defaults.hp")
+    code, base, log = rysmith_run(rysmith, os.path.join(tmp, "base"),
+                                  ["--hyperparams-out", defaults])
+    if code != 0 or not base:
+      failures.append(f"default run: exit code {code}, {len(base)} symbolic programs:\n" + log)
+
+    code, files, log = rysmith_run(rysmith, os.path.join(tmp, "loaded"),
+                                   ["--hyperparams", defaults])
+    if code != 0 or files != base:
+      failures.append("reloaded defaults generate other programs:\n" + log)
+
+    bare = write(os.path.join(tmp, "bare.hp"), BARE)
+    code, files, log = rysmith_run(rysmith, os.path.join(tmp, "bare"), ["--hyperparams", bare])
+    if code != 0 or not files:
+      failures.append(f"bare table: exit code {code}:\n" + log)
+    elif files == base:
+      failures.append("bare table generates the default programs")
+
+    bad = write(os.path.join(tmp, "bad.hp"), "IntOnPath_MulEnd = 60\nNoSuchParam = 1\n")
+    code, _, log = rysmith_run(rysmith, os.path.join(tmp, "bad"), ["--hyperparams", bad])
+    if code != 1 or "bad.hp:2: unknown hyperparameter" not in log:
+      failures.append(f"unknown name: exit code {code}:\n" + log)
+
+    adapted = os.path.join(tmp, "adapted.hp")
+    code, _, log = rysmith_run(rysmith, os.path.join(tmp, "adaptive"),
+                               ["--adaptive=0.5", "--hyperparams-out", adapted])
+    if code != 0 or "Adaptive mix" not in log:
+      failures.append(f"--adaptive: exit code {code}:\n" + log)
+    code, _, log = rysmith_run(rysmith, os.path.join(tmp, "readapted"),
+                               ["--hyperparams", adapted])
+    if code != 0:
+      failures.append("the adapted table does not load:\n" + log)
+  except subprocess.TimeoutExpired:
+    failures.append("rysmith timed out")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('rysmith --hyperparams checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    rysmith = sys.argv[1]
+  else:
+    rysmith = os.path.join(CWD, "rysmith")
+  sys.exit(run(rysmith))
@@ -0,0 +1,89 @@
+"""Verify that `rysmith -j` generates what a single thread does.
+
+Runs rysmith with the same --seed on one thread and on four, and checks
+that both report the same functions in the same order and write the same
+files, with identical symbolic programs. The concrete models are only
+compared by name: AliveSMT shares one Z3 context between the threads, so
+it may pick another model of the same formula.
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# Small functions and a generous timeout, so that no query the threads slow
+# down comes back UNKNOWN on one of the runs only.
+ARGS = [
+  "-n", "12", "--seed", "1", "--no-fp", "--n-bbls", "6", "--timeout", "20000", "--keep-symbolic"
+]
+
+
+def generate(rysmith, jobs, out_dir):
+  r = subprocess.run(
+    [rysmith] + ARGS + ["-j", str(jobs), "-o", out_dir],
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=600,
+  )
+  # The summary line carries timings; paths name the output directory.
+  log = [
+    line.replace(out_dir, "OUT")
+    for line in (r.stdout + r.stderr).splitlines()
+    if not line.startswith("Done:")
+  ]
+  files = {}
+  for name in sorted(os.listdir(out_dir)):
+    with open(os.path.join(out_dir, name)) as f:
+      files[name] = f.read()
+  return log, files
+
+
+def run(rysmith):
+  tmp = tempfile.mkdtemp()
+  start = time.time()
+  print(f"Testing rysmith -j via {rysmith}...", end=" ", flush=True)
+  failures = []
+  try:
+    log1, files1 = generate(rysmith, 1, os.path.join(tmp, "j1"))
+    log4, files4 = generate(rysmith, 4, os.path.join(tmp, "j4"))
+    if not any(name.endswith("_sym0.sir") for name in files1):
+      failures.append("no symbolic program written")
+    if log1 != log4:
+      failures.append("-j 4 reports differ:\n" + "\n".join(log4))
+    if sorted(files1) != sorted(files4):
+      failures.append(f"-j 4 files differ: {sorted(set(files1) ^ set(files4))}")
+    for name, text in files1.items():
+      if re.search(r"_sym\d+\.sir$", name) and files4.get(name) != text:
+        failures.append(f"-j 4 symbolic program differs: {name}")
+  except subprocess.TimeoutExpired:
+    failures.append("rysmith timed out")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('rysmith -j checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    rysmith = sys.argv[1]
+  else:
+    rysmith = os.path.join(CWD, "rysmith")
+  sys.exit(run(rysmith))
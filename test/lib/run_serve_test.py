@@ -0,0 +1,301 @@
+"""Verify the --serve mode of symirsolve, symiri and symirc.
+
+Talks JSON-RPC to each tool over stdin/stdout: loads a module, sends the
+tool's own requests on it, and checks the answers against those of the
+command line. Also checks that requests are answered as they finish (a
+long interpret run is overtaken by a ping), that a module is checked again
+after its file changes, that modules do not see each other's names, that
+errors come back with their codes, that a solve past its deadline is
+interrupted, and that a server on a Unix socket answers and stops on
+`shutdown`.
+"""
+
+import base64
+import json
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+SOLVE = """fun @main() : i32 {
+  sym %?a : value i32 in [0, 100];
+  let mut %r: i32 = 0;
+^entry:
+  %r = %?a + %?a;
+  require %r == 42, "twice a";
+  ret %r;
+}
+"""
+
+LOOP = """fun @main() : i32 {
+  sym %?n : value i32 in [0, 10000000];
+  let mut %i: i32 = 0;
+  let mut %x: i32 = 1;
+^entry:
+  br ^loop;
+^loop:
+  br %i < %?n, ^body, ^done;
+^body:
+  %x = 1023 & %x + 7 ^ %i;
+  %i = %i + 1;
+  br ^loop;
+^done:
+  ret %x;
+}
+"""
+
+# Names of its own, in a module of its own.
+OTHER = """fun @helper() : i32 {
+^entry:
+  ret 1;
+}
+
+fun @other() : i32 {
+  sym %?zz : value i32;
+  let mut %q: i32 = 0;
+^entry:
+  %q = %?zz + 1;
+  ret %q;
+}
+"""
+
+# A factoring query Z3 takes seconds on.
+HARD = """fun @main() : i64 {
+  sym %?a : value i64;
+  sym %?b : value i64;
+  sym %?c : value i64;
+  let mut %x: i64 = 0;
+  let mut %y: i64 = 0;
+  let mut %r: i64 = 0;
+^entry:
+  %x = %?a;
+  %y = %?b;
+  %r = %x * %y;
+  %y = %?c;
+  %r = %r * %y;
+  require %r == 1000000000000000007, "factors";
+  require %x > 1000, "a";
+  require %y > 1000, "c";
+  ret %r;
+}
+"""
+
+
+class Session:
+  """One server over stdin/stdout; answers are kept in arrival order."""
+
+  def __init__(self, cmd):
+    self.proc = subprocess.Popen(
+      cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True
+    )
+    self.next_id = 0
+
+  def send(self, method, params=None):
+    self.next_id += 1
+    msg = {"jsonrpc": "2.0", "id": self.next_id, "method": method}
+    if params is not None:
+      msg["params"] = params
+    self.proc.stdin.write(json.dumps(msg) + "\n")
+    self.proc.stdin.flush()
+    return self.next_id
+
+  def recv(self):
+    line = self.proc.stdout.readline()
+    if not line:
+      raise RuntimeError("server closed its output: " + self.proc.stderr.read())
+    return json.loads(line)
+
+  def call(self, method, params=None):
+    id = self.send(method, params)
+    answer = self.recv()
+    if answer.get("id") != id:
+      raise RuntimeError(f"answer to {answer.get('id')} while waiting for {id}")
+    return answer
+
+  def close(self):
+    self.call("shutdown")
+    self.proc.stdin.close()
+    return self.proc.wait(timeout=60)
+
+
+def check_symirsolve(binary, sir, failures):
+  s = Session([binary, "--serve", "-j", "2"])
+  try:
+    answer = s.call("load", {"input": sir})
+    if answer.get("result", {}).get("functions") != ["@main"]:
+      failures.append(f"symirsolve load: {answer}")
+    answer = s.call("solve", {"input": sir, "main": "@main", "path": ["^entry"]})
+    res = answer.get("result", {})
+    if res.get("result") != "sat" or res.get("model", {}).get("%?a") != 21:
+      failures.append(f"symirsolve solve: {answer}")
+    answer = s.call("sample", {"input": sir, "main": "@main"})
+    if answer.get("result", {}).get("result") != "sat":
+      failures.append(f"symirsolve sample: {answer}")
+    answer = s.call("stats")
+    if answer.get("result", {}).get("loads") != 1:
+      failures.append(f"symirsolve stats: {answer}")
+    start = time.time()
+    answer = s.call(
+      "solve", {"source": HARD, "main": "@main", "path": ["^entry"], "deadline_ms": 200}
+    )
+    res = answer.get("result", {})
+    if res.get("result") != "unknown" or res.get("message") != "deadline passed":
+      failures.append(f"symirsolve deadline: {answer}")
+    elif time.time() - start > 3:
+      failures.append(f"symirsolve deadline: answered after {time.time() - start:.1f}s")
+    answer = s.call("solve", {"input": sir + ".missing", "main": "@main", "path": ["^entry"]})
+    if answer.get("error", {}).get("code") != -32000:
+      failures.append(f"symirsolve missing file: {answer}")
+    answer = s.call("frobnicate")
+    if answer.get("error", {}).get("code") != -32601:
+      failures.append(f"symirsolve unknown method: {answer}")
+    if s.close() != 0:
+      failures.append("symirsolve did not exit cleanly")
+  finally:
+    s.proc.kill()
+
+
+def check_symiri(binary, sir, loop, failures):
+  s = Session([binary, "--serve", "-j", "2"])
+  try:
+    answer = s.call("interpret", {"input": sir, "syms": {"%?a": 21}})
+    res = answer.get("result", {})
+    if res.get("status") != "ok" or res.get("result") != "42":
+      failures.append(f"symiri interpret: {answer}")
+    answer = s.call("interpret", {"input": sir, "syms": {"%?a": 20}})
+    if answer.get("result", {}).get("status") == "ok":
+      failures.append(f"symiri failed require: {answer}")
+
+    # Each module has its own names; neither sees the other's.
+    answer = s.call("load", {"source": OTHER})
+    if answer.get("result", {}).get("functions") != ["@helper", "@other"]:
+      failures.append(f"symiri load of a second module: {answer}")
+    answer = s.call("interpret", {"source": OTHER, "main": "@other", "syms": {"%?zz": 4}})
+    if answer.get("result", {}).get("result") != "5":
+      failures.append(f"symiri second module: {answer}")
+    answer = s.call("interpret", {"input": sir, "syms": {"%?a": 21}})
+    if answer.get("result", {}).get("result") != "42":
+      failures.append(f"symiri first module again: {answer}")
+
+    # The ping is answered while the loop still runs.
+    slow = s.send("interpret", {"source": loop, "syms": {"%?n": 10000000}})
+    fast = s.send("ping")
+    order = [s.recv().get("id"), s.recv().get("id")]
+    if order != [fast, slow]:
+      failures.append(f"symiri answers not out of order: {order}")
+
+    # A changed file is checked again.
+    with open(sir) as f:
+      text = f.read()
+    with open(sir, "w") as f:
+      f.write(text.replace("%?a + %?a", "%?a + %?a + 2") + "\n")
+    answer = s.call("interpret", {"input": sir, "syms": {"%?a": 20}})
+    if answer.get("result", {}).get("result") != "42":
+      failures.append(f"symiri after a change: {answer}")
+    with open(sir, "w") as f:
+      f.write(text)
+    if s.close() != 0:
+      failures.append("symiri did not exit cleanly")
+  finally:
+    s.proc.kill()
+
+
+def check_symirc(binary, sir, failures):
+  s = Session([binary, "--serve"])
+  try:
+    for target, extra in [("c", []), ("wasm", []), ("wasm-bin", ["--wasm-names"])]:
+      expected = subprocess.run(
+        [binary, sir, "--target", target] + extra, stdout=subprocess.PIPE, timeout=60
+      ).stdout
+      params = {"input": sir, "target": target, "wasm_names": bool(extra)}
+      res = s.call("compile", params).get("result", {})
+      if target == "wasm-bin":
+        output = base64.b64decode(res.get("output_base64", ""))
+      else:
+        output = res.get("output", "").encode()
+      if output != expected:
+        failures.append(f"symirc {target} output differs from the command line's")
+    answer = s.call("compile", {"input": sir, "cfg_lowering": "bogus"})
+    if answer.get("error", {}).get("code") != -32602:
+      failures.append(f"symirc bad option: {answer}")
+    answer = s.call("compile", {"source": "fun @main( : i32 {"})
+    if answer.get("error", {}).get("code") != -32000:
+      failures.append(f"symirc bad source: {answer}")
+    if s.close() != 0:
+      failures.append("symirc did not exit cleanly")
+  finally:
+    s.proc.kill()
+
+
+def check_socket(binary, sir, tmp, failures):
+  path = os.path.join(tmp, "symiri.sock")
+  proc = subprocess.Popen(
+    [binary, f"--serve={path}"], stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True
+  )
+  try:
+    for _ in range(100):
+      if os.path.exists(path):
+        break
+      time.sleep(0.05)
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+      conn.connect(path)
+      f = conn.makefile("rw")
+      for id, method, params in [
+        (1, "interpret", {"input": sir, "syms": {"%?a": 21}}),
+        (2, "shutdown", None),
+      ]:
+        msg = {"jsonrpc": "2.0", "id": id, "method": method}
+        if params:
+          msg["params"] = params
+        f.write(json.dumps(msg) + "\n")
+        f.flush()
+        answer = json.loads(f.readline())
+        if answer.get("id") != id or "error" in answer:
+          failures.append(f"socket {method}: {answer}")
+    if proc.wait(timeout=60) != 0:
+      failures.append("socket server did not exit cleanly")
+    if os.path.exists(path):
+      failures.append("socket file left behind")
+  finally:
+    proc.kill()
+
+
+def run(bindir):
+  tmp = tempfile.mkdtemp()
+  start = time.time()
+  print(f"Testing --serve via {bindir}...", end=" ", flush=True)
+  failures = []
+  try:
+    sir = os.path.join(tmp, "twice.sir")
+    with open(sir, "w") as f:
+      f.write(SOLVE)
+    check_symirsolve(os.path.join(bindir, "symirsolve"), sir, failures)
+    check_symiri(os.path.join(bindir, "symiri"), sir, LOOP, failures)
+    check_symirc(os.path.join(bindir, "symirc"), sir, failures)
+    check_socket(os.path.join(bindir, "symiri"), sir, tmp, failures)
+  except (RuntimeError, ValueError, subprocess.TimeoutExpired) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--serve checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(run(sys.argv[1] if len(sys.argv) > 1 else CWD))
@@ -0,0 +1,130 @@
+"""Verify --emit-smt2 and the --remote/--worker round trip of symirsolve.
+
+Solves the paths of a fixture locally, through written SMT-LIB2 scripts,
+and through a worker process sharing a query directory. The verdicts and
+models must agree, every script must be a complete query, and the worker
+must count the queries it answered and exit once idle.
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# A feasible path with one model, and an infeasible one. The interval
+# pre-pass is off so that both reach the solver.
+SIR_FIXTURE = """\
+fun @main() : i32 {
+  sym %?a : value i32 in [0, 100];
+  let mut %r: i32 = 0;
+^entry:
+  br %?a < 50, ^small, ^big;
+^small:
+  %r = %?a + %?a + %?a;
+  require %r == 21, "three a";
+  br ^exit;
+^big:
+  %r = %?a + 1;
+  require %r == 20, "a plus one";
+  br ^exit;
+^exit:
+  ret %r;
+}
+"""
+
+PATHS = ["^entry,^small,^exit", "^entry,^big,^exit"]
+
+WORKER_RE = re.compile(r"^Worker: answered (\d+) queries$", re.M)
+
+
+def solve(symirsolve, sir, path, tmp, extra):
+  model = os.path.join(tmp, "model.json")
+  if os.path.exists(model):
+    os.remove(model)
+  r = subprocess.run(
+    [symirsolve, sir, "--path", path, "--no-intervals", "--emit-model", model] + extra,
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=60,
+  )
+  if not os.path.exists(model):
+    return r.stdout.strip(), None
+  with open(model) as f:
+    return r.stdout.strip(), json.load(f)
+
+
+def run(symirsolve):
+  tmp = tempfile.mkdtemp()
+  sir = os.path.join(tmp, "branch.sir")
+  scripts = os.path.join(tmp, "smt2")
+  queue = os.path.join(tmp, "queue")
+  os.makedirs(scripts)
+  os.makedirs(queue)
+  with open(sir, "w") as f:
+    f.write(SIR_FIXTURE)
+
+  start = time.time()
+  print(f"Testing --emit-smt2/--worker via {symirsolve}...", end=" ", flush=True)
+  failures = []
+  worker = subprocess.Popen(
+    [symirsolve, "--worker", queue, "--worker-idle-ms", "2000", "-j", "2"],
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+  )
+  try:
+    for path in PATHS:
+      local = solve(symirsolve, sir, path, tmp, [])
+      if local[0] not in ("SAT", "UNSAT"):
+        failures.append(f"{path}: local solve answered {local[0]}")
+      for mode, extra in (("--emit-smt2", ["--emit-smt2", scripts]), ("--remote", ["--remote", queue])):
+        got = solve(symirsolve, sir, path, tmp, extra)
+        if got != local:
+          failures.append(f"{path} {mode}: {got}, local solve {local}")
+
+    written = sorted(os.listdir(scripts))
+    if len(written) != len(PATHS):
+      failures.append(f"--emit-smt2 wrote {written}")
+    for name in written:
+      with open(os.path.join(scripts, name)) as f:
+        text = f.read()
+      if not text.startswith("(set-option") or "(check-sat" not in text or "(declare-const" not in text:
+        failures.append(f"{name} is no complete query:\n{text}")
+
+    out, err = worker.communicate(timeout=60)
+    m = WORKER_RE.search(err)
+    if worker.returncode != 0 or not m or int(m.group(1)) != len(PATHS):
+      failures.append(f"worker: exit {worker.returncode}\n{err}")
+  except (subprocess.TimeoutExpired, ValueError) as e:
+    failures.append(str(e))
+  finally:
+    worker.kill()
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--emit-smt2/--worker checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirsolve = sys.argv[1]
+  else:
+    symirsolve = os.path.join(CWD, "symirsolve")
+  sys.exit(run(symirsolve))
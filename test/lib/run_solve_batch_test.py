@@ -0,0 +1,156 @@
+"""Verify the --batch mode of symirsolve.
+
+Runs a jobs file naming two fixtures on two workers: path jobs, a sample
+job, a job fixing a sym, a malformed line and a missing file. Every line
+must be answered exactly once, in any order, and the verdict and model of
+each path job must equal those of the same path solved on the command
+line.
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# Each arm needs its own value of %?a; ^big is infeasible.
+BRANCH = """\
+fun @main() : i32 {
+  sym %?a : value i32 in [0, 100];
+  let mut %r: i32 = 0;
+^entry:
+  br %?a < 50, ^small, ^big;
+^small:
+  %r = %?a + %?a + %?a;
+  require %r == 21, "three a";
+  br ^exit;
+^big:
+  %r = %?a + 1;
+  require %r == 20, "a plus one";
+  br ^exit;
+^exit:
+  ret %r;
+}
+"""
+
+TWICE = """\
+fun @main() : i32 {
+  sym %?a : value i32 in [0, 100];
+  let mut %r: i32 = 0;
+^entry:
+  %r = %?a + %?a;
+  require %r == 42, "twice a";
+  ret %r;
+}
+"""
+
+PATHS = {
+  "small": ["^entry", "^small", "^exit"],
+  "big": ["^entry", "^big", "^exit"],
+}
+
+
+def solve_cli(symirsolve, sir, path, tmp):
+  model = os.path.join(tmp, "model.json")
+  if os.path.exists(model):
+    os.remove(model)
+  r = subprocess.run(
+    [symirsolve, sir, "--path", ",".join(path), "--emit-model", model],
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=60,
+  )
+  verdict = r.stdout.strip().lower()
+  if verdict != "sat":
+    return verdict, None
+  with open(model) as f:
+    return verdict, json.load(f)["@main"]
+
+
+def run(symirsolve):
+  tmp = tempfile.mkdtemp()
+  branch = os.path.join(tmp, "branch.sir")
+  twice = os.path.join(tmp, "twice.sir")
+  with open(branch, "w") as f:
+    f.write(BRANCH)
+  with open(twice, "w") as f:
+    f.write(TWICE)
+  jobs = [
+    json.dumps({"id": "small", "input": branch, "path": PATHS["small"]}),
+    json.dumps({"id": "big", "input": branch, "path": ",".join(PATHS["big"])}),
+    json.dumps({"id": 3, "input": twice, "sample": 4, "seed": 3}),
+    "not json",
+    json.dumps({"id": 5, "input": twice + ".missing", "path": ["^entry"]}),
+    "",
+    json.dumps({"id": 7, "input": twice, "path": ["^entry"], "syms": {"%?a": 20}}),
+  ]
+  jobs_file = os.path.join(tmp, "jobs.jsonl")
+  with open(jobs_file, "w") as f:
+    f.write("\n".join(jobs) + "\n")
+
+  start = time.time()
+  print(f"Testing --batch via {symirsolve}...", end=" ", flush=True)
+  failures = []
+  try:
+    r = subprocess.run(
+      [symirsolve, "--batch", jobs_file, "-j", "2"],
+      stdout=subprocess.PIPE,
+      stderr=subprocess.PIPE,
+      text=True,
+      timeout=60,
+    )
+    if r.returncode != 0:
+      failures.append(f"exit {r.returncode}:\n{r.stderr}")
+    answers = {}
+    for line in r.stdout.splitlines():
+      answer = json.loads(line)
+      if answer["line"] in answers:
+        failures.append(f"line {answer['line']} answered twice")
+      answers[answer["line"]] = answer
+    if sorted(answers) != [1, 2, 3, 4, 5, 7]:
+      failures.append(f"answered lines {sorted(answers)}, expected 1-5 and 7")
+
+    for line, name in ((1, "small"), (2, "big")):
+      answer = answers.get(line, {})
+      verdict, model = solve_cli(symirsolve, branch, PATHS[name], tmp)
+      if answer.get("id") != name or answer.get("result") != verdict:
+        failures.append(f"{name}: {answer}, command line says {verdict}")
+      elif answer.get("model") != model:
+        failures.append(f"{name}: model {answer.get('model')}, command line {model}")
+    if answers.get(3, {}).get("model") != {"%?a": 21}:
+      failures.append(f"sample job: {answers.get(3)}")
+    for line in (4, 5):
+      if answers.get(line, {}).get("result") != "error" or not answers[line].get("message"):
+        failures.append(f"line {line} is no error: {answers.get(line)}")
+    if answers.get(7, {}).get("result") != "unsat":
+      failures.append(f"fixed sym: {answers.get(7)}")
+  except (subprocess.TimeoutExpired, ValueError, KeyError) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--batch checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirsolve = sys.argv[1]
+  else:
+    symirsolve = os.path.join(CWD, "symirsolve")
+  sys.exit(run(symirsolve))
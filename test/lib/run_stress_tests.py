@@ -0,0 +1,154 @@
+"""Encoding-size regression tests over the stress templates of
+test/lib/stress.py.
+
+Solves every data point (a template at one size) with symirsolve --stats
+and records its term count, assertion count, DAG size and solve time. The
+counts are compared with the baseline curve in test/stress/baseline.json:
+a point fails when a count grows past its baseline by more than
+COUNT_TOLERANCE (plus COUNT_SLACK, for the smallest points), or when it
+takes TIME_TOLERANCE times its baseline solve time (plus TIME_SLACK_MS).
+An encoder change that turns a linear dimension quadratic fails at the
+larger points long before it is noticed in rysmith throughput.
+
+Counts come from the TermBuilder and do not depend on the backend; solve
+times do, so their bound is loose. When the encoder shrinks a curve on
+purpose, run with --update to store the new one.
+
+  python3 -m test.lib.run_stress_tests ./symirsolve [--dimension array]
+      [--report points.json] [--update] [--no-time]
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib import stress
+from test.lib.style import bold, green, red, yellow
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+BASELINE = os.path.join(CWD, "test", "stress", "baseline.json")
+
+COUNTS = ["terms", "assertions", "dag_size"]
+COUNT_TOLERANCE = 1.25
+COUNT_SLACK = 16
+TIME_TOLERANCE = 10
+TIME_SLACK_MS = 2000
+
+
+def measure(symirsolve, template, tmp):
+  """Solves one data point; returns (point, error)."""
+  sir = os.path.join(tmp, template.name + ".sir")
+  stats = os.path.join(tmp, template.name + ".json")
+  with open(sir, "w") as f:
+    f.write(template.source)
+  cmd = [symirsolve, sir, "--main", "@main", "--path", ",".join(template.path), "--stats", stats]
+  try:
+    r = subprocess.run(
+      cmd + template.args, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=300
+    )
+  except subprocess.TimeoutExpired:
+    return None, "symirsolve timed out"
+  if r.returncode != 0 or "SAT" not in r.stdout.split():
+    return None, f"not SAT (exit code {r.returncode}):\n{r.stdout}{r.stderr}"
+  with open(stats) as f:
+    total = json.load(f)["total"]
+  point = {k: total[k] for k in COUNTS}
+  point["solve_ms"] = round(total["solve_ms"], 3)
+  return point, None
+
+
+def compare(point, base, check_time):
+  """The ways in which a point exceeds its baseline."""
+  over = []
+  for k in COUNTS:
+    limit = base[k] * COUNT_TOLERANCE + COUNT_SLACK
+    if point[k] > limit:
+      over.append(f"{k} {point[k]} > {limit:.0f} (baseline {base[k]})")
+  if check_time:
+    limit = base["solve_ms"] * TIME_TOLERANCE + TIME_SLACK_MS
+    if point["solve_ms"] > limit:
+      over.append(f"solve_ms {point['solve_ms']} > {limit:.0f} (baseline {base['solve_ms']})")
+  return over
+
+
+def run(args):
+  baseline = {}
+  if os.path.exists(args.baseline):
+    with open(args.baseline) as f:
+      baseline = json.load(f)
+  dims = [args.dimension] if args.dimension else list(stress.POINTS)
+
+  tmp = tempfile.mkdtemp()
+  points = {}
+  failures = []
+  passed = 0
+  try:
+    for t in stress.templates(dims):
+      start = time.time()
+      print(f"Testing stress/{t.name}...", end=" ", flush=True)
+      point, err = measure(args.symirsolve, t, tmp)
+      duration_ms = int((time.time() - start) * 1000)
+      if err:
+        failures.append((t.name, err))
+        print(f"{red('FAIL')} ({duration_ms}ms)")
+        continue
+      points.setdefault(t.dimension, {})[str(t.n)] = point
+      base = baseline.get(t.dimension, {}).get(str(t.n))
+      over = [] if args.update or not base else compare(point, base, not args.no_time)
+      if not args.update and not base:
+        over = ["no baseline for this point; run with --update"]
+      if over:
+        failures.append((t.name, "\n".join(over)))
+        print(f"{red('FAIL')} ({duration_ms}ms)")
+      else:
+        passed += 1
+        shrunk = base and any(point[k] * COUNT_TOLERANCE < base[k] for k in COUNTS)
+        note = f", {yellow('below baseline')}" if shrunk and not args.update else ""
+        print(f"{green('OK')} ({duration_ms}ms{note})")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  if args.report:
+    with open(args.report, "w") as f:
+      json.dump(points, f, indent=2, sort_keys=True)
+      f.write("\n")
+  if args.update and not failures:
+    for dim, curve in points.items():
+      baseline[dim] = curve
+    with open(args.baseline, "w") as f:
+      json.dump(baseline, f, indent=2, sort_keys=True)
+      f.write("\n")
+    print(f"Baseline written to {args.baseline}")
+
+  total = passed + len(failures)
+  print(f"\nSummary (stress): {passed}/{total} passed", end="")
+  if failures:
+    print(f", {red(str(len(failures)) + ' failed')}", end="")
+  print(".\n")
+  if failures:
+    print(bold("Failures Details:"))
+    for name, msg in failures:
+      print(f"--- {red('stress/' + name)} ---")
+      print(msg)
+    return 1
+  return 0
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Encoding-size regression tests")
+  parser.add_argument("symirsolve", nargs="?", default=os.path.join(CWD, "symirsolve"))
+  parser.add_argument("--baseline", default=BASELINE, help="Baseline curves (JSON)")
+  parser.add_argument("--dimension", choices=sorted(stress.POINTS), help="Only this dimension")
+  parser.add_argument("--report", help="Write the measured points to this JSON file")
+  parser.add_argument("--update", action="store_true", help="Store the measured points as baseline")
+  parser.add_argument("--no-time", action="store_true", help="Do not check solve times")
+  return run(parser.parse_args())
+
+
+if __name__ == "__main__":
+  sys.exit(main())
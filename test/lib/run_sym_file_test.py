@@ -0,0 +1,172 @@
+"""Verify the --sym-file mode of symiri.
+
+Runs a fixture over a .csv and a .jsonl binding file, on one thread and on
+three. Every row must be reported once, with the exit code, result or
+message of a single run with the same --sym bindings. Malformed rows must
+be reported as errors of their own line while the other rows still run,
+and unreadable files must fail the whole run.
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# Rows can return, divide by zero, or fail the require.
+SIR_FIXTURE = """\
+fun @main() : i32 {
+  sym %?a : value i32;
+  sym %?b : value i32;
+  let mut %d: i32 = 0;
+  let mut %r: i32 = 0;
+^entry:
+  %d = %?b;
+  %r = %?a / %d;
+  require %r != 7, "not seven";
+  ret %r;
+}
+"""
+
+CSV = """\
+%?a,%?b
+10,2
+1,0
+# a comment
+
+14,2
+0x10,4
+-9,3
+"""
+
+# %?b comes from --sym 3 unless the row binds it.
+JSONL = """\
+{"%?a": 10, "%?b": 2}
+{"%?a": "0x10"}
+{"%?a": 21}
+"""
+
+# (file name, contents, line, message) of rows that must be rejected.
+BAD_ROWS = [
+  ("short.csv", "%?a,%?b\n10\n", 2, "Expected 2 values, got 1"),
+  ("nan.csv", "%?a,%?b\n10,zz\n", 2, "Invalid number value for symbol %?b: zz"),
+  ("brace.jsonl", '{"%?a": 1\n', 1, "JSON: expected '}' at offset 9"),
+  ("unbound.csv", "%?a,%?q\n1,2\n", 2, "Symbol %?b has no binding"),
+]
+
+
+def single(symiri, sir, bindings):
+  cmd = [symiri, sir]
+  for name, value in bindings.items():
+    cmd += ["--sym", f"{name}={value}"]
+  return subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60)
+
+
+def rows_of(path, defaults):
+  """The bindings of each data line, keyed by line number."""
+  rows = {}
+  with open(path) as f:
+    lines = f.read().splitlines()
+  if path.endswith(".csv"):
+    header = lines[0].split(",")
+    for n, line in enumerate(lines[1:], start=2):
+      if line and not line.startswith("#"):
+        rows[n] = dict(defaults, **dict(zip(header, line.split(","))))
+  else:
+    for n, line in enumerate(lines, start=1):
+      rows[n] = dict(defaults, **json.loads(line))
+  return rows
+
+
+def batch(symiri, sir, path, extra):
+  r = subprocess.run(
+    [symiri, sir, "--sym-file", path] + extra,
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    text=True,
+    timeout=60,
+  )
+  answers = {}
+  for line in r.stdout.splitlines():
+    answer = json.loads(line)
+    answers.setdefault(answer["line"], []).append(answer)
+  return r.returncode, answers
+
+
+def run(symiri):
+  tmp = tempfile.mkdtemp()
+  sir = os.path.join(tmp, "div.sir")
+  with open(sir, "w") as f:
+    f.write(SIR_FIXTURE)
+  files = {"rows.csv": CSV, "rows.jsonl": JSONL}
+  files.update({name: text for name, text, _, _ in BAD_ROWS})
+  for name, text in files.items():
+    with open(os.path.join(tmp, name), "w") as f:
+      f.write(text)
+
+  start = time.time()
+  print(f"Testing --sym-file via {symiri}...", end=" ", flush=True)
+  failures = []
+  try:
+    for name, defaults in (("rows.csv", {}), ("rows.jsonl", {"%?b": "3"})):
+      path = os.path.join(tmp, name)
+      extra = [arg for k, v in defaults.items() for arg in ("--sym", f"{k}={v}")]
+      rows = rows_of(path, defaults)
+      for threads in ("1", "3"):
+        rc, answers = batch(symiri, sir, path, extra + ["-j", threads])
+        if rc != 0 or sorted(answers) != sorted(rows):
+          failures.append(f"{name} -j {threads}: exit {rc}, lines {sorted(answers)}")
+          continue
+        for n, bindings in rows.items():
+          if len(answers[n]) != 1:
+            failures.append(f"{name} -j {threads}: line {n} answered {len(answers[n])} times")
+            continue
+          answer = answers[n][0]
+          ref = single(symiri, sir, bindings)
+          output = ref.stdout + ref.stderr
+          if answer["exit"] != ref.returncode:
+            failures.append(f"{name} line {n}: exit {answer['exit']}, single run {ref.returncode}")
+          elif answer["status"] == "ok" and f"Result: {answer['result']}" not in output:
+            failures.append(f"{name} line {n}: result {answer['result']}, single run:\n{output}")
+          elif answer["status"] != "ok" and answer["message"] not in output:
+            failures.append(f"{name} line {n}: {answer['message']!r}, single run:\n{output}")
+
+    for name, _, line, message in BAD_ROWS:
+      rc, answers = batch(symiri, sir, os.path.join(tmp, name), [])
+      answer = answers.get(line, [{}])[0]
+      if rc != 0 or answer.get("status") != "error" or not answer.get("message", "").startswith(message):
+        failures.append(f"{name}: exit {rc}, {answers}")
+
+    for name in ("missing.csv", "rows.txt"):
+      rc, answers = batch(symiri, sir, os.path.join(tmp, name), [])
+      if rc != 1 or answers:
+        failures.append(f"{name}: exit {rc}, {answers}")
+  except (subprocess.TimeoutExpired, ValueError, KeyError) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--sym-file checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symiri = sys.argv[1]
+  else:
+    symiri = os.path.join(CWD, "symiri")
+  sys.exit(run(symiri))
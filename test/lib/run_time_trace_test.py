@@ -0,0 +1,143 @@
+"""Verify the phase timings of symirc, symiri and symirsolve (--time-passes,
+--time-trace).
+
+Runs each tool on a module with and without the flags: the output must not
+change, the trace must be well-formed Chrome trace-event JSON, and it must
+agree with the --time-passes report on stderr. Every complete event must
+be named after the last part of its path and lie inside an event of its
+parent path, and each traced path must have as many events as the report
+counts calls; the counters of the report must be those of the trace.
+"""
+
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from collections import Counter
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# (tool, module, arguments); symirc runs its passes on four threads.
+RUNS = [
+  ("symirc", "test/compile/emit_many_functions.sir", ["-O", "-j", "4"]),
+  ("symirc", "examples/ptr_swap.sir", ["--target", "wasm-bin", "--vectorize"]),
+  ("symiri", "test/interp/profile_nested_loops.sir", []),
+  ("symirsolve", "examples/ptr_swap.sir", ["--path", "^entry,^loop,^body,^loop,^body,^loop,^exit"]),
+]
+
+REPORT_RE = re.compile(r"^\s+[0-9.]+\s+[0-9.]+\s+(\d+)( +)(\S+)$")
+COUNTER_RE = re.compile(r"^  ([\w-]+): (\d+)$")
+
+
+def parse_report(stderr):
+  """The calls per path and the counters of a --time-passes report."""
+  calls, counters, stack = {}, {}, []
+  in_counters = False
+  for line in stderr.splitlines():
+    if line.strip() == "Counters":
+      in_counters = True
+      continue
+    if in_counters:
+      if m := COUNTER_RE.match(line):
+        counters[m.group(1)] = int(m.group(2))
+      continue
+    if m := REPORT_RE.match(line):
+      depth = (len(m.group(2)) - 2) // 2
+      del stack[depth:]
+      stack.append(m.group(3))
+      calls["/".join(stack)] = int(m.group(1))
+  return calls, counters
+
+
+def check_trace(trace, calls, counters, what, failures):
+  events = trace.get("traceEvents")
+  if not isinstance(events, list) or trace.get("displayTimeUnit") != "ms":
+    failures.append(f"{what}: not a trace-event file")
+    return
+  complete = [e for e in events if e.get("ph") == "X"]
+  rss = [e for e in events if e.get("ph") == "C" and e.get("name") == "peak_rss_kib"]
+  if len(rss) != 1 or not rss[0]["args"]["value"] > 0:
+    failures.append(f"{what}: no peak RSS counter")
+  for e in complete:
+    path = e.get("args", {}).get("path", "")
+    fields_ok = all(isinstance(e.get(k), int) and e[k] >= 0 for k in ("ts", "dur", "tid"))
+    if not fields_ok or e.get("pid") != 1 or e.get("name") != path.rsplit("/", 1)[-1]:
+      failures.append(f"{what}: malformed event {e}")
+      return
+    if "/" in path:
+      parent = path.rsplit("/", 1)[0]
+      inside = any(
+        p["args"]["path"] == parent and p["ts"] <= e["ts"] and e["ts"] + e["dur"] <= p["ts"] + p["dur"]
+        for p in complete
+      )
+      if not inside:
+        failures.append(f"{what}: {path} at {e['ts']}us lies outside every {parent}")
+  other = dict(trace.get("otherData", {}))
+  dropped = other.pop("dropped_events", None)
+  if dropped == 0:
+    # Time added in bulk, like that of the lexer, is reported without events.
+    for path, n in Counter(e["args"]["path"] for e in complete).items():
+      if calls.get(path) != n:
+        failures.append(f"{what}: {n} events of {path}, the report counts {calls.get(path)} calls")
+  elif not dropped:
+    failures.append(f"{what}: no dropped_events in otherData")
+  if other != counters:
+    failures.append(f"{what}: trace counters {other}, the report says {counters}")
+
+
+def run(bindir):
+  tmp = tempfile.mkdtemp()
+  trace_out = os.path.join(tmp, "trace.json")
+  compiled = os.path.join(tmp, "out")
+
+  start = time.time()
+  print(f"Testing --time-trace via {bindir}...", end=" ", flush=True)
+  failures = []
+  try:
+    for tool, module, args in RUNS:
+      what = f"{tool} {module}"
+      cmd = [os.path.join(bindir, tool), os.path.join(CWD, module)] + args
+      if tool == "symirc":
+        cmd += ["-o", compiled]
+      outputs = []
+      for extra in ([], ["--time-passes", "--time-trace", trace_out]):
+        r = subprocess.run(cmd + extra, stdout=subprocess.PIPE, stderr=subprocess.PIPE, timeout=60)
+        if tool == "symirc":
+          with open(compiled, "rb") as f:
+            outputs.append((r.returncode, f.read()))
+        else:
+          outputs.append((r.returncode, r.stdout))
+      if outputs[0] != outputs[1] or not outputs[0][1]:
+        failures.append(f"{what}: output differs with the timing flags")
+        continue
+      calls, counters = parse_report(r.stderr.decode())
+      if not calls or "Peak RSS:" not in r.stderr.decode():
+        failures.append(f"{what}: no --time-passes report")
+        continue
+      with open(trace_out) as f:
+        check_trace(json.load(f), calls, counters, what, failures)
+  except (subprocess.TimeoutExpired, ValueError, KeyError, OSError) as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--time-trace checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(run(sys.argv[1] if len(sys.argv) > 1 else CWD))
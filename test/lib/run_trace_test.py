@@ -0,0 +1,122 @@
+"""Verify the binary trace format of symiri (--trace-file, --decode-trace).
+
+Runs test/interp/trace_binary_filtered.sir with its INTERP_ARGS, the trace
+redirected from /dev/null to a temporary file, and diffs the decoded trace
+against the expected dump. Then writes the fixture's trace plain and
+gzipped (when symiri has zlib), unfiltered and under each filter, and
+checks that every decoded binary trace equals the --dump-trace text of the
+same run.
+"""
+
+import difflib
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.framework import get_metadata
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+FIXTURE = os.path.join(CWD, "test", "interp", "trace_binary_filtered.sir")
+
+# The fixture's trace under `--trace-var %acc`: every block, but only the
+# assignments to %acc.
+EXPECTED = """\
+^entry:
+^loop:
+^body:
+  %acc[1] = 0
+^loop:
+^body:
+  %acc[1] = 1
+^loop:
+^body:
+  %acc[1] = 3
+^loop:
+^body:
+  %acc[1] = 6
+^loop:
+^done:
+"""
+
+FILTERS = [[], ["--trace-var", "%acc"], ["--trace-var", "%i"], ["--trace-blocks-only"]]
+
+
+def symiri_run(symiri, args):
+  return subprocess.run(
+    [symiri] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60
+  )
+
+
+def decode(symiri, trace, failures, what):
+  r = symiri_run(symiri, ["--decode-trace", trace])
+  if r.returncode != 0:
+    failures.append(f"{what}: --decode-trace exit {r.returncode}\n{r.stderr}")
+  return r.stdout
+
+
+def diff(expected, got):
+  return "".join(difflib.unified_diff(expected.splitlines(True), got.splitlines(True), "expected", "decoded"))
+
+
+def run(symiri):
+  tmp = tempfile.mkdtemp()
+  trace = os.path.join(tmp, "run.trace")
+
+  start = time.time()
+  print(f"Testing binary traces via {symiri}...", end=" ", flush=True)
+  failures = []
+  try:
+    _, args, _ = get_metadata(FIXTURE)
+    interp_args = [trace if a == "/dev/null" else a for a in args["INTERP_ARGS"]]
+    r = symiri_run(symiri, [FIXTURE] + interp_args)
+    if r.returncode != 0:
+      failures.append(f"fixture: exit {r.returncode}\n{r.stderr}")
+    else:
+      got = decode(symiri, trace, failures, "fixture")
+      if got != EXPECTED:
+        failures.append(f"fixture trace differs:\n{diff(EXPECTED, got)}")
+
+    for flags in FILTERS:
+      text = symiri_run(symiri, [FIXTURE, "--dump-trace"] + flags).stdout
+      text = "".join(l for l in text.splitlines(True) if not l.startswith("Result:"))
+      for compress in ([], ["--trace-compress"]):
+        what = " ".join(flags + compress) or "unfiltered"
+        if os.path.exists(trace):
+          os.remove(trace)
+        r = symiri_run(symiri, [FIXTURE, "--trace-file", trace] + flags + compress)
+        if compress and "built with zlib" in r.stderr:
+          continue
+        if r.returncode != 0:
+          failures.append(f"{what}: exit {r.returncode}\n{r.stderr}")
+          continue
+        got = decode(symiri, trace, failures, what)
+        if got != text:
+          failures.append(f"{what}: decoded trace differs from --dump-trace:\n{diff(text, got)}")
+  except subprocess.TimeoutExpired as e:
+    failures.append(str(e))
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('binary trace checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symiri = sys.argv[1]
+  else:
+    symiri = os.path.join(CWD, "symiri")
+  sys.exit(run(symiri))
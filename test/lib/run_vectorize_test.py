@@ -0,0 +1,216 @@
+"""Verify the vector code `symirc --vectorize` emits.
+
+Compiles a fixture with an element-wise loop and a prefix-sum loop, which
+reads the element of the previous iteration, to C under three vector
+lowerings, with three lanes under two of them, and to WASM text under
+--wasm-simd. Three or five lanes must be refused under vecext, which has
+no such vector types. The element-wise loop must move its elements with
+one vector load or store each and compute with vector operations; the
+prefix sum must stay scalar. The C is built with the host C compiler and
+must compute what the scalar loops do.
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from test.lib.style import bold, green, red
+
+CWD = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# %b[9] = 10 + 10 - 9 = 11, %c[9] = 33 and %p[9] = 10: returns 43.
+SIR_FIXTURE = """\
+fun @main() : i32 {
+  let mut %a: [10] i32 = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  let mut %b: [10] i32 = 0;
+  let mut %c: [10] i32 = 0;
+  let mut %p: [10] i32 = 1;
+  let mut %i: i32 = 0;
+  let mut %j: i32 = 1;
+  let mut %jm1: i32 = 0;
+  let %k: i32 = 3;
+^entry:
+  br ^loop;
+^loop:
+  br %i < 10, ^body, ^prefix;
+^body:
+  %b[%i] = %a[%i] + %a[%i] - %i;
+  %c[%i] = %k * %b[%i];
+  %i = %i + 1;
+  br ^loop;
+^prefix:
+  br %j < 10, ^prefix_body, ^done;
+^prefix_body:
+  %jm1 = %j - 1;
+  %p[%j] = %p[%j] + %p[%jm1];
+  %j = %j + 1;
+  br ^prefix;
+^done:
+  ret %c[9] + %p[9];
+}
+"""
+
+DRIVER = """\
+#include <stdint.h>
+#include <stdio.h>
+int32_t symir_main(void);
+int main(void) {
+  printf("%d\\n", symir_main());
+  return 0;
+}
+"""
+
+# Lane-by-lane copies of the elements, which the vector loop must not have.
+LANE_COPIES = [
+  "symir_a_v[1] = symir_a",
+  "symir_a_v.l[1] =",
+  "symir_b[symir_i_1]",
+  "symir_c[symir_i_1]",
+]
+
+# (symirc flags, strings the vector loop must contain)
+C_BUILDS = [
+  (
+    ["--vectorize"],
+    [
+      "memcpy(&symir_a_v, &symir_a[",
+      "memcpy(&symir_b[",
+      "memcpy(&symir_c[",
+      "symir_b_v = ((symir_a_v) + (symir_a_v) - (symir_i_v));",
+      "symir_c_v = ((symir_k_v * symir_b_v));",
+      "symir_i_v = ((symir_i_v) + (4));",
+    ],
+  ),
+  (
+    ["--vectorize", "--vec-lowering", "intrinsics", "--vec-target", "sse4"],
+    ["memcpy(symir_a_v.l, &symir_a[", "memcpy(&symir_b[", "_mm_add_epi32", "_mm_sub_epi32"],
+  ),
+  (
+    ["--vectorize", "--vec-lowering", "structarray"],
+    ["memcpy(symir_a_v.lanes, &symir_a[", "memcpy(&symir_c["],
+  ),
+  # Three lanes: three vector iterations and one left over.
+  (["--vectorize=3", "--vec-lowering", "array"], ["memcpy(symir_a_v, &symir_a[", "symir_i_v[2] ="]),
+  (
+    ["--vectorize=3", "--vec-lowering", "intrinsics"],
+    ["memcpy(symir_a_v.l, &symir_a[", "_mm_add_epi32"],
+  ),
+]
+
+# vecext has no vector types of three or five lanes.
+C_REJECTED = [["--vectorize=3"], ["--vectorize=5"]]
+
+WASM_WANT = ["v128.load", "v128.store", "i32x4.add", "i32x4.sub", "i32x4.mul"]
+WASM_SCALAR = ["i32.load", "i32.store"]
+
+
+def section(text, start, end):
+  """The text from the line containing `start` up to the next `end` line."""
+  m = re.search(re.escape(start) + r".*?(?=" + end + r"|\Z)", text, re.S)
+  return m.group(0) if m else ""
+
+
+def run(symirc):
+  cc = os.environ.get("CC") or shutil.which("cc") or shutil.which("gcc")
+  tmp = tempfile.mkdtemp()
+  sir = os.path.join(tmp, "vec.sir")
+  driver = os.path.join(tmp, "driver.c")
+  with open(sir, "w") as f:
+    f.write(SIR_FIXTURE)
+  with open(driver, "w") as f:
+    f.write(DRIVER)
+
+  start = time.time()
+  print(f"Testing --vectorize codegen via {symirc}...", end=" ", flush=True)
+  failures = []
+  try:
+    for flags in C_REJECTED:
+      r = subprocess.run(
+        [symirc, sir, "-w"] + flags, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True
+      )
+      if r.returncode != 1 or "power of two" not in r.stderr:
+        failures.append(f"{' '.join(flags)}: exit {r.returncode}, expected an error under vecext")
+
+    for flags, want in C_BUILDS:
+      what = " ".join(flags)
+      src = os.path.join(tmp, "vec.c")
+      exe = os.path.join(tmp, "vec")
+      r = subprocess.run(
+        [symirc, sir, "-w", "-o", src] + flags,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )
+      if r.returncode != 0:
+        failures.append(f"symirc {what} failed:\n{r.stderr}")
+        continue
+      with open(src) as f:
+        text = f.read()
+      loop = section(text, "symir_loop_vec: ;", r"\nsymir_\w+: ;")
+      for s in want:
+        if s not in loop:
+          failures.append(f"{what}: the vector loop lacks {s!r}")
+      for s in LANE_COPIES:
+        if s in loop:
+          failures.append(f"{what}: the vector loop copies lanes one by one ({s!r})")
+      if "symir_prefix_vec" in text:
+        failures.append(f"{what}: the prefix sum was vectorized")
+      if cc is None:
+        failures.append("no C compiler found (set CC)")
+        continue
+      r = subprocess.run(
+        [cc, "-std=gnu99", "-O2", "-w", src, driver, "-o", exe, "-lm"],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+      )
+      if r.returncode != 0:
+        failures.append(f"{cc} failed on {what} output:\n{r.stderr}")
+        continue
+      r = subprocess.run([exe], stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60)
+      if r.returncode != 0 or r.stdout.strip() != "43":
+        failures.append(f"{what}: exit {r.returncode}, printed {r.stdout.strip()!r}; expected 43")
+
+    r = subprocess.run(
+      [symirc, sir, "-w", "--vectorize", "--target", "wasm", "--wasm-simd"],
+      stdout=subprocess.PIPE,
+      stderr=subprocess.PIPE,
+      text=True,
+    )
+    if r.returncode != 0:
+      failures.append(f"symirc --target wasm --wasm-simd failed:\n{r.stderr}")
+    else:
+      loop = section(r.stdout, ";; -> ^loop_vec", r";; -> \^")
+      for s in WASM_WANT:
+        if s not in loop:
+          failures.append(f"wasm: the vector loop lacks {s}")
+      for s in WASM_SCALAR:
+        if re.search(r"^\s*" + re.escape(s) + r"\b", loop, re.M):
+          failures.append(f"wasm: the vector loop has a scalar {s}")
+      if "^prefix_vec" in r.stdout:
+        failures.append("wasm: the prefix sum was vectorized")
+  finally:
+    shutil.rmtree(tmp, ignore_errors=True)
+
+  duration_ms = int((time.time() - start) * 1000)
+  if failures:
+    print(f"{red('FAIL')} ({duration_ms}ms)")
+    print(bold("\nFailures Details:"))
+    print(f"--- {red('--vectorize codegen checks')} ---")
+    for msg in failures:
+      print(f"  - {msg}")
+    return 1
+  print(f"{green('OK')} ({duration_ms}ms)")
+  return 0
+
+
+if __name__ == "__main__":
+  if len(sys.argv) > 1:
+    symirc = sys.argv[1]
+  else:
+    symirc = os.path.join(CWD, "symirc")
+  sys.exit(run(symirc))
@@ -0,0 +1,21 @@
+// Runs the entry export of a module from `symirc --target wasm-bin`:
+//   node run_wasm.mjs <file.wasm> <export> '{"<sym>": ["<type>", "<value>"], ...}'
+// Each sym import (`<sym>`, or `<sym>__<lane>` for a vector sym) returns
+// its bound value, 0 when unbound. Exits 1 if the module traps.
+import { readFileSync } from "node:fs";
+
+const [file, entry, bindingsJson] = process.argv.slice(2);
+const bindings = JSON.parse(bindingsJson || "{}");
+const module = new WebAssembly.Module(readFileSync(file));
+const imports = {};
+for (const imp of WebAssembly.Module.imports(module)) {
+  const [type, value] = bindings[imp.name] || ["i32", "0"];
+  const v = type === "i64" ? BigInt(value) : Number(value);
+  (imports[imp.module] ??= {})[imp.name] = () => v;
+}
+try {
+  new WebAssembly.Instance(module, imports).exports[entry]();
+} catch (e) {
+  console.error(e.message);
+  process.exit(1);
+}
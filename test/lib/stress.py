@@ -0,0 +1,210 @@
+"""Stress templates for the symbolic executor, scaled along one dimension.
+
+Each dimension stresses one part of the encoder that has grown badly
+before:
+
+  array     reads and writes at a symbolic index of an N-cell array,
+            merged into ITE chains (mergeAggregate)
+  locals    N symbolic locals, all live to the end
+  pointers  one pointer that may point to any of N same-typed locals,
+            stored and loaded through (the StoreInstr/LoadInstr dispatch)
+  structs   a field assignment N structs deep (updateLValueRec)
+  path      a loop unrolled N times along the path
+
+`generate(dimension, n)` returns a Template: the source, the path to solve
+and the extra symirsolve arguments. Every template is SAT.
+
+Run as a module to write the templates as .sir files, e.g. to look at one
+by hand or to profile symirsolve on it:
+
+  python3 -m test.lib.stress --out /tmp/stress [--dimension array] [--n 256]
+"""
+
+import argparse
+import os
+import sys
+from dataclasses import dataclass, field
+
+# Data points per dimension, smallest first.
+POINTS = {
+  "array": [8, 32, 128, 256],
+  "locals": [8, 32, 128, 512],
+  "pointers": [4, 16, 64, 256],
+  "structs": [1, 2, 4, 8],
+  "path": [4, 16, 64, 256],
+}
+
+
+@dataclass
+class Template:
+  dimension: str
+  n: int
+  source: str
+  path: list
+  args: list = field(default_factory=list)
+
+  @property
+  def name(self):
+    return f"{self.dimension}_{self.n}"
+
+  def header(self):
+    path = ",".join(self.path)
+    args = " ".join(self.args)
+    return (
+      "// EXPECT: PASS\n"
+      f"// SOLVER_ARGS: --main @main --path '{path}' {args}\n"
+      f"// Stress template: {self.dimension}, n = {self.n} (test/lib/stress.py)\n"
+    )
+
+
+def _array(n):
+  # A write and two reads at symbolic indices; the ITE encoding is forced
+  # so that large arrays do not switch to SMT arrays.
+  cells = ", ".join(str(3 * k) for k in range(n))
+  src = f"""fun @main() : i32 {{
+  sym %?i : index i32 in [0, {n - 1}];
+  sym %?j : index i32 in [0, {n - 1}];
+  sym %?k : index i32 in [0, {n - 1}];
+  sym %?v : value i32 in [0, 100];
+  let mut %a: [{n}] i32 = {{{cells}}};
+  let mut %r: i32 = 0;
+^entry:
+  %a[%?k] = %?v;
+  %r = %a[%?i] + %a[%?j];
+  require %?k != %?i, "the write is not read back";
+  require %r == {3 * (n - 1)} + %?v, "one end and the written cell";
+  ret %r;
+}}
+"""
+  return Template("array", n, src, ["^entry"], ["--array-encoding=ite"])
+
+
+def _locals(n):
+  lines = ["fun @main() : i32 {"]
+  for k in range(n):
+    lines.append(f"  sym %?s{k} : value i32 in [0, 10];")
+  for k in range(n):
+    lines.append(f"  let mut %x{k}: i32 = 0;")
+  lines.append("  let mut %sum: i32 = 0;")
+  lines.append("^entry:")
+  for k in range(n):
+    lines.append(f"  %x{k} = %?s{k} + {k % 7};")
+  for k in range(n):
+    lines.append(f"  %sum = %sum ^ %x{k};")
+  lines.append('  require %sum != 0, "not all pairs cancel out";')
+  lines.append("  ret %sum;")
+  lines.append("}")
+  return Template("locals", n, "\n".join(lines) + "\n", ["^entry"])
+
+
+def _pointers(n):
+  # %p takes the address of each target in turn, so it may point to all of
+  # them; the stores and loads through it dispatch over the n targets.
+  lines = ["fun @main() : i32 {", "  sym %?v : value i32 in [0, 100];"]
+  for k in range(n):
+    lines.append(f"  let mut %t{k}: i32 = {k};")
+  lines += ["  let mut %p: ptr i32 = null;", "  let mut %r: i32 = 0;"]
+  path = []
+  for k in range(n):
+    lines.append(f"^set{k}:")
+    lines.append(f"  %p = addr %t{k};")
+    lines.append(f"  store %p, load %p + %?v;")
+    lines.append(f"  br ^set{k + 1};" if k + 1 < n else "  br ^use;")
+    path.append(f"^set{k}")
+  lines += [
+    "^use:",
+    "  %r = load %p;",
+    f'  require %r == {n - 1} + %?v, "the last target";',
+    '  require %t0 == %?v, "the first target";',
+    "  ret %r;",
+    "}",
+  ]
+  return Template("pointers", n, "\n".join(lines) + "\n", path + ["^use"])
+
+
+def _structs(n):
+  # @S0 holds two i32; @Sk two @S(k-1). One assignment of the innermost
+  # field rebuilds the n enclosing structs.
+  lines = ["struct @S0 { a: i32; b: i32; }"]
+  for k in range(1, n + 1):
+    lines.append(f"struct @S{k} {{ a: @S{k - 1}; b: @S{k - 1}; }}")
+  deep = "".join(".b" for _ in range(n))
+  lines += [
+    "",
+    "fun @main() : i32 {",
+    "  sym %?v : value i32 in [0, 100];",
+    f"  let mut %s: @S{n};",
+    "  let mut %r: i32 = 0;",
+    "^entry:",
+    f"  %s{deep}.a = 1;",
+    f"  %s{deep}.b = %?v;",
+    f"  %r = %s{deep}.a + %s{deep}.b;",
+    '  require %r == 42, "both fields of the innermost struct";',
+    "  ret %r;",
+    "}",
+  ]
+  return Template("structs", n, "\n".join(lines) + "\n", ["^entry"])
+
+
+def _path(n):
+  src = f"""fun @main() : i32 {{
+  sym %?c : coef i32 in [-8, 8];
+  let mut %i: i32 = 0;
+  let mut %x: i32 = 1;
+^entry:
+  br ^loop;
+^loop:
+  br %i < {n}, ^body, ^done;
+^body:
+  %x = 1023 & %x + %?c ^ %i;
+  %i = %i + 1;
+  br ^loop;
+^done:
+  require %x != 0, "any value but zero";
+  ret %x;
+}}
+"""
+  return Template("path", n, src, ["^entry"] + ["^loop", "^body"] * n + ["^loop", "^done"])
+
+
+GENERATORS = {
+  "array": _array,
+  "locals": _locals,
+  "pointers": _pointers,
+  "structs": _structs,
+  "path": _path,
+}
+
+
+def generate(dimension, n):
+  return GENERATORS[dimension](n)
+
+
+def templates(dimensions=None):
+  for dim in dimensions or POINTS:
+    for n in POINTS[dim]:
+      yield generate(dim, n)
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Write the stress templates as .sir files")
+  parser.add_argument("--out", required=True, help="Output directory")
+  parser.add_argument("--dimension", choices=sorted(GENERATORS), help="Only this dimension")
+  parser.add_argument("--n", type=int, help="Only this size (with --dimension)")
+  args = parser.parse_args()
+
+  if args.n is not None and not args.dimension:
+    parser.error("--n needs --dimension")
+  if args.n is not None:
+    todo = [generate(args.dimension, args.n)]
+  else:
+    todo = templates([args.dimension] if args.dimension else None)
+  os.makedirs(args.out, exist_ok=True)
+  for t in todo:
+    with open(os.path.join(args.out, t.name + ".sir"), "w") as f:
+      f.write(t.header() + "\n" + t.source)
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())